@@ -0,0 +1,160 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef BENCHMARK_BENCHMARK_UTILS_H_
+#define BENCHMARK_BENCHMARK_UTILS_H_
+
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "client/client.h"
+#include "common/util/logging.h"
+
+namespace vineyard {
+
+/**
+ * @brief Spawn a vineyardd with local metadata and wait until it accepts
+ * connections, returns -1 on failure.
+ */
+inline pid_t SpawnVineyardd(std::string const& socket) {
+#if defined(VINEYARDD_PATH)
+  pid_t pid = fork();
+  if (pid == 0) {
+    std::string socket_arg = "--socket=" + socket;
+    execl(VINEYARDD_PATH, "vineyardd", socket_arg.c_str(), "--meta=local",
+          "--size=8Gi", static_cast<char*>(nullptr));
+    _exit(127);
+  }
+  for (int retries = 0; pid > 0 && retries < 300; ++retries) {
+    Client client;
+    if (client.Connect(socket).ok()) {
+      return pid;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  LOG(ERROR) << "Failed to launch vineyardd at " << VINEYARDD_PATH;
+  if (pid > 0) {
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+  }
+#else
+  LOG(ERROR) << "VINEYARD_IPC_SOCKET is not set, and vineyardd is not built";
+#endif
+  return -1;
+}
+
+enum class Distribution {
+  kUniform = 0,
+  kRMAT = 1,
+};
+
+/**
+ * @brief Writes a vertex file `person.csv` (id,rank) and an edge file
+ * `knows.csv` (src,dst,weight) of the given distribution into `directory`,
+ * with `degree` edges per vertex on average. The ids of the R-MAT graph are
+ * scrambled so that the hubs are not clustered at the small ids.
+ */
+inline void GenerateGraph(std::string const& directory, int64_t const vertices,
+                          int64_t const degree,
+                          Distribution const distribution) {
+  std::mt19937_64 rng(20210101);
+  int scale = 0;
+  while ((int64_t(1) << scale) < vertices) {
+    scale += 1;
+  }
+  std::vector<int64_t> permutation(vertices);
+  for (int64_t i = 0; i < vertices; ++i) {
+    permutation[i] = i;
+  }
+  std::shuffle(permutation.begin(), permutation.end(), rng);
+
+  std::ofstream vfile(directory + "/person.csv");
+  vfile << "id,rank\n";
+  for (int64_t i = 0; i < vertices; ++i) {
+    vfile << i << "," << rng() % 1000 << "\n";
+  }
+  vfile.close();
+
+  // the quadrant probabilities of graph500
+  std::uniform_real_distribution<double> uniform(0, 1);
+  const double a = 0.57, b = 0.19, c = 0.19;
+  std::ofstream efile(directory + "/knows.csv");
+  efile << "src,dst,weight\n";
+  for (int64_t i = 0; i < vertices * degree; ++i) {
+    int64_t src = 0, dst = 0;
+    if (distribution == Distribution::kUniform) {
+      src = rng() % vertices;
+      dst = rng() % vertices;
+    } else {
+      for (int bit = 0; bit < scale; ++bit) {
+        double p = uniform(rng);
+        src = (src << 1) | (p >= a + b);
+        dst = (dst << 1) | ((p >= a && p < a + b) || p >= a + b + c);
+      }
+      src = permutation[src % vertices];
+      dst = permutation[dst % vertices];
+    }
+    efile << src << "," << dst << "," << uniform(rng) << "\n";
+  }
+  efile.close();
+}
+
+/**
+ * @brief The main function of the benchmarks, the benchmarks connect to the
+ * vineyardd at `VINEYARD_IPC_SOCKET`, or to a vineyardd that is spawned from
+ * the build tree when the variable is not set.
+ */
+inline int RunBenchmarks(int argc, char** argv, std::string& ipc_socket) {
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+
+  pid_t vineyardd = -1;
+  if (char const* socket = std::getenv("VINEYARD_IPC_SOCKET")) {
+    ipc_socket = socket;
+  } else {
+    ipc_socket = "/tmp/vineyard-benchmark." + std::to_string(getpid()) +
+                 ".sock";
+    if ((vineyardd = SpawnVineyardd(ipc_socket)) < 0) {
+      return 1;
+    }
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+
+  if (vineyardd > 0) {
+    kill(vineyardd, SIGTERM);
+    waitpid(vineyardd, nullptr, 0);
+  }
+  return 0;
+}
+
+}  // namespace vineyard
+
+#endif  // BENCHMARK_BENCHMARK_UTILS_H_
@@ -0,0 +1,340 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "client/client.h"
+#include "common/util/functions.h"
+#include "common/util/logging.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/loader/arrow_fragment_loader.h"
+
+#include "benchmark_utils.h"
+
+// Benchmarks for the accessors of ArrowFragment and ArrowVertexMap that form
+// the inner loops of the graph applications.
+//
+// Usage:
+//
+//    VINEYARD_IPC_SOCKET=/var/run/vineyard.sock ./fragment_benchmark \
+//        --benchmark_filter='BM_OutgoingAdjList/.*'
+//
+// The fragments are generated once for each degree distribution, i.e., a
+// uniform random graph (distribution 0) and an R-MAT graph whose skewed
+// degrees resemble the social graphs (distribution 1), with kVertices
+// vertices and kDegree edges per vertex on average, and loaded by a single
+// worker. The traversals report the edges visited per second, and the
+// lookups the ids resolved per second, in the sequential (order 0) or the
+// shuffled (order 1) order of the vertices.
+//
+// A vineyardd with local metadata is spawned from the build tree when
+// VINEYARD_IPC_SOCKET is not set.
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+namespace {
+
+using GraphType = ArrowFragment<property_graph_types::OID_TYPE,
+                                property_graph_types::VID_TYPE>;
+using oid_t = GraphType::oid_t;
+using vid_t = GraphType::vid_t;
+using vertex_t = GraphType::vertex_t;
+using internal_oid_t = GraphType::internal_oid_t;
+
+std::string ipc_socket;
+
+constexpr int64_t kVertices = 1 << 20;
+constexpr int64_t kDegree = 16;
+
+Client& local_client() {
+  static Client client;
+  if (!client.Connected()) {
+    VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  }
+  return client;
+}
+
+ObjectID load_fragment(Client& client, Distribution const distribution) {
+  std::string directory = "/tmp/vineyard-fragment-benchmark-" +
+                          std::to_string(getpid()) + "-" +
+                          std::to_string(static_cast<int>(distribution));
+  PCHECK(mkdir(directory.c_str(), 0755) == 0 || errno == EEXIST);
+  double t = -GetCurrentTime();
+  GenerateGraph(directory, kVertices, kDegree, distribution);
+  t += GetCurrentTime();
+  LOG(INFO) << "generated the graph of distribution "
+            << static_cast<int>(distribution) << " in " << t << " seconds";
+
+  std::vector<std::string> efiles{
+      directory +
+      "/knows.csv#header_row=true&delimiter=,"
+      "&src_label=person&dst_label=person&label=knows"};
+  std::vector<std::string> vfiles{
+      directory + "/person.csv#header_row=true&delimiter=,&label=person"};
+
+  grape::CommSpec comm_spec;
+  comm_spec.Init(MPI_COMM_WORLD);
+  ObjectID fragment_id = InvalidObjectID();
+  {
+    auto loader =
+        std::make_unique<ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                             property_graph_types::VID_TYPE>>(
+            client, comm_spec, efiles, vfiles, true);
+    fragment_id = boost::leaf::try_handle_all(
+        [&loader]() { return loader->LoadFragment(); },
+        [](const GSError& e) {
+          LOG(FATAL) << e.error_msg;
+          return InvalidObjectID();
+        },
+        [](const boost::leaf::error_info& unmatched) {
+          LOG(FATAL) << "Unmatched error " << unmatched;
+          return InvalidObjectID();
+        });
+  }
+
+  unlink((directory + "/person.csv").c_str());
+  unlink((directory + "/knows.csv").c_str());
+  rmdir(directory.c_str());
+  return fragment_id;
+}
+
+std::map<Distribution, ObjectID> fragment_ids;
+
+/**
+ * @brief The fragment of the given distribution, which is generated and
+ * loaded on the first use and shared by the following benchmarks.
+ */
+std::shared_ptr<GraphType> get_fragment(Distribution const distribution) {
+  static std::map<Distribution, std::shared_ptr<GraphType>> fragments;
+  auto iter = fragments.find(distribution);
+  if (iter != fragments.end()) {
+    return iter->second;
+  }
+  Client& client = local_client();
+  ObjectID fragment_id = load_fragment(client, distribution);
+  fragment_ids.emplace(distribution, fragment_id);
+  auto fragment =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+  CHECK(fragment != nullptr);
+  fragments.emplace(distribution, fragment);
+  return fragment;
+}
+
+/**
+ * @brief The inner vertices of the fragment, shuffled when the order is
+ * non-zero.
+ */
+std::vector<vertex_t> get_vertices(std::shared_ptr<GraphType> const& fragment,
+                                   int64_t const order) {
+  std::vector<vertex_t> vertices;
+  for (auto v : fragment->InnerVertices(0)) {
+    vertices.emplace_back(v);
+  }
+  if (order != 0) {
+    std::shuffle(vertices.begin(), vertices.end(), std::mt19937_64(1));
+  }
+  return vertices;
+}
+
+void BM_OutgoingAdjList(benchmark::State& state) {
+  auto fragment = get_fragment(static_cast<Distribution>(state.range(0)));
+  auto vertices = get_vertices(fragment, state.range(1));
+  size_t edges = 0;
+  for (auto _ : state) {
+    vid_t sum = 0;
+    for (auto const& v : vertices) {
+      auto oe = fragment->GetOutgoingAdjList(v, 0);
+      for (auto& e : oe) {
+        sum += e.neighbor().GetValue();
+      }
+      edges += oe.Size();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(edges);
+}
+
+void BM_EdgeDataColumn(benchmark::State& state) {
+  auto fragment = get_fragment(static_cast<Distribution>(state.range(0)));
+  auto vertices = get_vertices(fragment, state.range(1));
+  if (!fragment->edge_property_type(0, 0)->Equals(arrow::float64())) {
+    state.SkipWithError("the weight of the edges is not a double");
+    return;
+  }
+  auto column = fragment->edge_data_column<double>(0, 0);
+  size_t edges = 0;
+  for (auto _ : state) {
+    double sum = 0;
+    for (auto const& v : vertices) {
+      auto oe = fragment->GetOutgoingRawAdjList(v, 0);
+      for (auto const& e : oe) {
+        sum += column[e];
+      }
+      edges += oe.Size();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(edges);
+}
+
+void BM_EdgeDataGetData(benchmark::State& state) {
+  auto fragment = get_fragment(static_cast<Distribution>(state.range(0)));
+  auto vertices = get_vertices(fragment, state.range(1));
+  if (!fragment->edge_property_type(0, 0)->Equals(arrow::float64())) {
+    state.SkipWithError("the weight of the edges is not a double");
+    return;
+  }
+  size_t edges = 0;
+  for (auto _ : state) {
+    double sum = 0;
+    for (auto const& v : vertices) {
+      auto oe = fragment->GetOutgoingAdjList(v, 0);
+      for (auto& e : oe) {
+        sum += e.get_data<double>(0);
+      }
+      edges += oe.Size();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(edges);
+}
+
+// the loop over the contiguous values of all edges, which is vectorized
+void BM_EdgeDataSpan(benchmark::State& state) {
+  auto fragment = get_fragment(static_cast<Distribution>(state.range(0)));
+  if (!fragment->edge_property_type(0, 0)->Equals(arrow::float64())) {
+    state.SkipWithError("the weight of the edges is not a double");
+    return;
+  }
+  auto column = fragment->edge_data_column<double>(0, 0);
+  const double* values = column.data();
+  size_t size = column.size();
+  for (auto _ : state) {
+    double sum = 0;
+    for (size_t i = 0; i < size; ++i) {
+      sum += values[i];
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * size);
+}
+
+void BM_Oid2Gid(benchmark::State& state) {
+  auto fragment = get_fragment(static_cast<Distribution>(state.range(0)));
+  std::vector<oid_t> oids;
+  for (auto const& v : get_vertices(fragment, state.range(1))) {
+    oids.emplace_back(fragment->GetId(v));
+  }
+  for (auto _ : state) {
+    vid_t sum = 0, gid = 0;
+    for (auto const& oid : oids) {
+      fragment->Oid2Gid(0, oid, gid);
+      sum += gid;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * oids.size());
+}
+
+void BM_Gid2Oid(benchmark::State& state) {
+  auto fragment = get_fragment(static_cast<Distribution>(state.range(0)));
+  std::vector<vid_t> gids;
+  for (auto const& v : get_vertices(fragment, state.range(1))) {
+    gids.emplace_back(fragment->GetInnerVertexGid(v));
+  }
+  for (auto _ : state) {
+    oid_t sum = 0;
+    for (auto const& gid : gids) {
+      sum += fragment->Gid2Oid(gid);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * gids.size());
+}
+
+void BM_VertexMapGetGid(benchmark::State& state) {
+  auto fragment = get_fragment(static_cast<Distribution>(state.range(0)));
+  auto vertex_map = fragment->GetVertexMap();
+  fid_t fid = fragment->fid();
+  std::vector<internal_oid_t> oids;
+  for (auto const& v : get_vertices(fragment, state.range(1))) {
+    oids.emplace_back(fragment->GetId(v));
+  }
+  for (auto _ : state) {
+    vid_t sum = 0, gid = 0;
+    for (auto const& oid : oids) {
+      vertex_map->GetGid(fid, 0, oid, gid);
+      sum += gid;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * oids.size());
+}
+
+void FragmentArguments(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"distribution", "order"});
+  for (int distribution : {0, 1}) {
+    for (int order : {0, 1}) {
+      b->Args({distribution, order});
+    }
+  }
+}
+
+BENCHMARK(BM_OutgoingAdjList)
+    ->Apply(FragmentArguments)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EdgeDataColumn)
+    ->Apply(FragmentArguments)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EdgeDataGetData)
+    ->Apply(FragmentArguments)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_EdgeDataSpan)
+    ->Apply(FragmentArguments)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Oid2Gid)->Apply(FragmentArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Gid2Oid)->Apply(FragmentArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_VertexMapGetGid)
+    ->Apply(FragmentArguments)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  grape::InitMPIComm();
+  int ret = RunBenchmarks(argc, argv, ipc_socket);
+  // the spawned vineyardd has exited, and the fragments are gone with it
+  if (std::getenv("VINEYARD_IPC_SOCKET") != nullptr) {
+    for (auto const& item : fragment_ids) {
+      VINEYARD_DISCARD(local_client().DelData(item.second, true, true));
+    }
+  }
+  grape::FinalizeMPIComm();
+  return ret;
+}
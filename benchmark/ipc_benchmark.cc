@@ -0,0 +1,188 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+#include "benchmark_utils.h"
+
+// Benchmarks for the IPC and BulkStore hot paths of vineyardd.
+//
+// Usage:
+//
+//    VINEYARD_IPC_SOCKET=/var/run/vineyard.sock ./ipc_benchmark
+//
+// A vineyardd with local metadata is spawned from the build tree when
+// VINEYARD_IPC_SOCKET is not set. Each benchmark thread uses its own
+// connection.
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+namespace {
+
+std::string ipc_socket;
+
+/**
+ * @brief The connection of the calling thread, the connections live until
+ * the benchmark threads exit.
+ */
+Client& local_client() {
+  static thread_local Client client;
+  if (!client.Connected()) {
+    VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  }
+  return client;
+}
+
+#define BENCHMARK_CHECK_OK(state, status)           \
+  do {                                              \
+    auto _ret = (status);                           \
+    if (!_ret.ok()) {                               \
+      state.SkipWithError(_ret.ToString().c_str()); \
+      return;                                       \
+    }                                               \
+  } while (0)
+
+Status create_blobs(Client& client, size_t size, size_t count,
+                    std::vector<ObjectID>& blobs) {
+  for (size_t i = 0; i < count; ++i) {
+    std::unique_ptr<BlobWriter> writer;
+    RETURN_ON_ERROR(client.CreateBlob(size, writer));
+    blobs.emplace_back(writer->Seal(client)->id());
+  }
+  return Status::OK();
+}
+
+// keeps the batch of unreleased blobs of a thread below this many bytes
+constexpr size_t kMaxPendingBytes = 256 << 20;
+
+void BM_CreateAndSealBlob(benchmark::State& state) {
+  Client& client = local_client();
+  size_t size = state.range(0);
+  std::vector<ObjectID> blobs;
+  for (auto _ : state) {
+    std::unique_ptr<BlobWriter> writer;
+    BENCHMARK_CHECK_OK(state, client.CreateBlob(size, writer));
+    blobs.emplace_back(writer->Seal(client)->id());
+    if (blobs.size() * size >= kMaxPendingBytes) {
+      state.PauseTiming();
+      BENCHMARK_CHECK_OK(state, client.DelData(blobs));
+      blobs.clear();
+      state.ResumeTiming();
+    }
+  }
+  BENCHMARK_CHECK_OK(state, client.DelData(blobs));
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+void BM_GetBuffers(benchmark::State& state) {
+  Client& client = local_client();
+  size_t size = state.range(0), count = state.range(1);
+  std::vector<ObjectID> blobs;
+  BENCHMARK_CHECK_OK(state, create_blobs(client, size, count, blobs));
+  std::set<ObjectID> ids(blobs.begin(), blobs.end());
+  for (auto _ : state) {
+    std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
+    BENCHMARK_CHECK_OK(state, client.GetBuffers(ids, buffers));
+    benchmark::DoNotOptimize(buffers);
+  }
+  BENCHMARK_CHECK_OK(state, client.DelData(blobs));
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+void BM_GetMetaData(benchmark::State& state) {
+  Client& client = local_client();
+  size_t count = state.range(0);
+  std::vector<ObjectID> blobs;
+  BENCHMARK_CHECK_OK(state, create_blobs(client, 64, count, blobs));
+  ObjectMeta meta;
+  meta.SetTypeName("vineyard::Benchmark");
+  for (size_t i = 0; i < count; ++i) {
+    meta.AddMember("blob_" + std::to_string(i), blobs[i]);
+  }
+  ObjectID id = InvalidObjectID();
+  BENCHMARK_CHECK_OK(state, client.CreateMetaData(meta, id));
+  for (auto _ : state) {
+    ObjectMeta result;
+    BENCHMARK_CHECK_OK(state, client.GetMetaData(id, result));
+    benchmark::DoNotOptimize(result);
+  }
+  BENCHMARK_CHECK_OK(state, client.DelData(id, true, true));
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_Persist(benchmark::State& state) {
+  Client& client = local_client();
+  std::vector<ObjectID> objects;
+  for (auto _ : state) {
+    state.PauseTiming();
+    ObjectMeta meta;
+    meta.SetTypeName("vineyard::Benchmark");
+    meta.AddKeyValue("index", std::to_string(objects.size()));
+    ObjectID id = InvalidObjectID();
+    BENCHMARK_CHECK_OK(state, client.CreateMetaData(meta, id));
+    objects.emplace_back(id);
+    state.ResumeTiming();
+    BENCHMARK_CHECK_OK(state, client.Persist(id));
+  }
+  BENCHMARK_CHECK_OK(state, client.DelData(objects, true, true));
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_DelData(benchmark::State& state) {
+  Client& client = local_client();
+  size_t size = state.range(0);
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<ObjectID> blobs;
+    BENCHMARK_CHECK_OK(state, create_blobs(client, size, 1, blobs));
+    state.ResumeTiming();
+    BENCHMARK_CHECK_OK(state, client.DelData(blobs[0]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_CreateAndSealBlob)
+    ->RangeMultiplier(16)
+    ->Range(64, 16 << 20)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+BENCHMARK(BM_GetBuffers)
+    ->Ranges({{64, 1 << 20}, {1, 256}})
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+BENCHMARK(BM_GetMetaData)->Range(1, 1024)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_Persist)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_DelData)
+    ->RangeMultiplier(16)
+    ->Range(64, 16 << 20)
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  return RunBenchmarks(argc, argv, ipc_socket);
+}
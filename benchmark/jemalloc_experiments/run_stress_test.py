@@ -0,0 +1,145 @@
+#!/usr/bin/env python3
+#
+# Replays the allocation distributions against each allocator, and reports the
+# throughput, the RSS and the internal fragmentation, e.g.,
+#
+#   make vineyard_benchmarks
+#   ./run_stress_test.py --bin-dir ../../build/bin --threads 1,4
+#
+# The stress_test_vineyard_* allocators allocate from the shared memory of a
+# running vineyardd, specified by the VINEYARD_IPC_SOCKET environment variable.
+#
+# The internal fragmentation is reported by summarize-internal-frag.py, for the
+# allocators backed by jemalloc, whose prof stats are available, i.e., jemalloc
+# is built with "--enable-prof" and run with MALLOC_CONF="prof:true,...".
+
+import argparse
+import glob
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+here = os.path.dirname(os.path.abspath(__file__))
+
+
+def internal_fragmentation(stats_file):
+    ''' Sums up the live fragmentation of all size classes. '''
+    script = os.path.join(here, 'summarize-internal-frag.py')
+    result = subprocess.run(
+        [sys.executable, script, stats_file],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.DEVNULL,
+        universal_newlines=True,
+    )
+    if result.returncode != 0:
+        return None, ''
+    total, frag = 0, 0
+    for line in result.stdout.splitlines()[1:]:
+        fields = line.split()
+        total += int(fields[2])
+        frag += int(fields[6])
+    return (frag / total if total else 0.0), result.stdout
+
+
+def run(binary, distribution, threads, args):
+    with tempfile.TemporaryDirectory() as workdir:
+        stats_file = os.path.join(workdir, 'stats.json')
+        command = [
+            binary,
+            '--distribution_file=%s' % distribution,
+            '--num_threads=%d' % threads,
+            '--malloc_stats_file=%s' % stats_file,
+        ] + args
+        result = subprocess.run(
+            command, stdout=subprocess.PIPE, universal_newlines=True, check=True
+        )
+        summary = json.loads(result.stdout.strip().splitlines()[-1])
+        summary['internal_frag'] = None
+        if summary['malloc_stats_file']:
+            frag, report = internal_fragmentation(stats_file)
+            summary['internal_frag'] = frag
+            summary['internal_frag_report'] = report
+        del summary['malloc_stats_file']
+        return summary
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Replay the allocation distributions against the allocators'
+    )
+    parser.add_argument(
+        '--bin-dir', required=True, help='where the stress_test_* are built'
+    )
+    parser.add_argument(
+        '--allocators',
+        default='',
+        help='comma separated allocators, e.g., system,bulk_dlmalloc, '
+        'defaults to all that have been built',
+    )
+    parser.add_argument(
+        '--distributions',
+        default='',
+        help='comma separated distribution files, defaults to all in '
+        'stress_test/distributions',
+    )
+    parser.add_argument('--threads', default='1', help='comma separated')
+    parser.add_argument('--output', default='', help='write the results as JSON')
+    args, extra_args = parser.parse_known_args()
+
+    if args.allocators:
+        binaries = [
+            os.path.join(args.bin_dir, 'stress_test_%s' % name)
+            for name in args.allocators.split(',')
+        ]
+    else:
+        binaries = sorted(glob.glob(os.path.join(args.bin_dir, 'stress_test_*')))
+    if args.distributions:
+        distributions = args.distributions.split(',')
+    else:
+        distributions = sorted(
+            glob.glob(os.path.join(here, 'stress_test', 'distributions', '*.txt'))
+        )
+    threads = [int(t) for t in args.threads.split(',')]
+
+    results = []
+    print(
+        '%-16s %-12s %8s %10s %14s %12s %12s %14s'
+        % (
+            'allocator',
+            'distribution',
+            'threads',
+            'seconds',
+            'allocs/s',
+            'MB/s',
+            'peak_rss_MB',
+            'internal_frag',
+        )
+    )
+    for distribution in distributions:
+        for binary in binaries:
+            for t in threads:
+                r = run(binary, distribution, t, extra_args)
+                results.append(r)
+                frag = r['internal_frag']
+                print(
+                    '%-16s %-12s %8d %10.3f %14.0f %12.1f %12.1f %14s'
+                    % (
+                        r['allocator'],
+                        os.path.splitext(os.path.basename(distribution))[0],
+                        t,
+                        r['seconds'],
+                        r['allocations_per_second'],
+                        r['bytes_per_second'] / 1e6,
+                        r['peak_rss'] / 1e6,
+                        'n/a' if frag is None else '%.4f' % frag,
+                    )
+                )
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(results, f, indent=2)
+
+
+if __name__ == '__main__':
+    main()
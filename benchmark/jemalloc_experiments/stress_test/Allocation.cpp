@@ -1,6 +1,5 @@
 #include "Allocation.h"
 
-#include "jemalloc/include/jemalloc/jemalloc.h"
 
 bool Allocation::operator<(const Allocation &that) const {
   return this->freeAfterAbsolute < that.freeAfterAbsolute;
@@ -17,17 +16,7 @@ Allocation::Allocation(std::vector<void *> toFree, int freeAfterArg)
 
 void Allocation::clear() const {
   for (auto &ptr : this->toFree_) {
-#if defined(BENCH_SYSTEM)
-    free(ptr);
-#elif defined(BENCH_JEMALLOC)
-    vineyard_je_free(ptr);
-#elif defined(BENCH_VINEYARD)
-    vineyard_free(ptr);
-#elif defined(BENCH_ARENA)
-    vineyard_arena_free(ptr);
-#else
-    free(ptr);
-#endif
+    benchFree(ptr);
   }
 }
 
@@ -1,15 +1,10 @@
 #include <vector>
 
-#include "malloc/allocator.h"
 #include "common/util/logging.h"
 
-// simple wrapper that pairs a group of allocated blocks with a lifetime
-
-// #define BENCH_VINEYARD
-// #define BENCH_JEMALLOC
-// #define BENCH_SYSTEM
-#define BENCH_ARENA
+#include "Backend.h"
 
+// simple wrapper that pairs a group of allocated blocks with a lifetime
 class Allocation {
 public:
   // sorts based on [freeAfterAbsolute] field
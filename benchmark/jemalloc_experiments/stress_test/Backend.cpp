@@ -0,0 +1,125 @@
+#include "Backend.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <mutex>
+#include <unordered_map>
+
+#include <gflags/gflags.h>
+
+#include "common/util/logging.h"
+
+#include "SizeConstants.h"
+
+#if defined(BENCH_JEMALLOC) || (defined(BENCH_BULK) && defined(WITH_JEMALLOC))
+#define BENCH_WITH_JEMALLOC_STATS
+#include "jemalloc/include/jemalloc/jemalloc.h"
+#endif
+
+#if defined(BENCH_VINEYARD) || defined(BENCH_ARENA)
+#include "malloc/allocator.h"
+#endif
+
+#if defined(BENCH_BULK)
+#include "server/memory/allocator.h"
+#include "server/memory/malloc.h"
+
+DEFINE_int64(bulk_size, 8 * k1GB,
+             "size of the shared memory managed by the bulk allocator");
+
+namespace {
+// the bulk allocator is not thread-safe, and is serialized by the BulkStore
+// in vineyardd as well, which also remembers the size of every blob
+std::mutex bulkMutex;
+std::unordered_map<void *, size_t> bulkSizes;
+} // namespace
+#endif
+
+void benchInit() {
+#if defined(BENCH_BULK)
+  vineyard::BulkAllocator::SetFootprintLimit(FLAGS_bulk_size);
+  if (vineyard::BulkAllocator::Init(FLAGS_bulk_size) == nullptr) {
+    LOG(FATAL) << "Failed to initialize the bulk allocator with "
+               << FLAGS_bulk_size << " bytes";
+  }
+#endif
+}
+
+const char *benchName() {
+#if defined(BENCH_JEMALLOC)
+  return "jemalloc";
+#elif defined(BENCH_VINEYARD)
+  return "vineyard_malloc";
+#elif defined(BENCH_ARENA)
+  return "vineyard_arena";
+#elif defined(BENCH_BULK) && defined(WITH_DLMALLOC)
+  return "bulk_dlmalloc";
+#elif defined(BENCH_BULK) && defined(WITH_JEMALLOC)
+  return "bulk_jemalloc";
+#else
+  return "system";
+#endif
+}
+
+void *benchMalloc(size_t sz) {
+#if defined(BENCH_JEMALLOC)
+  return vineyard_je_mallocx(sz, MALLOCX_TCACHE_NONE);
+#elif defined(BENCH_VINEYARD)
+  return vineyard_malloc(sz);
+#elif defined(BENCH_ARENA)
+  return vineyard_arena_malloc(sz);
+#elif defined(BENCH_BULK)
+  std::lock_guard<std::mutex> guard(bulkMutex);
+  void *r = vineyard::BulkAllocator::Memalign(sz, vineyard::memory::kBlockSize);
+  if (r != nullptr) {
+    bulkSizes.emplace(r, sz);
+  }
+  return r;
+#else
+  return malloc(sz);
+#endif
+}
+
+void benchFree(void *ptr) {
+#if defined(BENCH_JEMALLOC)
+  vineyard_je_free(ptr);
+#elif defined(BENCH_VINEYARD)
+  vineyard_free(ptr);
+#elif defined(BENCH_ARENA)
+  vineyard_arena_free(ptr);
+#elif defined(BENCH_BULK)
+  std::lock_guard<std::mutex> guard(bulkMutex);
+  auto iter = bulkSizes.find(ptr);
+  if (iter != bulkSizes.end()) {
+    vineyard::BulkAllocator::Free(ptr, iter->second);
+    bulkSizes.erase(iter);
+  }
+#else
+  free(ptr);
+#endif
+}
+
+void benchThreadCleanup() {
+#if defined(BENCH_WITH_JEMALLOC_STATS)
+  if (vineyard_je_mallctl("thread.tcache.flush", NULL, NULL, NULL, 0)) {
+    LOG(ERROR) << "je_mallctl failed to flush the tcache";
+  }
+#endif
+}
+
+#if defined(BENCH_WITH_JEMALLOC_STATS)
+static void writeStats(void *opaque, const char *s) {
+  fputs(s, static_cast<FILE *>(opaque));
+}
+#endif
+
+bool benchPrintStats(FILE *file, bool json) {
+#if defined(BENCH_WITH_JEMALLOC_STATS)
+  benchThreadCleanup();
+  vineyard_je_malloc_stats_print(writeStats, file, json ? "J" : "");
+  return true;
+#else
+  return false;
+#endif
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+
+/* The allocator under test, chosen at compile time by one of
+ *
+ *  - BENCH_SYSTEM: malloc() of libc (the default)
+ *  - BENCH_JEMALLOC: the jemalloc bundled by vineyard
+ *  - BENCH_VINEYARD: vineyard_malloc(), i.e., the client-side allocator on
+ *    the shared memory of vineyardd (VINEYARD_IPC_SOCKET)
+ *  - BENCH_ARENA: vineyard_arena_malloc()
+ *  - BENCH_BULK: the BulkAllocator of vineyardd, with either WITH_DLMALLOC or
+ *    WITH_JEMALLOC */
+
+// initialize the allocator, before any allocation
+void benchInit();
+
+// the name of the allocator under test
+const char *benchName();
+
+void *benchMalloc(size_t sz);
+
+void benchFree(void *ptr);
+
+// called by each thread after it finished simulating
+void benchThreadCleanup();
+
+/* Write the allocator stats of malloc_stats_print() to [file], the JSON output
+ * can be fed to summarize.py and summarize-internal-frag.py. Returns false if
+ * the allocator is not backed by jemalloc. */
+bool benchPrintStats(FILE *file, bool json);
@@ -1,17 +1,25 @@
 #include <chrono>
+#include <cstdio>
 #include <iostream>
 #include <string>
 #include <thread>
 #include <vector>
 
 #include <gflags/gflags.h>
-#include "jemalloc/include/jemalloc/jemalloc.h"
+
+#include "common/util/env.h"
+#include "common/util/json.h"
+
+#include "Backend.h"
 #include "Distribution.h"
 #include "Mixer.h"
 
 
 DEFINE_int32(num_threads, 1, "number of threads to run");
 DEFINE_bool(print_malloc_stats, false, "print out malloc stats after running");
+DEFINE_string(malloc_stats_file, "",
+              "write the jemalloc stats in JSON to this file after running, "
+              "for summarize-internal-frag.py");
 DEFINE_string(distribution_file, "", "path to distribution file");
 static bool validateDistributionFile(const char *flagName,
                                      const std::string &val) {
@@ -28,7 +36,7 @@ void createAndRunMixer(const Distribution *distr, int me,
   m.run();
 }
 
-double run() {
+double run(size_t &allocatedBytes, size_t &allocations) {
   initInstBurner();
   Distribution distr = parseDistribution(FLAGS_distribution_file.c_str());
 
@@ -54,6 +62,8 @@ double run() {
 
   // Cleanup any remaining memory
   for (auto &t : threadObjects) {
+    allocatedBytes += t->allocatedBytes();
+    allocations += t->allocations();
     t->freeIgnoreLifetime();
   }
   high_resolution_clock::time_point endTime = high_resolution_clock::now();
@@ -64,14 +74,38 @@ double run() {
 
 int main(int argc, char **argv) {
   gflags::ParseCommandLineFlags(&argc, &argv, true);
-  double time = run();
+  benchInit();
+  size_t allocatedBytes = 0, allocations = 0;
+  double time = run(allocatedBytes, allocations);
 
-  if (FLAGS_print_malloc_stats) {
-    if (vineyard_je_mallctl("thread.tcache.flush", NULL, NULL, NULL, 0)) {
-      LOG(INFO) << "je_mallctl failed. Exiting...";
+  if (FLAGS_print_malloc_stats && !benchPrintStats(stderr, false)) {
+    LOG(INFO) << "malloc stats are not available for " << benchName();
+  }
+  bool hasStats = false;
+  if (!FLAGS_malloc_stats_file.empty()) {
+    FILE *file = fopen(FLAGS_malloc_stats_file.c_str(), "w");
+    if (file == nullptr) {
+      LOG(ERROR) << "Failed to open " << FLAGS_malloc_stats_file;
+    } else {
+      hasStats = benchPrintStats(file, true);
+      fclose(file);
     }
-      vineyard_je_malloc_stats_print(NULL, NULL, NULL);
   }
 
   LOG(INFO) << "Elapsed time: " << time;
+
+  // a single line of summary for the drivers, e.g., run_stress_test.py
+  vineyard::json summary = {
+      {"allocator", benchName()},
+      {"distribution", FLAGS_distribution_file},
+      {"threads", FLAGS_num_threads},
+      {"seconds", time},
+      {"allocations", allocations},
+      {"allocated_bytes", allocatedBytes},
+      {"allocations_per_second", allocations / time},
+      {"bytes_per_second", allocatedBytes / time},
+      {"rss", vineyard::get_rss()},
+      {"peak_rss", vineyard::get_peek_rss()},
+      {"malloc_stats_file", hasStats ? FLAGS_malloc_stats_file : ""}};
+  std::cout << summary.dump() << std::endl;
 }
@@ -6,7 +6,6 @@
 
 #include <assert.h>
 #include <gflags/gflags.h>
-#include "jemalloc/include/jemalloc/jemalloc.h"
 #include <stdlib.h>
 #include <sys/mman.h>
 
@@ -219,8 +218,6 @@ void Mixer::run() {
 
     burnInstCache(kMaxInstCacheSize);
   }
-  if (vineyard_je_mallctl("thread.tcache.flush", NULL, NULL, NULL, 0)) {
-    std::cout << "je_mallctl failed. Exiting..." << std::endl;
-  }
+  benchThreadCleanup();
   // Main loop will cleanup memory after all threads are done
 }
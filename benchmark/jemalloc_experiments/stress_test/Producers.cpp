@@ -3,7 +3,6 @@
 #include <iostream>
 #include <stdlib.h>
 #include <string.h>
-#include "jemalloc/include/jemalloc/jemalloc.h"
 
 void *allocateAndUse(ThreadObject &myThread, size_t &memUsed, size_t sz) {
   void *ptr = myThread.allocate(sz);
@@ -36,17 +35,7 @@ Allocation SimpleProducer::run(ThreadObject &myThread, size_t memUsageHint,
       return Allocation();
     }
     this->allocsLeft_ -= 1;
-#if defined(BENCH_SYSTEM)
-    free(ptr);
-#elif defined(BENCH_JEMALLOC)
-    vineyard_je_free(ptr);
-#elif defined(BENCH_VINEYARD)
-    vineyard_free(ptr);
-#elif defined(BENCH_ARENA)
-    vineyard_arena_free(ptr);
-#else
-    free(ptr);
-#endif
+    benchFree(ptr);
   }
 }
 
@@ -81,17 +70,7 @@ Allocation VectorProducer::run(ThreadObject &myThread, size_t memUsageHint,
       return Allocation();
     }
 
-#if defined(BENCH_SYSTEM)
-    free(this->ptr_);
-#elif defined(BENCH_JEMALLOC)
-    vineyard_je_free(this->ptr_);
-#elif defined(BENCH_VINEYARD)
-    vineyard_free(this->ptr_);
-#elif defined(BENCH_ARENA)
-    vineyard_arena_free(this->ptr_);
-#else
-    free(this->ptr_);
-#endif
+    benchFree(this->ptr_);
     this->currentSize_ *= 2;
     this->ptr_ = allocateAndUse(myThread, memUsed, this->currentSize_);
     if (ptr_ == nullptr) {
@@ -103,17 +82,7 @@ Allocation VectorProducer::run(ThreadObject &myThread, size_t memUsageHint,
 
 void VectorProducer::cleanup() {
   if (this->ptr_ != nullptr) {
-#if defined(BENCH_SYSTEM)
-    free(this->ptr_);
-#elif defined(BENCH_JEMALLOC)
-    vineyard_je_free(this->ptr_);
-#elif defined(BENCH_VINEYARD)
-    vineyard_free(this->ptr_);
-#elif defined(BENCH_ARENA)
-    vineyard_arena_free(this->ptr_);
-#else
-    free(this->ptr_);
-#endif
+    benchFree(this->ptr_);
   }
 }
 
@@ -144,17 +113,7 @@ Allocation LinkedListProducer::run(ThreadObject &myThread, size_t memUsageHint,
 
 void LinkedListProducer::cleanup() {
   for (auto &ptr : this->toFree_) {
-#if defined(BENCH_SYSTEM)
-    free(ptr);
-#elif defined(BENCH_JEMALLOC)
-    vineyard_je_free(ptr);
-#elif defined(BENCH_VINEYARD)
-    vineyard_free(ptr);
-#elif defined(BENCH_ARENA)
-    vineyard_arena_free(ptr);
-#else
-    free(ptr);
-#endif
+    benchFree(ptr);
   }
 }
 
@@ -10,7 +10,6 @@
 #include <gflags/gflags.h>
 
 #include "SizeConstants.h"
-#include "jemalloc/include/jemalloc/jemalloc.h"
 
 // #define TCACHE_NONE
 // #define VINEYARD_MALLOC
@@ -51,18 +50,9 @@ void *ThreadObject::allocate(size_t sz) {
     return nullptr;
   } else {
     this->allocSoFar_ += sz;
+    this->allocCount_ += 1;
     assert(sz > 0);
-#if defined(BENCH_SYSTEM)
-    void *r = malloc(sz);
-#elif defined(BENCH_JEMALLOC)
-    void *r = vineyard_je_mallocx(sz, MALLOCX_TCACHE_NONE);
-#elif defined(BENCH_VINEYARD)
-    void *r = vineyard_malloc(sz);
-#elif defined(BENCH_ARENA)
-    void *r = vineyard_arena_malloc(sz);
-#else
-    void *r = malloc(sz);
-#endif
+    void *r = benchMalloc(sz);
     if (r == nullptr) {
       LOG(ERROR) << "Malloc failed.";
       exit(1);
@@ -79,4 +69,8 @@ int ThreadObject::maxPhase() const {
   return FLAGS_alloc_per_thread / FLAGS_bytes_per_phase;
 }
 
-ThreadObject::ThreadObject() : allocSoFar_(0) {}
+size_t ThreadObject::allocatedBytes() const { return this->allocSoFar_; }
+
+size_t ThreadObject::allocations() const { return this->allocCount_; }
+
+ThreadObject::ThreadObject() : allocSoFar_(0), allocCount_(0) {}
@@ -24,6 +24,9 @@ public:
   // the time that the simulation will stop (according to this thread's logical
   // clock)
   int maxPhase() const;
+  // the amount and the number of allocations done by this thread so far
+  size_t allocatedBytes() const;
+  size_t allocations() const;
 
   ThreadObject();
 
@@ -33,4 +36,5 @@ private:
                       std::greater<Allocation>>
       q_;
   size_t allocSoFar_;
+  size_t allocCount_;
 };
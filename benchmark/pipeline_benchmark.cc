@@ -0,0 +1,476 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "arrow/api.h"
+#include "boost/algorithm/string.hpp"
+#include "gflags/gflags.h"
+
+#include "basic/stream/dataframe_stream.h"
+#include "basic/stream/parallel_stream.h"
+#include "client/client.h"
+#include "common/util/flags.h"
+#include "common/util/functions.h"
+#include "common/util/json.h"
+#include "common/util/logging.h"
+#include "io/io/io_factory.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/fragment/arrow_fragment_group.h"
+#include "graph/loader/arrow_fragment_loader.h"
+
+#include "benchmark_utils.h"
+
+// An end-to-end benchmark of the pipeline that loads a graph from files into
+// vineyard and queries it, which reports the throughput and the latency of
+// each stage:
+//
+//  - ingest: the workers read and parse their parts of the CSV files;
+//  - stream: the tables are pushed, in batches, into a DataframeStream per
+//    worker and label, which are grouped into a ParallelStream per label;
+//  - fragment: the ArrowFragmentLoader builds the fragments from the streams
+//    while they are being written, thus it overlaps the stream stage;
+//  - traverse: the workers visit the outgoing edges of their fragments;
+//  - query: the workers answer two-hop queries of random inner vertices.
+//
+// Usage:
+//
+//    mpirun -n 2 ./pipeline_benchmark \
+//        --ipc_sockets=/tmp/vineyard.0.sock,/tmp/vineyard.1.sock \
+//        --report=/tmp/pipeline.json
+//
+// The i-th worker connects to the (i % n)-th of the n sockets, the vineyardd
+// instances are expected to share the etcd, and the workers their data
+// directory. The stages are timed by the slowest worker, the records and
+// bytes are summed over the workers, and the latency percentiles are those of
+// the slowest worker. See also `pipeline_benchmark.py`, which deploys the
+// vineyardd instances, runs the benchmark and reads the fragments from
+// Python.
+
+namespace vineyard {
+
+DEFINE_string(ipc_sockets, "/tmp/vineyard.sock",
+              "Comma separated IPC sockets of the vineyardd instances");
+DEFINE_string(data_dir, "/tmp/vineyard-pipeline-benchmark",
+              "Directory of the generated files, shared by the workers");
+DEFINE_int64(vertices, 1 << 20, "Number of vertices of the graph");
+DEFINE_int64(degree, 16, "Average number of edges per vertex");
+DEFINE_int32(distribution, 1, "Degree distribution, 0 uniform and 1 R-MAT");
+DEFINE_int64(batch_rows, 1 << 16, "Rows of the batches pushed to streams");
+DEFINE_int64(queries, 10000, "Number of two-hop queries of each worker");
+DEFINE_string(report, "", "Write the report in JSON into the file");
+DEFINE_bool(keep_objects, false,
+            "Keep the fragment group for the readers after the benchmark");
+
+}  // namespace vineyard
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+namespace {
+
+using GraphType = ArrowFragment<property_graph_types::OID_TYPE,
+                                property_graph_types::VID_TYPE>;
+using vid_t = GraphType::vid_t;
+using vertex_t = GraphType::vertex_t;
+
+struct StageMetrics {
+  std::string name;
+  double seconds = 0;
+  int64_t records = 0;
+  int64_t bytes = 0;
+  // in milliseconds, of the batches or of the queries
+  std::vector<double> latencies;
+};
+
+int64_t buffer_bytes(std::shared_ptr<arrow::ArrayData> const& data) {
+  int64_t bytes = 0;
+  for (auto const& buffer : data->buffers) {
+    if (buffer != nullptr) {
+      bytes += buffer->size();
+    }
+  }
+  for (auto const& child : data->child_data) {
+    bytes += buffer_bytes(child);
+  }
+  return bytes;
+}
+
+int64_t batch_bytes(std::shared_ptr<arrow::RecordBatch> const& batch) {
+  int64_t bytes = 0;
+  for (int i = 0; i < batch->num_columns(); ++i) {
+    bytes += buffer_bytes(batch->column_data(i));
+  }
+  return bytes;
+}
+
+int64_t table_bytes(std::shared_ptr<arrow::Table> const& table) {
+  int64_t bytes = 0;
+  for (auto const& column : table->columns()) {
+    for (auto const& chunk : column->chunks()) {
+      bytes += buffer_bytes(chunk->data());
+    }
+  }
+  return bytes;
+}
+
+double percentile(std::vector<double> values, double const p) {
+  if (values.empty()) {
+    return 0;
+  }
+  std::sort(values.begin(), values.end());
+  size_t index = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+  return values[std::min(index, values.size() - 1)];
+}
+
+template <typename T>
+T all_reduce(grape::CommSpec const& comm_spec, T value, MPI_Op const op) {
+  MPI_Datatype type =
+      std::is_same<T, double>::value ? MPI_DOUBLE : MPI_INT64_T;
+  T result = value;
+  MPI_Allreduce(&value, &result, 1, type, op, comm_spec.comm());
+  return result;
+}
+
+/**
+ * @brief Summarize the metrics of the stage over the workers, which is a
+ * collective operation.
+ */
+json summarize(grape::CommSpec const& comm_spec, StageMetrics const& stage) {
+  double seconds = all_reduce(comm_spec, stage.seconds, MPI_MAX);
+  int64_t records = all_reduce(comm_spec, stage.records, MPI_SUM);
+  int64_t bytes = all_reduce(comm_spec, stage.bytes, MPI_SUM);
+  double p50 = all_reduce(comm_spec, percentile(stage.latencies, 0.5), MPI_MAX);
+  double p99 =
+      all_reduce(comm_spec, percentile(stage.latencies, 0.99), MPI_MAX);
+  json summary;
+  summary["stage"] = stage.name;
+  summary["seconds"] = seconds;
+  summary["records"] = records;
+  summary["bytes"] = bytes;
+  summary["records_per_second"] = seconds > 0 ? records / seconds : 0;
+  summary["bytes_per_second"] = seconds > 0 ? bytes / seconds : 0;
+  summary["p50_ms"] = p50;
+  summary["p99_ms"] = p99;
+  return summary;
+}
+
+/**
+ * @brief Read the part of the worker of the file, with the label attached to
+ * the metadata of the schema, where the loader finds the labels of the
+ * batches from the streams.
+ */
+Status ingest(std::string const& file, grape::CommSpec const& comm_spec,
+              std::vector<std::string> const& keys,
+              std::vector<std::string> const& values,
+              std::shared_ptr<arrow::Table>& table) {
+  auto io_adaptor = IOFactory::CreateIOAdaptor(file + "#header_row=true");
+  if (io_adaptor == nullptr) {
+    return Status::IOError("Failed to open " + file);
+  }
+  RETURN_ON_ERROR(io_adaptor->SetPartialRead(comm_spec.worker_id(),
+                                             comm_spec.worker_num()));
+  RETURN_ON_ERROR(io_adaptor->Open());
+  RETURN_ON_ERROR(io_adaptor->ReadTable(&table));
+  RETURN_ON_ERROR(io_adaptor->Close());
+  table = table->ReplaceSchemaMetadata(arrow::key_value_metadata(keys, values));
+  return Status::OK();
+}
+
+/**
+ * @brief Create a stream at each worker, and group the streams of all
+ * workers into a parallel stream, which is a collective operation.
+ */
+Status create_streams(Client& client, grape::CommSpec const& comm_spec,
+                      ObjectID& stream_id, ObjectID& pstream_id) {
+  DataframeStreamBuilder builder(client);
+  auto stream = builder.Seal(client);
+  RETURN_ON_ERROR(client.Persist(stream->id()));
+  stream_id = stream->id();
+
+  std::vector<ObjectID> stream_ids(comm_spec.worker_num());
+  MPI_Allgather(&stream_id, sizeof(ObjectID), MPI_CHAR, stream_ids.data(),
+                sizeof(ObjectID), MPI_CHAR, comm_spec.comm());
+  if (comm_spec.worker_id() == 0) {
+    ParallelStreamBuilder pbuilder(client);
+    for (auto const& id : stream_ids) {
+      pbuilder.AddStream(id);
+    }
+    pstream_id = pbuilder.Seal(client)->id();
+  }
+  MPI_Bcast(&pstream_id, sizeof(ObjectID), MPI_CHAR, 0, comm_spec.comm());
+
+  // wait until the global stream has been synced from the etcd
+  ObjectMeta meta;
+  return client.GetMetaData(pstream_id, meta, true);
+}
+
+/**
+ * @brief Push the table into the stream in batches, the latency of each
+ * batch, i.e., of sealing the batch in vineyard and pushing it to the
+ * stream, is recorded.
+ */
+Status push(Client& client, ObjectID const stream_id,
+            std::shared_ptr<arrow::Table> const& table, StageMetrics& stage) {
+  auto stream = client.GetObject<DataframeStream>(stream_id);
+  RETURN_ON_ASSERT(stream != nullptr, "The stream is not a DataframeStream");
+  std::unique_ptr<DataframeStreamWriter> writer;
+  RETURN_ON_ERROR(stream->OpenWriter(client, writer));
+  arrow::TableBatchReader reader(*table);
+  reader.set_chunksize(FLAGS_batch_rows);
+  std::shared_ptr<arrow::RecordBatch> batch;
+  while (reader.ReadNext(&batch).ok() && batch != nullptr) {
+    double t = -GetCurrentTime();
+    RETURN_ON_ERROR(writer->WriteBatch(batch));
+    t += GetCurrentTime();
+    stage.latencies.emplace_back(t * 1000);
+    stage.records += batch->num_rows();
+    stage.bytes += batch_bytes(batch);
+  }
+  return writer->Finish();
+}
+
+ObjectID load_fragment_group(Client& client, grape::CommSpec const& comm_spec,
+                             ObjectID const vstream, ObjectID const estream) {
+  auto loader =
+      std::make_unique<ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                           property_graph_types::VID_TYPE>>(
+          client, comm_spec, std::vector<ObjectID>{vstream},
+          std::vector<std::vector<ObjectID>>{{estream}}, true);
+  return boost::leaf::try_handle_all(
+      [&loader]() { return loader->LoadFragmentAsFragmentGroup(); },
+      [](const GSError& e) {
+        LOG(FATAL) << e.error_msg;
+        return InvalidObjectID();
+      },
+      [](const boost::leaf::error_info& unmatched) {
+        LOG(FATAL) << "Unmatched error " << unmatched;
+        return InvalidObjectID();
+      });
+}
+
+/**
+ * @brief Traverse the outgoing edges of all inner vertices, the records are
+ * the edges.
+ */
+void scan(std::shared_ptr<GraphType> const& fragment, StageMetrics& stage) {
+  double t = -GetCurrentTime();
+  vid_t sum = 0;
+  for (auto v : fragment->InnerVertices(0)) {
+    auto oe = fragment->GetOutgoingAdjList(v, 0);
+    for (auto& e : oe) {
+      sum += e.neighbor().GetValue();
+    }
+    stage.records += oe.Size();
+  }
+  t += GetCurrentTime();
+  stage.seconds = t;
+  stage.bytes = stage.records * sizeof(vid_t);
+  VLOG(100) << "checksum of the traversal: " << sum;
+}
+
+/**
+ * @brief Count the edges within two hops of random inner vertices, where the
+ * second hop expands the inner neighbors only, the records are the queries.
+ */
+void query(std::shared_ptr<GraphType> const& fragment, int64_t const seed,
+           StageMetrics& stage) {
+  std::vector<vertex_t> vertices;
+  for (auto v : fragment->InnerVertices(0)) {
+    vertices.emplace_back(v);
+  }
+  if (vertices.empty()) {
+    return;
+  }
+  std::mt19937_64 rng(seed);
+  int64_t edges = 0;
+  double t = -GetCurrentTime();
+  for (int64_t i = 0; i < FLAGS_queries; ++i) {
+    double latency = -GetCurrentTime();
+    auto const& v = vertices[rng() % vertices.size()];
+    auto oe = fragment->GetOutgoingAdjList(v, 0);
+    int64_t reached = oe.Size();
+    for (auto& e : oe) {
+      auto u = e.neighbor();
+      if (fragment->IsInnerVertex(u)) {
+        reached += fragment->GetOutgoingAdjList(u, 0).Size();
+      }
+    }
+    edges += reached;
+    latency += GetCurrentTime();
+    stage.latencies.emplace_back(latency * 1000);
+  }
+  t += GetCurrentTime();
+  stage.seconds = t;
+  stage.records = FLAGS_queries;
+  stage.bytes = edges * sizeof(vid_t);
+}
+
+Status RunPipeline(grape::CommSpec const& comm_spec) {
+  std::vector<std::string> sockets;
+  boost::split(sockets, FLAGS_ipc_sockets, boost::is_any_of(","));
+  Client client;
+  RETURN_ON_ERROR(
+      client.Connect(sockets[comm_spec.worker_id() % sockets.size()]));
+
+  std::string directory = FLAGS_data_dir;
+  if (comm_spec.worker_id() == 0) {
+    PCHECK(mkdir(directory.c_str(), 0755) == 0 || errno == EEXIST);
+    double t = -GetCurrentTime();
+    GenerateGraph(directory, FLAGS_vertices, FLAGS_degree,
+                  static_cast<Distribution>(FLAGS_distribution));
+    t += GetCurrentTime();
+    LOG(INFO) << "generated the graph in " << t << " seconds";
+  }
+  MPI_Barrier(comm_spec.comm());
+  double total = -GetCurrentTime();
+
+  StageMetrics ingest_stage{"ingest"};
+  std::shared_ptr<arrow::Table> vtable, etable;
+  {
+    double t = -GetCurrentTime();
+    RETURN_ON_ERROR(ingest(directory + "/person.csv", comm_spec, {"label"},
+                           {"person"}, vtable));
+    RETURN_ON_ERROR(ingest(directory + "/knows.csv", comm_spec,
+                           {"label", "src_label", "dst_label"},
+                           {"knows", "person", "person"}, etable));
+    t += GetCurrentTime();
+    ingest_stage.seconds = t;
+    ingest_stage.records = vtable->num_rows() + etable->num_rows();
+    ingest_stage.bytes = table_bytes(vtable) + table_bytes(etable);
+  }
+
+  ObjectID vstream, estream, vpstream = InvalidObjectID(),
+                             epstream = InvalidObjectID();
+  RETURN_ON_ERROR(create_streams(client, comm_spec, vstream, vpstream));
+  RETURN_ON_ERROR(create_streams(client, comm_spec, estream, epstream));
+  MPI_Barrier(comm_spec.comm());
+
+  // the streams are written with another client, as the writers may block
+  // while the loader reads with `client`
+  StageMetrics stream_stage{"stream"};
+  Status push_status;
+  std::thread producer([&]() {
+    Client writer_client;
+    push_status = writer_client.Connect(client.IPCSocket());
+    double t = -GetCurrentTime();
+    if (push_status.ok()) {
+      push_status = push(writer_client, vstream, vtable, stream_stage);
+    }
+    if (push_status.ok()) {
+      push_status = push(writer_client, estream, etable, stream_stage);
+    }
+    t += GetCurrentTime();
+    stream_stage.seconds = t;
+  });
+
+  StageMetrics fragment_stage{"fragment"};
+  double t = -GetCurrentTime();
+  ObjectID group_id =
+      load_fragment_group(client, comm_spec, vpstream, epstream);
+  t += GetCurrentTime();
+  producer.join();
+  RETURN_ON_ERROR(push_status);
+  fragment_stage.seconds = t;
+  fragment_stage.records = stream_stage.records;
+  fragment_stage.bytes = stream_stage.bytes;
+
+  auto group = client.GetObject<ArrowFragmentGroup>(group_id);
+  RETURN_ON_ASSERT(group != nullptr, "The fragment group is not available");
+  auto fragment = client.GetObject<GraphType>(
+      group->Fragments().at(comm_spec.fid()));
+  RETURN_ON_ASSERT(fragment != nullptr, "The fragment is not available");
+  StageMetrics scan_stage{"traverse"}, query_stage{"query"};
+  scan(fragment, scan_stage);
+  query(fragment, comm_spec.worker_id(), query_stage);
+  total += GetCurrentTime();
+
+  json report;
+  report["workers"] = comm_spec.worker_num();
+  report["instances"] = sockets.size();
+  report["vertices"] = FLAGS_vertices;
+  report["edges"] = FLAGS_vertices * FLAGS_degree;
+  report["fragment_group"] = ObjectIDToString(group_id);
+  report["total_seconds"] = all_reduce(comm_spec, total, MPI_MAX);
+  report["stages"] = json::array();
+  for (auto const& stage :
+       {ingest_stage, stream_stage, fragment_stage, scan_stage, query_stage}) {
+    report["stages"].push_back(summarize(comm_spec, stage));
+  }
+
+  if (comm_spec.worker_id() == 0) {
+    std::cout << report.dump(2) << std::endl;
+    if (!FLAGS_report.empty()) {
+      std::ofstream(FLAGS_report) << report.dump(2) << std::endl;
+    }
+    unlink((directory + "/person.csv").c_str());
+    unlink((directory + "/knows.csv").c_str());
+    rmdir(directory.c_str());
+  }
+
+  // the parallel streams go first, then the streams of each worker
+  if (comm_spec.worker_id() == 0) {
+    VINEYARD_DISCARD(client.DelData({vpstream, epstream}, true, false));
+    if (!FLAGS_keep_objects) {
+      VINEYARD_DISCARD(client.DelData(group_id, true, true));
+    }
+  }
+  MPI_Barrier(comm_spec.comm());
+  VINEYARD_DISCARD(client.DelData({vstream, estream}, true, false));
+  return Status::OK();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  FLAGS_stderrthreshold = 0;
+  vineyard::logging::InitGoogleLogging("vineyard");
+  vineyard::flags::SetUsageMessage("Usage: pipeline_benchmark [options]");
+  vineyard::flags::ParseCommandLineNonHelpFlags(&argc, &argv, false);
+  if (FLAGS_help) {
+    FLAGS_help = false;
+    FLAGS_helpmatch = "pipeline_benchmark";
+  }
+  vineyard::flags::HandleCommandLineHelpFlags();
+
+  grape::InitMPIComm();
+  int ret = 0;
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+    auto status = RunPipeline(comm_spec);
+    if (!status.ok()) {
+      LOG(ERROR) << "Pipeline benchmark failed: " << status.ToString();
+      ret = static_cast<int>(status.code());
+    }
+  }
+  grape::FinalizeMPIComm();
+  return ret;
+}
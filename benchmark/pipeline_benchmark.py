@@ -0,0 +1,235 @@
+#! /usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2020-2021 Alibaba Group Holding Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+'''Runs the end-to-end pipeline benchmark on a local vineyard cluster:
+
+- an etcd and ``--instances`` vineyardd instances are started;
+- ``pipeline_benchmark`` is launched with ``mpiexec``, one worker per
+  instance, to ingest the generated graph, push it through the streams,
+  build the fragments and query them, see ``pipeline_benchmark.cc``;
+- the vertex and edge tables of the fragments are then read from Python on
+  each instance by ``client.get``, as the ``python`` stage.
+
+The throughput and the latency of each stage, and of the whole pipeline, are
+printed as a table.
+
+Usage:
+
+.. code:: bash
+
+    python3 benchmark/pipeline_benchmark.py \\
+        --benchmark build/bin/pipeline_benchmark \\
+        --vineyardd build/bin/vineyardd \\
+        --instances 2 --vertices 1048576 --report pipeline.json
+'''
+
+import contextlib
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import time
+from argparse import ArgumentParser
+
+import vineyard
+from vineyard.deploy.etcd import start_etcd
+from vineyard.deploy.local import start_vineyardd
+from vineyard.deploy.utils import find_port
+
+
+def resolve_mpiexec_cmdargs():
+    if 'open' in subprocess.getoutput('mpiexec -V').lower():
+        return [
+            'mpiexec',
+            '--allow-run-as-root',
+            '-mca',
+            'orte_allowed_exit_without_sync',
+            '1',
+            '-mca',
+            'btl_vader_single_copy_mechanism',
+            'none',
+        ]
+    else:
+        return ['mpiexec']
+
+
+def percentile(values, p):
+    if not values:
+        return 0
+    values = sorted(values)
+    return values[min(int(p * (len(values) - 1) + 0.5), len(values) - 1)]
+
+
+def read_fragments(sockets, fragment_group):
+    '''Read the tables of the local fragments from each instance, the stage is
+    timed by the slowest instance, as the instances are expected to be read in
+    parallel in a real deployment.
+    '''
+    seconds, records, nbytes, latencies = 0, 0, 0, []
+    for socket in sockets:
+        client = vineyard.connect(socket)
+        start = time.perf_counter()
+        group = client.get_meta(vineyard.ObjectID(fragment_group), True)
+        for index in range(int(group['total_frag_num'])):
+            if int(group['frag_instance_id_%d' % index]) != client.instance_id:
+                continue
+            fragment_id = group['frag_object_id_%d' % index].id
+            fragment = client.get_meta(fragment_id)
+            for key in ['vertex_tables_0', 'edge_tables_0']:
+                latency = time.perf_counter()
+                table = client.get(fragment[key].id)
+                latencies.append((time.perf_counter() - latency) * 1000)
+                records += table.num_rows
+                nbytes += table.nbytes
+        seconds = max(seconds, time.perf_counter() - start)
+        client.close()
+    return {
+        'stage': 'python',
+        'seconds': seconds,
+        'records': records,
+        'bytes': nbytes,
+        'records_per_second': records / seconds if seconds > 0 else 0,
+        'bytes_per_second': nbytes / seconds if seconds > 0 else 0,
+        'p50_ms': percentile(latencies, 0.5),
+        'p99_ms': percentile(latencies, 0.99),
+    }
+
+
+def print_report(report):
+    print(
+        '%-10s %10s %14s %12s %16s %10s %10s'
+        % ('stage', 'seconds', 'records', 'MiB', 'records/s', 'p50(ms)', 'p99(ms)')
+    )
+    for stage in report['stages']:
+        print(
+            '%-10s %10.3f %14d %12.1f %16.1f %10.3f %10.3f'
+            % (
+                stage['stage'],
+                stage['seconds'],
+                stage['records'],
+                stage['bytes'] / 1024.0 / 1024.0,
+                stage['records_per_second'],
+                stage['p50_ms'],
+                stage['p99_ms'],
+            )
+        )
+    edges = report['edges']
+    print(
+        'total: %.3f seconds, %.1f edges/s end-to-end'
+        % (report['total_seconds'], edges / report['total_seconds'])
+    )
+
+
+def run(args):
+    with contextlib.ExitStack() as stack:
+        _, etcd_endpoints = stack.enter_context(start_etcd())
+        etcd_prefix = 'vineyard_pipeline_benchmark_%d' % os.getpid()
+        sockets = []
+        for index in range(args.instances):
+            _, socket, _ = stack.enter_context(
+                start_vineyardd(
+                    etcd_endpoints=etcd_endpoints,
+                    etcd_prefix=etcd_prefix,
+                    vineyardd_path=args.vineyardd,
+                    size=args.size,
+                    socket='/tmp/vineyard.pipeline.%d.%d.sock'
+                    % (os.getpid(), index),
+                    rpc_socket_port=find_port(),
+                )
+            )
+            sockets.append(socket)
+
+        data_dir = stack.enter_context(
+            tempfile.TemporaryDirectory(prefix='vineyard-pipeline-')
+        )
+        report_file = os.path.join(data_dir, 'report.json')
+        start = time.perf_counter()
+        subprocess.check_call(
+            resolve_mpiexec_cmdargs()
+            + [
+                '-n',
+                str(args.instances * args.workers_per_instance),
+                args.benchmark,
+                '--ipc_sockets=%s' % ','.join(sockets),
+                '--data_dir=%s' % os.path.join(data_dir, 'graph'),
+                '--vertices=%d' % args.vertices,
+                '--degree=%d' % args.degree,
+                '--distribution=%d' % args.distribution,
+                '--batch_rows=%d' % args.batch_rows,
+                '--queries=%d' % args.queries,
+                '--report=%s' % report_file,
+                '--keep_objects',
+            ],
+            stdout=subprocess.DEVNULL,
+        )
+        with open(report_file, 'r') as f:
+            report = json.load(f)
+        python_stage = read_fragments(sockets, report['fragment_group'])
+        report['stages'].append(python_stage)
+        # the generation of the graph is excluded
+        report['total_seconds'] += python_stage['seconds']
+        report['wall_seconds'] = time.perf_counter() - start
+
+    print_report(report)
+    if args.report:
+        with open(args.report, 'w') as f:
+            json.dump(report, f, indent=2)
+
+
+def parse_sys_args():
+    arg_parser = ArgumentParser()
+    arg_parser.add_argument(
+        '--benchmark',
+        type=str,
+        default='pipeline_benchmark',
+        help='The path of the pipeline_benchmark program',
+    )
+    arg_parser.add_argument(
+        '--vineyardd',
+        type=str,
+        default=None,
+        help='The path of vineyardd, the bundled one by default',
+    )
+    arg_parser.add_argument(
+        '--instances', type=int, default=2, help='Number of vineyardd instances'
+    )
+    arg_parser.add_argument(
+        '--workers-per-instance',
+        type=int,
+        default=1,
+        help='Number of workers that connect to each instance',
+    )
+    arg_parser.add_argument(
+        '--size', type=str, default='8Gi', help='Shared memory of each instance'
+    )
+    arg_parser.add_argument('--vertices', type=int, default=1 << 20)
+    arg_parser.add_argument('--degree', type=int, default=16)
+    arg_parser.add_argument(
+        '--distribution', type=int, default=1, help='0 for uniform, 1 for R-MAT'
+    )
+    arg_parser.add_argument('--batch-rows', type=int, default=1 << 16)
+    arg_parser.add_argument('--queries', type=int, default=10000)
+    arg_parser.add_argument(
+        '--report', type=str, default=None, help='Write the report in JSON'
+    )
+    return arg_parser.parse_args()
+
+
+if __name__ == '__main__':
+    sys.exit(run(parse_sys_args()))
@@ -0,0 +1,361 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/api.h"
+#include "benchmark/benchmark.h"
+
+#include "basic/ds/arrow.h"
+#include "basic/stream/byte_stream.h"
+#include "basic/stream/parallel_stream.h"
+#include "basic/stream/recordbatch_stream.h"
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+#include "benchmark_utils.h"
+
+// Throughput and latency of chunks through the stream store of vineyardd.
+//
+// Usage:
+//
+//    VINEYARD_IPC_SOCKET=/var/run/vineyard.sock ./stream_benchmark \
+//        --benchmark_filter='BM_Stream/kind:0/producers:4/.*'
+//
+// Each producer writes its own stream, which is a byte stream (kind 0), a
+// record batch stream (kind 1), or a substream of a parallel stream (kind
+// 2). The streams are partitioned among the consumers, and when there are
+// more consumers than streams, the consumers of a stream read it in fanout
+// mode. The push-to-pull latency is measured from right before a chunk is
+// pushed to right after it is pulled.
+//
+// A vineyardd with local metadata is spawned from the build tree when
+// VINEYARD_IPC_SOCKET is not set.
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+namespace {
+
+std::string ipc_socket;
+
+enum class StreamKind {
+  kByteStream = 0,
+  kRecordBatchStream = 1,
+  kParallelStream = 2,
+};
+
+using clock_type = std::chrono::steady_clock;
+
+// the amount of data every producer writes in an iteration
+constexpr size_t kBytesPerProducer = 64 << 20;
+
+struct StreamRun {
+  StreamKind kind;
+  size_t producers, consumers, chunk_size, chunks;
+
+  std::vector<ObjectID> streams;
+  ObjectID parallel_stream = InvalidObjectID();
+
+  std::mutex mutex;
+  std::unordered_map<ObjectID, clock_type::time_point> pushed;
+  std::vector<int64_t> latencies;
+  size_t pulled_chunks = 0, pulled_bytes = 0;
+
+  std::atomic<size_t> opened{0};
+  std::atomic<bool> started{false};
+};
+
+Status create_streams(Client& client, StreamRun& run) {
+  for (size_t i = 0; i < run.producers; ++i) {
+    std::shared_ptr<Object> stream;
+    if (run.kind == StreamKind::kRecordBatchStream) {
+      RecordBatchStreamBuilder builder(client);
+      builder.SetParam("kind", "benchmark");
+      stream = builder.Seal(client);
+    } else {
+      ByteStreamBuilder builder(client);
+      builder.SetParam("kind", "benchmark");
+      stream = builder.Seal(client);
+    }
+    run.streams.emplace_back(stream->id());
+  }
+  if (run.kind == StreamKind::kParallelStream) {
+    ParallelStreamBuilder builder(client);
+    for (auto const& stream : run.streams) {
+      builder.AddStream(stream);
+    }
+    run.parallel_stream = builder.Seal(client)->id();
+  }
+  return Status::OK();
+}
+
+/**
+ * @brief Resolves the i-th stream the same way as the real applications do,
+ * i.e., the substreams of a parallel stream are found from its metadata.
+ */
+ObjectID resolve_stream(Client& client, StreamRun& run, size_t index) {
+  if (run.kind == StreamKind::kParallelStream) {
+    auto parallel_stream =
+        client.GetObject<ParallelStream>(run.parallel_stream);
+    return parallel_stream->GetStream<ByteStream>(static_cast<int>(index))
+        ->id();
+  }
+  return run.streams[index];
+}
+
+Status make_chunk(Client& client, StreamRun& run,
+                  std::shared_ptr<arrow::RecordBatch> const& batch,
+                  size_t index, ObjectID& chunk) {
+  if (run.kind == StreamKind::kRecordBatchStream) {
+    RecordBatchBuilder builder(client, batch);
+    chunk = builder.Seal(client)->id();
+  } else {
+    std::unique_ptr<BlobWriter> writer;
+    RETURN_ON_ERROR(client.CreateBlob(run.chunk_size, writer));
+    memset(writer->data(), static_cast<int>(index), run.chunk_size);
+    chunk = writer->Seal(client)->id();
+  }
+  return Status::OK();
+}
+
+Status produce(StreamRun& run, size_t producer) {
+  Client client;
+  RETURN_ON_ERROR(client.Connect(ipc_socket));
+  ObjectID stream = resolve_stream(client, run, producer);
+  RETURN_ON_ERROR(client.OpenStream(stream, StreamOpenMode::write));
+
+  std::shared_ptr<arrow::RecordBatch> batch;
+  if (run.kind == StreamKind::kRecordBatchStream) {
+    arrow::Int64Builder builder;
+    RETURN_ON_ARROW_ERROR(builder.AppendValues(
+        std::vector<int64_t>(run.chunk_size / sizeof(int64_t), producer)));
+    std::shared_ptr<arrow::Array> array;
+    RETURN_ON_ARROW_ERROR(builder.Finish(&array));
+    batch = arrow::RecordBatch::Make(
+        arrow::schema({arrow::field("value", arrow::int64())}),
+        array->length(), {array});
+  }
+
+  while (!run.started.load()) {
+    std::this_thread::yield();
+  }
+  Status status;
+  for (size_t index = 0; index < run.chunks && status.ok(); ++index) {
+    ObjectID chunk = InvalidObjectID();
+    status &= make_chunk(client, run, batch, index, chunk);
+    if (status.ok()) {
+      {
+        std::lock_guard<std::mutex> lock(run.mutex);
+        run.pushed.emplace(chunk, clock_type::now());
+      }
+      status &= client.PushNextStreamChunk(stream, chunk);
+    }
+  }
+  VINEYARD_DISCARD(client.StopStream(stream, !status.ok()));
+  return status;
+}
+
+Status consume(StreamRun& run, size_t consumer) {
+  Client client;
+  std::vector<ObjectID> streams;
+  Status status = client.Connect(ipc_socket);
+  if (status.ok()) {
+    StreamOpenMode mode = StreamOpenMode::read;
+    if (run.consumers <= run.producers) {
+      for (size_t i = consumer; i < run.producers; i += run.consumers) {
+        streams.emplace_back(resolve_stream(client, run, i));
+      }
+    } else {
+      streams.emplace_back(
+          resolve_stream(client, run, consumer % run.producers));
+      mode = StreamOpenMode::fanout;
+    }
+    for (auto const& stream : streams) {
+      status &= client.OpenStream(stream, mode);
+    }
+  }
+  // fanout readers must join before the first chunk to see the whole stream,
+  // and the producers wait for all consumers, including the failed ones
+  run.opened += 1;
+  RETURN_ON_ERROR(status);
+
+  std::vector<int64_t> latencies;
+  size_t chunks = 0, bytes = 0;
+  for (auto const& stream : streams) {
+    while (true) {
+      std::shared_ptr<Object> chunk;
+      status = client.PullNextStreamChunk(stream, chunk);
+      auto pulled = clock_type::now();
+      if (status.IsStreamDrained()) {
+        break;
+      }
+      RETURN_ON_ERROR(status);
+      clock_type::time_point pushed;
+      {
+        std::lock_guard<std::mutex> lock(run.mutex);
+        pushed = run.pushed.at(chunk->id());
+      }
+      latencies.emplace_back(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(pulled -
+                                                               pushed)
+              .count());
+      chunks += 1;
+      bytes += chunk->meta().GetNBytes();
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(run.mutex);
+  run.latencies.insert(run.latencies.end(), latencies.begin(),
+                       latencies.end());
+  run.pulled_chunks += chunks;
+  run.pulled_bytes += bytes;
+  return Status::OK();
+}
+
+/**
+ * @brief Runs the producers and consumers to the end of the streams, returns
+ * the seconds from the first push to the last pull.
+ */
+Status run_streams(Client& client, StreamRun& run, double& seconds) {
+  RETURN_ON_ERROR(create_streams(client, run));
+
+  std::vector<Status> statuses(run.producers + run.consumers);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < run.consumers; ++i) {
+    threads.emplace_back(
+        [&run, &statuses, i]() { statuses[i] = consume(run, i); });
+  }
+  for (size_t i = 0; i < run.producers; ++i) {
+    threads.emplace_back([&run, &statuses, i]() {
+      statuses[run.consumers + i] = produce(run, i);
+    });
+  }
+  while (run.opened.load() < run.consumers) {
+    std::this_thread::yield();
+  }
+  auto start = clock_type::now();
+  run.started.store(true);
+  for (size_t i = 0; i < run.producers; ++i) {
+    threads[run.consumers + i].join();
+    if (!statuses[run.consumers + i].ok()) {
+      // unblocks the consumers when the producer failed before opening
+      VINEYARD_DISCARD(client.StopStream(run.streams[i], true));
+    }
+  }
+  for (size_t i = 0; i < run.consumers; ++i) {
+    threads[i].join();
+  }
+  seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+
+  std::vector<ObjectID> objects(run.streams.begin(), run.streams.end());
+  if (run.parallel_stream != InvalidObjectID()) {
+    objects.emplace_back(run.parallel_stream);
+  }
+  for (auto const& item : run.pushed) {
+    objects.emplace_back(item.first);
+  }
+  VINEYARD_DISCARD(client.DelData(objects, true, true));
+
+  Status status;
+  for (auto const& s : statuses) {
+    status &= s;
+  }
+  return status;
+}
+
+double percentile(std::vector<int64_t>& values, double p) {
+  if (values.empty()) {
+    return 0;
+  }
+  auto nth = values.begin() + static_cast<size_t>(p * (values.size() - 1));
+  std::nth_element(values.begin(), nth, values.end());
+  return *nth;
+}
+
+void BM_Stream(benchmark::State& state) {
+  static Client client;
+  if (!client.Connected()) {
+    VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  }
+
+  auto kind = static_cast<StreamKind>(state.range(0));
+  size_t producers = state.range(1), consumers = state.range(2),
+         chunk_size = state.range(3);
+  size_t chunks = std::max<size_t>(16, kBytesPerProducer / chunk_size);
+
+  std::vector<int64_t> latencies;
+  size_t pulled_chunks = 0, pulled_bytes = 0;
+  for (auto _ : state) {
+    StreamRun run;
+    run.kind = kind;
+    run.producers = producers;
+    run.consumers = consumers;
+    run.chunk_size = chunk_size;
+    run.chunks = chunks;
+
+    double seconds = 0;
+    auto status = run_streams(client, run, seconds);
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      return;
+    }
+    state.SetIterationTime(seconds);
+    latencies.insert(latencies.end(), run.latencies.begin(),
+                     run.latencies.end());
+    pulled_chunks += run.pulled_chunks;
+    pulled_bytes += run.pulled_bytes;
+  }
+
+  state.SetBytesProcessed(pulled_bytes);
+  state.counters["chunks/s"] =
+      benchmark::Counter(pulled_chunks, benchmark::Counter::kIsRate);
+  state.counters["p50_us"] = percentile(latencies, 0.50) / 1000;
+  state.counters["p99_us"] = percentile(latencies, 0.99) / 1000;
+}
+
+void StreamArguments(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"kind", "producers", "consumers", "chunk_size"});
+  for (int kind = 0; kind <= 2; ++kind) {
+    for (int producers : {1, 4}) {
+      for (int consumers : {1, 4}) {
+        for (int chunk_size : {4 << 10, 64 << 10, 1 << 20, 16 << 20}) {
+          b->Args({kind, producers, consumers, chunk_size});
+        }
+      }
+    }
+  }
+}
+
+BENCHMARK(BM_Stream)
+    ->Apply(StreamArguments)
+    ->UseManualTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  return RunBenchmarks(argc, argv, ipc_socket);
+}
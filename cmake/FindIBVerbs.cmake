@@ -0,0 +1,21 @@
+# This file is used to find ibverbs library in CMake script.
+#
+#  IBVERBS_FOUND       - True if ibverbs was found.
+#  IBVERBS_LIBRARIES   - The libraries needed to use ibverbs
+#  IBVERBS_INCLUDE_DIR - Location of infiniband/verbs.h
+
+FIND_PATH(IBVERBS_INCLUDE_DIR infiniband/verbs.h)
+if(NOT IBVERBS_INCLUDE_DIR)
+  message(STATUS "failed to find infiniband/verbs.h")
+endif()
+
+FIND_LIBRARY(IBVERBS_LIBRARIES "ibverbs")
+if(NOT IBVERBS_LIBRARIES)
+    MESSAGE(STATUS "failed to find ibverbs library")
+endif()
+
+MARK_AS_ADVANCED(IBVERBS_LIBRARIES IBVERBS_INCLUDE_DIR)
+
+include(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(IBVerbs DEFAULT_MSG
+  IBVERBS_LIBRARIES IBVERBS_INCLUDE_DIR)
@@ -0,0 +1,21 @@
+# This file is used to find liburing library in CMake script.
+#
+#  LIBURING_FOUND       - True if liburing was found.
+#  LIBURING_LIBRARIES   - The libraries needed to use liburing
+#  LIBURING_INCLUDE_DIR - Location of liburing.h
+
+FIND_PATH(LIBURING_INCLUDE_DIR liburing.h)
+if(NOT LIBURING_INCLUDE_DIR)
+  message(STATUS "failed to find liburing.h")
+endif()
+
+FIND_LIBRARY(LIBURING_LIBRARIES "uring")
+if(NOT LIBURING_LIBRARIES)
+    MESSAGE(STATUS "failed to find uring library")
+endif()
+
+MARK_AS_ADVANCED(LIBURING_LIBRARIES LIBURING_INCLUDE_DIR)
+
+include(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(LibUring DEFAULT_MSG
+  LIBURING_LIBRARIES LIBURING_INCLUDE_DIR)
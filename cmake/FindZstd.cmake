@@ -0,0 +1,21 @@
+# This file is used to find zstd library in CMake script.
+#
+#  ZSTD_FOUND       - True if zstd was found.
+#  ZSTD_LIBRARIES   - The libraries needed to use zstd
+#  ZSTD_INCLUDE_DIR - Location of zstd.h
+
+FIND_PATH(ZSTD_INCLUDE_DIR zstd.h)
+if(NOT ZSTD_INCLUDE_DIR)
+  message(STATUS "failed to find zstd.h")
+endif()
+
+FIND_LIBRARY(ZSTD_LIBRARIES "zstd")
+if(NOT ZSTD_LIBRARIES)
+    MESSAGE(STATUS "failed to find zstd library")
+endif()
+
+MARK_AS_ADVANCED(ZSTD_LIBRARIES ZSTD_INCLUDE_DIR)
+
+include(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(Zstd DEFAULT_MSG
+  ZSTD_LIBRARIES ZSTD_INCLUDE_DIR)
@@ -107,6 +107,22 @@ class ArrayBuilder : public ArrayBaseBuilder<T> {
     return Status::OK();
   }
 
+  /**
+   * @brief Abort the array builder, release the blob if the array hasn't been
+   * built.
+   *
+   * @param client The client connected to the vineyard server.
+   */
+  Status Abort(Client& client) {
+    if (buffer_writer_ == nullptr) {
+      return Status::OK();
+    }
+    auto status = buffer_writer_->Abort(client);
+    buffer_writer_.reset();
+    data_ = nullptr;
+    return status;
+  }
+
  private:
   std::unique_ptr<BlobWriter> buffer_writer_;
   T* data_;
@@ -0,0 +1,414 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "basic/ds/array_reduce.h"
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#include "common/util/json.h"
+
+namespace vineyard {
+
+namespace detail {
+
+// the minimal number of values for each thread, below which the threads
+// cost more than the scan
+constexpr int64_t kParallelReduceGrain = 1 << 16;
+
+// the resolution of the approximate quantiles
+constexpr size_t kQuantileBins = 4096;
+
+/**
+ * @brief Run `func(thread, begin, end)` on up to `concurrency` threads, the
+ * ranges are aligned to 64 values, i.e., the words of the validity bitmap.
+ */
+template <typename FUNC_T>
+int ParallelRanges(int64_t const length, int const concurrency,
+                   FUNC_T const& func) {
+  int64_t threads = std::min<int64_t>(std::max(concurrency, 1),
+                                      length / kParallelReduceGrain);
+  if (threads <= 1) {
+    func(0, 0, length);
+    return 1;
+  }
+  int64_t step = ((length + threads - 1) / threads + 63) / 64 * 64;
+  threads = (length + step - 1) / step;
+  std::vector<std::thread> workers;
+  for (int64_t index = 0; index < threads; ++index) {
+    workers.emplace_back([&func, index, step, length]() {
+      func(static_cast<int>(index), index * step,
+           std::min(length, (index + 1) * step));
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  return static_cast<int>(threads);
+}
+
+template <typename T>
+inline void SummarizeValue(T const value, ArraySummary<T>& summary) {
+  using sum_type = typename ArraySummary<T>::sum_type;
+  summary.count += 1;
+  summary.sum += static_cast<sum_type>(value);
+  summary.min_value = value < summary.min_value ? value : summary.min_value;
+  summary.max_value = value > summary.max_value ? value : summary.max_value;
+}
+
+/**
+ * @brief Summarize the values that are all valid, in lanes that don't
+ * depend on each other, thus the loop is vectorized by the compiler.
+ */
+template <typename T>
+void SummarizeDense(T const* values, int64_t const length,
+                    ArraySummary<T>& summary) {
+  using sum_type = typename ArraySummary<T>::sum_type;
+  constexpr int64_t kLanes = 8;
+  sum_type sums[kLanes] = {};
+  T mins[kLanes], maxs[kLanes];
+  std::fill_n(mins, kLanes, summary.min_value);
+  std::fill_n(maxs, kLanes, summary.max_value);
+  int64_t index = 0;
+  for (; index + kLanes <= length; index += kLanes) {
+    for (int64_t lane = 0; lane < kLanes; ++lane) {
+      T value = values[index + lane];
+      sums[lane] += static_cast<sum_type>(value);
+      mins[lane] = value < mins[lane] ? value : mins[lane];
+      maxs[lane] = value > maxs[lane] ? value : maxs[lane];
+    }
+  }
+  for (int64_t lane = 0; lane < kLanes; ++lane) {
+    summary.sum += sums[lane];
+    summary.min_value = mins[lane] < summary.min_value ? mins[lane]
+                                                       : summary.min_value;
+    summary.max_value = maxs[lane] > summary.max_value ? maxs[lane]
+                                                       : summary.max_value;
+  }
+  summary.count += index;
+  for (; index < length; ++index) {
+    SummarizeValue(values[index], summary);
+  }
+}
+
+#if defined(__AVX512F__)
+template <>
+void SummarizeDense<double>(double const* values, int64_t const length,
+                            ArraySummary<double>& summary) {
+  __m512d sums = _mm512_setzero_pd();
+  __m512d mins = _mm512_set1_pd(summary.min_value);
+  __m512d maxs = _mm512_set1_pd(summary.max_value);
+  int64_t index = 0;
+  for (; index + 8 <= length; index += 8) {
+    __m512d value = _mm512_loadu_pd(values + index);
+    sums = _mm512_add_pd(sums, value);
+    // returns the second operand when either is NaN, thus NaNs are ignored
+    mins = _mm512_min_pd(value, mins);
+    maxs = _mm512_max_pd(value, maxs);
+  }
+  summary.sum += _mm512_reduce_add_pd(sums);
+  summary.min_value = _mm512_reduce_min_pd(mins);
+  summary.max_value = _mm512_reduce_max_pd(maxs);
+  summary.count += index;
+  for (; index < length; ++index) {
+    SummarizeValue(values[index], summary);
+  }
+}
+#elif defined(__AVX2__)
+template <>
+void SummarizeDense<double>(double const* values, int64_t const length,
+                            ArraySummary<double>& summary) {
+  // two accumulators, to hide the latency of the additions
+  __m256d sums[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+  __m256d mins = _mm256_set1_pd(summary.min_value);
+  __m256d maxs = _mm256_set1_pd(summary.max_value);
+  int64_t index = 0;
+  for (; index + 8 <= length; index += 8) {
+    __m256d lo = _mm256_loadu_pd(values + index);
+    __m256d hi = _mm256_loadu_pd(values + index + 4);
+    sums[0] = _mm256_add_pd(sums[0], lo);
+    sums[1] = _mm256_add_pd(sums[1], hi);
+    // returns the second operand when either is NaN, thus NaNs are ignored
+    mins = _mm256_min_pd(hi, _mm256_min_pd(lo, mins));
+    maxs = _mm256_max_pd(hi, _mm256_max_pd(lo, maxs));
+  }
+  double lanes[4];
+  _mm256_storeu_pd(lanes, _mm256_add_pd(sums[0], sums[1]));
+  summary.sum += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  _mm256_storeu_pd(lanes, mins);
+  summary.min_value = std::min({lanes[0], lanes[1], lanes[2], lanes[3]});
+  _mm256_storeu_pd(lanes, maxs);
+  summary.max_value = std::max({lanes[0], lanes[1], lanes[2], lanes[3]});
+  summary.count += index;
+  for (; index < length; ++index) {
+    SummarizeValue(values[index], summary);
+  }
+}
+#endif
+
+inline uint64_t LoadWord(uint8_t const* bitmap, int64_t const bit) {
+  uint64_t word;
+  memcpy(&word, bitmap + bit / 8, sizeof(word));
+  return word;
+}
+
+inline bool GetBit(uint8_t const* bitmap, int64_t const bit) {
+  return (bitmap[bit >> 3] >> (bit & 7)) & 1;
+}
+
+/**
+ * @brief Run `dense(begin, end)` on the runs of valid values, which consist
+ * of the whole words of the bitmap that are all set, and `sparse(index)` on
+ * the other valid values.
+ */
+template <typename DENSE_T, typename SPARSE_T>
+void ForEachValid(uint8_t const* validity, int64_t const offset,
+                  int64_t const begin, int64_t const end, DENSE_T const& dense,
+                  SPARSE_T const& sparse) {
+  if (validity == nullptr) {
+    dense(begin, end);
+    return;
+  }
+  int64_t index = begin;
+  while (index < end) {
+    int64_t bit = offset + index;
+    if (bit % 64 != 0 || index + 64 > end) {
+      if (GetBit(validity, bit)) {
+        sparse(index);
+      }
+      index += 1;
+      continue;
+    }
+    uint64_t word = LoadWord(validity, bit);
+    if (word == ~uint64_t(0)) {
+      int64_t run_end = index + 64;
+      while (run_end + 64 <= end &&
+             LoadWord(validity, offset + run_end) == ~uint64_t(0)) {
+        run_end += 64;
+      }
+      dense(index, run_end);
+      index = run_end;
+      continue;
+    }
+    while (word != 0) {
+      sparse(index + __builtin_ctzll(word));
+      word &= word - 1;
+    }
+    index += 64;
+  }
+}
+
+template <typename T>
+inline bool BinOf(T const value, double const lower, double const upper,
+                  double const scale, size_t const bins, size_t& bin) {
+  double v = static_cast<double>(value);
+  // false for NaNs
+  if (!(v >= lower && v <= upper)) {
+    return false;
+  }
+  bin = std::min(static_cast<size_t>((v - lower) * scale), bins - 1);
+  return true;
+}
+
+}  // namespace detail
+
+template <typename T>
+Status Summarize(T const* values, int64_t const length,
+                 uint8_t const* validity, int64_t const offset,
+                 ArraySummary<T>& summary, int const concurrency) {
+  summary = ArraySummary<T>();
+  std::vector<ArraySummary<T>> partials(std::max(concurrency, 1));
+  int threads = detail::ParallelRanges(
+      length, concurrency, [&](int thread, int64_t begin, int64_t end) {
+        auto& partial = partials[thread];
+        detail::ForEachValid(
+            validity, offset, begin, end,
+            [&](int64_t run_begin, int64_t run_end) {
+              detail::SummarizeDense(values + run_begin, run_end - run_begin,
+                                     partial);
+            },
+            [&](int64_t index) {
+              detail::SummarizeValue(values[index], partial);
+            });
+      });
+  for (int thread = 0; thread < threads; ++thread) {
+    summary.Merge(partials[thread]);
+  }
+  return Status::OK();
+}
+
+template <typename T>
+Status Histogram(T const* values, int64_t const length,
+                 uint8_t const* validity, int64_t const offset,
+                 double const lower, double const upper, size_t const bins,
+                 std::vector<int64_t>& counts, int const concurrency) {
+  if (bins == 0) {
+    return Status::Invalid("The number of bins must be positive");
+  }
+  if (!(lower <= upper)) {
+    return Status::Invalid("The lower bound exceeds the upper bound");
+  }
+  counts.assign(bins, 0);
+  // all values fall into the first bin when the range is a single point
+  double scale = upper > lower ? bins / (upper - lower) : 0;
+  std::vector<std::vector<int64_t>> partials(std::max(concurrency, 1));
+  int threads = detail::ParallelRanges(
+      length, concurrency, [&](int thread, int64_t begin, int64_t end) {
+        auto& partial = partials[thread];
+        partial.assign(bins, 0);
+        auto count = [&](int64_t index) {
+          size_t bin;
+          if (detail::BinOf(values[index], lower, upper, scale, bins, bin)) {
+            partial[bin] += 1;
+          }
+        };
+        detail::ForEachValid(
+            validity, offset, begin, end,
+            [&](int64_t run_begin, int64_t run_end) {
+              for (int64_t index = run_begin; index < run_end; ++index) {
+                count(index);
+              }
+            },
+            count);
+      });
+  for (int thread = 0; thread < threads; ++thread) {
+    for (size_t bin = 0; bin < bins; ++bin) {
+      counts[bin] += partials[thread][bin];
+    }
+  }
+  return Status::OK();
+}
+
+template <typename T>
+Status Quantiles(T const* values, int64_t const length,
+                 uint8_t const* validity, int64_t const offset,
+                 std::vector<double> const& quantiles,
+                 std::vector<double>& results, int const concurrency) {
+  for (double const q : quantiles) {
+    if (!(q >= 0 && q <= 1)) {
+      return Status::Invalid("The quantiles must be in [0, 1]");
+    }
+  }
+  ArraySummary<T> summary;
+  RETURN_ON_ERROR(
+      Summarize(values, length, validity, offset, summary, concurrency));
+  results.assign(quantiles.size(), std::numeric_limits<double>::quiet_NaN());
+  if (summary.count == 0 || !(summary.min_value <= summary.max_value)) {
+    return Status::OK();
+  }
+  double lower = static_cast<double>(summary.min_value);
+  double upper = static_cast<double>(summary.max_value);
+  std::vector<int64_t> counts;
+  RETURN_ON_ERROR(Histogram(values, length, validity, offset, lower, upper,
+                            detail::kQuantileBins, counts, concurrency));
+  int64_t total = 0;
+  for (auto const count : counts) {
+    total += count;
+  }
+  double width = (upper - lower) / detail::kQuantileBins;
+  for (size_t index = 0; index < quantiles.size(); ++index) {
+    // the extremes are exact
+    if (quantiles[index] == 0 || quantiles[index] == 1) {
+      results[index] = quantiles[index] == 0 ? lower : upper;
+      continue;
+    }
+    // the rank of the value, counting from 0
+    double rank = quantiles[index] * (total - 1);
+    int64_t before = 0;
+    size_t bin = 0;
+    while (bin + 1 < counts.size() && before + counts[bin] <= rank) {
+      before += counts[bin];
+      bin += 1;
+    }
+    // the values are assumed to spread evenly in the bin
+    double position =
+        counts[bin] == 0 ? 0 : (rank - before + 0.5) / counts[bin];
+    results[index] =
+        std::min(upper, std::max(lower, lower + (bin + position) * width));
+  }
+  return Status::OK();
+}
+
+template <typename T>
+Status CacheSummary(Client& client, ObjectID const id,
+                    ArraySummary<T> const& summary, ObjectID& cached_id) {
+  if (!std::isfinite(static_cast<double>(summary.sum))) {
+    return Status::Invalid("The sum of the array is not finite");
+  }
+  json extra_metadata;
+  extra_metadata["summary_count_"] = summary.count;
+  extra_metadata["summary_sum_"] = summary.sum;
+  if (summary.count > 0) {
+    extra_metadata["summary_min_"] = summary.min_value;
+    extra_metadata["summary_max_"] = summary.max_value;
+  }
+  return client.ShallowCopy(id, extra_metadata, cached_id);
+}
+
+template <typename T>
+bool GetCachedSummary(ObjectMeta const& meta, ArraySummary<T>& summary) {
+  if (!meta.Haskey("summary_count_") || !meta.Haskey("summary_sum_")) {
+    return false;
+  }
+  summary = ArraySummary<T>();
+  meta.GetKeyValue("summary_count_", summary.count);
+  meta.GetKeyValue("summary_sum_", summary.sum);
+  if (summary.count > 0) {
+    meta.GetKeyValue("summary_min_", summary.min_value);
+    meta.GetKeyValue("summary_max_", summary.max_value);
+  }
+  return true;
+}
+
+#define INSTANTIATE_REDUCE_KERNELS(T)                                        \
+  template Status Summarize<T>(T const* values, int64_t const length,        \
+                               uint8_t const* validity, int64_t const offset, \
+                               ArraySummary<T>& summary,                     \
+                               int const concurrency);                       \
+  template Status Histogram<T>(                                              \
+      T const* values, int64_t const length, uint8_t const* validity,        \
+      int64_t const offset, double const lower, double const upper,          \
+      size_t const bins, std::vector<int64_t>& counts,                       \
+      int const concurrency);                                                \
+  template Status Quantiles<T>(                                              \
+      T const* values, int64_t const length, uint8_t const* validity,        \
+      int64_t const offset, std::vector<double> const& quantiles,            \
+      std::vector<double>& results, int const concurrency);                  \
+  template Status CacheSummary<T>(Client & client, ObjectID const id,        \
+                                  ArraySummary<T> const& summary,            \
+                                  ObjectID& cached_id);                      \
+  template bool GetCachedSummary<T>(ObjectMeta const& meta,                  \
+                                    ArraySummary<T>& summary);
+
+INSTANTIATE_REDUCE_KERNELS(int8_t)
+INSTANTIATE_REDUCE_KERNELS(uint8_t)
+INSTANTIATE_REDUCE_KERNELS(int16_t)
+INSTANTIATE_REDUCE_KERNELS(uint16_t)
+INSTANTIATE_REDUCE_KERNELS(int32_t)
+INSTANTIATE_REDUCE_KERNELS(uint32_t)
+INSTANTIATE_REDUCE_KERNELS(int64_t)
+INSTANTIATE_REDUCE_KERNELS(uint64_t)
+INSTANTIATE_REDUCE_KERNELS(float)
+INSTANTIATE_REDUCE_KERNELS(double)
+
+#undef INSTANTIATE_REDUCE_KERNELS
+
+}  // namespace vineyard
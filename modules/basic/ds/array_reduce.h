@@ -0,0 +1,184 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_ARRAY_REDUCE_H_
+#define MODULES_BASIC_DS_ARRAY_REDUCE_H_
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "basic/ds/array.h"
+#include "basic/ds/arrow.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief The count, sum, minimum and maximum of the valid values of an
+ * array. The integers are summed in 64 bits, with wrapping on overflow, and
+ * the floating points are summed in double, where NaNs are propagated to the
+ * sum but ignored by the minimum and the maximum.
+ *
+ * @tparam T The arithmetic type of the elements.
+ */
+template <typename T>
+struct ArraySummary {
+  using sum_type = typename std::conditional<
+      std::is_floating_point<T>::value, double,
+      typename std::conditional<std::is_signed<T>::value, int64_t,
+                                uint64_t>::type>::type;
+
+  int64_t count = 0;
+  sum_type sum = 0;
+  T min_value = std::numeric_limits<T>::has_infinity
+                    ? std::numeric_limits<T>::infinity()
+                    : std::numeric_limits<T>::max();
+  T max_value = std::numeric_limits<T>::has_infinity
+                    ? -std::numeric_limits<T>::infinity()
+                    : std::numeric_limits<T>::lowest();
+
+  double mean() const {
+    return count == 0 ? std::numeric_limits<double>::quiet_NaN()
+                      : static_cast<double>(sum) / count;
+  }
+
+  void Merge(ArraySummary const& other) {
+    count += other.count;
+    sum += other.sum;
+    min_value = other.min_value < min_value ? other.min_value : min_value;
+    max_value = other.max_value > max_value ? other.max_value : max_value;
+  }
+};
+
+/**
+ * @brief Summarize the `length` values, where the value `i` is valid if the
+ * bit `offset + i` of the `validity` bitmap is set, or when `validity` is
+ * null.
+ *
+ * The values are scanned with AVX-512 or AVX2 when vineyard is built for
+ * them, and in 8 independent lanes that the compiler vectorizes otherwise.
+ * Runs of 64 valid values take the dense kernels, and runs of 64 nulls are
+ * skipped. Arrays that are large enough are split to up to `concurrency`
+ * threads.
+ */
+template <typename T>
+Status Summarize(T const* values, int64_t const length,
+                 uint8_t const* validity, int64_t const offset,
+                 ArraySummary<T>& summary, int const concurrency = 1);
+
+/**
+ * @brief Count the valid values into `bins` bins of the same width that
+ * cover [lower, upper], the last bin includes `upper`, and the values out of
+ * the range (and NaNs) are not counted.
+ */
+template <typename T>
+Status Histogram(T const* values, int64_t const length,
+                 uint8_t const* validity, int64_t const offset,
+                 double const lower, double const upper, size_t const bins,
+                 std::vector<int64_t>& counts, int const concurrency = 1);
+
+/**
+ * @brief The approximate `quantiles` (in [0, 1]) of the valid values, which
+ * are interpolated in a histogram of 4096 bins between the minimum and the
+ * maximum, thus the error is bounded by 1/4096 of the range of the values,
+ * except that the 0 and 1 quantiles are exact. The results are NaN when
+ * there's no valid value.
+ */
+template <typename T>
+Status Quantiles(T const* values, int64_t const length,
+                 uint8_t const* validity, int64_t const offset,
+                 std::vector<double> const& quantiles,
+                 std::vector<double>& results, int const concurrency = 1);
+
+template <typename T>
+Status Summarize(Array<T> const& array, ArraySummary<T>& summary,
+                 int const concurrency = 1) {
+  return Summarize(array.data(), static_cast<int64_t>(array.size()), nullptr,
+                   0, summary, concurrency);
+}
+
+template <typename T>
+Status Summarize(NumericArray<T> const& array, ArraySummary<T>& summary,
+                 int const concurrency = 1) {
+  auto const& values = array.GetArray();
+  return Summarize(values->raw_values(), values->length(),
+                   values->null_count() == 0 ? nullptr
+                                             : values->null_bitmap_data(),
+                   values->offset(), summary, concurrency);
+}
+
+template <typename T>
+Status Histogram(Array<T> const& array, double const lower,
+                 double const upper, size_t const bins,
+                 std::vector<int64_t>& counts, int const concurrency = 1) {
+  return Histogram(array.data(), static_cast<int64_t>(array.size()), nullptr,
+                   0, lower, upper, bins, counts, concurrency);
+}
+
+template <typename T>
+Status Histogram(NumericArray<T> const& array, double const lower,
+                 double const upper, size_t const bins,
+                 std::vector<int64_t>& counts, int const concurrency = 1) {
+  auto const& values = array.GetArray();
+  return Histogram(values->raw_values(), values->length(),
+                   values->null_count() == 0 ? nullptr
+                                             : values->null_bitmap_data(),
+                   values->offset(), lower, upper, bins, counts, concurrency);
+}
+
+template <typename T>
+Status Quantiles(Array<T> const& array, std::vector<double> const& quantiles,
+                 std::vector<double>& results, int const concurrency = 1) {
+  return Quantiles(array.data(), static_cast<int64_t>(array.size()), nullptr,
+                   0, quantiles, results, concurrency);
+}
+
+template <typename T>
+Status Quantiles(NumericArray<T> const& array,
+                 std::vector<double> const& quantiles,
+                 std::vector<double>& results, int const concurrency = 1) {
+  auto const& values = array.GetArray();
+  return Quantiles(values->raw_values(), values->length(),
+                   values->null_count() == 0 ? nullptr
+                                             : values->null_bitmap_data(),
+                   values->offset(), quantiles, results, concurrency);
+}
+
+/**
+ * @brief Record the summary in the metadata of a shallow copy of the array
+ * object `id`, as the sealed objects are immutable, where the copy shares
+ * the blobs of the array. The summary can be read back from the metadata of
+ * the copy by `GetCachedSummary`.
+ *
+ * Summaries whose sum is not finite cannot be cached.
+ */
+template <typename T>
+Status CacheSummary(Client& client, ObjectID const id,
+                    ArraySummary<T> const& summary, ObjectID& cached_id);
+
+/**
+ * @brief Get the summary that is cached by `CacheSummary`, returns false if
+ * there's none.
+ */
+template <typename T>
+bool GetCachedSummary(ObjectMeta const& meta, ArraySummary<T>& summary);
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_ARRAY_REDUCE_H_
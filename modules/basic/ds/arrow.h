@@ -16,9 +16,13 @@ limitations under the License.
 #ifndef MODULES_BASIC_DS_ARROW_H_
 #define MODULES_BASIC_DS_ARROW_H_
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -59,9 +63,25 @@ class NumericArrayBuilder : public NumericArrayBaseBuilder<T> {
   NumericArrayBuilder(Client& client, std::shared_ptr<ArrayType> array)
       : NumericArrayBaseBuilder<T>(client), array_(array) {}
 
+  /**
+   * @brief Initialize the builder with the chunks of a column, which are
+   * copied into the blob one after another, i.e., the chunks are combined
+   * without an intermediate contiguous arrow array.
+   */
+  NumericArrayBuilder(Client& client,
+                      std::shared_ptr<arrow::ChunkedArray> chunks)
+      : NumericArrayBaseBuilder<T>(client), chunks_(chunks) {}
+
+  /**
+   * @brief The input array, or nullptr when the builder is initialized with
+   * the chunks of a column.
+   */
   std::shared_ptr<ArrayType> GetArray() { return array_; }
 
   Status Build(Client& client) override {
+    if (chunks_ != nullptr) {
+      return buildFromChunks(client);
+    }
     std::unique_ptr<BlobWriter> buffer_writer;
     RETURN_ON_ERROR(client.CreateBlob(array_->values()->size(), buffer_writer));
     memcpy(buffer_writer->data(), array_->values()->data(),
@@ -72,11 +92,89 @@ class NumericArrayBuilder : public NumericArrayBaseBuilder<T> {
     this->set_offset_(array_->offset());
     this->set_buffer_(std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
     BUILD_NULL_BITMAP(this, array_);
+    buildStatistics(array_->raw_values(), array_->length(),
+                    array_->null_count() == 0,
+                    [this](int64_t i) { return array_->IsValid(i); });
     return Status::OK();
   }
 
  private:
+  Status buildFromChunks(Client& client) {
+    int64_t length = chunks_->length();
+    std::unique_ptr<BlobWriter> buffer_writer;
+    RETURN_ON_ERROR(client.CreateBlob(length * sizeof(T), buffer_writer));
+    T* values = reinterpret_cast<T*>(buffer_writer->data());
+    int64_t position = 0;
+    for (auto const& chunk : chunks_->chunks()) {
+      auto array = std::dynamic_pointer_cast<ArrayType>(chunk);
+      if (array->length() > 0) {
+        memcpy(values + position, array->raw_values(),
+               array->length() * sizeof(T));
+      }
+      position += array->length();
+    }
+
+    this->set_length_(length);
+    this->set_null_count_(chunks_->null_count());
+    this->set_offset_(0);
+    if (chunks_->null_count() > 0) {
+      size_t nbytes = (length + 7) / 8;
+      std::unique_ptr<BlobWriter> bitmap_writer;
+      RETURN_ON_ERROR(client.CreateBlob(nbytes, bitmap_writer));
+      uint8_t* bits = reinterpret_cast<uint8_t*>(bitmap_writer->data());
+      memset(bits, 0, nbytes);
+      position = 0;
+      for (auto const& chunk : chunks_->chunks()) {
+        for (int64_t i = 0; i < chunk->length(); ++i, ++position) {
+          if (chunk->IsValid(i)) {
+            bits[position >> 3] |= static_cast<uint8_t>(1 << (position & 7));
+          }
+        }
+      }
+      buildStatistics(values, length, false, [bits](int64_t i) {
+        return (bits[i >> 3] & (1 << (i & 7))) != 0;
+      });
+      this->set_null_bitmap_(
+          std::shared_ptr<BlobWriter>(std::move(bitmap_writer)));
+    } else {
+      buildStatistics(values, length, true, [](int64_t) { return true; });
+      this->set_null_bitmap_(Blob::MakeEmpty(client));
+    }
+    this->set_buffer_(std::shared_ptr<BlobWriter>(std::move(buffer_writer)));
+    return Status::OK();
+  }
+
+  /**
+   * @brief Record the zone map of the array in its metadata, the comparisons
+   * are written without branches so that the dense case can be vectorized,
+   * and NaNs never replace the running minimum or maximum.
+   */
+  template <typename F>
+  void buildStatistics(const T* values, int64_t const length, bool const dense,
+                       F const& is_valid) {
+    T min_value = std::numeric_limits<T>::max();
+    T max_value = std::numeric_limits<T>::lowest();
+    if (dense) {
+      for (int64_t i = 0; i < length; ++i) {
+        min_value = values[i] < min_value ? values[i] : min_value;
+        max_value = values[i] > max_value ? values[i] : max_value;
+      }
+    } else {
+      for (int64_t i = 0; i < length; ++i) {
+        if (is_valid(i)) {
+          min_value = values[i] < min_value ? values[i] : min_value;
+          max_value = values[i] > max_value ? values[i] : max_value;
+        }
+      }
+    }
+    bool has_statistics = min_value <= max_value;
+    this->set_has_statistics_(has_statistics);
+    this->set_min_value_(has_statistics ? min_value : T{});
+    this->set_max_value_(has_statistics ? max_value : T{});
+  }
+
   std::shared_ptr<ArrayType> array_;
+  std::shared_ptr<arrow::ChunkedArray> chunks_;
 };
 
 /**
@@ -357,6 +455,43 @@ inline std::shared_ptr<ObjectBuilder> BuildArray(
   }
   return BuildSimpleArray(client, array);
 }
+
+template <typename T>
+inline std::shared_ptr<ObjectBuilder> BuildNumericChunks(
+    Client& client, std::shared_ptr<arrow::ChunkedArray> chunks) {
+  if (chunks->type()->Equals(ConvertToArrowType<T>::TypeValue())) {
+    return std::make_shared<NumericArrayBuilder<T>>(client, chunks);
+  }
+  return nullptr;
+}
+
+/**
+ * @brief Build the chunks of a column as a single array, the numeric chunks
+ * are concatenated right into the blob, the others are concatenated by arrow
+ * first.
+ */
+inline std::shared_ptr<ObjectBuilder> BuildChunkedArray(
+    Client& client, std::shared_ptr<arrow::ChunkedArray> chunks) {
+  if (chunks->num_chunks() == 1) {
+    return BuildArray(client, chunks->chunk(0));
+  }
+  std::shared_ptr<ObjectBuilder> builder;
+  if ((builder = BuildNumericChunks<int8_t>(client, chunks)) ||
+      (builder = BuildNumericChunks<uint8_t>(client, chunks)) ||
+      (builder = BuildNumericChunks<int16_t>(client, chunks)) ||
+      (builder = BuildNumericChunks<uint16_t>(client, chunks)) ||
+      (builder = BuildNumericChunks<int32_t>(client, chunks)) ||
+      (builder = BuildNumericChunks<uint32_t>(client, chunks)) ||
+      (builder = BuildNumericChunks<int64_t>(client, chunks)) ||
+      (builder = BuildNumericChunks<uint64_t>(client, chunks)) ||
+      (builder = BuildNumericChunks<float>(client, chunks)) ||
+      (builder = BuildNumericChunks<double>(client, chunks))) {
+    return builder;
+  }
+  std::shared_ptr<arrow::Array> array;
+  VINEYARD_CHECK_OK(ConcatenateChunks(chunks, &array));
+  return BuildArray(client, array);
+}
 }  // namespace detail
 
 /**
@@ -405,11 +540,35 @@ class RecordBatchBuilder : public RecordBatchBaseBuilder {
   RecordBatchBuilder(Client& client, std::shared_ptr<arrow::RecordBatch> batch)
       : RecordBatchBaseBuilder(client), batch_(batch) {}
 
+  /**
+   * @brief Initialize the builder with a sealed schema proxy of the batch's
+   * schema, which can be shared by many batches, e.g., of the same table.
+   */
+  RecordBatchBuilder(Client& client, std::shared_ptr<arrow::RecordBatch> batch,
+                     std::shared_ptr<Object> const& schema)
+      : RecordBatchBaseBuilder(client), batch_(batch), shared_schema_(schema) {}
+
+  /**
+   * @brief Initialize the builder with all rows of a table as a single batch,
+   * the chunks of each column are concatenated into a single array, and the
+   * columns are built in parallel, see detail::BuildChunkedArray.
+   */
+  RecordBatchBuilder(Client& client, std::shared_ptr<arrow::Table> table,
+                     std::shared_ptr<Object> const& schema)
+      : RecordBatchBaseBuilder(client), table_(table), shared_schema_(schema) {}
+
   Status Build(Client& client) override {
+    if (table_ != nullptr) {
+      return buildFromTable(client);
+    }
     this->set_column_num_(batch_->num_columns());
     this->set_row_num_(batch_->num_rows());
-    this->set_schema_(
-        std::make_shared<SchemaProxyBuilder>(client, batch_->schema()));
+    if (shared_schema_) {
+      this->set_schema_(shared_schema_);
+    } else {
+      this->set_schema_(
+          std::make_shared<SchemaProxyBuilder>(client, batch_->schema()));
+    }
     for (int64_t idx = 0; idx < batch_->num_columns(); ++idx) {
       this->add_columns_(detail::BuildArray(client, batch_->column(idx)));
     }
@@ -417,7 +576,39 @@ class RecordBatchBuilder : public RecordBatchBaseBuilder {
   }
 
  private:
+  Status buildFromTable(Client& client) {
+    int column_num = table_->num_columns();
+    this->set_column_num_(column_num);
+    this->set_row_num_(table_->num_rows());
+    this->set_schema_(shared_schema_);
+    std::vector<std::shared_ptr<Object>> columns(column_num);
+    std::atomic<int> next(0);
+    auto worker = [&]() {
+      for (int idx = next++; idx < column_num; idx = next++) {
+        columns[idx] = detail::BuildChunkedArray(client, table_->column(idx))
+                           ->Seal(client);
+      }
+    };
+    int parallelism = std::min(
+        static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u)),
+        column_num);
+    std::vector<std::thread> threads;
+    for (int i = 1; i < parallelism; ++i) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (auto const& column : columns) {
+      this->add_columns_(column);
+    }
+    return Status::OK();
+  }
+
   std::shared_ptr<arrow::RecordBatch> batch_;
+  std::shared_ptr<arrow::Table> table_;
+  std::shared_ptr<Object> shared_schema_;
 };
 
 /**
@@ -439,6 +630,14 @@ class RecordBatchExtender : public RecordBatchBaseBuilder {
 
   size_t num_rows() const { return row_num_; }
 
+  /**
+   * @brief Use the sealed schema proxy rather than building a new one, it
+   * must match the schema after extending.
+   */
+  void set_shared_schema(std::shared_ptr<Object> const& schema) {
+    shared_schema_ = schema;
+  }
+
   Status AddColumn(Client& client, const std::string& field_name,
                    std::shared_ptr<arrow::Array> column) {
     // validate input
@@ -465,7 +664,11 @@ class RecordBatchExtender : public RecordBatchBaseBuilder {
   Status Build(Client& client) override {
     this->set_row_num_(row_num_);
     this->set_column_num_(column_num_);
-    this->set_schema_(std::make_shared<SchemaProxyBuilder>(client, schema_));
+    if (shared_schema_) {
+      this->set_schema_(shared_schema_);
+    } else {
+      this->set_schema_(std::make_shared<SchemaProxyBuilder>(client, schema_));
+    }
     for (size_t idx = 0; idx < arrow_columns_.size(); ++idx) {
       this->add_columns_(detail::BuildArray(client, arrow_columns_[idx]));
     }
@@ -475,6 +678,7 @@ class RecordBatchExtender : public RecordBatchBaseBuilder {
  private:
   size_t row_num_ = 0, column_num_ = 0;
   std::shared_ptr<arrow::Schema> schema_;
+  std::shared_ptr<Object> shared_schema_;
   std::vector<std::shared_ptr<arrow::Array>> arrow_columns_;
 };
 
@@ -488,23 +692,48 @@ class TableBuilder : public TableBaseBuilder {
   TableBuilder(Client& client, std::shared_ptr<arrow::Table> table)
       : TableBaseBuilder(client), table_(table) {}
 
+  /**
+   * @brief Initialize the builder, and seal the table as a single batch when
+   * `combine_chunks` is true, whose columns are concatenated from the chunks
+   * right into the blobs, in parallel, rather than by
+   * `arrow::Table::CombineChunks` on the heap and copied then.
+   */
+  TableBuilder(Client& client, std::shared_ptr<arrow::Table> table,
+               bool const combine_chunks)
+      : TableBaseBuilder(client),
+        table_(table),
+        combine_chunks_(combine_chunks) {}
+
  public:
   Status Build(Client& client) override {
+    if (combine_chunks_ && table_->num_rows() > 0) {
+      this->set_batch_num_(1);
+      this->set_num_rows_(table_->num_rows());
+      this->set_num_columns_(table_->num_columns());
+      auto schema = SchemaProxyBuilder(client, table_->schema()).Seal(client);
+      this->add_batches_(
+          std::make_shared<RecordBatchBuilder>(client, table_, schema));
+      this->set_schema_(schema);
+      return Status::OK();
+    }
     std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
     RETURN_ON_ERROR(TableToRecordBatches(table_, &batches));
     this->set_batch_num_(batches.size());
     this->set_num_rows_(table_->num_rows());
     this->set_num_columns_(table_->num_columns());
+    // all batches and the table itself share a single schema proxy
+    auto schema = SchemaProxyBuilder(client, table_->schema()).Seal(client);
     for (auto const& batch : batches) {
-      this->add_batches_(std::make_shared<RecordBatchBuilder>(client, batch));
+      this->add_batches_(
+          std::make_shared<RecordBatchBuilder>(client, batch, schema));
     }
-    this->set_schema_(
-        std::make_shared<SchemaProxyBuilder>(client, table_->schema()));
+    this->set_schema_(schema);
     return Status::OK();
   }
 
  private:
   std::shared_ptr<arrow::Table> table_;
+  bool combine_chunks_ = false;
 };
 
 /**
@@ -587,10 +816,13 @@ class TableExtender : public TableBaseBuilder {
     this->set_batch_num_(record_batch_extenders_.size());
     this->set_num_rows_(row_num_);
     this->set_num_columns_(column_num_);
+    // all batches and the table itself share a single schema proxy
+    auto schema = SchemaProxyBuilder(client, schema_).Seal(client);
     for (auto const& extender : record_batch_extenders_) {
+      extender->set_shared_schema(schema);
       this->add_batches_(extender);
     }
-    this->set_schema_(std::make_shared<SchemaProxyBuilder>(client, schema_));
+    this->set_schema_(schema);
     return Status::OK();
   }
 
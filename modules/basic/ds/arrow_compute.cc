@@ -0,0 +1,502 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "basic/ds/arrow_compute.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <type_traits>
+
+#include "arrow/buffer.h"
+#include "arrow/util/config.h"
+
+#include "basic/ds/arrow_utils.h"
+
+namespace vineyard {
+
+namespace detail {
+
+Status ResolveColumns(std::shared_ptr<arrow::Schema> const& schema,
+                      std::vector<std::string> const& columns,
+                      std::vector<int>& indices) {
+  indices.clear();
+  for (auto const& name : columns) {
+    int index = schema->GetFieldIndex(name);
+    if (index == -1) {
+      return Status::Invalid("Column '" + name + "' doesn't exist");
+    }
+    indices.push_back(index);
+  }
+  return Status::OK();
+}
+
+Status AllocateBuffer(int64_t size, std::shared_ptr<arrow::Buffer>& buffer) {
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  RETURN_ON_ARROW_ERROR(
+      arrow::AllocateBuffer(arrow::default_memory_pool(), size, &buffer));
+#else
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      buffer, arrow::AllocateBuffer(size, arrow::default_memory_pool()));
+#endif
+  return Status::OK();
+}
+
+template <typename T, typename Op>
+void CompareKernel(T const* values, int64_t length, T value,
+                   arrow::Array const& array, SelectionVector& selection) {
+  Op op;
+  bool has_nulls = array.null_count() > 0;
+  for (int64_t base = 0; base < length; base += 64) {
+    int64_t lanes = std::min<int64_t>(64, length - base);
+    uint64_t mask = 0;
+    // branch-free, so the loop can be vectorized by the compiler
+    for (int64_t lane = 0; lane < lanes; ++lane) {
+      mask |= static_cast<uint64_t>(op(values[base + lane], value)) << lane;
+    }
+    while (mask != 0) {
+      int64_t index = base + __builtin_ctzll(mask);
+      mask &= mask - 1;
+      if (!has_nulls || array.IsValid(index)) {
+        selection.push_back(index);
+      }
+    }
+  }
+}
+
+template <typename T>
+void GatherKernel(uint8_t const* values, SelectionVector const& selection,
+                  uint8_t* out) {
+  T const* source = reinterpret_cast<T const*>(values);
+  T* target = reinterpret_cast<T*>(out);
+  for (size_t i = 0; i < selection.size(); ++i) {
+    target[i] = source[selection[i]];
+  }
+}
+
+Status TakeValidity(arrow::Array const& array, SelectionVector const& selection,
+                    std::shared_ptr<arrow::Buffer>& validity,
+                    int64_t& null_count) {
+  null_count = 0;
+  if (array.null_count() == 0) {
+    validity = nullptr;
+    return Status::OK();
+  }
+  int64_t nbytes = (static_cast<int64_t>(selection.size()) + 7) / 8;
+  RETURN_ON_ERROR(AllocateBuffer(nbytes, validity));
+  uint8_t* bits = validity->mutable_data();
+  memset(bits, 0, nbytes);
+  for (size_t i = 0; i < selection.size(); ++i) {
+    if (array.IsValid(selection[i])) {
+      bits[i >> 3] |= static_cast<uint8_t>(1 << (i & 7));
+    } else {
+      null_count += 1;
+    }
+  }
+  return Status::OK();
+}
+
+Status TakeFixedWidth(std::shared_ptr<arrow::Array> const& array,
+                      int64_t byte_width, SelectionVector const& selection,
+                      std::shared_ptr<arrow::Array>& out) {
+  int64_t length = static_cast<int64_t>(selection.size());
+  std::shared_ptr<arrow::Buffer> validity, values;
+  int64_t null_count = 0;
+  RETURN_ON_ERROR(TakeValidity(*array, selection, validity, null_count));
+  RETURN_ON_ERROR(AllocateBuffer(length * byte_width, values));
+
+  uint8_t const* source =
+      array->data()->buffers[1]->data() + array->offset() * byte_width;
+  uint8_t* target = values->mutable_data();
+  switch (byte_width) {
+  case 1:
+    GatherKernel<uint8_t>(source, selection, target);
+    break;
+  case 2:
+    GatherKernel<uint16_t>(source, selection, target);
+    break;
+  case 4:
+    GatherKernel<uint32_t>(source, selection, target);
+    break;
+  case 8:
+    GatherKernel<uint64_t>(source, selection, target);
+    break;
+  default:
+    for (int64_t i = 0; i < length; ++i) {
+      memcpy(target + i * byte_width, source + selection[i] * byte_width,
+             byte_width);
+    }
+  }
+  out = arrow::MakeArray(arrow::ArrayData::Make(
+      array->type(), length, {validity, values}, null_count));
+  return Status::OK();
+}
+
+template <typename ArrayType, typename BuilderType>
+Status TakeBinary(std::shared_ptr<arrow::Array> const& array,
+                  SelectionVector const& selection,
+                  std::shared_ptr<arrow::Array>& out) {
+  auto source = std::dynamic_pointer_cast<ArrayType>(array);
+  BuilderType builder(array->type(), arrow::default_memory_pool());
+  RETURN_ON_ARROW_ERROR(builder.Reserve(selection.size()));
+  for (auto index : selection) {
+    if (source->IsNull(index)) {
+      RETURN_ON_ARROW_ERROR(builder.AppendNull());
+    } else {
+      RETURN_ON_ARROW_ERROR(builder.Append(source->GetView(index)));
+    }
+  }
+  RETURN_ON_ARROW_ERROR(builder.Finish(&out));
+  return Status::OK();
+}
+
+Status TakeBoolean(std::shared_ptr<arrow::Array> const& array,
+                   SelectionVector const& selection,
+                   std::shared_ptr<arrow::Array>& out) {
+  auto source = std::dynamic_pointer_cast<arrow::BooleanArray>(array);
+  arrow::BooleanBuilder builder;
+  RETURN_ON_ARROW_ERROR(builder.Reserve(selection.size()));
+  for (auto index : selection) {
+    if (source->IsNull(index)) {
+      RETURN_ON_ARROW_ERROR(builder.AppendNull());
+    } else {
+      RETURN_ON_ARROW_ERROR(builder.Append(source->Value(index)));
+    }
+  }
+  RETURN_ON_ARROW_ERROR(builder.Finish(&out));
+  return Status::OK();
+}
+
+template <typename T>
+bool MayMatch(T min_value, T max_value, CompareOp op, T value) {
+  switch (op) {
+  case CompareOp::kEqual:
+    return min_value <= value && value <= max_value;
+  case CompareOp::kNotEqual:
+    // NaNs are not covered by the zone map, and never equal to the value
+    if (std::is_floating_point<T>::value) {
+      return true;
+    }
+    return !(min_value == value && max_value == value);
+  case CompareOp::kLess:
+    return min_value < value;
+  case CompareOp::kLessEqual:
+    return min_value <= value;
+  case CompareOp::kGreater:
+    return max_value > value;
+  case CompareOp::kGreaterEqual:
+    return max_value >= value;
+  }
+  return true;
+}
+
+/**
+ * @brief Whether every row of the column satisfies `column op value`
+ * according to its zone map. NaNs are not covered by the zone map, thus
+ * floating point columns can only be decided for `kNotEqual`.
+ */
+template <typename T>
+bool MustMatch(std::shared_ptr<Object> const& column, CompareOp op, T value) {
+  auto array = std::dynamic_pointer_cast<NumericArray<T>>(column);
+  if (array == nullptr || !array->has_statistics() ||
+      array->null_count() != 0) {
+    return false;
+  }
+  if (std::is_floating_point<T>::value && op != CompareOp::kNotEqual) {
+    return false;
+  }
+  T min_value = array->min_value(), max_value = array->max_value();
+  switch (op) {
+  case CompareOp::kEqual:
+    return min_value == value && max_value == value;
+  case CompareOp::kNotEqual:
+    return !MayMatch(min_value, max_value, CompareOp::kEqual, value);
+  case CompareOp::kLess:
+    return max_value < value;
+  case CompareOp::kLessEqual:
+    return max_value <= value;
+  case CompareOp::kGreater:
+    return min_value > value;
+  case CompareOp::kGreaterEqual:
+    return min_value >= value;
+  }
+  return false;
+}
+
+bool IsIdentity(SelectionVector const& selection, int64_t num_rows) {
+  if (static_cast<int64_t>(selection.size()) != num_rows) {
+    return false;
+  }
+  for (size_t i = 0; i < selection.size(); ++i) {
+    if (selection[i] != static_cast<int64_t>(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace detail
+
+Status Project(std::shared_ptr<arrow::RecordBatch> const& batch,
+               std::vector<std::string> const& columns,
+               std::shared_ptr<arrow::RecordBatch>& out) {
+  std::vector<int> indices;
+  RETURN_ON_ERROR(detail::ResolveColumns(batch->schema(), columns, indices));
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  std::vector<std::shared_ptr<arrow::Array>> arrays;
+  for (int index : indices) {
+    fields.push_back(batch->schema()->field(index));
+    arrays.push_back(batch->column(index));
+  }
+  out = arrow::RecordBatch::Make(
+      arrow::schema(fields, batch->schema()->metadata()), batch->num_rows(),
+      arrays);
+  return Status::OK();
+}
+
+template <typename T>
+Status Compare(std::shared_ptr<arrow::Array> const& array, CompareOp op,
+               T value, SelectionVector& selection) {
+  using ArrayType = typename ConvertToArrowType<T>::ArrayType;
+  if (!array->type()->Equals(ConvertToArrowType<T>::TypeValue())) {
+    return Status::Invalid("Cannot compare array of type " +
+                           array->type()->ToString() + " with the value");
+  }
+  T const* values =
+      std::dynamic_pointer_cast<ArrayType>(array)->raw_values();
+  int64_t length = array->length();
+  selection.clear();
+  switch (op) {
+  case CompareOp::kEqual:
+    detail::CompareKernel<T, std::equal_to<T>>(values, length, value, *array,
+                                               selection);
+    break;
+  case CompareOp::kNotEqual:
+    detail::CompareKernel<T, std::not_equal_to<T>>(values, length, value,
+                                                   *array, selection);
+    break;
+  case CompareOp::kLess:
+    detail::CompareKernel<T, std::less<T>>(values, length, value, *array,
+                                           selection);
+    break;
+  case CompareOp::kLessEqual:
+    detail::CompareKernel<T, std::less_equal<T>>(values, length, value,
+                                                 *array, selection);
+    break;
+  case CompareOp::kGreater:
+    detail::CompareKernel<T, std::greater<T>>(values, length, value, *array,
+                                              selection);
+    break;
+  case CompareOp::kGreaterEqual:
+    detail::CompareKernel<T, std::greater_equal<T>>(values, length, value,
+                                                    *array, selection);
+    break;
+  }
+  return Status::OK();
+}
+
+Status Take(std::shared_ptr<arrow::Array> const& array,
+            SelectionVector const& selection,
+            std::shared_ptr<arrow::Array>& out) {
+  for (auto index : selection) {
+    if (index < 0 || index >= array->length()) {
+      return Status::Invalid("The selected row " + std::to_string(index) +
+                             " is out of range");
+    }
+  }
+  switch (array->type_id()) {
+  case arrow::Type::BOOL:
+    return detail::TakeBoolean(array, selection, out);
+  case arrow::Type::STRING:
+    return detail::TakeBinary<arrow::StringArray, arrow::StringBuilder>(
+        array, selection, out);
+  case arrow::Type::BINARY:
+    return detail::TakeBinary<arrow::BinaryArray, arrow::BinaryBuilder>(
+        array, selection, out);
+  case arrow::Type::LARGE_STRING:
+    return detail::TakeBinary<arrow::LargeStringArray,
+                              arrow::LargeStringBuilder>(array, selection, out);
+  case arrow::Type::LARGE_BINARY:
+    return detail::TakeBinary<arrow::LargeBinaryArray,
+                              arrow::LargeBinaryBuilder>(array, selection, out);
+  case arrow::Type::DICTIONARY:
+  case arrow::Type::EXTENSION:
+    break;
+  default: {
+    auto type = std::dynamic_pointer_cast<arrow::FixedWidthType>(array->type());
+    if (type != nullptr && type->bit_width() % 8 == 0) {
+      return detail::TakeFixedWidth(array, type->bit_width() / 8, selection,
+                                    out);
+    }
+  }
+  }
+  return Status::NotImplemented("Take is not supported for arrays of type " +
+                                array->type()->ToString());
+}
+
+Status Take(std::shared_ptr<arrow::RecordBatch> const& batch,
+            SelectionVector const& selection,
+            std::shared_ptr<arrow::RecordBatch>& out) {
+  std::vector<std::shared_ptr<arrow::Array>> arrays(batch->num_columns());
+  for (int index = 0; index < batch->num_columns(); ++index) {
+    RETURN_ON_ERROR(Take(batch->column(index), selection, arrays[index]));
+  }
+  out = arrow::RecordBatch::Make(batch->schema(), selection.size(), arrays);
+  return Status::OK();
+}
+
+Status Project(Client& client, std::shared_ptr<Table> const& table,
+               std::vector<std::string> const& columns,
+               std::shared_ptr<Object>& out) {
+  std::vector<int> indices;
+  RETURN_ON_ERROR(detail::ResolveColumns(table->schema(), columns, indices));
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  for (int index : indices) {
+    fields.push_back(table->schema()->field(index));
+  }
+  auto schema =
+      SchemaProxyBuilder(client,
+                         arrow::schema(fields, table->schema()->metadata()))
+          .Seal(client);
+
+  TableBaseBuilder builder(client);
+  builder.set_batch_num_(table->batch_num());
+  builder.set_num_rows_(table->num_rows());
+  builder.set_num_columns_(indices.size());
+  builder.set_schema_(schema);
+  for (auto const& batch : table->batches()) {
+    auto batch_builder = std::make_shared<RecordBatchBaseBuilder>(client);
+    batch_builder->set_column_num_(indices.size());
+    batch_builder->set_row_num_(batch->num_rows());
+    batch_builder->set_schema_(schema);
+    for (int index : indices) {
+      batch_builder->add_columns_(batch->columns()[index]);
+    }
+    builder.add_batches_(batch_builder);
+  }
+  out = builder.Seal(client);
+  return Status::OK();
+}
+
+Status Take(Client& client, std::shared_ptr<Table> const& table,
+            std::vector<SelectionVector> const& selections,
+            std::shared_ptr<Object>& out) {
+  if (selections.size() != table->batch_num()) {
+    return Status::Invalid(
+        "The number of selections doesn't match the number of batches");
+  }
+  auto schema = table->meta().GetMember("schema_");
+
+  TableBaseBuilder builder(client);
+  size_t num_rows = 0;
+  for (size_t index = 0; index < selections.size(); ++index) {
+    auto const& batch = table->batches()[index];
+    auto const& selection = selections[index];
+    num_rows += selection.size();
+    if (detail::IsIdentity(selection, batch->num_rows())) {
+      builder.add_batches_(batch);
+      continue;
+    }
+    std::shared_ptr<arrow::RecordBatch> taken;
+    RETURN_ON_ERROR(Take(batch->GetRecordBatch(), selection, taken));
+    builder.add_batches_(
+        std::make_shared<RecordBatchBuilder>(client, taken, schema));
+  }
+  builder.set_batch_num_(table->batch_num());
+  builder.set_num_rows_(num_rows);
+  builder.set_num_columns_(table->num_columns());
+  builder.set_schema_(schema);
+  out = builder.Seal(client);
+  return Status::OK();
+}
+
+template <typename T>
+bool MayMatch(std::shared_ptr<Object> const& column, CompareOp op, T value) {
+  auto array = std::dynamic_pointer_cast<NumericArray<T>>(column);
+  if (array == nullptr || !array->has_statistics()) {
+    return true;
+  }
+  return detail::MayMatch(array->min_value(), array->max_value(), op, value);
+}
+
+template <typename T>
+Status PruneBatches(std::shared_ptr<Table> const& table,
+                    std::string const& column, CompareOp op, T value,
+                    std::vector<size_t>& batches) {
+  std::vector<int> indices;
+  RETURN_ON_ERROR(detail::ResolveColumns(table->schema(), {column}, indices));
+  batches.clear();
+  for (size_t index = 0; index < table->batch_num(); ++index) {
+    auto const& batch = table->batches()[index];
+    if (MayMatch<T>(batch->columns()[indices[0]], op, value)) {
+      batches.push_back(index);
+    }
+  }
+  return Status::OK();
+}
+
+template <typename T>
+Status Filter(Client& client, std::shared_ptr<Table> const& table,
+              std::string const& column, CompareOp op, T value,
+              std::shared_ptr<Object>& out) {
+  std::vector<int> indices;
+  RETURN_ON_ERROR(detail::ResolveColumns(table->schema(), {column}, indices));
+  std::vector<SelectionVector> selections(table->batch_num());
+  for (size_t index = 0; index < table->batch_num(); ++index) {
+    auto const& batch = table->batches()[index];
+    auto const& chunk = batch->columns()[indices[0]];
+    if (!MayMatch<T>(chunk, op, value)) {
+      continue;
+    }
+    if (detail::MustMatch<T>(chunk, op, value)) {
+      selections[index].resize(batch->num_rows());
+      std::iota(selections[index].begin(), selections[index].end(), 0);
+      continue;
+    }
+    RETURN_ON_ERROR(Compare<T>(batch->GetRecordBatch()->column(indices[0]),
+                               op, value, selections[index]));
+  }
+  return Take(client, table, selections, out);
+}
+
+#define INSTANTIATE_COMPUTE_KERNELS(T)                                       \
+  template Status Compare<T>(std::shared_ptr<arrow::Array> const& array,     \
+                             CompareOp op, T value,                          \
+                             SelectionVector& selection);                    \
+  template Status Filter<T>(Client & client,                                 \
+                            std::shared_ptr<Table> const& table,             \
+                            std::string const& column, CompareOp op,         \
+                            T value, std::shared_ptr<Object>& out);          \
+  template bool MayMatch<T>(std::shared_ptr<Object> const& column,           \
+                            CompareOp op, T value);                          \
+  template Status PruneBatches<T>(std::shared_ptr<Table> const& table,       \
+                                  std::string const& column, CompareOp op,   \
+                                  T value, std::vector<size_t>& batches);
+
+INSTANTIATE_COMPUTE_KERNELS(int8_t)
+INSTANTIATE_COMPUTE_KERNELS(uint8_t)
+INSTANTIATE_COMPUTE_KERNELS(int16_t)
+INSTANTIATE_COMPUTE_KERNELS(uint16_t)
+INSTANTIATE_COMPUTE_KERNELS(int32_t)
+INSTANTIATE_COMPUTE_KERNELS(uint32_t)
+INSTANTIATE_COMPUTE_KERNELS(int64_t)
+INSTANTIATE_COMPUTE_KERNELS(uint64_t)
+INSTANTIATE_COMPUTE_KERNELS(float)
+INSTANTIATE_COMPUTE_KERNELS(double)
+
+#undef INSTANTIATE_COMPUTE_KERNELS
+
+}  // namespace vineyard
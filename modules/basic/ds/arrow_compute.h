@@ -0,0 +1,132 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_ARROW_COMPUTE_H_
+#define MODULES_BASIC_DS_ARROW_COMPUTE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/array.h"
+#include "arrow/record_batch.h"
+
+#include "basic/ds/arrow.h"
+#include "client/client.h"
+#include "common/util/status.h"
+
+namespace vineyard {
+
+enum class CompareOp {
+  kEqual,
+  kNotEqual,
+  kLess,
+  kLessEqual,
+  kGreater,
+  kGreaterEqual,
+};
+
+/**
+ * @brief The ascending positions of the selected rows, relative to the
+ * beginning of an array (or a record batch).
+ */
+using SelectionVector = std::vector<int64_t>;
+
+/**
+ * @brief Select the named columns of the batch, the result shares the
+ * column arrays of the input batch.
+ */
+Status Project(std::shared_ptr<arrow::RecordBatch> const& batch,
+               std::vector<std::string> const& columns,
+               std::shared_ptr<arrow::RecordBatch>& out);
+
+/**
+ * @brief Evaluate `array[i] op value` and collects the positions of the
+ * rows that satisfy the predicate, null values never match.
+ *
+ * The comparisons are evaluated 64 lanes at a time into a bit mask without
+ * branches, the set bits are extracted afterwards.
+ *
+ * @tparam T The arithmetic type that matches the type of the array.
+ */
+template <typename T>
+Status Compare(std::shared_ptr<arrow::Array> const& array, CompareOp op,
+               T value, SelectionVector& selection);
+
+/**
+ * @brief Gather the selected rows of the array into a new array.
+ *
+ * Fixed-width, boolean, string and binary arrays are supported.
+ */
+Status Take(std::shared_ptr<arrow::Array> const& array,
+            SelectionVector const& selection,
+            std::shared_ptr<arrow::Array>& out);
+
+Status Take(std::shared_ptr<arrow::RecordBatch> const& batch,
+            SelectionVector const& selection,
+            std::shared_ptr<arrow::RecordBatch>& out);
+
+/**
+ * @brief Build a vineyard table that consists of the named columns of the
+ * given table. The column objects are referenced rather than copied, only
+ * the metadata and the schema of the projection are created.
+ */
+Status Project(Client& client, std::shared_ptr<Table> const& table,
+               std::vector<std::string> const& columns,
+               std::shared_ptr<Object>& out);
+
+/**
+ * @brief Build a vineyard table of the selected rows of the given table, one
+ * selection vector for each record batch.
+ *
+ * Batches whose selection covers all rows, and the schema, are shared with
+ * the given table, new blobs are only allocated for the gathered batches.
+ */
+Status Take(Client& client, std::shared_ptr<Table> const& table,
+            std::vector<SelectionVector> const& selections,
+            std::shared_ptr<Object>& out);
+
+/**
+ * @brief Test the zone map of a column object, returns false only when the
+ * recorded minimum and maximum rule out every row for `column op value`.
+ *
+ * Columns without statistics are always assumed to match.
+ */
+template <typename T>
+bool MayMatch(std::shared_ptr<Object> const& column, CompareOp op, T value);
+
+/**
+ * @brief Collect the indices of the batches of the table whose zone maps of
+ * the given column don't rule out `column op value`.
+ */
+template <typename T>
+Status PruneBatches(std::shared_ptr<Table> const& table,
+                    std::string const& column, CompareOp op, T value,
+                    std::vector<size_t>& batches);
+
+/**
+ * @brief Build a vineyard table of the rows where `column op value` holds.
+ *
+ * The zone maps of the column are consulted first, batches they rule out are
+ * skipped without scanning, and batches where all rows match are shared.
+ */
+template <typename T>
+Status Filter(Client& client, std::shared_ptr<Table> const& table,
+              std::string const& column, CompareOp op, T value,
+              std::shared_ptr<Object>& out);
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_ARROW_COMPUTE_H_
@@ -15,6 +15,13 @@ limitations under the License.
 
 #include "basic/ds/arrow_utils.h"
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include "arrow/array/concatenate.h"
+#include "arrow/io/file.h"
 #include "arrow/io/memory.h"
 #include "arrow/ipc/options.h"
 #include "arrow/ipc/reader.h"
@@ -31,6 +38,11 @@ std::shared_ptr<arrow::Table> ConcatenateTables(
   }
   auto col_names = tables[0]->ColumnNames();
   for (size_t i = 1; i < tables.size(); ++i) {
+    // renaming rebuilds the schema and the table, which is needless when the
+    // names match already, e.g., for the chunks of the same input
+    if (tables[i]->ColumnNames() == col_names) {
+      continue;
+    }
 #if defined(ARROW_VERSION) && ARROW_VERSION < 17000
     CHECK_ARROW_ERROR(tables[i]->RenameColumns(col_names, &tables[i]));
 #else
@@ -43,6 +55,26 @@ std::shared_ptr<arrow::Table> ConcatenateTables(
   return table;
 }
 
+Status ConcatenateChunks(const std::shared_ptr<arrow::ChunkedArray>& chunks,
+                         std::shared_ptr<arrow::Array>* array) {
+  if (chunks->num_chunks() == 1) {
+    *array = chunks->chunk(0);
+    return Status::OK();
+  }
+  if (chunks->num_chunks() == 0) {
+    return Status::Invalid("Cannot concatenate a column without chunks");
+  }
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  RETURN_ON_ARROW_ERROR(arrow::Concatenate(
+      chunks->chunks(), arrow::default_memory_pool(), array));
+#else
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      *array,
+      arrow::Concatenate(chunks->chunks(), arrow::default_memory_pool()));
+#endif
+  return Status::OK();
+}
+
 std::shared_ptr<arrow::DataType> FromAnyType(AnyType type) {
   switch (type) {
   case AnyType::Int32:
@@ -62,23 +94,74 @@ std::shared_ptr<arrow::DataType> FromAnyType(AnyType type) {
   }
 }
 
-Status GetRecordBatchStreamSize(const arrow::RecordBatch& batch, size_t* size) {
-  // emulates the behavior of Write without actually writing
-  arrow::io::MockOutputStream dst;
+namespace {
 
+/**
+ * @brief Write the batch to the stream in the arrow IPC stream format, i.e.,
+ * the schema, the batch and the end-of-stream marker.
+ */
+Status write_record_batch_stream(arrow::io::OutputStream* dst,
+                                 const arrow::RecordBatch& batch) {
   std::shared_ptr<arrow::ipc::RecordBatchWriter> writer;
 #if defined(ARROW_VERSION) && ARROW_VERSION < 17000
   RETURN_ON_ARROW_ERROR(
-      arrow::ipc::RecordBatchStreamWriter::Open(&dst, batch.schema(), &writer));
+      arrow::ipc::RecordBatchStreamWriter::Open(dst, batch.schema(), &writer));
 #elif defined(ARROW_VERSION) && ARROW_VERSION < 2000000
   RETURN_ON_ARROW_ERROR_AND_ASSIGN(
-      writer, arrow::ipc::NewStreamWriter(&dst, batch.schema()));
+      writer, arrow::ipc::NewStreamWriter(dst, batch.schema()));
 #else
   RETURN_ON_ARROW_ERROR_AND_ASSIGN(
-      writer, arrow::ipc::MakeStreamWriter(&dst, batch.schema()));
+      writer, arrow::ipc::MakeStreamWriter(dst, batch.schema()));
 #endif
   RETURN_ON_ARROW_ERROR(writer->WriteRecordBatch(batch));
   RETURN_ON_ARROW_ERROR(writer->Close());
+  return Status::OK();
+}
+
+/**
+ * @brief Run `task(index)` for the indices in `[0, task_num)` on at most
+ * `concurrency` threads, including the calling thread, each thread takes the
+ * next index from a shared counter.
+ */
+Status parallel_for_each(size_t const task_num, int concurrency,
+                         std::function<Status(size_t)> const& task) {
+  concurrency = static_cast<int>(
+      std::min(static_cast<size_t>(std::max(concurrency, 1)), task_num));
+  std::atomic<size_t> next(0);
+  std::vector<Status> statuses(std::max(concurrency, 1));
+  auto worker = [&](int const worker_index) {
+    for (size_t index = next++; index < task_num; index = next++) {
+      statuses[worker_index] &= task(index);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int worker_index = 1; worker_index < concurrency; ++worker_index) {
+    threads.emplace_back(worker, worker_index);
+  }
+  worker(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto const& status : statuses) {
+    RETURN_ON_ERROR(status);
+  }
+  return Status::OK();
+}
+
+// the streams of the batches start at aligned offsets, thus the buffers that
+// are read from them are aligned as well
+constexpr int64_t kStreamAlignment = 64;
+
+int64_t align_stream_offset(int64_t const offset) {
+  return (offset + kStreamAlignment - 1) / kStreamAlignment * kStreamAlignment;
+}
+
+}  // namespace
+
+Status GetRecordBatchStreamSize(const arrow::RecordBatch& batch, size_t* size) {
+  // emulates the behavior of Write without actually writing
+  arrow::io::MockOutputStream dst;
+  RETURN_ON_ERROR(write_record_batch_stream(&dst, batch));
   *size = dst.GetExtentBytesWritten();
   return Status::OK();
 }
@@ -104,6 +187,80 @@ Status SerializeRecordBatches(
   return Status::OK();
 }
 
+Status SerializeRecordBatchesInParallel(
+    const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches,
+    std::shared_ptr<arrow::Buffer>* buffer, int const concurrency) {
+  size_t batch_num = batches.size();
+  std::vector<size_t> sizes(batch_num);
+  RETURN_ON_ERROR(
+      parallel_for_each(batch_num, concurrency, [&](size_t index) {
+        return GetRecordBatchStreamSize(*batches[index], &sizes[index]);
+      }));
+
+  // | batch num | (offset, size) of each stream | padding | streams ... |
+  std::vector<int64_t> header(1 + 2 * batch_num);
+  header[0] = static_cast<int64_t>(batch_num);
+  int64_t streams_begin = align_stream_offset(header.size() * sizeof(int64_t));
+  int64_t offset = streams_begin;
+  for (size_t index = 0; index < batch_num; ++index) {
+    header[1 + 2 * index] = offset;
+    header[2 + 2 * index] = static_cast<int64_t>(sizes[index]);
+    offset = align_stream_offset(offset + sizes[index]);
+  }
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  RETURN_ON_ARROW_ERROR(
+      arrow::AllocateBuffer(arrow::default_memory_pool(), offset, buffer));
+#else
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      *buffer, arrow::AllocateBuffer(offset, arrow::default_memory_pool()));
+#endif
+  uint8_t* data = (*buffer)->mutable_data();
+  // the padding is zeroed, thus the serialized bytes are deterministic
+  memset(data, 0, streams_begin);
+  memcpy(data, header.data(), header.size() * sizeof(int64_t));
+  return parallel_for_each(batch_num, concurrency, [&](size_t index) {
+    int64_t begin = header[1 + 2 * index], size = header[2 + 2 * index];
+    int64_t end = index + 1 < batch_num ? header[3 + 2 * index] : offset;
+    memset(data + begin + size, 0, end - begin - size);
+    arrow::io::FixedSizeBufferWriter stream(
+        arrow::SliceMutableBuffer(*buffer, begin, size));
+    return write_record_batch_stream(&stream, *batches[index]);
+  });
+}
+
+Status DeserializeRecordBatchesInParallel(
+    const std::shared_ptr<arrow::Buffer>& buffer,
+    std::vector<std::shared_ptr<arrow::RecordBatch>>* batches,
+    int const concurrency) {
+  auto header = reinterpret_cast<const int64_t*>(buffer->data());
+  if (buffer->size() < static_cast<int64_t>(sizeof(int64_t)) ||
+      header[0] < 0 ||
+      buffer->size() <
+          static_cast<int64_t>((1 + 2 * header[0]) * sizeof(int64_t))) {
+    return Status::Invalid("The buffer of record batches is truncated");
+  }
+  size_t batch_num = static_cast<size_t>(header[0]);
+  for (size_t index = 0; index < batch_num; ++index) {
+    int64_t begin = header[1 + 2 * index], size = header[2 + 2 * index];
+    if (begin < 0 || size < 0 || begin + size > buffer->size()) {
+      return Status::Invalid("The buffer of record batches is corrupted");
+    }
+  }
+  std::vector<std::vector<std::shared_ptr<arrow::RecordBatch>>> streams(
+      batch_num);
+  RETURN_ON_ERROR(
+      parallel_for_each(batch_num, concurrency, [&](size_t index) {
+        return DeserializeRecordBatches(
+            arrow::SliceBuffer(buffer, header[1 + 2 * index],
+                               header[2 + 2 * index]),
+            &streams[index]);
+      }));
+  for (auto& stream : streams) {
+    batches->insert(batches->end(), stream.begin(), stream.end());
+  }
+  return Status::OK();
+}
+
 Status DeserializeRecordBatches(
     const std::shared_ptr<arrow::Buffer>& buffer,
     std::vector<std::shared_ptr<arrow::RecordBatch>>* batches) {
@@ -135,6 +292,10 @@ Status RecordBatchesToTable(
 Status CombineRecordBatches(
     const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches,
     std::shared_ptr<arrow::RecordBatch>* batch) {
+  if (batches.size() == 1) {
+    *batch = batches[0];
+    return Status::OK();
+  }
   std::shared_ptr<arrow::Table> table, combined_table;
   RETURN_ON_ERROR(RecordBatchesToTable(batches, &table));
 #if defined(ARROW_VERSION) && ARROW_VERSION < 17000
@@ -191,6 +352,43 @@ Status DeserializeTable(std::shared_ptr<arrow::Buffer> buffer,
   return Status::OK();
 }
 
+Status WriteTableToFile(std::shared_ptr<arrow::Table> table,
+                        const std::string& path) {
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  RETURN_ON_ERROR(TableToRecordBatches(table, &batches));
+  std::shared_ptr<arrow::io::FileOutputStream> out_stream;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  RETURN_ON_ARROW_ERROR(arrow::io::FileOutputStream::Open(path, &out_stream));
+#else
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(out_stream,
+                                   arrow::io::FileOutputStream::Open(path));
+#endif
+  RETURN_ON_ARROW_ERROR(arrow::ipc::WriteRecordBatchStream(
+      batches, arrow::ipc::IpcOptions::Defaults(), out_stream.get()));
+  RETURN_ON_ARROW_ERROR(out_stream->Close());
+  return Status::OK();
+}
+
+Status MapTableFromFile(const std::string& path,
+                        std::shared_ptr<arrow::Table>* table) {
+  std::shared_ptr<arrow::io::MemoryMappedFile> file;
+  std::shared_ptr<arrow::RecordBatchReader> batch_reader;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  RETURN_ON_ARROW_ERROR(arrow::io::MemoryMappedFile::Open(
+      path, arrow::io::FileMode::READ, &file));
+  RETURN_ON_ARROW_ERROR(
+      arrow::ipc::RecordBatchStreamReader::Open(file, &batch_reader));
+#else
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      file, arrow::io::MemoryMappedFile::Open(path, arrow::io::FileMode::READ));
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      batch_reader, arrow::ipc::RecordBatchStreamReader::Open(file));
+#endif
+  // reading from a memory-mapped file is zero-copy
+  RETURN_ON_ARROW_ERROR(batch_reader->ReadAll(table));
+  return Status::OK();
+}
+
 Status EmptyTableBuilder::Build(const std::shared_ptr<arrow::Schema>& schema,
                                 std::shared_ptr<arrow::Table>& table) {
   std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
@@ -185,10 +185,40 @@ Status DeserializeRecordBatches(
     const std::shared_ptr<arrow::Buffer>& buffer,
     std::vector<std::shared_ptr<arrow::RecordBatch>>* batches);
 
+/**
+ * @brief Serialize the batches on `concurrency` threads into one buffer,
+ * which is sized up front, where each batch is an IPC stream by itself in a
+ * disjoint region of the buffer, i.e.,
+ *
+ *    | batch num | (offset, size) of each stream | stream 0 | stream 1 | ...
+ *
+ * The buffer is read by DeserializeRecordBatchesInParallel, rather than by
+ * the readers of the arrow IPC stream format.
+ */
+Status SerializeRecordBatchesInParallel(
+    const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches,
+    std::shared_ptr<arrow::Buffer>* buffer, int const concurrency);
+
+/**
+ * @brief Deserialize the buffer of SerializeRecordBatchesInParallel on
+ * `concurrency` threads, in the order of the serialized batches, the batches
+ * reference the buffer rather than copying from it.
+ */
+Status DeserializeRecordBatchesInParallel(
+    const std::shared_ptr<arrow::Buffer>& buffer,
+    std::vector<std::shared_ptr<arrow::RecordBatch>>* batches,
+    int const concurrency);
+
 Status RecordBatchesToTable(
     const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches,
     std::shared_ptr<arrow::Table>* table);
 
+/**
+ * @brief Combine the batches into a single batch of contiguous columns, which
+ * copies the columns unless there is only one batch. Use
+ * RecordBatchesToTable instead when the chunked columns are fine, which only
+ * collects the chunks.
+ */
 Status CombineRecordBatches(
     const std::vector<std::shared_ptr<arrow::RecordBatch>>& batches,
     std::shared_ptr<arrow::RecordBatch>* batch);
@@ -206,6 +236,23 @@ Status SerializeTable(std::shared_ptr<arrow::Table> table,
 Status DeserializeTable(std::shared_ptr<arrow::Buffer> buffer,
                         std::shared_ptr<arrow::Table>* table);
 
+/**
+ * @brief Write the table to a local file in the arrow IPC stream format, e.g.,
+ * to spill it out of memory.
+ */
+Status WriteTableToFile(std::shared_ptr<arrow::Table> table,
+                        const std::string& path);
+
+/**
+ * @brief Read a table written by WriteTableToFile by memory-mapping the file,
+ * the buffers of the table reference the mapped pages rather than being read
+ * into memory, they are paged in on access and can be evicted by the kernel.
+ *
+ * The mapping stays valid after the file is removed.
+ */
+Status MapTableFromFile(const std::string& path,
+                        std::shared_ptr<arrow::Table>* table);
+
 struct EmptyTableBuilder {
   static Status Build(const std::shared_ptr<arrow::Schema>& schema,
                       std::shared_ptr<arrow::Table>& table);
@@ -214,11 +261,21 @@ struct EmptyTableBuilder {
 };
 
 /**
- * @brief Concatenate multiple arrow tables into one.
+ * @brief Concatenate multiple arrow tables into one, the columns of the result
+ * are the chunk lists of the inputs, i.e., no values are copied. The columns
+ * of the tables are renamed after the first table.
  */
 std::shared_ptr<arrow::Table> ConcatenateTables(
     std::vector<std::shared_ptr<arrow::Table>>& tables);
 
+/**
+ * @brief Concatenate the chunks of a column into a contiguous array, the only
+ * chunk is returned as is. See also TableBuilder, which concatenates the
+ * chunks right into the blobs when sealing a table.
+ */
+Status ConcatenateChunks(const std::shared_ptr<arrow::ChunkedArray>& chunks,
+                         std::shared_ptr<arrow::Array>* array);
+
 /**
  * @brief Convert type name in string to arrow type.
  *
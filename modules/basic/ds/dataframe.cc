@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "basic/ds/dataframe.h"
 
+#include "basic/ds/arrow_utils.h"
+
 namespace vineyard {
 
 class DataFrameBuilder;
@@ -143,6 +145,93 @@ Status DataFrameBuilder::Build(Client& client) {
   return Status::OK();
 }
 
+const std::vector<json>& ChunkedDataFrame::Columns() const {
+  return this->columns_;
+}
+
+const std::pair<size_t, size_t> ChunkedDataFrame::shape() const {
+  return std::make_pair(this->num_rows_, this->columns_.size());
+}
+
+const std::vector<std::shared_ptr<DataFrame>>& ChunkedDataFrame::Chunks()
+    const {
+  return this->chunks_;
+}
+
+std::vector<std::shared_ptr<ITensor>> ChunkedDataFrame::Column(
+    json const& column) const {
+  std::vector<std::shared_ptr<ITensor>> tensors;
+  for (auto const& chunk : chunks_) {
+    tensors.emplace_back(chunk->Column(column));
+  }
+  return tensors;
+}
+
+Status ChunkedDataFrame::AsTable(std::shared_ptr<arrow::Table>& table) const {
+  if (chunks_.empty()) {
+    return Status::Invalid("Cannot make a table from an empty dataframe");
+  }
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  for (auto const& chunk : chunks_) {
+    batches.emplace_back(chunk->AsBatch(false));
+  }
+  return RecordBatchesToTable(batches, &table);
+}
+
+ChunkedDataFrameBuilder::ChunkedDataFrameBuilder(Client& client)
+    : ChunkedDataFrameBaseBuilder(client) {
+  this->set_num_rows_(0);
+}
+
+ChunkedDataFrameBuilder::ChunkedDataFrameBuilder(
+    Client& client, std::shared_ptr<ChunkedDataFrame> const& base)
+    : ChunkedDataFrameBaseBuilder(base) {}
+
+Status ChunkedDataFrameBuilder::Append(
+    std::shared_ptr<DataFrame> const& chunk) {
+  if (this->chunks_.empty()) {
+    this->set_columns_(chunk->Columns());
+  } else if (chunk->Columns() != this->columns_) {
+    return Status::Invalid(
+        "The columns of the appended chunk don't match the dataframe");
+  }
+  this->set_num_rows_(this->num_rows_ + chunk->shape().first);
+  this->add_chunks_(chunk);
+  return Status::OK();
+}
+
+Status ChunkedDataFrameBuilder::Build(Client& client) { return Status::OK(); }
+
+namespace detail {
+
+/**
+ * @brief Index the partitions by rows, reusing the row offsets saved in the
+ * metadata when they are available.
+ */
+static void BuildPartitionIndex(
+    ObjectMeta const& meta, size_t partition_shape_row,
+    std::vector<std::shared_ptr<DataFrame>> const& partitions,
+    PartitionIndex& index) {
+  std::vector<size_t> row_partitions, num_rows;
+  for (auto const& partition : partitions) {
+    index.AddPartition(partition->id(), partition->meta().GetInstanceId(),
+                       partition->partition_index().first,
+                       partition->partition_index().second);
+    row_partitions.push_back(partition->partition_index().first);
+    num_rows.push_back(partition->shape().first);
+  }
+  if (meta.Haskey("row_offsets_")) {
+    std::vector<size_t> row_offsets;
+    meta.GetKeyValue("row_offsets_", row_offsets);
+    index.Finish(row_offsets);
+  } else {
+    index.Finish(PartitionIndex::RowOffsets(partition_shape_row,
+                                            row_partitions, num_rows));
+  }
+}
+
+}  // namespace detail
+
 void GlobalDataFrame::Construct(const ObjectMeta& meta) {
   std::string __type_name = type_name<GlobalDataFrame>();
   VINEYARD_ASSERT(meta.GetTypeName() == __type_name,
@@ -154,12 +243,16 @@ void GlobalDataFrame::Construct(const ObjectMeta& meta) {
   meta.GetKeyValue("partition_shape_row_", this->partition_shape_row_);
   meta.GetKeyValue("partition_shape_column_", this->partition_shape_column_);
 
+  std::vector<std::shared_ptr<DataFrame>> chunks;
   for (size_t __idx = 0; __idx < meta.GetKeyValue<size_t>("partitions_-size");
        ++__idx) {
     auto chunk = std::dynamic_pointer_cast<DataFrame>(
         meta.GetMember("partitions_-" + std::to_string(__idx)));
     this->partitions_[chunk->meta().GetInstanceId()].emplace_back(chunk);
+    chunks.emplace_back(chunk);
   }
+  detail::BuildPartitionIndex(meta, this->partition_shape_row_, chunks,
+                              this->index_);
 
   if (meta.IsLocal()) {
     this->PostConstruct(meta);
@@ -181,6 +274,13 @@ const std::vector<std::shared_ptr<DataFrame>>& GlobalDataFrame::LocalPartitions(
   return partitions_[instance_id];
 }
 
+size_t GlobalDataFrame::num_rows() const { return index_.num_rows(); }
+
+std::vector<PartitionLocation> GlobalDataFrame::LocateRows(size_t begin,
+                                                           size_t end) const {
+  return index_.LocateRows(begin, end);
+}
+
 std::shared_ptr<Object> GlobalDataFrameBaseBuilder::_Seal(Client& client) {
   // ensure the builder hasn't been sealed yet.
   ENSURE_NOT_SEALED(this);
@@ -206,6 +306,7 @@ std::shared_ptr<Object> GlobalDataFrameBaseBuilder::_Seal(Client& client) {
                              __value->partition_shape_column_);
 
   size_t __partitions__idx = 0;
+  std::vector<std::shared_ptr<DataFrame>> __chunks;
   for (auto& __partitions__value : partitions_) {
     auto __value_partitions_ = client.GetObject<DataFrame>(__partitions__value);
     __value->partitions_[__value_partitions_->meta().GetInstanceId()]
@@ -214,8 +315,13 @@ std::shared_ptr<Object> GlobalDataFrameBaseBuilder::_Seal(Client& client) {
                              __partitions__value);
     __value_nbytes += __value_partitions_->nbytes();
     __partitions__idx += 1;
+    __chunks.emplace_back(__value_partitions_);
   }
-  __value->meta_.AddKeyValue("partitions_-size", __value->partitions_.size());
+  __value->meta_.AddKeyValue("partitions_-size", __partitions__idx);
+
+  detail::BuildPartitionIndex(__value->meta_, __value->partition_shape_row_,
+                              __chunks, __value->index_);
+  __value->meta_.AddKeyValue("row_offsets_", __value->index_.row_offsets());
 
   __value->meta_.SetNBytes(__value_nbytes);
 
@@ -30,6 +30,7 @@ limitations under the License.
 #include "basic/ds/array.h"
 #include "basic/ds/arrow.h"
 #include "basic/ds/dataframe.vineyard.h"
+#include "basic/ds/partition_index.h"
 #include "basic/ds/tensor.h"
 #include "client/client.h"
 #include "client/ds/blob.h"
@@ -47,7 +48,10 @@ namespace vineyard {
  */
 class DataFrameBuilder : public DataFrameBaseBuilder {
  public:
-  explicit DataFrameBuilder(Client& client) : DataFrameBaseBuilder(client) {}
+  explicit DataFrameBuilder(Client& client) : DataFrameBaseBuilder(client) {
+    this->set_partition_index(0, 0);
+    this->set_row_batch_index(0);
+  }
 
   /**
    * @brief Get the partition index of the global dataframe.
@@ -118,6 +122,41 @@ class DataFrameBuilder : public DataFrameBaseBuilder {
   std::unordered_map<json, std::shared_ptr<ITensorBuilder>> values_;
 };
 
+/**
+ * @brief ChunkedDataFrameBuilder is used for constructing chunked dataframes,
+ * or appending row chunks to an existing chunked dataframe without copying
+ * or rebuilding the existing chunks.
+ *
+ */
+class ChunkedDataFrameBuilder : public ChunkedDataFrameBaseBuilder {
+ public:
+  explicit ChunkedDataFrameBuilder(Client& client);
+
+  /**
+   * @brief Initialize the builder with the chunks of an existing chunked
+   * dataframe, where the new chunks will be appended after them.
+   *
+   * @param client The client connected to the vineyard server.
+   * @param base The existing chunked dataframe.
+   */
+  ChunkedDataFrameBuilder(Client& client,
+                          std::shared_ptr<ChunkedDataFrame> const& base);
+
+  /**
+   * @brief Append a row chunk, whose columns must be the same as the existing
+   * chunks.
+   *
+   * @param chunk The dataframe of the row chunk.
+   */
+  Status Append(std::shared_ptr<DataFrame> const& chunk);
+
+  /**
+   * @brief Build the chunked dataframe object.
+   * @param client The client connected to the vineyard server.
+   */
+  Status Build(Client& client) override;
+};
+
 class GlobalDataFrameBaseBuilder;
 
 /**
@@ -160,6 +199,19 @@ class GlobalDataFrame : public Registered<GlobalDataFrame>, GlobalObject {
   const std::vector<std::shared_ptr<DataFrame>>& LocalPartitions(
       const InstanceID instance_id) const;
 
+  /**
+   * @brief Get the total number of rows of the global dataframe.
+   */
+  size_t num_rows() const;
+
+  /**
+   * @brief Locate the partitions that hold the global rows in `[begin, end)`.
+   *
+   * @return The IDs of the partitions and the instances that own them, ordered
+   * by rows and then by columns.
+   */
+  std::vector<PartitionLocation> LocateRows(size_t begin, size_t end) const;
+
  private:
   size_t partition_shape_row_;
   size_t partition_shape_column_;
@@ -167,6 +219,8 @@ class GlobalDataFrame : public Registered<GlobalDataFrame>, GlobalObject {
   mutable std::map<InstanceID, std::vector<std::shared_ptr<DataFrame>>>
       partitions_;
 
+  PartitionIndex index_;
+
   friend class Client;
   friend class GlobalDataFrameBaseBuilder;
 };
@@ -0,0 +1,269 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_ENCODED_ARRAY_H_
+#define MODULES_BASIC_DS_ENCODED_ARRAY_H_
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "flat_hash_map/flat_hash_map.hpp"
+
+#include "basic/ds/arrow_utils.h"
+#include "basic/ds/encoded_array.vineyard.h"
+#include "client/client.h"
+#include "client/ds/blob.h"
+
+namespace vineyard {
+
+/**
+ * @brief EncodedArrayBuilder encodes an arrow integer array with the given
+ * encoding, or with the encoding that yields the smallest payload when no
+ * encoding is specified.
+ *
+ * @tparam T The integral value type.
+ */
+template <typename T>
+class EncodedArrayBuilder : public EncodedArrayBaseBuilder<T> {
+ public:
+  using ArrayType = typename ConvertToArrowType<T>::ArrayType;
+
+  /**
+   * @brief Dictionaries larger than this are never chosen automatically.
+   */
+  static constexpr size_t kMaxDictionarySize = 1 << 16;
+
+  EncodedArrayBuilder(Client& client, std::shared_ptr<ArrayType> array)
+      : EncodedArrayBaseBuilder<T>(client), array_(array) {
+    prepare();
+    encoding_ = chooseEncoding();
+  }
+
+  EncodedArrayBuilder(Client& client, std::shared_ptr<ArrayType> array,
+                      ArrayEncoding encoding)
+      : EncodedArrayBaseBuilder<T>(client),
+        array_(array),
+        encoding_(encoding) {
+    prepare();
+  }
+
+  ArrayEncoding encoding() const { return encoding_; }
+
+  /**
+   * @brief The number of bytes of the encoded payload, excluding the null
+   * bitmap.
+   */
+  size_t EncodedSize() const { return encodedSize(encoding_); }
+
+  Status Build(Client& client) override {
+    this->set_encoding_(static_cast<int>(encoding_));
+    this->set_length_(values_.size());
+    this->set_null_count_(array_->null_count());
+    this->set_reference_(static_cast<int64_t>(min_value_));
+    switch (encoding_) {
+    case ArrayEncoding::kFrameOfReference:
+      RETURN_ON_ERROR(buildFrameOfReference(client));
+      break;
+    case ArrayEncoding::kDictionary:
+      RETURN_ON_ERROR(buildDictionary(client));
+      break;
+    case ArrayEncoding::kRunLength:
+      RETURN_ON_ERROR(buildRunLength(client));
+      break;
+    }
+    return buildNullBitmap(client);
+  }
+
+ private:
+  /**
+   * @brief Collect the values, null slots repeat the previous valid value so
+   * that they neither widen the range nor break the runs.
+   */
+  void prepare() {
+    int64_t length = array_->length();
+    values_.resize(length);
+    T const* values = array_->raw_values();
+    T last = T{};
+    bool seen = false;
+    for (int64_t i = 0; i < length; ++i) {
+      if (array_->IsValid(i)) {
+        last = values[i];
+        if (!seen) {
+          std::fill(values_.begin(), values_.begin() + i, last);
+          min_value_ = max_value_ = last;
+          seen = true;
+        }
+      }
+      values_[i] = last;
+      if (seen) {
+        min_value_ = std::min(min_value_, last);
+        max_value_ = std::max(max_value_, last);
+      }
+    }
+    num_runs_ = 0;
+    for (size_t i = 0; i < values_.size(); ++i) {
+      num_runs_ += (i == 0 || values_[i] != values_[i - 1]);
+    }
+    for (auto const& value : values_) {
+      if (dictionary_.size() > kMaxDictionarySize) {
+        break;
+      }
+      dictionary_.emplace(value, 0);
+    }
+  }
+
+  size_t encodedSize(ArrayEncoding encoding) const {
+    switch (encoding) {
+    case ArrayEncoding::kFrameOfReference:
+      return bit_packing::packed_size(values_.size(), rangeWidth());
+    case ArrayEncoding::kDictionary:
+      return dictionary_.size() * sizeof(T) +
+             bit_packing::packed_size(values_.size(), codeWidth());
+    case ArrayEncoding::kRunLength:
+      return num_runs_ * (sizeof(T) + sizeof(int64_t));
+    }
+    return 0;
+  }
+
+  ArrayEncoding chooseEncoding() const {
+    ArrayEncoding encoding = ArrayEncoding::kFrameOfReference;
+    size_t size = encodedSize(encoding);
+    if (dictionary_.size() <= kMaxDictionarySize &&
+        encodedSize(ArrayEncoding::kDictionary) < size) {
+      encoding = ArrayEncoding::kDictionary;
+      size = encodedSize(encoding);
+    }
+    if (encodedSize(ArrayEncoding::kRunLength) < size) {
+      encoding = ArrayEncoding::kRunLength;
+    }
+    return encoding;
+  }
+
+  int rangeWidth() const {
+    return bit_packing::bit_width(static_cast<uint64_t>(max_value_) -
+                                  static_cast<uint64_t>(min_value_));
+  }
+
+  int codeWidth() const {
+    return dictionary_.empty() ? 0
+                               : bit_packing::bit_width(dictionary_.size() - 1);
+  }
+
+  Status buildPacked(Client& client, std::vector<uint64_t> const& codes,
+                     int bit_width) {
+    std::unique_ptr<BlobWriter> writer;
+    RETURN_ON_ERROR(client.CreateBlob(
+        bit_packing::packed_size(codes.size(), bit_width), writer));
+    bit_packing::pack(codes.data(), codes.size(), bit_width,
+                      reinterpret_cast<uint64_t*>(writer->data()));
+    this->set_bit_width_(bit_width);
+    this->set_data_(std::shared_ptr<BlobWriter>(std::move(writer)));
+    return Status::OK();
+  }
+
+  Status buildFrameOfReference(Client& client) {
+    std::vector<uint64_t> offsets(values_.size());
+    for (size_t i = 0; i < values_.size(); ++i) {
+      offsets[i] = static_cast<uint64_t>(values_[i]) -
+                   static_cast<uint64_t>(min_value_);
+    }
+    this->set_num_values_(0);
+    this->set_values_(Blob::MakeEmpty(client));
+    return buildPacked(client, offsets, rangeWidth());
+  }
+
+  Status buildDictionary(Client& client) {
+    if (dictionary_.size() > kMaxDictionarySize) {
+      return Status::Invalid(
+          "Too many distinct values for the dictionary encoding");
+    }
+    std::vector<T> dictionary;
+    dictionary.reserve(dictionary_.size());
+    for (auto const& kv : dictionary_) {
+      dictionary.push_back(kv.first);
+    }
+    // sorted dictionaries preserve the order of values in the codes
+    std::sort(dictionary.begin(), dictionary.end());
+    for (size_t i = 0; i < dictionary.size(); ++i) {
+      dictionary_[dictionary[i]] = i;
+    }
+    std::vector<uint64_t> codes(values_.size());
+    for (size_t i = 0; i < values_.size(); ++i) {
+      codes[i] = dictionary_[values_[i]];
+    }
+    RETURN_ON_ERROR(writeValues(client, dictionary));
+    return buildPacked(client, codes, codeWidth());
+  }
+
+  Status buildRunLength(Client& client) {
+    std::vector<T> values;
+    std::unique_ptr<BlobWriter> writer;
+    RETURN_ON_ERROR(client.CreateBlob(num_runs_ * sizeof(int64_t), writer));
+    int64_t* ends = reinterpret_cast<int64_t*>(writer->data());
+    for (size_t i = 0; i < values_.size(); ++i) {
+      if (i + 1 == values_.size() || values_[i + 1] != values_[i]) {
+        ends[values.size()] = i + 1;
+        values.push_back(values_[i]);
+      }
+    }
+    this->set_bit_width_(sizeof(int64_t) * 8);
+    this->set_data_(std::shared_ptr<BlobWriter>(std::move(writer)));
+    return writeValues(client, values);
+  }
+
+  Status writeValues(Client& client, std::vector<T> const& values) {
+    std::unique_ptr<BlobWriter> writer;
+    RETURN_ON_ERROR(client.CreateBlob(values.size() * sizeof(T), writer));
+    memcpy(writer->data(), values.data(), values.size() * sizeof(T));
+    this->set_num_values_(values.size());
+    this->set_values_(std::shared_ptr<BlobWriter>(std::move(writer)));
+    return Status::OK();
+  }
+
+  Status buildNullBitmap(Client& client) {
+    if (array_->null_count() == 0) {
+      this->set_null_bitmap_(Blob::MakeEmpty(client));
+      return Status::OK();
+    }
+    // rebuilt rather than copied, as the arrow array may have an offset
+    size_t nbytes = (values_.size() + 7) / 8;
+    std::unique_ptr<BlobWriter> writer;
+    RETURN_ON_ERROR(client.CreateBlob(nbytes, writer));
+    uint8_t* bits = reinterpret_cast<uint8_t*>(writer->data());
+    memset(bits, 0, nbytes);
+    for (size_t i = 0; i < values_.size(); ++i) {
+      if (array_->IsValid(i)) {
+        bits[i >> 3] |= static_cast<uint8_t>(1 << (i & 7));
+      }
+    }
+    this->set_null_bitmap_(std::shared_ptr<BlobWriter>(std::move(writer)));
+    return Status::OK();
+  }
+
+  std::shared_ptr<ArrayType> array_;
+  ArrayEncoding encoding_;
+
+  std::vector<T> values_;
+  T min_value_ = T{}, max_value_ = T{};
+  size_t num_runs_ = 0;
+  ska::flat_hash_map<T, uint64_t> dictionary_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_ENCODED_ARRAY_H_
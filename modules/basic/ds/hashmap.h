@@ -17,10 +17,13 @@ limitations under the License.
 #define MODULES_BASIC_DS_HASHMAP_H_
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "flat_hash_map/flat_hash_map.hpp"
 
@@ -181,6 +184,242 @@ class HashmapBuilder : public HashmapBaseBuilder<K, V, H, E> {
   ska::flat_hash_map<K, V, H, E> hashmap_;
 };
 
+/**
+ * @brief ConcurrentHashmapBuilder constructs a hashmap from many threads at
+ * the same time.
+ *
+ * The table is laid out directly in a blob with the same format as the one
+ * used by Hashmap, thus Build() doesn't need to copy the entries. The number
+ * of buckets is fixed by the capacity given at construction, and the slots are
+ * protected by striped locks which are always acquired in ascending order.
+ *
+ * Elements that don't fit into the table (i.e., whose probe would exceed the
+ * max lookups) are kept aside and the table is rebuilt by Build(), which is
+ * expected to be rare when the capacity is estimated well.
+ *
+ * @tparam K The type for the key.
+ * @tparam V The type for the value.
+ * @tparam std::hash<K> The hash function for the key.
+ * @tparam std::equal_to<K> The compare function for the key.
+ */
+template <typename K, typename V, typename H = std::hash<K>,
+          typename E = std::equal_to<K>>
+class ConcurrentHashmapBuilder : public HashmapBaseBuilder<K, V, H, E> {
+  using entry_t = typename Hashmap<K, V, H, E>::Entry;
+  using value_t = typename Hashmap<K, V, H, E>::value_type;
+
+  static constexpr size_t kStripeSize = 256;
+
+ public:
+  /**
+   * @brief Initialize the builder with the expected number of elements.
+   *
+   * @param client The client connected to the vineyard server.
+   * @param capacity The expected number of elements.
+   */
+  ConcurrentHashmapBuilder(Client& client, size_t capacity)
+      : HashmapBaseBuilder<K, V, H, E>(client), num_elements_(0) {
+    // keep the same max load factor as ska::flat_hash_map
+    num_buckets_ = std::max<size_t>(capacity * 2, 2);
+    // the hash policies are nested in `ska::ska` in the bundled header
+    ska::ska::prime_number_hash_policy().next_size_over(num_buckets_);
+    max_lookups_ = std::max(ska::detailv3::min_lookups,
+                            ska::detailv3::log2(num_buckets_));
+
+    size_t entry_size = num_buckets_ + max_lookups_;
+    entries_ = std::make_shared<ArrayBuilder<entry_t>>(client, entry_size);
+    entry_t* entries = entries_->data();
+    for (size_t index = 0; index + 1 < entry_size; ++index) {
+      new (entries + index) entry_t();
+    }
+    new (entries + entry_size - 1) entry_t(entry_t::special_end_value);
+
+    num_stripes_ = (entry_size + kStripeSize - 1) / kStripeSize;
+    stripes_.reset(new std::mutex[num_stripes_]);
+  }
+
+  /**
+   * @brief Emplace key-value pair into the hashmap, can be called from
+   * multiple threads concurrently.
+   *
+   * @return false if the key already exists in the hashmap.
+   */
+  bool emplace(const K& key, const V& value) {
+    size_t index = H()(key) % num_buckets_;
+    entry_t* entries = entries_->data();
+    stripe_guard_t guard(*this, index);
+
+    size_t position = index;
+    int8_t distance = 0;
+    while (true) {
+      guard.cover(position);
+      if (entries[position].distance_from_desired < distance) {
+        break;
+      }
+      if (E()(key, entries[position].value.first)) {
+        return false;
+      }
+      ++position;
+      ++distance;
+    }
+
+    // the emplacing of the same key is serialized by the stripe of its
+    // desired slot, which is held until the key is inserted
+    bool const fit = fits(guard, position, distance);
+    if (!fit || overflowed_.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> lock(overflow_mutex_);
+      for (auto const& item : overflow_) {
+        if (E()(key, item.first)) {
+          return false;
+        }
+      }
+      if (!fit) {
+        overflow_.emplace_back(key, value);
+        overflowed_.store(true, std::memory_order_release);
+        num_elements_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+
+    // robin-hood insertion, stays within the stripes covered by `fits()`
+    value_t carried(key, value);
+    while (true) {
+      entry_t& entry = entries[position];
+      if (entry.is_empty()) {
+        entry.emplace(distance, std::move(carried));
+        break;
+      }
+      if (entry.distance_from_desired < distance) {
+        std::swap(carried, entry.value);
+        std::swap(distance, entry.distance_from_desired);
+      }
+      ++position;
+      ++distance;
+    }
+    num_elements_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /**
+   * @brief Get the number of elements that have been emplaced.
+   *
+   */
+  size_t size() const { return num_elements_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Build the hashmap object, must be called after all emplacing
+   * threads finish.
+   *
+   */
+  Status Build(Client& client) override {
+    if (!overflow_.empty()) {
+      return rebuild(client);
+    }
+    this->set_num_slots_minus_one_(num_buckets_ - 1);
+    this->set_max_lookups_(max_lookups_);
+    this->set_num_elements_(size());
+    this->set_entries_(std::static_pointer_cast<ObjectBase>(entries_));
+    return Status::OK();
+  }
+
+ private:
+  /**
+   * @brief Holds the consecutive stripes from the desired slot of a key to the
+   * farthest slot that has been visited.
+   */
+  class stripe_guard_t {
+   public:
+    stripe_guard_t(ConcurrentHashmapBuilder& builder, size_t position)
+        : builder_(builder),
+          first_(position / kStripeSize),
+          last_(position / kStripeSize) {
+      builder_.stripes_[first_].lock();
+    }
+
+    ~stripe_guard_t() {
+      for (size_t stripe = first_; stripe <= last_; ++stripe) {
+        builder_.stripes_[stripe].unlock();
+      }
+    }
+
+    void cover(size_t position) {
+      size_t stripe = position / kStripeSize;
+      while (last_ < stripe) {
+        builder_.stripes_[++last_].lock();
+      }
+    }
+
+   private:
+    ConcurrentHashmapBuilder& builder_;
+    size_t first_, last_;
+  };
+
+  /**
+   * @brief Simulate the robin-hood insertion starting from the given slot to
+   * check if every displaced entry stays within the max lookups.
+   */
+  bool fits(stripe_guard_t& guard, size_t position, int8_t distance) const {
+    const entry_t* entries = entries_->data();
+    while (distance < max_lookups_) {
+      guard.cover(position);
+      const entry_t& entry = entries[position];
+      if (entry.is_empty()) {
+        return true;
+      }
+      if (entry.distance_from_desired < distance) {
+        distance = entry.distance_from_desired;
+      }
+      ++position;
+      ++distance;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Fallback when some elements overflow: collect all elements into a
+   * larger table and copy it into the blob, as HashmapBuilder does.
+   */
+  Status rebuild(Client& client) {
+    ska::flat_hash_map<K, V, H, E> hashmap;
+    hashmap.reserve(size());
+    const entry_t* entries = entries_->data();
+    for (size_t index = 0; index + 1 < num_buckets_ + max_lookups_; ++index) {
+      if (entries[index].has_value()) {
+        hashmap.emplace(entries[index].value);
+      }
+    }
+    for (auto const& item : overflow_) {
+      hashmap.emplace(item);
+    }
+    // the elements have been moved out, the blob of the table is replaced
+    RETURN_ON_ERROR(entries_->Abort(client));
+    entries_ = nullptr;
+
+    size_t entry_size =
+        hashmap.get_num_slots_minus_one() + hashmap.get_max_lookups() + 1;
+    auto entries_builder = std::make_shared<ArrayBuilder<entry_t>>(
+        client, hashmap.get_entries(), entry_size);
+
+    this->set_num_slots_minus_one_(hashmap.get_num_slots_minus_one());
+    this->set_max_lookups_(hashmap.get_max_lookups());
+    this->set_num_elements_(hashmap.size());
+    this->set_entries_(std::static_pointer_cast<ObjectBase>(entries_builder));
+    return Status::OK();
+  }
+
+  size_t num_buckets_;
+  int8_t max_lookups_;
+  std::shared_ptr<ArrayBuilder<entry_t>> entries_;
+
+  size_t num_stripes_;
+  std::unique_ptr<std::mutex[]> stripes_;
+  std::atomic<size_t> num_elements_;
+
+  std::mutex overflow_mutex_;
+  std::atomic<bool> overflowed_{false};
+  std::vector<value_t> overflow_;
+};
+
 }  // namespace vineyard
 
 #endif  // MODULES_BASIC_DS_HASHMAP_H_
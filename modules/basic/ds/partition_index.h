@@ -0,0 +1,142 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_PARTITION_INDEX_H_
+#define MODULES_BASIC_DS_PARTITION_INDEX_H_
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief The location of a partition of a global object, and the range of
+ * global rows it covers.
+ */
+struct PartitionLocation {
+  ObjectID id;
+  InstanceID instance_id;
+  size_t row_partition;
+  /// the linearized partition index on the remaining dimensions
+  size_t column_partition;
+  size_t row_begin;
+  size_t row_end;
+};
+
+/**
+ * @brief PartitionIndex maps ranges of global rows to the partitions of a
+ * global dataframe or tensor that cover them, and to the instances that own
+ * these partitions.
+ *
+ * The row offsets of the row partitions are computed once when the global
+ * object is built and saved in its metadata, so locating rows never needs
+ * to inspect the metadata of the partitions.
+ */
+class PartitionIndex {
+ public:
+  void AddPartition(ObjectID id, InstanceID instance_id, size_t row_partition,
+                    size_t column_partition) {
+    locations_.push_back(
+        PartitionLocation{id, instance_id, row_partition, column_partition,
+                          /* row_begin */ 0, /* row_end */ 0});
+  }
+
+  /**
+   * @brief Compute the row offsets of `num_row_partitions` row partitions
+   * from the row partition and the number of rows of each partition,
+   * partitions whose row partition is out of range are not indexed.
+   */
+  static std::vector<size_t> RowOffsets(
+      size_t num_row_partitions, std::vector<size_t> const& row_partitions,
+      std::vector<size_t> const& num_rows) {
+    std::vector<size_t> offsets(num_row_partitions + 1, 0);
+    for (size_t i = 0; i < row_partitions.size(); ++i) {
+      if (row_partitions[i] >= num_row_partitions) {
+        continue;
+      }
+      offsets[row_partitions[i] + 1] =
+          std::max(offsets[row_partitions[i] + 1], num_rows[i]);
+    }
+    for (size_t i = 1; i < offsets.size(); ++i) {
+      offsets[i] += offsets[i - 1];
+    }
+    return offsets;
+  }
+
+  /**
+   * @brief Fix the row ranges of the added partitions with the given row
+   * offsets and sort them by rows, partitions out of the range of the row
+   * offsets are dropped.
+   */
+  void Finish(std::vector<size_t> const& row_offsets) {
+    row_offsets_ = row_offsets;
+    locations_.erase(
+        std::remove_if(locations_.begin(), locations_.end(),
+                       [this](PartitionLocation const& location) {
+                         return location.row_partition + 1 >=
+                                row_offsets_.size();
+                       }),
+        locations_.end());
+    for (auto& location : locations_) {
+      location.row_begin = row_offsets_[location.row_partition];
+      location.row_end = row_offsets_[location.row_partition + 1];
+    }
+    std::sort(locations_.begin(), locations_.end(),
+              [](PartitionLocation const& lhs, PartitionLocation const& rhs) {
+                return std::tie(lhs.row_partition, lhs.column_partition) <
+                       std::tie(rhs.row_partition, rhs.column_partition);
+              });
+  }
+
+  std::vector<size_t> const& row_offsets() const { return row_offsets_; }
+
+  size_t num_rows() const {
+    return row_offsets_.empty() ? 0 : row_offsets_.back();
+  }
+
+  std::vector<PartitionLocation> const& locations() const {
+    return locations_;
+  }
+
+  /**
+   * @brief Locate the partitions whose rows intersect with `[begin, end)`,
+   * ordered by rows and then by the remaining dimensions.
+   */
+  std::vector<PartitionLocation> LocateRows(size_t begin, size_t end) const {
+    std::vector<PartitionLocation> located;
+    auto iter = std::partition_point(
+        locations_.begin(), locations_.end(),
+        [begin](PartitionLocation const& location) {
+          return location.row_end <= begin;
+        });
+    for (; iter != locations_.end() && iter->row_begin < end; ++iter) {
+      if (iter->row_begin < iter->row_end) {
+        located.push_back(*iter);
+      }
+    }
+    return located;
+  }
+
+ private:
+  std::vector<size_t> row_offsets_;
+  std::vector<PartitionLocation> locations_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_PARTITION_INDEX_H_
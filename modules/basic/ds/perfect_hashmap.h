@@ -0,0 +1,187 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_BASIC_DS_PERFECT_HASHMAP_H_
+#define MODULES_BASIC_DS_PERFECT_HASHMAP_H_
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flat_hash_map/flat_hash_map.hpp"
+
+#include "basic/ds/array.h"
+#include "basic/ds/perfect_hashmap.vineyard.h"
+#include "client/ds/blob.h"
+#include "client/ds/i_object.h"
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief PerfectHashmapBuilder is used for constructing immutable perfect
+ * hashmaps that supported by vineyard, from the same inputs of
+ * HashmapBuilder.
+ *
+ * @tparam K The type for the key.
+ * @tparam V The type for the value.
+ * @tparam std::hash<K> The hash function for the key.
+ * @tparam std::equal_to<K> The compare function for the key.
+ */
+template <typename K, typename V, typename H = std::hash<K>,
+          typename E = std::equal_to<K>>
+class PerfectHashmapBuilder : public PerfectHashmapBaseBuilder<K, V, H, E> {
+  using value_t = typename PerfectHashmap<K, V, H, E>::value_type;
+
+  // bits per key of each level, a larger value uses fewer levels
+  static constexpr double kGamma = 2.0;
+  static constexpr size_t kMaxLevels = 64;
+
+ public:
+  explicit PerfectHashmapBuilder(Client& client)
+      : PerfectHashmapBaseBuilder<K, V, H, E>(client) {}
+
+  explicit PerfectHashmapBuilder(Client& client,
+                                 ska::flat_hash_map<K, V, H, E>&& hashmap)
+      : PerfectHashmapBaseBuilder<K, V, H, E>(client),
+        hashmap_(std::move(hashmap)) {}
+
+  /**
+   * @brief Get the mapping value of the given key.
+   *
+   */
+  inline V& operator[](const K& key) { return hashmap_[key]; }
+
+  /**
+   * @brief Get the mapping value of the given key.
+   *
+   */
+  inline V& operator[](K&& key) { return hashmap_[std::move(key)]; }
+
+  /**
+   * @brief Emplace key-value pair into the hashmap.
+   *
+   */
+  template <class... Args>
+  inline void emplace(Args&&... args) {
+    hashmap_.emplace(std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Get the size of the hashmap.
+   *
+   */
+  size_t size() const { return hashmap_.size(); }
+
+  /**
+   * @brief Reserve the size for the hashmap.
+   *
+   */
+  void reserve(size_t size) { hashmap_.reserve(size); }
+
+  /**
+   * @brief Check whether the hashmap is empty.
+   *
+   */
+  bool empty() const { return hashmap_.empty(); }
+
+  /**
+   * @brief Build the perfect hashmap object.
+   *
+   */
+  Status Build(Client& client) override {
+    H hasher;
+    std::vector<uint64_t> offsets{0}, bits;
+    std::vector<uint64_t> remaining, collided;
+    remaining.reserve(hashmap_.size());
+    for (auto const& item : hashmap_) {
+      remaining.emplace_back(hasher(item.first));
+    }
+
+    // the first level always exists to keep the arrays non-empty
+    do {
+      if (offsets.size() > kMaxLevels) {
+        return Status::Invalid(
+            "Failed to build the perfect hash: too many hash collisions");
+      }
+      size_t level = offsets.size() - 1;
+      size_t num_words = std::max<size_t>(
+          1, static_cast<size_t>(remaining.size() * kGamma + 63) / 64);
+      std::vector<uint64_t> taken(num_words, 0), collisions(num_words, 0);
+      for (uint64_t hash : remaining) {
+        uint64_t position = perfect_hash_policy::position_for_hash(
+            hash, level, num_words * 64);
+        uint64_t mask = uint64_t(1) << (position % 64);
+        if (taken[position / 64] & mask) {
+          collisions[position / 64] |= mask;
+        } else {
+          taken[position / 64] |= mask;
+        }
+      }
+      collided.clear();
+      for (uint64_t hash : remaining) {
+        uint64_t position = perfect_hash_policy::position_for_hash(
+            hash, level, num_words * 64);
+        if (collisions[position / 64] & (uint64_t(1) << (position % 64))) {
+          collided.emplace_back(hash);
+        }
+      }
+      for (size_t index = 0; index < num_words; ++index) {
+        bits.emplace_back(taken[index] & ~collisions[index]);
+      }
+      offsets.emplace_back(bits.size());
+      remaining.swap(collided);
+    } while (!remaining.empty());
+
+    std::vector<uint64_t> ranks(bits.size());
+    uint64_t rank = 0;
+    for (size_t index = 0; index < bits.size(); ++index) {
+      ranks[index] = rank;
+      rank += __builtin_popcountll(bits[index]);
+    }
+
+    size_t num_levels = offsets.size() - 1;
+    auto entries_builder =
+        std::make_shared<ArrayBuilder<value_t>>(client, hashmap_.size());
+    for (auto const& item : hashmap_) {
+      size_t index = perfect_hash_policy::index_for_hash(
+          hasher(item.first), num_levels, offsets.data(), bits.data(),
+          ranks.data(), hashmap_.size());
+      new (entries_builder->data() + index) value_t(item);
+    }
+
+    this->set_num_elements_(hashmap_.size());
+    this->set_num_levels_(num_levels);
+    this->set_level_offsets_(std::static_pointer_cast<ObjectBase>(
+        std::make_shared<ArrayBuilder<uint64_t>>(client, offsets)));
+    this->set_bits_(std::static_pointer_cast<ObjectBase>(
+        std::make_shared<ArrayBuilder<uint64_t>>(client, bits)));
+    this->set_ranks_(std::static_pointer_cast<ObjectBase>(
+        std::make_shared<ArrayBuilder<uint64_t>>(client, ranks)));
+    this->set_entries_(std::static_pointer_cast<ObjectBase>(entries_builder));
+    return Status::OK();
+  }
+
+ private:
+  ska::flat_hash_map<K, V, H, E> hashmap_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_BASIC_DS_PERFECT_HASHMAP_H_
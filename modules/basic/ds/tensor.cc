@@ -17,6 +17,45 @@ limitations under the License.
 
 namespace vineyard {
 
+namespace detail {
+
+/**
+ * @brief Index the partitions along the first axis, reusing the row offsets
+ * saved in the metadata when they are available.
+ */
+static void BuildPartitionIndex(
+    ObjectMeta const& meta, std::vector<int64_t> const& partition_shape,
+    std::vector<std::shared_ptr<ITensor>> const& partitions,
+    PartitionIndex& index) {
+  std::vector<size_t> row_partitions, num_rows;
+  for (auto const& partition : partitions) {
+    auto const& partition_index = partition->partition_index();
+    size_t row_partition = partition_index.empty() ? 0 : partition_index[0];
+    // linearize the partition index on the remaining axes
+    size_t column_partition = 0;
+    for (size_t axis = 1; axis < partition_index.size(); ++axis) {
+      size_t extent = axis < partition_shape.size() ? partition_shape[axis] : 1;
+      column_partition = column_partition * extent + partition_index[axis];
+    }
+    index.AddPartition(partition->id(), partition->meta().GetInstanceId(),
+                       row_partition, column_partition);
+    row_partitions.push_back(row_partition);
+    num_rows.push_back(partition->shape().empty() ? 0 : partition->shape()[0]);
+  }
+  if (meta.Haskey("row_offsets_")) {
+    std::vector<size_t> row_offsets;
+    meta.GetKeyValue("row_offsets_", row_offsets);
+    index.Finish(row_offsets);
+  } else {
+    size_t num_row_partitions =
+        partition_shape.empty() ? 1 : partition_shape[0];
+    index.Finish(PartitionIndex::RowOffsets(num_row_partitions,
+                                            row_partitions, num_rows));
+  }
+}
+
+}  // namespace detail
+
 std::vector<int64_t> const& GlobalTensor::shape() const { return shape_; }
 
 std::vector<int64_t> const& GlobalTensor::partition_shape() const {
@@ -33,12 +72,16 @@ void GlobalTensor::Construct(const ObjectMeta& meta) {
 
   meta.GetKeyValue("shape_", this->shape_);
   meta.GetKeyValue("partition_shape_", this->partition_shape_);
+  std::vector<std::shared_ptr<ITensor>> chunks;
   for (size_t __idx = 0; __idx < meta.GetKeyValue<size_t>("partitions_-size");
        ++__idx) {
     auto chunk = std::dynamic_pointer_cast<ITensor>(
         meta.GetMember("partitions_-" + std::to_string(__idx)));
     this->partitions_[chunk->meta().GetInstanceId()].emplace_back(chunk);
+    chunks.emplace_back(chunk);
   }
+  detail::BuildPartitionIndex(meta, this->partition_shape_, chunks,
+                              this->index_);
 
   if (meta.IsLocal()) {
     this->PostConstruct(meta);
@@ -55,6 +98,11 @@ const std::vector<std::shared_ptr<ITensor>>& GlobalTensor::LocalPartitions(
   return partitions_[instance_id];
 }
 
+std::vector<PartitionLocation> GlobalTensor::LocateRows(size_t begin,
+                                                        size_t end) const {
+  return index_.LocateRows(begin, end);
+}
+
 std::shared_ptr<Object> GlobalTensorBaseBuilder::_Seal(Client& client) {
   // ensure the builder hasn't been sealed yet.
   ENSURE_NOT_SEALED(this);
@@ -78,6 +126,7 @@ std::shared_ptr<Object> GlobalTensorBaseBuilder::_Seal(Client& client) {
   __value->meta_.AddKeyValue("partition_shape_", __value->partition_shape_);
 
   size_t __partitions__idx = 0;
+  std::vector<std::shared_ptr<ITensor>> __chunks;
   for (auto& __partitions__value : partitions_) {
     auto __value_partitions_ = client.GetObject<ITensor>(__partitions__value);
     __value->partitions_[__value_partitions_->meta().GetInstanceId()]
@@ -86,8 +135,13 @@ std::shared_ptr<Object> GlobalTensorBaseBuilder::_Seal(Client& client) {
                              __partitions__value);
     __value_nbytes += __value_partitions_->nbytes();
     __partitions__idx += 1;
+    __chunks.emplace_back(__value_partitions_);
   }
-  __value->meta_.AddKeyValue("partitions_-size", __value->partitions_.size());
+  __value->meta_.AddKeyValue("partitions_-size", __partitions__idx);
+
+  detail::BuildPartitionIndex(__value->meta_, __value->partition_shape_,
+                              __chunks, __value->index_);
+  __value->meta_.AddKeyValue("row_offsets_", __value->index_.row_offsets());
 
   __value->meta_.SetNBytes(__value_nbytes);
 
@@ -17,12 +17,14 @@ limitations under the License.
 #define MODULES_BASIC_DS_TENSOR_H_
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <map>
 #include <memory>
 #include <numeric>
 #include <set>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -32,6 +34,7 @@ limitations under the License.
 #include "arrow/tensor.h"
 
 #include "basic/ds/array.h"
+#include "basic/ds/partition_index.h"
 #include "basic/ds/tensor.vineyard.h"
 #include "client/client.h"
 #include "client/ds/blob.h"
@@ -63,6 +66,7 @@ class TensorBuilder : public ITensorBuilder, public TensorBaseBuilder<T> {
       : TensorBaseBuilder<T>(client) {
     this->set_value_type_(AnyType(AnyTypeEnum<T>::value));
     this->set_shape_(shape);
+    this->set_layout_("C");
     int64_t size = std::accumulate(this->shape_.begin(), this->shape_.end(), 1,
                                    std::multiplies<int64_t>{});
     VINEYARD_CHECK_OK(client.CreateBlob(size * sizeof(T), buffer_writer_));
@@ -82,6 +86,34 @@ class TensorBuilder : public ITensorBuilder, public TensorBaseBuilder<T> {
     this->set_partition_index_(partition_index);
   }
 
+  /**
+   * @brief Initialize the TensorBuilder with a tensor in the memory of the
+   * given CUDA device, see also `Client::CreateDeviceBlob()`. The `data()`
+   * of the builder is a device pointer then, and the tensor can be read by
+   * later runs without copying it to the device again.
+   *
+   * @param client The client connected to the vineyard server.
+   * @param shape The shape of the tensor.
+   * @param partition_index The partition index in the global tensor, empty
+   * if the tensor isn't a partition.
+   * @param device The ordinal of the CUDA device.
+   */
+  TensorBuilder(Client& client, std::vector<int64_t> const& shape,
+                std::vector<int64_t> const& partition_index, int const device)
+      : TensorBaseBuilder<T>(client) {
+    this->set_value_type_(AnyType(AnyTypeEnum<T>::value));
+    this->set_shape_(shape);
+    this->set_layout_("C");
+    if (!partition_index.empty()) {
+      this->set_partition_index_(partition_index);
+    }
+    int64_t size = std::accumulate(this->shape_.begin(), this->shape_.end(), 1,
+                                   std::multiplies<int64_t>{});
+    VINEYARD_CHECK_OK(
+        client.CreateDeviceBlob(size * sizeof(T), device, buffer_writer_));
+    this->data_ = reinterpret_cast<T*>(buffer_writer_->data());
+  }
+
   /**
    * @brief Get the shape of the tensor.
    *
@@ -118,17 +150,34 @@ class TensorBuilder : public ITensorBuilder, public TensorBaseBuilder<T> {
     this->set_partition_index_(partition_index);
   }
 
+  /**
+   * @brief Get the layout of the tensor, "C" (the default) for row-major and
+   * "F" for column-major.
+   */
+  std::string const& layout() const { return this->layout_; }
+
+  /**
+   * @brief Set the layout in which the data is written into the buffer.
+   *
+   * @param layout "C" for row-major and "F" for column-major.
+   */
+  void set_layout(std::string const& layout) {
+    VINEYARD_ASSERT(layout == "C" || layout == "F",
+                    "The layout of tensors must be either 'C' or 'F'");
+    this->set_layout_(layout);
+  }
+
   /**
    * @brief Get the strides of the tensor.
    *
-   * @return The strides of the tensor. The definition of the tensor's strides
-   * can be found in https://pytorch.org/docs/stable/tensor_attributes.html
+   * @return The strides of the tensor, in bytes, which respects the layout of
+   * the tensor. The definition of the tensor's strides can be found in
+   * https://pytorch.org/docs/stable/tensor_attributes.html
    */
   std::vector<int64_t> strides() const {
-    std::vector<int64_t> vec(this->shape_.size());
-    vec[this->shape_.size() - 1] = sizeof(T);
-    for (size_t i = this->shape_.size() - 1; i > 0; --i) {
-      vec[i - 1] = vec[i] * this->shape_[i];
+    auto vec = DLPackStrides(this->shape_, this->layout_ == "F");
+    for (auto& stride : vec) {
+      stride *= sizeof(T);
     }
     return vec;
   }
@@ -154,6 +203,294 @@ class TensorBuilder : public ITensorBuilder, public TensorBaseBuilder<T> {
   T* data_;
 };
 
+/**
+ * @brief TiledTensorBuilder is used for building tiled tensors that supported
+ * by vineyard, where each tile is allocated as its own blob.
+ *
+ * @tparam T The type for the elements.
+ */
+template <typename T>
+class TiledTensorBuilder : public TiledTensorBaseBuilder<T> {
+ public:
+  /**
+   * @brief Initialize the TiledTensorBuilder with the tensor shape and the
+   * tile shape.
+   *
+   * @param client The client connected to the vineyard server.
+   * @param shape The shape of the tensor.
+   * @param tile_shape The shape of tiles, must have the same number of axes as
+   * the tensor.
+   */
+  TiledTensorBuilder(Client& client, std::vector<int64_t> const& shape,
+                     std::vector<int64_t> const& tile_shape)
+      : TiledTensorBaseBuilder<T>(client) {
+    VINEYARD_ASSERT(shape.size() == tile_shape.size(),
+                    "The tile shape doesn't match the tensor shape");
+    for (auto const& item : tile_shape) {
+      VINEYARD_ASSERT(item > 0, "The tile shape must be positive");
+    }
+    this->set_value_type_(AnyType(AnyTypeEnum<T>::value));
+    this->set_shape_(shape);
+    this->set_tile_shape_(tile_shape);
+    layout_.Init(shape, tile_shape);
+
+    std::vector<size_t> sizes(layout_.num_tiles());
+    for (size_t index = 0; index < sizes.size(); ++index) {
+      sizes[index] = layout_.tile_size(index) * sizeof(T);
+    }
+    VINEYARD_CHECK_OK(client.CreateBlobs(sizes, tile_writers_));
+  }
+
+  /**
+   * @brief Get the shape of the tensor.
+   */
+  std::vector<int64_t> const& shape() const { return this->shape_; }
+
+  /**
+   * @brief Get the shape of tiles.
+   */
+  std::vector<int64_t> const& tile_shape() const { return this->tile_shape_; }
+
+  /**
+   * @brief Get the number of tiles along each axis.
+   */
+  std::vector<int64_t> const& grid() const { return layout_.grid(); }
+
+  /**
+   * @brief Get the data pointer of the tile at the given coordinate in the
+   * grid, the tile is in row-major order of its actual shape.
+   */
+  T* tile(std::vector<int64_t> const& coordinate) const {
+    return reinterpret_cast<T*>(
+        tile_writers_[layout_.tile_index(coordinate)]->data());
+  }
+
+  /**
+   * @brief Get the actual shape of the tile at the given coordinate.
+   */
+  std::vector<int64_t> tile_extent(
+      std::vector<int64_t> const& coordinate) const {
+    return layout_.tile_extent(coordinate);
+  }
+
+  /**
+   * @brief Copy the row-major `data` into the region [begin, end) of the
+   * tensor.
+   */
+  Status Write(std::vector<int64_t> const& begin,
+               std::vector<int64_t> const& end, const T* data) {
+    if (!layout_.valid_region(begin, end)) {
+      return Status::Invalid("Invalid region of the tiled tensor");
+    }
+    layout_.for_each_run(begin, end,
+                         [&](size_t tile, int64_t tile_offset,
+                             int64_t region_offset, int64_t length) {
+                           auto& writer = tile_writers_[tile];
+                           T* target = reinterpret_cast<T*>(writer->data());
+                           std::copy(data + region_offset,
+                                     data + region_offset + length,
+                                     target + tile_offset);
+                         });
+    return Status::OK();
+  }
+
+  /**
+   * @brief Build the tiled tensor.
+   *
+   * @param client The client connceted to the vineyard server.
+   */
+  Status Build(Client& client) override {
+    std::vector<std::shared_ptr<BlobWriter>> writers;
+    for (auto& writer : tile_writers_) {
+      writers.emplace_back(std::move(writer));
+    }
+    tile_writers_.clear();
+    for (auto& writer : writers) {
+      this->add_tiles_(writer);
+    }
+    // seals the tiles with a single round trip
+    return BlobWriter::SealBuffers(client, writers);
+  }
+
+ private:
+  tile_layout layout_;
+  std::vector<std::unique_ptr<BlobWriter>> tile_writers_;
+};
+
+namespace detail {
+
+/**
+ * @brief Copy a dense tensor between two layouts given by the strides, in
+ * number of elements, of each axis.
+ *
+ * The axes that are contiguous in the source and in the target are copied in
+ * blocks of `block x block` elements, thus both the reads and the writes of a
+ * block stay in the cache, e.g., when transposing between row-major and
+ * column-major. The blocks along the target's contiguous axis, for every
+ * index on the other axes, are copied on at most `concurrency` threads.
+ */
+template <typename T>
+void CopyTensorLayout(const T* source, T* target,
+                      std::vector<int64_t> const& shape,
+                      std::vector<int64_t> const& source_strides,
+                      std::vector<int64_t> const& target_strides,
+                      int const concurrency) {
+  constexpr int64_t block = 64;
+  const size_t ndim = shape.size();
+  for (auto const& extent : shape) {
+    if (extent == 0) {
+      return;
+    }
+  }
+  if (ndim == 0) {
+    target[0] = source[0];
+    return;
+  }
+  auto contiguous_axis = [](std::vector<int64_t> const& strides) {
+    return static_cast<size_t>(
+        std::min_element(strides.begin(), strides.end()) - strides.begin());
+  };
+  const size_t a = contiguous_axis(source_strides);
+  const size_t b = contiguous_axis(target_strides);
+  std::vector<size_t> others;
+  int64_t outer = 1;
+  for (size_t d = 0; d < ndim; ++d) {
+    if (d != a && d != b) {
+      others.push_back(d);
+      outer *= shape[d];
+    }
+  }
+  const int64_t blocks = (shape[b] + block - 1) / block;
+  const int64_t task_num = outer * blocks;
+
+  auto copy_block = [&](int64_t const task) {
+    // the offsets of the index on the axes other than `a` and `b`
+    int64_t index = task / blocks, source_base = 0, target_base = 0;
+    for (size_t k = others.size(); k > 0; --k) {
+      size_t d = others[k - 1];
+      int64_t coordinate = index % shape[d];
+      index /= shape[d];
+      source_base += coordinate * source_strides[d];
+      target_base += coordinate * target_strides[d];
+    }
+    int64_t b_begin = (task % blocks) * block;
+    int64_t b_end = std::min(b_begin + block, shape[b]);
+    // `a` is `b` when both tensors are contiguous on the same axis
+    int64_t a_extent = a == b ? 1 : shape[a];
+    for (int64_t a_begin = 0; a_begin < a_extent; a_begin += block) {
+      int64_t a_end = std::min(a_begin + block, a_extent);
+      for (int64_t i = b_begin; i < b_end; ++i) {
+        const T* from = source + source_base + i * source_strides[b];
+        T* to = target + target_base + i * target_strides[b];
+        for (int64_t j = a_begin; j < a_end; ++j) {
+          to[j * target_strides[a]] = from[j * source_strides[a]];
+        }
+      }
+    }
+  };
+
+  std::atomic<int64_t> next(0);
+  auto worker = [&]() {
+    for (int64_t task = next++; task < task_num; task = next++) {
+      copy_block(task);
+    }
+  };
+  int64_t parallelism =
+      std::min(static_cast<int64_t>(std::max(concurrency, 1)), task_num);
+  std::vector<std::thread> threads;
+  for (int64_t i = 1; i < parallelism; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace detail
+
+/**
+ * @brief Convert the tensor into a new tensor of the given layout, where the
+ * elements are copied into a new blob in parallel. Tensors can then be kept
+ * in the layouts their consumers prefer, e.g., column-major for the BLAS
+ * routines, rather than being converted on every read.
+ *
+ * @param layout "C" for row-major and "F" for column-major.
+ * @param concurrency The number of threads to copy the elements.
+ */
+template <typename T>
+Status ConvertLayout(
+    Client& client, Tensor<T> const& tensor, std::string const& layout,
+    std::shared_ptr<Tensor<T>>& result,
+    int const concurrency = std::thread::hardware_concurrency()) {
+  if (layout != "C" && layout != "F") {
+    return Status::Invalid("The layout of tensors must be either 'C' or 'F'");
+  }
+  TensorBuilder<T> builder(client, tensor.shape(), tensor.partition_index());
+  builder.set_layout(layout);
+  detail::CopyTensorLayout(
+      tensor.data(), builder.data(), tensor.shape(),
+      DLPackStrides(tensor.shape(), tensor.layout() == "F"),
+      DLPackStrides(tensor.shape(), layout == "F"), concurrency);
+  result = std::dynamic_pointer_cast<Tensor<T>>(builder.Seal(client));
+  return Status::OK();
+}
+
+/**
+ * @brief Convert the tensor into a tiled tensor, i.e., the blocked layout,
+ * where the tiles are filled in parallel.
+ *
+ * @param tile_shape The shape of the tiles, see `TiledTensorBuilder`.
+ * @param concurrency The number of threads to fill the tiles.
+ */
+template <typename T>
+Status ConvertLayout(
+    Client& client, Tensor<T> const& tensor,
+    std::vector<int64_t> const& tile_shape,
+    std::shared_ptr<TiledTensor<T>>& result,
+    int const concurrency = std::thread::hardware_concurrency()) {
+  if (tile_shape.size() != tensor.shape().size()) {
+    return Status::Invalid("The tile shape doesn't match the tensor shape");
+  }
+  for (auto const& item : tile_shape) {
+    if (item <= 0) {
+      return Status::Invalid("The tile shape must be positive");
+    }
+  }
+  TiledTensorBuilder<T> builder(client, tensor.shape(), tile_shape);
+  tile_layout layout;
+  layout.Init(tensor.shape(), tile_shape);
+  auto source_strides = DLPackStrides(tensor.shape(), tensor.layout() == "F");
+
+  const size_t num_tiles = layout.num_tiles();
+  std::atomic<size_t> next(0);
+  auto worker = [&]() {
+    for (size_t index = next++; index < num_tiles; index = next++) {
+      auto coordinate = layout.tile_coordinate(index);
+      auto extent = layout.tile_extent(coordinate);
+      int64_t origin = 0;
+      for (size_t d = 0; d < coordinate.size(); ++d) {
+        origin += coordinate[d] * tile_shape[d] * source_strides[d];
+      }
+      detail::CopyTensorLayout(tensor.data() + origin,
+                               builder.tile(coordinate), extent,
+                               source_strides, DLPackStrides(extent, false), 1);
+    }
+  };
+  size_t parallelism =
+      std::min(static_cast<size_t>(std::max(concurrency, 1)), num_tiles);
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < parallelism; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  result = std::dynamic_pointer_cast<TiledTensor<T>>(builder.Seal(client));
+  return Status::OK();
+}
+
 class GlobalTensorBaseBuilder;
 
 /**
@@ -191,6 +528,15 @@ class GlobalTensor : public Registered<GlobalTensor>, GlobalObject {
   const std::vector<std::shared_ptr<ITensor>>& LocalPartitions(
       const InstanceID instance_id) const;
 
+  /**
+   * @brief Locate the partitions that hold the slices `[begin, end)` along the
+   * first axis.
+   *
+   * @return The IDs of the partitions and the instances that own them, ordered
+   * by the first axis and then by the remaining axes.
+   */
+  std::vector<PartitionLocation> LocateRows(size_t begin, size_t end) const;
+
  private:
   std::vector<int64_t> shape_;
   std::vector<int64_t> partition_shape_;
@@ -198,6 +544,8 @@ class GlobalTensor : public Registered<GlobalTensor>, GlobalObject {
   mutable std::map<InstanceID, std::vector<std::shared_ptr<ITensor>>>
       partitions_;
 
+  PartitionIndex index_;
+
   friend class Client;
   friend class GlobalTensorBaseBuilder;
 };
@@ -184,7 +184,13 @@ Status DataframeStreamReader::GetHeaderLine(bool& header_row,
 
 Status DataframeStream::OpenReader(
     Client& client, std::unique_ptr<DataframeStreamReader>& reader) {
-  RETURN_ON_ERROR(client.OpenStream(id_, StreamOpenMode::read));
+  return OpenReader(client, reader, StreamOpenMode::read);
+}
+
+Status DataframeStream::OpenReader(
+    Client& client, std::unique_ptr<DataframeStreamReader>& reader,
+    const StreamOpenMode mode) {
+  RETURN_ON_ERROR(client.OpenStream(id_, mode));
   reader = std::unique_ptr<DataframeStreamReader>(
       new DataframeStreamReader(client, id_, meta_, params_));
   return Status::OK();
@@ -32,6 +32,9 @@ void ParallelStream::Construct(const ObjectMeta& meta) {
   this->id_ = meta.GetId();
 
   meta.GetKeyValue("size_", this->size_);
+  if (meta.Haskey("dynamic_")) {
+    meta.GetKeyValue("dynamic_", this->dynamic_);
+  }
   for (size_t idx = 0; idx < this->size_; ++idx) {
     streams_.emplace_back(meta.GetMember("stream_" + std::to_string(idx)));
   }
@@ -55,6 +58,8 @@ std::shared_ptr<Object> ParallelStreamBuilder::_Seal(Client& client) {
 
   __value->size_ = streams_.size();
   __value->meta_.AddKeyValue("size_", __value->size_);
+  __value->dynamic_ = dynamic_;
+  __value->meta_.AddKeyValue("dynamic_", __value->dynamic_);
 
   for (size_t idx = 0; idx < streams_.size(); ++idx) {
     __value->meta_.AddMember("stream_" + std::to_string(idx), streams_[idx]);
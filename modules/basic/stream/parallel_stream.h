@@ -39,6 +39,15 @@ class ParallelStream : public Registered<ParallelStream>, GlobalObject {
 
   size_t GetStreamSize() { return size_; }
 
+  /**
+   * @brief Whether the substreams are read in the dynamic mode, where every
+   * consumer opens all local substreams in the shared mode (see
+   * `StreamOpenMode::shared`) and claims the next ready chunk from them,
+   * rather than reading the substreams assigned to it, thus a slow or large
+   * substream is drained by all consumers together.
+   */
+  bool IsDynamic() const { return dynamic_; }
+
   template <typename T>
   std::shared_ptr<T> GetStream(int index) {
     return std::dynamic_pointer_cast<T>(streams_[index]);
@@ -57,6 +66,7 @@ class ParallelStream : public Registered<ParallelStream>, GlobalObject {
 
  private:
   size_t size_;
+  bool dynamic_ = false;
   std::vector<std::shared_ptr<Object>> streams_;
 
   friend class Client;
@@ -73,12 +83,19 @@ class ParallelStreamBuilder : public ObjectBuilder {
 
   void AddStream(const ObjectID stream_id);
 
+  /**
+   * @brief Let the consumers read the substreams in the dynamic mode, see
+   * also `ParallelStream::IsDynamic`.
+   */
+  void SetDynamic(bool const dynamic) { dynamic_ = dynamic; }
+
   Status Build(Client& client) override;
 
   std::shared_ptr<Object> _Seal(Client& client) override;
 
  private:
   std::vector<ObjectID> streams_;
+  bool dynamic_ = false;
 };
 
 }  // namespace vineyard
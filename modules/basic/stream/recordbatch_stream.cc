@@ -143,7 +143,14 @@ Status RecordBatchStreamReader::GetHeaderLine(bool& header_row,
 
 Status RecordBatchStream::OpenReader(
     Client& client, std::unique_ptr<RecordBatchStreamReader>& reader) {
-  RETURN_ON_ERROR(client.OpenStream(id_, StreamOpenMode::read));
+  return OpenReader(client, reader, false);
+}
+
+Status RecordBatchStream::OpenReader(
+    Client& client, std::unique_ptr<RecordBatchStreamReader>& reader,
+    const bool fanout) {
+  RETURN_ON_ERROR(client.OpenStream(
+      id_, fanout ? StreamOpenMode::fanout : StreamOpenMode::read));
   reader = std::unique_ptr<RecordBatchStreamReader>(
       new RecordBatchStreamReader(client, id_, meta_, params_));
   return Status::OK();
@@ -0,0 +1,175 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "fuse/adaptors/arrow_ipc.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "arrow/array.h"
+#include "arrow/io/interfaces.h"
+#include "arrow/ipc/api.h"
+#include "arrow/util/config.h"
+
+#include "basic/ds/arrow_utils.h"
+
+namespace vineyard {
+namespace fuse {
+
+namespace {
+
+/**
+ * @brief An output stream that records the writes of the given buffers as
+ * references, and copies other writes into the framing.
+ */
+class SegmentOutputStream : public arrow::io::OutputStream {
+ public:
+  SegmentOutputStream(
+      std::vector<std::pair<const uint8_t*, int64_t>> buffers,
+      std::string& framing, std::vector<ArrowIpcView::Segment>& segments)
+      : buffers_(std::move(buffers)), framing_(framing), segments_(segments) {
+    std::sort(buffers_.begin(), buffers_.end());
+  }
+
+  arrow::Status Close() override {
+    closed_ = true;
+    return arrow::Status::OK();
+  }
+
+  bool closed() const override { return closed_; }
+
+  arrow::Result<int64_t> Tell() const override { return position_; }
+
+  arrow::Status Write(const void* data, int64_t nbytes) override {
+    if (nbytes == 0) {
+      return arrow::Status::OK();
+    }
+    auto bytes = static_cast<const uint8_t*>(data);
+    if (isReferenced(bytes, nbytes)) {
+      segments_.push_back(ArrowIpcView::Segment{position_, nbytes, bytes, 0});
+    } else if (!segments_.empty() && segments_.back().data == nullptr) {
+      // merged into the previous piece of framing
+      segments_.back().size += nbytes;
+      framing_.append(reinterpret_cast<const char*>(bytes), nbytes);
+    } else {
+      segments_.push_back(ArrowIpcView::Segment{
+          position_, nbytes, nullptr, static_cast<int64_t>(framing_.size())});
+      framing_.append(reinterpret_cast<const char*>(bytes), nbytes);
+    }
+    position_ += nbytes;
+    return arrow::Status::OK();
+  }
+
+ private:
+  bool isReferenced(const uint8_t* data, int64_t nbytes) const {
+    auto iter = std::upper_bound(
+        buffers_.begin(), buffers_.end(),
+        std::make_pair(data, std::numeric_limits<int64_t>::max()));
+    if (iter == buffers_.begin()) {
+      return false;
+    }
+    --iter;
+    return data + nbytes <= iter->first + iter->second;
+  }
+
+  std::vector<std::pair<const uint8_t*, int64_t>> buffers_;
+  std::string& framing_;
+  std::vector<ArrowIpcView::Segment>& segments_;
+  bool closed_ = false;
+  int64_t position_ = 0;
+};
+
+void collect_buffers(std::shared_ptr<arrow::ArrayData> const& data,
+                     std::vector<std::pair<const uint8_t*, int64_t>>& buffers) {
+  for (auto const& buffer : data->buffers) {
+    if (buffer != nullptr && buffer->size() > 0) {
+      buffers.emplace_back(buffer->data(), buffer->size());
+    }
+  }
+  for (auto const& child : data->child_data) {
+    collect_buffers(child, buffers);
+  }
+  if (data->dictionary != nullptr) {
+#if defined(ARROW_VERSION) && ARROW_VERSION < 1000000
+    collect_buffers(data->dictionary->data(), buffers);
+#else
+    collect_buffers(data->dictionary, buffers);
+#endif
+  }
+}
+
+}  // namespace
+
+Status ArrowIpcView::Make(std::shared_ptr<vineyard::DataFrame> const& df,
+                          std::shared_ptr<ArrowIpcView>& view) {
+  view = std::shared_ptr<ArrowIpcView>(new ArrowIpcView());
+  view->df_ = df;
+  view->batch_ = df->AsBatch(false);
+
+  std::vector<std::pair<const uint8_t*, int64_t>> buffers;
+  for (auto const& column : view->batch_->columns()) {
+    collect_buffers(column->data(), buffers);
+  }
+  auto sink = std::make_shared<SegmentOutputStream>(
+      std::move(buffers), view->framing_, view->segments_);
+
+  std::shared_ptr<arrow::ipc::RecordBatchWriter> writer;
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 2000000
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      writer, arrow::ipc::MakeFileWriter(sink, view->batch_->schema()));
+#else
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      writer, arrow::ipc::RecordBatchFileWriter::Open(sink.get(),
+                                                      view->batch_->schema()));
+#endif
+  RETURN_ON_ARROW_ERROR(writer->WriteRecordBatch(*view->batch_));
+  RETURN_ON_ARROW_ERROR(writer->Close());
+  view->size_ = sink->Tell().ValueOrDie();
+  return Status::OK();
+}
+
+Status ArrowIpcView::Read(int64_t offset, int64_t nbytes, char* out,
+                          int64_t& nread) {
+  nread = 0;
+  int64_t end = std::min(offset + nbytes, size_);
+  auto iter = std::upper_bound(
+      segments_.begin(), segments_.end(), offset,
+      [](int64_t offset, Segment const& segment) {
+        return offset < segment.offset;
+      });
+  if (iter != segments_.begin()) {
+    --iter;
+  }
+  for (; offset < end && iter != segments_.end(); ++iter) {
+    int64_t begin = offset - iter->offset;
+    int64_t copied = std::min(end, iter->offset + iter->size) - offset;
+    const char* data =
+        iter->data != nullptr
+            ? reinterpret_cast<const char*>(iter->data) + begin
+            : framing_.data() + iter->framing_offset + begin;
+    memcpy(out + nread, data, copied);
+    offset += copied;
+    nread += copied;
+  }
+  return Status::OK();
+}
+
+}  // namespace fuse
+}  // namespace vineyard
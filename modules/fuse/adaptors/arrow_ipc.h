@@ -0,0 +1,74 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_FUSE_ADAPTORS_ARROW_IPC_H_
+#define MODULES_FUSE_ADAPTORS_ARROW_IPC_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/record_batch.h"
+
+#include "basic/ds/dataframe.h"
+#include "client/client.h"
+#include "common/util/status.h"
+#include "fuse/adaptors/view.h"
+
+namespace vineyard {
+namespace fuse {
+
+/**
+ * @brief ArrowIpcView presents a dataframe as an arrow IPC file without
+ * copying the column data.
+ *
+ * The file is laid out once by the arrow IPC file writer, the framing, i.e.,
+ * the magic, the flatbuffer messages, the paddings and the footer, is kept in
+ * memory, and the body buffers are recorded as references to the blobs of the
+ * dataframe, which are copied from the shared memory directly on reads.
+ */
+class ArrowIpcView : public View {
+ public:
+  static Status Make(std::shared_ptr<vineyard::DataFrame> const& df,
+                     std::shared_ptr<ArrowIpcView>& view);
+
+  int64_t size() const override { return size_; }
+
+  Status Read(int64_t offset, int64_t nbytes, char* out,
+              int64_t& nread) override;
+
+  /**
+   * @brief A range of the file, which is either a slice of the framing or a
+   * reference to a buffer of the dataframe.
+   */
+  struct Segment {
+    int64_t offset;  // in the file
+    int64_t size;
+    const uint8_t* data;  // nullptr for the framing
+    int64_t framing_offset;
+  };
+
+ private:
+  std::shared_ptr<vineyard::DataFrame> df_;
+  std::shared_ptr<arrow::RecordBatch> batch_;
+  int64_t size_ = 0;
+  std::string framing_;
+  std::vector<Segment> segments_;
+};
+
+}  // namespace fuse
+}  // namespace vineyard
+
+#endif  // MODULES_FUSE_ADAPTORS_ARROW_IPC_H_
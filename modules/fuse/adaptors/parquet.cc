@@ -17,10 +17,15 @@ limitations under the License.
 
 #if defined(WITH_PARQUET)
 
+#include <algorithm>
+#include <cstring>
 #include <limits>
 #include <memory>
+#include <string>
 
+#include "arrow/io/interfaces.h"
 #include "arrow/io/memory.h"
+#include "arrow/util/config.h"
 #include "arrow/util/logging.h"
 #include "parquet/api/reader.h"
 #include "parquet/api/schema.h"
@@ -28,21 +33,68 @@ limitations under the License.
 #include "parquet/arrow/reader.h"
 #include "parquet/arrow/schema.h"
 #include "parquet/arrow/writer.h"
+#include "parquet/metadata.h"
+
+#include "basic/ds/arrow_utils.h"
 
 namespace vineyard {
 namespace fuse {
 
-std::shared_ptr<arrow::Buffer> parquet_view(
-    std::shared_ptr<vineyard::DataFrame>& df) {
-  // Add writer properties
+namespace {
+
+std::shared_ptr<::parquet::WriterProperties> writer_properties(
+    size_t max_row_group_length) {
   ::parquet::WriterProperties::Builder builder;
   builder.encoding(::parquet::Encoding::PLAIN);
   builder.disable_dictionary();
   builder.compression(::parquet::Compression::UNCOMPRESSED);
   builder.disable_statistics();
   builder.write_batch_size(std::numeric_limits<size_t>::max());
-  builder.max_row_group_length(std::numeric_limits<size_t>::max());
-  std::shared_ptr<::parquet::WriterProperties> props = builder.build();
+  builder.max_row_group_length(max_row_group_length);
+  return builder.build();
+}
+
+/**
+ * @brief An output stream that only counts the bytes, except the ones written
+ * after `Keep()`.
+ */
+class TailOutputStream : public arrow::io::OutputStream {
+ public:
+  arrow::Status Close() override {
+    closed_ = true;
+    return arrow::Status::OK();
+  }
+
+  bool closed() const override { return closed_; }
+
+  arrow::Result<int64_t> Tell() const override { return position_; }
+
+  arrow::Status Write(const void* data, int64_t nbytes) override {
+    if (keeping_) {
+      tail_.append(static_cast<const char*>(data), nbytes);
+    }
+    position_ += nbytes;
+    return arrow::Status::OK();
+  }
+
+  void Keep() { keeping_ = true; }
+
+  std::string const& tail() const { return tail_; }
+
+ private:
+  bool closed_ = false;
+  bool keeping_ = false;
+  int64_t position_ = 0;
+  std::string tail_;
+};
+
+}  // namespace
+
+std::shared_ptr<arrow::Buffer> parquet_view(
+    std::shared_ptr<vineyard::DataFrame>& df) {
+  // Add writer properties
+  std::shared_ptr<::parquet::WriterProperties> props =
+      writer_properties(std::numeric_limits<size_t>::max());
 
   auto batch = df->AsBatch(false);
   std::shared_ptr<arrow::Table> table;
@@ -56,6 +108,143 @@ std::shared_ptr<arrow::Buffer> parquet_view(
   return buffer;
 }
 
+Status ParquetView::Make(std::shared_ptr<vineyard::DataFrame> const& df,
+                         std::shared_ptr<ParquetView>& view) {
+  view = std::shared_ptr<ParquetView>(new ParquetView());
+  view->df_ = df;
+  RETURN_ON_ERROR(RecordBatchesToTable({df->AsBatch(false)}, &view->table_));
+
+  // the bytes are discarded, except the last row group and the footer, as
+  // the last row group is only flushed when closing the writer.
+  auto sink = std::make_shared<TailOutputStream>();
+  auto props = writer_properties(kRowGroupLength);
+  std::unique_ptr<::parquet::arrow::FileWriter> writer;
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 10000000
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      writer, ::parquet::arrow::FileWriter::Open(
+                  *view->table_->schema(), arrow::default_memory_pool(), sink,
+                  props));
+#else
+  RETURN_ON_ARROW_ERROR(::parquet::arrow::FileWriter::Open(
+      *view->table_->schema(), arrow::default_memory_pool(), sink, props,
+      &writer));
+#endif
+  RETURN_ON_ARROW_ERROR(writer->WriteTable(*view->table_, kRowGroupLength));
+  sink->Keep();
+  RETURN_ON_ARROW_ERROR(writer->Close());
+
+  // the footer: metadata, its length in 4 bytes and the magic "PAR1"
+  auto const& tail = sink->tail();
+  if (tail.size() < 8) {
+    return Status::Invalid("Failed to encode the parquet footer");
+  }
+  uint32_t metadata_length = 0;
+  memcpy(&metadata_length, tail.data() + tail.size() - 8, sizeof(uint32_t));
+  if (tail.size() < metadata_length + 8) {
+    return Status::Invalid("Failed to encode the parquet footer");
+  }
+  view->footer_ = arrow::Buffer::FromString(
+      tail.substr(tail.size() - 8 - metadata_length));
+  view->size_ = sink->Tell().ValueOrDie();
+
+  uint32_t length = metadata_length;
+  auto metadata =
+      ::parquet::FileMetaData::Make(view->footer_->data(), &length);
+  int64_t offset = 4;
+  view->row_group_offsets_.push_back(offset);
+  for (int i = 0; i < metadata->num_row_groups(); ++i) {
+    auto row_group = metadata->RowGroup(i);
+    for (int j = 0; j < row_group->num_columns(); ++j) {
+      auto column = row_group->ColumnChunk(j);
+      int64_t begin = column->has_dictionary_page()
+                          ? column->dictionary_page_offset()
+                          : column->data_page_offset();
+      offset = std::max(offset, begin + column->total_compressed_size());
+    }
+    view->row_group_offsets_.push_back(offset);
+  }
+  if (offset != view->size_ - view->footer_->size()) {
+    return Status::Invalid("Unexpected layout of the parquet row groups");
+  }
+  return Status::OK();
+}
+
+Status ParquetView::Read(int64_t offset, int64_t nbytes, char* out,
+                         int64_t& nread) {
+  static const char magic[] = "PAR1";
+  nread = 0;
+  int64_t end = std::min(offset + nbytes, size_);
+  int64_t footer_offset = size_ - footer_->size();
+  while (offset < end) {
+    int64_t copied = 0;
+    if (offset < 4) {
+      copied = std::min<int64_t>(4, end) - offset;
+      memcpy(out + nread, magic + offset, copied);
+    } else if (offset >= footer_offset) {
+      copied = end - offset;
+      memcpy(out + nread, footer_->data() + (offset - footer_offset), copied);
+    } else {
+      size_t index = std::upper_bound(row_group_offsets_.begin(),
+                                      row_group_offsets_.end(), offset) -
+                     row_group_offsets_.begin() - 1;
+      std::shared_ptr<arrow::Buffer> row_group;
+      RETURN_ON_ERROR(rowGroup(index, row_group));
+      int64_t begin = row_group_offsets_[index];
+      copied = std::min(end, row_group_offsets_[index + 1]) - offset;
+      memcpy(out + nread, row_group->data() + (offset - begin), copied);
+    }
+    offset += copied;
+    nread += copied;
+  }
+  return Status::OK();
+}
+
+void ParquetView::Release() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  cache_.clear();
+  cache_index_.clear();
+}
+
+Status ParquetView::rowGroup(size_t index,
+                             std::shared_ptr<arrow::Buffer>& buffer) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = cache_index_.find(index);
+    if (iter != cache_index_.end()) {
+      cache_.splice(cache_.begin(), cache_, iter->second);
+      buffer = iter->second->second;
+      return Status::OK();
+    }
+  }
+
+  // a standalone file of the row group, its pages follow the magic "PAR1"
+  int64_t size = row_group_offsets_[index + 1] - row_group_offsets_[index];
+  auto slice = table_->Slice(index * kRowGroupLength, kRowGroupLength);
+  std::shared_ptr<arrow::io::BufferOutputStream> sink;
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(sink,
+                                   arrow::io::BufferOutputStream::Create());
+  RETURN_ON_ARROW_ERROR(::parquet::arrow::WriteTable(
+      *slice, arrow::default_memory_pool(), sink, kRowGroupLength,
+      writer_properties(kRowGroupLength)));
+  std::shared_ptr<arrow::Buffer> file;
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(file, sink->Finish());
+  if (file->size() < 4 + size) {
+    return Status::Invalid("Unexpected size of the parquet row group");
+  }
+  buffer = arrow::SliceBuffer(file, 4, size);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (cache_index_.find(index) == cache_index_.end()) {
+    cache_.emplace_front(index, buffer);
+    cache_index_[index] = cache_.begin();
+    if (cache_.size() > kCachedRowGroups) {
+      cache_index_.erase(cache_.back().first);
+      cache_.pop_back();
+    }
+  }
+  return Status::OK();
+}
+
 }  // namespace fuse
 }  // namespace vineyard
 
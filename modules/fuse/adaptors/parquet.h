@@ -18,10 +18,20 @@ limitations under the License.
 
 #if defined(WITH_PARQUET)
 
+#include <list>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "arrow/buffer.h"
+#include "arrow/table.h"
 
 #include "basic/ds/dataframe.h"
 #include "client/client.h"
+#include "common/util/status.h"
+#include "fuse/adaptors/view.h"
 
 namespace vineyard {
 namespace fuse {
@@ -29,6 +39,51 @@ namespace fuse {
 std::shared_ptr<arrow::Buffer> parquet_view(
     std::shared_ptr<vineyard::DataFrame>& df);
 
+/**
+ * @brief ParquetView presents a dataframe as a parquet file, whose row groups
+ * are encoded on demand for the byte ranges being read.
+ *
+ * The whole frame is encoded once when the view is made to lay out the row
+ * groups, and only the footer is kept. The pages of a row group don't depend
+ * on where the row group is placed in a file, thus reading a range re-encodes
+ * the row groups it covers, and the most recently used ones are cached.
+ */
+class ParquetView : public View {
+ public:
+  static constexpr int64_t kRowGroupLength = 64 * 1024;
+  static constexpr size_t kCachedRowGroups = 8;
+
+  static Status Make(std::shared_ptr<vineyard::DataFrame> const& df,
+                     std::shared_ptr<ParquetView>& view);
+
+  int64_t size() const override { return size_; }
+
+  Status Read(int64_t offset, int64_t nbytes, char* out,
+              int64_t& nread) override;
+
+  /**
+   * @brief Drop the cached row groups.
+   */
+  void Release() override;
+
+ private:
+  Status rowGroup(size_t index, std::shared_ptr<arrow::Buffer>& buffer);
+
+  std::shared_ptr<vineyard::DataFrame> df_;
+  std::shared_ptr<arrow::Table> table_;
+  int64_t size_ = 0;
+  // the byte offsets of the row groups in the file, and the end of the last
+  std::vector<int64_t> row_group_offsets_;
+  std::shared_ptr<arrow::Buffer> footer_;
+
+  std::mutex mutex_;
+  std::list<std::pair<size_t, std::shared_ptr<arrow::Buffer>>> cache_;
+  std::unordered_map<
+      size_t,
+      std::list<std::pair<size_t, std::shared_ptr<arrow::Buffer>>>::iterator>
+      cache_index_;
+};
+
 }  // namespace fuse
 }  // namespace vineyard
 
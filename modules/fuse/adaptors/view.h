@@ -0,0 +1,54 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_FUSE_ADAPTORS_VIEW_H_
+#define MODULES_FUSE_ADAPTORS_VIEW_H_
+
+#include <cstdint>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+namespace fuse {
+
+/**
+ * @brief A read-only file that presents a vineyard object in some format.
+ */
+class View {
+ public:
+  virtual ~View() = default;
+
+  /**
+   * @brief The size of the file, in bytes.
+   */
+  virtual int64_t size() const = 0;
+
+  /**
+   * @brief Copy the bytes in `[offset, offset + nbytes)` of the file to `out`,
+   * and returns the number of bytes copied.
+   */
+  virtual Status Read(int64_t offset, int64_t nbytes, char* out,
+                      int64_t& nread) = 0;
+
+  /**
+   * @brief Drop the cached content when the file is released.
+   */
+  virtual void Release() {}
+};
+
+}  // namespace fuse
+}  // namespace vineyard
+
+#endif  // MODULES_FUSE_ADAPTORS_VIEW_H_
@@ -16,6 +16,9 @@ limitations under the License.
 #include "fuse/fused.h"
 
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <unordered_map>
 
 #include "basic/ds/array.h"
@@ -33,6 +36,132 @@ namespace fuse {
 
 struct fs::fs_state_t fs::state {};
 
+namespace {
+
+constexpr char kArrowIpcSuffix[] = ".arrow";
+
+bool is_arrow_ipc(std::string const& name) {
+  size_t length = sizeof(kArrowIpcSuffix) - 1;
+  return name.size() > length &&
+         name.compare(name.size() - length, length, kArrowIpcSuffix) == 0;
+}
+
+ObjectID object_id(std::string const& name) {
+  if (is_arrow_ipc(name)) {
+    return ObjectIDFromString(
+        name.substr(0, name.size() - (sizeof(kArrowIpcSuffix) - 1)));
+  }
+  return ObjectIDFromString(name);
+}
+
+/**
+ * @brief Evict the least recently used views that have no open handles, until
+ * there are at most `max_views` views, requires `state.mutex`.
+ */
+void evict_views() {
+  auto& views = fs::state.views;
+  while (views.size() > fs::state.max_views) {
+    auto victim = views.end();
+    for (auto iter = views.begin(); iter != views.end(); ++iter) {
+      if (iter->second->open_handles == 0 &&
+          (victim == views.end() ||
+           iter->second->last_used < victim->second->last_used)) {
+        victim = iter;
+      }
+    }
+    if (victim == views.end()) {
+      break;
+    }
+    views.erase(victim);
+  }
+}
+
+std::shared_ptr<View> make_view(std::string const& name) {
+  auto object =
+      fs::state.client->GetObject<vineyard::DataFrame>(object_id(name));
+  if (object == nullptr) {
+    return nullptr;
+  }
+  Status status;
+  std::shared_ptr<View> view;
+  if (is_arrow_ipc(name)) {
+    std::shared_ptr<ArrowIpcView> ipc_view;
+    status = ArrowIpcView::Make(object, ipc_view);
+    view = ipc_view;
+  } else {
+#if defined(WITH_PARQUET)
+    std::shared_ptr<ParquetView> parquet_view;
+    status = ParquetView::Make(object, parquet_view);
+    view = parquet_view;
+#else
+    status = Status::NotImplemented("vineyard-fuse is built without parquet");
+#endif
+  }
+  if (!status.ok()) {
+    LOG(ERROR) << "fuse: failed to make the view of " << name << ": "
+               << status.ToString();
+    return nullptr;
+  }
+  return view;
+}
+
+/**
+ * @brief Get the view of the file, i.e., the parquet view of the dataframe
+ * for `<object id>`, and the arrow IPC view for `<object id>.arrow`, which is
+ * made on the first access. Returns nullptr if the object is not a dataframe.
+ *
+ * The view is pinned in the cache until `release_view` when `open` is true.
+ */
+std::shared_ptr<View> get_view(std::string const& name, bool open = false) {
+  std::shared_ptr<fs::fs_state_t::view_entry_t> entry;
+  {
+    std::lock_guard<std::mutex> lock(fs::state.mutex);
+    auto& slot = fs::state.views[name];
+    if (slot == nullptr) {
+      slot = std::make_shared<fs::fs_state_t::view_entry_t>();
+    }
+    slot->last_used = ++fs::state.clock;
+    slot->open_handles += open ? 1 : 0;
+    entry = slot;
+    evict_views();
+  }
+
+  std::lock_guard<std::mutex> lock(entry->mutex);
+  if (entry->view == nullptr) {
+    entry->view = make_view(name);
+  }
+  if (entry->view == nullptr && open) {
+    std::lock_guard<std::mutex> lock(fs::state.mutex);
+    entry->open_handles -= 1;
+  }
+  return entry->view;
+}
+
+void release_view(std::string const& name) {
+  std::shared_ptr<fs::fs_state_t::view_entry_t> entry;
+  {
+    std::lock_guard<std::mutex> lock(fs::state.mutex);
+    auto loc = fs::state.views.find(name);
+    if (loc == fs::state.views.end()) {
+      return;
+    }
+    loc->second->open_handles -= 1;
+    if (loc->second->open_handles == 0) {
+      entry = loc->second;
+    }
+    evict_views();
+  }
+  if (entry != nullptr) {
+    // keeps the layout, only the cached content is dropped
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    if (entry->view != nullptr) {
+      entry->view->Release();
+    }
+  }
+}
+
+}  // namespace
+
 int fs::fuse_getattr(const char* path, struct stat* stbuf,
                      struct fuse_file_info*) {
   VLOG(2) << "fuse: getattr on " << path;
@@ -43,7 +172,7 @@ int fs::fuse_getattr(const char* path, struct stat* stbuf,
     stbuf->st_nlink = 2;
     return 0;
   }
-  auto id = ObjectIDFromString(path + 1);
+  auto id = object_id(path + 1);
   bool exists = false;
   VINEYARD_CHECK_OK(state.client->Exists(id, exists));
   if (!exists) {
@@ -52,7 +181,8 @@ int fs::fuse_getattr(const char* path, struct stat* stbuf,
 
   stbuf->st_mode = S_IFREG | 0444;
   stbuf->st_nlink = 1;
-  stbuf->st_size = 0;  // not used, as we use `direct_io` in `open`.
+  auto view = get_view(path + 1);
+  stbuf->st_size = view == nullptr ? 0 : view->size();
   return 0;
 }
 
@@ -62,20 +192,12 @@ int fs::fuse_open(const char* path, struct fuse_file_info* fi) {
   if ((fi->flags & O_ACCMODE) != O_RDONLY) {
     return -EACCES;
   }
-  auto target = ObjectIDFromString(path + 1);
-  auto object = state.client->GetObject<vineyard::DataFrame>(target);
-  if (object == nullptr) {
+  if (get_view(path + 1, true) == nullptr) {
     return -ENOENT;
   }
-  auto loc = state.views.find(target);
-  if (loc == state.views.end()) {
-    state.views[target] = fuse::parquet_view(object);
-  }
-  // bypass kernel's page cache to avoid knowing the size in `getattr`.
-  //
-  // see also:
-  // https://stackoverflow.com/questions/46267972/fuse-avoid-calculating-size-in-getattr
-  fi->direct_io = 1;
+  // the real size is reported in `getattr`, and the content never changes,
+  // thus the kernel's page cache can be used.
+  fi->keep_cache = 1;
   return 0;
 }
 
@@ -84,33 +206,23 @@ int fs::fuse_read(const char* path, char* buf, size_t size, off_t offset,
   VLOG(2) << "fuse: read " << path << " from " << offset << ", expect " << size
           << " bytes";
 
-  auto target = ObjectIDFromString(path + 1);
-  auto loc = state.views.find(target);
-  if (loc == state.views.end()) {
+  auto view = get_view(path + 1);
+  if (view == nullptr) {
     return -ENOENT;
   }
-  auto buffer = loc->second;
-  if (offset >= buffer->size()) {
-    return 0;
-  } else {
-    size_t slice = size;
-    if (slice > static_cast<size_t>(buffer->size() - offset)) {
-      slice = buffer->size() - offset;
-    }
-    memcpy(buf, buffer->data() + offset, slice);
-    return slice;
+  int64_t nread = 0;
+  auto status = view->Read(offset, size, buf, nread);
+  if (!status.ok()) {
+    LOG(ERROR) << "fuse: failed to read " << path << ": " << status.ToString();
+    return -EIO;
   }
+  return nread;
 }
 
 int fs::fuse_release(const char* path, struct fuse_file_info*) {
   VLOG(2) << "fuse: release " << path;
 
-  auto target = ObjectIDFromString(path + 1);
-  auto loc = state.views.find(target);
-  if (loc == state.views.end()) {
-    return -ENOENT;
-  }
-  state.views.erase(loc);
+  release_view(path + 1);
   return 0;
 }
 
@@ -142,6 +254,8 @@ int fs::fuse_readdir(const char* path, void* buf, fuse_fill_dir_t filler,
   for (auto const& item : metas) {
     std::string base = ObjectIDToString(item.first).c_str();
     filler(buf, base.c_str(), NULL, 0, fuse_fill_dir_flags::FUSE_FILL_DIR_PLUS);
+    std::string ipc = base + kArrowIpcSuffix;
+    filler(buf, ipc.c_str(), NULL, 0, fuse_fill_dir_flags::FUSE_FILL_DIR_PLUS);
   }
   return 0;
 }
@@ -160,7 +274,10 @@ void* fs::fuse_init(struct fuse_conn_info* conn, struct fuse_config* cfg) {
 void fs::fuse_destroy(void* private_data) {
   VLOG(2) << "fuse: destroy";
 
-  state.views.clear();
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.views.clear();
+  }
   state.client->Disconnect();
 }
 
@@ -17,6 +17,7 @@ limitations under the License.
 #define MODULES_FUSE_FUSED_H_
 
 #include <memory>
+#include <mutex>
 #include <ostream>
 #include <sstream>
 #include <string>
@@ -30,19 +31,32 @@ limitations under the License.
 
 #include "client/client.h"
 
-namespace arrow {
-class Buffer;
-}
-
 namespace vineyard {
 
 namespace fuse {
 
+class View;
+
 struct fs {
   static struct fs_state_t {
     std::string vineyard_socket;
     std::shared_ptr<Client> client;
-    std::unordered_map<ObjectID, std::shared_ptr<arrow::Buffer>> views;
+    // the views of files, i.e., `<object id>` for parquet and
+    // `<object id>.arrow` for arrow IPC, shared by the open handles and kept
+    // after release, as the objects are immutable, up to `max_views` views.
+    //
+    // `mutex` only protects the map, views are made under the mutex of their
+    // entries, thus readers of different objects never wait for each other.
+    struct view_entry_t {
+      std::mutex mutex;
+      std::shared_ptr<View> view;
+      int open_handles = 0;
+      uint64_t last_used = 0;
+    };
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<view_entry_t>> views;
+    uint64_t clock = 0;
+    size_t max_views = 64;
   } state;
 
   static int fuse_getattr(const char* path, struct stat* stbuf,
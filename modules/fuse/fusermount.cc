@@ -33,6 +33,7 @@ limitations under the License.
  */
 static struct options {
   const char* vineyard_socket;
+  int max_views;
   int show_help;
 } options;
 
@@ -41,6 +42,7 @@ static struct options {
 
 static const struct fuse_opt option_spec[] = {
     OPTION("--vineyard-socket=%s", vineyard_socket),
+    OPTION("--max-views=%d", max_views),
     OPTION("--help", show_help), OPTION("-h", show_help), FUSE_OPT_END};
 
 static void print_help(const char* progname) {
@@ -50,6 +52,8 @@ static void print_help(const char* progname) {
       "    --vineyard-socket=<s>  Path of UNIX-domain socket of vineyard "
       "server\n"
       "                           (default: \"$VINEYARD_IPC_SOCKET\")\n"
+      "    --max-views=<n>        Number of file views that are cached\n"
+      "                           (default: 64)\n"
       "\n");
 }
 
@@ -58,6 +62,7 @@ static int process_args(struct fuse_args& args, int argc, char** argv) {
   // the defaults if other values are specified.
   std::string env = vineyard::read_env("VINEYARD_IPC_SOCKET");
   options.vineyard_socket = strdup(env.c_str());
+  options.max_views = 64;
 
   /* Parse options */
   if (fuse_opt_parse(&args, &options, option_spec, NULL) == -1) {
@@ -82,6 +87,9 @@ static int process_args(struct fuse_args& args, int argc, char** argv) {
 
   // populate state
   vineyard::fuse::fs::state.vineyard_socket = options.vineyard_socket;
+  if (options.max_views > 0) {
+    vineyard::fuse::fs::state.max_views = options.max_views;
+  }
   return 0;
 }
 
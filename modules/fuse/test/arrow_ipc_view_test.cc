@@ -0,0 +1,131 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/io/memory.h"
+#include "arrow/ipc/api.h"
+#include "arrow/util/config.h"
+
+#include "basic/ds/arrow_utils.h"
+#include "basic/ds/dataframe.h"
+#include "basic/ds/tensor.h"
+#include "client/client.h"
+#include "common/util/logging.h"
+#include "fuse/adaptors/arrow_ipc.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The file is read with ranges that fall within the framing, within the
+// column data, and that span both.
+constexpr int64_t kRows = 100003;
+constexpr int64_t kReadSizes[] = {1, 3, 8, 4096, 100003, 1 << 20};
+
+std::shared_ptr<DataFrame> makeDataFrame(Client& client) {
+  DataFrameBuilder builder(client);
+  auto ints = std::make_shared<TensorBuilder<int64_t>>(
+      client, std::vector<int64_t>{kRows});
+  auto doubles = std::make_shared<TensorBuilder<double>>(
+      client, std::vector<int64_t>{kRows});
+  for (int64_t row = 0; row < kRows; ++row) {
+    ints->data()[row] = row * 7;
+    doubles->data()[row] = row + 0.5;
+  }
+  builder.AddColumn("a", ints);
+  builder.AddColumn("b", doubles);
+  return std::dynamic_pointer_cast<DataFrame>(builder.Seal(client));
+}
+
+std::string readFile(fuse::View& view, int64_t const step) {
+  std::string content(view.size(), '\0');
+  int64_t offset = 0;
+  for (size_t round = 0; offset < view.size(); ++round) {
+    int64_t nbytes = step > 0 ? step
+                              : kReadSizes[round % (sizeof(kReadSizes) /
+                                                    sizeof(int64_t))];
+    nbytes = std::min(nbytes, view.size() - offset);
+    int64_t nread = 0;
+    VINEYARD_CHECK_OK(view.Read(offset, nbytes, &content[offset], nread));
+    CHECK_EQ(nread, nbytes);
+    offset += nread;
+  }
+  // nothing beyond the end of the file
+  int64_t nread = -1;
+  char out[16];
+  VINEYARD_CHECK_OK(view.Read(view.size(), sizeof(out), out, nread));
+  CHECK_EQ(nread, 0);
+  return content;
+}
+
+std::shared_ptr<arrow::RecordBatch> parseFile(std::string const& content) {
+  arrow::io::BufferReader input(arrow::Buffer::FromString(content));
+  std::shared_ptr<arrow::ipc::RecordBatchFileReader> reader;
+  std::shared_ptr<arrow::RecordBatch> batch;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  CHECK_ARROW_ERROR(arrow::ipc::RecordBatchFileReader::Open(&input, &reader));
+  CHECK_EQ(reader->num_record_batches(), 1);
+  CHECK_ARROW_ERROR(reader->ReadRecordBatch(0, &batch));
+#else
+  CHECK_ARROW_ERROR_AND_ASSIGN(reader,
+                               arrow::ipc::RecordBatchFileReader::Open(&input));
+  CHECK_EQ(reader->num_record_batches(), 1);
+  CHECK_ARROW_ERROR_AND_ASSIGN(batch, reader->ReadRecordBatch(0));
+#endif
+  return batch;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./arrow_ipc_view_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  auto df = makeDataFrame(client);
+  auto expected = df->AsBatch(false);
+
+  std::shared_ptr<fuse::ArrowIpcView> view;
+  VINEYARD_CHECK_OK(fuse::ArrowIpcView::Make(df, view));
+  // the column data, and a little framing
+  int64_t data_size = kRows * (sizeof(int64_t) + sizeof(double));
+  CHECK_GE(view->size(), data_size);
+  CHECK_LT(view->size(), data_size + 4096);
+
+  // the file read in ranges is a valid arrow IPC file of the frame
+  std::string content = readFile(*view, 0);
+  CHECK(parseFile(content)->Equals(*expected));
+  CHECK(readFile(*view, 65537) == content);
+  CHECK(readFile(*view, view->size()) == content);
+
+  // the view still reads the same bytes after releasing
+  view->Release();
+  CHECK(readFile(*view, 4096) == content);
+  LOG(INFO) << "Passed arrow ipc view tests...";
+
+  VINEYARD_CHECK_OK(client.DelData(df->id(), true, true));
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,214 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "basic/ds/dataframe.h"
+#include "basic/ds/tensor.h"
+#include "client/client.h"
+#include "common/util/logging.h"
+#include "common/util/uuid.h"
+#include "fuse/adaptors/arrow_ipc.h"
+#include "fuse/fused.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The callbacks are invoked directly, as fuse's multi-threaded loop would, on
+// the arrow IPC files of a few dataframes, without mounting the filesystem.
+constexpr size_t kFrames = 4;
+constexpr int kReaders = 8;
+
+std::shared_ptr<DataFrame> makeDataFrame(Client& client, int64_t rows) {
+  DataFrameBuilder builder(client);
+  auto ints = std::make_shared<TensorBuilder<int64_t>>(
+      client, std::vector<int64_t>{rows});
+  for (int64_t row = 0; row < rows; ++row) {
+    ints->data()[row] = row * 7;
+  }
+  builder.AddColumn("a", ints);
+  return std::dynamic_pointer_cast<DataFrame>(builder.Seal(client));
+}
+
+std::string arrowPath(std::shared_ptr<DataFrame> const& df) {
+  return "/" + ObjectIDToString(df->id()) + ".arrow";
+}
+
+std::string readPath(std::string const& path, size_t size, size_t step) {
+  std::string content(size, '\0');
+  for (size_t offset = 0; offset < size; offset += step) {
+    size_t nbytes = std::min(step, size - offset);
+    struct fuse_file_info fi;
+    memset(&fi, 0, sizeof(fi));
+    CHECK_EQ(fuse::fs::fuse_read(path.c_str(), &content[offset], nbytes,
+                                 offset, &fi),
+             static_cast<int>(nbytes));
+  }
+  return content;
+}
+
+int filler(void* buf, const char* name, const struct stat*, off_t,
+           enum fuse_fill_dir_flags) {
+  static_cast<std::vector<std::string>*>(buf)->emplace_back(name);
+  return 0;
+}
+
+bool cached(std::string const& path) {
+  std::lock_guard<std::mutex> lock(fuse::fs::state.mutex);
+  auto loc = fuse::fs::state.views.find(path.substr(1));
+  return loc != fuse::fs::state.views.end() && loc->second->view != nullptr;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./fused_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<std::shared_ptr<DataFrame>> dfs;
+  std::vector<std::string> expected;
+  for (size_t index = 0; index < kFrames; ++index) {
+    dfs.emplace_back(makeDataFrame(client, 10000 * (index + 1)));
+    std::shared_ptr<fuse::ArrowIpcView> view;
+    VINEYARD_CHECK_OK(fuse::ArrowIpcView::Make(dfs.back(), view));
+    std::string content(view->size(), '\0');
+    int64_t nread = 0;
+    VINEYARD_CHECK_OK(view->Read(0, view->size(), &content[0], nread));
+    expected.emplace_back(content);
+  }
+
+  fuse::fs::state.vineyard_socket = ipc_socket;
+  fuse::fs::state.max_views = 2;
+  struct fuse_config cfg;
+  memset(&cfg, 0, sizeof(cfg));
+  fuse::fs::fuse_init(nullptr, &cfg);
+
+  // every dataframe is listed as a parquet file and an arrow IPC file
+  {
+    std::vector<std::string> names;
+    CHECK_EQ(fuse::fs::fuse_readdir("/", &names, filler, 0, nullptr,
+                                    static_cast<fuse_readdir_flags>(0)),
+             0);
+    for (auto const& df : dfs) {
+      std::string base = ObjectIDToString(df->id());
+      CHECK(std::find(names.begin(), names.end(), base) != names.end());
+      CHECK(std::find(names.begin(), names.end(), base + ".arrow") !=
+            names.end());
+    }
+  }
+
+  // the files are read only, and missing objects don't exist
+  {
+    struct stat stbuf;
+    for (size_t index = 0; index < kFrames; ++index) {
+      CHECK_EQ(fuse::fs::fuse_getattr(arrowPath(dfs[index]).c_str(), &stbuf,
+                                      nullptr),
+               0);
+      CHECK_EQ(stbuf.st_size, static_cast<off_t>(expected[index].size()));
+    }
+    struct fuse_file_info fi;
+    memset(&fi, 0, sizeof(fi));
+    fi.flags = O_WRONLY;
+    CHECK_EQ(fuse::fs::fuse_open(arrowPath(dfs[0]).c_str(), &fi), -EACCES);
+    std::string missing = "/" + ObjectIDToString(GenerateObjectID()) + ".arrow";
+    CHECK_EQ(fuse::fs::fuse_getattr(missing.c_str(), &stbuf, nullptr),
+             -ENOENT);
+  }
+  LOG(INFO) << "Passed listing files tests...";
+
+  // the readers of all files go on in parallel on the shared views
+  {
+    std::vector<std::thread> readers;
+    for (int reader = 0; reader < kReaders; ++reader) {
+      readers.emplace_back([&, reader]() {
+        size_t index = reader % kFrames;
+        auto path = arrowPath(dfs[index]);
+        struct fuse_file_info fi;
+        memset(&fi, 0, sizeof(fi));
+        fi.flags = O_RDONLY;
+        CHECK_EQ(fuse::fs::fuse_open(path.c_str(), &fi), 0);
+        for (size_t step : {4096, 10007, 1 << 20}) {
+          CHECK(readPath(path, expected[index].size(), step) ==
+                expected[index]);
+        }
+        CHECK_EQ(fuse::fs::fuse_release(path.c_str(), &fi), 0);
+      });
+    }
+    for (auto& reader : readers) {
+      reader.join();
+    }
+  }
+  LOG(INFO) << "Passed concurrent reading tests...";
+
+  // the opened views are pinned, the others are evicted down to `max_views`
+  {
+    std::vector<struct fuse_file_info> fis(kFrames);
+    for (size_t index = 0; index < kFrames; ++index) {
+      memset(&fis[index], 0, sizeof(fis[index]));
+      fis[index].flags = O_RDONLY;
+      CHECK_EQ(fuse::fs::fuse_open(arrowPath(dfs[index]).c_str(), &fis[index]),
+               0);
+    }
+    CHECK_EQ(fuse::fs::state.views.size(), kFrames);
+    for (size_t index = 0; index < kFrames; ++index) {
+      CHECK(cached(arrowPath(dfs[index])));
+    }
+
+    // the released views keep their layout, until the least recently used
+    // ones are evicted
+    for (size_t index = 0; index < kFrames; ++index) {
+      CHECK_EQ(fuse::fs::fuse_release(arrowPath(dfs[index]).c_str(),
+                                      &fis[index]),
+               0);
+    }
+    CHECK_EQ(fuse::fs::state.views.size(), fuse::fs::state.max_views);
+    CHECK(!cached(arrowPath(dfs[0])));
+    CHECK(!cached(arrowPath(dfs[1])));
+    CHECK(cached(arrowPath(dfs[2])));
+    CHECK(cached(arrowPath(dfs[3])));
+
+    // and the evicted ones are made again on the next access
+    CHECK(readPath(arrowPath(dfs[0]), expected[0].size(), 4096) ==
+          expected[0]);
+    CHECK(cached(arrowPath(dfs[0])));
+    CHECK_EQ(fuse::fs::state.views.size(), fuse::fs::state.max_views);
+  }
+  LOG(INFO) << "Passed evicting views tests...";
+
+  fuse::fs::fuse_destroy(nullptr);
+  CHECK(fuse::fs::state.views.empty());
+
+  for (auto const& df : dfs) {
+    VINEYARD_CHECK_OK(client.DelData(df->id(), true, true));
+  }
+  client.Disconnect();
+
+  LOG(INFO) << "Passed fused tests...";
+
+  return 0;
+}
@@ -0,0 +1,135 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/io/memory.h"
+
+#include "basic/ds/arrow_utils.h"
+#include "basic/ds/dataframe.h"
+#include "basic/ds/tensor.h"
+#include "client/client.h"
+#include "common/util/logging.h"
+#include "fuse/adaptors/parquet.h"
+
+#if defined(WITH_PARQUET)
+#include "parquet/arrow/reader.h"
+#endif
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+#if defined(WITH_PARQUET)
+
+// The frame spans a few row groups, the last one is partial, and the file is
+// read with ranges that don't align with the row groups.
+constexpr int64_t kRows = 3 * fuse::ParquetView::kRowGroupLength + 17;
+constexpr int64_t kReadSizes[] = {1, 3, 4096, 100003, 1 << 20};
+
+std::shared_ptr<DataFrame> makeDataFrame(Client& client) {
+  DataFrameBuilder builder(client);
+  auto ints = std::make_shared<TensorBuilder<int64_t>>(
+      client, std::vector<int64_t>{kRows});
+  auto doubles = std::make_shared<TensorBuilder<double>>(
+      client, std::vector<int64_t>{kRows});
+  for (int64_t row = 0; row < kRows; ++row) {
+    ints->data()[row] = row * 7;
+    doubles->data()[row] = row + 0.5;
+  }
+  builder.AddColumn("a", ints);
+  builder.AddColumn("b", doubles);
+  return std::dynamic_pointer_cast<DataFrame>(builder.Seal(client));
+}
+
+std::string readFile(fuse::View& view, int64_t const step) {
+  std::string content(view.size(), '\0');
+  int64_t offset = 0;
+  for (size_t round = 0; offset < view.size(); ++round) {
+    int64_t nbytes = step > 0 ? step
+                              : kReadSizes[round % (sizeof(kReadSizes) /
+                                                    sizeof(int64_t))];
+    nbytes = std::min(nbytes, view.size() - offset);
+    int64_t nread = 0;
+    VINEYARD_CHECK_OK(view.Read(offset, nbytes, &content[offset], nread));
+    CHECK_EQ(nread, nbytes);
+    offset += nread;
+  }
+  // nothing beyond the end of the file
+  int64_t nread = -1;
+  char out[16];
+  VINEYARD_CHECK_OK(view.Read(view.size(), sizeof(out), out, nread));
+  CHECK_EQ(nread, 0);
+  return content;
+}
+
+std::shared_ptr<arrow::Table> parseFile(std::string const& content) {
+  auto input = std::make_shared<arrow::io::BufferReader>(
+      arrow::Buffer::FromString(content));
+  std::unique_ptr<::parquet::arrow::FileReader> reader;
+  CHECK_ARROW_ERROR(::parquet::arrow::OpenFile(
+      input, arrow::default_memory_pool(), &reader));
+  CHECK_EQ(reader->num_row_groups(),
+           (kRows + fuse::ParquetView::kRowGroupLength - 1) /
+               fuse::ParquetView::kRowGroupLength);
+  std::shared_ptr<arrow::Table> table;
+  CHECK_ARROW_ERROR(reader->ReadTable(&table));
+  return table;
+}
+
+#endif
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./parquet_view_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+#if defined(WITH_PARQUET)
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  auto df = makeDataFrame(client);
+  std::shared_ptr<arrow::Table> expected;
+  VINEYARD_CHECK_OK(RecordBatchesToTable({df->AsBatch(false)}, &expected));
+
+  std::shared_ptr<fuse::ParquetView> view;
+  VINEYARD_CHECK_OK(fuse::ParquetView::Make(df, view));
+
+  // the file read in ranges is a valid parquet file of the frame
+  std::string content = readFile(*view, 0);
+  CHECK(parseFile(content)->Equals(*expected));
+
+  // the row groups that are encoded again, after being dropped from the
+  // cache, are the same bytes
+  view->Release();
+  CHECK(readFile(*view, 65537) == content);
+  CHECK(readFile(*view, view->size()) == content);
+  LOG(INFO) << "Passed parquet view tests...";
+
+  VINEYARD_CHECK_OK(client.DelData(df->id(), true, true));
+  client.Disconnect();
+#else
+  LOG(INFO) << "Parquet isn't enabled, skipping the parquet view tests...";
+#endif
+
+  return 0;
+}
@@ -0,0 +1,154 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_FRAGMENT_ADJ_LIST_INTERSECTION_H_
+#define MODULES_GRAPH_FRAGMENT_ADJ_LIST_INTERSECTION_H_
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "graph/fragment/property_graph_utils.h"
+
+namespace vineyard {
+
+namespace property_graph_utils {
+
+namespace detail {
+
+/**
+ * @brief Lower bound of `vid` in the sorted units, by a linear scan that
+ * tests four units at a time.
+ */
+template <typename VID_T, typename EID_T>
+inline const NbrUnit<VID_T, EID_T>* scan_lower_bound(
+    const NbrUnit<VID_T, EID_T>* begin, const NbrUnit<VID_T, EID_T>* end,
+    VID_T vid) {
+#if defined(__AVX2__)
+  if (sizeof(VID_T) == 8 && sizeof(NbrUnit<VID_T, EID_T>) == 16) {
+    // flip the sign bits, as AVX2 only has signed 64-bit comparisons
+    const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i key = _mm256_xor_si256(
+        _mm256_set1_epi64x(static_cast<int64_t>(vid)), sign);
+    while (begin + 4 <= end) {
+      __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+      __m256i hi =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin + 2));
+      // the vids of the four units, in the order of 0, 2, 1, 3
+      __m256i vids = _mm256_xor_si256(_mm256_unpacklo_epi64(lo, hi), sign);
+      __m256i mask = _mm256_cmpgt_epi64(key, vids);
+      int less =
+          __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(mask)));
+      begin += less;
+      if (less != 4) {
+        return begin;
+      }
+    }
+  }
+#endif
+  while (begin + 4 <= end && begin[3].vid < vid) {
+    begin += 4;
+  }
+  while (begin != end && begin->vid < vid) {
+    ++begin;
+  }
+  return begin;
+}
+
+/**
+ * @brief Lower bound of `vid` in the sorted units, by an exponential search
+ * from `begin`, followed by a binary search.
+ */
+template <typename VID_T, typename EID_T>
+inline const NbrUnit<VID_T, EID_T>* gallop_lower_bound(
+    const NbrUnit<VID_T, EID_T>* begin, const NbrUnit<VID_T, EID_T>* end,
+    VID_T vid) {
+  size_t step = 1;
+  while (begin + step < end && begin[step].vid < vid) {
+    begin += step;
+    step <<= 1;
+  }
+  return std::lower_bound(
+      begin, std::min(begin + step, end), vid,
+      [](const NbrUnit<VID_T, EID_T>& unit, VID_T v) { return unit.vid < v; });
+}
+
+}  // namespace detail
+
+/**
+ * @brief The size ratio of the adjacency lists beyond which the intersection
+ * gallops over the longer list rather than scanning it.
+ */
+constexpr size_t kGallopingIntersectionRatio = 32;
+
+/**
+ * @brief Intersect two adjacency lists whose units are sorted by the vid, as
+ * the adjacency lists of ArrowFragment are, and invoke `func(lhs_unit,
+ * rhs_unit)` for every common neighbor, in ascending order of the vids.
+ *
+ * Both lists are merged when their sizes are comparable, the longer list is
+ * galloped over otherwise. In multigraphs every parallel edge is matched at
+ * most once.
+ */
+template <typename VID_T, typename EID_T, typename FUNC_T>
+void IntersectAdjList(const RawAdjList<VID_T, EID_T>& lhs,
+                      const RawAdjList<VID_T, EID_T>& rhs, const FUNC_T& func) {
+  bool swapped = lhs.Size() > rhs.Size();
+  const RawAdjList<VID_T, EID_T>& small = swapped ? rhs : lhs;
+  const RawAdjList<VID_T, EID_T>& large = swapped ? lhs : rhs;
+  if (small.Empty()) {
+    return;
+  }
+  bool gallop = large.Size() / small.Size() >= kGallopingIntersectionRatio;
+
+  const NbrUnit<VID_T, EID_T>* cursor = large.begin();
+  const NbrUnit<VID_T, EID_T>* end = large.end();
+  for (auto unit = small.begin(); unit != small.end() && cursor != end;
+       ++unit) {
+    cursor = gallop ? detail::gallop_lower_bound(cursor, end, unit->vid)
+                    : detail::scan_lower_bound(cursor, end, unit->vid);
+    if (cursor != end && cursor->vid == unit->vid) {
+      if (swapped) {
+        func(*cursor, *unit);
+      } else {
+        func(*unit, *cursor);
+      }
+      ++cursor;
+    }
+  }
+}
+
+/**
+ * @brief The number of common neighbors of two sorted adjacency lists.
+ */
+template <typename VID_T, typename EID_T>
+size_t IntersectionSize(const RawAdjList<VID_T, EID_T>& lhs,
+                        const RawAdjList<VID_T, EID_T>& rhs) {
+  size_t count = 0;
+  IntersectAdjList(lhs, rhs,
+                   [&count](const NbrUnit<VID_T, EID_T>&,
+                            const NbrUnit<VID_T, EID_T>&) { ++count; });
+  return count;
+}
+
+}  // namespace property_graph_utils
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_FRAGMENT_ADJ_LIST_INTERSECTION_H_
@@ -17,10 +17,14 @@ limitations under the License.
 #define MODULES_GRAPH_FRAGMENT_ARROW_FRAGMENT_H_
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -34,11 +38,15 @@ limitations under the License.
 #include "grape/utils/vertex_array.h"
 
 #include "basic/ds/arrow.h"
+#include "basic/ds/encoded_array.h"
 #include "common/util/functions.h"
 #include "common/util/typename.h"
 
+#include "graph/fragment/compressed_adj_list.h"
+#include "graph/fragment/delta_adj_list.h"
 #include "graph/fragment/fragment_traits.h"
 #include "graph/fragment/graph_schema.h"
+#include "graph/fragment/outer_vertex_index.h"
 #include "graph/fragment/property_graph_types.h"
 #include "graph/fragment/property_graph_utils.h"
 #include "graph/utils/context_protocols.h"
@@ -90,6 +98,24 @@ inline std::string arrow_type_to_string(
   }
 }
 
+/**
+ * @brief The byte width of the edge property types that can be sealed in an
+ * encoding, i.e., the 32-bit and 64-bit numeric types, or 0 otherwise. The
+ * floating point values are encoded by their bit patterns, which keeps the
+ * encoding lossless.
+ */
+inline int encodable_type_width(const std::shared_ptr<arrow::DataType>& type) {
+  if (type->Equals(arrow::int32()) || type->Equals(arrow::uint32()) ||
+      type->Equals(arrow::float32())) {
+    return 4;
+  } else if (type->Equals(arrow::int64()) || type->Equals(arrow::uint64()) ||
+             type->Equals(arrow::float64())) {
+    return 8;
+  } else {
+    return 0;
+  }
+}
+
 class ArrowFragmentBase : public vineyard::Object {
  public:
   using prop_id_t = property_graph_types::PROP_ID_TYPE;
@@ -190,6 +216,12 @@ class ArrowFragment
   using nbr_unit_t = property_graph_utils::NbrUnit<vid_t, eid_t>;
   using adj_list_t = property_graph_utils::AdjList<vid_t, eid_t>;
   using raw_adj_list_t = property_graph_utils::RawAdjList<vid_t, eid_t>;
+  using compressed_adj_list_t =
+      property_graph_utils::CompressedAdjList<vid_t, eid_t>;
+  using compressed_csr_t = property_graph_utils::CompressedCSR<vid_t, eid_t>;
+  using vid_adj_list_t = property_graph_utils::VidAdjList<vid_t>;
+  using delta_adj_list_t = property_graph_utils::DeltaAdjList<vid_t, eid_t>;
+  using delta_csr_t = property_graph_utils::DeltaCSR<vid_t, eid_t>;
   using vertex_map_t = ArrowVertexMap<internal_oid_t, vid_t>;
   using vertex_t = grape::Vertex<vid_t>;
 
@@ -274,6 +306,13 @@ class ArrowFragment
     this->fnum_ = meta.GetKeyValue<fid_t>("fnum");
     this->directed_ = (meta.GetKeyValue<int>("directed") != 0);
     this->is_multigraph_ = (meta.GetKeyValue<int>("is_multigraph") != 0);
+    this->separate_vid_lists_ =
+        meta.Haskey("separate_vid_lists") &&
+        (meta.GetKeyValue<int>("separate_vid_lists") != 0);
+    this->vertex_cut_ = meta.Haskey("vertex_cut") &&
+                        (meta.GetKeyValue<int>("vertex_cut") != 0);
+    this->lazy_incoming_ = directed_ && meta.Haskey("lazy_incoming") &&
+                           (meta.GetKeyValue<int>("lazy_incoming") != 0);
     this->vertex_label_num_ = meta.GetKeyValue<label_id_t>("vertex_label_num");
     this->edge_label_num_ = meta.GetKeyValue<label_id_t>("edge_label_num");
 
@@ -296,15 +335,16 @@ class ArrowFragment
     }
 
     CONSTRUCT_TABLE_VECTOR(edge_tables_, edge_label_num_, "edge_tables");
+    decodeEdgeColumns(meta);
 
-    if (directed_) {
+    if (directed_ && !lazy_incoming_) {
       CONSTRUCT_BINARY_ARRAY_VECTOR_VECTOR(ie_lists_, vertex_label_num_,
                                            edge_label_num_, "ie_lists");
     }
     CONSTRUCT_BINARY_ARRAY_VECTOR_VECTOR(oe_lists_, vertex_label_num_,
                                          edge_label_num_, "oe_lists");
 
-    if (directed_) {
+    if (directed_ && !lazy_incoming_) {
       CONSTRUCT_ARRAY_VECTOR_VECTOR(int64_t, ie_offsets_lists_,
                                     vertex_label_num_, edge_label_num_,
                                     "ie_offsets_lists");
@@ -323,10 +363,15 @@ class ArrowFragment
       for (auto& v : InnerVertices(i)) {
         for (label_id_t j = 0; j < edge_label_num_; j++) {
           oenum_ += GetLocalOutDegree(v, j);
-          ienum_ += GetLocalInDegree(v, j);
+          if (!lazy_incoming_) {
+            ienum_ += GetLocalInDegree(v, j);
+          }
         }
       }
     }
+    if (lazy_incoming_) {
+      ienum_ = countIncomingEdges();
+    }
   }
 
   fid_t fid() const { return fid_; }
@@ -569,16 +614,44 @@ class ArrowFragment
   }
 
   inline bool OuterVertexGid2Vertex(const vid_t& gid, vertex_t& v) const {
-    auto map = ovg2l_maps_ptr_[vid_parser_.GetLabelId(gid)];
-    auto iter = map->find(gid);
-    if (iter != map->end()) {
-      v.SetValue(iter->second);
+    vid_t lid;
+    if (ovg2l_indices_[vid_parser_.GetLabelId(gid)].Find(gid, lid)) {
+      v.SetValue(lid);
       return true;
     } else {
       return false;
     }
   }
 
+  /**
+   * @brief Translate a batch of outer vertex gids to their lids, where the
+   * consecutive gids of the same label are searched together, see
+   * OuterVertexIndex::FindBatch.
+   *
+   * @param gids The gids to translate.
+   * @param n The number of gids.
+   * @param lids The lids of the gids, left untouched for missing gids.
+   * @param found Whether each gid is an outer vertex of this fragment.
+   */
+  inline void OuterVertexGid2Lids(const vid_t* gids, size_t n, vid_t* lids,
+                                  bool* found) const {
+    size_t begin = 0;
+    while (begin < n) {
+      label_id_t label = vid_parser_.GetLabelId(gids[begin]);
+      size_t end = begin + 1;
+      while (end < n && vid_parser_.GetLabelId(gids[end]) == label) {
+        ++end;
+      }
+      if (label >= 0 && label < vertex_label_num_) {
+        ovg2l_indices_[label].FindBatch(gids + begin, end - begin,
+                                        lids + begin, found + begin);
+      } else {
+        std::fill(found + begin, found + end, false);
+      }
+      begin = end;
+    }
+  }
+
   inline vid_t GetOuterVertexGid(const vertex_t& v) const {
     label_id_t v_label = vid_parser_.GetLabelId(v.GetValue());
     return ovgid_lists_ptr_[v_label][vid_parser_.GetOffset(v.GetValue()) -
@@ -591,6 +664,7 @@ class ArrowFragment
 
   inline adj_list_t GetIncomingAdjList(const vertex_t& v,
                                        label_id_t e_label) const {
+    ensureIncoming();
     vid_t vid = v.GetValue();
     label_id_t v_label = vid_parser_.GetLabelId(vid);
     int64_t v_offset = vid_parser_.GetOffset(vid);
@@ -603,6 +677,7 @@ class ArrowFragment
 
   inline raw_adj_list_t GetIncomingRawAdjList(const vertex_t& v,
                                               label_id_t e_label) const {
+    ensureIncoming();
     vid_t vid = v.GetValue();
     label_id_t v_label = vid_parser_.GetLabelId(vid);
     int64_t v_offset = vid_parser_.GetOffset(vid);
@@ -635,6 +710,330 @@ class ArrowFragment
                           &oe[offset_array[v_offset + 1]]);
   }
 
+  /**
+   * @brief Whether the neighbor vids are also stored apart from the eids, see
+   * ArrowFragmentBuilder::set_separate_vid_lists.
+   */
+  bool separate_vid_lists() const { return separate_vid_lists_; }
+
+  /**
+   * @brief Whether the edges are partitioned by a vertex cut, see
+   * GridEdgePartitioner. The outer vertices are then the mirrors of vertices
+   * whose edges are spread over several fragments, i.e., the adjacency lists
+   * of an inner vertex only hold the part of its edges that lives in this
+   * fragment, and edges may connect two outer vertices.
+   */
+  bool vertex_cut() const { return vertex_cut_; }
+
+  /**
+   * @brief Whether the incoming edges of the directed fragment are left out
+   * of the sealed fragment, see ArrowFragmentBuilder::set_lazy_incoming.
+   * They are then built from the outgoing edges on the first access, and
+   * shared with the later readers of the fragment in the other processes.
+   */
+  bool lazy_incoming() const { return lazy_incoming_; }
+
+  /**
+   * @brief The neighbor vids of the incoming edges. The vids are contiguous
+   * when the fragment has separate vid lists, otherwise they are strided
+   * over the NbrUnit of the adjacency list.
+   */
+  inline vid_adj_list_t GetIncomingVidList(const vertex_t& v,
+                                           label_id_t e_label) const {
+    ensureIncoming();
+    vid_t vid = v.GetValue();
+    label_id_t v_label = vid_parser_.GetLabelId(vid);
+    int64_t v_offset = vid_parser_.GetOffset(vid);
+    const int64_t* offset_array = ie_offsets_ptr_lists_[v_label][e_label];
+    const vid_t* ie = ie_vid_ptr_lists_[v_label][e_label];
+    return vid_adj_list_t(
+        &ie[offset_array[v_offset] * vid_stride_],
+        offset_array[v_offset + 1] - offset_array[v_offset], vid_stride_);
+  }
+
+  /**
+   * @brief The neighbor vids of the outgoing edges, see GetIncomingVidList.
+   */
+  inline vid_adj_list_t GetOutgoingVidList(const vertex_t& v,
+                                           label_id_t e_label) const {
+    vid_t vid = v.GetValue();
+    label_id_t v_label = vid_parser_.GetLabelId(vid);
+    int64_t v_offset = vid_parser_.GetOffset(vid);
+    const int64_t* offset_array = oe_offsets_ptr_lists_[v_label][e_label];
+    const vid_t* oe = oe_vid_ptr_lists_[v_label][e_label];
+    return vid_adj_list_t(
+        &oe[offset_array[v_offset] * vid_stride_],
+        offset_array[v_offset + 1] - offset_array[v_offset], vid_stride_);
+  }
+
+  /**
+   * @brief Build the compressed adjacency lists of the fragment, which are
+   * not built by default. The compressed lists are kept in memory alongside
+   * the uncompressed ones, and decoded on the fly by
+   * GetCompressedIncomingAdjList and GetCompressedOutgoingAdjList.
+   */
+  void CompressAdjLists() {
+    compressCSR(oe_compressed_lists_, oe_offsets_lists_, oe_ptr_lists_);
+    if (directed_) {
+      ensureIncoming();
+      compressCSR(ie_compressed_lists_, ie_offsets_lists_, ie_ptr_lists_);
+    } else {
+      ie_compressed_lists_ = oe_compressed_lists_;
+    }
+  }
+
+  bool HasCompressedAdjLists() const { return !oe_compressed_lists_.empty(); }
+
+  /**
+   * @brief The compressed counterpart of GetIncomingAdjList, the neighbors
+   * are sorted by the vertex id, CompressAdjLists must have been called.
+   */
+  inline compressed_adj_list_t GetCompressedIncomingAdjList(
+      const vertex_t& v, label_id_t e_label) const {
+    vid_t vid = v.GetValue();
+    label_id_t v_label = vid_parser_.GetLabelId(vid);
+    int64_t v_offset = vid_parser_.GetOffset(vid);
+    return ie_compressed_lists_[v_label][e_label]->GetAdjList(
+        v_offset, flatten_edge_tables_columns_[e_label]);
+  }
+
+  /**
+   * @brief The compressed counterpart of GetOutgoingAdjList, the neighbors
+   * are sorted by the vertex id, CompressAdjLists must have been called.
+   */
+  inline compressed_adj_list_t GetCompressedOutgoingAdjList(
+      const vertex_t& v, label_id_t e_label) const {
+    vid_t vid = v.GetValue();
+    label_id_t v_label = vid_parser_.GetLabelId(vid);
+    int64_t v_offset = vid_parser_.GetOffset(vid);
+    return oe_compressed_lists_[v_label][e_label]->GetAdjList(
+        v_offset, flatten_edge_tables_columns_[e_label]);
+  }
+
+  /**
+   * @brief Insert edges of an existing edge label into the in-memory delta
+   * segments of the fragment, without rebuilding the CSR.
+   *
+   * The table has the same layout as the edge tables of AddEdges, i.e., the
+   * source gids, the destination gids, and then the properties of the edge
+   * label. Both endpoints must be vertices of the fragment, and unless the
+   * fragment is a vertex cut, at least one of them must be an inner vertex,
+   * new outer vertices need AddEdges.
+   *
+   * The inserted edges are visible through GetMergedIncomingAdjList and
+   * GetMergedOutgoingAdjList, and through the plain adjacency lists after
+   * CompactEdgeDeltas. The fragment is not thread safe for writes, i.e.,
+   * inserting must not run concurrently with readers.
+   */
+  boost::leaf::result<void> InsertEdges(label_id_t e_label,
+                                        std::shared_ptr<arrow::Table> edges) {
+    if (e_label < 0 || e_label >= edge_label_num_) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                      "Invalid edge label: " + std::to_string(e_label));
+    }
+    auto prop_num = edge_tables_[e_label]->num_columns();
+    if (edges->num_columns() != prop_num + 2) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                      "The inserted edges don't match the schema of label " +
+                          std::to_string(e_label));
+    }
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+    ARROW_OK_OR_RAISE(
+        edges->CombineChunks(arrow::default_memory_pool(), &edges));
+#else
+    ARROW_OK_ASSIGN_OR_RAISE(
+        edges, edges->CombineChunks(arrow::default_memory_pool()));
+#endif
+    int64_t edge_num = edges->num_rows();
+    if (edge_num == 0) {
+      return {};
+    }
+    const vid_t* src_gids = std::dynamic_pointer_cast<vid_array_t>(
+                                edges->column(0)->chunk(0))
+                                ->raw_values();
+    const vid_t* dst_gids = std::dynamic_pointer_cast<vid_array_t>(
+                                edges->column(1)->chunk(0))
+                                ->raw_values();
+
+    // resolves all endpoints before appending, so that a failure leaves the
+    // fragment untouched
+    std::vector<vid_t> src_lids(edge_num), dst_lids(edge_num);
+    for (int64_t i = 0; i < edge_num; ++i) {
+      if (!deltaGid2Lid(src_gids[i], src_lids[i]) ||
+          !deltaGid2Lid(dst_gids[i], dst_lids[i])) {
+        RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                        "The endpoints of the inserted edge " +
+                            std::to_string(i) + " are not in the fragment");
+      }
+      if (!vertex_cut_ && !IsInnerVertex(vertex_t(src_lids[i])) &&
+          !IsInnerVertex(vertex_t(dst_lids[i]))) {
+        RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                        "Neither endpoint of the inserted edge " +
+                            std::to_string(i) + " is an inner vertex");
+      }
+    }
+
+    std::shared_ptr<arrow::Table> tmp_table0, properties;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+    ARROW_OK_OR_RAISE(edges->RemoveColumn(0, &tmp_table0));
+    ARROW_OK_OR_RAISE(tmp_table0->RemoveColumn(0, &properties));
+#else
+    ARROW_OK_ASSIGN_OR_RAISE(tmp_table0, edges->RemoveColumn(0));
+    ARROW_OK_ASSIGN_OR_RAISE(properties, tmp_table0->RemoveColumn(0));
+#endif
+    initEdgeDeltas();
+    auto& delta_table = delta_edge_tables_[e_label];
+    eid_t eid = static_cast<eid_t>(edge_tables_[e_label]->num_rows() +
+                                   (delta_table ? delta_table->num_rows() : 0));
+    if (delta_table == nullptr) {
+      delta_table = properties;
+    } else {
+      std::vector<std::shared_ptr<arrow::Table>> tables{delta_table,
+                                                        properties};
+      delta_table = ConcatenateTables(tables);
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+      ARROW_OK_OR_RAISE(delta_table->CombineChunks(
+          arrow::default_memory_pool(), &delta_table));
+#else
+      ARROW_OK_ASSIGN_OR_RAISE(delta_table, delta_table->CombineChunks(
+                                                arrow::default_memory_pool()));
+#endif
+    }
+    delta_edge_tables_columns_[e_label].resize(prop_num);
+    for (int j = 0; j < prop_num; ++j) {
+      delta_edge_tables_columns_[e_label][j] =
+          get_arrow_array_ptr(delta_table->column(j)->chunk(0));
+    }
+
+    for (int64_t i = 0; i < edge_num; ++i, ++eid) {
+      vid_t src = src_lids[i], dst = dst_lids[i];
+      label_id_t src_label = vid_parser_.GetLabelId(src);
+      label_id_t dst_label = vid_parser_.GetLabelId(dst);
+      int64_t src_offset = vid_parser_.GetOffset(src);
+      int64_t dst_offset = vid_parser_.GetOffset(dst);
+      bool src_inner = IsInnerVertex(vertex_t(src));
+      bool dst_inner = IsInnerVertex(vertex_t(dst));
+      oe_edge_deltas_[src_label][e_label].Append(src_offset, dst, eid);
+      if (directed_) {
+        ie_edge_deltas_[dst_label][e_label].Append(dst_offset, src, eid);
+        oenum_ += src_inner;
+        ienum_ += dst_inner;
+      } else {
+        oe_edge_deltas_[dst_label][e_label].Append(dst_offset, src, eid);
+        oenum_ += src_inner + dst_inner;
+      }
+    }
+    return {};
+  }
+
+  /**
+   * @brief The number of inserted edges of the label that have not been
+   * compacted into the CSR yet.
+   */
+  size_t GetDeltaEdgeNum(label_id_t e_label) const {
+    return delta_edge_tables_.empty() || delta_edge_tables_[e_label] == nullptr
+               ? 0
+               : delta_edge_tables_[e_label]->num_rows();
+  }
+
+  /**
+   * @brief The incoming edges in the CSR, followed by the inserted incoming
+   * edges that have not been compacted yet, see InsertEdges.
+   */
+  inline delta_adj_list_t GetMergedIncomingAdjList(const vertex_t& v,
+                                                   label_id_t e_label) const {
+    ensureIncoming();
+    return getMergedAdjList(
+        v, e_label, ie_offsets_ptr_lists_, ie_ptr_lists_,
+        directed_ ? ie_edge_deltas_ : oe_edge_deltas_);
+  }
+
+  /**
+   * @brief The outgoing edges in the CSR, followed by the inserted outgoing
+   * edges that have not been compacted yet, see InsertEdges.
+   */
+  inline delta_adj_list_t GetMergedOutgoingAdjList(const vertex_t& v,
+                                                   label_id_t e_label) const {
+    return getMergedAdjList(v, e_label, oe_offsets_ptr_lists_, oe_ptr_lists_,
+                            oe_edge_deltas_);
+  }
+
+  /**
+   * @brief Merge the delta segments into the CSR and the inserted edges into
+   * the edge tables, after which the plain adjacency lists cover the inserted
+   * edges as well.
+   *
+   * Only the (vertex label, edge label) pairs that received edges are
+   * rebuilt, and the compacted fragment lives in memory only, i.e., the
+   * sealed vineyard object is unchanged.
+   */
+  boost::leaf::result<void> CompactEdgeDeltas() {
+    if (delta_edge_tables_.empty()) {
+      return {};
+    }
+    ensureIncoming();
+    bool compacted = false;
+    for (label_id_t j = 0; j < edge_label_num_; ++j) {
+      if (delta_edge_tables_[j] == nullptr) {
+        continue;
+      }
+      std::vector<std::shared_ptr<arrow::Table>> tables{edge_tables_[j],
+                                                        delta_edge_tables_[j]};
+      auto table = ConcatenateTables(tables);
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+      ARROW_OK_OR_RAISE(
+          table->CombineChunks(arrow::default_memory_pool(), &edge_tables_[j]));
+#else
+      ARROW_OK_ASSIGN_OR_RAISE(
+          edge_tables_[j], table->CombineChunks(arrow::default_memory_pool()));
+#endif
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        BOOST_LEAF_CHECK(mergeEdgeDelta(oe_edge_deltas_[i][j],
+                                        oe_offsets_lists_[i][j],
+                                        oe_lists_[i][j]));
+        if (directed_) {
+          BOOST_LEAF_CHECK(mergeEdgeDelta(ie_edge_deltas_[i][j],
+                                          ie_offsets_lists_[i][j],
+                                          ie_lists_[i][j]));
+        }
+      }
+      compacted = true;
+    }
+    delta_edge_tables_.clear();
+    delta_edge_tables_columns_.clear();
+    oe_edge_deltas_.clear();
+    ie_edge_deltas_.clear();
+    if (!compacted) {
+      return {};
+    }
+
+    // the derived lists are rebuilt from the new CSR
+    bool compressed = HasCompressedAdjLists();
+    oe_compressed_lists_.clear();
+    ie_compressed_lists_.clear();
+    idst_.clear();
+    odst_.clear();
+    iodst_.clear();
+    idoffset_.clear();
+    odoffset_.clear();
+    iodoffset_.clear();
+    initPointers();
+    if (compressed) {
+      CompressAdjLists();
+    }
+    return {};
+  }
+
+  /**
+   * @brief The offsets of the outgoing adjacency lists of all vertices of the
+   * label, i.e., the edges of the vertex at offset k are in [offsets[k],
+   * offsets[k + 1]), see parallel_for_inner_vertices.
+   */
+  inline const int64_t* GetOutgoingOffsets(label_id_t v_label,
+                                           label_id_t e_label) const {
+    return oe_offsets_ptr_lists_[v_label][e_label];
+  }
+
   /**
    * N.B.: as an temporary solution, for POC of graph-learn, will be removed
    * later.
@@ -867,6 +1266,7 @@ class ArrowFragment
       const std::vector<std::set<std::pair<std::string, std::string>>>&
           edge_relations,
       int concurrency) {
+    BOOST_LEAF_CHECK(materializeIncoming(&client));
     int extra_vertex_label_num = vertex_tables.size();
     int total_vertex_label_num = vertex_label_num_ + extra_vertex_label_num;
     int extra_edge_label_num = edge_tables.size();
@@ -941,8 +1341,8 @@ class ArrowFragment
             bool flag = true;
             if (fid != fid_) {
               if (label_id < vertex_label_num_) {
-                auto cur_map = ovg2l_maps_ptr_[label_id];
-                flag = cur_map->find(arr[i]) == cur_map->end();
+                vid_t lid;
+                flag = !ovg2l_indices_[label_id].Find(arr[i], lid);
               }
             } else {
               flag = false;
@@ -1183,12 +1583,16 @@ class ArrowFragment
     // Construct new fragment meta
     vineyard::ObjectMeta old_meta, new_meta;
     VINEYARD_CHECK_OK(client.GetMetaData(this->id_, old_meta));
+    attachIncoming(old_meta);
 
     new_meta.SetTypeName(type_name<ArrowFragment<oid_t, vid_t>>());
     new_meta.AddKeyValue("fid", fid_);
     new_meta.AddKeyValue("fnum", fnum_);
     new_meta.AddKeyValue("directed", static_cast<int>(directed_));
     new_meta.AddKeyValue("is_multigraph", static_cast<int>(is_multigraph_));
+    new_meta.AddKeyValue("separate_vid_lists",
+                         static_cast<int>(separate_vid_lists_));
+    new_meta.AddKeyValue("vertex_cut", static_cast<int>(vertex_cut_));
     new_meta.AddKeyValue("oid_type", TypeName<oid_t>::Get());
     new_meta.AddKeyValue("vid_type", TypeName<vid_t>::Get());
     new_meta.AddKeyValue("vertex_label_num", total_vertex_label_num);
@@ -1203,6 +1607,7 @@ class ArrowFragment
 
     ASSIGN_IDENTICAL_VEC_META("vertex_tables", vertex_label_num_);
     ASSIGN_IDENTICAL_VEC_META("edge_tables", edge_label_num_);
+    assignEncodedEdgeColumns(old_meta, new_meta, nbytes);
 
     if (directed_) {
       ASSIGN_IDENTICAL_VEC_VEC_META("ie_lists", vertex_label_num_,
@@ -1434,6 +1839,7 @@ class ArrowFragment
       Client& client,
       std::vector<std::shared_ptr<arrow::Table>>&& vertex_tables,
       ObjectID vm_id) {
+    BOOST_LEAF_CHECK(materializeIncoming(&client));
     int extra_vertex_label_num = vertex_tables.size();
     int total_vertex_label_num = vertex_label_num_ + extra_vertex_label_num;
 
@@ -1464,12 +1870,16 @@ class ArrowFragment
     }
     vineyard::ObjectMeta old_meta, new_meta;
     VINEYARD_CHECK_OK(client.GetMetaData(this->id_, old_meta));
+    attachIncoming(old_meta);
 
     new_meta.SetTypeName(type_name<ArrowFragment<oid_t, vid_t>>());
     new_meta.AddKeyValue("fid", fid_);
     new_meta.AddKeyValue("fnum", fnum_);
     new_meta.AddKeyValue("directed", static_cast<int>(directed_));
     new_meta.AddKeyValue("is_multigraph", static_cast<int>(is_multigraph_));
+    new_meta.AddKeyValue("separate_vid_lists",
+                         static_cast<int>(separate_vid_lists_));
+    new_meta.AddKeyValue("vertex_cut", static_cast<int>(vertex_cut_));
     new_meta.AddKeyValue("oid_type", TypeName<oid_t>::Get());
     new_meta.AddKeyValue("vid_type", TypeName<vid_t>::Get());
     new_meta.AddKeyValue("vertex_label_num", total_vertex_label_num);
@@ -1540,6 +1950,7 @@ class ArrowFragment
 
     ASSIGN_IDENTICAL_VEC_META("vertex_tables", vertex_label_num_);
     ASSIGN_IDENTICAL_VEC_META("edge_tables", edge_label_num_);
+    assignEncodedEdgeColumns(old_meta, new_meta, nbytes);
 
     ASSIGN_IDENTICAL_VEC_META("ovgid_lists", vertex_label_num_);
     ASSIGN_IDENTICAL_VEC_META("ovg2l_maps", vertex_label_num_);
@@ -1675,6 +2086,7 @@ class ArrowFragment
       const std::vector<std::set<std::pair<std::string, std::string>>>&
           edge_relations,
       int concurrency) {
+    BOOST_LEAF_CHECK(materializeIncoming(&client));
     int extra_edge_label_num = edge_tables.size();
     int total_edge_label_num = edge_label_num_ + extra_edge_label_num;
     // Newly constructed data structures
@@ -1726,9 +2138,9 @@ class ArrowFragment
           for (int64_t i = 0; i < gid_array->length(); ++i) {
             fid_t fid = vid_parser_.GetFid(arr[i]);
             label_id_t label_id = vid_parser_.GetLabelId(arr[i]);
-            auto cur_map = ovg2l_maps_ptr_[label_id];
-            if (fid != fid_ && cur_map->find(arr[i]) == cur_map->end()) {
-              extra_ovgids[vid_parser_.GetLabelId(arr[i])].push_back(arr[i]);
+            vid_t lid;
+            if (fid != fid_ && !ovg2l_indices_[label_id].Find(arr[i], lid)) {
+              extra_ovgids[label_id].push_back(arr[i]);
             }
           }
         };
@@ -1921,12 +2333,16 @@ class ArrowFragment
 
     vineyard::ObjectMeta old_meta, new_meta;
     VINEYARD_CHECK_OK(client.GetMetaData(this->id_, old_meta));
+    attachIncoming(old_meta);
 
     new_meta.SetTypeName(type_name<ArrowFragment<oid_t, vid_t>>());
     new_meta.AddKeyValue("fid", fid_);
     new_meta.AddKeyValue("fnum", fnum_);
     new_meta.AddKeyValue("directed", static_cast<int>(directed_));
     new_meta.AddKeyValue("is_multigraph", static_cast<int>(is_multigraph_));
+    new_meta.AddKeyValue("separate_vid_lists",
+                         static_cast<int>(separate_vid_lists_));
+    new_meta.AddKeyValue("vertex_cut", static_cast<int>(vertex_cut_));
     new_meta.AddKeyValue("oid_type", TypeName<oid_t>::Get());
     new_meta.AddKeyValue("vid_type", TypeName<vid_t>::Get());
     new_meta.AddKeyValue("vertex_label_num", vertex_label_num_);
@@ -1936,6 +2352,7 @@ class ArrowFragment
     auto schema = schema_;
     size_t nbytes = 0;
     ASSIGN_IDENTICAL_VEC_META("edge_tables", edge_label_num_);
+    assignEncodedEdgeColumns(old_meta, new_meta, nbytes);
     GENERATE_TABLE_VEC_META("edge", 0, edge_label_num_, edge_tables_);
     for (label_id_t i = 0; i < extra_edge_label_num; ++i) {
       label_id_t cur_label_id = edge_label_num_ + i;
@@ -2136,14 +2553,19 @@ class ArrowFragment
           label_id_t,
           std::vector<std::pair<std::string, std::shared_ptr<ArrayType>>>>
           columns) {
+    BOOST_LEAF_CHECK(materializeIncoming(&client));
     vineyard::ObjectMeta old_meta, new_meta;
     VINEYARD_CHECK_OK(client.GetMetaData(this->id_, old_meta));
+    attachIncoming(old_meta);
 
     new_meta.SetTypeName(type_name<ArrowFragment<oid_t, vid_t>>());
     new_meta.AddKeyValue("fid", fid_);
     new_meta.AddKeyValue("fnum", fnum_);
     new_meta.AddKeyValue("directed", static_cast<int>(directed_));
     new_meta.AddKeyValue("is_multigraph", static_cast<int>(is_multigraph_));
+    new_meta.AddKeyValue("separate_vid_lists",
+                         static_cast<int>(separate_vid_lists_));
+    new_meta.AddKeyValue("vertex_cut", static_cast<int>(vertex_cut_));
     new_meta.AddKeyValue("oid_type", TypeName<oid_t>::Get());
     new_meta.AddKeyValue("vid_type", TypeName<vid_t>::Get());
     new_meta.AddKeyValue("vertex_label_num", vertex_label_num_);
@@ -2198,6 +2620,7 @@ class ArrowFragment
     ASSIGN_IDENTICAL_VEC_META("ovgid_lists", vertex_label_num_);
     ASSIGN_IDENTICAL_VEC_META("ovg2l_maps", vertex_label_num_);
     ASSIGN_IDENTICAL_VEC_META("edge_tables", edge_label_num_);
+    assignEncodedEdgeColumns(old_meta, new_meta, nbytes);
 
     GENERATE_TABLE_VEC_META("edge", 0, edge_label_num_, this->edge_tables_);
 
@@ -2243,14 +2666,19 @@ class ArrowFragment
       vineyard::Client& client,
       std::map<label_id_t, std::vector<label_id_t>> vertices,
       std::map<label_id_t, std::vector<label_id_t>> edges) {
+    BOOST_LEAF_CHECK(materializeIncoming(&client));
     vineyard::ObjectMeta old_meta, new_meta;
     VINEYARD_CHECK_OK(client.GetMetaData(this->id_, old_meta));
+    attachIncoming(old_meta);
 
     new_meta.SetTypeName(type_name<ArrowFragment<oid_t, vid_t>>());
     new_meta.AddKeyValue("fid", fid_);
     new_meta.AddKeyValue("fnum", fnum_);
     new_meta.AddKeyValue("directed", static_cast<int>(directed_));
     new_meta.AddKeyValue("is_multigraph", static_cast<int>(is_multigraph_));
+    new_meta.AddKeyValue("separate_vid_lists",
+                         static_cast<int>(separate_vid_lists_));
+    new_meta.AddKeyValue("vertex_cut", static_cast<int>(vertex_cut_));
     new_meta.AddKeyValue("oid_type", TypeName<oid_t>::Get());
     new_meta.AddKeyValue("vid_type", TypeName<vid_t>::Get());
     new_meta.AddKeyValue("vertex_label_num", vertex_label_num_);
@@ -2347,6 +2775,7 @@ class ArrowFragment
     ASSIGN_IDENTICAL_VEC_META("ovg2l_maps", vertex_label_num_);
     ASSIGN_IDENTICAL_VEC_META("vertex_tables", vertex_label_num_);
     ASSIGN_IDENTICAL_VEC_META("edge_tables", edge_label_num_);
+    assignEncodedEdgeColumns(old_meta, new_meta, nbytes);
 
     GENERATE_TABLE_VEC_META("vertex", 0, vertex_label_num_,
                             this->vertex_tables_);
@@ -2372,10 +2801,49 @@ class ArrowFragment
     return ret;
   }
 
+  /**
+   * @brief Project the fragment, and reuse the projection across jobs.
+   *
+   * The projected fragment is persisted and registered under a name derived
+   * from the id of this fragment and the selected labels and properties, a
+   * later call with the same selection returns the registered object instead
+   * of building the projection again. The projection only references the
+   * members of this fragment, hence the cached object is metadata only.
+   */
+  boost::leaf::result<vineyard::ObjectID> ProjectCached(
+      vineyard::Client& client,
+      std::map<label_id_t, std::vector<label_id_t>> vertices,
+      std::map<label_id_t, std::vector<label_id_t>> edges) {
+    // the selections in different orders are the same projection
+    for (auto* selection : {&vertices, &edges}) {
+      for (auto& pair : *selection) {
+        std::sort(pair.second.begin(), pair.second.end());
+        pair.second.erase(std::unique(pair.second.begin(), pair.second.end()),
+                          pair.second.end());
+      }
+    }
+    std::string name = projectionName(vertices, edges);
+
+    vineyard::ObjectID projected = vineyard::InvalidObjectID();
+    bool exists = false;
+    if (client.GetName(name, projected).ok() &&
+        client.Exists(projected, exists).ok() && exists) {
+      return projected;
+    }
+    BOOST_LEAF_ASSIGN(projected, Project(client, vertices, edges));
+    VY_OK_OR_RAISE(client.Persist(projected));
+    // a concurrent job may have registered the same projection meanwhile,
+    // the name then points to whichever object is registered last
+    VY_OK_OR_RAISE(client.PutName(projected, name));
+    return projected;
+  }
+
   boost::leaf::result<vineyard::ObjectID> TransformDirection(
       vineyard::Client& client, int concurrency) {
+    BOOST_LEAF_CHECK(materializeIncoming(&client));
     vineyard::ObjectMeta old_meta, new_meta;
     VINEYARD_CHECK_OK(client.GetMetaData(this->id_, old_meta));
+    attachIncoming(old_meta);
 
     new_meta.SetTypeName(type_name<ArrowFragment<oid_t, vid_t>>());
     new_meta.AddKeyValue("fid", fid_);
@@ -2399,6 +2867,7 @@ class ArrowFragment
     ASSIGN_IDENTICAL_VEC_META("ovg2l_maps", vertex_label_num_);
     ASSIGN_IDENTICAL_VEC_META("vertex_tables", vertex_label_num_);
     ASSIGN_IDENTICAL_VEC_META("edge_tables", edge_label_num_);
+    assignEncodedEdgeColumns(old_meta, new_meta, nbytes);
 
     GENERATE_TABLE_VEC_META("vertex", 0, vertex_label_num_,
                             this->vertex_tables_);
@@ -2480,6 +2949,9 @@ class ArrowFragment
     }
 
     new_meta.AddKeyValue("is_multigraph", static_cast<int>(is_multigraph));
+    new_meta.AddKeyValue("separate_vid_lists",
+                         static_cast<int>(separate_vid_lists_));
+    new_meta.AddKeyValue("vertex_cut", static_cast<int>(vertex_cut_));
 
     new_meta.SetNBytes(nbytes);
 
@@ -2540,9 +3012,12 @@ class ArrowFragment
 
     ovgid_lists_ptr_.resize(vertex_label_num_);
     ovg2l_maps_ptr_.resize(vertex_label_num_);
+    ovg2l_indices_.resize(vertex_label_num_);
     for (label_id_t i = 0; i < vertex_label_num_; ++i) {
       ovgid_lists_ptr_[i] = ovgid_lists_[i]->raw_values();
       ovg2l_maps_ptr_[i] = ovg2l_maps_[i].get();
+      ovg2l_indices_[i].Init(ovgid_lists_ptr_[i], ovgid_lists_[i]->length(),
+                             vid_parser_.GenerateId(0, i, ivnums_[i]));
 
       oe_ptr_lists_[i].resize(edge_label_num_);
       oe_offsets_ptr_lists_[i].resize(edge_label_num_);
@@ -2562,6 +3037,23 @@ class ArrowFragment
       }
     }
 
+    if (separate_vid_lists_) {
+      vid_stride_ = 1;
+      initVidLists(oe_vid_lists_, oe_vid_ptr_lists_, oe_offsets_lists_,
+                   oe_ptr_lists_);
+    } else {
+      // the vid is the first member of the NbrUnit
+      vid_stride_ = sizeof(nbr_unit_t) / sizeof(vid_t);
+      initVidPointers(oe_vid_ptr_lists_, oe_ptr_lists_);
+    }
+
+    // the incoming edges of a lazy fragment are pointed to once built
+    if (!lazy_incoming_ || incoming_guard_.ready.load()) {
+      initIncomingPointers();
+    }
+  }
+
+  void initIncomingPointers() {
     if (directed_) {
       ie_ptr_lists_.resize(vertex_label_num_);
       ie_offsets_ptr_lists_.resize(vertex_label_num_);
@@ -2578,6 +3070,418 @@ class ArrowFragment
       ie_ptr_lists_ = oe_ptr_lists_;
       ie_offsets_ptr_lists_ = oe_offsets_ptr_lists_;
     }
+
+    if (separate_vid_lists_) {
+      if (directed_) {
+        initVidLists(ie_vid_lists_, ie_vid_ptr_lists_, ie_offsets_lists_,
+                     ie_ptr_lists_);
+      } else {
+        ie_vid_ptr_lists_ = oe_vid_ptr_lists_;
+      }
+    } else {
+      initVidPointers(ie_vid_ptr_lists_, ie_ptr_lists_);
+    }
+  }
+
+  inline void ensureIncoming() const {
+    if (lazy_incoming_ &&
+        !incoming_guard_.ready.load(std::memory_order_acquire)) {
+      auto result =
+          const_cast<ArrowFragment*>(this)->materializeIncoming(nullptr);
+      if (!result) {
+        LOG(FATAL) << "Failed to build the incoming edges of fragment "
+                   << ObjectIDToString(this->id_);
+      }
+    }
+  }
+
+  /**
+   * @brief Build the incoming edges of a lazy fragment, i.e., take the ones
+   * that are registered under incomingName by an earlier reader, or transpose
+   * the outgoing edges otherwise.
+   *
+   * With an IPC client, either the given one or the one that the fragment is
+   * constructed by, the transposed edges are sealed and registered for the
+   * later readers; the fragments built by other clients keep a local copy.
+   */
+  boost::leaf::result<void> materializeIncoming(vineyard::Client* client) {
+    if (!lazy_incoming_) {
+      return {};
+    }
+    std::lock_guard<std::mutex> lock(incoming_guard_.mutex);
+    if (incoming_guard_.ready.load(std::memory_order_relaxed)) {
+      // the derived fragments refer to the sealed edges, see attachIncoming
+      if (client != nullptr && incoming_id_ == vineyard::InvalidObjectID()) {
+        BOOST_LEAF_CHECK(sealIncoming(*client, false));
+      }
+      return {};
+    }
+    if (client == nullptr) {
+      client = dynamic_cast<vineyard::Client*>(this->meta_.GetClient());
+    }
+    if (client == nullptr || !lookupIncoming(*client)) {
+      BOOST_LEAF_CHECK(transposeOutgoing());
+      if (client != nullptr) {
+        // the later readers transpose again, rather than fail this one
+        auto sealed = sealIncoming(*client, true);
+        if (!sealed) {
+          LOG(WARNING) << "Failed to seal the incoming edges of fragment "
+                       << ObjectIDToString(this->id_)
+                       << ", keeps the local copy";
+        }
+      }
+    }
+    initIncomingPointers();
+    incoming_guard_.ready.store(true, std::memory_order_release);
+    return {};
+  }
+
+  bool lookupIncoming(vineyard::Client& client) {
+    vineyard::ObjectID incoming_id = vineyard::InvalidObjectID();
+    vineyard::ObjectMeta meta;
+    if (!client.GetName(incomingName(), incoming_id).ok() ||
+        !client.GetMetaData(incoming_id, meta).ok()) {
+      return false;
+    }
+    CONSTRUCT_BINARY_ARRAY_VECTOR_VECTOR(ie_lists_, vertex_label_num_,
+                                         edge_label_num_, "ie_lists");
+    CONSTRUCT_ARRAY_VECTOR_VECTOR(int64_t, ie_offsets_lists_,
+                                  vertex_label_num_, edge_label_num_,
+                                  "ie_offsets_lists");
+    incoming_id_ = incoming_id;
+    incoming_meta_ = meta;
+    return true;
+  }
+
+  boost::leaf::result<void> transposeOutgoing() {
+    int concurrency =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    std::vector<vid_t> tvnums(vertex_label_num_);
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      tvnums[i] = tvnums_[i];
+    }
+    ie_lists_.resize(vertex_label_num_);
+    ie_offsets_lists_.resize(vertex_label_num_);
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      ie_lists_[i].resize(edge_label_num_);
+      ie_offsets_lists_[i].resize(edge_label_num_);
+    }
+    for (label_id_t j = 0; j < edge_label_num_; ++j) {
+      // the eids are the rows of the edge table, hence the edges are put back
+      // in the order of the table, and the CSR is the same as the eager one
+      int64_t edge_num = edge_tables_[j]->num_rows();
+      std::vector<vid_t> srcs(edge_num), dsts(edge_num);
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        const int64_t* offsets = oe_offsets_ptr_lists_[i][j];
+        const nbr_unit_t* oe = oe_ptr_lists_[i][j];
+        for (vid_t k = 0; k < tvnums[i]; ++k) {
+          vid_t src = vid_parser_.GenerateId(0, i, k);
+          for (int64_t e = offsets[k]; e < offsets[k + 1]; ++e) {
+            srcs[oe[e].eid] = src;
+            dsts[oe[e].eid] = oe[e].vid;
+          }
+        }
+      }
+      std::shared_ptr<vid_array_t> src_list, dst_list;
+      vid_builder_t src_builder, dst_builder;
+      ARROW_OK_OR_RAISE(src_builder.AppendValues(srcs));
+      ARROW_OK_OR_RAISE(src_builder.Finish(&src_list));
+      ARROW_OK_OR_RAISE(dst_builder.AppendValues(dsts));
+      ARROW_OK_OR_RAISE(dst_builder.Finish(&dst_list));
+
+      std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>> sub_ie_lists(
+          vertex_label_num_);
+      std::vector<std::shared_ptr<arrow::Int64Array>> sub_ie_offset_lists(
+          vertex_label_num_);
+      bool is_multigraph = is_multigraph_;
+      BOOST_LEAF_CHECK((generate_directed_csr<vid_t, eid_t>(
+          vid_parser_, dst_list, src_list, tvnums, vertex_label_num_,
+          concurrency, sub_ie_lists, sub_ie_offset_lists, is_multigraph)));
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        ie_lists_[i][j] = sub_ie_lists[i];
+        ie_offsets_lists_[i][j] = sub_ie_offset_lists[i];
+      }
+    }
+    return {};
+  }
+
+  /**
+   * @brief Seal the incoming edges as an object of their own, and register
+   * it under incomingName, which is scoped to the fragment, i.e., the sealed
+   * edges are deleted together with the fragment. The sealed arrays replace
+   * the local ones unless the local ones may be in use already. Nothing is
+   * left behind on failure.
+   */
+  boost::leaf::result<void> sealIncoming(vineyard::Client& client,
+                                         bool replace) {
+    vineyard::ObjectMeta meta;
+    meta.SetTypeName("vineyard::ArrowFragmentIncomingEdges");
+    meta.AddKeyValue("fragment", this->id_);
+    meta.AddKeyValue("vertex_label_num", vertex_label_num_);
+    meta.AddKeyValue("edge_label_num", edge_label_num_);
+    size_t nbytes = 0;
+    std::vector<vineyard::ObjectID> sealed;
+    std::vector<std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>>>
+        ie_lists(vertex_label_num_);
+    std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>>
+        ie_offsets_lists(vertex_label_num_);
+    auto cleanup = [&client, &sealed]() {
+      VINEYARD_DISCARD(client.DelData(sealed, true, true));
+    };
+    try {
+      for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+        for (label_id_t j = 0; j < edge_label_num_; ++j) {
+          vineyard::FixedSizeBinaryArrayBuilder ie_builder(client,
+                                                           ie_lists_[i][j]);
+          auto ie = std::dynamic_pointer_cast<vineyard::FixedSizeBinaryArray>(
+              ie_builder.Seal(client));
+          sealed.push_back(ie->id());
+          vineyard::NumericArrayBuilder<int64_t> ieo_builder(
+              client, ie_offsets_lists_[i][j]);
+          auto ieo =
+              std::dynamic_pointer_cast<vineyard::NumericArray<int64_t>>(
+                  ieo_builder.Seal(client));
+          sealed.push_back(ieo->id());
+          meta.AddMember(generate_name_with_suffix("ie_lists", i, j),
+                         ie->meta());
+          meta.AddMember(generate_name_with_suffix("ie_offsets_lists", i, j),
+                         ieo->meta());
+          nbytes += ie->nbytes() + ieo->nbytes();
+          ie_lists[i].push_back(ie->GetArray());
+          ie_offsets_lists[i].push_back(ieo->GetArray());
+        }
+      }
+    } catch (std::exception const& e) {
+      cleanup();
+      RETURN_GS_ERROR(ErrorCode::kVineyardError, e.what());
+    }
+    meta.SetNBytes(nbytes);
+
+    vineyard::ObjectID incoming_id = vineyard::InvalidObjectID();
+    vineyard::ObjectMeta incoming_meta;
+    auto status = client.CreateMetaData(meta, incoming_id);
+    if (status.ok()) {
+      sealed.push_back(incoming_id);
+      status = client.Persist(incoming_id);
+    }
+    if (status.ok()) {
+      // a reader in another process may have registered its own copy
+      // meanwhile, the name then points to whichever copy is registered last
+      status = client.PutName(incoming_id, incomingName());
+    }
+    if (status.ok()) {
+      status = client.GetMetaData(incoming_id, incoming_meta);
+    }
+    if (!status.ok()) {
+      cleanup();
+      RETURN_GS_ERROR(ErrorCode::kVineyardError, status.ToString());
+    }
+    if (replace) {
+      ie_lists_ = std::move(ie_lists);
+      ie_offsets_lists_ = std::move(ie_offsets_lists);
+    }
+    incoming_meta_ = incoming_meta;
+    incoming_id_ = incoming_id;
+    return {};
+  }
+
+  /**
+   * @brief Add the sealed incoming edges of a lazy fragment to its meta, from
+   * which the fragments derived from this one take their members, see
+   * materializeIncoming.
+   */
+  void attachIncoming(vineyard::ObjectMeta& meta) const {
+    if (!lazy_incoming_) {
+      return;
+    }
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      for (label_id_t j = 0; j < edge_label_num_; ++j) {
+        for (auto prefix : {"ie_lists", "ie_offsets_lists"}) {
+          std::string name = generate_name_with_suffix(prefix, i, j);
+          meta.AddMember(name, incoming_meta_.GetMemberMeta(name));
+        }
+      }
+    }
+  }
+
+  std::string incomingName() const {
+    return vineyard::ScopedName(this->id_, "incoming");
+  }
+
+  /**
+   * @brief Decode the edge properties that are sealed in an encoding, see
+   * ArrowFragmentBuilder::set_encode_edge_properties, into the columns of the
+   * edge tables in place of their null placeholders, thus the accessors of
+   * the properties stay O(1). The decoded columns are shared by the readers
+   * of the fragment, see decodeEdgeColumn.
+   */
+  void decodeEdgeColumns(const vineyard::ObjectMeta& meta) {
+    auto client = dynamic_cast<vineyard::Client*>(meta.GetClient());
+    for (label_id_t i = 0; i < edge_label_num_; ++i) {
+      for (int j = 0; j < edge_tables_[i]->num_columns(); ++j) {
+        std::string name =
+            generate_name_with_suffix("edge_encoded_columns", i, j);
+        if (!meta.Haskey(name)) {
+          continue;
+        }
+        auto type = type_name_to_arrow_type(meta.GetKeyValue(
+            generate_name_with_suffix("edge_encoded_types", i, j)));
+        std::shared_ptr<arrow::Array> values;
+        if (encodable_type_width(type) == 4) {
+          values =
+              decodeEdgeColumn<int32_t>(client, meta.GetMemberMeta(name), i, j);
+        } else {
+          values =
+              decodeEdgeColumn<int64_t>(client, meta.GetMemberMeta(name), i, j);
+        }
+        auto data = values->data()->Copy();
+        data->type = type;
+        auto column = arrow::MakeArray(data);
+        auto field = arrow::field(edge_tables_[i]->field(j)->name(), type);
+        auto chunked = std::make_shared<arrow::ChunkedArray>(column);
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+        ARROW_CHECK_OK(
+            edge_tables_[i]->SetColumn(j, field, chunked, &edge_tables_[i]));
+#else
+        ARROW_CHECK_OK_AND_ASSIGN(
+            edge_tables_[i], edge_tables_[i]->SetColumn(j, field, chunked));
+#endif
+      }
+    }
+  }
+
+  /**
+   * @brief The decoded values of the `column`-th property of edge label
+   * `label`. The first reader with an IPC client seals them and registers
+   * them under a name that is scoped to the fragment (i.e., they are deleted
+   * together with the fragment), and the later readers map the sealed values
+   * rather than decoding again. Readers without an IPC client, or failing to
+   * seal, keep a local copy.
+   */
+  template <typename T>
+  std::shared_ptr<arrow::Array> decodeEdgeColumn(
+      vineyard::Client* client, const vineyard::ObjectMeta& encoded_meta,
+      label_id_t const label, int const column) const {
+    std::string name = vineyard::ScopedName(
+        this->id_,
+        generate_name_with_suffix("edge_decoded_columns", label, column));
+    vineyard::ObjectID decoded_id = vineyard::InvalidObjectID();
+    if (client != nullptr && client->GetName(name, decoded_id).ok()) {
+      std::shared_ptr<vineyard::NumericArray<T>> decoded;
+      if (client->GetObject(decoded_id, decoded).ok() && decoded != nullptr) {
+        return decoded->GetArray();
+      }
+    }
+
+    vineyard::EncodedArray<T> encoded;
+    encoded.Construct(encoded_meta);
+    std::shared_ptr<typename vineyard::EncodedArray<T>::ArrayType> values;
+    VINEYARD_CHECK_OK(encoded.ToArray(values));
+    if (client == nullptr) {
+      return values;
+    }
+    std::shared_ptr<vineyard::NumericArray<T>> decoded;
+    vineyard::Status status;
+    try {
+      vineyard::NumericArrayBuilder<T> builder(*client, values);
+      decoded = std::dynamic_pointer_cast<vineyard::NumericArray<T>>(
+          builder.Seal(*client));
+      status = client->Persist(decoded->id());
+      if (status.ok()) {
+        // a reader in another process may have registered its own copy
+        // meanwhile, the name then points to whichever is registered last
+        status = client->PutName(decoded->id(), name);
+      }
+    } catch (std::exception const& e) {
+      status = vineyard::Status::IOError(e.what());
+    }
+    if (status.ok()) {
+      return decoded->GetArray();
+    }
+    if (decoded != nullptr) {
+      VINEYARD_DISCARD(client->DelData(decoded->id(), true, true));
+    }
+    LOG(WARNING) << "Failed to share the decoded edge property " << column
+                 << " of label " << label << " of fragment "
+                 << ObjectIDToString(this->id_)
+                 << ", keeps a local copy: " << status.ToString();
+    return values;
+  }
+
+  /**
+   * @brief Carry the encoded edge properties of the existing edge labels over
+   * to the derived fragment, which shares the sealed edge tables, see
+   * decodeEdgeColumns.
+   */
+  void assignEncodedEdgeColumns(const vineyard::ObjectMeta& old_meta,
+                                vineyard::ObjectMeta& new_meta,
+                                size_t& nbytes) const {
+    for (label_id_t i = 0; i < edge_label_num_; ++i) {
+      for (int j = 0; j < edge_tables_[i]->num_columns(); ++j) {
+        std::string name =
+            generate_name_with_suffix("edge_encoded_columns", i, j);
+        if (!old_meta.Haskey(name)) {
+          continue;
+        }
+        std::string type_key =
+            generate_name_with_suffix("edge_encoded_types", i, j);
+        new_meta.AddMember(name, old_meta.GetMemberMeta(name));
+        new_meta.AddKeyValue(type_key, old_meta.GetKeyValue(type_key));
+        nbytes += old_meta.GetMemberMeta(name).GetNBytes();
+      }
+    }
+  }
+
+  // the incoming edges of the inner vertices are the outgoing edges to them
+  size_t countIncomingEdges() const {
+    size_t ienum = 0;
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      for (label_id_t j = 0; j < edge_label_num_; ++j) {
+        const int64_t* offsets = oe_offsets_ptr_lists_[i][j];
+        const nbr_unit_t* oe = oe_ptr_lists_[i][j];
+        for (int64_t k = 0; k < offsets[tvnums_[i]]; ++k) {
+          ienum += IsInnerVertex(vertex_t(oe[k].vid));
+        }
+      }
+    }
+    return ienum;
+  }
+
+  void initVidLists(
+      std::vector<std::vector<std::vector<vid_t>>>& vid_lists,
+      std::vector<std::vector<const vid_t*>>& vid_ptr_lists,
+      std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>> const&
+          offsets_lists,
+      std::vector<std::vector<const nbr_unit_t*>> const& nbrs) {
+    vid_lists.resize(vertex_label_num_);
+    vid_ptr_lists.resize(vertex_label_num_);
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      vid_lists[i].resize(edge_label_num_);
+      vid_ptr_lists[i].resize(edge_label_num_);
+      for (label_id_t j = 0; j < edge_label_num_; ++j) {
+        auto const& offsets = offsets_lists[i][j];
+        int64_t num_edges = offsets->Value(offsets->length() - 1);
+        auto& vids = vid_lists[i][j];
+        vids.resize(num_edges);
+        const nbr_unit_t* nbr = nbrs[i][j];
+        for (int64_t k = 0; k < num_edges; ++k) {
+          vids[k] = nbr[k].vid;
+        }
+        vid_ptr_lists[i][j] = vids.data();
+      }
+    }
+  }
+
+  void initVidPointers(
+      std::vector<std::vector<const vid_t*>>& vid_ptr_lists,
+      std::vector<std::vector<const nbr_unit_t*>> const& nbrs) {
+    vid_ptr_lists.resize(vertex_label_num_);
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      vid_ptr_lists[i].resize(edge_label_num_);
+      for (label_id_t j = 0; j < edge_label_num_; ++j) {
+        vid_ptr_lists[i][j] = reinterpret_cast<const vid_t*>(nbrs[i][j]);
+      }
+    }
   }
 
   void initDestFidList(
@@ -2635,6 +3539,119 @@ class ArrowFragment
     }
   }
 
+  std::string projectionName(
+      std::map<label_id_t, std::vector<label_id_t>> const& vertices,
+      std::map<label_id_t, std::vector<label_id_t>> const& edges) const {
+    using selection_t = std::map<label_id_t, std::vector<label_id_t>>;
+    std::string name = "__projection_" + ObjectIDToString(this->id_);
+    auto append = [&name](char kind, selection_t const& selection) {
+      for (auto& pair : selection) {
+        name += "_" + std::string(1, kind) + std::to_string(pair.first);
+        for (auto prop : pair.second) {
+          name += "." + std::to_string(prop);
+        }
+      }
+    };
+    append('v', vertices);
+    append('e', edges);
+    return name;
+  }
+
+  void initEdgeDeltas() {
+    if (!delta_edge_tables_.empty()) {
+      return;
+    }
+    delta_edge_tables_.resize(edge_label_num_);
+    delta_edge_tables_columns_.resize(edge_label_num_);
+    oe_edge_deltas_.resize(vertex_label_num_);
+    ie_edge_deltas_.resize(directed_ ? vertex_label_num_ : 0);
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      oe_edge_deltas_[i].resize(edge_label_num_);
+      if (directed_) {
+        ie_edge_deltas_[i].resize(edge_label_num_);
+      }
+    }
+  }
+
+  bool deltaGid2Lid(vid_t gid, vid_t& lid) const {
+    label_id_t label = vid_parser_.GetLabelId(gid);
+    if (label < 0 || label >= vertex_label_num_) {
+      return false;
+    }
+    if (vid_parser_.GetFid(gid) == fid_) {
+      int64_t offset = vid_parser_.GetOffset(gid);
+      lid = vid_parser_.GenerateId(0, label, offset);
+      return offset < static_cast<int64_t>(ivnums_[label]);
+    }
+    return ovg2l_indices_[label].Find(gid, lid);
+  }
+
+  delta_adj_list_t getMergedAdjList(
+      const vertex_t& v, label_id_t e_label,
+      std::vector<std::vector<const int64_t*>> const& offsets_ptr_lists,
+      std::vector<std::vector<const nbr_unit_t*>> const& ptr_lists,
+      std::vector<std::vector<delta_csr_t>> const& deltas) const {
+    vid_t vid = v.GetValue();
+    label_id_t v_label = vid_parser_.GetLabelId(vid);
+    int64_t v_offset = vid_parser_.GetOffset(vid);
+    const int64_t* offset_array = offsets_ptr_lists[v_label][e_label];
+    const nbr_unit_t* nbrs = ptr_lists[v_label][e_label];
+    const std::vector<nbr_unit_t>* delta =
+        deltas.empty() ? nullptr : deltas[v_label][e_label].Find(v_offset);
+    return delta_adj_list_t(
+        &nbrs[offset_array[v_offset]], &nbrs[offset_array[v_offset + 1]],
+        delta == nullptr ? nullptr : delta->data(),
+        delta == nullptr ? 0 : delta->size(),
+        static_cast<eid_t>(edge_tables_[e_label]->num_rows()),
+        flatten_edge_tables_columns_[e_label],
+        delta_edge_tables_columns_.empty() ||
+                delta_edge_tables_columns_[e_label].empty()
+            ? nullptr
+            : delta_edge_tables_columns_[e_label].data());
+  }
+
+  boost::leaf::result<void> mergeEdgeDelta(
+      delta_csr_t const& delta, std::shared_ptr<arrow::Int64Array>& offsets,
+      std::shared_ptr<arrow::FixedSizeBinaryArray>& nbrs) {
+    if (delta.empty()) {
+      return {};
+    }
+    int64_t num_vertices = offsets->length() - 1;
+    int64_t edge_num = offsets->Value(num_vertices) + delta.size();
+
+    vineyard::PodArrayBuilder<nbr_unit_t> edge_builder;
+    ARROW_OK_OR_RAISE(edge_builder.Resize(edge_num));
+    std::vector<int64_t> merged_offsets(num_vertices + 1);
+    is_multigraph_ |= delta.Merge(
+        offsets->raw_values(), reinterpret_cast<const nbr_unit_t*>(
+                                   nbrs->GetValue(0)),
+        num_vertices, merged_offsets.data(), edge_builder.MutablePointer(0));
+    ARROW_OK_OR_RAISE(edge_builder.Advance(edge_num));
+    ARROW_OK_OR_RAISE(edge_builder.Finish(&nbrs));
+
+    arrow::Int64Builder offset_builder;
+    ARROW_OK_OR_RAISE(offset_builder.AppendValues(merged_offsets));
+    ARROW_OK_OR_RAISE(offset_builder.Finish(&offsets));
+    return {};
+  }
+
+  void compressCSR(
+      std::vector<std::vector<std::shared_ptr<compressed_csr_t>>>& lists,
+      std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>> const&
+          offsets_lists,
+      std::vector<std::vector<const nbr_unit_t*>> const& ptr_lists) {
+    lists.resize(vertex_label_num_);
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      lists[i].resize(edge_label_num_);
+      for (label_id_t j = 0; j < edge_label_num_; ++j) {
+        lists[i][j] = std::make_shared<compressed_csr_t>();
+        lists[i][j]->Compress(offsets_lists[i][j]->raw_values(),
+                              offsets_lists[i][j]->length() - 1,
+                              ptr_lists[i][j]);
+      }
+    }
+  }
+
   void directedCSR2Undirected(
       std::vector<std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>>>&
           oe_lists,
@@ -2693,6 +3710,10 @@ class ArrowFragment
 
   std::vector<std::shared_ptr<vineyard::Hashmap<vid_t, vid_t>>> ovg2l_maps_;
   std::vector<vineyard::Hashmap<vid_t, vid_t>*> ovg2l_maps_ptr_;
+  // the gid to lid translation of outer vertices on the ovgid lists, as the
+  // lid of the k-th outer vertex of a label is its k-th ovgid, which is
+  // cheaper to search than the hashmaps above, see OuterVertexIndex
+  std::vector<OuterVertexIndex<vid_t>> ovg2l_indices_;
 
   std::vector<std::shared_ptr<arrow::Table>> edge_tables_;
   std::vector<std::vector<const void*>> edge_tables_columns_;
@@ -2706,6 +3727,41 @@ class ArrowFragment
   std::vector<std::vector<const int64_t*>> ie_offsets_ptr_lists_,
       oe_offsets_ptr_lists_;
 
+  std::vector<std::vector<std::shared_ptr<compressed_csr_t>>>
+      ie_compressed_lists_, oe_compressed_lists_;
+
+  bool separate_vid_lists_ = false;
+  bool vertex_cut_ = false;
+  size_t vid_stride_ = 1;
+
+  // guards building the incoming edges of a lazy fragment, the copy of a
+  // fragment copies the lists that are built by then as well
+  struct IncomingGuard {
+    IncomingGuard() = default;
+    IncomingGuard(IncomingGuard const& other) : ready(other.ready.load()) {}
+    IncomingGuard& operator=(IncomingGuard const& other) {
+      ready.store(other.ready.load());
+      return *this;
+    }
+
+    std::mutex mutex;
+    std::atomic<bool> ready{false};
+  };
+
+  bool lazy_incoming_ = false;
+  mutable IncomingGuard incoming_guard_;
+  // the sealed incoming edges of a lazy fragment, see sealIncoming
+  vineyard::ObjectID incoming_id_ = vineyard::InvalidObjectID();
+  vineyard::ObjectMeta incoming_meta_;
+  std::vector<std::vector<std::vector<vid_t>>> ie_vid_lists_, oe_vid_lists_;
+  std::vector<std::vector<const vid_t*>> ie_vid_ptr_lists_, oe_vid_ptr_lists_;
+
+  // the inserted edges that have not been compacted into the CSR, in
+  // undirected fragments the incoming deltas are the outgoing ones
+  std::vector<std::shared_ptr<arrow::Table>> delta_edge_tables_;
+  std::vector<std::vector<const void*>> delta_edge_tables_columns_;
+  std::vector<std::vector<delta_csr_t>> ie_edge_deltas_, oe_edge_deltas_;
+
   std::vector<std::vector<std::vector<fid_t>>> idst_, odst_, iodst_;
   std::vector<std::vector<std::vector<fid_t*>>> idoffset_, odoffset_,
       iodoffset_;
@@ -2742,6 +3798,47 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
   void set_directed(bool directed) { directed_ = directed; }
   void set_is_multigraph(bool is_multigraph) { is_multigraph_ = is_multigraph; }
 
+  /**
+   * @brief Store the neighbor vids apart from the eids as well, so that the
+   * traversals that only need the vids (see
+   * ArrowFragment::GetOutgoingVidList) don't pull the eids through the cache.
+   * Costs one more vid per edge of memory, off by default.
+   */
+  void set_separate_vid_lists(bool separate_vid_lists) {
+    separate_vid_lists_ = separate_vid_lists;
+  }
+
+  /**
+   * @brief Mark the edges of the fragment as partitioned by a vertex cut, see
+   * ArrowFragment::vertex_cut.
+   */
+  void set_vertex_cut(bool vertex_cut) { vertex_cut_ = vertex_cut; }
+
+  /**
+   * @brief Leave the incoming edges of a directed fragment out of the sealed
+   * fragment, they are built from the outgoing edges on the first access
+   * instead, see ArrowFragment::lazy_incoming. Saves about half of the time
+   * and the memory of building the CSR for the apps that only traverse the
+   * outgoing edges, off by default.
+   */
+  void set_lazy_incoming(bool lazy_incoming) { lazy_incoming_ = lazy_incoming; }
+
+  bool lazy_incoming() const { return lazy_incoming_; }
+
+  /**
+   * @brief Seal the 32-bit and 64-bit numeric edge properties in the encoding
+   * of the smallest payload, i.e., frame-of-reference, dictionary or
+   * run-length, see EncodedArray, for the columns where that is smaller than
+   * the plain values, e.g., the timestamps and the weights of few distinct
+   * values. The fragments decode the columns when they are constructed. Saves
+   * the shared memory and the persisted size, off by default.
+   */
+  void set_encode_edge_properties(bool encode_edge_properties) {
+    encode_edge_properties_ = encode_edge_properties;
+  }
+
+  bool encode_edge_properties() const { return encode_edge_properties_; }
+
   void set_label_num(label_id_t vertex_label_num, label_id_t edge_label_num) {
     vertex_label_num_ = vertex_label_num;
     edge_label_num_ = edge_label_num;
@@ -2751,6 +3848,7 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
     ovg2l_maps_.resize(vertex_label_num_);
 
     edge_tables_.resize(edge_label_num_);
+    edge_encoded_columns_.resize(edge_label_num_);
 
     if (directed_) {
       ie_lists_.resize(vertex_label_num_);
@@ -2805,6 +3903,17 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
     edge_tables_[label] = table;
   }
 
+  /**
+   * @brief Set the encoded values of an edge property of the original type,
+   * whose column in the edge table is a null placeholder.
+   */
+  void set_edge_encoded_column(label_id_t label, prop_id_t prop,
+                               std::shared_ptr<vineyard::Object> column,
+                               std::shared_ptr<arrow::DataType> type) {
+    assert(edge_encoded_columns_.size() > static_cast<size_t>(label));
+    edge_encoded_columns_[label][prop] = std::make_pair(column, type);
+  }
+
   void set_in_edge_list(
       label_id_t v_label, label_id_t e_label,
       std::shared_ptr<vineyard::FixedSizeBinaryArray> in_edge_list) {
@@ -2912,7 +4021,7 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
 
     ASSIGN_TABLE_VECTOR(edge_tables_, frag->edge_tables_);
 
-    if (directed_) {
+    if (directed_ && !lazy_incoming_) {
       ASSIGN_ARRAY_VECTOR_VECTOR(ie_lists_, frag->ie_lists_);
       ASSIGN_ARRAY_VECTOR_VECTOR(ie_offsets_lists_, frag->ie_offsets_lists_);
     }
@@ -2926,6 +4035,11 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
     frag->meta_.AddKeyValue("fnum", fnum_);
     frag->meta_.AddKeyValue("directed", static_cast<int>(directed_));
     frag->meta_.AddKeyValue("is_multigraph", static_cast<int>(is_multigraph_));
+    frag->meta_.AddKeyValue("separate_vid_lists",
+                            static_cast<int>(separate_vid_lists_));
+    frag->meta_.AddKeyValue("vertex_cut", static_cast<int>(vertex_cut_));
+    frag->meta_.AddKeyValue("lazy_incoming",
+                            static_cast<int>(directed_ && lazy_incoming_));
     frag->meta_.AddKeyValue("vertex_label_num", vertex_label_num_);
     frag->meta_.AddKeyValue("oid_type", TypeName<oid_t>::Get());
     frag->meta_.AddKeyValue("vid_type", TypeName<vid_t>::Get());
@@ -2968,10 +4082,15 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
       std::string name_prefix = "edge_property_name_" + std::to_string(i) + "_";
       std::string type_prefix = "edge_property_type_" + std::to_string(i) + "_";
       for (prop_id_t j = 0; j < prop_num; ++j) {
+        auto type = table->field(j)->type();
+        auto encoded = edge_encoded_columns_[i].find(j);
+        if (encoded != edge_encoded_columns_[i].end()) {
+          type = encoded->second.second;
+        }
         frag->meta_.AddKeyValue(name_prefix + std::to_string(j),
                                 table->field(j)->name());
         frag->meta_.AddKeyValue(type_prefix + std::to_string(j),
-                                arrow_type_to_string(table->field(j)->type()));
+                                arrow_type_to_string(type));
       }
     }
 
@@ -2987,7 +4106,18 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
     GENERATE_VEC_META("ovgid_lists", ovgid_lists_, vertex_label_num_);
     GENERATE_VEC_META("ovg2l_maps", ovg2l_maps_, vertex_label_num_);
     GENERATE_VEC_META("edge_tables", edge_tables_, edge_label_num_);
-    if (directed_) {
+    for (label_id_t i = 0; i < edge_label_num_; ++i) {
+      for (auto const& pair : edge_encoded_columns_[i]) {
+        frag->meta_.AddMember(
+            generate_name_with_suffix("edge_encoded_columns", i, pair.first),
+            pair.second.first->meta());
+        frag->meta_.AddKeyValue(
+            generate_name_with_suffix("edge_encoded_types", i, pair.first),
+            arrow_type_to_string(pair.second.second));
+        nbytes += pair.second.first->nbytes();
+      }
+    }
+    if (directed_ && !lazy_incoming_) {
       GENERATE_VEC_VEC_META("ie_lists", ie_lists_, vertex_label_num_,
                             edge_label_num_);
       GENERATE_VEC_VEC_META("ie_offsets_lists", ie_offsets_lists_,
@@ -3020,6 +4150,10 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
   fid_t fid_, fnum_;
   bool directed_;
   bool is_multigraph_;
+  bool separate_vid_lists_ = false;
+  bool vertex_cut_ = false;
+  bool lazy_incoming_ = false;
+  bool encode_edge_properties_ = false;
   label_id_t vertex_label_num_;
   label_id_t edge_label_num_;
 
@@ -3030,6 +4164,10 @@ class ArrowFragmentBuilder : public vineyard::ObjectBuilder {
   std::vector<std::shared_ptr<vineyard::Hashmap<vid_t, vid_t>>> ovg2l_maps_;
 
   std::vector<std::shared_ptr<vineyard::Table>> edge_tables_;
+  // the encoded edge properties and their original types, by property id
+  std::vector<std::map<prop_id_t, std::pair<std::shared_ptr<vineyard::Object>,
+                                            std::shared_ptr<arrow::DataType>>>>
+      edge_encoded_columns_;
 
   std::vector<std::vector<std::shared_ptr<vineyard::FixedSizeBinaryArray>>>
       ie_lists_, oe_lists_;
@@ -3064,98 +4202,112 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
     this->set_label_num(vertex_label_num_, edge_label_num_);
     this->set_property_graph_schema(schema_);
 
-    ThreadGroup tg;
-    {
-      auto fn = [this](Client& client) {
-        vineyard::ArrayBuilder<vid_t> ivnums_builder(client, ivnums_);
-        vineyard::ArrayBuilder<vid_t> ovnums_builder(client, ovnums_);
-        vineyard::ArrayBuilder<vid_t> tvnums_builder(client, tvnums_);
-        this->set_ivnums(*std::dynamic_pointer_cast<vineyard::Array<vid_t>>(
-            ivnums_builder.Seal(client)));
-        this->set_ovnums(*std::dynamic_pointer_cast<vineyard::Array<vid_t>>(
-            ovnums_builder.Seal(client)));
-        this->set_tvnums(*std::dynamic_pointer_cast<vineyard::Array<vid_t>>(
-            tvnums_builder.Seal(client)));
-        return Status::OK();
-      };
+    // the members are independent of each other, the adjacency lists and the
+    // tables come first as they dominate the sealing time
+    std::vector<std::function<Status(Client&)>> tasks;
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      for (label_id_t j = 0; j < edge_label_num_; ++j) {
+        if (directed_ && !this->lazy_incoming()) {
+          tasks.emplace_back([this, i, j](Client& client) {
+            vineyard::FixedSizeBinaryArrayBuilder ie_builder(client,
+                                                             ie_lists_[i][j]);
+            std::shared_ptr<vineyard::FixedSizeBinaryArray> ie;
+            RETURN_ON_ERROR(sealMember(client, ie_builder, ie));
+            this->set_in_edge_list(i, j, ie);
+            return Status::OK();
+          });
+        }
+        tasks.emplace_back([this, i, j](Client& client) {
+          vineyard::FixedSizeBinaryArrayBuilder oe_builder(client,
+                                                           oe_lists_[i][j]);
+          std::shared_ptr<vineyard::FixedSizeBinaryArray> oe;
+          RETURN_ON_ERROR(sealMember(client, oe_builder, oe));
+          this->set_out_edge_list(i, j, oe);
+          return Status::OK();
+        });
+      }
+    }
 
-      tg.AddTask(fn, std::ref(client));
+    for (label_id_t i = 0; i < edge_label_num_; ++i) {
+      tasks.emplace_back([this, i](Client& client) {
+        if (this->encode_edge_properties()) {
+          RETURN_ON_ERROR(encodeEdgeTable(client, i));
+        }
+        vineyard::TableBuilder et(client, edge_tables_[i], true);
+        std::shared_ptr<vineyard::Table> table;
+        RETURN_ON_ERROR(sealMember(client, et, table));
+        this->set_edge_table(i, table);
+        return Status::OK();
+      });
     }
 
     for (label_id_t i = 0; i < vertex_label_num_; ++i) {
-      auto fn = [this, i](Client& client) {
-        vineyard::TableBuilder vt(client, vertex_tables_[i]);
-        this->set_vertex_table(
-            i, std::dynamic_pointer_cast<vineyard::Table>(vt.Seal(client)));
-
-        vineyard::NumericArrayBuilder<vid_t> ovgid_list_builder(
-            client, ovgid_lists_[i]);
-        this->set_ovgid_list(
-            i, std::dynamic_pointer_cast<vineyard::NumericArray<vid_t>>(
-                   ovgid_list_builder.Seal(client)));
+      tasks.emplace_back([this, i](Client& client) {
+        vineyard::TableBuilder vt(client, vertex_tables_[i], true);
+        std::shared_ptr<vineyard::Table> table;
+        RETURN_ON_ERROR(sealMember(client, vt, table));
+        this->set_vertex_table(i, table);
+        return Status::OK();
+      });
+    }
 
+    for (label_id_t i = 0; i < vertex_label_num_; ++i) {
+      tasks.emplace_back([this, i](Client& client) {
         vineyard::HashmapBuilder<vid_t, vid_t> ovg2l_builder(
             client, std::move(ovg2l_maps_[i]));
-        this->set_ovg2l_map(
-            i, std::dynamic_pointer_cast<vineyard::Hashmap<vid_t, vid_t>>(
-                   ovg2l_builder.Seal(client)));
+        std::shared_ptr<vineyard::Hashmap<vid_t, vid_t>> ovg2l_map;
+        RETURN_ON_ERROR(sealMember(client, ovg2l_builder, ovg2l_map));
+        this->set_ovg2l_map(i, ovg2l_map);
         return Status::OK();
-      };
-      tg.AddTask(fn, std::ref(client));
-    }
-
-    for (label_id_t i = 0; i < edge_label_num_; ++i) {
-      auto fn = [this, i](Client& client) {
-        vineyard::TableBuilder et(client, edge_tables_[i]);
-        this->set_edge_table(
-            i, std::dynamic_pointer_cast<vineyard::Table>(et.Seal(client)));
+      });
+      tasks.emplace_back([this, i](Client& client) {
+        vineyard::NumericArrayBuilder<vid_t> ovgid_list_builder(
+            client, ovgid_lists_[i]);
+        std::shared_ptr<vineyard::NumericArray<vid_t>> ovgid_list;
+        RETURN_ON_ERROR(sealMember(client, ovgid_list_builder, ovgid_list));
+        this->set_ovgid_list(i, ovgid_list);
         return Status::OK();
-      };
-      tg.AddTask(fn, std::ref(client));
+      });
     }
 
     for (label_id_t i = 0; i < vertex_label_num_; ++i) {
       for (label_id_t j = 0; j < edge_label_num_; ++j) {
-        auto fn = [this, i, j](Client& client) {
-          if (directed_) {
-            vineyard::FixedSizeBinaryArrayBuilder ie_builder(client,
-                                                             ie_lists_[i][j]);
-            this->set_in_edge_list(
-                i, j,
-                std::dynamic_pointer_cast<vineyard::FixedSizeBinaryArray>(
-                    ie_builder.Seal(client)));
-          }
-          {
-            vineyard::FixedSizeBinaryArrayBuilder oe_builder(client,
-                                                             oe_lists_[i][j]);
-            this->set_out_edge_list(
-                i, j,
-                std::dynamic_pointer_cast<vineyard::FixedSizeBinaryArray>(
-                    oe_builder.Seal(client)));
-          }
-          if (directed_) {
-            vineyard::NumericArrayBuilder<int64_t> ieo(client,
-                                                       ie_offsets_lists_[i][j]);
-            this->set_in_edge_offsets(
-                i, j,
-                std::dynamic_pointer_cast<vineyard::NumericArray<int64_t>>(
-                    ieo.Seal(client)));
-          }
-          {
-            vineyard::NumericArrayBuilder<int64_t> oeo(client,
-                                                       oe_offsets_lists_[i][j]);
-            this->set_out_edge_offsets(
-                i, j,
-                std::dynamic_pointer_cast<vineyard::NumericArray<int64_t>>(
-                    oeo.Seal(client)));
-          }
+        if (directed_ && !this->lazy_incoming()) {
+          tasks.emplace_back([this, i, j](Client& client) {
+            vineyard::NumericArrayBuilder<int64_t> ieo_builder(
+                client, ie_offsets_lists_[i][j]);
+            std::shared_ptr<vineyard::NumericArray<int64_t>> ieo;
+            RETURN_ON_ERROR(sealMember(client, ieo_builder, ieo));
+            this->set_in_edge_offsets(i, j, ieo);
+            return Status::OK();
+          });
+        }
+        tasks.emplace_back([this, i, j](Client& client) {
+          vineyard::NumericArrayBuilder<int64_t> oeo_builder(
+              client, oe_offsets_lists_[i][j]);
+          std::shared_ptr<vineyard::NumericArray<int64_t>> oeo;
+          RETURN_ON_ERROR(sealMember(client, oeo_builder, oeo));
+          this->set_out_edge_offsets(i, j, oeo);
           return Status::OK();
-        };
-        tg.AddTask(fn, std::ref(client));
+        });
       }
     }
 
-    tg.TakeResults();
+    tasks.emplace_back([this](Client& client) {
+      vineyard::ArrayBuilder<vid_t> ivnums_builder(client, ivnums_);
+      vineyard::ArrayBuilder<vid_t> ovnums_builder(client, ovnums_);
+      vineyard::ArrayBuilder<vid_t> tvnums_builder(client, tvnums_);
+      std::shared_ptr<vineyard::Array<vid_t>> ivnums, ovnums, tvnums;
+      RETURN_ON_ERROR(sealMember(client, ivnums_builder, ivnums));
+      RETURN_ON_ERROR(sealMember(client, ovnums_builder, ovnums));
+      RETURN_ON_ERROR(sealMember(client, tvnums_builder, tvnums));
+      this->set_ivnums(*ivnums);
+      this->set_ovnums(*ovnums);
+      this->set_tvnums(*tvnums);
+      return Status::OK();
+    });
+
+    RETURN_ON_ERROR(sealConcurrently(client, tasks));
 
     this->set_vertex_map(vm_ptr_);
     return vineyard::Status::OK();
@@ -3187,6 +4339,110 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
   }
 
  private:
+  /**
+   * @brief Seal a member of the fragment, where the failure thrown by
+   * `Seal()` is returned as the status of the sealing task instead.
+   */
+  template <typename T, typename BuilderT>
+  static Status sealMember(Client& client, BuilderT& builder,
+                           std::shared_ptr<T>& member) {
+    try {
+      member = std::dynamic_pointer_cast<T>(builder.Seal(client));
+    } catch (std::exception const& e) {
+      return Status::UnknownError(e.what());
+    }
+    RETURN_ON_ASSERT(member != nullptr,
+                     "Failed to seal the member of the fragment");
+    return Status::OK();
+  }
+
+  /**
+   * @brief Run the sealing tasks on a fixed number of workers, each worker
+   * takes the next task from a shared counter until all tasks are done, i.e.,
+   * a small member is picked up as soon as a worker finishes a large one,
+   * without a thread for every member.
+   */
+  Status sealConcurrently(
+      Client& client,
+      std::vector<std::function<Status(Client&)>> const& tasks) {
+    size_t parallelism = std::min(
+        static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 1u)),
+        tasks.size());
+    std::atomic<size_t> next(0);
+    ThreadGroup tg(parallelism);
+    for (size_t worker = 0; worker < parallelism; ++worker) {
+      auto fn = [&tasks, &next](Client& client) {
+        Status status;
+        for (size_t index = next++; index < tasks.size(); index = next++) {
+          status &= tasks[index](client);
+        }
+        return status;
+      };
+      tg.AddTask(fn, std::ref(client));
+    }
+    for (auto const& status : tg.TakeResults()) {
+      RETURN_ON_ERROR(status);
+    }
+    return Status::OK();
+  }
+
+  /**
+   * @brief Seal the encodable columns of the edge table whose encoding is
+   * smaller than the plain values, see
+   * ArrowFragmentBuilder::set_encode_edge_properties. The columns are then
+   * replaced by null columns of the same length, which cost no memory in the
+   * sealed table.
+   */
+  Status encodeEdgeTable(Client& client, label_id_t label) {
+    auto& table = edge_tables_[label];
+    for (int j = 0; j < table->num_columns(); ++j) {
+      if (table->num_rows() == 0 ||
+          encodable_type_width(table->field(j)->type()) == 0) {
+        continue;
+      }
+      std::shared_ptr<arrow::Array> column;
+      RETURN_ON_ERROR(ConcatenateChunks(table->column(j), &column));
+      std::shared_ptr<vineyard::Object> encoded;
+      int width = encodable_type_width(column->type());
+      if (width == 4) {
+        RETURN_ON_ERROR(encodeEdgeColumn<int32_t>(client, column, encoded));
+      } else if (width == 8) {
+        RETURN_ON_ERROR(encodeEdgeColumn<int64_t>(client, column, encoded));
+      }
+      if (encoded == nullptr) {
+        continue;
+      }
+      this->set_edge_encoded_column(label, j, encoded, column->type());
+      auto field = arrow::field(table->field(j)->name(), arrow::null());
+      auto chunked = std::make_shared<arrow::ChunkedArray>(
+          std::make_shared<arrow::NullArray>(column->length()));
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+      RETURN_ON_ARROW_ERROR(table->SetColumn(j, field, chunked, &table));
+#else
+      RETURN_ON_ARROW_ERROR_AND_ASSIGN(table,
+                                       table->SetColumn(j, field, chunked));
+#endif
+    }
+    return Status::OK();
+  }
+
+  template <typename T>
+  static Status encodeEdgeColumn(Client& client,
+                                 std::shared_ptr<arrow::Array> const& column,
+                                 std::shared_ptr<vineyard::Object>& encoded) {
+    using array_t = typename vineyard::ConvertToArrowType<T>::ArrayType;
+    // the floating point values are encoded by their bit patterns
+    auto data = column->data()->Copy();
+    data->type = vineyard::ConvertToArrowType<T>::TypeValue();
+    auto values = std::dynamic_pointer_cast<array_t>(arrow::MakeArray(data));
+    vineyard::EncodedArrayBuilder<T> builder(client, values);
+    if (builder.EncodedSize() <
+        static_cast<size_t>(values->length()) * sizeof(T)) {
+      encoded = builder.Seal(client);
+    }
+    return Status::OK();
+  }
+
   // | prop_0 | prop_1 | ... |
   boost::leaf::result<void> initVertices(
       std::vector<std::shared_ptr<arrow::Table>>&& vertex_tables) {
@@ -3196,14 +4452,8 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
     ovnums_.resize(vertex_label_num_);
     tvnums_.resize(vertex_label_num_);
     for (size_t i = 0; i < vertex_tables.size(); ++i) {
-#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
-      ARROW_OK_OR_RAISE(vertex_tables[i]->CombineChunks(
-          arrow::default_memory_pool(), &vertex_tables_[i]));
-#else
-      ARROW_OK_ASSIGN_OR_RAISE(
-          vertex_tables_[i],
-          vertex_tables[i]->CombineChunks(arrow::default_memory_pool()));
-#endif
+      // the chunks are combined when the table is sealed, see Build
+      vertex_tables_[i] = std::move(vertex_tables[i]);
       ivnums_[i] = vm_ptr_->GetInnerVertexSize(fid_, i);
     }
     return {};
@@ -3222,26 +4472,23 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
     edge_tables_.resize(edge_label_num_);
     std::vector<std::vector<vid_t>> collected_ovgids(vertex_label_num_);
 
+    // only the src and dst columns are combined here, the chunks of the
+    // properties are combined when the table is sealed, see Build
+    std::vector<std::shared_ptr<arrow::Array>> edge_src_gids, edge_dst_gids;
+    edge_src_gids.resize(edge_label_num_);
+    edge_dst_gids.resize(edge_label_num_);
     for (size_t i = 0; i < edge_tables.size(); ++i) {
-      std::shared_ptr<arrow::Table> combined_table;
-#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
-      ARROW_OK_OR_RAISE(edge_tables[i]->CombineChunks(
-          arrow::default_memory_pool(), &combined_table));
-#else
-      ARROW_OK_ASSIGN_OR_RAISE(
-          combined_table,
-          edge_tables[i]->CombineChunks(arrow::default_memory_pool()));
-#endif
-      edge_tables[i].swap(combined_table);
-
-      collect_outer_vertices(vid_parser_,
-                             std::dynamic_pointer_cast<vid_array_t>(
-                                 edge_tables[i]->column(0)->chunk(0)),
-                             fid_, collected_ovgids);
-      collect_outer_vertices(vid_parser_,
-                             std::dynamic_pointer_cast<vid_array_t>(
-                                 edge_tables[i]->column(1)->chunk(0)),
-                             fid_, collected_ovgids);
+      VY_OK_OR_RAISE(
+          ConcatenateChunks(edge_tables[i]->column(0), &edge_src_gids[i]));
+      VY_OK_OR_RAISE(
+          ConcatenateChunks(edge_tables[i]->column(1), &edge_dst_gids[i]));
+
+      collect_outer_vertices(
+          vid_parser_, std::dynamic_pointer_cast<vid_array_t>(edge_src_gids[i]),
+          fid_, collected_ovgids);
+      collect_outer_vertices(
+          vid_parser_, std::dynamic_pointer_cast<vid_array_t>(edge_dst_gids[i]),
+          fid_, collected_ovgids);
     }
     std::vector<vid_t> start_ids(vertex_label_num_);
     for (label_id_t i = 0; i < vertex_label_num_; ++i) {
@@ -3256,27 +4503,42 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
       tvnums_[i] = ivnums_[i] + ovnums_[i];
     }
 
-    for (size_t i = 0; i < edge_tables.size(); ++i) {
-      generate_local_id_list(vid_parser_,
-                             std::dynamic_pointer_cast<vid_array_t>(
-                                 edge_tables[i]->column(0)->chunk(0)),
-                             fid_, ovg2l_maps_, concurrency, edge_src[i]);
-      generate_local_id_list(vid_parser_,
-                             std::dynamic_pointer_cast<vid_array_t>(
-                                 edge_tables[i]->column(1)->chunk(0)),
-                             fid_, ovg2l_maps_, concurrency, edge_dst[i]);
-
-      std::shared_ptr<arrow::Table> tmp_table0;
+    // the edge labels are independent with each other once the outer
+    // vertices are numbered, thus the local ids, and then the CSRs, of the
+    // edge labels are generated concurrently, see `runByLabels`
+    std::vector<size_t> id_list_bytes(edge_label_num_);
+    for (label_id_t e_label = 0; e_label < edge_label_num_; ++e_label) {
+      id_list_bytes[e_label] =
+          edge_src_gids[e_label]->length() * sizeof(vid_t) * 2;
+    }
+    BOOST_LEAF_CHECK(runByLabels(
+        id_list_bytes, concurrency,
+        [&](size_t const i, int const inner) -> boost::leaf::result<void> {
+          BOOST_LEAF_CHECK(generate_local_id_list(
+              vid_parser_,
+              std::dynamic_pointer_cast<vid_array_t>(edge_src_gids[i]), fid_,
+              ovg2l_maps_, inner, edge_src[i]));
+          BOOST_LEAF_CHECK(generate_local_id_list(
+              vid_parser_,
+              std::dynamic_pointer_cast<vid_array_t>(edge_dst_gids[i]), fid_,
+              ovg2l_maps_, inner, edge_dst[i]));
+          edge_src_gids[i].reset();
+          edge_dst_gids[i].reset();
+
+          std::shared_ptr<arrow::Table> tmp_table0;
 #if defined(ARROW_VERSION) && ARROW_VERSION < 17000
-      ARROW_OK_OR_RAISE(edge_tables[i]->RemoveColumn(0, &tmp_table0));
-      ARROW_OK_OR_RAISE(tmp_table0->RemoveColumn(0, &edge_tables_[i]));
+          ARROW_OK_OR_RAISE(edge_tables[i]->RemoveColumn(0, &tmp_table0));
+          ARROW_OK_OR_RAISE(tmp_table0->RemoveColumn(0, &edge_tables_[i]));
 #else
-      ARROW_OK_ASSIGN_OR_RAISE(tmp_table0, edge_tables[i]->RemoveColumn(0));
-      ARROW_OK_ASSIGN_OR_RAISE(edge_tables_[i], tmp_table0->RemoveColumn(0));
+          ARROW_OK_ASSIGN_OR_RAISE(tmp_table0,
+                                   edge_tables[i]->RemoveColumn(0));
+          ARROW_OK_ASSIGN_OR_RAISE(edge_tables_[i],
+                                   tmp_table0->RemoveColumn(0));
 #endif
 
-      edge_tables[i].reset();
-    }
+          edge_tables[i].reset();
+          return {};
+        }));
 
     oe_lists_.resize(vertex_label_num_);
     oe_offsets_lists_.resize(vertex_label_num_);
@@ -3293,39 +4555,117 @@ class BasicArrowFragmentBuilder : public ArrowFragmentBuilder<OID_T, VID_T> {
         ie_offsets_lists_[v_label].resize(edge_label_num_);
       }
     }
+
+    // a task for each direction of each edge label, which fills the sub
+    // lists of all vertex labels of the edge label in that direction
+    struct csr_task_t {
+      label_id_t e_label;
+      bool incoming;
+      std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>> edges;
+      std::vector<std::shared_ptr<arrow::Int64Array>> offsets;
+      bool is_multigraph = false;
+    };
+    size_t total_vnum = 0;
+    for (label_id_t v_label = 0; v_label < vertex_label_num_; ++v_label) {
+      total_vnum += tvnums_[v_label];
+    }
+    std::vector<csr_task_t> csr_tasks;
+    std::vector<size_t> csr_bytes;
     for (label_id_t e_label = 0; e_label < edge_label_num_; ++e_label) {
-      std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>> sub_ie_lists(
-          vertex_label_num_);
-      std::vector<std::shared_ptr<arrow::FixedSizeBinaryArray>> sub_oe_lists(
-          vertex_label_num_);
-      std::vector<std::shared_ptr<arrow::Int64Array>> sub_ie_offset_lists(
-          vertex_label_num_);
-      std::vector<std::shared_ptr<arrow::Int64Array>> sub_oe_offset_lists(
-          vertex_label_num_);
-      if (directed_) {
-        generate_directed_csr<vid_t, eid_t>(
-            vid_parser_, edge_src[e_label], edge_dst[e_label], tvnums_,
-            vertex_label_num_, concurrency, sub_oe_lists, sub_oe_offset_lists,
-            is_multigraph_);
-        generate_directed_csr<vid_t, eid_t>(
-            vid_parser_, edge_dst[e_label], edge_src[e_label], tvnums_,
-            vertex_label_num_, concurrency, sub_ie_lists, sub_ie_offset_lists,
-            is_multigraph_);
-      } else {
-        generate_undirected_csr<vid_t, eid_t>(
-            vid_parser_, edge_src[e_label], edge_dst[e_label], tvnums_,
-            vertex_label_num_, concurrency, sub_oe_lists, sub_oe_offset_lists,
-            is_multigraph_);
+      // the degrees and offsets of all vertices, and the nbrs of all edges
+      size_t bytes = total_vnum * (sizeof(int) + sizeof(int64_t)) +
+                     edge_src[e_label]->length() * sizeof(nbr_unit_t) *
+                         (directed_ ? 1 : 2);
+      for (bool incoming : {false, true}) {
+        if (incoming && (!directed_ || this->lazy_incoming())) {
+          continue;
+        }
+        csr_tasks.emplace_back();
+        csr_tasks.back().e_label = e_label;
+        csr_tasks.back().incoming = incoming;
+        csr_bytes.emplace_back(bytes);
       }
+    }
+    BOOST_LEAF_CHECK(runByLabels(
+        csr_bytes, concurrency,
+        [&](size_t const i, int const inner) -> boost::leaf::result<void> {
+          auto& task = csr_tasks[i];
+          auto const& src = task.incoming ? edge_dst[task.e_label]
+                                          : edge_src[task.e_label];
+          auto const& dst = task.incoming ? edge_src[task.e_label]
+                                          : edge_dst[task.e_label];
+          task.edges.resize(vertex_label_num_);
+          task.offsets.resize(vertex_label_num_);
+          if (directed_) {
+            BOOST_LEAF_CHECK(generate_directed_csr<vid_t, eid_t>(
+                vid_parser_, src, dst, tvnums_, vertex_label_num_, inner,
+                task.edges, task.offsets, task.is_multigraph));
+          } else {
+            BOOST_LEAF_CHECK(generate_undirected_csr<vid_t, eid_t>(
+                vid_parser_, src, dst, tvnums_, vertex_label_num_, inner,
+                task.edges, task.offsets, task.is_multigraph));
+          }
+          return {};
+        }));
 
+    for (auto& task : csr_tasks) {
+      auto& lists = task.incoming ? ie_lists_ : oe_lists_;
+      auto& offsets_lists =
+          task.incoming ? ie_offsets_lists_ : oe_offsets_lists_;
       for (label_id_t v_label = 0; v_label < vertex_label_num_; ++v_label) {
-        if (directed_) {
-          ie_lists_[v_label][e_label] = sub_ie_lists[v_label];
-          ie_offsets_lists_[v_label][e_label] = sub_ie_offset_lists[v_label];
-        }
-        oe_lists_[v_label][e_label] = sub_oe_lists[v_label];
-        oe_offsets_lists_[v_label][e_label] = sub_oe_offset_lists[v_label];
+        lists[v_label][task.e_label] = std::move(task.edges[v_label]);
+        offsets_lists[v_label][task.e_label] =
+            std::move(task.offsets[v_label]);
       }
+      is_multigraph_ = is_multigraph_ || task.is_multigraph;
+    }
+    return {};
+  }
+
+  /**
+   * @brief Run the tasks of the labels on the shared thread pool, with the
+   * larger tasks first, where at most `concurrency` threads are used in
+   * total, i.e., the `concurrency` is divided among the tasks that run at the
+   * same time, and the tasks are admitted by their estimated memory
+   * footprint `bytes`, see MemoryBudget.
+   */
+  boost::leaf::result<void> runByLabels(
+      std::vector<size_t> const& bytes, int const concurrency,
+      std::function<boost::leaf::result<void>(size_t, int)> const& task) {
+    size_t const task_num = bytes.size();
+    if (task_num == 0) {
+      return {};
+    }
+    size_t const parallelism =
+        std::min(static_cast<size_t>(std::max(concurrency, 1)), task_num);
+    int const inner = std::max(1, concurrency / static_cast<int>(parallelism));
+
+    std::vector<size_t> order(task_num);
+    for (size_t i = 0; i < task_num; ++i) {
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&bytes](size_t const lhs, size_t const rhs) {
+                       return bytes[lhs] > bytes[rhs];
+                     });
+
+    MemoryBudget budget;
+    auto fn = [&](size_t const index) -> Status {
+      size_t const i = order[index];
+      budget.Acquire(bytes[i]);
+      Status status = boost::leaf::try_handle_all(
+          [&]() -> boost::leaf::result<Status> {
+            BOOST_LEAF_CHECK(task(i, inner));
+            return Status::OK();
+          },
+          [](const GSError& e) { return Status::Invalid(e.error_msg); },
+          []() { return Status::UnknownError("Failed to build the label"); });
+      budget.Release(bytes[i]);
+      return status;
+    };
+    auto status = ParallelFor(task_num, fn, parallelism);
+    if (!status.ok()) {
+      RETURN_GS_ERROR(ErrorCode::kUnspecificError, status.message());
     }
     return {};
   }
@@ -0,0 +1,313 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_FRAGMENT_ARROW_FRAGMENT_EXPORTER_H_
+#define MODULES_GRAPH_FRAGMENT_ARROW_FRAGMENT_EXPORTER_H_
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/util/key_value_metadata.h"
+
+#include "basic/ds/arrow_compute.h"
+#include "basic/ds/arrow_utils.h"
+#include "basic/stream/recordbatch_stream.h"
+#include "client/client.h"
+#include "common/util/status.h"
+
+#include "graph/fragment/property_graph_types.h"
+#include "graph/utils/thread_group.h"
+
+namespace vineyard {
+
+/**
+ * @brief ArrowFragmentExporter writes the vertices and the edges of a
+ * fragment out as record batch streams, one stream per vertex label and one
+ * per edge label, chunk by chunk, to be consumed by the io adaptors (or by
+ * the loaders of another fragment) while the export is still going on, thus
+ * the whole tables are never materialized.
+ *
+ * The vertex batches are the id of the inner vertices followed by their
+ * properties, and the edge batches are the ids of the source and the
+ * destination followed by the properties of the edges, i.e., the layout
+ * that the fragment loaders accept. The schemas of the batches carry the
+ * "label" (and the "src_label" and "dst_label" of edges) in the metadata.
+ *
+ * The edges are taken from the outgoing lists of the inner vertices, thus
+ * every edge of a directed graph is exported by exactly one fragment. The
+ * edges of an undirected graph are exported by the endpoint that has the
+ * smaller gid.
+ */
+template <typename FRAG_T>
+class ArrowFragmentExporter {
+  using oid_t = typename FRAG_T::oid_t;
+  using vid_t = typename FRAG_T::vid_t;
+  using eid_t = typename FRAG_T::eid_t;
+  using label_id_t = typename FRAG_T::label_id_t;
+  using vertex_t = typename FRAG_T::vertex_t;
+  using oid_builder_t = typename ConvertToArrowType<oid_t>::BuilderType;
+
+ public:
+  /**
+   * @param chunk_size The number of rows of each batch, at most.
+   * @param concurrency The number of labels that are exported at the same
+   * time, 0 means the hardware concurrency.
+   */
+  ArrowFragmentExporter(Client& client, std::shared_ptr<FRAG_T> const& frag,
+                        int64_t const chunk_size = 64 * 1024,
+                        int const concurrency = 0)
+      : client_(client),
+        frag_(frag),
+        chunk_size_(std::max(chunk_size, static_cast<int64_t>(1))),
+        concurrency_(concurrency > 0 ? concurrency
+                                     : std::thread::hardware_concurrency()) {}
+
+  /**
+   * @brief Create the streams, in the order of the labels, the readers can be
+   * opened before `Export()`.
+   */
+  Status CreateStreams(std::vector<ObjectID>& vertex_streams,
+                       std::vector<ObjectID>& edge_streams) {
+    if (frag_->vertex_cut()) {
+      return Status::NotImplemented(
+          "exporting the fragments of a vertex cut is not supported");
+    }
+    auto const& schema = frag_->schema();
+    vertex_streams_.clear();
+    edge_streams_.clear();
+    for (label_id_t i = 0; i < frag_->vertex_label_num(); ++i) {
+      RETURN_ON_ERROR(createStream("vertex", schema.GetVertexLabelName(i),
+                                   vertex_streams_));
+    }
+    for (label_id_t j = 0; j < frag_->edge_label_num(); ++j) {
+      if (frag_->GetDeltaEdgeNum(j) > 0) {
+        return Status::Invalid(
+            "the inserted edges of label '" + schema.GetEdgeLabelName(j) +
+            "' must be compacted by CompactEdgeDeltas() before exporting");
+      }
+      RETURN_ON_ERROR(
+          createStream("edge", schema.GetEdgeLabelName(j), edge_streams_));
+    }
+    vertex_streams = vertex_streams_;
+    edge_streams = edge_streams_;
+    return Status::OK();
+  }
+
+  /**
+   * @brief Push the batches to the streams, the labels are exported in
+   * parallel and the streams are finished (or aborted on failures) one by
+   * one as their labels are done.
+   */
+  Status Export() {
+    size_t const task_num = vertex_streams_.size() + edge_streams_.size();
+    return ParallelFor(
+        task_num,
+        [this](size_t const index) -> Status {
+          bool const is_vertex = index < vertex_streams_.size();
+          ObjectID const stream_id =
+              is_vertex ? vertex_streams_[index]
+                        : edge_streams_[index - vertex_streams_.size()];
+          // use a connection per label, as pushing chunks may block when the
+          // readers fall behind
+          Client local_client;
+          RETURN_ON_ERROR(local_client.Connect(client_.IPCSocket()));
+          std::shared_ptr<RecordBatchStream> stream;
+          RETURN_ON_ERROR(local_client.GetObject(stream_id, stream));
+          std::unique_ptr<RecordBatchStreamWriter> writer;
+          RETURN_ON_ERROR(stream->OpenWriter(local_client, writer));
+          auto status =
+              is_vertex
+                  ? exportVertices(static_cast<label_id_t>(index), *writer)
+                  : exportEdges(static_cast<label_id_t>(
+                                    index - vertex_streams_.size()),
+                                *writer);
+          if (!status.ok()) {
+            VINEYARD_DISCARD(writer->Abort());
+            return status;
+          }
+          return writer->Finish();
+        },
+        static_cast<size_t>(concurrency_));
+  }
+
+ private:
+  Status createStream(std::string const& kind, std::string const& label,
+                      std::vector<ObjectID>& streams) {
+    RecordBatchStreamBuilder builder(client_);
+    builder.SetParam("kind", kind);
+    builder.SetParam("label", label);
+    builder.SetParam("fid", std::to_string(frag_->fid()));
+    auto stream = builder.Seal(client_);
+    streams.emplace_back(stream->id());
+    return Status::OK();
+  }
+
+  Status exportVertices(label_id_t const label,
+                        RecordBatchStreamWriter& writer) {
+    auto table = frag_->vertex_data_table(label);
+    auto inner_vertices = frag_->InnerVertices(label);
+    vid_t const begin = inner_vertices.begin().GetValue();
+    int64_t const ivnum = static_cast<int64_t>(inner_vertices.size());
+    // the rows of the table are the inner vertices, in order
+    bool const has_properties =
+        table != nullptr && table->num_columns() > 0 &&
+        table->num_rows() == ivnum;
+
+    std::vector<std::shared_ptr<arrow::Field>> fields{
+        arrow::field("id", ConvertToArrowType<oid_t>::TypeValue())};
+    if (has_properties) {
+      for (auto const& field : table->schema()->fields()) {
+        fields.emplace_back(field);
+      }
+    }
+    auto schema = arrow::schema(
+        fields, arrow::key_value_metadata(
+                    {"label"}, {frag_->schema().GetVertexLabelName(label)}));
+
+    for (int64_t offset = 0; offset < ivnum; offset += chunk_size_) {
+      int64_t const length = std::min(chunk_size_, ivnum - offset);
+      oid_builder_t builder;
+      RETURN_ON_ARROW_ERROR(builder.Reserve(length));
+      for (int64_t i = 0; i < length; ++i) {
+        RETURN_ON_ARROW_ERROR(builder.Append(
+            frag_->GetInnerVertexId(vertex_t(begin + offset + i))));
+      }
+      std::vector<std::shared_ptr<arrow::Array>> columns(1);
+      RETURN_ON_ARROW_ERROR(builder.Finish(&columns[0]));
+      if (has_properties) {
+        for (int i = 0; i < table->num_columns(); ++i) {
+          columns.emplace_back(
+              table->column(i)->chunk(0)->Slice(offset, length));
+        }
+      }
+      RETURN_ON_ERROR(writer.WriteBatch(
+          arrow::RecordBatch::Make(schema, length, columns)));
+    }
+    return Status::OK();
+  }
+
+  /**
+   * @brief The pending edges whose destinations are of the same vertex
+   * label, in the order of their sources.
+   */
+  struct EdgeChunk {
+    oid_builder_t src_ids, dst_ids;
+    SelectionVector eids;
+  };
+
+  Status exportEdges(label_id_t const e_label,
+                     RecordBatchStreamWriter& writer) {
+    auto table = frag_->edge_data_table(e_label);
+    bool const has_properties = table != nullptr && table->num_columns() > 0;
+    // dedups the self loops of undirected graphs, which are listed twice
+    std::unordered_set<eid_t> self_loops;
+
+    for (label_id_t src_label = 0; src_label < frag_->vertex_label_num();
+         ++src_label) {
+      std::unordered_map<label_id_t, EdgeChunk> chunks;
+      int64_t pending = 0;
+      auto flush = [&]() -> Status {
+        for (auto& item : chunks) {
+          if (item.second.eids.empty()) {
+            continue;
+          }
+          RETURN_ON_ERROR(writeEdges(table, has_properties, e_label, src_label,
+                                     item.first, item.second, writer));
+        }
+        pending = 0;
+        return Status::OK();
+      };
+
+      for (auto const& v : frag_->InnerVertices(src_label)) {
+        vid_t const src_gid = frag_->Vertex2Gid(v);
+        auto es = frag_->GetOutgoingRawAdjList(v, e_label);
+        if (es.Empty()) {
+          continue;
+        }
+        oid_t const src_id = frag_->GetInnerVertexId(v);
+        for (auto const& e : es) {
+          vertex_t const u(e.vid);
+          if (!frag_->directed()) {
+            vid_t const dst_gid = frag_->Vertex2Gid(u);
+            if (src_gid > dst_gid ||
+                (src_gid == dst_gid && !self_loops.insert(e.eid).second)) {
+              continue;
+            }
+          }
+          auto& chunk = chunks[frag_->vertex_label(u)];
+          RETURN_ON_ARROW_ERROR(chunk.src_ids.Append(src_id));
+          RETURN_ON_ARROW_ERROR(chunk.dst_ids.Append(frag_->GetId(u)));
+          chunk.eids.emplace_back(static_cast<int64_t>(e.eid));
+          pending += 1;
+        }
+        if (pending >= chunk_size_) {
+          RETURN_ON_ERROR(flush());
+        }
+      }
+      RETURN_ON_ERROR(flush());
+    }
+    return Status::OK();
+  }
+
+  Status writeEdges(std::shared_ptr<arrow::Table> const& table,
+                    bool const has_properties, label_id_t const e_label,
+                    label_id_t const src_label, label_id_t const dst_label,
+                    EdgeChunk& chunk,
+                    RecordBatchStreamWriter& writer) {
+    auto const& graph_schema = frag_->schema();
+    int64_t const length = static_cast<int64_t>(chunk.eids.size());
+    auto id_type = ConvertToArrowType<oid_t>::TypeValue();
+    std::vector<std::shared_ptr<arrow::Field>> fields{
+        arrow::field("src_id", id_type), arrow::field("dst_id", id_type)};
+    std::vector<std::shared_ptr<arrow::Array>> columns(2);
+    RETURN_ON_ARROW_ERROR(chunk.src_ids.Finish(&columns[0]));
+    RETURN_ON_ARROW_ERROR(chunk.dst_ids.Finish(&columns[1]));
+    if (has_properties) {
+      for (int i = 0; i < table->num_columns(); ++i) {
+        std::shared_ptr<arrow::Array> column;
+        RETURN_ON_ERROR(Take(table->column(i)->chunk(0), chunk.eids, column));
+        fields.emplace_back(table->schema()->field(i));
+        columns.emplace_back(column);
+      }
+    }
+    chunk.eids.clear();
+    auto schema = arrow::schema(
+        fields,
+        arrow::key_value_metadata(
+            {"label", "src_label", "dst_label"},
+            {graph_schema.GetEdgeLabelName(e_label),
+             graph_schema.GetVertexLabelName(src_label),
+             graph_schema.GetVertexLabelName(dst_label)}));
+    return writer.WriteBatch(
+        arrow::RecordBatch::Make(schema, length, columns));
+  }
+
+  Client& client_;
+  std::shared_ptr<FRAG_T> frag_;
+  int64_t const chunk_size_;
+  int const concurrency_;
+
+  std::vector<ObjectID> vertex_streams_, edge_streams_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_FRAGMENT_ARROW_FRAGMENT_EXPORTER_H_
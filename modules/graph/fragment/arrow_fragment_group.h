@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef MODULES_GRAPH_FRAGMENT_ARROW_FRAGMENT_GROUP_H_
 #define MODULES_GRAPH_FRAGMENT_ARROW_FRAGMENT_GROUP_H_
 
+#include <algorithm>
+#include <map>
 #include <memory>
 #include <string>
 #include <type_traits>
@@ -23,6 +25,7 @@ limitations under the License.
 #include <vector>
 
 #include "client/client.h"
+#include "client/ds/object_factory.h"
 
 #include "graph/fragment/arrow_fragment.h"
 #include "graph/fragment/property_graph_types.h"
@@ -51,6 +54,79 @@ class ArrowFragmentGroup : public Registered<ArrowFragmentGroup>, GlobalObject {
     return fragment_locations_;
   }
 
+  /**
+   * @brief The fids of the fragments on each vineyard instance, in ascending
+   * order, i.e., a worker takes the fragments of its own instance by
+   * `FragmentsByInstance()[client.instance_id()]`.
+   */
+  std::map<uint64_t, std::vector<fid_t>> FragmentsByInstance() const {
+    std::map<uint64_t, std::vector<fid_t>> placement;
+    for (auto const& kv : fragment_locations_) {
+      placement[kv.second].emplace_back(kv.first);
+    }
+    for (auto& kv : placement) {
+      std::sort(kv.second.begin(), kv.second.end());
+    }
+    return placement;
+  }
+
+  /**
+   * @brief The object ids of the fragments on the instance, in the order of
+   * their fids.
+   */
+  std::vector<ObjectID> LocalFragments(uint64_t const instance_id) const {
+    std::vector<ObjectID> fragments;
+    auto placement = FragmentsByInstance();
+    auto iter = placement.find(instance_id);
+    if (iter != placement.end()) {
+      for (fid_t fid : iter->second) {
+        fragments.emplace_back(fragments_.at(fid));
+      }
+    }
+    return fragments;
+  }
+
+  /**
+   * @brief Get the fragments on the instance of the client, whose metadata is
+   * fetched in one batched request, the fragments on the other instances are
+   * never touched. A group that has no fragment on the instance yields none.
+   */
+  Status GetLocalFragments(
+      Client& client,
+      std::map<fid_t, std::shared_ptr<ArrowFragmentBase>>& fragments) const {
+    fragments.clear();
+    auto placement = FragmentsByInstance();
+    auto iter = placement.find(client.instance_id());
+    if (iter == placement.end()) {
+      return Status::OK();
+    }
+    std::vector<fid_t> const& fids = iter->second;
+    std::vector<ObjectID> ids;
+    for (fid_t fid : fids) {
+      ids.emplace_back(fragments_.at(fid));
+    }
+    std::vector<ObjectMeta> metas;
+    RETURN_ON_ERROR(client.GetMetaData(ids, metas));
+    for (size_t i = 0; i < fids.size(); ++i) {
+      if (metas[i].GetInstanceId() != client.instance_id()) {
+        return Status::Invalid("Fragment " + std::to_string(fids[i]) +
+                               " isn't on instance " +
+                               std::to_string(client.instance_id()));
+      }
+      auto object = ObjectFactory::Create(metas[i].GetTypeName());
+      if (object == nullptr) {
+        return Status::Invalid("Fragment " + std::to_string(fids[i]) +
+                               " has an unknown type: " +
+                               metas[i].GetTypeName());
+      }
+      object->Construct(metas[i]);
+      fragments.emplace(fids[i],
+                        std::dynamic_pointer_cast<ArrowFragmentBase>(
+                            std::shared_ptr<Object>(object.release())));
+    }
+    return Status::OK();
+  }
+
   void Construct(const vineyard::ObjectMeta& meta) override {
     this->meta_ = meta;
     this->id_ = meta.GetId();
@@ -116,6 +192,7 @@ class ArrowFragmentGroupBuilder : public ObjectBuilder {
     fg->vertex_label_num_ = vertex_label_num_;
     fg->edge_label_num_ = edge_label_num_;
     fg->fragments_ = fragments_;
+    fg->fragment_locations_ = fragment_locations_;
     if (std::is_base_of<GlobalObject, ArrowFragmentGroup>::value) {
       fg->meta_.SetGlobal(true);
     }
@@ -0,0 +1,335 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_FRAGMENT_COMPRESSED_ADJ_LIST_H_
+#define MODULES_GRAPH_FRAGMENT_COMPRESSED_ADJ_LIST_H_
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "basic/ds/encoded_array.vineyard.h"
+#include "graph/fragment/property_graph_types.h"
+#include "graph/fragment/property_graph_utils.h"
+
+namespace vineyard {
+
+namespace property_graph_utils {
+
+/**
+ * @brief CompressedNbr decodes the neighbors of a compressed adjacency list on
+ * the fly, it has the same interface as Nbr so that the apps that are
+ * templated on the neighbor type work on both.
+ *
+ * The neighbor ids are stored as bit-packed deltas between consecutive
+ * (sorted) neighbors, the edge ids are either implicit, i.e., the position in
+ * the CSR, or bit-packed with a fixed width.
+ */
+template <typename VID_T, typename EID_T>
+struct CompressedNbr {
+ private:
+  using prop_id_t = property_graph_types::PROP_ID_TYPE;
+
+ public:
+  CompressedNbr()
+      : words_(nullptr),
+        bit_(0),
+        bit_width_(0),
+        vid_(0),
+        position_(0),
+        eid_words_(nullptr),
+        eid_bit_width_(0),
+        edata_arrays_(nullptr) {}
+  CompressedNbr(const uint64_t* words, size_t bit, int bit_width, VID_T vid,
+                int64_t position, const uint64_t* eid_words, int eid_bit_width,
+                const void** edata_arrays)
+      : words_(words),
+        bit_(bit),
+        bit_width_(bit_width),
+        vid_(vid),
+        position_(position),
+        eid_words_(eid_words),
+        eid_bit_width_(eid_bit_width),
+        edata_arrays_(edata_arrays) {}
+
+  grape::Vertex<VID_T> neighbor() const { return grape::Vertex<VID_T>(vid_); }
+
+  grape::Vertex<VID_T> get_neighbor() const {
+    return grape::Vertex<VID_T>(vid_);
+  }
+
+  EID_T edge_id() const {
+    return eid_words_ == nullptr
+               ? static_cast<EID_T>(position_)
+               : static_cast<EID_T>(
+                     bit_packing::get(eid_words_, position_, eid_bit_width_));
+  }
+
+  template <typename T>
+  T get_data(prop_id_t prop_id) const {
+    return ValueGetter<T>::Value(edata_arrays_[prop_id], edge_id());
+  }
+
+  std::string get_str(prop_id_t prop_id) const {
+    return ValueGetter<std::string>::Value(edata_arrays_[prop_id], edge_id());
+  }
+
+  double get_double(prop_id_t prop_id) const {
+    return ValueGetter<double>::Value(edata_arrays_[prop_id], edge_id());
+  }
+
+  int64_t get_int(prop_id_t prop_id) const {
+    return ValueGetter<int64_t>::Value(edata_arrays_[prop_id], edge_id());
+  }
+
+  // `bit_` points to the delta of the next neighbor, the deltas can only be
+  // decoded forwards, hence there is no operator--.
+  inline const CompressedNbr& operator++() const {
+    vid_ += static_cast<VID_T>(delta(bit_));
+    bit_ += bit_width_;
+    ++position_;
+    return *this;
+  }
+
+  inline CompressedNbr operator++(int) const {
+    CompressedNbr ret(*this);
+    ++(*this);
+    return ret;
+  }
+
+  inline bool operator==(const CompressedNbr& rhs) const {
+    return position_ == rhs.position_;
+  }
+  inline bool operator!=(const CompressedNbr& rhs) const {
+    return position_ != rhs.position_;
+  }
+
+  inline bool operator<(const CompressedNbr& rhs) const {
+    return position_ < rhs.position_;
+  }
+
+  inline const CompressedNbr& operator*() const { return *this; }
+
+ private:
+  inline uint64_t delta(size_t bit) const {
+    size_t word = bit >> 6, shift = bit & 63;
+    uint64_t mask = bit_width_ == 64 ? ~0ULL : (1ULL << bit_width_) - 1;
+    return ((words_[word] >> shift) |
+            ((words_[word + 1] << 1) << (63 - shift))) &
+           mask;
+  }
+
+  const uint64_t* words_;
+  mutable size_t bit_;
+  int bit_width_;
+  mutable VID_T vid_;
+  mutable int64_t position_;
+  const uint64_t* eid_words_;
+  int eid_bit_width_;
+  const void** edata_arrays_;
+
+  template <typename, typename>
+  friend class CompressedAdjList;
+};
+
+template <typename VID_T>
+using CompressedNbrDefault =
+    CompressedNbr<VID_T, property_graph_types::EID_TYPE>;
+
+template <typename VID_T, typename EID_T>
+class CompressedAdjList {
+ public:
+  CompressedAdjList() : size_(0) {}
+  CompressedAdjList(const CompressedNbr<VID_T, EID_T>& begin, size_t size)
+      : begin_(begin), size_(size) {}
+
+  inline CompressedNbr<VID_T, EID_T> begin() const { return begin_; }
+
+  /**
+   * @brief The end iterator only compares by the position, it must not be
+   * dereferenced.
+   */
+  inline CompressedNbr<VID_T, EID_T> end() const {
+    CompressedNbr<VID_T, EID_T> end(begin_);
+    end.position_ += size_;
+    return end;
+  }
+
+  inline size_t Size() const { return size_; }
+
+  inline bool Empty() const { return size_ == 0; }
+
+  inline bool NotEmpty() const { return size_ != 0; }
+
+  size_t size() const { return size_; }
+
+ private:
+  CompressedNbr<VID_T, EID_T> begin_;
+  size_t size_;
+};
+
+template <typename VID_T>
+using CompressedAdjListDefault =
+    CompressedAdjList<VID_T, property_graph_types::EID_TYPE>;
+
+/**
+ * @brief CompressedCSR is the compressed form of the CSR of one (vertex
+ * label, edge label) pair of a fragment.
+ *
+ * The neighbors of each vertex are sorted by the vertex id, the first one is
+ * kept as is and the rest are stored as deltas, bit-packed with the smallest
+ * width of the vertex. The edge ids are omitted altogether when they equal
+ * the positions in the CSR, i.e., the edges are in CSR order.
+ */
+template <typename VID_T, typename EID_T>
+class CompressedCSR {
+ public:
+  using nbr_unit_t = NbrUnit<VID_T, EID_T>;
+
+  CompressedCSR()
+      : offsets_(nullptr), implicit_eids_(true), eid_bit_width_(0) {}
+
+  /**
+   * @brief Compress the CSR given by `offsets` (of `num_vertices + 1`
+   * elements) and the neighbor units, the offsets are referenced rather than
+   * copied and must outlive the compressed CSR.
+   */
+  void Compress(const int64_t* offsets, size_t num_vertices,
+                const nbr_unit_t* nbrs) {
+    offsets_ = offsets;
+    int64_t num_edges = offsets_[num_vertices] - offsets_[0];
+    std::vector<nbr_unit_t> sorted(nbrs + offsets_[0],
+                                   nbrs + offsets_[num_vertices]);
+    auto cmp = [](const nbr_unit_t& lhs, const nbr_unit_t& rhs) {
+      return lhs.vid < rhs.vid || (lhs.vid == rhs.vid && lhs.eid < rhs.eid);
+    };
+
+    firsts_.assign(num_vertices, VID_T{});
+    bit_widths_.assign(num_vertices, 0);
+    bit_offsets_.assign(num_vertices, 0);
+    size_t total_bits = 0;
+    implicit_eids_ = true;
+    uint64_t max_eid = 0;
+    for (size_t v = 0; v < num_vertices; ++v) {
+      auto begin = sorted.begin() + (offsets_[v] - offsets_[0]);
+      auto end = sorted.begin() + (offsets_[v + 1] - offsets_[0]);
+      std::sort(begin, end, cmp);
+      uint64_t max_delta = 0;
+      for (auto iter = begin; iter != end; ++iter) {
+        if (iter != begin) {
+          max_delta = std::max(max_delta, static_cast<uint64_t>(
+                                              iter->vid - (iter - 1)->vid));
+        }
+        int64_t position = offsets_[v] + (iter - begin);
+        implicit_eids_ &= (static_cast<int64_t>(iter->eid) == position);
+        max_eid = std::max(max_eid, static_cast<uint64_t>(iter->eid));
+      }
+      if (begin != end) {
+        firsts_[v] = begin->vid;
+      }
+      bit_widths_[v] = static_cast<uint8_t>(bit_packing::bit_width(max_delta));
+      bit_offsets_[v] = total_bits;
+      if (end - begin > 1) {
+        total_bits += (end - begin - 1) * bit_widths_[v];
+      }
+    }
+
+    // the two padding words keep the decoding of the delta past the last
+    // neighbor in bound
+    words_.assign((total_bits + 63) / 64 + 2, 0);
+    for (size_t v = 0; v < num_vertices; ++v) {
+      auto begin = sorted.begin() + (offsets_[v] - offsets_[0]);
+      auto end = sorted.begin() + (offsets_[v + 1] - offsets_[0]);
+      size_t bit = bit_offsets_[v];
+      for (auto iter = begin + (begin == end ? 0 : 1); iter < end; ++iter) {
+        append(static_cast<uint64_t>(iter->vid - (iter - 1)->vid), bit,
+               bit_widths_[v]);
+        bit += bit_widths_[v];
+      }
+    }
+
+    eid_words_.clear();
+    eid_bit_width_ = 0;
+    if (!implicit_eids_) {
+      // indexed by the absolute position in the CSR
+      eid_bit_width_ = bit_packing::bit_width(max_eid);
+      std::vector<uint64_t> eids(offsets_[num_vertices], 0);
+      for (int64_t i = 0; i < num_edges; ++i) {
+        eids[offsets_[0] + i] = static_cast<uint64_t>(sorted[i].eid);
+      }
+      eid_words_.resize(
+          bit_packing::packed_size(eids.size(), eid_bit_width_) /
+          sizeof(uint64_t));
+      bit_packing::pack(eids.data(), eids.size(), eid_bit_width_,
+                        eid_words_.data());
+    }
+  }
+
+  inline CompressedAdjList<VID_T, EID_T> GetAdjList(
+      int64_t v_offset, const void** edata_arrays) const {
+    return CompressedAdjList<VID_T, EID_T>(
+        CompressedNbr<VID_T, EID_T>(
+            words_.data(), bit_offsets_[v_offset], bit_widths_[v_offset],
+            firsts_[v_offset], offsets_[v_offset],
+            implicit_eids_ ? nullptr : eid_words_.data(), eid_bit_width_,
+            edata_arrays),
+        offsets_[v_offset + 1] - offsets_[v_offset]);
+  }
+
+  inline size_t Degree(int64_t v_offset) const {
+    return offsets_[v_offset + 1] - offsets_[v_offset];
+  }
+
+  bool implicit_eids() const { return implicit_eids_; }
+
+  /**
+   * @brief The number of bytes of the compressed neighbors and edge ids,
+   * excluding the offsets which are shared with the uncompressed CSR.
+   */
+  size_t CompressedSize() const {
+    return words_.size() * sizeof(uint64_t) + firsts_.size() * sizeof(VID_T) +
+           bit_widths_.size() * sizeof(uint8_t) +
+           bit_offsets_.size() * sizeof(size_t) +
+           eid_words_.size() * sizeof(uint64_t);
+  }
+
+ private:
+  void append(uint64_t value, size_t bit, int bit_width) {
+    if (bit_width == 0) {
+      return;
+    }
+    size_t word = bit >> 6, shift = bit & 63;
+    words_[word] |= value << shift;
+    if (shift + bit_width > 64) {
+      words_[word + 1] |= value >> (64 - shift);
+    }
+  }
+
+  const int64_t* offsets_;
+  std::vector<VID_T> firsts_;
+  std::vector<uint8_t> bit_widths_;
+  std::vector<size_t> bit_offsets_;
+  std::vector<uint64_t> words_;
+
+  bool implicit_eids_;
+  int eid_bit_width_;
+  std::vector<uint64_t> eid_words_;
+};
+
+}  // namespace property_graph_utils
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_FRAGMENT_COMPRESSED_ADJ_LIST_H_
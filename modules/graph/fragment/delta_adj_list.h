@@ -0,0 +1,296 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_FRAGMENT_DELTA_ADJ_LIST_H_
+#define MODULES_GRAPH_FRAGMENT_DELTA_ADJ_LIST_H_
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "flat_hash_map/flat_hash_map.hpp"
+
+#include "graph/fragment/property_graph_types.h"
+#include "graph/fragment/property_graph_utils.h"
+
+namespace vineyard {
+
+namespace property_graph_utils {
+
+/**
+ * @brief DeltaNbr iterates over the neighbors in the base CSR of a vertex,
+ * followed by the neighbors in the delta segment, it has the same interface
+ * as Nbr so that the apps that are templated on the neighbor type work on
+ * both.
+ *
+ * The edge ids of the delta edges continue the ones of the base edge table,
+ * the properties of an edge are looked up in the delta edge table when its
+ * id is not less than the number of base edges.
+ */
+template <typename VID_T, typename EID_T>
+struct DeltaNbr {
+ private:
+  using prop_id_t = property_graph_types::PROP_ID_TYPE;
+
+ public:
+  DeltaNbr()
+      : nbr_(nullptr),
+        position_(0),
+        base_size_(0),
+        delta_begin_(nullptr),
+        base_edge_num_(0),
+        edata_arrays_(nullptr),
+        delta_edata_arrays_(nullptr) {}
+  DeltaNbr(const NbrUnit<VID_T, EID_T>* nbr, int64_t position,
+           int64_t base_size, const NbrUnit<VID_T, EID_T>* delta_begin,
+           EID_T base_edge_num, const void** edata_arrays,
+           const void** delta_edata_arrays)
+      : nbr_(nbr),
+        position_(position),
+        base_size_(base_size),
+        delta_begin_(delta_begin),
+        base_edge_num_(base_edge_num),
+        edata_arrays_(edata_arrays),
+        delta_edata_arrays_(delta_edata_arrays) {}
+
+  grape::Vertex<VID_T> neighbor() const {
+    return grape::Vertex<VID_T>(nbr_->vid);
+  }
+
+  grape::Vertex<VID_T> get_neighbor() const {
+    return grape::Vertex<VID_T>(nbr_->vid);
+  }
+
+  EID_T edge_id() const { return nbr_->eid; }
+
+  /**
+   * @brief Whether the edge is in the delta segment, i.e., has not been
+   * compacted into the base CSR yet.
+   */
+  bool is_delta() const { return position_ >= base_size_; }
+
+  template <typename T>
+  T get_data(prop_id_t prop_id) const {
+    return ValueGetter<T>::Value(column(prop_id), row());
+  }
+
+  std::string get_str(prop_id_t prop_id) const {
+    return ValueGetter<std::string>::Value(column(prop_id), row());
+  }
+
+  double get_double(prop_id_t prop_id) const {
+    return ValueGetter<double>::Value(column(prop_id), row());
+  }
+
+  int64_t get_int(prop_id_t prop_id) const {
+    return ValueGetter<int64_t>::Value(column(prop_id), row());
+  }
+
+  // the base and the delta neighbors are not adjacent in memory, hence the
+  // iterator compares by the position and there is no operator--.
+  inline const DeltaNbr& operator++() const {
+    ++nbr_;
+    if (++position_ == base_size_) {
+      nbr_ = delta_begin_;
+    }
+    return *this;
+  }
+
+  inline DeltaNbr operator++(int) const {
+    DeltaNbr ret(*this);
+    ++(*this);
+    return ret;
+  }
+
+  inline bool operator==(const DeltaNbr& rhs) const {
+    return position_ == rhs.position_;
+  }
+  inline bool operator!=(const DeltaNbr& rhs) const {
+    return position_ != rhs.position_;
+  }
+
+  inline bool operator<(const DeltaNbr& rhs) const {
+    return position_ < rhs.position_;
+  }
+
+  inline const DeltaNbr& operator*() const { return *this; }
+
+ private:
+  inline const void* column(prop_id_t prop_id) const {
+    return nbr_->eid < base_edge_num_ ? edata_arrays_[prop_id]
+                                      : delta_edata_arrays_[prop_id];
+  }
+
+  inline int64_t row() const {
+    return nbr_->eid < base_edge_num_
+               ? static_cast<int64_t>(nbr_->eid)
+               : static_cast<int64_t>(nbr_->eid - base_edge_num_);
+  }
+
+  const mutable NbrUnit<VID_T, EID_T>* nbr_;
+  mutable int64_t position_;
+  int64_t base_size_;
+  const NbrUnit<VID_T, EID_T>* delta_begin_;
+  EID_T base_edge_num_;
+  const void** edata_arrays_;
+  const void** delta_edata_arrays_;
+
+  template <typename, typename>
+  friend class DeltaAdjList;
+};
+
+template <typename VID_T>
+using DeltaNbrDefault = DeltaNbr<VID_T, property_graph_types::EID_TYPE>;
+
+template <typename VID_T, typename EID_T>
+class DeltaAdjList {
+ public:
+  DeltaAdjList() : size_(0) {}
+  DeltaAdjList(const NbrUnit<VID_T, EID_T>* base_begin,
+               const NbrUnit<VID_T, EID_T>* base_end,
+               const NbrUnit<VID_T, EID_T>* delta_begin, size_t delta_size,
+               EID_T base_edge_num, const void** edata_arrays,
+               const void** delta_edata_arrays)
+      : begin_(base_begin == base_end ? delta_begin : base_begin, 0,
+               base_end - base_begin, delta_begin, base_edge_num,
+               edata_arrays, delta_edata_arrays),
+        size_((base_end - base_begin) + delta_size) {}
+
+  inline DeltaNbr<VID_T, EID_T> begin() const { return begin_; }
+
+  /**
+   * @brief The end iterator only compares by the position, it must not be
+   * dereferenced.
+   */
+  inline DeltaNbr<VID_T, EID_T> end() const {
+    DeltaNbr<VID_T, EID_T> end(begin_);
+    end.position_ += size_;
+    return end;
+  }
+
+  inline size_t Size() const { return size_; }
+
+  inline bool Empty() const { return size_ == 0; }
+
+  inline bool NotEmpty() const { return size_ != 0; }
+
+  size_t size() const { return size_; }
+
+ private:
+  DeltaNbr<VID_T, EID_T> begin_;
+  size_t size_;
+};
+
+template <typename VID_T>
+using DeltaAdjListDefault = DeltaAdjList<VID_T, property_graph_types::EID_TYPE>;
+
+/**
+ * @brief DeltaCSR is the append-only delta segment of the CSR of one (vertex
+ * label, edge label) pair of a fragment, only the vertices that have new
+ * edges take space.
+ *
+ * The delta neighbors of a vertex are kept sorted by the vertex id, so that
+ * Merge with the (sorted) base CSR is a linear merge for each vertex.
+ */
+template <typename VID_T, typename EID_T>
+class DeltaCSR {
+ public:
+  using nbr_unit_t = NbrUnit<VID_T, EID_T>;
+
+  void Append(int64_t v_offset, VID_T vid, EID_T eid) {
+    auto& nbrs = nbrs_[v_offset];
+    nbr_unit_t unit(vid, eid);
+    nbrs.insert(std::upper_bound(nbrs.begin(), nbrs.end(), unit,
+                                 [](const nbr_unit_t& lhs,
+                                    const nbr_unit_t& rhs) {
+                                   return lhs.vid < rhs.vid;
+                                 }),
+                unit);
+    ++size_;
+  }
+
+  /**
+   * @brief The delta neighbors of the vertex, nullptr if there is none.
+   */
+  const std::vector<nbr_unit_t>* Find(int64_t v_offset) const {
+    auto iter = nbrs_.find(v_offset);
+    return iter == nbrs_.end() ? nullptr : &iter->second;
+  }
+
+  size_t Degree(int64_t v_offset) const {
+    auto nbrs = Find(v_offset);
+    return nbrs == nullptr ? 0 : nbrs->size();
+  }
+
+  /**
+   * @brief The number of edges in the delta segment.
+   */
+  size_t size() const { return size_; }
+
+  bool empty() const { return size_ == 0; }
+
+  void Clear() {
+    nbrs_.clear();
+    size_ = 0;
+  }
+
+  /**
+   * @brief Merge the base CSR of `num_vertices` vertices with the delta
+   * segment, the neighbors of each vertex stay sorted by the vertex id.
+   *
+   * `out_offsets` must have space for `num_vertices + 1` offsets, and
+   * `out_nbrs` for all base neighbors plus size() neighbors.
+   *
+   * @return Whether any vertex has parallel edges after the merge.
+   */
+  bool Merge(const int64_t* offsets, const nbr_unit_t* nbrs,
+             int64_t num_vertices, int64_t* out_offsets,
+             nbr_unit_t* out_nbrs) const {
+    auto less = [](const nbr_unit_t& lhs, const nbr_unit_t& rhs) {
+      return lhs.vid < rhs.vid;
+    };
+    bool is_multigraph = false;
+    int64_t position = 0;
+    out_offsets[0] = 0;
+    for (int64_t v = 0; v < num_vertices; ++v) {
+      const nbr_unit_t* begin = nbrs + offsets[v];
+      const nbr_unit_t* end = nbrs + offsets[v + 1];
+      nbr_unit_t* out = out_nbrs + position;
+      auto delta = Find(v);
+      if (delta == nullptr) {
+        std::copy(begin, end, out);
+      } else {
+        std::merge(begin, end, delta->begin(), delta->end(), out, less);
+      }
+      position = out_offsets[v + 1] =
+          position + (end - begin) + (delta ? static_cast<int64_t>(delta->size()) : 0);
+      for (nbr_unit_t* iter = out;
+           !is_multigraph && iter + 1 < out_nbrs + position; ++iter) {
+        is_multigraph = iter->vid == (iter + 1)->vid;
+      }
+    }
+    return is_multigraph;
+  }
+
+ private:
+  ska::flat_hash_map<int64_t, std::vector<nbr_unit_t>> nbrs_;
+  size_t size_ = 0;
+};
+
+}  // namespace property_graph_utils
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_FRAGMENT_DELTA_ADJ_LIST_H_
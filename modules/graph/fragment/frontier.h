@@ -0,0 +1,282 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_FRAGMENT_FRONTIER_H_
+#define MODULES_GRAPH_FRAGMENT_FRONTIER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "grape/utils/vertex_array.h"
+
+#include "common/util/status.h"
+#include "graph/utils/thread_group.h"
+
+namespace vineyard {
+
+/**
+ * @brief AtomicBitset is a bitset of a fixed size, whose bits can be set by
+ * many threads concurrently, e.g., the visited vertices of a BFS.
+ */
+class AtomicBitset {
+ public:
+  AtomicBitset() = default;
+
+  explicit AtomicBitset(size_t const size) { Resize(size); }
+
+  AtomicBitset(AtomicBitset&& other) = default;
+
+  AtomicBitset& operator=(AtomicBitset&& other) = default;
+
+  /**
+   * @brief Resize the bitset, all bits are cleared.
+   */
+  void Resize(size_t const size) {
+    size_ = size;
+    word_num_ = (size + 63) / 64;
+    words_.reset(new std::atomic<uint64_t>[word_num_]);
+    Clear();
+  }
+
+  inline size_t Size() const { return size_; }
+
+  void Clear() {
+    for (size_t i = 0; i < word_num_; ++i) {
+      words_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  inline bool Get(size_t const index) const {
+    return words_[index / 64].load(std::memory_order_relaxed) &
+           (uint64_t(1) << (index % 64));
+  }
+
+  /**
+   * @brief Set the bit, returns whether the bit was unset before, i.e., among
+   * the threads that set the same bit only one gets true.
+   */
+  inline bool Set(size_t const index) {
+    uint64_t mask = uint64_t(1) << (index % 64);
+    // skips the atomic write when the bit is set already, which is the common
+    // case for the visited vertices of the dense frontiers
+    if (words_[index / 64].load(std::memory_order_relaxed) & mask) {
+      return false;
+    }
+    return !(words_[index / 64].fetch_or(mask, std::memory_order_relaxed) &
+             mask);
+  }
+
+  inline void Reset(size_t const index) {
+    words_[index / 64].fetch_and(~(uint64_t(1) << (index % 64)),
+                                 std::memory_order_relaxed);
+  }
+
+  size_t Count() const {
+    size_t count = 0;
+    for (size_t i = 0; i < word_num_; ++i) {
+      count += __builtin_popcountll(words_[i].load(std::memory_order_relaxed));
+    }
+    return count;
+  }
+
+  void Swap(AtomicBitset& other) {
+    std::swap(size_, other.size_);
+    std::swap(word_num_, other.word_num_);
+    std::swap(words_, other.words_);
+  }
+
+  /**
+   * @brief Run `func(index)` for the set bits in ascending order.
+   */
+  template <typename FUNC_T>
+  void ForEach(FUNC_T const& func) const {
+    forEach(0, word_num_, func);
+  }
+
+  /**
+   * @brief Run `func(index)` for the set bits on `thread_num` threads, the
+   * bits of a 64-bit word are visited by the same thread.
+   */
+  template <typename FUNC_T>
+  void ParallelForEach(FUNC_T const& func, int const thread_num) const {
+    // 4096 bits per chunk, thus the sparse bitsets don't pay for the tasks
+    size_t const chunk = 64;
+    size_t chunk_num = (word_num_ + chunk - 1) / chunk;
+    VINEYARD_DISCARD(ParallelFor(
+        chunk_num,
+        [&](size_t index) {
+          forEach(index * chunk, std::min((index + 1) * chunk, word_num_),
+                  func);
+          return Status::OK();
+        },
+        static_cast<size_t>(std::max(thread_num, 1))));
+  }
+
+ private:
+  template <typename FUNC_T>
+  void forEach(size_t const begin, size_t const end,
+               FUNC_T const& func) const {
+    for (size_t i = begin; i < end; ++i) {
+      uint64_t word = words_[i].load(std::memory_order_relaxed);
+      while (word != 0) {
+        func(i * 64 + __builtin_ctzll(word));
+        word &= word - 1;
+      }
+    }
+  }
+
+  size_t size_ = 0, word_num_ = 0;
+  std::unique_ptr<std::atomic<uint64_t>[]> words_;
+};
+
+/**
+ * @brief VertexFrontier is the set of vertices of a vertex range, e.g.,
+ * `frag.Vertices(label)`, which covers the `GetVerticesNum(label)` inner and
+ * outer vertices of the label. The vertices can be inserted by many threads
+ * concurrently.
+ *
+ * @tparam VID_T
+ */
+template <typename VID_T>
+class VertexFrontier {
+ public:
+  using vertex_t = grape::Vertex<VID_T>;
+
+  explicit VertexFrontier(grape::VertexRange<VID_T> const& range)
+      : begin_(range.begin().GetValue()),
+        end_(range.end().GetValue()),
+        bitset_(range.size()) {}
+
+  /**
+   * @brief Insert the vertex, returns whether it wasn't in the frontier, see
+   * AtomicBitset::Set.
+   */
+  inline bool Insert(vertex_t const& v) {
+    return bitset_.Set(v.GetValue() - begin_);
+  }
+
+  inline bool Exist(vertex_t const& v) const {
+    return bitset_.Get(v.GetValue() - begin_);
+  }
+
+  inline void Erase(vertex_t const& v) { bitset_.Reset(v.GetValue() - begin_); }
+
+  grape::VertexRange<VID_T> Range() const {
+    return grape::VertexRange<VID_T>(begin_, end_);
+  }
+
+  size_t Count() const { return bitset_.Count(); }
+
+  bool Empty() const { return Count() == 0; }
+
+  void Clear() { bitset_.Clear(); }
+
+  /**
+   * @brief Swap with the frontier of the same range, e.g., the current and
+   * the next frontier of a BFS.
+   */
+  void Swap(VertexFrontier& other) {
+    std::swap(begin_, other.begin_);
+    std::swap(end_, other.end_);
+    bitset_.Swap(other.bitset_);
+  }
+
+  template <typename FUNC_T>
+  void ForEach(FUNC_T const& func) const {
+    VID_T begin = begin_;
+    bitset_.ForEach([&](size_t index) { func(vertex_t(begin + index)); });
+  }
+
+  template <typename FUNC_T>
+  void ParallelForEach(FUNC_T const& func, int const thread_num) const {
+    VID_T begin = begin_;
+    bitset_.ParallelForEach(
+        [&](size_t index) { func(vertex_t(begin + index)); }, thread_num);
+  }
+
+ private:
+  VID_T begin_, end_;
+  AtomicBitset bitset_;
+};
+
+/**
+ * @brief Run `func(v)` for the inner vertices of the label on `thread_num`
+ * threads, where the vertices are split into chunks of about the same number
+ * of outgoing edges of the edge label, or of all edge labels when `e_label`
+ * is -1, plus one per vertex, thus the skewed degrees are balanced. The
+ * chunks are taken by the threads in turn, see ParallelFor.
+ *
+ * @param chunk_num The number of chunks, 0 means 4 chunks per thread.
+ */
+template <typename FRAG_T, typename FUNC_T>
+void parallel_for_inner_vertices(
+    FRAG_T const& frag, typename FRAG_T::label_id_t const v_label,
+    FUNC_T const& func, int thread_num,
+    typename FRAG_T::label_id_t const e_label = -1, size_t chunk_num = 0) {
+  using label_id_t = typename FRAG_T::label_id_t;
+  using vid_t = typename FRAG_T::vid_t;
+
+  thread_num = std::max(thread_num, 1);
+  auto inner_vertices = frag.InnerVertices(v_label);
+  vid_t begin = inner_vertices.begin().GetValue();
+  size_t ivnum = inner_vertices.size();
+  label_id_t e_label_begin = e_label < 0 ? 0 : e_label;
+  label_id_t e_label_end = e_label < 0 ? frag.edge_label_num() : e_label + 1;
+  // the number of edges before the vertex at the offset, plus the offset,
+  // which is monotonic in the offset
+  auto weight = [&](size_t offset) {
+    int64_t sum = static_cast<int64_t>(offset);
+    for (label_id_t j = e_label_begin; j < e_label_end; ++j) {
+      sum += frag.GetOutgoingOffsets(v_label, j)[offset];
+    }
+    return sum;
+  };
+  auto bound = [&](int64_t target) {
+    size_t low = 0, high = ivnum;
+    while (low < high) {
+      size_t mid = low + (high - low) / 2;
+      if (weight(mid) < target) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return low;
+  };
+
+  if (chunk_num == 0) {
+    chunk_num = static_cast<size_t>(thread_num) * 4;
+  }
+  chunk_num = std::max(static_cast<size_t>(1), std::min(chunk_num, ivnum));
+  int64_t total = weight(ivnum);
+  VINEYARD_DISCARD(ParallelFor(
+      chunk_num,
+      [&](size_t index) {
+        size_t chunk_begin = bound(total * index / chunk_num);
+        size_t chunk_end = bound(total * (index + 1) / chunk_num);
+        for (size_t offset = chunk_begin; offset < chunk_end; ++offset) {
+          func(grape::Vertex<vid_t>(begin + offset));
+        }
+        return Status::OK();
+      },
+      static_cast<size_t>(thread_num)));
+}
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_FRAGMENT_FRONTIER_H_
@@ -0,0 +1,143 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_FRAGMENT_OUTER_VERTEX_INDEX_H_
+#define MODULES_GRAPH_FRAGMENT_OUTER_VERTEX_INDEX_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <vector>
+
+namespace vineyard {
+
+/**
+ * @brief OuterVertexIndex translates the gids of the outer vertices of a
+ * label to their lids by a branchless binary search over the sorted gids,
+ * rather than by probing a hashmap.
+ *
+ * The outer gids of a label are fixed once the fragment is built and the
+ * lid of the i-th outer gid is `start + i`. The gid list is sorted when the
+ * fragment is built from scratch, in which case the index borrows the list
+ * and costs no extra memory; otherwise, e.g., when new outer vertices are
+ * appended by `AddNewEdges`, a sorted copy of the gids and their lids is
+ * kept.
+ */
+template <typename VID_T>
+class OuterVertexIndex {
+ public:
+  /**
+   * @brief Index the `size` gids, which must outlive the index, where the lid
+   * of `gids[i]` is `start + i`.
+   */
+  void Init(const VID_T* gids, size_t const size, VID_T const start) {
+    size_ = size;
+    start_ = start;
+    sorted_gids_.clear();
+    lids_.clear();
+    if (std::is_sorted(gids, gids + size)) {
+      gids_ = gids;
+      return;
+    }
+    std::vector<size_t> order(size);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [gids](size_t lhs, size_t rhs) { return gids[lhs] < gids[rhs]; });
+    sorted_gids_.resize(size);
+    lids_.resize(size);
+    for (size_t k = 0; k < size; ++k) {
+      sorted_gids_[k] = gids[order[k]];
+      lids_[k] = start + static_cast<VID_T>(order[k]);
+    }
+    gids_ = sorted_gids_.data();
+  }
+
+  inline bool Find(VID_T const gid, VID_T& lid) const {
+    if (size_ == 0) {
+      return false;
+    }
+    const VID_T* base = gids_;
+    for (size_t n = size_; n > 1;) {
+      size_t half = n / 2;
+      base += (base[half] <= gid) ? half : 0;
+      n -= half;
+    }
+    if (*base != gid) {
+      return false;
+    }
+    lid = lidAt(base - gids_);
+    return true;
+  }
+
+  /**
+   * @brief Find the lids of a batch of gids. The searches of a group of gids
+   * advance in lockstep and the next probe of each search is prefetched, to
+   * overlap the cache misses of independent lookups, see also
+   * `Hashmap::find_batch`.
+   *
+   * @param gids The gids to find.
+   * @param n The number of gids.
+   * @param lids The lids of the gids, left untouched for missing gids.
+   * @param found Whether each gid is an outer vertex of the label.
+   */
+  void FindBatch(const VID_T* gids, size_t const n, VID_T* lids,
+                 bool* found) const {
+    constexpr size_t group_size = 16;
+    if (size_ == 0) {
+      std::fill(found, found + n, false);
+      return;
+    }
+    const VID_T* bases[group_size];
+    for (size_t begin = 0; begin < n; begin += group_size) {
+      size_t group = std::min(group_size, n - begin);
+      for (size_t i = 0; i < group; ++i) {
+        bases[i] = gids_;
+      }
+      for (size_t remaining = size_; remaining > 1;) {
+        size_t half = remaining / 2;
+        remaining -= half;
+        for (size_t i = 0; i < group; ++i) {
+          bases[i] += (bases[i][half] <= gids[begin + i]) ? half : 0;
+          __builtin_prefetch(bases[i] + remaining / 2, 0, 1);
+        }
+      }
+      for (size_t i = 0; i < group; ++i) {
+        found[begin + i] = *bases[i] == gids[begin + i];
+        if (found[begin + i]) {
+          lids[begin + i] = lidAt(bases[i] - gids_);
+        }
+      }
+    }
+  }
+
+  size_t size() const { return size_; }
+
+ private:
+  inline VID_T lidAt(ptrdiff_t const index) const {
+    return lids_.empty() ? start_ + static_cast<VID_T>(index) : lids_[index];
+  }
+
+  const VID_T* gids_ = nullptr;
+  size_t size_ = 0;
+  VID_T start_ = 0;
+
+  // the sorted copy, only when the gid list is not sorted itself
+  std::vector<VID_T> sorted_gids_;
+  std::vector<VID_T> lids_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_FRAGMENT_OUTER_VERTEX_INDEX_H_
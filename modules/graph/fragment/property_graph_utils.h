@@ -39,6 +39,7 @@ limitations under the License.
 #include "graph/fragment/property_graph_types.h"
 #include "graph/utils/error.h"
 #include "graph/utils/mpi_utils.h"
+#include "graph/utils/thread_group.h"
 
 namespace vineyard {
 
@@ -129,10 +130,18 @@ struct NbrUnit {
 template <typename VID_T>
 using NbrUnitDefault = NbrUnit<VID_T, property_graph_types::EID_TYPE>;
 
+/**
+ * EdgeDataColumn is the typed view of a numeric edge property, the accesses
+ * are plain loads indexed by the eid, hence inlined into the loops over the
+ * adjacency lists.
+ *
+ * @tparam DATA_T
+ * @tparam NBR_T
+ */
 template <typename DATA_T, typename NBR_T>
 class EdgeDataColumn {
  public:
-  EdgeDataColumn() = default;
+  EdgeDataColumn() : data_(NULL), size_(0) {}
 
   explicit EdgeDataColumn(std::shared_ptr<arrow::Array> array) {
     if (array->type()->Equals(
@@ -141,15 +150,44 @@ class EdgeDataColumn {
           std::dynamic_pointer_cast<
               typename vineyard::ConvertToArrowType<DATA_T>::ArrayType>(array)
               ->raw_values();
+      size_ = array->length();
     } else {
       data_ = NULL;
+      size_ = 0;
     }
   }
 
-  const DATA_T& operator[](const NBR_T& nbr) const { return data_[nbr.eid]; }
+  inline const DATA_T& operator[](const NBR_T& nbr) const {
+    return data_[nbr.eid];
+  }
+
+  /**
+   * @brief The values of the column in the order of the eids, i.e., a
+   * contiguous span of `size()` values, for the loops over all edges.
+   */
+  inline const DATA_T* data() const { return data_; }
+
+  inline size_t size() const { return size_; }
 
  private:
   const DATA_T* data_;
+  size_t size_;
+};
+
+/**
+ * The edges without properties, the column holds nothing and the accesses
+ * are compiled away.
+ */
+template <typename NBR_T>
+class EdgeDataColumn<grape::EmptyType, NBR_T> {
+ public:
+  EdgeDataColumn() = default;
+
+  explicit EdgeDataColumn(std::shared_ptr<arrow::Array>) {}
+
+  inline grape::EmptyType operator[](const NBR_T&) const {
+    return grape::EmptyType();
+  }
 };
 
 template <typename NBR_T>
@@ -176,6 +214,13 @@ class EdgeDataColumn<std::string, NBR_T> {
 template <typename DATA_T, typename VID_T>
 using EdgeDataColumnDefault = EdgeDataColumn<DATA_T, NbrUnitDefault<VID_T>>;
 
+/**
+ * VertexDataColumn is the typed view of a numeric vertex property of the
+ * inner vertices of a label, see EdgeDataColumn.
+ *
+ * @tparam DATA_T
+ * @tparam VID_T
+ */
 template <typename DATA_T, typename VID_T>
 class VertexDataColumn {
  public:
@@ -199,15 +244,37 @@ class VertexDataColumn {
     data_ = nullptr;
   }
 
-  const DATA_T& operator[](const grape::Vertex<VID_T>& v) const {
+  inline const DATA_T& operator[](const grape::Vertex<VID_T>& v) const {
     return data_[v.GetValue()];
   }
 
+  /**
+   * @brief The values of the vertices of the range in order, i.e., a
+   * contiguous span of `size()` values.
+   */
+  inline const DATA_T* data() const {
+    return data_ == NULL ? NULL : data_ + range_.begin().GetValue();
+  }
+
+  inline size_t size() const { return data_ == NULL ? 0 : range_.size(); }
+
  private:
   const DATA_T* data_;
   grape::VertexRange<VID_T> range_;
 };
 
+template <typename VID_T>
+class VertexDataColumn<grape::EmptyType, VID_T> {
+ public:
+  VertexDataColumn(grape::VertexRange<VID_T>, std::shared_ptr<arrow::Array>) {}
+
+  explicit VertexDataColumn(grape::VertexRange<VID_T>) {}
+
+  inline grape::EmptyType operator[](const grape::Vertex<VID_T>&) const {
+    return grape::EmptyType();
+  }
+};
+
 template <typename VID_T>
 class VertexDataColumn<std::string, VID_T> {
  public:
@@ -510,6 +577,100 @@ class AdjList {
 template <typename VID_T>
 using AdjListDefault = AdjList<VID_T, property_graph_types::EID_TYPE>;
 
+/**
+ * VidNbr iterates over the neighbor vids only, either over a separate vid
+ * array (the stride is 1), or over the vids of an array of NbrUnit.
+ *
+ * @tparam VID_T
+ */
+template <typename VID_T>
+struct VidNbr {
+ public:
+  VidNbr() : vid_(NULL), stride_(1) {}
+  VidNbr(const VID_T* vid, size_t stride) : vid_(vid), stride_(stride) {}
+
+  grape::Vertex<VID_T> neighbor() const { return grape::Vertex<VID_T>(*vid_); }
+
+  grape::Vertex<VID_T> get_neighbor() const {
+    return grape::Vertex<VID_T>(*vid_);
+  }
+
+  inline const VidNbr& operator++() const {
+    vid_ += stride_;
+    return *this;
+  }
+
+  inline VidNbr operator++(int) const {
+    VidNbr ret(*this);
+    ++(*this);
+    return ret;
+  }
+
+  inline const VidNbr& operator--() const {
+    vid_ -= stride_;
+    return *this;
+  }
+
+  inline VidNbr operator--(int) const {
+    VidNbr ret(*this);
+    --(*this);
+    return ret;
+  }
+
+  inline bool operator==(const VidNbr& rhs) const { return vid_ == rhs.vid_; }
+  inline bool operator!=(const VidNbr& rhs) const { return vid_ != rhs.vid_; }
+
+  inline bool operator<(const VidNbr& rhs) const { return vid_ < rhs.vid_; }
+
+  inline const VidNbr& operator*() const { return *this; }
+
+ private:
+  const mutable VID_T* vid_;
+  size_t stride_;
+};
+
+/**
+ * VidAdjList is the adjacency list of the neighbor vids only, for algorithms
+ * that don't touch the edges, e.g., BFS and PageRank. Over the separate vid
+ * arrays the eids are never pulled into the cache.
+ *
+ * @tparam VID_T
+ */
+template <typename VID_T>
+class VidAdjList {
+ public:
+  VidAdjList() : begin_(NULL), size_(0), stride_(1) {}
+  VidAdjList(const VID_T* begin, size_t size, size_t stride)
+      : begin_(begin), size_(size), stride_(stride) {}
+
+  inline VidNbr<VID_T> begin() const { return VidNbr<VID_T>(begin_, stride_); }
+
+  inline VidNbr<VID_T> end() const {
+    return VidNbr<VID_T>(begin_ + size_ * stride_, stride_);
+  }
+
+  inline size_t Size() const { return size_; }
+
+  inline bool Empty() const { return size_ == 0; }
+
+  inline bool NotEmpty() const { return size_ != 0; }
+
+  size_t size() const { return size_; }
+
+  /**
+   * @brief Whether the vids are contiguous, i.e., `begin_unit()` points to an
+   * array of `Size()` vids.
+   */
+  inline bool Contiguous() const { return stride_ == 1; }
+
+  inline const VID_T* begin_unit() const { return begin_; }
+
+ private:
+  const VID_T* begin_;
+  size_t size_;
+  size_t stride_;
+};
+
 /**
  * OffsetAdjList will offset the outer vertices' lid, makes it between "ivnum"
  * and "tvnum" instead of "ivnum ~ tvnum - outer vertex index"
@@ -864,32 +1025,23 @@ inline boost::leaf::result<std::shared_ptr<arrow::Table>> SyncSchema(
 template <typename ITER_T, typename FUNC_T>
 void parallel_for(const ITER_T& begin, const ITER_T& end, const FUNC_T& func,
                   int thread_num, size_t chunk = 0) {
-  std::vector<std::thread> threads(thread_num);
   size_t num = end - begin;
   if (chunk == 0) {
     chunk = (num + thread_num - 1) / thread_num;
   }
-  std::atomic<size_t> cur(0);
-  for (int i = 0; i < thread_num; ++i) {
-    threads[i] = std::thread([&]() {
-      while (true) {
-        size_t x = cur.fetch_add(chunk);
-        if (x >= num) {
-          break;
-        }
-        size_t y = std::min(x + chunk, num);
-        ITER_T a = begin + x;
-        ITER_T b = begin + y;
+  size_t chunk_num = chunk == 0 ? 0 : (num + chunk - 1) / chunk;
+  VINEYARD_DISCARD(ParallelFor(
+      chunk_num,
+      [&](size_t index) {
+        ITER_T a = begin + index * chunk;
+        ITER_T b = begin + std::min((index + 1) * chunk, num);
         while (a != b) {
           func(a);
           ++a;
         }
-      }
-    });
-  }
-  for (auto& thrd : threads) {
-    thrd.join();
-  }
+        return Status::OK();
+      },
+      static_cast<size_t>(thread_num)));
 }
 
 inline void parallel_prefix_sum(const int* input, int64_t* output,
@@ -908,13 +1060,13 @@ inline void parallel_prefix_sum(const int* input, int64_t* output,
     }
   };
 
-  std::vector<std::thread> threads_prefix;
-  for (int i = 0; i < thread_num; ++i) {
-    threads_prefix.emplace_back(block_prefix, i);
-  }
-  for (auto& thrd : threads_prefix) {
-    thrd.join();
-  }
+  VINEYARD_DISCARD(ParallelFor(
+      thread_num,
+      [&](size_t i) {
+        block_prefix(static_cast<int>(i));
+        return Status::OK();
+      },
+      thread_num));
 
   std::vector<int64_t> block_sum(thread_num);
   {
@@ -934,12 +1086,14 @@ inline void parallel_prefix_sum(const int* input, int64_t* output,
     }
   };
 
-  std::vector<std::thread> threads_sum;
-  for (int i = 1; i < thread_num; ++i) {
-    threads_sum.emplace_back(block_add, i);
-  }
-  for (auto& thrd : threads_sum) {
-    thrd.join();
+  if (thread_num > 1) {
+    VINEYARD_DISCARD(ParallelFor(
+        thread_num - 1,
+        [&](size_t i) {
+          block_add(static_cast<int>(i) + 1);
+          return Status::OK();
+        },
+        thread_num - 1));
   }
 }
 
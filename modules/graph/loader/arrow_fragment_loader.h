@@ -46,6 +46,7 @@ limitations under the License.
 #include "graph/loader/basic_ev_fragment_loader.h"
 #include "graph/loader/fragment_loader_utils.h"
 #include "graph/utils/error.h"
+#include "graph/utils/load_profile.h"
 #include "graph/utils/partitioner.h"
 #include "graph/utils/thread_group.h"
 #include "graph/vertex_map/arrow_vertex_map.h"
@@ -54,10 +55,22 @@ limitations under the License.
 
 namespace vineyard {
 
-inline Status ReadRecordBatchesFromVineyardStream(
+/**
+ * @brief Pull the batches of the local streams in `pstream`, the `consumer`
+ * is invoked on each batch as soon as it arrives, concurrently from the
+ * reader threads of the streams, thus the batches needn't be retained until
+ * all streams are drained. Reading a stream stops at the first batch that
+ * the consumer fails on.
+ *
+ * When the stream is dynamic, every reader thread reads all local streams in
+ * the shared mode, starting from a different one, and moves on to the next
+ * stream once the current one is drained, thus the batches of a slow or large
+ * stream are claimed by all reader threads of all parts.
+ */
+template <typename CONSUMER_T>
+inline Status ConsumeRecordBatchesFromVineyardStream(
     Client& client, std::shared_ptr<ParallelStream>& pstream,
-    std::vector<std::shared_ptr<arrow::RecordBatch>>& batches, int part_id,
-    int part_num) {
+    CONSUMER_T const& consumer, int part_id, int part_num) {
   auto local_streams = pstream->GetLocalStreams<DataframeStream>();
 
   size_t split_size = local_streams.size() / part_num +
@@ -66,30 +79,52 @@ inline Status ReadRecordBatchesFromVineyardStream(
   size_t end_to_read =
       std::min(local_streams.size(), (part_id + 1) * split_size);
 
-  std::mutex mutex_for_results;
-
-  auto reader = [&client, &local_streams, &mutex_for_results,
-                 &batches](size_t idx) {
+  auto reader = [&client, &local_streams, &consumer](size_t idx) {
     // use a local client, since reading from stream may block the client.
     Client local_client;
     RETURN_ON_ERROR(local_client.Connect(client.IPCSocket()));
     std::unique_ptr<DataframeStreamReader> reader;
     VINEYARD_CHECK_OK(local_streams[idx]->OpenReader(local_client, reader));
-    std::vector<std::shared_ptr<arrow::RecordBatch>> read_batches;
-    RETURN_ON_ERROR(reader->ReadRecordBatches(read_batches));
-    {
-      std::lock_guard<std::mutex> scoped_lock(mutex_for_results);
-      for (auto const& batch : read_batches) {
-        VLOG(10) << "recordbatch from stream: " << batch->schema()->ToString();
-        batches.emplace_back(batch);
+    std::shared_ptr<arrow::RecordBatch> batch;
+    while (reader->ReadBatch(batch).ok()) {
+      VLOG(10) << "recordbatch from stream: " << batch->schema()->ToString();
+      RETURN_ON_ERROR(consumer(batch));
+      batch.reset();
+    }
+    return Status::OK();
+  };
+
+  auto dynamic_reader = [&client, &local_streams, &consumer](size_t start) {
+    Client local_client;
+    RETURN_ON_ERROR(local_client.Connect(client.IPCSocket()));
+    std::vector<std::unique_ptr<DataframeStreamReader>> readers(
+        local_streams.size());
+    for (size_t idx = 0; idx < local_streams.size(); ++idx) {
+      RETURN_ON_ERROR(local_streams[idx]->OpenReader(
+          local_client, readers[idx], StreamOpenMode::shared));
+    }
+    for (size_t offset = 0; offset < readers.size(); ++offset) {
+      auto& reader = readers[(start + offset) % readers.size()];
+      std::shared_ptr<arrow::RecordBatch> batch;
+      while (reader->ReadBatch(batch).ok()) {
+        RETURN_ON_ERROR(consumer(batch));
+        batch.reset();
       }
     }
     return Status::OK();
   };
 
   ThreadGroup tg;
-  for (size_t idx = start_to_read; idx != end_to_read; ++idx) {
-    tg.AddTask(reader, idx);
+  if (pstream->IsDynamic() && !local_streams.empty()) {
+    // each part reads with at least one thread
+    end_to_read = std::max(end_to_read, start_to_read + 1);
+    for (size_t idx = start_to_read; idx != end_to_read; ++idx) {
+      tg.AddTask(dynamic_reader, idx);
+    }
+  } else {
+    for (size_t idx = start_to_read; idx < end_to_read; ++idx) {
+      tg.AddTask(reader, idx);
+    }
   }
   auto readers_status = tg.TakeResults();
   for (auto const& status : readers_status) {
@@ -98,6 +133,21 @@ inline Status ReadRecordBatchesFromVineyardStream(
   return Status::OK();
 }
 
+inline Status ReadRecordBatchesFromVineyardStream(
+    Client& client, std::shared_ptr<ParallelStream>& pstream,
+    std::vector<std::shared_ptr<arrow::RecordBatch>>& batches, int part_id,
+    int part_num) {
+  std::mutex mutex_for_results;
+  auto consumer = [&mutex_for_results, &batches](
+                      std::shared_ptr<arrow::RecordBatch> const& batch) {
+    std::lock_guard<std::mutex> scoped_lock(mutex_for_results);
+    batches.emplace_back(batch);
+    return Status::OK();
+  };
+  return ConsumeRecordBatchesFromVineyardStream(client, pstream, consumer,
+                                                part_id, part_num);
+}
+
 inline Status ReadRecordBatchesFromVineyardDataFrame(
     Client& client, std::shared_ptr<GlobalDataFrame>& gdf,
     std::vector<std::shared_ptr<arrow::RecordBatch>>& batches, int part_id,
@@ -134,12 +184,54 @@ inline Status ReadRecordBatchesFromVineyard(
       source->meta().GetTypeName());
 }
 
+/**
+ * @brief See ConsumeRecordBatchesFromVineyardStream, the chunks of a global
+ * dataframe are passed to the `consumer` one after another.
+ */
+template <typename CONSUMER_T>
+inline Status ConsumeRecordBatchesFromVineyard(Client& client,
+                                               const ObjectID object_id,
+                                               CONSUMER_T const& consumer,
+                                               int part_id, int part_num) {
+  auto source = client.GetObject(object_id);
+  RETURN_ON_ASSERT(source != nullptr,
+                   "Object not exists: " + ObjectIDToString(object_id));
+  if (auto pstream = std::dynamic_pointer_cast<ParallelStream>(source)) {
+    return ConsumeRecordBatchesFromVineyardStream(client, pstream, consumer,
+                                                  part_id, part_num);
+  }
+  if (auto gdf = std::dynamic_pointer_cast<GlobalDataFrame>(source)) {
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    RETURN_ON_ERROR(ReadRecordBatchesFromVineyardDataFrame(
+        client, gdf, batches, part_id, part_num));
+    for (auto const& batch : batches) {
+      RETURN_ON_ERROR(consumer(batch));
+    }
+    return Status::OK();
+  }
+
+  return Status::Invalid(
+      "The source is not a parallel stream nor a global dataframe: " +
+      source->meta().GetTypeName());
+}
+
 /**
  * @brief When the stream is empty, the result `table` will be set as nullptr.
  */
 inline Status ReadTableFromVineyardStream(
     Client& client, std::shared_ptr<ParallelStream>& pstream,
     std::shared_ptr<arrow::Table>& table, int part_id, int part_num) {
+  if (pstream->IsDynamic()) {
+    // the batches of a stream may be read by many parts
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    RETURN_ON_ERROR(ReadRecordBatchesFromVineyardStream(
+        client, pstream, batches, part_id, part_num));
+    if (batches.empty()) {
+      table = nullptr;
+      return Status::OK();
+    }
+    return RecordBatchesToTable(batches, &table);
+  }
   auto local_streams = pstream->GetLocalStreams<DataframeStream>();
   size_t split_size = local_streams.size() / part_num +
                       (local_streams.size() % part_num == 0 ? 0 : 1);
@@ -243,6 +335,26 @@ inline Status ReadTableFromVineyard(Client& client, const ObjectID object_id,
  * + or all chunks doesn't have such meta.
  */
 
+/**
+ * @brief Get the edge label and the vertex labels of the relation of an edge
+ * batch from the metadata of its schema, `label` is left unchanged when the
+ * metadata doesn't contain the label.
+ */
+inline void GetEdgeBatchLabels(std::shared_ptr<arrow::RecordBatch> const& batch,
+                               std::string& label, std::string& src_label,
+                               std::string& dst_label) {
+  auto metadata = batch->schema()->metadata();
+  if (metadata != nullptr) {
+    std::unordered_map<std::string, std::string> meta_map;
+    metadata->ToUnorderedMap(&meta_map);
+    if (meta_map.find("label") != meta_map.end()) {
+      label = meta_map["label"];
+    }
+    src_label = meta_map["src_label"];
+    dst_label = meta_map["dst_label"];
+  }
+}
+
 inline boost::leaf::result<
     std::vector<std::vector<std::shared_ptr<arrow::Table>>>>
 GatherETables(Client& client,
@@ -260,18 +372,9 @@ GatherETables(Client& client,
                                                 part_id, part_num);
     if (status.ok()) {
       std::lock_guard<std::mutex> scoped_lock(mutex_for_results);
-      std::string label = std::to_string(index), src_label = "", dst_label = "";
       for (auto const& batch : batches) {
-        auto metadata = batch->schema()->metadata();
-        if (metadata != nullptr) {
-          std::unordered_map<std::string, std::string> meta_map;
-          metadata->ToUnorderedMap(&meta_map);
-          if (meta_map.find("label") != meta_map.end()) {
-            label = meta_map["label"];
-          }
-          src_label = meta_map["src_label"];
-          dst_label = meta_map["dst_label"];
-        }
+        std::string label = std::to_string(index), src_label, dst_label;
+        GetEdgeBatchLabels(batch, label, src_label, dst_label);
         grouped_batches[label][std::make_pair(src_label, dst_label)]
             .emplace_back(batch);
       }
@@ -384,8 +487,11 @@ class ArrowFragmentLoader {
   static constexpr const char* DST_LABEL_TAG = "dst_label";
 
   static constexpr int id_column = 0;
-#ifdef HASH_PARTITION
+#if defined(HASH_PARTITION)
   using partitioner_t = HashPartitioner<oid_t>;
+#elif defined(RANGE_PARTITION)
+  // keeps the segment boundaries only, rather than a map of all oids
+  using partitioner_t = RangePartitioner<oid_t>;
 #else
   using partitioner_t = SegmentedPartitioner<oid_t>;
 #endif
@@ -462,19 +568,85 @@ class ArrowFragmentLoader {
 
   ~ArrowFragmentLoader() = default;
 
+  /**
+   * @brief See BasicEVFragmentLoader::SetVertexOrdering.
+   */
+  void SetVertexOrdering(VertexOrdering ordering) {
+    vertex_ordering_ = ordering;
+  }
+
+  /**
+   * @brief See BasicEVFragmentLoader::SetEdgePartitioning.
+   */
+  void SetEdgePartitioning(EdgePartitioning partitioning) {
+    edge_partitioning_ = partitioning;
+  }
+
+  /**
+   * @brief Resolve the edges of the edge streams chunk by chunk once the
+   * vertices have been constructed, rather than gathering the raw edges of all
+   * streams beforehand, thus only the resolved chunks are retained. The vertex
+   * labels of all edges must be given by the vertex streams, since they can't
+   * be deduced from the edges then.
+   */
+  void SetStreamingEdges(bool stream_edges) { stream_edges_ = stream_edges; }
+
+  /**
+   * @brief See BasicEVFragmentLoader::SetSpillDirectory.
+   */
+  void SetSpillDirectory(const std::string& spill_directory) {
+    spill_directory_ = spill_directory;
+  }
+
+  /**
+   * @brief See BasicEVFragmentLoader::SetLoadProfile, the reading of the
+   * inputs is recorded as well.
+   */
+  void SetLoadProfile(std::shared_ptr<LoadProfile> profile) {
+    profile_ = profile;
+  }
+
+  /**
+   * @brief See BasicEVFragmentLoader::SetSelectedProperties, the properties
+   * are pushed down to the csv reader of the files as well, thus the other
+   * columns are never parsed.
+   */
+  void SetSelectedProperties(property_selection_t const& vertex_properties,
+                             property_selection_t const& edge_properties) {
+    vertex_properties_ = vertex_properties;
+    edge_properties_ = edge_properties;
+  }
+
+  /**
+   * @brief See BasicEVFragmentLoader::SetLazyIncoming.
+   */
+  void SetLazyIncoming(bool lazy_incoming) { lazy_incoming_ = lazy_incoming; }
+
+  /**
+   * @brief See BasicEVFragmentLoader::SetEncodeEdgeProperties.
+   */
+  void SetEncodeEdgeProperties(bool encode_edge_properties) {
+    encode_edge_properties_ = encode_edge_properties;
+  }
+
   boost::leaf::result<ObjectID> LoadFragment() {
-    BOOST_LEAF_CHECK(initPartitioner());
+    {
+      LoadProfile::Scope scope(profile_, "init_partitioner");
+      BOOST_LEAF_CHECK(initPartitioner());
+    }
 
     std::vector<std::shared_ptr<arrow::Table>> partial_v_tables;
     std::vector<std::vector<std::shared_ptr<arrow::Table>>> partial_e_tables;
     if (!v_streams_.empty() && !e_streams_.empty()) {
       {
+        LoadProfile::Scope scope(profile_, "read_vertices");
         BOOST_LEAF_AUTO(
             tmp, GatherVTables(client_, v_streams_, comm_spec_.local_id(),
                                comm_spec_.local_num()));
         partial_v_tables = tmp;
       }
-      {
+      if (!stream_edges_) {
+        LoadProfile::Scope scope(profile_, "read_edges");
         BOOST_LEAF_AUTO(
             tmp, GatherETables(client_, e_streams_, comm_spec_.local_id(),
                                comm_spec_.local_num()));
@@ -485,12 +657,16 @@ class ArrowFragmentLoader {
         return loadVertexTables(vfiles_, comm_spec_.worker_id(),
                                 comm_spec_.worker_num());
       };
-      BOOST_LEAF_AUTO(tmp_v, sync_gs_error(comm_spec_, load_v_procedure));
-      partial_v_tables = tmp_v;
+      {
+        LoadProfile::Scope scope(profile_, "read_vertices");
+        BOOST_LEAF_AUTO(tmp_v, sync_gs_error(comm_spec_, load_v_procedure));
+        partial_v_tables = tmp_v;
+      }
       auto load_e_procedure = [&]() {
         return loadEdgeTables(efiles_, comm_spec_.worker_id(),
                               comm_spec_.worker_num());
       };
+      LoadProfile::Scope scope(profile_, "read_edges");
       BOOST_LEAF_AUTO(tmp_e, sync_gs_error(comm_spec_, load_e_procedure));
       partial_e_tables = tmp_e;
     } else if (vfiles_.empty() && !efiles_.empty()) {
@@ -498,6 +674,7 @@ class ArrowFragmentLoader {
         return loadEdgeTables(efiles_, comm_spec_.worker_id(),
                               comm_spec_.worker_num());
       };
+      LoadProfile::Scope scope(profile_, "read_edges");
       BOOST_LEAF_AUTO(tmp_e, sync_gs_error(comm_spec_, load_e_procedure));
       partial_e_tables = tmp_e;
     } else if (!partial_e_tables_.empty() && !partial_e_tables_.empty()) {
@@ -529,12 +706,24 @@ class ArrowFragmentLoader {
         basic_fragment_loader = std::make_shared<
             BasicEVFragmentLoader<OID_T, VID_T, partitioner_t>>(
             client_, comm_spec_, partitioner_, directed_, true, generate_eid_);
+    basic_fragment_loader->SetVertexOrdering(vertex_ordering_);
+    basic_fragment_loader->SetEdgePartitioning(edge_partitioning_);
+    basic_fragment_loader->SetSpillDirectory(spill_directory_);
+    basic_fragment_loader->SetLoadProfile(profile_);
+    basic_fragment_loader->SetSelectedProperties(vertex_properties_,
+                                                 edge_properties_);
+    basic_fragment_loader->SetLazyIncoming(lazy_incoming_);
+    basic_fragment_loader->SetEncodeEdgeProperties(encode_edge_properties_);
 
-    BOOST_LEAF_AUTO(v_e_tables,
-                    preprocessInputs(partial_v_tables, partial_e_tables));
-
-    auto vertex_tables_with_label = v_e_tables.first;
-    auto edge_tables_with_label = v_e_tables.second;
+    vertex_table_info_t vertex_tables_with_label;
+    edge_table_info_t edge_tables_with_label;
+    {
+      LoadProfile::Scope scope(profile_, "preprocess_inputs");
+      BOOST_LEAF_AUTO(v_e_tables,
+                      preprocessInputs(partial_v_tables, partial_e_tables));
+      vertex_tables_with_label = v_e_tables.first;
+      edge_tables_with_label = v_e_tables.second;
+    }
 
     for (auto& pair : vertex_tables_with_label) {
       BOOST_LEAF_CHECK(
@@ -545,6 +734,14 @@ class ArrowFragmentLoader {
     partial_v_tables.clear();
     vertex_tables_with_label.clear();
 
+    if (stream_edges_ && !e_streams_.empty()) {
+      auto consume_e_procedure = [&]() {
+        return consumeEdgeStreams(*basic_fragment_loader);
+      };
+      LoadProfile::Scope scope(profile_, "read_edges");
+      BOOST_LEAF_CHECK(sync_gs_error(comm_spec_, consume_e_procedure));
+    }
+
     for (auto& table : edge_tables_with_label) {
       BOOST_LEAF_CHECK(basic_fragment_loader->AddEdgeTable(
           table.src_label, table.dst_label, table.edge_label, table.table));
@@ -606,28 +803,105 @@ class ArrowFragmentLoader {
     return {};
   }
 
+  using io_adaptor_t =
+      std::unique_ptr<IIOAdaptor, std::function<void(IIOAdaptor*)>>;
+
+  /**
+   * @brief Read only the leading `key_columns` columns and the selected
+   * properties of the label of the file, by passing them as the `schema` of
+   * the file. The files that specify their own schema or column types are
+   * left unchanged.
+   */
+  std::string selectColumns(const std::string& file, int const key_columns,
+                            property_selection_t const& selection) {
+    auto pos = file.find('#');
+    if (selection.empty() || pos == std::string::npos) {
+      return file;
+    }
+    std::string location_args = file.substr(pos + 1);
+    std::vector<std::string> args;
+    boost::split(args, location_args, boost::is_any_of("&#"));
+    const std::string label_arg = std::string(LABEL_TAG) + "=";
+    std::string label;
+    for (auto const& arg : args) {
+      if (boost::starts_with(arg, "schema=") ||
+          boost::starts_with(arg, "column_types=") ||
+          boost::starts_with(arg, "include_all_columns=")) {
+        return file;
+      }
+      if (boost::starts_with(arg, label_arg)) {
+        label = arg.substr(label_arg.size());
+      }
+    }
+    auto iter = selection.find(label);
+    if (iter == selection.end()) {
+      return file;
+    }
+    // the key columns are referred by their indices, as the names come from
+    // the header
+    std::string schema = "0";
+    for (int index = 1; index < key_columns; ++index) {
+      schema += "," + std::to_string(index);
+    }
+    for (auto const& property : iter->second) {
+      schema += "," + property;
+    }
+    return file + "#schema=" + schema;
+  }
+
+  /**
+   * @brief Open and read the given files concurrently, each file is parsed by
+   * the multi-threaded arrow reader as well, thus many small files don't
+   * leave the workers idle. It is a collective operation.
+   */
+  boost::leaf::result<std::vector<std::shared_ptr<arrow::Table>>> readTables(
+      const std::vector<std::string>& files, int index, int total_parts,
+      std::vector<io_adaptor_t>& io_adaptors) {
+    io_adaptors.clear();
+    for (auto const& file : files) {
+      io_adaptors.emplace_back(
+          IOFactory::CreateIOAdaptor(file + "#header_row=true").release(),
+          io_deleter_);
+    }
+    auto read_procedure = [&]()
+        -> boost::leaf::result<std::vector<std::shared_ptr<arrow::Table>>> {
+      std::vector<std::shared_ptr<arrow::Table>> tables(files.size());
+      ThreadGroup tg;
+      for (size_t i = 0; i < files.size(); ++i) {
+        tg.AddTask(
+            [&](size_t const file_index) -> Status {
+              auto& io_adaptor = io_adaptors[file_index];
+              if (io_adaptor == nullptr) {
+                return Status::IOError("Failed to open " + files[file_index]);
+              }
+              RETURN_ON_ERROR(io_adaptor->SetPartialRead(index, total_parts));
+              RETURN_ON_ERROR(io_adaptor->Open());
+              return io_adaptor->ReadTable(&tables[file_index]);
+            },
+            i);
+      }
+      for (auto const& status : tg.TakeResults()) {
+        VY_OK_OR_RAISE(status);
+      }
+      return tables;
+    };
+    return sync_gs_error(comm_spec_, read_procedure);
+  }
+
   boost::leaf::result<std::vector<std::shared_ptr<arrow::Table>>>
   loadVertexTables(const std::vector<std::string>& files, int index,
                    int total_parts) {
     auto label_num = static_cast<label_id_t>(files.size());
-    std::vector<std::shared_ptr<arrow::Table>> tables(label_num);
+    std::vector<std::string> selected_files;
+    for (auto const& file : files) {
+      selected_files.emplace_back(selectColumns(file, 1, vertex_properties_));
+    }
+    std::vector<io_adaptor_t> io_adaptors;
+    BOOST_LEAF_AUTO(tables, readTables(selected_files, index, total_parts,
+                                       io_adaptors));
 
     for (label_id_t label_id = 0; label_id < label_num; ++label_id) {
-      std::unique_ptr<IIOAdaptor, std::function<void(IIOAdaptor*)>> io_adaptor(
-          IOFactory::CreateIOAdaptor(files[label_id] + "#header_row=true")
-              .release(),
-          io_deleter_);
-      auto read_procedure =
-          [&]() -> boost::leaf::result<std::shared_ptr<arrow::Table>> {
-        VY_OK_OR_RAISE(io_adaptor->SetPartialRead(index, total_parts));
-        VY_OK_OR_RAISE(io_adaptor->Open());
-        std::shared_ptr<arrow::Table> table;
-        VY_OK_OR_RAISE(io_adaptor->ReadTable(&table));
-        return table;
-      };
-
-      BOOST_LEAF_AUTO(table, sync_gs_error(comm_spec_, read_procedure));
-
+      auto& table = tables[label_id];
       auto sync_schema_procedure =
           [&]() -> boost::leaf::result<std::shared_ptr<arrow::Table>> {
         return SyncSchema(table, comm_spec_);
@@ -638,7 +912,7 @@ class ArrowFragmentLoader {
 
       auto meta = std::make_shared<arrow::KeyValueMetadata>();
 
-      auto adaptor_meta = io_adaptor->GetMeta();
+      auto adaptor_meta = io_adaptors[label_id]->GetMeta();
       // Check if label name is in meta
       if (adaptor_meta.find(LABEL_TAG) == adaptor_meta.end()) {
         RETURN_GS_ERROR(
@@ -665,26 +939,25 @@ class ArrowFragmentLoader {
     std::vector<std::vector<std::shared_ptr<arrow::Table>>> tables(label_num);
 
     try {
+      // the files of all labels are read together
+      std::vector<std::string> all_files;
+      std::vector<size_t> label_offsets(label_num + 1, 0);
       for (label_id_t label_id = 0; label_id < label_num; ++label_id) {
         std::vector<std::string> sub_label_files;
         boost::split(sub_label_files, files[label_id], boost::is_any_of(";"));
+        for (auto const& file : sub_label_files) {
+          all_files.emplace_back(selectColumns(file, 2, edge_properties_));
+        }
+        label_offsets[label_id + 1] = all_files.size();
+      }
+      std::vector<io_adaptor_t> io_adaptors;
+      BOOST_LEAF_AUTO(all_tables,
+                      readTables(all_files, index, total_parts, io_adaptors));
 
-        for (size_t j = 0; j < sub_label_files.size(); ++j) {
-          std::unique_ptr<IIOAdaptor, std::function<void(IIOAdaptor*)>>
-              io_adaptor(IOFactory::CreateIOAdaptor(sub_label_files[j] +
-                                                    "#header_row=true")
-                             .release(),
-                         io_deleter_);
-          auto read_procedure =
-              [&]() -> boost::leaf::result<std::shared_ptr<arrow::Table>> {
-            VY_OK_OR_RAISE(io_adaptor->SetPartialRead(index, total_parts));
-            VY_OK_OR_RAISE(io_adaptor->Open());
-            std::shared_ptr<arrow::Table> table;
-            VY_OK_OR_RAISE(io_adaptor->ReadTable(&table));
-            return table;
-          };
-          BOOST_LEAF_AUTO(table, sync_gs_error(comm_spec_, read_procedure));
-
+      for (label_id_t label_id = 0; label_id < label_num; ++label_id) {
+        for (size_t j = label_offsets[label_id];
+             j < label_offsets[label_id + 1]; ++j) {
+          auto& table = all_tables[j];
           auto sync_schema_procedure =
               [&]() -> boost::leaf::result<std::shared_ptr<arrow::Table>> {
             return SyncSchema(table, comm_spec_);
@@ -695,7 +968,7 @@ class ArrowFragmentLoader {
           std::shared_ptr<arrow::KeyValueMetadata> meta(
               new arrow::KeyValueMetadata());
 
-          auto adaptor_meta = io_adaptor->GetMeta();
+          auto adaptor_meta = io_adaptors[j]->GetMeta();
           auto it = adaptor_meta.find(LABEL_TAG);
           if (it == adaptor_meta.end()) {
             RETURN_GS_ERROR(
@@ -740,6 +1013,59 @@ class ArrowFragmentLoader {
     return tables;
   }
 
+  /**
+   * @brief Pull the batches of the edge streams and add them to the loader one
+   * at a time, see also BasicEVFragmentLoader::AddEdgeBatch.
+   */
+  boost::leaf::result<bool> consumeEdgeStreams(
+      BasicEVFragmentLoader<OID_T, VID_T, partitioner_t>& loader) {
+    std::mutex mutex_for_error;
+    GSError error;
+    auto reader = [&](size_t const index, ObjectID const estream) {
+      auto consumer = [&](std::shared_ptr<arrow::RecordBatch> const& batch) {
+        std::string label = std::to_string(index), src_label, dst_label;
+        GetEdgeBatchLabels(batch, label, src_label, dst_label);
+        GSError e = boost::leaf::try_handle_all(
+            [&]() -> boost::leaf::result<GSError> {
+              BOOST_LEAF_CHECK(
+                  loader.AddEdgeBatch(src_label, dst_label, label, batch));
+              return GSError();
+            },
+            [](const GSError& e) { return e; },
+            []() {
+              return GSError(ErrorCode::kUnspecificError,
+                             "Failed to add the edge batch");
+            });
+        if (!e.ok()) {
+          std::lock_guard<std::mutex> scoped_lock(mutex_for_error);
+          if (error.ok()) {
+            error = e;
+          }
+          return Status::Invalid(e.error_msg);
+        }
+        return Status::OK();
+      };
+      return ConsumeRecordBatchesFromVineyard(client_, estream, consumer,
+                                              comm_spec_.local_id(),
+                                              comm_spec_.local_num());
+    };
+
+    ThreadGroup tg;
+    for (size_t index = 0; index < e_streams_.size(); ++index) {
+      for (auto const& estream : e_streams_[index]) {
+        tg.AddTask(reader, index, estream);
+      }
+    }
+    auto readers_status = tg.TakeResults();
+    if (!error.ok()) {
+      return boost::leaf::new_error(error);
+    }
+    for (auto const& status : readers_status) {
+      VY_OK_OR_RAISE(status);
+    }
+    return true;
+  }
+
   boost::leaf::result<std::pair<vertex_table_info_t, edge_table_info_t>>
   preprocessInputs(
       const std::vector<std::shared_ptr<arrow::Table>>& v_tables,
@@ -825,6 +1151,14 @@ class ArrowFragmentLoader {
 
   bool directed_;
   bool generate_eid_;
+  VertexOrdering vertex_ordering_ = VertexOrdering::kInput;
+  EdgePartitioning edge_partitioning_ = EdgePartitioning::kEdgeCut;
+  bool stream_edges_ = false;
+  std::string spill_directory_;
+  std::shared_ptr<LoadProfile> profile_;
+  property_selection_t vertex_properties_, edge_properties_;
+  bool lazy_incoming_ = false;
+  bool encode_edge_properties_ = false;
 
   std::function<void(IIOAdaptor*)> io_deleter_ = [](IIOAdaptor* adaptor) {
     VINEYARD_CHECK_OK(adaptor->Close());
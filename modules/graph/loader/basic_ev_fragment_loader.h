@@ -16,25 +16,64 @@ limitations under the License.
 #ifndef MODULES_GRAPH_LOADER_BASIC_EV_FRAGMENT_LOADER_H_
 #define MODULES_GRAPH_LOADER_BASIC_EV_FRAGMENT_LOADER_H_
 
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <numeric>
 #include <set>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include "grape/worker/comm_spec.h"
 
+#include "basic/ds/arrow_compute.h"
 #include "graph/fragment/arrow_fragment.h"
 #include "graph/fragment/arrow_fragment_group.h"
 #include "graph/fragment/property_graph_types.h"
+#include "graph/loader/fragment_loader_utils.h"
 #include "graph/utils/error.h"
+#include "graph/utils/load_profile.h"
+#include "graph/utils/partitioner.h"
 #include "graph/utils/table_shuffler.h"
 #include "graph/utils/table_shuffler_beta.h"
+#include "graph/utils/thread_group.h"
 #include "graph/vertex_map/arrow_vertex_map.h"
 
 namespace vineyard {
 
+/**
+ * @brief The order of the inner vertices of each label in a fragment, i.e.,
+ * how the local ids are assigned.
+ */
+enum class VertexOrdering {
+  /// the order of the shuffled vertex tables
+  kInput = 0,
+  /// descending degree, which packs the hubs, their properties and their
+  /// entries in the vertex map at the beginning of each label
+  kDegree = 1,
+  /// ascending oid, the vertex map then resolves the oids by searching the
+  /// oid arrays and keeps no hashmaps, which takes about half of the memory,
+  /// only integral oids are supported
+  kOid = 2,
+};
+
+/**
+ * @brief How the edges are distributed over the fragments.
+ */
+enum class EdgePartitioning {
+  /// each edge is stored by the owners of both endpoints
+  kEdgeCut = 0,
+  /// each edge is stored once, by GridEdgePartitioner, and the vertices are
+  /// mirrored as outer vertices where their edges are
+  kVertexCut2D = 1,
+};
+
 template <typename OID_T, typename VID_T, typename PARTITIONER_T>
 class BasicEVFragmentLoader {
   static constexpr int id_column = 0;
@@ -47,6 +86,7 @@ class BasicEVFragmentLoader {
   using vid_t = VID_T;
   using partitioner_t = PARTITIONER_T;
   using oid_array_t = typename vineyard::ConvertToArrowType<oid_t>::ArrayType;
+  using vid_array_t = typename vineyard::ConvertToArrowType<vid_t>::ArrayType;
   using internal_oid_t = typename InternalType<oid_t>::type;
 
  public:
@@ -72,15 +112,16 @@ class BasicEVFragmentLoader {
    */
   boost::leaf::result<void> AddVertexTable(
       const std::string& label, std::shared_ptr<arrow::Table> vertex_table) {
+    auto selection = vertex_properties_.find(label);
+    if (selection != vertex_properties_.end()) {
+      BOOST_LEAF_ASSIGN(vertex_table, SelectProperties(vertex_table, 1,
+                                                       selection->second));
+    }
+    // the tables of a label are concatenated once in ConstructVertices
     if (input_vertex_tables_.find(label) == input_vertex_tables_.end()) {
       vertex_labels_.push_back(label);
-      input_vertex_tables_[label] = vertex_table;
-    } else {
-      std::vector<std::shared_ptr<arrow::Table>> tables;
-      tables.push_back(input_vertex_tables_.at(label));
-      tables.push_back(vertex_table);
-      input_vertex_tables_[label] = ConcatenateTables(tables);
     }
+    input_vertex_tables_[label].push_back(vertex_table);
 
     return {};
   }
@@ -98,7 +139,8 @@ class BasicEVFragmentLoader {
     ordered_vertex_tables_.resize(vertex_label_num_, nullptr);
 
     for (auto& pair : input_vertex_tables_) {
-      ordered_vertex_tables_[vertex_label_to_index_[pair.first]] = pair.second;
+      ordered_vertex_tables_[vertex_label_to_index_[pair.first]] =
+          ConcatenateTables(pair.second);
     }
 
     input_vertex_tables_.clear();
@@ -148,7 +190,11 @@ class BasicEVFragmentLoader {
 
         return tmp_table;
       };
-      BOOST_LEAF_AUTO(table, sync_gs_error(comm_spec_, shuffle_procedure));
+      std::shared_ptr<arrow::Table> table;
+      {
+        LoadProfile::Scope scope(profile_, "shuffle_vertices");
+        BOOST_LEAF_ASSIGN(table, sync_gs_error(comm_spec_, shuffle_procedure));
+      }
 
       auto metadata = std::make_shared<arrow::KeyValueMetadata>();
       metadata->Append("label", vertex_labels_[v_label]);
@@ -157,6 +203,7 @@ class BasicEVFragmentLoader {
       metadata->Append("retain_oid", std::to_string(retain_oid_));
       output_vertex_tables_[v_label] = table->ReplaceSchemaMetadata(metadata);
     }
+    LoadProfile::Scope scope(profile_, "build_vertex_map");
     ObjectID new_vm_id = InvalidObjectID();
     if (vm_id == InvalidObjectID()) {
       BasicArrowVertexMapBuilder<internal_oid_t, vid_t> vm_builder(
@@ -214,6 +261,11 @@ class BasicEVFragmentLoader {
                       "Invalid dst vertex label " + dst_label);
     }
     dst_label_id = iter->second;
+    auto selection = edge_properties_.find(edge_label);
+    if (selection != edge_properties_.end()) {
+      BOOST_LEAF_ASSIGN(edge_table,
+                        SelectProperties(edge_table, 2, selection->second));
+    }
     input_edge_tables_[edge_label].emplace_back(
         std::make_pair(src_label_id, dst_label_id), edge_table);
     if (std::find(std::begin(edge_labels_), std::end(edge_labels_),
@@ -223,35 +275,86 @@ class BasicEVFragmentLoader {
     return {};
   }
 
+  /**
+   * @brief Add a chunk of edges whose oids are resolved to gids against the
+   * vertex map right away, only the resolved chunk is retained, thus the raw
+   * chunks, e.g., the batches pulled from a stream, can be released as soon
+   * as they are added. It must be called after ConstructVertices, and it is
+   * safe to be called concurrently.
+   *
+   * The edge labels that are only added by AddEdgeBatch are numbered after
+   * the ones of AddEdgeTable, in the order of the label names, thus the
+   * numbering is consistent over the workers regardless of the order that
+   * the chunks arrive.
+   */
+  boost::leaf::result<void> AddEdgeBatch(
+      const std::string& src_label, const std::string& dst_label,
+      const std::string& edge_label,
+      std::shared_ptr<arrow::RecordBatch> edge_batch) {
+    if (vm_ptr_ == nullptr) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidOperationError,
+                      "Edge batches can only be added after the vertices "
+                      "have been constructed");
+    }
+    auto src_iter = vertex_label_to_index_.find(src_label);
+    if (src_iter == vertex_label_to_index_.end()) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                      "Invalid src vertex label " + src_label);
+    }
+    auto dst_iter = vertex_label_to_index_.find(dst_label);
+    if (dst_iter == vertex_label_to_index_.end()) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                      "Invalid dst vertex label " + dst_label);
+    }
+    std::shared_ptr<arrow::Table> edge_table;
+    VY_OK_OR_RAISE(RecordBatchesToTable({edge_batch}, &edge_table));
+    auto selection = edge_properties_.find(edge_label);
+    if (selection != edge_properties_.end()) {
+      BOOST_LEAF_ASSIGN(edge_table,
+                        SelectProperties(edge_table, 2, selection->second));
+    }
+    BOOST_LEAF_AUTO(resolved_table, edgesId2Gid(edge_table, src_iter->second,
+                                                dst_iter->second));
+    std::lock_guard<std::mutex> scoped_lock(resolved_edge_tables_mutex_);
+    resolved_edge_tables_[edge_label].emplace_back(
+        std::make_pair(src_iter->second, dst_iter->second), resolved_table);
+    return {};
+  }
+
   boost::leaf::result<std::shared_ptr<arrow::Table>> edgesId2Gid(
       std::shared_ptr<arrow::Table> edge_table, label_id_t src_label,
       label_id_t dst_label) {
+    return edgesId2Gid(
+        edge_table,
+        std::vector<label_id_t>(edge_table->column(src_column)->num_chunks(),
+                                src_label),
+        std::vector<label_id_t>(edge_table->column(dst_column)->num_chunks(),
+                                dst_label));
+  }
+
+  /**
+   * @brief Replace the oids of the edges with gids, where the vertex labels
+   * are given for each chunk of the src and dst columns, thus the tables of
+   * different relations can be resolved in one parallel pass.
+   */
+  boost::leaf::result<std::shared_ptr<arrow::Table>> edgesId2Gid(
+      std::shared_ptr<arrow::Table> edge_table,
+      const std::vector<label_id_t>& src_chunk_labels,
+      const std::vector<label_id_t>& dst_chunk_labels) {
     std::shared_ptr<arrow::Field> src_gid_field =
         std::make_shared<arrow::Field>(
             "src", vineyard::ConvertToArrowType<vid_t>::TypeValue());
     std::shared_ptr<arrow::Field> dst_gid_field =
         std::make_shared<arrow::Field>(
             "dst", vineyard::ConvertToArrowType<vid_t>::TypeValue());
-    auto src_column_type = edge_table->column(src_column)->type();
-    auto dst_column_type = edge_table->column(dst_column)->type();
-
-    if (!src_column_type->Equals(
-            vineyard::ConvertToArrowType<oid_t>::TypeValue())) {
-      RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
-                      "OID_T is not consistent with src id of edge table");
-    }
-    if (!dst_column_type->Equals(
-            vineyard::ConvertToArrowType<oid_t>::TypeValue())) {
-      RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
-                      "OID_T is not consistent with dst id of edge table");
-    }
+    BOOST_LEAF_CHECK(checkOidTypes(edge_table));
 
-    BOOST_LEAF_AUTO(
-        src_gid_array,
-        parseOidChunkedArray(src_label, edge_table->column(src_column)));
-    BOOST_LEAF_AUTO(
-        dst_gid_array,
-        parseOidChunkedArray(dst_label, edge_table->column(dst_column)));
+    BOOST_LEAF_AUTO(src_gid_array,
+                    parseOidChunkedArray(src_chunk_labels,
+                                         edge_table->column(src_column)));
+    BOOST_LEAF_AUTO(dst_gid_array,
+                    parseOidChunkedArray(dst_chunk_labels,
+                                         edge_table->column(dst_column)));
 
     // replace oid columns with gid
 #if defined(ARROW_VERSION) && ARROW_VERSION < 17000
@@ -272,9 +375,17 @@ class BasicEVFragmentLoader {
 
   boost::leaf::result<void> ConstructEdges(int label_offset = 0,
                                            int vertex_label_num = 0) {
+    // includes resolving the oids of the edges to gids
+    LoadProfile::Scope scope(profile_, "shuffle_edges");
     if (vertex_label_num == 0) {
       vertex_label_num = vertex_label_num_;
     }
+    for (auto const& pair : resolved_edge_tables_) {
+      if (std::find(std::begin(edge_labels_), std::end(edge_labels_),
+                    pair.first) == std::end(edge_labels_)) {
+        edge_labels_.push_back(pair.first);
+      }
+    }
     for (size_t i = 0; i < edge_labels_.size(); ++i) {
       edge_label_to_index_[edge_labels_[i]] = i;
     }
@@ -287,8 +398,19 @@ class BasicEVFragmentLoader {
       ordered_edge_tables_[edge_label_to_index_[pair.first]] =
           std::move(pair.second);
     }
+    // the resolved tables follow the raw tables of each label
+    std::vector<size_t> raw_edge_table_nums(edge_label_num_);
+    for (label_id_t e_label = 0; e_label < edge_label_num_; ++e_label) {
+      raw_edge_table_nums[e_label] = ordered_edge_tables_[e_label].size();
+    }
+    for (auto& pair : resolved_edge_tables_) {
+      auto& tables = ordered_edge_tables_[edge_label_to_index_[pair.first]];
+      tables.insert(tables.end(), std::make_move_iterator(pair.second.begin()),
+                    std::make_move_iterator(pair.second.end()));
+    }
 
     input_edge_tables_.clear();
+    resolved_edge_tables_.clear();
 
     if (generate_eid_) {
       generateEdgeId(ordered_edge_tables_, comm_spec_, label_offset);
@@ -318,24 +440,53 @@ class BasicEVFragmentLoader {
     for (label_id_t e_label = 0; e_label < edge_label_num_; ++e_label) {
       auto shuffle_procedure =
           [&]() -> boost::leaf::result<std::shared_ptr<arrow::Table>> {
+        // the tables of all relations are concatenated (the chunks are
+        // shared) and their oids are resolved in a single pass over the
+        // chunks, rather than one table after another
         auto& edge_table_list = ordered_edge_tables_[e_label];
-        std::vector<std::shared_ptr<arrow::Table>> processed_table_list;
-        for (auto& item : edge_table_list) {
-          label_id_t src_label = item.first.first;
-          label_id_t dst_label = item.first.second;
-          auto edge_table = item.second;
-          BOOST_LEAF_AUTO(tmp_table,
-                          edgesId2Gid(edge_table, src_label, dst_label));
-          processed_table_list.push_back(tmp_table);
+        std::vector<std::shared_ptr<arrow::Table>> edge_tables, tables;
+        std::vector<label_id_t> src_chunk_labels, dst_chunk_labels;
+        for (size_t index = 0; index < edge_table_list.size(); ++index) {
+          auto& item = edge_table_list[index];
+          auto& edge_table = item.second;
+          if (index >= raw_edge_table_nums[e_label]) {
+            tables.push_back(edge_table);
+            continue;
+          }
+          BOOST_LEAF_CHECK(checkOidTypes(edge_table));
+          src_chunk_labels.insert(src_chunk_labels.end(),
+                                  edge_table->column(src_column)->num_chunks(),
+                                  item.first.first);
+          dst_chunk_labels.insert(dst_chunk_labels.end(),
+                                  edge_table->column(dst_column)->num_chunks(),
+                                  item.first.second);
+          edge_tables.push_back(edge_table);
         }
-
-        auto table = vineyard::ConcatenateTables(processed_table_list);
-
-        BOOST_LEAF_AUTO(table_out, beta::ShufflePropertyEdgeTable<vid_t>(
-                                       comm_spec_, id_parser, src_column,
-                                       dst_column, table));
-
-        return table_out;
+        if (!edge_tables.empty()) {
+          BOOST_LEAF_AUTO(
+              resolved_table,
+              edgesId2Gid(vineyard::ConcatenateTables(edge_tables),
+                          src_chunk_labels, dst_chunk_labels));
+          tables.insert(tables.begin(), resolved_table);
+        }
+        auto table = vineyard::ConcatenateTables(tables);
+
+        std::shared_ptr<arrow::Table> shuffled_table;
+        if (edge_partitioning_ == EdgePartitioning::kVertexCut2D) {
+          GridEdgePartitioner edge_partitioner;
+          edge_partitioner.Init(comm_spec_.fnum());
+          BOOST_LEAF_ASSIGN(shuffled_table,
+                            beta::ShufflePropertyEdgeTable<vid_t>(
+                                comm_spec_, id_parser, edge_partitioner,
+                                src_column, dst_column, table));
+        } else {
+          BOOST_LEAF_ASSIGN(shuffled_table,
+                            beta::ShufflePropertyEdgeTable<vid_t>(
+                                comm_spec_, id_parser, src_column, dst_column,
+                                table));
+        }
+        table.reset();
+        return spillEdgeTable(e_label, std::move(shuffled_table));
       };
 
       BOOST_LEAF_AUTO(table, sync_gs_error(comm_spec_, shuffle_procedure));
@@ -430,21 +581,99 @@ class BasicEVFragmentLoader {
                                      edge_relations, thread_num);
   }
 
-  boost::leaf::result<ObjectID> ConstructFragment() {
-    BasicArrowFragmentBuilder<oid_t, vid_t> frag_builder(client_, vm_ptr_);
+  /**
+   * @brief Renumber the inner vertices in the given order before the CSR is
+   * built. It only takes effect in ConstructFragment, as the local ids of an
+   * existing fragment can't be changed when adding vertices or edges to it.
+   */
+  void SetVertexOrdering(VertexOrdering ordering) {
+    vertex_ordering_ = ordering;
+  }
 
-    PropertyGraphSchema schema;
-    BOOST_LEAF_CHECK(initSchema(schema));
-    frag_builder.SetPropertyGraphSchema(std::move(schema));
+  /**
+   * @brief Distribute the edges by the given strategy, it must be set before
+   * ConstructEdges. The fragments built from vertex-cut edges are marked by
+   * ArrowFragment::vertex_cut.
+   */
+  void SetEdgePartitioning(EdgePartitioning partitioning) {
+    edge_partitioning_ = partitioning;
+  }
 
-    int thread_num =
-        (std::thread::hardware_concurrency() + comm_spec_.local_num() - 1) /
-        comm_spec_.local_num();
+  /**
+   * @brief Spill the shuffled edges of each label to a local file under the
+   * directory, and keep the memory-mapped file rather than the table, it must
+   * be set before ConstructEdges. The mapped edges are paged in when the CSR
+   * of their label is built, and can be evicted by the kernel otherwise, thus
+   * graphs whose edges exceed the memory can still be loaded.
+   *
+   * An empty directory, the default, keeps the edges in memory.
+   */
+  void SetSpillDirectory(const std::string& spill_directory) {
+    spill_directory_ = spill_directory;
+  }
 
-    BOOST_LEAF_CHECK(frag_builder.Init(
-        comm_spec_.fid(), comm_spec_.fnum(), std::move(output_vertex_tables_),
-        std::move(output_edge_tables_), directed_, thread_num));
+  /**
+   * @brief Record the time and memory usage of the loading phases into the
+   * given profile, a null profile, the default, records nothing.
+   */
+  void SetLoadProfile(std::shared_ptr<LoadProfile> profile) {
+    profile_ = profile;
+  }
+
+  /**
+   * @brief Load only the given properties of the vertex and edge labels, in
+   * the given order, the other columns of the added tables are dropped before
+   * they are shuffled. The labels that are not listed keep all properties. It
+   * must be set before the tables are added.
+   */
+  void SetSelectedProperties(property_selection_t const& vertex_properties,
+                             property_selection_t const& edge_properties) {
+    vertex_properties_ = vertex_properties;
+    edge_properties_ = edge_properties;
+  }
+
+  /**
+   * @brief Build the incoming edges of a directed fragment on their first
+   * access rather than when the fragment is built, see
+   * ArrowFragmentBuilder::set_lazy_incoming.
+   */
+  void SetLazyIncoming(bool lazy_incoming) { lazy_incoming_ = lazy_incoming; }
+
+  /**
+   * @brief Seal the numeric edge properties in an encoding, see
+   * ArrowFragmentBuilder::set_encode_edge_properties.
+   */
+  void SetEncodeEdgeProperties(bool encode_edge_properties) {
+    encode_edge_properties_ = encode_edge_properties;
+  }
+
+  boost::leaf::result<ObjectID> ConstructFragment() {
+    if (vertex_ordering_ != VertexOrdering::kInput) {
+      LoadProfile::Scope scope(profile_, "reorder_vertices");
+      BOOST_LEAF_CHECK(reorderVertices());
+    }
+    BasicArrowFragmentBuilder<oid_t, vid_t> frag_builder(client_, vm_ptr_);
+    frag_builder.set_vertex_cut(edge_partitioning_ ==
+                                EdgePartitioning::kVertexCut2D);
+    frag_builder.set_lazy_incoming(lazy_incoming_);
+    frag_builder.set_encode_edge_properties(encode_edge_properties_);
+
+    {
+      LoadProfile::Scope scope(profile_, "build_csr");
+      PropertyGraphSchema schema;
+      BOOST_LEAF_CHECK(initSchema(schema));
+      frag_builder.SetPropertyGraphSchema(std::move(schema));
+
+      int thread_num =
+          (std::thread::hardware_concurrency() + comm_spec_.local_num() - 1) /
+          comm_spec_.local_num();
+
+      BOOST_LEAF_CHECK(frag_builder.Init(
+          comm_spec_.fid(), comm_spec_.fnum(), std::move(output_vertex_tables_),
+          std::move(output_edge_tables_), directed_, thread_num));
+    }
 
+    LoadProfile::Scope scope(profile_, "seal_fragment");
     auto frag = std::dynamic_pointer_cast<ArrowFragment<oid_t, vid_t>>(
         frag_builder.Seal(client_));
 
@@ -465,9 +694,61 @@ class BasicEVFragmentLoader {
   }
 
  private:
+  /**
+   * @brief See SetSpillDirectory. The file is removed once it is mapped, the
+   * mapping keeps the pages until the table is released.
+   */
+  boost::leaf::result<std::shared_ptr<arrow::Table>> spillEdgeTable(
+      label_id_t e_label, std::shared_ptr<arrow::Table> table) {
+    if (spill_directory_.empty()) {
+      return table;
+    }
+    std::string path = spill_directory_ + "/vineyard-edges-" +
+                       std::to_string(getpid()) + "-" +
+                       std::to_string(comm_spec_.worker_id()) + "-" +
+                       std::to_string(e_label) + ".arrow";
+    VY_OK_OR_RAISE(WriteTableToFile(table, path));
+    table.reset();
+    std::shared_ptr<arrow::Table> mapped_table;
+    auto status = MapTableFromFile(path, &mapped_table);
+    std::remove(path.c_str());
+    VY_OK_OR_RAISE(status);
+    return mapped_table;
+  }
+
+  boost::leaf::result<void> checkOidTypes(
+      const std::shared_ptr<arrow::Table>& edge_table) {
+    auto src_column_type = edge_table->column(src_column)->type();
+    auto dst_column_type = edge_table->column(dst_column)->type();
+
+    if (!src_column_type->Equals(
+            vineyard::ConvertToArrowType<oid_t>::TypeValue())) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                      "OID_T is not consistent with src id of edge table");
+    }
+    if (!dst_column_type->Equals(
+            vineyard::ConvertToArrowType<oid_t>::TypeValue())) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                      "OID_T is not consistent with dst id of edge table");
+    }
+    return {};
+  }
+
   boost::leaf::result<std::shared_ptr<arrow::ChunkedArray>>
   parseOidChunkedArray(label_id_t label_id,
                        std::shared_ptr<arrow::ChunkedArray> oid_arrays_in) {
+    return parseOidChunkedArray(
+        std::vector<label_id_t>(oid_arrays_in->num_chunks(), label_id),
+        oid_arrays_in);
+  }
+
+  /**
+   * @brief Resolve the oids of each chunk with the vertex label of the chunk,
+   * the chunks are distributed over the threads.
+   */
+  boost::leaf::result<std::shared_ptr<arrow::ChunkedArray>>
+  parseOidChunkedArray(const std::vector<label_id_t>& chunk_labels,
+                       std::shared_ptr<arrow::ChunkedArray> oid_arrays_in) {
     size_t chunk_num = oid_arrays_in->num_chunks();
     std::vector<std::shared_ptr<arrow::Array>> chunks_out(chunk_num);
 
@@ -484,72 +765,254 @@ class BasicEVFragmentLoader {
       for (size_t i = 0; i != size; ++i) {
         internal_oid_t oid = oid_array->GetView(i);
         fid_t fid = partitioner_.GetPartitionId(oid_t(oid));
-        CHECK_OR_RAISE(vm->GetGid(fid, label_id, oid, builder[i]));
+        CHECK_OR_RAISE(vm->GetGid(fid, chunk_labels[chunk_i], oid, builder[i]));
       }
       ARROW_OK_OR_RAISE(builder.Advance(size));
       ARROW_OK_OR_RAISE(builder.Finish(&chunks_out[chunk_i]));
     }
 #else
+    // a single chunk, e.g., of AddEdgeBatch, doesn't occupy idle workers
+    int thread_num = std::min(
+        chunk_num,
+        static_cast<size_t>((std::thread::hardware_concurrency() +
+                             comm_spec_.local_num() - 1) /
+                            comm_spec_.local_num()));
+    auto status = ParallelFor(
+        chunk_num,
+        [&](size_t const got) -> Status {
+          std::shared_ptr<oid_array_t> oid_array =
+              std::dynamic_pointer_cast<oid_array_t>(
+                  oid_arrays_in->chunk(got));
+          typename ConvertToArrowType<vid_t>::BuilderType builder;
+          size_t size = oid_array->length();
+
+          RETURN_ON_ARROW_ERROR(builder.Resize(size));
+
+          // group the oids by fragment and lookup them in batches
+          fid_t fnum = comm_spec_.fnum();
+          std::vector<fid_t> fids(size);
+          std::vector<size_t> offsets(fnum + 1, 0);
+          partitioner_.GetPartitionIds(*oid_array, fids.data());
+          for (size_t k = 0; k != size; ++k) {
+            ++offsets[fids[k] + 1];
+          }
+          for (fid_t fid = 0; fid < fnum; ++fid) {
+            offsets[fid + 1] += offsets[fid];
+          }
+          std::vector<size_t> order(size);
+          std::vector<internal_oid_t> oids(size);
+          {
+            std::vector<size_t> cursors(offsets.begin(), offsets.end() - 1);
+            for (size_t k = 0; k != size; ++k) {
+              size_t pos = cursors[fids[k]]++;
+              order[pos] = k;
+              oids[pos] = oid_array->GetView(k);
+            }
+          }
+          std::vector<vid_t> gids(size);
+          std::unique_ptr<bool[]> found(new bool[size]);
+          for (fid_t fid = 0; fid < fnum; ++fid) {
+            vm->GetGids(fid, chunk_labels[got], oids.data() + offsets[fid],
+                        offsets[fid + 1] - offsets[fid],
+                        gids.data() + offsets[fid],
+                        found.get() + offsets[fid]);
+          }
+          for (size_t pos = 0; pos != size; ++pos) {
+            if (found[pos]) {
+              builder[order[pos]] = gids[pos];
+            } else {
+              LOG(ERROR) << "Mapping vertex " << oids[pos] << " failed.";
+            }
+          }
+
+          RETURN_ON_ARROW_ERROR(builder.Advance(size));
+          RETURN_ON_ARROW_ERROR(builder.Finish(&chunks_out[got]));
+          return Status::OK();
+        },
+        thread_num);
+    if (!status.ok()) {
+      RETURN_GS_ERROR(ErrorCode::kArrowError, status.ToString());
+    }
+#endif
+
+    return std::make_shared<arrow::ChunkedArray>(chunks_out);
+  }
+
+  /**
+   * @brief Renumber the inner vertices of every label by descending degree,
+   * counted over the shuffled edge tables, or by ascending oid, then rebuild
+   * the vertex map from the renumbered oids of all fragments and rewrite the
+   * gids of the edges.
+   *
+   * It is a collective operation, the new offsets of every fragment are
+   * gathered to remap the outer vertices as well.
+   */
+  boost::leaf::result<void> reorderVertices() {
+    fid_t fid = comm_spec_.fid(), fnum = comm_spec_.fnum();
     int thread_num =
         (std::thread::hardware_concurrency() + comm_spec_.local_num() - 1) /
         comm_spec_.local_num();
-    std::vector<std::thread> parse_threads(thread_num);
-
-    std::atomic<size_t> cur(0);
-    std::vector<arrow::Status> statuses(thread_num, arrow::Status::OK());
-    for (int i = 0; i < thread_num; ++i) {
-      parse_threads[i] = std::thread(
-          [&](int tid) {
-            while (true) {
-              auto got = cur.fetch_add(1);
-              if (got >= chunk_num) {
-                break;
-              }
-              std::shared_ptr<oid_array_t> oid_array =
-                  std::dynamic_pointer_cast<oid_array_t>(
-                      oid_arrays_in->chunk(got));
-              typename ConvertToArrowType<vid_t>::BuilderType builder;
-              size_t size = oid_array->length();
-
-              arrow::Status status = builder.Resize(size);
-              if (!status.ok()) {
-                statuses[tid] = status;
-                return;
-              }
-
-              for (size_t k = 0; k != size; ++k) {
-                internal_oid_t oid = oid_array->GetView(k);
-                fid_t fid = partitioner_.GetPartitionId(oid_t(oid));
-                if (!vm->GetGid(fid, label_id, oid, builder[k])) {
-                  LOG(ERROR) << "Mapping vertex " << oid << " failed.";
-                }
-              }
-
-              status = builder.Advance(size);
-              if (!status.ok()) {
-                statuses[tid] = status;
-                return;
-              }
-              status = builder.Finish(&chunks_out[got]);
-              if (!status.ok()) {
-                statuses[tid] = status;
-                return;
-              }
-            }
-          },
-          i);
+    vineyard::IdParser<vid_t> id_parser;
+    id_parser.Init(fnum, vertex_label_num_);
+
+    if (vertex_ordering_ == VertexOrdering::kOid &&
+        !std::is_integral<internal_oid_t>::value) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                      "Ordering vertices by oid requires integral oids");
+    }
+
+    std::vector<std::vector<int>> degrees(vertex_label_num_);
+    for (label_id_t v_label = 0; v_label < vertex_label_num_; ++v_label) {
+      degrees[v_label].resize(vm_ptr_->GetInnerVertexSize(fid, v_label), 0);
     }
-    for (auto& thrd : parse_threads) {
-      thrd.join();
+    if (vertex_ordering_ == VertexOrdering::kDegree) {
+      for (auto const& table : output_edge_tables_) {
+        for (int column : {src_column, dst_column}) {
+          for (auto const& chunk : table->column(column)->chunks()) {
+            const vid_t* gids =
+                std::dynamic_pointer_cast<vid_array_t>(chunk)->raw_values();
+            parallel_for(
+                static_cast<int64_t>(0), chunk->length(),
+                [&](int64_t i) {
+                  if (id_parser.GetFid(gids[i]) == fid) {
+                    grape::atomic_add(degrees[id_parser.GetLabelId(gids[i])]
+                                             [id_parser.GetOffset(gids[i])],
+                                      1);
+                  }
+                },
+                thread_num);
+          }
+        }
+      }
     }
-    for (auto& status : statuses) {
-      if (!status.ok()) {
-        RETURN_GS_ERROR(ErrorCode::kArrowError, status.ToString());
+
+    std::vector<std::vector<std::shared_ptr<oid_array_t>>> oid_lists(
+        vertex_label_num_);
+    // new_offsets[v_label][fid][old offset] is the new offset
+    std::vector<std::vector<std::shared_ptr<vid_array_t>>> new_offsets(
+        vertex_label_num_);
+    for (label_id_t v_label = 0; v_label < vertex_label_num_; ++v_label) {
+      auto const& degree = degrees[v_label];
+      SelectionVector order(degree.size());
+      std::iota(order.begin(), order.end(), 0);
+      if (vertex_ordering_ == VertexOrdering::kOid) {
+        auto oids = vm_ptr_->GetOidArray(fid, v_label);
+        std::stable_sort(order.begin(), order.end(),
+                         [&oids](int64_t lhs, int64_t rhs) {
+                           return oids->GetView(lhs) < oids->GetView(rhs);
+                         });
+      } else {
+        std::stable_sort(order.begin(), order.end(),
+                         [&degree](int64_t lhs, int64_t rhs) {
+                           return degree[lhs] > degree[rhs];
+                         });
+      }
+
+      typename ConvertToArrowType<vid_t>::BuilderType builder;
+      ARROW_OK_OR_RAISE(builder.Resize(order.size()));
+      for (size_t i = 0; i < order.size(); ++i) {
+        builder[order[i]] = static_cast<vid_t>(i);
       }
+      ARROW_OK_OR_RAISE(builder.Advance(order.size()));
+      std::shared_ptr<vid_array_t> local_new_offsets;
+      ARROW_OK_OR_RAISE(builder.Finish(&local_new_offsets));
+      VY_OK_OR_RAISE(FragmentAllGatherArray<vid_t>(
+          comm_spec_, local_new_offsets, new_offsets[v_label]));
+
+      std::shared_ptr<arrow::Array> local_oids;
+      VY_OK_OR_RAISE(
+          Take(vm_ptr_->GetOidArray(fid, v_label), order, local_oids));
+      VY_OK_OR_RAISE(FragmentAllGatherArray<oid_t>(
+          comm_spec_, std::dynamic_pointer_cast<oid_array_t>(local_oids),
+          oid_lists[v_label]));
+
+      BOOST_LEAF_AUTO(table, takeRows(output_vertex_tables_[v_label], order));
+      output_vertex_tables_[v_label] = table;
     }
+
+    ObjectID old_vm_id = vm_ptr_->id();
+    vm_ptr_ = sealVertexMap(oid_lists, std::is_integral<internal_oid_t>());
+    VINEYARD_DISCARD(client_.DelData(old_vm_id));
+
+    for (auto& table : output_edge_tables_) {
+      for (int column : {src_column, dst_column}) {
+        std::vector<std::shared_ptr<arrow::Array>> chunks;
+        for (auto const& chunk : table->column(column)->chunks()) {
+          const vid_t* gids =
+              std::dynamic_pointer_cast<vid_array_t>(chunk)->raw_values();
+          typename ConvertToArrowType<vid_t>::BuilderType builder;
+          ARROW_OK_OR_RAISE(builder.Resize(chunk->length()));
+          parallel_for(
+              static_cast<int64_t>(0), chunk->length(),
+              [&](int64_t i) {
+                fid_t gid_fid = id_parser.GetFid(gids[i]);
+                label_id_t label = id_parser.GetLabelId(gids[i]);
+                builder[i] = id_parser.GenerateId(
+                    gid_fid, label,
+                    new_offsets[label][gid_fid]->Value(
+                        id_parser.GetOffset(gids[i])));
+              },
+              thread_num);
+          ARROW_OK_OR_RAISE(builder.Advance(chunk->length()));
+          std::shared_ptr<arrow::Array> relabeled;
+          ARROW_OK_OR_RAISE(builder.Finish(&relabeled));
+          chunks.push_back(relabeled);
+        }
+        auto relabeled = std::make_shared<arrow::ChunkedArray>(
+            chunks, ConvertToArrowType<vid_t>::TypeValue());
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+        ARROW_OK_OR_RAISE(table->SetColumn(
+            column, table->schema()->field(column), relabeled, &table));
+#else
+        ARROW_OK_ASSIGN_OR_RAISE(
+            table, table->SetColumn(column, table->schema()->field(column),
+                                    relabeled));
 #endif
+      }
+    }
+    return {};
+  }
 
-    return std::make_shared<arrow::ChunkedArray>(chunks_out);
+  std::shared_ptr<ArrowVertexMap<internal_oid_t, vid_t>> sealVertexMap(
+      const std::vector<std::vector<std::shared_ptr<oid_array_t>>>& oid_lists,
+      std::true_type) {
+    BasicArrowVertexMapBuilder<internal_oid_t, vid_t> vm_builder(
+        client_, comm_spec_.fnum(), vertex_label_num_, oid_lists, false,
+        vertex_ordering_ == VertexOrdering::kOid);
+    return std::dynamic_pointer_cast<ArrowVertexMap<internal_oid_t, vid_t>>(
+        vm_builder.Seal(client_));
+  }
+
+  std::shared_ptr<ArrowVertexMap<internal_oid_t, vid_t>> sealVertexMap(
+      const std::vector<std::vector<std::shared_ptr<oid_array_t>>>& oid_lists,
+      std::false_type) {
+    BasicArrowVertexMapBuilder<internal_oid_t, vid_t> vm_builder(
+        client_, comm_spec_.fnum(), vertex_label_num_, oid_lists);
+    return std::dynamic_pointer_cast<ArrowVertexMap<internal_oid_t, vid_t>>(
+        vm_builder.Seal(client_));
+  }
+
+  boost::leaf::result<std::shared_ptr<arrow::Table>> takeRows(
+      std::shared_ptr<arrow::Table> const& table,
+      SelectionVector const& order) {
+    std::shared_ptr<arrow::Table> combined_table;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+    ARROW_OK_OR_RAISE(
+        table->CombineChunks(arrow::default_memory_pool(), &combined_table));
+#else
+    ARROW_OK_ASSIGN_OR_RAISE(
+        combined_table, table->CombineChunks(arrow::default_memory_pool()));
+#endif
+    if (combined_table->num_rows() == 0) {
+      return combined_table;
+    }
+    std::vector<std::shared_ptr<arrow::Array>> columns;
+    for (int i = 0; i < combined_table->num_columns(); ++i) {
+      std::shared_ptr<arrow::Array> column;
+      VY_OK_OR_RAISE(Take(combined_table->column(i)->chunk(0), order, column));
+      columns.push_back(column);
+    }
+    return arrow::Table::Make(combined_table->schema(), columns);
   }
 
   boost::leaf::result<void> initSchema(PropertyGraphSchema& schema) {
@@ -657,16 +1120,28 @@ class BasicEVFragmentLoader {
   bool directed_;
   bool retain_oid_;
   bool generate_eid_;
+  VertexOrdering vertex_ordering_ = VertexOrdering::kInput;
+  EdgePartitioning edge_partitioning_ = EdgePartitioning::kEdgeCut;
+  std::string spill_directory_;
+  std::shared_ptr<LoadProfile> profile_;
+  property_selection_t vertex_properties_, edge_properties_;
+  bool lazy_incoming_ = false;
+  bool encode_edge_properties_ = false;
 
   std::map<std::string, label_id_t> vertex_label_to_index_;
   std::vector<std::string> vertex_labels_;
   std::map<std::string, label_id_t> edge_label_to_index_;
   std::vector<std::string> edge_labels_;
 
-  std::map<std::string, std::shared_ptr<arrow::Table>> input_vertex_tables_;
+  std::map<std::string, std::vector<std::shared_ptr<arrow::Table>>>
+      input_vertex_tables_;
   std::map<std::string, std::vector<std::pair<std::pair<label_id_t, label_id_t>,
                                               std::shared_ptr<arrow::Table>>>>
       input_edge_tables_;
+  std::map<std::string, std::vector<std::pair<std::pair<label_id_t, label_id_t>,
+                                              std::shared_ptr<arrow::Table>>>>
+      resolved_edge_tables_;
+  std::mutex resolved_edge_tables_mutex_;
 
   std::vector<std::shared_ptr<arrow::Table>> ordered_vertex_tables_;
   std::vector<std::vector<std::pair<std::pair<label_id_t, label_id_t>,
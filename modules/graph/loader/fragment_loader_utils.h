@@ -91,6 +91,50 @@ struct InputTable {
   std::shared_ptr<arrow::Table> table;
 };
 
+/**
+ * @brief The properties to load of each label, the labels that are not listed
+ * keep all of their properties.
+ */
+using property_selection_t = std::map<std::string, std::vector<std::string>>;
+
+/**
+ * @brief Keep the leading `key_columns` columns, i.e., the id column of a
+ * vertex table or the src and dst columns of an edge table, and then the
+ * given properties in the given order. The columns are not copied and the
+ * metadata of the schema is retained.
+ */
+inline boost::leaf::result<std::shared_ptr<arrow::Table>> SelectProperties(
+    std::shared_ptr<arrow::Table> const& table, int const key_columns,
+    std::vector<std::string> const& properties) {
+  if (table == nullptr) {
+    return table;
+  }
+  if (table->num_columns() < key_columns) {
+    RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                    "The table has less than " + std::to_string(key_columns) +
+                        " columns: " + table->schema()->ToString());
+  }
+  std::vector<std::shared_ptr<arrow::Field>> fields;
+  std::vector<std::shared_ptr<arrow::ChunkedArray>> columns;
+  for (int index = 0; index < key_columns; ++index) {
+    fields.emplace_back(table->schema()->field(index));
+    columns.emplace_back(table->column(index));
+  }
+  for (auto const& property : properties) {
+    int index = table->schema()->GetFieldIndex(property);
+    if (index < key_columns) {
+      RETURN_GS_ERROR(ErrorCode::kInvalidValueError,
+                      "'" + property + "' isn't a property of " +
+                          table->schema()->ToString());
+    }
+    fields.emplace_back(table->schema()->field(index));
+    columns.emplace_back(table->column(index));
+  }
+  return arrow::Table::Make(
+      arrow::schema(fields, table->schema()->metadata()), columns,
+      table->num_rows());
+}
+
 template <typename OID_T, typename VID_T, typename PARTITIONER_T>
 class FragmentLoaderUtils {
   static constexpr int src_column = 0;
@@ -0,0 +1,103 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "graph/fragment/adj_list_intersection.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using vid_t = uint64_t;
+using eid_t = uint64_t;
+using unit_t = property_graph_utils::NbrUnit<vid_t, eid_t>;
+using adj_list_t = property_graph_utils::RawAdjList<vid_t, eid_t>;
+
+// A sorted adjacency list of `size` neighbors drawn from [0, range), with
+// parallel edges when `size` exceeds `range`.
+std::vector<unit_t> makeUnits(size_t size, vid_t range, eid_t first_eid,
+                              std::mt19937& gen) {
+  std::uniform_int_distribution<vid_t> dist(0, range - 1);
+  std::vector<vid_t> vids(size);
+  for (auto& vid : vids) {
+    vid = dist(gen);
+  }
+  std::sort(vids.begin(), vids.end());
+  std::vector<unit_t> units;
+  for (size_t index = 0; index < size; ++index) {
+    units.emplace_back(vids[index], first_eid + index);
+  }
+  return units;
+}
+
+void checkIntersection(std::vector<unit_t> const& lhs,
+                       std::vector<unit_t> const& rhs) {
+  std::vector<vid_t> lhs_vids, rhs_vids, expected;
+  for (auto const& unit : lhs) {
+    lhs_vids.push_back(unit.vid);
+  }
+  for (auto const& unit : rhs) {
+    rhs_vids.push_back(unit.vid);
+  }
+  std::set_intersection(lhs_vids.begin(), lhs_vids.end(), rhs_vids.begin(),
+                        rhs_vids.end(), std::back_inserter(expected));
+
+  adj_list_t lhs_list(lhs.data(), lhs.data() + lhs.size());
+  adj_list_t rhs_list(rhs.data(), rhs.data() + rhs.size());
+  std::vector<vid_t> actual;
+  property_graph_utils::IntersectAdjList(
+      lhs_list, rhs_list, [&](const unit_t& l, const unit_t& r) {
+        // the units come from the respective lists
+        CHECK(&l >= lhs_list.begin() && &l < lhs_list.end());
+        CHECK(&r >= rhs_list.begin() && &r < rhs_list.end());
+        CHECK_EQ(l.vid, r.vid);
+        actual.push_back(l.vid);
+      });
+  CHECK(actual == expected);
+  CHECK_EQ(property_graph_utils::IntersectionSize(lhs_list, rhs_list),
+           expected.size());
+  CHECK_EQ(property_graph_utils::IntersectionSize(rhs_list, lhs_list),
+           expected.size());
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./adj_list_intersection_test <ipc_socket>");
+    return 1;
+  }
+
+  std::mt19937 gen(2021);
+  // merged, galloped, and with parallel edges, in both directions
+  std::vector<std::pair<size_t, size_t>> sizes = {
+      {0, 0}, {0, 100}, {1, 1}, {7, 13}, {1000, 1000}, {100, 2999},
+      {3, 100000}, {50, 50000}};
+  for (vid_t range : {16, 1000, 1000000}) {
+    for (auto const& size : sizes) {
+      auto lhs = makeUnits(size.first, range, 0, gen);
+      auto rhs = makeUnits(size.second, range, size.first, gen);
+      checkIntersection(lhs, rhs);
+      checkIntersection(rhs, lhs);
+    }
+  }
+  LOG(INFO) << "Passed adjacency list intersection tests...";
+  return 0;
+}
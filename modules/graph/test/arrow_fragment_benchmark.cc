@@ -0,0 +1,303 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "client/client.h"
+#include "common/util/env.h"
+#include "common/util/functions.h"
+#include "common/util/json.h"
+
+#include "graph/fragment/arrow_fragment.h"
+#include "graph/fragment/arrow_fragment_group.h"
+#include "graph/loader/arrow_fragment_loader.h"
+#include "graph/utils/load_profile.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using GraphType = ArrowFragment<property_graph_types::OID_TYPE,
+                                property_graph_types::VID_TYPE>;
+using LabelType = typename GraphType::label_id_t;
+
+/**
+ * @brief Generates a vertex file and an R-MAT edge file, whose skewed degree
+ * distribution resembles the social graphs, e.g., LDBC, the ids are
+ * scrambled so that the hubs are spread over the fragments.
+ */
+void GenerateGraph(std::string const& directory, int64_t vertices,
+                   int64_t edges) {
+  std::mt19937_64 rng(20210101);
+  int scale = 0;
+  while ((int64_t(1) << scale) < vertices) {
+    scale += 1;
+  }
+  std::vector<int64_t> permutation(vertices);
+  for (int64_t i = 0; i < vertices; ++i) {
+    permutation[i] = i;
+  }
+  std::shuffle(permutation.begin(), permutation.end(), rng);
+
+  std::ofstream vfile(directory + "/person.csv");
+  vfile << "id,rank\n";
+  for (int64_t i = 0; i < vertices; ++i) {
+    vfile << i << "," << rng() % 1000 << "\n";
+  }
+  vfile.close();
+
+  // the quadrant probabilities of graph500
+  std::uniform_real_distribution<double> uniform(0, 1);
+  const double a = 0.57, b = 0.19, c = 0.19;
+  std::ofstream efile(directory + "/knows.csv");
+  efile << "src,dst,weight\n";
+  for (int64_t i = 0; i < edges; ++i) {
+    int64_t src = 0, dst = 0;
+    for (int bit = 0; bit < scale; ++bit) {
+      double p = uniform(rng);
+      src = (src << 1) | (p >= a + b);
+      dst = (dst << 1) | ((p >= a && p < a + b) || p >= a + b + c);
+    }
+    efile << permutation[src % vertices] << ","
+          << permutation[dst % vertices] << "," << uniform(rng) << "\n";
+  }
+  efile.close();
+}
+
+/**
+ * @brief Gathers the reports of all workers to worker 0.
+ */
+std::vector<json> GatherReports(const grape::CommSpec& comm_spec,
+                                json const& report) {
+  std::string local = report.dump();
+  int length = local.size();
+  std::vector<int> lengths(comm_spec.worker_num());
+  MPI_Gather(&length, 1, MPI_INT, lengths.data(), 1, MPI_INT, 0,
+             comm_spec.comm());
+  std::vector<int> offsets(comm_spec.worker_num() + 1, 0);
+  for (int i = 0; i < comm_spec.worker_num(); ++i) {
+    offsets[i + 1] = offsets[i] + lengths[i];
+  }
+  std::string gathered(offsets.back(), '\0');
+  MPI_Gatherv(&local[0], length, MPI_CHAR, &gathered[0], lengths.data(),
+              offsets.data(), MPI_CHAR, 0, comm_spec.comm());
+
+  std::vector<json> reports;
+  if (comm_spec.worker_id() == 0) {
+    for (int i = 0; i < comm_spec.worker_num(); ++i) {
+      reports.emplace_back(
+          json::parse(gathered.substr(offsets[i], lengths[i])));
+    }
+  }
+  return reports;
+}
+
+/**
+ * @brief The minimum, maximum and mean of the time of each phase across the
+ * workers, the slowest worker of a phase bounds the loading time.
+ */
+json SummarizePhases(std::vector<json> const& reports) {
+  json summary = json::object();
+  for (auto const& report : reports) {
+    for (auto const& phase : report["phases"]) {
+      std::string name = phase["name"].get<std::string>();
+      double seconds = phase["seconds"].get<double>();
+      if (summary.find(name) == summary.end()) {
+        summary[name] = json{{"min", seconds}, {"max", seconds}, {"sum", 0.0}};
+      }
+      auto& item = summary[name];
+      item["min"] = std::min(item["min"].get<double>(), seconds);
+      item["max"] = std::max(item["max"].get<double>(), seconds);
+      item["sum"] = item["sum"].get<double>() + seconds;
+    }
+  }
+  for (auto& item : summary) {
+    item["mean"] = item["sum"].get<double>() / reports.size();
+    item.erase("sum");
+  }
+  return summary;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 6) {
+    printf(
+        "usage: ./arrow_fragment_benchmark <ipc_socket> <report.json> "
+        "synthetic <vertices> <edges> [directed]\n"
+        "       ./arrow_fragment_benchmark <ipc_socket> <report.json> "
+        "files <e_label_num> <efiles...> <v_label_num> <vfiles...> "
+        "[directed]\n");
+    return 1;
+  }
+  int index = 1;
+  std::string ipc_socket = std::string(argv[index++]);
+  std::string report_path = std::string(argv[index++]);
+  std::string mode = std::string(argv[index++]);
+
+  int64_t vertices = 0, edges = 0;
+  std::vector<std::string> efiles, vfiles;
+  if (mode == "synthetic") {
+    vertices = atoll(argv[index++]);
+    edges = atoll(argv[index++]);
+  } else {
+    int edge_label_num = atoi(argv[index++]);
+    for (int i = 0; i < edge_label_num; ++i) {
+      efiles.push_back(argv[index++]);
+    }
+    int vertex_label_num = atoi(argv[index++]);
+    for (int i = 0; i < vertex_label_num; ++i) {
+      vfiles.push_back(argv[index++]);
+    }
+  }
+  int directed = 1;
+  if (argc > index) {
+    directed = atoi(argv[index]);
+  }
+
+  vineyard::Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  grape::InitMPIComm();
+
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    std::string directory;
+    if (mode == "synthetic") {
+      // the same graph is generated by one worker on each host
+      int token = get_pid();
+      MPI_Bcast(&token, 1, MPI_INT, 0, comm_spec.comm());
+      directory = "/tmp/vineyard-graph-benchmark-" + std::to_string(token);
+      if (comm_spec.local_id() == 0) {
+        PCHECK(mkdir(directory.c_str(), 0755) == 0 || errno == EEXIST);
+        double t = -GetCurrentTime();
+        GenerateGraph(directory, vertices, edges);
+        t += GetCurrentTime();
+        LOG(INFO) << "[worker-" << comm_spec.worker_id()
+                  << "] generated the graph in " << t << " seconds";
+      }
+      MPI_Barrier(comm_spec.comm());
+      efiles.push_back(directory +
+                       "/knows.csv#header_row=true&delimiter=,"
+                       "&src_label=person&dst_label=person&label=knows");
+      vfiles.push_back(directory +
+                       "/person.csv#header_row=true&delimiter=,"
+                       "&label=person");
+    }
+
+    auto profile = std::make_shared<LoadProfile>();
+    MPI_Barrier(comm_spec.comm());
+    double t = -GetCurrentTime();
+    vineyard::ObjectID fragment_id = InvalidObjectID(),
+                       fragment_group_id = InvalidObjectID();
+    {
+      auto loader =
+          std::make_unique<ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                               property_graph_types::VID_TYPE>>(
+              client, comm_spec, efiles, vfiles, directed != 0);
+      loader->SetLoadProfile(profile);
+      fragment_id = boost::leaf::try_handle_all(
+          [&loader]() { return loader->LoadFragment(); },
+          [](const GSError& e) {
+            LOG(FATAL) << e.error_msg;
+            return 0;
+          },
+          [](const boost::leaf::error_info& unmatched) {
+            LOG(FATAL) << "Unmatched error " << unmatched;
+            return 0;
+          });
+    }
+    {
+      LoadProfile::Scope scope(profile, "build_fragment_group");
+      fragment_group_id = boost::leaf::try_handle_all(
+          [&]() {
+            return ConstructFragmentGroup(client, fragment_id, comm_spec);
+          },
+          [](const GSError& e) {
+            LOG(FATAL) << e.error_msg;
+            return 0;
+          },
+          [](const boost::leaf::error_info& unmatched) {
+            LOG(FATAL) << "Unmatched error " << unmatched;
+            return 0;
+          });
+    }
+    t += GetCurrentTime();
+
+    auto frag =
+        std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+    size_t inner_vertices = 0;
+    for (LabelType label = 0; label < frag->vertex_label_num(); ++label) {
+      inner_vertices += frag->GetInnerVerticesNum(label);
+    }
+    json report = {{"worker", comm_spec.worker_id()},
+                   {"hostname", get_hostname()},
+                   {"fid", frag->fid()},
+                   {"fragment", ObjectIDToString(fragment_id)},
+                   {"seconds", t},
+                   {"inner_vertices", inner_vertices},
+                   {"edges", frag->GetEdgeNum()},
+                   {"peak_rss", get_peek_rss()},
+                   {"phases", profile->ToJSON()}};
+
+    auto reports = GatherReports(comm_spec, report);
+    if (comm_spec.worker_id() == 0) {
+      double seconds = 0;
+      for (auto const& item : reports) {
+        seconds = std::max(seconds, item["seconds"].get<double>());
+      }
+      json result = {{"workers", comm_spec.worker_num()},
+                     {"mode", mode},
+                     {"efiles", efiles},
+                     {"vfiles", vfiles},
+                     {"directed", directed != 0},
+                     {"fragment_group", ObjectIDToString(fragment_group_id)},
+                     {"seconds", seconds},
+                     {"summary", SummarizePhases(reports)},
+                     {"reports", reports}};
+      std::ofstream fout(report_path);
+      fout << result.dump(2) << std::endl;
+      fout.close();
+      LOG(INFO) << "loading time: " << seconds << ", report is written to "
+                << report_path;
+    }
+
+    if (mode == "synthetic") {
+      MPI_Barrier(comm_spec.comm());
+      if (comm_spec.local_id() == 0) {
+        unlink((directory + "/person.csv").c_str());
+        unlink((directory + "/knows.csv").c_str());
+        rmdir(directory.c_str());
+      }
+    }
+  }
+  grape::FinalizeMPIComm();
+
+  LOG(INFO) << "Passed arrow fragment benchmark...";
+
+  return 0;
+}
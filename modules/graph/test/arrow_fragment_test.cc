@@ -14,15 +14,28 @@ limitations under the License.
 */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
 
+#include <algorithm>
 #include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "glog/logging.h"
 
+#include "basic/stream/dataframe_stream.h"
+#include "basic/stream/parallel_stream.h"
 #include "client/client.h"
+#include "io/io/io_factory.h"
 
 #include "graph/fragment/arrow_fragment.h"
+#include "graph/fragment/arrow_fragment_exporter.h"
 #include "graph/fragment/graph_schema.h"
 #include "graph/loader/arrow_fragment_loader.h"
 
@@ -31,6 +44,50 @@ using namespace vineyard;  // NOLINT(build/namespaces)
 using GraphType = ArrowFragment<property_graph_types::OID_TYPE,
                                 property_graph_types::VID_TYPE>;
 using LabelType = typename GraphType::label_id_t;
+using LoaderType = ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                       property_graph_types::VID_TYPE>;
+
+int64_t count_stream_rows(vineyard::Client& client, vineyard::ObjectID id) {
+  auto stream = client.GetObject<vineyard::RecordBatchStream>(id);
+  std::unique_ptr<vineyard::RecordBatchStreamReader> reader;
+  VINEYARD_CHECK_OK(stream->OpenReader(client, reader));
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  VINEYARD_CHECK_OK(reader->ReadRecordBatches(batches));
+  int64_t rows = 0;
+  for (auto const& batch : batches) {
+    rows += batch->num_rows();
+  }
+  return rows;
+}
+
+void export_graph(vineyard::Client& client, std::shared_ptr<GraphType> graph) {
+  vineyard::ArrowFragmentExporter<GraphType> exporter(client, graph, 1024);
+  std::vector<vineyard::ObjectID> vstreams, estreams;
+  VINEYARD_CHECK_OK(exporter.CreateStreams(vstreams, estreams));
+  Status export_status;
+  std::thread worker([&]() { export_status = exporter.Export(); });
+
+  for (LabelType v_label = 0; v_label != graph->vertex_label_num();
+       ++v_label) {
+    CHECK_EQ(count_stream_rows(client, vstreams[v_label]),
+             static_cast<int64_t>(graph->GetInnerVerticesNum(v_label)));
+  }
+  for (LabelType e_label = 0; e_label != graph->edge_label_num(); ++e_label) {
+    int64_t rows = count_stream_rows(client, estreams[e_label]);
+    if (graph->directed()) {
+      int64_t expected = 0;
+      for (LabelType v_label = 0; v_label != graph->vertex_label_num();
+           ++v_label) {
+        for (auto v : graph->InnerVertices(v_label)) {
+          expected += graph->GetLocalOutDegree(v, e_label);
+        }
+      }
+      CHECK_EQ(rows, expected);
+    }
+  }
+  worker.join();
+  VINEYARD_CHECK_OK(export_status);
+}
 
 void WriteOut(vineyard::Client& client, const grape::CommSpec& comm_spec,
               vineyard::ObjectID fragment_group_id) {
@@ -44,16 +101,18 @@ void WriteOut(vineyard::Client& client, const grape::CommSpec& comm_spec,
   }
 
   // NB: only retrieve local fragments.
-  auto locations = fg->FragmentLocations();
-  for (const auto& pair : fg->Fragments()) {
-    if (locations.at(pair.first) != client.instance_id()) {
-      continue;
-    }
-    auto frag_id = pair.second;
-    auto frag = std::dynamic_pointer_cast<GraphType>(client.GetObject(frag_id));
+  std::map<vineyard::fid_t, std::shared_ptr<vineyard::ArrowFragmentBase>>
+      local_fragments;
+  VINEYARD_CHECK_OK(fg->GetLocalFragments(client, local_fragments));
+  CHECK_EQ(local_fragments.size(),
+           fg->LocalFragments(client.instance_id()).size());
+  for (const auto& pair : local_fragments) {
+    auto frag_id = pair.second->id();
+    auto frag = std::dynamic_pointer_cast<GraphType>(pair.second);
     auto schema = frag->schema();
     auto mg_schema = vineyard::MaxGraphSchema(schema);
     mg_schema.DumpToFile("/tmp/" + std::to_string(fragment_group_id) + ".json");
+    export_graph(client, frag);
 
     LOG(INFO) << "[worker-" << comm_spec.worker_id()
               << "] loaded graph to vineyard: " << ObjectIDToString(frag_id)
@@ -94,6 +153,878 @@ void traverse_graph(std::shared_ptr<GraphType> graph, const std::string& path) {
   }
 }
 
+// The neighbors of the incoming edges of every inner vertex, by their oids.
+std::map<std::pair<LabelType, GraphType::oid_t>,
+         std::vector<GraphType::oid_t>>
+collect_incoming(std::shared_ptr<GraphType> graph, LabelType const e_label) {
+  std::map<std::pair<LabelType, GraphType::oid_t>,
+           std::vector<GraphType::oid_t>>
+      incoming;
+  for (LabelType v_label = 0; v_label != graph->vertex_label_num();
+       ++v_label) {
+    for (auto v : graph->InnerVertices(v_label)) {
+      auto& neighbors = incoming[std::make_pair(v_label, graph->GetId(v))];
+      for (auto& e : graph->GetIncomingAdjList(v, e_label)) {
+        neighbors.emplace_back(graph->GetId(e.neighbor()));
+      }
+      std::sort(neighbors.begin(), neighbors.end());
+    }
+  }
+  return incoming;
+}
+
+void check_lazy_incoming(vineyard::Client& client,
+                         const grape::CommSpec& comm_spec,
+                         vineyard::ObjectID eager_id,
+                         vineyard::ObjectID fragment_id) {
+  std::string const name = vineyard::ScopedName(fragment_id, "incoming");
+  vineyard::ObjectID incoming_id = vineyard::InvalidObjectID();
+  {
+    std::shared_ptr<GraphType> eager =
+        std::dynamic_pointer_cast<GraphType>(client.GetObject(eager_id));
+    std::shared_ptr<GraphType> graph =
+        std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+    CHECK(!eager->lazy_incoming());
+    CHECK(graph->lazy_incoming());
+    // nothing is transposed before the incoming edges are accessed
+    CHECK(!client.GetName(name, incoming_id).ok());
+
+    size_t out_edges = 0, in_edges = 0;
+    for (LabelType e_label = 0; e_label != graph->edge_label_num();
+         ++e_label) {
+      for (LabelType v_label = 0; v_label != graph->vertex_label_num();
+           ++v_label) {
+        for (auto v : graph->InnerVertices(v_label)) {
+          out_edges += graph->GetOutgoingAdjList(v, e_label).Size();
+          in_edges += graph->GetIncomingAdjList(v, e_label).Size();
+        }
+      }
+      // the transposed lists are the same as the eager ones
+      CHECK(collect_incoming(graph, e_label) ==
+            collect_incoming(eager, e_label));
+    }
+    if (comm_spec.fnum() == 1) {
+      CHECK_EQ(out_edges, in_edges);
+    }
+  }
+  VINEYARD_CHECK_OK(client.GetName(name, incoming_id));
+
+  // the later readers attach to the sealed incoming edges
+  {
+    vineyard::Client reader;
+    VINEYARD_CHECK_OK(reader.Connect(client.IPCSocket()));
+    std::shared_ptr<GraphType> eager =
+        std::dynamic_pointer_cast<GraphType>(reader.GetObject(eager_id));
+    std::shared_ptr<GraphType> graph =
+        std::dynamic_pointer_cast<GraphType>(reader.GetObject(fragment_id));
+    for (LabelType e_label = 0; e_label != graph->edge_label_num();
+         ++e_label) {
+      CHECK(collect_incoming(graph, e_label) ==
+            collect_incoming(eager, e_label));
+    }
+    vineyard::ObjectID attached_id = vineyard::InvalidObjectID();
+    VINEYARD_CHECK_OK(reader.GetName(name, attached_id));
+    CHECK_EQ(attached_id, incoming_id);
+    reader.Disconnect();
+  }
+
+  // the sealed incoming edges go with the fragment
+  VINEYARD_CHECK_OK(client.DelData(fragment_id, false, true));
+  CHECK(!client.GetName(name, incoming_id).ok());
+  bool exists = true;
+  VINEYARD_CHECK_OK(client.Exists(incoming_id, exists));
+  CHECK(!exists);
+  VINEYARD_CHECK_OK(client.DelData(eager_id, false, true));
+}
+
+void check_encoded_edges(vineyard::Client& client,
+                         vineyard::ObjectID fragment_id) {
+  std::vector<std::string> names;
+  std::vector<vineyard::ObjectID> decoded_ids;
+  {
+    std::shared_ptr<GraphType> graph =
+        std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+    vineyard::ObjectMeta meta;
+    VINEYARD_CHECK_OK(client.GetMetaData(fragment_id, meta));
+    for (LabelType e_label = 0; e_label != graph->edge_label_num();
+         ++e_label) {
+      auto table = graph->edge_data_table(e_label);
+      for (int column = 0; column < table->num_columns(); ++column) {
+        if (!meta.Haskey(vineyard::generate_name_with_suffix(
+                "edge_encoded_columns", e_label, column))) {
+          continue;
+        }
+        CHECK_EQ(table->column(column)->null_count(), 0);
+        std::string name = vineyard::ScopedName(
+            fragment_id, vineyard::generate_name_with_suffix(
+                             "edge_decoded_columns", e_label, column));
+        vineyard::ObjectID decoded_id = vineyard::InvalidObjectID();
+        VINEYARD_CHECK_OK(client.GetName(name, decoded_id));
+        names.emplace_back(name);
+        decoded_ids.emplace_back(decoded_id);
+      }
+    }
+  }
+
+  // the later readers map the decoded values rather than decoding again
+  {
+    std::shared_ptr<GraphType> graph =
+        std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+    for (size_t index = 0; index < names.size(); ++index) {
+      vineyard::ObjectID decoded_id = vineyard::InvalidObjectID();
+      VINEYARD_CHECK_OK(client.GetName(names[index], decoded_id));
+      CHECK_EQ(decoded_id, decoded_ids[index]);
+    }
+  }
+
+  // the decoded values go with the fragment
+  VINEYARD_CHECK_OK(client.DelData(fragment_id, false, true));
+  for (size_t index = 0; index < names.size(); ++index) {
+    vineyard::ObjectID decoded_id = vineyard::InvalidObjectID();
+    CHECK(!client.GetName(names[index], decoded_id).ok());
+    bool exists = true;
+    VINEYARD_CHECK_OK(client.Exists(decoded_ids[index], exists));
+    CHECK(!exists);
+  }
+}
+
+void check_compressed_adj_lists(vineyard::Client& client,
+                                vineyard::ObjectID fragment_id) {
+  using edge_t = std::pair<GraphType::vid_t, GraphType::eid_t>;
+  std::shared_ptr<GraphType> graph =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+  graph->CompressAdjLists();
+  CHECK(graph->HasCompressedAdjLists());
+
+  auto check = [](const GraphType::adj_list_t& raw,
+                  const GraphType::compressed_adj_list_t& compressed) {
+    CHECK_EQ(raw.Size(), compressed.Size());
+    std::vector<edge_t> expected, actual;
+    for (auto& e : raw) {
+      expected.emplace_back(e.neighbor().GetValue(), e.edge_id());
+    }
+    for (auto& e : compressed) {
+      actual.emplace_back(e.neighbor().GetValue(), e.edge_id());
+    }
+    CHECK_EQ(actual.size(), compressed.Size());
+    // the neighbors are decoded in the order of the vertex ids
+    for (size_t k = 1; k < actual.size(); ++k) {
+      CHECK_LE(actual[k - 1].first, actual[k].first);
+    }
+    std::sort(expected.begin(), expected.end());
+    std::sort(actual.begin(), actual.end());
+    CHECK(expected == actual);
+  };
+
+  for (LabelType e_label = 0; e_label != graph->edge_label_num(); ++e_label) {
+    for (LabelType v_label = 0; v_label != graph->vertex_label_num();
+         ++v_label) {
+      for (auto v : graph->InnerVertices(v_label)) {
+        check(graph->GetOutgoingAdjList(v, e_label),
+              graph->GetCompressedOutgoingAdjList(v, e_label));
+        check(graph->GetIncomingAdjList(v, e_label),
+              graph->GetCompressedIncomingAdjList(v, e_label));
+      }
+    }
+  }
+  VINEYARD_CHECK_OK(client.DelData(fragment_id, false, true));
+}
+
+void check_separate_vid_lists(vineyard::Client& client,
+                              vineyard::ObjectID fragment_id) {
+  // the same fragment, with the neighbor vids laid out separately
+  vineyard::ObjectMeta meta;
+  VINEYARD_CHECK_OK(client.GetMetaData(fragment_id, meta));
+  meta.AddKeyValue("separate_vid_lists", 1);
+  meta.ResetSignature();
+  vineyard::ObjectID separate_id = vineyard::InvalidObjectID();
+  VINEYARD_CHECK_OK(client.CreateMetaData(meta, separate_id));
+
+  std::shared_ptr<GraphType> graph =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+  std::shared_ptr<GraphType> separate =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(separate_id));
+  CHECK(!graph->separate_vid_lists());
+  CHECK(separate->separate_vid_lists());
+
+  auto check = [](const GraphType::adj_list_t& adj_list,
+                  const GraphType::vid_adj_list_t& vid_list,
+                  bool const contiguous) {
+    CHECK_EQ(adj_list.Size(), vid_list.Size());
+    CHECK_EQ(vid_list.Contiguous(), contiguous);
+    auto iter = vid_list.begin();
+    for (auto& e : adj_list) {
+      CHECK(iter != vid_list.end());
+      CHECK_EQ(e.neighbor().GetValue(), (*iter).neighbor().GetValue());
+      ++iter;
+    }
+    CHECK(iter == vid_list.end());
+  };
+
+  for (LabelType e_label = 0; e_label != graph->edge_label_num(); ++e_label) {
+    for (LabelType v_label = 0; v_label != graph->vertex_label_num();
+         ++v_label) {
+      for (auto v : graph->InnerVertices(v_label)) {
+        auto oe = graph->GetOutgoingAdjList(v, e_label);
+        check(oe, graph->GetOutgoingVidList(v, e_label), false);
+        check(oe, separate->GetOutgoingVidList(v, e_label), true);
+        auto ie = graph->GetIncomingAdjList(v, e_label);
+        check(ie, graph->GetIncomingVidList(v, e_label), false);
+        check(ie, separate->GetIncomingVidList(v, e_label), true);
+      }
+    }
+  }
+  VINEYARD_CHECK_OK(client.DelData(separate_id, false, false));
+  VINEYARD_CHECK_OK(client.DelData(fragment_id, false, true));
+}
+
+template <typename CONFIGURE_T>
+vineyard::ObjectID load_fragment(vineyard::Client& client,
+                                 const grape::CommSpec& comm_spec,
+                                 const std::vector<std::string>& efiles,
+                                 const std::vector<std::string>& vfiles,
+                                 bool directed, const CONFIGURE_T& configure) {
+  auto loader = std::make_unique<LoaderType>(client, comm_spec, efiles,
+                                             vfiles, directed);
+  configure(*loader);
+  return boost::leaf::try_handle_all(
+      [&loader]() { return loader->LoadFragment(); },
+      [](const GSError& e) {
+        LOG(FATAL) << e.error_msg;
+        return 0;
+      },
+      [](const boost::leaf::error_info& unmatched) {
+        LOG(FATAL) << "Unmatched error " << unmatched;
+        return 0;
+      });
+}
+
+std::vector<std::pair<GraphType::oid_t, GraphType::oid_t>> collect_edges(
+    std::shared_ptr<GraphType> graph) {
+  std::vector<std::pair<GraphType::oid_t, GraphType::oid_t>> edges;
+  for (LabelType e_label = 0; e_label != graph->edge_label_num(); ++e_label) {
+    for (LabelType v_label = 0; v_label != graph->vertex_label_num();
+         ++v_label) {
+      for (auto v : graph->InnerVertices(v_label)) {
+        for (auto& e : graph->GetOutgoingAdjList(v, e_label)) {
+          edges.emplace_back(graph->GetId(v), graph->GetId(e.neighbor()));
+        }
+      }
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  return edges;
+}
+
+void check_degree_ordering(vineyard::Client& client,
+                           vineyard::ObjectID fragment_id,
+                           vineyard::ObjectID ordered_id) {
+  std::shared_ptr<GraphType> graph =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+  std::shared_ptr<GraphType> ordered =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(ordered_id));
+
+  // the same vertices and edges, only the local ids differ
+  for (LabelType v_label = 0; v_label != graph->vertex_label_num();
+       ++v_label) {
+    CHECK_EQ(graph->GetInnerVerticesNum(v_label),
+             ordered->GetInnerVerticesNum(v_label));
+    for (auto v : graph->InnerVertices(v_label)) {
+      GraphType::vertex_t u;
+      CHECK(ordered->GetInnerVertex(v_label, graph->GetId(v), u));
+    }
+  }
+  CHECK(collect_edges(graph) == collect_edges(ordered));
+
+  // the degrees of the inner vertices, counted on both ends of the edges,
+  // are descending within every label
+  if (ordered->directed()) {
+    for (LabelType v_label = 0; v_label != ordered->vertex_label_num();
+         ++v_label) {
+      int64_t last = std::numeric_limits<int64_t>::max();
+      for (auto v : ordered->InnerVertices(v_label)) {
+        int64_t degree = 0;
+        for (LabelType e_label = 0; e_label != ordered->edge_label_num();
+             ++e_label) {
+          degree += ordered->GetLocalOutDegree(v, e_label) +
+                    ordered->GetLocalInDegree(v, e_label);
+        }
+        CHECK_LE(degree, last);
+        last = degree;
+      }
+    }
+  }
+  VINEYARD_CHECK_OK(client.DelData(ordered_id, false, true));
+  VINEYARD_CHECK_OK(client.DelData(fragment_id, false, true));
+}
+
+void check_edge_deltas(vineyard::Client& client,
+                       vineyard::ObjectID fragment_id) {
+  using edge_t = std::pair<GraphType::vid_t, GraphType::eid_t>;
+  std::shared_ptr<GraphType> graph =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+  LabelType const e_label = 0, v_label = 0;
+  auto inner_vertices = graph->InnerVertices(v_label);
+  int64_t const inserted = std::min<int64_t>(inner_vertices.size(), 64);
+  if (inserted == 0) {
+    return;
+  }
+
+  // a ring over the first inner vertices, with the properties of the
+  // first edges of the label
+  auto base_table = graph->edge_data_table(e_label);
+  int64_t const base_num = base_table->num_rows();
+  CHECK_GE(base_num, inserted);
+  std::vector<GraphType::vertex_t> vertices;
+  for (auto v : inner_vertices) {
+    if (static_cast<int64_t>(vertices.size()) == inserted) {
+      break;
+    }
+    vertices.push_back(v);
+  }
+  GraphType::vid_builder_t src_builder, dst_builder;
+  for (int64_t i = 0; i < inserted; ++i) {
+    CHECK_ARROW_ERROR(
+        src_builder.Append(graph->GetInnerVertexGid(vertices[i])));
+    CHECK_ARROW_ERROR(dst_builder.Append(
+        graph->GetInnerVertexGid(vertices[(i + 1) % inserted])));
+  }
+  std::shared_ptr<arrow::Array> src_gids, dst_gids;
+  CHECK_ARROW_ERROR(src_builder.Finish(&src_gids));
+  CHECK_ARROW_ERROR(dst_builder.Finish(&dst_gids));
+  auto properties = base_table->Slice(0, inserted);
+  std::vector<std::shared_ptr<arrow::Field>> fields{
+      arrow::field("src", src_gids->type()),
+      arrow::field("dst", dst_gids->type())};
+  std::vector<std::shared_ptr<arrow::ChunkedArray>> columns{
+      std::make_shared<arrow::ChunkedArray>(src_gids),
+      std::make_shared<arrow::ChunkedArray>(dst_gids)};
+  for (int column = 0; column < properties->num_columns(); ++column) {
+    fields.push_back(properties->schema()->field(column));
+    columns.push_back(properties->column(column));
+  }
+  auto edges = arrow::Table::Make(arrow::schema(fields), columns);
+
+  // the mismatched tables and labels are rejected, and leave the fragment
+  // untouched
+  CHECK(!graph->InsertEdges(graph->edge_label_num(), edges));
+  CHECK(!graph->InsertEdges(e_label, properties));
+  CHECK_EQ(graph->GetDeltaEdgeNum(e_label), 0U);
+
+  std::vector<std::vector<edge_t>> expected(inserted);
+  for (int64_t i = 0; i < inserted; ++i) {
+    for (auto& e : graph->GetOutgoingAdjList(vertices[i], e_label)) {
+      expected[i].emplace_back(e.neighbor().GetValue(), e.edge_id());
+    }
+    expected[i].emplace_back(vertices[(i + 1) % inserted].GetValue(),
+                             static_cast<GraphType::eid_t>(base_num + i));
+    if (!graph->directed()) {
+      // the reversed edge of the undirected ones
+      int64_t prev = (i + inserted - 1) % inserted;
+      expected[i].emplace_back(vertices[prev].GetValue(),
+                               static_cast<GraphType::eid_t>(base_num + prev));
+    }
+    std::sort(expected[i].begin(), expected[i].end());
+  }
+
+  CHECK(graph->InsertEdges(e_label, edges));
+  CHECK_EQ(graph->GetDeltaEdgeNum(e_label), static_cast<size_t>(inserted));
+  for (int64_t i = 0; i < inserted; ++i) {
+    // the plain adjacency lists don't see the deltas before compaction
+    CHECK_EQ(graph->GetOutgoingAdjList(vertices[i], e_label).Size() +
+                 (graph->directed() ? 1 : 2),
+             expected[i].size());
+    std::vector<edge_t> merged;
+    for (auto& e : graph->GetMergedOutgoingAdjList(vertices[i], e_label)) {
+      merged.emplace_back(e.neighbor().GetValue(), e.edge_id());
+    }
+    std::sort(merged.begin(), merged.end());
+    CHECK(merged == expected[i]);
+  }
+
+  CHECK(graph->CompactEdgeDeltas());
+  CHECK_EQ(graph->GetDeltaEdgeNum(e_label), 0U);
+  CHECK_EQ(graph->edge_data_table(e_label)->num_rows(), base_num + inserted);
+  for (int64_t i = 0; i < inserted; ++i) {
+    std::vector<edge_t> compacted;
+    for (auto& e : graph->GetOutgoingAdjList(vertices[i], e_label)) {
+      compacted.emplace_back(e.neighbor().GetValue(), e.edge_id());
+    }
+    std::sort(compacted.begin(), compacted.end());
+    CHECK(compacted == expected[i]);
+  }
+  VINEYARD_CHECK_OK(client.DelData(fragment_id, false, true));
+}
+
+void check_cached_projections(vineyard::Client& client,
+                              vineyard::ObjectID fragment_id) {
+  using selection_t = std::map<LabelType, std::vector<LabelType>>;
+  std::shared_ptr<GraphType> graph =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+  auto project = [&](const selection_t& vertices, const selection_t& edges) {
+    return boost::leaf::try_handle_all(
+        [&]() { return graph->ProjectCached(client, vertices, edges); },
+        [](const GSError& e) {
+          LOG(FATAL) << e.error_msg;
+          return vineyard::InvalidObjectID();
+        },
+        [](const boost::leaf::error_info& unmatched) {
+          LOG(FATAL) << "Unmatched error " << unmatched;
+          return vineyard::InvalidObjectID();
+        });
+  };
+
+  std::vector<LabelType> properties, shuffled;
+  for (int column = 0; column < graph->edge_data_table(0)->num_columns();
+       ++column) {
+    properties.push_back(column);
+    shuffled.insert(shuffled.begin(), {column, column});
+  }
+
+  // the same selection, in whatever order, is projected only once
+  vineyard::ObjectID projected = project({{0, {}}}, {{0, properties}});
+  CHECK_NE(projected, vineyard::InvalidObjectID());
+  CHECK_EQ(project({{0, {}}}, {{0, properties}}), projected);
+  CHECK_EQ(project({{0, {}}}, {{0, shuffled}}), projected);
+  {
+    std::shared_ptr<GraphType> fragment =
+        std::dynamic_pointer_cast<GraphType>(client.GetObject(projected));
+    CHECK_EQ(fragment->edge_data_table(0)->num_columns(),
+             static_cast<int>(properties.size()));
+  }
+
+  // a different selection is a different projection
+  vineyard::ObjectID other = project({{0, {}}}, {{0, {}}});
+  CHECK_NE(other, projected);
+
+  // the projection is rebuilt once the cached object is deleted
+  VINEYARD_CHECK_OK(client.DelData(projected, false, false));
+  vineyard::ObjectID rebuilt = project({{0, {}}}, {{0, properties}});
+  CHECK_NE(rebuilt, projected);
+  CHECK_EQ(project({{0, {}}}, {{0, properties}}), rebuilt);
+
+  VINEYARD_CHECK_OK(client.DelData(rebuilt, false, false));
+  VINEYARD_CHECK_OK(client.DelData(other, false, false));
+  VINEYARD_CHECK_OK(client.DelData(fragment_id, false, true));
+}
+
+void check_sealed_members(vineyard::Client& client,
+                          vineyard::ObjectID fragment_id,
+                          vineyard::ObjectID other_id) {
+  std::shared_ptr<GraphType> graph =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+  std::shared_ptr<GraphType> other =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(other_id));
+
+  // every member is sealed, whichever worker took it
+  for (LabelType v_label = 0; v_label != graph->vertex_label_num();
+       ++v_label) {
+    CHECK_EQ(graph->GetInnerVerticesNum(v_label),
+             other->GetInnerVerticesNum(v_label));
+    CHECK_EQ(graph->GetOuterVerticesNum(v_label),
+             other->GetOuterVerticesNum(v_label));
+    CHECK(graph->vertex_data_table(v_label)->schema()->Equals(
+        *other->vertex_data_table(v_label)->schema()));
+    CHECK_EQ(graph->vertex_data_table(v_label)->num_rows(),
+             other->vertex_data_table(v_label)->num_rows());
+  }
+  for (LabelType e_label = 0; e_label != graph->edge_label_num(); ++e_label) {
+    int64_t edge_num = graph->edge_data_table(e_label)->num_rows();
+    CHECK_EQ(edge_num, other->edge_data_table(e_label)->num_rows());
+    for (LabelType v_label = 0; v_label != graph->vertex_label_num();
+         ++v_label) {
+      for (auto v : graph->InnerVertices(v_label)) {
+        for (auto& e : graph->GetOutgoingAdjList(v, e_label)) {
+          CHECK_LT(static_cast<int64_t>(e.edge_id()), edge_num);
+        }
+        for (auto& e : graph->GetIncomingAdjList(v, e_label)) {
+          CHECK_LT(static_cast<int64_t>(e.edge_id()), edge_num);
+        }
+      }
+    }
+  }
+  CHECK(collect_edges(graph) == collect_edges(other));
+
+  VINEYARD_CHECK_OK(client.DelData(other_id, false, true));
+  VINEYARD_CHECK_OK(client.DelData(fragment_id, false, true));
+}
+
+void check_vertex_cut(vineyard::Client& client,
+                      const grape::CommSpec& comm_spec,
+                      vineyard::ObjectID fragment_id,
+                      vineyard::ObjectID cut_id) {
+  std::shared_ptr<GraphType> graph =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+  std::shared_ptr<GraphType> cut =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(cut_id));
+  CHECK(!graph->vertex_cut());
+  CHECK(cut->vertex_cut());
+
+  // the vertices keep their owners
+  for (LabelType v_label = 0; v_label != graph->vertex_label_num();
+       ++v_label) {
+    CHECK_EQ(graph->GetInnerVerticesNum(v_label),
+             cut->GetInnerVerticesNum(v_label));
+  }
+  // on a single fragment, the grid is the same as the edge-cut
+  if (comm_spec.fnum() == 1) {
+    for (LabelType e_label = 0; e_label != graph->edge_label_num();
+         ++e_label) {
+      CHECK_EQ(graph->edge_data_table(e_label)->num_rows(),
+               cut->edge_data_table(e_label)->num_rows());
+    }
+    CHECK(collect_edges(graph) == collect_edges(cut));
+  }
+
+  VINEYARD_CHECK_OK(client.DelData(cut_id, false, true));
+  VINEYARD_CHECK_OK(client.DelData(fragment_id, false, true));
+}
+
+// The same edge file, as the edges of another label.
+std::string relabel_edges(const std::string& efile, const std::string& suffix) {
+  for (auto const key : {"#label=", "&label="}) {
+    auto begin = efile.find(key);
+    if (begin != std::string::npos) {
+      auto end = efile.find('&', begin + 1);
+      std::string relabeled(efile);
+      relabeled.insert(end == std::string::npos ? efile.size() : end, suffix);
+      return relabeled;
+    }
+  }
+  LOG(FATAL) << "The edge label is expected in " << efile;
+  return efile;
+}
+
+void check_relabeled_edges(vineyard::Client& client,
+                           vineyard::ObjectID fragment_id,
+                           vineyard::ObjectID relabeled_id) {
+  std::shared_ptr<GraphType> graph =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+  std::shared_ptr<GraphType> relabeled =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(relabeled_id));
+  CHECK_EQ(relabeled->edge_label_num(), 2 * graph->edge_label_num());
+
+  // every copy of the files is read as the edges of its own label
+  for (LabelType e_label = 0; e_label != relabeled->edge_label_num();
+       ++e_label) {
+    LabelType origin = e_label % graph->edge_label_num();
+    CHECK_EQ(relabeled->edge_data_table(e_label)->num_rows(),
+             graph->edge_data_table(origin)->num_rows());
+    for (LabelType v_label = 0; v_label != graph->vertex_label_num();
+         ++v_label) {
+      for (auto v : graph->InnerVertices(v_label)) {
+        GraphType::vertex_t u;
+        CHECK(relabeled->GetInnerVertex(v_label, graph->GetId(v), u));
+        CHECK_EQ(relabeled->GetLocalOutDegree(u, e_label),
+                 graph->GetLocalOutDegree(v, origin));
+      }
+    }
+  }
+
+  VINEYARD_CHECK_OK(client.DelData(relabeled_id, false, true));
+  VINEYARD_CHECK_OK(client.DelData(fragment_id, false, true));
+}
+
+// A copy of the edge file in the directory, where every edge appears twice,
+// read as the edges of a new label.
+std::string duplicate_edges(const std::string& efile,
+                            const std::string& directory) {
+  size_t query = efile.find('#');
+  std::string path = efile.substr(0, query);
+  std::string copy =
+      directory + "/" + path.substr(path.find_last_of('/') + 1) + "_dup";
+  std::ifstream is(path);
+  std::ofstream os(copy);
+  std::string line;
+  CHECK(std::getline(is, line));
+  os << line << "\n";
+  while (std::getline(is, line)) {
+    os << line << "\n" << line << "\n";
+  }
+  return relabel_edges(copy + efile.substr(query), "_dup");
+}
+
+void check_parallel_edges(vineyard::Client& client,
+                          vineyard::ObjectID fragment_id,
+                          vineyard::ObjectID duplicated_id) {
+  std::shared_ptr<GraphType> graph =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+  std::shared_ptr<GraphType> duplicated =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(duplicated_id));
+  CHECK_EQ(duplicated->edge_label_num(), 2 * graph->edge_label_num());
+
+  // the parallel edges of the new labels make the whole graph a multigraph,
+  // and the other labels are built as before
+  CHECK_EQ(duplicated->meta().GetKeyValue<int>("is_multigraph"), 1);
+  for (LabelType e_label = 0; e_label != duplicated->edge_label_num();
+       ++e_label) {
+    LabelType origin = e_label % graph->edge_label_num();
+    int times = e_label < graph->edge_label_num() ? 1 : 2;
+    CHECK_EQ(duplicated->edge_data_table(e_label)->num_rows(),
+             times * graph->edge_data_table(origin)->num_rows());
+    for (LabelType v_label = 0; v_label != graph->vertex_label_num();
+         ++v_label) {
+      for (auto v : graph->InnerVertices(v_label)) {
+        GraphType::vertex_t u;
+        CHECK(duplicated->GetInnerVertex(v_label, graph->GetId(v), u));
+        CHECK_EQ(duplicated->GetLocalOutDegree(u, e_label),
+                 times * graph->GetLocalOutDegree(v, origin));
+        if (duplicated->directed()) {
+          CHECK_EQ(duplicated->GetLocalInDegree(u, e_label),
+                   times * graph->GetLocalInDegree(v, origin));
+        }
+      }
+    }
+  }
+
+  VINEYARD_CHECK_OK(client.DelData(duplicated_id, false, true));
+  VINEYARD_CHECK_OK(client.DelData(fragment_id, false, true));
+}
+
+// The part of the worker of the file, with the labels of the file in the
+// metadata of the schema, where the loader finds them in the stream batches.
+std::shared_ptr<arrow::Table> read_labeled_table(
+    const grape::CommSpec& comm_spec, const std::string& file) {
+  auto io_adaptor = IOFactory::CreateIOAdaptor(file + "#header_row=true");
+  CHECK(io_adaptor != nullptr);
+  VINEYARD_CHECK_OK(io_adaptor->SetPartialRead(comm_spec.worker_id(),
+                                               comm_spec.worker_num()));
+  VINEYARD_CHECK_OK(io_adaptor->Open());
+  std::shared_ptr<arrow::Table> table;
+  VINEYARD_CHECK_OK(io_adaptor->ReadTable(&table));
+  auto meta = io_adaptor->GetMeta();
+  std::vector<std::string> keys, values;
+  for (auto const key : {"label", "src_label", "dst_label"}) {
+    auto iter = meta.find(key);
+    if (iter != meta.end()) {
+      keys.emplace_back(key);
+      values.emplace_back(iter->second);
+    }
+  }
+  VINEYARD_CHECK_OK(io_adaptor->Close());
+  return table->ReplaceSchemaMetadata(arrow::key_value_metadata(keys, values));
+}
+
+// A stream of each worker, grouped into a parallel stream collectively.
+void create_streams(vineyard::Client& client, const grape::CommSpec& comm_spec,
+                    vineyard::ObjectID& stream_id,
+                    vineyard::ObjectID& pstream_id) {
+  DataframeStreamBuilder builder(client);
+  stream_id = builder.Seal(client)->id();
+  VINEYARD_CHECK_OK(client.Persist(stream_id));
+  std::vector<vineyard::ObjectID> stream_ids(comm_spec.worker_num());
+  MPI_Allgather(&stream_id, sizeof(vineyard::ObjectID), MPI_CHAR,
+                stream_ids.data(), sizeof(vineyard::ObjectID), MPI_CHAR,
+                comm_spec.comm());
+  if (comm_spec.worker_id() == 0) {
+    ParallelStreamBuilder pbuilder(client);
+    for (auto const& id : stream_ids) {
+      pbuilder.AddStream(id);
+    }
+    pstream_id = pbuilder.Seal(client)->id();
+  }
+  MPI_Bcast(&pstream_id, sizeof(vineyard::ObjectID), MPI_CHAR, 0,
+            comm_spec.comm());
+  ObjectMeta meta;
+  VINEYARD_CHECK_OK(client.GetMetaData(pstream_id, meta, true));
+}
+
+void push_batches(vineyard::Client& client, vineyard::ObjectID stream_id,
+                  std::shared_ptr<arrow::Table> const& table) {
+  auto stream = client.GetObject<DataframeStream>(stream_id);
+  CHECK(stream != nullptr);
+  std::unique_ptr<DataframeStreamWriter> writer;
+  VINEYARD_CHECK_OK(stream->OpenWriter(client, writer));
+  // small batches, thus the edges arrive in many chunks
+  arrow::TableBatchReader reader(*table);
+  reader.set_chunksize(16);
+  std::shared_ptr<arrow::RecordBatch> batch;
+  while (reader.ReadNext(&batch).ok() && batch != nullptr) {
+    VINEYARD_CHECK_OK(writer->WriteBatch(batch));
+  }
+  VINEYARD_CHECK_OK(writer->Finish());
+}
+
+vineyard::ObjectID load_from_streams(
+    vineyard::Client& client, const grape::CommSpec& comm_spec,
+    const std::string& efile, const std::string& vfile, bool directed,
+    bool stream_edges) {
+  auto vtable = read_labeled_table(comm_spec, vfile);
+  auto etable = read_labeled_table(comm_spec, efile);
+  vineyard::ObjectID vstream, estream, vpstream = InvalidObjectID(),
+                                       epstream = InvalidObjectID();
+  create_streams(client, comm_spec, vstream, vpstream);
+  create_streams(client, comm_spec, estream, epstream);
+  MPI_Barrier(comm_spec.comm());
+
+  // the streams are written with another client, as the writers may block
+  // while the loader reads with `client`
+  std::thread producer([&]() {
+    vineyard::Client writer_client;
+    VINEYARD_CHECK_OK(writer_client.Connect(client.IPCSocket()));
+    push_batches(writer_client, vstream, vtable);
+    push_batches(writer_client, estream, etable);
+  });
+  auto loader = std::make_unique<LoaderType>(
+      client, comm_spec, std::vector<vineyard::ObjectID>{vpstream},
+      std::vector<std::vector<vineyard::ObjectID>>{{epstream}}, directed);
+  loader->SetStreamingEdges(stream_edges);
+  auto fragment_id = boost::leaf::try_handle_all(
+      [&loader]() { return loader->LoadFragment(); },
+      [](const GSError& e) {
+        LOG(FATAL) << e.error_msg;
+        return 0;
+      },
+      [](const boost::leaf::error_info& unmatched) {
+        LOG(FATAL) << "Unmatched error " << unmatched;
+        return 0;
+      });
+  producer.join();
+  return fragment_id;
+}
+
+void check_streaming_edges(vineyard::Client& client,
+                           vineyard::ObjectID fragment_id,
+                           vineyard::ObjectID streamed_id) {
+  std::shared_ptr<GraphType> graph =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+  std::shared_ptr<GraphType> streamed =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(streamed_id));
+  CHECK_EQ(streamed->vertex_label_num(), graph->vertex_label_num());
+  CHECK_EQ(streamed->edge_label_num(), graph->edge_label_num());
+  for (LabelType v_label = 0; v_label != graph->vertex_label_num();
+       ++v_label) {
+    CHECK_EQ(streamed->GetInnerVerticesNum(v_label),
+             graph->GetInnerVerticesNum(v_label));
+  }
+  for (LabelType e_label = 0; e_label != graph->edge_label_num(); ++e_label) {
+    CHECK_EQ(streamed->edge_data_table(e_label)->num_rows(),
+             graph->edge_data_table(e_label)->num_rows());
+  }
+  // the edges resolved chunk by chunk are the same as the drained ones
+  CHECK(collect_edges(streamed) == collect_edges(graph));
+
+  VINEYARD_CHECK_OK(client.DelData(streamed_id, false, true));
+  VINEYARD_CHECK_OK(client.DelData(fragment_id, false, true));
+}
+
+void check_spilled_edges(vineyard::Client& client,
+                         vineyard::ObjectID fragment_id,
+                         vineyard::ObjectID spilled_id,
+                         const std::string& spill_directory) {
+  std::shared_ptr<GraphType> graph =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+  std::shared_ptr<GraphType> spilled =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(spilled_id));
+  CHECK_EQ(spilled->edge_label_num(), graph->edge_label_num());
+  for (LabelType e_label = 0; e_label != graph->edge_label_num(); ++e_label) {
+    CHECK_EQ(spilled->edge_data_table(e_label)->num_rows(),
+             graph->edge_data_table(e_label)->num_rows());
+    CHECK(spilled->edge_data_table(e_label)->schema()->Equals(
+        *graph->edge_data_table(e_label)->schema()));
+  }
+  CHECK(collect_edges(spilled) == collect_edges(graph));
+
+  // the spilled files are unlinked once they are mapped
+  CHECK_EQ(rmdir(spill_directory.c_str()), 0);
+
+  VINEYARD_CHECK_OK(client.DelData(spilled_id, false, true));
+  VINEYARD_CHECK_OK(client.DelData(fragment_id, false, true));
+}
+
+// Load the last property of every label only, and a property that no label
+// has, which is refused.
+void check_selected_properties(vineyard::Client& client,
+                               const grape::CommSpec& comm_spec,
+                               const std::vector<std::string>& efiles,
+                               const std::vector<std::string>& vfiles,
+                               bool directed, vineyard::ObjectID fragment_id) {
+  std::shared_ptr<GraphType> graph =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(fragment_id));
+  property_selection_t vertex_properties, edge_properties;
+  std::map<LabelType, std::string> vertex_selected, edge_selected;
+  for (LabelType v_label = 0; v_label != graph->vertex_label_num();
+       ++v_label) {
+    auto schema = graph->vertex_data_table(v_label)->schema();
+    if (schema->num_fields() > 1) {
+      auto field = schema->field(schema->num_fields() - 1);
+      vertex_selected[v_label] = field->name();
+      vertex_properties[graph->schema().GetVertexLabelName(v_label)] = {
+          vertex_selected[v_label]};
+    }
+  }
+  for (LabelType e_label = 0; e_label != graph->edge_label_num(); ++e_label) {
+    auto schema = graph->edge_data_table(e_label)->schema();
+    if (schema->num_fields() > 0) {
+      edge_selected[e_label] = schema->field(schema->num_fields() - 1)->name();
+      edge_properties[graph->schema().GetEdgeLabelName(e_label)] = {
+          edge_selected[e_label]};
+    }
+  }
+
+  auto selected_id = load_fragment(
+      client, comm_spec, efiles, vfiles, directed, [&](LoaderType& loader) {
+        loader.SetSelectedProperties(vertex_properties, edge_properties);
+      });
+  std::shared_ptr<GraphType> selected =
+      std::dynamic_pointer_cast<GraphType>(client.GetObject(selected_id));
+  for (LabelType v_label = 0; v_label != graph->vertex_label_num();
+       ++v_label) {
+    auto table = graph->vertex_data_table(v_label);
+    auto selected_table = selected->vertex_data_table(v_label);
+    CHECK_EQ(selected->GetInnerVerticesNum(v_label),
+             graph->GetInnerVerticesNum(v_label));
+    CHECK_EQ(selected_table->num_rows(), table->num_rows());
+    if (vertex_selected.count(v_label)) {
+      CHECK_LE(selected_table->num_columns(), table->num_columns());
+      auto field =
+          selected_table->schema()->GetFieldByName(vertex_selected[v_label]);
+      CHECK(field != nullptr);
+      CHECK(field->type()->Equals(
+          table->schema()->GetFieldByName(vertex_selected[v_label])->type()));
+    } else {
+      CHECK(selected_table->schema()->Equals(*table->schema()));
+    }
+  }
+  for (LabelType e_label = 0; e_label != graph->edge_label_num(); ++e_label) {
+    auto table = graph->edge_data_table(e_label);
+    auto selected_table = selected->edge_data_table(e_label);
+    CHECK_EQ(selected_table->num_rows(), table->num_rows());
+    if (edge_selected.count(e_label)) {
+      // the other properties are never loaded
+      CHECK_EQ(selected_table->num_columns(), 1);
+      CHECK_EQ(selected_table->schema()->field(0)->name(),
+               edge_selected[e_label]);
+      CHECK(selected_table->schema()->field(0)->type()->Equals(
+          table->schema()->GetFieldByName(edge_selected[e_label])->type()));
+    }
+  }
+  CHECK(collect_edges(selected) == collect_edges(graph));
+  VINEYARD_CHECK_OK(client.DelData(selected_id, false, true));
+
+  if (!edge_properties.empty()) {
+    property_selection_t missing = edge_properties;
+    missing.begin()->second = {"arrow_fragment_test_missing_property"};
+    auto loader = std::make_unique<LoaderType>(client, comm_spec, efiles,
+                                               vfiles, directed);
+    loader->SetSelectedProperties({}, missing);
+    bool failed = false;
+    boost::leaf::try_handle_all(
+        [&loader]() { return loader->LoadFragment(); },
+        [&failed](const GSError&) {
+          failed = true;
+          return vineyard::InvalidObjectID();
+        },
+        [&failed](const boost::leaf::error_info&) {
+          failed = true;
+          return vineyard::InvalidObjectID();
+        });
+    CHECK(failed);
+  }
+
+  VINEYARD_CHECK_OK(client.DelData(fragment_id, false, true));
+}
+
 int main(int argc, char** argv) {
   if (argc < 6) {
     printf(
@@ -213,6 +1144,184 @@ int main(int argc, char** argv) {
           });
       WriteOut(client, comm_spec, fragment_group_id);
     }
+
+    // Build the incoming edges lazily
+    if (directed != 0) {
+      auto eager_id = load_fragment(client, comm_spec, efiles, vfiles, true,
+                                    [](LoaderType&) {});
+      auto fragment_id = load_fragment(
+          client, comm_spec, efiles, vfiles, true,
+          [](LoaderType& loader) { loader.SetLazyIncoming(true); });
+      check_lazy_incoming(client, comm_spec, eager_id, fragment_id);
+    }
+
+    // Share the decoded edge properties across the readers
+    {
+      auto loader =
+          std::make_unique<ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                               property_graph_types::VID_TYPE>>(
+              client, comm_spec, efiles, vfiles, directed != 0);
+      loader->SetEncodeEdgeProperties(true);
+      vineyard::ObjectID fragment_id = boost::leaf::try_handle_all(
+          [&loader]() { return loader->LoadFragment(); },
+          [](const GSError& e) {
+            LOG(FATAL) << e.error_msg;
+            return 0;
+          },
+          [](const boost::leaf::error_info& unmatched) {
+            LOG(FATAL) << "Unmatched error " << unmatched;
+            return 0;
+          });
+      check_encoded_edges(client, fragment_id);
+    }
+
+    // Traverse the compressed adjacency lists
+    {
+      auto loader =
+          std::make_unique<ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                               property_graph_types::VID_TYPE>>(
+              client, comm_spec, efiles, vfiles, directed != 0);
+      vineyard::ObjectID fragment_id = boost::leaf::try_handle_all(
+          [&loader]() { return loader->LoadFragment(); },
+          [](const GSError& e) {
+            LOG(FATAL) << e.error_msg;
+            return 0;
+          },
+          [](const boost::leaf::error_info& unmatched) {
+            LOG(FATAL) << "Unmatched error " << unmatched;
+            return 0;
+          });
+      check_compressed_adj_lists(client, fragment_id);
+    }
+
+    // Traverse the separate neighbor vid lists
+    {
+      auto loader =
+          std::make_unique<ArrowFragmentLoader<property_graph_types::OID_TYPE,
+                                               property_graph_types::VID_TYPE>>(
+              client, comm_spec, efiles, vfiles, directed != 0);
+      vineyard::ObjectID fragment_id = boost::leaf::try_handle_all(
+          [&loader]() { return loader->LoadFragment(); },
+          [](const GSError& e) {
+            LOG(FATAL) << e.error_msg;
+            return 0;
+          },
+          [](const boost::leaf::error_info& unmatched) {
+            LOG(FATAL) << "Unmatched error " << unmatched;
+            return 0;
+          });
+      check_separate_vid_lists(client, fragment_id);
+    }
+
+    // Renumber the inner vertices by descending degree
+    {
+      auto fragment_id = load_fragment(client, comm_spec, efiles, vfiles,
+                                       directed != 0, [](LoaderType&) {});
+      auto ordered_id = load_fragment(
+          client, comm_spec, efiles, vfiles, directed != 0,
+          [](LoaderType& loader) {
+            loader.SetVertexOrdering(VertexOrdering::kDegree);
+          });
+      check_degree_ordering(client, fragment_id, ordered_id);
+    }
+
+    // Insert edges into the delta segments, and compact them
+    {
+      auto fragment_id = load_fragment(client, comm_spec, efiles, vfiles,
+                                       directed != 0, [](LoaderType&) {});
+      check_edge_deltas(client, fragment_id);
+    }
+
+    // Reuse the projections of the same selection
+    {
+      auto fragment_id = load_fragment(client, comm_spec, efiles, vfiles,
+                                       directed != 0, [](LoaderType&) {});
+      check_cached_projections(client, fragment_id);
+    }
+
+    // Seal the members of the same graph twice
+    {
+      auto fragment_id = load_fragment(client, comm_spec, efiles, vfiles,
+                                       directed != 0, [](LoaderType&) {});
+      auto other_id = load_fragment(client, comm_spec, efiles, vfiles,
+                                    directed != 0, [](LoaderType&) {});
+      check_sealed_members(client, fragment_id, other_id);
+    }
+
+    // Place every edge once, on a grid of the fragments
+    {
+      auto fragment_id = load_fragment(client, comm_spec, efiles, vfiles,
+                                       directed != 0, [](LoaderType&) {});
+      auto cut_id = load_fragment(
+          client, comm_spec, efiles, vfiles, directed != 0,
+          [](LoaderType& loader) {
+            loader.SetEdgePartitioning(EdgePartitioning::kVertexCut2D);
+          });
+      check_vertex_cut(client, comm_spec, fragment_id, cut_id);
+    }
+
+    // Read the files of several edge labels at the same time
+    {
+      std::vector<std::string> relabeled_efiles(efiles);
+      for (auto const& efile : efiles) {
+        relabeled_efiles.push_back(relabel_edges(efile, "_copy"));
+      }
+      auto fragment_id = load_fragment(client, comm_spec, efiles, vfiles,
+                                       directed != 0, [](LoaderType&) {});
+      auto relabeled_id =
+          load_fragment(client, comm_spec, relabeled_efiles, vfiles,
+                        directed != 0, [](LoaderType&) {});
+      check_relabeled_edges(client, fragment_id, relabeled_id);
+    }
+
+    // Build the CSRs of the edge labels at the same time, some of which
+    // have parallel edges
+    {
+      char duplicate_directory[] = "/tmp/arrow_fragment_test_XXXXXX";
+      CHECK(mkdtemp(duplicate_directory) != nullptr);
+      std::vector<std::string> duplicated_efiles(efiles);
+      for (auto const& efile : efiles) {
+        duplicated_efiles.push_back(
+            duplicate_edges(efile, duplicate_directory));
+      }
+      auto fragment_id = load_fragment(client, comm_spec, efiles, vfiles,
+                                       directed != 0, [](LoaderType&) {});
+      auto duplicated_id =
+          load_fragment(client, comm_spec, duplicated_efiles, vfiles,
+                        directed != 0, [](LoaderType&) {});
+      check_parallel_edges(client, fragment_id, duplicated_id);
+    }
+
+    // Resolve the edges of the streams chunk by chunk
+    {
+      auto fragment_id = load_from_streams(client, comm_spec, efiles[0],
+                                           vfiles[0], directed != 0, false);
+      auto streamed_id = load_from_streams(client, comm_spec, efiles[0],
+                                           vfiles[0], directed != 0, true);
+      check_streaming_edges(client, fragment_id, streamed_id);
+    }
+
+    // Load the selected properties only
+    {
+      auto fragment_id = load_fragment(client, comm_spec, efiles, vfiles,
+                                       directed != 0, [](LoaderType&) {});
+      check_selected_properties(client, comm_spec, efiles, vfiles,
+                                directed != 0, fragment_id);
+    }
+
+    // Spill the shuffled edges to memory-mapped local files
+    {
+      char spill_directory[] = "/tmp/arrow_fragment_test_XXXXXX";
+      CHECK(mkdtemp(spill_directory) != nullptr);
+      auto fragment_id = load_fragment(client, comm_spec, efiles, vfiles,
+                                       directed != 0, [](LoaderType&) {});
+      auto spilled_id = load_fragment(
+          client, comm_spec, efiles, vfiles, directed != 0,
+          [&spill_directory](LoaderType& loader) {
+            loader.SetSpillDirectory(spill_directory);
+          });
+      check_spilled_edges(client, fragment_id, spilled_id, spill_directory);
+    }
 #endif
   }
   grape::FinalizeMPIComm();
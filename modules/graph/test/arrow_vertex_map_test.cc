@@ -0,0 +1,298 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "basic/ds/arrow_utils.h"
+#include "client/client.h"
+#include "graph/fragment/property_graph_utils.h"
+#include "graph/vertex_map/arrow_vertex_map.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using vid_t = uint64_t;
+using label_id_t = property_graph_types::LABEL_ID_TYPE;
+
+constexpr fid_t kFnum = 3;
+constexpr label_id_t kLabelNum = 2;
+
+// The number of vertices of each (fragment, label), empty, a single one, and
+// several chunks of the concurrent builder.
+int64_t vertexNum(fid_t fid, label_id_t label) {
+  int64_t const sizes[] = {0, 1, 200003, 4096, 65536, 131077};
+  return sizes[(fid * kLabelNum + label) % 6];
+}
+
+// Distinct oids across all fragments and labels, in a random order unless
+// `sorted`.
+std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>> makeOids(
+    bool sorted) {
+  std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>> oid_arrays(
+      kLabelNum, std::vector<std::shared_ptr<arrow::Int64Array>>(kFnum));
+  std::mt19937 gen(2021);
+  for (label_id_t label = 0; label < kLabelNum; ++label) {
+    for (fid_t fid = 0; fid < kFnum; ++fid) {
+      std::vector<int64_t> oids(vertexNum(fid, label));
+      for (size_t k = 0; k < oids.size(); ++k) {
+        int64_t index = k * kFnum * kLabelNum + fid * kLabelNum + label;
+        oids[k] = index * 7 - 3;
+      }
+      if (!sorted) {
+        std::shuffle(oids.begin(), oids.end(), gen);
+      }
+      arrow::Int64Builder builder;
+      CHECK_ARROW_ERROR(builder.AppendValues(oids));
+      std::shared_ptr<arrow::Array> array;
+      CHECK_ARROW_ERROR(builder.Finish(&array));
+      oid_arrays[label][fid] =
+          std::dynamic_pointer_cast<arrow::Int64Array>(array);
+    }
+  }
+  return oid_arrays;
+}
+
+// Every oid maps to the gid of its position, back and forth, one by one and
+// in batches, and the oids that are not there are not found.
+template <typename OID_T, typename OID_ARRAY_T>
+void checkVertexMap(
+    std::shared_ptr<ArrowVertexMap<OID_T, vid_t>> const& vm,
+    std::vector<std::vector<std::shared_ptr<OID_ARRAY_T>>> const& oid_arrays,
+    std::vector<OID_T> const& missing) {
+  IdParser<vid_t> id_parser;
+  id_parser.Init(kFnum, kLabelNum);
+  for (label_id_t label = 0; label < kLabelNum; ++label) {
+    for (fid_t fid = 0; fid < kFnum; ++fid) {
+      auto const& array = oid_arrays[label][fid];
+      CHECK_EQ(static_cast<int64_t>(vm->GetInnerVertexSize(fid, label)),
+               array->length());
+      std::vector<OID_T> oids;
+      for (int64_t k = 0; k < array->length(); ++k) {
+        OID_T oid = array->GetView(k);
+        oids.push_back(oid);
+        vid_t gid = 0;
+        CHECK(vm->GetGid(fid, label, oid, gid));
+        CHECK_EQ(gid, id_parser.GenerateId(fid, label, k));
+        CHECK(vm->GetGid(label, oid, gid));
+        CHECK_EQ(gid, id_parser.GenerateId(fid, label, k));
+        OID_T value;
+        CHECK(vm->GetOid(gid, value));
+        CHECK(value == oid);
+      }
+      oids.insert(oids.end(), missing.begin(), missing.end());
+      std::vector<vid_t> gids(oids.size());
+      std::unique_ptr<bool[]> found(new bool[oids.size()]);
+      vm->GetGids(fid, label, oids.data(), oids.size(), gids.data(),
+                  found.get());
+      for (int64_t k = 0; k < array->length(); ++k) {
+        CHECK(found[k]);
+        CHECK_EQ(gids[k], id_parser.GenerateId(fid, label, k));
+      }
+      for (size_t k = array->length(); k < oids.size(); ++k) {
+        CHECK(!found[k]);
+      }
+    }
+  }
+  for (auto const& oid : missing) {
+    vid_t gid = 0;
+    CHECK(!vm->GetGid(0, oid, gid));
+  }
+}
+
+template <typename OID_T, typename OID_ARRAY_T, typename... Args>
+std::shared_ptr<ArrowVertexMap<OID_T, vid_t>> buildVertexMap(
+    Client& client,
+    std::vector<std::vector<std::shared_ptr<OID_ARRAY_T>>> const& oid_arrays,
+    Args... args) {
+  BasicArrowVertexMapBuilder<OID_T, vid_t> builder(client, kFnum, kLabelNum,
+                                                   oid_arrays, args...);
+  auto sealed = builder.Seal(client);
+  return std::dynamic_pointer_cast<ArrowVertexMap<OID_T, vid_t>>(
+      client.GetObject(sealed->id()));
+}
+
+// The string oids, of a few lengths, that share long prefixes.
+std::vector<std::vector<std::shared_ptr<arrow::LargeStringArray>>>
+makeStringOids() {
+  std::vector<std::vector<std::shared_ptr<arrow::LargeStringArray>>>
+      oid_arrays(kLabelNum,
+                 std::vector<std::shared_ptr<arrow::LargeStringArray>>(kFnum));
+  std::string const prefix(64, 'v');
+  for (label_id_t label = 0; label < kLabelNum; ++label) {
+    for (fid_t fid = 0; fid < kFnum; ++fid) {
+      arrow::LargeStringBuilder builder;
+      for (int64_t k = 0; k < vertexNum(fid, label); ++k) {
+        std::string oid = std::to_string(k) + "-" + std::to_string(fid) + "-" +
+                          std::to_string(label);
+        if (k % 3 == 0) {
+          oid = prefix + oid;
+        }
+        CHECK_ARROW_ERROR(builder.Append(oid));
+      }
+      std::shared_ptr<arrow::Array> array;
+      CHECK_ARROW_ERROR(builder.Finish(&array));
+      oid_arrays[label][fid] =
+          std::dynamic_pointer_cast<arrow::LargeStringArray>(array);
+    }
+  }
+  return oid_arrays;
+}
+
+// Extends the vertex map by label 1, whose vertices of fragment 1 are
+// unchanged, and by a new label 2, and checks that the existing gids are
+// kept and the unchanged members are shared.
+void checkAddVertices(
+    Client& client, std::shared_ptr<ArrowVertexMap<int64_t, vid_t>> const& vm,
+    std::vector<std::vector<std::shared_ptr<arrow::Int64Array>>> const&
+        oid_arrays) {
+  std::map<label_id_t, std::vector<std::shared_ptr<arrow::Int64Array>>> added;
+  for (label_id_t label = 1; label <= kLabelNum; ++label) {
+    for (fid_t fid = 0; fid < kFnum; ++fid) {
+      // greater than the existing oids, as the sorted oids require
+      std::vector<int64_t> oids(label == 1 && fid == 1 ? 0 : 1000 + fid);
+      for (size_t k = 0; k < oids.size(); ++k) {
+        oids[k] = 1000000000000LL + label * 1000000000LL + k * kFnum + fid;
+      }
+      arrow::Int64Builder builder;
+      CHECK_ARROW_ERROR(builder.AppendValues(oids));
+      std::shared_ptr<arrow::Array> array;
+      CHECK_ARROW_ERROR(builder.Finish(&array));
+      added[label].push_back(
+          std::dynamic_pointer_cast<arrow::Int64Array>(array));
+    }
+  }
+  auto extended = std::dynamic_pointer_cast<ArrowVertexMap<int64_t, vid_t>>(
+      client.GetObject(vm->AddVertices(client, added)));
+  CHECK_EQ(extended->label_num(), kLabelNum + 1);
+  CHECK_EQ(extended->use_sorted_oids(), vm->use_sorted_oids());
+
+  IdParser<vid_t> id_parser;
+  id_parser.Init(kFnum, kLabelNum + 1);
+  for (label_id_t label = 0; label <= kLabelNum; ++label) {
+    for (fid_t fid = 0; fid < kFnum; ++fid) {
+      std::vector<int64_t> oids;
+      if (label < kLabelNum) {
+        auto const& array = oid_arrays[label][fid];
+        oids.assign(array->raw_values(), array->raw_values() + array->length());
+      }
+      if (label > 0) {
+        auto const& array = added[label][fid];
+        oids.insert(oids.end(), array->raw_values(),
+                    array->raw_values() + array->length());
+      }
+      CHECK_EQ(extended->GetInnerVertexSize(fid, label), oids.size());
+      for (size_t k = 0; k < oids.size(); ++k) {
+        vid_t gid = 0;
+        CHECK(extended->GetGid(fid, label, oids[k], gid));
+        CHECK_EQ(gid, id_parser.GenerateId(fid, label, k));
+        int64_t oid = 0;
+        CHECK(extended->GetOid(gid, oid));
+        CHECK_EQ(oid, oids[k]);
+      }
+    }
+  }
+
+  // only the extended and the new (fid, label) pairs are built
+  for (fid_t fid = 0; fid < kFnum; ++fid) {
+    for (label_id_t label = 0; label < kLabelNum; ++label) {
+      std::string name =
+          "oid_arrays_" + std::to_string(fid) + "_" + std::to_string(label);
+      bool shared = label == 0 || fid == 1;
+      CHECK_EQ(extended->meta().GetMemberMeta(name).GetId() ==
+                   vm->meta().GetMemberMeta(name).GetId(),
+               shared);
+    }
+  }
+  VINEYARD_CHECK_OK(client.DelData(extended->id(), false, true));
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./arrow_vertex_map_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<int64_t> const missing = {-1, 0, 1, 5, 1000000007};
+  {
+    auto oid_arrays = makeOids(false);
+    // the hashmaps are filled from chunks of the oids on many threads
+    auto vm = buildVertexMap<int64_t>(client, oid_arrays);
+    checkVertexMap(vm, oid_arrays, missing);
+    VINEYARD_CHECK_OK(client.DelData(vm->id(), false, true));
+
+    auto perfect = buildVertexMap<int64_t>(client, oid_arrays, true);
+    checkVertexMap(perfect, oid_arrays, missing);
+    VINEYARD_CHECK_OK(client.DelData(perfect->id(), false, true));
+  }
+  LOG(INFO) << "Passed vertex map with hashmaps tests...";
+
+  {
+    // the sorted oids are searched rather than hashed
+    auto oid_arrays = makeOids(true);
+    auto vm = buildVertexMap<int64_t>(client, oid_arrays, false, true);
+    CHECK(vm->use_sorted_oids());
+    for (auto const& kv : vm->meta()) {
+      CHECK(kv.key().find("o2g_") != 0);
+    }
+    checkVertexMap(vm, oid_arrays, missing);
+    VINEYARD_CHECK_OK(client.DelData(vm->id(), false, true));
+
+    // and the unsorted ones are rejected
+    BasicArrowVertexMapBuilder<int64_t, vid_t> builder(
+        client, kFnum, kLabelNum, makeOids(false), false, true);
+    CHECK(builder.Build(client).IsInvalid());
+  }
+  LOG(INFO) << "Passed vertex map with sorted oids tests...";
+
+  {
+    for (bool sorted : {false, true}) {
+      auto oid_arrays = makeOids(sorted);
+      auto vm = buildVertexMap<int64_t>(client, oid_arrays, false, sorted);
+      checkAddVertices(client, vm, oid_arrays);
+      VINEYARD_CHECK_OK(client.DelData(vm->id(), false, true));
+    }
+  }
+  LOG(INFO) << "Passed adding vertices tests...";
+
+  {
+    // the string oids are indexed by their fingerprints
+    using oid_t = arrow::util::string_view;
+    auto oid_arrays = makeStringOids();
+    std::vector<oid_t> const missing = {"", "0", "0-0", "0-0-2",
+                                        "vvvv0-0-0", "0-0-0 "};
+    auto vm = buildVertexMap<oid_t>(client, oid_arrays);
+    checkVertexMap(vm, oid_arrays, missing);
+    VINEYARD_CHECK_OK(client.DelData(vm->id(), false, true));
+  }
+  LOG(INFO) << "Passed vertex map with string oids tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
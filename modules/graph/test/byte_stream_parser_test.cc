@@ -0,0 +1,172 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "basic/ds/arrow_utils.h"
+#include "basic/stream/byte_stream.h"
+#include "basic/stream/recordbatch_stream.h"
+#include "client/client.h"
+#include "io/io/byte_stream_parser.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The chunks of whole lines, the values of the i-th line are (i, "v<i>",
+// i + 0.5), and only the first and the last columns are selected.
+
+constexpr size_t kChunks = 16;
+constexpr size_t kLinesPerChunk = 1000;
+
+using params_t = std::unordered_map<std::string, std::string>;
+
+params_t makeParams() {
+  return params_t{{"header_row", "1"},
+                  {"header_line", "id|name|value"},
+                  {"delimiter", "|"},
+                  {"schema", "0,2"},
+                  {"column_types", "int64,double"}};
+}
+
+std::string makeChunk(size_t const chunk) {
+  std::string lines;
+  for (size_t line = 0; line < kLinesPerChunk; ++line) {
+    size_t index = chunk * kLinesPerChunk + line;
+    lines += std::to_string(index) + "|v" + std::to_string(index) + "|" +
+             std::to_string(index) + ".5\n";
+  }
+  return lines;
+}
+
+void checkTable(std::shared_ptr<arrow::Table> const& table, size_t first) {
+  CHECK_EQ(table->num_columns(), 2);
+  CHECK_EQ(table->schema()->field(0)->name(), "id");
+  CHECK_EQ(table->schema()->field(1)->name(), "value");
+  CHECK(table->schema()->field(0)->type()->Equals(arrow::int64()));
+  CHECK(table->schema()->field(1)->type()->Equals(arrow::float64()));
+  std::shared_ptr<arrow::Table> combined;
+  CHECK_ARROW_ERROR_AND_ASSIGN(combined, table->CombineChunks());
+  auto ids = std::dynamic_pointer_cast<arrow::Int64Array>(
+      combined->column(0)->chunk(0));
+  auto values = std::dynamic_pointer_cast<arrow::DoubleArray>(
+      combined->column(1)->chunk(0));
+  for (int64_t row = 0; row < table->num_rows(); ++row) {
+    CHECK_EQ(ids->Value(row), static_cast<int64_t>(first + row));
+    CHECK_EQ(values->Value(row), first + row + 0.5);
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./byte_stream_parser_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // the options are taken from the params
+  {
+    ByteStreamParser parser(makeParams());
+    VINEYARD_CHECK_OK(parser.Init());
+    std::shared_ptr<arrow::Table> table;
+    VINEYARD_CHECK_OK(
+        parser.Parse(arrow::Buffer::FromString(makeChunk(1)), table));
+    CHECK_EQ(table->num_rows(), kLinesPerChunk);
+    checkTable(table, kLinesPerChunk);
+
+    // an empty chunk yields no rows
+    VINEYARD_CHECK_OK(parser.Parse(arrow::Buffer::FromString(""), table));
+    CHECK(table == nullptr || table->num_rows() == 0);
+
+    auto params = makeParams();
+    params.erase("header_line");
+    CHECK(ByteStreamParser(params).Init().IsInvalid());
+    params = makeParams();
+    params["schema"] = "0,3";
+    CHECK(ByteStreamParser(params).Init().IsInvalid());
+    params = makeParams();
+    params["column_types"] = "int64,string,double";
+    CHECK(ByteStreamParser(params).Init().IsInvalid());
+  }
+  LOG(INFO) << "Passed parsing chunks tests...";
+
+  // the record batch stream is consumed while the byte stream is parsed
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(makeParams());
+    ObjectID byte_stream_id = builder.Seal(client)->id();
+
+    std::thread producer([&]() {
+      Client writer_client;
+      VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+      auto stream = writer_client.GetObject<ByteStream>(byte_stream_id);
+      std::unique_ptr<ByteStreamWriter> writer;
+      VINEYARD_CHECK_OK(stream->OpenWriter(writer_client, writer));
+      for (size_t chunk = 0; chunk < kChunks; ++chunk) {
+        std::string lines = makeChunk(chunk);
+        std::unique_ptr<arrow::MutableBuffer> buffer;
+        VINEYARD_CHECK_OK(writer->GetNext(lines.size(), buffer));
+        memcpy(buffer->mutable_data(), lines.data(), lines.size());
+      }
+      VINEYARD_CHECK_OK(writer->Finish());
+    });
+
+    std::thread consumer;
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    VINEYARD_CHECK_OK(ParseByteStream(
+        client, byte_stream_id, [&](ObjectID const stream_id) {
+          consumer = std::thread([&, stream_id]() {
+            Client reader_client;
+            VINEYARD_CHECK_OK(reader_client.Connect(ipc_socket));
+            auto stream =
+                reader_client.GetObject<RecordBatchStream>(stream_id);
+            CHECK(stream != nullptr);
+            auto params = stream->GetParams();
+            for (auto const& kv : makeParams()) {
+              CHECK_EQ(params.at(kv.first), kv.second);
+            }
+            std::unique_ptr<RecordBatchStreamReader> reader;
+            VINEYARD_CHECK_OK(stream->OpenReader(reader_client, reader));
+            VINEYARD_CHECK_OK(reader->ReadRecordBatches(batches));
+          });
+        }));
+    producer.join();
+    consumer.join();
+
+    std::shared_ptr<arrow::Table> table;
+    VINEYARD_CHECK_OK(RecordBatchesToTable(batches, &table));
+    CHECK_EQ(table->num_rows(), kChunks * kLinesPerChunk);
+    checkTable(table, 0);
+  }
+  LOG(INFO) << "Passed parsing byte streams tests...";
+
+  client.Disconnect();
+
+  LOG(INFO) << "Passed byte stream parser tests...";
+
+  return 0;
+}
@@ -0,0 +1,213 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "graph/fragment/frontier.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr int kThreads = 8;
+constexpr size_t kBits = 10000 + 17;
+
+// The accessors of ArrowFragment that parallel_for_inner_vertices uses, with
+// a vertex of a huge degree among the vertices of small degrees.
+class SkewedFragment {
+ public:
+  using label_id_t = int;
+  using vid_t = uint64_t;
+
+  SkewedFragment(vid_t const begin, size_t const ivnum)
+      : begin_(begin), ivnum_(ivnum), offsets_(2) {
+    for (label_id_t e_label = 0; e_label < 2; ++e_label) {
+      offsets_[e_label].emplace_back(0);
+      for (size_t offset = 0; offset < ivnum; ++offset) {
+        int64_t degree = offset == ivnum / 3 ? 100000 : offset % (7 + e_label);
+        offsets_[e_label].emplace_back(offsets_[e_label].back() + degree);
+      }
+    }
+  }
+
+  grape::VertexRange<vid_t> InnerVertices(label_id_t) const {
+    return grape::VertexRange<vid_t>(begin_, begin_ + ivnum_);
+  }
+
+  label_id_t edge_label_num() const { return 2; }
+
+  const int64_t* GetOutgoingOffsets(label_id_t, label_id_t e_label) const {
+    return offsets_[e_label].data();
+  }
+
+ private:
+  vid_t begin_;
+  size_t ivnum_;
+  std::vector<std::vector<int64_t>> offsets_;
+};
+
+void checkInnerVertices(size_t const ivnum, int const thread_num,
+                        int const e_label, size_t const chunk_num) {
+  SkewedFragment::vid_t const begin = 1000;
+  SkewedFragment frag(begin, ivnum);
+  std::vector<std::atomic<int>> visits(ivnum);
+  for (auto& visit : visits) {
+    visit.store(0);
+  }
+  parallel_for_inner_vertices(
+      frag, 0,
+      [&](grape::Vertex<SkewedFragment::vid_t> v) {
+        CHECK_GE(v.GetValue(), begin);
+        CHECK_LT(v.GetValue(), begin + ivnum);
+        visits[v.GetValue() - begin].fetch_add(1);
+      },
+      thread_num, e_label, chunk_num);
+  for (auto const& visit : visits) {
+    CHECK_EQ(visit.load(), 1);
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./frontier_test <ipc_socket>");
+    return 1;
+  }
+
+  // only one of the threads that set the same bit gets true
+  {
+    AtomicBitset bitset(kBits);
+    CHECK_EQ(bitset.Size(), kBits);
+    CHECK_EQ(bitset.Count(), 0U);
+    std::atomic<size_t> newly_set(0);
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < kThreads; ++thread) {
+      threads.emplace_back([&, thread]() {
+        for (size_t index = 0; index < kBits; ++index) {
+          size_t bit = (index * 11 + thread) % kBits;
+          if (bit % 3 != 0 && bitset.Set(bit)) {
+            newly_set.fetch_add(1);
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    size_t expected = kBits - (kBits + 2) / 3;
+    CHECK_EQ(newly_set.load(), expected);
+    CHECK_EQ(bitset.Count(), expected);
+
+    // the set bits are visited in ascending order, and only once in parallel
+    size_t previous = 0, visited = 0;
+    bitset.ForEach([&](size_t index) {
+      CHECK(visited == 0 || index > previous);
+      CHECK_NE(index % 3, 0U);
+      previous = index;
+      visited += 1;
+    });
+    CHECK_EQ(visited, expected);
+
+    std::vector<std::atomic<int>> visits(kBits);
+    for (auto& visit : visits) {
+      visit.store(0);
+    }
+    bitset.ParallelForEach([&](size_t index) { visits[index].fetch_add(1); },
+                           kThreads);
+    for (size_t index = 0; index < kBits; ++index) {
+      CHECK_EQ(visits[index].load(), index % 3 != 0 ? 1 : 0);
+    }
+
+    bitset.Reset(1);
+    CHECK(!bitset.Get(1));
+    CHECK(bitset.Set(1));
+    CHECK(!bitset.Set(1));
+
+    AtomicBitset other(64);
+    bitset.Swap(other);
+    CHECK_EQ(bitset.Size(), 64U);
+    CHECK_EQ(bitset.Count(), 0U);
+    CHECK_EQ(other.Count(), expected);
+    other.Clear();
+    CHECK_EQ(other.Count(), 0U);
+  }
+  LOG(INFO) << "Passed atomic bitset tests...";
+
+  // the frontiers of a BFS over a range of vertices
+  {
+    grape::VertexRange<uint64_t> range(100, 100 + kBits);
+    VertexFrontier<uint64_t> current(range), next(range);
+    CHECK(current.Empty());
+    CHECK(current.Insert(grape::Vertex<uint64_t>(100)));
+    CHECK(!current.Insert(grape::Vertex<uint64_t>(100)));
+    CHECK(current.Exist(grape::Vertex<uint64_t>(100)));
+    CHECK(!current.Exist(grape::Vertex<uint64_t>(101)));
+
+    // vertex v reaches v * 2 - 99 and v * 2 - 98, thus every level doubles
+    size_t reached = 1, levels = 0;
+    while (!current.Empty()) {
+      std::atomic<size_t> inserted(0);
+      current.ParallelForEach(
+          [&](grape::Vertex<uint64_t> v) {
+            for (uint64_t u : {v.GetValue() * 2 - 99, v.GetValue() * 2 - 98}) {
+              if (u < 100 + kBits && u != v.GetValue() &&
+                  next.Insert(grape::Vertex<uint64_t>(u))) {
+                inserted.fetch_add(1);
+              }
+            }
+          },
+          kThreads);
+      CHECK_EQ(next.Count(), inserted.load());
+      reached += inserted.load();
+      current.Swap(next);
+      next.Clear();
+      levels += 1;
+    }
+    CHECK_EQ(reached, kBits);
+    CHECK_GT(levels, 10U);
+    CHECK(current.Range().begin().GetValue() == 100);
+    CHECK_EQ(current.Range().size(), kBits);
+  }
+  LOG(INFO) << "Passed vertex frontier tests...";
+
+  // every inner vertex is visited once, however the chunks are split
+  for (size_t ivnum : {0, 1, 5, 1000, 100000}) {
+    checkInnerVertices(ivnum, kThreads, -1, 0);
+    checkInnerVertices(ivnum, kThreads, 1, 3);
+    checkInnerVertices(ivnum, 3, 0, 1000000);
+  }
+
+  // a single thread visits the vertices in order
+  {
+    SkewedFragment frag(0, 1000);
+    uint64_t expected = 0;
+    parallel_for_inner_vertices(
+        frag, 0,
+        [&](grape::Vertex<uint64_t> v) {
+          CHECK_EQ(v.GetValue(), expected);
+          expected += 1;
+        },
+        1);
+    CHECK_EQ(expected, 1000U);
+  }
+  LOG(INFO) << "Passed parallel inner vertices tests...";
+
+  LOG(INFO) << "Passed frontier tests...";
+
+  return 0;
+}
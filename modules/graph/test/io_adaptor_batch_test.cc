@@ -0,0 +1,170 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "common/util/status.h"
+#include "io/io/io_factory.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// Lines of various lengths, some are longer than a batch thus the batch is
+// enlarged, and the last line has no line break.
+constexpr size_t kLines = 2000;
+constexpr size_t kBatchSize = 1024;
+
+std::string makeLine(size_t const index) {
+  std::string line(index * 131 % 3000, static_cast<char>('a' + index % 26));
+  return line + "," + std::to_string(index);
+}
+
+std::vector<std::string> readLines(std::string const& path) {
+  auto io_adaptor = IOFactory::CreateIOAdaptor(path);
+  CHECK(io_adaptor != nullptr);
+  VINEYARD_CHECK_OK(io_adaptor->Open());
+  std::vector<std::string> lines;
+  std::string line;
+  while (io_adaptor->ReadLine(line).ok()) {
+    lines.emplace_back(line);
+  }
+  VINEYARD_CHECK_OK(io_adaptor->Close());
+  return lines;
+}
+
+std::vector<std::string> readBatches(std::string const& path, int parts) {
+  std::vector<std::string> lines;
+  for (int index = 0; index < parts; ++index) {
+    auto io_adaptor = IOFactory::CreateIOAdaptor(path);
+    CHECK(io_adaptor != nullptr);
+    VINEYARD_CHECK_OK(io_adaptor->SetPartialRead(index, parts));
+    VINEYARD_CHECK_OK(io_adaptor->Open());
+    std::shared_ptr<arrow::Buffer> buffer;
+    std::vector<int64_t> line_offsets;
+    while (true) {
+      auto status = io_adaptor->ReadBatch(kBatchSize, buffer, line_offsets);
+      if (status.IsEndOfFile()) {
+        break;
+      }
+      VINEYARD_CHECK_OK(status);
+      // at least one whole line, and the lines cover the buffer
+      CHECK_GE(line_offsets.size(), 2U);
+      CHECK_EQ(line_offsets.front(), 0);
+      CHECK_EQ(line_offsets.back(), buffer->size());
+      auto data = reinterpret_cast<const char*>(buffer->data());
+      for (size_t i = 0; i + 1 < line_offsets.size(); ++i) {
+        std::string line(data + line_offsets[i],
+                         line_offsets[i + 1] - line_offsets[i]);
+        if (!line.empty() && line.back() == '\n') {
+          line.pop_back();
+        }
+        lines.emplace_back(line);
+      }
+    }
+    VINEYARD_CHECK_OK(io_adaptor->Close());
+  }
+  return lines;
+}
+
+std::shared_ptr<arrow::Table> readTable(std::string const& path, int parts) {
+  std::vector<std::shared_ptr<arrow::Table>> tables;
+  for (int index = 0; index < parts; ++index) {
+    auto io_adaptor = IOFactory::CreateIOAdaptor(path + "#header_row=true");
+    CHECK(io_adaptor != nullptr);
+    VINEYARD_CHECK_OK(io_adaptor->SetPartialRead(index, parts));
+    VINEYARD_CHECK_OK(io_adaptor->Open());
+    std::shared_ptr<arrow::Table> table;
+    VINEYARD_CHECK_OK(io_adaptor->ReadTable(&table));
+    VINEYARD_CHECK_OK(io_adaptor->Close());
+    tables.emplace_back(table);
+  }
+  auto table = arrow::ConcatenateTables(tables);
+  CHECK(table.ok());
+  return table.ValueOrDie();
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./io_adaptor_batch_test <ipc_socket>");
+    return 1;
+  }
+
+  char path[] = "/tmp/io_adaptor_batch_test_XXXXXX";
+  int fd = mkstemp(path);
+  CHECK_GE(fd, 0);
+  close(fd);
+  {
+    std::ofstream file(path);
+    for (size_t index = 0; index < kLines; ++index) {
+      file << makeLine(index);
+      if (index + 1 < kLines) {
+        file << "\n";
+      }
+    }
+  }
+
+  auto lines = readLines(path);
+  CHECK_EQ(lines.size(), kLines);
+  for (size_t index = 0; index < kLines; ++index) {
+    CHECK_EQ(lines[index], makeLine(index));
+  }
+
+  // the batches of the whole file, and of the parts of the file, contain
+  // the same lines as the ones read line by line
+  for (int parts : {1, 3, 7}) {
+    CHECK(readBatches(path, parts) == lines);
+  }
+
+  // the mapped file is read the same way
+  std::string mapped = std::string(path) + "#mmap=true";
+  CHECK(readLines(mapped) == lines);
+  for (int parts : {1, 3, 7}) {
+    CHECK(readBatches(mapped, parts) == lines);
+  }
+  for (int parts : {1, 3}) {
+    CHECK(readTable(mapped, parts)->Equals(*readTable(path, parts)));
+  }
+
+  // so are the parts that are read ahead in the background
+  for (int parts : {1, 3}) {
+    CHECK(readTable(std::string(path) + "#readahead=2", parts)
+              ->Equals(*readTable(path, parts)));
+  }
+
+  // and the ones that are read with the tuned csv reader options, where the
+  // column types inferred from the first part are reused by the others
+  for (auto const options : {"#use_threads=false", "#block_size=4096",
+                             "#cache_column_types=true"}) {
+    for (int parts : {1, 3}) {
+      CHECK(readTable(std::string(path) + options, parts)
+                ->Equals(*readTable(path, parts)));
+    }
+  }
+
+  unlink(path);
+
+  LOG(INFO) << "Passed io adaptor batch tests...";
+
+  return 0;
+}
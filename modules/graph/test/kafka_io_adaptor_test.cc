@@ -0,0 +1,297 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "basic/ds/arrow_utils.h"
+#include "basic/stream/recordbatch_stream.h"
+#include "client/client.h"
+#include "common/util/status.h"
+#include "io/io/io_factory.h"
+#include "io/io/kafka_io_adaptor.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The reader waits for the messages of a partition that stays idle for a
+// while, without keeping a core busy, and the rows of tables are produced as
+// delimited messages.
+
+constexpr size_t kMessages = 1000;
+constexpr int kIdleSeconds = 3;
+constexpr int64_t kRows = 10000;
+
+std::string makeMessage(size_t const index) {
+  return "message," + std::to_string(index);
+}
+
+std::string makeTopic(std::string const& name) {
+  return name + "_" +
+         std::to_string(
+             std::chrono::system_clock::now().time_since_epoch().count());
+}
+
+// Rows of an int64 column with nulls, a double, a string and a bool column.
+std::shared_ptr<arrow::Table> makeTable() {
+  arrow::Int64Builder int_builder;
+  arrow::DoubleBuilder double_builder;
+  arrow::StringBuilder string_builder;
+  arrow::BooleanBuilder bool_builder;
+  for (int64_t row = 0; row < kRows; ++row) {
+    if (row % 7 == 0) {
+      CHECK_ARROW_ERROR(int_builder.AppendNull());
+    } else {
+      CHECK_ARROW_ERROR(int_builder.Append(row));
+    }
+    CHECK_ARROW_ERROR(double_builder.Append(row + 0.5));
+    CHECK_ARROW_ERROR(string_builder.Append("s" + std::to_string(row)));
+    CHECK_ARROW_ERROR(bool_builder.Append(row % 2 == 0));
+  }
+  std::shared_ptr<arrow::Array> ints, doubles, strings, bools;
+  CHECK_ARROW_ERROR(int_builder.Finish(&ints));
+  CHECK_ARROW_ERROR(double_builder.Finish(&doubles));
+  CHECK_ARROW_ERROR(string_builder.Finish(&strings));
+  CHECK_ARROW_ERROR(bool_builder.Finish(&bools));
+  auto schema = arrow::schema({arrow::field("i", arrow::int64()),
+                               arrow::field("d", arrow::float64()),
+                               arrow::field("s", arrow::utf8()),
+                               arrow::field("b", arrow::boolean())});
+  return arrow::Table::Make(schema, {ints, doubles, strings, bools});
+}
+
+std::string makeRow(int64_t const row) {
+  char value[32];
+  snprintf(value, sizeof(value), "%.17g", row + 0.5);
+  return (row % 7 == 0 ? "" : std::to_string(row)) + "|" + value + "|s" +
+         std::to_string(row) + "|" + (row % 2 == 0 ? "true" : "false");
+}
+
+// The rows of `makeTable()` from the `first` one, as parsed from the
+// messages.
+void checkRows(std::shared_ptr<arrow::Table> const& table, int64_t first) {
+  CHECK_EQ(table->num_columns(), 4);
+  std::shared_ptr<arrow::Table> combined;
+  CHECK_ARROW_ERROR_AND_ASSIGN(combined, table->CombineChunks());
+  auto ints = std::dynamic_pointer_cast<arrow::Int64Array>(
+      combined->column(0)->chunk(0));
+  auto doubles = std::dynamic_pointer_cast<arrow::DoubleArray>(
+      combined->column(1)->chunk(0));
+  auto strings = combined->column(2)->chunk(0);
+  auto bools = std::dynamic_pointer_cast<arrow::BooleanArray>(
+      combined->column(3)->chunk(0));
+  CHECK(ints != nullptr && doubles != nullptr && bools != nullptr);
+  for (int64_t index = 0; index < table->num_rows(); ++index) {
+    int64_t row = first + index;
+    CHECK_EQ(ints->IsNull(index), row % 7 == 0);
+    if (row % 7 != 0) {
+      CHECK_EQ(ints->Value(index), row);
+    }
+    CHECK_EQ(doubles->Value(index), row + 0.5);
+    std::string value =
+        strings->type()->id() == arrow::Type::LARGE_STRING
+            ? std::static_pointer_cast<arrow::LargeStringArray>(strings)
+                  ->GetString(index)
+            : std::static_pointer_cast<arrow::StringArray>(strings)
+                  ->GetString(index);
+    CHECK_EQ(value, "s" + std::to_string(row));
+    CHECK_EQ(bools->Value(index), row % 2 == 0);
+  }
+}
+
+void produce(std::string const& location, size_t begin, size_t end) {
+  auto io_adaptor = IOFactory::CreateIOAdaptor(location);
+  CHECK(io_adaptor != nullptr);
+  VINEYARD_CHECK_OK(io_adaptor->Open("w"));
+  for (size_t index = begin; index < end; ++index) {
+    VINEYARD_CHECK_OK(io_adaptor->WriteLine(makeMessage(index)));
+  }
+  VINEYARD_CHECK_OK(io_adaptor->Flush());
+  VINEYARD_CHECK_OK(io_adaptor->Close());
+}
+
+double cpuSeconds() {
+  struct rusage usage;
+  CHECK_EQ(getrusage(RUSAGE_SELF, &usage), 0);
+  auto seconds = [](struct timeval const& tv) {
+    return tv.tv_sec + tv.tv_usec / 1e6;
+  };
+  return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage ./kafka_io_adaptor_test <ipc_socket> <kafka_brokers>");
+    return 1;
+  }
+  std::string brokers = std::string(argv[2]);
+  std::string location = "kafka://" + brokers + "/" +
+                         makeTopic("kafka_io_adaptor_test") + "/group/1";
+
+  // the topic is created by the first messages
+  produce(location, 0, kMessages / 2);
+
+  auto reader = IOFactory::CreateIOAdaptor(location);
+  CHECK(reader != nullptr);
+  VINEYARD_CHECK_OK(reader->Open());
+
+  std::thread producer([&]() {
+    std::this_thread::sleep_for(std::chrono::seconds(kIdleSeconds));
+    produce(location, kMessages / 2, kMessages);
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  double cpu = -cpuSeconds();
+  std::vector<std::string> lines;
+  std::string line;
+  while (lines.size() < kMessages) {
+    VINEYARD_CHECK_OK(reader->ReadLine(line));
+    lines.emplace_back(line);
+  }
+  cpu += cpuSeconds();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  producer.join();
+
+  for (size_t index = 0; index < kMessages; ++index) {
+    CHECK_EQ(lines[index], makeMessage(index));
+  }
+  CHECK_GE(elapsed.count(), kIdleSeconds - 1);
+  // a spinning reader would burn a core for the whole wait
+  CHECK_LT(cpu, elapsed.count() / 2);
+  LOG(INFO) << "Waited " << elapsed.count() << " seconds with " << cpu
+            << " seconds of CPU time";
+
+  // the partition ends once it has been idle for the time interval
+  CHECK(reader->ReadLine(line).IsEndOfFile());
+  VINEYARD_CHECK_OK(reader->Close());
+
+  LOG(INFO) << "Passed waiting for messages tests...";
+
+  // the rows are produced in batches, and delivered in order
+  {
+    std::string table_location = "kafka://" + brokers + "/" +
+                                  makeTopic("kafka_io_adaptor_table_test") +
+                                  "/group/1";
+    auto writer = IOFactory::CreateIOAdaptor(table_location);
+    CHECK(writer != nullptr);
+    VINEYARD_CHECK_OK(writer->Configure("delimiter", "|"));
+    VINEYARD_CHECK_OK(writer->Configure("linger_ms", "20"));
+    VINEYARD_CHECK_OK(writer->Configure("batch_num_messages", "1000"));
+    VINEYARD_CHECK_OK(writer->Open("w"));
+    VINEYARD_CHECK_OK(writer->WriteTable(makeTable()));
+    VINEYARD_CHECK_OK(writer->Flush());
+
+    // the types that can't be written are rejected
+    arrow::ListBuilder list_builder(arrow::default_memory_pool(),
+                                    std::make_shared<arrow::Int64Builder>());
+    CHECK_ARROW_ERROR(list_builder.Append());
+    std::shared_ptr<arrow::Array> lists;
+    CHECK_ARROW_ERROR(list_builder.Finish(&lists));
+    auto list_table = arrow::Table::Make(
+        arrow::schema({arrow::field("l", lists->type())}), {lists});
+    CHECK(writer->WriteTable(list_table).IsNotImplemented());
+    VINEYARD_CHECK_OK(writer->Close());
+
+    auto table_reader = IOFactory::CreateIOAdaptor(table_location);
+    CHECK(table_reader != nullptr);
+    VINEYARD_CHECK_OK(table_reader->Open());
+    for (int64_t row = 0; row < kRows; ++row) {
+      VINEYARD_CHECK_OK(table_reader->ReadLine(line));
+      CHECK_EQ(line, makeRow(row));
+    }
+    VINEYARD_CHECK_OK(table_reader->Close());
+  }
+  LOG(INFO) << "Passed writing tables tests...";
+
+#if defined(KAFKA_ENABLED)
+  // the messages are parsed into the batches of a stream, which is read
+  // while the partition is being consumed
+  {
+    Client client;
+    VINEYARD_CHECK_OK(client.Connect(argv[1]));
+    std::string stream_location = "kafka://" + brokers + "/" +
+                                  makeTopic("kafka_io_adaptor_stream_test") +
+                                  "/group/1";
+    auto writer = IOFactory::CreateIOAdaptor(stream_location);
+    CHECK(writer != nullptr);
+    VINEYARD_CHECK_OK(writer->Configure("delimiter", "|"));
+    VINEYARD_CHECK_OK(writer->Open("w"));
+    VINEYARD_CHECK_OK(writer->WriteTable(makeTable()));
+    VINEYARD_CHECK_OK(writer->Flush());
+    VINEYARD_CHECK_OK(writer->Close());
+
+    auto io_adaptor = IOFactory::CreateIOAdaptor(stream_location);
+    auto stream_reader = dynamic_cast<KafkaIOAdaptor*>(io_adaptor.get());
+    CHECK(stream_reader != nullptr);
+    VINEYARD_CHECK_OK(stream_reader->Configure("batch_size", "1000"));
+    VINEYARD_CHECK_OK(stream_reader->Configure("time_interval", "1"));
+    std::unordered_map<std::string, std::string> params{
+        {"header_row", "1"},
+        {"header_line", "i|d|s|b"},
+        {"delimiter", "|"},
+        {"schema", "0,1,2,3"},
+        {"column_types", "int64,double,string,bool"}};
+    std::thread consumer;
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    VINEYARD_CHECK_OK(stream_reader->ConsumeToStream(
+        client, params, [&](ObjectID const stream_id) {
+          consumer = std::thread([&, stream_id]() {
+            Client reader_client;
+            VINEYARD_CHECK_OK(reader_client.Connect(argv[1]));
+            auto stream =
+                reader_client.GetObject<RecordBatchStream>(stream_id);
+            CHECK(stream != nullptr);
+            auto stream_params = stream->GetParams();
+            for (auto const& kv : params) {
+              CHECK_EQ(stream_params.at(kv.first), kv.second);
+            }
+            std::unique_ptr<RecordBatchStreamReader> reader;
+            VINEYARD_CHECK_OK(stream->OpenReader(reader_client, reader));
+            VINEYARD_CHECK_OK(reader->ReadRecordBatches(batches));
+          });
+        }));
+    consumer.join();
+
+    // a batch for every `batch_size` messages of the single partition
+    CHECK_GE(batches.size(), static_cast<size_t>(kRows / 1000));
+    int64_t first = 0;
+    for (auto const& batch : batches) {
+      CHECK_LE(batch->num_rows(), 1000);
+      std::shared_ptr<arrow::Table> table;
+      VINEYARD_CHECK_OK(RecordBatchesToTable({batch}, &table));
+      checkRows(table, first);
+      first += batch->num_rows();
+    }
+    CHECK_EQ(first, kRows);
+    client.Disconnect();
+  }
+  LOG(INFO) << "Passed consuming to streams tests...";
+#endif  // KAFKA_ENABLED
+
+  LOG(INFO) << "Passed kafka io adaptor tests...";
+
+  return 0;
+}
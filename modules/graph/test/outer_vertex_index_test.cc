@@ -0,0 +1,137 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "graph/fragment/outer_vertex_index.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+using vid_t = uint64_t;
+
+constexpr vid_t kStart = 1000;
+
+// Every gid in [0, max + 2] is found by the index iff it is in the list, at
+// the lid of its position, both one by one and in batches.
+void checkIndex(std::vector<vid_t> const& gids) {
+  OuterVertexIndex<vid_t> index;
+  index.Init(gids.data(), gids.size(), kStart);
+  CHECK_EQ(index.size(), gids.size());
+
+  std::map<vid_t, vid_t> expected;
+  for (size_t k = 0; k < gids.size(); ++k) {
+    expected[gids[k]] = kStart + k;
+  }
+  vid_t max_gid =
+      gids.empty() ? 0 : *std::max_element(gids.begin(), gids.end());
+  std::vector<vid_t> queries;
+  for (vid_t gid = 0; gid <= max_gid + 2; ++gid) {
+    queries.push_back(gid);
+  }
+  std::shuffle(queries.begin(), queries.end(), std::mt19937(gids.size()));
+
+  std::vector<vid_t> lids(queries.size(), 0);
+  std::unique_ptr<bool[]> found(new bool[queries.size()]);
+  index.FindBatch(queries.data(), queries.size(), lids.data(), found.get());
+  for (size_t i = 0; i < queries.size(); ++i) {
+    auto iter = expected.find(queries[i]);
+    vid_t lid = 0;
+    CHECK_EQ(index.Find(queries[i], lid), iter != expected.end());
+    CHECK_EQ(found[i], iter != expected.end());
+    if (iter != expected.end()) {
+      CHECK_EQ(lid, iter->second);
+      CHECK_EQ(lids[i], iter->second);
+    } else {
+      CHECK_EQ(lids[i], 0U);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./outer_vertex_index_test <ipc_socket>");
+    return 1;
+  }
+
+  // the sorted lists are borrowed, including the lists of every size
+  // around the groups of the batched searches
+  for (size_t size : {0, 1, 2, 3, 15, 16, 17, 33, 1000}) {
+    std::vector<vid_t> gids;
+    for (size_t k = 0; k < size; ++k) {
+      gids.push_back(3 * k + 1 + (k % 2));
+    }
+    checkIndex(gids);
+  }
+
+  // the gids of the outer vertices are bounded by the vid of the fragment
+  {
+    std::vector<vid_t> gids{0, std::numeric_limits<vid_t>::max() - 3};
+    OuterVertexIndex<vid_t> index;
+    index.Init(gids.data(), gids.size(), kStart);
+    vid_t lid = 0;
+    CHECK(index.Find(0, lid));
+    CHECK_EQ(lid, kStart);
+    CHECK(index.Find(gids[1], lid));
+    CHECK_EQ(lid, kStart + 1);
+    CHECK(!index.Find(std::numeric_limits<vid_t>::max(), lid));
+  }
+  LOG(INFO) << "Passed sorted outer vertex index tests...";
+
+  // the appended outer vertices leave the lists unsorted, which are sorted
+  // by a copy
+  for (size_t size : {2, 17, 1000}) {
+    std::vector<vid_t> gids;
+    for (size_t k = 0; k < size; ++k) {
+      gids.push_back(5 * k + 2);
+    }
+    std::shuffle(gids.begin(), gids.end(), std::mt19937(size));
+    checkIndex(gids);
+
+    // the sorted prefix with the new vertices after it
+    std::vector<vid_t> appended(gids);
+    std::sort(appended.begin(), appended.end() - size / 2);
+    checkIndex(appended);
+  }
+
+  // the index is rebuilt once the list changes
+  {
+    std::vector<vid_t> gids{9, 3, 7};
+    OuterVertexIndex<vid_t> index;
+    index.Init(gids.data(), gids.size(), kStart);
+    vid_t lid = 0;
+    CHECK(index.Find(3, lid));
+    CHECK_EQ(lid, kStart + 1);
+    std::vector<vid_t> sorted{2, 4};
+    index.Init(sorted.data(), sorted.size(), 0);
+    CHECK_EQ(index.size(), 2U);
+    CHECK(!index.Find(3, lid));
+    CHECK(index.Find(4, lid));
+    CHECK_EQ(lid, 1U);
+  }
+  LOG(INFO) << "Passed unsorted outer vertex index tests...";
+
+  LOG(INFO) << "Passed outer vertex index tests...";
+
+  return 0;
+}
@@ -0,0 +1,192 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+
+#include "graph/utils/partitioner.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+template <typename OID_T>
+void checkSameAssignment(fid_t fnum, std::vector<OID_T> const& oid_list) {
+  SegmentedPartitioner<OID_T> segmented;
+  segmented.Init(fnum, oid_list);
+  RangePartitioner<OID_T> range;
+  range.Init(fnum, oid_list);
+  for (auto const& oid : oid_list) {
+    CHECK_EQ(segmented.GetPartitionId(oid), range.GetPartitionId(oid));
+  }
+}
+
+void checkGridEdgePartitioner(fid_t fnum) {
+  GridEdgePartitioner partitioner;
+  partitioner.Init(fnum);
+  CHECK_EQ(partitioner.rows() * partitioner.cols(), fnum);
+  CHECK_LE(partitioner.rows(), partitioner.cols());
+
+  // the fragments that hold the edges of the vertices owned by `fid`
+  std::vector<std::set<fid_t>> mirrors(fnum);
+  for (fid_t src = 0; src < fnum; ++src) {
+    for (fid_t dst = 0; dst < fnum; ++dst) {
+      fid_t fid = partitioner.GetPartitionId(src, dst);
+      CHECK_LT(fid, fnum);
+      mirrors[src].insert(fid);
+      mirrors[dst].insert(fid);
+    }
+  }
+  for (fid_t fid = 0; fid < fnum; ++fid) {
+    CHECK_LE(mirrors[fid].size(),
+             partitioner.rows() + partitioner.cols() - 1);
+  }
+}
+
+// the batches are partitioned the same as the oids one by one
+void checkBatchPartitions(fid_t fnum) {
+  std::mt19937_64 random(fnum);
+  std::vector<int64_t> oids = {0, -1, 1, std::numeric_limits<int64_t>::min(),
+                               std::numeric_limits<int64_t>::max()};
+  for (int index = 0; index < 1000; ++index) {
+    oids.push_back(static_cast<int64_t>(random()));
+  }
+  arrow::Int64Builder oid_builder;
+  CHECK(oid_builder.AppendValues(oids).ok());
+  std::shared_ptr<arrow::Int64Array> oid_array;
+  CHECK(oid_builder.Finish(&oid_array).ok());
+
+  HashPartitioner<int64_t> partitioner;
+  partitioner.Init(fnum);
+  std::vector<fid_t> fids(oids.size());
+  partitioner.GetPartitionIds(*oid_array, fids.data());
+  for (size_t index = 0; index < oids.size(); ++index) {
+    CHECK_EQ(fids[index], partitioner.GetPartitionId(oids[index]));
+    CHECK_LT(fids[index], fnum);
+  }
+
+  std::vector<uint64_t> unsigned_oids(oids.begin(), oids.end());
+  HashPartitioner<uint64_t> unsigned_partitioner;
+  unsigned_partitioner.Init(fnum);
+  unsigned_partitioner.GetPartitionIds(unsigned_oids.data(),
+                                       unsigned_oids.size(), fids.data());
+  for (size_t index = 0; index < unsigned_oids.size(); ++index) {
+    CHECK_EQ(fids[index], unsigned_oids[index] % fnum);
+  }
+
+  // the string oids, whose number isn't a multiple of the group size
+  std::vector<std::string> names;
+  for (int index = 0; index < 103; ++index) {
+    names.emplace_back(std::string(index % 34, 'a' + index % 26) +
+                       std::to_string(random()));
+  }
+  names.emplace_back("");
+  arrow::LargeStringBuilder name_builder;
+  CHECK(name_builder.AppendValues(names).ok());
+  std::shared_ptr<arrow::LargeStringArray> name_array;
+  CHECK(name_builder.Finish(&name_array).ok());
+
+  HashPartitioner<std::string> string_partitioner;
+  string_partitioner.Init(fnum);
+  std::vector<fid_t> name_fids(names.size());
+  string_partitioner.GetPartitionIds(*name_array, name_fids.data());
+  std::vector<arrow::util::string_view> views(names.begin(), names.end());
+  std::vector<fid_t> view_fids(names.size());
+  string_partitioner.GetPartitionIds(views.data(), views.size(),
+                                     view_fids.data());
+  for (size_t index = 0; index < names.size(); ++index) {
+    fid_t expected = string_partitioner.GetPartitionId(names[index]);
+    CHECK_EQ(name_fids[index], expected);
+    CHECK_EQ(view_fids[index], expected);
+    CHECK_EQ(expected, std::hash<std::string>()(names[index]) % fnum);
+  }
+
+  // the segmented and range partitioners have the same interface
+  std::vector<int64_t> sorted_oids(oids);
+  std::sort(sorted_oids.begin(), sorted_oids.end());
+  RangePartitioner<int64_t> range;
+  range.Init(fnum, sorted_oids);
+  range.GetPartitionIds(*oid_array, fids.data());
+  for (size_t index = 0; index < oids.size(); ++index) {
+    CHECK_EQ(fids[index], range.GetPartitionId(oids[index]));
+  }
+  SegmentedPartitioner<std::string> segmented;
+  segmented.Init(fnum, names);
+  segmented.GetPartitionIds(*name_array, name_fids.data());
+  for (size_t index = 0; index < names.size(); ++index) {
+    CHECK_EQ(name_fids[index], segmented.GetPartitionId(names[index]));
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./partitioner_test <ipc_socket>");
+    return 1;
+  }
+
+  for (fid_t fnum : {1, 2, 3, 7}) {
+    std::vector<int64_t> oids;
+    for (int64_t oid = 0; oid < 1000; ++oid) {
+      oids.push_back(oid * 3 + 1);
+    }
+    checkSameAssignment<int64_t>(fnum, oids);
+
+    // a dense range is split the same way without the oid list
+    std::vector<int64_t> dense(1000);
+    std::iota(dense.begin(), dense.end(), 0);
+    SegmentedPartitioner<int64_t> segmented;
+    segmented.Init(fnum, dense);
+    RangePartitioner<int64_t> range;
+    range.Init(fnum, int64_t{0}, int64_t{1000});
+    for (auto const oid : dense) {
+      CHECK_EQ(segmented.GetPartitionId(oid), range.GetPartitionId(oid));
+    }
+
+    // an unsorted list is partitioned as if it were sorted
+    std::vector<int64_t> shuffled(oids);
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(fnum));
+    RangePartitioner<int64_t> unsorted;
+    unsorted.Init(fnum, shuffled);
+    SegmentedPartitioner<int64_t> sorted;
+    sorted.Init(fnum, oids);
+    for (auto const oid : shuffled) {
+      CHECK_EQ(sorted.GetPartitionId(oid), unsorted.GetPartitionId(oid));
+    }
+
+    std::vector<std::string> names;
+    for (int index = 0; index < 100; ++index) {
+      char name[16];
+      snprintf(name, sizeof(name), "v%04d", index);
+      names.emplace_back(name);
+    }
+    checkSameAssignment<std::string>(fnum, names);
+  }
+  for (fid_t fnum = 1; fnum <= 32; ++fnum) {
+    checkGridEdgePartitioner(fnum);
+  }
+  for (fid_t fnum : {1, 2, 3, 7, 8, 13, 64, 1000, 1023}) {
+    checkBatchPartitions(fnum);
+  }
+  LOG(INFO) << "Passed partitioner tests...";
+  return 0;
+}
@@ -0,0 +1,127 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/io/file.h"
+#include "glog/logging.h"
+
+#include "common/util/status.h"
+#include "io/io/readahead_input_stream.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The ranges are read with reads that fall within a chunk, span several
+// chunks, or are larger than the remaining bytes.
+constexpr int64_t kFileSize = 1000003;
+constexpr int64_t kReadSizes[] = {1, 7, 4096, 65537, 300000};
+
+char content(int64_t const offset) {
+  return static_cast<char>((offset * 13) % 251);
+}
+
+void checkRange(std::shared_ptr<arrow::io::RandomAccessFile> file,
+                int64_t offset, int64_t nbytes, int64_t chunk_size,
+                size_t depth) {
+  ReadAheadInputStream stream(file, offset, nbytes, chunk_size, depth);
+  int64_t position = 0;
+  std::vector<char> out;
+  for (size_t round = 0; position < nbytes; ++round) {
+    int64_t size = kReadSizes[round % (sizeof(kReadSizes) / sizeof(int64_t))];
+    int64_t expected = std::min(size, nbytes - position);
+    const char* data = nullptr;
+    std::shared_ptr<arrow::Buffer> buffer;
+    if (round % 2 == 0) {
+      auto result = stream.Read(size);
+      CHECK(result.ok());
+      buffer = result.ValueOrDie();
+      CHECK_EQ(buffer->size(), expected);
+      data = reinterpret_cast<const char*>(buffer->data());
+    } else {
+      out.resize(size);
+      auto result = stream.Read(size, out.data());
+      CHECK(result.ok());
+      CHECK_EQ(result.ValueOrDie(), expected);
+      data = out.data();
+    }
+    for (int64_t i = 0; i < expected; ++i) {
+      CHECK_EQ(data[i], content(offset + position + i));
+    }
+    position += expected;
+    CHECK_EQ(stream.Tell().ValueOrDie(), position);
+  }
+  // the end of the range
+  auto result = stream.Read(16);
+  CHECK(result.ok());
+  CHECK_EQ(result.ValueOrDie()->size(), 0);
+  CHECK(stream.Close().ok());
+  CHECK(stream.closed());
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./readahead_input_stream_test <ipc_socket>");
+    return 1;
+  }
+
+  char path[] = "/tmp/readahead_input_stream_test_XXXXXX";
+  int fd = mkstemp(path);
+  CHECK_GE(fd, 0);
+  close(fd);
+  {
+    std::ofstream stream(path, std::ios::binary);
+    for (int64_t offset = 0; offset < kFileSize; ++offset) {
+      stream.put(content(offset));
+    }
+  }
+
+  auto file = arrow::io::ReadableFile::Open(path);
+  CHECK(file.ok());
+  std::shared_ptr<arrow::io::RandomAccessFile> source = file.ValueOrDie();
+
+  for (int64_t chunk_size : {7, 1000, 4096, 1 << 20}) {
+    for (size_t depth : {1, 4}) {
+      checkRange(source, 0, kFileSize, chunk_size, depth);
+      checkRange(source, 12345, 500000, chunk_size, depth);
+      checkRange(source, kFileSize - 17, 17, chunk_size, depth);
+      checkRange(source, 100, 0, chunk_size, depth);
+    }
+  }
+  LOG(INFO) << "Passed reading ahead tests...";
+
+  // the stream is released before the background reads are consumed
+  for (int round = 0; round < 16; ++round) {
+    ReadAheadInputStream stream(source, 0, kFileSize, 4096, 2);
+    CHECK(stream.Read(10).ok());
+  }
+  LOG(INFO) << "Passed releasing the unconsumed chunks tests...";
+
+  CHECK(source->Close().ok());
+  unlink(path);
+
+  LOG(INFO) << "Passed readahead input stream tests...";
+
+  return 0;
+}
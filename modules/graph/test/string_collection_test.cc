@@ -0,0 +1,154 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "grape/communication/sync_comm.h"
+#include "grape/serialization/in_archive.h"
+#include "grape/serialization/out_archive.h"
+
+#include "graph/utils/string_collection.h"
+
+using grape::RefString;
+
+// Strings of various lengths, including the empty one, the ones that aren't
+// a multiple of the 8 bytes that the hash consumes at a time, and the ones
+// that only differ in their last byte.
+std::vector<std::string> makeStrings(size_t count) {
+  std::vector<std::string> strings;
+  strings.emplace_back("");
+  for (size_t index = 0; strings.size() < count; ++index) {
+    std::string str(index % 37, static_cast<char>('a' + index % 26));
+    str += std::to_string(index);
+    strings.emplace_back(str);
+  }
+  return strings;
+}
+
+void checkRSVector(std::vector<std::string> const& strings) {
+  grape::RSVector rsv;
+  for (auto const& str : strings) {
+    rsv.emplace_back(str);
+  }
+  CHECK_EQ(rsv.size(), strings.size());
+
+  // the views and the iterators visit the same strings in order
+  size_t index = 0;
+  rsv.ForEach([&](const RefString& rs) {
+    CHECK_EQ(rs.ToString(), strings[index]);
+    ++index;
+  });
+  CHECK_EQ(index, strings.size());
+  index = 0;
+  for (auto iter = rsv.begin(); iter != rsv.end(); ++iter) {
+    const RefString& rs = *iter;
+    CHECK_EQ(rs.ToString(), strings[index]);
+    ++index;
+  }
+  CHECK_EQ(index, strings.size());
+
+  std::vector<std::string> materialized = rsv;
+  CHECK(materialized == strings);
+
+  // the hashes of one pass are the same as the ones of each string
+  std::vector<size_t> hashes;
+  rsv.Hashes(hashes);
+  CHECK_EQ(hashes.size(), strings.size());
+  std::hash<RefString> hasher;
+  for (size_t id = 0; id < strings.size(); ++id) {
+    RefString rs(strings[id]);
+    CHECK_EQ(hashes[id], grape::HashRefString(rs));
+    CHECK_EQ(hashes[id], hasher(rs));
+  }
+
+  // the strings are copied into a single allocation
+  grape::RSVector assigned;
+  assigned.emplace_back(std::string("stale"));
+  assigned.assign(strings.begin(), strings.end());
+  CHECK_EQ(assigned.size(), strings.size());
+  CHECK_EQ(assigned.size_in_bytes(), rsv.size_in_bytes());
+  CHECK_EQ(memcmp(assigned.data(), rsv.data(), rsv.size_in_bytes()), 0);
+}
+
+void checkStringCollection(std::vector<std::string> const& strings) {
+  grape::StringCollection collection;
+  collection.Reserve(strings.size());
+  for (size_t index = 0; index < strings.size(); ++index) {
+    CHECK_EQ(collection.Put(strings[index]), index);
+  }
+  CHECK_EQ(collection.Count(), strings.size());
+
+  size_t visited = 0;
+  collection.ForEach([&](size_t id, const RefString& rs) {
+    CHECK_EQ(id, visited);
+    CHECK_EQ(rs.ToString(), strings[id]);
+    ++visited;
+  });
+  CHECK_EQ(visited, strings.size());
+
+  // the hashes are computed lazily, and extended for the strings that are
+  // put afterwards
+  for (size_t id = 0; id < strings.size(); ++id) {
+    CHECK_EQ(collection.Hash(id), grape::HashRefString(RefString(strings[id])));
+  }
+  std::string const extra = "the string put after the hashes";
+  size_t extra_id = collection.Put(extra);
+  CHECK_EQ(collection.Hash(extra_id), grape::HashRefString(RefString(extra)));
+  collection.BuildHashes();
+  CHECK_EQ(collection.Hash(0), grape::HashRefString(RefString(strings[0])));
+
+  grape::StringCollection moved(std::move(collection));
+  CHECK_EQ(moved.Count(), strings.size() + 1);
+  CHECK_EQ(moved.Hash(extra_id), grape::HashRefString(RefString(extra)));
+  std::string str;
+  CHECK(moved.Get(extra_id, str));
+  CHECK_EQ(str, extra);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./string_collection_test <ipc_socket>");
+    return 1;
+  }
+
+  for (size_t count : {1, 2, 100, 100000}) {
+    auto strings = makeStrings(count);
+    checkRSVector(strings);
+    checkStringCollection(strings);
+  }
+
+  // equal strings hash the same, the others rarely collide
+  {
+    auto strings = makeStrings(100000);
+    std::unordered_set<size_t> hashes;
+    for (auto const& str : strings) {
+      hashes.insert(grape::HashRefString(RefString(str)));
+      CHECK_EQ(grape::HashRefString(RefString(str)),
+               grape::HashRefString(RefString(std::string(str))));
+    }
+    CHECK_EQ(hashes.size(), strings.size());
+  }
+
+  LOG(INFO) << "Passed string collection tests...";
+
+  return 0;
+}
@@ -0,0 +1,303 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "glog/logging.h"
+#include "grape/worker/comm_spec.h"
+
+#include "basic/ds/arrow_utils.h"
+#include "graph/utils/partitioner.h"
+#include "graph/fragment/property_graph_utils.h"
+#include "graph/utils/error.h"
+#include "graph/utils/table_shuffler.h"
+#include "graph/utils/table_shuffler_beta.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// More rows than a single shuffle message holds, in batches of a few sizes.
+constexpr int64_t kRows = 2 * shuffle_chunk_rows + 17;
+constexpr int64_t kBatchRows[] = {1, 100000, 250007};
+
+// The vertices of every worker, i.e., `oid, oid * 3, "v<oid>"`, where the
+// oids of the worker are `worker_id + k * worker_num`.
+std::shared_ptr<arrow::Table> makeVertexTable(const grape::CommSpec& comm_spec,
+                                              int64_t rows) {
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  auto schema = arrow::schema({arrow::field("id", arrow::int64()),
+                               arrow::field("value", arrow::int64()),
+                               arrow::field("name", arrow::utf8())});
+  int64_t k = 0;
+  for (size_t index = 0; k < rows || batches.empty(); ++index) {
+    int64_t batch_rows = std::min(
+        kBatchRows[index % (sizeof(kBatchRows) / sizeof(int64_t))], rows - k);
+    arrow::Int64Builder id_builder, value_builder;
+    arrow::StringBuilder name_builder;
+    for (int64_t i = 0; i < batch_rows; ++i, ++k) {
+      int64_t oid = comm_spec.worker_id() + k * comm_spec.worker_num();
+      CHECK_ARROW_ERROR(id_builder.Append(oid));
+      CHECK_ARROW_ERROR(value_builder.Append(oid * 3));
+      CHECK_ARROW_ERROR(name_builder.Append("v" + std::to_string(oid)));
+    }
+    std::shared_ptr<arrow::Array> ids, values, names;
+    CHECK_ARROW_ERROR(id_builder.Finish(&ids));
+    CHECK_ARROW_ERROR(value_builder.Finish(&values));
+    CHECK_ARROW_ERROR(name_builder.Finish(&names));
+    batches.emplace_back(
+        arrow::RecordBatch::Make(schema, batch_rows, {ids, values, names}));
+  }
+  std::shared_ptr<arrow::Table> table;
+  VINEYARD_CHECK_OK(RecordBatchesToTable(batches, &table));
+  return table;
+}
+
+// Every row arrives at the fragment of its oid, with all of its columns.
+template <typename PARTITIONER_T>
+void checkVertexTable(const grape::CommSpec& comm_spec,
+                      const PARTITIONER_T& partitioner,
+                      std::shared_ptr<arrow::Table> const& table,
+                      int64_t rows) {
+  CHECK_EQ(table->num_columns(), 3);
+  int64_t local_rows = table->num_rows();
+  for (int chunk = 0; chunk < table->column(0)->num_chunks(); ++chunk) {
+    auto ids = std::dynamic_pointer_cast<arrow::Int64Array>(
+        table->column(0)->chunk(chunk));
+    auto values = std::dynamic_pointer_cast<arrow::Int64Array>(
+        table->column(1)->chunk(chunk));
+    auto names = std::dynamic_pointer_cast<arrow::StringArray>(
+        table->column(2)->chunk(chunk));
+    for (int64_t i = 0; i < ids->length(); ++i) {
+      int64_t oid = ids->Value(i);
+      CHECK_EQ(partitioner.GetPartitionId(oid), comm_spec.fid());
+      CHECK_EQ(values->Value(i), oid * 3);
+      CHECK_EQ(names->GetString(i), "v" + std::to_string(oid));
+    }
+  }
+  int64_t total_rows = 0;
+  MPI_Allreduce(&local_rows, &total_rows, 1, MPI_INT64_T, MPI_SUM,
+                comm_spec.comm());
+  CHECK_EQ(total_rows, rows * comm_spec.worker_num());
+}
+
+// The vertex table with a list column, i.e., `oid, [oid, oid + 1]`, which
+// cannot be gathered by `Take`.
+std::shared_ptr<arrow::Table> makeListTable(const grape::CommSpec& comm_spec,
+                                            int64_t rows) {
+  auto value_builder = std::make_shared<arrow::Int64Builder>();
+  arrow::ListBuilder list_builder(arrow::default_memory_pool(),
+                                  value_builder);
+  arrow::Int64Builder id_builder;
+  for (int64_t k = 0; k < rows; ++k) {
+    int64_t oid = comm_spec.worker_id() + k * comm_spec.worker_num();
+    CHECK_ARROW_ERROR(id_builder.Append(oid));
+    CHECK_ARROW_ERROR(list_builder.Append());
+    CHECK_ARROW_ERROR(value_builder->Append(oid));
+    CHECK_ARROW_ERROR(value_builder->Append(oid + 1));
+  }
+  std::shared_ptr<arrow::Array> ids, lists;
+  CHECK_ARROW_ERROR(id_builder.Finish(&ids));
+  CHECK_ARROW_ERROR(list_builder.Finish(&lists));
+  auto schema = arrow::schema({arrow::field("id", ids->type()),
+                               arrow::field("list", lists->type())});
+  return arrow::Table::Make(schema, {ids, lists});
+}
+
+template <typename PARTITIONER_T>
+std::shared_ptr<arrow::Table> shuffleByBeta(
+    const grape::CommSpec& comm_spec, const PARTITIONER_T& partitioner,
+    std::shared_ptr<arrow::Table> table) {
+  return boost::leaf::try_handle_all(
+      [&]() {
+        return beta::ShufflePropertyVertexTable(comm_spec, partitioner, table);
+      },
+      [](const GSError& e) {
+        LOG(FATAL) << e.error_msg;
+        return std::shared_ptr<arrow::Table>(nullptr);
+      },
+      [](const boost::leaf::error_info& unmatched) {
+        LOG(FATAL) << "Unmatched error " << unmatched;
+        return std::shared_ptr<arrow::Table>(nullptr);
+      });
+}
+
+// The rows of each fragment keep their order, whether gathered by `Take` or
+// appended one by one.
+void checkDividedRecords(const grape::CommSpec& comm_spec,
+                         std::shared_ptr<arrow::Table> const& table,
+                         int64_t rows) {
+  fid_t fnum = comm_spec.fnum();
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  VINEYARD_CHECK_OK(TableToRecordBatches(table, &batches));
+  std::vector<std::vector<std::shared_ptr<arrow::RecordBatch>>> divided(fnum);
+  VINEYARD_CHECK_OK(DivideRecordBatches(
+      comm_spec, batches, 1,
+      [&](size_t batch_index, int64_t row, fid_t* fids) {
+        auto ids = std::dynamic_pointer_cast<arrow::Int64Array>(
+            batches[batch_index]->column(0));
+        fids[0] = static_cast<fid_t>(ids->Value(row) % fnum);
+      },
+      divided));
+  int64_t divided_rows = 0;
+  for (fid_t fid = 0; fid < fnum; ++fid) {
+    int64_t last = -1;
+    for (auto const& batch : divided[fid]) {
+      CHECK(batch->schema()->Equals(*table->schema()));
+      auto ids = std::dynamic_pointer_cast<arrow::Int64Array>(batch->column(0));
+      for (int64_t i = 0; i < ids->length(); ++i) {
+        CHECK_EQ(static_cast<fid_t>(ids->Value(i) % fnum), fid);
+        CHECK_GT(ids->Value(i), last);
+        last = ids->Value(i);
+      }
+      divided_rows += batch->num_rows();
+    }
+  }
+  CHECK_EQ(divided_rows, rows);
+}
+
+// The edges `(k % fnum, (7 * k + 1) % fnum)` of every worker, by the
+// fragments of their endpoints, with a unique id as the property.
+std::shared_ptr<arrow::Table> makeEdgeTable(const grape::CommSpec& comm_spec,
+                                            const IdParser<uint64_t>& parser,
+                                            int64_t rows) {
+  fid_t fnum = comm_spec.fnum();
+  arrow::UInt64Builder src_builder, dst_builder;
+  arrow::Int64Builder id_builder;
+  for (int64_t k = 0; k < rows; ++k) {
+    CHECK_ARROW_ERROR(src_builder.Append(parser.GenerateId(k % fnum, 0, k)));
+    CHECK_ARROW_ERROR(
+        dst_builder.Append(parser.GenerateId((7 * k + 1) % fnum, 0, k)));
+    CHECK_ARROW_ERROR(id_builder.Append(comm_spec.worker_id() * rows + k));
+  }
+  std::shared_ptr<arrow::Array> srcs, dsts, ids;
+  CHECK_ARROW_ERROR(src_builder.Finish(&srcs));
+  CHECK_ARROW_ERROR(dst_builder.Finish(&dsts));
+  CHECK_ARROW_ERROR(id_builder.Finish(&ids));
+  auto schema = arrow::schema({arrow::field("src", srcs->type()),
+                               arrow::field("dst", dsts->type()),
+                               arrow::field("id", ids->type())});
+  return arrow::Table::Make(schema, {srcs, dsts, ids});
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./table_shuffler_test <ipc_socket>");
+    return 1;
+  }
+
+  grape::InitMPIComm();
+  {
+    grape::CommSpec comm_spec;
+    comm_spec.Init(MPI_COMM_WORLD);
+
+    HashPartitioner<int64_t> partitioner;
+    partitioner.Init(comm_spec.fnum());
+
+    // the batches of each destination are sent in several messages
+    for (int64_t rows : {int64_t{0}, int64_t{1000}, kRows}) {
+      auto table = makeVertexTable(comm_spec, rows);
+      std::shared_ptr<arrow::Table> shuffled;
+      VINEYARD_CHECK_OK(
+          ShufflePropertyVertexTable(comm_spec, partitioner, table, shuffled));
+      checkVertexTable(comm_spec, partitioner, shuffled, rows);
+    }
+    LOG(INFO) << "Passed shuffling vertex tables tests...";
+
+    // the rows are assigned to fragments in pieces on many threads
+    checkDividedRecords(comm_spec, makeVertexTable(comm_spec, kRows), kRows);
+    checkDividedRecords(comm_spec, makeListTable(comm_spec, 1000), 1000);
+    LOG(INFO) << "Passed dividing record batches tests...";
+
+    // an edge goes to the fragments of both endpoints, once if they are
+    // the same
+    {
+      IdParser<uint64_t> parser;
+      parser.Init(comm_spec.fnum(), 1);
+      int64_t const rows = 100000;
+      auto table = makeEdgeTable(comm_spec, parser, rows);
+      std::shared_ptr<arrow::Table> shuffled;
+      VINEYARD_CHECK_OK(
+          ShufflePropertyEdgeTable(comm_spec, parser, 0, 1, table, shuffled));
+      CHECK(shuffled->schema()->Equals(*table->schema()));
+      int64_t expected_rows = 0, shuffled_rows = shuffled->num_rows();
+      for (int64_t k = 0; k < rows; ++k) {
+        expected_rows += k % comm_spec.fnum() == (7 * k + 1) % comm_spec.fnum()
+                             ? 1
+                             : 2;
+      }
+      for (int chunk = 0; chunk < shuffled->column(0)->num_chunks(); ++chunk) {
+        auto srcs = std::dynamic_pointer_cast<arrow::UInt64Array>(
+            shuffled->column(0)->chunk(chunk));
+        auto dsts = std::dynamic_pointer_cast<arrow::UInt64Array>(
+            shuffled->column(1)->chunk(chunk));
+        for (int64_t i = 0; i < srcs->length(); ++i) {
+          CHECK(parser.GetFid(srcs->Value(i)) == comm_spec.fid() ||
+                parser.GetFid(dsts->Value(i)) == comm_spec.fid());
+        }
+      }
+      int64_t total_expected_rows = 0, total_shuffled_rows = 0;
+      MPI_Allreduce(&expected_rows, &total_expected_rows, 1, MPI_INT64_T,
+                    MPI_SUM, comm_spec.comm());
+      MPI_Allreduce(&shuffled_rows, &total_shuffled_rows, 1, MPI_INT64_T,
+                    MPI_SUM, comm_spec.comm());
+      CHECK_EQ(total_shuffled_rows, total_expected_rows);
+    }
+    LOG(INFO) << "Passed shuffling edge tables tests...";
+
+    // the rows gathered by `Take` are shuffled as arrow IPC messages
+    for (int64_t rows : {int64_t{0}, int64_t{1000}, kRows}) {
+      auto table = makeVertexTable(comm_spec, rows);
+      checkVertexTable(comm_spec, partitioner,
+                       shuffleByBeta(comm_spec, partitioner, table), rows);
+    }
+
+    // and the list columns are still serialized item by item
+    {
+      int64_t const rows = 1000;
+      auto shuffled =
+          shuffleByBeta(comm_spec, partitioner, makeListTable(comm_spec, rows));
+      CHECK_EQ(shuffled->num_columns(), 2);
+      int64_t local_rows = shuffled->num_rows(), total_rows = 0;
+      for (int chunk = 0; chunk < shuffled->column(0)->num_chunks(); ++chunk) {
+        auto ids = std::dynamic_pointer_cast<arrow::Int64Array>(
+            shuffled->column(0)->chunk(chunk));
+        auto lists = std::dynamic_pointer_cast<arrow::ListArray>(
+            shuffled->column(1)->chunk(chunk));
+        for (int64_t i = 0; i < ids->length(); ++i) {
+          int64_t oid = ids->Value(i);
+          CHECK_EQ(partitioner.GetPartitionId(oid), comm_spec.fid());
+          auto list = std::dynamic_pointer_cast<arrow::Int64Array>(
+              lists->value_slice(i));
+          CHECK_EQ(list->length(), 2);
+          CHECK_EQ(list->Value(0), oid);
+          CHECK_EQ(list->Value(1), oid + 1);
+        }
+      }
+      MPI_Allreduce(&local_rows, &total_rows, 1, MPI_INT64_T, MPI_SUM,
+                    comm_spec.comm());
+      CHECK_EQ(total_rows, rows * comm_spec.worker_num());
+    }
+    LOG(INFO) << "Passed shuffling selected rows tests...";
+  }
+  grape::FinalizeMPIComm();
+
+  LOG(INFO) << "Passed table shuffler tests...";
+  return 0;
+}
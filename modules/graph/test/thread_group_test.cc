@@ -0,0 +1,245 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "glog/logging.h"
+
+#include "common/util/status.h"
+#include "graph/utils/thread_group.h"
+#include "graph/utils/thread_pool.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr int kTasks = 1000;
+
+double cpuSeconds() {
+  struct rusage usage;
+  CHECK_EQ(getrusage(RUSAGE_SELF, &usage), 0);
+  auto seconds = [](struct timeval const& tv) {
+    return tv.tv_sec + tv.tv_usec / 1e6;
+  };
+  return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+}
+
+// Wait until `count` reaches `expected`, which is notified by the tasks.
+struct Latch {
+  std::mutex mutex;
+  std::condition_variable cv;
+  int count = 0;
+
+  void CountDown() {
+    std::lock_guard<std::mutex> lock(mutex);
+    count += 1;
+    cv.notify_all();
+  }
+
+  void Wait(int const expected) {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&]() { return count >= expected; });
+  }
+};
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./thread_group_test <ipc_socket>");
+    return 1;
+  }
+
+  // the tasks submitted by a worker are stolen by the idle workers
+  {
+    ThreadPool pool(4);
+    CHECK_EQ(pool.Concurrency(), 4U);
+    Latch latch;
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    pool.Submit([&]() {
+      for (int task = 0; task < kTasks; ++task) {
+        pool.Submit([&]() {
+          std::this_thread::sleep_for(std::chrono::microseconds(100));
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.insert(std::this_thread::get_id());
+          }
+          latch.CountDown();
+        });
+      }
+    });
+    latch.Wait(kTasks);
+    CHECK_GT(threads.size(), 1U);
+
+    // and the workers sleep once there's no task
+    double cpu = -cpuSeconds();
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    cpu += cpuSeconds();
+    CHECK_LT(cpu, 0.1);
+  }
+  LOG(INFO) << "Passed thread pool tests...";
+
+  // the results are in the order of the tasks, and at most `parallelism`
+  // tasks of a group, plus the one run by the waiting thread, run at the
+  // same time
+  {
+    std::atomic<int> running(0), peak(0);
+    ThreadGroup tg(3);
+    for (int task = 0; task < 64; ++task) {
+      tg.AddTask([&, task]() -> Status {
+        int current = running.fetch_add(1) + 1;
+        int expected = peak.load();
+        while (current > expected &&
+               !peak.compare_exchange_weak(expected, current)) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds((64 - task) % 5));
+        running.fetch_sub(1);
+        if (task % 10 == 0) {
+          return Status::Invalid(std::to_string(task));
+        }
+        return Status::OK();
+      });
+    }
+    auto results = tg.TakeResults();
+    CHECK_EQ(results.size(), 64U);
+    for (int task = 0; task < 64; ++task) {
+      if (task % 10 == 0) {
+        CHECK(results[task].IsInvalid());
+        CHECK_EQ(results[task].message(), std::to_string(task));
+      } else {
+        VINEYARD_CHECK_OK(results[task]);
+      }
+    }
+    CHECK_LE(peak.load(), 3 + 1);
+    CHECK(tg.TakeResults().empty());
+
+    // the exceptions of the tasks become statuses
+    ThreadGroup throwing(2);
+    auto tid = throwing.AddTask([]() -> Status {
+      throw std::runtime_error("thrown by the task");
+    });
+    auto status = throwing.TaskResult(tid);
+    CHECK(status.IsUnknownError());
+    CHECK_EQ(status.message(), "thrown by the task");
+  }
+  LOG(INFO) << "Passed thread group tests...";
+
+  // the nested groups never wait for an idle worker, even on a pool of a
+  // single worker
+  {
+    ThreadPool pool(1);
+    ThreadGroup outer(4, pool);
+    std::atomic<int> count(0);
+    for (int task = 0; task < 8; ++task) {
+      outer.AddTask([&]() -> Status {
+        ThreadGroup inner(4, pool);
+        for (int nested = 0; nested < 8; ++nested) {
+          inner.AddTask([&]() -> Status {
+            count.fetch_add(1);
+            return Status::OK();
+          });
+        }
+        Status status;
+        for (auto const& result : inner.TakeResults()) {
+          status &= result;
+        }
+        return status;
+      });
+    }
+    for (auto const& result : outer.TakeResults()) {
+      VINEYARD_CHECK_OK(result);
+    }
+    CHECK_EQ(count.load(), 64);
+  }
+  LOG(INFO) << "Passed nested thread group tests...";
+
+  // every index is visited once, and the failures are combined
+  {
+    std::vector<std::atomic<int>> visits(kTasks);
+    for (auto& visit : visits) {
+      visit.store(0);
+    }
+    VINEYARD_CHECK_OK(ParallelFor(kTasks, [&](size_t index) -> Status {
+      visits[index].fetch_add(1);
+      return Status::OK();
+    }));
+    for (auto const& visit : visits) {
+      CHECK_EQ(visit.load(), 1);
+    }
+
+    auto status = ParallelFor(
+        kTasks,
+        [&](size_t index) -> Status {
+          return index == 123 ? Status::Invalid("failed") : Status::OK();
+        },
+        3);
+    CHECK(status.IsInvalid());
+    VINEYARD_CHECK_OK(
+        ParallelFor(0, [](size_t) -> Status { return Status::Invalid(); }));
+  }
+  LOG(INFO) << "Passed parallel for tests...";
+
+  // the admitted tasks never exceed the budget, except a task larger than
+  // the budget, which runs alone
+  {
+    std::atomic<size_t> admitted(0), peak(0);
+    MemoryBudget budget(100);
+    ThreadGroup tg(8);
+    for (int task = 0; task < 64; ++task) {
+      tg.AddTask([&, task]() -> Status {
+        size_t const bytes = task % 16 == 0 ? 150 : 40;
+        budget.Acquire(bytes);
+        size_t current = admitted.fetch_add(bytes) + bytes;
+        size_t expected = peak.load();
+        while (current > expected &&
+               !peak.compare_exchange_weak(expected, current)) {
+        }
+        if (bytes > 100) {
+          CHECK_EQ(current, bytes);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        admitted.fetch_sub(bytes);
+        budget.Release(bytes);
+        return Status::OK();
+      });
+    }
+    for (auto const& result : tg.TakeResults()) {
+      VINEYARD_CHECK_OK(result);
+    }
+    CHECK_LE(peak.load(), 150U);
+    CHECK_EQ(admitted.load(), 0U);
+
+    // a zero budget admits every task at once
+    MemoryBudget unlimited(0);
+    for (int task = 0; task < 64; ++task) {
+      unlimited.Acquire(std::numeric_limits<size_t>::max() / 128);
+    }
+  }
+  LOG(INFO) << "Passed memory budget tests...";
+
+  LOG(INFO) << "Passed thread group tests...";
+
+  return 0;
+}
@@ -0,0 +1,112 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_UTILS_LOAD_PROFILE_H_
+#define MODULES_GRAPH_UTILS_LOAD_PROFILE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/util/env.h"
+#include "common/util/functions.h"
+#include "common/util/json.h"
+
+namespace vineyard {
+
+/**
+ * @brief LoadProfile records the wall time and the memory usage of the
+ * phases of loading a fragment on a worker. The phases that run many times,
+ * e.g., once for each label, are accumulated under the same name.
+ */
+class LoadProfile {
+ public:
+  struct Phase {
+    std::string name;
+    double seconds = 0;
+    size_t count = 0;
+    // the memory usage when the phase ends the last time, in bytes
+    size_t rss = 0, shared_rss = 0, peak_rss = 0;
+  };
+
+  /**
+   * @brief Measures the enclosing scope as a phase, does nothing when the
+   * profile is null.
+   */
+  class Scope {
+   public:
+    Scope(LoadProfile* profile, std::string const& name)
+        : profile_(profile), name_(name), start_(GetCurrentTime()) {}
+
+    Scope(std::shared_ptr<LoadProfile> const& profile, std::string const& name)
+        : Scope(profile.get(), name) {}
+
+    Scope(Scope const&) = delete;
+    Scope& operator=(Scope const&) = delete;
+
+    ~Scope() {
+      if (profile_ != nullptr) {
+        profile_->Record(name_, GetCurrentTime() - start_);
+      }
+    }
+
+   private:
+    LoadProfile* profile_;
+    std::string name_;
+    double start_;
+  };
+
+  void Record(std::string const& name, double seconds) {
+    Phase* phase = nullptr;
+    for (auto& item : phases_) {
+      if (item.name == name) {
+        phase = &item;
+        break;
+      }
+    }
+    if (phase == nullptr) {
+      phases_.emplace_back();
+      phase = &phases_.back();
+      phase->name = name;
+    }
+    phase->seconds += seconds;
+    phase->count += 1;
+    phase->rss = get_rss();
+    phase->shared_rss = get_shared_rss();
+    phase->peak_rss = get_peek_rss();
+  }
+
+  std::vector<Phase> const& phases() const { return phases_; }
+
+  json ToJSON() const {
+    json phases = json::array();
+    for (auto const& phase : phases_) {
+      phases.push_back(json{{"name", phase.name},
+                            {"seconds", phase.seconds},
+                            {"count", phase.count},
+                            {"rss", phase.rss},
+                            {"shared_rss", phase.shared_rss},
+                            {"peak_rss", phase.peak_rss}});
+    }
+    return phases;
+  }
+
+ private:
+  std::vector<Phase> phases_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_UTILS_LOAD_PROFILE_H_
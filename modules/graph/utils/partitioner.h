@@ -16,8 +16,11 @@ limitations under the License.
 #ifndef MODULES_GRAPH_UTILS_PARTITIONER_H_
 #define MODULES_GRAPH_UTILS_PARTITIONER_H_
 
+#include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -30,6 +33,72 @@ limitations under the License.
 
 namespace vineyard {
 
+namespace detail {
+
+/**
+ * @brief The remainders of 64-bit integers by an invariant divisor, which
+ * are computed by multiplications rather than divisions, see also "Faster
+ * Remainder by Direct Computation" (Lemire et al.), and by a mask when the
+ * divisor is a power of two.
+ */
+class FastModulo {
+ public:
+  FastModulo() : FastModulo(1) {}
+
+  explicit FastModulo(uint64_t const divisor)
+      : divisor_(divisor), mask_(0), power_of_two_(false) {
+    if (divisor_ != 0 && (divisor_ & (divisor_ - 1)) == 0) {
+      power_of_two_ = true;
+      mask_ = divisor_ - 1;
+    }
+#if defined(__SIZEOF_INT128__)
+    // overflows to zero when the divisor is one, which is still correct
+    multiplier_ = ~static_cast<unsigned __int128>(0) / divisor_ + 1;
+#endif
+  }
+
+  inline uint64_t operator()(uint64_t const value) const {
+    if (power_of_two_) {
+      return value & mask_;
+    }
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 lowbits = multiplier_ * value;
+    unsigned __int128 bottom =
+        (static_cast<unsigned __int128>(static_cast<uint64_t>(lowbits)) *
+         divisor_) >>
+        64;
+    unsigned __int128 top =
+        static_cast<unsigned __int128>(static_cast<uint64_t>(lowbits >> 64)) *
+        divisor_;
+    return static_cast<uint64_t>((bottom + top) >> 64);
+#else
+    return value % divisor_;
+#endif
+  }
+
+ private:
+  uint64_t divisor_, mask_;
+  bool power_of_two_;
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 multiplier_;
+#endif
+};
+
+/**
+ * @brief The same hash value as `std::hash<std::string>`, but without
+ * copying the view to a string.
+ */
+inline size_t HashStringView(arrow::util::string_view const& view) {
+#if defined(__GLIBCXX__)
+  return std::_Hash_bytes(view.data(), view.size(),
+                          static_cast<size_t>(0xc70f6907UL));
+#else
+  return std::hash<std::string>()(std::string(view.data(), view.size()));
+#endif
+}
+
+}  // namespace detail
+
 // TODO(lxj): check if identical to the file in libgrape-lite
 template <typename OID_T>
 class HashPartitioner {
@@ -38,32 +107,57 @@ class HashPartitioner {
 
   HashPartitioner() : fnum_(1) {}
 
-  void Init(fid_t fnum) { fnum_ = fnum; }
+  void Init(fid_t fnum) {
+    fnum_ = fnum;
+    modulo_ = detail::FastModulo(fnum);
+  }
 
   inline fid_t GetPartitionId(const OID_T& oid) const {
     return static_cast<fid_t>(static_cast<uint64_t>(oid) % fnum_);
   }
 
+  /**
+   * @brief The partitions of a batch of oids, which are the same as the ones
+   * of `GetPartitionId()`, but the remainders are computed by
+   * multiplications that pipeline well, rather than a division per oid.
+   */
+  void GetPartitionIds(const OID_T* oids, size_t const n, fid_t* out) const {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = static_cast<fid_t>(modulo_(static_cast<uint64_t>(oids[i])));
+    }
+  }
+
+  template <typename ARRAY_T>
+  void GetPartitionIds(const ARRAY_T& oids, fid_t* out) const {
+    GetPartitionIds(oids.raw_values(), oids.length(), out);
+  }
+
   HashPartitioner& operator=(const HashPartitioner& other) {
     if (this == &other) {
       return *this;
     }
     fnum_ = other.fnum_;
+    modulo_ = other.modulo_;
     return *this;
   }
 
-  HashPartitioner(const HashPartitioner& other) { fnum_ = other.fnum_; }
+  HashPartitioner(const HashPartitioner& other) {
+    fnum_ = other.fnum_;
+    modulo_ = other.modulo_;
+  }
 
   HashPartitioner& operator=(HashPartitioner&& other) {
     if (this == &other) {
       return *this;
     }
     fnum_ = other.fnum_;
+    modulo_ = other.modulo_;
     return *this;
   }
 
  private:
   fid_t fnum_;
+  detail::FastModulo modulo_;
 };
 
 template <>
@@ -73,33 +167,87 @@ class HashPartitioner<std::string> {
 
   HashPartitioner() : fnum_(1) {}
 
-  void Init(fid_t fnum) { fnum_ = fnum; }
+  void Init(fid_t fnum) {
+    fnum_ = fnum;
+    modulo_ = detail::FastModulo(fnum);
+  }
 
   inline fid_t GetPartitionId(const oid_t& oid) const {
     return static_cast<fid_t>(
         static_cast<uint64_t>(std::hash<std::string>()(oid)) % fnum_);
   }
 
+  /**
+   * @brief The partitions of a batch of oids, which are the same as the ones
+   * of `GetPartitionId()`, but the views are hashed in place rather than
+   * being copied to strings, and the remainders are computed by
+   * multiplications. The strings are hashed in groups of 4 in a loop, whose
+   * independent hashes overlap in the pipeline.
+   */
+  void GetPartitionIds(const arrow::util::string_view* oids, size_t const n,
+                       fid_t* out) const {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+      size_t h0 = detail::HashStringView(oids[i]);
+      size_t h1 = detail::HashStringView(oids[i + 1]);
+      size_t h2 = detail::HashStringView(oids[i + 2]);
+      size_t h3 = detail::HashStringView(oids[i + 3]);
+      out[i] = static_cast<fid_t>(modulo_(h0));
+      out[i + 1] = static_cast<fid_t>(modulo_(h1));
+      out[i + 2] = static_cast<fid_t>(modulo_(h2));
+      out[i + 3] = static_cast<fid_t>(modulo_(h3));
+    }
+    for (; i < n; ++i) {
+      out[i] = static_cast<fid_t>(modulo_(detail::HashStringView(oids[i])));
+    }
+  }
+
+  template <typename ARRAY_T>
+  void GetPartitionIds(const ARRAY_T& oids, fid_t* out) const {
+    size_t const n = oids.length();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+      size_t h0 = detail::HashStringView(oids.GetView(i));
+      size_t h1 = detail::HashStringView(oids.GetView(i + 1));
+      size_t h2 = detail::HashStringView(oids.GetView(i + 2));
+      size_t h3 = detail::HashStringView(oids.GetView(i + 3));
+      out[i] = static_cast<fid_t>(modulo_(h0));
+      out[i + 1] = static_cast<fid_t>(modulo_(h1));
+      out[i + 2] = static_cast<fid_t>(modulo_(h2));
+      out[i + 3] = static_cast<fid_t>(modulo_(h3));
+    }
+    for (; i < n; ++i) {
+      out[i] =
+          static_cast<fid_t>(modulo_(detail::HashStringView(oids.GetView(i))));
+    }
+  }
+
   HashPartitioner& operator=(const HashPartitioner& other) {
     if (this == &other) {
       return *this;
     }
     fnum_ = other.fnum_;
+    modulo_ = other.modulo_;
     return *this;
   }
 
-  HashPartitioner(const HashPartitioner& other) { fnum_ = other.fnum_; }
+  HashPartitioner(const HashPartitioner& other) {
+    fnum_ = other.fnum_;
+    modulo_ = other.modulo_;
+  }
 
   HashPartitioner& operator=(HashPartitioner&& other) {
     if (this == &other) {
       return *this;
     }
     fnum_ = other.fnum_;
+    modulo_ = other.modulo_;
     return *this;
   }
 
  private:
   fid_t fnum_;
+  detail::FastModulo modulo_;
 };
 
 #if defined(EXPERIMENTAL_ON) || defined(NETWORKX)
@@ -172,6 +320,13 @@ class SegmentedPartitioner {
 
   inline fid_t GetPartitionId(const OID_T& oid) const { return o2f_.at(oid); }
 
+  template <typename ARRAY_T>
+  void GetPartitionIds(const ARRAY_T& oids, fid_t* out) const {
+    for (int64_t i = 0; i < oids.length(); ++i) {
+      out[i] = GetPartitionId(OID_T(oids.GetView(i)));
+    }
+  }
+
   SegmentedPartitioner& operator=(const SegmentedPartitioner& other) {
     if (this == &other) {
       return *this;
@@ -195,6 +350,139 @@ class SegmentedPartitioner {
   ska::flat_hash_map<OID_T, fid_t> o2f_;
 };
 
+/**
+ * @brief RangePartitioner is the memory-lean counterpart of
+ * SegmentedPartitioner, it splits the sorted oids into `fnum` segments of
+ * equal size and keeps only the `fnum - 1` boundaries between them, rather
+ * than a map entry for every oid. A partition is resolved by a binary search
+ * over the boundaries, or by arithmetic for a dense range of integral oids.
+ *
+ * When the oid list is sorted, the partition of every oid is the same as the
+ * one of SegmentedPartitioner.
+ */
+template <typename OID_T>
+class RangePartitioner {
+ public:
+  using oid_t = OID_T;
+
+  RangePartitioner() : fnum_(1), dense_(false), begin_(), span_() {}
+
+  void Init(fid_t fnum, const std::vector<OID_T>& oid_list) {
+    if (std::is_sorted(oid_list.begin(), oid_list.end())) {
+      initBoundaries(fnum, oid_list);
+    } else {
+      std::vector<OID_T> sorted_oid_list(oid_list);
+      std::sort(sorted_oid_list.begin(), sorted_oid_list.end());
+      initBoundaries(fnum, sorted_oid_list);
+    }
+  }
+
+  /**
+   * @brief Split the dense range `[begin, end)` of integral oids, no oid list
+   * is needed at all.
+   */
+  template <typename T = OID_T>
+  typename std::enable_if<std::is_integral<T>::value>::type Init(fid_t fnum,
+                                                                  T begin,
+                                                                  T end) {
+    fnum_ = fnum;
+    dense_ = true;
+    begin_ = begin;
+    span_ = std::max<T>((end - begin + fnum - 1) / fnum, 1);
+    boundaries_.clear();
+  }
+
+  inline fid_t GetPartitionId(const OID_T& oid) const {
+    return dense_ ? densePartitionId(oid, std::is_integral<OID_T>())
+                  : static_cast<fid_t>(std::upper_bound(boundaries_.begin(),
+                                                        boundaries_.end(),
+                                                        oid) -
+                                       boundaries_.begin());
+  }
+
+  template <typename ARRAY_T>
+  void GetPartitionIds(const ARRAY_T& oids, fid_t* out) const {
+    for (int64_t i = 0; i < oids.length(); ++i) {
+      out[i] = GetPartitionId(OID_T(oids.GetView(i)));
+    }
+  }
+
+ private:
+  void initBoundaries(fid_t fnum, const std::vector<OID_T>& sorted_oid_list) {
+    fnum_ = fnum;
+    dense_ = false;
+    size_t vnum = sorted_oid_list.size();
+    size_t frag_vnum = std::max<size_t>((vnum + fnum_ - 1) / fnum_, 1);
+    boundaries_.clear();
+    for (size_t i = frag_vnum; i < vnum; i += frag_vnum) {
+      boundaries_.push_back(sorted_oid_list[i]);
+    }
+  }
+
+  inline fid_t densePartitionId(const OID_T& oid, std::true_type) const {
+    if (oid < begin_) {
+      return 0;
+    }
+    return static_cast<fid_t>(
+        std::min<OID_T>((oid - begin_) / span_, fnum_ - 1));
+  }
+
+  inline fid_t densePartitionId(const OID_T&, std::false_type) const {
+    return 0;
+  }
+
+  fid_t fnum_;
+  bool dense_;
+  OID_T begin_, span_;
+  std::vector<OID_T> boundaries_;
+};
+
+/**
+ * @brief GridEdgePartitioner is a 2D vertex-cut partitioner of the edges, the
+ * vertices are still owned by the fragments that the vertex partitioner
+ * assigns them to.
+ *
+ * The fragments are arranged as a grid of `rows x cols`, and the edge
+ * `(u, v)` goes to the fragment in the row of the owner of `u` and the column
+ * of the owner of `v`. Each edge is stored once, and a vertex has mirrors in
+ * at most `rows + cols - 1` fragments, rather than in up to all fragments in
+ * an edge-cut, which balances the edges of the hubs of skewed graphs.
+ */
+class GridEdgePartitioner {
+ public:
+  GridEdgePartitioner() : fnum_(1), rows_(1), cols_(1) {}
+
+  /**
+   * @brief The grid is as square as `fnum` allows, a prime `fnum` degenerates
+   * to a single row, i.e., the edges are placed by the owner of `v`.
+   */
+  void Init(fid_t fnum) {
+    fnum_ = fnum;
+    rows_ = 1;
+    for (fid_t rows = 1; rows * rows <= fnum; ++rows) {
+      if (fnum % rows == 0) {
+        rows_ = rows;
+      }
+    }
+    cols_ = fnum / rows_;
+  }
+
+  /**
+   * @brief The fragment of the edge, given the owners of its endpoints.
+   */
+  inline fid_t GetPartitionId(fid_t src_fid, fid_t dst_fid) const {
+    return (src_fid / cols_) * cols_ + dst_fid % cols_;
+  }
+
+  fid_t rows() const { return rows_; }
+
+  fid_t cols() const { return cols_; }
+
+ private:
+  fid_t fnum_;
+  fid_t rows_, cols_;
+};
+
 }  // namespace vineyard
 
 #endif  // MODULES_GRAPH_UTILS_PARTITIONER_H_
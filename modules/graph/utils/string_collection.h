@@ -25,9 +25,10 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
-#include "boost/functional/hash.hpp"
 #include "flat_hash_map/flat_hash_map.hpp"
 
+#include "common/util/checksum.h"
+
 namespace grape {
 
 const uint64_t block_size = 64 * 1024 * 1024;
@@ -65,6 +66,14 @@ inline bool operator!=(const RefString& lhs, const RefString& rhs) {
   return !(lhs == rhs);
 }
 
+/**
+ * @brief Hash the bytes of the string with XXH64, which consumes 8 bytes at a
+ * time rather than one byte after another.
+ */
+inline size_t HashRefString(const RefString& rs) {
+  return static_cast<size_t>(vineyard::Checksum(rs.str, rs.len));
+}
+
 struct RSBlock {
   RSBlock() {
     data = static_cast<char*>(malloc(block_size));
@@ -157,42 +166,67 @@ class RSVector {
   operator std::vector<std::string>() const {
     std::vector<std::string> ret;
     ret.reserve(size());
-    for (auto& rs : *this) {
-      ret.emplace_back(rs.ToString());
-    }
+    ForEach([&ret](const RefString& rs) { ret.emplace_back(rs.str, rs.len); });
     return ret;
   }
-  void emplace(const std::string& str) {
-    size_t old_size = buffer_.size();
-    size_t new_size = old_size + str.length() + 1;
-    buffer_.resize(new_size);
-    memcpy(&buffer_[old_size], str.data(), str.length());
-    buffer_[new_size - 1] = '\0';
-    ++count_;
-  }
-  void emplace(const RefString& rs) {
-    size_t old_size = buffer_.size();
-    size_t new_size = old_size + rs.len + 1;
-    buffer_.resize(new_size);
-    memcpy(&buffer_[old_size], rs.str, rs.len);
-    buffer_[new_size - 1] = '\0';
-    ++count_;
-  }
+  void emplace(const std::string& str) { append(str.data(), str.length()); }
+  void emplace(const RefString& rs) { append(rs.str, rs.len); }
   void emplace_back(const std::string& str) {
-    size_t old_size = buffer_.size();
-    size_t new_size = old_size + str.length() + 1;
-    buffer_.resize(new_size);
-    memcpy(&buffer_[old_size], str.data(), str.length());
-    buffer_[new_size - 1] = '\0';
-    ++count_;
+    append(str.data(), str.length());
+  }
+  void emplace_back(const RefString& rs) { append(rs.str, rs.len); }
+
+  /**
+   * @brief Replace the content by the strings in `[begin, end)`, the total
+   * size is computed first thus the strings are copied into a single
+   * allocation, rather than growing the buffer string by string.
+   */
+  template <typename ITER_T>
+  void assign(ITER_T begin, ITER_T end) {
+    size_t bytes = 0, count = 0;
+    for (auto iter = begin; iter != end; ++iter) {
+      bytes += RefString(*iter).len + 1;
+      ++count;
+    }
+    buffer_.resize(bytes);
+    char* cursor = buffer_.data();
+    for (auto iter = begin; iter != end; ++iter) {
+      RefString rs(*iter);
+      memcpy(cursor, rs.str, rs.len);
+      cursor[rs.len] = '\0';
+      cursor += rs.len + 1;
+    }
+    count_ = count;
   }
-  void emplace_back(const RefString& rs) {
-    size_t old_size = buffer_.size();
-    size_t new_size = old_size + rs.len + 1;
-    buffer_.resize(new_size);
-    memcpy(&buffer_[old_size], rs.str, rs.len);
-    buffer_[new_size - 1] = '\0';
-    ++count_;
+
+  /**
+   * @brief Visit the strings in order as RefString views without
+   * materializing them, the length of each string is scanned once.
+   */
+  template <typename FUNC_T>
+  void ForEach(FUNC_T const& func) const {
+    const char* cursor = buffer_.data();
+    const char* end = cursor + buffer_.size();
+    while (cursor < end) {
+      auto terminator =
+          static_cast<const char*>(memchr(cursor, '\0', end - cursor));
+      size_t len = terminator - cursor;
+      func(RefString(cursor, len));
+      cursor += len + 1;
+    }
+  }
+
+  /**
+   * @brief The hashes (see HashRefString) of all strings in order, they are
+   * computed in one pass, e.g., to partition the strings once and reuse the
+   * hashes when inserting them into hashmaps afterwards.
+   */
+  void Hashes(std::vector<size_t>& hashes) const {
+    hashes.clear();
+    hashes.reserve(count_);
+    ForEach([&hashes](const RefString& rs) {
+      hashes.push_back(HashRefString(rs));
+    });
   }
   void append(const RSVector& rsv) {
     buffer_.insert(buffer_.end(), rsv.buffer_.begin(), rsv.buffer_.end());
@@ -212,7 +246,9 @@ class RSVector {
       return lhs.current.str != rhs.current.str;
     }
     const_iterator& operator++() {
-      current.str += (strlen(current.str) + 1);
+      // the length has been scanned when the iterator is dereferenced
+      current.str += (current.len != 0 ? current.len : strlen(current.str)) + 1;
+      current.len = 0;
       return *this;
     }
     const_iterator operator++(int) {
@@ -251,6 +287,15 @@ class RSVector {
   void reserve(size_t cap) { buffer_.reserve(cap); }
 
  private:
+  void append(const char* str, size_t len) {
+    size_t old_size = buffer_.size();
+    size_t new_size = old_size + len + 1;
+    buffer_.resize(new_size);
+    memcpy(&buffer_[old_size], str, len);
+    buffer_[new_size - 1] = '\0';
+    ++count_;
+  }
+
   std::vector<char> buffer_;
   size_t count_;
 };
@@ -262,21 +307,18 @@ class StringCollection {
 
   StringCollection(StringCollection&& rhs) noexcept
       : blocks_(std::move(rhs.blocks_)),
-        addr_lists_(std::move(rhs.addr_lists_)) {}
+        addr_lists_(std::move(rhs.addr_lists_)),
+        hashes_(std::move(rhs.hashes_)) {}
+
+  /**
+   * @brief Reserve the addresses of `count` strings, the bytes of the strings
+   * are allocated by blocks anyway.
+   */
+  void Reserve(size_t count) { addr_lists_.reserve(count); }
 
   size_t Put(const RefString& str) {
-    if (blocks_.empty()) {
-      blocks_.resize(1);
-    }
-    uint64_t high = blocks_.size() - 1;
-    if (!blocks_[high].enough(str)) {
-      blocks_.resize(blocks_.size() + 1);
-      ++high;
-    }
-    uint64_t low = blocks_[high].append(str);
-    uint64_t offset = generate_addr(high, low);
     size_t res = addr_lists_.size();
-    addr_lists_.emplace_back(offset, str.len);
+    put(str);
     return res;
   }
 
@@ -286,17 +328,8 @@ class StringCollection {
   }
 
   RefString PutString(const RefString& str) {
-    if (blocks_.empty()) {
-      blocks_.resize(1);
-    }
-    uint64_t high = blocks_.size() - 1;
-    if (!blocks_[high].enough(str)) {
-      blocks_.resize(blocks_.size() + 1);
-      ++high;
-    }
-    uint64_t low = blocks_[high].append(str);
-    uint64_t offset = generate_addr(high, low);
-    addr_lists_.emplace_back(offset, str.len);
+    uint64_t high, low;
+    parse_addr(put(str), high, low);
     return RefString(blocks_[high].data + static_cast<ptrdiff_t>(low), str.len);
   }
 
@@ -326,9 +359,46 @@ class StringCollection {
 
   size_t Count() const { return addr_lists_.size(); }
 
+  /**
+   * @brief Visit the strings in the order of their ids as RefString views
+   * into the blocks, without materializing them.
+   */
+  template <typename FUNC_T>
+  void ForEach(FUNC_T const& func) const {
+    RefString rs;
+    for (size_t id = 0; id < addr_lists_.size(); ++id) {
+      Get(id, rs);
+      func(id, rs);
+    }
+  }
+
+  /**
+   * @brief The hash (see HashRefString) of the string of `id`. The hashes are
+   * computed once, for the strings that are put since the last call of
+   * Hash(), then reused by the shuffles and hashmaps of the strings. It is
+   * not thread-safe until the hashes of all strings have been computed by
+   * BuildHashes().
+   */
+  size_t Hash(size_t id) const {
+    if (id >= hashes_.size()) {
+      BuildHashes();
+    }
+    return hashes_[id];
+  }
+
+  void BuildHashes() const {
+    RefString rs;
+    hashes_.reserve(addr_lists_.size());
+    for (size_t id = hashes_.size(); id < addr_lists_.size(); ++id) {
+      Get(id, rs);
+      hashes_.push_back(HashRefString(rs));
+    }
+  }
+
   void Swap(StringCollection& other) {
     std::swap(blocks_, other.blocks_);
     std::swap(addr_lists_, other.addr_lists_);
+    std::swap(hashes_, other.hashes_);
   }
 
   std::vector<RSBlock>& GetBuffer() { return blocks_; }
@@ -342,6 +412,7 @@ class StringCollection {
     oa >> block_num >> al_size;
     blocks_.resize(block_num);
     addr_lists_.resize(al_size);
+    hashes_.clear();
     for (auto& block : blocks_) {
       block.Read(io_adaptor);
     }
@@ -376,6 +447,7 @@ class StringCollection {
     MPI_Recv(&block_num, sizeof(size_t), MPI_CHAR, worker_id, tag, comm,
              MPI_STATUS_IGNORE);
     blocks_.resize(block_num);
+    hashes_.clear();
     for (auto& block : blocks_) {
       block.RecvFrom(worker_id, comm, tag);
     }
@@ -402,15 +474,31 @@ class StringCollection {
     return res;
   }
 
+  uint64_t put(const RefString& str) {
+    if (blocks_.empty()) {
+      blocks_.resize(1);
+    }
+    uint64_t high = blocks_.size() - 1;
+    if (!blocks_[high].enough(str)) {
+      blocks_.resize(blocks_.size() + 1);
+      ++high;
+    }
+    uint64_t low = blocks_[high].append(str);
+    uint64_t offset = generate_addr(high, low);
+    addr_lists_.emplace_back(offset, str.len);
+    return offset;
+  }
+
   std::vector<RSBlock> blocks_;
   std::vector<rs_addr> addr_lists_;
+  mutable std::vector<size_t> hashes_;
 };
 }  // namespace grape
 namespace std {
 template <>
 struct hash<grape::RefString> {
   size_t operator()(const grape::RefString& rs) const noexcept {
-    return boost::hash_range(rs.str, rs.str + rs.len);
+    return grape::HashRefString(rs);
   }
   // using hash_policy = ska::prime_number_hash_policy;
 };
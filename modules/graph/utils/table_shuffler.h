@@ -18,9 +18,13 @@ limitations under the License.
 
 #include <mpi.h>
 
+#include <algorithm>
+#include <atomic>
 #include <future>
 #include <memory>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -32,6 +36,7 @@ limitations under the License.
 #include "grape/communication/sync_comm.h"
 #include "grape/worker/comm_spec.h"
 
+#include "basic/ds/arrow_compute.h"
 #include "basic/ds/arrow_utils.h"
 #include "common/util/status.h"
 #include "graph/fragment/property_graph_types.h"
@@ -342,109 +347,437 @@ Status FragmentAllGatherArray(
     return Status::OK();
   };
 
-  ThreadGroup tg;
-
-  tg.AddTask(send_procedure);
-  tg.AddTask(recv_procedure);
-  auto results = tg.TakeResults();
+  // the sends and the receives must progress at the same time, thus the
+  // sends run on a dedicated thread rather than on the shared pool
+  Status send_status;
+  std::thread send_thread([&]() { send_status = send_procedure(); });
+  Status recv_status = recv_procedure();
+  send_thread.join();
+  RETURN_ON_ERROR(send_status);
+  return recv_status;
+}
 
-  for (auto& res : results) {
-    RETURN_ON_ERROR(res);
+/**
+ * @brief The number of rows that are serialized into one message of the
+ * shuffle, so that serializing, sending, receiving and deserializing the
+ * consecutive messages overlap with each other.
+ */
+const int64_t shuffle_chunk_rows = 1 << 20;
+
+inline void isend_buffer(const uint8_t* ptr, size_t len, int dst_worker_id,
+                         MPI_Comm comm, int tag,
+                         std::vector<MPI_Request>& requests) {
+  while (len != 0) {
+    int count =
+        static_cast<int>(std::min(len, static_cast<size_t>(chunk_size)));
+    requests.emplace_back();
+    MPI_Isend(ptr, count, MPI_CHAR, dst_worker_id, tag, comm,
+              &requests.back());
+    ptr += count;
+    len -= count;
   }
-  return Status::OK();
 }
 
-template <typename PARTITIONER_T>
-Status ShufflePropertyVertexTable(const grape::CommSpec& comm_spec,
-                                  const PARTITIONER_T& partitioner,
-                                  const std::shared_ptr<arrow::Table>& table_in,
-                                  std::shared_ptr<arrow::Table>& table_out) {
-  using oid_t = typename PARTITIONER_T::oid_t;
-  using internal_oid_t = typename InternalType<oid_t>::type;
-  using oid_array_type = typename ConvertToArrowType<oid_t>::ArrayType;
-  auto fnum = comm_spec.fnum();
-  std::vector<std::unique_ptr<arrow::RecordBatchBuilder>>
-      divided_table_builders;
-  std::vector<std::vector<std::shared_ptr<arrow::RecordBatch>>> divided_records(
-      fnum);
-  for (fid_t i = 0; i < fnum; ++i) {
-    std::unique_ptr<arrow::RecordBatchBuilder> builder;
-    RETURN_ON_ARROW_ERROR(arrow::RecordBatchBuilder::Make(
-        table_in->schema(), arrow::default_memory_pool(), 4096, &builder));
-    divided_table_builders.emplace_back(std::move(builder));
-  }
-  TableAppender appender(table_in->schema());
-  arrow::TableBatchReader tbreader(*table_in);
-  std::shared_ptr<arrow::RecordBatch> batch;
-
-  while (true) {
-    RETURN_ON_ARROW_ERROR(tbreader.ReadNext(&batch));
-    if (batch == nullptr) {
-      break;
-    }
-    auto id_col = std::dynamic_pointer_cast<oid_array_type>(batch->column(0));
-    size_t row_num = batch->num_rows();
-    for (size_t i = 0; i < row_num; ++i) {
-      internal_oid_t rs = id_col->GetView(i);
-      fid_t fid = partitioner.GetPartitionId(oid_t(rs));
-      RETURN_ON_ERROR(appender.Apply(divided_table_builders[fid], batch, i,
-                                     divided_records[fid]));
-    }
+inline void irecv_buffer(uint8_t* ptr, size_t len, int src_worker_id,
+                         MPI_Comm comm, int tag,
+                         std::vector<MPI_Request>& requests) {
+  while (len != 0) {
+    int count =
+        static_cast<int>(std::min(len, static_cast<size_t>(chunk_size)));
+    requests.emplace_back();
+    MPI_Irecv(ptr, count, MPI_CHAR, src_worker_id, tag, comm,
+              &requests.back());
+    ptr += count;
+    len -= count;
   }
+}
 
-  for (fid_t i = 0; i < fnum; ++i) {
-    std::unique_ptr<arrow::RecordBatchBuilder> builder =
-        std::move(divided_table_builders[i]);
-    RETURN_ON_ERROR(appender.Flush(builder, divided_records[i]));
+inline void wait_requests(std::vector<MPI_Request>& requests) {
+  if (!requests.empty()) {
+    MPI_Waitall(static_cast<int>(requests.size()), requests.data(),
+                MPI_STATUSES_IGNORE);
+    requests.clear();
   }
-  divided_table_builders.clear();
+}
 
+/**
+ * @brief Exchange the divided record batches between all workers, after
+ * which `divided_records[comm_spec.fid()]` holds the local batches followed
+ * by the received ones.
+ *
+ * The batches for each destination are sent as messages of about
+ * `shuffle_chunk_rows` rows, with non-blocking sends from two alternating
+ * buffers, i.e., the next message is serialized while the previous one is
+ * in flight. On the receiving side a message is deserialized while the next
+ * one is being received.
+ */
+inline Status ShuffleRecordBatches(
+    const grape::CommSpec& comm_spec,
+    std::vector<std::vector<std::shared_ptr<arrow::RecordBatch>>>&
+        divided_records,
+    int tag = 0) {
   int worker_id = comm_spec.worker_id();
   int worker_num = comm_spec.worker_num();
+  auto& local_records = divided_records[comm_spec.fid()];
+  // the batches of a message are serialized and deserialized in parallel
+  int thread_num =
+      (std::thread::hardware_concurrency() + comm_spec.local_num() - 1) /
+      comm_spec.local_num();
 
   auto send_procedure = [&]() -> Status {
+    struct Message {
+      // | payload size | whether it is the last message for the worker |
+      int64_t header[2];
+      std::shared_ptr<arrow::Buffer> buffer;
+      std::vector<MPI_Request> requests;
+    };
+    Message messages[2];
+    size_t message_index = 0;
+
     int dst_worker_id = (worker_id + worker_num - 1) % worker_num;
     while (dst_worker_id != worker_id) {
       fid_t dst_fid = comm_spec.WorkerToFrag(dst_worker_id);
-      std::shared_ptr<arrow::Buffer> buffer;
       std::vector<std::shared_ptr<arrow::RecordBatch>> batches =
           std::move(divided_records[dst_fid]);
-      RETURN_ON_ERROR(SerializeRecordBatches(batches, &buffer));
-      SendArrowBuffer(buffer, dst_worker_id, comm_spec.comm());
+      size_t begin = 0;
+      do {
+        size_t end = begin;
+        int64_t rows = 0;
+        while (end < batches.size() && rows < shuffle_chunk_rows) {
+          rows += batches[end++]->num_rows();
+        }
+
+        // the buffer is reused once the message sent from it two messages
+        // ago has completed
+        Message& message = messages[message_index++ % 2];
+        wait_requests(message.requests);
+        message.buffer = nullptr;
+        if (end != begin) {
+          std::vector<std::shared_ptr<arrow::RecordBatch>> chunk(
+              batches.begin() + begin, batches.begin() + end);
+          RETURN_ON_ERROR(SerializeRecordBatchesInParallel(
+              chunk, &message.buffer, thread_num));
+        }
+        message.header[0] = message.buffer ? message.buffer->size() : 0;
+        message.header[1] = end == batches.size();
+        message.requests.emplace_back();
+        MPI_Isend(message.header, 2, MPI_INT64_T, dst_worker_id, tag,
+                  comm_spec.comm(), &message.requests.back());
+        if (message.buffer) {
+          isend_buffer(message.buffer->data(), message.buffer->size(),
+                       dst_worker_id, comm_spec.comm(), tag, message.requests);
+        }
+        begin = end;
+      } while (begin < batches.size());
       dst_worker_id = (dst_worker_id + worker_num - 1) % worker_num;
     }
+    for (auto& message : messages) {
+      wait_requests(message.requests);
+    }
     return Status::OK();
   };
 
   auto recv_procedure = [&]() -> Status {
-    int src_worker_id = (worker_id + 1) % worker_num;
-    while (src_worker_id != worker_id) {
-      std::shared_ptr<arrow::Buffer> buffer;
-      RETURN_ON_ERROR(RecvArrowBuffer(buffer, src_worker_id, comm_spec.comm()));
+    std::vector<std::shared_ptr<arrow::RecordBatch>> received;
+    std::future<Status> deserializing;
+    auto deserialize = [&received,
+                        thread_num](std::shared_ptr<arrow::Buffer> buffer) {
       std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
-      RETURN_ON_ERROR(DeserializeRecordBatches(buffer, &batches));
-      for (const auto& batch : batches) {
+      RETURN_ON_ERROR(
+          DeserializeRecordBatchesInParallel(buffer, &batches, thread_num));
+      for (auto& batch : batches) {
         if (batch->num_rows() > 0) {
-          divided_records[comm_spec.fid()].push_back(batch);
+          received.emplace_back(std::move(batch));
         }
       }
+      return Status::OK();
+    };
+
+    int src_worker_id = (worker_id + 1) % worker_num;
+    while (src_worker_id != worker_id) {
+      int64_t header[2] = {0, 0};
+      while (header[1] == 0) {
+        MPI_Recv(header, 2, MPI_INT64_T, src_worker_id, tag, comm_spec.comm(),
+                 MPI_STATUS_IGNORE);
+        if (header[0] == 0) {
+          continue;
+        }
+        std::shared_ptr<arrow::Buffer> buffer;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+        RETURN_ON_ARROW_ERROR(arrow::AllocateBuffer(
+            arrow::default_memory_pool(), header[0], &buffer));
+#else
+        RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+            buffer,
+            arrow::AllocateBuffer(header[0], arrow::default_memory_pool()));
+#endif
+        std::vector<MPI_Request> requests;
+        irecv_buffer(buffer->mutable_data(), header[0], src_worker_id,
+                     comm_spec.comm(), tag, requests);
+        wait_requests(requests);
+
+        // at most one message is deserialized at a time, which keeps the
+        // order of the received batches
+        if (deserializing.valid()) {
+          RETURN_ON_ERROR(deserializing.get());
+        }
+        deserializing = std::async(std::launch::async, deserialize, buffer);
+      }
       src_worker_id = (src_worker_id + 1) % worker_num;
     }
+    if (deserializing.valid()) {
+      RETURN_ON_ERROR(deserializing.get());
+    }
+    local_records.insert(local_records.end(), received.begin(),
+                         received.end());
     return Status::OK();
   };
 
-  ThreadGroup tg;
+  // the sends and the receives must progress at the same time, thus the
+  // sends run on a dedicated thread rather than on the shared pool
+  Status send_status;
+  std::thread send_thread([&]() { send_status = send_procedure(); });
+  Status recv_status = recv_procedure();
+  send_thread.join();
+  RETURN_ON_ERROR(send_status);
+  return recv_status;
+}
+
+/**
+ * @brief Whether every column of the schema can be gathered by `Take`, in
+ * which case the selected rows are shuffled as arrow IPC messages.
+ */
+inline bool TakeSupported(const arrow::Schema& schema) {
+  for (auto const& field : schema.fields()) {
+    switch (field->type()->id()) {
+    case arrow::Type::BOOL:
+    case arrow::Type::STRING:
+    case arrow::Type::BINARY:
+    case arrow::Type::LARGE_STRING:
+    case arrow::Type::LARGE_BINARY:
+      continue;
+    case arrow::Type::DICTIONARY:
+    case arrow::Type::EXTENSION:
+      return false;
+    default: {
+      auto type =
+          std::dynamic_pointer_cast<arrow::FixedWidthType>(field->type());
+      if (type == nullptr || type->bit_width() % 8 != 0) {
+        return false;
+      }
+    }
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief The minimum number of rows that are assigned to fragments by a
+ * thread at a time.
+ */
+const int64_t partition_chunk_rows = 1 << 16;
+
+/**
+ * @brief Divide the rows of the record batches by the fragments they are
+ * assigned to, the rows that go to the fragment `fid` are appended to
+ * `divided_records[fid]`.
+ *
+ * `assign(batch_index, row, fids)` writes the `fids_per_row` fragments of the
+ * row into `fids`, where `fnum` stands for no fragment.
+ *
+ * The batches are split into pieces of `partition_chunk_rows` rows that are
+ * assigned in parallel, and each piece counts its rows for each fragment. The
+ * prefix sum of the histograms gives each piece a disjoint range of the row
+ * ids of each fragment to scatter into, so no locks are needed, and the rows
+ * of a batch that go to the same fragment are contiguous and ascending, and
+ * then gathered with `Take`.
+ */
+template <typename ASSIGN_T>
+inline Status DivideRecordBatches(
+    const grape::CommSpec& comm_spec,
+    const std::vector<std::shared_ptr<arrow::RecordBatch>>& record_batches,
+    int fids_per_row, const ASSIGN_T& assign,
+    std::vector<std::vector<std::shared_ptr<arrow::RecordBatch>>>&
+        divided_records) {
+  fid_t fnum = comm_spec.fnum();
+  size_t batch_num = record_batches.size();
+
+  // | batch index | the first row | the end row |
+  std::vector<std::tuple<size_t, int64_t, int64_t>> pieces;
+  // the first piece of each batch
+  std::vector<size_t> batch_pieces(batch_num + 1, 0);
+  for (size_t batch_index = 0; batch_index < batch_num; ++batch_index) {
+    batch_pieces[batch_index] = pieces.size();
+    int64_t row_num = record_batches[batch_index]->num_rows();
+    for (int64_t begin = 0; begin < row_num; begin += partition_chunk_rows) {
+      pieces.emplace_back(batch_index, begin,
+                          std::min(row_num, begin + partition_chunk_rows));
+    }
+  }
+  batch_pieces[batch_num] = pieces.size();
+
+  int thread_num =
+      (std::thread::hardware_concurrency() + comm_spec.local_num() - 1) /
+      comm_spec.local_num();
+  auto parallel_for = [thread_num](size_t task_num, auto const& task) {
+    return ParallelFor(task_num, task, static_cast<size_t>(thread_num));
+  };
+
+  std::vector<std::vector<fid_t>> fids(pieces.size());
+  std::vector<std::vector<int64_t>> cursors(pieces.size());
+  RETURN_ON_ERROR(parallel_for(pieces.size(), [&](size_t index) -> Status {
+    size_t batch_index = std::get<0>(pieces[index]);
+    int64_t begin = std::get<1>(pieces[index]);
+    int64_t end = std::get<2>(pieces[index]);
+    auto& piece_fids = fids[index];
+    auto& histogram = cursors[index];
+    piece_fids.resize((end - begin) * fids_per_row);
+    histogram.resize(fnum + 1, 0);
+    for (int64_t row = begin; row < end; ++row) {
+      fid_t* row_fids = &piece_fids[(row - begin) * fids_per_row];
+      assign(batch_index, row, row_fids);
+      for (int k = 0; k < fids_per_row; ++k) {
+        histogram[row_fids[k]] += 1;
+      }
+    }
+    return Status::OK();
+  }));
 
-  tg.AddTask(send_procedure);
-  tg.AddTask(recv_procedure);
-  std::vector<Status> results = tg.TakeResults();
+  // turns the histograms into the positions to scatter to, in the order of
+  // fragments first, and pieces second
+  int64_t total = 0;
+  for (fid_t fid = 0; fid < fnum; ++fid) {
+    for (auto& cursor : cursors) {
+      int64_t count = cursor[fid];
+      cursor[fid] = total;
+      total += count;
+    }
+  }
+  // the end of rows for each fragment
+  std::vector<int64_t> fid_ends(fnum);
+  for (fid_t fid = 0; fid < fnum; ++fid) {
+    fid_ends[fid] = fid + 1 < fnum && !cursors.empty() ? cursors[0][fid + 1]
+                                                       : total;
+  }
 
-  for (auto& st : results) {
-    if (!st.ok()) {
-      return st;
+  std::vector<int64_t> row_ids(total);
+  // the ranges of row ids of the batch for each fragment
+  std::vector<std::vector<std::pair<int64_t, int64_t>>> ranges(batch_num);
+  for (size_t batch_index = 0; batch_index < batch_num; ++batch_index) {
+    auto& batch_ranges = ranges[batch_index];
+    batch_ranges.resize(fnum, {0, 0});
+    size_t first = batch_pieces[batch_index],
+           last = batch_pieces[batch_index + 1];
+    if (first == last) {
+      continue;
+    }
+    for (fid_t fid = 0; fid < fnum; ++fid) {
+      batch_ranges[fid].first = cursors[first][fid];
+      batch_ranges[fid].second =
+          last < pieces.size() ? cursors[last][fid] : fid_ends[fid];
     }
   }
 
+  RETURN_ON_ERROR(parallel_for(pieces.size(), [&](size_t index) -> Status {
+    int64_t begin = std::get<1>(pieces[index]);
+    int64_t end = std::get<2>(pieces[index]);
+    auto& piece_fids = fids[index];
+    auto& cursor = cursors[index];
+    for (int64_t row = begin; row < end; ++row) {
+      fid_t const* row_fids = &piece_fids[(row - begin) * fids_per_row];
+      for (int k = 0; k < fids_per_row; ++k) {
+        if (row_fids[k] != fnum) {
+          row_ids[cursor[row_fids[k]]++] = row;
+        }
+      }
+    }
+    std::vector<fid_t>().swap(piece_fids);
+    return Status::OK();
+  }));
+
+  std::vector<std::vector<std::shared_ptr<arrow::RecordBatch>>> gathered(
+      batch_num, std::vector<std::shared_ptr<arrow::RecordBatch>>(fnum));
+  if (batch_num > 0 && TakeSupported(*record_batches[0]->schema())) {
+    RETURN_ON_ERROR(parallel_for(batch_num, [&](size_t batch_index) -> Status {
+      auto& batch = record_batches[batch_index];
+      for (fid_t fid = 0; fid < fnum; ++fid) {
+        auto& range = ranges[batch_index][fid];
+        if (range.first == range.second) {
+          continue;
+        }
+        if (range.second - range.first == batch->num_rows()) {
+          gathered[batch_index][fid] = batch;
+          continue;
+        }
+        SelectionVector selection(row_ids.begin() + range.first,
+                                  row_ids.begin() + range.second);
+        RETURN_ON_ERROR(
+            Take(batch, selection, gathered[batch_index][fid]));
+      }
+      return Status::OK();
+    }));
+    for (auto& batches : gathered) {
+      for (fid_t fid = 0; fid < fnum; ++fid) {
+        if (batches[fid] != nullptr) {
+          divided_records[fid].emplace_back(std::move(batches[fid]));
+        }
+      }
+    }
+    return Status::OK();
+  }
+
+  // falls back to appending the rows one by one for the types that cannot
+  // be gathered by `Take`
+  for (size_t batch_index = 0; batch_index < batch_num; ++batch_index) {
+    auto& batch = record_batches[batch_index];
+    TableAppender appender(batch->schema());
+    for (fid_t fid = 0; fid < fnum; ++fid) {
+      auto& range = ranges[batch_index][fid];
+      if (range.first == range.second) {
+        continue;
+      }
+      std::unique_ptr<arrow::RecordBatchBuilder> builder;
+      RETURN_ON_ARROW_ERROR(arrow::RecordBatchBuilder::Make(
+          batch->schema(), arrow::default_memory_pool(), 4096, &builder));
+      for (int64_t i = range.first; i < range.second; ++i) {
+        RETURN_ON_ERROR(
+            appender.Apply(builder, batch, row_ids[i], divided_records[fid]));
+      }
+      RETURN_ON_ERROR(appender.Flush(builder, divided_records[fid]));
+    }
+  }
+  return Status::OK();
+}
+
+template <typename PARTITIONER_T>
+Status ShufflePropertyVertexTable(const grape::CommSpec& comm_spec,
+                                  const PARTITIONER_T& partitioner,
+                                  const std::shared_ptr<arrow::Table>& table_in,
+                                  std::shared_ptr<arrow::Table>& table_out) {
+  using oid_t = typename PARTITIONER_T::oid_t;
+  using internal_oid_t = typename InternalType<oid_t>::type;
+  using oid_array_type = typename ConvertToArrowType<oid_t>::ArrayType;
+  auto fnum = comm_spec.fnum();
+  std::vector<std::vector<std::shared_ptr<arrow::RecordBatch>>> divided_records(
+      fnum);
+  std::vector<std::shared_ptr<arrow::RecordBatch>> record_batches;
+  RETURN_ON_ERROR(TableToRecordBatches(table_in, &record_batches));
+
+  std::vector<std::shared_ptr<oid_array_type>> id_cols;
+  for (auto const& batch : record_batches) {
+    id_cols.emplace_back(
+        std::dynamic_pointer_cast<oid_array_type>(batch->column(0)));
+  }
+  RETURN_ON_ERROR(DivideRecordBatches(
+      comm_spec, record_batches, 1,
+      [&](size_t batch_index, int64_t row, fid_t* fids) {
+        internal_oid_t rs = id_cols[batch_index]->GetView(row);
+        fids[0] = partitioner.GetPartitionId(oid_t(rs));
+      },
+      divided_records));
+
+  RETURN_ON_ERROR(ShuffleRecordBatches(comm_spec, divided_records));
+
   auto& batches = divided_records[comm_spec.fid()];
   // remove empty batches
   batches.erase(std::remove_if(batches.begin(), batches.end(),
@@ -474,119 +807,34 @@ Status ShufflePropertyEdgeTable(const grape::CommSpec& comm_spec,
                                 int dst_col_id,
                                 const std::shared_ptr<arrow::Table>& table_in,
                                 std::shared_ptr<arrow::Table>& table_out) {
+  using vid_array_type = typename ConvertToArrowType<VID_TYPE>::ArrayType;
   fid_t fnum = comm_spec.fnum();
   std::vector<std::vector<std::shared_ptr<arrow::RecordBatch>>>
       divided_record_batches(fnum);
 
-  TableAppender appender(table_in->schema());
-  std::vector<std::unique_ptr<arrow::RecordBatchBuilder>>
-      divided_table_builders;
-
-  for (fid_t i = 0; i < fnum; ++i) {
-    std::unique_ptr<arrow::RecordBatchBuilder> builder;
-    RETURN_ON_ARROW_ERROR(arrow::RecordBatchBuilder::Make(
-        table_in->schema(), arrow::default_memory_pool(), 4096, &builder));
-    divided_table_builders.emplace_back(std::move(builder));
-  }
-
-  std::vector<std::shared_ptr<arrow::RecordBatch>> tmp_batch_vec;
   std::vector<std::shared_ptr<arrow::RecordBatch>> record_batches;
-
   RETURN_ON_ERROR(TableToRecordBatches(table_in, &record_batches));
-  for (const auto& rb : record_batches) {
-    size_t row_num = rb->num_rows();
-    auto src_col = std::dynamic_pointer_cast<
-        typename ConvertToArrowType<VID_TYPE>::ArrayType>(
-        rb->column(src_col_id));
-    auto dst_col = std::dynamic_pointer_cast<
-        typename ConvertToArrowType<VID_TYPE>::ArrayType>(
-        rb->column(dst_col_id));
-
-    for (size_t i = 0; i < row_num; ++i) {
-      VID_TYPE src_gid = src_col->Value(i);
-      VID_TYPE dst_gid = dst_col->Value(i);
-      fid_t src_fid = id_parser.GetFid(src_gid);
-      fid_t dst_fid = id_parser.GetFid(dst_gid);
-      RETURN_ON_ERROR(appender.Apply(divided_table_builders[src_fid], rb, i,
-                                     tmp_batch_vec));
-      if (!tmp_batch_vec.empty()) {
-        divided_record_batches[src_fid].emplace_back(
-            std::move(tmp_batch_vec[0]));
-        tmp_batch_vec.clear();
-      }
-      if (src_fid != dst_fid) {
-        RETURN_ON_ERROR(appender.Apply(divided_table_builders[dst_fid], rb, i,
-                                       tmp_batch_vec));
-        if (!tmp_batch_vec.empty()) {
-          divided_record_batches[dst_fid].emplace_back(
-              std::move(tmp_batch_vec[0]));
-          tmp_batch_vec.clear();
-        }
-      }
-    }
-  }
-
-  for (fid_t fid = 0; fid < fnum; ++fid) {
-    RETURN_ON_ERROR(appender.Flush(divided_table_builders[fid], tmp_batch_vec));
-    if (!tmp_batch_vec.empty()) {
-      divided_record_batches[fid].emplace_back(std::move(tmp_batch_vec[0]));
-      tmp_batch_vec.clear();
-    }
-  }
-
-  int worker_id = comm_spec.worker_id();
-  int worker_num = comm_spec.worker_num();
-
-  auto send_procedure = [&]() {
-    int dst_worker_id = (worker_id + worker_num - 1) % worker_num;
-    while (dst_worker_id != worker_id) {
-      fid_t dst_fid = comm_spec.WorkerToFrag(dst_worker_id);
-      std::shared_ptr<arrow::Buffer> buffer;
-      std::vector<std::shared_ptr<arrow::RecordBatch>> batches =
-          std::move(divided_record_batches[dst_fid]);
-      if (batches.empty()) {
-        std::shared_ptr<arrow::io::BufferOutputStream> out_stream;
-        RETURN_ON_ARROW_ERROR_AND_ASSIGN(
-            out_stream, arrow::io::BufferOutputStream::Create(1024));
-        RETURN_ON_ARROW_ERROR_AND_ASSIGN(buffer, out_stream->Finish());
-      } else {
-        RETURN_ON_ERROR(SerializeRecordBatches(batches, &buffer));
-      }
-      SendArrowBuffer(buffer, dst_worker_id, comm_spec.comm());
-      dst_worker_id = (dst_worker_id + worker_num - 1) % worker_num;
-    }
-
-    return Status::OK();
-  };
-
-  auto recv_procedure = [&]() {
-    int src_worker_id = (worker_id + 1) % worker_num;
-
-    while (src_worker_id != worker_id) {
-      std::shared_ptr<arrow::Buffer> buffer;
-      RETURN_ON_ERROR(RecvArrowBuffer(buffer, src_worker_id, comm_spec.comm()));
-
-      if (buffer->size() > 0) {
-        std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
-        RETURN_ON_ERROR(DeserializeRecordBatches(buffer, &batches));
-        for (const auto& batch : batches) {
-          divided_record_batches[comm_spec.fid()].push_back(batch);
-        }
-      }
-      src_worker_id = (src_worker_id + 1) % worker_num;
-    }
-    return Status::OK();
-  };
-
-  ThreadGroup tg;
-
-  tg.AddTask(send_procedure);
-  tg.AddTask(recv_procedure);
-  auto results = tg.TakeResults();
 
-  for (auto& res : results) {
-    RETURN_ON_ERROR(res);
+  std::vector<VID_TYPE const*> src_cols, dst_cols;
+  for (auto const& rb : record_batches) {
+    src_cols.emplace_back(
+        std::dynamic_pointer_cast<vid_array_type>(rb->column(src_col_id))
+            ->raw_values());
+    dst_cols.emplace_back(
+        std::dynamic_pointer_cast<vid_array_type>(rb->column(dst_col_id))
+            ->raw_values());
   }
+  // each edge goes to the fragments of both endpoints
+  RETURN_ON_ERROR(DivideRecordBatches(
+      comm_spec, record_batches, 2,
+      [&](size_t batch_index, int64_t row, fid_t* fids) {
+        fids[0] = id_parser.GetFid(src_cols[batch_index][row]);
+        fid_t dst_fid = id_parser.GetFid(dst_cols[batch_index][row]);
+        fids[1] = dst_fid == fids[0] ? fnum : dst_fid;
+      },
+      divided_record_batches));
+
+  RETURN_ON_ERROR(ShuffleRecordBatches(comm_spec, divided_record_batches));
 
   auto batches = divided_record_batches[comm_spec.fid()];
   batches.erase(std::remove_if(batches.begin(), batches.end(),
@@ -38,8 +38,10 @@ limitations under the License.
 #include "grape/utils/concurrent_queue.h"
 #include "grape/worker/comm_spec.h"
 
+#include "basic/ds/arrow_compute.h"
 #include "basic/ds/arrow_utils.h"
 #include "graph/utils/error.h"
+#include "graph/utils/table_shuffler.h"
 
 namespace grape {
 
@@ -471,7 +473,77 @@ inline void SelectRows(std::shared_ptr<arrow::RecordBatch> record_batch_in,
   ARROW_CHECK_OK(builder->Flush(&record_batch_out));
 }
 
-void ShuffleTableByOffsetLists(
+/**
+ * @brief Gather the selected rows of each batch into a record batch for each
+ * destination and exchange them as arrow IPC messages, the received batches
+ * reference the message buffers, i.e., nothing is deserialized item by item.
+ *
+ * Rows that stay on this worker are gathered but never serialized, and
+ * batches whose rows all go to the same fragment are shipped as they are.
+ */
+inline boost::leaf::result<void> ShuffleSelectedRowsByIPC(
+    std::vector<std::shared_ptr<arrow::RecordBatch>>& record_batches_out,
+    const std::vector<std::vector<std::vector<int64_t>>>& offset_lists,
+    std::vector<std::shared_ptr<arrow::RecordBatch>>& record_batches_in,
+    const grape::CommSpec& comm_spec) {
+  size_t record_batches_out_num = record_batches_out.size();
+  grape::fid_t fnum = comm_spec.fnum();
+
+  // fragment_num, record_batch_num
+  std::vector<std::vector<std::shared_ptr<arrow::RecordBatch>>> divided(fnum);
+  for (auto& batches : divided) {
+    batches.resize(record_batches_out_num);
+  }
+
+  int thread_num =
+      (std::thread::hardware_concurrency() + comm_spec.local_num() - 1) /
+      comm_spec.local_num();
+  thread_num = std::max(
+      1, std::min(thread_num, static_cast<int>(record_batches_out_num)));
+  std::vector<std::thread> take_threads(thread_num);
+  std::vector<Status> take_statuses(thread_num);
+  std::atomic<size_t> cur_batch_out(0);
+  for (int i = 0; i != thread_num; ++i) {
+    take_threads[i] = std::thread([&, i]() {
+      while (true) {
+        size_t got_batch = cur_batch_out.fetch_add(1);
+        if (got_batch >= record_batches_out_num) {
+          break;
+        }
+        auto& cur_rb = record_batches_out[got_batch];
+        auto& cur_offset_lists = offset_lists[got_batch];
+        for (grape::fid_t fid = 0; fid != fnum; ++fid) {
+          auto& selection = cur_offset_lists[fid];
+          if (selection.empty()) {
+            continue;
+          }
+          // the row ids are ascending and distinct
+          if (static_cast<int64_t>(selection.size()) == cur_rb->num_rows()) {
+            divided[fid][got_batch] = cur_rb;
+            continue;
+          }
+          take_statuses[i] &= Take(cur_rb, selection, divided[fid][got_batch]);
+        }
+      }
+    });
+  }
+  for (auto& thrd : take_threads) {
+    thrd.join();
+  }
+  for (auto& status : take_statuses) {
+    VY_OK_OR_RAISE(status);
+  }
+
+  for (auto& batches : divided) {
+    batches.erase(std::remove(batches.begin(), batches.end(), nullptr),
+                  batches.end());
+  }
+  VY_OK_OR_RAISE(ShuffleRecordBatches(comm_spec, divided));
+  record_batches_in = std::move(divided[comm_spec.fid()]);
+  return {};
+}
+
+void ShuffleSelectedRowsByArchives(
     std::shared_ptr<arrow::Schema> schema,
     std::vector<std::shared_ptr<arrow::RecordBatch>>& record_batches_out,
     const std::vector<std::vector<std::vector<int64_t>>>& offset_lists,
@@ -619,10 +691,39 @@ void ShuffleTableByOffsetLists(
   MPI_Barrier(comm_spec.comm());
 }
 
-template <typename VID_TYPE>
-boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyEdgeTable(
-    const grape::CommSpec& comm_spec, IdParser<VID_TYPE>& id_parser,
-    int src_col_id, int dst_col_id, std::shared_ptr<arrow::Table>& table_in) {
+/**
+ * @brief Send the rows `offset_lists[batch][fid]` of each batch to the
+ * fragment `fid`, the received rows (including the local ones) are placed
+ * into `record_batches_in` in an unspecified order.
+ *
+ * The selected rows are shuffled as arrow IPC messages when all columns can
+ * be gathered by `Take`, and serialized item by item otherwise. The schema
+ * is consistent across workers, so all workers take the same path.
+ */
+inline boost::leaf::result<void> ShuffleTableByOffsetLists(
+    std::shared_ptr<arrow::Schema> schema,
+    std::vector<std::shared_ptr<arrow::RecordBatch>>& record_batches_out,
+    const std::vector<std::vector<std::vector<int64_t>>>& offset_lists,
+    std::vector<std::shared_ptr<arrow::RecordBatch>>& record_batches_in,
+    const grape::CommSpec& comm_spec) {
+  if (TakeSupported(*schema)) {
+    return ShuffleSelectedRowsByIPC(record_batches_out, offset_lists,
+                                    record_batches_in, comm_spec);
+  }
+  ShuffleSelectedRowsByArchives(schema, record_batches_out, offset_lists,
+                                record_batches_in, comm_spec);
+  return {};
+}
+
+/**
+ * @brief Shuffle the edges to the fragments that `assign(src_gid, dst_gid,
+ * offset_list, row_id)` appends the row to, `offset_list` holds the rows of
+ * the batch for each fragment.
+ */
+template <typename VID_TYPE, typename ASSIGN_T>
+boost::leaf::result<std::shared_ptr<arrow::Table>> ShuffleEdgeTableBy(
+    const grape::CommSpec& comm_spec, int src_col_id, int dst_col_id,
+    std::shared_ptr<arrow::Table>& table_in, const ASSIGN_T& assign) {
   BOOST_LEAF_CHECK(SchemaConsistent(*table_in->schema(), comm_spec));
 
   std::vector<std::shared_ptr<arrow::RecordBatch>> record_batches;
@@ -663,16 +764,7 @@ boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyEdgeTable(
                 ->raw_values();
 
         for (int64_t row_id = 0; row_id < row_num; ++row_id) {
-          VID_TYPE src_gid = src_col[row_id];
-          VID_TYPE dst_gid = dst_col[row_id];
-
-          grape::fid_t src_fid = id_parser.GetFid(src_gid);
-          grape::fid_t dst_fid = id_parser.GetFid(dst_gid);
-
-          offset_list[src_fid].push_back(row_id);
-          if (src_fid != dst_fid) {
-            offset_list[dst_fid].push_back(row_id);
-          }
+          assign(src_col[row_id], dst_col[row_id], offset_list, row_id);
         }
       }
     });
@@ -683,8 +775,9 @@ boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyEdgeTable(
 
   std::vector<std::shared_ptr<arrow::RecordBatch>> batches_in;
 
-  ShuffleTableByOffsetLists(table_in->schema(), record_batches, offset_lists,
-                            batches_in, comm_spec);
+  BOOST_LEAF_CHECK(ShuffleTableByOffsetLists(table_in->schema(),
+                                             record_batches, offset_lists,
+                                             batches_in, comm_spec));
 
   batches_in.erase(std::remove_if(batches_in.begin(), batches_in.end(),
                                   [](std::shared_ptr<arrow::RecordBatch>& e) {
@@ -710,12 +803,55 @@ boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyEdgeTable(
   return table_out;
 }
 
+/**
+ * @brief Shuffle the edges by an edge-cut, i.e., each edge goes to the
+ * fragments that own its endpoints.
+ */
+template <typename VID_TYPE>
+boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyEdgeTable(
+    const grape::CommSpec& comm_spec, IdParser<VID_TYPE>& id_parser,
+    int src_col_id, int dst_col_id, std::shared_ptr<arrow::Table>& table_in) {
+  return ShuffleEdgeTableBy<VID_TYPE>(
+      comm_spec, src_col_id, dst_col_id, table_in,
+      [&id_parser](VID_TYPE src_gid, VID_TYPE dst_gid,
+                   std::vector<std::vector<int64_t>>& offset_list,
+                   int64_t row_id) {
+        grape::fid_t src_fid = id_parser.GetFid(src_gid);
+        grape::fid_t dst_fid = id_parser.GetFid(dst_gid);
+
+        offset_list[src_fid].push_back(row_id);
+        if (src_fid != dst_fid) {
+          offset_list[dst_fid].push_back(row_id);
+        }
+      });
+}
+
+/**
+ * @brief Shuffle the edges by a vertex-cut, i.e., each edge goes to the one
+ * fragment that the edge partitioner (e.g., GridEdgePartitioner) assigns it
+ * to, given the owners of its endpoints.
+ */
+template <typename VID_TYPE, typename EDGE_PARTITIONER_T>
+boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyEdgeTable(
+    const grape::CommSpec& comm_spec, IdParser<VID_TYPE>& id_parser,
+    const EDGE_PARTITIONER_T& edge_partitioner, int src_col_id,
+    int dst_col_id, std::shared_ptr<arrow::Table>& table_in) {
+  return ShuffleEdgeTableBy<VID_TYPE>(
+      comm_spec, src_col_id, dst_col_id, table_in,
+      [&id_parser, &edge_partitioner](
+          VID_TYPE src_gid, VID_TYPE dst_gid,
+          std::vector<std::vector<int64_t>>& offset_list, int64_t row_id) {
+        offset_list[edge_partitioner.GetPartitionId(id_parser.GetFid(src_gid),
+                                                    id_parser.GetFid(dst_gid))]
+            .push_back(row_id);
+      });
+}
+
 template <typename PARTITIONER_T>
 boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyVertexTable(
     const grape::CommSpec& comm_spec, const PARTITIONER_T& partitioner,
     std::shared_ptr<arrow::Table>& table_in) {
   using oid_t = typename PARTITIONER_T::oid_t;
-  using internal_oid_t = typename InternalType<oid_t>::type;
   using oid_array_type = typename ConvertToArrowType<oid_t>::ArrayType;
 
   BOOST_LEAF_CHECK(SchemaConsistent(*table_in->schema(), comm_spec));
@@ -748,10 +884,10 @@ boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyVertexTable(
         std::shared_ptr<oid_array_type> id_col =
             std::dynamic_pointer_cast<oid_array_type>(cur_batch->column(0));
 
+        std::vector<grape::fid_t> fids(row_num);
+        partitioner.GetPartitionIds(*id_col, fids.data());
         for (int64_t row_id = 0; row_id < row_num; ++row_id) {
-          internal_oid_t rs = id_col->GetView(row_id);
-          grape::fid_t fid = partitioner.GetPartitionId(oid_t(rs));
-          offset_list[fid].push_back(row_id);
+          offset_list[fids[row_id]].push_back(row_id);
         }
       }
     });
@@ -762,8 +898,9 @@ boost::leaf::result<std::shared_ptr<arrow::Table>> ShufflePropertyVertexTable(
 
   std::vector<std::shared_ptr<arrow::RecordBatch>> batches_in;
 
-  ShuffleTableByOffsetLists(table_in->schema(), record_batches, offset_lists,
-                            batches_in, comm_spec);
+  BOOST_LEAF_CHECK(ShuffleTableByOffsetLists(table_in->schema(),
+                                             record_batches, offset_lists,
+                                             batches_in, comm_spec));
 
   batches_in.erase(std::remove_if(batches_in.begin(), batches_in.end(),
                                   [](std::shared_ptr<arrow::RecordBatch>& e) {
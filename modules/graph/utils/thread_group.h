@@ -15,88 +15,107 @@ limitations under the License.
 
 #ifndef MODULES_GRAPH_UTILS_THREAD_GROUP_H_
 #define MODULES_GRAPH_UTILS_THREAD_GROUP_H_
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <future>
+#include <limits>
+#include <map>
 #include <memory>
-#include <queue>
+#include <mutex>
+#include <stdexcept>
 #include <thread>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "common/util/status.h"
 #include "graph/utils/error.h"
+#include "graph/utils/thread_pool.h"
 
 namespace vineyard {
+
+/**
+ * @brief ThreadGroup runs a group of tasks on the workers of a ThreadPool,
+ * the process-wide pool by default, at most `parallelism` of them at the same
+ * time, rather than on a thread for each task.
+ *
+ * The group keeps its pending tasks to itself and submits at most
+ * `parallelism` runners to the pool, each of which runs the pending tasks
+ * one after another. A thread waiting for the results runs the pending tasks
+ * of the group as well, thus nested groups never wait for an idle worker.
+ * The tasks that must run concurrently with each other, e.g., the two sides
+ * of a synchronous exchange, should use dedicated threads instead.
+ */
 class ThreadGroup {
   using tid_t = uint32_t;
   using return_t = Status;
 
  public:
-  explicit ThreadGroup(tid_t parallelism = std::thread::hardware_concurrency())
-      : parallelism_(parallelism), tid_(0), stopped_(false) {}
+  explicit ThreadGroup(tid_t parallelism = std::thread::hardware_concurrency(),
+                       ThreadPool& pool = ThreadPool::Default())
+      : parallelism_(std::max(parallelism, static_cast<tid_t>(1))),
+        tid_(0),
+        pool_(pool),
+        state_(std::make_shared<State>()) {}
 
   template <class F_T, class... ARGS_T>
   tid_t AddTask(F_T&& f, ARGS_T&&... args) {
-    if (stopped_) {
-      throw std::runtime_error("ThreadGroup is stopped");
-    }
-    while (getRunningThreadNum() >= parallelism_) {
-      std::lock_guard<std::mutex> lg(mutex_);
+    auto fn = std::bind(std::forward<F_T>(f), std::forward<ARGS_T>(args)...);
+    auto task = std::make_shared<std::packaged_task<return_t()>>(
+        [fn = std::move(fn)]() mutable -> return_t {
+          try {
+            return fn();
+          } catch (std::runtime_error& e) {
+            return Status(StatusCode::kUnknownError, e.what());
+          }
+        });
+    tasks_.emplace(tid_, task->get_future());
 
-      while (!finished_threads_.empty()) {
-        finished_threads_.front().join();
-        finished_threads_.pop();
+    bool spawn = false;
+    {
+      std::lock_guard<std::mutex> lg(state_->mutex);
+      state_->pending.emplace_back([task]() { (*task)(); });
+      if (state_->runners < parallelism_) {
+        state_->runners += 1;
+        spawn = true;
       }
-      std::this_thread::yield();
     }
-
-    auto task_wrapper = [this](tid_t tid, F_T&& _f,
-                               auto&&... _args) -> return_t {
-      return_t v;
-
-      try {
-        v = std::move(_f(std::forward<ARGS_T>(_args)...));
-      } catch (std::runtime_error& e) {
-        v = Status(StatusCode::kUnknownError, e.what());
-      }
-
-      std::lock_guard<std::mutex> lg(mutex_);
-
-      finished_threads_.push(std::move(threads_.at(tid)));
-      threads_.erase(tid);
-      return v;
-    };
-
-    auto task = std::make_shared<std::packaged_task<return_t()>>(
-        std::bind(std::move(task_wrapper), tid_, std::forward<F_T>(f),
-                  std::forward<ARGS_T>(args)...));
-
-    std::lock_guard<std::mutex> lg(mutex_);
-
-    threads_.emplace(tid_, std::thread([task]() { (*task)(); }));
-    tasks_[tid_] = task->get_future();
+    if (spawn) {
+      auto state = state_;
+      pool_.Submit([state]() {
+        std::function<void()> pending;
+        while (state->Take(pending, true)) {
+          pending();
+        }
+      });
+    }
     return tid_++;
   }
 
   ~ThreadGroup() {
-    stopped_ = true;
-    while (getRunningThreadNum() > 0) {
-      std::this_thread::yield();
-    }
-
-    std::lock_guard<std::mutex> lg(mutex_);
-
-    while (!finished_threads_.empty()) {
-      finished_threads_.front().join();
-      finished_threads_.pop();
+    for (auto& task : tasks_) {
+      if (task.second.valid()) {
+        wait(task.second);
+      }
     }
   }
 
   return_t TaskResult(tid_t tid) {
     auto fu_it = tasks_.find(tid);
+    wait(fu_it->second);
     return fu_it->second.get();
   }
 
+  /**
+   * @brief The results of the tasks that have not been taken, in the order of
+   * the tasks being added.
+   */
   std::vector<return_t> TakeResults() {
     std::vector<return_t> results;
     auto it = tasks_.begin();
@@ -104,6 +123,7 @@ class ThreadGroup {
     while (it != tasks_.end()) {
       auto& fu = it->second;
 
+      wait(fu);
       results.push_back(fu.get());
       it = tasks_.erase(it);
     }
@@ -111,18 +131,127 @@ class ThreadGroup {
   }
 
  private:
-  size_t getRunningThreadNum() {
-    std::unique_lock<std::mutex> lk(mutex_);
-    return threads_.size();
+  struct State {
+    std::mutex mutex;
+    std::deque<std::function<void()>> pending;
+    tid_t runners = 0;
+
+    /**
+     * @brief Take the next pending task, a runner retires once there's no
+     * pending task.
+     */
+    bool Take(std::function<void()>& task, bool const is_runner) {
+      std::lock_guard<std::mutex> lg(mutex);
+      if (pending.empty()) {
+        if (is_runner) {
+          runners -= 1;
+        }
+        return false;
+      }
+      task = std::move(pending.front());
+      pending.pop_front();
+      return true;
+    }
+  };
+
+  void wait(std::future<return_t>& fu) {
+    std::function<void()> pending;
+    while (fu.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      if (!state_->Take(pending, false)) {
+        fu.wait();
+        return;
+      }
+      pending();
+    }
   }
 
   tid_t parallelism_;
   tid_t tid_;
-  bool stopped_;
-  std::unordered_map<tid_t, std::thread> threads_;
-  std::unordered_map<tid_t, std::future<return_t>> tasks_;
-  std::queue<std::thread> finished_threads_;
+  ThreadPool& pool_;
+  std::shared_ptr<State> state_;
+  std::map<tid_t, std::future<return_t>> tasks_;
+};
+
+/**
+ * @brief Run `task(index)` for every index in [0, task_num) on at most
+ * `parallelism` workers of the process-wide pool, each of which takes the
+ * next index once it finishes one, thus the skewed tasks are balanced, and
+ * combine the returned statuses.
+ */
+template <typename FUNC_T>
+inline Status ParallelFor(
+    size_t const task_num, FUNC_T const& task,
+    size_t const parallelism = std::thread::hardware_concurrency()) {
+  std::atomic<size_t> next(0);
+  size_t worker_num =
+      std::max(static_cast<size_t>(1), std::min(parallelism, task_num));
+  ThreadGroup tg(static_cast<uint32_t>(worker_num));
+  for (size_t worker = 0; worker < worker_num; ++worker) {
+    tg.AddTask([&]() -> Status {
+      Status status;
+      size_t index;
+      while ((index = next.fetch_add(1)) < task_num) {
+        status &= task(index);
+      }
+      return status;
+    });
+  }
+  Status status;
+  for (auto& result : tg.TakeResults()) {
+    status &= result;
+  }
+  return status;
+}
+
+/**
+ * @brief MemoryBudget admits the concurrent tasks by their estimated memory
+ * footprint: a task waits until the footprint of the admitted tasks plus its
+ * own fits in the budget, except that a task is always admitted when no other
+ * task is, thus a task that is larger than the budget runs alone rather than
+ * never.
+ *
+ * The budget defaults to half of the available physical memory, and is
+ * unlimited where the available memory is unknown.
+ */
+class MemoryBudget {
+ public:
+  explicit MemoryBudget(size_t const budget = AvailableMemory() / 2)
+      : budget_(budget == 0 ? std::numeric_limits<size_t>::max() : budget) {}
+
+  void Acquire(size_t const bytes) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this, bytes]() {
+      return admitted_ == 0 ||
+             (admitted_ <= budget_ && budget_ - admitted_ >= bytes);
+    });
+    admitted_ += bytes;
+  }
+
+  void Release(size_t const bytes) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      admitted_ -= bytes;
+    }
+    cv_.notify_all();
+  }
+
+  static size_t AvailableMemory() {
+#if defined(_SC_AVPHYS_PAGES) && defined(_SC_PAGESIZE)
+    long pages = sysconf(_SC_AVPHYS_PAGES);  // NOLINT(runtime/int)
+    long page_size = sysconf(_SC_PAGESIZE);  // NOLINT(runtime/int)
+    if (pages > 0 && page_size > 0) {
+      return static_cast<size_t>(pages) * static_cast<size_t>(page_size);
+    }
+#endif
+    return 0;
+  }
+
+ private:
+  size_t const budget_;
+  size_t admitted_ = 0;
   std::mutex mutex_;
+  std::condition_variable cv_;
 };
+
 }  // namespace vineyard
 #endif  // MODULES_GRAPH_UTILS_THREAD_GROUP_H_
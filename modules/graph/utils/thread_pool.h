@@ -0,0 +1,167 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_GRAPH_UTILS_THREAD_POOL_H_
+#define MODULES_GRAPH_UTILS_THREAD_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace vineyard {
+
+/**
+ * @brief ThreadPool is a fixed set of persistent workers, each of which owns
+ * a queue of tasks. A worker runs the tasks of its own queue in LIFO order,
+ * and steals the oldest task from the other queues when its own queue is
+ * empty, thus a burst of tasks submitted by a worker is spread over the idle
+ * workers, and the workers sleep rather than spin when there's no task.
+ *
+ * The tasks submitted by a worker go to its own queue, and the tasks
+ * submitted by the other threads are distributed over the queues in turn.
+ * A task must not throw.
+ */
+class ThreadPool {
+ public:
+  using task_t = std::function<void()>;
+
+  explicit ThreadPool(size_t const concurrency = std::max(
+                          std::thread::hardware_concurrency(), 1u))
+      : stopped_(false), pending_(0), next_queue_(0) {
+    size_t worker_num = std::max(concurrency, static_cast<size_t>(1));
+    for (size_t index = 0; index < worker_num; ++index) {
+      queues_.emplace_back(new WorkQueue());
+    }
+    for (size_t index = 0; index < worker_num; ++index) {
+      workers_.emplace_back([this, index]() { run(index); });
+    }
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      stopped_ = true;
+    }
+    wakeup_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * @brief The pool shared by the whole process, it is created on first use
+   * and leaked, thus the tasks that are still running at exit are never
+   * joined.
+   */
+  static ThreadPool& Default() {
+    static ThreadPool* pool = new ThreadPool();
+    return *pool;
+  }
+
+  size_t Concurrency() const { return workers_.size(); }
+
+  void Submit(task_t task) {
+    auto const& current = current_worker();
+    size_t index = current.first == this
+                       ? current.second
+                       : next_queue_.fetch_add(1) % queues_.size();
+    {
+      std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+      queues_[index]->tasks.emplace_back(std::move(task));
+    }
+    pending_.fetch_add(1);
+    {
+      // pairs with the predicate check of the sleeping workers, so that the
+      // notification can't be lost
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    wakeup_.notify_one();
+  }
+
+ private:
+  struct WorkQueue {
+    std::mutex mutex;
+    std::deque<task_t> tasks;
+  };
+
+  /**
+   * @brief The pool and the index of the worker that is running on the
+   * current thread.
+   */
+  static std::pair<const ThreadPool*, size_t>& current_worker() {
+    thread_local std::pair<const ThreadPool*, size_t> current{nullptr, 0};
+    return current;
+  }
+
+  bool take(size_t const index, task_t& task) {
+    {
+      auto& queue = *queues_[index];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (!queue.tasks.empty()) {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+      }
+    }
+    for (size_t step = 1; step < queues_.size(); ++step) {
+      auto& queue = *queues_[(index + step) % queues_.size()];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (!queue.tasks.empty()) {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void run(size_t const index) {
+    current_worker() = std::make_pair(this, index);
+    while (true) {
+      task_t task;
+      if (take(index, task)) {
+        pending_.fetch_sub(1);
+        task();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      wakeup_.wait(lock, [this]() { return stopped_ || pending_.load() > 0; });
+      if (stopped_ && pending_.load() == 0) {
+        return;
+      }
+    }
+  }
+
+  bool stopped_;
+  std::atomic<size_t> pending_, next_queue_;
+  std::vector<std::unique_ptr<WorkQueue>> queues_;
+  std::vector<std::thread> workers_;
+  std::mutex sleep_mutex_;
+  std::condition_variable wakeup_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_GRAPH_UTILS_THREAD_POOL_H_
@@ -23,12 +23,15 @@ limitations under the License.
 #include <mutex>
 #include <string>
 #include <thread>
+#include <tuple>
 #include <vector>
 
 #include "basic/ds/array.h"
 #include "basic/ds/arrow.h"
 #include "basic/ds/hashmap.h"
+#include "basic/ds/perfect_hashmap.h"
 #include "client/client.h"
+#include "common/util/checksum.h"
 #include "common/util/functions.h"
 #include "common/util/typename.h"
 
@@ -48,6 +51,157 @@ namespace vineyard {
 template <typename OID_T, typename VID_T>
 class ArrowVertexMapBuilder;
 
+/**
+ * @brief Build the oid-to-gid mapping of the given oid array, where the gids
+ * are consecutive from `begin_gid`.
+ */
+template <typename MAP_T, typename MAP_BUILDER_T, typename OID_ARRAY_T,
+          typename VID_T>
+MAP_T BuildOidToGidMap(Client& client,
+                       const std::shared_ptr<OID_ARRAY_T>& array,
+                       VID_T begin_gid) {
+  MAP_BUILDER_T builder(client);
+  VID_T cur_gid = begin_gid;
+  int64_t vnum = array->length();
+  // builder.reserve(static_cast<size_t>(vnum));
+  for (int64_t k = 0; k < vnum; ++k) {
+    builder.emplace(array->GetView(k), cur_gid);
+    ++cur_gid;
+  }
+  return *std::dynamic_pointer_cast<MAP_T>(builder.Seal(client));
+}
+
+/**
+ * @brief Find the offset of `oid` in the ascending array `oids`.
+ *
+ * Each step probes the position interpolated from the values at both ends
+ * of the range, which takes O(log log n) steps for evenly spread oids, and
+ * then halves the range, so skewed oids still take O(log n) steps. Short
+ * ranges are finished by the binary search.
+ */
+template <typename OID_T>
+bool SearchSortedOid(const OID_T* oids, int64_t length, OID_T oid,
+                     int64_t& offset) {
+  int64_t low = 0, high = length;
+  while (high - low > 16) {
+    OID_T first = oids[low], last = oids[high - 1];
+    if (oid < first || last < oid) {
+      return false;
+    }
+    if (first == last) {
+      offset = low;
+      return true;
+    }
+    // interpolates in floating point, as `last - first` may overflow
+    long double ratio =
+        (static_cast<long double>(oid) - static_cast<long double>(first)) /
+        (static_cast<long double>(last) - static_cast<long double>(first));
+    int64_t probe =
+        low + static_cast<int64_t>(ratio * static_cast<long double>(
+                                               high - 1 - low));
+    probe = std::min(std::max(probe, low), high - 1);
+    if (oids[probe] < oid) {
+      low = probe + 1;
+    } else {
+      high = probe + 1;
+    }
+    if (high - low > 16) {
+      int64_t mid = low + (high - low) / 2;
+      if (oids[mid] < oid) {
+        low = mid + 1;
+      } else {
+        high = mid + 1;
+      }
+    }
+  }
+  const OID_T* iter = std::lower_bound(oids + low, oids + high, oid);
+  if (iter != oids + high && *iter == oid) {
+    offset = iter - oids;
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief The index from the string oids of an oid array to their offsets.
+ *
+ * It is keyed by the 64-bit fingerprints of the oids, i.e., a lookup hashes
+ * the oid once and compares it with the only candidate in the oid array,
+ * rather than keeping and comparing the string views in the hashmap. Oids
+ * whose fingerprints collide with the one of another oid are kept in a
+ * fallback map of strings.
+ */
+class StringOidIndex {
+  using oid_t = arrow::util::string_view;
+
+ public:
+  void Init(const std::shared_ptr<arrow::LargeStringArray>& array) {
+    array_ = array;
+    int64_t length = array->length();
+    offsets_.reserve(static_cast<size_t>(length));
+    for (int64_t k = 0; k < length; ++k) {
+      oid_t oid = array->GetView(k);
+      auto result = offsets_.emplace(Fingerprint(oid), k);
+      // keeps the first one for duplicated oids, as the emplace() of maps
+      if (!result.second && array->GetView(result.first->second) != oid) {
+        collisions_.emplace(oid, k);
+      }
+    }
+  }
+
+  bool Find(const oid_t& oid, int64_t& offset) const {
+    return find(oid, Fingerprint(oid), offset);
+  }
+
+  /**
+   * @brief Lookup a batch of oids, the fingerprints of the batch are computed
+   * in a tight loop before probing the index.
+   */
+  void FindBatch(const oid_t* oids, size_t n, int64_t* offsets,
+                 bool* found) const {
+    constexpr size_t kBatchSize = 256;
+    uint64_t fingerprints[kBatchSize];
+    for (size_t begin = 0; begin < n; begin += kBatchSize) {
+      size_t end = std::min(n, begin + kBatchSize);
+      for (size_t i = begin; i < end; ++i) {
+        fingerprints[i - begin] = Fingerprint(oids[i]);
+      }
+      for (size_t i = begin; i < end; ++i) {
+        found[i] = find(oids[i], fingerprints[i - begin], offsets[i]);
+      }
+    }
+  }
+
+  static uint64_t Fingerprint(const oid_t& oid) {
+    return Checksum(oid.data(), oid.size());
+  }
+
+ private:
+  bool find(const oid_t& oid, uint64_t fingerprint, int64_t& offset) const {
+    auto iter = offsets_.find(fingerprint);
+    if (iter == offsets_.end()) {
+      return false;
+    }
+    if (array_->GetView(iter->second) == oid) {
+      offset = iter->second;
+      return true;
+    }
+    if (collisions_.empty()) {
+      return false;
+    }
+    auto collision = collisions_.find(oid);
+    if (collision == collisions_.end()) {
+      return false;
+    }
+    offset = collision->second;
+    return true;
+  }
+
+  std::shared_ptr<arrow::LargeStringArray> array_;
+  ska::flat_hash_map<uint64_t, int64_t> offsets_;
+  ska::flat_hash_map<oid_t, int64_t> collisions_;
+};
+
 template <typename OID_T, typename VID_T>
 class ArrowVertexMap
     : public vineyard::Registered<ArrowVertexMap<OID_T, VID_T>> {
@@ -72,17 +226,36 @@ class ArrowVertexMap
 
     this->fnum_ = meta.GetKeyValue<fid_t>("fnum");
     this->label_num_ = meta.GetKeyValue<label_id_t>("label_num");
+    this->use_perfect_hash_ = meta.Haskey("use_perfect_hash") &&
+                              meta.GetKeyValue<int>("use_perfect_hash");
+    this->use_sorted_oids_ = meta.Haskey("use_sorted_oids") &&
+                             meta.GetKeyValue<int>("use_sorted_oids");
 
     id_parser_.Init(fnum_, label_num_);
 
-    o2g_.resize(fnum_);
+    if (use_perfect_hash_) {
+      o2g_p_.resize(fnum_);
+    } else if (!use_sorted_oids_) {
+      o2g_.resize(fnum_);
+    }
     oid_arrays_.resize(fnum_);
     for (fid_t i = 0; i < fnum_; ++i) {
-      o2g_[i].resize(label_num_);
+      if (use_perfect_hash_) {
+        o2g_p_[i].resize(label_num_);
+      } else if (!use_sorted_oids_) {
+        o2g_[i].resize(label_num_);
+      }
       oid_arrays_[i].resize(label_num_);
       for (label_id_t j = 0; j < label_num_; ++j) {
-        o2g_[i][j].Construct(meta.GetMemberMeta("o2g_" + std::to_string(i) +
-                                                "_" + std::to_string(j)));
+        if (!use_sorted_oids_) {
+          auto map_meta = meta.GetMemberMeta("o2g_" + std::to_string(i) +
+                                             "_" + std::to_string(j));
+          if (use_perfect_hash_) {
+            o2g_p_[i][j].Construct(map_meta);
+          } else {
+            o2g_[i][j].Construct(map_meta);
+          }
+        }
 
         typename InternalType<oid_t>::vineyard_array_type array;
         array.Construct(meta.GetMemberMeta("oid_arrays_" + std::to_string(i) +
@@ -107,12 +280,32 @@ class ArrowVertexMap
   }
 
   bool GetGid(fid_t fid, label_id_t label_id, oid_t oid, vid_t& gid) const {
-    auto iter = o2g_[fid][label_id].find(oid);
-    if (iter != o2g_[fid][label_id].end()) {
-      gid = iter->second;
-      return true;
+    if (use_sorted_oids_) {
+      return search(fid, label_id, oid, gid);
+    }
+    if (use_perfect_hash_) {
+      return lookup(o2g_p_[fid][label_id], oid, gid);
+    }
+    return lookup(o2g_[fid][label_id], oid, gid);
+  }
+
+  /**
+   * @brief Get the gids of a batch of oids that belong to the same fragment
+   * and label, `found` indicates whether each oid exists.
+   */
+  void GetGids(fid_t fid, label_id_t label_id, const oid_t* oids, size_t n,
+               vid_t* gids, bool* found) const {
+    if (use_sorted_oids_) {
+      for (size_t i = 0; i < n; ++i) {
+        found[i] = search(fid, label_id, oids[i], gids[i]);
+      }
+    } else if (use_perfect_hash_) {
+      for (size_t i = 0; i < n; ++i) {
+        found[i] = lookup(o2g_p_[fid][label_id], oids[i], gids[i]);
+      }
+    } else {
+      o2g_[fid][label_id].find_batch(oids, n, gids, found);
     }
-    return false;
   }
 
   bool GetGid(label_id_t label_id, oid_t oid, vid_t& gid) const {
@@ -162,6 +355,14 @@ class ArrowVertexMap
 
   label_id_t label_num() const { return label_num_; }
 
+  bool use_perfect_hash() const { return use_perfect_hash_; }
+
+  /**
+   * @brief Whether the oids of each label of each fragment are ascending and
+   * resolved by searching the oid arrays, without oid-to-gid hashmaps.
+   */
+  bool use_sorted_oids() const { return use_sorted_oids_; }
+
   vid_t GetInnerVertexSize(fid_t fid) const {
     size_t num = 0;
     for (auto& v : oid_arrays_[fid]) {
@@ -174,91 +375,148 @@ class ArrowVertexMap
     return static_cast<vid_t>(oid_arrays_[fid][label_id]->length());
   }
 
+  /**
+   * @brief Add vertices to the vertex map, where the keys of
+   * `oid_arrays_map` are either existing labels, whose vertices are appended
+   * after the existing ones of each fragment, or new labels that follow the
+   * existing ones.
+   *
+   * Only the (fid, label) pairs that have new vertices are built and sealed,
+   * the oid arrays and hashmaps of the others are reused by reference, thus
+   * the cost is proportional to the size of the labels that are extended or
+   * added, rather than the whole vertex map. The gids of the existing
+   * vertices are unchanged, and for a vertex map with sorted oids, the new
+   * oids of an existing label must be greater than its existing ones.
+   */
   ObjectID AddVertices(
       Client& client,
       const std::map<label_id_t, std::vector<std::shared_ptr<oid_array_t>>>&
           oid_arrays_map) {
-    int extra_label_num = oid_arrays_map.size();
-
+    std::map<label_id_t, std::vector<std::shared_ptr<oid_array_t>>> extended;
     std::vector<std::vector<std::shared_ptr<oid_array_t>>> oid_arrays;
-    oid_arrays.resize(extra_label_num);
     for (auto& pair : oid_arrays_map) {
-      oid_arrays[pair.first - label_num_] = pair.second;
+      if (pair.first < label_num_) {
+        extended.emplace(pair.first, pair.second);
+      } else {
+        CHECK_EQ(static_cast<size_t>(pair.first - label_num_),
+                 oid_arrays.size())
+            << "The new vertex labels must follow the existing ones";
+        oid_arrays.emplace_back(pair.second);
+      }
     }
-    return AddNewVertexLabels(client, oid_arrays);
+    return addVertices(client, extended, oid_arrays);
   }
 
   ObjectID AddNewVertexLabels(
       Client& client,
       const std::vector<std::vector<std::shared_ptr<oid_array_t>>>&
           oid_arrays) {
-    size_t extra_label_num = oid_arrays.size();
-    int task_num = static_cast<int>(fnum_) * static_cast<int>(extra_label_num);
+    return addVertices(client, {}, oid_arrays);
+  }
+
+ private:
+  ObjectID addVertices(
+      Client& client,
+      const std::map<label_id_t, std::vector<std::shared_ptr<oid_array_t>>>&
+          extended,
+      const std::vector<std::vector<std::shared_ptr<oid_array_t>>>&
+          oid_arrays) {
+    label_id_t total_label_num =
+        label_num_ + static_cast<label_id_t>(oid_arrays.size());
+
+    // the (fid, label) pairs to build
+    std::vector<std::pair<fid_t, label_id_t>> tasks;
+    for (auto const& pair : extended) {
+      for (fid_t fid = 0; fid < fnum_ && fid < pair.second.size(); ++fid) {
+        if (pair.second[fid] != nullptr && pair.second[fid]->length() > 0) {
+          tasks.emplace_back(fid, pair.first);
+        }
+      }
+    }
+    for (label_id_t label = label_num_; label < total_label_num; ++label) {
+      for (fid_t fid = 0; fid < fnum_; ++fid) {
+        tasks.emplace_back(fid, label);
+      }
+    }
 
     std::vector<std::vector<typename InternalType<oid_t>::vineyard_array_type>>
-        vy_oid_arrays;
-    std::vector<std::vector<vineyard::Hashmap<oid_t, vid_t>>> vy_o2g;
-    int total_label_num = label_num_ + extra_label_num;
-    vy_oid_arrays.resize(fnum_);
-    vy_o2g.resize(fnum_);
+        vy_oid_arrays(fnum_);
+    std::vector<std::vector<vineyard::Hashmap<oid_t, vid_t>>> vy_o2g(fnum_);
+    std::vector<std::vector<vineyard::PerfectHashmap<oid_t, vid_t>>> vy_o2g_p(
+        fnum_);
+    std::vector<std::vector<bool>> built(
+        fnum_, std::vector<bool>(total_label_num, false));
     for (fid_t i = 0; i < fnum_; ++i) {
-      vy_oid_arrays[i].resize(extra_label_num);
-      vy_o2g[i].resize(extra_label_num);
+      vy_oid_arrays[i].resize(total_label_num);
+      if (use_perfect_hash_) {
+        vy_o2g_p[i].resize(total_label_num);
+      } else {
+        vy_o2g[i].resize(total_label_num);
+      }
+    }
+    for (auto const& task : tasks) {
+      built[task.first][task.second] = true;
     }
 
-    int thread_num = std::min(
-        static_cast<int>(std::thread::hardware_concurrency()), task_num);
-    std::atomic<int> task_id(0);
-    std::vector<std::thread> threads(thread_num);
-    for (int i = 0; i < thread_num; ++i) {
-      threads[i] = std::thread([&]() {
-        while (true) {
-          int got_task_id = task_id.fetch_add(1);
-          if (got_task_id >= task_num) {
-            break;
-          }
-          fid_t cur_fid = static_cast<fid_t>(got_task_id) % fnum_;
-          auto cur_label =
-              static_cast<label_id_t>(static_cast<fid_t>(got_task_id) / fnum_);
-
-          vineyard::HashmapBuilder<oid_t, vid_t> builder(client);
-          auto array = oid_arrays[cur_label][cur_fid];
-          {
-            vid_t cur_gid =
-                id_parser_.GenerateId(cur_fid, label_num_ + cur_label, 0);
-            int64_t vnum = array->length();
-            // builder.reserve(static_cast<size_t>(vnum));
-            for (int64_t k = 0; k < vnum; ++k) {
-              builder.emplace(array->GetView(k), cur_gid);
-              ++cur_gid;
-            }
-          }
-
-          {
-            typename InternalType<oid_t>::vineyard_builder_type array_builder(
-                client, array);
-            vy_oid_arrays[cur_fid][cur_label] =
-                *std::dynamic_pointer_cast<vineyard::NumericArray<oid_t>>(
-                    array_builder.Seal(client));
+    ThreadGroup tg;
+    auto builder_fn = [&](fid_t const cur_fid,
+                          label_id_t const cur_label) -> Status {
+      std::shared_ptr<oid_array_t> array;
+      if (cur_label < label_num_) {
+        // the existing vertices keep their offsets, i.e., their gids
+        std::shared_ptr<arrow::Array> concatenated;
+        RETURN_ON_ERROR(ConcatenateChunks(
+            std::make_shared<arrow::ChunkedArray>(arrow::ArrayVector{
+                oid_arrays_[cur_fid][cur_label],
+                extended.at(cur_label)[cur_fid]}),
+            &concatenated));
+        array = std::dynamic_pointer_cast<oid_array_t>(concatenated);
+      } else {
+        array = oid_arrays[cur_label - label_num_][cur_fid];
+      }
+      vid_t begin_gid = id_parser_.GenerateId(cur_fid, cur_label, 0);
+      if (use_sorted_oids_) {
+        // the new labels are searched as well
+        CHECK(std::is_sorted(array->raw_values(),
+                             array->raw_values() + array->length()))
+            << "The oids of a vertex map with sorted oids must be sorted";
+      } else if (use_perfect_hash_) {
+        vy_o2g_p[cur_fid][cur_label] = BuildOidToGidMap<
+            vineyard::PerfectHashmap<oid_t, vid_t>,
+            vineyard::PerfectHashmapBuilder<oid_t, vid_t>>(client, array,
+                                                           begin_gid);
+      } else {
+        vy_o2g[cur_fid][cur_label] =
+            BuildOidToGidMap<vineyard::Hashmap<oid_t, vid_t>,
+                             vineyard::HashmapBuilder<oid_t, vid_t>>(
+                client, array, begin_gid);
+      }
 
-            vy_o2g[cur_fid][cur_label] =
-                *std::dynamic_pointer_cast<vineyard::Hashmap<oid_t, vid_t>>(
-                    builder.Seal(client));
-          }
-        }
-      });
+      typename InternalType<oid_t>::vineyard_builder_type array_builder(
+          client, array);
+      vy_oid_arrays[cur_fid][cur_label] =
+          *std::dynamic_pointer_cast<vineyard::NumericArray<oid_t>>(
+              array_builder.Seal(client));
+      return Status::OK();
+    };
+    for (auto const& task : tasks) {
+      tg.AddTask(builder_fn, task.first, task.second);
     }
-    for (auto& thrd : threads) {
-      thrd.join();
+    for (auto const& status : tg.TakeResults()) {
+      VINEYARD_CHECK_OK(status);
     }
 
-    vineyard::ObjectMeta old_meta, new_meta;
-    VINEYARD_CHECK_OK(client.GetMetaData(this->id(), old_meta));
+    // the local metadata has all members, no need to fetch it again
+    vineyard::ObjectMeta const& old_meta = this->meta();
+    vineyard::ObjectMeta new_meta;
 
     new_meta.SetTypeName(type_name<ArrowVertexMap<oid_t, vid_t>>());
 
     new_meta.AddKeyValue("fnum", fnum_);
     new_meta.AddKeyValue("label_num", total_label_num);
+    new_meta.AddKeyValue("use_perfect_hash",
+                         static_cast<int>(use_perfect_hash_));
+    new_meta.AddKeyValue("use_sorted_oids", static_cast<int>(use_sorted_oids_));
 
     size_t nbytes = 0;
     for (fid_t i = 0; i < fnum_; ++i) {
@@ -267,21 +525,27 @@ class ArrowVertexMap
             "oid_arrays_" + std::to_string(i) + "_" + std::to_string(j);
         std::string map_name =
             "o2g_" + std::to_string(i) + "_" + std::to_string(j);
-        if (j < label_num_) {
+        if (!built[i][j]) {
           auto array_meta = old_meta.GetMemberMeta(array_name);
           new_meta.AddMember(array_name, array_meta);
           nbytes += array_meta.GetNBytes();
 
-          auto map_meta = old_meta.GetMemberMeta(map_name);
-          new_meta.AddMember(map_name, map_meta);
-          nbytes += map_meta.GetNBytes();
+          if (!use_sorted_oids_) {
+            auto map_meta = old_meta.GetMemberMeta(map_name);
+            new_meta.AddMember(map_name, map_meta);
+            nbytes += map_meta.GetNBytes();
+          }
         } else {
-          new_meta.AddMember(array_name,
-                             vy_oid_arrays[i][j - label_num_].meta());
-          nbytes += vy_oid_arrays[i][j - label_num_].nbytes();
-
-          new_meta.AddMember(map_name, vy_o2g[i][j - label_num_].meta());
-          nbytes += vy_o2g[i][j - label_num_].nbytes();
+          new_meta.AddMember(array_name, vy_oid_arrays[i][j].meta());
+          nbytes += vy_oid_arrays[i][j].nbytes();
+
+          if (use_perfect_hash_) {
+            new_meta.AddMember(map_name, vy_o2g_p[i][j].meta());
+            nbytes += vy_o2g_p[i][j].nbytes();
+          } else if (!use_sorted_oids_) {
+            new_meta.AddMember(map_name, vy_o2g[i][j].meta());
+            nbytes += vy_o2g[i][j].nbytes();
+          }
         }
       }
     }
@@ -292,15 +556,37 @@ class ArrowVertexMap
     return ret;
   }
 
- private:
+  template <typename MAP_T>
+  static bool lookup(const MAP_T& map, oid_t oid, vid_t& gid) {
+    auto iter = map.find(oid);
+    if (iter != map.end()) {
+      gid = iter->second;
+      return true;
+    }
+    return false;
+  }
+
+  bool search(fid_t fid, label_id_t label_id, oid_t oid, vid_t& gid) const {
+    auto const& array = oid_arrays_[fid][label_id];
+    int64_t offset;
+    if (SearchSortedOid(array->raw_values(), array->length(), oid, offset)) {
+      gid = id_parser_.GenerateId(fid, label_id, offset);
+      return true;
+    }
+    return false;
+  }
+
   fid_t fnum_;
   label_id_t label_num_;
+  bool use_perfect_hash_ = false;
+  bool use_sorted_oids_ = false;
 
   vineyard::IdParser<vid_t> id_parser_;
 
   // frag->label->oid
   std::vector<std::vector<std::shared_ptr<oid_array_t>>> oid_arrays_;
   std::vector<std::vector<vineyard::Hashmap<oid_t, vid_t>>> o2g_;
+  std::vector<std::vector<vineyard::PerfectHashmap<oid_t, vid_t>>> o2g_p_;
 
   template <typename _OID_T, typename _VID_T>
   friend class ArrowVertexMapBuilder;
@@ -366,14 +652,29 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
   }
 
   bool GetGid(fid_t fid, label_id_t label_id, oid_t oid, vid_t& gid) const {
-    auto iter = o2g_[fid][label_id].find(oid);
-    if (iter != o2g_[fid][label_id].end()) {
-      gid = iter->second;
+    int64_t offset;
+    if (o2g_[fid][label_id].Find(oid, offset)) {
+      gid = id_parser_.GenerateId(fid, label_id, offset);
       return true;
     }
     return false;
   }
 
+  /**
+   * @brief Get the gids of a batch of oids that belong to the same fragment
+   * and label, `found` indicates whether each oid exists.
+   */
+  void GetGids(fid_t fid, label_id_t label_id, const oid_t* oids, size_t n,
+               vid_t* gids, bool* found) const {
+    std::vector<int64_t> offsets(n);
+    o2g_[fid][label_id].FindBatch(oids, n, offsets.data(), found);
+    for (size_t i = 0; i < n; ++i) {
+      if (found[i]) {
+        gids[i] = id_parser_.GenerateId(fid, label_id, offsets[i]);
+      }
+    }
+  }
+
   bool GetGid(label_id_t label_id, oid_t oid, vid_t& gid) const {
     for (fid_t i = 0; i < fnum_; ++i) {
       if (GetGid(i, label_id, oid, gid)) {
@@ -429,39 +730,71 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
     return static_cast<vid_t>(oid_arrays_[fid][label_id]->length());
   }
 
+  /**
+   * @brief Add vertices to existing labels or new labels, see also
+   * `ArrowVertexMap::AddVertices`, only the oid arrays of the (fid, label)
+   * pairs that have new vertices are built and sealed.
+   */
   ObjectID AddVertices(
       Client& client,
       const std::map<label_id_t, std::vector<std::shared_ptr<oid_array_t>>>&
           oid_arrays_map) {
-    int extra_label_num = oid_arrays_map.size();
-
+    std::map<label_id_t, std::vector<std::shared_ptr<oid_array_t>>> extended;
     std::vector<std::vector<std::shared_ptr<oid_array_t>>> oid_arrays;
-    oid_arrays.resize(extra_label_num);
     for (auto& pair : oid_arrays_map) {
-      oid_arrays[pair.first - label_num_] = pair.second;
+      if (pair.first < label_num_) {
+        extended.emplace(pair.first, pair.second);
+      } else {
+        CHECK_EQ(static_cast<size_t>(pair.first - label_num_),
+                 oid_arrays.size())
+            << "The new vertex labels must follow the existing ones";
+        oid_arrays.emplace_back(pair.second);
+      }
     }
-    return AddNewVertexLabels(client, oid_arrays);
+    return addVertices(client, extended, oid_arrays);
   }
 
   ObjectID AddNewVertexLabels(
       Client& client,
       const std::vector<std::vector<std::shared_ptr<oid_array_t>>>&
           oid_arrays) {
-    size_t extra_label_num = oid_arrays.size();
+    return addVertices(client, {}, oid_arrays);
+  }
+
+ private:
+  ObjectID addVertices(
+      Client& client,
+      const std::map<label_id_t, std::vector<std::shared_ptr<oid_array_t>>>&
+          extended,
+      const std::vector<std::vector<std::shared_ptr<oid_array_t>>>&
+          oid_arrays) {
+    label_id_t total_label_num =
+        label_num_ + static_cast<label_id_t>(oid_arrays.size());
 
     std::vector<std::vector<typename InternalType<oid_t>::vineyard_array_type>>
-        vy_oid_arrays;
-    int total_label_num = label_num_ + extra_label_num;
-    vy_oid_arrays.resize(fnum_);
+        vy_oid_arrays(fnum_);
+    std::vector<std::vector<bool>> built(
+        fnum_, std::vector<bool>(total_label_num, false));
     for (fid_t i = 0; i < fnum_; ++i) {
-      vy_oid_arrays[i].resize(extra_label_num);
+      vy_oid_arrays[i].resize(total_label_num);
     }
 
     ThreadGroup tg;
-    auto builder_fn = [&client, &oid_arrays, &vy_oid_arrays](
-                          fid_t const fid,
+    auto builder_fn = [&](fid_t const fid,
                           label_id_t const vlabel_id) -> Status {
-      auto& array = oid_arrays[vlabel_id][fid];
+      std::shared_ptr<oid_array_t> array;
+      if (vlabel_id < label_num_) {
+        // the existing vertices keep their offsets, i.e., their gids
+        std::shared_ptr<arrow::Array> concatenated;
+        RETURN_ON_ERROR(ConcatenateChunks(
+            std::make_shared<arrow::ChunkedArray>(
+                arrow::ArrayVector{oid_arrays_[fid][vlabel_id],
+                                   extended.at(vlabel_id)[fid]}),
+            &concatenated));
+        array = std::dynamic_pointer_cast<oid_array_t>(concatenated);
+      } else {
+        array = oid_arrays[vlabel_id - label_num_][fid];
+      }
       typename InternalType<oid_t>::vineyard_builder_type array_builder(client,
                                                                         array);
       vy_oid_arrays[fid][vlabel_id] = *std::dynamic_pointer_cast<
@@ -470,15 +803,28 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
       return Status::OK();
     };
 
-    for (fid_t fid = 0; fid < fnum_; ++fid) {
-      for (size_t vlabel_id = 0; vlabel_id < extra_label_num; ++vlabel_id) {
+    for (auto const& pair : extended) {
+      for (fid_t fid = 0; fid < fnum_ && fid < pair.second.size(); ++fid) {
+        if (pair.second[fid] != nullptr && pair.second[fid]->length() > 0) {
+          built[fid][pair.first] = true;
+          tg.AddTask(builder_fn, fid, pair.first);
+        }
+      }
+    }
+    for (label_id_t vlabel_id = label_num_; vlabel_id < total_label_num;
+         ++vlabel_id) {
+      for (fid_t fid = 0; fid < fnum_; ++fid) {
+        built[fid][vlabel_id] = true;
         tg.AddTask(builder_fn, fid, vlabel_id);
       }
     }
-    tg.TakeResults();
+    for (auto const& status : tg.TakeResults()) {
+      VINEYARD_CHECK_OK(status);
+    }
 
-    vineyard::ObjectMeta old_meta, new_meta;
-    VINEYARD_CHECK_OK(client.GetMetaData(this->id(), old_meta));
+    // the local metadata has all members, no need to fetch it again
+    vineyard::ObjectMeta const& old_meta = this->meta();
+    vineyard::ObjectMeta new_meta;
 
     new_meta.SetTypeName(type_name<ArrowVertexMap<oid_t, vid_t>>());
 
@@ -490,14 +836,13 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
       for (label_id_t j = 0; j < total_label_num; ++j) {
         std::string array_name =
             "oid_arrays_" + std::to_string(i) + "_" + std::to_string(j);
-        if (j < label_num_) {
+        if (!built[i][j]) {
           auto array_meta = old_meta.GetMemberMeta(array_name);
           new_meta.AddMember(array_name, array_meta);
           nbytes += array_meta.GetNBytes();
         } else {
-          new_meta.AddMember(array_name,
-                             vy_oid_arrays[i][j - label_num_].meta());
-          nbytes += vy_oid_arrays[i][j - label_num_].nbytes();
+          new_meta.AddMember(array_name, vy_oid_arrays[i][j].meta());
+          nbytes += vy_oid_arrays[i][j].nbytes();
         }
       }
     }
@@ -507,24 +852,24 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
     return ret;
   }
 
- private:
   void initHashmaps() {
     o2g_.resize(fnum_);
     for (fid_t i = 0; i < fnum_; ++i) {
       o2g_[i].resize(label_num_);
+    }
+
+    ThreadGroup tg;
+    for (fid_t i = 0; i < fnum_; ++i) {
       for (label_id_t j = 0; j < label_num_; ++j) {
-        auto array = oid_arrays_[i][j];
-        auto& map = o2g_[i][j];
-        {
-          vid_t cur_gid = id_parser_.GenerateId(i, j, 0);
-          int64_t vnum = array->length();
-          for (int64_t k = 0; k < vnum; ++k) {
-            map.emplace(array->GetView(k), cur_gid);
-            ++cur_gid;
-          }
-        }
+        tg.AddTask(
+            [this](fid_t const fid, label_id_t const label) -> Status {
+              o2g_[fid][label].Init(oid_arrays_[fid][label]);
+              return Status::OK();
+            },
+            i, j);
       }
     }
+    tg.TakeResults();
   }
 
   fid_t fnum_;
@@ -534,7 +879,7 @@ class ArrowVertexMap<arrow::util::string_view, VID_T>
 
   // frag->label->oid
   std::vector<std::vector<std::shared_ptr<oid_array_t>>> oid_arrays_;
-  std::vector<std::vector<ska::flat_hash_map<oid_t, vid_t>>> o2g_;
+  std::vector<std::vector<StringOidIndex>> o2g_;
 
   template <typename _OID_T, typename _VID_T>
   friend class ArrowVertexMapBuilder;
@@ -557,9 +902,11 @@ class ArrowVertexMapBuilder : public vineyard::ObjectBuilder {
     label_num_ = label_num;
     oid_arrays_.resize(fnum_);
     o2g_.resize(fnum_);
+    o2g_p_.resize(fnum_);
     for (fid_t i = 0; i < fnum_; ++i) {
       oid_arrays_[i].resize(label_num_);
       o2g_[i].resize(label_num_);
+      o2g_p_[i].resize(label_num_);
     }
   }
 
@@ -574,6 +921,25 @@ class ArrowVertexMapBuilder : public vineyard::ObjectBuilder {
     o2g_[fid][label] = rm;
   }
 
+  /**
+   * @brief Use the perfect hashmap as the oid-to-gid mapping, all labels of all
+   * fragments are expected to be set with the perfect hashmap.
+   */
+  void set_o2g(fid_t fid, label_id_t label,
+               const vineyard::PerfectHashmap<oid_t, vid_t>& rm) {
+    use_perfect_hash_ = true;
+    o2g_p_[fid][label] = rm;
+  }
+
+  /**
+   * @brief Resolve the oids by searching the oid arrays rather than by the
+   * oid-to-gid mappings, all oid arrays are expected to be ascending and no
+   * mapping is expected to be set.
+   */
+  void set_sorted_oids(bool use_sorted_oids) {
+    use_sorted_oids_ = use_sorted_oids;
+  }
+
   std::shared_ptr<vineyard::Object> _Seal(vineyard::Client& client) {
     // ensure the builder hasn't been sealed yet.
     ENSURE_NOT_SEALED(this);
@@ -594,12 +960,22 @@ class ArrowVertexMapBuilder : public vineyard::ObjectBuilder {
       }
     }
 
-    vertex_map->o2g_ = o2g_;
+    vertex_map->use_perfect_hash_ = use_perfect_hash_;
+    vertex_map->use_sorted_oids_ = use_sorted_oids_;
+    if (use_perfect_hash_) {
+      vertex_map->o2g_p_ = o2g_p_;
+    } else if (!use_sorted_oids_) {
+      vertex_map->o2g_ = o2g_;
+    }
 
     vertex_map->meta_.SetTypeName(type_name<ArrowVertexMap<oid_t, vid_t>>());
 
     vertex_map->meta_.AddKeyValue("fnum", fnum_);
     vertex_map->meta_.AddKeyValue("label_num", label_num_);
+    vertex_map->meta_.AddKeyValue("use_perfect_hash",
+                                  static_cast<int>(use_perfect_hash_));
+    vertex_map->meta_.AddKeyValue("use_sorted_oids",
+                                  static_cast<int>(use_sorted_oids_));
 
     size_t nbytes = 0;
     for (fid_t i = 0; i < fnum_; ++i) {
@@ -609,10 +985,15 @@ class ArrowVertexMapBuilder : public vineyard::ObjectBuilder {
             oid_arrays_[i][j].meta());
         nbytes += oid_arrays_[i][j].nbytes();
 
-        vertex_map->meta_.AddMember(
-            "o2g_" + std::to_string(i) + "_" + std::to_string(j),
-            o2g_[i][j].meta());
-        nbytes += o2g_[i][j].nbytes();
+        std::string map_name =
+            "o2g_" + std::to_string(i) + "_" + std::to_string(j);
+        if (use_perfect_hash_) {
+          vertex_map->meta_.AddMember(map_name, o2g_p_[i][j].meta());
+          nbytes += o2g_p_[i][j].nbytes();
+        } else if (!use_sorted_oids_) {
+          vertex_map->meta_.AddMember(map_name, o2g_[i][j].meta());
+          nbytes += o2g_[i][j].nbytes();
+        }
       }
     }
 
@@ -629,10 +1010,13 @@ class ArrowVertexMapBuilder : public vineyard::ObjectBuilder {
  private:
   fid_t fnum_;
   label_id_t label_num_;
+  bool use_perfect_hash_ = false;
+  bool use_sorted_oids_ = false;
 
   std::vector<std::vector<typename InternalType<oid_t>::vineyard_array_type>>
       oid_arrays_;
   std::vector<std::vector<vineyard::Hashmap<oid_t, vid_t>>> o2g_;
+  std::vector<std::vector<vineyard::PerfectHashmap<oid_t, vid_t>>> o2g_p_;
 };
 
 template <typename VID_T>
@@ -719,14 +1103,25 @@ class BasicArrowVertexMapBuilder : public ArrowVertexMapBuilder<OID_T, VID_T> {
   using vid_t = VID_T;
   using oid_array_t = typename vineyard::ConvertToArrowType<oid_t>::ArrayType;
   using label_id_t = property_graph_types::LABEL_ID_TYPE;
+  using o2g_builder_t = vineyard::ConcurrentHashmapBuilder<oid_t, vid_t>;
 
  public:
+  /**
+   * @param use_perfect_hash Whether to build the oid-to-gid mappings as
+   * PerfectHashmap, which is smaller and faster to lookup for immutable maps.
+   * @param use_sorted_oids Whether to skip the oid-to-gid mappings and search
+   * the oid arrays instead, which must be ascending. It takes about half of
+   * the memory at the cost of slower lookups.
+   */
   BasicArrowVertexMapBuilder(
       vineyard::Client& client, fid_t fnum, label_id_t label_num,
-      const std::vector<std::vector<std::shared_ptr<oid_array_t>>>& oid_arrays)
+      const std::vector<std::vector<std::shared_ptr<oid_array_t>>>& oid_arrays,
+      const bool use_perfect_hash = false, const bool use_sorted_oids = false)
       : ArrowVertexMapBuilder<oid_t, vid_t>(client),
         fnum_(fnum),
         label_num_(label_num),
+        use_perfect_hash_(use_perfect_hash),
+        use_sorted_oids_(use_sorted_oids),
         oid_arrays_(oid_arrays) {
     CHECK_EQ(oid_arrays.size(), label_num);
     id_parser_.Init(fnum_, label_num_);
@@ -734,6 +1129,18 @@ class BasicArrowVertexMapBuilder : public ArrowVertexMapBuilder<OID_T, VID_T> {
 
   vineyard::Status Build(vineyard::Client& client) override {
     this->set_fnum_label_num(fnum_, label_num_);
+    this->set_sorted_oids(use_sorted_oids_);
+    if (use_sorted_oids_) {
+      for (auto const& arrays : oid_arrays_) {
+        for (auto const& array : arrays) {
+          if (!std::is_sorted(array->raw_values(),
+                              array->raw_values() + array->length())) {
+            return vineyard::Status::Invalid(
+                "The oids must be sorted to be searched without hashmaps");
+          }
+        }
+      }
+    }
 
 #if 0
     for (fid_t i = 0; i < fnum_; ++i) {
@@ -766,57 +1173,67 @@ class BasicArrowVertexMapBuilder : public ArrowVertexMapBuilder<OID_T, VID_T> {
     }
 #else
     int task_num = static_cast<int>(fnum_) * static_cast<int>(label_num_);
-    int thread_num = std::min(
-        static_cast<int>(std::thread::hardware_concurrency()), task_num);
-    std::atomic<int> task_id(0);
+    int thread_num = static_cast<int>(std::thread::hardware_concurrency());
 
 #if defined(WITH_PROFILING)
     auto start_ts = GetCurrentTime();
 #endif
 
-    std::vector<std::thread> threads(thread_num);
-    for (int i = 0; i < thread_num; ++i) {
-      threads[i] = std::thread([&]() {
-        while (true) {
-          int got_task_id = task_id.fetch_add(1);
-          if (got_task_id >= task_num) {
-            break;
-          }
-          fid_t cur_fid = static_cast<fid_t>(got_task_id) % fnum_;
-          label_id_t cur_label =
-              static_cast<label_id_t>(static_cast<fid_t>(got_task_id) / fnum_);
-
-          vineyard::HashmapBuilder<oid_t, vid_t> builder(client);
-          auto array = oid_arrays_[cur_label][cur_fid];
-          {
-            vid_t cur_gid = id_parser_.GenerateId(cur_fid, cur_label, 0);
-            int64_t vnum = array->length();
-            // builder.reserve(static_cast<size_t>(vnum));
-            for (int64_t k = 0; k < vnum; ++k) {
-              builder.emplace(array->GetView(k), cur_gid);
-              ++cur_gid;
-            }
-          }
-
-          {
-            typename InternalType<oid_t>::vineyard_builder_type array_builder(
-                client, array);
-            this->set_oid_array(
-                cur_fid, cur_label,
-                *std::dynamic_pointer_cast<vineyard::NumericArray<oid_t>>(
-                    array_builder.Seal(client)));
-
-            this->set_o2g(
-                cur_fid, cur_label,
-                *std::dynamic_pointer_cast<vineyard::Hashmap<oid_t, vid_t>>(
-                    builder.Seal(client)));
-          }
-        }
-      });
-    }
-    for (auto& thrd : threads) {
-      thrd.join();
+    // the hashmaps are filled by chunks of the oid arrays from all threads,
+    // so that a few large labels don't serialize the construction
+    std::vector<std::unique_ptr<o2g_builder_t>> o2g_builders(
+        use_perfect_hash_ || use_sorted_oids_ ? 0 : task_num);
+    // | task id | the first oid | the end oid |
+    std::vector<std::tuple<int, int64_t, int64_t>> chunks;
+    for (int i = 0; i < static_cast<int>(o2g_builders.size()); ++i) {
+      int64_t vnum = taskArray(i)->length();
+      o2g_builders[i].reset(new o2g_builder_t(client, vnum));
+      for (int64_t begin = 0; begin < vnum; begin += kChunkSize) {
+        chunks.emplace_back(i, begin, std::min(vnum, begin + kChunkSize));
+      }
     }
+    parallelFor(thread_num, static_cast<int>(chunks.size()), [&](int index) {
+      int got_task_id = std::get<0>(chunks[index]);
+      auto& array = taskArray(got_task_id);
+      auto& builder = *o2g_builders[got_task_id];
+      vid_t cur_gid = taskGid(got_task_id) + std::get<1>(chunks[index]);
+      for (int64_t k = std::get<1>(chunks[index]);
+           k < std::get<2>(chunks[index]); ++k) {
+        builder.emplace(array->GetView(k), cur_gid);
+        ++cur_gid;
+      }
+    });
+
+    // seals the hashmaps (which already reside in blobs) and the oid arrays
+    parallelFor(std::min(thread_num, task_num), task_num, [&](int got_task_id) {
+      fid_t cur_fid = static_cast<fid_t>(got_task_id) % fnum_;
+      label_id_t cur_label =
+          static_cast<label_id_t>(static_cast<fid_t>(got_task_id) / fnum_);
+
+      auto& array = taskArray(got_task_id);
+      if (use_perfect_hash_ && !use_sorted_oids_) {
+        this->set_o2g(cur_fid, cur_label,
+                      BuildOidToGidMap<
+                          vineyard::PerfectHashmap<oid_t, vid_t>,
+                          vineyard::PerfectHashmapBuilder<oid_t, vid_t>>(
+                          client, array, taskGid(got_task_id)));
+      } else if (!o2g_builders.empty()) {
+        this->set_o2g(
+            cur_fid, cur_label,
+            *std::dynamic_pointer_cast<vineyard::Hashmap<oid_t, vid_t>>(
+                o2g_builders[got_task_id]->Seal(client)));
+        o2g_builders[got_task_id].reset();
+      }
+
+      {
+        typename InternalType<oid_t>::vineyard_builder_type array_builder(
+            client, array);
+        this->set_oid_array(
+            cur_fid, cur_label,
+            *std::dynamic_pointer_cast<vineyard::NumericArray<oid_t>>(
+                array_builder.Seal(client)));
+      }
+    });
 
 #if defined(WITH_PROFILING)
     auto finish_seal_ts = GetCurrentTime();
@@ -830,8 +1247,51 @@ class BasicArrowVertexMapBuilder : public ArrowVertexMapBuilder<OID_T, VID_T> {
   }
 
  private:
+  /**
+   * @brief The number of oids that are inserted by a thread at a time.
+   */
+  static constexpr int64_t kChunkSize = 1 << 16;
+
+  /**
+   * @brief The oid array of the task `task_id`, tasks are ordered by labels
+   * first, and fragments second.
+   */
+  const std::shared_ptr<oid_array_t>& taskArray(int task_id) const {
+    return oid_arrays_[static_cast<fid_t>(task_id) / fnum_]
+                      [static_cast<fid_t>(task_id) % fnum_];
+  }
+
+  vid_t taskGid(int task_id) const {
+    return id_parser_.GenerateId(
+        static_cast<fid_t>(task_id) % fnum_,
+        static_cast<label_id_t>(static_cast<fid_t>(task_id) / fnum_), 0);
+  }
+
+  /**
+   * @brief Run `task(0)`, ..., `task(task_num - 1)` on `thread_num` threads.
+   */
+  template <typename FUNC_T>
+  static void parallelFor(int thread_num, int task_num, const FUNC_T& task) {
+    thread_num = std::max(1, std::min(thread_num, task_num));
+    std::atomic<int> task_id(0);
+    std::vector<std::thread> threads(thread_num);
+    for (int i = 0; i < thread_num; ++i) {
+      threads[i] = std::thread([&]() {
+        int got_task_id;
+        while ((got_task_id = task_id.fetch_add(1)) < task_num) {
+          task(got_task_id);
+        }
+      });
+    }
+    for (auto& thrd : threads) {
+      thrd.join();
+    }
+  }
+
   fid_t fnum_;
   label_id_t label_num_;
+  bool use_perfect_hash_;
+  bool use_sorted_oids_;
 
   vineyard::IdParser<vid_t> id_parser_;
 
@@ -0,0 +1,301 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "io/flight/flight_server.h"
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "basic/ds/arrow.h"
+#include "basic/ds/arrow_utils.h"
+#include "basic/ds/dataframe.h"
+#include "common/util/logging.h"
+#include "common/util/typename.h"
+
+namespace vineyard {
+
+namespace flight = arrow::flight;
+
+namespace detail {
+
+/**
+ * @brief Read the record batches of a vineyard object, which is kept alive
+ * until the batches have been sent.
+ */
+class ObjectBatchReader : public arrow::RecordBatchReader {
+ public:
+  ObjectBatchReader(std::shared_ptr<arrow::Schema> schema,
+                    std::vector<std::shared_ptr<arrow::RecordBatch>> batches)
+      : schema_(std::move(schema)), batches_(std::move(batches)) {}
+
+  std::shared_ptr<arrow::Schema> schema() const override { return schema_; }
+
+  arrow::Status ReadNext(std::shared_ptr<arrow::RecordBatch>* batch) override {
+    if (index_ < batches_.size()) {
+      *batch = batches_[index_++];
+    } else {
+      batch->reset();
+    }
+    return arrow::Status::OK();
+  }
+
+ private:
+  std::shared_ptr<arrow::Schema> schema_;
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches_;
+  size_t index_ = 0;
+};
+
+inline arrow::Status ToArrowStatus(Status const& status) {
+  if (status.ok()) {
+    return arrow::Status::OK();
+  }
+  if (status.IsObjectNotExists()) {
+    return arrow::Status::KeyError(status.ToString());
+  }
+  if (status.IsInvalid() || status.IsNotImplemented()) {
+    return arrow::Status::Invalid(status.ToString());
+  }
+  return arrow::Status::IOError(status.ToString());
+}
+
+inline bool IsTabular(std::string const& type_name) {
+  return type_name == type_name<RecordBatch>() ||
+         type_name == type_name<Table>() ||
+         type_name == type_name<DataFrame>() ||
+         type_name == type_name<GlobalDataFrame>();
+}
+
+}  // namespace detail
+
+Status FlightServer::Start(std::string const& host) {
+  flight::Location location;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 8000000
+  RETURN_ON_ARROW_ERROR(flight::Location::ForGrpcTcp(host, port_, &location));
+#else
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(location,
+                                   flight::Location::ForGrpcTcp(host, port_));
+#endif
+  flight::FlightServerOptions options(location);
+  RETURN_ON_ARROW_ERROR(this->Init(options));
+  LOG(INFO) << "Serving the vineyard objects of instance "
+            << client_.instance_id() << " at " << location.ToString();
+  return Status::OK();
+}
+
+arrow::Status FlightServer::ListFlights(
+    const flight::ServerCallContext& context, const flight::Criteria* criteria,
+    std::unique_ptr<flight::FlightListing>* listings) {
+  // the criteria, if any, is a glob pattern of the typenames
+  std::string pattern = "vineyard::*";
+  if (criteria != nullptr && !criteria->expression.empty()) {
+    pattern = criteria->expression;
+  }
+  std::unordered_map<ObjectID, json> metas;
+  ARROW_RETURN_NOT_OK(detail::ToArrowStatus(
+      client_.ListData(pattern, false, std::numeric_limits<size_t>::max(),
+                       metas)));
+  std::vector<flight::FlightInfo> flights;
+  for (auto const& item : metas) {
+    ObjectMeta meta;
+    meta.SetMetaData(&client_, item.second);
+    if (!detail::IsTabular(meta.GetTypeName())) {
+      continue;
+    }
+    std::unique_ptr<flight::FlightInfo> info;
+    auto status = makeFlightInfo(
+        meta, flight::FlightDescriptor::Path({ObjectIDToString(item.first)}),
+        info);
+    if (!status.ok()) {
+      VLOG(10) << "Failed to describe object " << ObjectIDToString(item.first)
+               << ": " << status.ToString();
+      continue;
+    }
+    flights.emplace_back(std::move(*info));
+  }
+  listings->reset(new flight::SimpleFlightListing(std::move(flights)));
+  return arrow::Status::OK();
+}
+
+arrow::Status FlightServer::GetFlightInfo(
+    const flight::ServerCallContext& context,
+    const flight::FlightDescriptor& request,
+    std::unique_ptr<flight::FlightInfo>* info) {
+  ObjectID id = InvalidObjectID();
+  ARROW_RETURN_NOT_OK(detail::ToArrowStatus(resolve(request, id)));
+  ObjectMeta meta;
+  ARROW_RETURN_NOT_OK(
+      detail::ToArrowStatus(client_.GetMetaData(id, meta, true)));
+  if (!detail::IsTabular(meta.GetTypeName())) {
+    return arrow::Status::NotImplemented("Object of type '",
+                                         meta.GetTypeName(),
+                                         "' cannot be served by flight");
+  }
+  return detail::ToArrowStatus(makeFlightInfo(meta, request, *info));
+}
+
+arrow::Status FlightServer::DoGet(
+    const flight::ServerCallContext& context, const flight::Ticket& request,
+    std::unique_ptr<flight::FlightDataStream>* stream) {
+  std::shared_ptr<arrow::Schema> schema;
+  std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+  ARROW_RETURN_NOT_OK(detail::ToArrowStatus(
+      getBatches(ObjectIDFromString(request.ticket), schema, batches)));
+  auto reader =
+      std::make_shared<detail::ObjectBatchReader>(schema, std::move(batches));
+  stream->reset(new flight::RecordBatchStream(reader));
+  return arrow::Status::OK();
+}
+
+Status FlightServer::resolve(const flight::FlightDescriptor& descriptor,
+                             ObjectID& id) {
+  std::string target;
+  if (descriptor.type == flight::FlightDescriptor::CMD) {
+    target = descriptor.cmd;
+  } else if (descriptor.path.size() == 1) {
+    target = descriptor.path[0];
+  } else {
+    return Status::Invalid(
+        "The descriptor is expected to be a single object id or name");
+  }
+  ObjectID candidate = ObjectIDFromString(target);
+  if (!target.empty() && target[0] == 'o' &&
+      ObjectIDToString(candidate) == target) {
+    id = candidate;
+    return Status::OK();
+  }
+  return client_.GetName(target, id, false);
+}
+
+Status FlightServer::makeFlightInfo(
+    ObjectMeta const& meta, const flight::FlightDescriptor& descriptor,
+    std::unique_ptr<flight::FlightInfo>& info) {
+  std::vector<std::pair<ObjectID, InstanceID>> chunks;
+  if (meta.GetTypeName() == type_name<GlobalDataFrame>()) {
+    size_t chunk_num = meta.GetKeyValue<size_t>("partitions_-size");
+    for (size_t idx = 0; idx < chunk_num; ++idx) {
+      auto chunk = meta.GetMemberMeta("partitions_-" + std::to_string(idx));
+      chunks.emplace_back(chunk.GetId(), chunk.GetInstanceId());
+    }
+  } else {
+    chunks.emplace_back(meta.GetId(), meta.GetInstanceId());
+  }
+
+  // the schema and the number of rows are known from the local chunks only,
+  // the other chunks are counted as unknown
+  std::shared_ptr<arrow::Schema> schema;
+  int64_t total_records = 0;
+  std::vector<flight::FlightEndpoint> endpoints;
+  for (auto const& chunk : chunks) {
+    flight::FlightEndpoint endpoint;
+    endpoint.ticket.ticket = ObjectIDToString(chunk.first);
+    flight::Location location;
+    RETURN_ON_ERROR(locate(chunk.second, location));
+    endpoint.locations.emplace_back(location);
+    endpoints.emplace_back(std::move(endpoint));
+
+    if (chunk.second != client_.instance_id()) {
+      total_records = -1;
+      continue;
+    }
+    std::shared_ptr<arrow::Schema> chunk_schema;
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    RETURN_ON_ERROR(getBatches(chunk.first, chunk_schema, batches));
+    if (schema == nullptr) {
+      schema = chunk_schema;
+    }
+    for (auto const& batch : batches) {
+      if (total_records != -1) {
+        total_records += batch->num_rows();
+      }
+    }
+  }
+  if (schema == nullptr) {
+    // every chunk is remote, the schema comes with the stream of the chunks
+    schema = arrow::schema({});
+  }
+
+  int64_t total_bytes = static_cast<int64_t>(meta.GetNBytes());
+#if defined(ARROW_VERSION) && ARROW_VERSION < 8000000
+  flight::FlightInfo::Data data;
+  RETURN_ON_ARROW_ERROR(flight::FlightInfo::Make(
+      *schema, descriptor, endpoints, total_records, total_bytes, &data));
+  info.reset(new flight::FlightInfo(std::move(data)));
+#else
+  auto result = flight::FlightInfo::Make(*schema, descriptor, endpoints,
+                                         total_records, total_bytes);
+  if (!result.ok()) {
+    return Status::ArrowError(result.status());
+  }
+  info.reset(new flight::FlightInfo(std::move(result).ValueOrDie()));
+#endif
+  return Status::OK();
+}
+
+Status FlightServer::getBatches(
+    ObjectID const id, std::shared_ptr<arrow::Schema>& schema,
+    std::vector<std::shared_ptr<arrow::RecordBatch>>& batches) {
+  std::shared_ptr<Object> object;
+  RETURN_ON_ERROR(client_.GetObject(id, object));
+  if (auto batch = std::dynamic_pointer_cast<RecordBatch>(object)) {
+    schema = batch->schema();
+    batches.emplace_back(batch->GetRecordBatch());
+  } else if (auto table = std::dynamic_pointer_cast<Table>(object)) {
+    schema = table->schema();
+    for (auto const& chunk : table->batches()) {
+      batches.emplace_back(chunk->GetRecordBatch());
+    }
+  } else if (auto dataframe = std::dynamic_pointer_cast<DataFrame>(object)) {
+    auto batch = dataframe->AsBatch(false);
+    schema = batch->schema();
+    batches.emplace_back(batch);
+  } else {
+    return Status::Invalid("Object " + ObjectIDToString(id) + " of type '" +
+                           object->meta().GetTypeName() +
+                           "' is not a local tabular object");
+  }
+  return Status::OK();
+}
+
+Status FlightServer::locate(InstanceID const instance_id,
+                            flight::Location& location) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto iter = locations_.find(instance_id);
+  if (iter != locations_.end()) {
+    location = iter->second;
+    return Status::OK();
+  }
+  std::map<InstanceID, json> cluster;
+  RETURN_ON_ERROR(client_.ClusterInfo(cluster));
+  auto instance = cluster.find(instance_id);
+  if (instance == cluster.end()) {
+    return Status::Invalid("Instance " + std::to_string(instance_id) +
+                           " is not in the cluster");
+  }
+  std::string host = instance->second.value("hostname", "");
+#if defined(ARROW_VERSION) && ARROW_VERSION < 8000000
+  RETURN_ON_ARROW_ERROR(flight::Location::ForGrpcTcp(host, port_, &location));
+#else
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(location,
+                                   flight::Location::ForGrpcTcp(host, port_));
+#endif
+  locations_.emplace(instance_id, location);
+  return Status::OK();
+}
+
+}  // namespace vineyard
@@ -0,0 +1,106 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_IO_FLIGHT_FLIGHT_SERVER_H_
+#define MODULES_IO_FLIGHT_FLIGHT_SERVER_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "arrow/api.h"
+#include "arrow/flight/api.h"
+
+#include "client/client.h"
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief FlightServer serves the tabular objects of the connected vineyard
+ * instance, i.e., `vineyard::RecordBatch`, `vineyard::Table`,
+ * `vineyard::DataFrame` and `vineyard::GlobalDataFrame`, to the Arrow Flight
+ * clients, e.g., Spark or Java services, without re-encoding the data.
+ *
+ * The record batches are streamed right from the buffers of the blobs in the
+ * shared memory, which Flight sends as the bodies of the messages without
+ * copying them. The flight of a global dataframe has an endpoint for each of
+ * its chunks, at the flight server of the instance that owns the chunk,
+ * which all instances are expected to run at the same `port`, thus the
+ * chunks can be read in parallel from their owners.
+ *
+ * The descriptors are either a path (or a command) of a single element, the
+ * object id or the name of the object, and the tickets are the object ids.
+ */
+class FlightServer : public arrow::flight::FlightServerBase {
+ public:
+  explicit FlightServer(Client& client, int const port)
+      : client_(client), port_(port) {}
+
+  /**
+   * @brief Listen on `host`, the instances are located by their hostnames
+   * in the cluster info.
+   */
+  Status Start(std::string const& host);
+
+  arrow::Status ListFlights(
+      const arrow::flight::ServerCallContext& context,
+      const arrow::flight::Criteria* criteria,
+      std::unique_ptr<arrow::flight::FlightListing>* listings) override;
+
+  arrow::Status GetFlightInfo(
+      const arrow::flight::ServerCallContext& context,
+      const arrow::flight::FlightDescriptor& request,
+      std::unique_ptr<arrow::flight::FlightInfo>* info) override;
+
+  arrow::Status DoGet(
+      const arrow::flight::ServerCallContext& context,
+      const arrow::flight::Ticket& request,
+      std::unique_ptr<arrow::flight::FlightDataStream>* stream) override;
+
+ private:
+  /**
+   * @brief Resolve the object id (or name) in the descriptor.
+   */
+  Status resolve(const arrow::flight::FlightDescriptor& descriptor,
+                 ObjectID& id);
+
+  Status makeFlightInfo(ObjectMeta const& meta,
+                        const arrow::flight::FlightDescriptor& descriptor,
+                        std::unique_ptr<arrow::flight::FlightInfo>& info);
+
+  /**
+   * @brief The record batches of a local tabular object, which keep the
+   * object (and thus its blobs) alive.
+   */
+  Status getBatches(ObjectID const id, std::shared_ptr<arrow::Schema>& schema,
+                    std::vector<std::shared_ptr<arrow::RecordBatch>>& batches);
+
+  Status locate(InstanceID const instance_id,
+                arrow::flight::Location& location);
+
+  Client& client_;
+  int const port_;
+
+  // the flight locations of the instances, resolved on demand
+  std::mutex mutex_;
+  std::map<InstanceID, arrow::flight::Location> locations_;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_IO_FLIGHT_FLIGHT_SERVER_H_
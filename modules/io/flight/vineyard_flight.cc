@@ -0,0 +1,66 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <csignal>
+#include <string>
+
+#include "gflags/gflags.h"
+
+#include "basic/ds/arrow_utils.h"
+#include "client/client.h"
+#include "common/util/flags.h"
+#include "common/util/logging.h"
+#include "common/util/status.h"
+#include "io/flight/flight_server.h"
+
+namespace vineyard {
+
+DEFINE_string(ipc_socket, "/tmp/vineyard/vineyard.sock",
+              "IPC socket of vineyard server");
+DEFINE_string(host, "0.0.0.0", "Host to listen for the flight clients");
+DEFINE_int32(port, 9610,
+             "Port to listen for the flight clients, the sidecars of all "
+             "vineyard instances are expected to use the same port");
+
+Status RunServer() {
+  Client client;
+  RETURN_ON_ERROR(client.Connect(FLAGS_ipc_socket));
+  FlightServer server(client, FLAGS_port);
+  RETURN_ON_ERROR(server.Start(FLAGS_host));
+  RETURN_ON_ARROW_ERROR(server.SetShutdownOnSignals({SIGTERM, SIGINT}));
+  RETURN_ON_ARROW_ERROR(server.Serve());
+  return Status::OK();
+}
+
+}  // namespace vineyard
+
+int main(int argc, char** argv) {
+  FLAGS_stderrthreshold = 0;
+  vineyard::logging::InitGoogleLogging("vineyard");
+  vineyard::flags::SetUsageMessage("Usage: vineyard-flight [options]");
+  vineyard::flags::ParseCommandLineNonHelpFlags(&argc, &argv, false);
+  if (FLAGS_help) {
+    FLAGS_help = false;
+    FLAGS_helpmatch = "vineyard";
+  }
+  vineyard::flags::HandleCommandLineHelpFlags();
+
+  auto status = vineyard::RunServer();
+  if (!status.ok()) {
+    LOG(ERROR) << "Flight server failed: " << status.ToString();
+    return static_cast<int>(status.code());
+  }
+  return 0;
+}
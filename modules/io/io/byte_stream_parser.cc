@@ -0,0 +1,201 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "io/io/byte_stream_parser.h"
+
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "arrow/io/memory.h"
+#include "arrow/util/config.h"
+#include "boost/algorithm/string.hpp"
+
+#include "basic/ds/arrow_utils.h"
+#include "basic/stream/byte_stream.h"
+#include "basic/stream/recordbatch_stream.h"
+
+namespace vineyard {
+
+ByteStreamParser::ByteStreamParser(
+    std::unordered_map<std::string, std::string> const& params)
+    : params_(params),
+      read_options_(arrow::csv::ReadOptions::Defaults()),
+      parse_options_(arrow::csv::ParseOptions::Defaults()),
+      convert_options_(arrow::csv::ConvertOptions::Defaults()) {}
+
+Status ByteStreamParser::Init() {
+  auto param = [this](std::string const& key) -> std::string {
+    auto iter = params_.find(key);
+    return iter == params_.end() ? "" : iter->second;
+  };
+
+  bool header_row = param("header_row") == "1";
+  std::string delimiter = param("delimiter");
+  if (delimiter.empty()) {
+    delimiter = ",";
+  }
+  bool include_all_columns = param("include_all_columns") == "1";
+
+  std::vector<std::string> original_columns, columns, column_types;
+  if (header_row) {
+    std::string header_line = param("header_line");
+    boost::algorithm::trim(header_line);
+    if (header_line.empty()) {
+      return Status::Invalid(
+          "Header line not found while header_row is set to True");
+    }
+    boost::split(original_columns, header_line,
+                 boost::is_any_of(delimiter.substr(0, 1)));
+  }
+  if (!param("schema").empty()) {
+    boost::split(columns, param("schema"), boost::is_any_of(","));
+  }
+  if (!param("column_types").empty()) {
+    boost::split(column_types, param("column_types"), boost::is_any_of(","));
+  }
+
+  if (!original_columns.empty()) {
+    read_options_.column_names = original_columns;
+  } else {
+    read_options_.autogenerate_column_names = true;
+  }
+  parse_options_.delimiter = delimiter[0];
+
+  auto is_number = [](const std::string& s) -> bool {
+    return !s.empty() && std::all_of(s.begin(), s.end(), [](unsigned char c) {
+      return std::isdigit(c);
+    });
+  };
+  for (size_t i = 0; i < columns.size(); ++i) {
+    if (!original_columns.empty()) {
+      if (is_number(columns[i])) {
+        size_t column_index = std::stoul(columns[i]);
+        if (column_index >= original_columns.size()) {
+          return Status::Invalid("Column index out of range: " + columns[i]);
+        }
+        columns[i] = original_columns[column_index];
+      }
+    } else {
+      // the names that arrow generates for the columns
+      columns[i] = "f" + std::to_string(i);
+    }
+  }
+  if (include_all_columns) {
+    for (auto const& column : original_columns) {
+      if (std::find(columns.begin(), columns.end(), column) == columns.end()) {
+        columns.push_back(column);
+      }
+    }
+  }
+  if (!columns.empty()) {
+    convert_options_.include_columns = columns;
+  }
+  if (column_types.size() > columns.size()) {
+    return Status::Invalid(
+        "Format of column type schema is incorrect: too many columns");
+  }
+  for (size_t i = 0; i < column_types.size(); ++i) {
+    if (!column_types[i].empty()) {
+      convert_options_.column_types[columns[i]] =
+          type_name_to_arrow_type(column_types[i]);
+    }
+  }
+  return Status::OK();
+}
+
+Status ByteStreamParser::Parse(std::shared_ptr<arrow::Buffer> const& chunk,
+                               std::shared_ptr<arrow::Table>& table) {
+  auto input = std::make_shared<arrow::io::BufferReader>(chunk);
+  arrow::MemoryPool* pool = arrow::default_memory_pool();
+
+  std::shared_ptr<arrow::csv::TableReader> reader;
+#if defined(ARROW_VERSION) && ARROW_VERSION >= 4000000
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      reader, arrow::csv::TableReader::Make(arrow::io::IOContext(pool), input,
+                                            read_options_, parse_options_,
+                                            convert_options_));
+#else
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      reader, arrow::csv::TableReader::Make(pool, input, read_options_,
+                                            parse_options_, convert_options_));
+#endif
+  auto result = reader->Read();
+  if (!result.status().ok()) {
+    if (result.status().message() == "Empty CSV file") {
+      table = nullptr;
+      return Status::OK();
+    }
+    return Status::ArrowError(result.status());
+  }
+  table = result.ValueOrDie();
+  return Status::OK();
+}
+
+Status ParseByteStream(Client& client, ObjectID const byte_stream_id,
+                       std::function<void(ObjectID)> const& on_created) {
+  std::shared_ptr<ByteStream> byte_stream;
+  RETURN_ON_ERROR(client.GetObject(byte_stream_id, byte_stream));
+  auto params = byte_stream->GetParams();
+  ByteStreamParser parser(params);
+  RETURN_ON_ERROR(parser.Init());
+
+  std::unique_ptr<ByteStreamReader> reader;
+  RETURN_ON_ERROR(byte_stream->OpenReader(client, reader));
+
+  RecordBatchStreamBuilder builder(client);
+  builder.SetParams(params);
+  auto stream =
+      std::dynamic_pointer_cast<RecordBatchStream>(builder.Seal(client));
+  RETURN_ON_ERROR(client.Persist(stream->id()));
+  std::unique_ptr<RecordBatchStreamWriter> writer;
+  RETURN_ON_ERROR(stream->OpenWriter(client, writer));
+  on_created(stream->id());
+
+  auto status = [&]() -> Status {
+    while (true) {
+      std::unique_ptr<arrow::Buffer> chunk;
+      auto status = reader->GetNext(chunk);
+      if (status.IsStreamDrained()) {
+        return Status::OK();
+      }
+      RETURN_ON_ERROR(status);
+      std::shared_ptr<arrow::Table> table;
+      RETURN_ON_ERROR(parser.Parse(std::move(chunk), table));
+      if (table != nullptr) {
+        RETURN_ON_ERROR(writer->WriteTable(table));
+      }
+    }
+  }();
+  if (!status.ok()) {
+    VINEYARD_DISCARD(writer->Abort());
+    return status;
+  }
+  return writer->Finish();
+}
+
+Status ParseByteStream(Client& client, ObjectID const byte_stream_id,
+                       ObjectID& record_batch_stream_id) {
+  return ParseByteStream(
+      client, byte_stream_id,
+      [&record_batch_stream_id](ObjectID const stream_id) {
+        record_batch_stream_id = stream_id;
+      });
+}
+
+}  // namespace vineyard
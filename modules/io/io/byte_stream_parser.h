@@ -0,0 +1,83 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_IO_IO_BYTE_STREAM_PARSER_H_
+#define MODULES_IO_IO_BYTE_STREAM_PARSER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "arrow/buffer.h"
+#include "arrow/csv/api.h"
+#include "arrow/table.h"
+
+#include "client/client.h"
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief ByteStreamParser parses the chunks of a byte stream, the bytes of
+ * delimited values, into arrow tables.
+ *
+ * The options are taken from the params of the byte stream, i.e., the same
+ * `header_row`, `header_line`, `delimiter`, `schema`, `column_types` and
+ * `include_all_columns` that the io adaptors record, and every chunk is
+ * expected to consist of whole lines.
+ */
+class ByteStreamParser {
+ public:
+  explicit ByteStreamParser(
+      std::unordered_map<std::string, std::string> const& params);
+
+  /**
+   * @brief Validate the params, must be called before `Parse`.
+   */
+  Status Init();
+
+  /**
+   * @brief Parse a chunk, the chunk is read in place, columns of strings in
+   * the result may reference the chunk.
+   */
+  Status Parse(std::shared_ptr<arrow::Buffer> const& chunk,
+               std::shared_ptr<arrow::Table>& table);
+
+ private:
+  std::unordered_map<std::string, std::string> params_;
+
+  arrow::csv::ReadOptions read_options_;
+  arrow::csv::ParseOptions parse_options_;
+  arrow::csv::ConvertOptions convert_options_;
+};
+
+/**
+ * @brief Parse the byte stream into a newly created record batch stream, which
+ * carries the params of the byte stream as well.
+ *
+ * The record batch stream is created before parsing, and its id is passed to
+ * `on_created`, thus the consumers can start reading while the byte stream
+ * is being parsed. The record batch stream is aborted when parsing fails.
+ */
+Status ParseByteStream(Client& client, ObjectID const byte_stream_id,
+                       std::function<void(ObjectID)> const& on_created);
+
+Status ParseByteStream(Client& client, ObjectID const byte_stream_id,
+                       ObjectID& record_batch_stream_id);
+
+}  // namespace vineyard
+
+#endif  // MODULES_IO_IO_BYTE_STREAM_PARSER_H_
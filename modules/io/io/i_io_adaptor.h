@@ -19,8 +19,10 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "arrow/buffer.h"
 #include "arrow/table.h"
 
 #include "common/util/status.h"
@@ -70,6 +72,39 @@ class IIOAdaptor {
   virtual Status ReadLine(std::string& line) = 0;
   virtual Status WriteLine(const std::string& line) = 0;
 
+  /**
+   * @brief Read a batch of whole lines, of about `batch_size` bytes, into one
+   * contiguous buffer, the i-th line spans `[line_offsets[i],
+   * line_offsets[i + 1])` of the buffer and includes its line break, if any.
+   *
+   * A batch always contains at least one line, thus may exceed `batch_size`
+   * when a single line is longer than that. Returns EndOfFile when there are
+   * no more lines.
+   *
+   * The default implementation collects the lines of `ReadLine`, adaptors
+   * override it to avoid the per-line copies.
+   */
+  virtual Status ReadBatch(size_t batch_size,
+                           std::shared_ptr<arrow::Buffer>& buffer,
+                           std::vector<int64_t>& line_offsets) {
+    std::string lines, line;
+    line_offsets.assign(1, 0);
+    while (lines.size() < batch_size || line_offsets.size() == 1) {
+      auto status = ReadLine(line);
+      if (status.IsEndOfFile()) {
+        break;
+      }
+      RETURN_ON_ERROR(status);
+      lines.append(line).push_back('\n');
+      line_offsets.push_back(lines.size());
+    }
+    if (line_offsets.size() == 1) {
+      return Status::EndOfFile();
+    }
+    buffer = arrow::Buffer::FromString(std::move(lines));
+    return Status::OK();
+  }
+
   virtual Status Read(void* buffer, size_t size) = 0;
   virtual Status Write(void* buffer, size_t size) = 0;
 
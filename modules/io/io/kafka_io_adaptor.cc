@@ -17,26 +17,46 @@ limitations under the License.
 
 #include "io/io/kafka_io_adaptor.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <iosfwd>
+#include <iterator>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <utility>
 #include <vector>
 
+#include "arrow/array.h"
+#include "arrow/buffer.h"
+#include "arrow/buffer_builder.h"
+#include "arrow/memory_pool.h"
+#include "arrow/table.h"
+#include "arrow/util/config.h"
 #include "librdkafka/rdkafka.h"
 #include "librdkafka/rdkafkacpp.h"
 
+#include "basic/ds/arrow_utils.h"
 #include "common/util/logging.h"
 
 namespace vineyard {
 
+void KafkaIOAdaptor::DeliveryReport::dr_cb(RdKafka::Message& message) {
+  if (message.err() != RdKafka::ERR_NO_ERROR) {
+    LOG(ERROR) << "Failed to deliver message to kafka: " << message.errstr();
+    ++failures;
+  }
+}
+
 KafkaIOAdaptor::KafkaIOAdaptor(const std::string& location) {
   LOG(INFO) << "Parse location here";
   parseLocation(location);
 }
 
-KafkaIOAdaptor::~KafkaIOAdaptor() {}
+KafkaIOAdaptor::~KafkaIOAdaptor() { VINEYARD_DISCARD(Close()); }
 
 std::unique_ptr<IIOAdaptor> KafkaIOAdaptor::Make(const std::string& location,
                                                  Client* client) {
@@ -46,6 +66,12 @@ std::unique_ptr<IIOAdaptor> KafkaIOAdaptor::Make(const std::string& location,
 }
 
 Status KafkaIOAdaptor::Open() {
+  createConsumers();
+  startFetch();
+  return Status::OK();
+}
+
+void KafkaIOAdaptor::createConsumers() {
   if (partial_read_) {
     local_partition_num_ = partition_num_ / total_parts_;
     if (partition_num_ % total_parts_ > partial_index_) {
@@ -96,14 +122,10 @@ Status KafkaIOAdaptor::Open() {
     consumer_ptrs_[i]->subscribe({topic_});
 
     message_queue_[i] =
-        std::make_shared<PCBlockingQueue<std::vector<std::string>>>();
-    message_queue_[i]->SetLimit(16);
+        std::make_shared<MPMCQueue<std::vector<std::string>>>(16);
     message_queue_[i]->SetProducerNum(1);
   }
   delete conf;  // release the memory resource
-  startFetch();
-
-  return Status::OK();
 }
 
 // if mode has 'w', then create kafka producer.
@@ -125,13 +147,34 @@ Status KafkaIOAdaptor::Open(const char* mode) {
       LOG(WARNING) << "Failed to set queue.buffering.max.messages: "
                    << rdkafka_err;
     }
+    // messages are batched by librdkafka rather than flushed one by one
+    if (conf->set("linger.ms", std::to_string(linger_ms_), rdkafka_err) !=
+        RdKafka::Conf::CONF_OK) {
+      LOG(WARNING) << "Failed to set linger.ms: " << rdkafka_err;
+    }
+    if (conf->set("batch.num.messages", std::to_string(batch_num_messages_),
+                  rdkafka_err) != RdKafka::Conf::CONF_OK) {
+      LOG(WARNING) << "Failed to set batch.num.messages: " << rdkafka_err;
+    }
+    if (conf->set("dr_cb", &delivery_report_, rdkafka_err) !=
+        RdKafka::Conf::CONF_OK) {
+      LOG(WARNING) << "Failed to set dr_cb: " << rdkafka_err;
+    }
 
     producer_ = std::unique_ptr<RdKafka::Producer>(
         RdKafka::Producer::create(conf, rdkafka_err));
+    delete conf;  // release the memory resource
     if (!producer_) {
-      LOG(ERROR) << "Failed to create kafka producer: " << rdkafka_err;
+      return Status::IOError("Failed to create kafka producer: " +
+                             rdkafka_err);
     }
-    delete conf;  // release the memory resource
+    // serves the delivery reports in the background
+    polling_ = true;
+    poller_ = std::thread([this]() {
+      while (polling_) {
+        producer_->poll(100);
+      }
+    });
     return Status::OK();
   } else {
     consumer_ = true;
@@ -148,6 +191,12 @@ Status KafkaIOAdaptor::Configure(const std::string& key,
     batch_size_per_partition_ = batch_size_ / local_partition_num_;
   } else if (key == "time_interval") {
     time_interval_ms_ = std::stoi(value) * 1000;
+  } else if (key == "linger_ms") {
+    linger_ms_ = std::stoi(value);
+  } else if (key == "batch_num_messages") {
+    batch_num_messages_ = std::stoi(value);
+  } else if (key == "delimiter" && !value.empty()) {
+    delimiter_ = value[0];
   }
   return Status::OK();
 }
@@ -159,68 +208,264 @@ Status KafkaIOAdaptor::SetPartialRead(const int index, const int total_parts) {
   return Status::OK();
 }
 
-Status KafkaIOAdaptor::ReadLine(std::string& line) {
+bool KafkaIOAdaptor::nextMessages() {
   if (message_offset_ < message_list_.size()) {
-    line = message_list_[message_offset_];
-    ++message_offset_;
-    return Status::OK();
-  } else {
-    message_list_.clear();
-    message_offset_ = 0;
-    bool end = false;
-    while (!end) {
-      end = true;
-      for (int i = 0; i < local_partition_num_; ++i) {
-        end = end & message_queue_[i]->End();
-        if (message_queue_[i]->Size()) {
-          message_queue_[i]->Get(message_list_);
-          break;
+    return true;
+  }
+  message_list_.clear();
+  message_offset_ = 0;
+  while (true) {
+    // taken before scanning, thus a put after the scan is never missed
+    uint64_t fetched;
+    {
+      std::lock_guard<std::mutex> lock(fetch_mutex_);
+      fetched = fetch_seq_;
+    }
+    bool end = true;
+    for (int i = 0; i < local_partition_num_; ++i) {
+      end = end & message_queue_[i]->End();
+      if (message_queue_[i]->Size()) {
+        message_queue_[i]->Get(message_list_);
+        if (message_list_.size()) {
+          return true;
         }
       }
-      if (message_list_.size()) {
-        line = message_list_[message_offset_];
-        ++message_offset_;
-        return Status::OK();
-      }
     }
+    if (end) {
+      return false;
+    }
+    std::unique_lock<std::mutex> lock(fetch_mutex_);
+    fetch_cv_.wait(lock, [&]() { return fetch_seq_ != fetched; });
+  }
+}
+
+void KafkaIOAdaptor::notifyFetched() {
+  {
+    std::lock_guard<std::mutex> lock(fetch_mutex_);
+    ++fetch_seq_;
+  }
+  fetch_cv_.notify_all();
+}
+
+Status KafkaIOAdaptor::ReadMessages(std::vector<std::string>& messages) {
+  if (!nextMessages()) {
     return Status::EndOfFile();
   }
+  messages.assign(
+      std::make_move_iterator(message_list_.begin() + message_offset_),
+      std::make_move_iterator(message_list_.end()));
+  message_list_.clear();
+  message_offset_ = 0;
+  // the only consumer, thus non-empty queues never block
+  std::vector<std::vector<std::string>> fetched;
+  for (int i = 0; i < local_partition_num_; ++i) {
+    size_t pending = message_queue_[i]->Size();
+    if (pending > 0) {
+      message_queue_[i]->PopBatch(fetched, pending);
+    }
+  }
+  for (auto& batch : fetched) {
+    messages.insert(messages.end(), std::make_move_iterator(batch.begin()),
+                    std::make_move_iterator(batch.end()));
+  }
+  return Status::OK();
+}
+
+Status KafkaIOAdaptor::ReadLine(std::string& line) {
+  if (!nextMessages()) {
+    return Status::EndOfFile();
+  }
+  line = message_list_[message_offset_];
+  ++message_offset_;
+  return Status::OK();
+}
+
+Status KafkaIOAdaptor::ReadBatch(size_t batch_size,
+                                 std::shared_ptr<arrow::Buffer>& buffer,
+                                 std::vector<int64_t>& line_offsets) {
+  if (!nextMessages()) {
+    return Status::EndOfFile();
+  }
+  size_t end = message_offset_, nbytes = 0;
+  do {
+    nbytes += message_list_[end++].size() + 1;
+  } while (end < message_list_.size() && nbytes < batch_size);
+
+  std::shared_ptr<arrow::Buffer> lines;
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  RETURN_ON_ARROW_ERROR(
+      arrow::AllocateBuffer(arrow::default_memory_pool(), nbytes, &lines));
+#else
+  RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+      lines, arrow::AllocateBuffer(nbytes, arrow::default_memory_pool()));
+#endif
+  uint8_t* data = lines->mutable_data();
+  line_offsets.clear();
+  line_offsets.push_back(0);
+  for (; message_offset_ < end; ++message_offset_) {
+    auto const& message = message_list_[message_offset_];
+    memcpy(data, message.data(), message.size());
+    data[message.size()] = '\n';
+    data += message.size() + 1;
+    line_offsets.push_back(line_offsets.back() + message.size() + 1);
+  }
+  buffer = lines;
+  return Status::OK();
 }
 
 Status KafkaIOAdaptor::WriteLine(const std::string& line) {
   if (line.empty()) {
     return Status::OK();
   }
-  RdKafka::ErrorCode err = producer_->produce(
-      topic_, RdKafka::Topic::PARTITION_UA, RdKafka::Producer::RK_MSG_COPY,
-      static_cast<void*>(const_cast<char*>(line.c_str())) /* value */,
-      line.size() /* size */, NULL, 0, 0 /* timestamp */,
-      NULL /* delivery report */);
-  if (err != RdKafka::ERR_NO_ERROR) {
-    LOG(ERROR) << "Failed to writeline to kafka: " << RdKafka::err2str(err);
-  }
-  producer_->flush(time_interval_ms_);
-  return Status::OK();
+  return produce(line.data(), line.size());
 }
 
 Status KafkaIOAdaptor::Write(void* buffer, size_t size) {
-  {
-    if (size == 0) {
-      return Status::OK();
+  if (size == 0) {
+    return Status::OK();
+  }
+  return produce(buffer, size);
+}
+
+Status KafkaIOAdaptor::WriteTable(std::shared_ptr<arrow::Table> table) {
+  arrow::TableBatchReader reader(*table);
+  std::shared_ptr<arrow::RecordBatch> batch;
+  std::string line;
+  while (true) {
+    RETURN_ON_ARROW_ERROR(reader.ReadNext(&batch));
+    if (batch == nullptr) {
+      break;
+    }
+    for (int64_t row = 0; row < batch->num_rows(); ++row) {
+      line.clear();
+      for (int column = 0; column < batch->num_columns(); ++column) {
+        if (column != 0) {
+          line.push_back(delimiter_);
+        }
+        RETURN_ON_ERROR(appendValue(batch->column(column).get(), row, line));
+      }
+      RETURN_ON_ERROR(produce(line.data(), line.size()));
     }
+  }
+  return Status::OK();
+}
+
+Status KafkaIOAdaptor::Flush() {
+  if (producer_ == nullptr) {
+    return Status::OK();
+  }
+  if (producer_->flush(time_interval_ms_) != RdKafka::ERR_NO_ERROR) {
+    return Status::IOError("Timeout when flushing the messages to kafka");
+  }
+  int64_t failures = delivery_report_.failures.exchange(0);
+  if (failures != 0) {
+    return Status::IOError("Failed to deliver " + std::to_string(failures) +
+                           " messages to kafka");
+  }
+  return Status::OK();
+}
+
+Status KafkaIOAdaptor::Close() {
+  if (producer_ == nullptr) {
+    return Status::OK();
+  }
+  auto status = Flush();
+  polling_ = false;
+  if (poller_.joinable()) {
+    poller_.join();
+  }
+  return status;
+}
+
+Status KafkaIOAdaptor::produce(const void* payload, size_t size) {
+  while (true) {
     RdKafka::ErrorCode err = producer_->produce(
         topic_, RdKafka::Topic::PARTITION_UA, RdKafka::Producer::RK_MSG_COPY,
-        buffer /* value */, size /* size */, NULL, 0, 0 /* timestamp */,
-        NULL /* delivery report */);
-    if (err != RdKafka::ERR_NO_ERROR) {
-      LOG(ERROR) << "Failed to output to kafka: " << RdKafka::err2str(err);
+        const_cast<void*>(payload) /* value */, size /* size */, NULL, 0,
+        0 /* timestamp */, NULL /* delivery report */);
+    if (err == RdKafka::ERR_NO_ERROR) {
+      return Status::OK();
+    }
+    if (err != RdKafka::ERR__QUEUE_FULL) {
+      return Status::IOError("Failed to produce to kafka: " +
+                             RdKafka::err2str(err));
     }
-    producer_->flush(time_interval_ms_);
+    // wait for the in-flight messages to be delivered
+    producer_->poll(100);
   }
-  return Status::OK();
 }
 
-Status KafkaIOAdaptor::Close() { return Status::OK(); }
+Status KafkaIOAdaptor::appendValue(arrow::Array const* array, int64_t index,
+                                   std::string& out) {
+  if (array->IsNull(index)) {
+    return Status::OK();
+  }
+  switch (array->type_id()) {
+  case arrow::Type::BOOL:
+    out += static_cast<arrow::BooleanArray const*>(array)->Value(index)
+               ? "true"
+               : "false";
+    break;
+  case arrow::Type::INT8:
+    out += std::to_string(
+        static_cast<arrow::Int8Array const*>(array)->Value(index));
+    break;
+  case arrow::Type::UINT8:
+    out += std::to_string(
+        static_cast<arrow::UInt8Array const*>(array)->Value(index));
+    break;
+  case arrow::Type::INT16:
+    out += std::to_string(
+        static_cast<arrow::Int16Array const*>(array)->Value(index));
+    break;
+  case arrow::Type::UINT16:
+    out += std::to_string(
+        static_cast<arrow::UInt16Array const*>(array)->Value(index));
+    break;
+  case arrow::Type::INT32:
+    out += std::to_string(
+        static_cast<arrow::Int32Array const*>(array)->Value(index));
+    break;
+  case arrow::Type::UINT32:
+    out += std::to_string(
+        static_cast<arrow::UInt32Array const*>(array)->Value(index));
+    break;
+  case arrow::Type::INT64:
+    out += std::to_string(
+        static_cast<arrow::Int64Array const*>(array)->Value(index));
+    break;
+  case arrow::Type::UINT64:
+    out += std::to_string(
+        static_cast<arrow::UInt64Array const*>(array)->Value(index));
+    break;
+  case arrow::Type::FLOAT:
+  case arrow::Type::DOUBLE: {
+    double value =
+        array->type_id() == arrow::Type::FLOAT
+            ? static_cast<arrow::FloatArray const*>(array)->Value(index)
+            : static_cast<arrow::DoubleArray const*>(array)->Value(index);
+    char buffer[32];
+    int length = snprintf(buffer, sizeof(buffer), "%.17g", value);
+    out.append(buffer, length);
+    break;
+  }
+  case arrow::Type::STRING: {
+    auto view = static_cast<arrow::StringArray const*>(array)->GetView(index);
+    out.append(view.data(), view.size());
+    break;
+  }
+  case arrow::Type::LARGE_STRING: {
+    auto view =
+        static_cast<arrow::LargeStringArray const*>(array)->GetView(index);
+    out.append(view.data(), view.size());
+    break;
+  }
+  default:
+    return Status::NotImplemented("Writing the type " +
+                                  array->type()->ToString() + " to kafka");
+  }
+  return Status::OK();
+}
 
 void KafkaIOAdaptor::parseLocation(const std::string& location) {
   std::string tmp_location(location);
@@ -252,7 +497,9 @@ void KafkaIOAdaptor::startFetch() {
         std::vector<std::string> msg;
         fetchMessage(i, msg);
         message_queue_[i]->Put(std::move(msg));
+        notifyFetched();
       }
+      notifyFetched();
     });
     t.detach();
     LOG(INFO) << "[partition" << partial_index_
@@ -336,6 +583,120 @@ void KafkaIOAdaptor::fetchMessage(int partition_index,
   }
 }
 
+Status KafkaIOAdaptor::ConsumeToStream(
+    Client& client, std::unordered_map<std::string, std::string> const& params,
+    std::function<void(ObjectID)> const& on_created) {
+  ByteStreamParser parser(params);
+  RETURN_ON_ERROR(parser.Init());
+
+  RecordBatchStreamBuilder builder(client);
+  builder.SetParams(params);
+  auto stream =
+      std::dynamic_pointer_cast<RecordBatchStream>(builder.Seal(client));
+  RETURN_ON_ERROR(client.Persist(stream->id()));
+  std::unique_ptr<RecordBatchStreamWriter> writer;
+  RETURN_ON_ERROR(stream->OpenWriter(client, writer));
+  on_created(stream->id());
+
+  consumer_ = true;
+  createConsumers();
+  std::vector<Status> statuses(local_partition_num_);
+  std::vector<std::thread> consumers;
+  for (int i = 0; i < local_partition_num_; ++i) {
+    consumers.emplace_back([&, i]() {
+      statuses[i] = consumePartition(i, parser, *writer);
+    });
+  }
+  Status status;
+  for (int i = 0; i < local_partition_num_; ++i) {
+    consumers[i].join();
+    if (status.ok() && !statuses[i].ok()) {
+      status = statuses[i];
+    }
+  }
+  if (!status.ok()) {
+    VINEYARD_DISCARD(writer->Abort());
+    return status;
+  }
+  return writer->Finish();
+}
+
+Status KafkaIOAdaptor::consumePartition(int partition_index,
+                                        ByteStreamParser& parser,
+                                        RecordBatchStreamWriter& writer) {
+  auto consumer = consumer_ptrs_[partition_index];
+  auto const time_interval = std::chrono::milliseconds(time_interval_ms_);
+  int const batch_size = std::max(batch_size_per_partition_, 1);
+
+  arrow::BufferBuilder lines;
+  int msg_cnt = 0;
+  std::chrono::steady_clock::time_point first_msg_ts;
+
+  auto flush = [&]() -> Status {
+    if (msg_cnt == 0) {
+      return Status::OK();
+    }
+    msg_cnt = 0;
+    std::shared_ptr<arrow::Buffer> chunk;
+    RETURN_ON_ARROW_ERROR(lines.Finish(&chunk));
+    std::shared_ptr<arrow::Table> table;
+    RETURN_ON_ERROR(parser.Parse(chunk, table));
+    if (table != nullptr) {
+      RETURN_ON_ERROR(writer.WriteTable(table));
+    }
+    return Status::OK();
+  };
+
+  while (true) {
+    // waits no longer than the latency bound of the pending messages
+    auto timeout = time_interval;
+    if (msg_cnt != 0) {
+      timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
+          first_msg_ts + time_interval - std::chrono::steady_clock::now());
+      if (timeout.count() <= 0) {
+        RETURN_ON_ERROR(flush());
+        continue;
+      }
+    }
+    std::unique_ptr<RdKafka::Message> message(
+        consumer->consume(static_cast<int>(timeout.count())));
+    switch (message->err()) {
+    case RdKafka::ERR__TIMED_OUT:
+      if (msg_cnt != 0) {
+        RETURN_ON_ERROR(flush());
+        break;
+      }
+      return Status::OK();
+
+    case RdKafka::ERR_NO_ERROR:
+      if (message->len() == 0) {
+        break;
+      }
+      RETURN_ON_ARROW_ERROR(lines.Append(message->payload(), message->len()));
+      RETURN_ON_ARROW_ERROR(lines.Append("\n", 1));
+      if (msg_cnt++ == 0) {
+        first_msg_ts = std::chrono::steady_clock::now();
+      }
+      if (msg_cnt >= batch_size) {
+        RETURN_ON_ERROR(flush());
+      }
+      break;
+
+    case RdKafka::ERR__PARTITION_EOF:
+      return flush();
+
+    case RdKafka::ERR__UNKNOWN_TOPIC:
+    case RdKafka::ERR__UNKNOWN_PARTITION:
+      return Status::IOError("Topic or partition error: " +
+                             message->errstr());
+
+    default:
+      LOG(ERROR) << "Unhandled kafka error: " << message->errstr();
+      break;
+    }
+  }
+}
+
 const bool KafkaIOAdaptor::registered_ = IOFactory::Register(
     "kafka", static_cast<IOFactory::io_initializer_t>(&KafkaIOAdaptor::Make));
 
@@ -18,18 +18,27 @@ limitations under the License.
 
 #ifdef KAFKA_ENABLED
 
+#include <atomic>
+#include <condition_variable>
 #include <fstream>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "librdkafka/rdkafka.h"
 #include "librdkafka/rdkafkacpp.h"
 
+#include "basic/stream/recordbatch_stream.h"
+#include "client/client.h"
 #include "common/util/blocking_queue.h"
 #include "common/util/functions.h"
 #include "common/util/status.h"
+#include "io/io/byte_stream_parser.h"
 #include "io/io/i_io_adaptor.h"
 #include "io/io/io_factory.h"
 
@@ -57,6 +66,39 @@ class KafkaIOAdaptor : public IIOAdaptor {
 
   Status ReadLine(std::string& line) override;
 
+  /**
+   * @brief Concatenate the pending messages, one line for each message, into
+   * a single buffer, it waits for new messages only when none is pending.
+   */
+  Status ReadBatch(size_t batch_size, std::shared_ptr<arrow::Buffer>& buffer,
+                   std::vector<int64_t>& line_offsets) override;
+
+  /**
+   * @brief Take all the messages that have been fetched so far, it waits for
+   * new messages only when none is pending.
+   */
+  Status ReadMessages(std::vector<std::string>& messages);
+
+  /**
+   * @brief Consume the partitions into a newly created record batch stream,
+   * instead of `Open()`, and returns once all partitions have been consumed.
+   *
+   * Each partition is consumed on its own thread, where the payloads of the
+   * messages are appended right into a buffer of lines, which is parsed into
+   * a record batch by `ByteStreamParser` (with the `params`, which are
+   * carried by the stream as well) and pushed into the stream once it holds
+   * `batch_size / partitions` messages or `time_interval` has elapsed since
+   * its first message. The messages never become `std::string` lines.
+   *
+   * The id of the stream is passed to `on_created` before consuming, thus
+   * the readers can start while the partitions are being consumed. The
+   * stream is aborted when any of the partitions fails.
+   */
+  Status ConsumeToStream(
+      Client& client,
+      std::unordered_map<std::string, std::string> const& params,
+      std::function<void(ObjectID)> const& on_created);
+
   Status SetPartialRead(const int index, const int total_parts) override;
 
   Status GetPartialReadDetail(int64_t& offset, int64_t& nbytes) {
@@ -73,6 +115,18 @@ class KafkaIOAdaptor : public IIOAdaptor {
 
   Status Write(void* buffer, size_t size) override;
 
+  /**
+   * @brief Produce each row of the table as a message of delimited values,
+   * the messages are batched by the producer until `Flush()` or `Close()`.
+   */
+  Status WriteTable(std::shared_ptr<arrow::Table> table) override;
+
+  /**
+   * @brief Wait for the delivery of all produced messages, fails if any of
+   * them have been reported as undelivered since the last flush.
+   */
+  Status Flush() override;
+
   Status ListDirectory(const std::string& path,
                        std::vector<std::string>& files) override {
     return Status::NotImplemented();
@@ -87,10 +141,45 @@ class KafkaIOAdaptor : public IIOAdaptor {
  private:
   void parseLocation(const std::string& location);
 
+  /**
+   * @brief Create and assign the consumers of the local partitions.
+   */
+  void createConsumers();
+
   void startFetch();
 
+  /**
+   * @brief Refill the message list from the queues when it has been
+   * consumed, returns false when all partitions have reached the end.
+   */
+  bool nextMessages();
+
+  /**
+   * @brief Wake up the reader that waits in `nextMessages()`.
+   */
+  void notifyFetched();
+
+  /**
+   * @brief Enqueue a message into the producer, waits for the in-flight
+   * messages when the producer queue is full.
+   */
+  Status produce(const void* payload, size_t size);
+
+  static Status appendValue(arrow::Array const* array, int64_t index,
+                            std::string& out);
+
+  class DeliveryReport : public RdKafka::DeliveryReportCb {
+   public:
+    void dr_cb(RdKafka::Message& message) override;
+
+    std::atomic<int64_t> failures{0};
+  };
+
   void fetchMessage(int partition, std::vector<std::string>& messages);
 
+  Status consumePartition(int partition, ByteStreamParser& parser,
+                          RecordBatchStreamWriter& writer);
+
   static const constexpr int internal_buffer_size_ = 1024 * 1024;
 
   bool consumer_;
@@ -106,13 +195,24 @@ class KafkaIOAdaptor : public IIOAdaptor {
   int total_parts_;
 
   template <typename T>
-  using mq_t = std::shared_ptr<PCBlockingQueue<std::vector<T>>>;
+  using mq_t = std::shared_ptr<MPMCQueue<std::vector<T>>>;
   std::vector<mq_t<std::string>> message_queue_;
   std::vector<std::string> message_list_;
+  // bumped by the fetchers once messages are put into the queues
+  std::mutex fetch_mutex_;
+  std::condition_variable fetch_cv_;
+  uint64_t fetch_seq_ = 0;
   std::string group_id_;
   std::string brokers_;
   std::string topic_;
+  // for producer, the report callback outlives the producer
+  int linger_ms_ = 5;
+  int batch_num_messages_ = 10000;
+  char delimiter_ = ',';
+  DeliveryReport delivery_report_;
   std::unique_ptr<RdKafka::Producer> producer_;
+  std::atomic<bool> polling_{false};
+  std::thread poller_;
   std::map<int, std::shared_ptr<RdKafka::KafkaConsumer>> consumer_ptrs_;
 
   // register
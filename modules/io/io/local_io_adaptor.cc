@@ -20,9 +20,13 @@ limitations under the License.
 #include <sys/types.h>
 
 #include <algorithm>
+#include <cstring>
 #include <limits>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "arrow/csv/api.h"
@@ -37,8 +41,21 @@ limitations under the License.
 #include "glog/logging.h"
 
 #include "basic/ds/arrow_utils.h"
+#include "io/io/readahead_input_stream.h"
 
 namespace vineyard {
+
+namespace {
+
+using column_types_t =
+    std::unordered_map<std::string, std::shared_ptr<arrow::DataType>>;
+
+// the column types that are inferred from the partitions read so far, per file
+std::mutex inferred_column_types_mutex;
+std::unordered_map<std::string, column_types_t> inferred_column_types;
+
+}  // namespace
+
 LocalIOAdaptor::LocalIOAdaptor(const std::string& location)
     : location_(location),
       header_row_(false),
@@ -47,6 +64,19 @@ LocalIOAdaptor::LocalIOAdaptor(const std::string& location)
       index_(0) {
   // in csv format location:
   //    file_path#schema=t1,t2,t3&header_row=true/false
+  //
+  // `mmap=true` maps local files into memory rather than reading them with
+  // syscalls, reads and the input stream of `ReadPartialTable` then slice
+  // the mapping without copying.
+  //
+  // `readahead=<depth>` keeps up to `depth` chunks of the partial range read
+  // ahead in the background while parsing, it is enabled for the filesystems
+  // other than the local one by default.
+  //
+  // `use_threads=true/false` and `block_size=<bytes>` are passed to the arrow
+  // csv reader, which parses the blocks of a partition concurrently, and
+  // `cache_column_types=true` reuses the types inferred from the earlier
+  // partitions of the same file in this process.
 
   // process the args
   //
@@ -87,6 +117,18 @@ LocalIOAdaptor::LocalIOAdaptor(const std::string& location)
             (boost::algorithm::to_lower_copy(kv_pair[1]) == "true");
         meta_.emplace("include_all_columns",
                       std::to_string(include_all_columns_));
+      } else if (kv_pair[0] == "mmap") {
+        use_mmap_ = (boost::algorithm::to_lower_copy(kv_pair[1]) == "true");
+      } else if (kv_pair[0] == "readahead" && kv_pair.size() > 1) {
+        readahead_depth_ = std::stoi(kv_pair[1]);
+      } else if (kv_pair[0] == "use_threads" && kv_pair.size() > 1) {
+        use_threads_ =
+            (boost::algorithm::to_lower_copy(kv_pair[1]) == "true");
+      } else if (kv_pair[0] == "block_size" && kv_pair.size() > 1) {
+        block_size_ = std::stoll(kv_pair[1]);
+      } else if (kv_pair[0] == "cache_column_types" && kv_pair.size() > 1) {
+        cache_column_types_ =
+            (boost::algorithm::to_lower_copy(kv_pair[1]) == "true");
       } else if (kv_pair.size() > 1) {
         meta_.emplace(kv_pair[0], kv_pair[1]);
       }
@@ -160,7 +202,13 @@ Status LocalIOAdaptor::Open(const char* mode) {
     }
     return Status::OK();
   } else {
-    RETURN_ON_ARROW_ERROR_AND_ASSIGN(ifp_, fs_->OpenInputFile(location_));
+    if (use_mmap_ && fs_->type_name() == "local") {
+      RETURN_ON_ARROW_ERROR_AND_ASSIGN(
+          ifp_, arrow::io::MemoryMappedFile::Open(location_,
+                                                  arrow::io::FileMode::READ));
+    } else {
+      RETURN_ON_ARROW_ERROR_AND_ASSIGN(ifp_, fs_->OpenInputFile(location_));
+    }
 
     // check the partial read flag
     if (enable_partial_read_) {
@@ -311,8 +359,18 @@ Status LocalIOAdaptor::ReadPartialTable(std::shared_ptr<arrow::Table>* table,
   int64_t offset = partial_read_offset_[index];
   int64_t nbytes =
       partial_read_offset_[index + 1] - partial_read_offset_[index];
-  std::shared_ptr<arrow::io::InputStream> input =
-      arrow::io::RandomAccessFile::GetStream(ifp_, offset, nbytes);
+  int readahead_depth = readahead_depth_;
+  if (readahead_depth < 0) {
+    readahead_depth = fs_->type_name() == "local" ? 0 : kReadAheadDepth;
+  }
+  std::shared_ptr<arrow::io::InputStream> input;
+  if (readahead_depth > 0) {
+    input = std::make_shared<ReadAheadInputStream>(
+        ifp_, offset, nbytes, static_cast<int64_t>(kReadAheadChunkSize),
+        readahead_depth);
+  } else {
+    input = arrow::io::RandomAccessFile::GetStream(ifp_, offset, nbytes);
+  }
 
   arrow::MemoryPool* pool = arrow::default_memory_pool();
 
@@ -321,6 +379,18 @@ Status LocalIOAdaptor::ReadPartialTable(std::shared_ptr<arrow::Table>* table,
   auto convert_options = arrow::csv::ConvertOptions::Defaults();
 
   read_options.column_names = original_columns_;
+  read_options.use_threads = use_threads_;
+  if (block_size_ > 0) {
+    read_options.block_size = static_cast<int32_t>(block_size_);
+  } else if (use_threads_) {
+    // smaller blocks for small partitions, to occupy all the threads
+    constexpr int64_t kMinBlockSize = 256 * 1024;
+    int64_t concurrency = std::max(std::thread::hardware_concurrency(), 1u);
+    read_options.block_size = static_cast<int32_t>(
+        std::max(std::min(static_cast<int64_t>(read_options.block_size),
+                          nbytes / (4 * concurrency)),
+                 kMinBlockSize));
+  }
 
   auto is_number = [](const std::string& s) -> bool {
     return !s.empty() && std::find_if(s.begin(), s.end(), [](unsigned char c) {
@@ -358,8 +428,7 @@ Status LocalIOAdaptor::ReadPartialTable(std::shared_ptr<arrow::Table>* table,
     return Status(StatusCode::kArrowError,
                   "Format of column type schema is incorrect.");
   }
-  std::unordered_map<std::string, std::shared_ptr<arrow::DataType>>
-      column_types;
+  column_types_t column_types;
 
   for (size_t i = 0; i < column_types_.size(); ++i) {
     if (!column_types_[i].empty()) {
@@ -367,6 +436,14 @@ Status LocalIOAdaptor::ReadPartialTable(std::shared_ptr<arrow::Table>* table,
           type_name_to_arrow_type(column_types_[i]);
     }
   }
+  if (cache_column_types_) {
+    std::lock_guard<std::mutex> lock(inferred_column_types_mutex);
+    auto iter = inferred_column_types.find(location_);
+    if (iter != inferred_column_types.end()) {
+      // explicitly given types take precedence
+      column_types.insert(iter->second.begin(), iter->second.end());
+    }
+  }
   convert_options.column_types = column_types;
 
   parse_options.delimiter = delimiter_;
@@ -397,6 +474,14 @@ Status LocalIOAdaptor::ReadPartialTable(std::shared_ptr<arrow::Table>* table,
 
   RETURN_ON_ARROW_ERROR((*table)->Validate());
 
+  if (cache_column_types_) {
+    std::lock_guard<std::mutex> lock(inferred_column_types_mutex);
+    auto& inferred = inferred_column_types[location_];
+    for (auto const& field : (*table)->schema()->fields()) {
+      inferred.emplace(field->name(), field->type());
+    }
+  }
+
   VLOG(2) << "[file-" << location_ << "] contains: " << (*table)->num_rows()
           << " rows, " << (*table)->num_columns() << " columns";
   VLOG(2) << (*table)->schema()->ToString();
@@ -477,6 +562,65 @@ Status LocalIOAdaptor::ReadLine(std::string& line) {
   return Status::OK();
 }
 
+Status LocalIOAdaptor::ReadBatch(size_t batch_size,
+                                 std::shared_ptr<arrow::Buffer>& buffer,
+                                 std::vector<int64_t>& line_offsets) {
+  if (ifp_ == nullptr) {
+    return Status::IOError("The file hasn't been opened in read mode: " +
+                           location_);
+  }
+  int64_t position = tell();
+  int64_t limit =
+      enable_partial_read_ ? partial_read_offset_[index_ + 1] : GetFullSize();
+  if (position < 0 || limit < 0) {
+    return Status::IOError("Failed to tell the position of file: " +
+                           location_);
+  }
+  if (position >= limit) {
+    return Status::EndOfFile();
+  }
+
+  int64_t nbytes = std::min(
+      static_cast<int64_t>(std::max(batch_size, static_cast<size_t>(1))),
+      limit - position);
+  int64_t length = 0;
+  while (true) {
+    RETURN_ON_ARROW_ERROR_AND_ASSIGN(buffer, ifp_->ReadAt(position, nbytes));
+    if (buffer->size() == 0) {
+      return Status::EndOfFile();
+    }
+    if (position + buffer->size() >= limit ||
+        buffer->size() < nbytes /* short read: end of file */) {
+      length = buffer->size();
+      break;
+    }
+    const uint8_t* data = buffer->data();
+    length = buffer->size();
+    while (length > 0 && data[length - 1] != '\n') {
+      --length;
+    }
+    if (length > 0) {
+      break;
+    }
+    // the line is longer than the batch, retry with a larger one
+    nbytes = std::min(nbytes * 2, limit - position);
+  }
+  buffer = arrow::SliceBuffer(buffer, 0, length);
+  RETURN_ON_ERROR(seek(position + length, kFileLocationBegin));
+
+  const uint8_t* data = buffer->data();
+  line_offsets.clear();
+  line_offsets.push_back(0);
+  int64_t begin = 0;
+  while (begin < length) {
+    auto eol = static_cast<const uint8_t*>(
+        memchr(data + begin, '\n', length - begin));
+    begin = eol == nullptr ? length : (eol - data) + 1;
+    line_offsets.push_back(begin);
+  }
+  return Status::OK();
+}
+
 Status LocalIOAdaptor::WriteLine(const std::string& line) {
   if (ofp_ == nullptr) {
     return Status::IOError("The file hasn't been opened in write mode: " +
@@ -63,6 +63,14 @@ class LocalIOAdaptor : public IIOAdaptor {
 
   Status ReadLine(std::string& line) override;
 
+  /**
+   * @brief Read the whole lines of the next `batch_size` bytes of the file
+   * (or of the part, if partial read is enabled) in a single read, the
+   * returned buffer is sliced at the last line break.
+   */
+  Status ReadBatch(size_t batch_size, std::shared_ptr<arrow::Buffer>& buffer,
+                   std::vector<int64_t>& line_offsets) override;
+
   /** Read the part of file given index and total_parts.
    * first cut the file into several parts with given
    * <total_part>, looking backwards for the nearest
@@ -135,6 +143,16 @@ class LocalIOAdaptor : public IIOAdaptor {
   bool header_row_ = false;
   std::string header_line_ = "";
   bool include_all_columns_ = false;
+  // map local files into memory for reading
+  bool use_mmap_ = false;
+  // chunks read ahead by `ReadPartialTable`, -1 for the filesystem default
+  int readahead_depth_ = -1;
+  static constexpr int kReadAheadDepth = 4;
+  static constexpr int64_t kReadAheadChunkSize = 4 * 1024 * 1024;
+  // options of the arrow csv reader, block size 0 for auto
+  bool use_threads_ = true;
+  int64_t block_size_ = 0;
+  bool cache_column_types_ = false;
   // schema of header row
   std::vector<std::string> original_columns_;
 
@@ -0,0 +1,123 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "io/io/readahead_input_stream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace vineyard {
+
+ReadAheadInputStream::ReadAheadInputStream(
+    std::shared_ptr<arrow::io::RandomAccessFile> file, int64_t offset,
+    int64_t nbytes, int64_t chunk_size, size_t depth)
+    : file_(file),
+      offset_(offset),
+      nbytes_(nbytes),
+      chunk_size_(std::max(chunk_size, static_cast<int64_t>(1))),
+      stopped_(false) {
+  chunks_.SetLimit(std::max(depth, static_cast<size_t>(1)));
+  chunks_.SetProducerNum(1);
+  fetcher_ = std::thread([this]() { fetch(); });
+}
+
+ReadAheadInputStream::~ReadAheadInputStream() { ARROW_UNUSED(Close()); }
+
+arrow::Status ReadAheadInputStream::Close() {
+  if (closed_) {
+    return arrow::Status::OK();
+  }
+  closed_ = true;
+  stopped_ = true;
+  // unblock the fetcher if it is waiting for a free slot
+  std::shared_ptr<arrow::Buffer> chunk;
+  while (chunks_.Get(chunk)) {
+  }
+  fetcher_.join();
+  chunk_.reset();
+  return arrow::Status::OK();
+}
+
+arrow::Result<int64_t> ReadAheadInputStream::Read(int64_t nbytes, void* out) {
+  int64_t nread = 0;
+  while (nread < nbytes) {
+    ARROW_ASSIGN_OR_RAISE(bool has_chunk, nextChunk());
+    if (!has_chunk) {
+      break;
+    }
+    int64_t size = std::min(nbytes - nread, chunk_->size() - chunk_offset_);
+    memcpy(static_cast<uint8_t*>(out) + nread, chunk_->data() + chunk_offset_,
+           size);
+    chunk_offset_ += size;
+    nread += size;
+  }
+  position_ += nread;
+  return nread;
+}
+
+arrow::Result<std::shared_ptr<arrow::Buffer>> ReadAheadInputStream::Read(
+    int64_t nbytes) {
+  ARROW_ASSIGN_OR_RAISE(bool has_chunk, nextChunk());
+  if (!has_chunk) {
+    return std::make_shared<arrow::Buffer>(nullptr, 0);
+  }
+  if (chunk_->size() - chunk_offset_ >= nbytes) {
+    auto buffer = arrow::SliceBuffer(chunk_, chunk_offset_, nbytes);
+    chunk_offset_ += nbytes;
+    position_ += nbytes;
+    return buffer;
+  }
+  // the read spans chunks
+  std::string data(nbytes, '\0');
+  ARROW_ASSIGN_OR_RAISE(int64_t nread, Read(nbytes, &data[0]));
+  data.resize(nread);
+  return arrow::Buffer::FromString(std::move(data));
+}
+
+void ReadAheadInputStream::fetch() {
+  for (int64_t begin = 0; begin < nbytes_ && !stopped_; begin += chunk_size_) {
+    auto chunk =
+        file_->ReadAt(offset_ + begin, std::min(chunk_size_, nbytes_ - begin));
+    if (!chunk.ok()) {
+      status_ = chunk.status();
+      break;
+    }
+    if (chunk.ValueUnsafe()->size() == 0) {
+      break;
+    }
+    chunks_.Put(chunk.ValueUnsafe());
+  }
+  chunks_.DecProducerNum();
+}
+
+arrow::Result<bool> ReadAheadInputStream::nextChunk() {
+  if (closed_) {
+    return arrow::Status::Invalid("Operation on a closed stream");
+  }
+  while (chunk_ == nullptr || chunk_offset_ == chunk_->size()) {
+    chunk_offset_ = 0;
+    if (!chunks_.Get(chunk_)) {
+      chunk_.reset();
+      ARROW_RETURN_NOT_OK(status_);
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace vineyard
@@ -0,0 +1,85 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_IO_IO_READAHEAD_INPUT_STREAM_H_
+#define MODULES_IO_IO_READAHEAD_INPUT_STREAM_H_
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "arrow/buffer.h"
+#include "arrow/io/interfaces.h"
+#include "arrow/result.h"
+#include "arrow/status.h"
+
+#include "common/util/blocking_queue.h"
+
+namespace vineyard {
+
+/**
+ * @brief An input stream over the range `[offset, offset + nbytes)` of a
+ * random access file, which reads the following chunks of the range on a
+ * background thread while the current chunk is being consumed.
+ *
+ * At most `depth` chunks are buffered ahead, which bounds the memory to
+ * `depth * chunk_size` bytes, reads that fall within a single chunk are sliced
+ * out of it without copying.
+ */
+class ReadAheadInputStream : public arrow::io::InputStream {
+ public:
+  ReadAheadInputStream(std::shared_ptr<arrow::io::RandomAccessFile> file,
+                       int64_t offset, int64_t nbytes, int64_t chunk_size,
+                       size_t depth);
+
+  ~ReadAheadInputStream() override;
+
+  arrow::Status Close() override;
+
+  bool closed() const override { return closed_; }
+
+  arrow::Result<int64_t> Tell() const override { return position_; }
+
+  arrow::Result<int64_t> Read(int64_t nbytes, void* out) override;
+
+  arrow::Result<std::shared_ptr<arrow::Buffer>> Read(int64_t nbytes) override;
+
+ private:
+  void fetch();
+
+  /**
+   * @brief Make sure the current chunk has remaining bytes, returns false at
+   * the end of the range.
+   */
+  arrow::Result<bool> nextChunk();
+
+  std::shared_ptr<arrow::io::RandomAccessFile> file_;
+  int64_t offset_, nbytes_, chunk_size_;
+
+  PCBlockingQueue<std::shared_ptr<arrow::Buffer>> chunks_;
+  // the error of the background reads, visible once `chunks_` drained
+  arrow::Status status_;
+  std::atomic<bool> stopped_;
+  std::thread fetcher_;
+
+  std::shared_ptr<arrow::Buffer> chunk_;
+  int64_t chunk_offset_ = 0;
+  int64_t position_ = 0;
+  bool closed_ = false;
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_IO_IO_READAHEAD_INPUT_STREAM_H_
@@ -89,6 +89,13 @@ def pytest_addoption(parser):
         help='Location of oss config to login oss server',
     )
 
+    parser.addoption(
+        '--vineyard-flight-endpoint',
+        action='store',
+        default=None,
+        help='Location of the vineyard-flight server of the vineyard instance',
+    )
+
     parser.addoption(
         '--with-migration',
         action='store_true',
@@ -142,6 +149,11 @@ def oss_config(request):
     return request.config.option.oss_config
 
 
+@pytest.fixture(scope='session')
+def vineyard_flight_endpoint(request):
+    return request.config.option.vineyard_flight_endpoint
+
+
 @pytest.fixture(scope='session')
 def with_migration(request):
     return request.config.option.with_migration
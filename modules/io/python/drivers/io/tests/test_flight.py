@@ -0,0 +1,164 @@
+#! /usr/bin/env python
+# -*- coding: utf-8 -*-
+#
+# Copyright 2020-2021 Alibaba Group Holding Limited.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import numpy as np
+import pandas as pd
+import pyarrow as pa
+import pytest
+import vineyard
+from vineyard.data.dataframe import make_global_dataframe
+
+flight = pytest.importorskip('pyarrow.flight')
+
+
+@pytest.fixture(scope='module')
+def flight_client(vineyard_flight_endpoint):
+    if vineyard_flight_endpoint is None:
+        pytest.skip('Skip since vineyard-flight is not available')
+    return flight.FlightClient(vineyard_flight_endpoint)
+
+
+@pytest.fixture(scope='module')
+def vineyard_client(vineyard_ipc_socket):
+    return vineyard.connect(vineyard_ipc_socket)
+
+
+def make_table(rows, offset=0):
+    return pa.table(
+        {
+            'a': pa.array(np.arange(offset, offset + rows, dtype=np.int64)),
+            'b': pa.array(np.arange(rows, dtype=np.float64) / 3),
+            's': pa.array(
+                ['s%d' % (offset + i) for i in range(rows)], type=pa.large_string()
+            ),
+        }
+    )
+
+
+def read_flight(flight_client, info):
+    tables = [
+        flight_client.do_get(endpoint.ticket).read_all()
+        for endpoint in info.endpoints
+    ]
+    return pa.concat_tables(tables)
+
+
+def test_get_table(vineyard_client, flight_client):
+    table = pa.concat_tables([make_table(100), make_table(57, 100)])
+    object_id = vineyard_client.put(table)
+    vineyard_client.persist(object_id)
+
+    info = flight_client.get_flight_info(
+        flight.FlightDescriptor.for_path(repr(object_id))
+    )
+    assert info.total_records == table.num_rows
+    assert info.schema.equals(table.schema)
+    assert len(info.endpoints) == 1
+    assert info.endpoints[0].ticket.ticket == repr(object_id).encode()
+    assert read_flight(flight_client, info).equals(table)
+
+    # the objects are served by their names as well
+    vineyard_client.put_name(object_id, 'flight_test_table')
+    for descriptor in [
+        flight.FlightDescriptor.for_path('flight_test_table'),
+        flight.FlightDescriptor.for_command('flight_test_table'),
+    ]:
+        info = flight_client.get_flight_info(descriptor)
+        assert read_flight(flight_client, info).equals(table)
+    vineyard_client.drop_name('flight_test_table')
+    vineyard_client.delete(object_id)
+
+
+def test_get_record_batch_and_dataframe(vineyard_client, flight_client):
+    batch = make_table(33).to_batches()[0]
+    batch_id = vineyard_client.put(batch)
+    info = flight_client.get_flight_info(
+        flight.FlightDescriptor.for_path(repr(batch_id))
+    )
+    assert info.total_records == batch.num_rows
+    assert read_flight(flight_client, info).equals(pa.Table.from_batches([batch]))
+
+    df = pd.DataFrame({'a': np.arange(1000), 'b': np.random.rand(1000)})
+    df_id = vineyard_client.put(df)
+    info = flight_client.get_flight_info(
+        flight.FlightDescriptor.for_path(repr(df_id))
+    )
+    assert info.total_records == len(df)
+    result = read_flight(flight_client, info)
+    np.testing.assert_array_equal(result.column('a').to_numpy(), df['a'].values)
+    np.testing.assert_array_equal(result.column('b').to_numpy(), df['b'].values)
+    vineyard_client.delete([batch_id, df_id])
+
+
+def test_get_global_dataframe(vineyard_client, flight_client):
+    chunk_ids = []
+    for offset, rows in [(0, 10), (10, 20), (30, 30)]:
+        df = pd.DataFrame({'a': np.arange(offset, offset + rows)})
+        chunk_ids.append(vineyard_client.put(df))
+        vineyard_client.persist(chunk_ids[-1])
+    meta = make_global_dataframe(vineyard_client, chunk_ids)
+
+    # a flight endpoint for each chunk, at the sidecar of its owner
+    info = flight_client.get_flight_info(
+        flight.FlightDescriptor.for_path(repr(meta.id))
+    )
+    assert info.total_records == 60
+    assert [endpoint.ticket.ticket for endpoint in info.endpoints] == [
+        repr(chunk_id).encode() for chunk_id in chunk_ids
+    ]
+    for endpoint in info.endpoints:
+        assert len(endpoint.locations) == 1
+    result = read_flight(flight_client, info)
+    np.testing.assert_array_equal(result.column('a').to_numpy(), np.arange(60))
+    vineyard_client.delete(meta.id, deep=False)
+    vineyard_client.delete(chunk_ids)
+
+
+def test_list_flights(vineyard_client, flight_client):
+    table_id = vineyard_client.put(make_table(10))
+    batch_id = vineyard_client.put(make_table(10).to_batches()[0])
+    tensor_id = vineyard_client.put(np.arange(10))
+    for object_id in [table_id, batch_id, tensor_id]:
+        vineyard_client.persist(object_id)
+
+    # only the tabular objects are listed
+    listed = {info.descriptor.path[0] for info in flight_client.list_flights()}
+    assert repr(table_id).encode() in listed
+    assert repr(batch_id).encode() in listed
+    assert repr(tensor_id).encode() not in listed
+
+    # and the criteria is a glob pattern of the typenames
+    listed = {
+        info.descriptor.path[0]
+        for info in flight_client.list_flights(criteria=b'vineyard::Table*')
+    }
+    assert repr(table_id).encode() in listed
+    assert repr(batch_id).encode() not in listed
+    vineyard_client.delete([table_id, batch_id, tensor_id])
+
+
+def test_invalid_flights(vineyard_client, flight_client):
+    tensor_id = vineyard_client.put(np.arange(10))
+    for target in [repr(tensor_id), 'flight_test_missing_name']:
+        with pytest.raises((pa.ArrowException, flight.FlightError)):
+            flight_client.get_flight_info(flight.FlightDescriptor.for_path(target))
+    with pytest.raises((pa.ArrowException, flight.FlightError)):
+        flight_client.get_flight_info(flight.FlightDescriptor.for_path('a', 'b'))
+    with pytest.raises((pa.ArrowException, flight.FlightError)):
+        flight_client.do_get(flight.Ticket(repr(tensor_id).encode())).read_all()
+    vineyard_client.delete(tensor_id)
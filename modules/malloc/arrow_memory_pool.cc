@@ -0,0 +1,183 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "malloc/arrow_memory_pool.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace vineyard {
+
+// arrow prefers 64-bytes aligned buffers; jemalloc aligns a size class to the
+// largest power of two that divides it, so rounding the requested size up to
+// a multiple of 64 is enough.
+static constexpr int64_t kArrowAlignment = 64;
+
+static inline int64_t round_up(const int64_t size) {
+  return (size + kArrowAlignment - 1) & ~(kArrowAlignment - 1);
+}
+
+VineyardMemoryPool::VineyardMemoryPool(Client& client)
+    : client_(client), allocator_(client) {}
+
+VineyardMemoryPool::~VineyardMemoryPool() {}
+
+#if defined(ARROW_VERSION) && ARROW_VERSION < 11000000
+arrow::Status VineyardMemoryPool::Allocate(int64_t size, uint8_t** out) {
+  return allocate(size, out);
+}
+
+arrow::Status VineyardMemoryPool::Reallocate(int64_t old_size, int64_t new_size,
+                                             uint8_t** ptr) {
+  return reallocate(old_size, new_size, ptr);
+}
+
+void VineyardMemoryPool::Free(uint8_t* buffer, int64_t size) {
+  deallocate(buffer, size);
+}
+#else
+arrow::Status VineyardMemoryPool::Allocate(int64_t size, int64_t alignment,
+                                           uint8_t** out) {
+  if (alignment > kArrowAlignment) {
+    return arrow::Status::Invalid("unsupported alignment: ", alignment);
+  }
+  return allocate(size, out);
+}
+
+arrow::Status VineyardMemoryPool::Reallocate(int64_t old_size, int64_t new_size,
+                                             int64_t alignment, uint8_t** ptr) {
+  if (alignment > kArrowAlignment) {
+    return arrow::Status::Invalid("unsupported alignment: ", alignment);
+  }
+  return reallocate(old_size, new_size, ptr);
+}
+
+void VineyardMemoryPool::Free(uint8_t* buffer, int64_t size, int64_t) {
+  deallocate(buffer, size);
+}
+#endif
+
+int64_t VineyardMemoryPool::bytes_allocated() const {
+  return bytes_allocated_.load();
+}
+
+int64_t VineyardMemoryPool::max_memory() const { return max_memory_.load(); }
+
+std::string VineyardMemoryPool::backend_name() const { return "vineyard"; }
+
+Status VineyardMemoryPool::Freeze(const std::shared_ptr<arrow::Buffer>& buffer,
+                                  std::shared_ptr<Blob>& blob) {
+  if (buffer == nullptr || buffer->size() == 0) {
+    blob = Blob::MakeEmpty(client_);
+    return Status::OK();
+  }
+  uintptr_t pointer = reinterpret_cast<uintptr_t>(buffer->data());
+  std::lock_guard<std::mutex> lock(mutex_);
+  // the allocation that starts at or before the buffer, jemalloc can't tell
+  // the size of a pointer into the middle of an allocation
+  auto allocation = allocations_.upper_bound(pointer);
+  if (allocation == allocations_.begin()) {
+    return Status::Invalid(
+        "The buffer is not allocated from the vineyard memory pool");
+  }
+  --allocation;
+  if (pointer + buffer->size() > allocation->first + allocation->second ||
+      !allocator_.Owns(reinterpret_cast<void*>(allocation->first))) {
+    return Status::Invalid(
+        "The buffer is not allocated from the vineyard memory pool");
+  }
+  auto frozen = frozen_.find(allocation->first);
+  if (frozen == frozen_.end()) {
+    frozen = frozen_
+                 .emplace(allocation->first,
+                          allocator_.Freeze(
+                              reinterpret_cast<void*>(allocation->first)))
+                 .first;
+  }
+  blob = frozen->second;
+  return Status::OK();
+}
+
+Status VineyardMemoryPool::Release() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return allocator_.Release();
+}
+
+Status VineyardMemoryPool::Renew() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return allocator_.Renew();
+}
+
+arrow::Status VineyardMemoryPool::allocate(int64_t size, uint8_t** out) {
+  if (size < 0) {
+    return arrow::Status::Invalid("negative malloc size");
+  }
+  void* pointer = allocator_.Allocate(round_up(size), kArrowAlignment);
+  if (pointer == nullptr) {
+    return arrow::Status::OutOfMemory("malloc of size ", size,
+                                      " failed in vineyard memory pool");
+  }
+  *out = reinterpret_cast<uint8_t*>(pointer);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    allocations_[reinterpret_cast<uintptr_t>(pointer)] = round_up(size);
+  }
+  int64_t allocated = bytes_allocated_.fetch_add(size) + size;
+  int64_t peak = max_memory_.load();
+  while (allocated > peak &&
+         !max_memory_.compare_exchange_weak(peak, allocated)) {
+  }
+  return arrow::Status::OK();
+}
+
+arrow::Status VineyardMemoryPool::reallocate(int64_t old_size, int64_t new_size,
+                                             uint8_t** ptr) {
+  if (new_size < 0) {
+    return arrow::Status::Invalid("negative realloc size");
+  }
+  void* pointer = allocator_.Reallocate(*ptr, round_up(new_size));
+  if (pointer == nullptr) {
+    return arrow::Status::OutOfMemory("realloc of size ", new_size,
+                                      " failed in vineyard memory pool");
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    allocations_.erase(reinterpret_cast<uintptr_t>(*ptr));
+    allocations_[reinterpret_cast<uintptr_t>(pointer)] = round_up(new_size);
+  }
+  *ptr = reinterpret_cast<uint8_t*>(pointer);
+  int64_t allocated =
+      bytes_allocated_.fetch_add(new_size - old_size) + new_size - old_size;
+  int64_t peak = max_memory_.load();
+  while (allocated > peak &&
+         !max_memory_.compare_exchange_weak(peak, allocated)) {
+  }
+  return arrow::Status::OK();
+}
+
+void VineyardMemoryPool::deallocate(uint8_t* buffer, int64_t size) {
+  bytes_allocated_.fetch_sub(size);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    allocations_.erase(reinterpret_cast<uintptr_t>(buffer));
+    if (frozen_.find(reinterpret_cast<uintptr_t>(buffer)) != frozen_.end()) {
+      return;
+    }
+  }
+  allocator_.Free(buffer, size);
+}
+
+}  // namespace vineyard
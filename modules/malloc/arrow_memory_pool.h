@@ -0,0 +1,128 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_MALLOC_ARROW_MEMORY_POOL_H_
+#define MODULES_MALLOC_ARROW_MEMORY_POOL_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "arrow/buffer.h"
+#include "arrow/memory_pool.h"
+#include "arrow/status.h"
+
+#include "client/allocator.h"
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief An arrow::MemoryPool that allocates from a shared memory arena of
+ * vineyard, so buffers of arrays built with it (e.g., by arrow builders) can
+ * be sealed as blobs without being copied into a `BlobWriter`.
+ *
+ * \code{.cpp}
+ *    VineyardMemoryPool pool(client);
+ *    arrow::Int64Builder builder(&pool);
+ *    ...
+ *    std::shared_ptr<arrow::Int64Array> array;
+ *    builder.Finish(&array);
+ *    std::shared_ptr<Blob> blob;
+ *    VINEYARD_CHECK_OK(pool.Freeze(array->values(), blob));
+ *    VINEYARD_CHECK_OK(pool.Release());  // registers the frozen blobs
+ * \endcode
+ *
+ * Blobs returned by `Freeze` become visible to the vineyard server after
+ * `Release()` or `Renew()`.
+ */
+class VineyardMemoryPool : public arrow::MemoryPool {
+ public:
+  explicit VineyardMemoryPool(Client& client);
+
+  ~VineyardMemoryPool() override;
+
+#if defined(ARROW_VERSION) && ARROW_VERSION < 11000000
+  arrow::Status Allocate(int64_t size, uint8_t** out) override;
+
+  arrow::Status Reallocate(int64_t old_size, int64_t new_size,
+                           uint8_t** ptr) override;
+
+  void Free(uint8_t* buffer, int64_t size) override;
+#else
+  arrow::Status Allocate(int64_t size, int64_t alignment,
+                         uint8_t** out) override;
+
+  arrow::Status Reallocate(int64_t old_size, int64_t new_size,
+                           int64_t alignment, uint8_t** ptr) override;
+
+  void Free(uint8_t* buffer, int64_t size, int64_t alignment) override;
+#endif
+
+  int64_t bytes_allocated() const override;
+
+  int64_t max_memory() const override;
+
+  std::string backend_name() const override;
+
+  /**
+   * @brief Seal a buffer that was allocated from this pool as a blob, without
+   * copying, e.g., the buffers of arrays produced by arrow builders that use
+   * this pool.
+   *
+   * The buffer may be a slice of an allocation (e.g., the values of a sliced
+   * array), the blob then covers the whole allocation, and the buffer starts
+   * at `buffer->data() - blob->data()` in the blob. Freezing the buffers of
+   * the same allocation returns the same blob.
+   */
+  Status Freeze(const std::shared_ptr<arrow::Buffer>& buffer,
+                std::shared_ptr<Blob>& blob);
+
+  /**
+   * @brief Register all frozen blobs to vineyard and release the arena.
+   */
+  Status Release();
+
+  /**
+   * @brief Register all frozen blobs to vineyard and start a new arena.
+   */
+  Status Renew();
+
+ private:
+  arrow::Status allocate(int64_t size, uint8_t** out);
+
+  arrow::Status reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr);
+
+  void deallocate(uint8_t* buffer, int64_t size);
+
+  Client& client_;
+  std::mutex mutex_;  // protects the allocator's state of frozen blocks
+  VineyardAllocator<void> allocator_;
+  // the start and (rounded) size of the live allocations, to resolve the
+  // allocation that a sliced buffer belongs to
+  std::map<uintptr_t, int64_t> allocations_;
+  // frozen blocks are owned by their blobs, and won't go back to the arena
+  std::map<uintptr_t, std::shared_ptr<Blob>> frozen_;
+  std::atomic<int64_t> bytes_allocated_{0};
+  std::atomic<int64_t> max_memory_{0};
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_MALLOC_ARROW_MEMORY_POOL_H_
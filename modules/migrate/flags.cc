@@ -21,5 +21,11 @@ DEFINE_uint64(migration_port, 0, "rpc port of migration");
 DEFINE_string(object_list, "", "object list");
 DEFINE_string(instance_map, "", "instance_mapping");
 DEFINE_string(ipc_socket, "", "ipc socket of vineyard server");
+DEFINE_uint64(migration_connections, 4,
+              "number of connections to send blobs concurrently");
+DEFINE_uint64(migration_chunk_size, 4 * 1024 * 1024,
+              "size of chunks that blobs are split into for migration");
+DEFINE_string(dump_file, "", "file that objects are dumped to");
+DEFINE_bool(restore, false, "restore the object from the dump file");
 
 }  // namespace vineyard
@@ -26,6 +26,10 @@ DECLARE_uint64(migration_port);
 DECLARE_string(object_list);
 DECLARE_string(instance_map);
 DECLARE_string(ipc_socket);
+DECLARE_uint64(migration_connections);
+DECLARE_uint64(migration_chunk_size);
+DECLARE_string(dump_file);
+DECLARE_bool(restore);
 
 }  // namespace vineyard
 
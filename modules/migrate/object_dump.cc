@@ -0,0 +1,306 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "migrate/object_dump.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/json.h"
+
+namespace vineyard {
+
+static constexpr char kDumpMagic[8] = {'V', 'Y', 'D', 'U', 'M', 'P', '0', '1'};
+static constexpr size_t kDumpAlignment = 4096;
+static constexpr size_t kDumpChunkSize = 4 * 1024 * 1024;
+
+static size_t alignToPage(size_t const offset) {
+  return (offset + kDumpAlignment - 1) / kDumpAlignment * kDumpAlignment;
+}
+
+static Status errnoToStatus(std::string const& action,
+                            std::string const& path) {
+  return Status::IOError(action + " '" + path + "': " + strerror(errno));
+}
+
+static Status writeAll(int fd, char const* data, size_t size, size_t offset,
+                       std::string const& path) {
+  while (size > 0) {
+    ssize_t written = pwrite(fd, data, size, offset);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errnoToStatus("Failed to write", path);
+    }
+    data += written;
+    size -= written;
+    offset += written;
+  }
+  return Status::OK();
+}
+
+static Status collectBlobs(json const& meta_tree, InstanceID const instance_id,
+                           std::set<ObjectID>& blob_ids) {
+  ObjectID id =
+      ObjectIDFromString(meta_tree["id"].get_ref<std::string const&>());
+  if (IsBlob(id)) {
+    // the empty blob exists on every instance
+    RETURN_ON_ASSERT(id == EmptyBlobID() ||
+                         meta_tree["instance_id"].get<InstanceID>() ==
+                             instance_id,
+                     "The blob " + ObjectIDToString(id) +
+                         " is not on the connected instance");
+    blob_ids.insert(id);
+    return Status::OK();
+  }
+  for (auto const& item : meta_tree) {
+    if (item.is_object() && !item.empty()) {
+      RETURN_ON_ERROR(collectBlobs(item, instance_id, blob_ids));
+    }
+  }
+  return Status::OK();
+}
+
+/**
+ * @brief Recreate the metadata of the object and its members bottom-up, the
+ * ids of the members are substituted by the new ids in `object_id_map`.
+ */
+static Status restoreMeta(Client& client, json& meta_tree,
+                          std::unordered_map<ObjectID, ObjectID>& object_id_map,
+                          ObjectID& object_id) {
+  for (auto& item : json::iterator_wrapper(meta_tree)) {
+    if (!item.value().is_object() || item.value().empty()) {
+      continue;
+    }
+    ObjectID id =
+        ObjectIDFromString(item.value()["id"].get_ref<std::string const&>());
+    auto iter = object_id_map.find(id);
+    if (iter == object_id_map.end()) {
+      RETURN_ON_ASSERT(!IsBlob(id), "The blob " + ObjectIDToString(id) +
+                                        " is missing from the dump");
+      ObjectID member_id = InvalidObjectID();
+      RETURN_ON_ERROR(
+          restoreMeta(client, item.value(), object_id_map, member_id));
+      iter = object_id_map.emplace(id, member_id).first;
+    }
+    ObjectMeta member_meta;
+    RETURN_ON_ERROR(client.GetMetaData(iter->second, member_meta));
+    meta_tree[item.key()] = member_meta.MetaData();
+  }
+  ObjectMeta meta;
+  meta.SetMetaData(&client, meta_tree);
+  return client.CreateMetaData(meta, object_id);
+}
+
+Status DumpObject(Client& client, ObjectID const object_id,
+                  std::string const& path) {
+  ObjectMeta meta;
+  RETURN_ON_ERROR(client.GetMetaData(object_id, meta));
+  json const& meta_tree = meta.MetaData();
+  std::set<ObjectID> blob_ids;
+  RETURN_ON_ERROR(collectBlobs(meta_tree, client.instance_id(), blob_ids));
+
+  std::vector<std::shared_ptr<Blob>> blobs;
+  for (auto const blob_id : blob_ids) {
+    if (blob_id == EmptyBlobID()) {
+      continue;
+    }
+    auto blob = std::dynamic_pointer_cast<Blob>(client.GetObject(blob_id));
+    RETURN_ON_ASSERT(blob != nullptr,
+                     "Failed to get blob " + ObjectIDToString(blob_id));
+    blobs.emplace_back(blob);
+  }
+
+  // the offsets are relative to the end of the header, which is page
+  // aligned as well, thus the header can be written first
+  json blobs_tree = json::array();
+  std::vector<size_t> offsets(blobs.size());
+  size_t payload_size = 0;
+  for (size_t index = 0; index < blobs.size(); ++index) {
+    offsets[index] = payload_size;
+    payload_size = alignToPage(payload_size + blobs[index]->allocated_size());
+    blobs_tree.push_back(json{{"id", ObjectIDToString(blobs[index]->id())},
+                              {"offset", offsets[index]},
+                              {"size", blobs[index]->allocated_size()}});
+  }
+  json header_tree{{"meta", meta_tree}, {"blobs", blobs_tree}};
+  std::string header = header_tree.dump();
+  uint64_t header_size = header.size();
+  size_t payload_offset =
+      alignToPage(sizeof(kDumpMagic) + sizeof(header_size) + header_size);
+
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1) {
+    return errnoToStatus("Failed to open", path);
+  }
+  std::unique_ptr<int, void (*)(int*)> fd_guard(&fd,
+                                                [](int* fd) { close(*fd); });
+  RETURN_ON_ERROR(writeAll(fd, kDumpMagic, sizeof(kDumpMagic), 0, path));
+  RETURN_ON_ERROR(writeAll(fd, reinterpret_cast<char const*>(&header_size),
+                           sizeof(header_size), sizeof(kDumpMagic), path));
+  RETURN_ON_ERROR(writeAll(fd, header.data(), header.size(),
+                           sizeof(kDumpMagic) + sizeof(header_size), path));
+  for (size_t index = 0; index < blobs.size(); ++index) {
+    RETURN_ON_ERROR(writeAll(fd, blobs[index]->data(),
+                             blobs[index]->allocated_size(),
+                             payload_offset + offsets[index], path));
+  }
+  // pads the file to the aligned end of the last blob
+  if (ftruncate(fd, payload_offset + payload_size) != 0) {
+    return errnoToStatus("Failed to truncate", path);
+  }
+  return Status::OK();
+}
+
+Status RestoreObject(Client& client, std::string const& path,
+                     ObjectID& object_id) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return errnoToStatus("Failed to open", path);
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    close(fd);
+    return errnoToStatus("Failed to stat", path);
+  }
+  size_t file_size = file_stat.st_size;
+  void* mapped = nullptr;
+  if (file_size > 0) {
+    mapped = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (mapped == MAP_FAILED || mapped == nullptr) {
+    return errnoToStatus("Failed to mmap", path);
+  }
+  std::unique_ptr<void, std::function<void(void*)>> mapped_guard(
+      mapped, [file_size](void* pointer) { munmap(pointer, file_size); });
+  char const* base = reinterpret_cast<char const*>(mapped);
+  madvise(mapped, file_size, MADV_SEQUENTIAL);
+
+  uint64_t header_size = 0;
+  RETURN_ON_ASSERT(file_size >= sizeof(kDumpMagic) + sizeof(header_size) &&
+                       memcmp(base, kDumpMagic, sizeof(kDumpMagic)) == 0,
+                   "Not a dump of vineyard objects: " + path);
+  memcpy(&header_size, base + sizeof(kDumpMagic), sizeof(header_size));
+  size_t header_offset = sizeof(kDumpMagic) + sizeof(header_size);
+  RETURN_ON_ASSERT(header_size <= file_size - header_offset,
+                   "The header of the dump is truncated: " + path);
+  json header_tree;
+  try {
+    header_tree = json::parse(base + header_offset,
+                              base + header_offset + header_size);
+  } catch (std::exception const& e) {
+    return Status::Invalid("Failed to parse the header of the dump: " +
+                           std::string(e.what()));
+  }
+  size_t payload_offset = alignToPage(header_offset + header_size);
+
+  std::unordered_map<ObjectID, ObjectID> object_id_map;
+  object_id_map.emplace(EmptyBlobID(), EmptyBlobID());
+  std::vector<ObjectID> blob_ids;
+  std::vector<size_t> sizes;
+  std::vector<char const*> sources;
+  for (auto const& blob_tree : header_tree["blobs"]) {
+    size_t offset = blob_tree["offset"].get<size_t>();
+    size_t size = blob_tree["size"].get<size_t>();
+    RETURN_ON_ASSERT(payload_offset + offset + size <= file_size,
+                     "The payloads of the dump are truncated: " + path);
+    ObjectID blob_id =
+        ObjectIDFromString(blob_tree["id"].get_ref<std::string const&>());
+    if (size == 0) {
+      object_id_map.emplace(blob_id, Blob::MakeEmpty(client)->id());
+      continue;
+    }
+    blob_ids.emplace_back(blob_id);
+    sizes.emplace_back(size);
+    sources.emplace_back(base + payload_offset + offset);
+  }
+  // either all of the blobs are created, or none of them is left behind
+  std::unique_ptr<BlobWriterGroup> writers;
+  RETURN_ON_ERROR(BlobWriterGroup::Make(client, sizes, writers));
+  for (size_t index = 0; index < writers->size(); ++index) {
+    object_id_map.emplace(blob_ids[index], writers->Writer(index)->id());
+  }
+
+  // the blobs are copied in chunks, so that a few large blobs (e.g., the
+  // edge lists of a fragment) are spread over all threads as well
+  struct Chunk {
+    size_t index;
+    size_t offset;
+    size_t size;
+  };
+  std::vector<Chunk> chunks;
+  for (size_t index = 0; index < writers->size(); ++index) {
+    size_t size = writers->Writer(index)->size();
+    for (size_t offset = 0; offset < size; offset += kDumpChunkSize) {
+      chunks.emplace_back(
+          Chunk{index, offset, std::min(kDumpChunkSize, size - offset)});
+    }
+  }
+  size_t thread_num = std::min<size_t>(
+      std::max<size_t>(std::thread::hardware_concurrency(), 1), chunks.size());
+  std::atomic<size_t> next_chunk(0);
+  std::vector<std::thread> workers;
+  for (size_t idx = 0; idx < thread_num; ++idx) {
+    workers.emplace_back([&]() {
+      size_t chunk_index = 0;
+      while ((chunk_index = next_chunk.fetch_add(1)) < chunks.size()) {
+        auto const& chunk = chunks[chunk_index];
+        memcpy(writers->Writer(chunk.index)->data() + chunk.offset,
+               sources[chunk.index] + chunk.offset, chunk.size);
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  mapped_guard.reset();
+  std::vector<std::shared_ptr<Blob>> blobs;
+  auto status = writers->Seal(client, blobs);
+  if (!status.ok()) {
+    VINEYARD_DISCARD(writers->Abort(client));
+  }
+  if (status.ok()) {
+    status =
+        restoreMeta(client, header_tree["meta"], object_id_map, object_id);
+  }
+  if (!status.ok()) {
+    // the sealed blobs are not referenced by any restored object
+    std::vector<ObjectID> sealed_ids;
+    for (auto const& blob : blobs) {
+      sealed_ids.emplace_back(blob->id());
+    }
+    VINEYARD_DISCARD(client.DelData(sealed_ids));
+  }
+  return status;
+}
+
+}  // namespace vineyard
@@ -0,0 +1,58 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_MIGRATE_OBJECT_DUMP_H_
+#define MODULES_MIGRATE_OBJECT_DUMP_H_
+
+#include <string>
+
+#include "client/client.h"
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief Dump an object, i.e., its metadata and the payloads of all of its
+ * blobs, to a local file, from which the object can be restored without
+ * being rebuilt from its sources, e.g., a sealed ArrowFragment after the
+ * cluster restarts.
+ *
+ * The file consists of a magic number, the length of the header, the header
+ * (a json of the metadata tree and the offset and size of each blob), and the
+ * payloads of the blobs, each of which starts at a page boundary thus can be
+ * mapped directly.
+ *
+ * All blobs of the object must be on the instance that the client connects
+ * to, the members of a global object are dumped on their own instances.
+ */
+Status DumpObject(Client& client, ObjectID const object_id,
+                  std::string const& path);
+
+/**
+ * @brief Restore an object from a file written by DumpObject. The file is
+ * memory-mapped and the blobs are filled from the mapped pages (served from
+ * the page cache when the file is hot) by a pool of threads, then the
+ * metadata tree is recreated with the ids of the new blobs, nothing is
+ * parsed or rebuilt.
+ *
+ * @param object_id The id of the restored object.
+ */
+Status RestoreObject(Client& client, std::string const& path,
+                     ObjectID& object_id);
+
+}  // namespace vineyard
+
+#endif  // MODULES_MIGRATE_OBJECT_DUMP_H_
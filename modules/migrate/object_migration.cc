@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "migrate/object_migration.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <limits>
 #include <map>
 #include <string>
@@ -32,6 +36,35 @@ namespace vineyard {
 namespace asio = boost::asio;
 using boost::asio::ip::tcp;
 
+static void writeMessage(tcp::socket& socket, std::string const& msg) {
+  size_t length = msg.size();
+  boost::asio::write(socket, asio::buffer(&length, sizeof(size_t)));
+  boost::asio::write(socket, asio::buffer(msg, msg.size()));
+}
+
+static json readMessage(tcp::socket& socket) {
+  size_t length;
+  std::string message_in;
+  boost::asio::read(socket, asio::buffer(&length, sizeof(size_t)));
+  message_in.resize(length);
+  boost::asio::read(socket, asio::buffer(&message_in[0], message_in.size()));
+  return json::parse(message_in);
+}
+
+static void reportProgress(std::string const& action, size_t const bytes,
+                           size_t const total,
+                           std::chrono::steady_clock::time_point const start) {
+  double const seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+  double const mb = static_cast<double>(bytes) / (1024 * 1024);
+  LOG(INFO) << "Migration: " << action << " " << mb << " MB of "
+            << static_cast<double>(total) / (1024 * 1024) << " MB ("
+            << (total == 0 ? 100 : bytes * 100 / total) << "%) in " << seconds
+            << "s, throughput " << (seconds > 0 ? mb / seconds : 0)
+            << " MB/s";
+}
+
 Status ObjectMigration::Migrate(
     std::unordered_map<InstanceID, InstanceID>& instance_map,
     std::unordered_map<ObjectID, InstanceID>& object_map, Client& client) {
@@ -54,30 +87,110 @@ Status ObjectMigration::Migrate(
     LOG(INFO) << "Start send object " << object_id;
     RETURN_ON_ERROR(sendObjectMeta(object_id, client, socket));
   }
+  RETURN_ON_ERROR(sendBlobs(client, endpoint, socket));
+  std::string message_exit;
+  WriteExitRequest(message_exit);
+  writeMessage(socket, message_exit);
+  return Status::OK();
+}
+
+Status ObjectMigration::sendBlobs(Client& client, tcp::endpoint const& endpoint,
+                                  tcp::socket& socket) {
+  struct Chunk {
+    size_t index;
+    size_t offset;
+    size_t size;
+  };
+
+  std::vector<ObjectID> blob_ids;
+  std::vector<size_t> blob_sizes;
+  std::vector<std::shared_ptr<Blob>> blobs;
   for (auto blob_id : blob_list_) {
     std::shared_ptr<Blob> target_blob =
         std::dynamic_pointer_cast<Blob>(client.GetObject(blob_id));
-    size_t remain_size = target_blob->size();
-    std::string message_out;
-    WriteSendBlobBufferRequest(blob_id, remain_size, message_out);
-    size_t length = message_out.size();
-    boost::asio::write(socket, asio::buffer(&length, sizeof(size_t)));
-    boost::asio::write(socket, asio::buffer(message_out, message_out.size()));
-    size_t offset = 0;
-    while (remain_size) {
-      size_t send_size =
-          remain_size < MAX_BUFFER_SIZE ? remain_size : MAX_BUFFER_SIZE;
-      boost::asio::write(socket,
-                         asio::buffer(target_blob->data() + offset, send_size));
-      remain_size -= send_size;
-      offset += send_size;
+    RETURN_ON_ASSERT(target_blob != nullptr,
+                     "Failed to get blob " + ObjectIDToString(blob_id));
+    blob_ids.emplace_back(blob_id);
+    blob_sizes.emplace_back(target_blob->allocated_size());
+    blobs.emplace_back(target_blob);
+  }
+
+  // the chunks of a blob are sent concurrently, and the small blobs are
+  // sent as a whole
+  size_t const chunk_size = std::max<size_t>(FLAGS_migration_chunk_size, 1);
+  std::vector<Chunk> chunks;
+  size_t total_size = 0;
+  for (size_t index = 0; index < blobs.size(); ++index) {
+    for (size_t offset = 0; offset < blob_sizes[index]; offset += chunk_size) {
+      size_t const size = std::min(chunk_size, blob_sizes[index] - offset);
+      chunks.emplace_back(Chunk{index, offset, size});
     }
+    total_size += blob_sizes[index];
   }
-  std::string message_exit;
-  WriteExitRequest(message_exit);
-  size_t length = message_exit.size();
-  boost::asio::write(socket, asio::buffer(&length, sizeof(size_t)));
-  boost::asio::write(socket, asio::buffer(message_exit, message_exit.size()));
+  size_t const connections =
+      std::min<size_t>(std::max<size_t>(FLAGS_migration_connections, 1),
+                       chunks.size());
+
+  std::string message_out;
+  WriteSendBlobsRequest(blob_ids, blob_sizes, connections, message_out);
+  writeMessage(socket, message_out);
+
+  auto start = std::chrono::steady_clock::now();
+  std::atomic<size_t> next_chunk(0), sent_size(0);
+  std::mutex mutex;
+  std::condition_variable finished_cv;
+  size_t finished = 0;
+  std::vector<Status> statuses(connections);
+  std::vector<std::thread> workers;
+  for (size_t idx = 0; idx < connections; ++idx) {
+    workers.emplace_back([&, idx]() {
+      try {
+        boost::asio::io_service io_service;
+        tcp::socket connection(io_service);
+        connection.connect(endpoint);
+        size_t chunk_index = 0;
+        while ((chunk_index = next_chunk.fetch_add(1)) < chunks.size()) {
+          auto const& chunk = chunks[chunk_index];
+          std::string message_chunk;
+          WriteSendBlobChunkRequest(blob_ids[chunk.index], chunk.offset,
+                                    chunk.size, message_chunk);
+          writeMessage(connection, message_chunk);
+          boost::asio::write(
+              connection,
+              asio::buffer(blobs[chunk.index]->data() + chunk.offset,
+                           chunk.size));
+          sent_size.fetch_add(chunk.size);
+        }
+        std::string message_exit;
+        WriteExitRequest(message_exit);
+        writeMessage(connection, message_exit);
+      } catch (boost::system::system_error const& e) {
+        statuses[idx] = Status::IOError(
+            "Failed to send blobs to the migration server: " +
+            std::string(e.what()));
+        // stop the other connections as early as possible
+        next_chunk.store(chunks.size());
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      finished += 1;
+      finished_cv.notify_all();
+    });
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!finished_cv.wait_for(lock, std::chrono::seconds(1), [&]() {
+      return finished == connections;
+    })) {
+      reportProgress("sent", sent_size.load(), total_size, start);
+    }
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  for (auto const& status : statuses) {
+    RETURN_ON_ERROR(status);
+  }
+  reportProgress("sent", sent_size.load(), total_size, start);
   return Status::OK();
 }
 
@@ -105,9 +218,7 @@ Status ObjectMigration::sendObjectMeta(ObjectID object_id, Client& client,
   if (object_list_.find(object_id) == object_list_.end()) {
     std::string msg;
     WriteSendObjectRequest(object_id, meta_tree, msg);
-    size_t length = msg.size();
-    boost::asio::write(socket, asio::buffer(&length, sizeof(size_t)));
-    boost::asio::write(socket, asio::buffer(msg, msg.size()));
+    writeMessage(socket, msg);
     object_list_.emplace(object_id);
   }
   return Status::OK();
@@ -138,12 +249,7 @@ Status MigrationServer::Start(Client& client) {
   acceptor.accept(socket);
   bool read_msg = true;
   while (read_msg) {
-    size_t length;
-    std::string message_in;
-    boost::asio::read(socket, asio::buffer(&length, sizeof(size_t)));
-    message_in.resize(length);
-    boost::asio::read(socket, asio::buffer(&message_in[0], message_in.size()));
-    json root = json::parse(message_in);
+    json root = readMessage(socket);
 
     std::string type = root["type"].get_ref<std::string const&>();
     MigrateActionType cmd = ParseMigrateAction(type);
@@ -176,6 +282,15 @@ Status MigrationServer::Start(Client& client) {
       auto buffer = buffer_writer->Seal(client);
       object_id_map_.emplace(blob_id, buffer->id());
     } break;
+    case MigrateActionType::SendBlobsRequest: {
+      std::vector<ObjectID> blob_ids;
+      std::vector<size_t> blob_sizes;
+      size_t connections = 0;
+      RETURN_ON_ERROR(
+          ReadSendBlobsRequest(root, blob_ids, blob_sizes, connections));
+      RETURN_ON_ERROR(receiveBlobs(client, io_service, acceptor, blob_ids,
+                                   blob_sizes, connections));
+    } break;
     case MigrateActionType::ExitRequest: {
       for (auto it = object_map_.begin(); it != object_map_.end(); it++) {
         ObjectID object_id;
@@ -204,6 +319,103 @@ Status MigrationServer::Start(Client& client) {
   return Status::OK();
 }
 
+Status MigrationServer::receiveBlobs(Client& client,
+                                     asio::io_service& io_service,
+                                     tcp::acceptor& acceptor,
+                                     std::vector<ObjectID> const& blob_ids,
+                                     std::vector<size_t> const& blob_sizes,
+                                     size_t const connections) {
+  struct PendingBlob {
+    size_t size;
+    size_t remaining;
+    std::unique_ptr<BlobWriter> writer;
+  };
+
+  std::unordered_map<ObjectID, PendingBlob> pending;
+  size_t total_size = 0;
+  for (size_t idx = 0; idx < blob_ids.size(); ++idx) {
+    if (blob_sizes[idx] == 0) {
+      object_id_map_.emplace(blob_ids[idx], Blob::MakeEmpty(client)->id());
+    } else {
+      pending[blob_ids[idx]] = PendingBlob{blob_sizes[idx], blob_sizes[idx]};
+    }
+    total_size += blob_sizes[idx];
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::atomic<size_t> received_size(0);
+  std::vector<Status> statuses(connections);
+  std::vector<std::thread> workers;
+  auto receive = [&](tcp::socket& connection) -> Status {
+    while (true) {
+      json root = readMessage(connection);
+      std::string const& type = root["type"].get_ref<std::string const&>();
+      MigrateActionType cmd = ParseMigrateAction(type);
+      if (cmd == MigrateActionType::ExitRequest) {
+        return Status::OK();
+      }
+      RETURN_ON_ASSERT(cmd == MigrateActionType::SendBlobChunkRequest,
+                       "Got unexpected command: " + type);
+      ObjectID blob_id;
+      size_t offset, size;
+      RETURN_ON_ERROR(ReadSendBlobChunkRequest(root, blob_id, offset, size));
+      BlobWriter* writer = nullptr;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto iter = pending.find(blob_id);
+        RETURN_ON_ASSERT(iter != pending.end(),
+                         "Unexpected blob " + ObjectIDToString(blob_id));
+        RETURN_ON_ASSERT(offset <= iter->second.size &&
+                             size <= iter->second.size - offset,
+                         "The chunk exceeds the blob");
+        // allocate the blob when its first chunk arrives
+        if (iter->second.writer == nullptr) {
+          RETURN_ON_ERROR(
+              client.CreateBlob(iter->second.size, iter->second.writer));
+        }
+        writer = iter->second.writer.get();
+      }
+      boost::asio::read(connection,
+                        asio::buffer(writer->data() + offset, size));
+      received_size.fetch_add(size);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto iter = pending.find(blob_id);
+        iter->second.remaining -= size;
+        if (iter->second.remaining == 0) {
+          auto buffer = iter->second.writer->Seal(client);
+          object_id_map_.emplace(blob_id, buffer->id());
+          pending.erase(iter);
+        }
+      }
+    }
+  };
+  for (size_t idx = 0; idx < connections; ++idx) {
+    auto connection = std::make_shared<tcp::socket>(io_service);
+    acceptor.accept(*connection);
+    workers.emplace_back([&, idx, connection]() {
+      try {
+        statuses[idx] = receive(*connection);
+      } catch (boost::system::system_error const& e) {
+        statuses[idx] = Status::IOError(
+            "Failed to receive blobs from the migration client: " +
+            std::string(e.what()));
+      } catch (std::exception const& e) {
+        statuses[idx] = Status::Invalid(e.what());
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  for (auto const& status : statuses) {
+    RETURN_ON_ERROR(status);
+  }
+  RETURN_ON_ASSERT(pending.empty(), "Some blobs haven't been received");
+  reportProgress("received", received_size.load(), total_size, start);
+  return Status::OK();
+}
+
 ObjectID MigrationServer::createObject(json& meta_tree, Client& client,
                                        bool persist) {
   InstanceID instance_id = meta_tree["instance_id"].get<InstanceID>();
@@ -17,6 +17,7 @@ limitations under the License.
 #define MODULES_MIGRATE_OBJECT_MIGRATION_H_
 
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <thread>
@@ -56,6 +57,13 @@ class ObjectMigration {
   Status sendObjectMeta(ObjectID object_id, Client& client,
                         tcp::socket& socket);
 
+  /**
+   * @brief Split the blobs into chunks, and send the chunks over a pool of
+   * connections to `endpoint` concurrently.
+   */
+  Status sendBlobs(Client& client, tcp::endpoint const& endpoint,
+                   tcp::socket& socket);
+
   void getBlobList(json& meta_tree);
 
   std::vector<ObjectID> object_ids_;
@@ -76,9 +84,21 @@ class MigrationServer {
  private:
   ObjectID createObject(json& meta, Client& client, bool persist);
 
+  /**
+   * @brief Accept the connections for the announced blobs, the blobs are
+   * allocated and written as their chunks arrive.
+   */
+  Status receiveBlobs(Client& client, asio::io_service& io_service,
+                      tcp::acceptor& acceptor,
+                      std::vector<ObjectID> const& blob_ids,
+                      std::vector<size_t> const& blob_sizes,
+                      size_t const connections);
+
   std::unordered_map<InstanceID, InstanceID> instance_map_;
   std::unordered_map<ObjectID, json> object_map_;
   std::unordered_map<ObjectID, ObjectID> object_id_map_;
+  // protects the `object_id_map_` when receiving blobs
+  std::mutex mutex_;
 };
 
 }  // namespace vineyard
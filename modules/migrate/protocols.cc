@@ -32,6 +32,10 @@ MigrateActionType ParseMigrateAction(const std::string& str_type) {
     return MigrateActionType::SendObjectRequest;
   } else if (str_type == "send_blob_buffer_request") {
     return MigrateActionType::SendBlobBufferRequest;
+  } else if (str_type == "send_blobs_request") {
+    return MigrateActionType::SendBlobsRequest;
+  } else if (str_type == "send_blob_chunk_request") {
+    return MigrateActionType::SendBlobChunkRequest;
   } else {
     return MigrateActionType::NullAction;
   }
@@ -88,4 +92,47 @@ Status ReadSendBlobBufferRequest(const json& root, ObjectID& blob_id,
   return Status::OK();
 }
 
+void WriteSendBlobsRequest(const std::vector<ObjectID>& blob_ids,
+                           const std::vector<size_t>& blob_sizes,
+                           const size_t connections, std::string& msg) {
+  json root;
+  root["type"] = "send_blobs_request";
+  root["blob_ids"] = blob_ids;
+  root["blob_sizes"] = blob_sizes;
+  root["connections"] = connections;
+  encode_msg(root, msg);
+}
+
+Status ReadSendBlobsRequest(const json& root, std::vector<ObjectID>& blob_ids,
+                            std::vector<size_t>& blob_sizes,
+                            size_t& connections) {
+  RETURN_ON_ASSERT(root["type"].get_ref<std::string const&>() ==
+                   "send_blobs_request");
+  blob_ids = root["blob_ids"].get<std::vector<ObjectID>>();
+  blob_sizes = root["blob_sizes"].get<std::vector<size_t>>();
+  connections = root["connections"].get<size_t>();
+  RETURN_ON_ASSERT(blob_ids.size() == blob_sizes.size());
+  return Status::OK();
+}
+
+void WriteSendBlobChunkRequest(const ObjectID blob_id, const size_t offset,
+                               const size_t size, std::string& msg) {
+  json root;
+  root["type"] = "send_blob_chunk_request";
+  root["blob_id"] = blob_id;
+  root["offset"] = offset;
+  root["size"] = size;
+  encode_msg(root, msg);
+}
+
+Status ReadSendBlobChunkRequest(const json& root, ObjectID& blob_id,
+                                size_t& offset, size_t& size) {
+  RETURN_ON_ASSERT(root["type"].get_ref<std::string const&>() ==
+                   "send_blob_chunk_request");
+  blob_id = root["blob_id"].get<ObjectID>();
+  offset = root["offset"].get<size_t>();
+  size = root["size"].get<size_t>();
+  return Status::OK();
+}
+
 }  // namespace vineyard
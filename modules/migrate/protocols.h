@@ -17,6 +17,7 @@ limitations under the License.
 #define MODULES_MIGRATE_PROTOCOLS_H_
 
 #include <string>
+#include <vector>
 
 #include "common/util/json.h"
 #include "common/util/status.h"
@@ -30,6 +31,8 @@ enum class MigrateActionType {
   ExitReply = 2,
   SendObjectRequest = 3,
   SendBlobBufferRequest = 4,
+  SendBlobsRequest = 5,
+  SendBlobChunkRequest = 6,
 };
 
 MigrateActionType ParseMigrateAction(const std::string& str_type);
@@ -50,6 +53,27 @@ void WriteSendBlobBufferRequest(const ObjectID blob_id, const size_t blob_size,
 Status ReadSendBlobBufferRequest(const json& root, ObjectID& blob_id,
                                  size_t& blob_size);
 
+/**
+ * @brief Announce the blobs to migrate, whose content will be sent in chunks
+ * over `connections` extra connections, see also `SendBlobChunkRequest`.
+ */
+void WriteSendBlobsRequest(const std::vector<ObjectID>& blob_ids,
+                           const std::vector<size_t>& blob_sizes,
+                           const size_t connections, std::string& msg);
+
+Status ReadSendBlobsRequest(const json& root, std::vector<ObjectID>& blob_ids,
+                            std::vector<size_t>& blob_sizes,
+                            size_t& connections);
+
+/**
+ * @brief The `size` bytes of the blob at `offset` follow the request.
+ */
+void WriteSendBlobChunkRequest(const ObjectID blob_id, const size_t offset,
+                               const size_t size, std::string& msg);
+
+Status ReadSendBlobChunkRequest(const json& root, ObjectID& blob_id,
+                                size_t& offset, size_t& size);
+
 }  // namespace vineyard
 
 #endif  // MODULES_MIGRATE_PROTOCOLS_H_
@@ -0,0 +1,271 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "migrate/rdma.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+
+#include "common/util/logging.h"
+
+namespace vineyard {
+
+#if defined(WITH_RDMA)
+
+// the max number of outstanding reads
+static constexpr int kQueueDepth = 16;
+
+// the max size of a single read request
+static constexpr size_t kMaxReadSize = 1UL << 30;
+
+RDMAEndpoint::RDMAEndpoint() { memset(&local_, 0, sizeof(Address)); }
+
+RDMAEndpoint::~RDMAEndpoint() {
+  for (auto& region : regions_) {
+    ibv_dereg_mr(region.second);
+  }
+  if (qp_ != nullptr) {
+    ibv_destroy_qp(qp_);
+  }
+  if (cq_ != nullptr) {
+    ibv_destroy_cq(cq_);
+  }
+  if (pd_ != nullptr) {
+    ibv_dealloc_pd(pd_);
+  }
+  if (context_ != nullptr) {
+    ibv_close_device(context_);
+  }
+}
+
+Status RDMAEndpoint::Make(const std::string& device, int const gid_index,
+                          std::unique_ptr<RDMAEndpoint>& endpoint) {
+  std::unique_ptr<RDMAEndpoint> ep(new RDMAEndpoint());
+  int num_devices = 0;
+  struct ibv_device** devices = ibv_get_device_list(&num_devices);
+  if (devices == nullptr || num_devices == 0) {
+    if (devices != nullptr) {
+      ibv_free_device_list(devices);
+    }
+    return Status::IOError("No RDMA device is found");
+  }
+  struct ibv_device* target = nullptr;
+  for (int idx = 0; idx < num_devices; ++idx) {
+    if (device.empty() || device == ibv_get_device_name(devices[idx])) {
+      target = devices[idx];
+      break;
+    }
+  }
+  if (target != nullptr) {
+    ep->context_ = ibv_open_device(target);
+  }
+  ibv_free_device_list(devices);
+  if (ep->context_ == nullptr) {
+    return Status::IOError("Failed to open the RDMA device '" + device + "'");
+  }
+
+  ep->gid_index_ = gid_index;
+  struct ibv_port_attr port_attr;
+  if (ibv_query_port(ep->context_, ep->port_, &port_attr) != 0) {
+    return Status::IOError("Failed to query the RDMA port");
+  }
+  ep->mtu_ = port_attr.active_mtu;
+  union ibv_gid gid;
+  if (ibv_query_gid(ep->context_, ep->port_, ep->gid_index_, &gid) != 0) {
+    return Status::IOError("Failed to query the GID of the RDMA port");
+  }
+
+  ep->pd_ = ibv_alloc_pd(ep->context_);
+  if (ep->pd_ == nullptr) {
+    return Status::IOError("Failed to allocate the RDMA protection domain");
+  }
+  ep->cq_ = ibv_create_cq(ep->context_, kQueueDepth, nullptr, nullptr, 0);
+  if (ep->cq_ == nullptr) {
+    return Status::IOError("Failed to create the RDMA completion queue");
+  }
+  struct ibv_qp_init_attr init_attr;
+  memset(&init_attr, 0, sizeof(init_attr));
+  init_attr.send_cq = ep->cq_;
+  init_attr.recv_cq = ep->cq_;
+  init_attr.qp_type = IBV_QPT_RC;
+  init_attr.cap.max_send_wr = kQueueDepth;
+  init_attr.cap.max_recv_wr = 1;
+  init_attr.cap.max_send_sge = 1;
+  init_attr.cap.max_recv_sge = 1;
+  ep->qp_ = ibv_create_qp(ep->pd_, &init_attr);
+  if (ep->qp_ == nullptr) {
+    return Status::IOError("Failed to create the RDMA queue pair");
+  }
+
+  struct ibv_qp_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_INIT;
+  attr.pkey_index = 0;
+  attr.port_num = ep->port_;
+  attr.qp_access_flags = IBV_ACCESS_REMOTE_READ;
+  if (ibv_modify_qp(ep->qp_, &attr,
+                    IBV_QP_STATE | IBV_QP_PKEY_INDEX | IBV_QP_PORT |
+                        IBV_QP_ACCESS_FLAGS) != 0) {
+    return Status::IOError("Failed to initialize the RDMA queue pair");
+  }
+
+  std::random_device rd;
+  ep->local_.valid = 1;
+  ep->local_.qpn = ep->qp_->qp_num;
+  ep->local_.psn = rd() & 0xffffff;
+  ep->local_.lid = port_attr.lid;
+  memcpy(ep->local_.gid, gid.raw, sizeof(ep->local_.gid));
+  endpoint = std::move(ep);
+  return Status::OK();
+}
+
+Status RDMAEndpoint::Connect(const Address& remote) {
+  RETURN_ON_ASSERT(remote.valid, "RDMA is not available on the peer");
+  struct ibv_qp_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_RTR;
+  attr.path_mtu = mtu_;
+  attr.dest_qp_num = remote.qpn;
+  attr.rq_psn = remote.psn;
+  attr.max_dest_rd_atomic = kQueueDepth;
+  attr.min_rnr_timer = 12;
+  // RoCE requires the global routing header
+  attr.ah_attr.is_global = 1;
+  memcpy(attr.ah_attr.grh.dgid.raw, remote.gid, sizeof(remote.gid));
+  attr.ah_attr.grh.sgid_index = gid_index_;
+  attr.ah_attr.grh.hop_limit = 1;
+  attr.ah_attr.dlid = remote.lid;
+  attr.ah_attr.port_num = port_;
+  if (ibv_modify_qp(qp_, &attr,
+                    IBV_QP_STATE | IBV_QP_AV | IBV_QP_PATH_MTU |
+                        IBV_QP_DEST_QPN | IBV_QP_RQ_PSN |
+                        IBV_QP_MAX_DEST_RD_ATOMIC |
+                        IBV_QP_MIN_RNR_TIMER) != 0) {
+    return Status::IOError("Failed to move the RDMA queue pair to RTR");
+  }
+
+  memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_RTS;
+  attr.timeout = 14;
+  attr.retry_cnt = 7;
+  attr.rnr_retry = 7;
+  attr.sq_psn = local_.psn;
+  attr.max_rd_atomic = kQueueDepth;
+  if (ibv_modify_qp(qp_, &attr,
+                    IBV_QP_STATE | IBV_QP_TIMEOUT | IBV_QP_RETRY_CNT |
+                        IBV_QP_RNR_RETRY | IBV_QP_SQ_PSN |
+                        IBV_QP_MAX_QP_RD_ATOMIC) != 0) {
+    return Status::IOError("Failed to move the RDMA queue pair to RTS");
+  }
+  return Status::OK();
+}
+
+Status RDMAEndpoint::Register(const uintptr_t base, size_t const size,
+                              uint32_t& lkey, uint32_t& rkey) {
+  auto iter = regions_.find(base);
+  if (iter == regions_.end() || iter->second->length < size) {
+    struct ibv_mr* mr =
+        ibv_reg_mr(pd_, reinterpret_cast<void*>(base), size,
+                   IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_READ);
+    if (mr == nullptr) {
+      return Status::IOError("Failed to register the memory region: " +
+                             std::string(strerror(errno)));
+    }
+    if (iter != regions_.end()) {
+      ibv_dereg_mr(iter->second);
+      iter->second = mr;
+    } else {
+      iter = regions_.emplace(base, mr).first;
+    }
+  }
+  lkey = iter->second->lkey;
+  rkey = iter->second->rkey;
+  return Status::OK();
+}
+
+Status RDMAEndpoint::Read(uint8_t* local, uint32_t const lkey,
+                          Region const& remote, size_t const size) {
+  size_t offset = 0;
+  int outstanding = 0;
+  while (offset < size || outstanding > 0) {
+    while (offset < size && outstanding < kQueueDepth) {
+      size_t const length = std::min(size - offset, kMaxReadSize);
+      struct ibv_sge sge;
+      sge.addr = reinterpret_cast<uint64_t>(local + offset);
+      sge.length = static_cast<uint32_t>(length);
+      sge.lkey = lkey;
+      struct ibv_send_wr wr, *bad_wr = nullptr;
+      memset(&wr, 0, sizeof(wr));
+      wr.wr_id = offset;
+      wr.sg_list = &sge;
+      wr.num_sge = 1;
+      wr.opcode = IBV_WR_RDMA_READ;
+      wr.send_flags = IBV_SEND_SIGNALED;
+      wr.wr.rdma.remote_addr = remote.address + offset;
+      wr.wr.rdma.rkey = remote.rkey;
+      if (ibv_post_send(qp_, &wr, &bad_wr) != 0) {
+        return Status::IOError("Failed to post the RDMA read request");
+      }
+      offset += length;
+      outstanding += 1;
+    }
+    struct ibv_wc wcs[kQueueDepth];
+    int completed = ibv_poll_cq(cq_, kQueueDepth, wcs);
+    if (completed < 0) {
+      return Status::IOError("Failed to poll the RDMA completion queue");
+    }
+    for (int idx = 0; idx < completed; ++idx) {
+      if (wcs[idx].status != IBV_WC_SUCCESS) {
+        return Status::IOError("The RDMA read failed: " +
+                               std::string(ibv_wc_status_str(wcs[idx].status)));
+      }
+    }
+    outstanding -= completed;
+  }
+  return Status::OK();
+}
+
+#else
+
+RDMAEndpoint::RDMAEndpoint() { memset(&local_, 0, sizeof(Address)); }
+
+RDMAEndpoint::~RDMAEndpoint() {}
+
+Status RDMAEndpoint::Make(const std::string&, int const,
+                          std::unique_ptr<RDMAEndpoint>&) {
+  return Status::NotImplemented("vineyard is built without RDMA support");
+}
+
+Status RDMAEndpoint::Connect(const Address&) {
+  return Status::NotImplemented("vineyard is built without RDMA support");
+}
+
+Status RDMAEndpoint::Register(const uintptr_t, size_t const, uint32_t&,
+                              uint32_t&) {
+  return Status::NotImplemented("vineyard is built without RDMA support");
+}
+
+Status RDMAEndpoint::Read(uint8_t*, uint32_t const, Region const&,
+                          size_t const) {
+  return Status::NotImplemented("vineyard is built without RDMA support");
+}
+
+#endif  // WITH_RDMA
+
+}  // namespace vineyard
@@ -0,0 +1,113 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef MODULES_MIGRATE_RDMA_H_
+#define MODULES_MIGRATE_RDMA_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+#if defined(WITH_RDMA)
+#include "infiniband/verbs.h"
+#endif
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief RDMAEndpoint is a reliable-connected queue pair between two
+ * migration peers, over which the blob payloads are pulled with one-sided
+ * RDMA reads, bypassing the kernel and the CPU of the sender.
+ *
+ * The memory-mapped segments of the local vineyardd are registered as memory
+ * regions on first use, and the registrations are kept until the endpoint
+ * is destroyed.
+ */
+class RDMAEndpoint {
+ public:
+  /**
+   * @brief The address of an endpoint, exchanged out-of-band with the peer
+   * before connecting. `valid` is 0 when RDMA is unavailable on the peer.
+   */
+  struct Address {
+    uint32_t valid;
+    uint32_t qpn;
+    uint32_t psn;
+    uint16_t lid;
+    uint8_t gid[16];
+  };
+
+  /**
+   * @brief A piece of remote memory that can be read by the peer.
+   */
+  struct Region {
+    uint64_t address;
+    uint32_t rkey;
+  };
+
+  ~RDMAEndpoint();
+
+  /**
+   * @brief Open the RDMA device, the first device will be used if `device`
+   * is empty. Fails when built without ibverbs or no device is available.
+   */
+  static Status Make(const std::string& device, int const gid_index,
+                     std::unique_ptr<RDMAEndpoint>& endpoint);
+
+  const Address& LocalAddress() const { return local_; }
+
+  /**
+   * @brief Connect the queue pair to the remote endpoint.
+   */
+  Status Connect(const Address& remote);
+
+  /**
+   * @brief Register the memory segment `[base, base + size)`, returns the
+   * local and remote keys of the memory region.
+   */
+  Status Register(const uintptr_t base, size_t const size, uint32_t& lkey,
+                  uint32_t& rkey);
+
+  /**
+   * @brief Read `size` bytes from the remote region to `local`, which must
+   * lie in a registered memory region with key `lkey`.
+   */
+  Status Read(uint8_t* local, uint32_t const lkey, Region const& remote,
+              size_t const size);
+
+ private:
+  RDMAEndpoint();
+
+  Address local_;
+
+#if defined(WITH_RDMA)
+  uint8_t port_ = 1;
+  int gid_index_ = 0;
+  enum ibv_mtu mtu_ = IBV_MTU_1024;
+  struct ibv_context* context_ = nullptr;
+  struct ibv_pd* pd_ = nullptr;
+  struct ibv_cq* cq_ = nullptr;
+  struct ibv_qp* qp_ = nullptr;
+  // registered segments, indexed by the base address
+  std::map<uintptr_t, struct ibv_mr*> regions_;
+#endif
+};
+
+}  // namespace vineyard
+
+#endif  // MODULES_MIGRATE_RDMA_H_
@@ -0,0 +1,147 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+#include "migrate/object_dump.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// A wrapper of a few blobs (crossing the page and the copying chunk
+// boundaries, and an empty one) and a nested wrapper is dumped, and then
+// restored with new ids and the same contents.
+
+constexpr size_t kSizes[] = {1, 4097, 4 * 1024 * 1024 + 7};
+
+static char content(size_t const blob, size_t const offset) {
+  return static_cast<char>((blob * 17 + offset) % 253);
+}
+
+static std::shared_ptr<Blob> makeBlob(Client& client, size_t const blob) {
+  std::unique_ptr<BlobWriter> writer;
+  VINEYARD_CHECK_OK(client.CreateBlob(kSizes[blob], writer));
+  for (size_t i = 0; i < kSizes[blob]; ++i) {
+    writer->data()[i] = content(blob, i);
+  }
+  return std::dynamic_pointer_cast<Blob>(writer->Seal(client));
+}
+
+static void checkBlob(ObjectMeta const& meta, std::string const& name,
+                      ObjectID const origin, size_t const blob) {
+  auto member = std::dynamic_pointer_cast<Blob>(meta.GetMember(name));
+  CHECK(member != nullptr);
+  CHECK_NE(member->id(), origin);
+  CHECK_EQ(member->allocated_size(), kSizes[blob]);
+  for (size_t i = 0; i < kSizes[blob]; ++i) {
+    CHECK_EQ(member->data()[i], content(blob, i));
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./object_dump_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  std::string path =
+      "/tmp/vineyard_object_dump_test_" + std::to_string(getpid());
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  std::vector<std::shared_ptr<Blob>> blobs;
+  for (size_t blob = 0; blob < sizeof(kSizes) / sizeof(kSizes[0]); ++blob) {
+    blobs.emplace_back(makeBlob(client, blob));
+  }
+
+  ObjectMeta nested;
+  nested.SetTypeName("vineyard::test::Nested");
+  nested.SetNBytes(kSizes[2]);
+  nested.AddKeyValue("value", "nested");
+  nested.AddMember("buffer", blobs[2]->id());
+  ObjectID nested_id = InvalidObjectID();
+  VINEYARD_CHECK_OK(client.CreateMetaData(nested, nested_id));
+
+  ObjectMeta wrapper;
+  wrapper.SetTypeName("vineyard::test::Wrapper");
+  wrapper.SetNBytes(kSizes[0] + kSizes[1]);
+  wrapper.AddKeyValue("value", "wrapper");
+  wrapper.AddMember("buffer_0", blobs[0]->id());
+  wrapper.AddMember("buffer_1", blobs[1]->id());
+  wrapper.AddMember("empty", Blob::MakeEmpty(client)->id());
+  wrapper.AddMember("nested", nested_id);
+  ObjectID wrapper_id = InvalidObjectID();
+  VINEYARD_CHECK_OK(client.CreateMetaData(wrapper, wrapper_id));
+
+  VINEYARD_CHECK_OK(DumpObject(client, wrapper_id, path));
+  ObjectID restored_id = InvalidObjectID();
+  VINEYARD_CHECK_OK(RestoreObject(client, path, restored_id));
+  CHECK_NE(restored_id, wrapper_id);
+
+  {
+    ObjectMeta restored;
+    VINEYARD_CHECK_OK(client.GetMetaData(restored_id, restored));
+    CHECK_EQ(restored.GetTypeName(), "vineyard::test::Wrapper");
+    CHECK_EQ(restored.GetKeyValue("value"), "wrapper");
+    checkBlob(restored, "buffer_0", blobs[0]->id(), 0);
+    checkBlob(restored, "buffer_1", blobs[1]->id(), 1);
+    CHECK_EQ(restored.GetMemberMeta("empty").GetId(), EmptyBlobID());
+    ObjectMeta restored_nested = restored.GetMemberMeta("nested");
+    CHECK_NE(restored_nested.GetId(), nested_id);
+    CHECK_EQ(restored_nested.GetKeyValue("value"), "nested");
+    checkBlob(restored_nested, "buffer", blobs[2]->id(), 2);
+  }
+  LOG(INFO) << "Passed dump and restore round-trip tests...";
+
+  // a truncated dump is rejected, without creating any object
+  {
+    std::ifstream input(path, std::ios::binary);
+    std::string dumped((std::istreambuf_iterator<char>(input)),
+                       std::istreambuf_iterator<char>());
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output.write(dumped.data(), dumped.size() - kSizes[2]);
+  }
+  ObjectID truncated_id = InvalidObjectID();
+  CHECK(!RestoreObject(client, path, truncated_id).ok());
+  CHECK_EQ(truncated_id, InvalidObjectID());
+  std::remove(path.c_str());
+  LOG(INFO) << "Passed restoring truncated dump tests...";
+
+  VINEYARD_CHECK_OK(client.DelData(restored_id, true, true));
+  VINEYARD_CHECK_OK(client.DelData(wrapper_id, true, true));
+  bool exists = true;
+  VINEYARD_CHECK_OK(client.Exists(restored_id, exists));
+  CHECK(!exists);
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,128 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+#include "migrate/flags.h"
+#include "migrate/object_migration.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The blobs are split into small chunks that are sent over a few
+// connections at the same time, thus the chunks of the large blobs arrive
+// out of order and are written in place by the receiver.
+
+constexpr size_t kChunkSize = 1024 * 1024;
+constexpr size_t kConnections = 3;
+constexpr size_t kSizes[] = {1, 4097, kChunkSize, kChunkSize + 1,
+                             9 * kChunkSize + 17};
+constexpr size_t kBlobs = sizeof(kSizes) / sizeof(kSizes[0]);
+
+static char content(size_t const blob, size_t const offset) {
+  return static_cast<char>((blob * 7 + offset) % 241);
+}
+
+static uint64_t findPort() {
+  asio::io_service io_service;
+  tcp::acceptor acceptor(io_service, tcp::endpoint(tcp::v4(), 0));
+  return acceptor.local_endpoint().port();
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage ./object_migration_test <ipc_socket> <ipc_socket_1>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  std::string ipc_socket_1 = std::string(argv[2]);
+
+  FLAGS_migration_port = findPort();
+  FLAGS_migration_chunk_size = kChunkSize;
+  FLAGS_migration_connections = kConnections;
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  Client client1;
+  VINEYARD_CHECK_OK(client1.Connect(ipc_socket_1));
+  LOG(INFO) << "Connected to IPCServers: " << ipc_socket << ", "
+            << ipc_socket_1;
+
+  ObjectMeta meta;
+  meta.SetTypeName("vineyard::test::ChunkedWrapper");
+  size_t nbytes = 0;
+  for (size_t blob = 0; blob < kBlobs; ++blob) {
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(kSizes[blob], writer));
+    for (size_t i = 0; i < kSizes[blob]; ++i) {
+      writer->data()[i] = content(blob, i);
+    }
+    meta.AddMember("buffer_" + std::to_string(blob), writer->Seal(client));
+    nbytes += kSizes[blob];
+  }
+  meta.SetNBytes(nbytes);
+  ObjectID id = InvalidObjectID();
+  VINEYARD_CHECK_OK(client.CreateMetaData(meta, id));
+
+  std::unordered_map<InstanceID, InstanceID> instance_map{
+      {client.instance_id(), client1.instance_id()}};
+  std::thread receiver([&]() {
+    MigrationServer server(instance_map);
+    VINEYARD_CHECK_OK(server.Start(client1));
+  });
+  // wait for the receiver to listen
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+  {
+    std::unordered_map<ObjectID, InstanceID> object_map;
+    ObjectMigration sender({id}, client);
+    VINEYARD_CHECK_OK(sender.Migrate(instance_map, object_map, client));
+  }
+  receiver.join();
+
+  auto migrated = client1.ListObjectMeta("vineyard::test::ChunkedWrapper");
+  CHECK_EQ(migrated.size(), 1U);
+  CHECK_NE(migrated[0].GetId(), id);
+  CHECK_EQ(migrated[0].GetInstanceId(), client1.instance_id());
+  for (size_t blob = 0; blob < kBlobs; ++blob) {
+    auto member = std::dynamic_pointer_cast<Blob>(
+        migrated[0].GetMember("buffer_" + std::to_string(blob)));
+    CHECK(member != nullptr);
+    CHECK_EQ(member->allocated_size(), kSizes[blob]);
+    for (size_t i = 0; i < kSizes[blob]; ++i) {
+      CHECK_EQ(member->data()[i], content(blob, i));
+    }
+  }
+  LOG(INFO) << "Passed chunked object migration tests...";
+
+  VINEYARD_CHECK_OK(client1.DelData(migrated[0].GetId(), true, true));
+  VINEYARD_CHECK_OK(client.DelData(id, true, true));
+
+  client1.Disconnect();
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,54 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <signal.h>
+
+#include <iostream>
+
+#include "client/client.h"
+#include "common/util/flags.h"
+#include "common/util/logging.h"
+#include "migrate/flags.h"
+#include "migrate/object_dump.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char* argv[]) {
+  sigset(SIGINT, SIG_DFL);
+  FLAGS_stderrthreshold = 0;
+  flags::SetUsageMessage(
+      "Usage: vineyard_dump --ipc_socket=<socket> --dump_file=<file> "
+      "[--object_list=<object id> | --restore]");
+  flags::ParseCommandLineFlags(&argc, &argv, true);
+  logging::InitGoogleLogging("vineyard_dump");
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(FLAGS_ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << FLAGS_ipc_socket;
+
+  if (FLAGS_restore) {
+    ObjectID object_id = InvalidObjectID();
+    VINEYARD_CHECK_OK(RestoreObject(client, FLAGS_dump_file, object_id));
+    LOG(INFO) << "Restored object " << ObjectIDToString(object_id) << " from "
+              << FLAGS_dump_file;
+    std::cout << ObjectIDToString(object_id) << std::endl;
+  } else {
+    ObjectID object_id = ObjectIDFromString(FLAGS_object_list);
+    VINEYARD_CHECK_OK(DumpObject(client, object_id, FLAGS_dump_file));
+    LOG(INFO) << "Dumped object " << ObjectIDToString(object_id) << " to "
+              << FLAGS_dump_file;
+  }
+  return 0;
+}
@@ -13,11 +13,17 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <limits>
 #include <map>
+#include <memory>
+#include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "boost/asio.hpp"
 #include "gflags/gflags.h"
@@ -25,10 +31,13 @@ limitations under the License.
 #include "client/client.h"
 #include "client/ds/blob.h"
 #include "client/rpc_client.h"
+#include "common/memory/memcpy.h"
 #include "common/util/boost.h"
+#include "common/util/checksum.h"
 #include "common/util/flags.h"
 #include "common/util/logging.h"
 #include "common/util/status.h"
+#include "migrate/rdma.h"
 
 namespace vineyard {
 
@@ -47,6 +56,109 @@ DEFINE_string(
 DEFINE_string(id, ObjectIDToString(InvalidObjectID()),
               "Object to migrate to local");
 DEFINE_bool(local_copy, false, "Make a copy of blobs even on the same machine");
+DEFINE_bool(rdma, false,
+            "Pull blob payloads with one-sided RDMA reads when available");
+DEFINE_string(rdma_device, "",
+              "RDMA device used for migration, the first one if empty");
+DEFINE_int32(rdma_gid_index, 0, "GID index of the RDMA port");
+DEFINE_bool(co_located_copy, true,
+            "Copy the blobs of the instances on the same host between their "
+            "shared memory directly, rather than over the socket");
+DEFINE_string(manifest, "",
+              "Manifest of the blobs that have been migrated, to let a retried "
+              "migration skip them, defaults to a file next to the IPC socket");
+
+// requests the sizes and checksums of blobs, rather than the content, which
+// isn't a blob id, thus never collides with the request of a blob, nor with
+// the `InvalidObjectID()` that ends the migration
+static constexpr ObjectID kManifestRequest = 0x7fffffffffffffffUL;
+
+struct BlobDigest {
+  uint64_t size;
+  uint64_t checksum;
+
+  bool operator==(BlobDigest const& other) const {
+    return size == other.size && checksum == other.checksum;
+  }
+};
+
+/**
+ * @brief A blob that has landed on the local instance, recorded in the
+ * manifest as "<remote blob> <size> <checksum> <local blob>" lines.
+ */
+struct ManifestEntry {
+  BlobDigest digest;
+  ObjectID local_id;
+};
+
+static std::string manifest_path(InstanceID const remote_instance_id) {
+  if (!FLAGS_manifest.empty()) {
+    return FLAGS_manifest;
+  }
+  std::string directory = FLAGS_ipc_socket;
+  size_t pos = directory.find_last_of('/');
+  directory = pos == std::string::npos ? "." : directory.substr(0, pos);
+  return directory + "/migrate-" + FLAGS_id + "-" +
+         std::to_string(remote_instance_id) + ".manifest";
+}
+
+static void load_manifest(std::string const& path,
+                          std::map<ObjectID, ManifestEntry>& entries) {
+  std::ifstream manifest(path);
+  std::string remote_id, local_id;
+  ManifestEntry entry;
+  while (manifest >> remote_id >> entry.digest.size >> entry.digest.checksum >>
+         local_id) {
+    entry.local_id = ObjectIDFromString(local_id);
+    entries[ObjectIDFromString(remote_id)] = entry;
+  }
+}
+
+/**
+ * @brief Whether the blob recorded in the manifest is still intact on the
+ * local instance.
+ */
+static bool reuse_blob(Client& client, ManifestEntry const& entry,
+                       std::shared_ptr<Blob>& blob) {
+  if (!client.GetObject<Blob>(entry.local_id, blob).ok() || blob == nullptr ||
+      blob->allocated_size() != entry.digest.size) {
+    return false;
+  }
+  return Checksum(blob->data(), blob->allocated_size()) ==
+         entry.digest.checksum;
+}
+
+/**
+ * @brief Open the RDMA endpoint and exchange the addresses with the peer
+ * over the TCP connection. Both peers fall back to TCP (with `endpoint`
+ * being nullptr) unless RDMA is enabled and available on both sides.
+ */
+static Status connect_rdma_endpoint(asio::ip::tcp::socket& socket,
+                                    std::unique_ptr<RDMAEndpoint>& endpoint) {
+  RDMAEndpoint::Address local, remote;
+  memset(&local, 0, sizeof(RDMAEndpoint::Address));
+  if (FLAGS_rdma) {
+    auto status =
+        RDMAEndpoint::Make(FLAGS_rdma_device, FLAGS_rdma_gid_index, endpoint);
+    if (status.ok()) {
+      local = endpoint->LocalAddress();
+    } else {
+      LOG(WARNING) << "RDMA is unavailable, fallback to TCP: "
+                   << status.ToString();
+    }
+  }
+  asio::write(socket, asio::buffer(&local, sizeof(RDMAEndpoint::Address)));
+  asio::read(socket, asio::buffer(&remote, sizeof(RDMAEndpoint::Address)));
+  if (!local.valid || !remote.valid) {
+    endpoint.reset();
+    return Status::OK();
+  }
+  auto status = endpoint->Connect(remote);
+  if (!status.ok()) {
+    endpoint.reset();
+  }
+  return status;
+}
 
 static void find_blobs_on_remote_instance(const InstanceID remote_instance_id,
                                           const json& tree,
@@ -73,7 +185,105 @@ static void find_blobs_on_remote_instance(const InstanceID remote_instance_id,
   }
 }
 
+static void find_blob_owners(const json& tree,
+                             std::map<ObjectID, InstanceID>& owners) {
+  if (tree.empty()) {
+    return;
+  }
+  ObjectID member_id =
+      ObjectIDFromString(tree["id"].get_ref<std::string const&>());
+  if (IsBlob(member_id)) {
+    owners.emplace(member_id, tree["instance_id"].get<InstanceID>());
+  } else {
+    for (auto& item : tree) {
+      if (item.is_object()) {
+        find_blob_owners(item, owners);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Copy the blobs whose owners run on the same host, i.e., on the same
+ * node and the IPC sockets of them are reachable, by mapping the shared
+ * memory of the owners and copying with `concurrent_memcpy`, bypassing the
+ * sockets entirely. The copied blobs are removed from `blobs`, and the rest
+ * are left to be migrated over the socket.
+ */
+static Status copy_co_located_blobs(
+    Client& client, const json& tree, std::set<ObjectID>& blobs,
+    std::map<ObjectID, std::shared_ptr<Blob>>& target_blobs) {
+  std::map<ObjectID, InstanceID> owners;
+  find_blob_owners(tree, owners);
+  std::map<InstanceID, json> cluster;
+  RETURN_ON_ERROR(client.ClusterInfo(cluster));
+  auto self = cluster.find(client.instance_id());
+  if (self == cluster.end()) {
+    return Status::OK();
+  }
+  std::string const nodename = self->second.value("nodename", "");
+
+  // the clients of the co-located owners, nullptr if the owner is not
+  // reachable from here
+  std::map<InstanceID, std::unique_ptr<Client>> sources;
+  auto source_of = [&](InstanceID const instance_id) -> Client* {
+    if (instance_id == client.instance_id()) {
+      return &client;
+    }
+    auto iter = sources.find(instance_id);
+    if (iter != sources.end()) {
+      return iter->second.get();
+    }
+    std::unique_ptr<Client> source;
+    auto instance = cluster.find(instance_id);
+    if (instance != cluster.end() &&
+        instance->second.value("nodename", "") == nodename) {
+      source.reset(new Client());
+      if (!source->Connect(instance->second.value("ipc_socket", "")).ok() ||
+          source->instance_id() != instance_id) {
+        source.reset();
+      }
+    }
+    return sources.emplace(instance_id, std::move(source))
+        .first->second.get();
+  };
+
+  for (auto iter = blobs.begin(); iter != blobs.end();) {
+    ObjectID const blob_id = *iter;
+    auto owner = owners.find(blob_id);
+    Client* source = nullptr;
+    if (blob_id != EmptyBlobID() && owner != owners.end()) {
+      source = source_of(owner->second);
+    }
+    std::shared_ptr<Blob> blob;
+    if (source == nullptr || !source->GetObject<Blob>(blob_id, blob).ok()) {
+      ++iter;
+      continue;
+    }
+    if (blob->size() == 0) {
+      target_blobs.emplace(blob_id, Blob::MakeEmpty(client));
+    } else {
+      std::unique_ptr<BlobWriter> buffer;
+      RETURN_ON_ERROR(client.CreateBlob(blob->size(), buffer));
+      VLOG(10) << "Copying blob payload of size " << blob->size()
+               << " from the co-located instance " << owner->second;
+      memory::concurrent_memcpy(buffer->data(), blob->data(), blob->size());
+      target_blobs.emplace(
+          blob_id, std::dynamic_pointer_cast<Blob>(buffer->Seal(client)));
+    }
+    iter = blobs.erase(iter);
+  }
+  for (auto& source : sources) {
+    if (source.second != nullptr) {
+      source.second->Disconnect();
+    }
+  }
+  return Status::OK();
+}
+
 Status Serve(Client& client, asio::ip::tcp::socket&& socket) {
+  std::unique_ptr<RDMAEndpoint> endpoint;
+  RETURN_ON_ERROR(connect_rdma_endpoint(socket, endpoint));
   while (true) {
     ObjectID blob_to_send = InvalidObjectID();
     asio::read(socket, asio::buffer(&blob_to_send, sizeof(ObjectID)));
@@ -82,13 +292,65 @@ Status Serve(Client& client, asio::ip::tcp::socket&& socket) {
       LOG(INFO) << "The server finishes its job, exit normally";
       return Status::OK();
     }
+    if (blob_to_send == kManifestRequest) {
+      uint64_t count = 0;
+      asio::read(socket, asio::buffer(&count, sizeof(uint64_t)));
+      std::vector<ObjectID> blob_ids(count);
+      asio::read(socket, asio::buffer(blob_ids.data(),
+                                      count * sizeof(ObjectID)));
+      std::vector<BlobDigest> digests(count, BlobDigest{0, Checksum("", 0)});
+      for (uint64_t idx = 0; idx < count; ++idx) {
+        if (blob_ids[idx] != EmptyBlobID()) {
+          // the missing blobs keep the digest of empty blobs, which doesn't
+          // match any landed blob, and fail when being requested
+          std::shared_ptr<Blob> blob;
+          if (!client.GetObject(blob_ids[idx], blob).ok() || blob == nullptr) {
+            continue;
+          }
+          digests[idx].size = blob->allocated_size();
+          digests[idx].checksum = Checksum(blob->data(), digests[idx].size);
+        }
+      }
+      asio::write(socket, asio::buffer(digests.data(),
+                                       count * sizeof(BlobDigest)));
+      continue;
+    }
     size_t blob_size = 0;
     std::shared_ptr<Blob> blob = nullptr;
     if (blob_to_send != EmptyBlobID()) {
-      blob = client.GetObject<Blob>(blob_to_send);
-      blob_size = blob->size();
+      auto status = client.GetObject(blob_to_send, blob);
+      if (!status.ok() || blob == nullptr) {
+        // closes the connection, thus the peer fails rather than receiving
+        // an empty blob
+        LOG(ERROR) << "Failed to get the blob to migrate "
+                   << ObjectIDToString(blob_to_send) << ": "
+                   << status.ToString();
+        return status.ok() ? Status::ObjectNotExists(
+                                 "not a blob: " +
+                                 ObjectIDToString(blob_to_send))
+                           : status;
+      }
+      blob_size = blob->allocated_size();
     }
     asio::write(socket, asio::buffer(&blob_size, sizeof(size_t)));
+    if (blob_size > 0 && endpoint) {
+      // the peer reads the payload from the region directly, which keeps
+      // valid as the blob is held until the next request arrives
+      RDMAEndpoint::Region region{0, 0};
+      uintptr_t base = 0;
+      size_t size = 0;
+      uint32_t lkey = 0;
+      if (client.IsSharedMemory(blob->data(), base, size) &&
+          endpoint->Register(base, size, lkey, region.rkey).ok()) {
+        region.address = reinterpret_cast<uintptr_t>(blob->data());
+      }
+      asio::write(socket, asio::buffer(&region, sizeof(RDMAEndpoint::Region)));
+      if (region.address != 0) {
+        VLOG(10) << "Exposing blob payload of size " << blob_size
+                 << " via RDMA ...";
+        continue;
+      }
+    }
     if (blob_size > 0) {
       VLOG(10) << "Sending blob payload of size " << blob_size << " ...";
       asio::write(socket, asio::buffer(blob->data(), blob_size));
@@ -157,6 +419,9 @@ Status Rebuild(Client& client, ObjectMeta const& metadata, ObjectMeta& target,
 
 Status Work(Client& client, RPCClient& rpc_client,
             asio::ip::tcp::socket& socket) {
+  std::unique_ptr<RDMAEndpoint> endpoint;
+  RETURN_ON_ERROR(connect_rdma_endpoint(socket, endpoint));
+
   // ping to ensure server works as expected
   ObjectID empty_blob_id = EmptyBlobID();
   asio::write(socket, asio::buffer(&empty_blob_id, sizeof(ObjectID)));
@@ -175,9 +440,44 @@ Status Work(Client& client, RPCClient& rpc_client,
   metadata.PrintMeta();
   VLOG(10) << "blob sizes to migrate: " << remote_blobs.size();
   std::map<ObjectID, std::shared_ptr<Blob>> target_blobs;
+  if (FLAGS_co_located_copy) {
+    RETURN_ON_ERROR(copy_co_located_blobs(client, metadata.MetaData(),
+                                          remote_blobs, target_blobs));
+    VLOG(10) << "blobs to migrate over the socket: " << remote_blobs.size();
+  }
 
-  // step 2: migrate blobs to local
-  for (auto const& blob : remote_blobs) {
+  // step 2: fetch the sizes and checksums of blobs, the blobs that have
+  // landed intact in a previous attempt are reused
+  std::vector<ObjectID> blob_ids(remote_blobs.begin(), remote_blobs.end());
+  std::vector<BlobDigest> digests(blob_ids.size());
+  {
+    ObjectID request = kManifestRequest;
+    uint64_t count = blob_ids.size();
+    asio::write(socket, asio::buffer(&request, sizeof(ObjectID)));
+    asio::write(socket, asio::buffer(&count, sizeof(uint64_t)));
+    asio::write(socket,
+                asio::buffer(blob_ids.data(), count * sizeof(ObjectID)));
+    asio::read(socket,
+               asio::buffer(digests.data(), count * sizeof(BlobDigest)));
+  }
+  std::string const path = manifest_path(rpc_client.remote_instance_id());
+  std::map<ObjectID, ManifestEntry> landed;
+  load_manifest(path, landed);
+  std::ofstream manifest(path, std::ios::app);
+
+  // step 3: migrate blobs to local
+  for (size_t index = 0; index < blob_ids.size(); ++index) {
+    ObjectID const& blob = blob_ids[index];
+    BlobDigest const& digest = digests[index];
+    auto entry = landed.find(blob);
+    std::shared_ptr<Blob> local_blob;
+    if (digest.size > 0 && entry != landed.end() &&
+        entry->second.digest == digest &&
+        reuse_blob(client, entry->second, local_blob)) {
+      VLOG(10) << "Reuse the migrated blob " << ObjectIDToString(blob);
+      target_blobs.emplace(blob, local_blob);
+      continue;
+    }
     VLOG(10) << "Will migrate blob " << ObjectIDToString(blob) << " to local";
     asio::write(socket, asio::buffer(&blob, sizeof(ObjectID)));
     size_t size_of_blob = std::numeric_limits<size_t>::max();
@@ -185,19 +485,50 @@ Status Work(Client& client, RPCClient& rpc_client,
     if (size_of_blob > 0) {
       std::unique_ptr<BlobWriter> buffer;
       RETURN_ON_ERROR(client.CreateBlob(size_of_blob, buffer));
-      VLOG(10) << "Receiving blob payload of size " << size_of_blob << " ...";
-      asio::read(socket, asio::buffer(buffer->data(), size_of_blob));
-      target_blobs.emplace(
-          blob, std::dynamic_pointer_cast<Blob>(buffer->Seal(client)));
+      RDMAEndpoint::Region region{0, 0};
+      if (endpoint) {
+        asio::read(socket,
+                   asio::buffer(&region, sizeof(RDMAEndpoint::Region)));
+      }
+      uintptr_t base = 0;
+      size_t size = 0;
+      uint32_t lkey = 0, rkey = 0;
+      if (region.address != 0 &&
+          client.IsSharedMemory(buffer->data(), base, size) &&
+          endpoint->Register(base, size, lkey, rkey).ok()) {
+        VLOG(10) << "Reading blob payload of size " << size_of_blob
+                 << " via RDMA ...";
+        RETURN_ON_ERROR(endpoint->Read(
+            reinterpret_cast<uint8_t*>(buffer->data()), lkey, region,
+            size_of_blob));
+      } else {
+        RETURN_ON_ASSERT(region.address == 0,
+                         "Failed to register the local blob for RDMA");
+        VLOG(10) << "Receiving blob payload of size " << size_of_blob
+                 << " ...";
+        asio::read(socket, asio::buffer(buffer->data(), size_of_blob));
+      }
+      RETURN_ON_ASSERT(
+          size_of_blob == digest.size &&
+              Checksum(buffer->data(), size_of_blob) == digest.checksum,
+          "The blob " + ObjectIDToString(blob) +
+              " is corrupted during migration");
+      auto sealed = std::dynamic_pointer_cast<Blob>(buffer->Seal(client));
+      manifest << ObjectIDToString(blob) << " " << digest.size << " "
+               << digest.checksum << " " << ObjectIDToString(sealed->id())
+               << std::endl;
+      target_blobs.emplace(blob, sealed);
     } else {
       target_blobs.emplace(blob, Blob::MakeEmpty(client));
     }
   }
 
-  // step 3: rebuild metadata and object
+  // step 4: rebuild metadata and object
   ObjectMeta target;
   RETURN_ON_ERROR(Rebuild(client, metadata, target, target_blobs));
   RETURN_ON_ERROR(client.Persist(target.GetId()));
+  manifest.close();
+  std::remove(path.c_str());
   VLOG(10) << "Test: get local object meta ...";
   {
     ObjectMeta migrated;
@@ -16,8 +16,10 @@ limitations under the License.
 #include <iostream>
 #include <limits>
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "boost/asio.hpp"
 #include "gflags/gflags.h"
@@ -46,6 +48,9 @@ DEFINE_string(
     "RPC endpoint of the peer vineyard server for fetching complete metadata");
 DEFINE_string(id, ObjectIDToString(InvalidObjectID()),
               "Object to migrate to local");
+DEFINE_uint64(window, 4,
+              "Max number of chunks in flight when forwarding the stream, "
+              "1 means forwarding chunk by chunk");
 
 Status Rebuild(Client& client, ObjectMeta const& metadata,
                ObjectID& target_id) {
@@ -136,9 +141,81 @@ Status RunServer() {
   return Serve(client, rpc_client, std::move(socket));
 }
 
+/**
+ * @brief Forward the stream in batches of up to `window` chunks, the chunks
+ * of a batch are written to the peer from the mapped blobs in a single
+ * gathered write.
+ *
+ * Pulling a batch releases the previous one, whose blobs may be reused by
+ * the producer, thus the next batch is pulled only after the previous one
+ * has been written. The producer keeps filling the chunks that are buffered
+ * in the stream meanwhile.
+ */
+Status WorkWindowed(Client& client, ObjectID const stream_id,
+                    asio::ip::tcp::socket& socket, size_t const window) {
+  Status status;
+  while (status.ok()) {
+    std::vector<ObjectID> chunks;
+    status = client.PullNextStreamChunks(stream_id, window, 0, chunks);
+    if (!status.ok()) {
+      break;
+    }
+    auto objects = client.GetObjects(chunks);
+    std::vector<std::shared_ptr<Blob>> blobs;
+    blobs.reserve(objects.size());
+    for (size_t idx = 0; idx < objects.size(); ++idx) {
+      if (objects[idx] == nullptr) {
+        status = Status::ObjectNotExists("Failed to get the stream chunk " +
+                                         ObjectIDToString(chunks[idx]));
+        break;
+      }
+      auto blob = std::dynamic_pointer_cast<Blob>(objects[idx]);
+      if (blob == nullptr) {
+        status = Status::Invalid("Expect buffer, but got '" +
+                                 objects[idx]->meta().GetTypeName() + "'");
+        break;
+      }
+      blobs.emplace_back(blob);
+    }
+    if (!status.ok()) {
+      break;
+    }
+
+    std::vector<size_t> sizes;
+    sizes.reserve(blobs.size());
+    for (auto const& blob : blobs) {
+      sizes.emplace_back(blob->allocated_size());
+    }
+    std::vector<asio::const_buffer> buffers;
+    buffers.reserve(blobs.size() * 2);
+    for (size_t idx = 0; idx < blobs.size(); ++idx) {
+      buffers.emplace_back(asio::buffer(&sizes[idx], sizeof(size_t)));
+      if (sizes[idx] > 0) {
+        buffers.emplace_back(asio::buffer(blobs[idx]->data(), sizes[idx]));
+      }
+    }
+    boost::system::error_code ec;
+    asio::write(socket, buffers, ec);
+    if (ec) {
+      return Status::IOError("Failed to forward stream chunks: " +
+                             ec.message());
+    }
+  }
+
+  size_t buffer_size = std::numeric_limits<size_t>::max();
+  if (!status.IsStreamDrained()) {
+    buffer_size = std::numeric_limits<size_t>::max() - 1;
+  }
+  asio::write(socket, asio::buffer(&buffer_size, sizeof(size_t)));
+  return status.IsStreamDrained() ? Status::OK() : status;
+}
+
 Status Work(Client& client, asio::ip::tcp::socket& socket) {
   ObjectID stream_id = ObjectIDFromString(FLAGS_id);
   RETURN_ON_ERROR(client.OpenStream(stream_id, StreamOpenMode::read));
+  if (FLAGS_window > 1) {
+    return WorkWindowed(client, stream_id, socket, FLAGS_window);
+  }
   while (true) {
     std::unique_ptr<arrow::Buffer> buffer;
     Status status = client.PullNextStreamChunk(stream_id, buffer);
@@ -15,12 +15,14 @@ limitations under the License.
 
 #include <memory>
 #include <sstream>
+#include <vector>
 
 #include "client/client.h"
 #include "client/ds/blob.h"
 #include "client/ds/i_object.h"
 #include "client/ds/object_meta.h"
 #include "client/rpc_client.h"
+#include "common/memory/memcpy.h"
 #include "common/util/env.h"
 #include "common/util/json.h"
 #include "common/util/status.h"
@@ -146,20 +148,33 @@ void bind_client(py::module& mod) {
           "object"_a, py::arg("force") = false, py::arg("deep") = true)
       .def(
           "create_stream",
-          [](ClientBase* self, ObjectID const id) {
-            throw_on_error(self->CreateStream(id));
-          },
-          "stream"_a)
+          [](ClientBase* self, ObjectID const id,
+             size_t const high_watermark_bytes, size_t const low_watermark_bytes,
+             size_t const high_watermark_chunks,
+             size_t const low_watermark_chunks, bool const recycle_chunks) {
+            throw_on_error(self->CreateStream(
+                id, high_watermark_bytes, low_watermark_bytes,
+                high_watermark_chunks, low_watermark_chunks, recycle_chunks));
+          },
+          "stream"_a, py::arg("high_watermark_bytes") = 0,
+          py::arg("low_watermark_bytes") = 0,
+          py::arg("high_watermark_chunks") = 0,
+          py::arg("low_watermark_chunks") = 0,
+          py::arg("recycle_chunks") = false)
       .def(
           "open_stream",
           [](ClientBase* self, ObjectID const id, std::string const& mode) {
             if (mode == "r") {
               throw_on_error(self->OpenStream(id, StreamOpenMode::read));
+            } else if (mode == "f") {
+              throw_on_error(self->OpenStream(id, StreamOpenMode::fanout));
+            } else if (mode == "s") {
+              throw_on_error(self->OpenStream(id, StreamOpenMode::shared));
             } else if (mode == "w") {
               throw_on_error(self->OpenStream(id, StreamOpenMode::write));
             } else {
-              throw_on_error(
-                  Status::AssertionFailed("Mode can only be 'r' or 'w'"));
+              throw_on_error(Status::AssertionFailed(
+                  "Mode can only be 'r', 'f', 's' or 'w'"));
             }
           },
           "stream"_a, "mode"_a)
@@ -169,6 +184,25 @@ void bind_client(py::module& mod) {
             throw_on_error(self->PushNextStreamChunk(stream_id, chunk));
           },
           "stream"_a, "chunk"_a, py::call_guard<py::gil_scoped_release>())
+      .def(
+          "push_chunks",
+          [](ClientBase* self, ObjectID const stream_id,
+             std::vector<ObjectID> const& chunks) {
+            throw_on_error(self->PushNextStreamChunks(stream_id, chunks));
+          },
+          "stream"_a, "chunks"_a, py::call_guard<py::gil_scoped_release>())
+      .def(
+          "next_chunk_ids",
+          [](ClientBase* self, ObjectID const stream_id,
+             size_t const max_chunks,
+             size_t const max_bytes) -> std::vector<ObjectID> {
+            std::vector<ObjectID> ids;
+            throw_on_error(self->PullNextStreamChunks(stream_id, max_chunks,
+                                                      max_bytes, ids));
+            return ids;
+          },
+          "stream"_a, "max_chunks"_a, "max_bytes"_a = 0,
+          py::call_guard<py::gil_scoped_release>())
       .def(
           "next_chunk_id",
           [](ClientBase* self, ObjectID const stream_id) -> ObjectID {
@@ -351,6 +385,52 @@ void bind_client(py::module& mod) {
             return target_id;
           },
           "object_id"_a)
+      .def(
+          "prefetch",
+          [](ClientBase* self, const std::vector<ObjectIDWrapper>& object_ids,
+             InstanceID const target,
+             int64_t const pin_ttl) -> std::vector<ObjectIDWrapper> {
+            std::vector<ObjectID> unwrapped_object_ids(object_ids.begin(),
+                                                       object_ids.end());
+            std::vector<ObjectID> replicas;
+            throw_on_error(self->Prefetch(unwrapped_object_ids, target,
+                                          pin_ttl, replicas));
+            return std::vector<ObjectIDWrapper>(replicas.begin(),
+                                                replicas.end());
+          },
+          "object_ids"_a, "target"_a, py::arg("pin_ttl") = 600,
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "unpin",
+          [](ClientBase* self, const std::vector<ObjectIDWrapper>& object_ids) {
+            std::vector<ObjectID> unwrapped_object_ids(object_ids.begin(),
+                                                       object_ids.end());
+            throw_on_error(self->Unpin(unwrapped_object_ids));
+          },
+          "object_ids"_a)
+      .def(
+          "list_ids",
+          [](ClientBase* self, std::string const& pattern, bool const regex,
+             size_t const limit, py::dict filters,
+             std::vector<std::string> const& fields,
+             std::string cursor) -> py::tuple {
+            std::vector<ObjectID> ids;
+            std::unordered_map<ObjectID, json> projections;
+            throw_on_error(self->ListDataPage(pattern, regex, limit,
+                                              detail::to_json(filters), fields,
+                                              cursor, ids, projections));
+            std::vector<ObjectIDWrapper> wrapped_ids(ids.begin(), ids.end());
+            py::dict wrapped_projections;
+            for (auto const& kv : projections) {
+              wrapped_projections[py::cast(ObjectIDWrapper(kv.first))] =
+                  detail::from_json(kv.second);
+            }
+            return py::make_tuple(wrapped_ids, wrapped_projections, cursor);
+          },
+          "pattern"_a, py::arg("regex") = false, py::arg("limit") = 1000,
+          py::arg("filters") = py::dict(),
+          py::arg("fields") = std::vector<std::string>{},
+          py::arg("cursor") = "")
       .def("clear", [](ClientBase* self) { throw_on_error(self->Clear()); })
       .def("reset", [](ClientBase* self) { throw_on_error(self->Clear()); })
       .def_property_readonly("connected", &Client::Connected)
@@ -382,6 +462,20 @@ void bind_client(py::module& mod) {
             throw_on_error(self->InstanceStatus(status));
             return status;
           })
+      .def("memory_attribution",
+           [](ClientBase* self) {
+             json usage;
+             throw_on_error(self->MemoryAttribution(usage));
+             return detail::from_json(usage);
+           })
+      .def(
+          "checkpoint",
+          [](ClientBase* self, std::string const& path) {
+            json stats;
+            throw_on_error(self->Checkpoint(path, stats));
+            return detail::from_json(stats);
+          },
+          "path"_a)
       .def("debug",
            [](ClientBase* self, py::dict debug) {
              json result;
@@ -407,6 +501,13 @@ void bind_client(py::module& mod) {
       .def_property_readonly(
           "memory_limit",
           [](InstanceStatus* status) { return status->memory_limit; })
+      .def_property_readonly(
+          "memory_fragmentation",
+          [](InstanceStatus* status) { return status->memory_fragmentation; })
+      .def_property_readonly("session_memory",
+                             [](InstanceStatus* status) {
+                               return detail::from_json(status->session_memory);
+                             })
       .def_property_readonly(
           "deferred_requests",
           [](InstanceStatus* status) { return status->deferred_requests; })
@@ -416,6 +517,21 @@ void bind_client(py::module& mod) {
       .def_property_readonly(
           "rpc_connections",
           [](InstanceStatus* status) { return status->rpc_connections; })
+      .def_property_readonly("request_stats",
+                             [](InstanceStatus* status) {
+                               return detail::from_json(status->request_stats);
+                             })
+      .def_property_readonly(
+          "connection_stats",
+          [](InstanceStatus* status) {
+            return detail::from_json(status->connection_stats);
+          })
+      .def_property_readonly(
+          "meta_service_time_us",
+          [](InstanceStatus* status) { return status->meta_service_time_us; })
+      .def_property_readonly(
+          "bulk_store_time_us",
+          [](InstanceStatus* status) { return status->bulk_store_time_us; })
       .def("__repr__",
            [](InstanceStatus* status) {
              std::stringstream ss;
@@ -427,6 +543,8 @@ void bind_client(py::module& mod) {
                 << std::endl;
              ss << "    memory_limit: " << status->memory_limit << ","
                 << std::endl;
+             ss << "    memory_fragmentation: " << status->memory_fragmentation
+                << "," << std::endl;
              ss << "    deferred_requests: " << status->deferred_requests << ","
                 << std::endl;
              ss << "    ipc_connections: " << status->ipc_connections << ","
@@ -443,6 +561,8 @@ void bind_client(py::module& mod) {
         ss << "    deployment: " << status->deployment << std::endl;
         ss << "    memory_usage: " << status->memory_usage << std::endl;
         ss << "    memory_limit: " << status->memory_limit << std::endl;
+        ss << "    memory_fragmentation: " << status->memory_fragmentation
+           << std::endl;
         ss << "    deferred_requests: " << status->deferred_requests
            << std::endl;
         ss << "    ipc_connections: " << status->ipc_connections << std::endl;
@@ -460,6 +580,45 @@ void bind_client(py::module& mod) {
             return std::shared_ptr<BlobWriter>(blob.release());
           },
           py::return_value_policy::move, "size"_a)
+      .def(
+          "create_blobs_from_buffers",
+          [](Client* self, std::vector<py::buffer> const& buffers)
+              -> std::vector<std::shared_ptr<Blob>> {
+            std::vector<py::buffer_info> infos;
+            std::vector<size_t> sizes;
+            for (auto const& buffer : buffers) {
+              infos.emplace_back(buffer.request());
+              auto const& info = infos.back();
+              // only the C-contiguous buffers can be copied as a whole
+              ssize_t stride = info.itemsize;
+              for (ssize_t dim = info.ndim - 1; dim >= 0; --dim) {
+                if (info.shape[dim] != 1 && info.strides[dim] != stride) {
+                  throw py::value_error(
+                      "Not a contiguous buffer, please consider translate to "
+                      "`bytes` first.");
+                }
+                stride *= info.shape[dim];
+              }
+              sizes.emplace_back(info.size * info.itemsize);
+            }
+
+            // the buffers are released after the GIL is re-acquired
+            py::gil_scoped_release release;
+            std::unique_ptr<BlobWriterGroup> group;
+            throw_on_error(BlobWriterGroup::Make(*self, sizes, group));
+            for (size_t index = 0; index < sizes.size(); ++index) {
+              memory::concurrent_memcpy(group->Writer(index)->data(),
+                                        infos[index].ptr, sizes[index]);
+            }
+            std::vector<std::shared_ptr<Blob>> blobs;
+            auto status = group->Seal(*self, blobs);
+            if (!status.ok()) {
+              VINEYARD_DISCARD(group->Abort(*self));
+            }
+            throw_on_error(status);
+            return blobs;
+          },
+          "buffers"_a)
       .def("create_empty_blob",
            [](Client* self) -> std::shared_ptr<Blob> {
              return Blob::MakeEmpty(*self);
@@ -472,7 +631,7 @@ void bind_client(py::module& mod) {
             throw_on_error(self->GetObject(object_id, object));
             return object;
           },
-          "object_id"_a)
+          "object_id"_a, py::call_guard<py::gil_scoped_release>())
       .def(
           "get_objects",
           [](Client* self, const std::vector<ObjectIDWrapper>& object_ids) {
@@ -482,7 +641,7 @@ void bind_client(py::module& mod) {
             }
             return self->GetObjects(unwrapped_object_ids);
           },
-          "object_ids"_a)
+          "object_ids"_a, py::call_guard<py::gil_scoped_release>())
       .def(
           "get_meta",
           [](Client* self, ObjectIDWrapper const& object_id,
@@ -493,7 +652,8 @@ void bind_client(py::module& mod) {
             throw_on_error(self->GetMetaData(object_id, meta, sync_remote));
             return meta;
           },
-          "object_id"_a, py::arg("sync_remote") = false)
+          "object_id"_a, py::arg("sync_remote") = false,
+          py::call_guard<py::gil_scoped_release>())
       .def(
           "get_metas",
           [](Client* self, std::vector<ObjectIDWrapper> const& object_ids,
@@ -509,7 +669,8 @@ void bind_client(py::module& mod) {
                 self->GetMetaData(unwrapped_object_ids, metas, sync_remote));
             return metas;
           },
-          "object_ids"_a, py::arg("sync_remote") = false)
+          "object_ids"_a, py::arg("sync_remote") = false,
+          py::call_guard<py::gil_scoped_release>())
       .def("list_objects", &Client::ListObjects, "pattern"_a,
            py::arg("regex") = false, py::arg("limit") = 5)
       .def("list_metadatas", &Client::ListObjectMeta, "pattern"_a,
@@ -591,7 +752,7 @@ void bind_client(py::module& mod) {
             throw_on_error(self->GetObject(object_id, object));
             return object;
           },
-          "object_id"_a)
+          "object_id"_a, py::call_guard<py::gil_scoped_release>())
       .def(
           "get_objects",
           [](RPCClient* self, std::vector<ObjectIDWrapper> const& object_ids) {
@@ -601,7 +762,7 @@ void bind_client(py::module& mod) {
             }
             return self->GetObjects(unwrapped_object_ids);
           },
-          "object_ids"_a)
+          "object_ids"_a, py::call_guard<py::gil_scoped_release>())
       .def(
           "get_meta",
           [](RPCClient* self, ObjectIDWrapper const& object_id) -> ObjectMeta {
@@ -609,7 +770,7 @@ void bind_client(py::module& mod) {
             throw_on_error(self->GetMetaData(object_id, meta, true));
             return meta;
           },
-          "object_id"_a)
+          "object_id"_a, py::call_guard<py::gil_scoped_release>())
       .def(
           "get_metas",
           [](RPCClient* self, std::vector<ObjectIDWrapper> const& object_ids)
@@ -623,7 +784,7 @@ void bind_client(py::module& mod) {
                 self->GetMetaData(unwrapped_object_ids, metas, true));
             return metas;
           },
-          "object_ids"_a)
+          "object_ids"_a, py::call_guard<py::gil_scoped_release>())
       .def("list_objects", &RPCClient::ListObjects, "pattern"_a,
            py::arg("regex") = false, py::arg("limit") = 5)
       .def("list_metadatas", &RPCClient::ListObjectMeta, "pattern"_a,
@@ -15,12 +15,16 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "client/client.h"
 #include "client/ds/blob.h"
+#include "client/ds/dlpack.h"
 #include "client/ds/i_object.h"
 #include "client/ds/object_meta.h"
 #include "client/rpc_client.h"
+#include "common/memory/memcpy.h"
 #include "common/util/json.h"
 #include "common/util/status.h"
 
@@ -323,6 +327,96 @@ void bind_core(py::module& mod) {
            [](Object const* self, std::string const& name) {
              return self->meta().GetMember(name);
            })
+      .def(
+          "tensor_members",
+          [](Object const* self, std::vector<std::string> const& names) {
+            std::vector<ObjectMeta> metas(names.size());
+            std::vector<std::shared_ptr<Object>> objects(names.size());
+            std::vector<std::shared_ptr<Object>> buffers(names.size());
+            {
+              // resolving the placeholders of lazy metadata needs IPCs
+              py::gil_scoped_release release;
+              auto const& tree = self->meta().MetaData();
+              for (size_t index = 0; index < names.size(); ++index) {
+                auto iter = tree.find(names[index]);
+                if (iter == tree.end() || !iter->is_object()) {
+                  continue;
+                }
+                metas[index] = self->meta().GetMemberMeta(names[index]);
+                if (metas[index].GetTypeName().rfind("vineyard::Tensor<", 0) ==
+                        0 &&
+                    metas[index].Haskey("buffer_")) {
+                  objects[index] = self->meta().GetMember(names[index]);
+                  buffers[index] = metas[index].GetMember("buffer_");
+                }
+              }
+            }
+            py::list members;
+            for (size_t index = 0; index < names.size(); ++index) {
+              if (buffers[index] == nullptr) {
+                members.append(py::none());
+                continue;
+              }
+              py::dict member;
+              for (auto const& item :
+                   json::iterator_wrapper(metas[index].MetaData())) {
+                if (!item.value().is_object()) {
+                  member[py::str(item.key())] =
+                      detail::from_json(item.value());
+                }
+              }
+              member["buffer_"] = py::cast(buffers[index]);
+              member["object"] = py::cast(objects[index]);
+              members.append(member);
+            }
+            return members;
+          },
+          "names"_a)
+      .def(
+          "__dlpack__",
+          [](Object const* self, py::object stream) -> py::object {
+            auto const& meta = self->meta();
+            if (meta.GetTypeName().rfind("vineyard::Tensor<", 0) != 0) {
+              throw_on_error(Status::NotImplemented(
+                  "Only tensors can be exported as DLPack tensors, but got '" +
+                  meta.GetTypeName() + "'"));
+            }
+            DLDataType dtype;
+            throw_on_error(DLPackDataType(
+                meta.GetKeyValue<std::string>("value_type_"), dtype));
+            std::vector<int64_t> shape;
+            meta.GetKeyValue("shape_", shape);
+            bool column_major = meta.Haskey("layout_") &&
+                                meta.GetKeyValue("layout_") == "F";
+            std::shared_ptr<Blob> buffer;
+            {
+              py::gil_scoped_release release;
+              buffer = std::dynamic_pointer_cast<Blob>(
+                  meta.GetMember("buffer_"));
+            }
+            DLManagedTensor* tensor = MakeDLPackTensor(
+                buffer, dtype, shape, DLPackStrides(shape, column_major));
+            // the tensor is released by the capsule only when it hasn't been
+            // consumed, i.e., renamed to "used_dltensor"
+            PyObject* capsule =
+                PyCapsule_New(tensor, "dltensor", [](PyObject* capsule) {
+                  if (PyCapsule_IsValid(capsule, "dltensor")) {
+                    auto tensor = static_cast<DLManagedTensor*>(
+                        PyCapsule_GetPointer(capsule, "dltensor"));
+                    tensor->deleter(tensor);
+                  }
+                });
+            if (capsule == nullptr) {
+              tensor->deleter(tensor);
+              throw py::error_already_set();
+            }
+            return py::reinterpret_steal<py::object>(capsule);
+          },
+          "stream"_a = py::none())
+      .def("__dlpack_device__",
+           [](Object const* self) {
+             return py::make_tuple(static_cast<int>(kDLCPU), 0);
+           })
       .def_property_readonly("islocal", &Object::IsLocal)
       .def_property_readonly("ispersist", &Object::IsPersist)
       .def_property_readonly("isglobal", &Object::IsGlobal)
@@ -428,8 +522,9 @@ void bind_core(py::module& mod) {
           "copy",
           [](BlobWriter* self, size_t const offset, uintptr_t ptr,
              size_t const size) {
-            std::memcpy(self->data() + offset, reinterpret_cast<void*>(ptr),
-                        size);
+            py::gil_scoped_release release;
+            memory::concurrent_memcpy(self->data() + offset,
+                                      reinterpret_cast<void*>(ptr), size);
           },
           "offset"_a, "address"_a, "size"_a)
       .def(
@@ -454,7 +549,9 @@ void bind_core(py::module& mod) {
                   "', but the buffer size is '" + std::to_string(length) +
                   "'"));
             }
-            std::memcpy(self->data() + offset, buffer, length);
+            // the bytes object is immutable and kept alive by the caller
+            py::gil_scoped_release release;
+            memory::concurrent_memcpy(self->data() + offset, buffer, length);
           },
           "offset"_a, "bytes"_a)
       .def_property_readonly("address",
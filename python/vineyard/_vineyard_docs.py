@@ -452,6 +452,53 @@ See Also:
 ''',
 )
 
+add_doc(
+    Object.tensor_members,
+    r'''
+.. method:: tensor_members(self, names: List[str]) -> List[Optional[dict]]
+    :noindex:
+
+Resolve the tensor members of this object in a single call, with the GIL
+released, to avoid resolving the members of wide objects (e.g., dataframes
+with hundreds of columns) one by one.
+
+Parameters:
+    names: List[str]
+        The names of the member objects.
+
+Returns:
+    For each name, the plain fields of the tensor (e.g., :code:`value_type_` and
+    :code:`shape_`) with its :code:`buffer_` blob and the tensor
+    :code:`object` itself, or :code:`None` if the member is not a tensor.
+''',
+)
+
+add_doc(
+    Object.__dlpack__,
+    r'''
+.. method:: __dlpack__(self, stream=None)
+    :noindex:
+
+Export the tensor as a DLPack capsule, e.g., for :code:`torch.from_dlpack`,
+which points right into the shared memory of the tensor's blob without
+copying. Only tensors (i.e., :code:`vineyard::Tensor<T>`) can be exported.
+
+.. code:: python
+
+    >>> tensor = torch.from_dlpack(client.get_object(object_id))
+''',
+)
+
+add_doc(
+    Object.__dlpack_device__,
+    r'''
+.. method:: __dlpack_device__(self)
+    :noindex:
+
+The DLPack device of the tensor, i.e., :code:`(kDLCPU, 0)`.
+''',
+)
+
 add_doc(
     Object.islocal,
     r'''
@@ -684,6 +731,81 @@ Synchronize remote metadata to local immediately.
 ''',
 )
 
+add_doc(
+    ClientBase.prefetch,
+    r'''
+.. method:: prefetch(object_ids: List[ObjectID], target: InstanceID,
+                     pin_ttl: int = 600) -> List[ObjectID]
+    :noindex:
+
+Migrate the objects to the instance :code:`target` ahead of the jobs that will use
+them, and pin the replicas on the target for :code:`pin_ttl` seconds thus they won't
+be evicted before the jobs start. A job on the target that migrates the objects
+gets the prefetched replicas at once.
+
+The GIL is released during the prefetch, run it in a thread to prefetch in the
+background.
+
+Parameters:
+    object_ids: List[ObjectID]
+        The objects to prefetch.
+    target: InstanceID
+        The instance that the objects will be prefetched to.
+    pin_ttl: int
+        How long (in seconds) the replicas are pinned. Default value is 600.
+
+Returns:
+    The replica of each object on the target instance.
+''',
+)
+
+add_doc(
+    ClientBase.unpin,
+    r'''
+.. method:: unpin(object_ids: List[ObjectID]) -> None
+    :noindex:
+
+Release the pinned replicas of the objects that have been prefetched to the
+connected instance.
+''',
+)
+
+add_doc(
+    ClientBase.list_ids,
+    r'''
+.. method:: list_ids(pattern: str, regex: bool = False, limit: int = 1000,
+                     filters: Dict = {}, fields: List[str] = [], cursor: str = '')
+                     -> Tuple[List[ObjectID], Dict[ObjectID, Dict], str]
+    :noindex:
+
+List a page of object ids in the vineyard server, without resolving the
+metadatas of objects.
+
+Parameters:
+    pattern: str
+        The pattern string that will be matched against the object's typename.
+    regex: bool
+        Whether the pattern is a regex expression, otherwise the pattern will be used
+        as wildcard pattern. Default value is False.
+    limit: int
+        The maximum number of objects in the page. Default value is 1000.
+    filters: dict
+        The optional filters, i.e., :code:`instance_id`, :code:`created_after` and
+        :code:`created_before` (in microseconds since the epoch), :code:`min_nbytes`
+        and :code:`max_nbytes`.
+    fields: list
+        The top-level fields (e.g., :code:`typename`, :code:`nbytes`) that will be
+        returned with the ids.
+    cursor: str
+        The cursor of the page, empty for the first page.
+
+Returns:
+    The ids, the requested fields of each object, and the cursor of the next
+    page, which is empty when the listing ends. The page may be shorter than
+    :code:`limit` when the filters are selective.
+''',
+)
+
 add_doc(
     ClientBase.clear,
     r'''
@@ -753,6 +875,36 @@ See Also:
 ''',
 )
 
+add_doc(
+    ClientBase.memory_attribution,
+    r'''
+.. method:: memory_attribution() -> dict
+    :noindex:
+
+Attribute the shared memory of the connected vineyard server to the objects
+that hold the blobs, aggregated by the type name (:code:`by_type`), the
+instance (:code:`by_instance`) and the client process that created the blobs
+(:code:`by_owner`), as well as the objects that hold the most bytes
+(:code:`top_objects`).
+''',
+)
+
+add_doc(
+    ClientBase.checkpoint,
+    r'''
+.. method:: checkpoint(path: str) -> dict
+    :noindex:
+
+Write the sealed blobs of the connected vineyard server, and the metadata of
+the objects that live in that server only, to the checkpoint file at
+:code:`path` on the host of the server. vineyardd loads the checkpoint back
+when it restarts with :code:`--restore_checkpoint`.
+
+Returns the number of :code:`blobs` and :code:`bytes` that have been written,
+and the :code:`seconds` that have been taken.
+''',
+)
+
 add_doc(
     ClientBase.ipc_socket,
     r'''
@@ -799,6 +951,24 @@ Returns:
 ''',
 )
 
+add_doc(
+    IPCClient.create_blobs_from_buffers,
+    r'''
+.. method:: create_blobs_from_buffers(buffers: List[memoryview]) -> List[Blob]
+    :noindex:
+
+Create a blob for each of the contiguous buffers, copy the buffers into the
+blobs and seal them, with a single call and the GIL released.
+
+Parameters:
+    buffers: List[memoryview]
+        The buffers, e.g., the out-of-band buffers of pickle protocol 5.
+
+Returns:
+    The sealed blobs, in the order of :code:`buffers`.
+''',
+)
+
 add_doc(
     IPCClient.create_empty_blob,
     r'''
@@ -1200,6 +1370,43 @@ Report number of alive RPC connections on the current vineyardd instance.
 ''',
 )
 
+add_doc(
+    InstanceStatus.request_stats,
+    r'''
+Report the number, the total and the max handling time (in microseconds) of the
+requests on the current vineyardd instance, by command, e.g.,
+
+.. code:: python
+
+    >>> status.request_stats
+    {'get_data_request': {'count': 8, 'max_us': 40.2, 'total_us': 120.5}}
+''',
+)
+
+add_doc(
+    InstanceStatus.connection_stats,
+    r'''
+Report the number, the total and the max handling time (in microseconds) of the
+requests of each alive connection on the current vineyardd instance.
+''',
+)
+
+add_doc(
+    InstanceStatus.meta_service_time_us,
+    r'''
+Report the time (in microseconds) spent on committing to the metadata service
+on the current vineyardd instance.
+''',
+)
+
+add_doc(
+    InstanceStatus.bulk_store_time_us,
+    r'''
+Report the time (in microseconds) spent on allocating blobs from the bulk store
+on the current vineyardd instance.
+''',
+)
+
 add_doc(
     Blob,
     r'''
@@ -65,6 +65,7 @@ Some examples on how to use vineyard-ctl:
 
 11. Issue a debug request
     $ vineyard-ctl debug --payload '{"instance_status":[], "memory_size":[]}'
+    $ vineyard-ctl debug --cpu_profile 30 --heap_profile --output vineyardd
 
 12. Start vineyardd
     $ vineyard-ctl start --local
@@ -268,6 +269,43 @@ def vineyard_argument_parser():
         const='rpc_connections',
         help='Number of alive RPC connections on the current vineyardd instance',
     )
+    stat_opt.add_argument(
+        '--request_stats',
+        dest='properties',
+        action='append_const',
+        const='request_stats',
+        help='Number, total and max handling time of the requests by command, '
+        'the slowest first',
+    )
+    stat_opt.add_argument(
+        '--connection_stats',
+        dest='properties',
+        action='append_const',
+        const='connection_stats',
+        help='Number, total and max handling time of the requests by connection',
+    )
+    stat_opt.add_argument(
+        '--meta_service_time_us',
+        dest='properties',
+        action='append_const',
+        const='meta_service_time_us',
+        help='Time (in microseconds) spent on committing to the metadata service',
+    )
+    stat_opt.add_argument(
+        '--bulk_store_time_us',
+        dest='properties',
+        action='append_const',
+        const='bulk_store_time_us',
+        help='Time (in microseconds) spent on allocating from the bulk store',
+    )
+    stat_opt.add_argument(
+        '--memory_attribution',
+        dest='properties',
+        action='append_const',
+        const='memory_attribution',
+        help='Memory usage of current vineyardd instance by the object type, '
+        'the instance and the client process that created the blobs',
+    )
 
     put_opt = cmd_parser.add_parser(
         'put',
@@ -358,6 +396,8 @@ def vineyard_argument_parser():
         epilog=(
             'Example:\n\n>>> vineyard-ctl debug --payload '
             + '\'{"instance_status":[], "memory_size":[]}\''
+            + '\n>>> vineyard-ctl debug --cpu_profile 30 --heap_profile '
+            + '--output vineyardd'
         ),
     )
     debug_opt.add_argument(
@@ -365,6 +405,29 @@ def vineyard_argument_parser():
         type=json.loads,
         help='The payload that will be sent to the debug handler',
     )
+    debug_opt.add_argument(
+        '--cpu_profile',
+        type=float,
+        help='Sample the CPU usage of vineyardd for the given seconds',
+    )
+    debug_opt.add_argument(
+        '--frequency',
+        type=int,
+        default=99,
+        help='The sampling frequency of the CPU profile, in Hz',
+    )
+    debug_opt.add_argument(
+        '--heap_profile',
+        action='store_true',
+        help='Dump the statistics and the heap profile of the allocator',
+    )
+    debug_opt.add_argument(
+        '--output',
+        help=(
+            'Write the CPU profile to <output>.folded, which can be rendered '
+            'by flamegraph.pl, and the heap profile to <output>.heap.json'
+        ),
+    )
 
     start_opt = cmd_parser.add_parser(
         'start',
@@ -622,7 +685,36 @@ def status(client, args):
     else:
         print('InstanceStatus:')
         for prop in args.properties:
-            print(f'    {prop}: {getattr(stat, prop)}')
+            if prop == 'request_stats':
+                print(f'    {prop}:')
+                commands = sorted(
+                    stat.request_stats.items(),
+                    key=lambda item: item[1]['total_us'],
+                    reverse=True,
+                )
+                for command, stats in commands:
+                    print(
+                        f'        {command}: count={stats["count"]}, '
+                        f'total_us={stats["total_us"]}, max_us={stats["max_us"]}'
+                    )
+            elif prop == 'memory_attribution':
+                usage = client.memory_attribution()
+                print(f'    {prop}:')
+                for group in ['by_type', 'by_instance', 'by_owner']:
+                    print(f'        {group}:')
+                    items = sorted(
+                        usage[group].items(),
+                        key=lambda item: item[1]['bytes'],
+                        reverse=True,
+                    )
+                    for name, item in items:
+                        print(
+                            f'            {name}: objects={item["objects"]}, '
+                            f'blobs={item["blobs"]}, '
+                            f'bytes={pretty_format_memory(item["bytes"])}'
+                        )
+            else:
+                print(f'    {prop}: {getattr(stat, prop)}')
 
 
 def put_object(client, args):
@@ -721,15 +813,32 @@ def migrate_object(client, args):
 
 def debug(client, args):
     """Utility to issue a debug request."""
+    payload = dict(args.payload or {})
+    if args.cpu_profile is not None:
+        payload['cpu_profile'] = {
+            'seconds': args.cpu_profile,
+            'frequency': args.frequency,
+        }
+    if args.heap_profile:
+        payload['heap_profile'] = {}
     try:
-        result = client.debug(args.payload)
+        result = client.debug(payload)
     except BaseException as exc:
         raise Exception(
             (
                 'The following error was encountered during the debug'
-                f' request with payload, {args.payload}:'
+                f' request with payload, {payload}:'
             )
         ) from exc
+    if args.output:
+        if 'cpu_profile' in result:
+            with open(f'{args.output}.folded', 'w', encoding='utf-8') as f:
+                f.write(result['cpu_profile'].pop('folded'))
+            print(f'The CPU profile is written to {args.output}.folded')
+        if 'heap_profile' in result:
+            with open(f'{args.output}.heap.json', 'w', encoding='utf-8') as f:
+                json.dump(result.pop('heap_profile'), f, indent=2)
+            print(f'The heap profile is written to {args.output}.heap.json')
     print(f'The result returned by the debug handler:\n{result}')
 
 
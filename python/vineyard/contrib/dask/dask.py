@@ -27,6 +27,7 @@ import vineyard
 from dask.distributed import Client
 from vineyard.data.dataframe import make_global_dataframe
 from vineyard.data.tensor import make_global_tensor
+from vineyard.data.utils import normalize_dtype
 
 
 def dask_array_builder(client, value, builder, **kw):
@@ -55,38 +56,62 @@ def dask_dataframe_builder(client, value, builder, **kw):
     return make_global_dataframe(client, blocks)
 
 
-def dask_array_resolver(obj, resolver, **kw):
-    def get_partition(obj_id):
-        client = vineyard.connect()
-        np_value = client.get(obj_id)
-        return da.from_array(np_value)
+def _get_partition(obj_id):
+    '''Resolve the partition through the shared memory of the vineyard instance
+    that the worker connects to, the partition is migrated to there first if it
+    lives on another instance.
+    '''
+    client = vineyard.connect()
+    meta = client.get_meta(obj_id, sync_remote=True)
+    if meta.instance_id != client.instance_id:
+        obj_id = client.migrate(obj_id)
+    return client.get(obj_id)
+
+
+def _submit_partition(dask_client, partition, **kw):
+    '''Resolve the partition on the dask worker that is co-located with the
+    vineyard instance of the partition. Only the object id is sent to the worker
+    and the resolved value stays there, rather than being gathered afterwards.
+    '''
+    # we expect the 1-on-1 alignment of vineyard instances and dask workers, where
+    # dask_workers maps vineyard instance_ids into names of dask workers.
+    worker = kw.get('dask_workers', {}).get(partition.instance_id, None)
+    if worker is None:
+        return dask_client.submit(_get_partition, partition.id, pure=False)
+    return dask_client.submit(
+        _get_partition,
+        partition.id,
+        workers={worker},
+        allow_other_workers=True,
+        pure=False,
+    )
+
 
+def dask_array_resolver(obj, resolver, **kw):
     meta = obj.meta
     num = int(meta['partitions_-size'])
     dask_client = Client(kw['dask_scheduler'])
-    futures = []
+    arrays = []
     indices = []
     with_index = True
     for i in range(num):
-        ts = meta.get_member('partitions_-%d' % i)
-        instance_id = int(ts.meta['instance_id'])
+        ts = meta['partitions_-%d' % i]
 
-        partition_index = json.loads(ts.meta['partition_index_'])
+        partition_index = json.loads(ts['partition_index_'])
         if partition_index:
             indices.append((partition_index[0], partition_index[1], i))
         else:
             with_index = False
 
-        futures.append(
-            # we require the 1-on-1 alignment of vineyard instances and dask workers.
-            # vineyard_sockets maps vineyard instance_ids into ipc_sockets, while
-            # dask_workers maps vineyard instance_ids into names of dask workers.
-            dask_client.submit(
-                get_partition, ts.meta.id, workers={kw['dask_workers'][instance_id]}
+        arrays.append(
+            da.from_delayed(
+                _submit_partition(dask_client, ts, **kw),
+                shape=tuple(json.loads(ts['shape_'])),
+                dtype=normalize_dtype(
+                    ts['value_type_'], ts.get('value_type_meta_', None)
+                ),
             )
         )
-
-    arrays = dask_client.gather(futures)
     if with_index:
         indices = list(sorted(indices))
         nx = indices[-1][0] + 1
@@ -104,29 +129,15 @@ def dask_array_resolver(obj, resolver, **kw):
 
 
 def dask_dataframe_resolver(obj, resolver, **kw):
-    def get_partition(obj_id):
-        client = vineyard.connect()
-        df = client.get(obj_id)
-        return dd.from_pandas(df, npartitions=1)
-
     meta = obj.meta
     num = int(meta['partitions_-size'])
     dask_client = Client(kw['dask_scheduler'])
     futures = []
     for i in range(num):
-        df = meta.get_member('partitions_-%d' % i)
-        instance_id = int(df.meta['instance_id'])
-        futures.append(
-            # we require the 1-on-1 alignment of vineyard instances and dask workers.
-            # vineyard_sockets maps vineyard instance_ids into ipc_sockets, while
-            # dask_workers maps vineyard instance_ids into names of dask workers.
-            dask_client.submit(
-                get_partition, df.meta.id, workers={kw['dask_workers'][instance_id]}
-            )
-        )
-
-    dfs = dask_client.gather(futures)
-    return dd.concat(dfs, axis=0)
+        df = meta['partitions_-%d' % i]
+        futures.append(_submit_partition(dask_client, df, **kw))
+    # the meta of the dataframe is inferred on the workers as well
+    return dd.from_delayed(futures)
 
 
 def register_dask_types(builder_ctx, resolver_ctx):
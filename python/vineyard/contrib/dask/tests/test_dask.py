@@ -24,6 +24,9 @@ import numpy as np
 import pandas as pd
 import pytest
 import vineyard
+from dask.distributed import Client
+from dask.distributed import wait
+from vineyard.contrib.dask.dask import _submit_partition
 from vineyard.contrib.dask.dask import register_dask_types
 from vineyard.core.builder import builder_context
 from vineyard.core.resolver import resolver_context
@@ -145,3 +148,50 @@ def test_dask_dataframe_roundtrip(dask_cluster):
     pd.testing.assert_frame_equal(
         df1.compute(), pd.DataFrame({'a': np.ones(1024), 'b': np.ones(1024)})
     )
+
+
+def test_dask_partitions_resolved_on_colocated_workers(dask_cluster):
+    clients, dask_scheduler, dask_workers = dask_cluster
+    dask_client = Client(dask_scheduler)
+    names = {
+        address: info['name']
+        for address, info in dask_client.scheduler_info()['workers'].items()
+    }
+
+    chunks = []
+    for i, client in enumerate(clients):
+        chunk = client.put(np.arange(8).reshape(1, 8) + i * 8, partition_index=[i, 0])
+        client.persist(chunk)
+        chunks.append(chunk)
+    gtensor = make_global_tensor(clients[0], chunks)
+
+    # each partition stays on the worker of its vineyard instance
+    meta = clients[0].get_meta(gtensor.id)
+    futures = []
+    for i in range(int(meta['partitions_-size'])):
+        partition = meta['partitions_-%d' % i]
+        futures.append(
+            (
+                partition.instance_id,
+                _submit_partition(dask_client, partition, dask_workers=dask_workers),
+            )
+        )
+    wait([future for _, future in futures])
+    who_has = dask_client.who_has([future for _, future in futures])
+    for instance_id, future in futures:
+        assert [names[address] for address in who_has[future.key]] == [
+            dask_workers[instance_id]
+        ]
+
+    # the shape and dtype are known without resolving the partitions
+    darr = clients[0].get(
+        gtensor.id, dask_scheduler=dask_scheduler, dask_workers=dask_workers
+    )
+    expected = np.arange(8 * len(clients)).reshape(len(clients), 8)
+    assert darr.shape == expected.shape
+    assert darr.dtype == expected.dtype
+    np.testing.assert_array_equal(darr.compute(), expected)
+
+    # the instances without a mapped worker are accepted as well
+    darr = clients[0].get(gtensor.id, dask_scheduler=dask_scheduler, dask_workers={})
+    np.testing.assert_array_equal(darr.compute(), expected)
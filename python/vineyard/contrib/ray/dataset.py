@@ -36,7 +36,10 @@ from .actor import spread_to_all_nodes
 def _block_to_vineyard(block: Block):
     client = vineyard.connect()
     block = BlockAccessor.for_block(block)
-    return client.put(block.to_pandas())
+    object_id = client.put(block.to_pandas())
+    # the partitions of global objects must be visible to the other instances
+    client.persist(object_id)
+    return object_id
 
 
 def to_vineyard(self):
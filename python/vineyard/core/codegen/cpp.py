@@ -113,6 +113,11 @@ post_construct_meth_tpl = '''
 construct_meta_tpl = '''
     meta.GetKeyValue("{name}", this->{name});'''
 
+construct_meta_optional_tpl = '''
+    if (meta.Haskey("{name}")) {{
+        meta.GetKeyValue("{name}", this->{name});
+    }}'''
+
 construct_plain_tpl = '''
     this->{name}.Construct(meta.GetMemberMeta("{name}"));'''
 
@@ -175,7 +180,10 @@ def codegen_construct(
         name = field.spelling
         spec = parse_codegen_spec(kind)
         if spec.is_meta:
-            tpl = construct_meta_tpl
+            if spec.optional:
+                tpl = construct_meta_optional_tpl
+            else:
+                tpl = construct_meta_tpl
         if spec.is_plain:
             if spec.star:
                 tpl = construct_plain_star_tpl
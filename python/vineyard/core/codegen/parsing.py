@@ -47,6 +47,10 @@ except ImportError:
 #   __attribute__((annotate("codegen"))):
 #       meta codegen
 #
+#   __attribute__((annotate("codegen?"))):
+#       optional meta codegen, the field keeps its default value when the key
+#       is absent from the metadata
+#
 #   __attribute__((annotate("codegen:Type"))):
 #       member type: Type member_
 #
@@ -76,6 +80,7 @@ except ImportError:
 class CodeGenKind:
     def __init__(self, kind='meta', element_type=None):
         self.kind = kind
+        self.optional = False
         if element_type is None:
             self.element_type = None
             self.star = ''
@@ -172,6 +177,10 @@ def parse_codegen_spec(kind):
         kind = kind[len('vineyard') :]
     if kind.startswith('codegen'):
         kind = kind[len('codegen') :]
+    if kind == '?':
+        spec = parse_meta.parse('')
+        spec.optional = True
+        return spec
     if kind.startswith(':'):
         kind = kind[1:]
     return codegen_spec_parser.parse(kind)
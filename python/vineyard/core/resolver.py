@@ -40,6 +40,13 @@ class ResolverContext:
     def register(self, typename_prefix, resolver):
         self.__factory[typename_prefix] = resolver
 
+    def lookup(self, typename):
+        '''Find the resolver that will be used for the given typename, or
+        :code:`None` if there's no matched resolver.
+        '''
+        _, resolver = find_most_precise_match(typename, self.__factory)
+        return resolver
+
     def run(self, obj, **kw):
         typename = obj.meta.typename
         prefix, resolver = find_most_precise_match(typename, self.__factory)
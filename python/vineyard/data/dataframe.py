@@ -52,6 +52,8 @@ from vineyard._C import ObjectID
 from vineyard._C import ObjectMeta
 
 from .tensor import ndarray
+from .tensor import numpy_ndarray_from_members
+from .tensor import numpy_ndarray_resolver
 from .utils import expand_slice
 from .utils import from_json
 from .utils import normalize_dtype
@@ -104,9 +106,24 @@ def pandas_dataframe_resolver(obj, resolver):
     # ensure zero-copy
     blocks = []
     index_size = 0
+    # resolves the tensor columns in a single call when they are resolved to
+    # numpy arrays
+    members = obj.tensor_members(
+        ['__values_-value-%d' % idx for idx in range(len(columns))]
+    )
     for idx, _ in enumerate(columns):
         names.append(from_json(meta['__values_-key-%d' % idx]))
-        np_value = resolver.run(obj.member('__values_-value-%d' % idx))
+        member = members[idx]
+        if (
+            member is not None
+            and resolver.lookup(member['typename']) is numpy_ndarray_resolver
+        ):
+            # the blob is referenced by the buffer of the array, and the tensor
+            # is kept for reusing it when the column is put again
+            np_value = numpy_ndarray_from_members(member)
+            setattr(np_value, '__vineyard_ref', member['object'])
+        else:
+            np_value = resolver.run(obj.member('__values_-value-%d' % idx))
         index_size = len(np_value)
         # ndim: 1 for SingleBlockManager/Series, 2 for BlockManager/DataFrame
         if BlockPlacement:
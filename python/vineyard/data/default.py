@@ -24,23 +24,50 @@ if pickle.HIGHEST_PROTOCOL < 5:
 from vineyard._C import ObjectMeta
 
 
+# the smaller buffers are kept in the pickled payload
+OUT_OF_BAND_THRESHOLD = 64 * 1024
+
+
 def default_builder(client, value, **kwargs):
-    '''Default builder: pickle (version 5), then build a blob object for it.'''
-    payload = pickle.dumps(value, protocol=5)
+    '''Default builder: pickle (version 5), then build a blob object for it.
+
+    The large buffers (e.g., of numpy arrays) inside the value are pickled
+    out-of-band, and each of them is copied into its own blob natively,
+    thus they are resolved zero-copy.
+    '''
+    buffers = []
+
+    def buffer_callback(buffer):
+        if buffer.raw().nbytes < OUT_OF_BAND_THRESHOLD:
+            return True  # in-band
+        buffers.append(buffer.raw())
+        return False
+
+    payload = pickle.dumps(value, protocol=5, buffer_callback=buffer_callback)
     buffer = client.create_blob(len(payload))
     buffer.copy(0, payload)
 
     meta = ObjectMeta(**kwargs)
     meta['typename'] = 'vineyard::PickleBuffer'
-    meta['nbytes'] = len(payload)
+    meta['nbytes'] = len(payload) + sum(buf.nbytes for buf in buffers)
     meta['size_'] = len(payload)
     meta.add_member('buffer_', buffer.seal(client))
+    meta['__buffers_-size'] = len(buffers)
+    if buffers:
+        blobs = client.create_blobs_from_buffers(buffers)
+        for idx, blob in enumerate(blobs):
+            meta.add_member('__buffers_-%d' % idx, blob)
     return client.create_metadata(meta)
 
 
 def default_resolver(obj):
-    view = memoryview(obj.member('buffer_'))[0 : int(obj.meta['size_'])]
-    return pickle.loads(view, fix_imports=True)
+    meta = obj.meta
+    view = memoryview(obj.member('buffer_'))[0 : int(meta['size_'])]
+    buffers = [
+        memoryview(obj.member('__buffers_-%d' % idx))
+        for idx in range(int(meta.get('__buffers_-size', 0)))
+    ]
+    return pickle.loads(view, fix_imports=True, buffers=buffers)
 
 
 def register_default_types(builder_ctx=None, resolver_ctx=None):
@@ -62,33 +62,63 @@ def numpy_ndarray_builder(client, value, **kw):
     meta['partition_index_'] = to_json(kw.get('partition_index', []))
     meta['nbytes'] = value.nbytes
     meta['order_'] = to_json(('C' if value.flags['C_CONTIGUOUS'] else 'F'))
-    meta.add_member('buffer_', build_numpy_buffer(client, value))
+    if (
+        value.dtype.name != 'object'
+        and value.flags['F_CONTIGUOUS']
+        and not value.flags['C_CONTIGUOUS']
+    ):
+        # column-major arrays are kept as is, the transpose is a row-major
+        # view of the same memory
+        meta['layout_'] = 'F'
+        meta.add_member('buffer_', build_numpy_buffer(client, value.T))
+    else:
+        meta.add_member('buffer_', build_numpy_buffer(client, value))
     return client.create_metadata(meta)
 
 
-def numpy_ndarray_resolver(obj):
-    meta = obj.meta
-    value_name = meta['value_type_']
+def numpy_ndarray_from_members(members):
+    '''Build the ndarray from the tensor members resolved by
+    :meth:`Object.tensor_members`, without crossing the C++ boundary.
+    '''
+    value_name = members['value_type_']
     if value_name == 'object':
-        view = memoryview(obj.member('buffer_'))
+        view = memoryview(members['buffer_'])
         return pickle.loads(view, fix_imports=True)
 
-    value_type = normalize_dtype(value_name, meta.get('value_type_meta_', None))
-    shape = from_json(meta['shape_'])
-    if 'order_' in meta:
-        order = from_json(meta['order_'])
+    value_type = normalize_dtype(value_name, members.get('value_type_meta_', None))
+    shape = from_json(members['shape_'])
+    if 'order_' in members:
+        order = from_json(members['order_'])
     else:
         order = 'C'
     if np.prod(shape) == 0:
         return np.zeros(shape, dtype=value_type)
-    c_array = np.frombuffer(
-        memoryview(obj.member('buffer_')), dtype=value_type
-    ).reshape(shape)
+    if members.get('layout_', 'C') == 'F':
+        array = np.frombuffer(memoryview(members['buffer_']), dtype=value_type)
+        return array.reshape(shape, order='F').view(ndarray)
+    c_array = np.frombuffer(memoryview(members['buffer_']), dtype=value_type).reshape(
+        shape
+    )
     # TODO: revise the memory copy of asfortranarray
     array = c_array if order == 'C' else np.asfortranarray(c_array)
     return array.view(ndarray)
 
 
+def numpy_ndarray_resolver(obj):
+    meta = obj.meta
+    members = {
+        'value_type_': meta['value_type_'],
+        'value_type_meta_': meta.get('value_type_meta_', None),
+        'shape_': meta['shape_'],
+        'buffer_': obj.member('buffer_'),
+    }
+    if 'order_' in meta:
+        members['order_'] = meta['order_']
+    if 'layout_' in meta:
+        members['layout_'] = meta['layout_']
+    return numpy_ndarray_from_members(members)
+
+
 def bsr_matrix_builder(client, value, builder, **kw):
     meta = ObjectMeta()
     meta['typename'] = 'vineyard::BSRMatrix<%s>' % value.dtype.name
@@ -22,6 +22,7 @@ import pytest
 import vineyard
 from vineyard.core import default_builder_context
 from vineyard.core import default_resolver_context
+from vineyard.core import resolver_context
 from vineyard.data import register_builtin_types
 
 register_builtin_types(default_builder_context, default_resolver_context)
@@ -135,3 +136,50 @@ def test_dataframe_reusing(vineyard_client):
     assert ob is not None
     assert ob2 is not None
     assert ob.id == ob2.id
+
+
+def test_dataframe_tensor_members(vineyard_client):
+    dtypes = [np.int32, np.int64, np.float64]
+    df = pd.DataFrame(
+        {'c%d' % idx: np.arange(100, dtype=dtypes[idx % 3]) for idx in range(300)}
+    )
+    object_id = vineyard_client.put(df)
+    obj = vineyard_client.get_object(object_id)
+
+    names = ['__values_-value-%d' % idx for idx in range(len(df.columns))]
+    members = obj.tensor_members(names + ['__values_-key-0', 'not-a-member'])
+    assert len(members) == len(names) + 2
+    for idx, member in enumerate(members[: len(names)]):
+        assert member['typename'].startswith('vineyard::Tensor<')
+        assert member['buffer_'].size == df.iloc[:, idx].values.nbytes
+        assert member['object'].id == obj.member(names[idx]).id
+    assert members[-2] is None
+    assert members[-1] is None
+
+    # the columns are resolved on the blobs, and keep their tensors
+    value = vineyard_client.get(object_id)
+    for block in value._mgr.blocks:
+        ref = getattr(block.values, '__vineyard_ref', None)
+        assert ref is not None
+        assert ref.id == obj.member(names[block.mgr_locs.indexer.start]).id
+    pd.testing.assert_frame_equal(df, value)
+
+
+def test_dataframe_with_tensor_resolver(vineyard_client):
+    df = pd.DataFrame({'a': np.arange(10), 'b': np.arange(10, 20)})
+    object_id = vineyard_client.put(df)
+
+    resolved = []
+
+    def tensor_resolver(obj):
+        resolved.append(obj.id)
+        return np.full(10, -1)
+
+    # the registered tensor resolvers are still used for the columns
+    with resolver_context({'vineyard::Tensor': tensor_resolver}):
+        value = vineyard_client.get(object_id)
+    assert len(resolved) == 2
+    assert (value.values == -1).all()
+
+    # and the columns are resolved in one call again outside the context
+    pd.testing.assert_frame_equal(df, vineyard_client.get(object_id))
@@ -56,3 +56,43 @@ def test_dict(vineyard_client):
     value = {1: 2, 3: 4, 5: None, None: 6}
     object_id = vineyard_client.put(value)
     assert vineyard_client.get(object_id) == value
+
+
+class Arrays:
+    def __init__(self, large, small):
+        self.large = large
+        self.small = small
+
+
+def test_pickle_out_of_band_buffers(vineyard_client):
+    large = np.arange(1024 * 1024, dtype=np.int64)
+    small = np.arange(16, dtype=np.int64)
+    value = Arrays([large, large[::2].copy()], small)
+    object_id = vineyard_client.put(value)
+
+    # the large buffers become blobs, and the small ones stay in the payload
+    obj = vineyard_client.get_object(object_id)
+    assert obj.typename == 'vineyard::PickleBuffer'
+    assert int(obj.meta['__buffers_-size']) == 2
+    assert obj.member('__buffers_-0').size == large.nbytes
+    assert obj.member('__buffers_-1').size == large.nbytes // 2
+
+    result = vineyard_client.get(object_id)
+    np.testing.assert_array_equal(result.large[0], large)
+    np.testing.assert_array_equal(result.large[1], large[::2])
+    np.testing.assert_array_equal(result.small, small)
+    # the arrays are rebuilt on the shared memory of the blobs
+    assert not result.large[0].flags.owndata
+
+
+def test_create_blobs_from_buffers(vineyard_client):
+    large = np.arange(1024 * 1024, dtype=np.float64)
+    buffers = [b'abcdef', bytearray(b'x' * 100), large]
+    blobs = vineyard_client.create_blobs_from_buffers(buffers)
+    assert len(blobs) == len(buffers)
+    for blob, buffer in zip(blobs, buffers):
+        assert bytes(memoryview(blob)) == bytes(memoryview(buffer))
+
+    # the buffers must be contiguous
+    with pytest.raises(ValueError):
+        vineyard_client.create_blobs_from_buffers([large[::2]])
@@ -98,6 +98,43 @@ def test_tensor_order(vineyard_client):
     assert res.flags['F_CONTIGUOUS'] == arr.flags['F_CONTIGUOUS']
 
 
+def test_tensor_layout(vineyard_client):
+    arr = np.asfortranarray(np.random.rand(30, 40, 5))
+    object_id = vineyard_client.put(arr)
+    assert vineyard_client.get_meta(object_id)['layout_'] == 'F'
+    res = vineyard_client.get(object_id)
+    assert res.flags['F_CONTIGUOUS']
+    np.testing.assert_allclose(arr, res)
+
+
+def test_tensor_dlpack(vineyard_client):
+    arrays = [
+        np.arange(120, dtype=np.int64).reshape(4, 5, 6),
+        np.asfortranarray(np.random.rand(7, 9).astype(np.float32)),
+    ]
+    for arr in arrays:
+        tensor = vineyard_client.get_object(vineyard_client.put(arr))
+        assert tensor.__dlpack_device__() == (1, 0)
+        if hasattr(np, 'from_dlpack'):
+            np.testing.assert_equal(arr, np.from_dlpack(tensor))
+
+    # only the tensors are exported
+    dataframe = vineyard_client.get_object(
+        vineyard_client.put(pd.DataFrame({'a': np.arange(10)}))
+    )
+    with pytest.raises(vineyard.NotImplementedException):
+        dataframe.__dlpack__()
+
+
+def test_tensor_dlpack_torch(vineyard_client):
+    torch = pytest.importorskip('torch')
+    arr = np.asfortranarray(np.random.rand(6, 8))
+    tensor = torch.from_dlpack(vineyard_client.get_object(vineyard_client.put(arr)))
+    assert tuple(tensor.shape) == arr.shape
+    assert tensor.stride() == (1, 6)
+    np.testing.assert_allclose(arr, tensor.numpy())
+
+
 @pytest.mark.skipif(sp is None, reason="scipy.sparse is not available")
 def test_bsr_matrix(vineyard_client):
     arr = sp.sparse.bsr_matrix((3, 4), dtype=np.int8)
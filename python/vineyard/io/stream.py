@@ -16,8 +16,11 @@
 # limitations under the License.
 #
 
+import asyncio
 import json
 import logging
+import queue
+import threading
 import traceback
 from typing import Dict
 from typing import List
@@ -27,6 +30,7 @@ from .._C import ObjectID
 from .._C import ObjectMeta
 from .._C import StreamDrainedException
 from ..core.driver import registerize
+from ..core.resolver import get_current_resolvers
 from ..core.resolver import resolver_context
 
 logger = logging.getLogger('vineyard')
@@ -179,6 +183,12 @@ class BaseStream:
             except StreamDrainedException as e:
                 raise StopIteration('No more chunks') from e
 
+        def prefetch(self, depth: int = 2) -> "PrefetchingReader":
+            '''Resolve up to :code:`depth` chunks ahead of the consumer in a
+            background thread, see also :class:`PrefetchingReader`.
+            '''
+            return PrefetchingReader(self, depth)
+
         def __str__(self) -> str:
             return repr(self)
 
@@ -261,6 +271,107 @@ class BaseStream:
         return self._writer
 
 
+class PrefetchingReader:
+    '''Wraps a stream reader to keep up to :code:`depth` chunks pulled and
+    resolved ahead of the consumer by a background thread, which waits for the
+    chunks without holding the GIL. The reader can be consumed both as an
+    iterator and as an asynchronous iterator in asyncio:
+
+    .. code:: python
+
+        >>> for chunk in stream.reader.prefetch(4):
+        ...     ...
+
+        >>> async for chunk in stream.reader.prefetch(4):
+        ...     ...
+
+    The chunks are resolved with the resolvers that are current when the
+    prefetching reader is created. The errors of the underlying reader, e.g.,
+    a failed stream, are raised to the consumer in order.
+    '''
+
+    _END = object()
+
+    def __init__(self, reader: BaseStream.Reader, depth: int = 2):
+        if depth < 1:
+            raise ValueError('The prefetch depth must be positive')
+        self._reader = reader
+        self._resolvers = get_current_resolvers()
+        self._queue = queue.Queue(maxsize=depth)
+        self._stopped = threading.Event()
+        self._drained = False
+        self._thread = threading.Thread(target=self._prefetch, daemon=True)
+        self._thread.start()
+
+    def _prefetch(self):
+        with resolver_context(base=self._resolvers):
+            while not self._stopped.is_set():
+                try:
+                    item = (self._reader.next(), None)
+                except StopIteration:
+                    item = (PrefetchingReader._END, None)
+                except Exception as e:  # pylint: disable=broad-except
+                    item = (None, e)
+                while not self._stopped.is_set():
+                    try:
+                        self._queue.put(item, timeout=0.1)
+                        break
+                    except queue.Full:
+                        continue
+                if item[0] is PrefetchingReader._END or item[1] is not None:
+                    return
+
+    def _next_or_end(self):
+        if self._drained:
+            return PrefetchingReader._END
+        chunk, error = self._queue.get()
+        if chunk is PrefetchingReader._END or error is not None:
+            self._drained = True
+        if error is not None:
+            raise error
+        return chunk
+
+    def next(self) -> object:
+        chunk = self._next_or_end()
+        if chunk is PrefetchingReader._END:
+            raise StopIteration('No more chunks')
+        return chunk
+
+    def close(self):
+        '''Stop prefetching, the chunk that is being waited for by the background
+        thread is discarded once it arrives.
+        '''
+        self._stopped.set()
+        self._drained = True
+
+    def __iter__(self):
+        return self
+
+    def __next__(self):
+        return self.next()
+
+    def __aiter__(self):
+        return self
+
+    async def __anext__(self):
+        # StopIteration cannot be raised through futures
+        chunk = await asyncio.get_running_loop().run_in_executor(
+            None, self._next_or_end
+        )
+        if chunk is PrefetchingReader._END:
+            raise StopAsyncIteration
+        return chunk
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, exc_traceback):
+        self.close()
+
+    def __repr__(self) -> str:
+        return 'Prefetching %r' % self._reader
+
+
 class StreamCollection:
     '''A stream collection is a set of stream, where each element is a stream, or,
     another stream collection.
@@ -341,6 +452,7 @@ __all__ = [
     'read',
     'write',
     'BaseStream',
+    'PrefetchingReader',
     'StreamCollection',
     'register_stream_collection_types',
 ]
@@ -16,6 +16,7 @@
 # limitations under the License.
 #
 
+import asyncio
 import logging
 import threading
 import time
@@ -88,3 +89,39 @@ def test_recordbatch_stream(vineyard_client):
 
     thread1.join()
     thread2.join()
+
+
+def test_prefetching_reader(vineyard_client):
+    total_chunks = 10
+
+    stream = RecordBatchStream.new(vineyard_client)
+    writer = vineyard_client.fork().get(stream.id).writer
+    produced = []
+    for _ in range(total_chunks):
+        chunk = generate_random_dataframe({'a': np.dtype('int')}, 4)
+        writer.append(vineyard_client.put(chunk))
+        produced.append(chunk)
+    writer.finish()
+
+    with vineyard_client.fork().get(stream.id).reader.prefetch(3) as reader:
+        consumed = list(reader)
+    assert len(consumed) == total_chunks
+    for expected, chunk in zip(produced, consumed):
+        pd.testing.assert_frame_equal(expected, chunk)
+
+
+def test_prefetching_reader_async(vineyard_client):
+    total_chunks = 10
+
+    stream = RecordBatchStream.new(vineyard_client)
+    writer = vineyard_client.fork().get(stream.id).writer
+    for _ in range(total_chunks):
+        chunk = generate_random_dataframe({'a': np.dtype('int')}, 4)
+        writer.append(vineyard_client.put(chunk))
+    writer.finish()
+
+    async def consume():
+        reader = vineyard_client.fork().get(stream.id).reader.prefetch(3)
+        return [chunk async for chunk in reader]
+
+    assert len(asyncio.run(consume())) == total_chunks
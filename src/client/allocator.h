@@ -75,8 +75,17 @@ struct VineyardAllocator : public memory::Jemalloc {
     sizes_.emplace_back(allocated_size);
     freezed_.emplace(reinterpret_cast<uintptr_t>(ptr));
     ObjectID id = base_ + (reinterpret_cast<uintptr_t>(ptr) - space_);
-    return Blob::FromBuffer(client_, id, reinterpret_cast<uintptr_t>(ptr),
-                            allocated_size);
+    return Blob::FromBuffer(client_, id, allocated_size,
+                            reinterpret_cast<uintptr_t>(ptr));
+  }
+
+  /**
+   * @brief Whether the pointer lies in the shared memory arena of this
+   * allocator.
+   */
+  bool Owns(const void* ptr) const {
+    uintptr_t pointer = reinterpret_cast<uintptr_t>(ptr);
+    return pointer >= space_ && pointer < space_ + available_size_;
   }
 
   Status Release() {
@@ -0,0 +1,154 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "client/async_client.h"
+
+#include <utility>
+
+namespace vineyard {
+
+AsyncClient::AsyncClient() {}
+
+AsyncClient::~AsyncClient() { Close(); }
+
+Status AsyncClient::Open(Client& client, size_t const parallelism) {
+  RETURN_ON_ASSERT(client.Connected(), "The client is not connected");
+  RETURN_ON_ASSERT(parallelism > 0, "The parallelism must be positive");
+  std::lock_guard<std::mutex> open_guard(open_mutex_);
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    RETURN_ON_ASSERT(workers_.empty(), "The async client has been opened");
+    stopped_ = false;
+  }
+  for (size_t index = 0; index < parallelism; ++index) {
+    std::unique_ptr<Client> forked(new Client());
+    auto status = client.Fork(*forked);
+    if (!status.ok()) {
+      stop();
+      return status;
+    }
+    clients_.emplace_back(std::move(forked));
+  }
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto& forked : clients_) {
+      Client* target = forked.get();
+      workers_.emplace_back([this, target]() { work(*target); });
+    }
+  }
+  return Status::OK();
+}
+
+void AsyncClient::Close() {
+  std::lock_guard<std::mutex> open_guard(open_mutex_);
+  stop();
+}
+
+void AsyncClient::stop() {
+  std::vector<std::thread> workers;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stopped_ = true;
+    // the later submissions are rejected once the workers are taken
+    workers.swap(workers_);
+  }
+  cv_.notify_all();
+  for (auto& worker : workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  for (auto& client : clients_) {
+    client->Disconnect();
+  }
+  clients_.clear();
+}
+
+std::future<Status> AsyncClient::GetData(const ObjectID id, json& tree,
+                                         const bool sync_remote,
+                                         const bool wait) {
+  return Submit([id, &tree, sync_remote, wait](Client& client) {
+    return client.GetData(id, tree, sync_remote, wait);
+  });
+}
+
+std::future<Status> AsyncClient::GetMetaData(const ObjectID id,
+                                             ObjectMeta& meta_data,
+                                             const bool sync_remote) {
+  return Submit([id, &meta_data, sync_remote](Client& client) {
+    return client.GetMetaData(id, meta_data, sync_remote);
+  });
+}
+
+std::future<Status> AsyncClient::GetMetaData(
+    const std::vector<ObjectID>& ids, std::vector<ObjectMeta>& meta_datas,
+    const bool sync_remote) {
+  return Submit([ids, &meta_datas, sync_remote](Client& client) {
+    return client.GetMetaData(ids, meta_datas, sync_remote);
+  });
+}
+
+std::future<Status> AsyncClient::CreateMetaData(ObjectMeta& meta_data,
+                                                ObjectID& id) {
+  return Submit([&meta_data, &id](Client& client) {
+    return client.CreateMetaData(meta_data, id);
+  });
+}
+
+std::future<Status> AsyncClient::Persist(const ObjectID id) {
+  return Submit([id](Client& client) { return client.Persist(id); });
+}
+
+std::future<Status> AsyncClient::DelData(const ObjectID id, const bool force,
+                                         const bool deep) {
+  return Submit([id, force, deep](Client& client) {
+    return client.DelData(id, force, deep);
+  });
+}
+
+std::future<Status> AsyncClient::Submit(std::function<Status(Client&)> task) {
+  std::packaged_task<Status(Client&)> packaged(std::move(task));
+  auto result = packaged.get_future();
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (stopped_ || workers_.empty()) {
+      std::promise<Status> failed;
+      failed.set_value(Status::Invalid("The async client is not opened"));
+      return failed.get_future();
+    }
+    tasks_.emplace_back(std::move(packaged));
+  }
+  cv_.notify_one();
+  return result;
+}
+
+void AsyncClient::work(Client& client) {
+  while (true) {
+    std::packaged_task<Status(Client&)> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return stopped_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        // drains the submitted tasks before stop
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task(client);
+  }
+}
+
+}  // namespace vineyard
@@ -0,0 +1,102 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_CLIENT_ASYNC_CLIENT_H_
+#define SRC_CLIENT_ASYNC_CLIENT_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/json.h"
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief AsyncClient issues requests to vineyard without blocking the caller,
+ * the requests are served by a fixed number of connections forked from a
+ * connected client, so that many requests (e.g., metadata fetches of many
+ * objects) are in flight at the same time without a thread per request.
+ *
+ * The results are stored in the arguments passed by reference, which must be
+ * kept alive until the returned future is ready.
+ */
+class AsyncClient {
+ public:
+  AsyncClient();
+
+  ~AsyncClient();
+
+  /**
+   * @brief Fork `parallelism` connections from the connected `client`.
+   */
+  Status Open(Client& client, size_t const parallelism = 4);
+
+  /**
+   * @brief Wait for the submitted requests and close the connections.
+   */
+  void Close();
+
+  std::future<Status> GetData(const ObjectID id, json& tree,
+                              const bool sync_remote = false,
+                              const bool wait = false);
+
+  std::future<Status> GetMetaData(const ObjectID id, ObjectMeta& meta_data,
+                                  const bool sync_remote = false);
+
+  std::future<Status> GetMetaData(const std::vector<ObjectID>& ids,
+                                  std::vector<ObjectMeta>& meta_datas,
+                                  const bool sync_remote = false);
+
+  std::future<Status> CreateMetaData(ObjectMeta& meta_data, ObjectID& id);
+
+  std::future<Status> Persist(const ObjectID id);
+
+  std::future<Status> DelData(const ObjectID id, const bool force = false,
+                              const bool deep = true);
+
+  /**
+   * @brief Run the `task` on one of the connections.
+   */
+  std::future<Status> Submit(std::function<Status(Client&)> task);
+
+ private:
+  void work(Client& client);
+
+  // stops the workers and disconnects the forked clients
+  void stop();
+
+  std::mutex open_mutex_;  // serializes `Open()` and `Close()`
+  std::vector<std::unique_ptr<Client>> clients_;  // guarded by `open_mutex_`
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;  // protects `tasks_`, `stopped_` and `workers_`
+  std::condition_variable cv_;
+  std::deque<std::packaged_task<Status(Client&)>> tasks_;
+  bool stopped_ = false;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_CLIENT_ASYNC_CLIENT_H_
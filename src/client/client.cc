@@ -16,29 +16,48 @@ limitations under the License.
 #include "client/client.h"
 
 #include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <iterator>
 #include <limits>
 #include <map>
 #include <mutex>
 #include <set>
+#include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "boost/range/combine.hpp"
 
 #include "client/ds/blob.h"
 #include "client/io.h"
 #include "client/utils.h"
+#include "common/memory/cow.h"
+#include "common/memory/cuda.h"
 #include "common/memory/fling.h"
+#include "common/memory/ring.h"
 #include "common/util/boost.h"
 #include "common/util/protocols.h"
 
 namespace vineyard {
 
+// how long the client busy-polls the request ring for the reply, before
+// sleeping on the socket
+static constexpr std::chrono::microseconds kRingSpinWindow{50};
+
 Client::Client() : shm_(new detail::SharedMemoryManager(-1)) {}
 
-Client::~Client() { Disconnect(); }
+Client::~Client() {
+  meta_cache_.reset();
+  Disconnect();
+}
 
 Status Client::Connect() {
   auto ep = read_env("VINEYARD_IPC_SOCKET");
@@ -50,23 +69,55 @@ Status Client::Connect() {
 }
 
 Status Client::Connect(const std::string& ipc_socket) {
+  return Connect(ipc_socket, 0);
+}
+
+Status Client::Connect(const std::string& ipc_socket,
+                       size_t const ring_capacity) {
+  return connect(ipc_socket, ring_capacity, {});
+}
+
+Status Client::connect(const std::string& ipc_socket,
+                       size_t const ring_capacity,
+                       const std::vector<int>& held_fds) {
   std::lock_guard<std::recursive_mutex> guard(client_mutex_);
   RETURN_ON_ASSERT(!connected_ || ipc_socket == ipc_socket_);
   if (connected_) {
     return Status::OK();
   }
   ipc_socket_ = ipc_socket;
+  meta_cache_.reset();
+  QoSClass qos_class = QoSClass::Interactive;
+  RETURN_ON_ERROR(ParseQoSClass(read_env("VINEYARD_QOS_CLASS"), qos_class));
   RETURN_ON_ERROR(connect_ipc_socket_retry(ipc_socket, vineyard_conn_));
   std::string message_out;
-  WriteRegisterRequest(message_out);
+  WriteRegisterRequest(WireFormat::MsgPack, ring_capacity, qos_class,
+                       held_fds, read_env("VINEYARD_SESSION"), message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
   RETURN_ON_ERROR(doRead(message_in));
   std::string ipc_socket_value, rpc_endpoint_value;
+  size_t ring_capacity_value = 0;
   RETURN_ON_ERROR(ReadRegisterReply(message_in, ipc_socket_value,
                                     rpc_endpoint_value, instance_id_,
-                                    server_version_));
+                                    server_version_, wire_format_,
+                                    support_batch_, ring_capacity_value,
+                                    support_deduplication_));
   rpc_endpoint_ = rpc_endpoint_value;
+  ring_.reset();
+  if (ring_capacity_value > 0) {
+    // the fd of the request ring follows the reply
+    int ring_fd = recv_fd(vineyard_conn_);
+    RETURN_ON_ASSERT(ring_fd >= 0, "Failed to receive the request ring");
+    auto status =
+        memory::RequestRing::Open(ring_fd, ring_capacity_value, ring_);
+    close(ring_fd);
+    if (!status.ok()) {
+      std::clog << "[warn] Failed to open the request ring: "
+                << status.ToString() << std::endl;
+      ring_.reset();
+    }
+  }
   connected_ = true;
 
   if (!compatible_server(server_version_)) {
@@ -81,10 +132,61 @@ Status Client::Connect(const std::string& ipc_socket) {
   return Status::OK();
 }
 
+Status Client::doRequest(const std::string& message_out, json& message_in) {
+  if (ring_ == nullptr || !ring_->requests().TryPush(message_out)) {
+    // the ring is not available, or the request is too large for it
+    RETURN_ON_ERROR(doWrite(message_out));
+    return doRead(message_in);
+  }
+  auto& requests = ring_->requests();
+  auto& replies = ring_->replies();
+  if (requests.TakeWaiting()) {
+    std::string doorbell;
+    WriteRingDoorbell(doorbell);
+    RETURN_ON_ERROR(doWrite(doorbell));
+  }
+
+  std::string reply;
+  bool received = replies.TryPop(reply);
+  auto start = std::chrono::steady_clock::now();
+  while (!received &&
+         std::chrono::steady_clock::now() - start < kRingSpinWindow) {
+    received = replies.TryPop(reply);
+  }
+  if (!received) {
+    // sleeps on the socket until the server rings the doorbell
+    std::string doorbell;
+    replies.SetWaiting();
+    if (replies.TryPop(reply)) {
+      if (!replies.TakeWaiting()) {
+        // the server has taken the flag, and the doorbell is on the way
+        RETURN_ON_ERROR(doRead(doorbell));
+      }
+    } else {
+      RETURN_ON_ERROR(doRead(doorbell));
+      RETURN_ON_ASSERT(replies.TryPop(reply),
+                       "The reply is missing in the request ring");
+    }
+  }
+  RETURN_ON_ERROR(CATCH_JSON_ERROR([&]() -> Status {
+    message_in = DecodeMessage(reply);
+    return Status::OK();
+  }()));
+  if (IsRingOverflow(message_in)) {
+    // the reply follows on the socket
+    return doRead(message_in);
+  }
+  return Status::OK();
+}
+
 Status Client::Fork(Client& client) {
   RETURN_ON_ASSERT(!client.Connected(),
                    "The client has already been connected to vineyard server");
-  return client.Connect(ipc_socket_);
+  // segments that have been mapped by this client won't be mapped again, and
+  // the received fds won't be passed again
+  std::vector<int> held_fds = shm_->HeldFds();
+  RETURN_ON_ERROR(client.connect(ipc_socket_, 0, held_fds));
+  return client.shm_->ShareMappings(*shm_, held_fds);
 }
 
 Client& Client::Default() {
@@ -97,6 +199,13 @@ Client& Client::Default() {
 Status Client::GetMetaData(const ObjectID id, ObjectMeta& meta,
                            const bool sync_remote) {
   ENSURE_CONNECTED(this);
+  uint64_t generation = 0;
+  if (meta_cache_ && !sync_remote) {
+    if (meta_cache_->Get(id, meta)) {
+      return Status::OK();
+    }
+    generation = meta_cache_->Generation();
+  }
   json tree;
   RETURN_ON_ERROR(GetData(id, tree, sync_remote));
   meta.Reset();
@@ -111,6 +220,43 @@ Status Client::GetMetaData(const ObjectID id, ObjectMeta& meta,
       meta.SetBuffer(id, buffer->second);
     }
   }
+  if (meta_cache_ && !meta.incomplete()) {
+    meta_cache_->Put(id, meta, generation);
+  }
+  return Status::OK();
+}
+
+Status Client::GetLazyMetaData(const ObjectID id, ObjectMeta& meta,
+                               const bool sync_remote) {
+  ENSURE_CONNECTED(this);
+  std::vector<json> trees;
+  RETURN_ON_ERROR(
+      GetData(std::vector<ObjectID>{id}, trees, sync_remote, false, 0));
+  meta.Reset();
+  meta.SetMetaData(this, trees[0]);
+
+  std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
+  RETURN_ON_ERROR(GetBuffers(meta.GetBufferSet()->AllBufferIds(), buffers));
+
+  for (auto const& id : meta.GetBufferSet()->AllBufferIds()) {
+    const auto& buffer = buffers.find(id);
+    if (buffer != buffers.end()) {
+      meta.SetBuffer(id, buffer->second);
+    }
+  }
+  return Status::OK();
+}
+
+Status Client::EnableMetaCache(size_t const capacity) {
+  ENSURE_CONNECTED(this);
+  std::lock_guard<std::recursive_mutex> guard(client_mutex_);
+  if (meta_cache_) {
+    return Status::OK();
+  }
+  RETURN_ON_ASSERT(capacity > 0, "The capacity of meta cache must be positive");
+  std::unique_ptr<detail::MetaCache> cache(new detail::MetaCache(capacity));
+  RETURN_ON_ERROR(cache->Open(ipc_socket_));
+  meta_cache_ = std::move(cache);
   return Status::OK();
 }
 
@@ -145,6 +291,83 @@ Status Client::GetMetaData(const std::vector<ObjectID>& ids,
   return Status::OK();
 }
 
+Status Client::MigrateGlobalObject(const ObjectID global_id,
+                                   const std::set<InstanceID>& instances,
+                                   ObjectMeta& local_view,
+                                   size_t const parallelism) {
+  ENSURE_CONNECTED(this);
+  ObjectMeta meta;
+  RETURN_ON_ERROR(this->GetMetaData(global_id, meta, true));
+  RETURN_ON_ASSERT(meta.IsGlobal(),
+                   "Only members of global objects can be migrated");
+
+  // plans the members that are not co-located
+  ObjectMeta view;
+  std::vector<std::string> names;
+  std::vector<ObjectID> members;
+  for (auto const& item : meta.MetaData().items()) {
+    auto const& key = item.key();
+    auto const& value = item.value();
+    if (key == "id" || key == "signature" || key == "instance_id" ||
+        key == "transient") {
+      continue;
+    }
+    if (!value.is_object() || !value.contains("id")) {
+      view.MutMetaData()[key] = value;
+      continue;
+    }
+    ObjectID member_id =
+        ObjectIDFromString(value["id"].get_ref<std::string const&>());
+    InstanceID location = value.value("instance_id", UnspecifiedInstanceID());
+    if (location == instance_id_ ||
+        instances.find(location) != instances.end()) {
+      view.AddMember(key, member_id);
+    } else {
+      names.emplace_back(key);
+      members.emplace_back(member_id);
+    }
+  }
+  if (members.empty()) {
+    local_view = meta;
+    return Status::OK();
+  }
+
+  std::vector<ObjectID> results(members.size(), InvalidObjectID());
+  std::vector<Status> statuses(members.size());
+  std::atomic<size_t> next{0};
+  auto migrate = [&]() {
+    Client client;
+    auto status = this->Fork(client);
+    for (size_t idx = next++; idx < members.size(); idx = next++) {
+      statuses[idx] =
+          status.ok() ? client.MigrateObject(members[idx], results[idx])
+                      : status;
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t idx = 0;
+       idx < std::min(std::max(parallelism, static_cast<size_t>(1)),
+                      members.size());
+       ++idx) {
+    workers.emplace_back(migrate);
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  for (auto const& status : statuses) {
+    RETURN_ON_ERROR(status);
+  }
+
+  for (size_t idx = 0; idx < names.size(); ++idx) {
+    view.AddMember(names[idx], results[idx]);
+  }
+  ObjectID view_id = InvalidObjectID();
+  RETURN_ON_ERROR(this->CreateMetaData(view, view_id));
+  RETURN_ON_ERROR(this->Persist(view_id));
+  local_view = view;
+  return Status::OK();
+}
+
 Status Client::CreateBlob(size_t size, std::unique_ptr<BlobWriter>& blob) {
   ENSURE_CONNECTED(this);
 
@@ -156,10 +379,145 @@ Status Client::CreateBlob(size_t size, std::unique_ptr<BlobWriter>& blob) {
   return Status::OK();
 }
 
+Status Client::CreateBlob(size_t size, const int numa_node,
+                          std::unique_ptr<BlobWriter>& blob) {
+  return CreateBlob(size, numa_node, false, blob);
+}
+
+Status Client::CreateBlob(size_t size, const int numa_node,
+                          const bool prefault,
+                          std::unique_ptr<BlobWriter>& blob) {
+  ENSURE_CONNECTED(this);
+
+  ObjectID object_id = InvalidObjectID();
+  Payload object;
+  std::shared_ptr<arrow::MutableBuffer> buffer = nullptr;
+  RETURN_ON_ERROR(
+      CreateBuffer(size, object_id, object, buffer, numa_node, prefault));
+  blob.reset(new BlobWriter(object_id, object, buffer));
+  return Status::OK();
+}
+
+Status Client::CreateCopyOnWriteBlob(
+    const ObjectID parent, std::vector<std::pair<size_t, size_t>> const& dirty,
+    std::unique_ptr<BlobWriter>& blob) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteCreateCopyOnWriteBufferRequest(parent, dirty, message_out);
+  json message_in;
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
+  ObjectID object_id = InvalidObjectID();
+  Payload object;
+  std::vector<int> fds_sent;
+  RETURN_ON_ERROR(ReadCreateCopyOnWriteBufferReply(message_in, object_id,
+                                                   object, fds_sent));
+  RETURN_ON_ERROR(shm_->ReceiveFds(fds_sent, {object}, false, true));
+  uint8_t* dist = nullptr;
+  RETURN_ON_ERROR(shm_->MmapExtents(object, false, &dist));
+  auto buffer = std::make_shared<arrow::MutableBuffer>(dist, object.data_size);
+  blob.reset(new BlobWriter(object_id, object, buffer));
+  return Status::OK();
+}
+
+Status Client::CreateDeviceBlob(size_t size, const int device,
+                                std::unique_ptr<BlobWriter>& blob) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteCreateDeviceBufferRequest(size, device, message_out);
+  json message_in;
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
+  ObjectID object_id = InvalidObjectID();
+  Payload object;
+  RETURN_ON_ERROR(ReadCreateBufferReply(message_in, object_id, object));
+  RETURN_ON_ASSERT(static_cast<size_t>(object.data_size) == size);
+  uint8_t* dist = nullptr;
+  if (object.data_size > 0) {
+    RETURN_ON_ERROR(shm_->OpenDevice(object, &dist));
+  }
+  auto buffer = std::make_shared<arrow::MutableBuffer>(dist, object.data_size);
+  blob.reset(new BlobWriter(object_id, object, buffer));
+  return Status::OK();
+}
+
+Status Client::CreateBlobs(const std::vector<size_t>& sizes,
+                           std::vector<std::unique_ptr<BlobWriter>>& blobs) {
+  ENSURE_CONNECTED(this);
+  blobs.clear();
+  if (!support_batch_) {
+    // the fds follow each reply, requests can't be pipelined
+    for (size_t const size : sizes) {
+      std::unique_ptr<BlobWriter> blob;
+      auto status = CreateBlob(size, blob);
+      if (!status.ok()) {
+        for (auto& created : blobs) {
+          VINEYARD_DISCARD(created->Abort(*this));
+        }
+        blobs.clear();
+        return status;
+      }
+      blobs.emplace_back(std::move(blob));
+    }
+    return Status::OK();
+  }
+
+  std::vector<std::string> messages_out(sizes.size());
+  for (size_t idx = 0; idx < sizes.size(); ++idx) {
+    WriteCreateBufferRequest(sizes[idx], messages_out[idx]);
+  }
+  std::vector<json> messages_in;
+  RETURN_ON_ERROR(doBatch(messages_out, messages_in));
+  std::vector<ObjectID> ids(sizes.size(), InvalidObjectID());
+  std::vector<Payload> payloads(sizes.size());
+  Status status = Status::OK();
+  for (size_t idx = 0; idx < sizes.size(); ++idx) {
+    // keep on reading, the fds of the succeeded ones follow the batch reply
+    auto s = ReadCreateBufferReply(messages_in[idx], ids[idx], payloads[idx]);
+    if (!s.ok()) {
+      ids[idx] = InvalidObjectID();
+      payloads[idx] = Payload();
+      if (status.ok()) {
+        status = s;
+      }
+    }
+  }
+  // the server passes the unseen fds in the order of the requests
+  for (size_t idx = 0; idx < sizes.size(); ++idx) {
+    auto const& payload = payloads[idx];
+    if (ids[idx] == InvalidObjectID()) {
+      continue;
+    }
+    uint8_t *shared = nullptr, *dist = nullptr;
+    if (payload.data_size > 0) {
+      auto s =
+          shm_->Mmap(payload.store_fd, payload.map_size, false, true, &shared);
+      if (!s.ok()) {
+        if (status.ok()) {
+          status = s;
+        }
+        // the blob has been created, but can't be wrapped into a writer
+        VINEYARD_DISCARD(DropBuffer(ids[idx], payload.store_fd));
+        continue;
+      }
+      dist = shared + payload.data_offset;
+    }
+    auto buffer =
+        std::make_shared<arrow::MutableBuffer>(dist, payload.data_size);
+    blobs.emplace_back(new BlobWriter(ids[idx], payload, buffer));
+  }
+  if (!status.ok()) {
+    for (auto& blob : blobs) {
+      VINEYARD_DISCARD(blob->Abort(*this));
+    }
+    blobs.clear();
+  }
+  return status;
+}
+
 Status Client::GetNextStreamChunk(ObjectID const id, size_t const size,
                                   std::unique_ptr<arrow::MutableBuffer>& blob) {
   ENSURE_CONNECTED(this);
   std::string message_out;
+  WireFormatScope wire_format_scope(wire_format_);
   WriteGetNextStreamChunkRequest(id, size, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
@@ -216,6 +574,60 @@ Status Client::GetObject(const ObjectID id, std::shared_ptr<Object>& object) {
   return Status::OK();
 }
 
+Status Client::GetObject(const ObjectID id, std::shared_ptr<Object>& object,
+                         const bool prefetch) {
+  if (!prefetch) {
+    return GetObject(id, object);
+  }
+  ObjectMeta meta;
+  // resolves the whole tree, as well as the payloads of all reachable blobs,
+  // with a single GetData and a single GetBuffers.
+  RETURN_ON_ERROR(this->GetMetaData(id, meta, true));
+  RETURN_ON_ASSERT(!meta.MetaData().empty());
+
+  // merge the page-aligned ranges of large blobs, as blobs of the same object
+  // are usually adjacent in the shared memory.
+  static const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  std::map<uintptr_t, uintptr_t> ranges;
+  for (auto const& item : meta.GetBufferSet()->AllBuffers()) {
+    auto const& buffer = item.second;
+    if (buffer == nullptr || buffer->data() == nullptr ||
+        static_cast<size_t>(buffer->size()) < kPrefetchThreshold) {
+      continue;
+    }
+    uintptr_t begin = reinterpret_cast<uintptr_t>(buffer->data());
+    uintptr_t end = begin + buffer->size();
+    begin = begin & ~(page_size - 1);
+    end = (end + page_size - 1) & ~(page_size - 1);
+    auto next = ranges.lower_bound(begin);
+    if (next != ranges.begin()) {
+      auto prev = std::prev(next);
+      if (prev->second >= begin) {
+        begin = prev->first;
+        end = std::max(end, prev->second);
+        ranges.erase(prev);
+      }
+    }
+    while (next != ranges.end() && next->first <= end) {
+      end = std::max(end, next->second);
+      next = ranges.erase(next);
+    }
+    ranges.emplace(begin, end);
+  }
+  for (auto const& range : ranges) {
+    // the advice is a hint only, failures are harmless.
+    madvise(reinterpret_cast<void*>(range.first), range.second - range.first,
+            MADV_WILLNEED);
+  }
+
+  object = ObjectFactory::Create(meta.GetTypeName());
+  if (object == nullptr) {
+    object = std::unique_ptr<Object>(new Object());
+  }
+  object->Construct(meta);
+  return Status::OK();
+}
+
 std::vector<std::shared_ptr<Object>> Client::GetObjects(
     const std::vector<ObjectID>& ids) {
   std::vector<ObjectMeta> metas;
@@ -329,6 +741,11 @@ bool Client::IsSharedMemory(const uintptr_t target) const {
   return shm_->Exists(target);
 }
 
+bool Client::IsSharedMemory(const void* target, uintptr_t& base,
+                            size_t& size) const {
+  return shm_->Exists(reinterpret_cast<const uintptr_t>(target), base, size);
+}
+
 Status Client::AllocatedSize(const ObjectID id, size_t& size) {
   ENSURE_CONNECTED(this);
   json tree;
@@ -376,14 +793,68 @@ Status Client::ReleaseArena(const int fd, std::vector<size_t> const& offsets,
   return Status::OK();
 }
 
+Status Client::SealBuffer(const ObjectID id, Payload& payload) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WireFormatScope wire_format_scope(wire_format_);
+  WriteSealBufferRequest(id, message_out);
+  json message_in;
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
+  std::vector<int> fds_sent;
+  RETURN_ON_ERROR(ReadSealBufferReply(message_in, payload, fds_sent));
+  return shm_->ReceiveFds(fds_sent, {payload}, false, true);
+}
+
+Status Client::SealBuffers(const std::vector<ObjectID>& ids,
+                           std::vector<Payload>& payloads) {
+  ENSURE_CONNECTED(this);
+  payloads.resize(ids.size());
+  if (!support_batch_) {
+    // the fds follow each reply, requests can't be pipelined
+    for (size_t idx = 0; idx < ids.size(); ++idx) {
+      RETURN_ON_ERROR(SealBuffer(ids[idx], payloads[idx]));
+    }
+    return Status::OK();
+  }
+
+  std::vector<std::string> messages_out(ids.size());
+  WireFormatScope wire_format_scope(wire_format_);
+  for (size_t idx = 0; idx < ids.size(); ++idx) {
+    WriteSealBufferRequest(ids[idx], messages_out[idx]);
+  }
+  std::vector<json> messages_in;
+  RETURN_ON_ERROR(doBatch(messages_out, messages_in));
+  std::vector<std::vector<int>> fds_sent(ids.size());
+  Status status = Status::OK();
+  for (size_t idx = 0; idx < ids.size(); ++idx) {
+    // keep on reading, the fds of the succeeded ones follow the batch reply
+    auto s =
+        ReadSealBufferReply(messages_in[idx], payloads[idx], fds_sent[idx]);
+    if (!s.ok() && status.ok()) {
+      status = s;
+    }
+  }
+  // the server passes the unseen fds in the order of the requests
+  for (size_t idx = 0; idx < ids.size(); ++idx) {
+    RETURN_ON_ERROR(
+        shm_->ReceiveFds(fds_sent[idx], {payloads[idx]}, false, true));
+  }
+  return status;
+}
+
 Status Client::CreateBuffer(const size_t size, ObjectID& id, Payload& payload,
-                            std::shared_ptr<arrow::MutableBuffer>& buffer) {
+                            std::shared_ptr<arrow::MutableBuffer>& buffer,
+                            const int numa_node, const bool prefault) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteCreateBufferRequest(size, message_out);
-  RETURN_ON_ERROR(doWrite(message_out));
+  WireFormatScope wire_format_scope(wire_format_);
+  if (numa_node >= 0 || prefault) {
+    WriteCreateBufferRequest(size, numa_node, prefault, message_out);
+  } else {
+    WriteCreateBufferRequest(size, message_out);
+  }
   json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
   RETURN_ON_ERROR(ReadCreateBufferReply(message_in, id, payload));
   RETURN_ON_ASSERT(static_cast<size_t>(payload.data_size) == size);
 
@@ -417,16 +888,22 @@ Status Client::GetBuffers(
   }
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteGetBuffersRequest(ids, message_out);
-  RETURN_ON_ERROR(doWrite(message_out));
+  WireFormatScope wire_format_scope(wire_format_);
+  WriteGetBuffersRequest(ids, true, message_out);
   json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
   std::vector<Payload> payloads;
-  RETURN_ON_ERROR(ReadGetBuffersReply(message_in, payloads));
+  std::vector<int> fds_sent;
+  RETURN_ON_ERROR(ReadGetBuffersReply(message_in, payloads, fds_sent));
+  RETURN_ON_ERROR(shm_->ReceiveFds(fds_sent, payloads, true, true));
   for (auto const& item : payloads) {
     std::shared_ptr<arrow::Buffer> buffer = nullptr;
     uint8_t *shared = nullptr, *dist = nullptr;
-    if (item.data_size > 0) {
+    if (item.IsDevice()) {
+      RETURN_ON_ERROR(shm_->OpenDevice(item, &dist));
+    } else if (item.IsCopyOnWrite()) {
+      RETURN_ON_ERROR(shm_->MmapExtents(item, true, &dist));
+    } else if (item.data_size > 0) {
       VINEYARD_CHECK_OK(
           shm_->Mmap(item.store_fd, item.map_size, true, true, &shared));
       dist = shared + item.data_offset;
@@ -444,15 +921,21 @@ Status Client::GetBufferSizes(const std::set<ObjectID>& ids,
   }
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteGetBuffersRequest(ids, message_out);
-  RETURN_ON_ERROR(doWrite(message_out));
+  WireFormatScope wire_format_scope(wire_format_);
+  WriteGetBuffersRequest(ids, true, message_out);
   json message_in;
-  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
   std::vector<Payload> payloads;
-  RETURN_ON_ERROR(ReadGetBuffersReply(message_in, payloads));
+  std::vector<int> fds_sent;
+  RETURN_ON_ERROR(ReadGetBuffersReply(message_in, payloads, fds_sent));
+  RETURN_ON_ERROR(shm_->ReceiveFds(fds_sent, payloads, true, true));
   for (auto const& item : payloads) {
     uint8_t* shared = nullptr;
-    if (item.data_size > 0) {
+    if (item.IsDevice()) {
+      // device blobs are sized without opening their memory
+    } else if (item.IsCopyOnWrite()) {
+      RETURN_ON_ERROR(shm_->MmapExtents(item, true, &shared));
+    } else if (item.data_size > 0) {
       VINEYARD_CHECK_OK(
           shm_->Mmap(item.store_fd, item.map_size, true, true, &shared));
     }
@@ -483,6 +966,31 @@ Status Client::DropBuffer(const ObjectID id, const int fd) {
   return Status::OK();
 }
 
+Status Client::GetCachedBuffers(const std::vector<ObjectID>& remote_ids,
+                                std::vector<ObjectID>& local_ids,
+                                bool& enabled) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteGetCachedBuffersRequest(remote_ids, message_out);
+  json message_in;
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
+  RETURN_ON_ERROR(ReadGetCachedBuffersReply(message_in, enabled, local_ids));
+  RETURN_ON_ASSERT(local_ids.size() == remote_ids.size(),
+                   "The result size doesn't match with the requested sizes");
+  return Status::OK();
+}
+
+Status Client::CacheBuffers(const std::vector<ObjectID>& remote_ids,
+                            const std::vector<ObjectID>& local_ids) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteCacheBuffersRequest(remote_ids, local_ids, message_out);
+  json message_in;
+  RETURN_ON_ERROR(doRequest(message_out, message_in));
+  RETURN_ON_ERROR(ReadCacheBuffersReply(message_in));
+  return Status::OK();
+}
+
 namespace detail {
 
 MmapEntry::MmapEntry(int fd, int64_t map_size, bool readonly, bool realign)
@@ -540,68 +1048,332 @@ uint8_t* MmapEntry::map_readwrite() {
   return rw_pointer_;
 }
 
+SharedMemoryManager::Mappings::~Mappings() {
+  for (auto const& item : windows) {
+    munmap(item.second.first, item.second.second);
+  }
+  for (auto const& item : device_buffers) {
+    VINEYARD_DISCARD(
+        memory::cuda_ipc_close_handle(item.second.first, item.second.second));
+  }
+}
+
 SharedMemoryManager::SharedMemoryManager(int vineyard_conn)
-    : vineyard_conn_(vineyard_conn) {}
+    : vineyard_conn_(vineyard_conn), mappings_(std::make_shared<Mappings>()) {
+  mappings_->segments = std::make_shared<const segments_t>();
+}
 
 Status SharedMemoryManager::Mmap(int fd, int64_t map_size, bool readonly,
                                  bool realign, uint8_t** ptr) {
-  auto entry = mmap_table_.find(fd);
-  if (entry == mmap_table_.end()) {
-    int client_fd = recv_fd(vineyard_conn_);
-    if (fd <= 0) {
-      return Status::IOError(
-          "Failed to receieve file descriptor from the socket");
-    }
-    auto mmap_entry = std::unique_ptr<MmapEntry>(
-        new MmapEntry(client_fd, map_size, readonly, realign));
-    entry = mmap_table_.emplace(fd, std::move(mmap_entry)).first;
-  }
-  if (readonly) {
-    *ptr = entry->second->map_readonly();
-    if (*ptr == nullptr) {
-      return Status::IOError("Failed to mmap received fd as a readonly buffer");
+  {
+    std::lock_guard<std::mutex> lock(mappings_->mutex);
+    if (received_fds_.find(fd) == received_fds_.end()) {
+      int client_fd = recv_fd(vineyard_conn_);
+      if (client_fd < 0) {
+        return Status::IOError(
+            "Failed to receieve file descriptor from the socket");
+      }
+      registerFd(fd, client_fd, map_size, readonly, realign);
     }
-  } else {
-    *ptr = entry->second->map_readwrite();
-    if (*ptr == nullptr) {
-      return Status::IOError("Failed to mmap received fd as a writable buffer");
+    auto& entry = mappings_->mmap_table.at(fd);
+    if (readonly) {
+      *ptr = entry->map_readonly();
+      if (*ptr == nullptr) {
+        return Status::IOError(
+            "Failed to mmap received fd as a readonly buffer");
+      }
+    } else {
+      *ptr = entry->map_readwrite();
+      if (*ptr == nullptr) {
+        return Status::IOError(
+            "Failed to mmap received fd as a writable buffer");
+      }
     }
   }
-  segments_.emplace(reinterpret_cast<uintptr_t>(*ptr), map_size);
+  addSegment(reinterpret_cast<uintptr_t>(*ptr), map_size);
   return Status::OK();
 }
 
-bool SharedMemoryManager::Exists(const uintptr_t target) {
-  if (segments_.empty()) {
-    return false;
+Status SharedMemoryManager::ReceiveFds(const std::vector<int>& fds,
+                                       const std::vector<Payload>& payloads,
+                                       bool readonly, bool realign) {
+  if (fds.empty()) {
+    return Status::OK();
   }
-#ifndef NDEBUG
-  std::clog << "-------- Shared memory segments: " << std::endl;
-  for (auto const& item : segments_) {
-    std::clog << "[" << item.first << ", " << (item.first + item.second) << ")"
-              << std::endl;
+  std::vector<int> client_fds(fds.size(), -1);
+  if (recv_fds(vineyard_conn_, client_fds.data(),
+               static_cast<int>(client_fds.size())) < 0) {
+    return Status::IOError(
+        "Failed to receieve file descriptors from the socket");
+  }
+  std::unordered_map<int, int64_t> map_sizes;
+  for (auto const& payload : payloads) {
+    map_sizes.emplace(payload.store_fd, payload.map_size);
+    for (auto const& extent : payload.extents) {
+      map_sizes.emplace(extent.fd, extent.map_size);
+    }
+  }
+  std::lock_guard<std::mutex> lock(mappings_->mutex);
+  for (size_t i = 0; i < fds.size(); ++i) {
+    registerFd(fds[i], client_fds[i], map_sizes[fds[i]], readonly, realign);
+  }
+  return Status::OK();
+}
+
+Status SharedMemoryManager::MmapExtents(const Payload& payload, bool readonly,
+                                        uint8_t** ptr) {
+  auto key = std::make_pair(payload.object_id, readonly);
+  size_t window_size = memory::PageExtentsSize(payload.extents);
+  uint8_t* window = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mappings_->mutex);
+    auto iter = mappings_->windows.find(key);
+    if (iter != mappings_->windows.end()) {
+      *ptr = iter->second.first + payload.data_offset;
+      return Status::OK();
+    }
+    for (auto const& extent : payload.extents) {
+      if (received_fds_.find(extent.fd) == received_fds_.end()) {
+        int client_fd = recv_fd(vineyard_conn_);
+        if (client_fd < 0) {
+          return Status::IOError(
+              "Failed to receieve file descriptor from the socket");
+        }
+        registerFd(extent.fd, client_fd, extent.map_size, readonly, true);
+      }
+    }
+    auto const& mmap_table = mappings_->mmap_table;
+    RETURN_ON_ERROR(memory::MapPageExtents(
+        payload.extents,
+        [&mmap_table](int fd) {
+          auto entry = mmap_table.find(fd);
+          return entry == mmap_table.end() ? -1 : entry->second->fd();
+        },
+        readonly, &window));
+    mappings_->windows.emplace(key, std::make_pair(window, window_size));
+  }
+  addSegment(reinterpret_cast<uintptr_t>(window), window_size);
+  *ptr = window + payload.data_offset;
+  return Status::OK();
+}
+
+Status SharedMemoryManager::OpenDevice(const Payload& payload,
+                                       uint8_t** ptr) {
+  std::lock_guard<std::mutex> lock(mappings_->mutex);
+  auto iter = mappings_->device_buffers.find(payload.ipc_handle);
+  if (iter == mappings_->device_buffers.end()) {
+    uint8_t* pointer = nullptr;
+    RETURN_ON_ERROR(memory::cuda_ipc_open_handle(
+        payload.device, payload.ipc_handle, &pointer));
+    iter = mappings_->device_buffers
+               .emplace(payload.ipc_handle,
+                        std::make_pair(payload.device, pointer))
+               .first;
+  }
+  *ptr = iter->second.second;
+  return Status::OK();
+}
+
+Status SharedMemoryManager::ShareMappings(const SharedMemoryManager& other,
+                                          const std::vector<int>& held_fds) {
+  if (mappings_ == other.mappings_) {
+    return Status::OK();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mappings_->mutex);
+    RETURN_ON_ASSERT(mappings_->mmap_table.empty(),
+                     "Cannot share mappings after fds have been mapped");
+  }
+  mappings_ = other.mappings_;
+  std::lock_guard<std::mutex> lock(mappings_->mutex);
+  received_fds_.insert(held_fds.begin(), held_fds.end());
+  return Status::OK();
+}
+
+std::vector<int> SharedMemoryManager::HeldFds() const {
+  std::lock_guard<std::mutex> lock(mappings_->mutex);
+  std::vector<int> fds;
+  fds.reserve(mappings_->mmap_table.size());
+  for (auto const& item : mappings_->mmap_table) {
+    fds.emplace_back(item.first);
+  }
+  return fds;
+}
+
+void SharedMemoryManager::registerFd(int fd, int client_fd, int64_t map_size,
+                                     bool readonly, bool realign) {
+  received_fds_.emplace(fd);
+  auto& mmap_table = mappings_->mmap_table;
+  if (mmap_table.find(fd) != mmap_table.end()) {
+    // has been mapped via another connection
+    close(client_fd);
+    return;
   }
-#endif
+  auto mmap_entry = std::unique_ptr<MmapEntry>(
+      new MmapEntry(client_fd, map_size, readonly, realign));
+  mmap_table.emplace(fd, std::move(mmap_entry));
+}
+
+bool SharedMemoryManager::Exists(const uintptr_t target) {
+  uintptr_t base = 0;
+  size_t size = 0;
+  return Exists(target, base, size);
+}
 
-  auto loc = segments_.upper_bound(
-      std::make_pair(target, std::numeric_limits<size_t>::max()));
-  if (loc == segments_.begin()) {
+bool SharedMemoryManager::Exists(const uintptr_t target, uintptr_t& base,
+                                 size_t& size) {
+  auto segments = loadSegments();
+  // the last segment that starts at or before the target
+  auto loc = std::upper_bound(
+      segments->begin(), segments->end(), target,
+      [](const uintptr_t value, const std::pair<uintptr_t, size_t>& item) {
+        return value < item.first;
+      });
+  if (loc == segments->begin()) {
+    return false;
+  }
+  auto const& item = *std::prev(loc);
+  if (target >= item.first + item.second) {
     return false;
-  } else if (loc == segments_.end()) {
-    // check rbegin
-    auto const item = segments_.rbegin();
-    return target < item->first + item->second;
-  } else {
-    // check prev
-    auto const item = std::prev(loc);
-    return target < item->first + item->second;
   }
+  base = item.first;
+  size = item.second;
+  return true;
 }
 
 bool SharedMemoryManager::Exists(const void* target) {
   return Exists(reinterpret_cast<const uintptr_t>(target));
 }
 
+std::shared_ptr<const SharedMemoryManager::segments_t>
+SharedMemoryManager::loadSegments() const {
+  return std::atomic_load(&mappings_->segments);
+}
+
+void SharedMemoryManager::addSegment(const uintptr_t base, const size_t size) {
+  auto item = std::make_pair(base, size);
+  {
+    // fast path: segments are mapped once but registered for every payload
+    auto segments = loadSegments();
+    if (std::binary_search(segments->begin(), segments->end(), item)) {
+      return;
+    }
+  }
+  std::lock_guard<std::mutex> lock(mappings_->segments_mutex);
+  auto segments = loadSegments();
+  auto loc = std::lower_bound(segments->begin(), segments->end(), item);
+  if (loc != segments->end() && *loc == item) {
+    return;
+  }
+  auto updated = std::make_shared<segments_t>();
+  updated->reserve(segments->size() + 1);
+  updated->insert(updated->end(), segments->begin(), loc);
+  updated->emplace_back(item);
+  updated->insert(updated->end(), loc, segments->end());
+  std::atomic_store(&mappings_->segments,
+                    std::shared_ptr<const segments_t>(std::move(updated)));
+}
+
+MetaCache::MetaCache(size_t capacity) : capacity_(capacity) {}
+
+MetaCache::~MetaCache() {
+  if (conn_ != -1) {
+    // wakes up the listener
+    shutdown(conn_, SHUT_RDWR);
+  }
+  if (listener_.joinable()) {
+    listener_.join();
+  }
+  if (conn_ != -1) {
+    close(conn_);
+  }
+}
+
+Status MetaCache::Open(const std::string& ipc_socket) {
+  RETURN_ON_ERROR(connect_ipc_socket_retry(ipc_socket, conn_));
+  std::string message_out, message_in;
+  WriteRegisterRequest(WireFormat::JSON, 0, message_out);
+  RETURN_ON_ERROR(send_message(conn_, message_out));
+  RETURN_ON_ERROR(recv_message(conn_, message_in));
+  WriteSubscribeInvalidationRequest(message_out);
+  RETURN_ON_ERROR(send_message(conn_, message_out));
+  RETURN_ON_ERROR(recv_message(conn_, message_in));
+  json reply;
+  RETURN_ON_ERROR(CATCH_JSON_ERROR([&]() -> Status {
+    reply = DecodeMessage(message_in);
+    return Status::OK();
+  }()));
+  RETURN_ON_ERROR(ReadSubscribeInvalidationReply(reply));
+  alive_ = true;
+  listener_ = std::thread([this]() { listen(); });
+  return Status::OK();
+}
+
+bool MetaCache::Get(const ObjectID id, ObjectMeta& meta) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto iter = metas_.find(id);
+  if (!alive_ || iter == metas_.end()) {
+    return false;
+  }
+  meta = iter->second.first;
+  return true;
+}
+
+uint64_t MetaCache::Generation() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return generation_;
+}
+
+void MetaCache::Put(const ObjectID id, const ObjectMeta& meta,
+                    uint64_t const generation) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (!alive_ || generation != generation_ ||
+      metas_.find(id) != metas_.end()) {
+    return;
+  }
+  order_.push_back(id);
+  metas_.emplace(id, std::make_pair(meta, std::prev(order_.end())));
+  while (metas_.size() > capacity_) {
+    metas_.erase(order_.front());
+    order_.pop_front();
+  }
+}
+
+void MetaCache::Invalidate(const std::vector<ObjectID>& ids) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  generation_ += 1;
+  for (auto const id : ids) {
+    auto iter = metas_.find(id);
+    if (iter != metas_.end()) {
+      order_.erase(iter->second.second);
+      metas_.erase(iter);
+    }
+  }
+}
+
+void MetaCache::listen() {
+  std::string message;
+  std::vector<ObjectID> ids;
+  while (true) {
+    auto status = recv_message(conn_, message);
+    if (status.ok()) {
+      status = CATCH_JSON_ERROR([&]() -> Status {
+        return ReadInvalidationMessage(DecodeMessage(message), ids);
+      }());
+    }
+    if (!status.ok()) {
+      break;
+    }
+    Invalidate(ids);
+  }
+  // nothing could be trusted once the invalidation is lost
+  std::lock_guard<std::mutex> guard(mutex_);
+  alive_ = false;
+  generation_ += 1;
+  metas_.clear();
+  order_.clear();
+}
+
 }  // namespace detail
 
 }  // namespace vineyard
@@ -16,11 +16,16 @@ limitations under the License.
 #ifndef SRC_CLIENT_CLIENT_H_
 #define SRC_CLIENT_CLIENT_H_
 
+#include <list>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -38,6 +43,10 @@ namespace vineyard {
 class Blob;
 class BlobWriter;
 
+namespace memory {
+class RequestRing;
+}  // namespace memory
+
 namespace detail {
 
 /**
@@ -82,21 +91,183 @@ class SharedMemoryManager {
   Status Mmap(int fd, int64_t map_size, bool readonly, bool realign,
               uint8_t** ptr);
 
+  /**
+   * @brief Receive the `fds` that the server passed in a single batch, in
+   * order, and register them, so that the following `Mmap` calls won't
+   * receive fds from the socket one by one.
+   */
+  Status ReceiveFds(const std::vector<int>& fds,
+                    const std::vector<Payload>& payloads, bool readonly,
+                    bool realign);
+
+  /**
+   * @brief Map the extents of a copy-on-write blob to a contiguous window,
+   * the window is kept until the manager is destroyed.
+   *
+   * @param ptr The start of the data of the blob in the window.
+   */
+  Status MmapExtents(const Payload& payload, bool readonly, uint8_t** ptr);
+
+  /**
+   * @brief Open the memory of a device blob by its CUDA IPC handle, the
+   * memory is kept open until the manager is destroyed.
+   */
+  Status OpenDevice(const Payload& payload, uint8_t** ptr);
+
   bool Exists(const uintptr_t target);
 
   bool Exists(const void* target);
 
+  bool Exists(const uintptr_t target, uintptr_t& base, size_t& size);
+
+  /**
+   * @brief Share the mmap table (and the shm segments) of `other`, so that
+   * the segments that have been mapped through another connection to the
+   * same server won't be mapped again. Must be called before any `Mmap`.
+   *
+   * @param held_fds The fds of `other` that the server has been told not to
+   * pass through this connection, see `HeldFds`.
+   */
+  Status ShareMappings(const SharedMemoryManager& other,
+                       const std::vector<int>& held_fds = {});
+
+  /**
+   * @brief The server-side fds that have been received, which can be reused
+   * by the connections that share the mappings.
+   */
+  std::vector<int> HeldFds() const;
+
  private:
+  using segments_t = std::vector<std::pair<uintptr_t, size_t>>;
+
+  /**
+   * @brief The mappings of server-side fds, may be shared by the managers of
+   * many connections.
+   */
+  struct Mappings {
+    ~Mappings();
+
+    std::mutex mutex;  // protects `mmap_table` and `windows`
+    std::unordered_map<int, std::unique_ptr<MmapEntry>> mmap_table;
+    // the windows of copy-on-write blobs, by (blob id, readonly)
+    std::map<std::pair<ObjectID, bool>, std::pair<uint8_t*, size_t>> windows;
+    // the opened memory of device blobs, by the IPC handle
+    std::unordered_map<std::string, std::pair<int, uint8_t*>> device_buffers;
+
+    // sorted shm segments for fast "if exists" query, readers binary-search
+    // an immutable snapshot without locking, writers (serialized by
+    // `segments_mutex`) publish a new copy (RCU-style).
+    std::shared_ptr<const segments_t> segments;
+    std::mutex segments_mutex;
+  };
+
+  // registers a fd received from the socket, requires `mappings_->mutex`
+  void registerFd(int fd, int client_fd, int64_t map_size, bool readonly,
+                  bool realign);
+
+  std::shared_ptr<const segments_t> loadSegments() const;
+
+  void addSegment(const uintptr_t base, const size_t size);
+
   // UNIX-domain socket
   int vineyard_conn_ = -1;
 
-  // mmap table
-  std::unordered_map<int, std::unique_ptr<MmapEntry>> mmap_table_;
+  // the server-side fds that have been received from this connection, as the
+  // server passes every fd once per connection. Protected by
+  // `mappings_->mutex`.
+  std::unordered_set<int> received_fds_;
 
-  // sorted shm segments for fast "if exists" query
-  std::set<std::pair<uintptr_t, size_t>> segments_;
+  std::shared_ptr<Mappings> mappings_;
 };
 
+/**
+ * @brief MetaCache keeps the metadata of sealed objects on the client side.
+ * Sealed objects are immutable, and the entries are dropped when the server
+ * pushes the invalidation of them on a dedicated connection, e.g., when the
+ * objects are deleted or persisted.
+ *
+ * The invalidation is asynchronous, readers may still see the metadata of an
+ * object shortly after it has been deleted by others.
+ */
+class MetaCache {
+ public:
+  explicit MetaCache(size_t capacity);
+
+  ~MetaCache();
+
+  /**
+   * @brief Subscribe the invalidation from the server at `ipc_socket`.
+   */
+  Status Open(const std::string& ipc_socket);
+
+  bool Get(const ObjectID id, ObjectMeta& meta);
+
+  /**
+   * @brief The generation changes on every invalidation, metadata fetched
+   * before that shouldn't be put into the cache.
+   */
+  uint64_t Generation();
+
+  void Put(const ObjectID id, const ObjectMeta& meta,
+           uint64_t const generation);
+
+  void Invalidate(const std::vector<ObjectID>& ids);
+
+ private:
+  void listen();
+
+  size_t capacity_;
+  int conn_ = -1;
+  std::thread listener_;
+
+  std::mutex mutex_;  // protects the following members
+  bool alive_ = false;
+  uint64_t generation_ = 0;
+  std::list<ObjectID> order_;  // the oldest entry comes first
+  std::unordered_map<ObjectID,
+                     std::pair<ObjectMeta, std::list<ObjectID>::iterator>>
+      metas_;
+};
+
+/**
+ * @brief Whether `T` is a concrete object type that can be instantiated (by
+ * its static `Create()`) without consulting the `ObjectFactory`.
+ */
+template <typename T, typename = void>
+struct is_static_creatable : std::false_type {};
+
+template <typename T>
+struct is_static_creatable<
+    T, typename std::enable_if<std::is_same<
+           decltype(T::Create()), std::unique_ptr<Object>>::value>::type>
+    : std::true_type {};
+
+/**
+ * @brief Construct an object of the statically known type `T` from `meta`,
+ * returns nullptr when `meta` is not exactly of type `T` (e.g., `T` is a
+ * base class), in which case the `ObjectFactory` should be used.
+ */
+template <typename T>
+typename std::enable_if<is_static_creatable<T>::value,
+                        std::shared_ptr<T>>::type
+construct_typed(ObjectMeta const& meta) {
+  // computed once per type, rather than a registry lookup per object
+  static const std::string name = type_name<T>();
+  if (meta.GetTypeName() != name) {
+    return nullptr;
+  }
+  std::shared_ptr<T> object(static_cast<T*>(T::Create().release()));
+  object->Construct(meta);
+  return object;
+}
+
+template <typename T>
+typename std::enable_if<!is_static_creatable<T>::value,
+                        std::shared_ptr<T>>::type
+construct_typed(ObjectMeta const&) {
+  return nullptr;
+}
+
 }  // namespace detail
 
 /**
@@ -129,7 +300,23 @@ class Client : public ClientBase {
   Status Connect(const std::string& ipc_socket);
 
   /**
-   * @brief Create a new client using self UNIX domain socket.
+   * @brief Connect to vineyardd using the given UNIX domain socket
+   * `ipc_socket`, and submit the latency-critical requests (i.e., creating
+   * and getting buffers) through a shared memory ring rather than the socket,
+   * if the server supports.
+   *
+   * @param ipc_socket Location of the UNIX domain socket.
+   * @param ring_capacity The capacity of the request ring in bytes, zero
+   * means don't use the ring.
+   *
+   * @return Status that indicates whether the connect has succeeded.
+   */
+  Status Connect(const std::string& ipc_socket, size_t const ring_capacity);
+
+  /**
+   * @brief Create a new client using self UNIX domain socket. The new client
+   * shares the mmap table with this client, and reuses the fds that have been
+   * received by this client, which won't be passed by the server again.
    */
   Status Fork(Client& client);
 
@@ -167,7 +354,57 @@ class Client : public ClientBase {
    * @return Status that indicates whether the get action has succeeded.
    */
   Status GetMetaData(const std::vector<ObjectID>& id, std::vector<ObjectMeta>&,
-                     const bool sync_remote = false);
+                     const bool sync_remote = false) override;
+
+  /**
+   * @brief Obtain the metadata of an object, with its members (except blobs)
+   * left as placeholders that are resolved on demand, see also
+   * `ObjectMeta::GetMemberMeta()` and `ObjectMeta::ResolveMembers()`.
+   *
+   * Suitable for global objects with many members, of which only a few
+   * will be accessed.
+   *
+   * @param id The object id to get.
+   * @param meta_data The result metadata.
+   * @param sync_remote Whether to trigger an immediate remote metadata
+   *        synchronization before get specific metadata. Default is false.
+   *
+   * @return Status that indicates whether the get action has succeeded.
+   */
+  Status GetLazyMetaData(const ObjectID id, ObjectMeta& meta_data,
+                         const bool sync_remote = false);
+
+  /**
+   * @brief Cache the metadata of objects got by `GetMetaData()` on the client
+   * side, the cached entries are invalidated by the server when the objects
+   * are deleted or persisted. Requests with `sync_remote` bypass the cache.
+   *
+   * @param capacity The maximum number of cached objects.
+   *
+   * @return Status that indicates whether the cache has been enabled.
+   */
+  Status EnableMetaCache(size_t const capacity = 1024);
+
+  /**
+   * @brief Migrate the members of a global object that are located outside
+   * the given instances to the connected vineyard server, and create a
+   * global object that refers to the migrated copies.
+   *
+   * Members that already live on the connected instance or on `instances`
+   * won't be moved, and the others are migrated concurrently.
+   *
+   * @param global_id The global object to migrate.
+   * @param instances The instances whose members are considered co-located.
+   * @param local_view The metadata of the result global object, which is the
+   * original one when no member needs to be migrated.
+   * @param parallelism The max number of members migrated concurrently.
+   *
+   * @return Status that indicates whether the migration has succeeded.
+   */
+  Status MigrateGlobalObject(const ObjectID global_id,
+                             const std::set<InstanceID>& instances,
+                             ObjectMeta& local_view,
+                             size_t const parallelism = 4);
 
   /**
    * @brief Create a blob in vineyard server. When creating a blob, vineyard
@@ -181,6 +418,72 @@ class Client : public ClientBase {
    */
   Status CreateBlob(size_t size, std::unique_ptr<BlobWriter>& blob);
 
+  /**
+   * @brief Create a blob in vineyard server, and hint the server to place the
+   * memory of the blob on the given NUMA node. See also `CreateBlob`.
+   *
+   * @param size The size of requested blob.
+   * @param numa_node The preferred NUMA node, -1 means let the server decide.
+   * @param blob The result mutable blob will be set in `blob`.
+   */
+  Status CreateBlob(size_t size, const int numa_node,
+                    std::unique_ptr<BlobWriter>& blob);
+
+  /**
+   * @brief Create a blob in vineyard server, and ask the server to fault in
+   * the pages of the blob before returning when `prefault` is true, to keep
+   * the page faults off the critical path of writing the blob. See also
+   * `CreateBlob`.
+   *
+   * @param size The size of requested blob.
+   * @param numa_node The preferred NUMA node, -1 means let the server decide.
+   * @param prefault Whether to pre-fault the pages of the blob.
+   * @param blob The result mutable blob will be set in `blob`.
+   */
+  Status CreateBlob(size_t size, const int numa_node, const bool prefault,
+                    std::unique_ptr<BlobWriter>& blob);
+
+  /**
+   * @brief Create a copy-on-write blob of the sealed blob `parent`, which
+   * shares the unchanged pages with the parent, only the pages that overlap
+   * with the `dirty` (offset, size) ranges are newly allocated (and filled
+   * with the contents of the parent). The blob has the same size as the
+   * parent, and writing outside the pages of the dirty ranges faults.
+   *
+   * @param parent The blob to derive from.
+   * @param dirty The byte ranges that are going to be modified.
+   * @param blob The result mutable blob will be set in `blob`.
+   */
+  Status CreateCopyOnWriteBlob(
+      const ObjectID parent,
+      std::vector<std::pair<size_t, size_t>> const& dirty,
+      std::unique_ptr<BlobWriter>& blob);
+
+  /**
+   * @brief Create a blob in the memory of the given CUDA device, when
+   * vineyard is built with `USE_CUDA`. The data pointer of the writer (and
+   * of the blob got from vineyard later) is a device pointer, which is
+   * shared through the CUDA IPC handle, and shouldn't be accessed from the
+   * host. Device blobs are only available to the clients on the same host.
+   *
+   * @param size The size of requested blob.
+   * @param device The ordinal of the CUDA device.
+   * @param blob The result mutable blob will be set in `blob`.
+   */
+  Status CreateDeviceBlob(size_t size, const int device,
+                          std::unique_ptr<BlobWriter>& blob);
+
+  /**
+   * @brief Create many blobs in vineyard server with a single round trip
+   * (when the server supports batched requests), e.g., the buffers of the
+   * many small columns of a wide dataframe. See also `BlobWriterGroup`.
+   *
+   * @param sizes The sizes of requested blobs.
+   * @param blobs The result mutable blobs, in the order of `sizes`.
+   */
+  Status CreateBlobs(const std::vector<size_t>& sizes,
+                     std::vector<std::unique_ptr<BlobWriter>>& blobs);
+
   /**
    * @brief Get a blob from vineyard server. When obtaining blobs from vineyard
    * server, the memory address in the server process will be mmapped to the
@@ -258,6 +561,17 @@ class Client : public ClientBase {
    */
   Status GetObject(const ObjectID id, std::shared_ptr<Object>& object);
 
+  /**
+   * @brief Get an object from vineyard, like `GetObject(id, object)`.
+   *
+   * When `prefetch` is true, the payloads of all blobs reachable from the
+   * metadata are resolved before the object is constructed, and the pages of
+   * large blobs (see `kPrefetchThreshold`) are advised with `MADV_WILLNEED`,
+   * to let the kernel fault them in ahead of the first access.
+   */
+  Status GetObject(const ObjectID id, std::shared_ptr<Object>& object,
+                   const bool prefetch);
+
   /**
    * @brief Get an object from vineyard. The type parameter `T` will be used to
    * resolve the constructor of the object.
@@ -270,7 +584,10 @@ class Client : public ClientBase {
    */
   template <typename T>
   std::shared_ptr<T> GetObject(const ObjectID id) {
-    return std::dynamic_pointer_cast<T>(GetObject(id));
+    ObjectMeta meta;
+    VINEYARD_CHECK_OK(this->GetMetaData(id, meta, true));
+    VINEYARD_ASSERT(!meta.MetaData().empty());
+    return constructObject<T>(meta);
   }
 
   /**
@@ -294,7 +611,28 @@ class Client : public ClientBase {
    */
   template <typename T>
   Status GetObject(const ObjectID id, std::shared_ptr<T>& object) {
-    object = std::dynamic_pointer_cast<T>(GetObject(id));
+    ObjectMeta meta;
+    RETURN_ON_ERROR(this->GetMetaData(id, meta, true));
+    RETURN_ON_ASSERT(!meta.MetaData().empty());
+    object = constructObject<T>(meta);
+    if (object == nullptr) {
+      return Status::ObjectNotExists("object not exists: " +
+                                     ObjectIDToString(id));
+    } else {
+      return Status::OK();
+    }
+  }
+
+  /**
+   * @brief Get an object from vineyard with the `prefetch` hint, see also
+   * `GetObject(id, object, prefetch)`.
+   */
+  template <typename T>
+  Status GetObject(const ObjectID id, std::shared_ptr<T>& object,
+                   const bool prefetch) {
+    std::shared_ptr<Object> result;
+    RETURN_ON_ERROR(GetObject(id, result, prefetch));
+    object = std::dynamic_pointer_cast<T>(result);
     if (object == nullptr) {
       return Status::ObjectNotExists("object not exists: " +
                                      ObjectIDToString(id));
@@ -303,6 +641,12 @@ class Client : public ClientBase {
     }
   }
 
+  /**
+   * @brief Blobs that are smaller than the threshold are not worth a
+   * `madvise()` call when prefetching.
+   */
+  static constexpr size_t kPrefetchThreshold = 1024 * 1024;
+
   /**
    * @brief Get multiple objects from vineayrd.
    *
@@ -365,6 +709,13 @@ class Client : public ClientBase {
    */
   bool IsSharedMemory(const uintptr_t target) const;
 
+  /**
+   * Check if the given address belongs to the shared memory region, and
+   * returns the (client-side) base address and size of the memory-mapped
+   * segment that contains it.
+   */
+  bool IsSharedMemory(const void* target, uintptr_t& base, size_t& size) const;
+
   /**
    * Get the allocated size for the given object.
    */
@@ -378,7 +729,8 @@ class Client : public ClientBase {
 
  protected:
   Status CreateBuffer(const size_t size, ObjectID& id, Payload& payload,
-                      std::shared_ptr<arrow::MutableBuffer>& buffer);
+                      std::shared_ptr<arrow::MutableBuffer>& buffer,
+                      const int numa_node = -1, const bool prefault = false);
 
   Status GetBuffer(const ObjectID id, std::shared_ptr<arrow::Buffer>& buffer);
 
@@ -398,12 +750,74 @@ class Client : public ClientBase {
    */
   Status DropBuffer(const ObjectID id, const int fd);
 
+  /**
+   * @brief Look up the local copies of remote blobs in the remote blob cache
+   * of the connected vineyard server, `InvalidObjectID()` for the blobs that
+   * are not cached. `enabled` is false when the server doesn't enable the
+   * cache.
+   */
+  Status GetCachedBuffers(const std::vector<ObjectID>& remote_ids,
+                          std::vector<ObjectID>& local_ids, bool& enabled);
+
+  /**
+   * @brief Hand the sealed local blobs over to the remote blob cache as the
+   * copies of the remote blobs.
+   */
+  Status CacheBuffers(const std::vector<ObjectID>& remote_ids,
+                      const std::vector<ObjectID>& local_ids);
+
  private:
+  Status connect(const std::string& ipc_socket, size_t const ring_capacity,
+                 const std::vector<int>& held_fds);
+
+  /**
+   * @brief Send the request and receive the reply, through the request ring
+   * if it is available.
+   */
+  Status doRequest(const std::string& message_out, json& message_in);
+
+  /**
+   * @brief Seal the blob in a server that deduplicates blobs, the `payload`
+   * is updated when the content is stored at the location of an identical
+   * blob.
+   */
+  Status SealBuffer(const ObjectID id, Payload& payload);
+
+  /**
+   * @brief Seal many blobs in a server that deduplicates blobs, with a single
+   * round trip when the server supports batched requests.
+   */
+  Status SealBuffers(const std::vector<ObjectID>& ids,
+                     std::vector<Payload>& payloads);
+
+  /**
+   * @brief Construct the object of type `T`, bypassing the `ObjectFactory`
+   * when the metadata is exactly of the statically known type.
+   */
+  template <typename T>
+  std::shared_ptr<T> constructObject(ObjectMeta const& meta) {
+    auto object = detail::construct_typed<T>(meta);
+    if (object != nullptr) {
+      return object;
+    }
+    std::shared_ptr<Object> target = ObjectFactory::Create(meta.GetTypeName());
+    if (target == nullptr) {
+      target = std::unique_ptr<Object>(new Object());
+    }
+    target->Construct(meta);
+    return std::dynamic_pointer_cast<T>(target);
+  }
+
   std::shared_ptr<detail::SharedMemoryManager> shm_;
+  std::shared_ptr<memory::RequestRing> ring_;
+  std::unique_ptr<detail::MetaCache> meta_cache_;
+  // whether blobs are sealed by the server, see also `SealBuffer()`
+  bool support_deduplication_ = false;
 
  private:
   friend class Blob;
   friend class BlobWriter;
+  friend class RPCClient;
 };
 
 }  // namespace vineyard
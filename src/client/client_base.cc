@@ -15,9 +15,14 @@ limitations under the License.
 
 #include "client/client_base.h"
 
+#include <algorithm>
 #include <future>
 #include <iostream>
+#include <map>
+#include <set>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "boost/range/combine.hpp"
 
@@ -26,15 +31,21 @@ limitations under the License.
 #include "client/rpc_client.h"
 #include "client/utils.h"
 #include "common/util/protocols.h"
+#include "common/util/trace.h"
 
 namespace vineyard {
 
-ClientBase::ClientBase() : connected_(false), vineyard_conn_(0) {}
+ClientBase::ClientBase()
+    : connected_(false),
+      vineyard_conn_(0),
+      wire_format_(WireFormat::JSON),
+      support_batch_(false) {}
 
 Status ClientBase::GetData(const ObjectID id, json& tree,
                            const bool sync_remote, const bool wait) {
   ENSURE_CONNECTED(this);
   std::string message_out;
+  WireFormatScope wire_format_scope(wire_format_);
   WriteGetDataRequest(id, sync_remote, wait, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
@@ -45,10 +56,15 @@ Status ClientBase::GetData(const ObjectID id, json& tree,
 
 Status ClientBase::GetData(const std::vector<ObjectID>& ids,
                            std::vector<json>& trees, const bool sync_remote,
-                           const bool wait) {
+                           const bool wait, const int depth) {
   ENSURE_CONNECTED(this);
   std::string message_out;
-  WriteGetDataRequest(ids, sync_remote, wait, message_out);
+  WireFormatScope wire_format_scope(wire_format_);
+  if (depth < 0) {
+    WriteGetDataRequest(ids, sync_remote, wait, message_out);
+  } else {
+    WriteGetDataRequest(ids, sync_remote, wait, depth, message_out);
+  }
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
   RETURN_ON_ERROR(doRead(message_in));
@@ -65,6 +81,7 @@ Status ClientBase::CreateData(const json& tree, ObjectID& id,
                               Signature& signature, InstanceID& instance_id) {
   ENSURE_CONNECTED(this);
   std::string message_out;
+  WireFormatScope wire_format_scope(wire_format_);
   WriteCreateDataRequest(tree, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
@@ -103,6 +120,51 @@ Status ClientBase::CreateMetaData(ObjectMeta& meta_data, ObjectID& id) {
   return status;
 }
 
+Status ClientBase::CreateMetaData(std::vector<ObjectMeta>& meta_datas,
+                                  std::vector<ObjectID>& ids) {
+  ENSURE_CONNECTED(this);
+  ids.clear();
+  for (auto const& meta_data : meta_datas) {
+    if (meta_data.incomplete()) {
+      // requires the remote meta sync, create them one by one
+      for (auto& meta : meta_datas) {
+        ObjectID id = InvalidObjectID();
+        RETURN_ON_ERROR(CreateMetaData(meta, id));
+        ids.emplace_back(id);
+      }
+      return Status::OK();
+    }
+  }
+  std::vector<std::string> messages_out(meta_datas.size());
+  WireFormatScope wire_format_scope(wire_format_);
+  for (size_t idx = 0; idx < meta_datas.size(); ++idx) {
+    auto& meta_data = meta_datas[idx];
+    meta_data.SetInstanceId(this->instance_id_);
+    meta_data.AddKeyValue("transient", true);
+    // nbytes is optional
+    if (!meta_data.Haskey("nbytes")) {
+      meta_data.SetNBytes(0);
+    }
+    WriteCreateDataRequest(meta_data.MetaData(), messages_out[idx]);
+  }
+  std::vector<json> messages_in;
+  RETURN_ON_ERROR(doBatch(messages_out, messages_in));
+  for (size_t idx = 0; idx < meta_datas.size(); ++idx) {
+    ObjectID id = InvalidObjectID();
+    Signature signature;
+    InstanceID instance_id = UnspecifiedInstanceID();
+    RETURN_ON_ERROR(
+        ReadCreateDataReply(messages_in[idx], id, signature, instance_id));
+    auto& meta_data = meta_datas[idx];
+    meta_data.SetId(id);
+    meta_data.SetSignature(signature);
+    meta_data.SetClient(this);
+    meta_data.SetInstanceId(instance_id);
+    ids.emplace_back(id);
+  }
+  return Status::OK();
+}
+
 Status ClientBase::SyncMetaData() {
   json __dummy;
   return GetData(InvalidObjectID(), __dummy, true, false);
@@ -145,6 +207,23 @@ Status ClientBase::ListData(std::string const& pattern, bool const regex,
   return Status::OK();
 }
 
+Status ClientBase::ListDataPage(
+    std::string const& pattern, bool const regex, size_t const limit,
+    json const& filters, std::vector<std::string> const& fields,
+    std::string& cursor, std::vector<ObjectID>& ids,
+    std::unordered_map<ObjectID, json>& projections) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteListDataPageRequest(pattern, regex, limit, filters, fields, cursor,
+                           message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(
+      ReadListDataPageReply(message_in, ids, projections, cursor));
+  return Status::OK();
+}
+
 Status ClientBase::CreateStream(const ObjectID& id) {
   ENSURE_CONNECTED(this);
   std::string message_out;
@@ -156,6 +235,24 @@ Status ClientBase::CreateStream(const ObjectID& id) {
   return Status::OK();
 }
 
+Status ClientBase::CreateStream(const ObjectID& id,
+                                const size_t high_watermark_bytes,
+                                const size_t low_watermark_bytes,
+                                const size_t high_watermark_chunks,
+                                const size_t low_watermark_chunks,
+                                const bool recycle_chunks) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteCreateStreamRequest(id, high_watermark_bytes, low_watermark_bytes,
+                           high_watermark_chunks, low_watermark_chunks,
+                           recycle_chunks, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadCreateStreamReply(message_in));
+  return Status::OK();
+}
+
 Status ClientBase::OpenStream(const ObjectID& id, StreamOpenMode mode) {
   ENSURE_CONNECTED(this);
   std::string message_out;
@@ -171,6 +268,7 @@ Status ClientBase::PushNextStreamChunk(ObjectID const id,
                                        ObjectID const chunk) {
   ENSURE_CONNECTED(this);
   std::string message_out;
+  WireFormatScope wire_format_scope(wire_format_);
   WritePushNextStreamChunkRequest(id, chunk, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
@@ -179,9 +277,23 @@ Status ClientBase::PushNextStreamChunk(ObjectID const id,
   return Status::OK();
 }
 
+Status ClientBase::PushNextStreamChunks(ObjectID const id,
+                                        std::vector<ObjectID> const& chunks) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WireFormatScope wire_format_scope(wire_format_);
+  WritePushNextStreamChunkRequest(id, chunks, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadPushNextStreamChunkReply(message_in));
+  return Status::OK();
+}
+
 Status ClientBase::PullNextStreamChunk(ObjectID const id, ObjectID& chunk) {
   ENSURE_CONNECTED(this);
   std::string message_out;
+  WireFormatScope wire_format_scope(wire_format_);
   WritePullNextStreamChunkRequest(id, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
@@ -190,6 +302,21 @@ Status ClientBase::PullNextStreamChunk(ObjectID const id, ObjectID& chunk) {
   return Status::OK();
 }
 
+Status ClientBase::PullNextStreamChunks(ObjectID const id,
+                                        size_t const max_chunks,
+                                        size_t const max_bytes,
+                                        std::vector<ObjectID>& chunks) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WireFormatScope wire_format_scope(wire_format_);
+  WritePullNextStreamChunkRequest(id, max_chunks, max_bytes, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadPullNextStreamChunkReply(message_in, chunks));
+  return Status::OK();
+}
+
 Status ClientBase::PullNextStreamChunk(ObjectID const id, ObjectMeta& chunk) {
   ObjectID chunk_id = InvalidObjectID();
   RETURN_ON_ERROR(this->PullNextStreamChunk(id, chunk_id));
@@ -231,6 +358,79 @@ Status ClientBase::Persist(const ObjectID id) {
   return Status::OK();
 }
 
+Status ClientBase::Persist(const std::vector<ObjectID>& ids) {
+  ENSURE_CONNECTED(this);
+  std::vector<std::string> messages_out(ids.size());
+  for (size_t idx = 0; idx < ids.size(); ++idx) {
+    WritePersistRequest(ids[idx], messages_out[idx]);
+  }
+  std::vector<json> messages_in;
+  RETURN_ON_ERROR(doBatch(messages_out, messages_in));
+  for (auto const& message_in : messages_in) {
+    RETURN_ON_ERROR(ReadPersistReply(message_in));
+  }
+  return Status::OK();
+}
+
+Status ClientBase::PersistAsync(const ObjectID id) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WritePersistRequest(id, true, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadPersistReply(message_in));
+  return Status::OK();
+}
+
+Status ClientBase::PersistAsync(const std::vector<ObjectID>& ids) {
+  ENSURE_CONNECTED(this);
+  std::vector<std::string> messages_out(ids.size());
+  for (size_t idx = 0; idx < ids.size(); ++idx) {
+    WritePersistRequest(ids[idx], true, messages_out[idx]);
+  }
+  std::vector<json> messages_in;
+  RETURN_ON_ERROR(doBatch(messages_out, messages_in));
+  for (auto const& message_in : messages_in) {
+    RETURN_ON_ERROR(ReadPersistReply(message_in));
+  }
+  return Status::OK();
+}
+
+Status ClientBase::PollPersist(const ObjectID id, bool& persisted) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteWaitPersistRequest(id, false, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadWaitPersistReply(message_in, persisted));
+  return Status::OK();
+}
+
+Status ClientBase::WaitPersist(const ObjectID id) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteWaitPersistRequest(id, true, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  bool persisted = false;
+  RETURN_ON_ERROR(ReadWaitPersistReply(message_in, persisted));
+  return Status::OK();
+}
+
+Status ClientBase::Lease(const std::vector<ObjectID>& ids, int64_t const ttl) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteLeaseRequest(ids, ttl, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadLeaseReply(message_in));
+  return Status::OK();
+}
+
 Status ClientBase::IfPersist(const ObjectID id, bool& persist) {
   ENSURE_CONNECTED(this);
   std::string message_out;
@@ -364,6 +564,15 @@ Status ClientBase::MigrateObject(const ObjectID object_id, ObjectID& result_id,
     result_id = object_id;
     return Status::OK();
   }
+  // reuses the replica that has been prefetched to this instance
+  if (!is_stream) {
+    std::vector<ObjectID> known;
+    if (prefetchImpl({object_id}, {}, 1, known).ok() && known.size() == 1 &&
+        known[0] != InvalidObjectID()) {
+      result_id = known[0];
+      return Status::OK();
+    }
+  }
 
   // findout remote server
   std::map<InstanceID, json> cluster;
@@ -399,6 +608,199 @@ Status ClientBase::MigrateObject(const ObjectID object_id, ObjectID& result_id,
   return sender.get() & receiver.get();
 }
 
+Status ClientBase::Broadcast(const ObjectID object_id,
+                             const std::vector<InstanceID>& targets,
+                             std::map<InstanceID, ObjectID>& replicas) {
+  ENSURE_CONNECTED(this);
+  ObjectMeta meta;
+  RETURN_ON_ERROR(this->GetMetaData(object_id, meta, true));
+  std::map<InstanceID, json> cluster;
+  RETURN_ON_ERROR(this->ClusterInfo(cluster));
+  auto hostname = [&](InstanceID const instance_id) -> std::string const& {
+    return cluster.at(instance_id)["hostname"].get_ref<std::string const&>();
+  };
+
+  replicas.clear();
+  replicas.emplace(meta.GetInstanceId(), object_id);
+  std::vector<InstanceID> pending;
+  for (auto const& target : targets) {
+    RETURN_ON_ASSERT(cluster.find(target) != cluster.end(),
+                     "Instance not found in the cluster: " +
+                         std::to_string(target));
+    if (replicas.find(target) == replicas.end() &&
+        std::find(pending.begin(), pending.end(), target) == pending.end()) {
+      pending.emplace_back(target);
+    }
+  }
+  // visits the first target of each host first to spread across hosts
+  {
+    std::set<std::string> visited;
+    std::vector<InstanceID> firsts, others;
+    for (auto const& target : pending) {
+      if (visited.emplace(hostname(target)).second) {
+        firsts.emplace_back(target);
+      } else {
+        others.emplace_back(target);
+      }
+    }
+    pending.swap(firsts);
+    pending.insert(pending.end(), others.begin(), others.end());
+  }
+
+  while (!pending.empty()) {
+    // pairs each target with an idle replica, preferring the same host
+    std::set<std::string> covered;
+    for (auto const& replica : replicas) {
+      covered.emplace(hostname(replica.first));
+    }
+    std::set<InstanceID> busy;
+    std::vector<std::pair<InstanceID, InstanceID>> plan;
+    std::vector<InstanceID> deferred;
+    for (auto const& target : pending) {
+      bool const local = covered.find(hostname(target)) != covered.end();
+      auto source = replicas.end();
+      for (auto iter = replicas.begin(); iter != replicas.end(); ++iter) {
+        if (busy.find(iter->first) != busy.end()) {
+          continue;
+        }
+        if (!local || hostname(iter->first) == hostname(target)) {
+          source = iter;
+          break;
+        }
+      }
+      if (source == replicas.end()) {
+        deferred.emplace_back(target);
+      } else {
+        busy.emplace(source->first);
+        plan.emplace_back(source->first, target);
+      }
+    }
+
+    std::vector<ObjectID> results(plan.size(), InvalidObjectID());
+    std::vector<std::future<Status>> transfers;
+    for (size_t idx = 0; idx < plan.size(); ++idx) {
+      transfers.emplace_back(std::async(std::launch::async, [&, idx]() {
+        return migrateBetween(replicas.at(plan[idx].first),
+                              cluster.at(plan[idx].first),
+                              cluster.at(plan[idx].second), results[idx]);
+      }));
+    }
+    Status status;
+    for (auto& transfer : transfers) {
+      status &= transfer.get();
+    }
+    RETURN_ON_ERROR(status);
+    for (size_t idx = 0; idx < plan.size(); ++idx) {
+      replicas.emplace(plan[idx].second, results[idx]);
+    }
+    pending.swap(deferred);
+  }
+  return Status::OK();
+}
+
+Status ClientBase::Prefetch(const std::vector<ObjectID>& ids,
+                            InstanceID const target, int64_t const pin_ttl,
+                            std::vector<ObjectID>& replicas) {
+  // doesn't hold the client during the migrations, see `PrefetchAsync()`
+  if (!this->connected_) {
+    return Status::ConnectionError("Client is not connected");
+  }
+  RETURN_ON_ASSERT(pin_ttl > 0, "The replicas must be pinned for a while");
+  std::vector<ObjectMeta> metas;
+  RETURN_ON_ERROR(this->GetMetaData(ids, metas, true));
+  std::map<InstanceID, json> cluster;
+  RETURN_ON_ERROR(this->ClusterInfo(cluster));
+  RETURN_ON_ASSERT(cluster.find(target) != cluster.end(),
+                   "Instance not found in the cluster: " +
+                       std::to_string(target));
+
+  RPCClient client;
+  RETURN_ON_ERROR(client.Connect(
+      cluster.at(target)["rpc_endpoint"].get_ref<std::string const&>()));
+  std::vector<ObjectID> known;
+  RETURN_ON_ERROR(client.prefetchImpl(ids, {}, pin_ttl, known));
+
+  replicas.assign(ids.size(), InvalidObjectID());
+  std::vector<std::future<Status>> transfers;
+  for (size_t idx = 0; idx < ids.size(); ++idx) {
+    InstanceID const source = metas[idx].GetInstanceId();
+    if (source == target) {
+      replicas[idx] = ids[idx];
+    } else if (known[idx] != InvalidObjectID()) {
+      replicas[idx] = known[idx];
+    } else {
+      RETURN_ON_ASSERT(cluster.find(source) != cluster.end(),
+                       "Instance not found in the cluster: " +
+                           std::to_string(source));
+      transfers.emplace_back(std::async(std::launch::async, [&, idx, source]() {
+        return migrateBetween(ids[idx], cluster.at(source), cluster.at(target),
+                              replicas[idx]);
+      }));
+    }
+  }
+  Status status;
+  for (auto& transfer : transfers) {
+    status &= transfer.get();
+  }
+  RETURN_ON_ERROR(status);
+  std::vector<ObjectID> pinned;
+  return client.prefetchImpl(ids, replicas, pin_ttl, pinned);
+}
+
+std::future<Status> ClientBase::PrefetchAsync(const std::vector<ObjectID>& ids,
+                                              InstanceID const target,
+                                              int64_t const pin_ttl) {
+  return std::async(std::launch::async, [this, ids, target, pin_ttl]() {
+    std::vector<ObjectID> replicas;
+    return this->Prefetch(ids, target, pin_ttl, replicas);
+  });
+}
+
+Status ClientBase::Unpin(const std::vector<ObjectID>& ids) {
+  std::vector<ObjectID> known;
+  return prefetchImpl(ids, {}, 0, known);
+}
+
+Status ClientBase::prefetchImpl(const std::vector<ObjectID>& ids,
+                                const std::vector<ObjectID>& replicas,
+                                int64_t const ttl,
+                                std::vector<ObjectID>& known) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WritePrefetchRequest(ids, replicas, ttl, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadPrefetchReply(message_in, known));
+  RETURN_ON_ASSERT(known.size() == ids.size(),
+                   "The prefetch reply doesn't match the request");
+  return Status::OK();
+}
+
+Status ClientBase::migrateBetween(const ObjectID object_id, const json& from,
+                                  const json& to, ObjectID& result_id) {
+  auto const& from_host = from["hostname"].get_ref<std::string const&>();
+  auto const& from_endpoint =
+      from["rpc_endpoint"].get_ref<std::string const&>();
+  auto const& to_host = to["hostname"].get_ref<std::string const&>();
+  auto const& to_endpoint = to["rpc_endpoint"].get_ref<std::string const&>();
+
+  auto sender = std::async(std::launch::async, [&]() -> Status {
+    RPCClient client;
+    RETURN_ON_ERROR(client.Connect(from_endpoint));
+    ObjectID dummy = InvalidObjectID();
+    return client.migrateObjectImpl(object_id, dummy, true, false, to_host,
+                                    from_endpoint);
+  });
+  auto receiver = std::async(std::launch::async, [&]() -> Status {
+    RPCClient client;
+    RETURN_ON_ERROR(client.Connect(to_endpoint));
+    return client.migrateObjectImpl(object_id, result_id, false, false,
+                                    from_host, from_endpoint);
+  });
+  return sender.get() & receiver.get();
+}
+
 Status ClientBase::migrateObjectImpl(const ObjectID object_id,
                                      ObjectID& result_id, bool const local,
                                      bool const is_stream,
@@ -453,18 +855,25 @@ Status ClientBase::doWrite(const std::string& message_out) {
 }
 
 Status ClientBase::doRead(std::string& message_in) {
-  return recv_message(vineyard_conn_, message_in);
+  auto status = recv_message(vineyard_conn_, message_in);
+#if defined(WITH_TRACING)
+  Tracer::EndRequest();
+#endif
+  return status;
 }
 
 Status ClientBase::doRead(json& root) {
   std::string message_in;
   auto status = recv_message(vineyard_conn_, message_in);
+#if defined(WITH_TRACING)
+  Tracer::EndRequest();
+#endif
   if (!status.ok()) {
     connected_ = false;
     return status;
   }
   status = CATCH_JSON_ERROR([&]() -> Status {
-    root = json::parse(message_in);
+    root = DecodeMessage(message_in);
     return Status::OK();
   }());
   if (!status.ok()) {
@@ -473,6 +882,29 @@ Status ClientBase::doRead(json& root) {
   return status;
 }
 
+Status ClientBase::doBatch(const std::vector<std::string>& messages_out,
+                           std::vector<json>& messages_in) {
+  messages_in.clear();
+  if (!support_batch_) {
+    for (auto const& message_out : messages_out) {
+      RETURN_ON_ERROR(doWrite(message_out));
+      json message_in;
+      RETURN_ON_ERROR(doRead(message_in));
+      messages_in.emplace_back(std::move(message_in));
+    }
+    return Status::OK();
+  }
+  std::string message_out;
+  WriteBatchRequest(messages_out, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadBatchReply(message_in, messages_in));
+  RETURN_ON_ASSERT(messages_in.size() == messages_out.size(),
+                   "The replies of the batch doesn't match its requests");
+  return Status::OK();
+}
+
 Status ClientBase::ClusterInfo(std::map<InstanceID, json>& meta) {
   ENSURE_CONNECTED(this);
   std::string message_out;
@@ -504,6 +936,28 @@ Status ClientBase::InstanceStatus(
   return Status::OK();
 }
 
+Status ClientBase::MemoryAttribution(json& usage) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteMemoryAttributionRequest(message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadMemoryAttributionReply(message_in, usage));
+  return Status::OK();
+}
+
+Status ClientBase::Checkpoint(const std::string& path, json& stats) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteCheckpointRequest(path, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  RETURN_ON_ERROR(ReadCheckpointReply(message_in, stats));
+  return Status::OK();
+}
+
 Status ClientBase::Instances(std::vector<InstanceID>& instances) {
   ENSURE_CONNECTED(this);
   std::string message_out;
@@ -537,8 +991,14 @@ InstanceStatus::InstanceStatus(const json& tree)
       deployment(tree["deployment"].get_ref<const std::string&>()),
       memory_usage(tree["memory_usage"].get<size_t>()),
       memory_limit(tree["memory_limit"].get<size_t>()),
+      memory_fragmentation(tree.value("memory_fragmentation", 0.0)),
+      session_memory(tree.value("session_memory", json::object())),
       deferred_requests(tree["deferred_requests"].get<size_t>()),
       ipc_connections(tree["ipc_connections"].get<size_t>()),
-      rpc_connections(tree["rpc_connections"].get<size_t>()) {}
+      rpc_connections(tree["rpc_connections"].get<size_t>()),
+      request_stats(tree.value("request_stats", json::object())),
+      connection_stats(tree.value("connection_stats", json::array())),
+      meta_service_time_us(tree.value("meta_service_time_us", 0.0)),
+      bulk_store_time_us(tree.value("bulk_store_time_us", 0.0)) {}
 
 }  // namespace vineyard
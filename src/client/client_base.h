@@ -17,6 +17,7 @@ limitations under the License.
 #define SRC_CLIENT_CLIENT_BASE_H_
 
 #include <sys/mman.h>
+#include <future>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -35,10 +36,19 @@ namespace vineyard {
 enum class StreamOpenMode {
   read = 1,
   write = 2,
+  // read in the fan-out mode, where many readers can open the stream and each
+  // of them reads all chunks
+  fanout = 4,
+  // read in the shared mode, where many readers can open the stream and each
+  // chunk is read by only one of them, i.e., the first reader that pulls
+  shared = 8,
 };
 
 struct InstanceStatus;
 
+// see also: common/util/protocols.h
+enum class WireFormat;
+
 /**
  * @brief ClientBase is the base class for vineyard IPC and RPC client.
  *
@@ -81,11 +91,15 @@ class ClientBase {
    *        synchronization before get specific metadata. Default is false.
    * @param wait The request could be blocked util the object with given id has
    *        been created on vineyard by other clients. Default is false.
+   * @param depth Members nested deeper than `depth` levels are returned as
+   *        placeholders `{"id": ...}`, except blobs. Default is -1, i.e., the
+   *        whole metadata tree.
    *
    * @return Status that indicates whether the get action has succeeded.
    */
   Status GetData(const std::vector<ObjectID>& ids, std::vector<json>& trees,
-                 const bool sync_remote = false, const bool wait = false);
+                 const bool sync_remote = false, const bool wait = false,
+                 const int depth = -1);
 
   /**
    * @brief Create the metadata in the vineyard server.
@@ -111,6 +125,18 @@ class ClientBase {
    */
   Status CreateMetaData(ObjectMeta& meta_data, ObjectID& id);
 
+  /**
+   * @brief Create the metadata of many objects in a single round trip, after
+   * created, the resulted object ids in the `meta_datas` will be filled.
+   *
+   * @param meta_datas The metadata that will be created in vineyard.
+   * @param ids The returned object IDs of the created metadata, in order.
+   *
+   * @return Status that indicates whether the create action has succeeded.
+   */
+  Status CreateMetaData(std::vector<ObjectMeta>& meta_datas,
+                        std::vector<ObjectID>& ids);
+
   /**
    * @brief Get the meta-data of the requested object
    *
@@ -123,6 +149,13 @@ class ClientBase {
   virtual Status GetMetaData(const ObjectID id, ObjectMeta& meta_data,
                              const bool sync_remote = false) = 0;
 
+  /**
+   * @brief Get the meta-data of multiple objects in a single request.
+   */
+  virtual Status GetMetaData(const std::vector<ObjectID>& ids,
+                             std::vector<ObjectMeta>& meta_datas,
+                             const bool sync_remote = false) = 0;
+
   /**
    * Sync remote metadata from etcd to the connected vineyardd.
    *
@@ -180,6 +213,37 @@ class ClientBase {
                   size_t const limit,
                   std::unordered_map<ObjectID, json>& meta_trees);
 
+  /**
+   * @brief List a page of object ids in vineyard, using the given typename
+   * patterns and filters, without resolving the metadatas of objects.
+   *
+   * @param pattern The pattern string that will be used to matched against
+   * objects' `typename`.
+   * @param regex Whether the pattern is a regular expression pattern.
+   * @param limit The number limit for how many objects will be returned in
+   * the page at most.
+   * @param filters The filters that the objects must satisfy, i.e.,
+   * "instance_id", "created_after" and "created_before" (in microseconds
+   * since the epoch), "min_nbytes" and "max_nbytes", all are optional.
+   * @param fields The top-level fields (e.g., "typename", "nbytes") that will
+   * be returned with the ids, nothing but the ids are returned when empty.
+   * @param cursor The cursor of the page, empty for the first page, and will
+   * be updated to the cursor of the next page, which is empty when there's
+   * no more objects.
+   * @param ids The ids of the listed objects.
+   * @param projections The requested fields of the listed objects.
+   *
+   * Note that a page may be shorter than `limit` (even empty) when the
+   * filters are selective, the listing ends only when the cursor is empty.
+   *
+   * @return Status that indicates whether the list action has succeeded.
+   */
+  Status ListDataPage(std::string const& pattern, bool const regex,
+                      size_t const limit, json const& filters,
+                      std::vector<std::string> const& fields,
+                      std::string& cursor, std::vector<ObjectID>& ids,
+                      std::unordered_map<ObjectID, json>& projections);
+
   /**
    * @brief Allocate a stream on vineyard. The metadata of parameter `id` must
    * has already been created on vineyard.
@@ -190,12 +254,38 @@ class ClientBase {
    */
   Status CreateStream(const ObjectID& id);
 
+  /**
+   * @brief Allocate a stream on vineyard with backpressure. The writer of the
+   * stream will be blocked once the chunks that haven't been consumed reach
+   * the high watermark (in bytes, or in number of chunks), until the reader
+   * catches up with the low watermark. Zero means unlimited.
+   *
+   * When `recycle_chunks` is true, the consumed chunks are kept by the stream
+   * and reused for the subsequent chunks of the same size, rather than being
+   * freed and allocated again.
+   *
+   * @param id The id of metadata that will be used to create stream.
+   * @param high_watermark_bytes The high watermark in bytes.
+   * @param low_watermark_bytes The low watermark in bytes.
+   * @param high_watermark_chunks The high watermark in number of chunks.
+   * @param low_watermark_chunks The low watermark in number of chunks.
+   * @param recycle_chunks Whether to reuse the consumed chunks.
+   *
+   * @return Status that indicates whether the create action has succeeded.
+   */
+  Status CreateStream(const ObjectID& id, const size_t high_watermark_bytes,
+                      const size_t low_watermark_bytes,
+                      const size_t high_watermark_chunks = 0,
+                      const size_t low_watermark_chunks = 0,
+                      const bool recycle_chunks = false);
+
   /**
    * @brief open a stream on vineyard. Failed if the stream is already opened on
    * the given mode.
    *
    * @param id The id of stream to mark.
-   * @param mode The mode, StreamOpenMode::read or StreamOpenMode::write.
+   * @param mode The mode, StreamOpenMode::read, StreamOpenMode::fanout,
+   * StreamOpenMode::shared or StreamOpenMode::write.
    *
    * @return Status that indicates whether the open action has succeeded.
    */
@@ -214,6 +304,18 @@ class ClientBase {
    */
   Status PushNextStreamChunk(ObjectID const id, ObjectID const chunk);
 
+  /**
+   * @brief Push a batch of chunks to a stream in a single round trip, the
+   * chunks are made available to the reader in order.
+   *
+   * @param id The id of the stream.
+   * @param chunks The immutable chunks generated by the writer of the stream.
+   *
+   * @return Status that indicates whether the pushing has succeeded.
+   */
+  Status PushNextStreamChunks(ObjectID const id,
+                              std::vector<ObjectID> const& chunks);
+
   /**
    * @brief Pull a chunk from a stream. When there's no more chunk available in
    * the stream, i.e., the stream has been stoped, a status code
@@ -227,6 +329,24 @@ class ClientBase {
    */
   Status PullNextStreamChunk(ObjectID const id, ObjectID& chunk);
 
+  /**
+   * @brief Pull a batch of chunks from a stream in a single round trip. The
+   * reader will be blocked until there's at least one chunk, and the chunks
+   * that are ready at the time will be returned in order, up to the given
+   * limits.
+   *
+   * @param id The id of the stream.
+   * @param max_chunks The max number of chunks to pull.
+   * @param max_bytes The max total size of the chunks to pull, zero means
+   * unlimited. The first chunk is always returned even if it is larger.
+   * @param chunks The immutable chunks generated by the writer of the stream.
+   *
+   * @return Status that indicates whether the polling has succeeded.
+   */
+  Status PullNextStreamChunks(ObjectID const id, size_t const max_chunks,
+                              size_t const max_bytes,
+                              std::vector<ObjectID>& chunks);
+
   /**
    * @brief Pull a chunk from a stream. When there's no more chunk available in
    * the stream, i.e., the stream has been stoped, a status code
@@ -274,6 +394,70 @@ class ClientBase {
    */
   Status Persist(const ObjectID id);
 
+  /**
+   * @brief Persist many objects in a single round trip.
+   *
+   * @param ids The object ids of objects that will be persisted.
+   *
+   * @return Status that indicates whether the persist action has succeeded.
+   */
+  Status Persist(const std::vector<ObjectID>& ids);
+
+  /**
+   * @brief Persist the given object in the background: returns once the
+   * connected vineyard server accepts the request, without waiting for etcd.
+   * The object id is the handle of the persistence, whose completion is
+   * observed by `PollPersist` and `WaitPersist`. Clients that connect to other
+   * vineyard servers see the object once the persistence completes.
+   *
+   * @param id The object id of object that will be persisted.
+   *
+   * @return Status that indicates whether the request has been accepted.
+   */
+  Status PersistAsync(const ObjectID id);
+
+  /**
+   * @brief Persist many objects in the background in a single round trip.
+   */
+  Status PersistAsync(const std::vector<ObjectID>& ids);
+
+  /**
+   * @brief Check if the asynchronous persistence of the given object has
+   * completed, without blocking.
+   *
+   * @param id The object id that has been passed to `PersistAsync`.
+   * @param persisted The result variable, true means the persistence has
+   * completed.
+   *
+   * @return Status that indicates whether the persistence has failed.
+   */
+  Status PollPersist(const ObjectID id, bool& persisted);
+
+  /**
+   * @brief Wait until the asynchronous persistence of the given object
+   * completes.
+   *
+   * @param id The object id that has been passed to `PersistAsync`.
+   *
+   * @return Status that indicates whether the persistence has succeeded.
+   */
+  Status WaitPersist(const ObjectID id);
+
+  /**
+   * @brief Lease the given objects for `ttl` seconds, to let the vineyard
+   * server collect them when the client has crashed: the leases are renewed
+   * as long as the client stays connected, and the objects that are still not
+   * persisted are deleted once `ttl` seconds have passed since the client
+   * disconnected. Leasing again renews the leases for the current client, and
+   * a non-positive `ttl` releases them.
+   *
+   * @param ids The object ids of objects to lease.
+   * @param ttl The time-to-live (in seconds) after the client disconnects.
+   *
+   * @return Status that indicates whether the lease has succeeded.
+   */
+  Status Lease(const std::vector<ObjectID>& ids, int64_t const ttl);
+
   /**
    * @brief Check if the given object has been persist to etcd.
    *
@@ -396,6 +580,62 @@ class ClientBase {
    */
   Status MigrateStream(const ObjectID object_id, ObjectID& result_id);
 
+  /**
+   * @brief Replicate an object to many instances along a broadcast tree.
+   *
+   * In each round every instance that has got a replica forwards it to
+   * another instance, thus the number of rounds grows logarithmically with
+   * the number of targets. Hosts are covered first using the host
+   * information from `ClusterInfo`, then the instances on the same host copy
+   * from the replicas on that host.
+   *
+   * @param object_id The object to replicate.
+   * @param targets The instances to replicate the object to.
+   * @param replicas Record the replica on each target instance, the origin
+   * instance is associated with the object itself.
+   *
+   * @return Status that indicates if the replication success.
+   */
+  Status Broadcast(const ObjectID object_id,
+                   const std::vector<InstanceID>& targets,
+                   std::map<InstanceID, ObjectID>& replicas);
+
+  /**
+   * @brief Prefetch the objects to the instance `target` ahead of the jobs
+   * that will use them, e.g., by a scheduler that knows where the jobs will
+   * run. The objects are migrated to the target concurrently, and the local
+   * blobs of the replicas are pinned on the target for `pin_ttl` seconds,
+   * thus they won't be evicted before the jobs start. The objects that have
+   * been prefetched to the target already are pinned again.
+   *
+   * A job on the target instance that calls `MigrateObject()` gets the
+   * prefetched replica at once, rather than migrating the object again.
+   *
+   * @param ids The objects to prefetch.
+   * @param target The instance that the objects will be prefetched to.
+   * @param pin_ttl How long (in seconds) the replicas are pinned.
+   * @param replicas Record the replica of each object on the target.
+   *
+   * @return Status that indicates if the prefetch success.
+   */
+  Status Prefetch(const std::vector<ObjectID>& ids, InstanceID const target,
+                  int64_t const pin_ttl, std::vector<ObjectID>& replicas);
+
+  /**
+   * @brief Prefetch the objects in the background, see also `Prefetch()`.
+   * The client must outlive the returned future, and can serve other
+   * requests in the meantime.
+   */
+  std::future<Status> PrefetchAsync(const std::vector<ObjectID>& ids,
+                                    InstanceID const target,
+                                    int64_t const pin_ttl);
+
+  /**
+   * @brief Release the pinned replicas of the objects that have been
+   * prefetched to the connected instance.
+   */
+  Status Unpin(const std::vector<ObjectID>& ids);
+
   /**
    * @brief Clear all objects _that are visible to current instances_ in
             the cluster.
@@ -460,6 +700,33 @@ class ClientBase {
    */
   Status InstanceStatus(std::shared_ptr<struct InstanceStatus>& status);
 
+  /**
+   * @brief Attribute the shared memory of the connected vineyard instance to
+   * the objects that hold the blobs, aggregated by the type name, the instance
+   * and the client process that created the blobs.
+   *
+   * @param usage The memory usage, where "by_type", "by_instance" and
+   * "by_owner" map the group to its "objects", "blobs" and "bytes", and
+   * "top_objects" lists the objects that hold the most bytes.
+   *
+   * @return Status that indicates whether the query has succeeded.
+   */
+  Status MemoryAttribution(json& usage);
+
+  /**
+   * @brief Write the sealed blobs of the connected vineyard instance, and the
+   * metadata of the objects that live in this instance only, to a
+   * checkpoint file on the host of the instance, which is loaded back when
+   * vineyardd restarts with `--restore_checkpoint`.
+   *
+   * @param path The path of the checkpoint file on the server side.
+   * @param stats The number of "blobs" and "bytes" that have been written,
+   * and the "seconds" that have been taken.
+   *
+   * @return Status that indicates whether the checkpoint has succeeded.
+   */
+  Status Checkpoint(const std::string& path, json& stats);
+
   /**
    * @brief List all instances in the connected vineyard cluster.
    *
@@ -494,6 +761,13 @@ class ClientBase {
 
   Status doRead(json& root);
 
+  /**
+   * @brief Send the requests in a batch and receive their replies in order,
+   * in a single round trip if the server supports batching.
+   */
+  Status doBatch(const std::vector<std::string>& messages_out,
+                 std::vector<json>& messages_in);
+
   /**
    * @brief Implementation for migrate remote object to local.
    *
@@ -504,16 +778,31 @@ class ClientBase {
                            std::string const& peer,
                            std::string const& peer_rpc_endpoint);
 
+  Status prefetchImpl(const std::vector<ObjectID>& ids,
+                      const std::vector<ObjectID>& replicas, int64_t const ttl,
+                      std::vector<ObjectID>& known);
+
   Status deepCopyImpl(const ObjectID object_id, ObjectID& target_id,
                       std::string const& peer,
                       std::string const& peer_rpc_endpoint);
 
+  /**
+   * @brief Migrate the object on the instance `from` to the instance `to`,
+   * both are described by the entries of `ClusterInfo`.
+   */
+  static Status migrateBetween(const ObjectID object_id, const json& from,
+                               const json& to, ObjectID& result_id);
+
   mutable bool connected_;
   std::string ipc_socket_;
   std::string rpc_endpoint_;
   int vineyard_conn_;
   InstanceID instance_id_;
   std::string server_version_;
+  // the encoding of hot commands that the server accepts
+  WireFormat wire_format_;
+  // whether the server accepts batch requests
+  bool support_batch_;
 
   // A mutex which protects the client.
   std::recursive_mutex client_mutex_;
@@ -528,12 +817,29 @@ struct InstanceStatus {
   const size_t memory_usage;
   /// The memory upper bound of this vineyard server, in bytes.
   const size_t memory_limit;
+  /// The fragmentation of the free shared memory, in range [0, 1).
+  const double memory_fragmentation;
+  /// The memory quotas and the resident bytes of the sessions, e.g.,
+  /// `{"etl": {"usage": 1024, "soft_limit": 0, "hard_limit": 4096}}`.
+  const json session_memory;
   /// How many requests are deferred in the queue.
   const size_t deferred_requests;
   /// How many Client connects to this vineyard server.
   const size_t ipc_connections;
   /// How many RPCClient connects to this vineyard server.
   const size_t rpc_connections;
+  /// The number, the cumulative and the maximum time (in microseconds) of the
+  /// requests handled by vineyard server, by command, e.g.,
+  /// `{"get_data_request": {"count": 8, "total_us": 120, "max_us": 40}}`.
+  const json request_stats;
+  /// The same stats of the requests as above, of each alive connection.
+  const json connection_stats;
+  /// The cumulative time spent on committing to the metadata service, in
+  /// microseconds.
+  const double meta_service_time_us;
+  /// The cumulative time spent on allocating from the bulk store, in
+  /// microseconds.
+  const double bulk_store_time_us;
 
   /**
    * @brief Initialize the status value using a json returned from the vineyard
@@ -0,0 +1,76 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "client/client_pool.h"
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "common/util/env.h"
+
+namespace vineyard {
+
+ClientPool::ClientPool() {}
+
+ClientPool::~ClientPool() { Close(); }
+
+Status ClientPool::Open(const std::string& ipc_socket, size_t const size) {
+  RETURN_ON_ASSERT(clients_.empty(), "The client pool has been opened");
+  RETURN_ON_ASSERT(size > 0, "The size of client pool must be positive");
+  std::unique_ptr<Client> client(new Client());
+  RETURN_ON_ERROR(client->Connect(ipc_socket));
+  clients_.emplace_back(std::move(client));
+  for (size_t index = 1; index < size; ++index) {
+    // forked clients share the mmap table
+    std::unique_ptr<Client> forked(new Client());
+    auto status = clients_.front()->Fork(*forked);
+    if (!status.ok()) {
+      Close();
+      return status;
+    }
+    clients_.emplace_back(std::move(forked));
+  }
+  return Status::OK();
+}
+
+void ClientPool::Close() {
+  for (auto& client : clients_) {
+    client->Disconnect();
+  }
+  clients_.clear();
+}
+
+Client& ClientPool::Get() {
+  VINEYARD_ASSERT(!clients_.empty(), "The client pool is not opened");
+  static thread_local size_t hash =
+      std::hash<std::thread::id>()(std::this_thread::get_id());
+  return *clients_[hash % clients_.size()];
+}
+
+ClientPool& ClientPool::Default() {
+  static std::once_flag flag;
+  static ClientPool* pool = new ClientPool();
+  std::call_once(flag, [&] {
+    int size = std::stoi(read_env("VINEYARD_CLIENT_POOL_SIZE", "4"));
+    VINEYARD_CHECK_OK(
+        pool->Open(read_env("VINEYARD_IPC_SOCKET"), std::max(size, 1)));
+  });
+  return *pool;
+}
+
+}  // namespace vineyard
@@ -0,0 +1,78 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_CLIENT_CLIENT_POOL_H_
+#define SRC_CLIENT_CLIENT_POOL_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "client/client.h"
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief ClientPool multiplexes the threads of a process over a small, fixed
+ * number of connections to vineyardd, rather than a connection (and a
+ * registration, and an mmap table) per thread. All connections of the pool
+ * share one mmap table, thus each segment is mapped once per process.
+ *
+ * A thread always gets the same connection of a pool, requests of threads
+ * that share a connection are serialized by the client.
+ *
+ * \code{.cpp}
+ *    auto& client = ClientPool::Default().Get();
+ *    client.GetObject(id, object);
+ * \endcode
+ */
+class ClientPool {
+ public:
+  ClientPool();
+
+  ~ClientPool();
+
+  /**
+   * @brief Connect `size` clients to vineyardd at `ipc_socket`.
+   */
+  Status Open(const std::string& ipc_socket, size_t const size = 4);
+
+  /**
+   * @brief Disconnect all clients of the pool.
+   */
+  void Close();
+
+  /**
+   * @brief The connection of the calling thread.
+   */
+  Client& Get();
+
+  size_t Size() const { return clients_.size(); }
+
+  /**
+   * @brief The process-wide pool connected to the socket specified by the
+   * environment variable `VINEYARD_IPC_SOCKET`, the size is given by
+   * `VINEYARD_CLIENT_POOL_SIZE` (4 by default).
+   */
+  static ClientPool& Default();
+
+ private:
+  std::vector<std::unique_ptr<Client>> clients_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_CLIENT_CLIENT_POOL_H_
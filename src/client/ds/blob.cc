@@ -18,6 +18,9 @@ limitations under the License.
 #include <iomanip>
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "client/client.h"
 #include "common/memory/payload.h"
@@ -198,8 +201,16 @@ void BlobWriter::Dump() const {
 std::shared_ptr<Object> BlobWriter::_Seal(Client& client) {
   VINEYARD_ASSERT(!this->sealed(), "The blob writer has been already sealed.");
   // get blob and re-map
+  if (client.support_deduplication_ && payload_.data_size > 0 &&
+      !payload_.IsCopyOnWrite() && !buffer_sealed_) {
+    // the content may be kept only once with an identical blob, thus the
+    // buffer of the writer shouldn't be used anymore after sealing
+    VINEYARD_CHECK_OK(client.SealBuffer(object_id_, payload_));
+  }
   uint8_t *mmapped_ptr = nullptr, *dist = nullptr;
-  if (payload_.data_size > 0) {
+  if (payload_.IsCopyOnWrite()) {
+    VINEYARD_CHECK_OK(client.shm_->MmapExtents(payload_, true, &dist));
+  } else if (payload_.data_size > 0) {
     VINEYARD_CHECK_OK(client.shm_->Mmap(payload_.store_fd, payload_.map_size,
                                         false, true, &mmapped_ptr));
     dist = mmapped_ptr + payload_.data_offset;
@@ -231,6 +242,72 @@ std::shared_ptr<Object> BlobWriter::_Seal(Client& client) {
   return blob;
 }
 
+Status BlobWriter::SealBuffers(
+    Client& client, std::vector<std::shared_ptr<BlobWriter>> const& writers) {
+  if (!client.support_deduplication_) {
+    return Status::OK();
+  }
+  std::vector<BlobWriter*> targets;
+  std::vector<ObjectID> ids;
+  for (auto const& writer : writers) {
+    if (writer->sealed() || writer->buffer_sealed_ ||
+        writer->payload_.data_size == 0 || writer->payload_.IsCopyOnWrite()) {
+      continue;
+    }
+    targets.emplace_back(writer.get());
+    ids.emplace_back(writer->object_id_);
+  }
+  if (targets.empty()) {
+    return Status::OK();
+  }
+  std::vector<Payload> payloads;
+  RETURN_ON_ERROR(client.SealBuffers(ids, payloads));
+  for (size_t idx = 0; idx < targets.size(); ++idx) {
+    targets[idx]->payload_ = payloads[idx];
+    targets[idx]->buffer_sealed_ = true;
+  }
+  return Status::OK();
+}
+
+Status BlobWriterGroup::Make(Client& client, const std::vector<size_t>& sizes,
+                             std::unique_ptr<BlobWriterGroup>& group) {
+  std::vector<std::unique_ptr<BlobWriter>> writers;
+  RETURN_ON_ERROR(client.CreateBlobs(sizes, writers));
+  group.reset(new BlobWriterGroup());
+  for (auto& writer : writers) {
+    group->writers_.emplace_back(std::move(writer));
+  }
+  return Status::OK();
+}
+
+Status BlobWriterGroup::Seal(Client& client,
+                             std::vector<std::shared_ptr<Blob>>& blobs) {
+  blobs.clear();
+  RETURN_ON_ERROR(BlobWriter::SealBuffers(client, writers_));
+  for (auto const& writer : writers_) {
+    if (writer->sealed()) {
+      continue;
+    }
+    auto blob = std::dynamic_pointer_cast<Blob>(writer->Seal(client));
+    RETURN_ON_ASSERT(blob != nullptr, "Failed to seal the blob");
+    blobs.emplace_back(blob);
+  }
+  return Status::OK();
+}
+
+Status BlobWriterGroup::Abort(Client& client) {
+  Status status = Status::OK();
+  for (auto const& writer : writers_) {
+    if (!writer->sealed()) {
+      auto s = writer->Abort(client);
+      if (status.ok()) {
+        status = s;
+      }
+    }
+  }
+  return status;
+}
+
 Status BufferSet::EmplaceBuffer(ObjectID const id) {
   auto p = buffers_.find(id);
   if (p != buffers_.end() && p->second != nullptr) {
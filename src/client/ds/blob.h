@@ -23,6 +23,7 @@ limitations under the License.
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "arrow/buffer.h"
 
@@ -219,6 +220,16 @@ class BlobWriter : public ObjectBuilder {
    */
   void Dump() const;
 
+  /**
+   * @brief Seal the buffers of many blob writers in the server with a single
+   * round trip, before they are sealed (e.g., as members of other builders).
+   * The content of the writers shouldn't be modified anymore.
+   *
+   * It is a no-op when the server doesn't seal blobs by itself.
+   */
+  static Status SealBuffers(
+      Client& client, std::vector<std::shared_ptr<BlobWriter>> const& writers);
+
  protected:
   std::shared_ptr<Object> _Seal(Client& client) override;
 
@@ -234,6 +245,8 @@ class BlobWriter : public ObjectBuilder {
   ObjectID object_id_;
   Payload payload_;
   std::shared_ptr<arrow::MutableBuffer> buffer_;
+  // whether the buffer has been sealed in the server, see `SealBuffers()`
+  bool buffer_sealed_ = false;
   // Allowing blobs have extra key-value metadata
   std::unordered_map<std::string, std::string> metadata_;
 
@@ -241,6 +254,57 @@ class BlobWriter : public ObjectBuilder {
   friend class RPCClient;
 };
 
+/**
+ * @brief A group of blob writers that are created together with a single
+ * request (when the server supports batched creation), for builders that
+ * produce many small buffers, e.g., wide dataframes with many small columns.
+ *
+ * \code{.cpp}
+ *    std::unique_ptr<BlobWriterGroup> group;
+ *    VINEYARD_CHECK_OK(BlobWriterGroup::Make(client, sizes, group));
+ *    for (size_t index = 0; index < group->size(); ++index) {
+ *      memcpy(group->Writer(index)->data(), ..., sizes[index]);
+ *    }
+ *    std::vector<std::shared_ptr<Blob>> blobs;
+ *    VINEYARD_CHECK_OK(group->Seal(client, blobs));
+ * \endcode
+ */
+class BlobWriterGroup {
+ public:
+  static Status Make(Client& client, const std::vector<size_t>& sizes,
+                     std::unique_ptr<BlobWriterGroup>& group);
+
+  size_t size() const { return writers_.size(); }
+
+  /**
+   * @brief The writer of the `index`-th blob, which can also be used as a
+   * member of other builders directly.
+   */
+  const std::shared_ptr<BlobWriter>& Writer(size_t const index) const {
+    return writers_[index];
+  }
+
+  /**
+   * @brief Seal the blobs that haven't been sealed (e.g., as members of
+   * other builders) yet.
+   *
+   * When the server deduplicates the sealed buffers, the buffers of the whole
+   * group are sealed with a single request, see `BlobWriter::SealBuffers`,
+   * otherwise sealing a blob doesn't involve the server at all.
+   */
+  Status Seal(Client& client, std::vector<std::shared_ptr<Blob>>& blobs);
+
+  /**
+   * @brief Abort the blobs that haven't been sealed yet.
+   */
+  Status Abort(Client& client);
+
+ private:
+  BlobWriterGroup() = default;
+
+  std::vector<std::shared_ptr<BlobWriter>> writers_;
+};
+
 /**
  * @brief A set of (readonly) buffers that been associated with an object and
  * its members (recursively).
@@ -0,0 +1,205 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_CLIENT_DS_DLPACK_H_
+#define SRC_CLIENT_DS_DLPACK_H_
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__has_include) && __has_include("dlpack/dlpack.h")
+#include "dlpack/dlpack.h"
+#else
+// the ABI of DLPack (since v0.6), see also
+// https://github.com/dmlc/dlpack/blob/main/include/dlpack/dlpack.h
+extern "C" {
+
+typedef enum {
+  kDLCPU = 1,
+  kDLCUDA = 2,
+  kDLCUDAHost = 3,
+} DLDeviceType;
+
+typedef struct {
+  DLDeviceType device_type;
+  int32_t device_id;
+} DLDevice;
+
+typedef enum {
+  kDLInt = 0U,
+  kDLUInt = 1U,
+  kDLFloat = 2U,
+} DLDataTypeCode;
+
+typedef struct {
+  uint8_t code;
+  uint8_t bits;
+  uint16_t lanes;
+} DLDataType;
+
+typedef struct {
+  void* data;
+  DLDevice device;
+  int32_t ndim;
+  DLDataType dtype;
+  int64_t* shape;
+  int64_t* strides;
+  uint64_t byte_offset;
+} DLTensor;
+
+typedef struct DLManagedTensor {
+  DLTensor dl_tensor;
+  void* manager_ctx;
+  void (*deleter)(struct DLManagedTensor* self);
+} DLManagedTensor;
+
+}  // extern "C"
+#endif
+
+#include "client/ds/blob.h"
+#include "common/util/status.h"
+
+namespace vineyard {
+
+namespace detail {
+
+// `kDLBool` only exists since DLPack v0.8
+constexpr uint8_t kDLPackBool = 6U;
+
+struct DLPackContext {
+  std::shared_ptr<Blob> buffer;
+  std::vector<int64_t> shape;
+  std::vector<int64_t> strides;
+  DLManagedTensor tensor;
+};
+
+}  // namespace detail
+
+/**
+ * @brief The DLPack data type of the elements of type `T`.
+ */
+template <typename T>
+inline DLDataType DLPackDataType() {
+  static_assert(std::is_arithmetic<T>::value,
+                "Only the arithmetic types can be exported as DLPack tensors");
+  DLDataType dtype;
+  if (std::is_same<T, bool>::value) {
+    dtype.code = detail::kDLPackBool;
+  } else if (std::is_floating_point<T>::value) {
+    dtype.code = kDLFloat;
+  } else if (std::is_signed<T>::value) {
+    dtype.code = kDLInt;
+  } else {
+    dtype.code = kDLUInt;
+  }
+  dtype.bits = static_cast<uint8_t>(sizeof(T) * 8);
+  dtype.lanes = 1;
+  return dtype;
+}
+
+/**
+ * @brief The DLPack data type for the `value_type_` of tensors, which is
+ * either the name of a numpy dtype, e.g., "float64", or of a C++ type, e.g.,
+ * "double".
+ */
+inline Status DLPackDataType(std::string const& name, DLDataType& dtype) {
+  auto bits_of = [&name](size_t const prefix) -> int {
+    return prefix < name.size() ? std::atoi(name.c_str() + prefix) : 0;
+  };
+  int bits = 0;
+  if (name == "bool") {
+    dtype.code = detail::kDLPackBool;
+    bits = 8;
+  } else if (name == "float" || name == "double") {
+    dtype.code = kDLFloat;
+    bits = name == "float" ? 32 : 64;
+  } else if (name.compare(0, 5, "float") == 0) {
+    dtype.code = kDLFloat;
+    bits = bits_of(5);
+  } else if (name.compare(0, 4, "uint") == 0) {
+    dtype.code = kDLUInt;
+    bits = bits_of(4);
+  } else if (name.compare(0, 3, "int") == 0) {
+    dtype.code = kDLInt;
+    bits = bits_of(3);
+  }
+  if (bits != 8 && bits != 16 && bits != 32 && bits != 64) {
+    return Status::NotImplemented("Elements of type '" + name +
+                                  "' cannot be exported as DLPack tensors");
+  }
+  dtype.bits = static_cast<uint8_t>(bits);
+  dtype.lanes = 1;
+  return Status::OK();
+}
+
+/**
+ * @brief The strides, in number of elements, of a dense tensor in row-major
+ * (or column-major) order.
+ */
+inline std::vector<int64_t> DLPackStrides(std::vector<int64_t> const& shape,
+                                          bool const column_major) {
+  std::vector<int64_t> strides(shape.size(), 1);
+  if (column_major) {
+    for (size_t i = 1; i < shape.size(); ++i) {
+      strides[i] = strides[i - 1] * shape[i - 1];
+    }
+  } else {
+    for (size_t i = shape.size(); i > 1; --i) {
+      strides[i - 2] = strides[i - 1] * shape[i - 1];
+    }
+  }
+  return strides;
+}
+
+/**
+ * @brief Wrap the buffer of a blob as a DLPack tensor without copying, the
+ * tensor points right into the shared memory and keeps the blob alive until
+ * the consumer calls its `deleter`. As the blob has been sealed, consumers
+ * are not expected to write the tensor.
+ *
+ * @param strides The strides in number of elements, see `DLPackStrides`.
+ */
+inline DLManagedTensor* MakeDLPackTensor(std::shared_ptr<Blob> const& buffer,
+                                         DLDataType const& dtype,
+                                         std::vector<int64_t> const& shape,
+                                         std::vector<int64_t> const& strides) {
+  auto context = new detail::DLPackContext();
+  context->buffer = buffer;
+  context->shape = shape;
+  context->strides = strides;
+
+  DLTensor& tensor = context->tensor.dl_tensor;
+  tensor.data = const_cast<char*>(buffer->data());
+  tensor.device.device_type = kDLCPU;
+  tensor.device.device_id = 0;
+  tensor.ndim = static_cast<int32_t>(context->shape.size());
+  tensor.dtype = dtype;
+  tensor.shape = context->shape.data();
+  tensor.strides = context->strides.data();
+  tensor.byte_offset = 0;
+  context->tensor.manager_ctx = context;
+  context->tensor.deleter = [](DLManagedTensor* self) {
+    delete static_cast<detail::DLPackContext*>(self->manager_ctx);
+  };
+  return &context->tensor;
+}
+
+}  // namespace vineyard
+
+#endif  // SRC_CLIENT_DS_DLPACK_H_
@@ -164,19 +164,61 @@ void ObjectMeta::AddMember(const std::string& name, const ObjectID member_id) {
 }
 
 std::shared_ptr<Object> ObjectMeta::GetMember(const std::string& name) const {
-  ObjectMeta meta = this->GetMemberMeta(name);
-  auto object = ObjectFactory::Create(meta.GetTypeName());
-  if (object == nullptr) {
-    object = std::unique_ptr<Object>(new Object());
-  }
-  object->Construct(meta);
+  std::shared_ptr<Object> object;
+  VINEYARD_CHECK_OK(this->GetMember(name, object));
   return object;
 }
 
+Status ObjectMeta::GetMember(const std::string& name,
+                             std::shared_ptr<Object>& object) const {
+  ObjectMeta meta;
+  RETURN_ON_ERROR(this->GetMemberMeta(name, meta));
+  auto member = ObjectFactory::Create(meta.GetTypeName());
+  if (member == nullptr) {
+    member = std::unique_ptr<Object>(new Object());
+  }
+  member->Construct(meta);
+  object = std::shared_ptr<Object>(member.release());
+  return Status::OK();
+}
+
+static bool is_meta_placeholder(const json& tree) {
+  return tree.is_object() && tree.size() == 1 && tree.contains("id") &&
+         !IsBlob(ObjectIDFromString(tree["id"].get_ref<std::string const&>()));
+}
+
+static bool has_meta_placeholder(const json& tree) {
+  for (auto const& item : tree) {
+    if (item.is_object() &&
+        (is_meta_placeholder(item) || has_meta_placeholder(item))) {
+      return true;
+    }
+  }
+  return false;
+}
+
 ObjectMeta ObjectMeta::GetMemberMeta(const std::string& name) const {
   ObjectMeta ret;
+  VINEYARD_CHECK_OK(this->GetMemberMeta(name, ret));
+  return ret;
+}
+
+Status ObjectMeta::GetMemberMeta(const std::string& name,
+                                 ObjectMeta& ret) const {
+  RETURN_ON_ASSERT(meta_.contains(name) && !meta_[name].is_null(),
+                   "Failed to get member " + name);
   auto const& child_meta = meta_[name];
-  VINEYARD_ASSERT(!child_meta.is_null(), "Failed to get member " + name);
+
+  if (client_ != nullptr && is_meta_placeholder(child_meta)) {
+    // resolve the member on demand
+    RETURN_ON_ERROR(client_->GetMetaData(
+        ObjectIDFromString(child_meta["id"].get_ref<std::string const&>()),
+        ret));
+    if (this->force_local_) {
+      ret.ForceLocal();
+    }
+    return Status::OK();
+  }
 
   ret.SetMetaData(this->client_, child_meta);
   auto const& all_blobs = buffer_set_->AllBuffers();
@@ -190,7 +232,34 @@ ObjectMeta ObjectMeta::GetMemberMeta(const std::string& name) const {
   if (this->force_local_) {
     ret.ForceLocal();
   }
-  return ret;
+  return Status::OK();
+}
+
+Status ObjectMeta::ResolveMembers(const std::vector<std::string>& names) {
+  std::vector<std::string> members;
+  std::vector<ObjectID> member_ids;
+  for (auto const& name : names) {
+    auto const& child_meta = meta_[name];
+    RETURN_ON_ASSERT(!child_meta.is_null(), "Failed to get member " + name);
+    if (is_meta_placeholder(child_meta)) {
+      members.emplace_back(name);
+      member_ids.emplace_back(
+          ObjectIDFromString(child_meta["id"].get_ref<std::string const&>()));
+    }
+  }
+  if (member_ids.empty()) {
+    return Status::OK();
+  }
+  RETURN_ON_ASSERT(client_ != nullptr,
+                   "The metadata is not associated with a client");
+  std::vector<ObjectMeta> member_metas;
+  RETURN_ON_ERROR(client_->GetMetaData(member_ids, member_metas));
+  for (size_t index = 0; index < members.size(); ++index) {
+    meta_[members[index]] = member_metas[index].meta_;
+    buffer_set_->Extend(member_metas[index].buffer_set_);
+  }
+  incomplete_ = has_meta_placeholder(meta_);
+  return Status::OK();
 }
 
 Status ObjectMeta::GetBuffer(const ObjectID blob_id,
@@ -284,6 +353,9 @@ void ObjectMeta::findAllBlobs(const json& tree) {
         tree["instance_id"].get<InstanceID>() == client_->instance_id()) {
       VINEYARD_CHECK_OK(buffer_set_->EmplaceBuffer(member_id));
     }
+  } else if (is_meta_placeholder(tree)) {
+    // members to be resolved on demand
+    incomplete_ = true;
   } else {
     for (auto& item : tree) {
       if (item.is_object()) {
@@ -466,6 +466,16 @@ class ObjectMeta {
    */
   std::shared_ptr<Object> GetMember(const std::string& name) const;
 
+  /**
+   * @brief Get member value from vineyard, the failure (e.g., of fetching
+   * the metadata of a lazy member) is returned rather than thrown.
+   *
+   * @param name The name of member object.
+   * @param object The member object.
+   */
+  Status GetMember(const std::string& name,
+                   std::shared_ptr<Object>& object) const;
+
   /**
    * @brief Get member's ObjectMeta value.
    *
@@ -474,6 +484,25 @@ class ObjectMeta {
    */
   ObjectMeta GetMemberMeta(const std::string& name) const;
 
+  /**
+   * @brief Get member's ObjectMeta value, the member that is still a
+   * placeholder (e.g., got by `Client::GetLazyMetaData()`) is fetched on
+   * demand, and the failure of fetching is returned rather than thrown.
+   *
+   * @param name The name of member object.
+   * @param meta The metadata of member object.
+   */
+  Status GetMemberMeta(const std::string& name, ObjectMeta& meta) const;
+
+  /**
+   * @brief Fetch the metadata of members that are still placeholders (e.g.,
+   * got by `Client::GetLazyMetaData()`) in a single request, and fill them
+   * in place.
+   *
+   * @param names The name of member objects.
+   */
+  Status ResolveMembers(const std::vector<std::string>& names);
+
   /**
    * @brief Get buffer member (directed or indirected) from the metadata. The
    * metadata should has already been initialized.
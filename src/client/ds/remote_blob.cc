@@ -0,0 +1,69 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "client/ds/remote_blob.h"
+
+#include <cstdint>
+#include <string>
+
+#include "client/rpc_client.h"
+
+namespace vineyard {
+
+RemoteBlobWriter::~RemoteBlobWriter() { VINEYARD_DISCARD(Abort()); }
+
+ObjectID RemoteBlobWriter::id() const { return object_id_; }
+
+size_t RemoteBlobWriter::size() const { return size_; }
+
+size_t RemoteBlobWriter::offset() const { return offset_; }
+
+Status RemoteBlobWriter::Append(const void* data, size_t const size) {
+  RETURN_ON_ASSERT(!finished_, "The remote blob has been sealed or aborted");
+  RETURN_ON_ASSERT(size <= size_ - offset_,
+                   "The content exceeds the size of the remote blob: " +
+                       std::to_string(offset_ + size) + " vs. " +
+                       std::to_string(size_));
+  if (size == 0) {
+    return Status::OK();
+  }
+  RETURN_ON_ERROR(client_.writeRemoteBufferChunk(
+      object_id_, offset_, reinterpret_cast<const uint8_t*>(data), size,
+      compressed_));
+  offset_ += size;
+  return Status::OK();
+}
+
+Status RemoteBlobWriter::Seal(ObjectID& id) {
+  RETURN_ON_ASSERT(!finished_, "The remote blob has been sealed or aborted");
+  RETURN_ON_ASSERT(offset_ == size_,
+                   "The content of the remote blob is incomplete: " +
+                       std::to_string(offset_) + " vs. " +
+                       std::to_string(size_));
+  RETURN_ON_ERROR(client_.sealRemoteBuffer(object_id_));
+  finished_ = true;
+  id = object_id_;
+  return Status::OK();
+}
+
+Status RemoteBlobWriter::Abort() {
+  if (finished_) {
+    return Status::OK();
+  }
+  finished_ = true;
+  return client_.dropRemoteBuffer(object_id_);
+}
+
+}  // namespace vineyard
@@ -0,0 +1,106 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_CLIENT_DS_REMOTE_BLOB_H_
+#define SRC_CLIENT_DS_REMOTE_BLOB_H_
+
+#include <cstddef>
+
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+class RPCClient;
+
+/**
+ * @brief The writer to stream the content of a blob into a remote vineyard
+ * server. The blob is allocated on the server when the writer is created by
+ * `RPCClient::CreateRemoteBlob`, and the content is sent in chunks as it is
+ * produced, without staging the whole payload locally.
+ *
+ * The writer must not outlive the RPCClient that creates it, and the blob is
+ * dropped if the writer is destroyed before being sealed.
+ */
+class RemoteBlobWriter {
+ public:
+  ~RemoteBlobWriter();
+
+  /**
+   * @brief Return the object id of the blob on the remote server.
+   *
+   * @return The ObjectID of the remote blob.
+   */
+  ObjectID id() const;
+
+  /**
+   * @brief Get the size of the blob, i.e., the number of bytes of the data
+   * payload in the blob.
+   *
+   * @return The size of the blob.
+   */
+  size_t size() const;
+
+  /**
+   * @brief Get the number of bytes that have been written to the blob.
+   *
+   * @return The size of the written content.
+   */
+  size_t offset() const;
+
+  /**
+   * @brief Send the next chunk of content to the remote blob, right after
+   * the content that has been written.
+   *
+   * @param data The content of the chunk.
+   * @param size The size of the chunk, which must not exceed the rest of the
+   * blob.
+   */
+  Status Append(const void* data, size_t const size);
+
+  /**
+   * @brief Finish the remote blob after the whole content has been written.
+   *
+   * @param id The object id of the blob on the remote server.
+   */
+  Status Seal(ObjectID& id);
+
+  /**
+   * @brief Abort the writer and drop the remote blob if it is not sealed.
+   */
+  Status Abort();
+
+ private:
+  RemoteBlobWriter(RPCClient& client, ObjectID const object_id,
+                   size_t const size, bool const compressed)
+      : client_(client),
+        object_id_(object_id),
+        size_(size),
+        compressed_(compressed) {}
+
+  RPCClient& client_;
+  ObjectID object_id_;
+  size_t size_;
+  size_t offset_ = 0;
+  bool compressed_;
+  // sealed or aborted
+  bool finished_ = false;
+
+  friend class RPCClient;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_CLIENT_DS_REMOTE_BLOB_H_
@@ -15,22 +15,95 @@ limitations under the License.
 
 #include "client/rpc_client.h"
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <mutex>
+#include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "arrow/memory_pool.h"
+#include "arrow/util/config.h"
+
+#include "client/client.h"
 #include "client/ds/blob.h"
 #include "client/ds/object_factory.h"
+#include "client/ds/remote_blob.h"
 #include "client/io.h"
 #include "client/utils.h"
 #include "common/util/boost.h"
+#include "common/util/compression.h"
 #include "common/util/env.h"
 #include "common/util/protocols.h"
 
 namespace vineyard {
 
+// transfers smaller than this won't be split across connections
+static constexpr size_t kMinParallelFetchSize = 64 * 1024 * 1024;
+
+static Status allocateBuffer(size_t const size,
+                             std::shared_ptr<arrow::Buffer>& buffer) {
+#if defined(ARROW_VERSION) && ARROW_VERSION < 17000
+  auto status = arrow::AllocateBuffer(arrow::default_memory_pool(), size,
+                                      &buffer);
+  if (!status.ok()) {
+    return Status::ArrowError(status);
+  }
+#else
+  auto result = arrow::AllocateBuffer(size, arrow::default_memory_pool());
+  if (!result.ok()) {
+    return Status::ArrowError(result.status());
+  }
+  buffer = std::move(result).ValueOrDie();
+#endif
+  return Status::OK();
+}
+
+// receives `length` bytes of content from compressed frames
+static Status recvCompressedBytes(int fd, const std::string& compression,
+                                  uint8_t* data, size_t const length,
+                                  std::string& scratch) {
+  size_t received = 0;
+  while (received < length) {
+    CompressionFrameHeader header;
+    RETURN_ON_ERROR(recv_bytes(fd, &header, sizeof(CompressionFrameHeader)));
+    RETURN_ON_ASSERT(header.content_size > 0 &&
+                         header.content_size <= length - received &&
+                         header.compressed_size <= header.content_size,
+                     "Invalid compressed frame from server");
+    if (header.compressed_size == header.content_size) {
+      RETURN_ON_ERROR(recv_bytes(fd, data + received, header.content_size));
+    } else {
+      scratch.resize(header.compressed_size);
+      RETURN_ON_ERROR(recv_bytes(fd, &scratch[0], header.compressed_size));
+      RETURN_ON_ERROR(DecompressFrame(
+          compression, header, reinterpret_cast<const uint8_t*>(scratch.data()),
+          data + received));
+    }
+    received += header.content_size;
+  }
+  return Status::OK();
+}
+
+// sends `length` bytes of content in compressed frames
+static Status sendCompressedBytes(int fd, const std::string& compression,
+                                  const uint8_t* data, size_t const length,
+                                  std::string& frame) {
+  size_t sent = 0;
+  while (sent < length) {
+    size_t const chunk = std::min(length - sent, kCompressionChunkSize);
+    RETURN_ON_ERROR(CompressFrame(compression, data + sent, chunk, frame));
+    RETURN_ON_ERROR(send_bytes(fd, frame.data(), frame.size()));
+    sent += chunk;
+  }
+  return Status::OK();
+}
+
 RPCClient::~RPCClient() { Disconnect(); }
 
 Status RPCClient::Connect() {
@@ -63,16 +136,21 @@ Status RPCClient::Connect(const std::string& host, uint32_t port) {
     return Status::OK();
   }
   rpc_endpoint_ = rpc_endpoint;
+  QoSClass qos_class = QoSClass::Interactive;
+  RETURN_ON_ERROR(ParseQoSClass(read_env("VINEYARD_QOS_CLASS"), qos_class));
   RETURN_ON_ERROR(connect_rpc_socket_retry(host, port, vineyard_conn_));
   std::string message_out;
-  WriteRegisterRequest(message_out);
+  // the request ring is only available for IPC clients
+  WriteRegisterRequest(WireFormat::MsgPack, 0, qos_class, message_out);
   RETURN_ON_ERROR(doWrite(message_out));
   json message_in;
   RETURN_ON_ERROR(doRead(message_in));
   std::string ipc_socket_value, rpc_endpoint_value;
-  RETURN_ON_ERROR(ReadRegisterReply(message_in, ipc_socket_value,
-                                    rpc_endpoint_value, remote_instance_id_,
-                                    server_version_));
+  size_t ring_capacity_value = 0;
+  RETURN_ON_ERROR(ReadRegisterReply(
+      message_in, ipc_socket_value, rpc_endpoint_value, remote_instance_id_,
+      server_version_, wire_format_, support_batch_, ring_capacity_value,
+      compressions_));
   ipc_socket_ = ipc_socket_value;
   connected_ = true;
 
@@ -106,6 +184,17 @@ Status RPCClient::GetMetaData(const ObjectID id, ObjectMeta& meta,
   return Status::OK();
 }
 
+Status RPCClient::GetLazyMetaData(const ObjectID id, ObjectMeta& meta,
+                                  const bool sync_remote) {
+  ENSURE_CONNECTED(this);
+  std::vector<json> trees;
+  RETURN_ON_ERROR(
+      GetData(std::vector<ObjectID>{id}, trees, sync_remote, false, 0));
+  meta.Reset();
+  meta.SetMetaData(this, trees[0]);
+  return Status::OK();
+}
+
 Status RPCClient::GetMetaData(const std::vector<ObjectID>& ids,
                               std::vector<ObjectMeta>& metas,
                               const bool sync_remote) {
@@ -203,4 +292,314 @@ std::vector<std::shared_ptr<Object>> RPCClient::ListObjects(
   return objects;
 }
 
+Status RPCClient::GetRemoteBuffers(
+    const std::vector<ObjectID>& ids,
+    std::vector<std::shared_ptr<arrow::Buffer>>& buffers,
+    size_t const parallelism, bool const compressed) {
+  ENSURE_CONNECTED(this);
+  buffers.clear();
+  buffers.resize(ids.size());
+  return fetchRemoteBuffersInParallel(ids, parallelism, compressed, buffers);
+}
+
+Status RPCClient::GetRemoteBuffers(
+    Client& local, const std::vector<ObjectID>& ids,
+    std::vector<std::shared_ptr<arrow::Buffer>>& buffers,
+    size_t const parallelism, bool const compressed) {
+  ENSURE_CONNECTED(this);
+  std::vector<ObjectID> local_ids;
+  bool enabled = false;
+  RETURN_ON_ERROR(local.GetCachedBuffers(ids, local_ids, enabled));
+  if (!enabled) {
+    return GetRemoteBuffers(ids, buffers, parallelism, compressed);
+  }
+
+  buffers.clear();
+  buffers.resize(ids.size());
+  std::set<ObjectID> hits;
+  for (auto const& local_id : local_ids) {
+    if (local_id != InvalidObjectID()) {
+      hits.emplace(local_id);
+    }
+  }
+  std::map<ObjectID, std::shared_ptr<arrow::Buffer>> cached;
+  RETURN_ON_ERROR(local.GetBuffers(hits, cached));
+
+  std::vector<ObjectID> misses;
+  std::vector<size_t> miss_indices;
+  for (size_t idx = 0; idx < ids.size(); ++idx) {
+    auto iter = cached.find(local_ids[idx]);
+    if (iter != cached.end()) {
+      buffers[idx] = iter->second;
+    } else {
+      // the copy may have been dropped after the lookup
+      misses.emplace_back(ids[idx]);
+      miss_indices.emplace_back(idx);
+    }
+  }
+  if (misses.empty()) {
+    return Status::OK();
+  }
+
+  // fetches the misses into local blobs, and caches them afterwards
+  std::vector<size_t> sizes;
+  RETURN_ON_ERROR(probeRemoteBuffers(misses, sizes));
+  std::vector<std::unique_ptr<BlobWriter>> writers(misses.size());
+  std::vector<std::shared_ptr<arrow::Buffer>> targets(misses.size());
+  auto abort = [&]() {
+    for (auto& writer : writers) {
+      if (writer) {
+        VINEYARD_DISCARD(writer->Abort(local));
+      }
+    }
+  };
+  for (size_t idx = 0; idx < misses.size(); ++idx) {
+    if (sizes[idx] == 0) {
+      // empty blobs are not worth caching
+      targets[idx] = std::make_shared<arrow::Buffer>(nullptr, 0);
+      continue;
+    }
+    auto status = local.CreateBlob(sizes[idx], writers[idx]);
+    if (!status.ok()) {
+      abort();
+      return status;
+    }
+    targets[idx] = writers[idx]->Buffer();
+  }
+  auto status =
+      fetchRemoteBuffersInParallel(misses, parallelism, compressed, targets);
+  if (!status.ok()) {
+    abort();
+    return status;
+  }
+
+  std::vector<ObjectID> remote_ids, copies;
+  for (size_t idx = 0; idx < misses.size(); ++idx) {
+    buffers[miss_indices[idx]] = targets[idx];
+    if (writers[idx]) {
+      auto blob = writers[idx]->Seal(local);
+      remote_ids.emplace_back(misses[idx]);
+      copies.emplace_back(blob->id());
+    }
+  }
+  if (!remote_ids.empty()) {
+    RETURN_ON_ERROR(local.CacheBuffers(remote_ids, copies));
+  }
+  return Status::OK();
+}
+
+Status RPCClient::fetchRemoteBuffersInParallel(
+    const std::vector<ObjectID>& ids, size_t const parallelism,
+    bool const compressed,
+    std::vector<std::shared_ptr<arrow::Buffer>>& buffers) {
+  size_t const whole = std::numeric_limits<size_t>::max();
+  if (parallelism <= 1) {
+    return fetchRemoteBuffers(
+        ids, std::vector<std::pair<size_t, size_t>>(ids.size(), {0, whole}),
+        compressed, buffers);
+  }
+
+  // inspects the size of blobs (and allocates the buffers) first
+  RETURN_ON_ERROR(fetchRemoteBuffers(
+      ids, std::vector<std::pair<size_t, size_t>>(ids.size(), {0, 0}), false,
+      buffers));
+  size_t total = 0;
+  for (auto const& buffer : buffers) {
+    total += buffer->size();
+  }
+  size_t const shards = std::min(
+      parallelism,
+      std::max(total / kMinParallelFetchSize, static_cast<size_t>(1)));
+  if (shards <= 1) {
+    return fetchRemoteBuffers(
+        ids, std::vector<std::pair<size_t, size_t>>(ids.size(), {0, whole}),
+        compressed, buffers);
+  }
+
+  // splits the blobs into ranges of roughly equal size
+  struct Shard {
+    std::vector<ObjectID> ids;
+    std::vector<std::pair<size_t, size_t>> ranges;
+    std::vector<std::shared_ptr<arrow::Buffer>> buffers;
+  };
+  std::vector<Shard> plan(shards);
+  size_t const shard_size = (total + shards - 1) / shards;
+  size_t shard = 0, shard_filled = 0;
+  for (size_t idx = 0; idx < ids.size(); ++idx) {
+    size_t const size = buffers[idx]->size();
+    size_t offset = 0;
+    while (offset < size) {
+      size_t const length = std::min(size - offset, shard_size - shard_filled);
+      plan[shard].ids.emplace_back(ids[idx]);
+      plan[shard].ranges.emplace_back(offset, length);
+      plan[shard].buffers.emplace_back(buffers[idx]);
+      offset += length;
+      shard_filled += length;
+      if (shard_filled == shard_size && shard + 1 < shards) {
+        shard += 1;
+        shard_filled = 0;
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<RPCClient>> clients(shards - 1);
+  for (auto& client : clients) {
+    client.reset(new RPCClient());
+    RETURN_ON_ERROR(Fork(*client));
+  }
+  std::vector<Status> statuses(shards);
+  std::vector<std::thread> workers;
+  for (size_t idx = 1; idx < shards; ++idx) {
+    workers.emplace_back([&, idx]() {
+      statuses[idx] = clients[idx - 1]->fetchRemoteBuffers(
+          plan[idx].ids, plan[idx].ranges, compressed, plan[idx].buffers);
+    });
+  }
+  statuses[0] = fetchRemoteBuffers(plan[0].ids, plan[0].ranges, compressed,
+                                   plan[0].buffers);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  for (auto const& status : statuses) {
+    RETURN_ON_ERROR(status);
+  }
+  return Status::OK();
+}
+
+Status RPCClient::probeRemoteBuffers(const std::vector<ObjectID>& ids,
+                                     std::vector<size_t>& sizes) {
+  std::string message_out;
+  WriteGetRemoteBuffersRequest(
+      ids, std::vector<std::pair<size_t, size_t>>(ids.size(), {0, 0}), "",
+      message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  std::vector<Payload> payloads;
+  std::string compression;
+  RETURN_ON_ERROR(ReadGetBuffersReply(message_in, payloads, compression));
+  RETURN_ON_ASSERT(payloads.size() == ids.size(),
+                   "The result size doesn't match with the requested sizes");
+  sizes.clear();
+  for (auto const& payload : payloads) {
+    sizes.emplace_back(static_cast<size_t>(payload.data_size));
+  }
+  return Status::OK();
+}
+
+Status RPCClient::fetchRemoteBuffers(
+    const std::vector<ObjectID>& ids,
+    const std::vector<std::pair<size_t, size_t>>& ranges,
+    bool const compressed,
+    std::vector<std::shared_ptr<arrow::Buffer>>& buffers) {
+  std::string compression;
+  if (compressed) {
+    compression = NegotiateCompression(compressions_);
+  }
+  std::string message_out;
+  WriteGetRemoteBuffersRequest(ids, ranges, compression, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  std::vector<Payload> payloads;
+  RETURN_ON_ERROR(ReadGetBuffersReply(message_in, payloads, compression));
+  RETURN_ON_ASSERT(payloads.size() == ids.size(),
+                   "The result size doesn't match with the requested sizes");
+
+  std::string scratch;
+  for (size_t idx = 0; idx < payloads.size(); ++idx) {
+    size_t const size = static_cast<size_t>(payloads[idx].data_size);
+    if (buffers[idx] == nullptr) {
+      RETURN_ON_ERROR(allocateBuffer(size, buffers[idx]));
+    }
+    size_t const offset = std::min(ranges[idx].first, size);
+    size_t const length = std::min(ranges[idx].second, size - offset);
+    if (length == 0) {
+      continue;
+    }
+    RETURN_ON_ASSERT(
+        offset + length <= static_cast<size_t>(buffers[idx]->size()),
+        "The buffer is too small for the blob content");
+    uint8_t* data = buffers[idx]->mutable_data() + offset;
+    Status status;
+    if (compression.empty()) {
+      status = recv_bytes(vineyard_conn_, data, length);
+    } else {
+      status = recvCompressedBytes(vineyard_conn_, compression, data, length,
+                                   scratch);
+    }
+    if (!status.ok()) {
+      connected_ = false;
+      return status;
+    }
+  }
+  return Status::OK();
+}
+
+Status RPCClient::CreateRemoteBlob(size_t const size,
+                                   std::unique_ptr<RemoteBlobWriter>& writer,
+                                   bool const compressed) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteCreateRemoteBufferRequest(size, "", true, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  ObjectID object_id = InvalidObjectID();
+  Payload object;
+  RETURN_ON_ERROR(ReadCreateBufferReply(message_in, object_id, object));
+  writer.reset(new RemoteBlobWriter(*this, object_id, size, compressed));
+  return Status::OK();
+}
+
+Status RPCClient::writeRemoteBufferChunk(ObjectID const id,
+                                         size_t const offset,
+                                         const uint8_t* data,
+                                         size_t const size,
+                                         bool const compressed) {
+  ENSURE_CONNECTED(this);
+  std::string compression;
+  if (compressed && size >= kCompressionThreshold) {
+    compression = NegotiateCompression(compressions_);
+  }
+  std::string message_out;
+  WriteRemoteBufferChunkRequest(id, offset, size, compression, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  Status status;
+  if (compression.empty()) {
+    status = send_bytes(vineyard_conn_, data, size);
+  } else {
+    std::string frame;
+    status =
+        sendCompressedBytes(vineyard_conn_, compression, data, size, frame);
+  }
+  if (!status.ok()) {
+    connected_ = false;
+    return status;
+  }
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  return ReadRemoteBufferChunkReply(message_in);
+}
+
+Status RPCClient::sealRemoteBuffer(ObjectID const id) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteSealRemoteBufferRequest(id, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  return ReadSealRemoteBufferReply(message_in);
+}
+
+Status RPCClient::dropRemoteBuffer(ObjectID const id) {
+  ENSURE_CONNECTED(this);
+  std::string message_out;
+  WriteDropBufferRequest(id, message_out);
+  RETURN_ON_ERROR(doWrite(message_out));
+  json message_in;
+  RETURN_ON_ERROR(doRead(message_in));
+  return ReadDropBufferReply(message_in);
+}
+
 }  // namespace vineyard
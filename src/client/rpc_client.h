@@ -18,8 +18,11 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "arrow/buffer.h"
+
 #include "client/client_base.h"
 #include "client/ds/i_object.h"
 #include "client/ds/object_meta.h"
@@ -29,6 +32,8 @@ limitations under the License.
 namespace vineyard {
 
 class BlobWriter;
+class Client;
+class RemoteBlobWriter;
 
 class RPCClient : public ClientBase {
  public:
@@ -95,7 +100,15 @@ class RPCClient : public ClientBase {
    */
   Status GetMetaData(const std::vector<ObjectID>& id,
                      std::vector<ObjectMeta>& meta_data,
-                     const bool sync_remote = false);
+                     const bool sync_remote = false) override;
+
+  /**
+   * @brief Obtain the metadata of an object, with its members (except blobs)
+   * left as placeholders that are resolved on demand, see also
+   * `ObjectMeta::GetMemberMeta()` and `ObjectMeta::ResolveMembers()`.
+   */
+  Status GetLazyMetaData(const ObjectID id, ObjectMeta& meta_data,
+                         const bool sync_remote = false);
 
   /**
    * @brief Get an object from vineyard. The ObjectFactory will be used to
@@ -225,8 +238,111 @@ class RPCClient : public ClientBase {
    */
   const InstanceID remote_instance_id() const { return remote_instance_id_; }
 
+  /**
+   * @brief Fetch the content of remote blobs from the connected vineyard
+   * server.
+   *
+   * When `parallelism` is larger than 1, a large transfer is split into
+   * byte ranges of roughly equal size, which may span many blobs or lie
+   * within a single big blob, and the ranges are fetched over such many
+   * connections concurrently and reassembled into the result buffers.
+   *
+   * @param ids The blob ids to fetch.
+   * @param buffers The result buffers, in the same order of `ids`.
+   * @param parallelism The max number of connections used for the transfer.
+   * @param compressed Whether to compress the content on the wire, it takes
+   * effect only when both the client and the server support a common codec,
+   * and the transfer is large enough.
+   *
+   * @return Status that indicates whether the fetch action has succeeded.
+   */
+  Status GetRemoteBuffers(const std::vector<ObjectID>& ids,
+                          std::vector<std::shared_ptr<arrow::Buffer>>& buffers,
+                          size_t const parallelism = 1,
+                          bool const compressed = false);
+
+  /**
+   * @brief Fetch the content of remote blobs through the remote blob cache of
+   * the local vineyard server that `local` connects to.
+   *
+   * Cached blobs are read from the local shared memory, and the others are
+   * fetched into local blobs which are then handed over to the cache. It
+   * behaves the same as the overload above when the local server doesn't
+   * enable the cache.
+   *
+   * @param local The IPC client of the local vineyard server.
+   * @param ids The blob ids to fetch.
+   * @param buffers The result buffers, in the same order of `ids`.
+   * @param parallelism The max number of connections used for the transfer.
+   * @param compressed Whether to compress the content on the wire.
+   *
+   * @return Status that indicates whether the fetch action has succeeded.
+   */
+  Status GetRemoteBuffers(Client& local, const std::vector<ObjectID>& ids,
+                          std::vector<std::shared_ptr<arrow::Buffer>>& buffers,
+                          size_t const parallelism = 1,
+                          bool const compressed = false);
+
+  /**
+   * @brief Allocate a blob of `size` bytes on the connected vineyard server,
+   * and returns a writer that streams the content into the remote blob in
+   * chunks.
+   *
+   * @param size The size of the remote blob.
+   * @param writer The writer of the remote blob.
+   * @param compressed Whether to compress the chunks on the wire, see also
+   * `GetRemoteBuffers`.
+   *
+   * @return Status that indicates whether the create action has succeeded.
+   */
+  Status CreateRemoteBlob(size_t const size,
+                          std::unique_ptr<RemoteBlobWriter>& writer,
+                          bool const compressed = false);
+
  private:
+  /**
+   * @brief Fetch the whole content of remote blobs into `buffers`, over at
+   * most `parallelism` connections. Null buffers are allocated.
+   */
+  Status fetchRemoteBuffersInParallel(
+      const std::vector<ObjectID>& ids, size_t const parallelism,
+      bool const compressed,
+      std::vector<std::shared_ptr<arrow::Buffer>>& buffers);
+
+  /**
+   * @brief Inspect the size of remote blobs without transferring the content.
+   */
+  Status probeRemoteBuffers(const std::vector<ObjectID>& ids,
+                            std::vector<size_t>& sizes);
+
+  /**
+   * @brief Receive the given ranges of blobs into `buffers` at the same
+   * offsets, null buffers are allocated using the size of blobs.
+   */
+  Status fetchRemoteBuffers(
+      const std::vector<ObjectID>& ids,
+      const std::vector<std::pair<size_t, size_t>>& ranges,
+      bool const compressed,
+      std::vector<std::shared_ptr<arrow::Buffer>>& buffers);
+
+  /**
+   * @brief Send the `size` bytes of content at `offset` of a streaming
+   * remote blob.
+   */
+  Status writeRemoteBufferChunk(ObjectID const id, size_t const offset,
+                                const uint8_t* data, size_t const size,
+                                bool const compressed);
+
+  Status sealRemoteBuffer(ObjectID const id);
+
+  Status dropRemoteBuffer(ObjectID const id);
+
   InstanceID remote_instance_id_;
+
+  // the compression codecs accepted by the server
+  std::vector<std::string> compressions_;
+
+  friend class RemoteBlobWriter;
 };
 
 }  // namespace vineyard
@@ -16,6 +16,7 @@ limitations under the License.
 #include <iostream>
 #include <sstream>
 #include <thread>
+#include <utility>
 
 #include "common/memory/arena.h"
 #include "common/memory/jemalloc.h"
@@ -33,13 +34,19 @@ namespace memory {
 
 std::unordered_map<unsigned, ArenaAllocator::arena_t> ArenaAllocator::arenas_;
 
+std::atomic<uint64_t> ArenaAllocator::next_instance_id_{0};
+
 ArenaAllocator::ArenaAllocator()
     : num_arenas_(std::thread::hardware_concurrency()),
-      empty_arenas_(num_arenas_, 0) {
+      empty_arenas_(num_arenas_, 0),
+      instance_id_(next_instance_id_.fetch_add(1)) {
   extent_hooks_ = static_cast<extent_hooks_t*>(malloc(sizeof(extent_hooks_t)));
 }
 
 ArenaAllocator::~ArenaAllocator() {
+  // cached extents must go back to the arenas before they are destroyed
+  destroyThreadCaches();
+
   if (extent_hooks_) {
     free(extent_hooks_);
   }
@@ -53,20 +60,11 @@ void* ArenaAllocator::Init(void* space, const size_t size) {
 }
 
 void* ArenaAllocator::Allocate(const size_t size, const size_t alignment) {
-  std::thread::id id = std::this_thread::get_id();
-  int arena_index = -1;
-  // Do not need lock here, as current thread is the only thread with thread id
-  // = id .find() would return a const iterator, which is thread safe
-  if (thread_arena_map_.find(id) == thread_arena_map_.end()) {
-    arena_index = requestArena();
-    if (arena_index == -1)
-      return nullptr;
-  } else {
-    arena_index = thread_arena_map_[id];
+  thread_cache_t* cache = threadCache(true);
+  if (cache == nullptr) {
+    return nullptr;
   }
-
-  // TODO: check flag
-  return vineyard_je_mallocx(std::max(size, alignment), 0);
+  return vineyard_je_mallocx(std::max(size, alignment), cache->alloc_flags);
 }
 
 int ArenaAllocator::LookUp(void* ptr) {
@@ -84,7 +82,11 @@ int ArenaAllocator::LookUp(void* ptr) {
 
 void ArenaAllocator::Free(void* ptr, size_t) {
   if (ptr) {
-    vineyard_je_dallocx(ptr, 0);
+    // the explicit tcache can only be used by its owner thread, blocks freed
+    // by other threads bypass the cache.
+    thread_cache_t* cache = threadCache(false);
+    vineyard_je_dallocx(ptr,
+                        cache ? cache->free_flags : MALLOCX_TCACHE_NONE);
   }
 }
 
@@ -120,6 +122,58 @@ unsigned ArenaAllocator::ThreadTotalDeallocatedBytes() {
   return deallocated;
 }
 
+ArenaAllocator::thread_cache_t* ArenaAllocator::threadCache(
+    const bool create) {
+  static thread_local std::unordered_map<uint64_t, thread_cache_t> caches;
+  auto iter = caches.find(instance_id_);
+  if (iter != caches.end()) {
+    return &iter->second;
+  }
+  if (!create) {
+    return nullptr;
+  }
+  thread_cache_t cache;
+  cache.arena_index = requestArena();
+  if (cache.arena_index == -1) {
+    return nullptr;
+  }
+  unsigned tcache = 0;
+  if (createThreadCache(tcache) == 0) {
+    cache.alloc_flags =
+        MALLOCX_ARENA(cache.arena_index) | MALLOCX_TCACHE(tcache);
+    cache.free_flags = MALLOCX_TCACHE(tcache);
+  } else {
+    cache.alloc_flags = MALLOCX_ARENA(cache.arena_index) | MALLOCX_TCACHE_NONE;
+  }
+  return &caches.emplace(instance_id_, cache).first->second;
+}
+
+int ArenaAllocator::createThreadCache(unsigned& tcache) {
+  size_t sz = sizeof(tcache);
+  if (auto ret = vineyard_je_mallctl("tcache.create", &tcache, &sz, NULL, 0)) {
+    int err = std::exchange(errno, ret);
+    std::clog << "Failed to create tcache" << std::endl;
+    errno = err;
+    return -1;
+  }
+  std::lock_guard<std::mutex> guard(tcaches_mutex_);
+  tcaches_.push_back(tcache);
+  return 0;
+}
+
+void ArenaAllocator::destroyThreadCaches() {
+  std::lock_guard<std::mutex> guard(tcaches_mutex_);
+  for (unsigned tcache : tcaches_) {
+    if (auto ret = vineyard_je_mallctl("tcache.destroy", NULL, NULL, &tcache,
+                                       sizeof(tcache))) {
+      int err = std::exchange(errno, ret);
+      std::clog << "Failed to destroy tcache " << tcache << std::endl;
+      errno = err;
+    }
+  }
+  tcaches_.clear();
+}
+
 int ArenaAllocator::requestArena() {
   std::thread::id id = std::this_thread::get_id();
 
@@ -284,6 +338,18 @@ void* ArenaAllocator::theAllocHook(extent_hooks_t* extent_hooks, void* new_addr,
                                    bool* commit, unsigned int arena_index) {
   // align
   arena_t& arena = arenas_[arena_index];
+  if (new_addr != nullptr) {
+    // jemalloc asks for the extent right after an existing one to grow a
+    // (large) allocation in place, which can only be satisfied when it is the
+    // tail of what has been handed out so far.
+    uintptr_t target = reinterpret_cast<uintptr_t>(new_addr);
+    if (target != arena.pre_alloc_ || target + size > arena.base_end_pointer_) {
+      return nullptr;
+    }
+    arena.pre_alloc_ = target + size;
+    *commit = false;
+    return new_addr;
+  }
   uintptr_t ret = (arena.pre_alloc_ + alignment - 1) & ~(alignment - 1);
   if (ret + size > arena.base_end_pointer_) {
     return nullptr;
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <sys/mman.h>
 
+#include <atomic>
 #include <deque>
 #include <fstream>
 #include <iostream>
@@ -70,6 +71,23 @@ class ArenaAllocator {
   };
 
  private:
+  /**
+   * @brief The arena and the explicit jemalloc tcache that the calling thread
+   * uses with this allocator, so that `Allocate` and `Free` don't touch any
+   * shared state after the first allocation of a thread.
+   */
+  struct thread_cache_t {
+    int arena_index = -1;
+    int alloc_flags = 0;
+    int free_flags = MALLOCX_TCACHE_NONE;
+  };
+
+  thread_cache_t* threadCache(const bool create);
+
+  int createThreadCache(unsigned& tcache);
+
+  void destroyThreadCaches();
+
   int doCreateArena();
 
   int requestArena();
@@ -102,6 +120,13 @@ class ArenaAllocator {
   std::unordered_map<std::thread::id, int> thread_arena_map_;
   extent_hooks_t* extent_hooks_ = nullptr;
   static std::unordered_map<unsigned, arena_t> arenas_;
+
+  // distinguishes the thread-local caches of different allocators
+  const uint64_t instance_id_;
+  static std::atomic<uint64_t> next_instance_id_;
+  // explicit tcaches created by threads, destroyed with the allocator
+  std::mutex tcaches_mutex_;
+  std::vector<unsigned> tcaches_;
 };
 
 }  // namespace memory
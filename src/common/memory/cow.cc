@@ -0,0 +1,79 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "common/memory/cow.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <string>
+#include <vector>
+
+namespace vineyard {
+
+namespace memory {
+
+size_t PageExtentsSize(std::vector<PageExtent> const& extents) {
+  size_t size = 0;
+  for (auto const& extent : extents) {
+    size += extent.size;
+  }
+  return size;
+}
+
+Status MapPageExtents(std::vector<PageExtent> const& extents,
+                      std::function<int(int)> const& resolve,
+                      bool const readonly, uint8_t** window) {
+  size_t window_size = PageExtentsSize(extents);
+  if (window_size == 0) {
+    return Status::Invalid("The copy-on-write blob has no pages");
+  }
+  // reserve the address space first, then place the extents into it
+  void* base = mmap(nullptr, window_size, PROT_NONE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (base == MAP_FAILED) {
+    return Status::IOError("Failed to reserve the copy-on-write window: " +
+                           std::string(strerror(errno)));
+  }
+  uint8_t* cursor = static_cast<uint8_t*>(base);
+  for (auto const& extent : extents) {
+    int fd = resolve(extent.fd);
+    int prot = extent.writable && !readonly ? PROT_READ | PROT_WRITE
+                                            : PROT_READ;
+    if (fd < 0 ||
+        mmap(cursor, extent.size, prot, MAP_SHARED | MAP_FIXED, fd,
+             extent.offset) == MAP_FAILED) {
+      int error = fd < 0 ? EBADF : errno;
+      munmap(base, window_size);
+      return Status::IOError("Failed to map the copy-on-write extent: " +
+                             std::string(strerror(error)));
+    }
+    cursor += extent.size;
+  }
+  *window = static_cast<uint8_t*>(base);
+  return Status::OK();
+}
+
+void UnmapPageExtents(std::vector<PageExtent> const& extents,
+                      uint8_t* window) {
+  if (window != nullptr) {
+    munmap(window, PageExtentsSize(extents));
+  }
+}
+
+}  // namespace memory
+
+}  // namespace vineyard
@@ -0,0 +1,53 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_COMMON_MEMORY_COW_H_
+#define SRC_COMMON_MEMORY_COW_H_
+
+#include <functional>
+#include <vector>
+
+#include "common/memory/payload.h"
+#include "common/util/status.h"
+
+namespace vineyard {
+
+namespace memory {
+
+/**
+ * @brief The total size of the window that the extents are mapped to.
+ */
+size_t PageExtentsSize(std::vector<PageExtent> const& extents);
+
+/**
+ * @brief Map the extents of a copy-on-write blob, in order, to a contiguous
+ * window of the address space. The extents that are shared with the parent
+ * blob are always mapped as readonly, thus writes to the unchanged pages
+ * fault rather than modifying the parent.
+ *
+ * The `resolve` function translates the (server-side) fd of an extent to the
+ * fd of the current process.
+ */
+Status MapPageExtents(std::vector<PageExtent> const& extents,
+                      std::function<int(int)> const& resolve,
+                      bool const readonly, uint8_t** window);
+
+void UnmapPageExtents(std::vector<PageExtent> const& extents, uint8_t* window);
+
+}  // namespace memory
+
+}  // namespace vineyard
+
+#endif  // SRC_COMMON_MEMORY_COW_H_
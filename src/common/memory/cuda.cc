@@ -0,0 +1,140 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "common/memory/cuda.h"
+
+#if defined(WITH_CUDA)
+#include <cuda_runtime_api.h>
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace vineyard {
+
+namespace memory {
+
+#if defined(WITH_CUDA)
+
+namespace {
+
+Status cuda_status(cudaError_t const error, const char* what) {
+  if (error == cudaSuccess) {
+    return Status::OK();
+  }
+  // clears the sticky error of the calling thread
+  cudaGetLastError();
+  return Status::IOError(std::string(what) + ": " + cudaGetErrorString(error));
+}
+
+}  // namespace
+
+bool cuda_enabled() { return true; }
+
+Status cuda_malloc(int const device, size_t const size, uint8_t** pointer) {
+  RETURN_ON_ERROR(cuda_status(cudaSetDevice(device), "cudaSetDevice"));
+  void* memory = nullptr;
+  cudaError_t error = cudaMalloc(&memory, size);
+  if (error == cudaErrorMemoryAllocation) {
+    cudaGetLastError();
+    return Status::NotEnoughMemory("device " + std::to_string(device) +
+                                   ", size = " + std::to_string(size));
+  }
+  RETURN_ON_ERROR(cuda_status(error, "cudaMalloc"));
+  *pointer = static_cast<uint8_t*>(memory);
+  return Status::OK();
+}
+
+Status cuda_free(int const device, uint8_t* pointer) {
+  RETURN_ON_ERROR(cuda_status(cudaSetDevice(device), "cudaSetDevice"));
+  return cuda_status(cudaFree(pointer), "cudaFree");
+}
+
+Status cuda_ipc_get_handle(int const device, uint8_t* pointer,
+                           std::string& handle) {
+  RETURN_ON_ERROR(cuda_status(cudaSetDevice(device), "cudaSetDevice"));
+  cudaIpcMemHandle_t ipc_handle;
+  RETURN_ON_ERROR(cuda_status(cudaIpcGetMemHandle(&ipc_handle, pointer),
+                              "cudaIpcGetMemHandle"));
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&ipc_handle);
+  handle.resize(sizeof(ipc_handle) * 2);
+  for (size_t index = 0; index < sizeof(ipc_handle); ++index) {
+    snprintf(&handle[index * 2], 3, "%02x", bytes[index]);
+  }
+  return Status::OK();
+}
+
+Status cuda_ipc_open_handle(int const device, std::string const& handle,
+                            uint8_t** pointer) {
+  cudaIpcMemHandle_t ipc_handle;
+  if (handle.size() != sizeof(ipc_handle) * 2) {
+    return Status::Invalid("Invalid CUDA IPC handle: '" + handle + "'");
+  }
+  uint8_t* bytes = reinterpret_cast<uint8_t*>(&ipc_handle);
+  for (size_t index = 0; index < sizeof(ipc_handle); ++index) {
+    bytes[index] = static_cast<uint8_t>(
+        std::stoul(handle.substr(index * 2, 2), nullptr, 16));
+  }
+  RETURN_ON_ERROR(cuda_status(cudaSetDevice(device), "cudaSetDevice"));
+  void* memory = nullptr;
+  RETURN_ON_ERROR(cuda_status(
+      cudaIpcOpenMemHandle(&memory, ipc_handle, cudaIpcMemLazyEnablePeerAccess),
+      "cudaIpcOpenMemHandle"));
+  *pointer = static_cast<uint8_t*>(memory);
+  return Status::OK();
+}
+
+Status cuda_ipc_close_handle(int const device, uint8_t* pointer) {
+  RETURN_ON_ERROR(cuda_status(cudaSetDevice(device), "cudaSetDevice"));
+  return cuda_status(cudaIpcCloseMemHandle(pointer), "cudaIpcCloseMemHandle");
+}
+
+#else
+
+namespace {
+
+Status cuda_not_enabled() {
+  return Status::NotImplemented(
+      "Device-memory blobs require vineyard built with USE_CUDA");
+}
+
+}  // namespace
+
+bool cuda_enabled() { return false; }
+
+Status cuda_malloc(int const, size_t const, uint8_t**) {
+  return cuda_not_enabled();
+}
+
+Status cuda_free(int const, uint8_t*) { return cuda_not_enabled(); }
+
+Status cuda_ipc_get_handle(int const, uint8_t*, std::string&) {
+  return cuda_not_enabled();
+}
+
+Status cuda_ipc_open_handle(int const, std::string const&, uint8_t**) {
+  return cuda_not_enabled();
+}
+
+Status cuda_ipc_close_handle(int const, uint8_t*) {
+  return cuda_not_enabled();
+}
+
+#endif  // WITH_CUDA
+
+}  // namespace memory
+
+}  // namespace vineyard
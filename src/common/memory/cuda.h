@@ -0,0 +1,64 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_COMMON_MEMORY_CUDA_H_
+#define SRC_COMMON_MEMORY_CUDA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+namespace memory {
+
+/**
+ * @brief Whether vineyard is built with the CUDA device-memory blobs, i.e.,
+ * with the cmake option `USE_CUDA`. The following functions fail with
+ * `NotImplemented` otherwise.
+ */
+bool cuda_enabled();
+
+/**
+ * @brief Allocate `size` bytes of device memory on the given device.
+ */
+Status cuda_malloc(int const device, size_t const size, uint8_t** pointer);
+
+Status cuda_free(int const device, uint8_t* pointer);
+
+/**
+ * @brief Export the device memory allocated by `cuda_malloc` as an IPC
+ * handle, which is passed to the clients in the payload (in hex), as the fds
+ * of the shared memory are passed by `send_fd`.
+ */
+Status cuda_ipc_get_handle(int const device, uint8_t* pointer,
+                           std::string& handle);
+
+/**
+ * @brief Map the device memory of the IPC handle into the current process,
+ * the handle can't be opened by the process that exports it.
+ */
+Status cuda_ipc_open_handle(int const device, std::string const& handle,
+                            uint8_t** pointer);
+
+Status cuda_ipc_close_handle(int const device, uint8_t* pointer);
+
+}  // namespace memory
+
+}  // namespace vineyard
+
+#endif  // SRC_COMMON_MEMORY_CUDA_H_
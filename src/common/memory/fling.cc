@@ -152,3 +152,107 @@ int recv_fd(int conn) {
 
   return found_fd;
 }
+
+// The kernel rejects messages that carry more than SCM_MAX_FD (253 on Linux)
+// descriptors, chunk conservatively.
+static const int kMaxFdsPerMessage = 128;
+
+int send_fds(int conn, const int* fds, int num) {
+  struct msghdr msg;
+  struct iovec iov;
+  char buf[CMSG_SPACE(sizeof(int) * kMaxFdsPerMessage)];
+
+  for (int offset = 0; offset < num; offset += kMaxFdsPerMessage) {
+    int count = num - offset < kMaxFdsPerMessage ? num - offset
+                                                 : kMaxFdsPerMessage;
+    size_t buf_len = CMSG_SPACE(sizeof(int) * count);
+    memset(&buf, 0, buf_len);
+    init_msg(&msg, &iov, buf, buf_len);
+
+    struct cmsghdr* header = CMSG_FIRSTHDR(&msg);
+    if (header == nullptr) {
+      std::clog << "[error] Error in init_msg: header is NULL" << std::endl;
+      return -1;
+    }
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(int) * count);
+    memcpy(CMSG_DATA(header), reinterpret_cast<const void*>(fds + offset),
+           sizeof(int) * count);
+
+    while (true) {
+      ssize_t r = sendmsg(conn, &msg, 0);
+      if (r < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ||
+            errno == EMSGSIZE) {
+          continue;
+        }
+        std::clog << "[error] Error in send_fds (errno = " << errno << ": "
+                  << strerror(errno) << ")" << std::endl;
+        return static_cast<int>(r);
+      } else if (r == 0) {
+        std::clog << "[error] Encountered unexpected EOF" << std::endl;
+        return -1;
+      }
+      break;
+    }
+  }
+  return num;
+}
+
+int recv_fds(int conn, int* fds, int num) {
+  struct msghdr msg;
+  struct iovec iov;
+  char buf[CMSG_SPACE(sizeof(int) * kMaxFdsPerMessage)];
+
+  int received = 0;
+  while (received < num) {
+    init_msg(&msg, &iov, buf, sizeof(buf));
+    ssize_t r = recvmsg(conn, &msg, 0);
+    if (r == -1) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+        continue;
+      }
+      std::clog << "[error] Error in recv_fds (errno = " << errno << ")"
+                << std::endl;
+      break;
+    } else if (r == 0) {
+      std::clog << "[error] Encountered unexpected EOF" << std::endl;
+      break;
+    }
+    int found = 0;
+    for (struct cmsghdr* header = CMSG_FIRSTHDR(&msg); header != NULL;
+         header = CMSG_NXTHDR(&msg, header)) {
+      if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS) {
+        ssize_t count =
+            (header->cmsg_len -
+             (CMSG_DATA(header) - reinterpret_cast<unsigned char*>(header))) /
+            sizeof(int);
+        for (int i = 0; i < count; ++i) {
+          int fd = (reinterpret_cast<int*>(CMSG_DATA(header)))[i];
+          if (received < num) {
+            fds[received++] = fd;
+          } else {
+            close(fd);
+          }
+          found += 1;
+        }
+      }
+    }
+    if (found == 0) {
+      std::clog << "[error] Error in recv_fds: no fd received in message"
+                << std::endl;
+      break;
+    }
+  }
+
+  if (received < num) {
+    // don't leak the partially received batch
+    for (int i = 0; i < received; ++i) {
+      close(fds[i]);
+    }
+    errno = EBADMSG;
+    return -1;
+  }
+  return received;
+}
@@ -65,6 +65,23 @@ int send_fd(int conn, int fd);
 // @return File descriptor or a value < 0 on failure.
 int recv_fd(int conn);
 
+// Send a batch of file descriptors over a unix domain socket, packing as many
+// of them as the kernel allows (SCM_MAX_FD) into each message.
+//
+// @param conn Unix domain socket to send the file descriptors over.
+// @param fds File descriptors to send over.
+// @param num Number of file descriptors in `fds`.
+// @return Status code which is < 0 on failure.
+int send_fds(int conn, const int* fds, int num);
+
+// Receive a batch of file descriptors sent by `send_fds`.
+//
+// @param conn Unix domain socket to receive the file descriptors from.
+// @param fds Buffer for the received file descriptors, of at least `num`.
+// @param num Number of file descriptors to receive.
+// @return Status code which is < 0 on failure.
+int recv_fds(int conn, int* fds, int num);
+
 #ifdef __cplusplus
 }
 #endif
@@ -114,6 +114,14 @@ void* Jemalloc::Allocate(const size_t bytes, const size_t alignment) {
 }
 
 void* Jemalloc::Reallocate(void* pointer, size_t size) {
+  if (pointer == nullptr) {
+    return Allocate(size);
+  }
+  // try to resize in place first, which avoids copying the content when the
+  // following space in the arena is free, see also `theAllocHook`.
+  if (vineyard_je_xallocx(pointer, size, 0, flags_) >= size) {
+    return pointer;
+  }
   return vineyard_je_rallocx(pointer, size, flags_);
 }
 
@@ -158,6 +166,18 @@ void* Jemalloc::theAllocHook(extent_hooks_t* extent_hooks, void* new_addr,
                              bool* commit, unsigned arena_index) {
   // align
   arena_t& arena = arenas_[arena_index];
+  if (new_addr != nullptr) {
+    // jemalloc asks for the extent right after an existing one to grow a
+    // (large) allocation in place, which can only be satisfied when it is the
+    // tail of what has been handed out so far.
+    uintptr_t target = reinterpret_cast<uintptr_t>(new_addr);
+    if (target != arena.pre_alloc_ || target + size > arena.base_end_pointer_) {
+      return nullptr;
+    }
+    arena.pre_alloc_ = target + size;
+    *commit = false;
+    return new_addr;
+  }
   uintptr_t ret = (arena.pre_alloc_ + alignment - 1) & ~(alignment - 1);
   if (ret + size > arena.base_end_pointer_) {
     return nullptr;
@@ -0,0 +1,103 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "common/memory/memcpy.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace vineyard {
+
+namespace memory {
+
+namespace {
+
+// more threads hardly help once the memory bandwidth is saturated
+constexpr size_t kMaxMemcpyThreads = 8;
+// each thread copies at least that many bytes
+constexpr size_t kMinMemcpyChunk = 4 * 1024 * 1024;
+
+void streaming_memcpy(uint8_t* dst, const uint8_t* src, size_t size) {
+#if defined(__SSE2__)
+  // align the destination to the cache line for the non-temporal stores
+  size_t head = (64 - reinterpret_cast<uintptr_t>(dst) % 64) % 64;
+  head = std::min(head, size);
+  memcpy(dst, src, head);
+  dst += head;
+  src += head;
+  size -= head;
+
+  size_t const body = size / 64 * 64;
+  for (size_t offset = 0; offset < body; offset += 64) {
+    const __m128i* from = reinterpret_cast<const __m128i*>(src + offset);
+    __m128i* to = reinterpret_cast<__m128i*>(dst + offset);
+    __m128i a = _mm_loadu_si128(from + 0);
+    __m128i b = _mm_loadu_si128(from + 1);
+    __m128i c = _mm_loadu_si128(from + 2);
+    __m128i d = _mm_loadu_si128(from + 3);
+    _mm_stream_si128(to + 0, a);
+    _mm_stream_si128(to + 1, b);
+    _mm_stream_si128(to + 2, c);
+    _mm_stream_si128(to + 3, d);
+  }
+  memcpy(dst + body, src + body, size - body);
+  // the non-temporal stores are weakly ordered
+  _mm_sfence();
+#else
+  memcpy(dst, src, size);
+#endif
+}
+
+}  // namespace
+
+void concurrent_memcpy(void* dst, const void* src, size_t const size,
+                       size_t concurrency) {
+  if (size < kConcurrentMemcpyThreshold) {
+    memcpy(dst, src, size);
+    return;
+  }
+  if (concurrency == 0) {
+    concurrency = std::min<size_t>(std::thread::hardware_concurrency(),
+                                   kMaxMemcpyThreads);
+  }
+  concurrency =
+      std::max<size_t>(1, std::min(concurrency, size / kMinMemcpyChunk));
+
+  uint8_t* to = static_cast<uint8_t*>(dst);
+  const uint8_t* from = static_cast<const uint8_t*>(src);
+  // the chunks are aligned to the cache line, except the last one
+  size_t chunk = ((size + concurrency - 1) / concurrency + 63) / 64 * 64;
+  std::vector<std::thread> workers;
+  for (size_t offset = chunk; offset < size; offset += chunk) {
+    workers.emplace_back(streaming_memcpy, to + offset, from + offset,
+                         std::min(chunk, size - offset));
+  }
+  // the calling thread copies the first chunk
+  streaming_memcpy(to, from, std::min(chunk, size));
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+}  // namespace memory
+
+}  // namespace vineyard
@@ -0,0 +1,46 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_COMMON_MEMORY_MEMCPY_H_
+#define SRC_COMMON_MEMORY_MEMCPY_H_
+
+#include <cstddef>
+
+namespace vineyard {
+
+namespace memory {
+
+// the copies smaller than that are done by a single `memcpy`
+constexpr size_t kConcurrentMemcpyThreshold = 32 * 1024 * 1024;
+
+/**
+ * @brief Copy `size` bytes from `src` to `dst`, the regions must not overlap.
+ *
+ * The large copies are split into chunks that are copied by `concurrency`
+ * threads (the hardware concurrency, at most 8, by default), with
+ * non-temporal stores on x86, as the destination, usually the shared memory
+ * of a blob, won't be read by the writer again and would only evict the
+ * working set from the cache.
+ *
+ * The caller is expected to release the GIL before copying from python.
+ */
+void concurrent_memcpy(void* dst, const void* src, size_t const size,
+                       size_t concurrency = 0);
+
+}  // namespace memory
+
+}  // namespace vineyard
+
+#endif  // SRC_COMMON_MEMORY_MEMCPY_H_
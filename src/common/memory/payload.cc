@@ -17,6 +17,22 @@ limitations under the License.
 
 namespace vineyard {
 
+json PageExtent::ToJSON() const {
+  return json{{"fd", fd},
+              {"map_size", map_size},
+              {"offset", offset},
+              {"size", size},
+              {"writable", writable}};
+}
+
+void PageExtent::FromJSON(const json& tree) {
+  fd = tree["fd"].get<int>();
+  map_size = tree["map_size"].get<int64_t>();
+  offset = tree["offset"].get<ptrdiff_t>();
+  size = tree["size"].get<int64_t>();
+  writable = tree["writable"].get<bool>();
+}
+
 json Payload::ToJSON() const {
   json payload;
   this->ToJSON(payload);
@@ -29,6 +45,17 @@ void Payload::ToJSON(json& tree) const {
   tree["data_offset"] = data_offset;
   tree["data_size"] = data_size;
   tree["map_size"] = map_size;
+  if (!extents.empty()) {
+    json items = json::array();
+    for (auto const& extent : extents) {
+      items.push_back(extent.ToJSON());
+    }
+    tree["extents"] = items;
+  }
+  if (device >= 0) {
+    tree["device"] = device;
+    tree["ipc_handle"] = ipc_handle;
+  }
 }
 
 void Payload::FromJSON(const json& tree) {
@@ -38,6 +65,16 @@ void Payload::FromJSON(const json& tree) {
   data_size = tree["data_size"].get<int64_t>();
   map_size = tree["map_size"].get<int64_t>();
   pointer = nullptr;
+  extents.clear();
+  if (tree.contains("extents")) {
+    for (auto const& item : tree["extents"]) {
+      PageExtent extent;
+      extent.FromJSON(item);
+      extents.emplace_back(extent);
+    }
+  }
+  device = tree.value("device", -1);
+  ipc_handle = tree.value("ipc_handle", std::string());
 }
 
 Payload Payload::FromJSON1(const json& tree) {
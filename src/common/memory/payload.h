@@ -17,12 +17,34 @@ limitations under the License.
 #define SRC_COMMON_MEMORY_PAYLOAD_H_
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "common/util/json.h"
 #include "common/util/uuid.h"
 
 namespace vineyard {
 
+/**
+ * @brief A page-aligned range of a shared memory segment, the pages of a
+ * copy-on-write blob are made up of a sequence of extents, see also
+ * `BulkStore::CreateCopyOnWrite()`.
+ */
+struct PageExtent {
+  int fd;
+  int64_t map_size;
+  // the page-aligned offset of the range in the segment
+  ptrdiff_t offset;
+  int64_t size;
+  // the pages that are owned by the blob itself, rather than shared with the
+  // parent blob
+  bool writable;
+
+  json ToJSON() const;
+
+  void FromJSON(const json& tree);
+};
+
 struct Payload {
   ObjectID object_id;
   int store_fd;
@@ -31,6 +53,39 @@ struct Payload {
   int64_t data_size;
   int64_t map_size;
   uint8_t* pointer;
+  // non-empty for copy-on-write blobs, whose pages are mapped from these
+  // extents, in order, to a contiguous window, and the data starts at
+  // `data_offset` of the window.
+  std::vector<PageExtent> extents;
+  // non-negative for the blobs in the device memory of that CUDA device,
+  // whose memory is shared by the CUDA IPC handle rather than the fds.
+  int device;
+  std::string ipc_handle;
+
+  // The following fields are only meaningful inside vineyardd.
+  bool is_spilled;
+  // whether the blob has been migrated to the far memory tier, and the
+  // accesses since then, see also `BulkStore::EnableFarTier()`
+  bool is_far;
+  size_t far_hits;
+  int64_t ref_cnt;
+  // the client process that creates the blob
+  std::shared_ptr<const std::string> owner;
+  // the session whose memory quota the blob is charged to, if any
+  std::shared_ptr<const std::string> session;
+  // the blob whose pages are shared by this blob, i.e., the parent of a
+  // copy-on-write blob, or the identical blob of a deduplicated one, and the
+  // pages that are allocated for the modified pages of a copy-on-write blob
+  std::shared_ptr<Payload> cow_parent;
+  uint8_t* cow_pages;
+  int64_t cow_pages_size;
+  // the number of blobs that share the pages of this blob, the pages outlive
+  // a deletion until the last of them has gone
+  int64_t cow_children;
+  bool cow_deleted;
+  // the content hash of a sealed blob, when it is indexed for deduplication
+  uint64_t content_hash;
+  bool content_indexed;
 
   Payload()
       : object_id(EmptyBlobID()),
@@ -39,7 +94,18 @@ struct Payload {
         data_offset(0),
         data_size(0),
         map_size(0),
-        pointer(nullptr) {}
+        pointer(nullptr),
+        device(-1),
+        is_spilled(false),
+        is_far(false),
+        far_hits(0),
+        ref_cnt(0),
+        cow_pages(nullptr),
+        cow_pages_size(0),
+        cow_children(0),
+        cow_deleted(false),
+        content_hash(0),
+        content_indexed(false) {}
 
   Payload(ObjectID object_id, int64_t size, uint8_t* ptr, int fd, int64_t msize,
           ptrdiff_t offset)
@@ -49,7 +115,18 @@ struct Payload {
         data_offset(offset),
         data_size(size),
         map_size(msize),
-        pointer(ptr) {}
+        pointer(ptr),
+        device(-1),
+        is_spilled(false),
+        is_far(false),
+        far_hits(0),
+        ref_cnt(0),
+        cow_pages(nullptr),
+        cow_pages_size(0),
+        cow_children(0),
+        cow_deleted(false),
+        content_hash(0),
+        content_indexed(false) {}
 
   Payload(ObjectID object_id, int64_t size, uint8_t* ptr, int fd, int arena_fd,
           int64_t msize, ptrdiff_t offset)
@@ -59,7 +136,18 @@ struct Payload {
         data_offset(offset),
         data_size(size),
         map_size(msize),
-        pointer(ptr) {}
+        pointer(ptr),
+        device(-1),
+        is_spilled(false),
+        is_far(false),
+        far_hits(0),
+        ref_cnt(0),
+        cow_pages(nullptr),
+        cow_pages_size(0),
+        cow_children(0),
+        cow_deleted(false),
+        content_hash(0),
+        content_indexed(false) {}
 
   static std::shared_ptr<Payload> MakeEmpty() {
     static std::shared_ptr<Payload> payload = std::make_shared<Payload>();
@@ -72,6 +160,18 @@ struct Payload {
             (data_size == other.data_size));
   }
 
+  bool IsCopyOnWrite() const { return !extents.empty(); }
+
+  bool IsDevice() const { return device >= 0; }
+
+  /**
+   * @brief Whether the pages are shared with other blobs, such blobs won't be
+   * evicted, spilled or relocated. Only meaningful inside vineyardd.
+   */
+  bool IsPageShared() const {
+    return cow_parent != nullptr || cow_children > 0;
+  }
+
   json ToJSON() const;
 
   void ToJSON(json& tree) const;
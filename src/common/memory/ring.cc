@@ -0,0 +1,189 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "common/memory/ring.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace vineyard {
+
+namespace memory {
+
+static inline size_t align_up(size_t const size, size_t const alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+MessageRing::MessageRing(void* region, size_t const capacity,
+                         bool const initialize)
+    : header_(reinterpret_cast<Header*>(region)),
+      data_(reinterpret_cast<char*>(region) + sizeof(Header)),
+      capacity_(capacity) {
+  if (initialize) {
+    new (header_) Header();
+    header_->head.store(0);
+    header_->tail.store(0);
+    header_->waiting.store(0);
+    header_->capacity = capacity;
+  }
+}
+
+size_t MessageRing::RegionSize(size_t const capacity) {
+  return align_up(sizeof(Header) + capacity, 64);
+}
+
+bool MessageRing::TryPush(const std::string& message) {
+  uint64_t head = header_->head.load(std::memory_order_acquire);
+  uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+  uint64_t length = message.size();
+  if (sizeof(uint64_t) + length > capacity_ - (tail - head)) {
+    return false;
+  }
+  copyIn(tail, &length, sizeof(uint64_t));
+  copyIn(tail + sizeof(uint64_t), message.data(), length);
+  header_->tail.store(tail + sizeof(uint64_t) + length,
+                      std::memory_order_release);
+  return true;
+}
+
+bool MessageRing::TryPop(std::string& message) {
+  uint64_t tail = header_->tail.load(std::memory_order_acquire);
+  uint64_t head = header_->head.load(std::memory_order_relaxed);
+  if (head == tail) {
+    return false;
+  }
+  uint64_t length = 0;
+  copyOut(head, &length, sizeof(uint64_t));
+  message.resize(length);
+  copyOut(head + sizeof(uint64_t), &message[0], length);
+  header_->head.store(head + sizeof(uint64_t) + length,
+                      std::memory_order_release);
+  return true;
+}
+
+bool MessageRing::Empty() const {
+  return header_->head.load(std::memory_order_acquire) ==
+         header_->tail.load(std::memory_order_acquire);
+}
+
+void MessageRing::SetWaiting() {
+  header_->waiting.store(1, std::memory_order_seq_cst);
+  // the following check of the ring mustn't be reordered before the flag
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+bool MessageRing::TakeWaiting() {
+  // the message pushed before must be visible before taking the flag
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  return header_->waiting.exchange(0, std::memory_order_seq_cst) != 0;
+}
+
+void MessageRing::copyIn(uint64_t position, const void* data, size_t size) {
+  size_t offset = position % capacity_;
+  size_t first = std::min(size, capacity_ - offset);
+  memcpy(data_ + offset, data, first);
+  if (first < size) {
+    memcpy(data_, reinterpret_cast<const char*>(data) + first, size - first);
+  }
+}
+
+void MessageRing::copyOut(uint64_t position, void* data, size_t size) const {
+  size_t offset = position % capacity_;
+  size_t first = std::min(size, capacity_ - offset);
+  memcpy(data, data_ + offset, first);
+  if (first < size) {
+    memcpy(reinterpret_cast<char*>(data) + first, data_, size - first);
+  }
+}
+
+RequestRing::RequestRing(void* region, size_t const capacity,
+                         bool const initialize)
+    : region_(region),
+      size_(RegionSize(capacity)),
+      requests_(region, capacity, initialize),
+      replies_(reinterpret_cast<char*>(region) +
+                   MessageRing::RegionSize(capacity),
+               capacity, initialize) {}
+
+RequestRing::~RequestRing() {
+  if (region_ != nullptr) {
+    munmap(region_, size_);
+  }
+}
+
+size_t RequestRing::RegionSize(size_t const capacity) {
+  return MessageRing::RegionSize(capacity) * 2;
+}
+
+Status RequestRing::Create(size_t const capacity, int& fd,
+                           std::shared_ptr<RequestRing>& ring) {
+  // directory where to create the memory-backed file
+#ifdef __linux__
+  std::string file_template = "/dev/shm/vineyard-ring-XXXXXX";
+#else
+  std::string file_template = "/tmp/vineyard-ring-XXXXXX";
+#endif
+  std::vector<char> file_name(file_template.begin(), file_template.end());
+  file_name.push_back('\0');
+  fd = mkstemp(&file_name[0]);
+  if (fd < 0) {
+    return Status::IOError("Failed to create the request ring: " +
+                           std::string(strerror(errno)));
+  }
+  // Immediately unlink the file so we do not leave traces in the system.
+  unlink(&file_name[0]);
+  size_t size = RegionSize(capacity);
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    close(fd);
+    fd = -1;
+    return Status::IOError("Failed to resize the request ring: " +
+                           std::string(strerror(errno)));
+  }
+  void* region =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (region == MAP_FAILED) {
+    close(fd);
+    fd = -1;
+    return Status::IOError("Failed to map the request ring: " +
+                           std::string(strerror(errno)));
+  }
+  ring.reset(new RequestRing(region, capacity, true));
+  return Status::OK();
+}
+
+Status RequestRing::Open(int const fd, size_t const capacity,
+                         std::shared_ptr<RequestRing>& ring) {
+  size_t size = RegionSize(capacity);
+  void* region =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (region == MAP_FAILED) {
+    return Status::IOError("Failed to map the request ring: " +
+                           std::string(strerror(errno)));
+  }
+  ring.reset(new RequestRing(region, capacity, false));
+  return Status::OK();
+}
+
+}  // namespace memory
+
+}  // namespace vineyard
@@ -0,0 +1,123 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_COMMON_MEMORY_RING_H_
+#define SRC_COMMON_MEMORY_RING_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+namespace memory {
+
+/**
+ * @brief A lock-free single-producer single-consumer ring of length-prefixed
+ * messages, which lives in shared memory and is used by a client and the
+ * server that are co-located.
+ *
+ * When the consumer is about to sleep rather than polling the ring, it sets
+ * the `waiting` flag, and the producer that takes the flag away (by
+ * `TakeWaiting()`) must wake it up through the socket.
+ */
+class MessageRing {
+ public:
+  struct Header {
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) std::atomic<uint32_t> waiting;
+    uint64_t capacity;
+  };
+
+  MessageRing() = default;
+
+  MessageRing(void* region, size_t const capacity, bool const initialize);
+
+  static size_t RegionSize(size_t const capacity);
+
+  /**
+   * @brief Returns false when there's no enough space for the message.
+   */
+  bool TryPush(const std::string& message);
+
+  bool TryPop(std::string& message);
+
+  bool Empty() const;
+
+  size_t Capacity() const { return capacity_; }
+
+  /**
+   * @brief Announce that the consumer will wait for a doorbell.
+   */
+  void SetWaiting();
+
+  /**
+   * @brief Take the waiting flag, returns true if the consumer was waiting
+   * and thus needs a doorbell.
+   */
+  bool TakeWaiting();
+
+ private:
+  void copyIn(uint64_t position, const void* data, size_t size);
+
+  void copyOut(uint64_t position, void* data, size_t size) const;
+
+  Header* header_ = nullptr;
+  char* data_ = nullptr;
+  size_t capacity_ = 0;
+};
+
+/**
+ * @brief A pair of rings for submitting requests and polling the replies, in
+ * a shared memory region that is passed from the server to the client.
+ */
+class RequestRing {
+ public:
+  ~RequestRing();
+
+  /**
+   * @brief Create the shared memory region, used by the server.
+   */
+  static Status Create(size_t const capacity, int& fd,
+                       std::shared_ptr<RequestRing>& ring);
+
+  /**
+   * @brief Map the shared memory region from the server, used by the client.
+   */
+  static Status Open(int const fd, size_t const capacity,
+                     std::shared_ptr<RequestRing>& ring);
+
+  static size_t RegionSize(size_t const capacity);
+
+  MessageRing& requests() { return requests_; }
+
+  MessageRing& replies() { return replies_; }
+
+ private:
+  RequestRing(void* region, size_t const capacity, bool const initialize);
+
+  void* region_ = nullptr;
+  size_t size_ = 0;
+  MessageRing requests_, replies_;
+};
+
+}  // namespace memory
+
+}  // namespace vineyard
+
+#endif  // SRC_COMMON_MEMORY_RING_H_
@@ -17,11 +17,19 @@ limitations under the License.
 #define SRC_COMMON_UTIL_BLOCKING_QUEUE_H_
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstddef>
 #include <deque>
+#include <iterator>
 #include <limits>
+#include <memory>
 #include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace vineyard {
 
@@ -165,6 +173,253 @@ class PCBlockingQueue {
   std::atomic<int> producer_num_;
 };
 
+/**
+ * @brief A bounded lock-free multi-producer multi-consumer queue on a ring of
+ * cells, where each cell carries a sequence number that tells whether it is
+ * ready to be written or read in the current lap (Dmitry Vyukov's design), so
+ * producers and consumers only contend on a single atomic position each.
+ *
+ * The producer-count termination of `PCBlockingQueue` is kept: `Get` returns
+ * false once the queue is empty and all producers have called
+ * `DecProducerNum`. The batching `PushBatch` and `PopBatch` claim many
+ * consecutive cells with a single CAS. Blocking operations spin, then yield,
+ * then sleep for short intervals, rather than waiting on a condition
+ * variable.
+ */
+template <typename T>
+class MPMCQueue {
+ public:
+  /**
+   * @brief The capacity is rounded up to the next power of two.
+   */
+  explicit MPMCQueue(size_t const capacity = 1024)
+      : mask_(round_up_to_power_of_two(capacity) - 1),
+        cells_(new Cell[mask_ + 1]) {
+    for (size_t index = 0; index <= mask_; ++index) {
+      cells_[index].sequence.store(index, std::memory_order_relaxed);
+    }
+  }
+
+  ~MPMCQueue() {
+    size_t end = enqueue_pos_.load();
+    for (size_t pos = dequeue_pos_.load(); pos != end; ++pos) {
+      Cell& cell = cells_[pos & mask_];
+      if (cell.sequence.load() == pos + 1) {
+        reinterpret_cast<T*>(&cell.storage)->~T();
+      }
+    }
+  }
+
+  MPMCQueue(const MPMCQueue&) = delete;
+  MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+  size_t Capacity() const { return mask_ + 1; }
+
+  void SetProducerNum(int pn) { producer_num_.store(pn); }
+
+  void DecProducerNum() { producer_num_.fetch_sub(1); }
+
+  bool TryPut(const T& item) {
+    T copy(item);
+    return TryPut(std::move(copy));
+  }
+
+  bool TryPut(T&& item) {
+    size_t pos;
+    if (claim(enqueue_pos_, 1, 0, pos) == 0) {
+      return false;
+    }
+    write(pos, std::move(item));
+    return true;
+  }
+
+  void Put(const T& item) {
+    T copy(item);
+    Put(std::move(copy));
+  }
+
+  void Put(T&& item) {
+    for (size_t spins = 0; !TryPut(std::move(item)); ++spins) {
+      backoff(spins);
+    }
+  }
+
+  /**
+   * @brief Put the items of [begin, end) in order, moving them into the
+   * queue, blocks until all of them have been put.
+   */
+  template <typename Iterator>
+  void PushBatch(Iterator begin, Iterator end) {
+    size_t spins = 0;
+    while (begin != end) {
+      size_t pos;
+      size_t claimed = claim(enqueue_pos_, std::distance(begin, end), 0, pos);
+      if (claimed == 0) {
+        backoff(spins++);
+        continue;
+      }
+      spins = 0;
+      for (size_t index = 0; index < claimed; ++index, ++begin) {
+        write(pos + index, std::move(*begin));
+      }
+    }
+  }
+
+  void PushBatch(std::vector<T>& items) {
+    PushBatch(items.begin(), items.end());
+  }
+
+  bool TryGet(T& item) {
+    size_t pos;
+    if (claim(dequeue_pos_, 1, 1, pos) == 0) {
+      return false;
+    }
+    item = read(pos);
+    return true;
+  }
+
+  /**
+   * @brief Blocks until an item is available, returns false when the queue is
+   * empty and all producers have finished.
+   */
+  bool Get(T& item) {
+    for (size_t spins = 0; !TryGet(item); ++spins) {
+      if (producer_num_.load() == 0) {
+        // the items that have been put before the last `DecProducerNum`
+        return TryGet(item);
+      }
+      backoff(spins);
+    }
+    return true;
+  }
+
+  /**
+   * @brief Append at most `max_items` items to `items`, blocks until at least
+   * one item is available, returns the number of items that have been got,
+   * which is zero when the queue is empty and all producers have finished.
+   */
+  size_t PopBatch(std::vector<T>& items, size_t const max_items) {
+    for (size_t spins = 0; max_items > 0; ++spins) {
+      bool finished = producer_num_.load() == 0;
+      size_t pos;
+      size_t claimed = claim(dequeue_pos_, max_items, 1, pos);
+      if (claimed > 0) {
+        items.reserve(items.size() + claimed);
+        for (size_t index = 0; index < claimed; ++index) {
+          items.emplace_back(read(pos + index));
+        }
+        return claimed;
+      }
+      if (finished) {
+        break;
+      }
+      backoff(spins);
+    }
+    return 0;
+  }
+
+  /**
+   * @brief The number of items that have been claimed by producers and not
+   * yet claimed by consumers, which is inexact under concurrent updates.
+   */
+  size_t Size() const {
+    size_t dequeued = dequeue_pos_.load(std::memory_order_acquire);
+    size_t enqueued = enqueue_pos_.load(std::memory_order_acquire);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+  }
+
+  bool End() const { return Size() == 0 && producer_num_.load() == 0; }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+  };
+
+  static size_t round_up_to_power_of_two(size_t value) {
+    size_t capacity = 2;
+    while (capacity < value) {
+      capacity <<= 1;
+    }
+    return capacity;
+  }
+
+  static void backoff(size_t const spins) {
+    if (spins >= 1024) {
+      // waited for long, e.g., on a slow consumer
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    } else if (spins >= 64) {
+      std::this_thread::yield();
+    }
+  }
+
+  /**
+   * @brief Claim at most `count` consecutive cells from `position`, that are
+   * ready for writing (`lag` is 0) or reading (`lag` is 1) in the current lap.
+   *
+   * Once a cell is ready it stays ready until it is claimed, and the cells
+   * can only be claimed by advancing the position, thus the cells checked
+   * before a successful CAS are still ready.
+   */
+  size_t claim(std::atomic<size_t>& position, size_t const count,
+               size_t const lag, size_t& pos) {
+    pos = position.load(std::memory_order_relaxed);
+    while (true) {
+      size_t ready = 0;
+      while (ready < count && ready <= mask_) {
+        Cell& cell = cells_[(pos + ready) & mask_];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (sequence != pos + ready + lag) {
+          break;
+        }
+        ++ready;
+      }
+      if (ready == 0) {
+        Cell& cell = cells_[pos & mask_];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<std::ptrdiff_t>(sequence - (pos + lag)) < 0) {
+          // full for producers, or empty for consumers
+          return 0;
+        }
+        // claimed by others, retry from the new position
+        pos = position.load(std::memory_order_relaxed);
+        continue;
+      }
+      if (position.compare_exchange_weak(pos, pos + ready,
+                                         std::memory_order_relaxed)) {
+        return ready;
+      }
+    }
+  }
+
+  void write(size_t const pos, T&& item) {
+    Cell& cell = cells_[pos & mask_];
+    new (&cell.storage) T(std::move(item));
+    cell.sequence.store(pos + 1, std::memory_order_release);
+  }
+
+  T read(size_t const pos) {
+    Cell& cell = cells_[pos & mask_];
+    T* value = reinterpret_cast<T*>(&cell.storage);
+    T item(std::move(*value));
+    value->~T();
+    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return item;
+  }
+
+  size_t const mask_;
+  std::unique_ptr<Cell[]> cells_;
+
+  // keeps the positions of producers and consumers on separate cache lines
+  char padding0_[64];
+  std::atomic<size_t> enqueue_pos_{0};
+  char padding1_[64];
+  std::atomic<size_t> dequeue_pos_{0};
+  char padding2_[64];
+
+  std::atomic<int> producer_num_{0};
+};
+
 class SpinLock {
   std::atomic_flag locked = ATOMIC_FLAG_INIT;
 
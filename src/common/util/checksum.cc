@@ -0,0 +1,105 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "common/util/checksum.h"
+
+#include <cstring>
+
+namespace vineyard {
+
+static constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+static constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+static constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t rotl(uint64_t const value, int const bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t read64(const uint8_t* p) {
+  uint64_t value;
+  memcpy(&value, p, sizeof(uint64_t));
+  return value;
+}
+
+static inline uint32_t read32(const uint8_t* p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(uint32_t));
+  return value;
+}
+
+static inline uint64_t round(uint64_t acc, uint64_t const input) {
+  acc += input * kPrime2;
+  acc = rotl(acc, 31);
+  return acc * kPrime1;
+}
+
+static inline uint64_t merge(uint64_t acc, uint64_t const value) {
+  acc ^= round(0, value);
+  return acc * kPrime1 + kPrime4;
+}
+
+uint64_t Checksum(const void* data, size_t const size, uint64_t const seed) {
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+  const uint8_t* const end = p + size;
+  uint64_t hash;
+
+  if (size >= 32) {
+    const uint8_t* const limit = end - 32;
+    uint64_t v1 = seed + kPrime1 + kPrime2;
+    uint64_t v2 = seed + kPrime2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - kPrime1;
+    do {
+      v1 = round(v1, read64(p));
+      v2 = round(v2, read64(p + 8));
+      v3 = round(v3, read64(p + 16));
+      v4 = round(v4, read64(p + 24));
+      p += 32;
+    } while (p <= limit);
+    hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    hash = merge(hash, v1);
+    hash = merge(hash, v2);
+    hash = merge(hash, v3);
+    hash = merge(hash, v4);
+  } else {
+    hash = seed + kPrime5;
+  }
+  hash += static_cast<uint64_t>(size);
+
+  for (; p + 8 <= end; p += 8) {
+    hash ^= round(0, read64(p));
+    hash = rotl(hash, 27) * kPrime1 + kPrime4;
+  }
+  if (p + 4 <= end) {
+    hash ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+    hash = rotl(hash, 23) * kPrime2 + kPrime3;
+    p += 4;
+  }
+  for (; p < end; ++p) {
+    hash ^= static_cast<uint64_t>(*p) * kPrime5;
+    hash = rotl(hash, 11) * kPrime1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= kPrime2;
+  hash ^= hash >> 29;
+  hash *= kPrime3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+}  // namespace vineyard
@@ -0,0 +1,32 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_COMMON_UTIL_CHECKSUM_H_
+#define SRC_COMMON_UTIL_CHECKSUM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace vineyard {
+
+/**
+ * @brief Compute the 64-bit xxHash (XXH64) of the given bytes, which is used
+ * to verify the integrity of blobs that are transferred between instances.
+ */
+uint64_t Checksum(const void* data, size_t const size, uint64_t const seed = 0);
+
+}  // namespace vineyard
+
+#endif  // SRC_COMMON_UTIL_CHECKSUM_H_
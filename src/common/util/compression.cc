@@ -0,0 +1,129 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "common/util/compression.h"
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(WITH_ZSTD)
+#include "zstd.h"
+#endif
+
+namespace vineyard {
+
+#if defined(WITH_ZSTD)
+// fast enough to keep up with the network, while still effective for
+// offsets, low-cardinality integers and bitmaps
+static constexpr int kZstdLevel = 1;
+#endif
+
+const std::vector<std::string>& SupportedCompressions() {
+  static const std::vector<std::string> codecs = {
+#if defined(WITH_ZSTD)
+      "zstd",
+#endif
+  };
+  return codecs;
+}
+
+bool IsCompressionSupported(const std::string& codec) {
+  for (auto const& item : SupportedCompressions()) {
+    if (item == codec) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string NegotiateCompression(const std::vector<std::string>& codecs) {
+  for (auto const& codec : codecs) {
+    if (IsCompressionSupported(codec)) {
+      return codec;
+    }
+  }
+  return std::string();
+}
+
+Status CompressFrame(const std::string& codec, const uint8_t* data,
+                     size_t const size, std::string& frame) {
+  RETURN_ON_ASSERT(size <= kCompressionChunkSize,
+                   "The chunk is too large to be compressed as a frame");
+  CompressionFrameHeader header;
+  header.content_size = size;
+  header.compressed_size = size;
+  size_t const offset = sizeof(CompressionFrameHeader);
+#if defined(WITH_ZSTD)
+  if (codec == "zstd") {
+    static thread_local std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)>
+        context(ZSTD_createCCtx(), ZSTD_freeCCtx);
+    frame.resize(offset + ZSTD_compressBound(size));
+    size_t compressed = ZSTD_compressCCtx(context.get(), &frame[offset],
+                                          frame.size() - offset, data, size,
+                                          kZstdLevel);
+    if (ZSTD_isError(compressed)) {
+      return Status::IOError("Failed to compress the chunk: " +
+                             std::string(ZSTD_getErrorName(compressed)));
+    }
+    if (compressed < size) {
+      header.compressed_size = compressed;
+    }
+  } else {
+    return Status::NotImplemented("Unsupported compression: " + codec);
+  }
+#else
+  return Status::NotImplemented("Unsupported compression: " + codec);
+#endif
+  if (header.compressed_size == header.content_size) {
+    frame.resize(offset + size);
+    memcpy(&frame[offset], data, size);
+  } else {
+    frame.resize(offset + header.compressed_size);
+  }
+  memcpy(&frame[0], &header, sizeof(CompressionFrameHeader));
+  return Status::OK();
+}
+
+Status DecompressFrame(const std::string& codec,
+                       const CompressionFrameHeader& header,
+                       const uint8_t* payload, uint8_t* data) {
+  if (header.compressed_size == header.content_size) {
+    if (payload != data) {
+      memcpy(data, payload, header.content_size);
+    }
+    return Status::OK();
+  }
+#if defined(WITH_ZSTD)
+  if (codec == "zstd") {
+    static thread_local std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)>
+        context(ZSTD_createDCtx(), ZSTD_freeDCtx);
+    size_t decompressed =
+        ZSTD_decompressDCtx(context.get(), data, header.content_size, payload,
+                            header.compressed_size);
+    if (ZSTD_isError(decompressed)) {
+      return Status::IOError("Failed to decompress the chunk: " +
+                             std::string(ZSTD_getErrorName(decompressed)));
+    }
+    RETURN_ON_ASSERT(decompressed == header.content_size,
+                     "The decompressed chunk has an unexpected size");
+    return Status::OK();
+  }
+#endif
+  return Status::NotImplemented("Unsupported compression: " + codec);
+}
+
+}  // namespace vineyard
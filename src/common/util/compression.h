@@ -0,0 +1,74 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_COMMON_UTIL_COMPRESSION_H_
+#define SRC_COMMON_UTIL_COMPRESSION_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/// The max size of the content carried by a single compressed frame, blobs
+/// are compressed in chunks to overlap the compression with network I/O.
+constexpr size_t kCompressionChunkSize = 4 * 1024 * 1024;
+
+/// Transfers smaller than this are sent without compression.
+constexpr size_t kCompressionThreshold = 64 * 1024;
+
+/**
+ * @brief The header of a compressed frame, which is followed by
+ * `compressed_size` bytes. The content is stored as is when it doesn't
+ * shrink, i.e., when `compressed_size` equals to `content_size`.
+ */
+struct CompressionFrameHeader {
+  uint64_t compressed_size;
+  uint64_t content_size;
+};
+
+/**
+ * @brief The compression codecs supported by this build, e.g., "zstd".
+ */
+const std::vector<std::string>& SupportedCompressions();
+
+bool IsCompressionSupported(const std::string& codec);
+
+/**
+ * @brief Pick the first codec in `codecs` that is supported by this build,
+ * returns an empty string if none of them is supported.
+ */
+std::string NegotiateCompression(const std::vector<std::string>& codecs);
+
+/**
+ * @brief Compress a chunk of at most `kCompressionChunkSize` bytes into a
+ * frame, including the header.
+ */
+Status CompressFrame(const std::string& codec, const uint8_t* data,
+                     size_t const size, std::string& frame);
+
+/**
+ * @brief Decompress the payload of a frame into `data`, which must have room
+ * for `header.content_size` bytes.
+ */
+Status DecompressFrame(const std::string& codec,
+                       const CompressionFrameHeader& header,
+                       const uint8_t* payload, uint8_t* data);
+
+}  // namespace vineyard
+
+#endif  // SRC_COMMON_UTIL_COMPRESSION_H_
@@ -17,9 +17,12 @@ limitations under the License.
 
 #include <sstream>
 #include <unordered_set>
+#include <utility>
 
 #include "boost/algorithm/string.hpp"
 
+#include "common/util/compression.h"
+#include "common/util/trace.h"
 #include "common/util/uuid.h"
 #include "common/util/version.h"
 
@@ -62,6 +65,10 @@ CommandType ParseCommandType(const std::string& str_type) {
     return CommandType::ClusterMetaRequest;
   } else if (str_type == "list_data_request") {
     return CommandType::ListDataRequest;
+  } else if (str_type == "prefetch_request") {
+    return CommandType::PrefetchRequest;
+  } else if (str_type == "list_data_page_request") {
+    return CommandType::ListDataPageRequest;
   } else if (str_type == "create_buffer_request") {
     return CommandType::CreateBufferRequest;
   } else if (str_type == "get_buffers_request") {
@@ -96,6 +103,30 @@ CommandType ParseCommandType(const std::string& str_type) {
     return CommandType::MigrateObjectRequest;
   } else if (str_type == "create_remote_buffer_request") {
     return CommandType::CreateRemoteBufferRequest;
+  } else if (str_type == "remote_buffer_chunk_request") {
+    return CommandType::RemoteBufferChunkRequest;
+  } else if (str_type == "seal_remote_buffer_request") {
+    return CommandType::SealRemoteBufferRequest;
+  } else if (str_type == "get_cached_buffers_request") {
+    return CommandType::GetCachedBuffersRequest;
+  } else if (str_type == "cache_buffers_request") {
+    return CommandType::CacheBuffersRequest;
+  } else if (str_type == "subscribe_invalidation_request") {
+    return CommandType::SubscribeInvalidationRequest;
+  } else if (str_type == "memory_attribution_request") {
+    return CommandType::MemoryAttributionRequest;
+  } else if (str_type == "create_copy_on_write_buffer_request") {
+    return CommandType::CreateCopyOnWriteBufferRequest;
+  } else if (str_type == "seal_buffer_request") {
+    return CommandType::SealBufferRequest;
+  } else if (str_type == "wait_persist_request") {
+    return CommandType::WaitPersistRequest;
+  } else if (str_type == "lease_request") {
+    return CommandType::LeaseRequest;
+  } else if (str_type == "create_device_buffer_request") {
+    return CommandType::CreateDeviceBufferRequest;
+  } else if (str_type == "checkpoint_request") {
+    return CommandType::CheckpointRequest;
   } else if (str_type == "get_remote_buffers_request") {
     return CommandType::GetRemoteBuffersRequest;
   } else if (str_type == "drop_buffer_request") {
@@ -106,6 +137,10 @@ CommandType ParseCommandType(const std::string& str_type) {
     return CommandType::FinalizeArenaRequest;
   } else if (str_type == "clear_request") {
     return CommandType::ClearRequest;
+  } else if (str_type == "batch_request") {
+    return CommandType::BatchRequest;
+  } else if (str_type == "ring_doorbell") {
+    return CommandType::RingDoorbell;
   } else if (str_type == "debug_command") {
     return CommandType::DebugCommand;
   } else {
@@ -113,8 +148,109 @@ CommandType ParseCommandType(const std::string& str_type) {
   }
 }
 
+// the wire format of hot commands written by the current thread
+static thread_local WireFormat current_wire_format = WireFormat::JSON;
+
+WireFormatScope::WireFormatScope(WireFormat const format)
+    : previous_(current_wire_format) {
+  current_wire_format = format;
+}
+
+WireFormatScope::~WireFormatScope() { current_wire_format = previous_; }
+
+static inline bool is_hot_message(const json& root) {
+  static const std::unordered_set<std::string> hot_messages = {
+      "create_buffer_request",          "create_buffer_reply",
+      "get_buffers_request",            "get_buffers_reply",
+      "get_next_stream_chunk_request",  "get_next_stream_chunk_reply",
+      "push_next_stream_chunk_request", "push_next_stream_chunk_reply",
+      "pull_next_stream_chunk_request", "pull_next_stream_chunk_reply",
+      "create_data_request",            "create_data_reply",
+      "get_data_request",               "get_data_reply",
+      "batch_request",                  "batch_reply",
+  };
+  auto type = root.find("type");
+  return type != root.end() && type->is_string() &&
+         hot_messages.find(type->get_ref<std::string const&>()) !=
+             hot_messages.end();
+}
+
+static inline void encode_msg_impl(const json& root, std::string& msg) {
+  if (current_wire_format == WireFormat::MsgPack && is_hot_message(root)) {
+    msg.clear();
+    json::to_msgpack(root, msg);
+  } else {
+    msg = json_to_string(root);
+  }
+}
+
+#if defined(WITH_TRACING)
+static inline bool is_request_message(const std::string& type) {
+  static const std::string suffix = "_request";
+  return type.size() > suffix.size() &&
+         type.compare(type.size() - suffix.size(), suffix.size(), suffix) ==
+             0;
+}
+
+/**
+ * @brief Requests carry the trace id of the client thread, and the span of
+ * the request begins once it is encoded.
+ */
+static inline void encode_msg(const json& root, std::string& msg) {
+  auto type = root.find("type");
+  if (type == root.end() || !type->is_string() ||
+      !is_request_message(type->get_ref<std::string const&>())) {
+    encode_msg_impl(root, msg);
+    return;
+  }
+  uint64_t trace_id = Tracer::CurrentTraceID();
+  if (trace_id == 0) {
+    trace_id = Tracer::NewTraceID();
+  }
+  json traced = root;
+  traced["trace_id"] = trace_id;
+  encode_msg_impl(traced, msg);
+  Tracer::BeginRequest(
+      Tracer::InternName(type->get_ref<std::string const&>()), trace_id);
+}
+#else
 static inline void encode_msg(const json& root, std::string& msg) {
-  msg = json_to_string(root);
+  encode_msg_impl(root, msg);
+}
+#endif
+
+static inline const char* wire_format_name(WireFormat const wire_format) {
+  return wire_format == WireFormat::MsgPack ? "msgpack" : "json";
+}
+
+static inline WireFormat parse_wire_format(const std::string& name) {
+  return name == "msgpack" ? WireFormat::MsgPack : WireFormat::JSON;
+}
+
+Status ParseQoSClass(const std::string& name, QoSClass& qos_class) {
+  if (name.empty() || name == "interactive") {
+    qos_class = QoSClass::Interactive;
+  } else if (name == "batch") {
+    qos_class = QoSClass::Batch;
+  } else {
+    return Status::Invalid("Unknown QoS class: '" + name +
+                           "', expects 'interactive' or 'batch'");
+  }
+  return Status::OK();
+}
+
+bool IsBinaryMessage(const std::string& msg) {
+  // a JSON message is an object that starts with '{', while a MessagePack
+  // message starts with a map header, i.e., 0x80 - 0x8f, 0xde or 0xdf.
+  return !msg.empty() && (static_cast<uint8_t>(msg[0]) & 0x80);
+}
+
+json DecodeMessage(const std::string& msg) {
+  if (IsBinaryMessage(msg)) {
+    // non-strict: the receiving buffer may have a trailing '\0'
+    return json::from_msgpack(msg, false);
+  }
+  return json::parse(msg);
 }
 
 void WriteErrorReply(Status const& status, std::string& msg) {
@@ -138,6 +274,128 @@ Status ReadRegisterRequest(const json& root, std::string& version) {
   return Status::OK();
 }
 
+void WriteRegisterRequest(WireFormat const wire_format,
+                          size_t const ring_capacity, std::string& msg) {
+  json root;
+  root["type"] = "register_request";
+  root["version"] = vineyard_version();
+  root["wire_format"] = wire_format_name(wire_format);
+  if (ring_capacity > 0) {
+    root["ring_capacity"] = ring_capacity;
+  }
+
+  encode_msg(root, msg);
+}
+
+Status ReadRegisterRequest(const json& root, std::string& version,
+                           WireFormat& wire_format, size_t& ring_capacity) {
+  RETURN_ON_ERROR(ReadRegisterRequest(root, version));
+  // Clients that don't know the binary format won't ask for it.
+  wire_format = parse_wire_format(root.value<std::string>("wire_format", ""));
+  ring_capacity = root.value("ring_capacity", static_cast<size_t>(0));
+  return Status::OK();
+}
+
+void WriteRegisterRequest(WireFormat const wire_format,
+                          size_t const ring_capacity, QoSClass const qos_class,
+                          std::string& msg) {
+  json root;
+  root["type"] = "register_request";
+  root["version"] = vineyard_version();
+  root["wire_format"] = wire_format_name(wire_format);
+  if (ring_capacity > 0) {
+    root["ring_capacity"] = ring_capacity;
+  }
+  if (qos_class == QoSClass::Batch) {
+    root["qos"] = "batch";
+  }
+
+  encode_msg(root, msg);
+}
+
+Status ReadRegisterRequest(const json& root, std::string& version,
+                           WireFormat& wire_format, size_t& ring_capacity,
+                           QoSClass& qos_class) {
+  RETURN_ON_ERROR(
+      ReadRegisterRequest(root, version, wire_format, ring_capacity));
+  return ParseQoSClass(root.value<std::string>("qos", ""), qos_class);
+}
+
+void WriteRegisterRequest(WireFormat const wire_format,
+                          size_t const ring_capacity, QoSClass const qos_class,
+                          std::vector<int> const& held_fds, std::string& msg) {
+  json root;
+  root["type"] = "register_request";
+  root["version"] = vineyard_version();
+  root["wire_format"] = wire_format_name(wire_format);
+  if (ring_capacity > 0) {
+    root["ring_capacity"] = ring_capacity;
+  }
+  if (qos_class == QoSClass::Batch) {
+    root["qos"] = "batch";
+  }
+  if (!held_fds.empty()) {
+    root["held_fds"] = held_fds;
+  }
+
+  encode_msg(root, msg);
+}
+
+Status ReadRegisterRequest(const json& root, std::string& version,
+                           WireFormat& wire_format, size_t& ring_capacity,
+                           QoSClass& qos_class, std::vector<int>& held_fds) {
+  RETURN_ON_ERROR(ReadRegisterRequest(root, version, wire_format,
+                                      ring_capacity, qos_class));
+  held_fds = root.value("held_fds", std::vector<int>{});
+  return Status::OK();
+}
+
+void WriteRegisterRequest(WireFormat const wire_format,
+                          size_t const ring_capacity, QoSClass const qos_class,
+                          std::vector<int> const& held_fds,
+                          std::string const& session, std::string& msg) {
+  json root;
+  root["type"] = "register_request";
+  root["version"] = vineyard_version();
+  root["wire_format"] = wire_format_name(wire_format);
+  if (ring_capacity > 0) {
+    root["ring_capacity"] = ring_capacity;
+  }
+  if (qos_class == QoSClass::Batch) {
+    root["qos"] = "batch";
+  }
+  if (!held_fds.empty()) {
+    root["held_fds"] = held_fds;
+  }
+  if (!session.empty()) {
+    root["session"] = session;
+  }
+
+  encode_msg(root, msg);
+}
+
+Status ReadRegisterRequest(const json& root, std::string& version,
+                           WireFormat& wire_format, size_t& ring_capacity,
+                           QoSClass& qos_class, std::vector<int>& held_fds,
+                           std::string& session) {
+  RETURN_ON_ERROR(ReadRegisterRequest(root, version, wire_format,
+                                      ring_capacity, qos_class, held_fds));
+  session = root.value<std::string>("session", "");
+  return Status::OK();
+}
+
+Status ReadRegisterReply(const json& root, std::string& ipc_socket,
+                         std::string& rpc_endpoint, InstanceID& instance_id,
+                         std::string& version, WireFormat& wire_format,
+                         bool& support_batch, size_t& ring_capacity,
+                         std::vector<std::string>& compressions) {
+  RETURN_ON_ERROR(ReadRegisterReply(root, ipc_socket, rpc_endpoint,
+                                    instance_id, version, wire_format,
+                                    support_batch, ring_capacity));
+  compressions = root.value("compressions", std::vector<std::string>{});
+  return Status::OK();
+}
+
 void WriteRegisterReply(const std::string& ipc_socket,
                         const std::string& rpc_endpoint,
                         const InstanceID instance_id, std::string& msg) {
@@ -164,6 +422,52 @@ Status ReadRegisterReply(const json& root, std::string& ipc_socket,
   return Status::OK();
 }
 
+void WriteRegisterReply(const std::string& ipc_socket,
+                        const std::string& rpc_endpoint,
+                        const InstanceID instance_id,
+                        WireFormat const wire_format,
+                        size_t const ring_capacity, bool const deduplication,
+                        std::string& msg) {
+  json root;
+  root["type"] = "register_reply";
+  root["ipc_socket"] = ipc_socket;
+  root["rpc_endpoint"] = rpc_endpoint;
+  root["instance_id"] = instance_id;
+  root["version"] = vineyard_version();
+  root["wire_format"] = wire_format_name(wire_format);
+  root["support_batch"] = true;
+  // the fd of the ring follows the reply
+  root["ring_capacity"] = ring_capacity;
+  root["compressions"] = SupportedCompressions();
+  root["deduplication"] = deduplication;
+  encode_msg(root, msg);
+}
+
+Status ReadRegisterReply(const json& root, std::string& ipc_socket,
+                         std::string& rpc_endpoint, InstanceID& instance_id,
+                         std::string& version, WireFormat& wire_format,
+                         bool& support_batch, size_t& ring_capacity) {
+  RETURN_ON_ERROR(ReadRegisterReply(root, ipc_socket, rpc_endpoint,
+                                    instance_id, version));
+  // Servers that don't know the binary format won't accept it.
+  wire_format = parse_wire_format(root.value<std::string>("wire_format", ""));
+  support_batch = root.value("support_batch", false);
+  ring_capacity = root.value("ring_capacity", static_cast<size_t>(0));
+  return Status::OK();
+}
+
+Status ReadRegisterReply(const json& root, std::string& ipc_socket,
+                         std::string& rpc_endpoint, InstanceID& instance_id,
+                         std::string& version, WireFormat& wire_format,
+                         bool& support_batch, size_t& ring_capacity,
+                         bool& deduplication) {
+  RETURN_ON_ERROR(ReadRegisterReply(root, ipc_socket, rpc_endpoint,
+                                    instance_id, version, wire_format,
+                                    support_batch, ring_capacity));
+  deduplication = root.value("deduplication", false);
+  return Status::OK();
+}
+
 void WriteExitRequest(std::string& msg) {
   json root;
   root["type"] = "exit_request";
@@ -194,12 +498,26 @@ void WriteGetDataRequest(const std::vector<ObjectID>& ids,
   encode_msg(root, msg);
 }
 
+void WriteGetDataRequest(const std::vector<ObjectID>& ids,
+                         const bool sync_remote, const bool wait,
+                         const int depth, std::string& msg) {
+  json root;
+  root["type"] = "get_data_request";
+  root["id"] = ids;
+  root["sync_remote"] = sync_remote;
+  root["wait"] = wait;
+  root["depth"] = depth;
+
+  encode_msg(root, msg);
+}
+
 Status ReadGetDataRequest(const json& root, std::vector<ObjectID>& ids,
-                          bool& sync_remote, bool& wait) {
+                          bool& sync_remote, bool& wait, int& depth) {
   RETURN_ON_ASSERT(root["type"] == "get_data_request");
   ids = root["id"].get_to(ids);
   sync_remote = root.value("sync_remote", false);
   wait = root.value("wait", false);
+  depth = root.value("depth", -1);
   return Status::OK();
 }
 
@@ -214,7 +532,7 @@ void WriteGetDataReply(const json& content, std::string& msg) {
 Status ReadGetDataReply(const json& root, json& content) {
   CHECK_IPC_ERROR(root, "get_data_reply");
   // should be only one item
-  auto content_group = root["content"];
+  auto const& content_group = root["content"];
   if (content_group.size() != 1) {
     return Status::ObjectNotExists("failed to read get_data reply: " +
                                    root.dump());
@@ -235,138 +553,635 @@ Status ReadGetDataReply(const json& root,
 void WriteListDataRequest(std::string const& pattern, bool const regex,
                           size_t const limit, std::string& msg) {
   json root;
-  root["type"] = "list_data_request";
-  root["pattern"] = pattern;
-  root["regex"] = regex;
-  root["limit"] = limit;
+  root["type"] = "list_data_request";
+  root["pattern"] = pattern;
+  root["regex"] = regex;
+  root["limit"] = limit;
+
+  encode_msg(root, msg);
+}
+
+Status ReadListDataRequest(const json& root, std::string& pattern, bool& regex,
+                           size_t& limit) {
+  RETURN_ON_ASSERT(root["type"] == "list_data_request");
+  pattern = root["pattern"].get_ref<std::string const&>();
+  regex = root.value("regex", false);
+  limit = root["limit"].get<size_t>();
+  return Status::OK();
+}
+
+void WriteListDataPageRequest(std::string const& pattern, bool const regex,
+                              size_t const limit, json const& filters,
+                              std::vector<std::string> const& fields,
+                              std::string const& cursor, std::string& msg) {
+  json root;
+  root["type"] = "list_data_page_request";
+  root["pattern"] = pattern;
+  root["regex"] = regex;
+  root["limit"] = limit;
+  root["filters"] = filters.is_null() ? json::object() : filters;
+  root["fields"] = fields;
+  root["cursor"] = cursor;
+
+  encode_msg(root, msg);
+}
+
+Status ReadListDataPageRequest(const json& root, std::string& pattern,
+                               bool& regex, size_t& limit, json& filters,
+                               std::vector<std::string>& fields,
+                               std::string& cursor) {
+  RETURN_ON_ASSERT(root["type"] == "list_data_page_request");
+  pattern = root["pattern"].get_ref<std::string const&>();
+  regex = root.value("regex", false);
+  limit = root["limit"].get<size_t>();
+  filters = root.value("filters", json::object());
+  fields = root.value("fields", std::vector<std::string>{});
+  cursor = root.value("cursor", std::string());
+  return Status::OK();
+}
+
+void WriteListDataPageReply(std::vector<ObjectID> const& ids,
+                            json const& projections,
+                            std::string const& next_cursor, std::string& msg) {
+  json root;
+  root["type"] = "list_data_page_reply";
+  root["ids"] = ids;
+  root["projections"] = projections;
+  root["cursor"] = next_cursor;
+
+  encode_msg(root, msg);
+}
+
+Status ReadListDataPageReply(const json& root, std::vector<ObjectID>& ids,
+                             std::unordered_map<ObjectID, json>& projections,
+                             std::string& next_cursor) {
+  CHECK_IPC_ERROR(root, "list_data_page_reply");
+  ids = root["ids"].get<std::vector<ObjectID>>();
+  for (auto const& kv : json::iterator_wrapper(root["projections"])) {
+    projections.emplace(ObjectIDFromString(kv.key()), kv.value());
+  }
+  next_cursor = root.value("cursor", std::string());
+  return Status::OK();
+}
+
+void WriteCreateBufferRequest(const size_t size, std::string& msg) {
+  json root;
+  root["type"] = "create_buffer_request";
+  root["size"] = size;
+
+  encode_msg(root, msg);
+}
+
+void WriteCreateBufferRequest(const size_t size, const int numa_node,
+                              const bool prefault, std::string& msg) {
+  json root;
+  root["type"] = "create_buffer_request";
+  root["size"] = size;
+  root["numa_node"] = numa_node;
+  root["prefault"] = prefault;
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateBufferRequest(const json& root, size_t& size) {
+  RETURN_ON_ASSERT(root["type"] == "create_buffer_request");
+  size = root["size"].get<size_t>();
+  return Status::OK();
+}
+
+Status ReadCreateBufferRequest(const json& root, size_t& size, int& numa_node,
+                               bool& prefault) {
+  RETURN_ON_ASSERT(root["type"] == "create_buffer_request");
+  size = root["size"].get<size_t>();
+  numa_node = root.value("numa_node", -1);
+  prefault = root.value("prefault", false);
+  return Status::OK();
+}
+
+void WriteCreateDeviceBufferRequest(const size_t size, const int device,
+                                    std::string& msg) {
+  json root;
+  root["type"] = "create_device_buffer_request";
+  root["size"] = size;
+  root["device"] = device;
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateDeviceBufferRequest(const json& root, size_t& size,
+                                     int& device) {
+  RETURN_ON_ASSERT(root["type"] == "create_device_buffer_request");
+  size = root["size"].get<size_t>();
+  device = root["device"].get<int>();
+  return Status::OK();
+}
+
+void WriteCreateBufferReply(const ObjectID id,
+                            const std::shared_ptr<Payload>& object,
+                            std::string& msg) {
+  json root;
+  root["type"] = "create_buffer_reply";
+  root["id"] = id;
+  json tree;
+  object->ToJSON(tree);
+  root["created"] = tree;
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateBufferReply(const json& root, ObjectID& id, Payload& object) {
+  CHECK_IPC_ERROR(root, "create_buffer_reply");
+  json tree = root["created"];
+  id = root["id"].get<ObjectID>();
+  object.FromJSON(tree);
+  return Status::OK();
+}
+
+void WriteCreateCopyOnWriteBufferRequest(
+    const ObjectID parent, std::vector<std::pair<size_t, size_t>> const& dirty,
+    std::string& msg) {
+  json root;
+  root["type"] = "create_copy_on_write_buffer_request";
+  root["parent"] = parent;
+  root["dirty"] = dirty;
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateCopyOnWriteBufferRequest(
+    const json& root, ObjectID& parent,
+    std::vector<std::pair<size_t, size_t>>& dirty) {
+  RETURN_ON_ASSERT(root["type"] == "create_copy_on_write_buffer_request");
+  parent = root["parent"].get<ObjectID>();
+  dirty = root["dirty"].get<std::vector<std::pair<size_t, size_t>>>();
+  return Status::OK();
+}
+
+void WriteCreateCopyOnWriteBufferReply(const ObjectID id,
+                                       const std::shared_ptr<Payload>& object,
+                                       const std::vector<int>& fds,
+                                       std::string& msg) {
+  json root;
+  root["type"] = "create_copy_on_write_buffer_reply";
+  root["id"] = id;
+  json tree;
+  object->ToJSON(tree);
+  root["created"] = tree;
+  root["fds"] = fds;
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateCopyOnWriteBufferReply(const json& root, ObjectID& id,
+                                        Payload& object,
+                                        std::vector<int>& fds) {
+  CHECK_IPC_ERROR(root, "create_copy_on_write_buffer_reply");
+  json tree = root["created"];
+  id = root["id"].get<ObjectID>();
+  object.FromJSON(tree);
+  fds = root["fds"].get<std::vector<int>>();
+  return Status::OK();
+}
+
+void WriteSealBufferRequest(const ObjectID id, std::string& msg) {
+  json root;
+  root["type"] = "seal_buffer_request";
+  root["id"] = id;
+
+  encode_msg(root, msg);
+}
+
+Status ReadSealBufferRequest(const json& root, ObjectID& id) {
+  RETURN_ON_ASSERT(root["type"] == "seal_buffer_request");
+  id = root["id"].get<ObjectID>();
+  return Status::OK();
+}
+
+void WriteSealBufferReply(const std::shared_ptr<Payload>& object,
+                          const std::vector<int>& fds, std::string& msg) {
+  json root;
+  root["type"] = "seal_buffer_reply";
+  json tree;
+  object->ToJSON(tree);
+  root["sealed"] = tree;
+  root["fds"] = fds;
+
+  encode_msg(root, msg);
+}
+
+Status ReadSealBufferReply(const json& root, Payload& object,
+                           std::vector<int>& fds) {
+  CHECK_IPC_ERROR(root, "seal_buffer_reply");
+  object.FromJSON(root["sealed"]);
+  fds = root["fds"].get<std::vector<int>>();
+  return Status::OK();
+}
+
+void WriteCreateRemoteBufferRequest(const size_t size, std::string& msg) {
+  json root;
+  root["type"] = "create_remote_buffer_request";
+  root["size"] = size;
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateRemoteBufferRequest(const json& root, size_t& size) {
+  RETURN_ON_ASSERT(root["type"] == "create_remote_buffer_request");
+  size = root["size"].get<size_t>();
+  return Status::OK();
+}
+
+void WriteCreateRemoteBufferRequest(const size_t size,
+                                    const std::string& compression,
+                                    std::string& msg) {
+  json root;
+  root["type"] = "create_remote_buffer_request";
+  root["size"] = size;
+  root["compression"] = compression;
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateRemoteBufferRequest(const json& root, size_t& size,
+                                     std::string& compression) {
+  RETURN_ON_ERROR(ReadCreateRemoteBufferRequest(root, size));
+  compression = root.value<std::string>("compression", "");
+  return Status::OK();
+}
+
+void WriteCreateRemoteBufferRequest(const size_t size,
+                                    const std::string& compression,
+                                    const bool stream, std::string& msg) {
+  json root;
+  root["type"] = "create_remote_buffer_request";
+  root["size"] = size;
+  root["compression"] = compression;
+  root["stream"] = stream;
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateRemoteBufferRequest(const json& root, size_t& size,
+                                     std::string& compression, bool& stream) {
+  RETURN_ON_ERROR(ReadCreateRemoteBufferRequest(root, size, compression));
+  stream = root.value("stream", false);
+  return Status::OK();
+}
+
+void WriteRemoteBufferChunkRequest(const ObjectID id, const size_t offset,
+                                   const size_t size,
+                                   const std::string& compression,
+                                   std::string& msg) {
+  json root;
+  root["type"] = "remote_buffer_chunk_request";
+  root["id"] = id;
+  root["offset"] = offset;
+  root["size"] = size;
+  root["compression"] = compression;
+
+  encode_msg(root, msg);
+}
+
+Status ReadRemoteBufferChunkRequest(const json& root, ObjectID& id,
+                                    size_t& offset, size_t& size,
+                                    std::string& compression) {
+  RETURN_ON_ASSERT(root["type"] == "remote_buffer_chunk_request");
+  id = root["id"].get<ObjectID>();
+  offset = root["offset"].get<size_t>();
+  size = root["size"].get<size_t>();
+  compression = root.value<std::string>("compression", "");
+  return Status::OK();
+}
+
+void WriteRemoteBufferChunkReply(std::string& msg) {
+  json root;
+  root["type"] = "remote_buffer_chunk_reply";
+
+  encode_msg(root, msg);
+}
+
+Status ReadRemoteBufferChunkReply(const json& root) {
+  CHECK_IPC_ERROR(root, "remote_buffer_chunk_reply");
+  return Status::OK();
+}
+
+void WriteSealRemoteBufferRequest(const ObjectID id, std::string& msg) {
+  json root;
+  root["type"] = "seal_remote_buffer_request";
+  root["id"] = id;
+
+  encode_msg(root, msg);
+}
+
+Status ReadSealRemoteBufferRequest(const json& root, ObjectID& id) {
+  RETURN_ON_ASSERT(root["type"] == "seal_remote_buffer_request");
+  id = root["id"].get<ObjectID>();
+  return Status::OK();
+}
+
+void WriteSealRemoteBufferReply(std::string& msg) {
+  json root;
+  root["type"] = "seal_remote_buffer_reply";
+
+  encode_msg(root, msg);
+}
+
+Status ReadSealRemoteBufferReply(const json& root) {
+  CHECK_IPC_ERROR(root, "seal_remote_buffer_reply");
+  return Status::OK();
+}
+
+void WriteGetBuffersRequest(const std::set<ObjectID>& ids, std::string& msg) {
+  json root;
+  root["type"] = "get_buffers_request";
+  int idx = 0;
+  for (auto const& id : ids) {
+    root[std::to_string(idx++)] = id;
+  }
+  root["num"] = ids.size();
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetBuffersRequest(const json& root, std::vector<ObjectID>& ids) {
+  RETURN_ON_ASSERT(root["type"] == "get_buffers_request");
+  size_t num = root["num"].get<size_t>();
+  for (size_t i = 0; i < num; ++i) {
+    ids.push_back(root[std::to_string(i)].get<ObjectID>());
+  }
+  return Status::OK();
+}
+
+void WriteGetBuffersRequest(const std::set<ObjectID>& ids, const bool batch_fds,
+                            std::string& msg) {
+  json root;
+  root["type"] = "get_buffers_request";
+  int idx = 0;
+  for (auto const& id : ids) {
+    root[std::to_string(idx++)] = id;
+  }
+  root["num"] = ids.size();
+  root["batch_fds"] = batch_fds;
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetBuffersRequest(const json& root, std::vector<ObjectID>& ids,
+                             bool& batch_fds) {
+  RETURN_ON_ERROR(ReadGetBuffersRequest(root, ids));
+  batch_fds = root.value("batch_fds", false);
+  return Status::OK();
+}
+
+void WriteGetBuffersReply(const std::vector<std::shared_ptr<Payload>>& objects,
+                          std::string& msg) {
+  json root;
+  root["type"] = "get_buffers_reply";
+  for (size_t i = 0; i < objects.size(); ++i) {
+    json tree;
+    objects[i]->ToJSON(tree);
+    root[std::to_string(i)] = tree;
+  }
+  root["num"] = objects.size();
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetBuffersReply(const json& root, std::vector<Payload>& objects) {
+  CHECK_IPC_ERROR(root, "get_buffers_reply");
+  for (size_t i = 0; i < root["num"]; ++i) {
+    json tree = root[std::to_string(i)];
+    Payload object;
+    object.FromJSON(tree);
+    objects.emplace_back(object);
+  }
+  return Status::OK();
+}
+
+void WriteGetBuffersReply(const std::vector<std::shared_ptr<Payload>>& objects,
+                          const std::string& compression, std::string& msg) {
+  json root;
+  root["type"] = "get_buffers_reply";
+  for (size_t i = 0; i < objects.size(); ++i) {
+    json tree;
+    objects[i]->ToJSON(tree);
+    root[std::to_string(i)] = tree;
+  }
+  root["num"] = objects.size();
+  root["compression"] = compression;
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetBuffersReply(const json& root, std::vector<Payload>& objects,
+                           std::string& compression) {
+  RETURN_ON_ERROR(ReadGetBuffersReply(root, objects));
+  compression = root.value<std::string>("compression", "");
+  return Status::OK();
+}
+
+void WriteGetBuffersReply(const std::vector<std::shared_ptr<Payload>>& objects,
+                          const std::vector<int>& fds, std::string& msg) {
+  json root;
+  root["type"] = "get_buffers_reply";
+  for (size_t i = 0; i < objects.size(); ++i) {
+    json tree;
+    objects[i]->ToJSON(tree);
+    root[std::to_string(i)] = tree;
+  }
+  root["num"] = objects.size();
+  root["fds"] = fds;
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetBuffersReply(const json& root, std::vector<Payload>& objects,
+                           std::vector<int>& fds) {
+  RETURN_ON_ERROR(ReadGetBuffersReply(root, objects));
+  if (root.contains("fds")) {
+    fds = root["fds"].get<std::vector<int>>();
+  }
+  return Status::OK();
+}
+
+void WriteGetRemoteBuffersRequest(const std::unordered_set<ObjectID>& ids,
+                                  std::string& msg) {
+  json root;
+  root["type"] = "get_remote_buffers_request";
+  int idx = 0;
+  for (auto const& id : ids) {
+    root[std::to_string(idx++)] = id;
+  }
+  root["num"] = ids.size();
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetRemoteBuffersRequest(const json& root,
+                                   std::vector<ObjectID>& ids) {
+  RETURN_ON_ASSERT(root["type"] == "get_remote_buffers_request");
+  size_t num = root["num"].get<size_t>();
+  for (size_t i = 0; i < num; ++i) {
+    ids.push_back(root[std::to_string(i)].get<ObjectID>());
+  }
+  return Status::OK();
+}
+
+void WriteGetRemoteBuffersRequest(
+    const std::vector<ObjectID>& ids,
+    const std::vector<std::pair<size_t, size_t>>& ranges, std::string& msg) {
+  json root;
+  root["type"] = "get_remote_buffers_request";
+  int idx = 0;
+  for (auto const& id : ids) {
+    root[std::to_string(idx++)] = id;
+  }
+  root["num"] = ids.size();
+  root["ranges"] = ranges;
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetRemoteBuffersRequest(
+    const json& root, std::vector<ObjectID>& ids,
+    std::vector<std::pair<size_t, size_t>>& ranges) {
+  RETURN_ON_ERROR(ReadGetRemoteBuffersRequest(root, ids));
+  if (root.contains("ranges")) {
+    ranges = root["ranges"].get<std::vector<std::pair<size_t, size_t>>>();
+    RETURN_ON_ASSERT(ranges.size() == ids.size());
+  }
+  return Status::OK();
+}
+
+void WriteGetRemoteBuffersRequest(
+    const std::vector<ObjectID>& ids,
+    const std::vector<std::pair<size_t, size_t>>& ranges,
+    const std::string& compression, std::string& msg) {
+  json root;
+  root["type"] = "get_remote_buffers_request";
+  int idx = 0;
+  for (auto const& id : ids) {
+    root[std::to_string(idx++)] = id;
+  }
+  root["num"] = ids.size();
+  root["ranges"] = ranges;
+  root["compression"] = compression;
+
+  encode_msg(root, msg);
+}
+
+Status ReadGetRemoteBuffersRequest(
+    const json& root, std::vector<ObjectID>& ids,
+    std::vector<std::pair<size_t, size_t>>& ranges, std::string& compression) {
+  RETURN_ON_ERROR(ReadGetRemoteBuffersRequest(root, ids, ranges));
+  compression = root.value<std::string>("compression", "");
+  return Status::OK();
+}
+
+void WriteGetCachedBuffersRequest(const std::vector<ObjectID>& remote_ids,
+                                  std::string& msg) {
+  json root;
+  root["type"] = "get_cached_buffers_request";
+  root["ids"] = remote_ids;
 
   encode_msg(root, msg);
 }
 
-Status ReadListDataRequest(const json& root, std::string& pattern, bool& regex,
-                           size_t& limit) {
-  RETURN_ON_ASSERT(root["type"] == "list_data_request");
-  pattern = root["pattern"].get_ref<std::string const&>();
-  regex = root.value("regex", false);
-  limit = root["limit"].get<size_t>();
+Status ReadGetCachedBuffersRequest(const json& root,
+                                   std::vector<ObjectID>& remote_ids) {
+  RETURN_ON_ASSERT(root["type"] == "get_cached_buffers_request");
+  remote_ids = root["ids"].get<std::vector<ObjectID>>();
   return Status::OK();
 }
 
-void WriteCreateBufferRequest(const size_t size, std::string& msg) {
+void WriteGetCachedBuffersReply(const bool enabled,
+                                const std::vector<ObjectID>& local_ids,
+                                std::string& msg) {
   json root;
-  root["type"] = "create_buffer_request";
-  root["size"] = size;
+  root["type"] = "get_cached_buffers_reply";
+  root["enabled"] = enabled;
+  root["ids"] = local_ids;
 
   encode_msg(root, msg);
 }
 
-Status ReadCreateBufferRequest(const json& root, size_t& size) {
-  RETURN_ON_ASSERT(root["type"] == "create_buffer_request");
-  size = root["size"].get<size_t>();
+Status ReadGetCachedBuffersReply(const json& root, bool& enabled,
+                                 std::vector<ObjectID>& local_ids) {
+  CHECK_IPC_ERROR(root, "get_cached_buffers_reply");
+  enabled = root["enabled"].get<bool>();
+  local_ids = root["ids"].get<std::vector<ObjectID>>();
   return Status::OK();
 }
 
-void WriteCreateBufferReply(const ObjectID id,
-                            const std::shared_ptr<Payload>& object,
-                            std::string& msg) {
+void WriteCacheBuffersRequest(const std::vector<ObjectID>& remote_ids,
+                              const std::vector<ObjectID>& local_ids,
+                              std::string& msg) {
   json root;
-  root["type"] = "create_buffer_reply";
-  root["id"] = id;
-  json tree;
-  object->ToJSON(tree);
-  root["created"] = tree;
+  root["type"] = "cache_buffers_request";
+  root["remote_ids"] = remote_ids;
+  root["local_ids"] = local_ids;
 
   encode_msg(root, msg);
 }
 
-Status ReadCreateBufferReply(const json& root, ObjectID& id, Payload& object) {
-  CHECK_IPC_ERROR(root, "create_buffer_reply");
-  json tree = root["created"];
-  id = root["id"].get<ObjectID>();
-  object.FromJSON(tree);
+Status ReadCacheBuffersRequest(const json& root,
+                               std::vector<ObjectID>& remote_ids,
+                               std::vector<ObjectID>& local_ids) {
+  RETURN_ON_ASSERT(root["type"] == "cache_buffers_request");
+  remote_ids = root["remote_ids"].get<std::vector<ObjectID>>();
+  local_ids = root["local_ids"].get<std::vector<ObjectID>>();
+  RETURN_ON_ASSERT(remote_ids.size() == local_ids.size());
   return Status::OK();
 }
 
-void WriteCreateRemoteBufferRequest(const size_t size, std::string& msg) {
+void WriteCacheBuffersReply(std::string& msg) {
   json root;
-  root["type"] = "create_remote_buffer_request";
-  root["size"] = size;
+  root["type"] = "cache_buffers_reply";
 
   encode_msg(root, msg);
 }
 
-Status ReadCreateRemoteBufferRequest(const json& root, size_t& size) {
-  RETURN_ON_ASSERT(root["type"] == "create_remote_buffer_request");
-  size = root["size"].get<size_t>();
+Status ReadCacheBuffersReply(const json& root) {
+  CHECK_IPC_ERROR(root, "cache_buffers_reply");
   return Status::OK();
 }
 
-void WriteGetBuffersRequest(const std::set<ObjectID>& ids, std::string& msg) {
+void WriteSubscribeInvalidationRequest(std::string& msg) {
   json root;
-  root["type"] = "get_buffers_request";
-  int idx = 0;
-  for (auto const& id : ids) {
-    root[std::to_string(idx++)] = id;
-  }
-  root["num"] = ids.size();
+  root["type"] = "subscribe_invalidation_request";
 
   encode_msg(root, msg);
 }
 
-Status ReadGetBuffersRequest(const json& root, std::vector<ObjectID>& ids) {
-  RETURN_ON_ASSERT(root["type"] == "get_buffers_request");
-  size_t num = root["num"].get<size_t>();
-  for (size_t i = 0; i < num; ++i) {
-    ids.push_back(root[std::to_string(i)].get<ObjectID>());
-  }
+Status ReadSubscribeInvalidationRequest(const json& root) {
+  RETURN_ON_ASSERT(root["type"] == "subscribe_invalidation_request");
   return Status::OK();
 }
 
-void WriteGetBuffersReply(const std::vector<std::shared_ptr<Payload>>& objects,
-                          std::string& msg) {
+void WriteSubscribeInvalidationReply(std::string& msg) {
   json root;
-  root["type"] = "get_buffers_reply";
-  for (size_t i = 0; i < objects.size(); ++i) {
-    json tree;
-    objects[i]->ToJSON(tree);
-    root[std::to_string(i)] = tree;
-  }
-  root["num"] = objects.size();
+  root["type"] = "subscribe_invalidation_reply";
 
   encode_msg(root, msg);
 }
 
-Status ReadGetBuffersReply(const json& root, std::vector<Payload>& objects) {
-  CHECK_IPC_ERROR(root, "get_buffers_reply");
-  for (size_t i = 0; i < root["num"]; ++i) {
-    json tree = root[std::to_string(i)];
-    Payload object;
-    object.FromJSON(tree);
-    objects.emplace_back(object);
-  }
+Status ReadSubscribeInvalidationReply(const json& root) {
+  CHECK_IPC_ERROR(root, "subscribe_invalidation_reply");
   return Status::OK();
 }
 
-void WriteGetRemoteBuffersRequest(const std::unordered_set<ObjectID>& ids,
-                                  std::string& msg) {
+void WriteInvalidationMessage(const std::vector<ObjectID>& ids,
+                              std::string& msg) {
   json root;
-  root["type"] = "get_remote_buffers_request";
-  int idx = 0;
-  for (auto const& id : ids) {
-    root[std::to_string(idx++)] = id;
-  }
-  root["num"] = ids.size();
+  root["type"] = "invalidation";
+  root["ids"] = ids;
 
   encode_msg(root, msg);
 }
 
-Status ReadGetRemoteBuffersRequest(const json& root,
-                                   std::vector<ObjectID>& ids) {
-  RETURN_ON_ASSERT(root["type"] == "get_remote_buffers_request");
-  size_t num = root["num"].get<size_t>();
-  for (size_t i = 0; i < num; ++i) {
-    ids.push_back(root[std::to_string(i)].get<ObjectID>());
-  }
+Status ReadInvalidationMessage(const json& root, std::vector<ObjectID>& ids) {
+  RETURN_ON_ASSERT(root["type"] == "invalidation");
+  ids = root["ids"].get<std::vector<ObjectID>>();
   return Status::OK();
 }
 
@@ -444,6 +1259,23 @@ Status ReadPersistRequest(const json& root, ObjectID& id) {
   return Status::OK();
 }
 
+void WritePersistRequest(const ObjectID id, bool const async,
+                         std::string& msg) {
+  json root;
+  root["type"] = "persist_request";
+  root["id"] = id;
+  root["async"] = async;
+
+  encode_msg(root, msg);
+}
+
+Status ReadPersistRequest(const json& root, ObjectID& id, bool& async) {
+  RETURN_ON_ASSERT(root["type"] == "persist_request");
+  id = root["id"].get<ObjectID>();
+  async = root.value("async", false);
+  return Status::OK();
+}
+
 void WritePersistReply(std::string& msg) {
   json root;
   root["type"] = "persist_reply";
@@ -484,6 +1316,105 @@ Status ReadIfPersistReply(const json& root, bool& persist) {
   return Status::OK();
 }
 
+void WriteWaitPersistRequest(const ObjectID id, bool const block,
+                             std::string& msg) {
+  json root;
+  root["type"] = "wait_persist_request";
+  root["id"] = id;
+  root["block"] = block;
+
+  encode_msg(root, msg);
+}
+
+Status ReadWaitPersistRequest(const json& root, ObjectID& id, bool& block) {
+  RETURN_ON_ASSERT(root["type"] == "wait_persist_request");
+  id = root["id"].get<ObjectID>();
+  block = root.value("block", true);
+  return Status::OK();
+}
+
+void WriteWaitPersistReply(bool const persisted, std::string& msg) {
+  json root;
+  root["type"] = "wait_persist_reply";
+  root["persisted"] = persisted;
+
+  encode_msg(root, msg);
+}
+
+Status ReadWaitPersistReply(const json& root, bool& persisted) {
+  CHECK_IPC_ERROR(root, "wait_persist_reply");
+  persisted = root.value("persisted", false);
+  return Status::OK();
+}
+
+void WriteLeaseRequest(const std::vector<ObjectID>& ids, int64_t const ttl,
+                       std::string& msg) {
+  json root;
+  root["type"] = "lease_request";
+  root["ids"] = ids;
+  root["ttl"] = ttl;
+
+  encode_msg(root, msg);
+}
+
+Status ReadLeaseRequest(const json& root, std::vector<ObjectID>& ids,
+                        int64_t& ttl) {
+  RETURN_ON_ASSERT(root["type"] == "lease_request");
+  ids = root["ids"].get<std::vector<ObjectID>>();
+  ttl = root.value("ttl", static_cast<int64_t>(0));
+  return Status::OK();
+}
+
+void WriteLeaseReply(std::string& msg) {
+  json root;
+  root["type"] = "lease_reply";
+
+  encode_msg(root, msg);
+}
+
+Status ReadLeaseReply(const json& root) {
+  CHECK_IPC_ERROR(root, "lease_reply");
+  return Status::OK();
+}
+
+void WritePrefetchRequest(const std::vector<ObjectID>& ids,
+                          const std::vector<ObjectID>& replicas,
+                          int64_t const ttl, std::string& msg) {
+  json root;
+  root["type"] = "prefetch_request";
+  root["ids"] = ids;
+  root["replicas"] = replicas;
+  root["ttl"] = ttl;
+
+  encode_msg(root, msg);
+}
+
+Status ReadPrefetchRequest(const json& root, std::vector<ObjectID>& ids,
+                           std::vector<ObjectID>& replicas, int64_t& ttl) {
+  RETURN_ON_ASSERT(root["type"] == "prefetch_request");
+  ids = root["ids"].get<std::vector<ObjectID>>();
+  replicas = root.value("replicas", std::vector<ObjectID>{});
+  ttl = root.value("ttl", static_cast<int64_t>(0));
+  RETURN_ON_ASSERT(replicas.size() <= ids.size(),
+                   "Each replica must be associated with an object");
+  return Status::OK();
+}
+
+void WritePrefetchReply(const std::vector<ObjectID>& replicas,
+                        std::string& msg) {
+  json root;
+  root["type"] = "prefetch_reply";
+  root["replicas"] = replicas;
+
+  encode_msg(root, msg);
+}
+
+Status ReadPrefetchReply(const json& root, std::vector<ObjectID>& replicas) {
+  CHECK_IPC_ERROR(root, "prefetch_reply");
+  replicas = root["replicas"].get<std::vector<ObjectID>>();
+  return Status::OK();
+}
+
 void WriteExistsRequest(const ObjectID id, std::string& msg) {
   json root;
   root["type"] = "exists_request";
@@ -611,6 +1542,60 @@ Status ReadInstanceStatusReply(const json& root, json& meta) {
   return Status::OK();
 }
 
+void WriteMemoryAttributionRequest(std::string& msg) {
+  json root;
+  root["type"] = "memory_attribution_request";
+
+  encode_msg(root, msg);
+}
+
+Status ReadMemoryAttributionRequest(const json& root) {
+  RETURN_ON_ASSERT(root["type"] == "memory_attribution_request");
+  return Status::OK();
+}
+
+void WriteMemoryAttributionReply(const json& usage, std::string& msg) {
+  json root;
+  root["type"] = "memory_attribution_reply";
+  root["usage"] = usage;
+
+  encode_msg(root, msg);
+}
+
+Status ReadMemoryAttributionReply(const json& root, json& usage) {
+  CHECK_IPC_ERROR(root, "memory_attribution_reply");
+  usage = root["usage"];
+  return Status::OK();
+}
+
+void WriteCheckpointRequest(const std::string& path, std::string& msg) {
+  json root;
+  root["type"] = "checkpoint_request";
+  root["path"] = path;
+
+  encode_msg(root, msg);
+}
+
+Status ReadCheckpointRequest(const json& root, std::string& path) {
+  RETURN_ON_ASSERT(root["type"] == "checkpoint_request");
+  path = root["path"].get<std::string>();
+  return Status::OK();
+}
+
+void WriteCheckpointReply(const json& stats, std::string& msg) {
+  json root;
+  root["type"] = "checkpoint_reply";
+  root["stats"] = stats;
+
+  encode_msg(root, msg);
+}
+
+Status ReadCheckpointReply(const json& root, json& stats) {
+  CHECK_IPC_ERROR(root, "checkpoint_reply");
+  stats = root["stats"];
+  return Status::OK();
+}
+
 void WritePutNameRequest(const ObjectID object_id, const std::string& name,
                          std::string& msg) {
   json root;
@@ -754,6 +1739,40 @@ Status ReadCreateStreamRequest(const json& root, ObjectID& object_id) {
   return Status::OK();
 }
 
+void WriteCreateStreamRequest(const ObjectID& object_id,
+                              const size_t high_watermark_bytes,
+                              const size_t low_watermark_bytes,
+                              const size_t high_watermark_chunks,
+                              const size_t low_watermark_chunks,
+                              const bool recycle_chunks, std::string& msg) {
+  json root;
+  root["type"] = "create_stream_request";
+  root["object_id"] = object_id;
+  root["high_watermark_bytes"] = high_watermark_bytes;
+  root["low_watermark_bytes"] = low_watermark_bytes;
+  root["high_watermark_chunks"] = high_watermark_chunks;
+  root["low_watermark_chunks"] = low_watermark_chunks;
+  root["recycle_chunks"] = recycle_chunks;
+
+  encode_msg(root, msg);
+}
+
+Status ReadCreateStreamRequest(const json& root, ObjectID& object_id,
+                               size_t& high_watermark_bytes,
+                               size_t& low_watermark_bytes,
+                               size_t& high_watermark_chunks,
+                               size_t& low_watermark_chunks,
+                               bool& recycle_chunks) {
+  RETURN_ON_ASSERT(root["type"] == "create_stream_request");
+  object_id = root["object_id"].get<ObjectID>();
+  high_watermark_bytes = root.value("high_watermark_bytes", 0UL);
+  low_watermark_bytes = root.value("low_watermark_bytes", 0UL);
+  high_watermark_chunks = root.value("high_watermark_chunks", 0UL);
+  low_watermark_chunks = root.value("low_watermark_chunks", 0UL);
+  recycle_chunks = root.value("recycle_chunks", false);
+  return Status::OK();
+}
+
 void WriteCreateStreamReply(std::string& msg) {
   json root;
   root["type"] = "create_stream_reply";
@@ -849,6 +1868,29 @@ Status ReadPushNextStreamChunkRequest(const json& root, ObjectID& stream_id,
   return Status::OK();
 }
 
+void WritePushNextStreamChunkRequest(const ObjectID stream_id,
+                                     const std::vector<ObjectID>& chunks,
+                                     std::string& msg) {
+  json root;
+  root["type"] = "push_next_stream_chunk_request";
+  root["id"] = stream_id;
+  root["chunks"] = chunks;
+
+  encode_msg(root, msg);
+}
+
+Status ReadPushNextStreamChunkRequest(const json& root, ObjectID& stream_id,
+                                      std::vector<ObjectID>& chunks) {
+  RETURN_ON_ASSERT(root["type"] == "push_next_stream_chunk_request");
+  stream_id = root["id"].get<ObjectID>();
+  if (root.contains("chunks")) {
+    root["chunks"].get_to(chunks);
+  } else {
+    chunks = {root["chunk"].get<ObjectID>()};
+  }
+  return Status::OK();
+}
+
 void WritePushNextStreamChunkReply(std::string& msg) {
   json root;
   root["type"] = "push_next_stream_chunk_reply";
@@ -875,6 +1917,27 @@ Status ReadPullNextStreamChunkRequest(const json& root, ObjectID& stream_id) {
   return Status::OK();
 }
 
+void WritePullNextStreamChunkRequest(const ObjectID stream_id,
+                                     const size_t max_chunks,
+                                     const size_t max_bytes, std::string& msg) {
+  json root;
+  root["type"] = "pull_next_stream_chunk_request";
+  root["id"] = stream_id;
+  root["max_chunks"] = max_chunks;
+  root["max_bytes"] = max_bytes;
+
+  encode_msg(root, msg);
+}
+
+Status ReadPullNextStreamChunkRequest(const json& root, ObjectID& stream_id,
+                                      size_t& max_chunks, size_t& max_bytes) {
+  RETURN_ON_ASSERT(root["type"] == "pull_next_stream_chunk_request");
+  stream_id = root["id"].get<ObjectID>();
+  max_chunks = root.value("max_chunks", static_cast<size_t>(1));
+  max_bytes = root.value("max_bytes", static_cast<size_t>(0));
+  return Status::OK();
+}
+
 void WritePullNextStreamChunkReply(ObjectID const chunk, std::string& msg) {
   json root;
   root["type"] = "pull_next_stream_chunk_reply";
@@ -889,6 +1952,28 @@ Status ReadPullNextStreamChunkReply(const json& root, ObjectID& chunk) {
   return Status::OK();
 }
 
+void WritePullNextStreamChunkReply(const std::vector<ObjectID>& chunks,
+                                   std::string& msg) {
+  json root;
+  root["type"] = "pull_next_stream_chunk_reply";
+  // keeps "chunk" for clients that pull a single chunk
+  root["chunk"] = chunks.empty() ? InvalidObjectID() : chunks.front();
+  root["chunks"] = chunks;
+
+  encode_msg(root, msg);
+}
+
+Status ReadPullNextStreamChunkReply(const json& root,
+                                    std::vector<ObjectID>& chunks) {
+  CHECK_IPC_ERROR(root, "pull_next_stream_chunk_reply");
+  if (root.contains("chunks")) {
+    root["chunks"].get_to(chunks);
+  } else {
+    chunks = {root["chunk"].get<ObjectID>()};
+  }
+  return Status::OK();
+}
+
 void WriteStopStreamRequest(const ObjectID stream_id, const bool failed,
                             std::string& msg) {
   json root;
@@ -1111,4 +2196,53 @@ Status ReadDebugReply(const json& root, json& result) {
   return Status::OK();
 }
 
+void WriteBatchRequest(const std::vector<std::string>& requests,
+                       std::string& msg) {
+  json root;
+  root["type"] = "batch_request";
+  json items = json::array();
+  for (auto const& request : requests) {
+    items.push_back(DecodeMessage(request));
+  }
+  root["requests"] = std::move(items);
+  encode_msg(root, msg);
+}
+
+Status ReadBatchRequest(const json& root, std::vector<json>& requests) {
+  RETURN_ON_ASSERT(root["type"] == "batch_request");
+  RETURN_ON_ASSERT(root["requests"].is_array());
+  requests.assign(root["requests"].begin(), root["requests"].end());
+  return Status::OK();
+}
+
+void WriteBatchReply(const std::vector<json>& replies, std::string& msg) {
+  json root;
+  root["type"] = "batch_reply";
+  root["replies"] = replies;
+  encode_msg(root, msg);
+}
+
+Status ReadBatchReply(const json& root, std::vector<json>& replies) {
+  CHECK_IPC_ERROR(root, "batch_reply");
+  RETURN_ON_ASSERT(root["replies"].is_array());
+  replies.assign(root["replies"].begin(), root["replies"].end());
+  return Status::OK();
+}
+
+void WriteRingDoorbell(std::string& msg) {
+  json root;
+  root["type"] = "ring_doorbell";
+  encode_msg(root, msg);
+}
+
+void WriteRingOverflow(std::string& msg) {
+  json root;
+  root["type"] = "ring_overflow";
+  encode_msg(root, msg);
+}
+
+bool IsRingOverflow(const json& root) {
+  return root.value("type", "") == "ring_overflow";
+}
+
 }  // namespace vineyard
@@ -22,6 +22,7 @@ limitations under the License.
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "common/memory/payload.h"
@@ -69,24 +70,169 @@ enum class CommandType {
   DeepCopyRequest = 35,
   ClearRequest = 36,
   PushNextStreamChunkRequest = 37,
+  BatchRequest = 38,
+  RingDoorbell = 39,
+  RemoteBufferChunkRequest = 40,
+  SealRemoteBufferRequest = 41,
+  GetCachedBuffersRequest = 42,
+  CacheBuffersRequest = 43,
+  SubscribeInvalidationRequest = 44,
+  MemoryAttributionRequest = 45,
+  CreateCopyOnWriteBufferRequest = 46,
+  SealBufferRequest = 47,
+  WaitPersistRequest = 48,
+  LeaseRequest = 49,
+  CreateDeviceBufferRequest = 50,
+  CheckpointRequest = 51,
+  ListDataPageRequest = 52,
+  PrefetchRequest = 53,
 };
 
 CommandType ParseCommandType(const std::string& str_type);
 
+/**
+ * @brief The encoding of IPC messages on the wire. JSON is always accepted,
+ * while the compact binary encoding (MessagePack) is negotiated during
+ * registration and used for the hot commands, i.e., buffers, stream
+ * chunks and the metadata of objects, whose values then stay typed on the
+ * wire rather than being printed and parsed as text.
+ */
+enum class WireFormat {
+  JSON = 0,
+  MsgPack = 1,
+};
+
+/**
+ * @brief Encode the messages of hot commands in the given wire format, for
+ * the messages written by the current thread during the lifetime of the
+ * scope.
+ */
+class WireFormatScope {
+ public:
+  explicit WireFormatScope(WireFormat const format);
+
+  ~WireFormatScope();
+
+ private:
+  WireFormat previous_;
+};
+
+/**
+ * @brief The class of service of a connection, which is chosen by the client
+ * at registration, e.g., by `VINEYARD_QOS_CLASS=batch`. The requests of batch
+ * connections yield to the interactive ones that are served by the same
+ * thread, and their remote buffer sends are paced to a share of the time
+ * while interactive sends are in flight.
+ */
+enum class QoSClass {
+  Interactive = 0,
+  Batch = 1,
+};
+
+/**
+ * @brief Parse "interactive" or "batch", an empty name means interactive.
+ */
+Status ParseQoSClass(const std::string& name, QoSClass& qos_class);
+
+/**
+ * @brief Whether the message is encoded in the binary wire format.
+ */
+bool IsBinaryMessage(const std::string& msg);
+
+/**
+ * @brief Decode a message in either wire format, throws `json::exception`
+ * on malformed messages, as `json::parse` does.
+ */
+json DecodeMessage(const std::string& msg);
+
 void WriteErrorReply(Status const& status, std::string& msg);
 
 void WriteRegisterRequest(std::string& msg);
 
+void WriteRegisterRequest(WireFormat const wire_format,
+                          size_t const ring_capacity, std::string& msg);
+
 Status ReadRegisterRequest(const json& msg, std::string& version);
 
+Status ReadRegisterRequest(const json& msg, std::string& version,
+                           WireFormat& wire_format, size_t& ring_capacity);
+
+void WriteRegisterRequest(WireFormat const wire_format,
+                          size_t const ring_capacity, QoSClass const qos_class,
+                          std::string& msg);
+
+Status ReadRegisterRequest(const json& msg, std::string& version,
+                           WireFormat& wire_format, size_t& ring_capacity,
+                           QoSClass& qos_class);
+
+/**
+ * @brief `held_fds` are the server-side fds that the client has received
+ * through another connection to the same server, e.g., the connection of the
+ * client it's forked from, thus they won't be passed again.
+ */
+void WriteRegisterRequest(WireFormat const wire_format,
+                          size_t const ring_capacity, QoSClass const qos_class,
+                          std::vector<int> const& held_fds, std::string& msg);
+
+Status ReadRegisterRequest(const json& msg, std::string& version,
+                           WireFormat& wire_format, size_t& ring_capacity,
+                           QoSClass& qos_class, std::vector<int>& held_fds);
+
+/**
+ * @brief `session` names the tenant whose memory quota the blobs that are
+ * created by the client are charged to, e.g., by `VINEYARD_SESSION=etl`,
+ * empty means none.
+ */
+void WriteRegisterRequest(WireFormat const wire_format,
+                          size_t const ring_capacity, QoSClass const qos_class,
+                          std::vector<int> const& held_fds,
+                          std::string const& session, std::string& msg);
+
+Status ReadRegisterRequest(const json& msg, std::string& version,
+                           WireFormat& wire_format, size_t& ring_capacity,
+                           QoSClass& qos_class, std::vector<int>& held_fds,
+                           std::string& session);
+
 void WriteRegisterReply(const std::string& ipc_socket,
                         const std::string& rpc_endpoint,
                         const InstanceID instance_id, std::string& msg);
 
+/**
+ * @brief `deduplication` tells the client to seal blobs by
+ * `WriteSealBufferRequest`, as the content of a blob may be stored only once.
+ */
+void WriteRegisterReply(const std::string& ipc_socket,
+                        const std::string& rpc_endpoint,
+                        const InstanceID instance_id,
+                        WireFormat const wire_format,
+                        size_t const ring_capacity, bool const deduplication,
+                        std::string& msg);
+
 Status ReadRegisterReply(const json& msg, std::string& ipc_socket,
                          std::string& rpc_endpoint, InstanceID& instance_id,
                          std::string& version);
 
+Status ReadRegisterReply(const json& msg, std::string& ipc_socket,
+                         std::string& rpc_endpoint, InstanceID& instance_id,
+                         std::string& version, WireFormat& wire_format,
+                         bool& support_batch, size_t& ring_capacity);
+
+Status ReadRegisterReply(const json& msg, std::string& ipc_socket,
+                         std::string& rpc_endpoint, InstanceID& instance_id,
+                         std::string& version, WireFormat& wire_format,
+                         bool& support_batch, size_t& ring_capacity,
+                         bool& deduplication);
+
+/**
+ * @brief Also reads the compression codecs that the server accepts for
+ * transferring remote buffers.
+ */
+Status ReadRegisterReply(const json& msg, std::string& ipc_socket,
+                         std::string& rpc_endpoint, InstanceID& instance_id,
+                         std::string& version, WireFormat& wire_format,
+                         bool& support_batch, size_t& ring_capacity,
+                         std::vector<std::string>& compressions);
+
 void WriteExitRequest(std::string& msg);
 
 void WriteGetDataRequest(const ObjectID id, const bool sync_remote,
@@ -96,8 +242,16 @@ void WriteGetDataRequest(const std::vector<ObjectID>& ids,
                          const bool sync_remote, const bool wait,
                          std::string& msg);
 
+/**
+ * @brief Members nested deeper than `depth` are replied as placeholders, a
+ * negative `depth` means the whole tree.
+ */
+void WriteGetDataRequest(const std::vector<ObjectID>& ids,
+                         const bool sync_remote, const bool wait,
+                         const int depth, std::string& msg);
+
 Status ReadGetDataRequest(const json& root, std::vector<ObjectID>& ids,
-                          bool& sync_remote, bool& wait);
+                          bool& sync_remote, bool& wait, int& depth);
 
 void WriteGetDataReply(const json& content, std::string& msg);
 
@@ -112,6 +266,24 @@ void WriteListDataRequest(std::string const& pattern, bool const regex,
 Status ReadListDataRequest(const json& root, std::string& pattern, bool& regex,
                            size_t& limit);
 
+void WriteListDataPageRequest(std::string const& pattern, bool const regex,
+                              size_t const limit, json const& filters,
+                              std::vector<std::string> const& fields,
+                              std::string const& cursor, std::string& msg);
+
+Status ReadListDataPageRequest(const json& root, std::string& pattern,
+                               bool& regex, size_t& limit, json& filters,
+                               std::vector<std::string>& fields,
+                               std::string& cursor);
+
+void WriteListDataPageReply(std::vector<ObjectID> const& ids,
+                            json const& projections,
+                            std::string const& next_cursor, std::string& msg);
+
+Status ReadListDataPageReply(const json& root, std::vector<ObjectID>& ids,
+                             std::unordered_map<ObjectID, json>& projections,
+                             std::string& next_cursor);
+
 void WriteCreateDataRequest(const json& content, std::string& msg);
 
 Status ReadCreateDataRequest(const json& root, json& content);
@@ -126,6 +298,15 @@ void WritePersistRequest(const ObjectID id, std::string& msg);
 
 Status ReadPersistRequest(const json& root, ObjectID& id);
 
+/**
+ * @brief An `async` persist request is replied once the server accepts it,
+ * its completion is observed by `WriteWaitPersistRequest`.
+ */
+void WritePersistRequest(const ObjectID id, bool const async,
+                         std::string& msg);
+
+Status ReadPersistRequest(const json& root, ObjectID& id, bool& async);
+
 void WritePersistReply(std::string& msg);
 
 Status ReadPersistReply(const json& root);
@@ -138,6 +319,51 @@ void WriteIfPersistReply(bool exists, std::string& msg);
 
 Status ReadIfPersistReply(const json& root, bool& persist);
 
+/**
+ * @brief Query the asynchronous persistence of the object, the reply is
+ * deferred until the persistence completes when `block` is true.
+ */
+void WriteWaitPersistRequest(const ObjectID id, bool const block,
+                             std::string& msg);
+
+Status ReadWaitPersistRequest(const json& root, ObjectID& id, bool& block);
+
+void WriteWaitPersistReply(bool const persisted, std::string& msg);
+
+Status ReadWaitPersistReply(const json& root, bool& persisted);
+
+/**
+ * @brief Lease the objects for `ttl` seconds, a non-positive `ttl` releases
+ * the leases.
+ */
+void WriteLeaseRequest(const std::vector<ObjectID>& ids, int64_t const ttl,
+                       std::string& msg);
+
+Status ReadLeaseRequest(const json& root, std::vector<ObjectID>& ids,
+                        int64_t& ttl);
+
+void WriteLeaseReply(std::string& msg);
+
+Status ReadLeaseReply(const json& root);
+
+/**
+ * @brief Record `replicas[i]` as the prefetched replica of `ids[i]` and pin
+ * it for `ttl` seconds, the ids without a replica (i.e., the trailing ids
+ * when `replicas` is shorter) are only looked up. The reply carries the
+ * known replica of each id, or `InvalidObjectID()`.
+ */
+void WritePrefetchRequest(const std::vector<ObjectID>& ids,
+                          const std::vector<ObjectID>& replicas,
+                          int64_t const ttl, std::string& msg);
+
+Status ReadPrefetchRequest(const json& root, std::vector<ObjectID>& ids,
+                           std::vector<ObjectID>& replicas, int64_t& ttl);
+
+void WritePrefetchReply(const std::vector<ObjectID>& replicas,
+                        std::string& msg);
+
+Status ReadPrefetchReply(const json& root, std::vector<ObjectID>& replicas);
+
 void WriteExistsRequest(const ObjectID id, std::string& msg);
 
 Status ReadExistsRequest(const json& root, ObjectID& id);
@@ -176,35 +402,258 @@ void WriteInstanceStatusReply(const json& content, std::string& msg);
 
 Status ReadInstanceStatusReply(const json& root, json& content);
 
+void WriteMemoryAttributionRequest(std::string& msg);
+
+Status ReadMemoryAttributionRequest(const json& root);
+
+void WriteMemoryAttributionReply(const json& usage, std::string& msg);
+
+Status ReadMemoryAttributionReply(const json& root, json& usage);
+
+void WriteCheckpointRequest(const std::string& path, std::string& msg);
+
+Status ReadCheckpointRequest(const json& root, std::string& path);
+
+void WriteCheckpointReply(const json& stats, std::string& msg);
+
+Status ReadCheckpointReply(const json& root, json& stats);
+
 void WriteCreateBufferRequest(const size_t size, std::string& msg);
 
+void WriteCreateBufferRequest(const size_t size, const int numa_node,
+                              const bool prefault, std::string& msg);
+
 Status ReadCreateBufferRequest(const json& root, size_t& size);
 
+Status ReadCreateBufferRequest(const json& root, size_t& size, int& numa_node,
+                               bool& prefault);
+
+void WriteCreateDeviceBufferRequest(const size_t size, const int device,
+                                    std::string& msg);
+
+Status ReadCreateDeviceBufferRequest(const json& root, size_t& size,
+                                     int& device);
+
 void WriteCreateBufferReply(const ObjectID id,
                             const std::shared_ptr<Payload>& object,
                             std::string& msg);
 
 Status ReadCreateBufferReply(const json& root, ObjectID& id, Payload& object);
 
+/**
+ * @brief Create a copy-on-write blob of `parent`, the `dirty` (offset, size)
+ * ranges are the parts that will be modified, see also
+ * `BulkStore::CreateCopyOnWrite`.
+ */
+void WriteCreateCopyOnWriteBufferRequest(
+    const ObjectID parent, std::vector<std::pair<size_t, size_t>> const& dirty,
+    std::string& msg);
+
+Status ReadCreateCopyOnWriteBufferRequest(
+    const json& root, ObjectID& parent,
+    std::vector<std::pair<size_t, size_t>>& dirty);
+
+/**
+ * @brief The unseen `fds` of the extents are passed in a single message
+ * after the reply.
+ */
+void WriteCreateCopyOnWriteBufferReply(const ObjectID id,
+                                       const std::shared_ptr<Payload>& object,
+                                       const std::vector<int>& fds,
+                                       std::string& msg);
+
+Status ReadCreateCopyOnWriteBufferReply(const json& root, ObjectID& id,
+                                        Payload& object,
+                                        std::vector<int>& fds);
+
+void WriteSealBufferRequest(const ObjectID id, std::string& msg);
+
+Status ReadSealBufferRequest(const json& root, ObjectID& id);
+
+/**
+ * @brief The sealed blob may be stored at the location of an identical blob,
+ * the unseen `fds` are passed in a single message after the reply.
+ */
+void WriteSealBufferReply(const std::shared_ptr<Payload>& object,
+                          const std::vector<int>& fds, std::string& msg);
+
+Status ReadSealBufferReply(const json& root, Payload& object,
+                           std::vector<int>& fds);
+
 void WriteCreateRemoteBufferRequest(const size_t size, std::string& msg);
 
 Status ReadCreateRemoteBufferRequest(const json& root, size_t& size);
 
+/**
+ * @brief The content follows the request in compressed frames when
+ * `compression` is not empty, see also `CompressFrame`.
+ */
+void WriteCreateRemoteBufferRequest(const size_t size,
+                                    const std::string& compression,
+                                    std::string& msg);
+
+Status ReadCreateRemoteBufferRequest(const json& root, size_t& size,
+                                     std::string& compression);
+
+/**
+ * @brief When `stream` is true, the server replies as soon as the buffer is
+ * allocated, and the content is sent later in chunks, see also
+ * `WriteRemoteBufferChunkRequest`.
+ */
+void WriteCreateRemoteBufferRequest(const size_t size,
+                                    const std::string& compression,
+                                    const bool stream, std::string& msg);
+
+Status ReadCreateRemoteBufferRequest(const json& root, size_t& size,
+                                     std::string& compression, bool& stream);
+
+/**
+ * @brief The `size` bytes of content at `offset` of a streaming remote
+ * buffer follow the request, in compressed frames when `compression` is not
+ * empty.
+ */
+void WriteRemoteBufferChunkRequest(const ObjectID id, const size_t offset,
+                                   const size_t size,
+                                   const std::string& compression,
+                                   std::string& msg);
+
+Status ReadRemoteBufferChunkRequest(const json& root, ObjectID& id,
+                                    size_t& offset, size_t& size,
+                                    std::string& compression);
+
+void WriteRemoteBufferChunkReply(std::string& msg);
+
+Status ReadRemoteBufferChunkReply(const json& root);
+
+void WriteSealRemoteBufferRequest(const ObjectID id, std::string& msg);
+
+Status ReadSealRemoteBufferRequest(const json& root, ObjectID& id);
+
+void WriteSealRemoteBufferReply(std::string& msg);
+
+Status ReadSealRemoteBufferReply(const json& root);
+
 void WriteGetBuffersRequest(const std::set<ObjectID>& ids, std::string& msg);
 
 Status ReadGetBuffersRequest(const json& root, std::vector<ObjectID>& ids);
 
+/**
+ * @brief Ask the server to pass the fds of all unseen segments in a single
+ * message after the reply, see also `WriteGetBuffersReply` with `fds`.
+ */
+void WriteGetBuffersRequest(const std::set<ObjectID>& ids, const bool batch_fds,
+                            std::string& msg);
+
+Status ReadGetBuffersRequest(const json& root, std::vector<ObjectID>& ids,
+                             bool& batch_fds);
+
 void WriteGetBuffersReply(const std::vector<std::shared_ptr<Payload>>& objects,
                           std::string& msg);
 
 Status ReadGetBuffersReply(const json& root, std::vector<Payload>& objects);
 
+/**
+ * @brief The content follows the reply in compressed frames when
+ * `compression` is not empty, see also `CompressFrame`.
+ */
+void WriteGetBuffersReply(const std::vector<std::shared_ptr<Payload>>& objects,
+                          const std::string& compression, std::string& msg);
+
+Status ReadGetBuffersReply(const json& root, std::vector<Payload>& objects,
+                           std::string& compression);
+
+/**
+ * @brief The `fds` are the store fds that are passed, in order, with a single
+ * `send_fds` right after the reply.
+ */
+void WriteGetBuffersReply(const std::vector<std::shared_ptr<Payload>>& objects,
+                          const std::vector<int>& fds, std::string& msg);
+
+Status ReadGetBuffersReply(const json& root, std::vector<Payload>& objects,
+                           std::vector<int>& fds);
+
 void WriteGetRemoteBuffersRequest(const std::unordered_set<ObjectID>& ids,
                                   std::string& msg);
 
 Status ReadGetRemoteBuffersRequest(const json& root,
                                    std::vector<ObjectID>& ids);
 
+/**
+ * @brief Request the given ranges, as pairs of offset and length, of the
+ * remote blobs. The reply still describes the whole blobs, and a range of
+ * length 0 fetches nothing but the description.
+ */
+void WriteGetRemoteBuffersRequest(
+    const std::vector<ObjectID>& ids,
+    const std::vector<std::pair<size_t, size_t>>& ranges, std::string& msg);
+
+Status ReadGetRemoteBuffersRequest(
+    const json& root, std::vector<ObjectID>& ids,
+    std::vector<std::pair<size_t, size_t>>& ranges);
+
+/**
+ * @brief Also asks the server to compress the content with `compression`,
+ * the codec that is actually used is told by the reply.
+ */
+void WriteGetRemoteBuffersRequest(
+    const std::vector<ObjectID>& ids,
+    const std::vector<std::pair<size_t, size_t>>& ranges,
+    const std::string& compression, std::string& msg);
+
+Status ReadGetRemoteBuffersRequest(
+    const json& root, std::vector<ObjectID>& ids,
+    std::vector<std::pair<size_t, size_t>>& ranges, std::string& compression);
+
+/**
+ * @brief Look up the local copies of remote blobs in the remote blob cache,
+ * the reply carries `InvalidObjectID()` for the blobs that are not cached.
+ */
+void WriteGetCachedBuffersRequest(const std::vector<ObjectID>& remote_ids,
+                                  std::string& msg);
+
+Status ReadGetCachedBuffersRequest(const json& root,
+                                   std::vector<ObjectID>& remote_ids);
+
+void WriteGetCachedBuffersReply(const bool enabled,
+                                const std::vector<ObjectID>& local_ids,
+                                std::string& msg);
+
+Status ReadGetCachedBuffersReply(const json& root, bool& enabled,
+                                 std::vector<ObjectID>& local_ids);
+
+/**
+ * @brief Record the local blobs as the cached copies of remote blobs.
+ */
+void WriteCacheBuffersRequest(const std::vector<ObjectID>& remote_ids,
+                              const std::vector<ObjectID>& local_ids,
+                              std::string& msg);
+
+Status ReadCacheBuffersRequest(const json& root,
+                               std::vector<ObjectID>& remote_ids,
+                               std::vector<ObjectID>& local_ids);
+
+void WriteCacheBuffersReply(std::string& msg);
+
+Status ReadCacheBuffersReply(const json& root);
+
+/**
+ * @brief Subscribe the invalidation of object metadata on the connection,
+ * after the reply the server pushes invalidation messages on it whenever
+ * objects are deleted or changed.
+ */
+void WriteSubscribeInvalidationRequest(std::string& msg);
+
+Status ReadSubscribeInvalidationRequest(const json& root);
+
+void WriteSubscribeInvalidationReply(std::string& msg);
+
+Status ReadSubscribeInvalidationReply(const json& root);
+
+void WriteInvalidationMessage(const std::vector<ObjectID>& ids,
+                              std::string& msg);
+
+Status ReadInvalidationMessage(const json& root, std::vector<ObjectID>& ids);
+
 void WriteDropBufferRequest(const ObjectID id, std::string& msg);
 
 Status ReadDropBufferRequest(const json& root, ObjectID& id);
@@ -257,6 +706,20 @@ void WriteCreateStreamRequest(const ObjectID& object_id, std::string& msg);
 
 Status ReadCreateStreamRequest(const json& root, ObjectID& object_id);
 
+void WriteCreateStreamRequest(const ObjectID& object_id,
+                              const size_t high_watermark_bytes,
+                              const size_t low_watermark_bytes,
+                              const size_t high_watermark_chunks,
+                              const size_t low_watermark_chunks,
+                              const bool recycle_chunks, std::string& msg);
+
+Status ReadCreateStreamRequest(const json& root, ObjectID& object_id,
+                               size_t& high_watermark_bytes,
+                               size_t& low_watermark_bytes,
+                               size_t& high_watermark_chunks,
+                               size_t& low_watermark_chunks,
+                               bool& recycle_chunks);
+
 void WriteCreateStreamReply(std::string& msg);
 
 Status ReadCreateStreamReply(const json& root);
@@ -288,6 +751,13 @@ void WritePushNextStreamChunkRequest(const ObjectID stream_id,
 Status ReadPushNextStreamChunkRequest(const json& root, ObjectID& stream_id,
                                       ObjectID& chunk);
 
+void WritePushNextStreamChunkRequest(const ObjectID stream_id,
+                                     const std::vector<ObjectID>& chunks,
+                                     std::string& msg);
+
+Status ReadPushNextStreamChunkRequest(const json& root, ObjectID& stream_id,
+                                      std::vector<ObjectID>& chunks);
+
 void WritePushNextStreamChunkReply(std::string& msg);
 
 Status ReadPushNextStreamChunkReply(const json& root);
@@ -297,10 +767,23 @@ void WritePullNextStreamChunkRequest(const ObjectID stream_id,
 
 Status ReadPullNextStreamChunkRequest(const json& root, ObjectID& stream_id);
 
+void WritePullNextStreamChunkRequest(const ObjectID stream_id,
+                                     const size_t max_chunks,
+                                     const size_t max_bytes, std::string& msg);
+
+Status ReadPullNextStreamChunkRequest(const json& root, ObjectID& stream_id,
+                                      size_t& max_chunks, size_t& max_bytes);
+
 void WritePullNextStreamChunkReply(ObjectID const chunk, std::string& msg);
 
 Status ReadPullNextStreamChunkReply(const json& root, ObjectID& chunk);
 
+void WritePullNextStreamChunkReply(const std::vector<ObjectID>& chunks,
+                                   std::string& msg);
+
+Status ReadPullNextStreamChunkReply(const json& root,
+                                    std::vector<ObjectID>& chunks);
+
 void WriteStopStreamRequest(const ObjectID stream_id, const bool failed,
                             std::string& msg);
 
@@ -372,6 +855,33 @@ void WriteDebugReply(const json& result, std::string& msg);
 
 Status ReadDebugReply(const json& root, json& result);
 
+/**
+ * @brief A batch of requests that are processed in order by the server, and
+ * answered by a single reply which carries the replies of all requests.
+ */
+void WriteBatchRequest(const std::vector<std::string>& requests,
+                       std::string& msg);
+
+Status ReadBatchRequest(const json& root, std::vector<json>& requests);
+
+void WriteBatchReply(const std::vector<json>& replies, std::string& msg);
+
+Status ReadBatchReply(const json& root, std::vector<json>& replies);
+
+/**
+ * @brief Wakes up the peer that waits for messages in the request ring, see
+ * also `memory::RequestRing`.
+ */
+void WriteRingDoorbell(std::string& msg);
+
+/**
+ * @brief Put in the request ring when the reply is too large for the ring,
+ * and the reply follows on the socket.
+ */
+void WriteRingOverflow(std::string& msg);
+
+bool IsRingOverflow(const json& root);
+
 }  // namespace vineyard
 
 #endif  // SRC_COMMON_UTIL_PROTOCOLS_H_
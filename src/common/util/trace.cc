@@ -0,0 +1,301 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "common/util/trace.h"
+
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common/util/env.h"
+#include "common/util/json.h"
+
+namespace vineyard {
+
+namespace {
+
+struct TraceEvent {
+  const char* name;
+  uint64_t trace_id, start, end;
+};
+
+// 128KB for each thread
+constexpr size_t kTraceBufferCapacity = 4096;
+
+struct TraceBuffer {
+  explicit TraceBuffer(uint64_t const tid) : tid(tid) {}
+
+  uint64_t tid;
+  // the number of events ever recorded, the writer is the owner thread
+  std::atomic<uint64_t> head{0};
+  std::array<TraceEvent, kTraceBufferCapacity> events;
+};
+
+struct TraceRegistry {
+  std::mutex mutex;
+  std::vector<std::shared_ptr<TraceBuffer>> buffers;
+  std::unordered_set<std::string> names;
+};
+
+void dump_at_exit() {
+  std::string path = read_env("VINEYARD_TRACE_FILE");
+  if (path.empty()) {
+    return;
+  }
+  auto pos = path.find("%p");
+  if (pos != std::string::npos) {
+    path.replace(pos, 2, std::to_string(getpid()));
+  }
+  auto status = Tracer::Dump(path);
+  if (!status.ok()) {
+    fprintf(stderr, "Failed to write the traces to '%s': %s\n", path.c_str(),
+            status.ToString().c_str());
+  }
+}
+
+// leaked, thus the buffers are still alive when the traces are dumped at exit
+TraceRegistry& registry() {
+  static TraceRegistry* instance = []() {
+    auto registry = new TraceRegistry();
+    std::atexit(dump_at_exit);
+    return registry;
+  }();
+  return *instance;
+}
+
+TraceBuffer& local_buffer() {
+  thread_local std::shared_ptr<TraceBuffer> buffer = []() {
+    static std::atomic<uint64_t> next_tid{1};
+    auto buffer = std::make_shared<TraceBuffer>(next_tid.fetch_add(1));
+    auto& instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    instance.buffers.emplace_back(buffer);
+    return buffer;
+  }();
+  return *buffer;
+}
+
+thread_local uint64_t current_trace_id = 0;
+
+struct PendingRequest {
+  const char* name = nullptr;
+  uint64_t trace_id = 0, start = 0;
+};
+
+thread_local PendingRequest pending_request;
+
+std::string to_hex(uint64_t const value) {
+  char buffer[17];
+  snprintf(buffer, sizeof(buffer), "%016llx",
+           static_cast<unsigned long long>(value));  // NOLINT(runtime/int)
+  return std::string(buffer);
+}
+
+/**
+ * @brief Copy out the events of the buffer that are not overwritten during
+ * copying.
+ */
+std::vector<TraceEvent> snapshot(TraceBuffer const& buffer) {
+  uint64_t head = buffer.head.load(std::memory_order_acquire);
+  uint64_t begin =
+      head > kTraceBufferCapacity ? head - kTraceBufferCapacity : 0;
+  std::vector<TraceEvent> events;
+  events.reserve(head - begin);
+  for (uint64_t index = begin; index < head; ++index) {
+    events.emplace_back(buffer.events[index % kTraceBufferCapacity]);
+  }
+  uint64_t after = buffer.head.load(std::memory_order_acquire);
+  if (after > begin + kTraceBufferCapacity) {
+    uint64_t overwritten = std::min<uint64_t>(
+        after - begin - kTraceBufferCapacity, events.size());
+    events.erase(events.begin(), events.begin() + overwritten);
+  }
+  return events;
+}
+
+void dump_chrome(std::ostream& os,
+                 std::vector<std::shared_ptr<TraceBuffer>> const& buffers) {
+  json events = json::array();
+  int pid = getpid();
+  for (auto const& buffer : buffers) {
+    for (auto const& event : snapshot(*buffer)) {
+      json item = {{"name", event.name},
+                   {"cat", "vineyard"},
+                   {"ph", "X"},
+                   {"ts", event.start / 1000.0},
+                   {"dur", (event.end - event.start) / 1000.0},
+                   {"pid", pid},
+                   {"tid", buffer->tid}};
+      if (event.trace_id != 0) {
+        item["args"] = json{{"trace_id", to_hex(event.trace_id)}};
+      }
+      events.push_back(std::move(item));
+    }
+  }
+  os << json{{"traceEvents", events}, {"displayTimeUnit", "ns"}}.dump();
+}
+
+void dump_opentelemetry(
+    std::ostream& os,
+    std::vector<std::shared_ptr<TraceBuffer>> const& buffers) {
+  json spans = json::array();
+  uint64_t span_id = Tracer::NewTraceID();
+  for (auto const& buffer : buffers) {
+    for (auto const& event : snapshot(*buffer)) {
+      span_id += 1;
+      // the uncorrelated spans are traces by themselves
+      uint64_t trace_id = event.trace_id != 0 ? event.trace_id : span_id;
+      json attributes = json::array();
+      attributes.push_back(
+          json{{"key", "thread.id"},
+               {"value", {{"intValue", std::to_string(buffer->tid)}}}});
+      spans.push_back(
+          json{{"traceId", to_hex(0) + to_hex(trace_id)},
+               {"spanId", to_hex(span_id)},
+               {"name", event.name},
+               {"kind", 1},
+               {"startTimeUnixNano", std::to_string(event.start)},
+               {"endTimeUnixNano", std::to_string(event.end)},
+               {"attributes", attributes}});
+    }
+  }
+  json resource_attributes = json::array();
+  resource_attributes.push_back(
+      json{{"key", "service.name"},
+           {"value",
+            {{"stringValue", read_env("OTEL_SERVICE_NAME", "vineyard")}}}});
+  resource_attributes.push_back(
+      json{{"key", "process.pid"},
+           {"value", {{"intValue", std::to_string(getpid())}}}});
+  json scope_spans = json::array();
+  scope_spans.push_back(
+      json{{"scope", {{"name", "vineyard"}}}, {"spans", spans}});
+  json resource_spans = json::array();
+  resource_spans.push_back(
+      json{{"resource", {{"attributes", resource_attributes}}},
+           {"scopeSpans", scope_spans}});
+  os << json{{"resourceSpans", resource_spans}}.dump();
+}
+
+}  // namespace
+
+uint64_t Tracer::Now() {
+  timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+uint64_t Tracer::NewTraceID() {
+  static const uint64_t base = []() {
+    std::random_device device;
+    return (static_cast<uint64_t>(device()) << 32) | device();
+  }();
+  static std::atomic<uint64_t> sequence{0};
+  // the multiplier is odd, thus the ids of a process never collide
+  uint64_t id = base ^ (sequence.fetch_add(1) * 0x9e3779b97f4a7c15ULL);
+  return id == 0 ? 1 : id;
+}
+
+uint64_t Tracer::CurrentTraceID() { return current_trace_id; }
+
+void Tracer::SetCurrentTraceID(uint64_t const trace_id) {
+  current_trace_id = trace_id;
+}
+
+void Tracer::Record(const char* name, uint64_t const trace_id,
+                    uint64_t const start, uint64_t const end) {
+  TraceBuffer& buffer = local_buffer();
+  uint64_t head = buffer.head.load(std::memory_order_relaxed);
+  buffer.events[head % kTraceBufferCapacity] =
+      TraceEvent{name, trace_id, start, end};
+  buffer.head.store(head + 1, std::memory_order_release);
+}
+
+const char* Tracer::InternName(const std::string& name) {
+  thread_local std::unordered_map<std::string, const char*> cache;
+  auto iter = cache.find(name);
+  if (iter != cache.end()) {
+    return iter->second;
+  }
+  auto& instance = registry();
+  std::lock_guard<std::mutex> lock(instance.mutex);
+  // the nodes of the set, and thus the strings, are stable
+  const char* interned = instance.names.emplace(name).first->c_str();
+  cache.emplace(name, interned);
+  return interned;
+}
+
+void Tracer::BeginRequest(const char* name, uint64_t const trace_id) {
+  pending_request.name = name;
+  pending_request.trace_id = trace_id;
+  pending_request.start = Now();
+}
+
+void Tracer::EndRequest() {
+  if (pending_request.name != nullptr) {
+    Record(pending_request.name, pending_request.trace_id,
+           pending_request.start, Now());
+    pending_request.name = nullptr;
+  }
+}
+
+void Tracer::Dump(std::ostream& os, TraceFormat const format) {
+  std::vector<std::shared_ptr<TraceBuffer>> buffers;
+  {
+    auto& instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    buffers = instance.buffers;
+  }
+  if (format == TraceFormat::kOpenTelemetry) {
+    dump_opentelemetry(os, buffers);
+  } else {
+    dump_chrome(os, buffers);
+  }
+}
+
+Status Tracer::Dump(const std::string& path) {
+  static const std::string otlp_suffix = ".otlp.json";
+  TraceFormat format = TraceFormat::kChrome;
+  if (path.size() >= otlp_suffix.size() &&
+      path.compare(path.size() - otlp_suffix.size(), otlp_suffix.size(),
+                   otlp_suffix) == 0) {
+    format = TraceFormat::kOpenTelemetry;
+  }
+  std::ofstream os(path);
+  if (!os) {
+    return Status::IOError("Failed to open '" + path + "'");
+  }
+  Dump(os, format);
+  os.close();
+  if (!os) {
+    return Status::IOError("Failed to write '" + path + "'");
+  }
+  return Status::OK();
+}
+
+}  // namespace vineyard
@@ -0,0 +1,139 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_COMMON_UTIL_TRACE_H_
+#define SRC_COMMON_UTIL_TRACE_H_
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+enum class TraceFormat {
+  /// the JSON trace event format of chrome://tracing and perfetto
+  kChrome = 0,
+  /// the OTLP/JSON encoding of OpenTelemetry spans
+  kOpenTelemetry = 1,
+};
+
+/**
+ * @brief Tracer records the spans of the hot paths into a fixed size ring
+ * buffer of each thread, the oldest spans are overwritten once a buffer is
+ * full. Recording takes no lock.
+ *
+ * The spans are correlated across the client and the server by the trace id
+ * of the requests: a client request carries the trace id that is current on
+ * the client thread (a new one when there isn't), and the server handles the
+ * request under that trace id.
+ *
+ * The call sites are compiled only with `-DWITH_TRACING` (the cmake option
+ * `USE_TRACING`). The spans are written at exit to `VINEYARD_TRACE_FILE`,
+ * where `%p` is replaced by the pid, in the OpenTelemetry format when the
+ * path ends with `.otlp.json`, in the chrome format otherwise.
+ */
+class Tracer {
+ public:
+  /**
+   * @brief Nanoseconds since the unix epoch.
+   */
+  static uint64_t Now();
+
+  static uint64_t NewTraceID();
+
+  static uint64_t CurrentTraceID();
+
+  static void SetCurrentTraceID(uint64_t const trace_id);
+
+  /**
+   * @brief Record a span, the `name` must outlive the tracer, i.e., be either
+   * a literal or a name returned by `InternName`.
+   */
+  static void Record(const char* name, uint64_t const trace_id,
+                     uint64_t const start, uint64_t const end);
+
+  static const char* InternName(const std::string& name);
+
+  /**
+   * @brief Begin the span of the client request that is being sent by the
+   * current thread, which ends once its reply is received. Only the latest
+   * request of a thread is pending.
+   */
+  static void BeginRequest(const char* name, uint64_t const trace_id);
+
+  static void EndRequest();
+
+  /**
+   * @brief Write the recorded spans of all threads, the spans that are
+   * overwritten while being written are skipped.
+   */
+  static void Dump(std::ostream& os, TraceFormat const format);
+
+  static Status Dump(const std::string& path);
+};
+
+/**
+ * @brief Record the enclosing scope as a span.
+ */
+class TraceSpan {
+ public:
+  explicit TraceSpan(const char* name)
+      : name_(name),
+        trace_id_(Tracer::CurrentTraceID()),
+        start_(Tracer::Now()) {}
+
+  ~TraceSpan() { Tracer::Record(name_, trace_id_, start_, Tracer::Now()); }
+
+ private:
+  const char* name_;
+  uint64_t trace_id_, start_;
+};
+
+/**
+ * @brief Make the given trace id current on the thread during the lifetime of
+ * the scope.
+ */
+class TraceIDScope {
+ public:
+  explicit TraceIDScope(uint64_t const trace_id)
+      : previous_(Tracer::CurrentTraceID()) {
+    Tracer::SetCurrentTraceID(trace_id);
+  }
+
+  ~TraceIDScope() { Tracer::SetCurrentTraceID(previous_); }
+
+ private:
+  uint64_t previous_;
+};
+
+#define VINEYARD_TRACE_CONCAT_IMPL(a, b) a##b
+#define VINEYARD_TRACE_CONCAT(a, b) VINEYARD_TRACE_CONCAT_IMPL(a, b)
+
+#if defined(WITH_TRACING)
+#define VINEYARD_TRACE_SPAN(name) \
+  ::vineyard::TraceSpan VINEYARD_TRACE_CONCAT(__trace_span_, __LINE__)(name)
+#define VINEYARD_TRACE_ID_SCOPE(trace_id)                           \
+  ::vineyard::TraceIDScope VINEYARD_TRACE_CONCAT(__trace_id_scope_, \
+                                                 __LINE__)(trace_id)
+#else
+#define VINEYARD_TRACE_SPAN(name)
+#define VINEYARD_TRACE_ID_SCOPE(trace_id)
+#endif
+
+}  // namespace vineyard
+
+#endif  // SRC_COMMON_UTIL_TRACE_H_
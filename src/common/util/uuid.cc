@@ -20,11 +20,89 @@ limitations under the License.
 
 #include "common/util/uuid.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
+#include <random>
 
 namespace vineyard {
 
+namespace {
+
+// 2021-01-01T00:00:00Z
+constexpr uint64_t kIDEpochMilliseconds = 1609459200000ULL;
+constexpr int kIDCounterBits = 10;
+constexpr int kIDTagBits = 13;
+constexpr uint64_t kIDTagMask = (1ULL << kIDTagBits) - 1;
+constexpr uint64_t kIDBlockSize = 256;
+
+std::atomic<uint64_t>& id_tag() {
+  static std::atomic<uint64_t> tag{[]() {
+    std::random_device device;
+    return static_cast<uint64_t>(device()) & kIDTagMask;
+  }()};
+  return tag;
+}
+
+/**
+ * @brief Reserve `count` consecutive sequences, which start from the current
+ * time when the previous reservations don't run ahead of the clock.
+ */
+uint64_t reserve_sequences(uint64_t const count) {
+  static std::atomic<uint64_t> next_sequence{0};
+  uint64_t milliseconds =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count();
+  uint64_t floor = (milliseconds - kIDEpochMilliseconds) << kIDCounterBits;
+  uint64_t current = next_sequence.load(std::memory_order_relaxed);
+  uint64_t start;
+  do {
+    start = std::max(current, floor);
+  } while (!next_sequence.compare_exchange_weak(current, start + count,
+                                                std::memory_order_relaxed));
+  return start;
+}
+
+struct SequenceBlock {
+  uint64_t next = 0, end = 0;
+};
+
+thread_local SequenceBlock local_sequences;
+
+inline ObjectID make_id(uint64_t const sequence) {
+  return 0x7FFFFFFFFFFFFFFFUL &
+         ((sequence << kIDTagBits) | id_tag().load(std::memory_order_relaxed));
+}
+
+}  // namespace
+
+ObjectID GenerateObjectID() {
+  SequenceBlock& block = local_sequences;
+  if (block.next == block.end) {
+    block.next = reserve_sequences(kIDBlockSize);
+    block.end = block.next + kIDBlockSize;
+  }
+  return make_id(block.next++);
+}
+
+std::vector<ObjectID> GenerateObjectIDs(size_t const count) {
+  std::vector<ObjectID> ids(count);
+  uint64_t sequence = count == 0 ? 0 : reserve_sequences(count);
+  for (size_t index = 0; index < count; ++index) {
+    ids[index] = make_id(sequence + index);
+  }
+  return ids;
+}
+
+Signature GenerateSignature() { return GenerateObjectID(); }
+
+void SetObjectIDTag(InstanceID const tag) {
+  id_tag().store(tag & kIDTagMask, std::memory_order_relaxed);
+}
+
 const std::string ObjectIDToString(const ObjectID id) {
   thread_local char buffer[18] = {'\0'};
   std::snprintf(buffer, sizeof(buffer), "o%016" PRIx64, id);
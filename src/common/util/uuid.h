@@ -24,6 +24,7 @@ limitations under the License.
 #include <cstdlib>
 #include <limits>
 #include <string>
+#include <vector>
 
 namespace vineyard {
 
@@ -48,7 +49,7 @@ using Signature = uint64_t;
 using InstanceID = uint64_t;
 
 // blob id: 1 + memory address (in vineyardd)
-// non-blob id: 0 + random (rdstc)
+// non-blob id: 0 + sequence + tag, see GenerateObjectID
 
 inline void* GetBlobAddr(ObjectID const id) {
   return (id & 0x8000000000000000UL)
@@ -66,23 +67,35 @@ inline ObjectID GenerateBlobID(const uintptr_t ptr) {
 
 constexpr inline ObjectID EmptyBlobID() { return 0x8000000000000000UL; }
 
-inline ObjectID GenerateObjectID() {
-#if defined(__x86_64__)
-  return 0x7FFFFFFFFFFFFFFFUL & static_cast<uint64_t>(__rdtsc());
-#else
-  return 0x7FFFFFFFFFFFFFFFUL &
-         static_cast<uint64_t>(rand());  // NOLINT(runtime/threadsafe_fn)
-#endif
-}
+/**
+ * @brief Generate the id of a non-blob object, it is collision-free, and is
+ * time-ordered across the blocks of ids that are reserved by the threads.
+ *
+ * An id is made up of, from the highest bit to the lowest:
+ *
+ *    | 0 | 50 bits sequence | 13 bits tag |
+ *
+ * where the sequence is the milliseconds since 2021-01-01 followed by a
+ * 10-bit counter, and the tag is the instance id, see `SetObjectIDTag`. Each
+ * thread reserves a block of sequences at a time, thus generating an id takes
+ * neither a lock nor an atomic read-modify-write. The sequences run ahead of
+ * the clock when more than 1024 ids are generated in a millisecond.
+ */
+ObjectID GenerateObjectID();
 
-inline ObjectID GenerateSignature() {
-#if defined(__x86_64__)
-  return 0x7FFFFFFFFFFFFFFFUL & static_cast<uint64_t>(__rdtsc());
-#else
-  return 0x7FFFFFFFFFFFFFFFUL &
-         static_cast<uint64_t>(rand());  // NOLINT(runtime/threadsafe_fn)
-#endif
-}
+/**
+ * @brief Reserve the ids for a batch of objects at once, e.g., to assign the
+ * ids to the members of a batch builder locally.
+ */
+std::vector<ObjectID> GenerateObjectIDs(size_t const count);
+
+Signature GenerateSignature();
+
+/**
+ * @brief Set the tag of the generated ids, which distinguishes the ids
+ * generated by different instances. The tag is random until it is set.
+ */
+void SetObjectIDTag(InstanceID const tag);
 
 inline bool IsBlob(ObjectID id) { return id & 0x8000000000000000UL; }
 
@@ -125,6 +138,15 @@ inline Signature SignatureFromString(const char* s) {
   return strtoull(s + 1, nullptr, 16);
 }
 
+/**
+ * @brief A name that is scoped to the owner object. When the owner is deleted,
+ * the name is dropped, and the object that the name is associated with is
+ * deleted as well.
+ */
+inline std::string ScopedName(const ObjectID owner, const std::string& name) {
+  return "__scoped." + ObjectIDToString(owner) + "." + name;
+}
+
 inline ObjectID InvalidObjectID() {
   return std::numeric_limits<ObjectID>::max();
 }
@@ -99,6 +99,16 @@ void IPCServer::doAccept() {
   if (!acceptor_.is_open()) {
     return;
   }
+  // accepts the next connection on the ipc threads, or a shard when serving
+  // with io shards
+#if BOOST_VERSION >= 107000
+  // the handlers of a connection are serialized on a strand, as the context
+  // may be run by many threads
+  socket_ = asio::local::stream_protocol::socket(
+      asio::make_strand(vs_ptr_->GetIPCContext()));
+#else
+  socket_ = asio::local::stream_protocol::socket(vs_ptr_->GetIPCContext());
+#endif
   acceptor_.async_accept(socket_, [this](boost::system::error_code ec) {
     if (!ec) {
       std::shared_ptr<SocketConnection> conn =
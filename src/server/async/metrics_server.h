@@ -0,0 +1,66 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_ASYNC_METRICS_SERVER_H_
+#define SRC_SERVER_ASYNC_METRICS_SERVER_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "boost/asio.hpp"
+
+#include "server/server/vineyard_server.h"
+
+namespace vineyard {
+
+namespace asio = boost::asio;
+
+/**
+ * @brief MetricsServer serves the metrics of vineyard server over HTTP in the
+ * prometheus text format, every request gets the same response regardless
+ * of the path.
+ */
+class MetricsServer {
+ public:
+  MetricsServer(vs_ptr_t vs_ptr, const uint32_t port);
+
+  ~MetricsServer();
+
+  /**
+   * @brief Listen on the port and start to accept requests, fails if the
+   * port cannot be bound.
+   */
+  Status Start();
+
+  void Stop();
+
+ private:
+  void doAccept();
+
+  void doServe(std::shared_ptr<asio::ip::tcp::socket> socket);
+
+  std::string dumpMetrics();
+
+  vs_ptr_t vs_ptr_;
+  const uint32_t port_;
+  asio::ip::tcp::acceptor acceptor_;
+  asio::ip::tcp::socket socket_;
+  std::atomic_bool stopped_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_ASYNC_METRICS_SERVER_H_
@@ -67,6 +67,15 @@ void RPCServer::doAccept() {
   if (!acceptor_.is_open()) {
     return;
   }
+  // accepts the next connection on the rpc threads, or a shard when serving
+  // with io shards
+#if BOOST_VERSION >= 107000
+  // the handlers of a connection are serialized on a strand, as the context
+  // may be run by many threads
+  socket_ = asio::ip::tcp::socket(asio::make_strand(vs_ptr_->GetRPCContext()));
+#else
+  socket_ = asio::ip::tcp::socket(vs_ptr_->GetRPCContext());
+#endif
   acceptor_.async_accept(socket_, [this](boost::system::error_code ec) {
     if (!ec) {
       std::shared_ptr<SocketConnection> conn =
@@ -15,6 +15,13 @@ limitations under the License.
 
 #include "server/async/socket_server.h"
 
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
 #include <limits>
 #include <memory>
 #include <string>
@@ -23,19 +30,58 @@ limitations under the License.
 
 #include "common/memory/fling.h"
 #include "common/util/callback.h"
+#include "common/util/compression.h"
 #include "common/util/functions.h"
 #include "common/util/json.h"
+#include "common/util/trace.h"
+#include "server/memory/numa.h"
 #include "server/util/metrics.h"
+#include "server/util/profiler.h"
 
 namespace vineyard {
 
+// the max capacity of the request ring, see also the limit of messages
+static constexpr size_t kMaxRingCapacity = 64 * 1024 * 1024;
+
+// the max number of payloads and bytes sent by a single vectored write
+static constexpr size_t kMaxWriteBuffers = 1024;
+static constexpr size_t kMaxWriteBytes = 64 * 1024 * 1024;
+// the writes of batch connections are smaller, as they are paced
+static constexpr size_t kMaxBatchWriteBytes = 4 * 1024 * 1024;
+// the buffers of the written messages that are kept for the later replies
+static constexpr size_t kMaxSpareMessages = 8;
+static constexpr size_t kMaxSpareMessageBytes = 1024 * 1024;
+
+// finds the next chunk to compress from the `index`-th payload at `offset`,
+// and advances them past the chunk
+static bool nextCompressionChunk(
+    std::vector<std::shared_ptr<Payload>> const& objects, size_t& index,
+    size_t& offset, const uint8_t*& data, size_t& size) {
+  while (index < objects.size() &&
+         offset >= static_cast<size_t>(objects[index]->data_size)) {
+    index += 1;
+    offset = 0;
+  }
+  if (index >= objects.size()) {
+    return false;
+  }
+  data = objects[index]->pointer + offset;
+  size = std::min(kCompressionChunkSize,
+                  static_cast<size_t>(objects[index]->data_size) - offset);
+  offset += size;
+  return true;
+}
+
 SocketConnection::SocketConnection(stream_protocol::socket socket,
                                    vs_ptr_t server_ptr,
                                    SocketServer* socket_server_ptr, int conn_id)
     : socket_(std::move(socket)),
       server_ptr_(server_ptr),
       socket_server_ptr_(socket_server_ptr),
-      conn_id_(conn_id) {}
+      conn_id_(conn_id) {
+  numa_aware_ = server_ptr_->GetSpec()["bulkstore_spec"].value("numa_aware",
+                                                               false);
+}
 
 bool SocketConnection::Start() {
   running_.store(true);
@@ -52,8 +98,19 @@ bool SocketConnection::Stop() {
 
   // do cleanup: clean up streams associated with this client
   for (auto stream_id : associated_streams_) {
-    VINEYARD_SUPPRESS(server_ptr_->GetStreamStore()->Drop(stream_id));
+    VINEYARD_SUPPRESS(server_ptr_->GetStreamStore()->Drop(stream_id, conn_id_));
   }
+  // release blobs that used by this client
+  for (auto blob_id : used_blobs_) {
+    VINEYARD_SUPPRESS(server_ptr_->GetBulkStore()->Unref(blob_id));
+  }
+  used_blobs_.clear();
+  // drop the remote buffers that haven't been finished
+  for (auto const& item : streaming_buffers_) {
+    VINEYARD_SUPPRESS(server_ptr_->GetBulkStore()->Unref(item.first));
+    VINEYARD_DISCARD(server_ptr_->GetBulkStore()->Delete(item.first));
+  }
+  streaming_buffers_.clear();
 
   // On Mac the state of socket may be "not connected" after the client has
   // already closed the socket, hence there will be an exception.
@@ -103,11 +160,36 @@ void SocketConnection::doReadBody() {
                        doStop();
                        return;
                      }
+                     if (payload_pending_) {
+                       // resumed by the handler that completes reading the
+                       // payload, which runs on the same strand after this
+                       // handler returns
+                       return;
+                     }
+                     if (batch_ != nullptr) {
+                       // resumed when the batch finishes, so that the
+                       // replies of the batch won't interleave with others
+                       batch_->reading_deferred = true;
+                       return;
+                     }
                      // start next-round read
-                     doReadHeader();
+                     if (qos_class_ == QoSClass::Batch) {
+                       // yields to the handlers that are ready on the shard
+                       asio::post(socket_.get_executor(),
+                                  [this, self]() { doReadHeader(); });
+                     } else {
+                       doReadHeader();
+                     }
                    });
 }
 
+void SocketConnection::resumeReading() {
+  if (payload_pending_) {
+    payload_pending_ = false;
+    doReadHeader();
+  }
+}
+
 #ifndef __REPORT_JSON_ERROR
 #ifndef NDEBUG
 #define __REPORT_JSON_ERROR(err, data) \
@@ -168,13 +250,31 @@ void SocketConnection::doReadBody() {
 
 bool SocketConnection::processMessage(const std::string& message_in) {
   json root;
-  std::istringstream is(message_in);
 
   // DON'T let vineyardd crash when the client is malicious.
-  TRY_READ_FROM_JSON(root = json::parse(message_in), message_in);
+  TRY_READ_FROM_JSON(root = DecodeMessage(message_in), message_in);
+  // replies to the hot commands are encoded in the negotiated format
+  WireFormatScope wire_format_scope(wire_format_);
+#if defined(WITH_TRACING)
+  auto trace_id = root.find("trace_id");
+  auto type = root.find("type");
+  if (type != root.end() && type->is_string()) {
+    TraceIDScope trace_id_scope(
+        (trace_id != root.end() && trace_id->is_number_unsigned())
+            ? trace_id->get<uint64_t>()
+            : 0);
+    TraceSpan span(Tracer::InternName(type->get_ref<std::string const&>()));
+    return processCommand(root);
+  }
+#endif
+  return processCommand(root);
+}
 
+bool SocketConnection::processCommand(const json& root) {
   std::string const& type = root["type"].get_ref<std::string const&>();
   CommandType cmd = ParseCommandType(type);
+  ServerMetrics::RequestScope metrics_scope(server_ptr_->GetMetrics(),
+                                            &request_stats_, cmd, type);
   switch (cmd) {
   case CommandType::RegisterRequest: {
     return doRegister(root);
@@ -188,18 +288,48 @@ bool SocketConnection::processMessage(const std::string& message_in) {
   case CommandType::CreateBufferRequest: {
     return doCreateBuffer(root);
   }
+  case CommandType::CreateDeviceBufferRequest: {
+    return doCreateDeviceBuffer(root);
+  }
   case CommandType::CreateRemoteBufferRequest: {
     return doCreateRemoteBuffer(root);
   }
+  case CommandType::CreateCopyOnWriteBufferRequest: {
+    return doCreateCopyOnWriteBuffer(root);
+  }
+  case CommandType::SealBufferRequest: {
+    return doSealBuffer(root);
+  }
+  case CommandType::RemoteBufferChunkRequest: {
+    return doRemoteBufferChunk(root);
+  }
+  case CommandType::SealRemoteBufferRequest: {
+    return doSealRemoteBuffer(root);
+  }
   case CommandType::DropBufferRequest: {
     return doDropBuffer(root);
   }
+  case CommandType::GetCachedBuffersRequest: {
+    return doGetCachedBuffers(root);
+  }
+  case CommandType::CacheBuffersRequest: {
+    return doCacheBuffers(root);
+  }
+  case CommandType::SubscribeInvalidationRequest: {
+    return doSubscribeInvalidation(root);
+  }
   case CommandType::GetDataRequest: {
     return doGetData(root);
   }
   case CommandType::ListDataRequest: {
     return doListData(root);
   }
+  case CommandType::ListDataPageRequest: {
+    return doListDataPage(root);
+  }
+  case CommandType::PrefetchRequest: {
+    return doPrefetch(root);
+  }
   case CommandType::CreateDataRequest: {
     return doCreateData(root);
   }
@@ -209,6 +339,12 @@ bool SocketConnection::processMessage(const std::string& message_in) {
   case CommandType::IfPersistRequest: {
     return doIfPersist(root);
   }
+  case CommandType::WaitPersistRequest: {
+    return doWaitPersist(root);
+  }
+  case CommandType::LeaseRequest: {
+    return doLease(root);
+  }
   case CommandType::ExistsRequest: {
     return doExists(root);
   }
@@ -257,6 +393,12 @@ bool SocketConnection::processMessage(const std::string& message_in) {
   case CommandType::InstanceStatusRequest: {
     return doInstanceStatus(root);
   }
+  case CommandType::MemoryAttributionRequest: {
+    return doMemoryAttribution(root);
+  }
+  case CommandType::CheckpointRequest: {
+    return doCheckpoint(root);
+  }
   case CommandType::MakeArenaRequest: {
     return doMakeArena(root);
   }
@@ -269,6 +411,12 @@ bool SocketConnection::processMessage(const std::string& message_in) {
   case CommandType::DebugCommand: {
     return doDebug(root);
   }
+  case CommandType::BatchRequest: {
+    return doBatch(root);
+  }
+  case CommandType::RingDoorbell: {
+    return doRingDoorbell(root);
+  }
   case CommandType::ExitRequest: {
     return true;
   }
@@ -282,21 +430,84 @@ bool SocketConnection::processMessage(const std::string& message_in) {
 bool SocketConnection::doRegister(const json& root) {
   auto self(shared_from_this());
   std::string client_version, message_out;
-  TRY_READ_REQUEST(ReadRegisterRequest, root, client_version);
+  WireFormat wire_format;
+  size_t ring_capacity = 0;
+  QoSClass qos_class = QoSClass::Interactive;
+  std::vector<int> held_fds;
+  std::string session;
+  TRY_READ_REQUEST(ReadRegisterRequest, root, client_version, wire_format,
+                   ring_capacity, qos_class, held_fds, session);
+  // accepts the binary format when the client asks for it
+  wire_format_ = wire_format;
+  qos_class_ = qos_class;
+  // the fds that the client (forked from another one) has already received
+  used_fds_.insert(held_fds.begin(), held_fds.end());
+  if (!session.empty()) {
+    session_ = std::make_shared<const std::string>(session);
+  }
+  // sets up the request ring for co-located clients
+  int ring_fd = -1;
+  if (ring_capacity > 0) {
+    ring_capacity = std::min(ring_capacity, kMaxRingCapacity);
+    Status status = Status::Invalid("ring is only available for IPC clients");
+    if (ring_ == nullptr &&
+        socket_.local_endpoint().protocol().family() == AF_UNIX) {
+      status = memory::RequestRing::Create(ring_capacity, ring_fd, ring_);
+    }
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to setup the request ring: " << status.ToString();
+      ring_capacity = 0;
+    } else {
+      // the server waits for the doorbell at the beginning
+      ring_->requests().SetWaiting();
+    }
+  }
   WriteRegisterReply(server_ptr_->IPCSocket(), server_ptr_->RPCEndpoint(),
-                     server_ptr_->instance_id(), message_out);
-  doWrite(message_out);
+                     server_ptr_->instance_id(), wire_format_, ring_capacity,
+                     server_ptr_->GetBulkStore()->DeduplicationEnabled(),
+                     message_out);
+  if (ring_fd == -1) {
+    doWrite(message_out);
+  } else {
+    doWrite(message_out, [self, ring_fd](const Status& status) {
+      send_fd(self->nativeHandle(), ring_fd);
+      close(ring_fd);
+      return Status::OK();
+    });
+  }
   return false;
 }
 
 bool SocketConnection::doGetBuffers(const json& root) {
   auto self(shared_from_this());
   std::vector<ObjectID> ids;
+  bool batch_fds = false;
   std::vector<std::shared_ptr<Payload>> objects;
   std::string message_out;
 
-  TRY_READ_REQUEST(ReadGetBuffersRequest, root, ids);
+  TRY_READ_REQUEST(ReadGetBuffersRequest, root, ids, batch_fds);
+  refBlobs(ids);
   RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->Get(ids, objects));
+
+  if (batch_fds) {
+    // pass all unseen segments with a single message, the client learns
+    // which fds to expect (and in which order) from the reply.
+    std::vector<int> fds_to_send;
+    for (auto const& object : objects) {
+      collectUnseenFds(object, fds_to_send);
+    }
+    WriteGetBuffersReply(objects, fds_to_send, message_out);
+    this->doWrite(message_out, [self, fds_to_send = std::move(fds_to_send)](
+                                   const Status& status) {
+      if (!fds_to_send.empty()) {
+        send_fds(self->nativeHandle(), fds_to_send.data(),
+                 static_cast<int>(fds_to_send.size()));
+      }
+      return Status::OK();
+    });
+    return false;
+  }
+
   WriteGetBuffersReply(objects, message_out);
 
   /* NOTE: Here we send the file descriptor after the objects.
@@ -310,33 +521,167 @@ bool SocketConnection::doGetBuffers(const json& root) {
    *       We will examine other methods later, such as using
    *       explicit file descritors.
    */
-  this->doWrite(message_out, [self, objects](const Status& status) {
-    for (auto object : objects) {
-      int store_fd = object->store_fd;
-      int data_size = object->data_size;
-      if (data_size > 0 &&
-          self->used_fds_.find(store_fd) == self->used_fds_.end()) {
-        self->used_fds_.emplace(store_fd);
-        send_fd(self->nativeHandle(), store_fd);
-      }
+  this->doWrite(message_out, [self, objects = std::move(objects)](
+                                 const Status& status) {
+    std::vector<int> fds_to_send;
+    for (auto const& object : objects) {
+      self->collectUnseenFds(object, fds_to_send);
+    }
+    for (int const fd : fds_to_send) {
+      send_fd(self->nativeHandle(), fd);
     }
     return Status::OK();
   });
   return false;
 }
 
-void SocketConnection::sendBufferHelper(
-    std::vector<std::shared_ptr<Payload>> const objects, size_t index,
-    boost::system::error_code const ec, callback_t<> callback_after_finish) {
+pid_t SocketConnection::peerPid() {
+  if (peer_pid_ == 0) {
+    // not a UNIX-domain socket, e.g., the RPC connections
+    peer_pid_ = -1;
+#if defined(__linux__) && defined(SO_PEERCRED)
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    if (getsockopt(nativeHandle(), SOL_SOCKET, SO_PEERCRED, &cred, &len) ==
+            0 &&
+        cred.pid > 0) {
+      peer_pid_ = cred.pid;
+    }
+#endif
+  }
+  return peer_pid_;
+}
+
+int SocketConnection::peerNumaNode() {
+  auto now = std::chrono::steady_clock::now();
+  if (now < peer_numa_node_expiry_) {
+    return peer_numa_node_;
+  }
+  pid_t pid = peerPid();
+  peer_numa_node_ = pid > 0 ? memory::numa_node_of_process(pid) : -1;
+  peer_numa_node_expiry_ = now + std::chrono::seconds(1);
+  return peer_numa_node_;
+}
+
+std::shared_ptr<const std::string> const& SocketConnection::peerOwner() {
+  if (peer_owner_ == nullptr) {
+    pid_t pid = peerPid();
+    if (pid > 0) {
+      std::string comm;
+      std::ifstream is("/proc/" + std::to_string(pid) + "/comm");
+      if (!std::getline(is, comm) || comm.empty()) {
+        comm = "unknown";
+      }
+      peer_owner_ = std::make_shared<const std::string>(
+          comm + ":" + std::to_string(pid));
+    } else {
+      peer_owner_ = std::make_shared<const std::string>(
+          "connection:" + std::to_string(conn_id_));
+    }
+  }
+  return peer_owner_;
+}
+
+void SocketConnection::refBlobs(std::vector<ObjectID> const& ids) {
+  for (auto const id : ids) {
+    if (used_blobs_.find(id) == used_blobs_.end() &&
+        server_ptr_->GetBulkStore()->Ref(id).ok()) {
+      used_blobs_.emplace(id);
+    }
+  }
+}
+
+void SocketConnection::collectUnseenFds(std::shared_ptr<Payload> const& object,
+                                        std::vector<int>& fds) {
+  if (object->data_size == 0 || object->IsDevice()) {
+    return;
+  }
+  auto collect = [this, &fds](int const fd) {
+    if (used_fds_.find(fd) == used_fds_.end()) {
+      used_fds_.emplace(fd);
+      fds.emplace_back(fd);
+    }
+  };
+  if (object->IsCopyOnWrite()) {
+    for (auto const& extent : object->extents) {
+      collect(extent.fd);
+    }
+  } else {
+    collect(object->store_fd);
+  }
+}
+
+void SocketConnection::sendBufferHelper(payloads_t const& objects,
+                                        size_t index,
+                                        boost::system::error_code const ec,
+                                        callback_t<> callback_after_finish) {
   auto self(shared_from_this());
-  if (!ec && index < objects.size()) {
-    async_write(
-        socket_,
-        boost::asio::buffer(objects[index]->pointer, objects[index]->data_size),
-        [this, self, callback_after_finish, objects, index](
-            boost::system::error_code ec, std::size_t) {
-          sendBufferHelper(objects, index + 1, ec, callback_after_finish);
+  auto const& uring_sender = socket_server_ptr_->GetUringSender();
+  bool const batch = qos_class_ == QoSClass::Batch;
+  if (!ec && index == 0 && uring_sender && !batch) {
+    // submits all buffers at once, and completes on the socket's executor
+    UringSender::buffers_t buffers;
+    for (auto const& object : *objects) {
+      if (object->data_size > 0) {
+        buffers.emplace_back(object->pointer, object->data_size);
+      }
+    }
+    uring_sender->Send(
+        socket_.native_handle(), buffers,
+        [this, self, objects, callback_after_finish](const Status& status) {
+          asio::post(socket_.get_executor(),
+                     [self, status, callback_after_finish]() {
+                       VINEYARD_DISCARD(callback_after_finish(status));
+                     });
+          return Status::OK();
         });
+    return;
+  }
+  if (!ec && index < objects->size()) {
+    // gathers the following payloads into one write, bounded by the budget
+    auto const& payloads = *objects;
+    std::vector<asio::const_buffer> buffers;
+    size_t next = index, bytes = 0;
+    size_t const budget = batch ? kMaxBatchWriteBytes : kMaxWriteBytes;
+    while (next < payloads.size() && buffers.size() < kMaxWriteBuffers &&
+           (bytes == 0 || bytes + payloads[next]->data_size <= budget)) {
+      if (payloads[next]->data_size > 0) {
+        buffers.emplace_back(payloads[next]->pointer,
+                             payloads[next]->data_size);
+        bytes += payloads[next]->data_size;
+      }
+      next += 1;
+    }
+    if (!batch) {
+      async_write(socket_, buffers,
+                  [this, self, callback_after_finish, objects, next](
+                      boost::system::error_code ec, std::size_t) {
+                    sendBufferHelper(objects, next, ec, callback_after_finish);
+                  });
+      return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    async_write(socket_, buffers, [this, self, callback_after_finish, objects,
+                                   next, start](boost::system::error_code ec,
+                                                std::size_t) {
+      double share = socket_server_ptr_->BatchBandwidthShare();
+      if (ec || share >= 1.0 ||
+          socket_server_ptr_->InteractiveSends().load() == 0) {
+        sendBufferHelper(objects, next, ec, callback_after_finish);
+        return;
+      }
+      // leaves the rest of the time to the interactive sends
+      auto elapsed = std::chrono::steady_clock::now() - start;
+      auto timer = std::make_shared<asio::steady_timer>(
+          socket_.get_executor(),
+          std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              elapsed * ((1.0 - share) / share)));
+      timer->async_wait([this, self, callback_after_finish, objects, next,
+                         timer](const boost::system::error_code&) {
+        sendBufferHelper(objects, next, boost::system::error_code(),
+                         callback_after_finish);
+      });
+    });
   } else {
     if (ec) {
       VINEYARD_DISCARD(callback_after_finish(Status::IOError(
@@ -347,25 +692,229 @@ void SocketConnection::sendBufferHelper(
   }
 }
 
+void SocketConnection::sendCompressedBufferHelper(
+    payloads_t const& objects, std::string const& compression, size_t index,
+    size_t offset, std::shared_ptr<std::string> frame,
+    callback_t<> callback_after_finish) {
+  auto self(shared_from_this());
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+  if (frame == nullptr) {
+    frame = std::make_shared<std::string>();
+    if (nextCompressionChunk(*objects, index, offset, data, size)) {
+      auto status = CompressFrame(compression, data, size, *frame);
+      if (!status.ok()) {
+        VINEYARD_DISCARD(callback_after_finish(status));
+        return;
+      }
+    }
+  }
+  if (frame->empty()) {
+    VINEYARD_DISCARD(callback_after_finish(Status::OK()));
+    return;
+  }
+
+  struct Progress {
+    std::atomic<int> pending{2};
+    boost::system::error_code ec;
+    Status status;
+    std::shared_ptr<std::string> frame = std::make_shared<std::string>();
+  };
+  auto progress = std::make_shared<Progress>();
+  bool const has_next =
+      nextCompressionChunk(*objects, index, offset, data, size);
+  // continues when both the write and the compression are finished
+  auto step = [this, self, objects, compression, index, offset, progress,
+               callback_after_finish]() {
+    if (progress->pending.fetch_sub(1) != 1) {
+      return;
+    }
+    asio::post(socket_.get_executor(), [this, self, objects, compression,
+                                        index, offset, progress,
+                                        callback_after_finish]() {
+      if (progress->ec) {
+        VINEYARD_DISCARD(callback_after_finish(Status::IOError(
+            "Failed to write buffer to client: " + progress->ec.message())));
+      } else if (!progress->status.ok()) {
+        VINEYARD_DISCARD(callback_after_finish(progress->status));
+      } else {
+        sendCompressedBufferHelper(objects, compression, index, offset,
+                                   progress->frame, callback_after_finish);
+      }
+    });
+  };
+  async_write(socket_, asio::buffer(*frame),
+              [frame, progress, step](boost::system::error_code ec,
+                                      std::size_t) {
+                progress->ec = ec;
+                step();
+              });
+  asio::post(server_ptr_->GetContext(),
+             [compression, has_next, data, size, progress, step]() {
+               if (has_next) {
+                 progress->status =
+                     CompressFrame(compression, data, size, *progress->frame);
+               }
+               step();
+             });
+}
+
+void SocketConnection::receiveCompressedBufferHelper(
+    std::shared_ptr<Payload> const object, std::string const compression,
+    size_t offset, size_t const end, callback_t<> callback_after_finish) {
+  auto self(shared_from_this());
+  if (offset >= end) {
+    VINEYARD_DISCARD(callback_after_finish(Status::OK()));
+    return;
+  }
+  auto header = std::make_shared<CompressionFrameHeader>();
+  asio::async_read(
+      socket_, asio::buffer(header.get(), sizeof(CompressionFrameHeader)),
+      [this, self, object, compression, offset, end, header,
+       callback_after_finish](boost::system::error_code ec, std::size_t) {
+        if (ec) {
+          VINEYARD_DISCARD(callback_after_finish(Status::IOError(
+              "Failed to read buffer's content from client: " +
+              ec.message())));
+          return;
+        }
+        if (header->content_size == 0 ||
+            header->content_size > std::min(end - offset,
+                                            kCompressionChunkSize) ||
+            header->compressed_size > header->content_size) {
+          VINEYARD_DISCARD(callback_after_finish(
+              Status::IOError("Invalid compressed frame from client")));
+          return;
+        }
+        uint8_t* target = object->pointer + offset;
+        size_t const next = offset + header->content_size;
+        if (header->compressed_size == header->content_size) {
+          asio::async_read(
+              socket_, asio::buffer(target, header->content_size),
+              [this, self, object, compression, next, end,
+               callback_after_finish](boost::system::error_code ec,
+                                      std::size_t) {
+                if (ec) {
+                  VINEYARD_DISCARD(callback_after_finish(Status::IOError(
+                      "Failed to read buffer's content from client: " +
+                      ec.message())));
+                  return;
+                }
+                receiveCompressedBufferHelper(object, compression, next, end,
+                                              callback_after_finish);
+              });
+          return;
+        }
+        auto payload = std::make_shared<std::string>();
+        payload->resize(header->compressed_size);
+        asio::async_read(
+            socket_, asio::buffer(&(*payload)[0], payload->size()),
+            [this, self, object, compression, next, end, header, payload,
+             target, callback_after_finish](boost::system::error_code ec,
+                                            std::size_t) {
+              Status status;
+              if (ec) {
+                status = Status::IOError(
+                    "Failed to read buffer's content from client: " +
+                    ec.message());
+              } else {
+                status = DecompressFrame(
+                    compression, *header,
+                    reinterpret_cast<const uint8_t*>(payload->data()), target);
+              }
+              if (!status.ok()) {
+                VINEYARD_DISCARD(callback_after_finish(status));
+                return;
+              }
+              receiveCompressedBufferHelper(object, compression, next, end,
+                                            callback_after_finish);
+            });
+      });
+}
+
 bool SocketConnection::doGetRemoteBuffers(const json& root) {
   auto self(shared_from_this());
   std::vector<ObjectID> ids;
+  std::vector<std::pair<size_t, size_t>> ranges;
+  std::string compression;
   std::vector<std::shared_ptr<Payload>> objects;
   std::string message_out;
 
-  TRY_READ_REQUEST(ReadGetBuffersRequest, root, ids);
-  RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->Get(ids, objects));
-  WriteGetBuffersReply(objects, message_out);
+  TRY_READ_REQUEST(ReadGetRemoteBuffersRequest, root, ids, ranges,
+                   compression);
+  // pin the blobs until the content has been sent out
+  for (auto const id : ids) {
+    VINEYARD_SUPPRESS(server_ptr_->GetBulkStore()->Ref(id));
+  }
+  auto status = server_ptr_->GetBulkStore()->Get(ids, objects);
+  for (auto const& object : objects) {
+    if (status.ok() && object->IsDevice()) {
+      status = Status::Invalid(
+          "Blobs in device memory can't be transferred to remote: " +
+          ObjectIDToString(object->object_id));
+    }
+  }
+  if (!status.ok()) {
+    for (auto const id : ids) {
+      VINEYARD_SUPPRESS(server_ptr_->GetBulkStore()->Unref(id));
+    }
+  }
+  RESPONSE_ON_ERROR(status);
+
+  // only the requested ranges of the blobs will be sent
+  auto contents = std::make_shared<std::vector<std::shared_ptr<Payload>>>(
+      objects);
+  for (size_t idx = 0; idx < ranges.size(); ++idx) {
+    size_t size = static_cast<size_t>(objects[idx]->data_size);
+    size_t offset = std::min(ranges[idx].first, size);
+    auto content = std::make_shared<Payload>(*objects[idx]);
+    content->pointer += offset;
+    content->data_size = std::min(ranges[idx].second, size - offset);
+    (*contents)[idx] = content;
+  }
+  size_t total = 0;
+  for (auto const& content : *contents) {
+    total += content->data_size;
+  }
+  if (!IsCompressionSupported(compression) || total < kCompressionThreshold) {
+    compression.clear();
+  }
+  WriteGetBuffersReply(objects, compression, message_out);
 
-  this->doWrite(message_out, [this, self, objects](const Status& status) {
-    boost::system::error_code ec;
-    sendBufferHelper(objects, 0, ec, [self](const Status& status) {
-      if (!status.ok()) {
-        LOG(ERROR) << "Failed to send buffers to remote client: "
-                   << status.ToString();
-      }
+  bool const interactive = qos_class_ == QoSClass::Interactive;
+  if (interactive) {
+    socket_server_ptr_->InteractiveSends().fetch_add(1);
+  }
+  callback_t<> callback_after_finish = [self, ids,
+                                        interactive](const Status& status) {
+    if (interactive) {
+      self->socket_server_ptr_->InteractiveSends().fetch_sub(1);
+    }
+    for (auto const id : ids) {
+      VINEYARD_SUPPRESS(self->server_ptr_->GetBulkStore()->Unref(id));
+    }
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to send buffers to remote client: "
+                 << status.ToString();
+      self->doStop();
       return Status::OK();
-    });
+    }
+    // the following messages are written after the payloads
+    self->resumeWrites();
+    return Status::OK();
+  };
+  payloads_t payloads = std::move(contents);
+  this->doWrite(message_out, [this, self, payloads, compression,
+                              callback_after_finish](const Status& status) {
+    // the payloads own the socket until they have been written
+    suspendWrites();
+    if (compression.empty()) {
+      boost::system::error_code ec;
+      sendBufferHelper(payloads, 0, ec, callback_after_finish);
+    } else {
+      sendCompressedBufferHelper(payloads, compression, 0, 0, nullptr,
+                                 callback_after_finish);
+    }
     return Status::OK();
   });
   return false;
@@ -374,13 +923,21 @@ bool SocketConnection::doGetRemoteBuffers(const json& root) {
 bool SocketConnection::doCreateBuffer(const json& root) {
   auto self(shared_from_this());
   size_t size;
+  int numa_node = -1;
+  bool prefault = false;
   std::shared_ptr<Payload> object;
   std::string message_out;
 
-  TRY_READ_REQUEST(ReadCreateBufferRequest, root, size);
+  TRY_READ_REQUEST(ReadCreateBufferRequest, root, size, numa_node, prefault);
+  if (numa_node < 0 && numa_aware_) {
+    numa_node = peerNumaNode();
+  }
   ObjectID object_id;
   RESPONSE_ON_ERROR(
-      server_ptr_->GetBulkStore()->Create(size, object_id, object));
+      server_ptr_->GetBulkStore()->Create(size, object_id, object, numa_node,
+                                          prefault, session_));
+  object->owner = peerOwner();
+  refBlobs({object_id});
   WriteCreateBufferReply(object_id, object, message_out);
 
   int store_fd = object->store_fd;
@@ -399,45 +956,248 @@ bool SocketConnection::doCreateBuffer(const json& root) {
   return false;
 }
 
+bool SocketConnection::doCreateDeviceBuffer(const json& root) {
+  auto self(shared_from_this());
+  size_t size;
+  int device = -1;
+  std::shared_ptr<Payload> object;
+  std::string message_out;
+
+  TRY_READ_REQUEST(ReadCreateDeviceBufferRequest, root, size, device);
+  ObjectID object_id;
+  RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->CreateDevice(
+      size, device, object_id, object));
+  object->owner = peerOwner();
+  refBlobs({object_id});
+  // the device memory is shared by the IPC handle in the payload, no fd
+  WriteCreateBufferReply(object_id, object, message_out);
+  this->doWrite(message_out);
+  return false;
+}
+
 bool SocketConnection::doCreateRemoteBuffer(const json& root) {
   auto self(shared_from_this());
   size_t size;
+  std::string compression;
+  bool stream = false;
   std::shared_ptr<Payload> object;
 
-  TRY_READ_REQUEST(ReadCreateBufferRequest, root, size);
+  TRY_READ_REQUEST(ReadCreateRemoteBufferRequest, root, size, compression,
+                   stream);
+  if (!compression.empty() && !IsCompressionSupported(compression)) {
+    RESPONSE_ON_ERROR(
+        Status::NotImplemented("Unsupported compression: " + compression));
+  }
   ObjectID object_id;
   RESPONSE_ON_ERROR(
       server_ptr_->GetBulkStore()->Create(size, object_id, object));
+  object->owner = peerOwner();
+  // pin the blob until the content has been received
+  VINEYARD_SUPPRESS(server_ptr_->GetBulkStore()->Ref(object_id));
+
+  if (stream) {
+    streaming_buffers_.emplace(object_id, object);
+    std::string message_out;
+    WriteCreateBufferReply(object_id, object, message_out);
+    this->doWrite(message_out);
+    return false;
+  }
+
+  callback_t<> callback_after_finish = [this, self,
+                                        object](const Status& status) {
+    VINEYARD_SUPPRESS(server_ptr_->GetBulkStore()->Unref(object->object_id));
+    std::string message_out;
+    if (status.ok()) {
+      WriteCreateBufferReply(object->object_id, object, message_out);
+    } else {
+      VINEYARD_DISCARD(server_ptr_->GetBulkStore()->Delete(object->object_id));
+      WriteErrorReply(status, message_out);
+    }
+    self->doWrite(message_out);
+    self->resumeReading();
+    LOG_SUMMARY("instances_memory_usage_bytes", server_ptr_->instance_id(),
+                server_ptr_->GetBulkStore()->Footprint());
+    return Status::OK();
+  };
 
+  if (size == 0) {
+    VINEYARD_DISCARD(callback_after_finish(Status::OK()));
+    return false;
+  }
+  // the next message follows the content
+  payload_pending_ = true;
+  if (!compression.empty()) {
+    receiveCompressedBufferHelper(object, compression, 0, size,
+                                  callback_after_finish);
+    return false;
+  }
   asio::async_read(
       socket_, asio::buffer(object->pointer, size),
-      [this, self, &object](boost::system::error_code ec, std::size_t size) {
-        std::string message_out;
+      [object, callback_after_finish](boost::system::error_code ec,
+                                      std::size_t size) {
         if (static_cast<size_t>(object->data_size) == size &&
             (!ec || ec == asio::error::eof)) {
-          WriteCreateBufferReply(object->object_id, object, message_out);
+          VINEYARD_DISCARD(callback_after_finish(Status::OK()));
+        } else if (static_cast<size_t>(object->data_size) == size) {
+          VINEYARD_DISCARD(callback_after_finish(
+              Status::IOError("Failed to read buffer's content from client")));
         } else {
           VINEYARD_DISCARD(
-              server_ptr_->GetBulkStore()->Delete(object->object_id));
-          if (static_cast<size_t>(object->data_size) == size) {
-            WriteErrorReply(
-                Status::IOError("Failed to read buffer's content from client"),
-                message_out);
-          } else {
-            WriteErrorReply(Status::IOError(ec.message()), message_out);
-          }
+              callback_after_finish(Status::IOError(ec.message())));
+        }
+      });
+  return false;
+}
+
+bool SocketConnection::doCreateCopyOnWriteBuffer(const json& root) {
+  auto self(shared_from_this());
+  ObjectID parent_id = InvalidObjectID();
+  std::vector<std::pair<size_t, size_t>> dirty;
+  std::shared_ptr<Payload> object;
+  std::string message_out;
+
+  TRY_READ_REQUEST(ReadCreateCopyOnWriteBufferRequest, root, parent_id, dirty);
+  ObjectID object_id;
+  RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->CreateCopyOnWrite(
+      parent_id, dirty, object_id, object));
+  object->owner = peerOwner();
+  refBlobs({object_id});
+  std::vector<int> fds_to_send;
+  collectUnseenFds(object, fds_to_send);
+  WriteCreateCopyOnWriteBufferReply(object_id, object, fds_to_send,
+                                    message_out);
+  this->doWrite(message_out, [self, fds_to_send = std::move(fds_to_send)](
+                                 const Status& status) {
+    if (!fds_to_send.empty()) {
+      send_fds(self->nativeHandle(), fds_to_send.data(),
+               static_cast<int>(fds_to_send.size()));
+    }
+    return Status::OK();
+  });
+  return false;
+}
+
+bool SocketConnection::doSealBuffer(const json& root) {
+  auto self(shared_from_this());
+  ObjectID object_id = InvalidObjectID();
+  std::shared_ptr<Payload> object;
+  std::string message_out;
+
+  TRY_READ_REQUEST(ReadSealBufferRequest, root, object_id);
+  RESPONSE_ON_ERROR(server_ptr_->GetBulkStore()->Seal(object_id, object));
+  std::vector<int> fds_to_send;
+  collectUnseenFds(object, fds_to_send);
+  WriteSealBufferReply(object, fds_to_send, message_out);
+  this->doWrite(message_out, [self, fds_to_send = std::move(fds_to_send)](
+                                 const Status& status) {
+    if (!fds_to_send.empty()) {
+      send_fds(self->nativeHandle(), fds_to_send.data(),
+               static_cast<int>(fds_to_send.size()));
+    }
+    return Status::OK();
+  });
+  return false;
+}
+
+bool SocketConnection::doRemoteBufferChunk(const json& root) {
+  auto self(shared_from_this());
+  ObjectID object_id = InvalidObjectID();
+  size_t offset = 0, size = 0;
+  std::string compression;
+  TRY_READ_REQUEST(ReadRemoteBufferChunkRequest, root, object_id, offset, size,
+                   compression);
+
+  Status status;
+  auto iter = streaming_buffers_.find(object_id);
+  if (iter == streaming_buffers_.end()) {
+    status = Status::ObjectNotExists("remote buffer is not being streamed: " +
+                                     ObjectIDToString(object_id));
+  } else if (offset > static_cast<size_t>(iter->second->data_size) ||
+             size > static_cast<size_t>(iter->second->data_size) - offset) {
+    status = Status::Invalid("the chunk exceeds the remote buffer");
+  } else if (!compression.empty() && !IsCompressionSupported(compression)) {
+    status = Status::NotImplemented("Unsupported compression: " + compression);
+  }
+  if (!status.ok()) {
+    // the content of the chunk cannot be consumed, close the connection once
+    // the error has been replied
+    payload_pending_ = true;
+    std::string message_out;
+    WriteErrorReply(status, message_out);
+    this->doWrite(message_out, [self](const Status&) {
+      self->doStop();
+      return Status::OK();
+    });
+    return false;
+  }
+
+  std::shared_ptr<Payload> object = iter->second;
+  callback_t<> callback_after_finish = [self](const Status& status) {
+    std::string message_out;
+    if (status.ok()) {
+      WriteRemoteBufferChunkReply(message_out);
+    } else {
+      WriteErrorReply(status, message_out);
+    }
+    self->doWrite(message_out);
+    self->resumeReading();
+    return Status::OK();
+  };
+
+  if (size == 0) {
+    VINEYARD_DISCARD(callback_after_finish(Status::OK()));
+    return false;
+  }
+  // the next message follows the content
+  payload_pending_ = true;
+  if (!compression.empty()) {
+    receiveCompressedBufferHelper(object, compression, offset, offset + size,
+                                  callback_after_finish);
+    return false;
+  }
+  asio::async_read(
+      socket_, asio::buffer(object->pointer + offset, size),
+      [callback_after_finish](boost::system::error_code ec, std::size_t) {
+        if (!ec || ec == asio::error::eof) {
+          VINEYARD_DISCARD(callback_after_finish(Status::OK()));
+        } else {
+          VINEYARD_DISCARD(callback_after_finish(Status::IOError(
+              "Failed to read buffer's content from client: " +
+              ec.message())));
         }
-        self->doWrite(message_out);
-        LOG_SUMMARY("instances_memory_usage_bytes", server_ptr_->instance_id(),
-                    server_ptr_->GetBulkStore()->Footprint());
       });
   return false;
 }
 
+bool SocketConnection::doSealRemoteBuffer(const json& root) {
+  auto self(shared_from_this());
+  ObjectID object_id = InvalidObjectID();
+  TRY_READ_REQUEST(ReadSealRemoteBufferRequest, root, object_id);
+  auto iter = streaming_buffers_.find(object_id);
+  if (iter == streaming_buffers_.end()) {
+    RESPONSE_ON_ERROR(Status::ObjectNotExists(
+        "remote buffer is not being streamed: " + ObjectIDToString(object_id)));
+  }
+  streaming_buffers_.erase(iter);
+  VINEYARD_SUPPRESS(server_ptr_->GetBulkStore()->Unref(object_id));
+  std::string message_out;
+  WriteSealRemoteBufferReply(message_out);
+  this->doWrite(message_out);
+  LOG_SUMMARY("instances_memory_usage_bytes", server_ptr_->instance_id(),
+              server_ptr_->GetBulkStore()->Footprint());
+  return false;
+}
+
 bool SocketConnection::doDropBuffer(const json& root) {
   auto self(shared_from_this());
   ObjectID object_id = InvalidObjectID();
   TRY_READ_REQUEST(ReadDropBufferRequest, root, object_id);
+  auto iter = streaming_buffers_.find(object_id);
+  if (iter != streaming_buffers_.end()) {
+    // the client aborts a streaming remote buffer
+    streaming_buffers_.erase(iter);
+    VINEYARD_SUPPRESS(server_ptr_->GetBulkStore()->Unref(object_id));
+  }
   auto status = server_ptr_->GetBulkStore()->Delete(object_id);
   std::string message_out;
   if (status.ok()) {
@@ -451,16 +1211,70 @@ bool SocketConnection::doDropBuffer(const json& root) {
   return false;
 }
 
+bool SocketConnection::doGetCachedBuffers(const json& root) {
+  auto self(shared_from_this());
+  std::vector<ObjectID> remote_ids, local_ids;
+  TRY_READ_REQUEST(ReadGetCachedBuffersRequest, root, remote_ids);
+  auto cache = server_ptr_->GetRemoteBlobCache();
+  if (cache) {
+    cache->Get(remote_ids, local_ids);
+  } else {
+    local_ids.resize(remote_ids.size(), InvalidObjectID());
+  }
+  std::string message_out;
+  WriteGetCachedBuffersReply(cache != nullptr, local_ids, message_out);
+  this->doWrite(message_out);
+  return false;
+}
+
+bool SocketConnection::doCacheBuffers(const json& root) {
+  auto self(shared_from_this());
+  std::vector<ObjectID> remote_ids, local_ids;
+  TRY_READ_REQUEST(ReadCacheBuffersRequest, root, remote_ids, local_ids);
+  auto cache = server_ptr_->GetRemoteBlobCache();
+  if (!cache) {
+    RESPONSE_ON_ERROR(Status::Invalid("the remote blob cache is disabled"));
+  }
+  for (size_t idx = 0; idx < remote_ids.size(); ++idx) {
+    RESPONSE_ON_ERROR(cache->Put(remote_ids[idx], local_ids[idx], peerOwner()));
+  }
+  std::string message_out;
+  WriteCacheBuffersReply(message_out);
+  this->doWrite(message_out);
+  LOG_SUMMARY("instances_memory_usage_bytes", server_ptr_->instance_id(),
+              server_ptr_->GetBulkStore()->Footprint());
+  return false;
+}
+
+bool SocketConnection::doSubscribeInvalidation(const json& root) {
+  auto self(shared_from_this());
+  TRY_READ_REQUEST(ReadSubscribeInvalidationRequest, root);
+  std::string message_out;
+  WriteSubscribeInvalidationReply(message_out);
+  this->doWrite(message_out, [self](const Status& status) {
+    // start pushing after the reply has been written
+    self->socket_server_ptr_->Subscribe(self->conn_id_);
+    return Status::OK();
+  });
+  return false;
+}
+
 bool SocketConnection::doGetData(const json& root) {
   auto self(shared_from_this());
   std::vector<ObjectID> ids;
   bool sync_remote = false, wait = false;
+  int depth = -1;
   double startTime = GetCurrentTime();
-  TRY_READ_REQUEST(ReadGetDataRequest, root, ids, sync_remote, wait);
+  TRY_READ_REQUEST(ReadGetDataRequest, root, ids, sync_remote, wait, depth);
   json tree;
+  // the reply is written on the meta context, out of the scope of the
+  // wire format in `processMessage`
+  auto const wire_format = wire_format_;
   RESPONSE_ON_ERROR(server_ptr_->GetData(
-      ids, sync_remote, wait, [self]() { return self->running_.load(); },
-      [self, startTime](const Status& status, const json& tree) {
+      ids, sync_remote, wait, depth,
+      [self]() { return self->running_.load(); },
+      [self, startTime, wire_format](const Status& status, const json& tree) {
+        WireFormatScope wire_format_scope(wire_format);
         std::string message_out;
         if (status.ok()) {
           WriteGetDataReply(tree, message_out);
@@ -484,8 +1298,11 @@ bool SocketConnection::doListData(const json& root) {
   bool regex;
   size_t limit;
   TRY_READ_REQUEST(ReadListDataRequest, root, pattern, regex, limit);
+  auto const wire_format = wire_format_;
   RESPONSE_ON_ERROR(server_ptr_->ListData(
-      pattern, regex, limit, [self](const Status& status, const json& tree) {
+      pattern, regex, limit,
+      [self, wire_format](const Status& status, const json& tree) {
+        WireFormatScope wire_format_scope(wire_format);
         std::string message_out;
         if (status.ok()) {
           WriteGetDataReply(tree, message_out);
@@ -499,15 +1316,44 @@ bool SocketConnection::doListData(const json& root) {
   return false;
 }
 
+bool SocketConnection::doListDataPage(const json& root) {
+  auto self(shared_from_this());
+  std::string pattern;
+  bool regex;
+  size_t limit;
+  json filters;
+  std::vector<std::string> fields;
+  std::string cursor;
+  TRY_READ_REQUEST(ReadListDataPageRequest, root, pattern, regex, limit,
+                   filters, fields, cursor);
+  RESPONSE_ON_ERROR(server_ptr_->ListDataPage(
+      pattern, regex, limit, filters, fields, cursor,
+      [self](const Status& status, const std::vector<ObjectID>& ids,
+             const json& projections, const std::string& next_cursor) {
+        std::string message_out;
+        if (status.ok()) {
+          WriteListDataPageReply(ids, projections, next_cursor, message_out);
+        } else {
+          LOG(ERROR) << status.ToString();
+          WriteErrorReply(status, message_out);
+        }
+        self->doWrite(message_out);
+        return Status::OK();
+      }));
+  return false;
+}
+
 bool SocketConnection::doCreateData(const json& root) {
   auto self(shared_from_this());
   json tree;
   double startTime = GetCurrentTime();
   TRY_READ_REQUEST(ReadCreateDataRequest, root, tree);
+  auto const wire_format = wire_format_;
   RESPONSE_ON_ERROR(server_ptr_->CreateData(
-      tree, [tree, self, startTime](const Status& status, const ObjectID id,
-                                    const Signature signature,
-                                    const InstanceID instance_id) {
+      tree, [tree, self, startTime, wire_format](
+                const Status& status, const ObjectID id,
+                const Signature signature, const InstanceID instance_id) {
+        WireFormatScope wire_format_scope(wire_format);
         std::string message_out;
         if (status.ok()) {
           WriteCreateDataReply(id, signature, instance_id, message_out);
@@ -532,7 +1378,15 @@ bool SocketConnection::doCreateData(const json& root) {
 bool SocketConnection::doPersist(const json& root) {
   auto self(shared_from_this());
   ObjectID id;
-  TRY_READ_REQUEST(ReadPersistRequest, root, id);
+  bool async = false;
+  TRY_READ_REQUEST(ReadPersistRequest, root, id, async);
+  if (async) {
+    std::string message_out;
+    RESPONSE_ON_ERROR(server_ptr_->PersistAsync(id));
+    WritePersistReply(message_out);
+    this->doWrite(message_out);
+    return false;
+  }
   RESPONSE_ON_ERROR(server_ptr_->Persist(id, [self](const Status& status) {
     std::string message_out;
     if (status.ok()) {
@@ -566,6 +1420,64 @@ bool SocketConnection::doIfPersist(const json& root) {
   return false;
 }
 
+bool SocketConnection::doWaitPersist(const json& root) {
+  auto self(shared_from_this());
+  ObjectID id;
+  bool block = true;
+  TRY_READ_REQUEST(ReadWaitPersistRequest, root, id, block);
+  RESPONSE_ON_ERROR(server_ptr_->WaitPersist(
+      id, block, [self](const Status& status, bool const persisted) {
+        std::string message_out;
+        if (status.ok()) {
+          WriteWaitPersistReply(persisted, message_out);
+        } else {
+          LOG(ERROR) << status.ToString();
+          WriteErrorReply(status, message_out);
+        }
+        self->doWrite(message_out);
+        return Status::OK();
+      }));
+  return false;
+}
+
+bool SocketConnection::doLease(const json& root) {
+  auto self(shared_from_this());
+  std::vector<ObjectID> ids;
+  int64_t ttl = 0;
+  std::string message_out;
+  TRY_READ_REQUEST(ReadLeaseRequest, root, ids, ttl);
+  // the leases outlive the connection
+  std::weak_ptr<SocketConnection> connection = self;
+  RESPONSE_ON_ERROR(server_ptr_->Lease(ids, ttl, [connection]() {
+    auto self = connection.lock();
+    return self != nullptr && self->running_.load();
+  }));
+  WriteLeaseReply(message_out);
+  this->doWrite(message_out);
+  return false;
+}
+
+bool SocketConnection::doPrefetch(const json& root) {
+  auto self(shared_from_this());
+  std::vector<ObjectID> ids, replicas;
+  int64_t ttl = 0;
+  TRY_READ_REQUEST(ReadPrefetchRequest, root, ids, replicas, ttl);
+  RESPONSE_ON_ERROR(server_ptr_->Prefetch(
+      ids, replicas, ttl,
+      [self](const Status& status, const std::vector<ObjectID>& known) {
+        std::string message_out;
+        if (status.ok()) {
+          WritePrefetchReply(known, message_out);
+        } else {
+          LOG(ERROR) << status.ToString();
+          WriteErrorReply(status, message_out);
+        }
+        self->doWrite(message_out);
+        return Status::OK();
+      }));
+  return false;
+}
+
 bool SocketConnection::doExists(const json& root) {
   auto self(shared_from_this());
   ObjectID id;
@@ -655,8 +1567,16 @@ bool SocketConnection::doDelData(const json& root) {
 bool SocketConnection::doCreateStream(const json& root) {
   auto self(shared_from_this());
   ObjectID stream_id;
-  TRY_READ_REQUEST(ReadCreateStreamRequest, root, stream_id);
-  auto status = server_ptr_->GetStreamStore()->Create(stream_id);
+  size_t high_watermark_bytes = 0, low_watermark_bytes = 0;
+  size_t high_watermark_chunks = 0, low_watermark_chunks = 0;
+  bool recycle_chunks = false;
+  TRY_READ_REQUEST(ReadCreateStreamRequest, root, stream_id,
+                   high_watermark_bytes, low_watermark_bytes,
+                   high_watermark_chunks, low_watermark_chunks,
+                   recycle_chunks);
+  auto status = server_ptr_->GetStreamStore()->Create(
+      stream_id, high_watermark_bytes, low_watermark_bytes,
+      high_watermark_chunks, low_watermark_chunks, recycle_chunks);
   std::string message_out;
   if (status.ok()) {
     WriteCreateStreamReply(message_out);
@@ -673,7 +1593,7 @@ bool SocketConnection::doOpenStream(const json& root) {
   ObjectID stream_id;
   int64_t mode;
   TRY_READ_REQUEST(ReadOpenStreamRequest, root, stream_id, mode);
-  auto status = server_ptr_->GetStreamStore()->Open(stream_id, mode);
+  auto status = server_ptr_->GetStreamStore()->Open(stream_id, mode, conn_id_);
   std::string message_out;
   if (status.ok()) {
     WriteOpenStreamReply(message_out);
@@ -695,6 +1615,7 @@ bool SocketConnection::doGetNextStreamChunk(const json& root) {
         std::string message_out;
         if (status.ok()) {
           std::shared_ptr<Payload> object;
+          self->refBlobs({chunk});
           RETURN_ON_ERROR(
               self->server_ptr_->GetBulkStore()->Get(chunk, object));
           WriteGetNextStreamChunkReply(object, message_out);
@@ -721,10 +1642,11 @@ bool SocketConnection::doGetNextStreamChunk(const json& root) {
 
 bool SocketConnection::doPushNextStreamChunk(const json& root) {
   auto self(shared_from_this());
-  ObjectID stream_id, chunk;
-  TRY_READ_REQUEST(ReadPushNextStreamChunkRequest, root, stream_id, chunk);
+  ObjectID stream_id;
+  std::vector<ObjectID> chunks;
+  TRY_READ_REQUEST(ReadPushNextStreamChunkRequest, root, stream_id, chunks);
   RESPONSE_ON_ERROR(server_ptr_->GetStreamStore()->Push(
-      stream_id, chunk, [self](const Status& status, const ObjectID) {
+      stream_id, chunks, [self](const Status& status, const ObjectID) {
         std::string message_out;
         if (status.ok()) {
           WritePushNextStreamChunkReply(message_out);
@@ -741,13 +1663,16 @@ bool SocketConnection::doPushNextStreamChunk(const json& root) {
 bool SocketConnection::doPullNextStreamChunk(const json& root) {
   auto self(shared_from_this());
   ObjectID stream_id;
-  TRY_READ_REQUEST(ReadPullNextStreamChunkRequest, root, stream_id);
+  size_t max_chunks, max_bytes;
+  TRY_READ_REQUEST(ReadPullNextStreamChunkRequest, root, stream_id, max_chunks,
+                   max_bytes);
   this->associated_streams_.emplace(stream_id);
   RESPONSE_ON_ERROR(server_ptr_->GetStreamStore()->Pull(
-      stream_id, [self](const Status& status, const ObjectID chunk) {
+      stream_id, conn_id_, max_chunks, max_bytes,
+      [self](const Status& status, const std::vector<ObjectID>& chunks) {
         std::string message_out;
         if (status.ok()) {
-          WritePullNextStreamChunkReply(chunk, message_out);
+          WritePullNextStreamChunkReply(chunks, message_out);
         } else {
           if (!status.IsStreamDrained()) {
             LOG(ERROR) << status.ToString();
@@ -911,6 +1836,43 @@ bool SocketConnection::doInstanceStatus(const json& root) {
   return false;
 }
 
+bool SocketConnection::doMemoryAttribution(const json& root) {
+  auto self(shared_from_this());
+  TRY_READ_REQUEST(ReadMemoryAttributionRequest, root);
+  RESPONSE_ON_ERROR(server_ptr_->MemoryAttribution(
+      [self](const Status& status, const json& usage) {
+        std::string message_out;
+        if (status.ok()) {
+          WriteMemoryAttributionReply(usage, message_out);
+        } else {
+          LOG(ERROR) << "Attribute the memory usage: " << status.ToString();
+          WriteErrorReply(status, message_out);
+        }
+        self->doWrite(message_out);
+        return Status::OK();
+      }));
+  return false;
+}
+
+bool SocketConnection::doCheckpoint(const json& root) {
+  auto self(shared_from_this());
+  std::string path;
+  TRY_READ_REQUEST(ReadCheckpointRequest, root, path);
+  RESPONSE_ON_ERROR(server_ptr_->Checkpoint(
+      path, [self](const Status& status, const json& stats) {
+        std::string message_out;
+        if (status.ok()) {
+          WriteCheckpointReply(stats, message_out);
+        } else {
+          LOG(ERROR) << "Checkpoint the bulk store: " << status.ToString();
+          WriteErrorReply(status, message_out);
+        }
+        self->doWrite(message_out);
+        return Status::OK();
+      }));
+  return false;
+}
+
 bool SocketConnection::doMakeArena(const json& root) {
   auto self(shared_from_this());
   size_t size;
@@ -991,47 +1953,293 @@ bool SocketConnection::doClear(const json& root) {
 }
 
 bool SocketConnection::doDebug(const json& root) {
+  auto self(shared_from_this());
+  json debug;
+  TRY_READ_REQUEST(ReadDebugRequest, root, debug);
   std::string message_out;
   json result;
-  WriteDebugReply(result, message_out);
-  this->doWrite(message_out);
+  if (debug.contains("heap_profile")) {
+    auto status = HeapProfile(result["heap_profile"]);
+    if (!status.ok()) {
+      WriteErrorReply(status, message_out);
+      this->doWrite(message_out);
+      return false;
+    }
+  }
+  if (!debug.contains("cpu_profile")) {
+    WriteDebugReply(result, message_out);
+    this->doWrite(message_out);
+    return false;
+  }
+
+  // the profile is replied once the given seconds elapse, the connection
+  // keeps serving the other requests in the meantime
+  json const& options = debug["cpu_profile"];
+  double seconds = 10;
+  int frequency = 99;
+  if (options.is_object()) {
+    seconds = options.value("seconds", seconds);
+    frequency = options.value("frequency", frequency);
+  }
+  Status status;
+  if (seconds <= 0 || seconds > 600) {
+    status = Status::Invalid("The profiling seconds should be in (0, 600]");
+  } else {
+    status = CPUProfiler::Start(frequency);
+  }
+  if (!status.ok()) {
+    WriteErrorReply(status, message_out);
+    this->doWrite(message_out);
+    return false;
+  }
+  auto timer = std::make_shared<asio::steady_timer>(
+      server_ptr_->GetContext(),
+      std::chrono::milliseconds(static_cast<int64_t>(seconds * 1000)));
+  timer->async_wait(
+      [self, timer, result](const boost::system::error_code& error) mutable {
+        json profile;
+        Status status = CPUProfiler::Stop(profile);
+        if (error) {
+          status = Status::IOError("The profiling timer fails: " +
+                                   error.message());
+        }
+        std::string message_out;
+        if (status.ok()) {
+          result["cpu_profile"] = std::move(profile);
+          WriteDebugReply(result, message_out);
+        } else {
+          WriteErrorReply(status, message_out);
+        }
+        self->doWrite(message_out);
+      });
+  return false;
+}
+
+bool SocketConnection::doBatch(const json& root) {
+  auto self(shared_from_this());
+  std::vector<json> requests;
+  TRY_READ_REQUEST(ReadBatchRequest, root, requests);
+  batch_ = std::make_shared<BatchContext>();
+  batch_->requests = std::move(requests);
+  batch_->replies.resize(batch_->requests.size());
+  batch_->callbacks.resize(batch_->requests.size());
+  processBatch();
+  return false;
+}
+
+bool SocketConnection::doRingDoorbell(const json& root) {
+  if (ring_ == nullptr) {
+    LOG(ERROR) << "The request ring hasn't been setup for the connection";
+    return false;
+  }
+  pollRing();
   return false;
 }
 
+void SocketConnection::pollRing() {
+  if (ring_ == nullptr || !running_.load()) {
+    return;
+  }
+  if (batch_ != nullptr) {
+    // resumed when the batch finishes
+    batch_->ring_deferred = true;
+    return;
+  }
+  auto& requests = ring_->requests();
+  std::string message_in;
+  while (!ring_pending_ && requests.TryPop(message_in)) {
+    ring_pending_ = true;
+    // the client never exits through the ring
+    processMessage(message_in);
+  }
+  if (ring_pending_) {
+    // resumed by `ringReply()` once the request has been answered
+    return;
+  }
+  // the client will ring the doorbell for the next request, unless the
+  // request has arrived in between
+  auto self(shared_from_this());
+  requests.SetWaiting();
+  if (!requests.Empty() && requests.TakeWaiting()) {
+    asio::post(socket_.get_executor(), [self]() { self->pollRing(); });
+  }
+}
+
+void SocketConnection::ringReply(const std::string& buf,
+                                 callback_t<> callback) {
+  auto& replies = ring_->replies();
+  bool overflow = !replies.TryPush(buf);
+  if (overflow) {
+    // there's at most one outstanding reply, thus the marker always fits
+    std::string marker;
+    WriteRingOverflow(marker);
+    replies.TryPush(marker);
+  }
+  std::string doorbell;
+  if (replies.TakeWaiting()) {
+    WriteRingDoorbell(doorbell);
+  }
+  // the doorbell goes first, then the overflowed reply and the fds
+  if (overflow) {
+    if (!doorbell.empty()) {
+      doWrite(doorbell);
+    }
+    if (callback) {
+      doWrite(buf, callback);
+    } else {
+      doWrite(buf);
+    }
+  } else if (!doorbell.empty()) {
+    if (callback) {
+      doWrite(doorbell, callback);
+    } else {
+      doWrite(doorbell);
+    }
+  } else if (callback) {
+    VINEYARD_DISCARD(callback(Status::OK()));
+  }
+  // wakes up to serve the next request from the ring
+  auto self(shared_from_this());
+  asio::post(socket_.get_executor(), [self]() { self->pollRing(); });
+}
+
+void SocketConnection::processBatch() {
+  auto batch = batch_;
+  WireFormatScope wire_format_scope(wire_format_);
+  if (batch->next == batch->requests.size()) {
+    batch_ = nullptr;
+    std::string message_out;
+    WriteBatchReply(batch->replies, message_out);
+    auto callbacks = std::move(batch->callbacks);
+    doWrite(message_out, [callbacks](const Status& status) {
+      for (auto const& callback : callbacks) {
+        if (callback) {
+          VINEYARD_DISCARD(callback(status));
+        }
+      }
+      return Status::OK();
+    });
+    if (batch->reading_deferred) {
+      doReadHeader();
+    }
+    if (batch->ring_deferred) {
+      pollRing();
+    }
+    return;
+  }
+
+  batch->pending = batch->next;
+  json const& request = batch->requests[batch->next++];
+  CommandType cmd = CommandType::NullCommand;
+  if (request.is_object() && request.contains("type") &&
+      request["type"].is_string()) {
+    cmd = ParseCommandType(request["type"].get_ref<std::string const&>());
+  }
+  switch (cmd) {
+  case CommandType::NullCommand:
+  case CommandType::RegisterRequest:
+  case CommandType::ExitRequest:
+  case CommandType::BatchRequest:
+  case CommandType::RingDoorbell:
+  // the payload follows the request (or the reply) on the socket
+  case CommandType::CreateRemoteBufferRequest:
+  case CommandType::RemoteBufferChunkRequest:
+  case CommandType::GetRemoteBuffersRequest: {
+    std::string message_out;
+    WriteErrorReply(Status::Invalid("Unsupported request in batch: " +
+                                    request.dump()),
+                    message_out);
+    batchReply(message_out, nullptr);
+    return;
+  }
+  default: {
+    // the reply will be collected by `batchReply()`
+    try {
+      processCommand(request);
+    } catch (std::exception const& err) {
+      std::string message_out;
+      WriteErrorReply(Status::Invalid(err.what()), message_out);
+      batchReply(message_out, nullptr);
+    }
+  }
+  }
+}
+
+bool SocketConnection::batchReply(const std::string& buf,
+                                  callback_t<> callback) {
+  auto batch = batch_;
+  if (batch == nullptr ||
+      batch->pending == std::numeric_limits<size_t>::max()) {
+    return false;
+  }
+  size_t const index = batch->pending;
+  batch->pending = std::numeric_limits<size_t>::max();
+  batch->replies[index] = DecodeMessage(buf);
+  batch->callbacks[index] = std::move(callback);
+  // continues with the next request, without deepening the stack when the
+  // request is answered synchronously
+  auto self(shared_from_this());
+  asio::post(socket_.get_executor(), [self]() { self->processBatch(); });
+  return true;
+}
+
 void SocketConnection::doWrite(const std::string& buf) {
-  std::string to_send;
-  size_t length = buf.size();
-  to_send.resize(length + sizeof(size_t));
-  char* ptr = &to_send[0];
-  memcpy(ptr, &length, sizeof(size_t));
-  ptr += sizeof(size_t);
-  memcpy(ptr, buf.data(), length);
-  {
-    std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
-    write_msgs_.push_back(std::move(to_send));
+  if (batch_ != nullptr && batchReply(buf, nullptr)) {
+    return;
   }
-  doAsyncWrite();
+  if (wire_format_ == WireFormat::JSON && IsBinaryMessage(buf)) {
+    // the reply may be written when serving another connection that talks
+    // in the binary format
+    std::string const message = json_to_string(DecodeMessage(buf));
+    return doWrite(message);
+  }
+  if (ring_pending_) {
+    ring_pending_ = false;
+    return ringReply(buf, nullptr);
+  }
+  enqueueWrite(frameMessage(buf), nullptr);
 }
 
 void SocketConnection::doWrite(const std::string& buf, callback_t<> callback) {
-  std::string to_send;
-  size_t length = buf.size();
-  to_send.resize(length + sizeof(size_t));
-  char* ptr = &to_send[0];
-  memcpy(ptr, &length, sizeof(size_t));
-  ptr += sizeof(size_t);
-  memcpy(ptr, buf.data(), length);
-  {
-    std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
-    write_msgs_.push_back(std::move(to_send));
+  if (batch_ != nullptr && batchReply(buf, callback)) {
+    return;
   }
-  doAsyncWrite(callback);
+  if (wire_format_ == WireFormat::JSON && IsBinaryMessage(buf)) {
+    std::string const message = json_to_string(DecodeMessage(buf));
+    return doWrite(message, callback);
+  }
+  if (ring_pending_) {
+    ring_pending_ = false;
+    return ringReply(buf, callback);
+  }
+  enqueueWrite(frameMessage(buf), std::move(callback));
 }
 
 void SocketConnection::doWrite(std::string&& buf) {
+  enqueueWrite(std::move(buf), nullptr);
+}
+
+json SocketConnection::Stats() const {
+  json stats = request_stats_.ToJSON();
+  stats["conn_id"] = conn_id_;
+  stats["qos"] = qos_class_ == QoSClass::Batch ? "batch" : "interactive";
+  return stats;
+}
+
+void SocketConnection::Push(const std::string& message) {
+  enqueueWrite(frameMessage(message), nullptr);
+}
+
+void SocketConnection::enqueueWrite(std::string&& message,
+                                    callback_t<> callback) {
   {
     std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
-    write_msgs_.push_back(std::move(buf));
+    write_msgs_.push_back(
+        PendingMessage{std::move(message), std::move(callback)});
+    if (writing_) {
+      return;
+    }
+    writing_ = true;
   }
   doAsyncWrite();
 }
@@ -1044,62 +2252,99 @@ void SocketConnection::doStop() {
 }
 
 void SocketConnection::doAsyncWrite() {
-  std::shared_ptr<std::string> payload = nullptr;
+  auto pending = std::make_shared<PendingMessage>();
   {
     std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
-    if (!write_msgs_.empty()) {
-      payload.reset(new std::string());
-      payload->swap(write_msgs_.front());
-      write_msgs_.pop_front();
+    if (write_msgs_.empty()) {
+      writing_ = false;
+      return;
     }
-  }
-  if (payload == nullptr) {
-    return;
+    *pending = std::move(write_msgs_.front());
+    write_msgs_.pop_front();
   }
   auto self(shared_from_this());
   asio::async_write(
-      socket_, boost::asio::buffer(payload->data(), payload->length()),
-      [this, self, payload](boost::system::error_code ec, std::size_t) {
-        if (!ec) {
-          doAsyncWrite();
-        } else {
+      socket_,
+      boost::asio::buffer(pending->message.data(), pending->message.length()),
+      [this, self, pending](boost::system::error_code ec, std::size_t) {
+        if (ec) {
           doStop();
+          return;
+        }
+        recycleMessage(std::move(pending->message));
+        if (pending->callback) {
+          // e.g., sends the file descriptors that follow the reply, before
+          // the next message is written
+          auto status = pending->callback(Status::OK());
+          if (!status.ok()) {
+            doStop();
+            return;
+          }
         }
+        {
+          std::lock_guard<std::recursive_mutex> scoped_lock(
+              write_msgs_mutex_);
+          if (writes_suspended_) {
+            // continued by `resumeWrites()`
+            return;
+          }
+        }
+        doAsyncWrite();
       });
 }
 
-void SocketConnection::doAsyncWrite(callback_t<> callback) {
-  std::shared_ptr<std::string> payload = nullptr;
+void SocketConnection::suspendWrites() {
+  std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
+  writes_suspended_ = true;
+}
+
+void SocketConnection::resumeWrites() {
   {
     std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
-    if (!write_msgs_.empty()) {
-      payload.reset(new std::string());
-      payload->swap(write_msgs_.front());
-      write_msgs_.pop_front();
+    if (!writes_suspended_) {
+      return;
     }
+    writes_suspended_ = false;
   }
-  if (payload == nullptr) {
-    auto status = callback(Status::OK());
-    if (!status.ok()) {
-      doStop();
+  doAsyncWrite();
+}
+
+std::string SocketConnection::frameMessage(const std::string& message) {
+  std::string framed;
+  {
+    std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
+    if (!spare_msgs_.empty()) {
+      framed = std::move(spare_msgs_.back());
+      spare_msgs_.pop_back();
     }
+  }
+  size_t length = message.size();
+  framed.clear();
+  framed.reserve(length + sizeof(size_t));
+  framed.append(reinterpret_cast<const char*>(&length), sizeof(size_t));
+  framed.append(message);
+  return framed;
+}
+
+void SocketConnection::recycleMessage(std::string&& message) {
+  if (message.capacity() > kMaxSpareMessageBytes) {
     return;
   }
-  auto self(shared_from_this());
-  asio::async_write(socket_,
-                    boost::asio::buffer(payload->data(), payload->length()),
-                    [this, self, payload, callback](
-                        boost::system::error_code ec, std::size_t) {
-                      if (!ec) {
-                        doAsyncWrite(callback);
-                      } else {
-                        doStop();
-                      }
-                    });
+  std::lock_guard<std::recursive_mutex> scoped_lock(write_msgs_mutex_);
+  if (spare_msgs_.size() < kMaxSpareMessages) {
+    spare_msgs_.emplace_back(std::move(message));
+  }
 }
 
 SocketServer::SocketServer(vs_ptr_t vs_ptr)
-    : vs_ptr_(vs_ptr), next_conn_id_(0) {}
+    : vs_ptr_(vs_ptr), next_conn_id_(0) {
+  if (vs_ptr_->GetSpec().value("io_uring", false)) {
+    uring_sender_ = UringSender::Create();
+  }
+  batch_bandwidth_share_ = std::min(
+      std::max(vs_ptr_->GetSpec().value("batch_bandwidth_share", 1.0), 0.01),
+      1.0);
+}
 
 void SocketServer::Start() {
   stopped_.store(false);
@@ -1116,6 +2361,9 @@ void SocketServer::Stop() {
   for (auto& pair : connections_) {
     pair.second->Stop();
   }
+  if (uring_sender_) {
+    uring_sender_->Stop();
+  }
 }
 
 bool SocketServer::ExistsConnection(int conn_id) const {
@@ -1129,6 +2377,32 @@ void SocketServer::RemoveConnection(int conn_id) {
   if (conn != connections_.end()) {
     connections_.erase(conn);
   }
+  subscribers_.erase(conn_id);
+}
+
+void SocketServer::Subscribe(int conn_id) {
+  std::lock_guard<std::recursive_mutex> scope_lock(this->connections_mutex_);
+  if (connections_.find(conn_id) != connections_.end()) {
+    subscribers_.emplace(conn_id);
+  }
+}
+
+void SocketServer::Invalidate(const std::vector<ObjectID>& ids) {
+  if (ids.empty()) {
+    return;
+  }
+  std::lock_guard<std::recursive_mutex> scope_lock(this->connections_mutex_);
+  if (subscribers_.empty()) {
+    return;
+  }
+  std::string message;
+  WriteInvalidationMessage(ids, message);
+  for (auto const conn_id : subscribers_) {
+    auto conn = connections_.find(conn_id);
+    if (conn != connections_.end()) {
+      conn->second->Push(message);
+    }
+  }
 }
 
 void SocketServer::CloseConnection(int conn_id) {
@@ -1145,4 +2419,19 @@ size_t SocketServer::AliveConnections() const {
   return connections_.size();
 }
 
+size_t SocketServer::AcceptedConnections() const {
+  std::lock_guard<std::recursive_mutex> scope_lock(this->connections_mutex_);
+  return next_conn_id_;
+}
+
+void SocketServer::ConnectionStats(const std::string& kind,
+                                   json& stats) const {
+  std::lock_guard<std::recursive_mutex> scope_lock(this->connections_mutex_);
+  for (auto const& item : connections_) {
+    json connection = item.second->Stats();
+    connection["kind"] = kind;
+    stats.push_back(std::move(connection));
+  }
+}
+
 }  // namespace vineyard
@@ -17,7 +17,9 @@ limitations under the License.
 #define SRC_SERVER_ASYNC_SOCKET_SERVER_H_
 
 #include <atomic>
+#include <chrono>
 #include <deque>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -27,9 +29,12 @@ limitations under the License.
 
 #include "boost/asio.hpp"
 
+#include "common/memory/ring.h"
 #include "common/util/protocols.h"
 #include "server/async/socket_server.h"
+#include "server/async/uring_sender.h"
 #include "server/server/vineyard_server.h"
+#include "server/util/metrics.h"
 
 namespace vineyard {
 
@@ -40,6 +45,13 @@ class SocketServer;
 
 using socket_message_queue_t = std::deque<std::string>;
 
+/**
+ * @brief The payloads that are sent in a sequence of asynchronous writes,
+ * which are shared by the steps rather than copied into each of them.
+ */
+using payloads_t =
+    std::shared_ptr<const std::vector<std::shared_ptr<Payload>>>;
+
 /**
  * @brief SocketConnection handles the socket connection in vineyard
  *
@@ -56,6 +68,18 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
    */
   bool Stop();
 
+  /**
+   * @brief Push a message to the client without a request, the pushed
+   * messages are written in order.
+   */
+  void Push(const std::string& message);
+
+  /**
+   * @brief The number, the cumulative and the maximum time of the requests
+   * that have been handled on the connection.
+   */
+  json Stats() const;
+
  protected:
   bool doRegister(const json& root);
 
@@ -73,20 +97,56 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
    * @brief doCreateBuffer differs from doCreateRemoteBuffer, that the content
    * of blob is in the request body, rather than via memory sharing.
    */
+  bool doCreateDeviceBuffer(const json& root);
+
   bool doCreateRemoteBuffer(const json& root);
 
+  bool doCreateCopyOnWriteBuffer(const json& root);
+
+  /**
+   * @brief Seal the blob, which may be deduplicated against an identical
+   * sealed blob, the reply carries the final location of the content.
+   */
+  bool doSealBuffer(const json& root);
+
+  /**
+   * @brief Receive a chunk of content of a streaming remote buffer, which is
+   * created by doCreateRemoteBuffer with `stream` set.
+   */
+  bool doRemoteBufferChunk(const json& root);
+
+  /**
+   * @brief Finish a streaming remote buffer, the buffer won't be released
+   * when the connection closes anymore.
+   */
+  bool doSealRemoteBuffer(const json& root);
+
   bool doDropBuffer(const json& root);
 
+  bool doGetCachedBuffers(const json& root);
+
+  bool doCacheBuffers(const json& root);
+
+  bool doSubscribeInvalidation(const json& root);
+
   bool doGetData(const json& root);
 
   bool doListData(const json& root);
 
+  bool doListDataPage(const json& root);
+
   bool doCreateData(const json& root);
 
   bool doPersist(const json& root);
 
   bool doIfPersist(const json& root);
 
+  bool doWaitPersist(const json& root);
+
+  bool doLease(const json& root);
+
+  bool doPrefetch(const json& root);
+
   bool doExists(const json& root);
 
   bool doShallowCopy(const json& root);
@@ -119,6 +179,10 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
 
   bool doInstanceStatus(const json& root);
 
+  bool doMemoryAttribution(const json& root);
+
+  bool doCheckpoint(const json& root);
+
   bool doMakeArena(const json& root);
 
   bool doFinalizeArena(const json& root);
@@ -127,6 +191,18 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
 
   bool doDebug(const json& root);
 
+  /**
+   * @brief Process the requests in a batch in order, and reply them with a
+   * single message, to save the round trips of many small requests.
+   */
+  bool doBatch(const json& root);
+
+  /**
+   * @brief The client submits requests through the request ring, and the
+   * doorbell tells the server to start polling the ring.
+   */
+  bool doRingDoorbell(const json& root);
+
  private:
   int nativeHandle() { return socket_.native_handle(); }
 
@@ -138,10 +214,48 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
    */
   bool processMessage(const std::string& message_in);
 
+  bool processCommand(const json& root);
+
+  /**
+   * @brief Process the next request in the current batch, or send the reply
+   * of the batch once all requests have been answered.
+   */
+  void processBatch();
+
+  /**
+   * @brief Collect the reply of the request in the current batch that is
+   * being processed, instead of writing it to the client.
+   *
+   * @return Returns false if there's no such a request, i.e., the message
+   * isn't a reply of the batch and should be written as usual.
+   */
+  bool batchReply(const std::string& buf, callback_t<> callback);
+
+  /**
+   * @brief Serve the requests in the request ring one at a time, then wait
+   * for the doorbell when the ring is empty.
+   */
+  void pollRing();
+
+  /**
+   * @brief Put the reply into the request ring, for the request that comes
+   * from the ring. The socket is used only for the doorbell, file
+   * descriptors, and the replies that are too large for the ring.
+   */
+  void ringReply(const std::string& buf, callback_t<> callback);
+
   void doReadHeader();
 
   void doReadBody();
 
+  /**
+   * @brief Start reading the next message once the content that follows the
+   * current request has been received, see also `payload_pending_`. Must be
+   * called only by the handler that completes reading the content, thus the
+   * header isn't read again by the handler of the request.
+   */
+  void resumeReading();
+
   void doWrite(const std::string& buf);
 
   void doWrite(std::string&& buf);
@@ -156,14 +270,96 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
    */
   void doStop();
 
+  /**
+   * @brief Queue the framed message to be written, the replies and the pushed
+   * messages share the queue and are written by a single writer in order.
+   */
+  void enqueueWrite(std::string&& message, callback_t<> callback);
+
+  /**
+   * @brief Write the next queued message, there's at most one write in flight
+   * on the socket.
+   */
   void doAsyncWrite();
 
-  void doAsyncWrite(callback_t<> callback);
+  /**
+   * @brief Called by the callback of a written message, to hold the queued
+   * messages until `resumeWrites()`, e.g., while the payloads that follow the
+   * reply are being written to the socket (by asio or io_uring).
+   */
+  void suspendWrites();
+
+  void resumeWrites();
+
+  /**
+   * @brief Prefix the message with its length, the framed message reuses a
+   * recycled buffer of an earlier reply when there's one.
+   */
+  std::string frameMessage(const std::string& message);
+
+  /**
+   * @brief Keep the buffer of a written message for the later replies, thus
+   * the replies of a busy connection don't allocate for framing.
+   */
+  void recycleMessage(std::string&& message);
+
+  /**
+   * @brief Pin the blobs for the lifetime of this connection, as the client
+   * may access these blobs through the shared memory at any time.
+   */
+  void refBlobs(std::vector<ObjectID> const& ids);
+
+  /**
+   * @brief Collect the fds that the blob is mapped from, i.e., the fd of the
+   * segment or the fds of the extents of a copy-on-write blob, which haven't
+   * been passed to the client yet.
+   */
+  void collectUnseenFds(std::shared_ptr<Payload> const& object,
+                        std::vector<int>& fds);
+
+  /**
+   * @brief Infer the NUMA node that the peer client currently runs on,
+   * returns -1 if unknown. The node is inspected at most once per second,
+   * as the client rarely moves across nodes.
+   */
+  int peerNumaNode();
+
+  /**
+   * @brief The pid of the peer client, returns -1 if not available, e.g., for
+   * the RPC connections.
+   */
+  pid_t peerPid();
 
-  void sendBufferHelper(std::vector<std::shared_ptr<Payload>> const objects,
-                        size_t index, boost::system::error_code const ec,
+  /**
+   * @brief The peer client process that the blobs created by this connection
+   * are attributed to, i.e., "<comm>:<pid>", or "connection:<conn_id>" when
+   * the pid of the peer isn't available.
+   */
+  std::shared_ptr<const std::string> const& peerOwner();
+
+  void sendBufferHelper(payloads_t const& objects, size_t index,
+                        boost::system::error_code const ec,
                         callback_t<> callback_after_finish);
 
+  /**
+   * Sends the payloads in compressed frames, the next frame is compressed on
+   * the server's context while the current one is being written. `index` and
+   * `offset` points to the content after the current `frame`.
+   */
+  void sendCompressedBufferHelper(
+      payloads_t const& objects, std::string const& compression, size_t index,
+      size_t offset, std::shared_ptr<std::string> frame,
+      callback_t<> callback_after_finish);
+
+  /**
+   * Receives the content of the blob in `[offset, end)` from compressed
+   * frames.
+   */
+  void receiveCompressedBufferHelper(std::shared_ptr<Payload> const object,
+                                     std::string const compression,
+                                     size_t offset, size_t const end,
+                                     callback_t<> callback_after_finish);
+
   stream_protocol::socket socket_;
   vs_ptr_t server_ptr_;
   SocketServer* socket_server_ptr_;
@@ -171,15 +367,76 @@ class SocketConnection : public std::enable_shared_from_this<SocketConnection> {
   std::atomic_bool running_;
 
   asio::streambuf buf_;
-  socket_message_queue_t write_msgs_;
+  struct PendingMessage {
+    std::string message;
+    // invoked after the message has been written, may be empty
+    callback_t<> callback;
+  };
+  std::deque<PendingMessage> write_msgs_;
+  // whether a message is being written, see also `enqueueWrite()`
+  bool writing_ = false;
+  // whether the writer is held by the callback, see also `suspendWrites()`
+  bool writes_suspended_ = false;
   std::recursive_mutex write_msgs_mutex_;  // protect the write_msgs
+  // the buffers of the written messages, see also `recycleMessage()`
+  std::vector<std::string> spare_msgs_;
 
   std::unordered_set<int> used_fds_;
+  // the blobs that have been mapped by the client
+  std::unordered_set<ObjectID> used_blobs_;
+
+  // the encoding of hot commands negotiated with the client
+  WireFormat wire_format_ = WireFormat::JSON;
+  QoSClass qos_class_ = QoSClass::Interactive;
+
+  struct BatchContext {
+    std::vector<json> requests;
+    size_t next = 0;
+    // the index of the request whose reply hasn't been collected yet
+    size_t pending = std::numeric_limits<size_t>::max();
+    // the replies, in the order of the requests
+    std::vector<json> replies;
+    // to be invoked after the reply of the batch has been written, e.g., for
+    // sending file descriptors, in the order of the requests
+    std::vector<callback_t<>> callbacks;
+    // whether reading the next request from the socket (or the ring) is
+    // deferred until the batch finishes
+    bool reading_deferred = false;
+    bool ring_deferred = false;
+  };
+  // the batch of requests that is being processed
+  std::shared_ptr<BatchContext> batch_;
+
+  // the shared memory ring for co-located clients
+  std::shared_ptr<memory::RequestRing> ring_;
+  // whether the request from the ring is waiting for its reply, the next
+  // request won't be taken from the ring until it has been answered, thus
+  // the reply to write belongs to it
+  bool ring_pending_ = false;
+
+  bool numa_aware_ = false;
+  pid_t peer_pid_ = 0;  // 0: unknown, -1: not available
+  int peer_numa_node_ = -1;
+  std::chrono::steady_clock::time_point peer_numa_node_expiry_;
+  std::shared_ptr<const std::string> peer_owner_;
+  // the session whose memory quota the created blobs are charged to
+  std::shared_ptr<const std::string> session_;
   // the associated reader of the stream
   std::unordered_set<ObjectID> associated_streams_;
 
   size_t read_msg_header_;
   std::string read_msg_body_;
+  // whether the content that follows the current request is being read, the
+  // next message is read by the handler that completes the content, see also
+  // `resumeReading()`. Only accessed by the handlers of the connection, which
+  // are serialized on the strand of the socket.
+  bool payload_pending_ = false;
+
+  // the remote buffers that are being streamed by the client, which are
+  // dropped if the connection closes before they are sealed
+  std::unordered_map<ObjectID, std::shared_ptr<Payload>> streaming_buffers_;
+
+  RequestStats request_stats_;
 };
 
 /**
@@ -220,12 +477,58 @@ class SocketServer {
    */
   size_t AliveConnections() const;
 
+  /**
+   * Inspect the number of connections that have been accepted.
+   */
+  size_t AcceptedConnections() const;
+
+  /**
+   * Append the stats of the alive connections, see also
+   * `SocketConnection::Stats()`.
+   */
+  void ConnectionStats(const std::string& kind, json& stats) const;
+
+  /**
+   * @brief Push invalidation messages on the connection, until it closes.
+   */
+  void Subscribe(int conn_id);
+
+  /**
+   * @brief Notify the subscribed connections that the metadata of the given
+   * objects are no longer valid.
+   */
+  void Invalidate(const std::vector<ObjectID>& ids);
+
+  /**
+   * The io_uring sender for writing buffers to clients, nullptr if io_uring
+   * is not enabled or not supported.
+   */
+  std::shared_ptr<UringSender> const& GetUringSender() const {
+    return uring_sender_;
+  }
+
+  /**
+   * The share of the time that the remote buffer sends of batch connections
+   * get while the sends of interactive connections are in flight, in (0, 1].
+   */
+  double BatchBandwidthShare() const { return batch_bandwidth_share_; }
+
+  /**
+   * The number of remote buffer sends of interactive connections that are in
+   * flight.
+   */
+  std::atomic<size_t>& InteractiveSends() { return interactive_sends_; }
+
  protected:
   std::atomic_bool stopped_;  // if the socket server being stopped.
   vs_ptr_t vs_ptr_;
   int next_conn_id_;
   std::unordered_map<int, std::shared_ptr<SocketConnection>> connections_;
   mutable std::recursive_mutex connections_mutex_;  // protect `connections_`
+  std::unordered_set<int> subscribers_;  // protected by `connections_mutex_`
+  std::shared_ptr<UringSender> uring_sender_;
+  double batch_bandwidth_share_ = 1.0;
+  std::atomic<size_t> interactive_sends_{0};
 
  private:
   virtual void doAccept() = 0;
@@ -0,0 +1,353 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/async/uring_sender.h"
+
+#if defined(WITH_IO_URING)
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "common/util/logging.h"
+#include "server/memory/malloc.h"
+
+namespace vineyard {
+
+#if defined(WITH_IO_URING)
+
+namespace detail {
+
+// At most such many writes of a transfer are linked and in flight at once,
+// the rest is submitted when the previous chain completes.
+constexpr size_t kMaxChainLength = 64;
+
+// The number of bulk store segments that can be registered as fixed buffers.
+constexpr unsigned kFixedBufferSlots = 1024;
+
+// The kernel refuses to register a buffer larger than 1GB, writes from larger
+// segments go through plain sends.
+constexpr int64_t kMaxFixedBufferSize = 1L << 30;
+
+}  // namespace detail
+
+UringSender::UringSender() : stopped_(true) {}
+
+UringSender::~UringSender() { Stop(); }
+
+std::shared_ptr<UringSender> UringSender::Create(unsigned const entries) {
+  std::shared_ptr<UringSender> sender(new UringSender());
+  int ret = io_uring_queue_init(entries, &sender->ring_, 0);
+  if (ret < 0) {
+    LOG(WARNING) << "io_uring is not available, fallback to asio: "
+                 << strerror(-ret);
+    return nullptr;
+  }
+#if defined(IORING_RSRC_REGISTER_SPARSE)
+  ret = io_uring_register_buffers_sparse(&sender->ring_,
+                                         detail::kFixedBufferSlots);
+  if (ret == 0) {
+    sender->fixed_buffers_supported_ = true;
+    for (unsigned slot = detail::kFixedBufferSlots; slot > 0; --slot) {
+      sender->free_fixed_slots_.emplace_back(slot - 1);
+    }
+  } else {
+    LOG(WARNING) << "Failed to register fixed buffers for io_uring, "
+                    "fallback to plain sends: "
+                 << strerror(-ret);
+  }
+#endif
+  sender->stopped_.store(false);
+  UringSender* self = sender.get();
+  sender->reaper_ = std::thread([self]() { self->reap(); });
+  return sender;
+}
+
+void UringSender::Send(int const fd, buffers_t const& buffers,
+                       callback_t<> callback) {
+  std::unique_ptr<Transfer> transfer(new Transfer());
+  transfer->fd = fd;
+  transfer->buffers = buffers;
+  transfer->written.resize(buffers.size(), 0);
+  for (size_t index = 0; index < buffers.size(); ++index) {
+    transfer->writes.emplace_back(Write{transfer.get(), index});
+  }
+  transfer->callback = callback;
+
+  Status status;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (stopped_.load()) {
+      status = Status::IOError("The io_uring sender has been stopped");
+    } else {
+      if (!fixed_buffers_.empty()) {
+        releaseFixedBuffers();
+      }
+      Transfer* pointer = transfer.get();
+      inflight_.emplace(pointer, std::move(transfer));
+      if (submit(pointer)) {
+        return;
+      }
+      // nothing left to write
+      if (pointer->error == 0) {
+        status = Status::OK();
+      } else {
+        status = Status::IOError("Failed to write buffers with io_uring: " +
+                                 std::string(strerror(pointer->error)));
+      }
+      inflight_.erase(pointer);
+    }
+  }
+  VINEYARD_DISCARD(callback(status));
+}
+
+void UringSender::Stop() {
+  if (stopped_.exchange(true)) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    // wakeup the reaper
+    struct io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+    if (sqe != nullptr) {
+      io_uring_prep_nop(sqe);
+      io_uring_sqe_set_data(sqe, nullptr);
+      io_uring_submit(&ring_);
+    }
+  }
+  if (reaper_.joinable()) {
+    reaper_.join();
+  }
+  // cancels the writes that are still in flight
+  io_uring_queue_exit(&ring_);
+
+  std::unordered_map<Transfer*, std::unique_ptr<Transfer>> inflight;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    inflight.swap(inflight_);
+  }
+  for (auto& item : inflight) {
+    VINEYARD_DISCARD(item.second->callback(
+        Status::IOError("The io_uring sender has been stopped")));
+  }
+}
+
+bool UringSender::submit(Transfer* transfer) {
+  size_t const limit = std::min<size_t>(detail::kMaxChainLength,
+                                        io_uring_sq_space_left(&ring_));
+  size_t count = 0;
+  struct io_uring_sqe* last = nullptr;
+  for (size_t index = 0; index < transfer->buffers.size() && count < limit;
+       ++index) {
+    auto const& buffer = transfer->buffers[index];
+    size_t const written = transfer->written[index];
+    if (written >= buffer.second) {
+      continue;
+    }
+    struct io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+    if (sqe == nullptr) {
+      break;
+    }
+    const uint8_t* pointer = buffer.first + written;
+    size_t const size = buffer.second - written;
+    int const slot = fixedBuffer(buffer.first, buffer.second);
+    if (slot >= 0) {
+      io_uring_prep_write_fixed(sqe, transfer->fd, pointer, size, 0, slot);
+    } else {
+      io_uring_prep_send(sqe, transfer->fd, pointer, size, MSG_NOSIGNAL);
+    }
+    io_uring_sqe_set_data(sqe, &transfer->writes[index]);
+    // a failed or short write cancels the rest of the chain, which will be
+    // resubmitted from where it stops
+    io_uring_sqe_set_flags(sqe, IOSQE_IO_LINK);
+    last = sqe;
+    count += 1;
+  }
+  if (last == nullptr) {
+    if (count == 0 && limit == 0) {
+      transfer->error = EBUSY;
+    }
+    return false;
+  }
+  io_uring_sqe_set_flags(last, 0);
+
+  int ret = 0;
+  do {
+    ret = io_uring_submit(&ring_);
+  } while (ret == -EINTR || ret == -EAGAIN);
+  if (ret < 0) {
+    // the entries have been queued and will be consumed by the kernel on the
+    // next submission, fails the transfer once they complete
+    LOG(ERROR) << "Failed to submit to io_uring: " << strerror(-ret);
+    transfer->error = -ret;
+  }
+  transfer->pending += count;
+  return true;
+}
+
+int UringSender::fixedBuffer(const uint8_t* pointer, size_t const size) {
+  if (!fixed_buffers_supported_) {
+    return -1;
+  }
+  int fd = -1;
+  int64_t map_size = 0;
+  ptrdiff_t offset = 0;
+  memory::GetMallocMapinfo(const_cast<uint8_t*>(pointer), &fd, &map_size,
+                           &offset);
+  if (fd == -1 || map_size > detail::kMaxFixedBufferSize ||
+      offset + size > static_cast<size_t>(map_size)) {
+    return -1;
+  }
+  uintptr_t const base = reinterpret_cast<uintptr_t>(pointer) - offset;
+  unsigned slot = 0;
+  auto iter = fixed_buffers_.find(fd);
+  if (iter != fixed_buffers_.end()) {
+    if (iter->second.base == base &&
+        iter->second.size == static_cast<size_t>(map_size)) {
+      return iter->second.slot;
+    }
+    // the segment has been remapped, replaces the registration
+    slot = iter->second.slot;
+    fixed_buffers_.erase(iter);
+  } else {
+    if (free_fixed_slots_.empty()) {
+      return -1;
+    }
+    slot = free_fixed_slots_.back();
+    free_fixed_slots_.pop_back();
+  }
+
+  struct iovec iov;
+  iov.iov_base = reinterpret_cast<void*>(base);
+  iov.iov_len = map_size;
+  __u64 tag = 0;
+  int ret = io_uring_register_buffers_update_tag(&ring_, slot, &iov, &tag, 1);
+  if (ret < 0) {
+    LOG(WARNING) << "Failed to register the memory segment as fixed buffer, "
+                    "fallback to plain sends: "
+                 << strerror(-ret);
+    fixed_buffers_supported_ = false;
+    free_fixed_slots_.emplace_back(slot);
+    return -1;
+  }
+  fixed_buffers_.emplace(fd, FixedBuffer{slot, base, iov.iov_len});
+  return slot;
+}
+
+void UringSender::releaseFixedBuffers() {
+  // the registration pins the pages, unregisters the segments that have been
+  // released by the allocator to give the memory back to the OS.
+  std::lock_guard<std::mutex> guard(memory::mmap_records_mutex);
+  for (auto iter = fixed_buffers_.begin(); iter != fixed_buffers_.end();) {
+    auto record = memory::mmap_records.find(
+        reinterpret_cast<void*>(iter->second.base));
+    if (record != memory::mmap_records.end() &&
+        record->second.fd == iter->first &&
+        static_cast<size_t>(record->second.size) == iter->second.size) {
+      ++iter;
+      continue;
+    }
+    struct iovec iov;
+    iov.iov_base = nullptr;
+    iov.iov_len = 0;
+    __u64 tag = 0;
+    io_uring_register_buffers_update_tag(&ring_, iter->second.slot, &iov,
+                                         &tag, 1);
+    free_fixed_slots_.emplace_back(iter->second.slot);
+    iter = fixed_buffers_.erase(iter);
+  }
+}
+
+void UringSender::reap() {
+  while (true) {
+    struct io_uring_cqe* cqe = nullptr;
+    int ret = io_uring_wait_cqe(&ring_, &cqe);
+    if (ret == -EINTR) {
+      continue;
+    }
+    if (ret < 0) {
+      LOG(ERROR) << "Failed to wait for io_uring completions: "
+                 << strerror(-ret);
+      return;
+    }
+    Write* write = static_cast<Write*>(io_uring_cqe_get_data(cqe));
+    int const result = cqe->res;
+    io_uring_cqe_seen(&ring_, cqe);
+    if (write == nullptr) {
+      if (stopped_.load()) {
+        return;
+      }
+      continue;
+    }
+
+    callback_t<> callback;
+    Status status;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      Transfer* transfer = write->transfer;
+      if (result > 0) {
+        transfer->written[write->index] += result;
+      } else if (transfer->error == 0 && result != -ECANCELED) {
+        transfer->error = result == 0 ? EPIPE : -result;
+      }
+      transfer->pending -= 1;
+      if (transfer->pending > 0) {
+        continue;
+      }
+      if (transfer->error == 0 && stopped_.load()) {
+        transfer->error = ECANCELED;
+      }
+      if (transfer->error == 0 && submit(transfer)) {
+        continue;
+      }
+      if (transfer->error == 0) {
+        status = Status::OK();
+      } else {
+        status = Status::IOError("Failed to write buffers with io_uring: " +
+                                 std::string(strerror(transfer->error)));
+      }
+      callback = std::move(transfer->callback);
+      inflight_.erase(transfer);
+    }
+    VINEYARD_DISCARD(callback(status));
+  }
+}
+
+#else
+
+UringSender::UringSender() {}
+
+UringSender::~UringSender() {}
+
+std::shared_ptr<UringSender> UringSender::Create(unsigned const) {
+  return nullptr;
+}
+
+void UringSender::Send(int const, buffers_t const&, callback_t<> callback) {
+  VINEYARD_DISCARD(callback(
+      Status::NotImplemented("vineyardd is built without io_uring support")));
+}
+
+void UringSender::Stop() {}
+
+#endif  // WITH_IO_URING
+
+}  // namespace vineyard
@@ -0,0 +1,125 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_ASYNC_URING_SENDER_H_
+#define SRC_SERVER_ASYNC_URING_SENDER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(WITH_IO_URING)
+#include "liburing.h"
+#endif
+
+#include "common/util/callback.h"
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief UringSender writes buffers to sockets with io_uring. All buffers of
+ * a transfer are submitted as a chain of linked writes in a single syscall,
+ * and the memory segments of the bulk store are registered as fixed buffers
+ * on first use to save the page pinning on every write.
+ *
+ * Completions are reaped on a dedicated thread, the callback of a transfer
+ * is invoked on that thread and the caller is expected to post it back to
+ * its own executor.
+ */
+class UringSender {
+ public:
+  using buffers_t = std::vector<std::pair<const uint8_t*, size_t>>;
+
+  ~UringSender();
+
+  /**
+   * @brief Create a sender, returns nullptr when the server is built without
+   * io_uring or the kernel doesn't support it, in which case the caller
+   * should fall back to asio.
+   */
+  static std::shared_ptr<UringSender> Create(unsigned const entries = 256);
+
+  /**
+   * @brief Write all buffers to the given socket in order, the buffers must
+   * be kept alive until the callback is invoked.
+   */
+  void Send(int const fd, buffers_t const& buffers, callback_t<> callback);
+
+  /**
+   * @brief Stop the reaper thread, transfers still in flight are completed
+   * with an error.
+   */
+  void Stop();
+
+ private:
+  UringSender();
+
+#if defined(WITH_IO_URING)
+  struct Transfer;
+
+  struct Write {
+    Transfer* transfer;
+    size_t index;
+  };
+
+  struct Transfer {
+    int fd;
+    buffers_t buffers;
+    std::vector<size_t> written;
+    std::vector<Write> writes;
+    size_t pending = 0;
+    int error = 0;
+    callback_t<> callback;
+  };
+
+  // requires `mutex_`
+  bool submit(Transfer* transfer);
+
+  // requires `mutex_`
+  int fixedBuffer(const uint8_t* pointer, size_t const size);
+
+  // requires `mutex_`
+  void releaseFixedBuffers();
+
+  void reap();
+
+  struct FixedBuffer {
+    unsigned slot;
+    uintptr_t base;
+    size_t size;
+  };
+
+  struct io_uring ring_;
+  std::mutex mutex_;
+  std::thread reaper_;
+  std::atomic_bool stopped_;
+  std::unordered_map<Transfer*, std::unique_ptr<Transfer>> inflight_;
+
+  // registered segments of the bulk store, indexed by the fd of the segment
+  bool fixed_buffers_supported_ = false;
+  std::unordered_map<int, FixedBuffer> fixed_buffers_;
+  std::vector<unsigned> free_fixed_slots_;
+#endif
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_ASYNC_URING_SENDER_H_
@@ -104,6 +104,26 @@ void BulkAllocator::Free(void* mem, size_t bytes) {
   allocated_ -= bytes;
 }
 
+void BulkAllocator::Trim() {
+#if defined(WITH_DLMALLOC)
+  Allocator::Trim();
+#endif
+#if defined(WITH_JEMALLOC)
+  allocator_.Recycle();
+#endif
+}
+
+bool BulkAllocator::FreeSpace(size_t& free_bytes, size_t& largest_chunk) {
+#if defined(WITH_DLMALLOC)
+  Allocator::FreeSpace(free_bytes, largest_chunk);
+  return true;
+#else
+  free_bytes = 0;
+  largest_chunk = 0;
+  return false;
+#endif
+}
+
 void BulkAllocator::SetFootprintLimit(size_t bytes) {
   footprint_limit_ = static_cast<int64_t>(bytes);
 }
@@ -112,4 +132,26 @@ int64_t BulkAllocator::GetFootprintLimit() { return footprint_limit_; }
 
 int64_t BulkAllocator::Allocated() { return allocated_; }
 
+json BulkAllocator::Stats() {
+  json stats = Allocator::Stats();
+#if defined(WITH_DLMALLOC)
+  stats["allocator"] = "dlmalloc";
+#endif
+#if defined(WITH_JEMALLOC)
+  stats["allocator"] = "jemalloc";
+#endif
+  stats["bulk_allocated"] = allocated_;
+  stats["bulk_footprint_limit"] = footprint_limit_;
+  return stats;
+}
+
+Status BulkAllocator::DumpHeapProfile(std::string& profile) {
+#if defined(WITH_JEMALLOC)
+  return Allocator::DumpProfile(profile);
+#else
+  return Status::NotImplemented(
+      "the heap profile requires vineyardd built with jemalloc");
+#endif
+}
+
 }  // namespace vineyard
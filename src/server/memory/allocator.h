@@ -31,6 +31,10 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
+
+#include "common/util/json.h"
+#include "common/util/status.h"
 
 namespace vineyard {
 
@@ -59,6 +63,17 @@ class BulkAllocator {
   /// \param bytes Number of bytes to be freed.
   static void Free(void* mem, size_t bytes);
 
+  /// Gives the unused memory segments back to the OS. Only segments that are
+  /// mapped after Init(), i.e., when the shared memory grows, are released.
+  static void Trim();
+
+  /// Inspect the free space in the mapped shared memory.
+  ///
+  /// \param free_bytes Total bytes of free chunks.
+  /// \param largest_chunk Bytes of the largest free chunk.
+  /// \return Whether the allocator supports the inspection.
+  static bool FreeSpace(size_t& free_bytes, size_t& largest_chunk);
+
   /// Sets the memory footprint limit for Plasma.
   ///
   /// \param bytes Plasma memory footprint limit in bytes.
@@ -73,6 +88,15 @@ class BulkAllocator {
   /// \return Number of bytes allocated by Plasma so far.
   static int64_t Allocated();
 
+  /// Get the statistics of the underlying allocator.
+  static json Stats();
+
+  /// Dump the heap profile of the underlying allocator.
+  ///
+  /// \param profile The heap profile, in the format of the allocator.
+  /// \return NotImplemented when the allocator doesn't support profiling.
+  static Status DumpHeapProfile(std::string& profile);
+
 #if defined(WITH_DLMALLOC)
   using Allocator = vineyard::memory::DLmallocAllocator;
 #endif
@@ -30,6 +30,8 @@
 
 #include <stddef.h>
 
+#include <algorithm>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -55,6 +57,7 @@ int fake_munmap(void*, int64_t);
 #define DEFAULT_MMAP_THRESHOLD MAX_SIZE_T
 #define DEFAULT_GRANULARITY ((size_t) 128U * 1024U)
 #define USE_LOCKS 1 /* makes the dlmalloc thread safe (but is not scalable) */
+#define MALLOC_INSPECT_ALL 1
 
 #include "dlmalloc/dlmalloc.c"  // NOLINT
 
@@ -66,6 +69,7 @@ int fake_munmap(void*, int64_t);
 #undef HAVE_MORECORE
 #undef DEFAULT_GRANULARITY
 #undef USE_LOCKS
+#undef MALLOC_INSPECT_ALL
 
 // dlmalloc.c defined DEBUG which will conflict with ARROW_LOG(DEBUG).
 #ifdef DEBUG
@@ -101,10 +105,12 @@ void* fake_mmap(size_t size) {
   // Add kMmapRegionsGap so that the returned pointer is deliberately not
   // page-aligned. This ensures that the segments of memory returned by
   // fake_mmap are never contiguous.
-  size += kMmapRegionsGap;
+  size = segment_size(size + kMmapRegionsGap);
 
   int fd = create_buffer(size);
   CHECK_GE(fd, 0) << "Failed to create buffer during mmap";
+  VLOG(2) << "mapping a new shared memory segment: fd = " << fd
+          << ", size = " << size;
   // MAP_POPULATE can be used to pre-populate the page tables for this memory
   // region
   // which avoids work when accessing the pages later. However it causes long
@@ -123,13 +129,18 @@ void* fake_mmap(size_t size) {
     LOG(ERROR) << "mmap failed with error: " << strerror(errno);
     return pointer;
   }
+  advise_huge_pages(pointer, size);
+  populate_segment(pointer, size);
 
   // Increase dlmalloc's allocation granularity directly.
   mparams.granularity *= GRANULARITY_MULTIPLIER;
 
-  MmapRecord& record = mmap_records[pointer];
-  record.fd = fd;
-  record.size = size;
+  {
+    std::lock_guard<std::mutex> guard(mmap_records_mutex);
+    MmapRecord& record = mmap_records[pointer];
+    record.fd = fd;
+    record.size = size;
+  }
 
   // We lie to dlmalloc about where mapped memory actually lives.
   pointer = pointer_advance(pointer, kMmapRegionsGap);
@@ -138,8 +149,9 @@ void* fake_mmap(size_t size) {
 
 int fake_munmap(void* addr, int64_t size) {
   addr = pointer_retreat(addr, kMmapRegionsGap);
-  size += kMmapRegionsGap;
+  size = segment_size(size + kMmapRegionsGap);
 
+  std::lock_guard<std::mutex> guard(mmap_records_mutex);
   auto entry = mmap_records.find(addr);
 
   if (entry == mmap_records.end() || entry->second.size != size) {
@@ -150,7 +162,15 @@ int fake_munmap(void* addr, int64_t size) {
 
   int r = munmap(addr, size);
   if (r == 0) {
-    close(entry->second.fd);
+    // Clients keep their mappings by the fd number, thus we cannot close
+    // the fd, otherwise the number may be reused by a new segment. Truncating
+    // the file is enough to give the memory back to the OS.
+    VLOG(2) << "releasing the shared memory segment: fd = "
+            << entry->second.fd << ", size = " << size;
+    if (ftruncate(entry->second.fd, 0) != 0) {
+      LOG(ERROR) << "failed to truncate the released segment: "
+                 << strerror(errno);
+    }
   }
 
   mmap_records.erase(entry);
@@ -158,6 +178,10 @@ int fake_munmap(void* addr, int64_t size) {
 }
 
 void* DLmallocAllocator::Init(const size_t size) {
+  if (hugetlb_page_size() != 0) {
+    // segments must be a multiple of the huge page size
+    SetMallocGranularity(hugetlb_page_size());
+  }
   // We are using a single memory-mapped file by mallocing and freeing a single
   // large amount of space up front.
   void* pointer = dlmemalign(kBlockSize, size - 256 * sizeof(size_t));
@@ -175,6 +199,41 @@ void* DLmallocAllocator::Allocate(const size_t bytes, const size_t alignment) {
 
 void DLmallocAllocator::Free(void* pointer, size_t) { dlfree(pointer); }
 
+void DLmallocAllocator::Trim() { dlmalloc_trim(0); }
+
+void DLmallocAllocator::FreeSpace(size_t& free_bytes, size_t& largest_chunk) {
+  struct free_space_t {
+    size_t free_bytes = 0;
+    size_t largest_chunk = 0;
+  } result;
+  dlmalloc_inspect_all(
+      [](void* start, void* end, size_t used_bytes, void* arg) {
+        if (used_bytes == 0) {
+          auto result = static_cast<free_space_t*>(arg);
+          size_t size = reinterpret_cast<uintptr_t>(end) -
+                        reinterpret_cast<uintptr_t>(start);
+          result->free_bytes += size;
+          result->largest_chunk = std::max(result->largest_chunk, size);
+        }
+      },
+      &result);
+  free_bytes = result.free_bytes;
+  largest_chunk = result.largest_chunk;
+}
+
+json DLmallocAllocator::Stats() {
+  struct mallinfo info = dlmallinfo();
+  size_t free_bytes = 0, largest_chunk = 0;
+  FreeSpace(free_bytes, largest_chunk);
+  return json{{"footprint", dlmalloc_footprint()},
+              {"max_footprint", dlmalloc_max_footprint()},
+              {"allocated_bytes", info.uordblks},
+              {"free_bytes", info.fordblks},
+              {"free_chunks", info.ordblks},
+              {"largest_free_chunk", largest_chunk},
+              {"releasable_bytes", info.keepcost}};
+}
+
 void DLmallocAllocator::SetMallocGranularity(int value) {
   change_mparam(M_GRANULARITY, value);
 }
@@ -18,6 +18,7 @@ limitations under the License.
 
 #if defined(WITH_DLMALLOC)
 
+#include "common/util/json.h"
 #include "common/util/status.h"
 
 namespace vineyard {
@@ -32,6 +33,12 @@ class DLmallocAllocator {
 
   static void Free(void* pointer, size_t = 0);
 
+  static void Trim();
+
+  static void FreeSpace(size_t& free_bytes, size_t& largest_chunk);
+
+  static json Stats();
+
   static void SetMallocGranularity(int value);
 };
 
@@ -0,0 +1,175 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/memory/eviction.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace vineyard {
+
+std::unique_ptr<EvictionPolicy> EvictionPolicy::Make(const std::string& name) {
+  if (name == "lru") {
+    return std::unique_ptr<EvictionPolicy>(new LRUPolicy());
+  }
+  if (name == "lfu") {
+    return std::unique_ptr<EvictionPolicy>(new LFUPolicy());
+  }
+  return nullptr;
+}
+
+void LRUPolicy::Insert(const ObjectID id) {
+  if (index_.find(id) != index_.end()) {
+    return;
+  }
+  list_.emplace_front(id);
+  index_.emplace(id, list_.begin());
+}
+
+void LRUPolicy::Erase(const ObjectID id) {
+  auto iter = index_.find(id);
+  if (iter != index_.end()) {
+    list_.erase(iter->second);
+    index_.erase(iter);
+  }
+}
+
+void LRUPolicy::Touch(const ObjectID id) {
+  auto iter = index_.find(id);
+  if (iter != index_.end()) {
+    list_.splice(list_.begin(), list_, iter->second);
+  }
+}
+
+bool LRUPolicy::Pop(ObjectID& id) {
+  if (list_.empty()) {
+    return false;
+  }
+  id = list_.back();
+  list_.pop_back();
+  index_.erase(id);
+  return true;
+}
+
+bool LRUPolicy::Pop(ObjectID& id,
+                    std::function<bool(const ObjectID)> const& accepts) {
+  for (auto iter = list_.rbegin(); iter != list_.rend(); ++iter) {
+    if (accepts(*iter)) {
+      id = *iter;
+      list_.erase(std::next(iter).base());
+      index_.erase(id);
+      return true;
+    }
+  }
+  return false;
+}
+
+void LFUPolicy::Insert(const ObjectID id) {
+  if (index_.find(id) != index_.end()) {
+    return;
+  }
+  auto& bucket = buckets_[hits_[id]];
+  bucket.emplace_front(id);
+  index_.emplace(id, bucket.begin());
+}
+
+void LFUPolicy::Erase(const ObjectID id) {
+  auto iter = index_.find(id);
+  if (iter == index_.end()) {
+    return;
+  }
+  auto bucket = buckets_.find(hits_[id]);
+  bucket->second.erase(iter->second);
+  if (bucket->second.empty()) {
+    buckets_.erase(bucket);
+  }
+  index_.erase(iter);
+}
+
+void LFUPolicy::Touch(const ObjectID id) {
+  auto iter = index_.find(id);
+  uint64_t& hits = hits_[id];
+  if (iter != index_.end()) {
+    auto bucket = buckets_.find(hits);
+    auto& target = buckets_[hits + 1];
+    target.splice(target.begin(), bucket->second, iter->second);
+    if (bucket->second.empty()) {
+      buckets_.erase(bucket);
+    }
+  }
+  if (++hits >= kMaxHits) {
+    Decay();
+  }
+}
+
+void LFUPolicy::Decay() {
+  std::map<uint64_t, bucket_t> buckets;
+  for (auto& bucket : buckets_) {
+    // the hotter bucket goes to the front, i.e., is evicted later, and the
+    // iterators in `index_` are kept valid by splicing
+    auto& target = buckets[bucket.first / 2];
+    target.splice(target.begin(), bucket.second);
+  }
+  buckets_.swap(buckets);
+  for (auto iter = hits_.begin(); iter != hits_.end();) {
+    iter->second /= 2;
+    if (iter->second == 0) {
+      iter = hits_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+bool LFUPolicy::Pop(ObjectID& id) {
+  if (buckets_.empty()) {
+    return false;
+  }
+  auto bucket = buckets_.begin();
+  id = bucket->second.back();
+  bucket->second.pop_back();
+  if (bucket->second.empty()) {
+    buckets_.erase(bucket);
+  }
+  index_.erase(id);
+  return true;
+}
+
+bool LFUPolicy::Pop(ObjectID& id,
+                    std::function<bool(const ObjectID)> const& accepts) {
+  for (auto bucket = buckets_.begin(); bucket != buckets_.end(); ++bucket) {
+    for (auto iter = bucket->second.rbegin(); iter != bucket->second.rend();
+         ++iter) {
+      if (accepts(*iter)) {
+        id = *iter;
+        bucket->second.erase(std::next(iter).base());
+        if (bucket->second.empty()) {
+          buckets_.erase(bucket);
+        }
+        index_.erase(id);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void LFUPolicy::Forget(const ObjectID id) {
+  Erase(id);
+  hits_.erase(id);
+}
+
+}  // namespace vineyard
@@ -0,0 +1,148 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_MEMORY_EVICTION_H_
+#define SRC_SERVER_MEMORY_EVICTION_H_
+
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+/**
+ * @brief EvictionPolicy decides which blob should be evicted first when the
+ * bulk store runs out of memory.
+ *
+ * Only blobs that have been inserted are candidates for eviction, the bulk
+ * store inserts the blob when there's no client references it, and erases it
+ * once it is referenced again. The policy itself is not thread-safe.
+ */
+class EvictionPolicy {
+ public:
+  virtual ~EvictionPolicy() = default;
+
+  /**
+   * @brief The blob becomes a candidate for eviction.
+   */
+  virtual void Insert(const ObjectID id) = 0;
+
+  /**
+   * @brief The blob is no longer a candidate for eviction.
+   */
+  virtual void Erase(const ObjectID id) = 0;
+
+  /**
+   * @brief Record an access (hit) to the blob.
+   */
+  virtual void Touch(const ObjectID id) = 0;
+
+  /**
+   * @brief Pop the next victim, returns false if there are no candidates.
+   */
+  virtual bool Pop(ObjectID& id) = 0;
+
+  /**
+   * @brief Pop the next victim among the candidates that are accepted by
+   * `accepts`, the other candidates keep their positions.
+   */
+  virtual bool Pop(ObjectID& id,
+                   std::function<bool(const ObjectID)> const& accepts) = 0;
+
+  /**
+   * @brief Drop all states of the blob, e.g., when it has been deleted.
+   */
+  virtual void Forget(const ObjectID id) { Erase(id); }
+
+  /**
+   * @brief Create the eviction policy by name, can be "lru" or "lfu".
+   *
+   * Returns nullptr if the name is unknown.
+   */
+  static std::unique_ptr<EvictionPolicy> Make(const std::string& name);
+};
+
+/**
+ * @brief Evicts the least recently used blob first.
+ */
+class LRUPolicy : public EvictionPolicy {
+ public:
+  void Insert(const ObjectID id) override;
+
+  void Erase(const ObjectID id) override;
+
+  void Touch(const ObjectID id) override;
+
+  bool Pop(ObjectID& id) override;
+
+  bool Pop(ObjectID& id,
+           std::function<bool(const ObjectID)> const& accepts) override;
+
+ private:
+  // front is the most recently used.
+  std::list<ObjectID> list_;
+  std::unordered_map<ObjectID, std::list<ObjectID>::iterator> index_;
+};
+
+/**
+ * @brief Evicts the least frequently used blob first, ties are broken by
+ * recency.
+ *
+ * The hit count of a blob is kept across being referenced and released, and
+ * is discarded only when the blob is forgot. Once a count reaches
+ * `kMaxHits` all counts are halved, thus the blobs that were hot long ago
+ * don't outlive the ones that are hot now.
+ */
+class LFUPolicy : public EvictionPolicy {
+ public:
+  void Insert(const ObjectID id) override;
+
+  void Erase(const ObjectID id) override;
+
+  void Touch(const ObjectID id) override;
+
+  bool Pop(ObjectID& id) override;
+
+  bool Pop(ObjectID& id,
+           std::function<bool(const ObjectID)> const& accepts) override;
+
+  void Forget(const ObjectID id) override;
+
+  static constexpr uint64_t kMaxHits = 1024;
+
+ private:
+  /**
+   * @brief Halve the hit counts, and drop the counts that become zero.
+   */
+  void Decay();
+
+  using bucket_t = std::list<ObjectID>;
+
+  // hits of all known blobs
+  std::unordered_map<ObjectID, uint64_t> hits_;
+  // candidates, grouped by hits, the front of bucket is the most recently used
+  std::map<uint64_t, bucket_t> buckets_;
+  std::unordered_map<ObjectID, bucket_t::iterator> index_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_MEMORY_EVICTION_H_
@@ -0,0 +1,133 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/memory/far_tier.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+
+#include "common/util/logging.h"
+#include "server/memory/malloc.h"
+
+namespace vineyard {
+
+namespace memory {
+
+FarTier::~FarTier() {
+  if (base_ != nullptr) {
+    munmap(base_, size_);
+  }
+  if (fd_ != -1) {
+    close(fd_);
+  }
+}
+
+Status FarTier::Init(const std::string& path, const size_t size) {
+  int fd = open(path.c_str(), O_CREAT | O_RDWR, 0600);
+  if (fd == -1) {
+    return Status::IOError("Failed to open the far memory '" + path +
+                           "': " + strerror(errno));
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    auto status = Status::IOError("Failed to stat the far memory '" + path +
+                                  "': " + strerror(errno));
+    close(fd);
+    return status;
+  }
+  size_t mapped_size = size;
+  if (S_ISREG(st.st_mode)) {
+    if (mapped_size == 0) {
+      mapped_size = static_cast<size_t>(st.st_size);
+    } else if (static_cast<size_t>(st.st_size) < mapped_size &&
+               ftruncate(fd, mapped_size) == -1) {
+      auto status = Status::IOError("Failed to extend the far memory '" +
+                                    path + "': " + strerror(errno));
+      close(fd);
+      return status;
+    }
+  }
+  if (mapped_size == 0) {
+    close(fd);
+    return Status::Invalid("The size of the far memory '" + path +
+                           "' is required");
+  }
+  void* pointer =
+      mmap(nullptr, mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (pointer == MAP_FAILED) {
+    auto status = Status::IOError("Failed to map the far memory '" + path +
+                                  "': " + strerror(errno));
+    close(fd);
+    return status;
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  fd_ = fd;
+  base_ = static_cast<uint8_t*>(pointer);
+  size_ = mapped_size;
+  free_ranges_.clear();
+  free_ranges_.emplace(0, mapped_size);
+  LOG(INFO) << "Cold blobs will be migrated to the far memory '" << path
+            << "' of " << mapped_size << " bytes";
+  return Status::OK();
+}
+
+uint8_t* FarTier::Allocate(const size_t size) {
+  size_t aligned = (size + kBlockSize - 1) & ~(kBlockSize - 1);
+  std::lock_guard<std::mutex> guard(mutex_);
+  for (auto iter = free_ranges_.begin(); iter != free_ranges_.end(); ++iter) {
+    if (iter->second < aligned) {
+      continue;
+    }
+    size_t offset = iter->first, left = iter->second - aligned;
+    free_ranges_.erase(iter);
+    if (left > 0) {
+      free_ranges_.emplace(offset + aligned, left);
+    }
+    allocated_ += aligned;
+    return base_ + offset;
+  }
+  return nullptr;
+}
+
+void FarTier::Free(uint8_t* pointer, const size_t size) {
+  size_t aligned = (size + kBlockSize - 1) & ~(kBlockSize - 1);
+  size_t offset = pointer - base_;
+  std::lock_guard<std::mutex> guard(mutex_);
+  allocated_ -= aligned;
+  auto iter = free_ranges_.emplace(offset, aligned).first;
+  // merge with the next range, and then the previous one
+  auto next = std::next(iter);
+  if (next != free_ranges_.end() && iter->first + iter->second == next->first) {
+    iter->second += next->second;
+    free_ranges_.erase(next);
+  }
+  if (iter != free_ranges_.begin()) {
+    auto prev = std::prev(iter);
+    if (prev->first + prev->second == iter->first) {
+      prev->second += iter->second;
+      free_ranges_.erase(iter);
+    }
+  }
+}
+
+}  // namespace memory
+
+}  // namespace vineyard
@@ -0,0 +1,93 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_MEMORY_FAR_TIER_H_
+#define SRC_SERVER_MEMORY_FAR_TIER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+namespace memory {
+
+/**
+ * @brief FarTier is a second, larger and slower memory tier of the bulk
+ * store, i.e., a file on a DAX filesystem (PMEM, or CXL-attached memory
+ * exposed as a DAX device) that is mapped as a whole. Sealed blobs that are
+ * cold are migrated to the far tier rather than being spilled, and the
+ * clients map the far tier by its fd as they map the shared memory.
+ *
+ * Chunks are allocated first-fit from the free ranges, which are coalesced
+ * when chunks are freed. The allocations are rare (once per migration) and
+ * large, thus a simple ordered map is enough.
+ */
+class FarTier {
+ public:
+  ~FarTier();
+
+  /**
+   * @brief Map `size` bytes of the file (or the DAX device) at `path`, the
+   * file is created (or extended) if it is not large enough, and the size of
+   * an existing file is used when `size` is zero.
+   */
+  Status Init(const std::string& path, const size_t size);
+
+  bool Enabled() const { return base_ != nullptr; }
+
+  uint8_t* Allocate(const size_t size);
+
+  void Free(uint8_t* pointer, const size_t size);
+
+  bool Contains(const uint8_t* pointer) const {
+    return pointer >= base_ && pointer < base_ + size_;
+  }
+
+  /**
+   * @brief The fd, the size of the mapping and the offset of the pointer,
+   * for the clients to map the chunk, see also `GetMallocMapinfo()`.
+   */
+  void Mapinfo(const uint8_t* pointer, int* fd, int64_t* map_size,
+               ptrdiff_t* offset) const {
+    *fd = fd_;
+    *map_size = static_cast<int64_t>(size_);
+    *offset = pointer - base_;
+  }
+
+  size_t Footprint() const { return allocated_; }
+
+  size_t FootprintLimit() const { return size_; }
+
+ private:
+  int fd_ = -1;
+  uint8_t* base_ = nullptr;
+  size_t size_ = 0;
+  size_t allocated_ = 0;
+
+  // the free ranges, by their offsets
+  std::map<size_t, size_t> free_ranges_;
+  std::mutex mutex_;
+};
+
+}  // namespace memory
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_MEMORY_FAR_TIER_H_
@@ -15,7 +15,20 @@ limitations under the License.
 
 #if defined(WITH_JEMALLOC)
 
+#include <stdlib.h>
 #include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#define JEMALLOC_NO_DEMANGLE
+#include "jemalloc/include/jemalloc/jemalloc.h"
+#undef JEMALLOC_NO_DEMANGLE
 
 #include "server/memory/jemalloc.h"
 #include "server/memory/malloc.h"
@@ -27,18 +40,66 @@ namespace memory {
 void* JemallocAllocator::Init(const size_t size) {
   // create memory using mmap
   int fd = create_buffer(size);
-  void* space = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-  if (space == nullptr) {
-    return space;
+  void* space = mmap(NULL, segment_size(size), PROT_READ | PROT_WRITE,
+                     MAP_SHARED, fd, 0);
+  if (space == MAP_FAILED) {
+    return nullptr;
   }
+  advise_huge_pages(space, segment_size(size));
+  populate_segment(space, segment_size(size));
 
-  MmapRecord& record = mmap_records[space];
-  record.fd = fd;
-  record.size = size;
+  {
+    std::lock_guard<std::mutex> guard(mmap_records_mutex);
+    MmapRecord& record = mmap_records[space];
+    record.fd = fd;
+    record.size = size;
+  }
 
   return Jemalloc::Init(space, size);
 }
 
+json JemallocAllocator::Stats() {
+  std::string stats;
+  vineyard_je_malloc_stats_print(
+      [](void* opaque, const char* message) {
+        static_cast<std::string*>(opaque)->append(message);
+      },
+      &stats, "J");
+  json tree = json::parse(stats, nullptr, false);
+  return tree.is_discarded() ? json::object() : tree;
+}
+
+Status JemallocAllocator::DumpProfile(std::string& profile) {
+  bool enabled = false;
+  size_t enabled_size = sizeof(enabled);
+  if (vineyard_je_mallctl("opt.prof", &enabled, &enabled_size, nullptr, 0) !=
+          0 ||
+      !enabled) {
+    return Status::NotImplemented(
+        "the heap profiling of jemalloc is not enabled");
+  }
+  char path[] = "/tmp/vineyardd.heap.XXXXXX";
+  int fd = mkstemp(path);
+  if (fd == -1) {
+    return Status::IOError("Failed to create the heap profile: " +
+                           std::string(strerror(errno)));
+  }
+  close(fd);
+  const char* filename = path;
+  if (auto ret = vineyard_je_mallctl("prof.dump", nullptr, nullptr, &filename,
+                                     sizeof(const char*))) {
+    unlink(path);
+    return Status::IOError("Failed to dump the heap profile: " +
+                           std::string(strerror(ret)));
+  }
+  std::ifstream file(path);
+  std::stringstream ss;
+  ss << file.rdbuf();
+  profile = ss.str();
+  unlink(path);
+  return Status::OK();
+}
+
 }  // namespace memory
 
 }  // namespace vineyard
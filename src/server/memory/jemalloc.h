@@ -18,7 +18,11 @@ limitations under the License.
 
 #if defined(WITH_JEMALLOC)
 
+#include <string>
+
 #include "common/memory/jemalloc.h"
+#include "common/util/json.h"
+#include "common/util/status.h"
 
 namespace vineyard {
 
@@ -27,6 +31,18 @@ namespace memory {
 class JemallocAllocator : public Jemalloc {
  public:
   void* Init(const size_t size);
+
+  /**
+   * @brief The statistics of jemalloc, as reported by `malloc_stats_print`.
+   */
+  static json Stats();
+
+  /**
+   * @brief Dump the heap profile of jemalloc, which requires a jemalloc
+   * built with `--enable-prof`, and vineyardd running with
+   * `VINEYARD_JE_MALLOC_CONF=prof:true`.
+   */
+  static Status DumpProfile(std::string& profile);
 };
 
 }  // namespace memory
@@ -29,8 +29,14 @@
 #include "server/memory/malloc.h"
 
 #include <stddef.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <cstring>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "common/util/logging.h"
@@ -39,8 +45,12 @@ namespace vineyard {
 
 namespace memory {
 
+static SegmentOptions segment_options;
+
 std::unordered_map<void*, MmapRecord> mmap_records;
 
+std::mutex mmap_records_mutex;
+
 static void* pointer_advance(void* p, ptrdiff_t n) {
   return (unsigned char*) p + n;
 }
@@ -49,10 +59,155 @@ static ptrdiff_t pointer_distance(void const* pfrom, void const* pto) {
   return (unsigned char const*) pto - (unsigned char const*) pfrom;
 }
 
+static size_t system_page_size() { return (size_t) sysconf(_SC_PAGESIZE); }
+
+void configure_segments(SegmentOptions const& options) {
+  segment_options = options;
+}
+
+size_t hugetlb_page_size() {
+  static size_t page_size = []() -> size_t {
+    std::string const& hugepages = segment_options.hugepages;
+    if (hugepages == "2M" || hugepages == "2m") {
+      return 2UL * 1024 * 1024;
+    }
+    if (hugepages == "1G" || hugepages == "1g") {
+      return 1UL * 1024 * 1024 * 1024;
+    }
+    if (!hugepages.empty() && hugepages != "thp") {
+      LOG(WARNING) << "Unknown value for --hugepages: '" << hugepages
+                   << "', huge pages are not enabled";
+    }
+    return 0;
+  }();
+  return page_size;
+}
+
+size_t segment_page_size() {
+  static size_t page_size = hugetlb_page_size() == 0 ? system_page_size()
+                                                     : hugetlb_page_size();
+  return page_size;
+}
+
+int64_t segment_size(int64_t size) {
+  if (hugetlb_page_size() == 0) {
+    return size;
+  }
+  int64_t alignment = static_cast<int64_t>(hugetlb_page_size());
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+void advise_huge_pages(void* pointer, size_t size) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (segment_options.hugepages == "thp") {
+    if (madvise(pointer, size, MADV_HUGEPAGE)) {
+      LOG(WARNING) << "madvise(MADV_HUGEPAGE) failed: " << strerror(errno);
+    }
+  }
+#endif
+}
+
+static void touch_pages(uint8_t* pointer, size_t size, size_t page_size) {
+  for (size_t offset = 0; offset < size; offset += page_size) {
+    // an atomic no-op write, keeps the content even if others are writing
+    __atomic_fetch_add(pointer + offset, 0, __ATOMIC_RELAXED);
+  }
+}
+
+static void populate_pages(uint8_t* pointer, size_t size, size_t page_size) {
+#if defined(__linux__)
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+  // available since Linux 5.14, falls back to touching the pages
+  if (madvise(pointer, size, MADV_POPULATE_WRITE) == 0) {
+    return;
+  }
+#endif
+  touch_pages(pointer, size, page_size);
+}
+
+void prefault_pages(void* pointer, size_t size, size_t concurrency) {
+  uint8_t* base = static_cast<uint8_t*>(pointer);
+  size_t page_size = segment_page_size();
+  // madvise requires the address to be aligned to pages
+  uint8_t* aligned = reinterpret_cast<uint8_t*>(
+      (reinterpret_cast<uintptr_t>(base) + page_size - 1) & ~(page_size - 1));
+  if (aligned > base) {
+    touch_pages(base, 1, page_size);
+  }
+  if (aligned >= base + size) {
+    return;
+  }
+  size_t length = base + size - aligned;
+  size_t pages = (length + page_size - 1) / page_size;
+  concurrency = std::max<size_t>(1, std::min(concurrency, pages));
+  if (concurrency == 1) {
+    populate_pages(aligned, length, page_size);
+    return;
+  }
+  size_t chunk = (pages + concurrency - 1) / concurrency * page_size;
+  std::vector<std::thread> workers;
+  for (size_t offset = 0; offset < length; offset += chunk) {
+    workers.emplace_back(populate_pages, aligned + offset,
+                         std::min(chunk, length - offset), page_size);
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+void populate_segment(void* pointer, size_t size) {
+  if (segment_options.prefault) {
+    size_t concurrency = segment_options.prefault_threads > 0
+                             ? segment_options.prefault_threads
+                             : std::thread::hardware_concurrency();
+    prefault_pages(pointer, size, concurrency);
+    VLOG(2) << "Pre-faulted " << size << " bytes shared memory at "
+            << pointer;
+  }
+  if (segment_options.mlock) {
+    if (mlock(pointer, size)) {
+      LOG(WARNING) << "Failed to lock " << size
+                   << " bytes shared memory: " << strerror(errno)
+                   << ", please check 'ulimit -l'";
+    }
+  }
+}
+
+#if defined(__linux__) && defined(MFD_HUGETLB)
+static int create_hugetlb_buffer(int64_t size) {
+  unsigned int flags = MFD_HUGETLB;
+#if defined(MFD_HUGE_2MB) && defined(MFD_HUGE_1GB)
+  flags |= hugetlb_page_size() == 2UL * 1024 * 1024 ? MFD_HUGE_2MB
+                                                    : MFD_HUGE_1GB;
+#endif
+  int fd = memfd_create("vineyard-bulk", flags);
+  if (fd < 0) {
+    LOG(ERROR) << "create_buffer failed to create hugetlb file: "
+               << strerror(errno);
+    return -1;
+  }
+  if (ftruncate(fd, (off_t) segment_size(size)) != 0) {
+    LOG(ERROR) << "failed to ftruncate hugetlb file, are there enough huge "
+                  "pages reserved? "
+               << strerror(errno);
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+#endif
+
 // Create a buffer. This is creating a temporary file and then
 // immediately unlinking it so we do not leave traces in the system.
 int create_buffer(int64_t size) {
   int fd = -1;
+#if defined(__linux__) && defined(MFD_HUGETLB)
+  if (hugetlb_page_size() != 0) {
+    return create_hugetlb_buffer(size);
+  }
+#endif
 #ifdef _WIN32
   if (!CreateFileMapping(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
                          (DWORD)((uint64_t) size >> (CHAR_BIT * sizeof(DWORD))),
@@ -95,6 +250,7 @@ void GetMallocMapinfo(void* addr, int* fd, int64_t* map_size,
                       ptrdiff_t* offset) {
   // About the efficiences: the records size usually small, thus linear search
   // is enough.
+  std::lock_guard<std::mutex> guard(mmap_records_mutex);
   for (const auto& entry : mmap_records) {
     if (addr >= entry.first &&
         addr < pointer_advance(entry.first, entry.second.size)) {
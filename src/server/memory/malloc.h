@@ -32,6 +32,8 @@
 #include <inttypes.h>
 #include <stddef.h>
 
+#include <mutex>
+#include <string>
 #include <unordered_map>
 
 namespace vineyard {
@@ -54,12 +56,56 @@ struct MmapRecord {
 /// and size.
 extern std::unordered_map<void*, MmapRecord> mmap_records;
 
+/// Protects `mmap_records`, as new segments can be mapped (and unused ones be
+/// released) by the allocator at any time when the shared memory grows.
+extern std::mutex mmap_records_mutex;
+
+/// How the shared memory segments are backed and populated, see also the
+/// `--hugepages`, `--prefault`, `--prefault_threads` and `--mlock` options.
+struct SegmentOptions {
+  // "thp" for transparent huge pages, "2M" or "1G" for hugetlbfs pages,
+  // empty means disabled
+  std::string hugepages;
+  bool prefault = false;
+  // 0 means the number of CPU cores
+  size_t prefault_threads = 0;
+  bool mlock = false;
+};
+
+/// Must be called before the shared memory is mapped, i.e., before
+/// `BulkAllocator::Init`.
+void configure_segments(SegmentOptions const& options);
+
 // Create a buffer. This is creating a temporary file and then
 // immediately unlinking it so we do not leave traces in the system.
 //
 // Returns a fd as expected.
 int create_buffer(int64_t size);
 
+/// The size of hugetlbfs pages that back the shared memory, returns 0 if the
+/// shared memory is backed by normal (or transparent huge) pages.
+///
+/// See also `SegmentOptions::hugepages`.
+size_t hugetlb_page_size();
+
+/// The granularity of mapping and recycling the shared memory, i.e., the
+/// hugetlbfs page size if enabled, otherwise the system page size.
+size_t segment_page_size();
+
+/// Round up the size of a shared memory segment to `segment_page_size()`.
+int64_t segment_size(int64_t size);
+
+/// Advise the kernel to back the segment with transparent huge pages, if
+/// `SegmentOptions::hugepages` is "thp".
+void advise_huge_pages(void* pointer, size_t size);
+
+/// Fault in the pages of the given range, using `concurrency` threads.
+void prefault_pages(void* pointer, size_t size, size_t concurrency = 1);
+
+/// Pre-fault and lock the pages of a newly mapped segment, if
+/// `SegmentOptions::prefault` and `SegmentOptions::mlock` are enabled.
+void populate_segment(void* pointer, size_t size);
+
 }  // namespace memory
 
 }  // namespace vineyard
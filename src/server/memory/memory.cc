@@ -28,18 +28,38 @@
 
 #include "server/memory/memory.h"
 
+#include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <limits>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#include "boost/filesystem/operations.hpp"
+#include "boost/filesystem/path.hpp"
+
+#include "common/memory/cow.h"
+#include "common/memory/cuda.h"
+#include "common/memory/memcpy.h"
+#include "common/util/checksum.h"
 #include "common/util/logging.h"
+#include "common/util/trace.h"
 #include "server/memory/allocator.h"
 #include "server/memory/malloc.h"
+#include "server/memory/numa.h"
+#include "server/memory/recycler.h"
 
 namespace vineyard {
 
@@ -48,10 +68,6 @@ using memory::kBlockSize;
 
 namespace memory {
 
-static inline size_t system_page_size() {
-  return (size_t) sysconf(_SC_PAGESIZE);
-}
-
 static inline uintptr_t align_up(const uintptr_t address,
                                  const size_t alignment) {
   return (address + alignment - 1) & ~(alignment - 1);
@@ -62,35 +78,18 @@ static inline uintptr_t align_down(const uintptr_t address,
   return address & ~(alignment - 1);
 }
 
-static inline void recycle_resident_memory(const uintptr_t aligned_left,
-                                           const uintptr_t aligned_right) {
-  if (aligned_left != aligned_right) {
-    /**
-     * Notes [Recycle Pages with madvise]:
-     *
-     * 1. madvise(.., MADV_FREE) cannot be used for shared memory, thus we use
-     * `MADV_DONTNEED`.
-     * 2. madvise(...) requires alignment to PAGE size.
-     *
-     * See also: https://man7.org/linux/man-pages/man2/madvise.2.html
-     */
-    if (madvise(reinterpret_cast<void*>(aligned_left),
-                aligned_right - aligned_left, MADV_DONTNEED)) {
-      LOG(ERROR) << "madvise: " << errno << " -> " << strerror(errno);
-    }
-  }
-}
-
-static inline void recycle_resident_memory(const uintptr_t base, size_t left,
+static inline void recycle_resident_memory(PageRecycler& recycler,
+                                           const uintptr_t base, size_t left,
                                            size_t right) {
-  static size_t page_size = system_page_size();
+  // n.b.: hugetlbfs pages must be recycled at the granularity of huge pages.
+  static size_t page_size = segment_page_size();
   uintptr_t aligned_left = align_up(base + left, page_size),
             aligned_right = align_down(base + right, page_size);
   DVLOG(10) << "recycle memory: " << reinterpret_cast<void*>(base + left) << "("
             << reinterpret_cast<void*>(aligned_left) << ") to "
             << reinterpret_cast<void*>(base + right) << "("
             << reinterpret_cast<void*>(aligned_right) << ")";
-  recycle_resident_memory(aligned_left, aligned_right);
+  recycler.Recycle(aligned_left, aligned_right);
 }
 
 /**
@@ -98,7 +97,8 @@ static inline void recycle_resident_memory(const uintptr_t base, size_t left,
  *
  * n.b.: the intervals may overlap.
  */
-static void recycle_arena(const uintptr_t base, const size_t size,
+static void recycle_arena(PageRecycler& recycler, const uintptr_t base,
+                          const size_t size,
                           std::vector<size_t> const& offsets,
                           std::vector<size_t> const& sizes) {
   std::map<size_t, int32_t> points;
@@ -118,16 +118,173 @@ static void recycle_arena(const uintptr_t base, const size_t size,
     }
     if (markersum == 0) {
       // release memory in the untouched interval.
-      recycle_resident_memory(base, head->first, next->first);
+      recycle_resident_memory(recycler, base, head->first, next->first);
     }
     head = next;
   }
 }
+
+/**
+ * @brief Write the content of a blob to the given file, the file will be
+ * truncated if it already exists.
+ */
+static Status spill_to_file(const std::string& path, const uint8_t* data,
+                            const size_t size) {
+  int fd = open(path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0600);
+  if (fd == -1) {
+    return Status::IOError("Failed to open spill file '" + path +
+                           "': " + strerror(errno));
+  }
+  size_t offset = 0;
+  while (offset < size) {
+    ssize_t nbytes = write(fd, data + offset, size - offset);
+    if (nbytes == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      auto status = Status::IOError("Failed to write spill file '" + path +
+                                    "': " + strerror(errno));
+      close(fd);
+      unlink(path.c_str());
+      return status;
+    }
+    offset += nbytes;
+  }
+  close(fd);
+  return Status::OK();
+}
+
+/**
+ * @brief Load the content of a blob back from the given file.
+ */
+static Status load_from_file(const std::string& path, uint8_t* data,
+                             const size_t size) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return Status::IOError("Failed to open spill file '" + path +
+                           "': " + strerror(errno));
+  }
+  size_t offset = 0;
+  while (offset < size) {
+    ssize_t nbytes = read(fd, data + offset, size - offset);
+    if (nbytes == -1 && errno == EINTR) {
+      continue;
+    }
+    if (nbytes <= 0) {
+      close(fd);
+      return Status::IOError("Failed to read spill file '" + path + "'");
+    }
+    offset += nbytes;
+  }
+  close(fd);
+  return Status::OK();
+}
+
+// the blobs start at page boundaries of the checkpoint file
+constexpr size_t kCheckpointAlignment = 4096;
+// each read or write of the content of a checkpoint is at most that large
+constexpr size_t kCheckpointChunkSize = 8 * 1024 * 1024;
+// the checkpoint is usually bound by the disk, rather than the threads
+constexpr size_t kMaxCheckpointThreads = 8;
+constexpr char kCheckpointMagic[8] = {'V', 'Y', 'C', 'K', 'P', 'T', '0', '1'};
+
+/**
+ * @brief The end of a checkpoint file, which locates the manifest, as the
+ * manifest is written after the content of blobs.
+ */
+struct CheckpointTrailer {
+  uint64_t manifest_offset;
+  uint64_t manifest_size;
+  char magic[8];
+};
+
+/**
+ * @brief A blob in memory and its location in the checkpoint file.
+ */
+struct CheckpointRange {
+  uint8_t* data;
+  size_t size;
+  uint64_t offset;
+};
+
+static Status checkpoint_io(int fd, uint8_t* data, size_t const size,
+                            uint64_t const offset, bool const write,
+                            const std::string& path) {
+  size_t done = 0;
+  while (done < size) {
+    ssize_t nbytes =
+        write ? pwrite(fd, data + done, size - done, offset + done)
+              : pread(fd, data + done, size - done, offset + done);
+    if (nbytes == -1 && errno == EINTR) {
+      continue;
+    }
+    if (nbytes <= 0) {
+      return Status::IOError("Failed to " +
+                             std::string(write ? "write" : "read") +
+                             " the checkpoint '" + path +
+                             "': " + strerror(nbytes == 0 ? EIO : errno));
+    }
+    done += nbytes;
+  }
+  return Status::OK();
+}
+
+/**
+ * @brief Transfer the ranges between the memory and the checkpoint file in
+ * parallel, each thread takes a contiguous run of ranges of roughly the
+ * same bytes, thus its accesses to the file are sequential, in large chunks.
+ */
+static Status checkpoint_ranges(int fd,
+                                std::vector<CheckpointRange> const& ranges,
+                                bool const write, const std::string& path) {
+  size_t total = 0;
+  for (auto const& range : ranges) {
+    total += range.size;
+  }
+  size_t concurrency = std::min<size_t>(
+      {kMaxCheckpointThreads,
+       std::max<size_t>(std::thread::hardware_concurrency(), 1),
+       std::max<size_t>(total / kCheckpointChunkSize, 1)});
+  std::vector<Status> statuses(concurrency);
+  std::vector<std::thread> workers;
+  size_t begin = 0, accumulated = 0;
+  for (size_t index = 0; index < concurrency; ++index) {
+    size_t end = begin;
+    size_t const target = total / concurrency * (index + 1);
+    while (end < ranges.size() &&
+           (accumulated < target || index + 1 == concurrency)) {
+      accumulated += ranges[end++].size;
+    }
+    workers.emplace_back([&, index, begin, end]() {
+      for (size_t i = begin; i < end && statuses[index].ok(); ++i) {
+        auto const& range = ranges[i];
+        for (size_t done = 0; done < range.size && statuses[index].ok();
+             done += kCheckpointChunkSize) {
+          statuses[index] = checkpoint_io(
+              fd, range.data + done,
+              std::min(kCheckpointChunkSize, range.size - done),
+              range.offset + done, write, path);
+        }
+      }
+    });
+    begin = end;
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  for (auto const& status : statuses) {
+    RETURN_ON_ERROR(status);
+  }
+  return Status::OK();
+}
 }  // namespace memory
 
 std::set<ObjectID> BulkStore::Arena::spans{};
 
 BulkStore::~BulkStore() {
+  // the queued ranges must be released before the memory that they belong to
+  // is unmapped, e.g., by trimming the heap when deleting the blobs below
+  recycler_.Stop();
   std::vector<ObjectID> object_ids;
   object_ids.reserve(objects_.size());
   for (auto iter = objects_.begin(); iter != objects_.end(); iter++) {
@@ -136,18 +293,38 @@ BulkStore::~BulkStore() {
   for (auto const& item : object_ids) {
     VINEYARD_DISCARD(Delete(item));
   }
+  // the arenas that haven't been finalized
+  for (auto const& item : arenas_) {
+    munmap(reinterpret_cast<void*>(item.second.base), item.second.size);
+    close(item.second.fd);
+  }
+  arenas_.clear();
 }
 
-Status BulkStore::PreAllocate(const size_t size) {
+Status BulkStore::PreAllocate(const size_t size, const size_t initial_size) {
+  size_t reserved_size = initial_size == 0 ? size : std::min(size, initial_size);
+#if defined(WITH_JEMALLOC)
+  if (reserved_size < size) {
+    LOG(WARNING) << "The jemalloc allocator cannot grow the shared memory, "
+                    "the whole shared memory will be mapped at startup";
+    reserved_size = size;
+  }
+#endif
   BulkAllocator::SetFootprintLimit(size);
-  void* pointer = BulkAllocator::Init(size);
+  void* pointer = BulkAllocator::Init(reserved_size);
 
   if (pointer == nullptr) {
     return Status::NotEnoughMemory("mmap failed, size = " +
-                                   std::to_string(size));
+                                   std::to_string(reserved_size));
+  }
+  growable_ = reserved_size < size;
+  if (growable_) {
+    LOG(INFO) << "Starting with " << reserved_size
+              << " bytes shared memory, which grows on demand up to " << size
+              << " bytes";
   }
 
-  // insert a special marker for obtaining the whole shared memory range
+  // insert a special marker for obtaining the initial shared memory segment
   ObjectID object_id = GenerateBlobID(
       reinterpret_cast<void*>(std::numeric_limits<uintptr_t>::max()));
   int fd = -1;
@@ -156,26 +333,95 @@ Status BulkStore::PreAllocate(const size_t size) {
   GetMallocMapinfo(pointer, &fd, &map_size, &offset);
   objects_.emplace(
       object_id,
-      std::make_shared<Payload>(object_id, size, static_cast<uint8_t*>(pointer),
-                                fd, map_size, offset));
+      std::make_shared<Payload>(object_id, reserved_size,
+                                static_cast<uint8_t*>(pointer), fd, map_size,
+                                offset));
   return Status::OK();
 }
 
 // Allocate memory
 uint8_t* BulkStore::AllocateMemory(size_t size, int* fd, int64_t* map_size,
                                    ptrdiff_t* offset) {
+  auto allocate = [this](const size_t size) -> uint8_t* {
+    if (slab_.Accepts(size)) {
+      return reinterpret_cast<uint8_t*>(slab_.Allocate(size));
+    }
+    return reinterpret_cast<uint8_t*>(
+        BulkAllocator::Memalign(size, kBlockSize));
+  };
   // Try to evict objects until there is enough space.
-  uint8_t* pointer = nullptr;
-  pointer =
-      reinterpret_cast<uint8_t*>(BulkAllocator::Memalign(size, kBlockSize));
+  uint8_t* pointer = allocate(size);
+  if (pointer == nullptr && compaction_enabled_ &&
+      Footprint() + size <= FootprintLimit()) {
+    // there's enough free space in total, but no hole is large enough
+    if (Compact() > 0) {
+      pointer = allocate(size);
+    }
+  }
+  if (pointer == nullptr && policy_ != nullptr) {
+    std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+    while (pointer == nullptr && EvictColdObjects(size).ok()) {
+      pointer = allocate(size);
+    }
+  }
   if (pointer) {
     GetMallocMapinfo(pointer, fd, map_size, offset);
   }
   return pointer;
 }
 
+void BulkStore::FreeMemory(uint8_t* pointer, const size_t size) {
+  if (far_.Contains(pointer)) {
+    far_.Free(pointer, size);
+  } else if (slab_.Accepts(size)) {
+    slab_.Free(pointer, size);
+  } else {
+    BulkAllocator::Free(pointer, size);
+  }
+}
+
+void BulkStore::ReleaseMemory(std::shared_ptr<Payload> const& object) {
+  if (object->IsDevice()) {
+    auto status = memory::cuda_free(object->device, object->pointer);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to free the device blob "
+                   << ObjectIDToString(object->object_id) << ": "
+                   << status.ToString();
+    }
+    device_footprint_.fetch_sub(object->data_size);
+    object->pointer = nullptr;
+    return;
+  }
+  Unindex(object);
+  Unmovable(object);
+  if (object->IsCopyOnWrite()) {
+    memory::UnmapPageExtents(object->extents,
+                             object->pointer - object->data_offset);
+    if (object->cow_pages != nullptr) {
+      BulkAllocator::Free(object->cow_pages, object->cow_pages_size);
+    }
+    object->cow_pages = nullptr;
+  } else if (object->cow_parent == nullptr) {
+    FreeMemory(object->pointer, object->data_size);
+  }
+  // a deduplicated blob owns no memory at all
+  object->pointer = nullptr;
+  auto parent = std::move(object->cow_parent);
+  if (parent != nullptr && --parent->cow_children == 0) {
+    if (parent->cow_deleted) {
+      ReleaseMemory(parent);
+    } else if (policy_ != nullptr && parent->ref_cnt == 0 &&
+               !parent->IsPageShared()) {
+      // may have been popped by the eviction policy in the meantime
+      policy_->Insert(parent->object_id);
+    }
+  }
+}
+
 Status BulkStore::Create(const size_t data_size, ObjectID& object_id,
-                         std::shared_ptr<Payload>& object) {
+                         std::shared_ptr<Payload>& object,
+                         const int numa_node, const bool prefault) {
+  VINEYARD_TRACE_SPAN("BulkStore::Create");
   if (data_size == 0) {
     object_id = EmptyBlobID();
     object = Payload::MakeEmpty();
@@ -185,44 +431,476 @@ Status BulkStore::Create(const size_t data_size, ObjectID& object_id,
   int64_t map_size = 0;
   ptrdiff_t offset = 0;
   uint8_t* pointer = nullptr;
+  auto start = std::chrono::steady_clock::now();
   pointer = AllocateMemory(data_size, &fd, &map_size, &offset);
+  allocation_latency_[SizeBucket(data_size)].Observe(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start)
+          .count());
   if (pointer == nullptr) {
+    allocation_failures_.fetch_add(1, std::memory_order_relaxed);
     return Status::NotEnoughMemory("size = " + std::to_string(data_size));
   }
+  allocations_.fetch_add(1, std::memory_order_relaxed);
+  if (numa_node >= 0) {
+    auto status = memory::numa_bind(pointer, data_size, numa_node);
+    if (!status.ok()) {
+      VLOG(10) << "Failed to bind blob to numa node " << numa_node << ": "
+               << status.ToString();
+    }
+  }
+  if (prefault) {
+    memory::prefault_pages(pointer, data_size);
+  }
   object_id = GenerateBlobID(pointer);
+  if (!spill_path_.empty() || compaction_enabled_ || deduplication_enabled_ ||
+      restored_ || far_.Enabled()) {
+    // blobs that have been reloaded from disk, relocated by compaction,
+    // migrated between the memory tiers, deduplicated or restored from a
+    // checkpoint keep their original ids,
+    // which may conflict with the address of the newly allocated blob.
+    object_map_t::const_accessor accessor;
+    while (objects_.find(accessor, object_id)) {
+      accessor.release();
+      object_id = GenerateBlobID(GenerateObjectID());
+    }
+  }
   object = std::make_shared<Payload>(object_id, data_size, pointer, fd,
                                      map_size, offset);
   objects_.emplace(object_id, object);
+  if (compaction_enabled_ && !slab_.Accepts(data_size)) {
+    std::lock_guard<std::mutex> guard(movable_mutex_);
+    movable_.emplace(object_id, object);
+  }
   DVLOG(10) << "after allocate: " << ObjectIDToString(object_id) << ": "
             << Footprint() << "(" << FootprintLimit() << ")";
   return Status::OK();
 }
 
+Status BulkStore::Create(const size_t data_size, ObjectID& object_id,
+                         std::shared_ptr<Payload>& object,
+                         const int numa_node, const bool prefault,
+                         std::shared_ptr<const std::string> const& session) {
+  if (session == nullptr || data_size == 0) {
+    return Create(data_size, object_id, object, numa_node, prefault);
+  }
+  size_t overflow = 0;
+  {
+    std::lock_guard<std::mutex> lock(quota_mutex_);
+    auto iter = quotas_.find(*session);
+    if (iter == quotas_.end()) {
+      // a new session, which takes the default quota
+      SessionQuota quota;
+      auto fallback = quotas_.find("*");
+      if (fallback != quotas_.end()) {
+        quota.soft_limit = fallback->second.soft_limit;
+        quota.hard_limit = fallback->second.hard_limit;
+      }
+      iter = quotas_.emplace(*session, quota).first;
+    }
+    auto const& quota = iter->second;
+    if (quota.soft_limit > 0 && quota.usage + data_size > quota.soft_limit) {
+      overflow = quota.usage + data_size - quota.soft_limit;
+    }
+  }
+  if (overflow > 0 && policy_ != nullptr) {
+    // best effort, the hard limit is checked below
+    VINEYARD_DISCARD(EvictColdObjects(overflow, session));
+  }
+  {
+    std::lock_guard<std::mutex> lock(quota_mutex_);
+    auto& quota = quotas_[*session];
+    if (quota.hard_limit > 0 && quota.usage + data_size > quota.hard_limit) {
+      allocation_failures_.fetch_add(1, std::memory_order_relaxed);
+      return Status::NotEnoughMemory(
+          "size = " + std::to_string(data_size) + ", the session '" +
+          *session + "' has used " + std::to_string(quota.usage) +
+          " bytes of its hard limit " + std::to_string(quota.hard_limit));
+    }
+    // reserves the quota before allocating
+    quota.usage += data_size;
+  }
+  auto status = Create(data_size, object_id, object, numa_node, prefault);
+  if (!status.ok()) {
+    std::lock_guard<std::mutex> lock(quota_mutex_);
+    quotas_[*session].usage -= data_size;
+    return status;
+  }
+  object->session = session;
+  return Status::OK();
+}
+
+void BulkStore::SetQuota(const std::string& session, const size_t soft_limit,
+                         const size_t hard_limit) {
+  std::lock_guard<std::mutex> lock(quota_mutex_);
+  auto& quota = quotas_[session];
+  quota.soft_limit = soft_limit;
+  quota.hard_limit = hard_limit;
+}
+
+json BulkStore::SessionUsages() const {
+  json usages = json::object();
+  std::lock_guard<std::mutex> lock(quota_mutex_);
+  for (auto const& item : quotas_) {
+    if (item.first == "*") {
+      continue;
+    }
+    usages[item.first] = json{{"usage", item.second.usage},
+                              {"soft_limit", item.second.soft_limit},
+                              {"hard_limit", item.second.hard_limit}};
+  }
+  return usages;
+}
+
+void BulkStore::Charge(std::shared_ptr<Payload> const& object,
+                       const int64_t size) {
+  if (object->session == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(quota_mutex_);
+  auto iter = quotas_.find(*object->session);
+  if (iter != quotas_.end()) {
+    auto& usage = iter->second.usage;
+    usage = size < 0 ? usage - std::min(usage, static_cast<size_t>(-size))
+                     : usage + static_cast<size_t>(size);
+  }
+}
+
+Status BulkStore::CreateDevice(const size_t data_size, const int device,
+                               ObjectID& object_id,
+                               std::shared_ptr<Payload>& object) {
+  if (device < 0) {
+    return Status::Invalid("Invalid CUDA device: " + std::to_string(device));
+  }
+  if (data_size == 0) {
+    object_id = EmptyBlobID();
+    object = Payload::MakeEmpty();
+    return Status::OK();
+  }
+  uint8_t* pointer = nullptr;
+  auto status = memory::cuda_malloc(device, data_size, &pointer);
+  if (!status.ok()) {
+    allocation_failures_.fetch_add(1, std::memory_order_relaxed);
+    return status;
+  }
+  std::string ipc_handle;
+  status = memory::cuda_ipc_get_handle(device, pointer, ipc_handle);
+  if (!status.ok()) {
+    VINEYARD_DISCARD(memory::cuda_free(device, pointer));
+    return status;
+  }
+  allocations_.fetch_add(1, std::memory_order_relaxed);
+  device_footprint_.fetch_add(data_size);
+  // the device addresses may collide with the ids of relocated or reloaded
+  // blobs in the shared memory
+  object_id = GenerateBlobID(pointer);
+  {
+    object_map_t::const_accessor accessor;
+    while (objects_.find(accessor, object_id)) {
+      accessor.release();
+      object_id = GenerateBlobID(GenerateObjectID());
+    }
+  }
+  object = std::make_shared<Payload>(object_id, data_size, pointer, -1, 0, 0);
+  object->device = device;
+  object->ipc_handle = std::move(ipc_handle);
+  objects_.emplace(object_id, object);
+  DVLOG(10) << "after allocate on device " << device << ": "
+            << ObjectIDToString(object_id) << ": " << DeviceFootprint();
+  return Status::OK();
+}
+
+Status BulkStore::CreateCopyOnWrite(
+    const ObjectID parent_id,
+    std::vector<std::pair<size_t, size_t>> const& dirty, ObjectID& object_id,
+    std::shared_ptr<Payload>& object) {
+  VINEYARD_TRACE_SPAN("BulkStore::CreateCopyOnWrite");
+  static size_t page_size = memory::segment_page_size();
+  std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+  std::shared_ptr<Payload> parent;
+  {
+    object_map_t::const_accessor accessor;
+    if (!objects_.find(accessor, parent_id)) {
+      return Status::ObjectNotExists("copy-on-write: id = " +
+                                     ObjectIDToString(parent_id));
+    }
+    parent = accessor->second;
+  }
+  if (parent->data_size == 0 || parent->arena_fd != -1 || parent->IsDevice()) {
+    return Status::Invalid(
+        "Copy-on-write blobs can only be created from non-empty blobs that "
+        "are not in arenas or device memory");
+  }
+  RETURN_ON_ERROR(ReloadLocked(parent));
+
+  // the window of the child has the same pages as the one of the parent
+  size_t const data_size = parent->data_size;
+  std::vector<PageExtent> sources = parent->extents;
+  ptrdiff_t skew = parent->data_offset;
+  if (!parent->IsCopyOnWrite()) {
+    skew = parent->data_offset % page_size;
+    sources.emplace_back(PageExtent{
+        parent->store_fd, parent->map_size, parent->data_offset - skew,
+        static_cast<int64_t>(
+            memory::align_up(skew + data_size, page_size)),
+        false});
+  }
+  size_t const page_count = memory::PageExtentsSize(sources) / page_size;
+  std::vector<bool> modified(page_count, false);
+  for (auto const& range : dirty) {
+    if (range.first > data_size || range.second > data_size - range.first) {
+      return Status::Invalid("The dirty range (" + std::to_string(range.first) +
+                             ", " + std::to_string(range.second) +
+                             ") exceeds the blob of size " +
+                             std::to_string(data_size));
+    }
+    if (range.second == 0) {
+      continue;
+    }
+    size_t begin = (skew + range.first) / page_size,
+           end = memory::align_up(skew + range.first + range.second,
+                                  page_size) /
+                 page_size;
+    std::fill(modified.begin() + begin, modified.begin() + end, true);
+  }
+  int64_t const pages_size =
+      std::count(modified.begin(), modified.end(), true) * page_size;
+
+  // pins the parent, as the allocation below may evict or relocate blobs
+  parent->cow_children += 1;
+  uint8_t* pages = nullptr;
+  int fd = -1;
+  int64_t map_size = 0;
+  ptrdiff_t offset = 0;
+  if (pages_size > 0) {
+    pages = reinterpret_cast<uint8_t*>(
+        BulkAllocator::Memalign(pages_size, page_size));
+    while (pages == nullptr && policy_ != nullptr &&
+           EvictColdObjects(pages_size).ok()) {
+      pages = reinterpret_cast<uint8_t*>(
+          BulkAllocator::Memalign(pages_size, page_size));
+    }
+    if (pages == nullptr) {
+      parent->cow_children -= 1;
+      allocation_failures_.fetch_add(1, std::memory_order_relaxed);
+      return Status::NotEnoughMemory("size = " + std::to_string(pages_size));
+    }
+    GetMallocMapinfo(pages, &fd, &map_size, &offset);
+  }
+
+  // copy the modified pages, and coalesce the adjacent pages into extents
+  std::vector<PageExtent> extents;
+  auto append = [&extents](PageExtent const& extent) {
+    if (!extents.empty()) {
+      auto& last = extents.back();
+      if (last.fd == extent.fd && last.writable == extent.writable &&
+          last.offset + last.size == extent.offset) {
+        last.size += extent.size;
+        return;
+      }
+    }
+    extents.emplace_back(extent);
+  };
+  uint8_t* base = parent->pointer - skew;
+  size_t page = 0, copied = 0;
+  for (auto const& source : sources) {
+    for (int64_t delta = 0; delta < source.size; delta += page_size) {
+      if (modified[page]) {
+        memcpy(pages + copied, base + page * page_size, page_size);
+        append(PageExtent{fd, map_size, offset + static_cast<ptrdiff_t>(copied),
+                          static_cast<int64_t>(page_size), true});
+        copied += page_size;
+      } else {
+        append(PageExtent{source.fd, source.map_size, source.offset + delta,
+                          static_cast<int64_t>(page_size), false});
+      }
+      page += 1;
+    }
+  }
+
+  uint8_t* window = nullptr;
+  auto status = memory::MapPageExtents(
+      extents, [](int fd) { return fd; }, false, &window);
+  if (!status.ok()) {
+    if (pages != nullptr) {
+      BulkAllocator::Free(pages, pages_size);
+    }
+    parent->cow_children -= 1;
+    return status;
+  }
+  allocations_.fetch_add(1, std::memory_order_relaxed);
+
+  object_id = GenerateBlobID(window + skew);
+  {
+    object_map_t::const_accessor accessor;
+    while (objects_.find(accessor, object_id)) {
+      accessor.release();
+      object_id = GenerateBlobID(GenerateObjectID());
+    }
+  }
+  // the fd of the first extent, for the paths that only pass a single fd
+  object = std::make_shared<Payload>(object_id, data_size, window + skew,
+                                     extents.front().fd,
+                                     extents.front().map_size, skew);
+  object->extents = std::move(extents);
+  object->cow_parent = parent;
+  object->cow_pages = pages;
+  object->cow_pages_size = pages_size;
+  objects_.emplace(object_id, object);
+  DVLOG(10) << "after copy-on-write: " << ObjectIDToString(object_id)
+            << " of " << ObjectIDToString(parent_id) << ", " << pages_size
+            << " bytes are copied: " << Footprint() << "(" << FootprintLimit()
+            << ")";
+  return Status::OK();
+}
+
+Status BulkStore::Seal(const ObjectID id, std::shared_ptr<Payload>& object) {
+  RETURN_ON_ERROR(Get(id, object));
+  if (!deduplication_enabled_ || object->data_size == 0 ||
+      object->arena_fd != -1 || object->IsDevice() ||
+      object->IsPageShared() || object->content_indexed) {
+    return Status::OK();
+  }
+  VINEYARD_TRACE_SPAN("BulkStore::Seal");
+  // the sealing client still references the blob, thus it won't be moved
+  // while being hashed without the lock
+  uint64_t const hash = Checksum(object->pointer, object->data_size);
+  std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+  {
+    object_map_t::const_accessor accessor;
+    if (!objects_.find(accessor, id) || accessor->second != object) {
+      return Status::ObjectNotExists("seal: id = " + ObjectIDToString(id));
+    }
+  }
+  // the blob may have been mapped by other clients at its own location
+  if (object->is_spilled || object->IsPageShared() ||
+      object->content_indexed || object->ref_cnt > 1) {
+    return Status::OK();
+  }
+  auto range = dedup_index_.equal_range(hash);
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    auto const& target = iter->second;
+    if (target->data_size != object->data_size || target->is_spilled ||
+        memcmp(target->pointer, object->pointer, object->data_size) != 0) {
+      continue;
+    }
+    // alias the blob to the identical one, the id of the blob is unchanged
+    FreeMemory(object->pointer, object->data_size);
+    object->pointer = target->pointer;
+    object->store_fd = target->store_fd;
+    object->map_size = target->map_size;
+    object->data_offset = target->data_offset;
+    object->cow_parent = target;
+    target->cow_children += 1;
+    if (policy_ != nullptr) {
+      policy_->Erase(target->object_id);
+      policy_->Forget(id);
+    }
+    deduplications_.fetch_add(1, std::memory_order_relaxed);
+    deduplicated_bytes_.fetch_add(object->data_size,
+                                  std::memory_order_relaxed);
+    DVLOG(10) << "after dedup: " << ObjectIDToString(id) << " -> "
+              << ObjectIDToString(target->object_id) << ": " << Footprint()
+              << "(" << FootprintLimit() << ")";
+    return Status::OK();
+  }
+  object->content_hash = hash;
+  object->content_indexed = true;
+  dedup_index_.emplace(hash, object);
+  return Status::OK();
+}
+
+void BulkStore::Unindex(std::shared_ptr<Payload> const& object) {
+  if (!object->content_indexed) {
+    return;
+  }
+  auto range = dedup_index_.equal_range(object->content_hash);
+  for (auto iter = range.first; iter != range.second; ++iter) {
+    if (iter->second == object) {
+      dedup_index_.erase(iter);
+      break;
+    }
+  }
+  object->content_indexed = false;
+}
+
+void BulkStore::Unmovable(std::shared_ptr<Payload> const& object) {
+  if (!compaction_enabled_) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(movable_mutex_);
+  auto iter = movable_.find(object->object_id);
+  if (iter != movable_.end() && iter->second == object) {
+    movable_.erase(iter);
+  }
+}
+
 Status BulkStore::Get(const ObjectID id, std::shared_ptr<Payload>& object) {
   if (id == EmptyBlobID()) {
     object = Payload::MakeEmpty();
     return Status::OK();
   } else {
-    object_map_t::const_accessor accessor;
-    if (objects_.find(accessor, id)) {
+    {
+      object_map_t::const_accessor accessor;
+      if (!objects_.find(accessor, id)) {
+        return Status::ObjectNotExists("get: id = " + ObjectIDToString(id));
+      }
       object = accessor->second;
-      return Status::OK();
-    } else {
-      return Status::ObjectNotExists("get: id = " + ObjectIDToString(id));
     }
+    if (policy_ != nullptr) {
+      return Access(id, object);
+    }
+    return Status::OK();
   }
 }
 
 Status BulkStore::Get(const std::vector<ObjectID>& ids,
                       std::vector<std::shared_ptr<Payload>>& objects) {
-  for (auto object_id : ids) {
-    if (object_id == EmptyBlobID()) {
-      objects.push_back(Payload::MakeEmpty());
+  std::vector<std::shared_ptr<Payload>> found(ids.size());
+  for (size_t index = 0; index < ids.size(); ++index) {
+    if (ids[index] == EmptyBlobID()) {
+      found[index] = Payload::MakeEmpty();
     } else {
       object_map_t::const_accessor accessor;
-      if (objects_.find(accessor, object_id)) {
-        objects.push_back(accessor->second);
+      if (objects_.find(accessor, ids[index])) {
+        found[index] = accessor->second;
+      }
+    }
+  }
+  if (policy_ != nullptr) {
+    // the resident blobs are accessed under a single `policy_mutex_` for the
+    // whole batch, and the spilled ones are read back after it is released
+    std::vector<size_t> spilled;
+    {
+      std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+      for (size_t index = 0; index < ids.size(); ++index) {
+        if (found[index] == nullptr || ids[index] == EmptyBlobID()) {
+          continue;
+        }
+        bool resident = false;
+        auto status = AccessResident(ids[index], found[index], resident);
+        if (status.IsObjectNotExists()) {
+          found[index] = nullptr;
+          continue;
+        }
+        RETURN_ON_ERROR(status);
+        if (!resident) {
+          spilled.emplace_back(index);
+        }
+      }
+    }
+    for (auto const index : spilled) {
+      auto status = Access(ids[index], found[index]);
+      if (status.IsObjectNotExists()) {
+        found[index] = nullptr;
+        continue;
       }
+      RETURN_ON_ERROR(status);
+    }
+  }
+  for (auto& object : found) {
+    if (object != nullptr) {
+      objects.emplace_back(std::move(object));
     }
   }
   return Status::OK();
@@ -240,14 +918,30 @@ Status BulkStore::Delete(const ObjectID& object_id) {
     return Status::ObjectNotExists("delete: id = " +
                                    ObjectIDToString(object_id));
   }
-  auto& object = accessor->second;
+  auto object = accessor->second;
   if (object->arena_fd == -1) {
-    auto buff_size = object->data_size;
-    BulkAllocator::Free(object->pointer, buff_size);
+    // the blob may be evicted concurrently, revalidate it under the lock.
+    accessor.release();
+    std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+    if (!objects_.find(accessor, object_id) || accessor->second != object) {
+      return Status::ObjectNotExists("delete: id = " +
+                                     ObjectIDToString(object_id));
+    }
+    if (ReleaseBlob(object) && growable_) {
+      // release segments that become empty
+      BulkAllocator::Trim();
+    }
     DVLOG(10) << "after free: " << ObjectIDToString(object_id) << ": "
               << Footprint() << "(" << FootprintLimit() << ")";
+    objects_.erase(accessor);
+    deletions_.fetch_add(1, std::memory_order_relaxed);
+    return Status::OK();
   } else {
-    static size_t page_size = memory::system_page_size();
+    {
+      std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+      meta_blobs_.erase(object_id);
+    }
+    static size_t page_size = memory::segment_page_size();
     uintptr_t pointer = reinterpret_cast<uintptr_t>(object->pointer);
     uintptr_t lower = memory::align_down(pointer, page_size),
               upper = memory::align_up(pointer, page_size);
@@ -282,14 +976,162 @@ Status BulkStore::Delete(const ObjectID& object_id) {
       DVLOG(10) << "after free: " << Footprint() << "(" << FootprintLimit()
                 << "), recycle: (" << std::max(lower, lower_bound) << ", "
                 << std::min(upper, upper_bound) << ")";
-      memory::recycle_resident_memory(std::max(lower, lower_bound),
-                                      std::min(upper, upper_bound));
+      recycler_.Recycle(std::max(lower, lower_bound),
+                        std::min(upper, upper_bound));
     }
   }
   objects_.erase(accessor);
+  deletions_.fetch_add(1, std::memory_order_relaxed);
+  return Status::OK();
+}
+
+Status BulkStore::Delete(const std::vector<ObjectID>& ids) {
+  VINEYARD_TRACE_SPAN("BulkStore::DeleteBatch");
+  static const ObjectID marker = GenerateBlobID(
+      reinterpret_cast<void*>(std::numeric_limits<uintptr_t>::max()));
+  std::vector<std::shared_ptr<Payload>> objects, arena_objects;
+  objects.reserve(ids.size());
+  std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+  for (auto const object_id : ids) {
+    if (object_id == EmptyBlobID() || object_id == marker) {
+      continue;
+    }
+    object_map_t::const_accessor accessor;
+    if (!objects_.find(accessor, object_id)) {
+      continue;
+    }
+    if (accessor->second->arena_fd != -1) {
+      arena_objects.emplace_back(accessor->second);
+    } else {
+      objects.emplace_back(accessor->second);
+    }
+  }
+  // freeing in the order of addresses lets the allocator coalesce the
+  // adjacent chunks as they are returned
+  std::sort(objects.begin(), objects.end(),
+            [](std::shared_ptr<Payload> const& lhs,
+               std::shared_ptr<Payload> const& rhs) {
+              return lhs->pointer < rhs->pointer;
+            });
+  bool freed = false;
+  for (auto const& object : objects) {
+    freed |= ReleaseBlob(object);
+    objects_.erase(object->object_id);
+  }
+  if (freed && growable_) {
+    // release segments that become empty, once for the whole batch
+    BulkAllocator::Trim();
+  }
+  deletions_.fetch_add(objects.size(), std::memory_order_relaxed);
+  DVLOG(10) << "after free " << objects.size() << " blobs: " << Footprint()
+            << "(" << FootprintLimit() << ")";
+  if (!arena_objects.empty()) {
+    RecycleArenaBlobs(arena_objects);
+    for (auto const& object : arena_objects) {
+      meta_blobs_.erase(object->object_id);
+      objects_.erase(object->object_id);
+    }
+    deletions_.fetch_add(arena_objects.size(), std::memory_order_relaxed);
+  }
   return Status::OK();
 }
 
+void BulkStore::RecycleArenaBlobs(
+    std::vector<std::shared_ptr<Payload>> const& objects) {
+  static size_t page_size = memory::segment_page_size();
+  std::set<ObjectID> deleting;
+  for (auto const& object : objects) {
+    deleting.emplace(object->object_id);
+  }
+  // the pages shared with the nearest blob that is kept can't be recycled
+  auto kept = [&](const ObjectID id, std::shared_ptr<Payload>& neighbor) {
+    if (deleting.find(id) != deleting.end()) {
+      return false;
+    }
+    object_map_t::const_accessor accessor;
+    if (!objects_.find(accessor, id)) {
+      return false;
+    }
+    neighbor = accessor->second;
+    return true;
+  };
+  std::vector<std::pair<uintptr_t, uintptr_t>> ranges;
+  for (auto const& object : objects) {
+    uintptr_t pointer = reinterpret_cast<uintptr_t>(object->pointer);
+    uintptr_t lower = memory::align_down(pointer, page_size),
+              upper = memory::align_up(pointer + object->data_size, page_size);
+    auto iter = Arena::spans.find(object->object_id);
+    if (iter != Arena::spans.end()) {
+      std::shared_ptr<Payload> neighbor;
+      for (auto prev = iter; prev != Arena::spans.begin();) {
+        if (kept(*--prev, neighbor)) {
+          lower = std::max(
+              lower, memory::align_up(
+                         reinterpret_cast<uintptr_t>(neighbor->pointer) +
+                             neighbor->data_size,
+                         page_size));
+          break;
+        }
+      }
+      for (auto next = std::next(iter); next != Arena::spans.end(); ++next) {
+        if (kept(*next, neighbor)) {
+          upper = std::min(
+              upper, memory::align_down(
+                         reinterpret_cast<uintptr_t>(neighbor->pointer),
+                         page_size));
+          break;
+        }
+      }
+    }
+    if (lower < upper) {
+      ranges.emplace_back(lower, upper);
+    }
+  }
+  // merge the ranges of adjacent blobs, to be released by a single madvise
+  std::sort(ranges.begin(), ranges.end());
+  size_t merged = 0;
+  for (size_t index = 1; index < ranges.size(); ++index) {
+    if (ranges[index].first <= ranges[merged].second) {
+      ranges[merged].second =
+          std::max(ranges[merged].second, ranges[index].second);
+    } else {
+      ranges[++merged] = ranges[index];
+    }
+  }
+  if (!ranges.empty()) {
+    ranges.resize(merged + 1);
+  }
+  for (auto const& range : ranges) {
+    recycler_.Recycle(range.first, range.second);
+  }
+  DVLOG(10) << "recycle " << objects.size() << " arena blobs in "
+            << ranges.size() << " ranges";
+}
+
+bool BulkStore::ReleaseBlob(std::shared_ptr<Payload> const& object) {
+  if (policy_ != nullptr) {
+    policy_->Forget(object->object_id);
+  }
+  meta_blobs_.erase(object->object_id);
+  Unmovable(object);
+  if (object->is_spilled) {
+    unlink(SpillFilePath(object->object_id).c_str());
+    spilled_size_ -= object->data_size;
+    object->is_spilled = false;
+    return false;
+  }
+  if (!object->is_far) {
+    Charge(object, -object->data_size);
+  }
+  if (object->cow_children > 0) {
+    // the pages are still shared by other blobs
+    object->cow_deleted = true;
+    return false;
+  }
+  ReleaseMemory(object);
+  return true;
+}
+
 bool BulkStore::Exists(const ObjectID& object_id) {
   object_map_t::const_accessor accessor;
   return objects_.find(accessor, object_id);
@@ -307,6 +1149,7 @@ Status BulkStore::MakeArena(size_t const size, int& fd, uintptr_t& base) {
     return Status::NotEnoughMemory("Failed to allocate a new arena");
   }
   void* space = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  memory::advise_huge_pages(space, size);
   base = reinterpret_cast<uintptr_t>(space);
   arenas_.emplace(fd, Arena{.fd = fd,
                             .size = size,
@@ -344,9 +1187,10 @@ Status BulkStore::FinalizeArena(const int fd,
     Arena::spans.emplace(object_id);
   }
   // recycle memory
-  { memory::recycle_arena(mmap_base, mmap_size, offsets, sizes); }
+  { memory::recycle_arena(recycler_, mmap_base, mmap_size, offsets, sizes); }
   // make it available for mmap record
   {
+    std::lock_guard<std::mutex> guard(memory::mmap_records_mutex);
     memory::MmapRecord& record =
         memory::mmap_records[reinterpret_cast<void*>(mmap_base)];
     record.fd = fd;
@@ -356,4 +1200,751 @@ Status BulkStore::FinalizeArena(const int fd,
   return Status::OK();
 }
 
+Status BulkStore::EnableEviction(const std::string& policy,
+                                 const std::string& spill_path,
+                                 const bool drop) {
+  auto eviction_policy = EvictionPolicy::Make(policy);
+  if (eviction_policy == nullptr) {
+    return Status::Invalid("Unknown eviction policy: '" + policy + "'");
+  }
+  if (!spill_path.empty()) {
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(spill_path, ec);
+    if (ec) {
+      return Status::IOError("Failed to create the spill directory '" +
+                             spill_path + "': " + ec.message());
+    }
+    LOG(INFO) << "Cold blobs will be spilled to '" << spill_path
+              << "' (policy: " << policy << ")";
+  } else if (drop) {
+    LOG(INFO) << "Cold blobs will be dropped when the shared memory is "
+                 "exhausted (policy: "
+              << policy << ")";
+  }
+  std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+  spill_path_ = spill_path;
+  drop_cold_blobs_ = drop;
+  policy_ = std::move(eviction_policy);
+  return Status::OK();
+}
+
+Status BulkStore::EnableFarTier(const std::string& path, const size_t size,
+                                const size_t promote_hits) {
+  RETURN_ON_ERROR(far_.Init(path, size));
+  promote_hits_ = std::max(promote_hits, static_cast<size_t>(1));
+  return Status::OK();
+}
+
+Status BulkStore::Ref(const ObjectID id) {
+  if (id == EmptyBlobID()) {
+    return Status::OK();
+  }
+  std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+  object_map_t::const_accessor accessor;
+  if (!objects_.find(accessor, id)) {
+    return Status::ObjectNotExists("ref: id = " + ObjectIDToString(id));
+  }
+  // referenced blobs are no longer candidates for eviction
+  if (accessor->second->ref_cnt++ == 0 && policy_ != nullptr) {
+    policy_->Erase(id);
+  }
+  return Status::OK();
+}
+
+Status BulkStore::Unref(const ObjectID id) {
+  if (id == EmptyBlobID()) {
+    return Status::OK();
+  }
+  std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+  object_map_t::const_accessor accessor;
+  if (!objects_.find(accessor, id)) {
+    return Status::ObjectNotExists("unref: id = " + ObjectIDToString(id));
+  }
+  auto& object = accessor->second;
+  if (object->ref_cnt > 0 && --object->ref_cnt == 0 && policy_ != nullptr &&
+      object->arena_fd == -1 && !object->is_spilled && !object->is_far &&
+      !object->IsDevice() && !object->IsPageShared()) {
+    policy_->Insert(id);
+  }
+  return Status::OK();
+}
+
+Status BulkStore::Access(const ObjectID id,
+                         std::shared_ptr<Payload> const& object) {
+  {
+    std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+    bool resident = false;
+    RETURN_ON_ERROR(AccessResident(id, object, resident));
+    if (resident) {
+      return Status::OK();
+    }
+  }
+  // the spilled blob is read back without the `policy_mutex_`, and then
+  // validated again
+  RETURN_ON_ERROR(Reload(object));
+  return Access(id, object);
+}
+
+Status BulkStore::AccessResident(const ObjectID id,
+                                 std::shared_ptr<Payload> const& object,
+                                 bool& resident) {
+  {
+    object_map_t::const_accessor accessor;
+    if (!objects_.find(accessor, id) || accessor->second != object) {
+      // has been evicted in the meantime
+      return Status::ObjectNotExists("get: id = " + ObjectIDToString(id));
+    }
+  }
+  resident = !object->is_spilled;
+  if (!resident) {
+    return Status::OK();
+  }
+  if (object->is_far && ++object->far_hits >= promote_hits_ &&
+      object->ref_cnt == 0) {
+    Promote(object);
+  }
+  policy_->Touch(id);
+  return Status::OK();
+}
+
+void BulkStore::ReferenceByMeta(const std::set<ObjectID>& ids) {
+  std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+  for (auto const id : ids) {
+    if (objects_.count(id) > 0) {
+      meta_blobs_.emplace(id);
+    }
+  }
+}
+
+bool BulkStore::IsReferencedByMeta(const ObjectID id) {
+  std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+  return meta_blobs_.count(id) > 0;
+}
+
+Status BulkStore::EvictColdObjects(
+    const size_t size, std::shared_ptr<const std::string> const& session) {
+  std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+  size_t evicted = 0;
+  ObjectID id = InvalidObjectID();
+  auto of_session = [this, &session](const ObjectID candidate) {
+    object_map_t::const_accessor accessor;
+    return objects_.find(accessor, candidate) &&
+           accessor->second->session != nullptr &&
+           *accessor->second->session == *session;
+  };
+  auto pop = [&]() {
+    return session == nullptr ? policy_->Pop(id) : policy_->Pop(id, of_session);
+  };
+  // the blobs that are members of metadata can't be dropped, and are put
+  // back to the policy once the eviction finishes
+  std::vector<ObjectID> kept;
+  while (evicted < size && pop()) {
+    object_map_t::const_accessor accessor;
+    if (!objects_.find(accessor, id)) {
+      continue;
+    }
+    auto object = accessor->second;
+    if (object->ref_cnt > 0 || object->is_spilled || object->is_far ||
+        object->IsDevice() || object->IsPageShared()) {
+      continue;
+    }
+    if (Demote(object)) {
+      evicted += object->data_size;
+      continue;
+    }
+    if (spill_path_.empty() && !drop_cold_blobs_) {
+      // the far tier is full, and the blobs can only be migrated
+      policy_->Insert(id);
+      break;
+    }
+    if (spill_path_.empty() && meta_blobs_.count(id) > 0) {
+      kept.emplace_back(id);
+      continue;
+    }
+    if (spill_path_.empty()) {
+      objects_.erase(accessor);
+      policy_->Forget(id);
+      Charge(object, -object->data_size);
+      ReleaseMemory(object);
+      DVLOG(10) << "after drop: " << ObjectIDToString(id) << ": "
+                << Footprint() << "(" << FootprintLimit() << ")";
+    } else {
+      accessor.release();
+      auto status = Spill(object);
+      if (!status.ok()) {
+        LOG(ERROR) << "Failed to spill blob " << ObjectIDToString(id) << ": "
+                   << status.ToString();
+        policy_->Insert(id);
+        return status;
+      }
+    }
+    evicted += object->data_size;
+  }
+  for (auto const candidate : kept) {
+    policy_->Insert(candidate);
+  }
+  if (evicted == 0) {
+    return Status::NotEnoughMemory("no blobs can be evicted");
+  }
+  return Status::OK();
+}
+
+Status BulkStore::Spill(std::shared_ptr<Payload> const& object) {
+  std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+  if (object->is_spilled || object->ref_cnt > 0 || object->IsPageShared()) {
+    return Status::OK();
+  }
+  RETURN_ON_ERROR(memory::spill_to_file(SpillFilePath(object->object_id),
+                                        object->pointer, object->data_size));
+  FreeMemory(object->pointer, object->data_size);
+  object->is_spilled = true;
+  object->pointer = nullptr;
+  object->store_fd = -1;
+  object->map_size = 0;
+  object->data_offset = 0;
+  spilled_size_ += object->data_size;
+  Charge(object, -object->data_size);
+  DVLOG(10) << "after spill: " << ObjectIDToString(object->object_id) << ": "
+            << Footprint() << "(" << FootprintLimit() << ")";
+  return Status::OK();
+}
+
+Status BulkStore::Reload(std::shared_ptr<Payload> const& object) {
+  // a single reader per blob, the others find the blob resident once they
+  // get the lock
+  std::lock_guard<std::mutex> reload_guard(
+      reload_mutexes_[object->object_id % kReloadStripes]);
+  int fd = -1;
+  int64_t map_size = 0;
+  ptrdiff_t offset = 0;
+  uint8_t* pointer = nullptr;
+  {
+    std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+    if (!object->is_spilled) {
+      return Status::OK();
+    }
+    pointer = AllocateMemory(object->data_size, &fd, &map_size, &offset);
+    if (pointer == nullptr) {
+      return Status::NotEnoughMemory(
+          "failed to reload spilled blob: size = " +
+          std::to_string(object->data_size));
+    }
+  }
+  // the blob stays spilled, i.e., it is neither spilled nor migrated by
+  // others, while being read
+  std::string path = SpillFilePath(object->object_id);
+  auto status = memory::load_from_file(path, pointer, object->data_size);
+
+  std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+  bool stored = false;
+  {
+    object_map_t::const_accessor accessor;
+    stored = objects_.find(accessor, object->object_id) &&
+             accessor->second == object;
+  }
+  if (!stored || !object->is_spilled || !status.ok()) {
+    // deleted, or reloaded by `ReloadLocked`, in the meantime
+    FreeMemory(pointer, object->data_size);
+    if (!stored) {
+      return Status::ObjectNotExists("reload: id = " +
+                                     ObjectIDToString(object->object_id));
+    }
+    return object->is_spilled ? status : Status::OK();
+  }
+  CompleteReload(object, path, pointer, fd, map_size, offset);
+  return Status::OK();
+}
+
+Status BulkStore::ReloadLocked(std::shared_ptr<Payload> const& object) {
+  std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+  if (!object->is_spilled) {
+    return Status::OK();
+  }
+  int fd = -1;
+  int64_t map_size = 0;
+  ptrdiff_t offset = 0;
+  uint8_t* pointer =
+      AllocateMemory(object->data_size, &fd, &map_size, &offset);
+  if (pointer == nullptr) {
+    return Status::NotEnoughMemory(
+        "failed to reload spilled blob: size = " +
+        std::to_string(object->data_size));
+  }
+  std::string path = SpillFilePath(object->object_id);
+  auto status = memory::load_from_file(path, pointer, object->data_size);
+  if (!status.ok()) {
+    FreeMemory(pointer, object->data_size);
+    return status;
+  }
+  CompleteReload(object, path, pointer, fd, map_size, offset);
+  return Status::OK();
+}
+
+void BulkStore::CompleteReload(std::shared_ptr<Payload> const& object,
+                               std::string const& path, uint8_t* pointer,
+                               const int fd, const int64_t map_size,
+                               const ptrdiff_t offset) {
+  unlink(path.c_str());
+  object->is_spilled = false;
+  object->pointer = pointer;
+  object->store_fd = fd;
+  object->map_size = map_size;
+  object->data_offset = offset;
+  spilled_size_ -= object->data_size;
+  Charge(object, object->data_size);
+  if (object->ref_cnt == 0) {
+    policy_->Insert(object->object_id);
+  }
+  DVLOG(10) << "after reload: " << ObjectIDToString(object->object_id) << ": "
+            << Footprint() << "(" << FootprintLimit() << ")";
+}
+
+bool BulkStore::Demote(std::shared_ptr<Payload> const& object) {
+  if (!far_.Enabled() || object->is_far || object->is_spilled ||
+      object->ref_cnt > 0 || object->pointer == nullptr ||
+      object->arena_fd != -1 || object->IsDevice() ||
+      object->IsPageShared()) {
+    return false;
+  }
+  uint8_t* pointer = far_.Allocate(object->data_size);
+  if (pointer == nullptr) {
+    return false;
+  }
+  memory::concurrent_memcpy(pointer, object->pointer, object->data_size);
+  FreeMemory(object->pointer, object->data_size);
+  object->pointer = pointer;
+  far_.Mapinfo(pointer, &object->store_fd, &object->map_size,
+               &object->data_offset);
+  object->is_far = true;
+  object->far_hits = 0;
+  // the usage of sessions counts the blobs in the shared memory only
+  Charge(object, -object->data_size);
+  demotions_.fetch_add(1, std::memory_order_relaxed);
+  DVLOG(10) << "after demote: " << ObjectIDToString(object->object_id) << ": "
+            << Footprint() << "(" << FootprintLimit() << "), far: "
+            << far_.Footprint() << "(" << far_.FootprintLimit() << ")";
+  return true;
+}
+
+void BulkStore::Promote(std::shared_ptr<Payload> const& object) {
+  if (!object->is_far || object->ref_cnt > 0) {
+    return;
+  }
+  int fd = -1;
+  int64_t map_size = 0;
+  ptrdiff_t offset = 0;
+  // may demote other blobs to make room, but never this one, as blobs in the
+  // far tier are not candidates of the eviction policy
+  uint8_t* pointer =
+      AllocateMemory(object->data_size, &fd, &map_size, &offset);
+  if (pointer == nullptr) {
+    // stays in the far tier, and will be retried on the next access
+    return;
+  }
+  memory::concurrent_memcpy(pointer, object->pointer, object->data_size);
+  far_.Free(object->pointer, object->data_size);
+  object->pointer = pointer;
+  object->store_fd = fd;
+  object->map_size = map_size;
+  object->data_offset = offset;
+  object->is_far = false;
+  object->far_hits = 0;
+  Charge(object, object->data_size);
+  policy_->Insert(object->object_id);
+  promotions_.fetch_add(1, std::memory_order_relaxed);
+  DVLOG(10) << "after promote: " << ObjectIDToString(object->object_id)
+            << ": " << Footprint() << "(" << FootprintLimit() << "), far: "
+            << far_.Footprint() << "(" << far_.FootprintLimit() << ")";
+}
+
+std::string BulkStore::SpillFilePath(const ObjectID id) const {
+  return (boost::filesystem::path(spill_path_) / ObjectIDToString(id))
+      .string();
+}
+
+Status BulkStore::Checkpoint(const std::string& path,
+                             const std::set<ObjectID>& ids,
+                             const json& metadata, json& stats) {
+  VINEYARD_TRACE_SPAN("BulkStore::Checkpoint");
+  auto start = std::chrono::steady_clock::now();
+  // a crash won't leave a broken checkpoint at `path`
+  std::string const temporary = path + ".tmp";
+  int fd = open(temporary.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0600);
+  if (fd == -1) {
+    return Status::IOError("Failed to open the checkpoint '" + temporary +
+                           "': " + strerror(errno));
+  }
+  json blobs = json::array();
+  std::vector<memory::CheckpointRange> ranges;
+  size_t bytes = 0, skipped = 0;
+  uint64_t offset = 0;
+
+  // the selected blobs are pinned like the parent of a copy-on-write blob:
+  // they won't be evicted, spilled or relocated, and a delete is deferred
+  // until they are unpinned, so the pages can be written without the lock.
+  std::vector<std::shared_ptr<Payload>> pinned;
+  {
+    std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+    for (auto const id : ids) {
+      if (id == EmptyBlobID()) {
+        continue;
+      }
+      object_map_t::const_accessor accessor;
+      if (!objects_.find(accessor, id)) {
+        continue;
+      }
+      auto const& object = accessor->second;
+      if (object->is_spilled || object->IsDevice() ||
+          object->pointer == nullptr) {
+        skipped += 1;
+        continue;
+      }
+      object->cow_children += 1;
+      pinned.push_back(object);
+      size_t const size = object->data_size;
+      blobs.push_back(json::array({id, size, offset}));
+      ranges.push_back(memory::CheckpointRange{object->pointer, size, offset});
+      bytes += size;
+      offset = memory::align_up(offset + size, memory::kCheckpointAlignment);
+    }
+  }
+  auto status = memory::checkpoint_ranges(fd, ranges, true, temporary);
+  {
+    std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+    for (auto const& object : pinned) {
+      if (--object->cow_children > 0) {
+        continue;
+      }
+      if (object->cow_deleted) {
+        ReleaseMemory(object);
+      } else if (policy_ != nullptr && object->ref_cnt == 0 &&
+                 !object->IsPageShared()) {
+        policy_->Insert(object->object_id);
+      }
+    }
+  }
+  if (status.ok()) {
+    json manifest = {{"blobs", blobs}, {"metadata", metadata}};
+    std::vector<uint8_t> content = json::to_msgpack(manifest);
+    memory::CheckpointTrailer trailer;
+    trailer.manifest_offset = offset;
+    trailer.manifest_size = content.size();
+    memcpy(trailer.magic, memory::kCheckpointMagic, sizeof(trailer.magic));
+    status = memory::checkpoint_io(fd, content.data(), content.size(), offset,
+                                   true, temporary);
+    if (status.ok()) {
+      status = memory::checkpoint_io(fd, reinterpret_cast<uint8_t*>(&trailer),
+                                     sizeof(trailer), offset + content.size(),
+                                     true, temporary);
+    }
+  }
+  if (status.ok() && fsync(fd) != 0) {
+    status = Status::IOError("Failed to sync the checkpoint '" + temporary +
+                             "': " + strerror(errno));
+  }
+  close(fd);
+  if (status.ok() && std::rename(temporary.c_str(), path.c_str()) != 0) {
+    status = Status::IOError("Failed to move the checkpoint to '" + path +
+                             "': " + strerror(errno));
+  }
+  if (!status.ok()) {
+    unlink(temporary.c_str());
+    return status;
+  }
+  stats["path"] = path;
+  stats["blobs"] = blobs.size();
+  stats["bytes"] = bytes;
+  stats["skipped"] = skipped;
+  stats["seconds"] = std::chrono::duration_cast<std::chrono::duration<double>>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+  return Status::OK();
+}
+
+Status BulkStore::Restore(const std::string& path, json& metadata,
+                          json& stats) {
+  auto start = std::chrono::steady_clock::now();
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return Status::IOError("Failed to open the checkpoint '" + path +
+                           "': " + strerror(errno));
+  }
+  json manifest;
+  auto status = [&]() -> Status {
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      return Status::IOError("Failed to stat the checkpoint '" + path +
+                             "': " + strerror(errno));
+    }
+    memory::CheckpointTrailer trailer;
+    if (static_cast<size_t>(st.st_size) < sizeof(trailer)) {
+      return Status::Invalid("Invalid checkpoint '" + path + "'");
+    }
+    RETURN_ON_ERROR(memory::checkpoint_io(
+        fd, reinterpret_cast<uint8_t*>(&trailer), sizeof(trailer),
+        st.st_size - sizeof(trailer), false, path));
+    if (memcmp(trailer.magic, memory::kCheckpointMagic,
+               sizeof(trailer.magic)) != 0 ||
+        trailer.manifest_offset + trailer.manifest_size + sizeof(trailer) !=
+            static_cast<uint64_t>(st.st_size)) {
+      return Status::Invalid("Invalid checkpoint '" + path + "'");
+    }
+    std::vector<uint8_t> content(trailer.manifest_size);
+    RETURN_ON_ERROR(memory::checkpoint_io(fd, content.data(), content.size(),
+                                          trailer.manifest_offset, false,
+                                          path));
+    manifest = json::from_msgpack(content, true, false);
+    if (!manifest.is_object() || !manifest.contains("blobs")) {
+      return Status::Invalid("Invalid checkpoint '" + path + "'");
+    }
+    return Status::OK();
+  }();
+  if (!status.ok()) {
+    close(fd);
+    return status;
+  }
+
+  std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+  std::vector<std::shared_ptr<Payload>> objects;
+  std::vector<memory::CheckpointRange> ranges;
+  size_t bytes = 0;
+  for (auto const& blob : manifest["blobs"]) {
+    ObjectID const id = blob[0].get<ObjectID>();
+    size_t const size = blob[1].get<size_t>();
+    if (objects_.count(id) > 0 || size == 0) {
+      continue;
+    }
+    int store_fd = -1;
+    int64_t map_size = 0;
+    ptrdiff_t offset = 0;
+    uint8_t* pointer = AllocateMemory(size, &store_fd, &map_size, &offset);
+    if (pointer == nullptr) {
+      status = Status::NotEnoughMemory(
+          "failed to restore the blobs from the checkpoint: size = " +
+          std::to_string(size));
+      break;
+    }
+    objects.emplace_back(std::make_shared<Payload>(id, size, pointer, store_fd,
+                                                   map_size, offset));
+    ranges.push_back(
+        memory::CheckpointRange{pointer, size, blob[2].get<uint64_t>()});
+    bytes += size;
+  }
+  if (status.ok()) {
+    status = memory::checkpoint_ranges(fd, ranges, false, path);
+  }
+  close(fd);
+  if (!status.ok()) {
+    for (auto const& object : objects) {
+      FreeMemory(object->pointer, object->data_size);
+    }
+    return status;
+  }
+  for (auto const& object : objects) {
+    objects_.emplace(object->object_id, object);
+    if (policy_ != nullptr) {
+      policy_->Insert(object->object_id);
+    }
+  }
+  restored_ = restored_ || !objects.empty();
+  allocations_.fetch_add(objects.size(), std::memory_order_relaxed);
+  metadata = manifest.value("metadata", json::object());
+  stats["path"] = path;
+  stats["blobs"] = objects.size();
+  stats["bytes"] = bytes;
+  stats["seconds"] = std::chrono::duration_cast<std::chrono::duration<double>>(
+                         std::chrono::steady_clock::now() - start)
+                         .count();
+  return Status::OK();
+}
+
+size_t BulkStore::Compact() {
+  std::vector<std::shared_ptr<Payload>> movable;
+  {
+    std::lock_guard<std::mutex> guard(movable_mutex_);
+    movable.reserve(movable_.size());
+    for (auto const& item : movable_) {
+      movable.emplace_back(item.second);
+    }
+  }
+  // the locations and the references of the blobs are only modified with
+  // `policy_mutex_` held, thus the candidates are collected under the lock
+  std::vector<std::pair<uint8_t*, std::shared_ptr<Payload>>> candidates;
+  {
+    std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+    for (auto const& object : movable) {
+      if (object->pointer == nullptr || object->ref_cnt > 0 ||
+          object->is_spilled || object->is_far || object->IsPageShared()) {
+        continue;
+      }
+      candidates.emplace_back(object->pointer, object);
+    }
+  }
+  // move the blobs at the tail first, to make holes at the head usable
+  std::sort(candidates.begin(), candidates.end(),
+            [](std::pair<uint8_t*, std::shared_ptr<Payload>> const& lhs,
+               std::pair<uint8_t*, std::shared_ptr<Payload>> const& rhs) {
+              return lhs.first > rhs.first;
+            });
+  size_t moved = 0;
+  for (auto const& candidate : candidates) {
+    auto const& object = candidate.second;
+    // hold the lock per blob, to keep clients from waiting for the whole pass
+    std::lock_guard<std::recursive_mutex> guard(policy_mutex_);
+    {
+      object_map_t::const_accessor accessor;
+      if (!objects_.find(accessor, object->object_id) ||
+          accessor->second != object) {
+        continue;
+      }
+    }
+    if (Relocate(object)) {
+      moved += object->data_size;
+    }
+  }
+  if (moved > 0) {
+    if (growable_) {
+      BulkAllocator::Trim();
+    }
+    VLOG(2) << "compaction moved " << moved << " bytes, fragmentation: "
+            << Fragmentation();
+  }
+  return moved;
+}
+
+bool BulkStore::Relocate(std::shared_ptr<Payload> const& object) {
+  if (object->ref_cnt > 0 || object->is_spilled || object->is_far ||
+      object->pointer == nullptr || object->IsDevice() ||
+      object->IsPageShared()) {
+    return false;
+  }
+  uint8_t* pointer = reinterpret_cast<uint8_t*>(
+      BulkAllocator::Memalign(object->data_size, kBlockSize));
+  if (pointer == nullptr) {
+    return false;
+  }
+  if (pointer >= object->pointer) {
+    BulkAllocator::Free(pointer, object->data_size);
+    return false;
+  }
+  int fd = -1;
+  int64_t map_size = 0;
+  ptrdiff_t offset = 0;
+  GetMallocMapinfo(pointer, &fd, &map_size, &offset);
+  memcpy(pointer, object->pointer, object->data_size);
+  BulkAllocator::Free(object->pointer, object->data_size);
+  object->pointer = pointer;
+  object->store_fd = fd;
+  object->map_size = map_size;
+  object->data_offset = offset;
+  return true;
+}
+
+double BulkStore::Fragmentation() const {
+  int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+                    std::chrono::steady_clock::now().time_since_epoch())
+                    .count();
+  if (now < fragmentation_expiry_.load(std::memory_order_acquire) ||
+      fragmentation_sampling_.test_and_set(std::memory_order_acquire)) {
+    return fragmentation_.load(std::memory_order_relaxed);
+  }
+  double fragmentation = 0.0;
+  size_t free_bytes = 0, largest_chunk = 0;
+  if (BulkAllocator::FreeSpace(free_bytes, largest_chunk) && free_bytes > 0) {
+    fragmentation = 1.0 - static_cast<double>(largest_chunk) / free_bytes;
+  }
+  fragmentation_.store(fragmentation, std::memory_order_relaxed);
+  fragmentation_expiry_.store(now + kFragmentationInterval,
+                              std::memory_order_release);
+  fragmentation_sampling_.clear(std::memory_order_release);
+  return fragmentation;
+}
+
+size_t BulkStore::SizeBucket(const size_t size) {
+  size_t bucket = 0, bound = 4096;
+  while (bucket + 1 < kSizeBuckets && size > bound) {
+    ++bucket;
+    bound <<= 4;
+  }
+  return bucket;
+}
+
+uint64_t BulkStore::AllocationNanoseconds() const {
+  uint64_t nanoseconds = 0;
+  for (auto const& latency : allocation_latency_) {
+    nanoseconds += latency.Sum();
+  }
+  return nanoseconds;
+}
+
+void BulkStore::DumpMetrics(std::ostream& os) const {
+  static const char* size_labels[kSizeBuckets] = {"4KB",  "64KB",  "1MB",
+                                                  "16MB", "256MB", "+Inf"};
+  os << "# HELP vineyard_blob_allocation_duration_seconds Latency of "
+        "allocating blobs from the shared memory.\n";
+  os << "# TYPE vineyard_blob_allocation_duration_seconds histogram\n";
+  for (size_t bucket = 0; bucket < kSizeBuckets; ++bucket) {
+    allocation_latency_[bucket].Dump(
+        os, "vineyard_blob_allocation_duration_seconds",
+        std::string("size=\"") + size_labels[bucket] + "\"", 1e-9);
+  }
+
+  auto counter = [&os](const std::string& name, const std::string& help,
+                       const uint64_t value) {
+    os << "# HELP " << name << " " << help << "\n";
+    os << "# TYPE " << name << " counter\n";
+    os << name << " " << value << "\n";
+  };
+  auto gauge = [&os](const std::string& name, const std::string& help,
+                     const double value) {
+    os << "# HELP " << name << " " << help << "\n";
+    os << "# TYPE " << name << " gauge\n";
+    os << name << " " << value << "\n";
+  };
+  counter("vineyard_blob_allocations_total", "Number of allocated blobs.",
+          allocations_.load(std::memory_order_relaxed));
+  counter("vineyard_blob_allocation_failures_total",
+          "Number of allocations that failed for lack of memory.",
+          allocation_failures_.load(std::memory_order_relaxed));
+  counter("vineyard_blob_deletions_total", "Number of deleted blobs.",
+          deletions_.load(std::memory_order_relaxed));
+  counter("vineyard_blob_deduplications_total",
+          "Number of sealed blobs that are stored as an identical blob.",
+          deduplications_.load(std::memory_order_relaxed));
+  counter("vineyard_deduplicated_bytes_total",
+          "Bytes of the allocations that are released by deduplication.",
+          deduplicated_bytes_.load(std::memory_order_relaxed));
+  counter("vineyard_recycled_bytes_total",
+          "Bytes of pages released back to the OS kernel.",
+          recycler_.RecycledBytes());
+  counter("vineyard_madvise_calls_total",
+          "Number of madvise() calls for recycling pages.",
+          recycler_.MadviseCalls());
+  counter("vineyard_blob_demotions_total",
+          "Number of blobs migrated to the far memory tier.",
+          demotions_.load(std::memory_order_relaxed));
+  counter("vineyard_blob_promotions_total",
+          "Number of blobs migrated back from the far memory tier.",
+          promotions_.load(std::memory_order_relaxed));
+
+  size_t footprint = Footprint(), limit = FootprintLimit();
+  gauge("vineyard_memory_live_bytes", "Bytes allocated for blobs.",
+        footprint);
+  gauge("vineyard_memory_free_bytes", "Bytes that can still be allocated.",
+        limit > footprint ? limit - footprint : 0);
+  gauge("vineyard_memory_limit_bytes", "Upper bound of the shared memory.",
+        limit);
+  gauge("vineyard_memory_spilled_bytes", "Bytes of blobs that are spilled.",
+        SpilledSize());
+  gauge("vineyard_memory_fragmentation",
+        "Fragmentation of the free shared memory.", Fragmentation());
+  gauge("vineyard_far_memory_live_bytes",
+        "Bytes of the far memory tier allocated for blobs.",
+        far_.Footprint());
+  gauge("vineyard_far_memory_limit_bytes", "Size of the far memory tier.",
+        far_.FootprintLimit());
+  gauge("vineyard_device_memory_live_bytes",
+        "Bytes of the device memory allocated for blobs.", DeviceFootprint());
+}
+
 }  // namespace vineyard
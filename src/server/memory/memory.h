@@ -29,15 +29,28 @@
 #ifndef SRC_SERVER_MEMORY_MEMORY_H_
 #define SRC_SERVER_MEMORY_MEMORY_H_
 
+#include <array>
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <ostream>
 #include <set>
+#include <string>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "oneapi/tbb/concurrent_hash_map.h"
 
 #include "common/memory/payload.h"
 #include "common/util/status.h"
+#include "server/memory/eviction.h"
+#include "server/memory/far_tier.h"
+#include "server/memory/recycler.h"
+#include "server/memory/slab.h"
+#include "server/util/metrics.h"
 
 namespace vineyard {
 
@@ -48,10 +61,68 @@ class BulkStore {
 
   ~BulkStore();
 
-  Status PreAllocate(const size_t size);
+  /**
+   * @brief Initialize the shared memory. The store starts with `initial_size`
+   * bytes and grows by mapping extra segments on demand, until the footprint
+   * reaches `size`. The whole `size` bytes are mapped when `initial_size` is
+   * zero.
+   */
+  Status PreAllocate(const size_t size, const size_t initial_size = 0);
+
+  /**
+   * @brief Allocate a blob, the pages of the blob prefer to reside on the
+   * given NUMA node when `numa_node` is non-negative, and are faulted in
+   * before returning when `prefault` is true.
+   */
+  Status Create(const size_t size, ObjectID& object_id,
+                std::shared_ptr<Payload>& object, const int numa_node = -1,
+                const bool prefault = false);
 
+  /**
+   * @brief Allocate a blob that is charged to the memory quota of the
+   * session, see `SetQuota()`. When the blob would take the session over its
+   * soft limit, the cold blobs of the session are evicted first, and the
+   * allocation is refused when it would still exceed the hard limit.
+   */
   Status Create(const size_t size, ObjectID& object_id,
-                std::shared_ptr<Payload>& object);
+                std::shared_ptr<Payload>& object, const int numa_node,
+                const bool prefault,
+                std::shared_ptr<const std::string> const& session);
+
+  /**
+   * @brief Allocate a blob in the memory of the given CUDA device, which is
+   * shared with the clients by its CUDA IPC handle. Device blobs are never
+   * evicted, spilled, relocated or deduplicated, and are accounted in
+   * `DeviceFootprint()` rather than the footprint of the shared memory.
+   */
+  Status CreateDevice(const size_t size, const int device, ObjectID& object_id,
+                      std::shared_ptr<Payload>& object);
+
+  /**
+   * @brief Create a copy-on-write blob of the parent, which shares the
+   * unchanged pages with the parent, while the pages that overlap with the
+   * `dirty` (offset, size) ranges are newly allocated and initialized with
+   * the contents of the parent. Only the newly allocated pages are writable.
+   *
+   * The parent won't be evicted, spilled or relocated until all of its
+   * copy-on-write blobs have been deleted, and the pages of a deleted parent
+   * are released after the last of them has gone.
+   */
+  Status CreateCopyOnWrite(
+      const ObjectID parent_id,
+      std::vector<std::pair<size_t, size_t>> const& dirty,
+      ObjectID& object_id, std::shared_ptr<Payload>& object);
+
+  /**
+   * @brief Seal the blob after its content has been written. When
+   * deduplication is enabled, the content is hashed, and the blob becomes an
+   * alias of an identical sealed blob if there is one, i.e., its memory is
+   * released and `object` locates the content of the identical blob.
+   *
+   * Blobs that have been mapped by other clients than the creator are
+   * sealed as is, as the clients still access the original memory.
+   */
+  Status Seal(const ObjectID id, std::shared_ptr<Payload>& object);
 
   Status Get(const ObjectID id, std::shared_ptr<Payload>& object);
 
@@ -64,6 +135,15 @@ class BulkStore {
 
   Status Delete(const ObjectID& object_id);
 
+  /**
+   * @brief Delete many blobs with a single acquisition of the lock, e.g., the
+   * blobs of a fragment that is deleted deeply. The blobs are freed in the
+   * order of their addresses and the empty segments are trimmed once for the
+   * whole batch. The pages of adjacent arena blobs are recycled as merged
+   * ranges. Blobs that don't exist are skipped.
+   */
+  Status Delete(const std::vector<ObjectID>& ids);
+
   bool Exists(const ObjectID& object_id);
 
   object_map_t const& List() const { return objects_; }
@@ -71,14 +151,297 @@ class BulkStore {
   size_t Footprint() const;
   size_t FootprintLimit() const;
 
+  /**
+   * @brief Bytes of the device memory that are allocated for device blobs.
+   */
+  size_t DeviceFootprint() const { return device_footprint_; }
+
+  /**
+   * @brief The background thread that releases the freed pages, see also
+   * `memory::PageRecycler`.
+   */
+  std::thread::native_handle_type RecyclerThread() {
+    return recycler_.NativeHandle();
+  }
+
   Status MakeArena(const size_t size, int& fd, uintptr_t& base);
 
   Status FinalizeArena(const int fd, std::vector<size_t> const& offsets,
                        std::vector<size_t> const& sizes);
 
+  /**
+   * @brief Allocate blobs that are not larger than the threshold from slabs,
+   * zero means disabled. Must be set before creating any blobs.
+   */
+  void SetSmallBlobThreshold(const size_t threshold) {
+    slab_.SetThreshold(threshold);
+  }
+
+  /**
+   * @brief Enable evicting cold blobs when the shared memory is exhausted.
+   * Victims are chosen by the given policy ("lru" or "lfu") among blobs that
+   * are not referenced by any client, and are spilled to files under
+   * `spill_path`, or dropped if `spill_path` is empty and `drop` is true.
+   *
+   * When the far memory tier is enabled, victims are migrated to it first,
+   * and are spilled (or dropped) only when it is full.
+   */
+  Status EnableEviction(const std::string& policy,
+                        const std::string& spill_path, const bool drop = true);
+
+  /**
+   * @brief Enable the far memory tier, i.e., a DAX-mapped file on PMEM or
+   * CXL-attached memory, see also `memory::FarTier`. Cold blobs are migrated
+   * to it when they are evicted from the shared memory, and are promoted back
+   * once they have been accessed `promote_hits` times. The clients map the
+   * far tier by its fd, thus the blobs are accessed in place in either tier.
+   *
+   * Must be set before `EnableEviction()` and before creating any blobs.
+   */
+  Status EnableFarTier(const std::string& path, const size_t size,
+                       const size_t promote_hits);
+
+  /**
+   * @brief Bytes of the far memory tier that are allocated for blobs.
+   */
+  size_t FarFootprint() const { return far_.Footprint(); }
+
+  /**
+   * @brief Limit the bytes of the resident blobs of the session, zero means
+   * unlimited. The quota of the session "*" applies to each of the sessions
+   * that have no quota of their own, thus every tenant gets a fair share.
+   *
+   * The soft limit triggers the eviction of the cold blobs of the session (if
+   * eviction is enabled), and the hard limit rejects the allocations.
+   */
+  void SetQuota(const std::string& session, const size_t soft_limit,
+                const size_t hard_limit);
+
+  /**
+   * @brief The "usage", "soft_limit" and "hard_limit" of the sessions that
+   * have allocated blobs.
+   */
+  json SessionUsages() const;
+
+  /**
+   * @brief Mark the blob as being used by some client. Blobs that are
+   * referenced won't be evicted.
+   */
+  Status Ref(const ObjectID id);
+
+  /**
+   * @brief Release the reference that obtained by `Ref()`.
+   */
+  Status Unref(const ObjectID id);
+
+  /**
+   * @brief Total size of blobs that currently live in the spill directory.
+   */
+  size_t SpilledSize() const { return spilled_size_; }
+
+  /**
+   * @brief Relocate blobs that are not referenced by any client towards the
+   * lower end of the shared memory, to coalesce the free holes between them.
+   * Blobs keep their ids after being relocated.
+   *
+   * @return The number of bytes that have been moved.
+   */
+  size_t Compact();
+
+  /**
+   * @brief Compact the shared memory before failing an allocation that is
+   * refused only because of fragmentation.
+   */
+  void EnableCompaction() { compaction_enabled_ = true; }
+
+  /**
+   * @brief Store identical sealed blobs only once, see also `Seal()`. Must be
+   * set before creating any blobs.
+   */
+  void EnableDeduplication() { deduplication_enabled_ = true; }
+
+  bool DeduplicationEnabled() const { return deduplication_enabled_; }
+
+  /**
+   * @brief Write the content of the given blobs, and the metadata that
+   * refers to them, to a checkpoint file at `path`, see also `Restore()`.
+   * The content is written by several threads in large sequential writes.
+   *
+   * Blobs that don't exist, are spilled or reside in device memory are
+   * skipped. The blobs are neither deleted, evicted nor relocated while the
+   * checkpoint is being written, such requests wait until it is done.
+   *
+   * @param stats The number of blobs and bytes that have been written, and
+   * the time that has been taken.
+   */
+  Status Checkpoint(const std::string& path, const std::set<ObjectID>& ids,
+                    const json& metadata, json& stats);
+
+  /**
+   * @brief Load the blobs of a checkpoint back into the shared memory, the
+   * blobs keep the ids they had when the checkpoint was written. Must be
+   * called after `PreAllocate()` and before serving any client.
+   *
+   * @param metadata The metadata that has been saved with the checkpoint.
+   */
+  Status Restore(const std::string& path, json& metadata, json& stats);
+
+  /**
+   * @brief The fragmentation of the free space, i.e., `1 - largest free
+   * chunk / total free bytes`, zero if the allocator cannot report it.
+   *
+   * Measuring it walks the whole heap under the allocator lock, thus it is
+   * sampled at most once per `kFragmentationInterval`, and the callers in
+   * the meantime get the last sample.
+   */
+  double Fragmentation() const;
+
+  /**
+   * @brief Write the metrics of the shared memory in the prometheus text
+   * format.
+   */
+  void DumpMetrics(std::ostream& os) const;
+
+  /**
+   * @brief The cumulative time spent on allocating blobs, in nanoseconds.
+   */
+  uint64_t AllocationNanoseconds() const;
+
  private:
+  // upper bounds of the size buckets of allocation latency: 4KB, 64KB, 1MB,
+  // 16MB, 256MB and +Inf.
+  static constexpr size_t kSizeBuckets = 6;
+
+  static constexpr int64_t kFragmentationInterval = 10;  // in seconds
+
+  static size_t SizeBucket(const size_t size);
+
   uint8_t* AllocateMemory(size_t size, int* fd, int64_t* map_size,
                           ptrdiff_t* offset);
+
+  void FreeMemory(uint8_t* pointer, const size_t size);
+
+  /**
+   * @brief Release the memory of a blob that is not spilled, including the
+   * window and the pages of copy-on-write blobs, must be called with
+   * `policy_mutex_` held.
+   */
+  void ReleaseMemory(std::shared_ptr<Payload> const& object);
+
+  /**
+   * @brief Release the blob that is being deleted, must be called with
+   * `policy_mutex_` held.
+   *
+   * @return Whether memory has been returned to the allocator.
+   */
+  bool ReleaseBlob(std::shared_ptr<Payload> const& object);
+
+  /**
+   * @brief Recycle the pages of the arena blobs that are deleted together,
+   * with the ranges of adjacent blobs merged, must be called with
+   * `policy_mutex_` held and before the blobs are erased.
+   */
+  void RecycleArenaBlobs(std::vector<std::shared_ptr<Payload>> const& objects);
+
+  /**
+   * @brief Remove the blob from the index of deduplication, must be called
+   * with `policy_mutex_` held.
+   */
+  void Unindex(std::shared_ptr<Payload> const& object);
+
+  /**
+   * @brief Remove the blob from the blobs that compaction may relocate.
+   */
+  void Unmovable(std::shared_ptr<Payload> const& object);
+
+  /**
+   * @brief Record the access to the blob, and reload it if it has been
+   * spilled, must be called without `policy_mutex_` held, as the spilled
+   * blob is read back from the disk without the lock.
+   */
+  Status Access(const ObjectID id, std::shared_ptr<Payload> const& object);
+
+  /**
+   * @brief Record the access to the blob if it is resident, must be called
+   * with `policy_mutex_` held. `resident` is false if the blob has been
+   * spilled, which is then left to `Access`.
+   */
+  Status AccessResident(const ObjectID id,
+                        std::shared_ptr<Payload> const& object,
+                        bool& resident);
+
+  /**
+   * @brief The blobs have become members of metadata, such blobs are never
+   * dropped by eviction (but can still be spilled or migrated), as they
+   * cannot be re-derived. The mark is cleared when the blob is deleted.
+   */
+  void ReferenceByMeta(const std::set<ObjectID>& ids);
+
+  bool IsReferencedByMeta(const ObjectID id);
+
+  /**
+   * @brief Evict unreferenced blobs, in the order decided by the eviction
+   * policy, until at least `size` bytes have been released. Only the blobs of
+   * the `session` are evicted when it is not null.
+   */
+  Status EvictColdObjects(
+      const size_t size,
+      std::shared_ptr<const std::string> const& session = nullptr);
+
+  struct SessionQuota {
+    size_t soft_limit = 0;
+    size_t hard_limit = 0;
+    size_t usage = 0;
+  };
+
+  /**
+   * @brief Charge (or refund, when `size` is negative) the resident bytes of
+   * the blob to the quota of its session.
+   */
+  void Charge(std::shared_ptr<Payload> const& object, const int64_t size);
+
+  Status Spill(std::shared_ptr<Payload> const& object);
+
+  /**
+   * @brief Read the spilled blob back, without holding `policy_mutex_`
+   * during the disk read, must be called without `policy_mutex_` held.
+   */
+  Status Reload(std::shared_ptr<Payload> const& object);
+
+  /**
+   * @brief Read the spilled blob back, must be called with `policy_mutex_`
+   * held.
+   */
+  Status ReloadLocked(std::shared_ptr<Payload> const& object);
+
+  void CompleteReload(std::shared_ptr<Payload> const& object,
+                      std::string const& path, uint8_t* pointer, const int fd,
+                      const int64_t map_size, const ptrdiff_t offset);
+
+  /**
+   * @brief Migrate the blob to the far memory tier, must be called with
+   * `policy_mutex_` held.
+   *
+   * @return Whether the blob has been migrated, false if it cannot be moved
+   * or the far tier is full.
+   */
+  bool Demote(std::shared_ptr<Payload> const& object);
+
+  /**
+   * @brief Migrate the blob from the far memory tier back to the shared
+   * memory, if there's enough memory, must be called with `policy_mutex_`
+   * held.
+   */
+  void Promote(std::shared_ptr<Payload> const& object);
+
+  std::string SpillFilePath(const ObjectID id) const;
+
+  /**
+   * @brief Move the blob to a lower address if possible, must be called
+   * with `policy_mutex_` held.
+   */
+  bool Relocate(std::shared_ptr<Payload> const& object);
+
   struct Arena {
     int fd;
     size_t size;
@@ -89,6 +452,64 @@ class BulkStore {
   std::unordered_map<int /* fd */, Arena> arenas_;
 
   object_map_t objects_;
+
+  // releases the pages of deleted blobs in arenas in background
+  memory::PageRecycler recycler_;
+
+  memory::SlabAllocator slab_;
+
+  // whether the shared memory can grow (and shrink) after startup
+  bool growable_ = false;
+
+  // eviction is disabled if there's no policy.
+  std::unique_ptr<EvictionPolicy> policy_;
+  std::string spill_path_;
+  size_t spilled_size_ = 0;
+  bool drop_cold_blobs_ = true;
+  std::recursive_mutex policy_mutex_;
+  // the blobs that are members of metadata, protected by `policy_mutex_`
+  std::unordered_set<ObjectID> meta_blobs_;
+
+  // serializes the reloads of the same blob, striped by the blob ids
+  static constexpr size_t kReloadStripes = 64;
+  std::array<std::mutex, kReloadStripes> reload_mutexes_;
+
+  memory::FarTier far_;
+  size_t promote_hits_ = 0;
+  std::atomic<uint64_t> demotions_{0};
+  std::atomic<uint64_t> promotions_{0};
+
+  bool compaction_enabled_ = false;
+  // the blobs that compaction may relocate, which are indexed apart from
+  // `objects_` as the concurrent hash map cannot be iterated while blobs are
+  // being created and deleted
+  std::mutex movable_mutex_;
+  std::unordered_map<ObjectID, std::shared_ptr<Payload>> movable_;
+
+  // whether there are blobs that have been restored from a checkpoint
+  bool restored_ = false;
+
+  // sealed blobs by the hash of their content, protected by `policy_mutex_`
+  bool deduplication_enabled_ = false;
+  std::unordered_multimap<uint64_t, std::shared_ptr<Payload>> dedup_index_;
+
+  // allocation latency in nanoseconds, per size bucket
+  std::array<Histogram, kSizeBuckets> allocation_latency_;
+  std::atomic<uint64_t> allocations_{0};
+  std::atomic<uint64_t> allocation_failures_{0};
+  std::atomic<uint64_t> deletions_{0};
+  std::atomic<uint64_t> deduplications_{0};
+  std::atomic<uint64_t> deduplicated_bytes_{0};
+  std::atomic<size_t> device_footprint_{0};
+
+  // the last sample of `Fragmentation()`
+  mutable std::atomic<double> fragmentation_{0.0};
+  mutable std::atomic<int64_t> fragmentation_expiry_{0};
+  mutable std::atomic_flag fragmentation_sampling_ = ATOMIC_FLAG_INIT;
+
+  // the quotas of sessions, "*" is the quota of the sessions that have none
+  mutable std::mutex quota_mutex_;
+  std::unordered_map<std::string, SessionQuota> quotas_;
 };
 
 }  // namespace vineyard
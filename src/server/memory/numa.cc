@@ -0,0 +1,152 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/memory/numa.h"
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "boost/filesystem.hpp"
+
+#include "common/util/logging.h"
+#include "server/memory/malloc.h"
+
+namespace vineyard {
+
+namespace memory {
+
+// see also: linux/mempolicy.h
+constexpr int kMPolicyPreferred = 1;
+constexpr unsigned kMPolicyMoveFlag = (1 << 1);
+
+int numa_node_count() {
+  static int count = []() -> int {
+    int nodes = 0;
+    boost::system::error_code ec;
+    boost::filesystem::directory_iterator iter("/sys/devices/system/node", ec),
+        end;
+    for (; !ec && iter != end; iter.increment(ec)) {
+      std::string name = iter->path().filename().string();
+      if (name.compare(0, 4, "node") == 0 &&
+          name.find_first_not_of("0123456789", 4) == std::string::npos) {
+        nodes += 1;
+      }
+    }
+    return nodes == 0 ? 1 : nodes;
+  }();
+  return count;
+}
+
+int numa_node_of_cpu(const int cpu) {
+  // the topology doesn't change while running, thus is inspected only once
+  static std::vector<int> nodes = []() -> std::vector<int> {
+    std::vector<int> nodes;
+    boost::system::error_code ec;
+    boost::filesystem::directory_iterator iter("/sys/devices/system/node", ec),
+        end;
+    for (; !ec && iter != end; iter.increment(ec)) {
+      std::string name = iter->path().filename().string();
+      if (name.compare(0, 4, "node") != 0 || name.size() <= 4 ||
+          name.find_first_not_of("0123456789", 4) != std::string::npos) {
+        continue;
+      }
+      int node = std::stoi(name.substr(4));
+      boost::system::error_code cpu_ec;
+      boost::filesystem::directory_iterator cpu_iter(iter->path(), cpu_ec),
+          cpu_end;
+      for (; !cpu_ec && cpu_iter != cpu_end; cpu_iter.increment(cpu_ec)) {
+        std::string cpu_name = cpu_iter->path().filename().string();
+        if (cpu_name.compare(0, 3, "cpu") != 0 || cpu_name.size() <= 3 ||
+            cpu_name.find_first_not_of("0123456789", 3) != std::string::npos) {
+          continue;
+        }
+        size_t cpu = std::stoul(cpu_name.substr(3));
+        if (nodes.size() <= cpu) {
+          nodes.resize(cpu + 1, -1);
+        }
+        nodes[cpu] = node;
+      }
+    }
+    return nodes;
+  }();
+  if (cpu < 0 || static_cast<size_t>(cpu) >= nodes.size()) {
+    return -1;
+  }
+  return nodes[cpu];
+}
+
+int numa_node_of_process(const pid_t pid) {
+  std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+  std::string content;
+  if (!stat.is_open() || !std::getline(stat, content)) {
+    return -1;
+  }
+  // the command name in the second field may contains spaces, thus starts
+  // from the last ')'.
+  size_t loc = content.rfind(')');
+  if (loc == std::string::npos) {
+    return -1;
+  }
+  // "processor" is the 39th field, and the 3rd field follows the ')'.
+  int field = 2;
+  for (size_t idx = loc + 1; idx < content.size(); ++idx) {
+    if (content[idx] == ' ') {
+      field += 1;
+      if (field == 39) {
+        return numa_node_of_cpu(std::atoi(content.c_str() + idx + 1));
+      }
+    }
+  }
+  return -1;
+}
+
+Status numa_bind(void* pointer, const size_t size, const int node) {
+#if defined(__linux__) && defined(SYS_mbind)
+  if (node < 0 || node >= numa_node_count() || numa_node_count() <= 1) {
+    return Status::OK();
+  }
+  // the range must be aligned to the pages that back the shared memory, i.e.,
+  // the huge pages when the segments live on hugetlbfs
+  static const uintptr_t page_size = segment_page_size();
+  // only the pages that the blob covers entirely are bound, as the partial
+  // pages at both ends are shared with the neighbouring blobs
+  uintptr_t begin = (reinterpret_cast<uintptr_t>(pointer) + page_size - 1) &
+                    ~(page_size - 1);
+  uintptr_t end = (reinterpret_cast<uintptr_t>(pointer) + size) &
+                  ~(page_size - 1);
+  if (end <= begin) {
+    return Status::OK();
+  }
+  constexpr size_t bits = sizeof(unsigned long) * 8;  // NOLINT(runtime/int)
+  std::vector<unsigned long> nodemask(  // NOLINT(runtime/int)
+      node / bits + 1, 0);
+  nodemask[node / bits] |= 1UL << (node % bits);
+  if (syscall(SYS_mbind, begin, end - begin, kMPolicyPreferred,
+              nodemask.data(), nodemask.size() * bits + 1,
+              kMPolicyMoveFlag) != 0) {
+    return Status::Invalid("mbind failed: " + std::string(strerror(errno)));
+  }
+#endif
+  return Status::OK();
+}
+
+}  // namespace memory
+
+}  // namespace vineyard
@@ -0,0 +1,61 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_MEMORY_NUMA_H_
+#define SRC_SERVER_MEMORY_NUMA_H_
+
+#include <sys/types.h>
+
+#include <cstddef>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+namespace memory {
+
+/**
+ * @brief The number of NUMA nodes on this machine, returns 1 if the machine
+ * is not a NUMA system or the topology cannot be detected.
+ */
+int numa_node_count();
+
+/**
+ * @brief The NUMA node that the given CPU belongs to, returns -1 if unknown.
+ */
+int numa_node_of_cpu(const int cpu);
+
+/**
+ * @brief The NUMA node of the CPU that the given process last ran on, returns
+ * -1 if unknown.
+ */
+int numa_node_of_process(const pid_t pid);
+
+/**
+ * @brief Prefer allocating the pages of the given range on the NUMA node.
+ *
+ * The shared memory is backed by files, the memory policy is attached to the
+ * file thus takes effect when the pages are first touched by any process,
+ * e.g., when the client fills the blob. Pages that are resident already are
+ * migrated if possible. Only the pages that the blob covers entirely are
+ * bound, thus blobs smaller than a page are left to the default policy.
+ */
+Status numa_bind(void* pointer, const size_t size, const int node);
+
+}  // namespace memory
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_MEMORY_NUMA_H_
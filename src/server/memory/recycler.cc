@@ -0,0 +1,124 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/memory/recycler.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#include "common/util/logging.h"
+
+namespace vineyard {
+
+namespace memory {
+
+// wait a while before recycling to batch the ranges freed in a burst
+static constexpr auto kRecycleDelay = std::chrono::milliseconds(10);
+
+PageRecycler::PageRecycler() : worker_(&PageRecycler::run, this) {}
+
+PageRecycler::~PageRecycler() { Stop(); }
+
+void PageRecycler::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+  }
+  pending_cv_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+void PageRecycler::Recycle(const uintptr_t left, const uintptr_t right) {
+  if (left >= right) {
+    return;
+  }
+  uintptr_t lower = left, upper = right;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopped_) {
+      // the shared memory is being unmapped
+      return;
+    }
+    // merge with the ranges that overlap or are adjacent to [left, right)
+    auto iter = pending_.upper_bound(lower);
+    if (iter != pending_.begin() && std::prev(iter)->second >= lower) {
+      --iter;
+    }
+    while (iter != pending_.end() && iter->first <= upper) {
+      lower = std::min(lower, iter->first);
+      upper = std::max(upper, iter->second);
+      iter = pending_.erase(iter);
+    }
+    pending_.emplace(lower, upper);
+  }
+  pending_cv_.notify_one();
+}
+
+void PageRecycler::Flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  flushed_cv_.wait(lock, [this]() { return pending_.empty() && !recycling_; });
+}
+
+void PageRecycler::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    pending_cv_.wait(lock, [this]() { return stopped_ || !pending_.empty(); });
+    if (!stopped_) {
+      pending_cv_.wait_for(lock, kRecycleDelay, [this]() { return stopped_; });
+    }
+    if (pending_.empty() && stopped_) {
+      break;
+    }
+    std::map<uintptr_t, uintptr_t> ranges;
+    std::swap(ranges, pending_);
+    recycling_ = true;
+    lock.unlock();
+    /**
+     * Notes [Recycle Pages with madvise]:
+     *
+     * 1. madvise(.., MADV_FREE) cannot be used for shared memory, thus we use
+     * `MADV_DONTNEED`.
+     * 2. madvise(...) requires alignment to PAGE size.
+     *
+     * See also: https://man7.org/linux/man-pages/man2/madvise.2.html
+     */
+    for (auto const& range : ranges) {
+      if (madvise(reinterpret_cast<void*>(range.first),
+                  range.second - range.first, MADV_DONTNEED)) {
+        LOG(ERROR) << "madvise: " << errno << " -> " << strerror(errno);
+      } else {
+        recycled_bytes_ += range.second - range.first;
+      }
+    }
+    madvise_calls_ += ranges.size();
+    DVLOG(10) << "recycled " << ranges.size() << " ranges of pages";
+    lock.lock();
+    recycling_ = false;
+    flushed_cv_.notify_all();
+  }
+  flushed_cv_.notify_all();
+}
+
+}  // namespace memory
+
+}  // namespace vineyard
@@ -0,0 +1,90 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_MEMORY_RECYCLER_H_
+#define SRC_SERVER_MEMORY_RECYCLER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace vineyard {
+
+namespace memory {
+
+/**
+ * @brief PageRecycler releases the resident pages of freed ranges back to the
+ * OS kernel in a background thread, to keep `madvise()` off the threads that
+ * serve requests.
+ *
+ * Ranges that are recycled in a short period are queued and coalesced, and
+ * adjacent (or overlapping) ranges are released by a single `madvise()`.
+ */
+class PageRecycler {
+ public:
+  PageRecycler();
+
+  ~PageRecycler();
+
+  /**
+   * @brief Queue the range [left, right) for recycling, both of them must be
+   * aligned to pages.
+   */
+  void Recycle(const uintptr_t left, const uintptr_t right);
+
+  /**
+   * @brief Block until all queued ranges have been released.
+   */
+  void Flush();
+
+  /**
+   * @brief Release the queued ranges and stop the background thread, the
+   * ranges that are recycled later are ignored. Must be called before the
+   * shared memory is unmapped.
+   */
+  void Stop();
+
+  uint64_t RecycledBytes() const { return recycled_bytes_; }
+
+  uint64_t MadviseCalls() const { return madvise_calls_; }
+
+  std::thread::native_handle_type NativeHandle() {
+    return worker_.native_handle();
+  }
+
+ private:
+  void run();
+
+  std::mutex mutex_;
+  std::condition_variable pending_cv_, flushed_cv_;
+  // coalesced ranges, left -> right
+  std::map<uintptr_t, uintptr_t> pending_;
+  bool recycling_ = false;
+  bool stopped_ = false;
+  std::atomic<uint64_t> recycled_bytes_{0};
+  std::atomic<uint64_t> madvise_calls_{0};
+  // must be the last member, as it starts running in the constructor
+  std::thread worker_;
+};
+
+}  // namespace memory
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_MEMORY_RECYCLER_H_
@@ -0,0 +1,141 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/memory/remote_cache.h"
+
+#include <utility>
+
+#include "glog/logging.h"
+
+#include "server/memory/memory.h"
+
+namespace vineyard {
+
+RemoteBlobCache::RemoteBlobCache(std::shared_ptr<BulkStore> bulk_store,
+                                 const size_t capacity)
+    : bulk_store_(bulk_store), capacity_(capacity) {}
+
+void RemoteBlobCache::Get(const std::vector<ObjectID>& remote_ids,
+                          std::vector<ObjectID>& local_ids) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  local_ids.clear();
+  local_ids.reserve(remote_ids.size());
+  for (auto const& remote_id : remote_ids) {
+    auto iter = entries_.find(remote_id);
+    if (iter == entries_.end()) {
+      local_ids.emplace_back(InvalidObjectID());
+      continue;
+    }
+    if (!bulk_store_->Exists(iter->second.local_id)) {
+      // the copy has been evicted or deleted by the bulk store
+      size_ -= iter->second.size;
+      lru_.erase(iter->second.position);
+      entries_.erase(iter);
+      local_ids.emplace_back(InvalidObjectID());
+      continue;
+    }
+    lru_.splice(lru_.begin(), lru_, iter->second.position);
+    local_ids.emplace_back(iter->second.local_id);
+  }
+}
+
+Status RemoteBlobCache::Put(const ObjectID remote_id, const ObjectID local_id,
+                            std::shared_ptr<const std::string> const& owner) {
+  size_t size = 0;
+  {
+    BulkStore::object_map_t::const_accessor accessor;
+    if (!bulk_store_->List().find(accessor, local_id)) {
+      return Status::ObjectNotExists("cache remote blob: " +
+                                     ObjectIDToString(local_id));
+    }
+    auto const& object = accessor->second;
+    if (owner == nullptr || object->owner == nullptr ||
+        *object->owner != *owner) {
+      return Status::Invalid("cache remote blob: " +
+                             ObjectIDToString(local_id) +
+                             " is not created by the client");
+    }
+    size = object->data_size;
+  }
+  if (bulk_store_->IsReferencedByMeta(local_id)) {
+    return Status::Invalid("cache remote blob: " + ObjectIDToString(local_id) +
+                           " is a member of metadata");
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = entries_.find(remote_id);
+  if (iter != entries_.end()) {
+    if (iter->second.local_id == local_id) {
+      lru_.splice(lru_.begin(), lru_, iter->second.position);
+      return Status::OK();
+    }
+    drop(iter);
+  }
+  lru_.emplace_front(remote_id);
+  entries_.emplace(remote_id, Entry{local_id, size, lru_.begin()});
+  size_ += size;
+  evict(remote_id);
+  return Status::OK();
+}
+
+void RemoteBlobCache::Invalidate(const std::set<ObjectID>& remote_ids) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto const& remote_id : remote_ids) {
+    auto iter = entries_.find(remote_id);
+    if (iter != entries_.end()) {
+      drop(iter);
+    }
+  }
+}
+
+bool RemoteBlobCache::referenced(const ObjectID local_id) const {
+  BulkStore::object_map_t::const_accessor accessor;
+  if (!bulk_store_->List().find(accessor, local_id)) {
+    return false;
+  }
+  return accessor->second->ref_cnt > 0;
+}
+
+void RemoteBlobCache::drop(entry_map_t::iterator iter) {
+  auto status = bulk_store_->Delete(iter->second.local_id);
+  if (!status.ok() && !status.IsObjectNotExists()) {
+    LOG(WARNING) << "Failed to delete the cached copy "
+                 << ObjectIDToString(iter->second.local_id) << ": "
+                 << status.ToString();
+  }
+  size_ -= iter->second.size;
+  lru_.erase(iter->second.position);
+  entries_.erase(iter);
+}
+
+void RemoteBlobCache::evict(const ObjectID keep) {
+  // walk from the least recently used end, skipping copies in use
+  auto position = lru_.end();
+  while (size_ > capacity_ && position != lru_.begin()) {
+    --position;
+    if (*position == keep) {
+      continue;
+    }
+    auto iter = entries_.find(*position);
+    if (referenced(iter->second.local_id)) {
+      continue;
+    }
+    // `drop()` invalidates `position`, step past the victim first
+    ++position;
+    drop(iter);
+  }
+}
+
+}  // namespace vineyard
@@ -0,0 +1,102 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_MEMORY_REMOTE_CACHE_H_
+#define SRC_SERVER_MEMORY_REMOTE_CACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/util/status.h"
+#include "common/util/uuid.h"
+
+namespace vineyard {
+
+class BulkStore;
+
+/**
+ * @brief RemoteBlobCache keeps the local copies of blobs fetched from remote
+ * instances, keyed by the remote blob ids, to make repeated cross-instance
+ * reads local shared-memory reads.
+ *
+ * The cache is bounded by `capacity` bytes, the least recently used copies
+ * that are not referenced by any client are deleted from the bulk store to
+ * make room for new ones.
+ */
+class RemoteBlobCache {
+ public:
+  RemoteBlobCache(std::shared_ptr<BulkStore> bulk_store,
+                  const size_t capacity);
+
+  /**
+   * @brief Look up the local copies of the remote blobs, `InvalidObjectID()`
+   * for the blobs that are not cached.
+   */
+  void Get(const std::vector<ObjectID>& remote_ids,
+           std::vector<ObjectID>& local_ids);
+
+  /**
+   * @brief Record the local blob as the copy of the remote blob. The local
+   * blob is owned by the cache afterwards, thus it must have been created by
+   * the `owner`, i.e., the requesting client, and mustn't be a member of any
+   * metadata.
+   */
+  Status Put(const ObjectID remote_id, const ObjectID local_id,
+             std::shared_ptr<const std::string> const& owner);
+
+  /**
+   * @brief Drop the cached copies of the remote blobs, e.g., when the remote
+   * blobs have been deleted.
+   */
+  void Invalidate(const std::set<ObjectID>& remote_ids);
+
+  size_t Size() const { return size_; }
+
+  size_t Capacity() const { return capacity_; }
+
+ private:
+  struct Entry {
+    ObjectID local_id;
+    size_t size;
+    std::list<ObjectID>::iterator position;
+  };
+
+  using entry_map_t = std::unordered_map<ObjectID, Entry>;
+
+  bool referenced(const ObjectID local_id) const;
+
+  void drop(entry_map_t::iterator iter);
+
+  void evict(const ObjectID keep);
+
+  std::shared_ptr<BulkStore> bulk_store_;
+  const size_t capacity_;
+  size_t size_ = 0;
+
+  std::mutex mutex_;
+  // remote ids, the most recently used one at the front
+  std::list<ObjectID> lru_;
+  entry_map_t entries_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_MEMORY_REMOTE_CACHE_H_
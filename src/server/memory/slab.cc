@@ -0,0 +1,111 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/memory/slab.h"
+
+#include <algorithm>
+
+#include "common/util/logging.h"
+#include "server/memory/allocator.h"
+#include "server/memory/malloc.h"
+
+namespace vineyard {
+
+namespace memory {
+
+void SlabAllocator::SetThreshold(const size_t threshold) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (threshold == 0) {
+    threshold_ = 0;
+    return;
+  }
+  // at least 8 chunks in a slab
+  threshold_ = std::min(threshold, kSlabSize / 8);
+  partial_slabs_.resize(size_class(threshold_) + 1);
+}
+
+size_t SlabAllocator::size_class(const size_t size) const {
+  size_t index = 0, chunk_size = kBlockSize;
+  while (chunk_size < size) {
+    chunk_size <<= 1;
+    index += 1;
+  }
+  return index;
+}
+
+void* SlabAllocator::Allocate(const size_t size) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  size_t index = size_class(size);
+  auto& partial = partial_slabs_[index];
+  if (partial.empty()) {
+    void* base = BulkAllocator::Memalign(kSlabSize, kBlockSize);
+    if (base == nullptr) {
+      return nullptr;
+    }
+    Slab empty;
+    empty.base = reinterpret_cast<uintptr_t>(base);
+    empty.chunk_size = static_cast<size_t>(kBlockSize) << index;
+    empty.used = 0;
+    empty.untouched = 0;
+    empty.free_list = nullptr;
+    uintptr_t address = empty.base;
+    slabs_.emplace(address, empty);
+    partial.emplace(address);
+  }
+  Slab& slab = slabs_.at(*partial.begin());
+  void* chunk = nullptr;
+  if (slab.free_list != nullptr) {
+    chunk = slab.free_list;
+    slab.free_list = *reinterpret_cast<void**>(chunk);
+  } else {
+    chunk = reinterpret_cast<void*>(slab.base + slab.untouched);
+    slab.untouched += slab.chunk_size;
+  }
+  slab.used += 1;
+  if (slab.free_list == nullptr && slab.untouched == kSlabSize) {
+    partial.erase(partial.begin());
+  }
+  return chunk;
+}
+
+void SlabAllocator::Free(void* pointer, const size_t size) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+  auto iter = slabs_.upper_bound(address);
+  if (iter == slabs_.begin() ||
+      address >= (--iter)->second.base + kSlabSize) {
+    LOG(ERROR) << "Failed to free " << pointer << ": not a slab chunk";
+    return;
+  }
+  Slab& slab = iter->second;
+  uintptr_t base = slab.base;
+  auto& partial = partial_slabs_[size_class(slab.chunk_size)];
+  *reinterpret_cast<void**>(pointer) = slab.free_list;
+  slab.free_list = pointer;
+  slab.used -= 1;
+  if (slab.used == 0 && partial.size() > 1) {
+    // give the empty slab back, unless it is the only one that has free
+    // chunks in this size class
+    partial.erase(base);
+    slabs_.erase(iter);
+    BulkAllocator::Free(reinterpret_cast<void*>(base), kSlabSize);
+  } else {
+    partial.emplace(base);
+  }
+}
+
+}  // namespace memory
+
+}  // namespace vineyard
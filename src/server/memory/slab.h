@@ -0,0 +1,88 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_MEMORY_SLAB_H_
+#define SRC_SERVER_MEMORY_SLAB_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace vineyard {
+
+namespace memory {
+
+/**
+ * @brief SlabAllocator packs small blobs into slabs of shared pages, to avoid
+ * the per-chunk overhead and the lock contention of the bulk allocator when
+ * creating lots of tiny blobs, e.g., offsets, null bitmaps and scalars.
+ *
+ * Slabs are obtained from (and given back to) the BulkAllocator, and each
+ * slab contains chunks of a single size class. Size classes are powers of two
+ * starting from kBlockSize, thus chunks are still aligned to kBlockSize.
+ */
+class SlabAllocator {
+ public:
+  static constexpr size_t kSlabSize = 64 * 1024;  // 64KB
+
+  /**
+   * @brief Blobs that not larger than the threshold are allocated from
+   * slabs, zero means the slab allocator is disabled.
+   */
+  void SetThreshold(const size_t threshold);
+
+  bool Accepts(const size_t size) const {
+    return size > 0 && size <= threshold_;
+  }
+
+  void* Allocate(const size_t size);
+
+  void Free(void* pointer, const size_t size);
+
+  /**
+   * @brief Bytes of slabs that have been obtained from the bulk allocator.
+   */
+  size_t Footprint() const { return slabs_.size() * kSlabSize; }
+
+ private:
+  struct Slab {
+    uintptr_t base;
+    size_t chunk_size;
+    size_t used;
+    // chunks beyond `untouched` have never been allocated
+    size_t untouched;
+    // intrusive list of freed chunks
+    void* free_list;
+  };
+
+  size_t size_class(const size_t size) const;
+
+  size_t threshold_ = 0;
+
+  // ordered by the base address, for finding the slab of a chunk
+  std::map<uintptr_t, Slab> slabs_;
+  // slabs that have free chunks, for each size class
+  std::vector<std::set<uintptr_t>> partial_slabs_;
+  std::mutex mutex_;
+};
+
+}  // namespace memory
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_MEMORY_SLAB_H_
@@ -15,14 +15,20 @@ limitations under the License.
 
 #include "server/memory/stream_store.h"
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <mutex>
+#include <ostream>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "common/util/callback.h"
 #include "common/util/logging.h"
 #include "server/memory/memory.h"
 #include "server/server/vineyard_server.h"
+#include "server/util/metrics.h"
 
 namespace vineyard {
 
@@ -38,26 +44,89 @@ namespace vineyard {
   } while (0)
 #endif  // CHECK_STREAM_STATE
 
+#ifndef CHECK_STREAM_STATE_BATCH
+#define CHECK_STREAM_STATE_BATCH(condition)                            \
+  do {                                                                 \
+    if (!(condition)) {                                                \
+      LOG(ERROR) << "Stream state error(" __FILE__                     \
+                    ":" VINEYARD_TO_STRING(__LINE__) "): " #condition; \
+      return callback(Status::InvalidStreamState(#condition),          \
+                      std::vector<ObjectID>{});                        \
+    }                                                                  \
+  } while (0)
+#endif  // CHECK_STREAM_STATE_BATCH
+
+// see also: StreamOpenMode in client_base.h
+static constexpr int64_t kStreamOpenRead = 1;
+static constexpr int64_t kStreamOpenFanout = 4;
+static constexpr int64_t kStreamOpenShared = 8;
+
+// max number of consumed chunks that a stream keeps for reusing
+static constexpr size_t kChunkPoolCapacity = 16;
+
 // manage a pool of streams.
-Status StreamStore::Create(ObjectID const stream_id) {
+Status StreamStore::Create(ObjectID const stream_id,
+                           size_t const high_watermark_bytes,
+                           size_t const low_watermark_bytes,
+                           size_t const high_watermark_chunks,
+                           size_t const low_watermark_chunks,
+                           bool const recycle_chunks) {
   std::lock_guard<std::recursive_mutex> __guard(this->mutex_);
   if (streams_.find(stream_id) != streams_.end()) {
     return Status::ObjectExists();
   }
-  streams_.emplace(stream_id, std::make_shared<StreamHolder>());
+  if ((high_watermark_bytes != 0 &&
+       low_watermark_bytes > high_watermark_bytes) ||
+      (high_watermark_chunks != 0 &&
+       low_watermark_chunks > high_watermark_chunks)) {
+    return Status::Invalid(
+        "The low watermark of stream cannot exceed the high watermark");
+  }
+  auto stream = std::make_shared<StreamHolder>();
+  stream->high_watermark_bytes = high_watermark_bytes;
+  stream->low_watermark_bytes = low_watermark_bytes;
+  stream->high_watermark_chunks = high_watermark_chunks;
+  stream->low_watermark_chunks = low_watermark_chunks;
+  stream->recycle_chunks = recycle_chunks;
+  streams_.emplace(stream_id, stream);
   return Status::OK();
 }
 
-Status StreamStore::Open(ObjectID const stream_id, int64_t const mode) {
+Status StreamStore::Open(ObjectID const stream_id, int64_t const mode,
+                         int64_t const reader) {
   std::lock_guard<std::recursive_mutex> __guard(this->mutex_);
   if (streams_.find(stream_id) == streams_.end()) {
     return Status::ObjectNotExists("stream cannot be open: " +
                                    ObjectIDToString(stream_id));
   }
-  if (streams_[stream_id]->open_mark & mode) {
+  auto stream = streams_.at(stream_id);
+  if (mode & kStreamOpenShared) {
+    // the shared readers cannot be mixed with the other kinds of readers
+    if ((stream->open_mark & (kStreamOpenRead | kStreamOpenFanout)) ||
+        stream->claimers_.find(reader) != stream->claimers_.end()) {
+      return Status::StreamOpened();
+    }
+    stream->claimers_[reader];
+    stream->open_mark |= mode;
+    return Status::OK();
+  }
+  if (mode & kStreamOpenFanout) {
+    // the exclusive reader and fan-out readers cannot be mixed
+    if ((stream->open_mark & (kStreamOpenRead | kStreamOpenShared)) ||
+        stream->subscribers_.find(reader) != stream->subscribers_.end()) {
+      return Status::StreamOpened();
+    }
+    // reads from the oldest chunk that is still kept
+    stream->subscribers_[reader].next = stream->ready_base_;
+    stream->open_mark |= mode;
+    return Status::OK();
+  }
+  if ((stream->open_mark & mode) ||
+      ((mode & kStreamOpenRead) &&
+       (stream->open_mark & (kStreamOpenFanout | kStreamOpenShared)))) {
     return Status::StreamOpened();
   }
-  streams_[stream_id]->open_mark |= mode;
+  stream->open_mark |= mode;
   return Status::OK();
 }
 
@@ -78,7 +147,7 @@ Status StreamStore::Get(ObjectID const stream_id, size_t const size,
 
   // seal current chunk
   if (stream->current_writing_) {
-    stream->ready_chunks_.push(stream->current_writing_.get());
+    stream->ready_chunks_.push_back(stream->current_writing_.get());
     stream->current_writing_ = boost::none;
   }
   // weak up the pending reader
@@ -87,21 +156,24 @@ Status StreamStore::Get(ObjectID const stream_id, size_t const size,
     CHECK_STREAM_STATE(!stream->current_reading_);
     if (!stream->ready_chunks_.empty()) {
       stream->current_reading_ = stream->ready_chunks_.front();
-      stream->ready_chunks_.pop();
+      stream->ready_chunks_.pop_front();
       VINEYARD_SUPPRESS(
           stream->reader_.get()(Status::OK(), stream->current_reading_.get()));
       stream->reader_ = boost::none;
     }
   }
+  wakeupSubscribers(stream);
+  wakeupClaimers(stream);
+  releaseConsumed(stream);
 
-  if (allocatable(stream, size)) {
+  if (!throttled(stream, size, 1) && allocatable(stream, size)) {
     // do allocation
     ObjectID chunk;
-    std::shared_ptr<Payload> object;
-    auto status = store_->Create(size, chunk, object);
+    auto status = allocateChunk(stream, size, chunk);
     if (!status.ok()) {
       return callback(status, InvalidObjectID());
     } else {
+      bufferChunk(stream, chunk, size);
       stream->current_writing_ = chunk;
       return callback(Status::OK(), stream->current_writing_.get());
     }
@@ -116,6 +188,12 @@ Status StreamStore::Get(ObjectID const stream_id, size_t const size,
 // available for consumer to read
 Status StreamStore::Push(ObjectID const stream_id, ObjectID const chunk,
                          callback_t<const ObjectID> callback) {
+  return Push(stream_id, std::vector<ObjectID>{chunk}, callback);
+}
+
+Status StreamStore::Push(ObjectID const stream_id,
+                         std::vector<ObjectID> const& chunks,
+                         callback_t<const ObjectID> callback) {
   std::lock_guard<std::recursive_mutex> __guard(this->mutex_);
   if (streams_.find(stream_id) == streams_.end()) {
     return callback(Status::ObjectNotExists("failed to push to stream"),
@@ -124,11 +202,16 @@ Status StreamStore::Push(ObjectID const stream_id, ObjectID const chunk,
   auto stream = streams_.at(stream_id);
 
   // precondition: there's no unsatistified writer, and still running
-  CHECK_STREAM_STATE(!stream->writer_);
+  CHECK_STREAM_STATE(!stream->writer_ && !stream->pusher_);
   CHECK_STREAM_STATE(!stream->drained && !stream->failed);
 
-  // seal current chunk
-  stream->ready_chunks_.push(chunk);
+  // seal current chunks
+  for (auto const chunk : chunks) {
+    stream->ready_chunks_.push_back(chunk);
+    std::shared_ptr<Payload> object;
+    bool is_blob = IsBlob(chunk) && store_->Get(chunk, object).ok();
+    bufferChunk(stream, chunk, is_blob ? object->data_size : 0);
+  }
 
   // weak up the pending reader
   if (stream->reader_) {
@@ -136,84 +219,109 @@ Status StreamStore::Push(ObjectID const stream_id, ObjectID const chunk,
     CHECK_STREAM_STATE(!stream->current_reading_);
     if (!stream->ready_chunks_.empty()) {
       stream->current_reading_ = stream->ready_chunks_.front();
-      stream->ready_chunks_.pop();
+      stream->ready_chunks_.pop_front();
       VINEYARD_SUPPRESS(
           stream->reader_.get()(Status::OK(), stream->current_reading_.get()));
       stream->reader_ = boost::none;
     }
   }
+  wakeupSubscribers(stream);
+  wakeupClaimers(stream);
+  releaseConsumed(stream);
 
+  if (throttled(stream, 0, 0)) {
+    // reply after the reader catches up
+    stream->pusher_ = callback;
+    return Status::OK();
+  }
   // done
   return callback(Status::OK(), InvalidObjectID());
 }
 
 // for consumer: read current chunk
-Status StreamStore::Pull(ObjectID const stream_id,
+Status StreamStore::Pull(ObjectID const stream_id, int64_t const reader,
                          callback_t<const ObjectID> callback) {
+  return Pull(stream_id, reader, 1, 0,
+              [callback](const Status& status,
+                         const std::vector<ObjectID>& chunks) {
+                return callback(status, chunks.empty() ? InvalidObjectID()
+                                                       : chunks.front());
+              });
+}
+
+// for consumer: read a batch of chunks
+Status StreamStore::Pull(ObjectID const stream_id, int64_t const reader,
+                         size_t const max_chunks, size_t const max_bytes,
+                         callback_t<const std::vector<ObjectID>&> callback) {
   std::lock_guard<std::recursive_mutex> __guard(this->mutex_);
   if (streams_.find(stream_id) == streams_.end()) {
     return callback(Status::ObjectNotExists("failed to pull from stream"),
-                    InvalidObjectID());
+                    std::vector<ObjectID>{});
   }
   auto stream = streams_.at(stream_id);
 
+  if (stream->open_mark & kStreamOpenFanout) {
+    auto subscriber = stream->subscribers_.find(reader);
+    CHECK_STREAM_STATE_BATCH(subscriber != stream->subscribers_.end());
+    return pullShared(stream, subscriber->second, max_chunks, max_bytes,
+                      callback);
+  }
+  if (stream->open_mark & kStreamOpenShared) {
+    auto claimer = stream->claimers_.find(reader);
+    CHECK_STREAM_STATE_BATCH(claimer != stream->claimers_.end());
+    return pullClaimed(stream, reader, claimer->second, max_chunks, max_bytes,
+                       callback);
+  }
+
   // precondition: there's no unsatistified reader
-  CHECK_STREAM_STATE(!stream->reader_);
+  CHECK_STREAM_STATE_BATCH(!stream->reader_);
 
   // drop current reading
   if (stream->current_reading_) {
-    auto target = stream->current_reading_.get();
-    Status status;
-    if (IsBlob(target)) {
-      status = store_->Delete(target);
-    } else {
-      status = server_->DelData(
-          {target}, false, true, false, [](Status const& status) {
-            if (!status.ok()) {
-              LOG(WARNING) << "failed to delete the stream chunk: "
-                           << status.ToString();
-            }
-            return Status::OK();
-          });
+    auto status = deleteChunk(stream, stream->current_reading_.get());
+    for (auto const chunk : stream->batch_reading_) {
+      auto s = deleteChunk(stream, chunk);
+      if (status.ok() && !s.ok()) {
+        status = s;
+      }
     }
+    stream->current_reading_ = boost::none;
+    stream->batch_reading_.clear();
     if (!status.ok()) {
-      return callback(status, InvalidObjectID());
+      return callback(status, std::vector<ObjectID>{});
     }
-    stream->current_reading_ = boost::none;
   }
   // wake up the pending writer
   if (stream->writer_) {
     // should be no writing chunk
-    CHECK_STREAM_STATE(!stream->current_writing_);
-    auto writer = stream->writer_.get();
-    if (allocatable(stream, writer.first)) {
-      ObjectID chunk;
-      std::shared_ptr<Payload> object;
-      auto status = store_->Create(writer.first, chunk, object);
-      if (!status.ok()) {
-        VINEYARD_SUPPRESS(writer.second(status, InvalidObjectID()));
-      } else {
-        stream->current_writing_ = chunk;
-        VINEYARD_SUPPRESS(
-            writer.second(Status::OK(), stream->current_writing_.get()));
-        stream->writer_ = boost::none;
-      }
-    }
+    CHECK_STREAM_STATE_BATCH(!stream->current_writing_);
   }
+  wakeupWriter(stream);
 
-  if (!stream->ready_chunks_.empty()) {
-    stream->current_reading_ = stream->ready_chunks_.front();
-    stream->ready_chunks_.pop();
-    return callback(Status::OK(), stream->current_reading_.get());
+  size_t count = batchSize(stream, 0, max_chunks, max_bytes);
+  if (count > 0) {
+    std::vector<ObjectID> chunks(stream->ready_chunks_.begin(),
+                                 stream->ready_chunks_.begin() + count);
+    stream->ready_chunks_.erase(stream->ready_chunks_.begin(),
+                                stream->ready_chunks_.begin() + count);
+    stream->current_reading_ = chunks.front();
+    stream->batch_reading_.assign(chunks.begin() + 1, chunks.end());
+    return callback(Status::OK(), chunks);
   } else {
     // if stream has been stoped, return a proper status.
     if (stream->drained) {
-      return callback(Status::StreamDrained(), InvalidObjectID());
+      return callback(Status::StreamDrained(), std::vector<ObjectID>{});
     } else if (stream->failed) {
-      return callback(Status::StreamFailed(), InvalidObjectID());
+      return callback(Status::StreamFailed(), std::vector<ObjectID>{});
     } else {
-      // pending the reader
-      stream->reader_ = callback;
+      // pending the reader, which will be woken up by a single chunk
+      stream->reader_ = [callback](const Status& status,
+                                   const ObjectID chunk) {
+        if (status.ok()) {
+          return callback(status, std::vector<ObjectID>{chunk});
+        }
+        return callback(status, std::vector<ObjectID>{});
+      };
       return Status::OK();
     }
   }
@@ -236,7 +344,7 @@ Status StreamStore::Stop(ObjectID const stream_id, bool failed) {
   }
   // seal current writing chunk
   if (stream->current_writing_) {
-    stream->ready_chunks_.push(stream->current_writing_.get());
+    stream->ready_chunks_.push_back(stream->current_writing_.get());
     stream->current_writing_ = boost::none;
   }
   // stop
@@ -245,6 +353,10 @@ Status StreamStore::Stop(ObjectID const stream_id, bool failed) {
   } else {
     stream->drained = true;
   }
+  // the producer won't ask for chunks any more
+  releaseChunkPool(stream);
+  wakeupSubscribers(stream);
+  wakeupClaimers(stream);
   // weak up the pending reader
   if (stream->reader_) {
     // should be no reading chunk
@@ -261,7 +373,7 @@ Status StreamStore::Stop(ObjectID const stream_id, bool failed) {
       stream->reader_ = boost::none;
     } else if (!stream->ready_chunks_.empty()) {
       stream->current_reading_ = stream->ready_chunks_.front();
-      stream->ready_chunks_.pop();
+      stream->ready_chunks_.pop_front();
       VINEYARD_SUPPRESS(
           stream->reader_.get()(Status::OK(), stream->current_reading_.get()));
       stream->reader_ = boost::none;
@@ -276,14 +388,41 @@ Status StreamStore::Stop(ObjectID const stream_id, bool failed) {
   return Status::OK();
 }
 
-Status StreamStore::Drop(ObjectID const stream_id) {
+Status StreamStore::Drop(ObjectID const stream_id, int64_t const reader) {
   std::lock_guard<std::recursive_mutex> __guard(this->mutex_);
   if (streams_.find(stream_id) == streams_.end()) {
     return Status::ObjectNotExists("failed to drop stream: " +
                                    ObjectIDToString(stream_id));
   }
   auto stream = streams_.at(stream_id);
+  if (stream->open_mark & kStreamOpenFanout) {
+    // the reader leaves, and won't hold back the other readers any more
+    if (stream->subscribers_.erase(reader)) {
+      releaseConsumed(stream);
+      wakeupWriter(stream);
+    }
+    return Status::OK();
+  }
+  if (stream->open_mark & kStreamOpenShared) {
+    auto claimer = stream->claimers_.find(reader);
+    if (claimer != stream->claimers_.end()) {
+      // the chunks that haven't been finished are handed to the others
+      auto& reading = claimer->second.reading;
+      stream->ready_chunks_.insert(stream->ready_chunks_.begin(),
+                                   reading.begin(), reading.end());
+      stream->claimers_.erase(claimer);
+      wakeupClaimers(stream);
+    }
+    return Status::OK();
+  }
   stream->failed = true;
+  releaseChunkPool(stream);
+  // the producer won't be unblocked by the reader any more
+  if (stream->pusher_) {
+    VINEYARD_SUPPRESS(
+        stream->pusher_.get()(Status::StreamFailed(), InvalidObjectID()));
+    stream->pusher_ = boost::none;
+  }
   // weakup pending reader
   if (stream->reader_) {
     // should be no reading chunk
@@ -297,28 +436,21 @@ Status StreamStore::Drop(ObjectID const stream_id) {
   // drop all memory chunks in ready queue, but still keep the reading chunk
   // to avoid crash the reader
   while (!stream->ready_chunks_.empty()) {
-    auto target = stream->ready_chunks_.front();
-    Status status;
-    if (IsBlob(target)) {
-      status = store_->Delete(target);
-    } else {
-      status = server_->DelData(
-          {target}, false, true, false, [](Status const& status) {
-            if (!status.ok()) {
-              LOG(WARNING) << "failed to delete the stream chunk: "
-                           << status.ToString();
-            }
-            return Status::OK();
-          });
-    }
-    VINEYARD_DISCARD(status);
-    stream->ready_chunks_.pop();
+    VINEYARD_DISCARD(deleteChunk(stream, stream->ready_chunks_.front()));
+    stream->ready_chunks_.pop_front();
   }
   return Status::OK();
 }
 
 bool StreamStore::allocatable(std::shared_ptr<StreamHolder> stream,
                               size_t size) {
+  if (stream->recycle_chunks) {
+    // reusing a chunk doesn't take more memory
+    auto pooled = stream->chunk_pool_.find(size);
+    if (pooled != stream->chunk_pool_.end() && !pooled->second.empty()) {
+      return true;
+    }
+  }
   if (store_->Footprint() + size <
       store_->FootprintLimit() * threshold_ / 100.0) {
     return true;
@@ -327,4 +459,341 @@ bool StreamStore::allocatable(std::shared_ptr<StreamHolder> stream,
   }
 }
 
+bool StreamStore::throttled(std::shared_ptr<StreamHolder> stream,
+                            size_t const size, size_t const chunks) {
+  if (stream->throttled) {
+    // resume once the consumption catches up with the low watermark
+    if ((stream->high_watermark_bytes == 0 ||
+         stream->buffered_bytes <= stream->low_watermark_bytes) &&
+        (stream->high_watermark_chunks == 0 ||
+         stream->buffered_chunks <= stream->low_watermark_chunks)) {
+      stream->throttled = false;
+    }
+  } else if (stream->buffered_chunks > 0) {
+    // a single chunk that exceeds the watermark is still allowed
+    if ((stream->high_watermark_bytes != 0 &&
+         stream->buffered_bytes + size > stream->high_watermark_bytes) ||
+        (stream->high_watermark_chunks != 0 &&
+         stream->buffered_chunks + chunks > stream->high_watermark_chunks)) {
+      stream->throttled = true;
+    }
+  }
+  return stream->throttled;
+}
+
+void StreamStore::bufferChunk(std::shared_ptr<StreamHolder> stream,
+                              ObjectID const chunk, size_t const size) {
+  if (stream->buffered_sizes_.emplace(chunk, size).second) {
+    stream->buffered_bytes += size;
+    stream->buffered_chunks += 1;
+  }
+}
+
+Status StreamStore::allocateChunk(std::shared_ptr<StreamHolder> stream,
+                                  size_t const size, ObjectID& chunk) {
+  auto pooled = stream->chunk_pool_.find(size);
+  if (pooled != stream->chunk_pool_.end() && !pooled->second.empty()) {
+    chunk = pooled->second.back();
+    pooled->second.pop_back();
+    stream->pooled_chunks -= 1;
+    return Status::OK();
+  }
+  std::shared_ptr<Payload> object;
+  return store_->Create(size, chunk, object);
+}
+
+void StreamStore::releaseChunkPool(std::shared_ptr<StreamHolder> stream) {
+  for (auto const& pooled : stream->chunk_pool_) {
+    for (auto const& chunk : pooled.second) {
+      VINEYARD_DISCARD(store_->Delete(chunk));
+    }
+  }
+  stream->chunk_pool_.clear();
+  stream->pooled_chunks = 0;
+}
+
+Status StreamStore::deleteChunk(std::shared_ptr<StreamHolder> stream,
+                                ObjectID const chunk) {
+  size_t size = 0;
+  bool buffered_chunk = false;
+  auto buffered = stream->buffered_sizes_.find(chunk);
+  if (buffered != stream->buffered_sizes_.end()) {
+    size = buffered->second;
+    buffered_chunk = true;
+    stream->buffered_bytes -= buffered->second;
+    stream->buffered_chunks -= 1;
+    stream->buffered_sizes_.erase(buffered);
+  }
+  // keep the blob for the producer, unless the producer has finished
+  if (stream->recycle_chunks && buffered_chunk && size > 0 && IsBlob(chunk) &&
+      !stream->drained && !stream->failed &&
+      stream->pooled_chunks < kChunkPoolCapacity) {
+    stream->chunk_pool_[size].push_back(chunk);
+    stream->pooled_chunks += 1;
+    return Status::OK();
+  }
+  if (IsBlob(chunk)) {
+    return store_->Delete(chunk);
+  }
+  return server_->DelData(
+      {chunk}, false, true, false, [](Status const& status) {
+        if (!status.ok()) {
+          LOG(WARNING) << "failed to delete the stream chunk: "
+                       << status.ToString();
+        }
+        return Status::OK();
+      });
+}
+
+size_t StreamStore::batchSize(std::shared_ptr<StreamHolder> stream,
+                              size_t const begin, size_t const max_chunks,
+                              size_t const max_bytes) {
+  size_t count = 0, bytes = 0;
+  while (begin + count < stream->ready_chunks_.size() &&
+         count < std::max(max_chunks, static_cast<size_t>(1))) {
+    size_t size = 0;
+    auto buffered =
+        stream->buffered_sizes_.find(stream->ready_chunks_[begin + count]);
+    if (buffered != stream->buffered_sizes_.end()) {
+      size = buffered->second;
+    }
+    // the first chunk is always returned, even if it exceeds the budget
+    if (count > 0 && max_bytes != 0 && bytes + size > max_bytes) {
+      break;
+    }
+    bytes += size;
+    count += 1;
+  }
+  return count;
+}
+
+Status StreamStore::pullShared(
+    std::shared_ptr<StreamHolder> stream, StreamSubscriber& subscriber,
+    size_t const max_chunks, size_t const max_bytes,
+    callback_t<const std::vector<ObjectID>&> callback) {
+  // precondition: there's no unsatistified reader
+  CHECK_STREAM_STATE_BATCH(!subscriber.reader_);
+
+  // finish current reading
+  if (subscriber.reading > 0) {
+    subscriber.reading = 0;
+    releaseConsumed(stream);
+    wakeupWriter(stream);
+  }
+
+  size_t begin = subscriber.next - stream->ready_base_;
+  size_t count = batchSize(stream, begin, max_chunks, max_bytes);
+  if (count > 0) {
+    std::vector<ObjectID> chunks(stream->ready_chunks_.begin() + begin,
+                                 stream->ready_chunks_.begin() + begin + count);
+    subscriber.next += count;
+    subscriber.reading = count;
+    return callback(Status::OK(), chunks);
+  } else {
+    // if stream has been stoped, return a proper status.
+    if (stream->drained) {
+      return callback(Status::StreamDrained(), std::vector<ObjectID>{});
+    } else if (stream->failed) {
+      return callback(Status::StreamFailed(), std::vector<ObjectID>{});
+    } else {
+      // pending the reader, which will be woken up by a single chunk
+      subscriber.reader_ = [callback](const Status& status,
+                                      const ObjectID chunk) {
+        if (status.ok()) {
+          return callback(status, std::vector<ObjectID>{chunk});
+        }
+        return callback(status, std::vector<ObjectID>{});
+      };
+      return Status::OK();
+    }
+  }
+}
+
+void StreamStore::wakeupSubscribers(std::shared_ptr<StreamHolder> stream) {
+  for (auto& item : stream->subscribers_) {
+    auto& subscriber = item.second;
+    if (!subscriber.reader_) {
+      continue;
+    }
+    auto reader = subscriber.reader_.get();
+    if (subscriber.next < stream->ready_base_ + stream->ready_chunks_.size()) {
+      auto chunk = stream->ready_chunks_[subscriber.next - stream->ready_base_];
+      subscriber.next += 1;
+      subscriber.reading = 1;
+      subscriber.reader_ = boost::none;
+      VINEYARD_SUPPRESS(reader(Status::OK(), chunk));
+    } else if (stream->drained) {
+      subscriber.reader_ = boost::none;
+      VINEYARD_SUPPRESS(reader(Status::StreamDrained(), InvalidObjectID()));
+    } else if (stream->failed) {
+      subscriber.reader_ = boost::none;
+      VINEYARD_SUPPRESS(reader(Status::StreamFailed(), InvalidObjectID()));
+    }
+  }
+}
+
+Status StreamStore::pullClaimed(
+    std::shared_ptr<StreamHolder> stream, int64_t const reader,
+    StreamClaimer& claimer, size_t const max_chunks, size_t const max_bytes,
+    callback_t<const std::vector<ObjectID>&> callback) {
+  // precondition: there's no unsatistified reader
+  CHECK_STREAM_STATE_BATCH(!claimer.reader_);
+
+  // finish current reading
+  if (!claimer.reading.empty()) {
+    Status status;
+    for (auto const chunk : claimer.reading) {
+      auto s = deleteChunk(stream, chunk);
+      if (status.ok() && !s.ok()) {
+        status = s;
+      }
+    }
+    claimer.reading.clear();
+    wakeupWriter(stream);
+    if (!status.ok()) {
+      return callback(status, std::vector<ObjectID>{});
+    }
+  }
+
+  // the readers that arrived earlier are served first
+  size_t count = stream->pending_claimers_.empty()
+                     ? batchSize(stream, 0, max_chunks, max_bytes)
+                     : 0;
+  if (count > 0) {
+    claimer.reading.assign(stream->ready_chunks_.begin(),
+                           stream->ready_chunks_.begin() + count);
+    stream->ready_chunks_.erase(stream->ready_chunks_.begin(),
+                                stream->ready_chunks_.begin() + count);
+    return callback(Status::OK(), claimer.reading);
+  } else if (stream->ready_chunks_.empty() && stream->drained) {
+    return callback(Status::StreamDrained(), std::vector<ObjectID>{});
+  } else if (stream->ready_chunks_.empty() && stream->failed) {
+    return callback(Status::StreamFailed(), std::vector<ObjectID>{});
+  } else {
+    // pending the reader, which will be woken up by a single chunk
+    claimer.reader_ = [callback](const Status& status, const ObjectID chunk) {
+      if (status.ok()) {
+        return callback(status, std::vector<ObjectID>{chunk});
+      }
+      return callback(status, std::vector<ObjectID>{});
+    };
+    stream->pending_claimers_.push_back(reader);
+    wakeupClaimers(stream);
+    return Status::OK();
+  }
+}
+
+void StreamStore::wakeupClaimers(std::shared_ptr<StreamHolder> stream) {
+  while (!stream->pending_claimers_.empty()) {
+    auto claimer = stream->claimers_.find(stream->pending_claimers_.front());
+    if (claimer == stream->claimers_.end() || !claimer->second.reader_) {
+      // the reader has left
+      stream->pending_claimers_.pop_front();
+      continue;
+    }
+    auto reader = claimer->second.reader_.get();
+    if (!stream->ready_chunks_.empty()) {
+      auto chunk = stream->ready_chunks_.front();
+      stream->ready_chunks_.pop_front();
+      claimer->second.reading.assign(1, chunk);
+      claimer->second.reader_ = boost::none;
+      stream->pending_claimers_.pop_front();
+      VINEYARD_SUPPRESS(reader(Status::OK(), chunk));
+    } else if (stream->drained || stream->failed) {
+      claimer->second.reader_ = boost::none;
+      stream->pending_claimers_.pop_front();
+      VINEYARD_SUPPRESS(reader(stream->drained ? Status::StreamDrained()
+                                               : Status::StreamFailed(),
+                               InvalidObjectID()));
+    } else {
+      break;
+    }
+  }
+}
+
+void StreamStore::releaseConsumed(std::shared_ptr<StreamHolder> stream) {
+  if (!(stream->open_mark & kStreamOpenFanout)) {
+    // keep the chunks for the first reader
+    return;
+  }
+  // every chunk has been consumed once no reader remains
+  size_t consumed = stream->ready_base_ + stream->ready_chunks_.size();
+  for (auto const& item : stream->subscribers_) {
+    auto const& subscriber = item.second;
+    consumed = std::min(consumed, subscriber.next - subscriber.reading);
+  }
+  while (!stream->ready_chunks_.empty() && stream->ready_base_ < consumed) {
+    auto status = deleteChunk(stream, stream->ready_chunks_.front());
+    if (!status.ok()) {
+      LOG(WARNING) << "failed to delete the stream chunk: "
+                   << status.ToString();
+    }
+    stream->ready_chunks_.pop_front();
+    stream->ready_base_ += 1;
+  }
+}
+
+void StreamStore::wakeupWriter(std::shared_ptr<StreamHolder> stream) {
+  if (stream->pusher_ && !throttled(stream, 0, 0)) {
+    auto pusher = stream->pusher_.get();
+    stream->pusher_ = boost::none;
+    VINEYARD_SUPPRESS(pusher(Status::OK(), InvalidObjectID()));
+  }
+  if (!stream->writer_ || stream->current_writing_) {
+    return;
+  }
+  auto writer = stream->writer_.get();
+  if (!throttled(stream, writer.first, 1) &&
+      allocatable(stream, writer.first)) {
+    ObjectID chunk;
+    auto status = allocateChunk(stream, writer.first, chunk);
+    if (!status.ok()) {
+      VINEYARD_SUPPRESS(writer.second(status, InvalidObjectID()));
+    } else {
+      bufferChunk(stream, chunk, writer.first);
+      stream->current_writing_ = chunk;
+      VINEYARD_SUPPRESS(
+          writer.second(Status::OK(), stream->current_writing_.get()));
+      stream->writer_ = boost::none;
+    }
+  }
+}
+
+void StreamStore::DumpMetrics(std::ostream& os) {
+  size_t streams = 0, ready_chunks = 0, buffered_chunks = 0,
+         buffered_bytes = 0, throttled_streams = 0, pooled_chunks = 0;
+  {
+    std::lock_guard<std::recursive_mutex> __guard(this->mutex_);
+    streams = streams_.size();
+    for (auto const& item : streams_) {
+      auto const& stream = item.second;
+      ready_chunks += stream->ready_chunks_.size();
+      buffered_chunks += stream->buffered_chunks;
+      buffered_bytes += stream->buffered_bytes;
+      throttled_streams += stream->throttled ? 1 : 0;
+      pooled_chunks += stream->pooled_chunks;
+    }
+  }
+  auto gauge = [&os](const std::string& name, const std::string& help,
+                     const size_t value) {
+    DumpMetricHeader(os, name, "gauge", help);
+    os << name << " " << value << "\n";
+  };
+  gauge("vineyard_streams", "Number of streams.", streams);
+  gauge("vineyard_stream_ready_chunks",
+        "Chunks that have been pushed but not yet pulled by all readers.",
+        ready_chunks);
+  gauge("vineyard_stream_buffered_chunks",
+        "Chunks that have been produced but not yet released.",
+        buffered_chunks);
+  gauge("vineyard_stream_buffered_bytes",
+        "Bytes of the chunks that have been produced but not yet released.",
+        buffered_bytes);
+  gauge("vineyard_stream_throttled",
+        "Number of streams whose writers are blocked by the backpressure.",
+        throttled_streams);
+  gauge("vineyard_stream_pooled_chunks",
+        "Consumed chunks that are kept for reusing.", pooled_chunks);
+}
+
 }  // namespace vineyard
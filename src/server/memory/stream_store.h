@@ -16,11 +16,13 @@ limitations under the License.
 #ifndef SRC_SERVER_MEMORY_STREAM_STORE_H_
 #define SRC_SERVER_MEMORY_STREAM_STORE_H_
 
+#include <deque>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <ostream>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "common/util/callback.h"
 #include "server/memory/memory.h"
@@ -31,6 +33,28 @@ namespace vineyard {
 class VineyardServer;
 using vs_ptr_t = std::shared_ptr<VineyardServer>;
 
+/**
+ * @brief A reader of the stream in the fan-out mode, where every reader
+ * reads all chunks with its own cursor.
+ */
+struct StreamSubscriber {
+  // sequence number of the next chunk to read
+  size_t next{0};
+  // number of chunks before `next` that are still being read
+  size_t reading{0};
+  boost::optional<callback_t<ObjectID>> reader_;
+};
+
+/**
+ * @brief A reader of the stream in the shared mode, where every chunk is
+ * claimed by exactly one of the readers.
+ */
+struct StreamClaimer {
+  // the chunks claimed by the last pull, which are released on the next pull
+  std::vector<ObjectID> reading;
+  boost::optional<callback_t<ObjectID>> reader_;
+};
+
 /**
  * @brief StreamHolder aims to maintain all chunks for a single stream.
  * "Stream" is a special kind of "Object" in vineyard, which represents
@@ -40,11 +64,43 @@ using vs_ptr_t = std::shared_ptr<VineyardServer>;
  */
 struct StreamHolder {
   boost::optional<ObjectID> current_writing_, current_reading_;
-  std::queue<ObjectID> ready_chunks_;
+  // the chunks that are pulled together with `current_reading_` in a batch
+  std::vector<ObjectID> batch_reading_;
+  std::deque<ObjectID> ready_chunks_;
   boost::optional<callback_t<ObjectID>> reader_;
   boost::optional<std::pair<size_t, callback_t<ObjectID>>> writer_;
   bool drained{false}, failed{false};
   int64_t open_mark{0};
+
+  // in the fan-out mode, chunks are kept in `ready_chunks_` until all
+  // subscribers have consumed them.
+  //
+  // sequence number of the front of `ready_chunks_`
+  size_t ready_base_{0};
+  std::unordered_map<int64_t /* reader */, StreamSubscriber> subscribers_;
+
+  // in the shared mode, the readers claim chunks from the front of
+  // `ready_chunks_`, i.e., the cursor is shared by all readers, and the
+  // pending readers are woken up in the order of arrival.
+  std::unordered_map<int64_t /* reader */, StreamClaimer> claimers_;
+  std::deque<int64_t> pending_claimers_;
+
+  // backpressure: the writer is blocked once the chunks that haven't been
+  // consumed reach the high watermark, until they drop to the low watermark.
+  // Zero means unlimited.
+  size_t high_watermark_bytes{0}, low_watermark_bytes{0};
+  size_t high_watermark_chunks{0}, low_watermark_chunks{0};
+  // chunks that have been produced but not yet released
+  size_t buffered_bytes{0}, buffered_chunks{0};
+  std::unordered_map<ObjectID, size_t> buffered_sizes_;
+  bool throttled{false};
+  // the producer that pushed a chunk and waits for the backpressure
+  boost::optional<callback_t<ObjectID>> pusher_;
+
+  // consumed blob chunks that will be reused by the producer, by size
+  bool recycle_chunks{false};
+  std::unordered_map<size_t, std::vector<ObjectID>> chunk_pool_;
+  size_t pooled_chunks{0};
 };
 
 /**
@@ -57,9 +113,25 @@ class StreamStore {
               size_t const stream_threshold)
       : server_(server), store_(store), threshold_(stream_threshold) {}
 
-  Status Create(ObjectID const stream_id);
+  /**
+   * @brief Create a stream, with optional watermarks for backpressure, see
+   * also `StreamHolder`.
+   */
+  Status Create(ObjectID const stream_id,
+                size_t const high_watermark_bytes = 0,
+                size_t const low_watermark_bytes = 0,
+                size_t const high_watermark_chunks = 0,
+                size_t const low_watermark_chunks = 0,
+                bool const recycle_chunks = false);
 
-  Status Open(ObjectID const stream_id, int64_t const mode);
+  /**
+   * @brief Open the stream for reading or writing. A stream can be opened by
+   * many readers in the fan-out mode, identified by `reader`, and each of
+   * them gets all chunks of the stream, or in the shared mode, where each
+   * chunk goes to the reader that pulls first.
+   */
+  Status Open(ObjectID const stream_id, int64_t const mode,
+              int64_t const reader);
 
   /**
    * @brief This is called by the producer of the steram and it makes current
@@ -77,11 +149,28 @@ class StreamStore {
   Status Push(ObjectID const stream_id, ObjectID const chunk,
               callback_t<const ObjectID> callback);
 
+  /**
+   * @brief Emplace a batch of chunks to the ready queue in order, in a single
+   * round trip.
+   */
+  Status Push(ObjectID const stream_id, std::vector<ObjectID> const& chunks,
+              callback_t<const ObjectID> callback);
+
   /**
    * @brief The consumer invokes this function to read current chunk
    *
    */
-  Status Pull(ObjectID const stream_id, callback_t<const ObjectID> callback);
+  Status Pull(ObjectID const stream_id, int64_t const reader,
+              callback_t<const ObjectID> callback);
+
+  /**
+   * @brief Read up to `max_chunks` ready chunks, and no more than `max_bytes`
+   * bytes unless it is zero. At least one chunk will be returned when there's
+   * any, and all of them are released on the next pull.
+   */
+  Status Pull(ObjectID const stream_id, int64_t const reader,
+              size_t const max_chunks, size_t const max_bytes,
+              callback_t<const std::vector<ObjectID>&> callback);
 
   /**
    * @brief Function stop is called by the vineyard clients.
@@ -91,14 +180,84 @@ class StreamStore {
 
   /**
    * @brief Function Drop is called by vineyard when the clients loose
-   * connections
+   * connections. Readers in the fan-out mode just leave the stream, and
+   * readers in the shared mode give the chunks they are reading back to the
+   * others.
    *
    */
-  Status Drop(ObjectID const stream_id);
+  Status Drop(ObjectID const stream_id, int64_t const reader);
+
+  /**
+   * @brief Write the backlog of the streams in the prometheus text format.
+   */
+  void DumpMetrics(std::ostream& os);
 
  private:
   bool allocatable(std::shared_ptr<StreamHolder> stream, size_t size);
 
+  /**
+   * @brief Allocate a chunk for the producers, reuses a consumed one if
+   * possible.
+   */
+  Status allocateChunk(std::shared_ptr<StreamHolder> stream, size_t const size,
+                       ObjectID& chunk);
+
+  /**
+   * @brief Free the consumed chunks that are kept for reusing.
+   */
+  void releaseChunkPool(std::shared_ptr<StreamHolder> stream);
+
+  /**
+   * @brief Whether the writer should wait for the reader to catch up, before
+   * producing `chunks` more chunks of `size` bytes.
+   */
+  bool throttled(std::shared_ptr<StreamHolder> stream, size_t const size,
+                 size_t const chunks);
+
+  void bufferChunk(std::shared_ptr<StreamHolder> stream, ObjectID const chunk,
+                   size_t const size);
+
+  Status deleteChunk(std::shared_ptr<StreamHolder> stream,
+                     ObjectID const chunk);
+
+  /**
+   * @brief The number of ready chunks, starting from `begin`, that fit in a
+   * batch.
+   */
+  size_t batchSize(std::shared_ptr<StreamHolder> stream, size_t const begin,
+                   size_t const max_chunks, size_t const max_bytes);
+
+  Status pullShared(std::shared_ptr<StreamHolder> stream,
+                    StreamSubscriber& subscriber, size_t const max_chunks,
+                    size_t const max_bytes,
+                    callback_t<const std::vector<ObjectID>&> callback);
+
+  /**
+   * @brief Hand out the newly ready chunks (or the end of stream) to the
+   * pending readers in the fan-out mode.
+   */
+  void wakeupSubscribers(std::shared_ptr<StreamHolder> stream);
+
+  Status pullClaimed(std::shared_ptr<StreamHolder> stream,
+                     int64_t const reader, StreamClaimer& claimer,
+                     size_t const max_chunks, size_t const max_bytes,
+                     callback_t<const std::vector<ObjectID>&> callback);
+
+  /**
+   * @brief Hand out the newly ready chunks (or the end of stream) to the
+   * pending readers in the shared mode, one chunk per reader.
+   */
+  void wakeupClaimers(std::shared_ptr<StreamHolder> stream);
+
+  /**
+   * @brief Free the chunks that have been consumed by all remaining
+   * subscribers in the fan-out mode, i.e., every chunk once the last
+   * subscriber has left.
+   */
+  void releaseConsumed(std::shared_ptr<StreamHolder> stream);
+
+  void wakeupWriter(std::shared_ptr<StreamHolder> stream);
+
   // protect the stream store
   std::recursive_mutex mutex_;
 
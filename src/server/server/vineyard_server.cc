@@ -15,11 +15,25 @@ limitations under the License.
 
 #include "server/server/vineyard_server.h"
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <set>
+#include <sstream>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "common/util/boost.h"
@@ -27,8 +41,11 @@ limitations under the License.
 #include "common/util/json.h"
 #include "common/util/logging.h"
 #include "server/async/ipc_server.h"
+#include "server/async/metrics_server.h"
 #include "server/async/rpc_server.h"
+#include "server/memory/malloc.h"
 #include "server/services/meta_service.h"
+#include "server/util/affinity.h"
 #include "server/util/kubectl.h"
 #include "server/util/meta_tree.h"
 #include "server/util/metrics.h"
@@ -54,15 +71,31 @@ bool DeferredReq::Alive() const { return alive_fn_(); }
 
 bool DeferredReq::TestThenCall(const json& meta) const {
   if (test_fn_(meta)) {
+    done_ = true;
     VINEYARD_SUPPRESS(call_fn_(meta));
     return true;
   }
   return false;
 }
 
+VineyardServer::ThreadPool::ThreadPool(const std::string& role,
+                                       const int size)
+    : role(role),
+      size(size),
+      context(new io_context_t(size)),
+#if BOOST_VERSION >= 106600
+      guard(asio::make_work_guard(*context)) {
+}
+#else
+      guard(new boost::asio::io_service::work(*context)) {
+}
+#endif
+
 VineyardServer::VineyardServer(const json& spec)
     : spec_(spec),
-      concurrency_(std::thread::hardware_concurrency()),
+      concurrency_(spec.value("worker_threads", 0) > 0
+                       ? spec.value("worker_threads", 0)
+                       : std::thread::hardware_concurrency()),
       context_(concurrency_),
       meta_context_(),
 #if BOOST_VERSION >= 106600
@@ -72,11 +105,54 @@ VineyardServer::VineyardServer(const json& spec)
       guard_(new boost::asio::io_service::work(context_)),
       meta_guard_(new boost::asio::io_service::work(context_)),
 #endif
+      next_shard_(0),
       ready_(0) {
+  int shards = spec_.value("io_shards", 0);
+  for (int idx = 0; idx < shards; ++idx) {
+#if BOOST_VERSION >= 106600
+    shards_.emplace_back(new asio::io_context(1));
+    shard_guards_.emplace_back(asio::make_work_guard(*shards_.back()));
+#else
+    shards_.emplace_back(new asio::io_service(1));
+    shard_guards_.emplace_back(
+        new boost::asio::io_service::work(*shards_.back()));
+#endif
+  }
+  if (spec_.value("ipc_threads", 0) > 0) {
+    ipc_pool_.reset(new ThreadPool("ipc", spec_.value("ipc_threads", 0)));
+  }
+  if (spec_.value("rpc_threads", 0) > 0) {
+    rpc_pool_.reset(new ThreadPool("rpc", spec_.value("rpc_threads", 0)));
+  }
+  if (spec_.value("background_threads", 0) > 0) {
+    background_pool_.reset(
+        new ThreadPool("background", spec_.value("background_threads", 0)));
+  }
 }
 
 Status VineyardServer::Serve() {
   stopped_.store(false);
+  start_time_ = std::chrono::steady_clock::now();
+
+  RETURN_ON_ERROR(parse_cpu_affinity(
+      spec_.value("cpu_affinity", std::string()), cpu_affinity_));
+  for (auto const& item : cpu_affinity_) {
+    static const std::set<std::string> roles = {"worker", "ipc", "rpc",
+                                                "meta", "background"};
+    if (roles.find(item.first) == roles.end()) {
+      return Status::Invalid("Unknown thread role '" + item.first +
+                             "' in the CPU affinity, expect one of worker, "
+                             "ipc, rpc, meta and background");
+    }
+  }
+  if ((cpu_affinity_.count("ipc") && ipc_pool_ == nullptr) ||
+      (cpu_affinity_.count("rpc") && rpc_pool_ == nullptr)) {
+    LOG(WARNING) << "The CPU affinity of the ipc (or rpc) role takes effect "
+                    "only with --ipc_threads (or --rpc_threads)";
+  }
+  if (spec_.value("worker_threads", 0) <= 0 && cpu_affinity_.count("worker")) {
+    concurrency_ = cpu_affinity_["worker"].size();
+  }
 
   // Initialize the ipc/rpc server ptr first to get self endpoints when
   // initializing the metadata service.
@@ -88,18 +164,150 @@ Status VineyardServer::Serve() {
   }
 
   this->meta_service_ptr_ = IMetaService::Get(shared_from_this());
-  RETURN_ON_ERROR(this->meta_service_ptr_->Start());
+  // launching (or probing) etcd and loading the metadata snapshot don't
+  // depend on the shared memory, which takes long to map (and pre-fault) for
+  // a large `--size`, thus the two run concurrently. The callbacks of the
+  // meta service are handled by the meta context, which runs only after both
+  // have finished.
+  auto meta_started = std::async(std::launch::async, [this]() {
+    auto status = this->meta_service_ptr_->Start();
+    recordStartupPhase("meta_start");
+    return status;
+  });
 
+  {
+    auto const& bulkstore_spec = spec_["bulkstore_spec"];
+    memory::SegmentOptions options;
+    options.hugepages = bulkstore_spec.value("hugepages", std::string());
+    options.prefault = bulkstore_spec.value("prefault", false);
+    options.prefault_threads =
+        bulkstore_spec.value("prefault_threads", static_cast<size_t>(0));
+    options.mlock = bulkstore_spec.value("mlock", false);
+    memory::configure_segments(options);
+  }
   bulk_store_ = std::make_shared<BulkStore>();
+  pinThread(bulk_store_->RecyclerThread(), "background");
   RETURN_ON_ERROR(bulk_store_->PreAllocate(
-      spec_["bulkstore_spec"]["memory_size"].get<size_t>()));
+      spec_["bulkstore_spec"]["memory_size"].get<size_t>(),
+      spec_["bulkstore_spec"]["initial_size"].get<size_t>()));
+  recordStartupPhase("bulk_allocate");
+  {
+    auto const& bulkstore_spec = spec_["bulkstore_spec"];
+    bulk_store_->SetSmallBlobThreshold(
+        bulkstore_spec["small_blob_threshold"].get<size_t>());
+    auto const& spill_path = bulkstore_spec["spill_path"].get<std::string>();
+    auto const far_memory_path =
+        bulkstore_spec.value("far_memory_path", std::string());
+    bool const evict_cold_blobs =
+        bulkstore_spec["evict_cold_blobs"].get<bool>();
+    if (!far_memory_path.empty()) {
+      RETURN_ON_ERROR(bulk_store_->EnableFarTier(
+          far_memory_path,
+          bulkstore_spec.value("far_memory_size", static_cast<size_t>(0)),
+          bulkstore_spec.value("far_memory_promote_hits",
+                               static_cast<size_t>(2))));
+    }
+    if (!spill_path.empty() || evict_cold_blobs || !far_memory_path.empty()) {
+      RETURN_ON_ERROR(bulk_store_->EnableEviction(
+          bulkstore_spec["eviction_policy"].get<std::string>(), spill_path,
+          evict_cold_blobs));
+    }
+    auto compaction_interval =
+        bulkstore_spec.value("compaction_interval", static_cast<int64_t>(0));
+    if (compaction_interval > 0) {
+      bulk_store_->EnableCompaction();
+      startCompaction(compaction_interval);
+    }
+    if (bulkstore_spec.value("deduplicate_blobs", false)) {
+      bulk_store_->EnableDeduplication();
+    }
+    for (auto const& item : json::iterator_wrapper(
+             bulkstore_spec.value("memory_quotas", json::object()))) {
+      bulk_store_->SetQuota(item.key(),
+                            item.value()["soft_limit"].get<size_t>(),
+                            item.value()["hard_limit"].get<size_t>());
+    }
+  }
+  RETURN_ON_ERROR(meta_started.get());
+
   stream_store_ = std::make_shared<StreamStore>(
       shared_from_this(), bulk_store_,
       spec_["bulkstore_spec"]["stream_threshold"].get<size_t>());
-  BulkReady();
+  auto remote_cache_size = spec_["bulkstore_spec"].value(
+      "remote_cache_size", static_cast<size_t>(0));
+  if (remote_cache_size > 0) {
+    remote_blob_cache_ =
+        std::make_shared<RemoteBlobCache>(bulk_store_, remote_cache_size);
+  }
+  auto const& restore_path = spec_["bulkstore_spec"].value(
+      "restore_checkpoint", std::string());
+  if (!restore_path.empty()) {
+    json metadata, stats;
+    RETURN_ON_ERROR(bulk_store_->Restore(restore_path, metadata, stats));
+    LOG(INFO) << "Restored " << stats["blobs"] << " blobs (" << stats["bytes"]
+              << " bytes) from the checkpoint " << restore_path << " in "
+              << stats["seconds"] << "s";
+    // the clients are served after the metadata has been restored as well
+    meta_service_ptr_->RequestToRestoreTransient(
+        metadata, [this](const Status& status) {
+          if (!status.ok()) {
+            LOG(ERROR) << "Failed to restore the metadata from the "
+                       << "checkpoint: " << status.ToString();
+          }
+          BulkReady();
+          return Status::OK();
+        });
+  } else {
+    BulkReady();
+  }
+
+  auto metrics_port = spec_.value("metrics_port", static_cast<uint32_t>(0));
+  if (metrics_port > 0) {
+    metrics_server_ptr_ = std::unique_ptr<MetricsServer>(
+        new MetricsServer(shared_from_this(), metrics_port));
+    auto status = metrics_server_ptr_->Start();
+    if (!status.ok()) {
+      // the metrics are optional, thus serving continues without them
+      LOG(ERROR) << status.ToString();
+      metrics_server_ptr_.reset();
+    }
+  }
+
+  lease_sweep_interval_ =
+      spec_.value("lease_sweep_interval", static_cast<int64_t>(0));
+  if (lease_sweep_interval_ > 0) {
+    startLeaseSweeper(lease_sweep_interval_);
+  }
 
   serve_status_ = Status::OK();
 
+  // the io shards serve the ipc connections, and are spread over the CPUs of
+  // the ipc role in --cpu_affinity (or of the worker role), one per shard
+  auto shard_mask = cpu_affinity_.find("ipc");
+  if (shard_mask == cpu_affinity_.end()) {
+    shard_mask = cpu_affinity_.find("worker");
+  }
+  for (size_t idx = 0; idx < shards_.size(); ++idx) {
+    auto& shard = shards_[idx];
+    shard_workers_.emplace_back([&shard]() { shard->run(); });
+#if defined(__linux__)
+    int cpu = static_cast<int>(
+        idx % std::max(std::thread::hardware_concurrency(), 1U));
+    if (shard_mask != cpu_affinity_.end() && !shard_mask->second.empty()) {
+      cpu = shard_mask->second[idx % shard_mask->second.size()];
+    }
+    auto status = pin_thread(shard_workers_.back().native_handle(), {cpu});
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to pin the io shard " << idx
+                   << " to core: " << status.ToString();
+    }
+#endif
+  }
+  if (!shards_.empty()) {
+    LOG(INFO) << "Serving connections with " << shards_.size()
+              << " io shards";
+  }
+
   for (unsigned int idx = 0; idx < concurrency_; ++idx) {
 #if BOOST_VERSION >= 106600
     workers_.emplace_back(
@@ -108,7 +316,18 @@ Status VineyardServer::Serve() {
     workers_.emplace_back(
         boost::bind(&boost::asio::io_service::run, &context_));
 #endif
+    pinThread(workers_.back().native_handle(), "worker");
+  }
+  startPool(ipc_pool_.get());
+  startPool(rpc_pool_.get());
+  startPool(background_pool_.get());
+  if (!cpu_affinity_.empty()) {
+    LOG(INFO) << "Pinning the threads to the CPUs: "
+              << spec_["cpu_affinity"].get<std::string>();
   }
+
+  // the meta context is run by the current thread
+  pinThread(pthread_self(), "meta");
   meta_context_.run();
 
   return serve_status_;
@@ -116,11 +335,212 @@ Status VineyardServer::Serve() {
 
 Status VineyardServer::Finalize() { return Status::OK(); }
 
+#if BOOST_VERSION >= 106600
+asio::io_context& VineyardServer::GetConnectionContext() {
+#else
+asio::io_service& VineyardServer::GetConnectionContext() {
+#endif
+  if (shards_.empty()) {
+    return context_;
+  }
+  return *shards_[next_shard_.fetch_add(1) % shards_.size()];
+}
+
+#if BOOST_VERSION >= 106600
+asio::io_context& VineyardServer::GetIPCContext() {
+#else
+asio::io_service& VineyardServer::GetIPCContext() {
+#endif
+  if (ipc_pool_) {
+    return *ipc_pool_->context;
+  }
+  return GetConnectionContext();
+}
+
+#if BOOST_VERSION >= 106600
+asio::io_context& VineyardServer::GetRPCContext() {
+#else
+asio::io_service& VineyardServer::GetRPCContext() {
+#endif
+  if (rpc_pool_) {
+    return *rpc_pool_->context;
+  }
+  return GetConnectionContext();
+}
+
+#if BOOST_VERSION >= 106600
+asio::io_context& VineyardServer::GetBackgroundContext() {
+#else
+asio::io_service& VineyardServer::GetBackgroundContext() {
+#endif
+  if (background_pool_) {
+    return *background_pool_->context;
+  }
+  return context_;
+}
+
+void VineyardServer::pinThread(std::thread::native_handle_type thread,
+                               const std::string& role) {
+  auto iter = cpu_affinity_.find(role);
+  if (iter == cpu_affinity_.end()) {
+    return;
+  }
+  auto status = pin_thread(thread, iter->second);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to pin the " << role
+                 << " thread: " << status.ToString();
+  }
+}
+
+void VineyardServer::startPool(ThreadPool* pool) {
+  if (pool == nullptr) {
+    return;
+  }
+  auto context = pool->context.get();
+  for (int idx = 0; idx < pool->size; ++idx) {
+    pool->workers.emplace_back([context]() { context->run(); });
+    pinThread(pool->workers.back().native_handle(), pool->role);
+  }
+  LOG(INFO) << "Running the " << pool->role << " role on " << pool->size
+            << " dedicated threads";
+}
+
+void VineyardServer::startCompaction(const int64_t interval) {
+  compaction_timer_.reset(
+      new asio::steady_timer(GetBackgroundContext(),
+                             std::chrono::seconds(interval)));
+  compaction_timer_->async_wait(
+      [this, interval](const boost::system::error_code& error) {
+        if (error == asio::error::operation_aborted || stopped_.load()) {
+          return;
+        }
+        if (error) {
+          LOG(ERROR) << "compaction timer error: " << error << ", "
+                     << error.message();
+        }
+        bulk_store_->Compact();
+        startCompaction(interval);
+      });
+}
+
+void VineyardServer::startLeaseSweeper(const int64_t interval) {
+  lease_timer_.reset(
+      new asio::steady_timer(GetBackgroundContext(),
+                             std::chrono::seconds(interval)));
+  lease_timer_->async_wait(
+      [this, interval](const boost::system::error_code& error) {
+        if (error == asio::error::operation_aborted || stopped_.load()) {
+          return;
+        }
+        if (error) {
+          LOG(ERROR) << "lease timer error: " << error << ", "
+                     << error.message();
+        }
+        sweepExpiredLeases();
+        startLeaseSweeper(interval);
+      });
+}
+
+void VineyardServer::sweepExpiredLeases() {
+  auto now = std::chrono::steady_clock::now();
+  std::vector<ObjectID> expired;
+  {
+    std::lock_guard<std::mutex> lock(leases_mutex_);
+    std::vector<ObjectID> unpinned;
+    for (auto const& pin : pins_) {
+      if (pin.second.deadline <= now) {
+        unpinned.emplace_back(pin.first);
+      }
+    }
+    for (auto const& replica : unpinned) {
+      unpinReplica(replica);
+    }
+    auto iter = leases_.begin();
+    while (iter != leases_.end()) {
+      auto& lease = iter->second;
+      if (lease.alive && lease.alive()) {
+        lease.deadline = now + lease.ttl;
+        ++iter;
+      } else if (lease.deadline <= now) {
+        expired.emplace_back(iter->first);
+        leases_.erase(iter++);
+      } else {
+        ++iter;
+      }
+    }
+  }
+  if (expired.empty()) {
+    return;
+  }
+  meta_service_ptr_->RequestToGetData(false, [this, expired](
+                                                 const Status& status,
+                                                 const json& meta) {
+    if (!status.ok()) {
+      LOG(ERROR) << status.ToString();
+      return status;
+    }
+    std::vector<ObjectID> objects;
+    std::set<ObjectID> blobs;
+    for (auto const& id : expired) {
+      bool exists = false;
+      VINEYARD_SUPPRESS(CATCH_JSON_ERROR(meta_tree::Exists(meta, id, exists)));
+      if (!exists) {
+        // the blobs that are not referenced by any metadata
+        if (IsBlob(id)) {
+          blobs.emplace(id);
+        }
+        continue;
+      }
+      bool persist = false;
+      VINEYARD_SUPPRESS(
+          CATCH_JSON_ERROR(meta_tree::IfPersist(meta, id, persist)));
+      if (!persist) {
+        objects.emplace_back(id);
+      }
+    }
+    VLOG(2) << "Deleting " << objects.size() << " objects and " << blobs.size()
+            << " blobs whose leases have expired";
+    if (!blobs.empty()) {
+      VINEYARD_SUPPRESS(DeleteBlobBatch(blobs));
+    }
+    if (!objects.empty()) {
+      auto on_deleted = [](const Status& status) {
+        if (!status.ok()) {
+          LOG(WARNING) << "Failed to delete the expired objects: "
+                       << status.ToString();
+        }
+        return Status::OK();
+      };
+      VINEYARD_SUPPRESS(DelData(objects, false, true, false, on_deleted));
+    }
+    return Status::OK();
+  });
+}
+
 std::shared_ptr<VineyardServer> VineyardServer::Get(const json& spec) {
   return std::shared_ptr<VineyardServer>(new VineyardServer(spec));
 }
 
-void VineyardServer::Ready() {}
+void VineyardServer::Ready() {
+  std::lock_guard<std::mutex> lock(startup_mutex_);
+  std::stringstream ss;
+  for (auto const& phase : startup_phases_) {
+    ss << ", " << phase.first << ": " << phase.second << "s";
+  }
+  LOG(INFO) << "vineyardd is ready in "
+            << std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                             start_time_)
+                   .count()
+            << "s (startup phases" << ss.str() << ")";
+}
+
+void VineyardServer::recordStartupPhase(const std::string& phase) {
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start_time_)
+                       .count();
+  std::lock_guard<std::mutex> lock(startup_mutex_);
+  startup_phases_.emplace_back(phase, seconds);
+}
 
 void VineyardServer::BackendReady() {
   try {
@@ -154,120 +574,146 @@ void VineyardServer::BackendReady() {
 
 void VineyardServer::MetaReady() {
   VINEYARD_ASSERT(!(ready_ & kMeta), "A component can't be initialized twice!");
-  ready_ |= kMeta;
-  if (ready_ == kReady) {
+  recordStartupPhase("meta_ready");
+  unsigned char ready = (ready_ |= kMeta);
+  if (ready == kReady) {
     Ready();
   }
-  if (ready_ == kBackendReady) {
+  if (ready == kBackendReady) {
     BackendReady();
   }
 }
 
 void VineyardServer::BulkReady() {
   VINEYARD_ASSERT(!(ready_ & kBulk), "A component can't be initialized twice!");
-  ready_ |= kBulk;
-  if (ready_ == kReady) {
+  recordStartupPhase("bulk_ready");
+  unsigned char ready = (ready_ |= kBulk);
+  if (ready == kReady) {
     Ready();
   }
-  if (ready_ == kBackendReady) {
+  if (ready == kBackendReady) {
     BackendReady();
   }
 }
 
 void VineyardServer::IPCReady() {
   VINEYARD_ASSERT(!(ready_ & kIPC), "A component can't be initialized twice!");
-  ready_ |= kIPC;
-  if (ready_ == kReady) {
+  recordStartupPhase("ipc_ready");
+  if ((ready_ |= kIPC) == kReady) {
     Ready();
   }
 }
 
 void VineyardServer::RPCReady() {
   VINEYARD_ASSERT(!(ready_ & kRPC), "A component can't be initialized twice!");
-  ready_ |= kRPC;
-  if (ready_ == kReady) {
+  recordStartupPhase("rpc_ready");
+  if ((ready_ |= kRPC) == kReady) {
     Ready();
   }
 }
 
 Status VineyardServer::GetData(const std::vector<ObjectID>& ids,
                                const bool sync_remote, const bool wait,
-                               std::function<bool()> alive,
+                               const int depth, std::function<bool()> alive,
                                callback_t<const json&> callback) {
   ENSURE_VINEYARDD_READY();
-  meta_service_ptr_->RequestToGetData(
-      sync_remote, [this, ids, wait, alive, callback](const Status& status,
-                                                      const json& meta) {
-        if (status.ok()) {
-      // When object not exists, we return an empty json, rather than
-      // the status to indicate the error.
+  auto get_data = [this, ids, wait, depth, alive, callback](
+                      const Status& status, const json& meta) -> Status {
+    if (status.ok()) {
+  // When object not exists, we return an empty json, rather than
+  // the status to indicate the error.
 #if !defined(NDEBUG)
-          if (VLOG_IS_ON(10)) {
-            VLOG(10) << "Got request from client to get data, dump json:";
-            std::cerr << meta.dump(4) << std::endl;
-            VLOG(10) << "=========================================";
-          }
+      if (VLOG_IS_ON(10)) {
+        VLOG(10) << "Got request from client to get data, dump json:";
+        std::cerr << meta.dump(4) << std::endl;
+        VLOG(10) << "=========================================";
+      }
 #endif
-          auto test_task = [this, ids](const json& meta) -> bool {
-            for (auto const& id : ids) {
-              bool exists = false;
-              if (IsBlob(id)) {
-                exists = this->bulk_store_->Exists(id);
-              } else {
-                VINEYARD_SUPPRESS(
-                    CATCH_JSON_ERROR(meta_tree::Exists(meta, id, exists)));
-              }
-              if (!exists) {
-                return exists;
-              }
+      auto test_task = [this, ids](const json& meta) -> bool {
+        for (auto const& id : ids) {
+          bool exists = false;
+          if (IsBlob(id)) {
+            exists = this->bulk_store_->Exists(id);
+          } else {
+            VINEYARD_SUPPRESS(
+                CATCH_JSON_ERROR(meta_tree::Exists(meta, id, exists)));
+          }
+          if (!exists) {
+            return exists;
+          }
+        }
+        return true;
+      };
+      auto eval_task = [this, ids, depth,
+                        callback](const json& meta) -> Status {
+        json sub_tree_group;
+        for (auto const& id : ids) {
+          json sub_tree;
+          if (IsBlob(id)) {
+            std::shared_ptr<Payload> object;
+            if (this->bulk_store_->Get(id, object).ok()) {
+              sub_tree["id"] = ObjectIDToString(id);
+              sub_tree["typename"] = "vineyard::Blob";
+              sub_tree["length"] = object->data_size;
+              sub_tree["nbytes"] = object->data_size;
+              sub_tree["transient"] = true;
+              sub_tree["instance_id"] = this->instance_id();
+            }
+          } else {
+            auto s = CATCH_JSON_ERROR(
+                meta_tree::GetData(meta, this->instance_name(), id, depth,
+                                   sub_tree, instance_id_));
+            if (s.IsMetaTreeInvalid()) {
+              LOG(WARNING) << "Found errors in metadata: " << s.ToString();
             }
-            return true;
-          };
-          auto eval_task = [this, ids, callback](const json& meta) -> Status {
-            json sub_tree_group;
-            for (auto const& id : ids) {
-              json sub_tree;
-              if (IsBlob(id)) {
-                std::shared_ptr<Payload> object;
-                if (this->bulk_store_->Get(id, object).ok()) {
-                  sub_tree["id"] = ObjectIDToString(id);
-                  sub_tree["typename"] = "vineyard::Blob";
-                  sub_tree["length"] = object->data_size;
-                  sub_tree["nbytes"] = object->data_size;
-                  sub_tree["transient"] = true;
-                  sub_tree["instance_id"] = this->instance_id();
-                }
-              } else {
-                auto s = CATCH_JSON_ERROR(meta_tree::GetData(
-                    meta, this->instance_name(), id, sub_tree, instance_id_));
-                if (s.IsMetaTreeInvalid()) {
-                  LOG(WARNING) << "Found errors in metadata: " << s.ToString();
-                }
 #if !defined(NDEBUG)
-                if (VLOG_IS_ON(10)) {
-                  VLOG(10) << "Got request response:";
-                  std::cerr << sub_tree.dump(4) << std::endl;
-                  VLOG(10) << "=========================================";
-                }
-#endif
-              }
-              if (sub_tree.is_object() && !sub_tree.empty()) {
-                sub_tree_group[ObjectIDToString(id)] = sub_tree;
-              }
+            if (VLOG_IS_ON(10)) {
+              VLOG(10) << "Got request response:";
+              std::cerr << sub_tree.dump(4) << std::endl;
+              VLOG(10) << "=========================================";
             }
-            return callback(Status::OK(), sub_tree_group);
-          };
-          if (!wait || test_task(meta)) {
-            return eval_task(meta);
-          } else {
-            this->deferred_.emplace_back(alive, test_task, eval_task);
-            return Status::OK();
+#endif
+          }
+          if (sub_tree.is_object() && !sub_tree.empty()) {
+            sub_tree_group[ObjectIDToString(id)] = sub_tree;
           }
+        }
+        return callback(Status::OK(), sub_tree_group);
+      };
+      if (!wait || test_task(meta)) {
+        return eval_task(meta);
+      } else {
+        std::vector<std::string> keys;
+        for (auto const& id : ids) {
+          if (!IsBlob(id)) {
+            keys.emplace_back("/data/" + ObjectIDToString(id));
+          }
+        }
+        if (keys.size() == ids.size()) {
+          this->deferRequest(DeferredReq(keys, alive, test_task, eval_task));
         } else {
-          LOG(ERROR) << status.ToString();
-          return status;
+          // the blobs are not in the metadata
+          this->deferred_.emplace_back(alive, test_task, eval_task);
         }
-      });
+        return Status::OK();
+      }
+    } else {
+      LOG(ERROR) << status.ToString();
+      return status;
+    }
+  };
+  if (!sync_remote) {
+    meta_service_ptr_->RequestToGetData(false, get_data);
+    return Status::OK();
+  }
+  // fetches the subtrees of the requested objects only, the blobs are local
+  std::vector<ObjectID> object_ids;
+  for (auto const& id : ids) {
+    if (!IsBlob(id)) {
+      object_ids.emplace_back(id);
+    }
+  }
+  meta_service_ptr_->RequestToGetData(object_ids, get_data);
   return Status::OK();
 }
 
@@ -282,7 +728,8 @@ Status VineyardServer::ListData(std::string const& pattern, bool const regex,
         if (status.ok()) {
           json sub_tree_group;
           auto s = CATCH_JSON_ERROR(
-              meta_tree::ListData(meta, this->instance_name(), pattern, regex,
+              meta_tree::ListData(meta, meta_service_ptr_->GetTypeIndex(),
+                                  this->instance_name(), pattern, regex,
                                   limit, sub_tree_group));
           if (!s.ok()) {
             return callback(s, sub_tree_group);
@@ -319,6 +766,34 @@ Status VineyardServer::ListData(std::string const& pattern, bool const regex,
   return Status::OK();
 }
 
+Status VineyardServer::ListDataPage(
+    std::string const& pattern, bool const regex, size_t const limit,
+    json const& filters, std::vector<std::string> const& fields,
+    std::string const& cursor,
+    callback_t<const std::vector<ObjectID>&, const json&, const std::string&>
+        callback) {
+  ENSURE_VINEYARDD_READY();
+  meta_service_ptr_->RequestToGetData(
+      false,  // no need for sync from etcd
+      [this, pattern, regex, limit, filters, fields, cursor, callback](
+          const Status& status, const json& meta) {
+        std::vector<ObjectID> ids;
+        json projections = json::object();
+        std::string next_cursor;
+        if (status.ok()) {
+          auto s = CATCH_JSON_ERROR(meta_tree::ListDataPage(
+              meta, meta_service_ptr_->GetTypeIndex(), this->instance_name(),
+              pattern, regex, limit, filters, fields, cursor, ids,
+              projections, next_cursor));
+          return callback(s, ids, projections, next_cursor);
+        } else {
+          LOG(ERROR) << status.ToString();
+          return callback(status, ids, projections, next_cursor);
+        }
+      });
+  return Status::OK();
+}
+
 Status VineyardServer::ListAllData(
     callback_t<std::vector<ObjectID> const&> callback) {
   ENSURE_VINEYARDD_READY();
@@ -381,6 +856,10 @@ Status VineyardServer::CreateData(
   } else {
     decorated_tree["signature"] = signature;
   }
+  decorated_tree[meta_tree::kCreatedAtKey] =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count();
 
   // update meta into json
   meta_service_ptr_->RequestToBulkUpdate(
@@ -430,6 +909,229 @@ Status VineyardServer::Persist(const ObjectID id, callback_t<> callback) {
   return Status::OK();
 }
 
+Status VineyardServer::PersistAsync(const ObjectID id) {
+  {
+    std::lock_guard<std::mutex> lock(pending_persists_mutex_);
+    auto iter = pending_persists_.find(id);
+    if (iter != pending_persists_.end() && !iter->second.done) {
+      // joins the persistence that is in flight
+      return Status::OK();
+    }
+    pending_persists_[id] = PendingPersist();
+  }
+  auto status = Persist(id, [this, id](const Status& status) {
+    this->finishPersist(id, status);
+    return Status::OK();
+  });
+  if (!status.ok()) {
+    std::lock_guard<std::mutex> lock(pending_persists_mutex_);
+    pending_persists_.erase(id);
+  }
+  return status;
+}
+
+void VineyardServer::finishPersist(const ObjectID id, const Status& status) {
+  std::vector<callback_t<const bool>> waiters;
+  {
+    std::lock_guard<std::mutex> lock(pending_persists_mutex_);
+    auto iter = pending_persists_.find(id);
+    if (iter == pending_persists_.end()) {
+      return;
+    }
+    waiters.swap(iter->second.waiters);
+    if (status.ok() || !waiters.empty()) {
+      // the persisted object is known by `IfPersist` from now on
+      pending_persists_.erase(iter);
+    } else {
+      iter->second.done = true;
+      iter->second.status = status;
+    }
+  }
+  for (auto const& waiter : waiters) {
+    VINEYARD_DISCARD(waiter(status, status.ok()));
+  }
+}
+
+Status VineyardServer::WaitPersist(const ObjectID id, bool const block,
+                                   callback_t<const bool> callback) {
+  ENSURE_VINEYARDD_READY();
+  {
+    std::lock_guard<std::mutex> lock(pending_persists_mutex_);
+    auto iter = pending_persists_.find(id);
+    if (iter != pending_persists_.end()) {
+      if (iter->second.done) {
+        Status status = iter->second.status;
+        pending_persists_.erase(iter);
+        context_.post(boost::bind(callback, status, false));
+      } else if (block) {
+        iter->second.waiters.emplace_back(callback);
+      } else {
+        context_.post(boost::bind(callback, Status::OK(), false));
+      }
+      return Status::OK();
+    }
+  }
+  return IfPersist(
+      id, [id, callback](const Status& status, bool const persist) {
+        if (status.ok() && !persist) {
+          return callback(Status::ObjectNotExists(
+                              "the object is not being persisted: id = " +
+                              ObjectIDToString(id)),
+                          false);
+        }
+        return callback(status, persist);
+      });
+}
+
+Status VineyardServer::Lease(const std::vector<ObjectID>& ids,
+                             int64_t const ttl, DeferredReq::alive_t alive) {
+  ENSURE_VINEYARDD_READY();
+  RETURN_ON_ASSERT(lease_sweep_interval_ > 0,
+                   "The leases are disabled by --lease_sweep_interval=0");
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(ttl);
+  std::lock_guard<std::mutex> lock(leases_mutex_);
+  for (auto const& id : ids) {
+    if (ttl <= 0) {
+      leases_.erase(id);
+    } else {
+      leases_[id] = lease_t{std::chrono::seconds(ttl), deadline, alive};
+    }
+  }
+  return Status::OK();
+}
+
+/**
+ * The local blobs that the object references, directly or through its
+ * members.
+ */
+static void collect_local_blobs(const json& tree, InstanceID const instance_id,
+                                std::set<ObjectID>& blobs) {
+  if (!tree.is_object()) {
+    return;
+  }
+  auto type = tree.find("typename");
+  if (type != tree.end() && type->is_string() &&
+      type->get_ref<std::string const&>() == "vineyard::Blob") {
+    if (tree.value("instance_id", UnspecifiedInstanceID()) == instance_id) {
+      blobs.emplace(ObjectIDFromString(tree["id"].get<std::string>()));
+    }
+    return;
+  }
+  for (auto const& item : tree) {
+    if (item.is_object()) {
+      collect_local_blobs(item, instance_id, blobs);
+    }
+  }
+}
+
+Status VineyardServer::Prefetch(
+    const std::vector<ObjectID>& ids, const std::vector<ObjectID>& replicas,
+    int64_t const ttl, callback_t<const std::vector<ObjectID>&> callback) {
+  ENSURE_VINEYARDD_READY();
+  if (ttl <= 0) {
+    {
+      std::lock_guard<std::mutex> lock(leases_mutex_);
+      for (auto const& id : ids) {
+        auto iter = prefetched_.find(id);
+        if (iter != prefetched_.end()) {
+          unpinReplica(iter->second);
+        }
+      }
+    }
+    context_.post([callback, ids]() {
+      VINEYARD_DISCARD(
+          callback(Status::OK(), std::vector<ObjectID>(ids.size(),
+                                                       InvalidObjectID())));
+    });
+    return Status::OK();
+  }
+  if (replicas.empty()) {
+    auto known = lookupPrefetched(ids);
+    context_.post([callback, known]() {
+      VINEYARD_DISCARD(callback(Status::OK(), known));
+    });
+    return Status::OK();
+  }
+  RETURN_ON_ASSERT(lease_sweep_interval_ > 0,
+                   "The pins are disabled by --lease_sweep_interval=0");
+  meta_service_ptr_->RequestToGetData(
+      false,  // the replicas are local objects
+      [this, ids, replicas, ttl, callback](const Status& status,
+                                          const json& meta) {
+        if (!status.ok()) {
+          LOG(ERROR) << status.ToString();
+          return callback(status, std::vector<ObjectID>{});
+        }
+        std::vector<std::set<ObjectID>> blobs(replicas.size());
+        for (size_t idx = 0; idx < replicas.size(); ++idx) {
+          if (IsBlob(replicas[idx])) {
+            blobs[idx].emplace(replicas[idx]);
+            continue;
+          }
+          json tree;
+          auto s = CATCH_JSON_ERROR(meta_tree::GetData(
+              meta, this->instance_name(), replicas[idx], tree));
+          if (!s.ok()) {
+            return callback(s, std::vector<ObjectID>{});
+          }
+          collect_local_blobs(tree, this->instance_id(), blobs[idx]);
+        }
+
+        auto deadline =
+            std::chrono::steady_clock::now() + std::chrono::seconds(ttl);
+        {
+          std::lock_guard<std::mutex> lock(leases_mutex_);
+          for (size_t idx = 0; idx < replicas.size(); ++idx) {
+            auto iter = prefetched_.find(ids[idx]);
+            if (iter != prefetched_.end()) {
+              unpinReplica(iter->second);
+            }
+            if (pins_.find(replicas[idx]) != pins_.end()) {
+              unpinReplica(replicas[idx]);
+            }
+            for (auto const& blob : blobs[idx]) {
+              VINEYARD_SUPPRESS(bulk_store_->Ref(blob));
+            }
+            prefetched_[ids[idx]] = replicas[idx];
+            pins_[replicas[idx]] =
+                pin_t{ids[idx], deadline, std::move(blobs[idx])};
+          }
+        }
+        VLOG(2) << "Pinned " << replicas.size() << " prefetched replicas for "
+                << ttl << " seconds";
+        return callback(Status::OK(), lookupPrefetched(ids));
+      });
+  return Status::OK();
+}
+
+void VineyardServer::unpinReplica(const ObjectID replica) {
+  auto pin = pins_.find(replica);
+  if (pin == pins_.end()) {
+    return;
+  }
+  for (auto const& blob : pin->second.blobs) {
+    VINEYARD_SUPPRESS(bulk_store_->Unref(blob));
+  }
+  auto iter = prefetched_.find(pin->second.origin);
+  if (iter != prefetched_.end() && iter->second == replica) {
+    prefetched_.erase(iter);
+  }
+  pins_.erase(pin);
+}
+
+std::vector<ObjectID> VineyardServer::lookupPrefetched(
+    const std::vector<ObjectID>& ids) {
+  std::vector<ObjectID> replicas(ids.size(), InvalidObjectID());
+  std::lock_guard<std::mutex> lock(leases_mutex_);
+  for (size_t idx = 0; idx < ids.size(); ++idx) {
+    auto iter = prefetched_.find(ids[idx]);
+    if (iter != prefetched_.end()) {
+      replicas[idx] = iter->second;
+    }
+  }
+  return replicas;
+}
+
 Status VineyardServer::IfPersist(const ObjectID id,
                                  callback_t<const bool> callback) {
   ENSURE_VINEYARDD_READY();
@@ -522,6 +1224,9 @@ Status VineyardServer::DeepCopy(const ObjectID id, const std::string& peer,
                                      "--rpc_endpoint", peer_rpc_endpoint,
                                      "--host",         "0.0.0.0",
                                      "--local_copy",   "true"};
+    if (spec_.value("rdma", false)) {
+      args.insert(args.end(), {"--rdma", "true"});
+    }
     auto proc = std::make_shared<Process>(context_);
     proc->Start(
         migrate_process, args,
@@ -549,6 +1254,9 @@ Status VineyardServer::DeepCopy(const ObjectID id, const std::string& peer,
                                      "--host",         peer,
                                      "--id",           ObjectIDToString(id),
                                      "--local_copy",   "true"};
+    if (spec_.value("rdma", false)) {
+      args.insert(args.end(), {"--rdma", "true"});
+    }
     auto proc = std::make_shared<Process>(context_);
     proc->Start(
         migrate_process, args,
@@ -615,12 +1323,28 @@ Status VineyardServer::DelData(const std::vector<ObjectID>& ids,
 }
 
 Status VineyardServer::DeleteBlobBatch(const std::set<ObjectID>& ids) {
-  for (auto object_id : ids) {
-    VINEYARD_SUPPRESS(this->bulk_store_->Delete(object_id));
+  if (remote_blob_cache_) {
+    // the deleted blobs may have local copies fetched from other instances
+    remote_blob_cache_->Invalidate(ids);
   }
+  VINEYARD_SUPPRESS(this->bulk_store_->Delete(
+      std::vector<ObjectID>(ids.begin(), ids.end())));
   return Status::OK();
 }
 
+void VineyardServer::ReferenceBlobsByMeta(const std::set<ObjectID>& blobs) {
+  if (!blobs.empty()) {
+    bulk_store_->ReferenceByMeta(blobs);
+  }
+}
+
+void VineyardServer::InvalidateObjects(const std::set<ObjectID>& ids) {
+  if (ids.empty() || ipc_server_ptr_ == nullptr) {
+    return;
+  }
+  ipc_server_ptr_->Invalidate(std::vector<ObjectID>(ids.begin(), ids.end()));
+}
+
 Status VineyardServer::DeleteAllAt(const json& meta,
                                    InstanceID const instance_id) {
   std::vector<ObjectID> objects_to_cleanup;
@@ -714,7 +1438,8 @@ Status VineyardServer::GetName(const std::string& name, const bool wait,
       if (!wait || test_task(meta)) {
         return eval_task(meta);
       } else {
-        deferred_.emplace_back(alive, test_task, eval_task);
+        deferRequest(
+            DeferredReq({"/names/" + name}, alive, test_task, eval_task));
         return Status::OK();
       }
     } else {
@@ -774,6 +1499,9 @@ Status VineyardServer::MigrateObject(const ObjectID object_id, const bool local,
         "--rpc_endpoint", peer_rpc_endpoint,
         "--host",         peer,
         "--id",           ObjectIDToString(object_id)};
+    if (spec_.value("rdma", false)) {
+      args.insert(args.end(), {"--rdma", "true"});
+    }
     auto proc = std::make_shared<Process>(context_);
     proc->Start(
         migrate_process, args,
@@ -830,6 +1558,9 @@ Status VineyardServer::MigrateObject(const ObjectID object_id, const bool local,
                                      "--ipc_socket",   IPCSocket(),
                                      "--rpc_endpoint", peer_rpc_endpoint,
                                      "--host",         "0.0.0.0"};
+    if (spec_.value("rdma", false)) {
+      args.insert(args.end(), {"--rdma", "true"});
+    }
     auto proc = std::make_shared<Process>(context_);
     proc->Start(
         migrate_process, args,
@@ -937,7 +1668,9 @@ Status VineyardServer::InstanceStatus(callback_t<const json&> callback) {
   status["deployment"] = GetDeployment();
   status["memory_usage"] = bulk_store_->Footprint();
   status["memory_limit"] = bulk_store_->FootprintLimit();
-  status["deferred_requests"] = deferred_.size();
+  status["memory_fragmentation"] = bulk_store_->Fragmentation();
+  status["session_memory"] = bulk_store_->SessionUsages();
+  status["deferred_requests"] = deferred_.size() + keyed_deferred_size_;
   if (ipc_server_ptr_) {
     status["ipc_connections"] = ipc_server_ptr_->AliveConnections();
   } else {
@@ -949,10 +1682,269 @@ Status VineyardServer::InstanceStatus(callback_t<const json&> callback) {
     status["rpc_connections"] = 0;
   }
 
+  // where the time goes, see also `ServerMetrics`
+  json metrics = metrics_.ToJSON();
+  status["request_stats"] = metrics["commands"];
+  status["meta_service_time_us"] = metrics["meta_commit_time_us"];
+  status["bulk_store_time_us"] = bulk_store_->AllocationNanoseconds() / 1000.0;
+  json connection_stats = json::array();
+  if (ipc_server_ptr_) {
+    ipc_server_ptr_->ConnectionStats("ipc", connection_stats);
+  }
+  if (rpc_server_ptr_) {
+    rpc_server_ptr_->ConnectionStats("rpc", connection_stats);
+  }
+  status["connection_stats"] = connection_stats;
+
   return callback(Status::OK(), status);
 }
 
-Status VineyardServer::ProcessDeferred(const json& meta) {
+Status VineyardServer::MemoryAttribution(callback_t<const json&> callback) {
+  ENSURE_VINEYARDD_READY();
+  meta_service_ptr_->RequestToGetData(
+      false,  // no need for sync from etcd
+      [this, callback](const Status& status, const json& meta) {
+        if (!status.ok()) {
+          return callback(status, json());
+        }
+        json usage;
+        auto s = CATCH_JSON_ERROR(attributeMemory(meta, usage));
+        return callback(s, usage);
+      });
+  return Status::OK();
+}
+
+Status VineyardServer::Checkpoint(const std::string& path,
+                                  callback_t<const json&> callback) {
+  ENSURE_VINEYARDD_READY();
+  meta_service_ptr_->RequestToGetData(
+      false,  // the objects of other instances hold no local blobs
+      [this, path, callback](const Status& status, const json& meta) {
+        if (!status.ok()) {
+          return callback(status, json());
+        }
+        std::vector<meta_tree::RootObject> roots;
+        auto s = CATCH_JSON_ERROR(
+            meta_tree::ListRootObjects(meta, instance_name(), roots));
+        if (!s.ok()) {
+          return callback(s, json());
+        }
+        // the blobs that haven't been sealed into any object are skipped
+        std::set<ObjectID> blobs;
+        for (auto const& root : roots) {
+          blobs.insert(root.blobs.begin(), root.blobs.end());
+        }
+        json metadata = IMetaService::TransientMeta(meta);
+        // keeps the meta context responsive while the blobs are written, on
+        // the background threads when there are
+        GetBackgroundContext().post(
+            [this, path, callback, blobs, metadata]() {
+              json stats;
+              auto status =
+                  bulk_store_->Checkpoint(path, blobs, metadata, stats);
+              if (status.ok()) {
+                LOG(INFO) << "Checkpointed " << stats["blobs"] << " blobs ("
+                          << stats["bytes"] << " bytes) to " << path << " in "
+                          << stats["seconds"] << "s";
+              }
+              VINEYARD_DISCARD(callback(status, stats));
+            });
+        return Status::OK();
+      });
+  return Status::OK();
+}
+
+namespace {
+
+struct MemoryUsage {
+  size_t objects = 0, blobs = 0, bytes = 0;
+
+  void Add(size_t const objects, size_t const blobs, size_t const bytes) {
+    this->objects += objects;
+    this->blobs += blobs;
+    this->bytes += bytes;
+  }
+};
+
+json usage_to_json(std::map<std::string, MemoryUsage> const& groups) {
+  json result = json::object();
+  for (auto const& item : groups) {
+    result[item.first] = json{{"objects", item.second.objects},
+                              {"blobs", item.second.blobs},
+                              {"bytes", item.second.bytes}};
+  }
+  return result;
+}
+
+}  // namespace
+
+Status VineyardServer::attributeMemory(const json& meta, json& usage) {
+  // the biggest objects to report
+  constexpr size_t kTopObjects = 16;
+  static const std::string unknown_owner = "unknown";
+
+  std::vector<meta_tree::RootObject> roots;
+  RETURN_ON_ERROR(meta_tree::ListRootObjects(meta, instance_name(), roots));
+
+  // the sizes of the local blobs, the spilled blobs occupy no shared memory
+  std::unordered_map<ObjectID, std::pair<size_t, std::string const*>> blobs;
+  size_t spilled_bytes = 0;
+  for (auto const& item : bulk_store_->List()) {
+    auto const& payload = item.second;
+    if (payload->is_spilled) {
+      spilled_bytes += payload->data_size;
+    } else if (item.first != EmptyBlobID()) {
+      blobs.emplace(item.first,
+                    std::make_pair(payload->data_size,
+                                   payload->owner ? payload->owner.get()
+                                                  : &unknown_owner));
+    }
+  }
+
+  std::map<std::string, MemoryUsage> by_type, by_instance, by_owner;
+  // the bytes and the index of the outermost objects
+  std::vector<std::pair<size_t, size_t>> objects;
+  size_t attributed_bytes = 0, unreferenced_blobs = 0, unreferenced_bytes = 0;
+  std::string const local_instance = std::to_string(instance_id_);
+
+  for (size_t index = 0; index < roots.size(); ++index) {
+    auto const& root = roots[index];
+    size_t blob_count = 0, bytes = 0;
+    // the object is owned by the creator of its first blob
+    std::string const* owner = &unknown_owner;
+    for (auto const& blob : root.blobs) {
+      auto iter = blobs.find(blob);
+      if (iter != blobs.end()) {
+        blob_count += 1;
+        bytes += iter->second.first;
+        if (owner == &unknown_owner) {
+          owner = iter->second.second;
+        }
+        // attributed to the object, and isn't counted again below
+        blobs.erase(iter);
+      }
+    }
+    if (blob_count == 0 && root.instance_id != instance_id_) {
+      // held by the remote instances
+      continue;
+    }
+    by_type[root.type_name].Add(1, blob_count, bytes);
+    by_instance[std::to_string(root.instance_id)].Add(1, blob_count, bytes);
+    by_owner[*owner].Add(1, blob_count, bytes);
+    attributed_bytes += bytes;
+    objects.emplace_back(bytes, index);
+  }
+
+  // the blobs that haven't been sealed into any object yet
+  for (auto const& item : blobs) {
+    by_type["vineyard::Blob"].Add(0, 1, item.second.first);
+    by_instance[local_instance].Add(0, 1, item.second.first);
+    by_owner[*item.second.second].Add(0, 1, item.second.first);
+    unreferenced_blobs += 1;
+    unreferenced_bytes += item.second.first;
+  }
+
+  size_t const top = std::min(objects.size(), kTopObjects);
+  std::partial_sort(objects.begin(), objects.begin() + top, objects.end(),
+                    std::greater<std::pair<size_t, size_t>>());
+  json top_objects = json::array();
+  for (size_t i = 0; i < top; ++i) {
+    auto const& root = roots[objects[i].second];
+    top_objects.push_back(json{{"id", ObjectIDToString(root.id)},
+                               {"typename", root.type_name},
+                               {"instance_id", root.instance_id},
+                               {"bytes", objects[i].first}});
+  }
+
+  usage = json{{"memory_usage", bulk_store_->Footprint()},
+               {"memory_limit", bulk_store_->FootprintLimit()},
+               {"attributed_bytes", attributed_bytes},
+               {"unreferenced_blobs", unreferenced_blobs},
+               {"unreferenced_bytes", unreferenced_bytes},
+               {"spilled_bytes", spilled_bytes},
+               {"far_memory_usage", bulk_store_->FarFootprint()},
+               {"by_type", usage_to_json(by_type)},
+               {"by_instance", usage_to_json(by_instance)},
+               {"by_owner", usage_to_json(by_owner)},
+               {"top_objects", top_objects}};
+  return Status::OK();
+}
+
+void VineyardServer::DumpMetrics(std::ostream& os) {
+  metrics_.Dump(os);
+
+  DumpMetricHeader(os, "vineyard_connections", "gauge",
+                   "Number of alive client connections.");
+  os << "vineyard_connections{kind=\"ipc\"} "
+     << (ipc_server_ptr_ ? ipc_server_ptr_->AliveConnections() : 0) << "\n";
+  os << "vineyard_connections{kind=\"rpc\"} "
+     << (rpc_server_ptr_ ? rpc_server_ptr_->AliveConnections() : 0) << "\n";
+  DumpMetricHeader(os, "vineyard_connections_total", "counter",
+                   "Number of accepted client connections.");
+  os << "vineyard_connections_total{kind=\"ipc\"} "
+     << (ipc_server_ptr_ ? ipc_server_ptr_->AcceptedConnections() : 0)
+     << "\n";
+  os << "vineyard_connections_total{kind=\"rpc\"} "
+     << (rpc_server_ptr_ ? rpc_server_ptr_->AcceptedConnections() : 0)
+     << "\n";
+
+  if (bulk_store_) {
+    bulk_store_->DumpMetrics(os);
+  }
+  if (stream_store_) {
+    stream_store_->DumpMetrics(os);
+  }
+}
+
+void VineyardServer::deferRequest(DeferredReq&& request) {
+  auto deferred = std::make_shared<DeferredReq>(std::move(request));
+  for (auto const& key : deferred->Keys()) {
+    keyed_deferred_[key].emplace_back(deferred);
+    keyed_deferred_size_ += 1;
+  }
+  if (keyed_deferred_size_ < 2 * keyed_deferred_swept_size_ + 64) {
+    return;
+  }
+  // sweeps the requests whose connections have gone, amortized O(1)
+  auto iter = keyed_deferred_.begin();
+  while (iter != keyed_deferred_.end()) {
+    auto& requests = iter->second;
+    size_t before = requests.size();
+    requests.erase(std::remove_if(requests.begin(), requests.end(),
+                                  [](std::shared_ptr<DeferredReq> const& r) {
+                                    return r->Done() || !r->Alive();
+                                  }),
+                   requests.end());
+    keyed_deferred_size_ -= before - requests.size();
+    if (requests.empty()) {
+      keyed_deferred_.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+  keyed_deferred_swept_size_ = keyed_deferred_size_;
+}
+
+Status VineyardServer::ProcessDeferred(
+    const json& meta, std::unordered_set<std::string> const& updated_keys) {
+  for (auto const& key : updated_keys) {
+    auto iter = keyed_deferred_.find(key);
+    if (iter == keyed_deferred_.end()) {
+      continue;
+    }
+    auto& requests = iter->second;
+    size_t before = requests.size();
+    auto finished = [&meta](std::shared_ptr<DeferredReq> const& r) {
+      return r->Done() || !r->Alive() || r->TestThenCall(meta);
+    };
+    requests.erase(
+        std::remove_if(requests.begin(), requests.end(), finished),
+        requests.end());
+    keyed_deferred_size_ -= before - requests.size();
+    if (requests.empty()) {
+      keyed_deferred_.erase(iter);
+    }
+  }
   auto iter = deferred_.begin();
   while (iter != deferred_.end()) {
     if (!iter->Alive() || iter->TestThenCall(meta)) {
@@ -987,6 +1979,12 @@ void VineyardServer::Stop() {
 
   guard_.reset();
   meta_guard_.reset();
+  if (compaction_timer_) {
+    compaction_timer_->cancel();
+  }
+  if (lease_timer_) {
+    lease_timer_->cancel();
+  }
   if (this->ipc_server_ptr_) {
     this->ipc_server_ptr_->Stop();
   }
@@ -996,14 +1994,27 @@ void VineyardServer::Stop() {
   if (this->meta_service_ptr_) {
     this->meta_service_ptr_->Stop();
   }
+  if (this->metrics_server_ptr_) {
+    this->metrics_server_ptr_->Stop();
+  }
 
   // stop the asio context at last
   context_.stop();
   meta_context_.stop();
+  for (auto& shard : shards_) {
+    shard->stop();
+  }
+  for (auto pool : {ipc_pool_.get(), rpc_pool_.get(), background_pool_.get()}) {
+    if (pool != nullptr) {
+      pool->guard.reset();
+      pool->context->stop();
+    }
+  }
 
   // cleanup
   this->ipc_server_ptr_.reset(nullptr);
   this->rpc_server_ptr_.reset(nullptr);
+  this->metrics_server_ptr_.reset(nullptr);
   this->meta_service_ptr_.reset();
 
   // wait for the IO context finishes.
@@ -1012,6 +2023,21 @@ void VineyardServer::Stop() {
       worker.join();
     }
   }
+  for (auto& worker : shard_workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+  for (auto pool : {ipc_pool_.get(), rpc_pool_.get(), background_pool_.get()}) {
+    if (pool == nullptr) {
+      continue;
+    }
+    for (auto& worker : pool->workers) {
+      if (worker.joinable()) {
+        worker.join();
+      }
+    }
+  }
 }
 
 bool VineyardServer::Running() const { return !stopped_.load(); }
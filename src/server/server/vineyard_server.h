@@ -17,21 +17,31 @@ limitations under the License.
 #define SRC_SERVER_SERVER_VINEYARD_SERVER_H_
 
 #include <atomic>
+#include <chrono>
 #include <list>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <ostream>
 #include <set>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "boost/asio.hpp"
+#include "boost/asio/steady_timer.hpp"
 
 #include "common/util/callback.h"
 #include "common/util/json.h"
 #include "common/util/status.h"
+#include "common/util/uuid.h"
 
 #include "server/memory/memory.h"
+#include "server/memory/remote_cache.h"
 #include "server/memory/stream_store.h"
+#include "server/util/metrics.h"
 
 namespace vineyard {
 
@@ -41,6 +51,7 @@ class IMetaService;
 
 class IPCServer;
 class RPCServer;
+class MetricsServer;
 
 /**
  * @brief DeferredReq aims to defer a socket request such that the request
@@ -56,14 +67,32 @@ class DeferredReq {
   DeferredReq(alive_t alive_fn, test_t test_fn, call_t call_fn)
       : alive_fn_(alive_fn), test_fn_(test_fn), call_fn_(call_fn) {}
 
+  /**
+   * @brief The request is tested only when the given keys of the metadata,
+   * i.e., "/names/<name>" or "/data/<object id>", are updated, rather than on
+   * every update of the metadata.
+   */
+  DeferredReq(std::vector<std::string> const& keys, alive_t alive_fn,
+              test_t test_fn, call_t call_fn)
+      : keys_(keys),
+        alive_fn_(alive_fn),
+        test_fn_(test_fn),
+        call_fn_(call_fn) {}
+
   bool Alive() const;
 
   bool TestThenCall(const json& meta) const;
 
+  std::vector<std::string> const& Keys() const { return keys_; }
+
+  bool Done() const { return done_; }
+
  private:
+  std::vector<std::string> keys_;
   alive_t alive_fn_;
   test_t test_fn_;
   call_t call_fn_;
+  mutable bool done_ = false;
 };
 
 /**
@@ -85,8 +114,49 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
   inline asio::io_service& GetContext() { return context_; }
   inline asio::io_service& GetMetaContext() { return meta_context_; }
 #endif
+
+  /**
+   * @brief The io context for serving a new connection, picked from the
+   * per-core shards in round-robin when `--io_shards` is set, otherwise the
+   * shared context.
+   */
+#if BOOST_VERSION >= 106600
+  asio::io_context& GetConnectionContext();
+#else
+  asio::io_service& GetConnectionContext();
+#endif
+
+  /**
+   * @brief The io contexts for serving a new IPC (or RPC) connection, from
+   * the dedicated pool when `--ipc_threads` (or `--rpc_threads`) is set,
+   * otherwise the same as `GetConnectionContext()`.
+   */
+#if BOOST_VERSION >= 106600
+  asio::io_context& GetIPCContext();
+  asio::io_context& GetRPCContext();
+#else
+  asio::io_service& GetIPCContext();
+  asio::io_service& GetRPCContext();
+#endif
+
+  /**
+   * @brief The io context for the periodic maintenance, i.e., compaction,
+   * lease sweeping and checkpoints, from the dedicated pool when
+   * `--background_threads` is set, otherwise the shared context.
+   */
+#if BOOST_VERSION >= 106600
+  asio::io_context& GetBackgroundContext();
+#else
+  asio::io_service& GetBackgroundContext();
+#endif
   inline std::shared_ptr<BulkStore> GetBulkStore() { return bulk_store_; }
   inline std::shared_ptr<StreamStore> GetStreamStore() { return stream_store_; }
+  /**
+   * @brief The cache of remote blobs, nullptr when it is disabled.
+   */
+  inline std::shared_ptr<RemoteBlobCache> GetRemoteBlobCache() {
+    return remote_blob_cache_;
+  }
   static std::shared_ptr<VineyardServer> Get(const json& spec);
 
   void MetaReady();
@@ -97,13 +167,24 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
   void Ready();
 
   Status GetData(const std::vector<ObjectID>& ids, const bool sync_remote,
-                 const bool wait,
+                 const bool wait, const int depth,
                  DeferredReq::alive_t alive,  // if connection is still alive
                  callback_t<const json&> callback);
 
   Status ListData(std::string const& pattern, bool const regex,
                   size_t const limit, callback_t<const json&> callback);
 
+  /**
+   * @brief List a page of object ids, see also `meta_tree::ListDataPage`.
+   */
+  Status ListDataPage(std::string const& pattern, bool const regex,
+                      size_t const limit, json const& filters,
+                      std::vector<std::string> const& fields,
+                      std::string const& cursor,
+                      callback_t<const std::vector<ObjectID>&, const json&,
+                                 const std::string&>
+                          callback);
+
   Status ListAllData(callback_t<std::vector<ObjectID> const&> callback);
 
   Status CreateData(
@@ -112,8 +193,44 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
 
   Status Persist(const ObjectID id, callback_t<> callback);
 
+  /**
+   * @brief Persist the object in the background, i.e., in the next group
+   * committed by the meta service, and return once the request is accepted.
+   */
+  Status PersistAsync(const ObjectID id);
+
+  /**
+   * @brief Report whether the asynchronous persistence of the object has
+   * completed, and defer the report until it completes when `block` is true.
+   * A failed persistence is reported, only once, as the error.
+   */
+  Status WaitPersist(const ObjectID id, bool const block,
+                     callback_t<const bool> callback);
+
   Status IfPersist(const ObjectID id, callback_t<const bool> callback);
 
+  /**
+   * @brief Lease the objects for `ttl` seconds: the leases are renewed while
+   * the session that leases them is `alive`, and the objects that are still
+   * not persisted are deleted by the sweeper once their leases expire. A new
+   * lease of an object replaces the previous one, and a non-positive `ttl`
+   * releases it.
+   */
+  Status Lease(const std::vector<ObjectID>& ids, int64_t const ttl,
+               DeferredReq::alive_t alive);
+
+  /**
+   * @brief Record the prefetched replicas of objects on this instance, and
+   * pin the local blobs of the replicas for `ttl` seconds, thus they won't
+   * be evicted before the jobs that need them start. The ids without a
+   * replica are only looked up, a non-positive `ttl` releases the pins of
+   * the ids, and the callback gets the replica of each id (or
+   * `InvalidObjectID()`) that is still pinned.
+   */
+  Status Prefetch(const std::vector<ObjectID>& ids,
+                  const std::vector<ObjectID>& replicas, int64_t const ttl,
+                  callback_t<const std::vector<ObjectID>&> callback);
+
   Status Exists(const ObjectID id, callback_t<const bool> callback);
 
   Status ShallowCopy(const ObjectID id, json const& extra_metadata,
@@ -128,6 +245,17 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
 
   Status DeleteBlobBatch(const std::set<ObjectID>& blobs);
 
+  /**
+   * @brief The blobs have become members of metadata, thus cannot be
+   * re-derived, see also `BulkStore::ReferenceByMeta`.
+   */
+  void ReferenceBlobsByMeta(const std::set<ObjectID>& blobs);
+
+  /**
+   * @brief Notify the clients that cache the metadata of the given objects.
+   */
+  void InvalidateObjects(const std::set<ObjectID>& ids);
+
   Status DeleteAllAt(const json& meta, InstanceID const instance_id);
 
   Status PutName(const ObjectID object_id, const std::string& name,
@@ -153,13 +281,45 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
 
   Status InstanceStatus(callback_t<const json&> callback);
 
-  Status ProcessDeferred(const json& meta);
+  /**
+   * @brief Attribute the blobs in the shared memory to the outermost objects
+   * that reference them, aggregated by the type name, the instance and the
+   * owner of the objects, i.e., the client process that created the blobs.
+   */
+  Status MemoryAttribution(callback_t<const json&> callback);
+
+  /**
+   * @brief Write the blobs that are referenced by any object, and the
+   * metadata of the transient objects of this instance, to the checkpoint
+   * at `path`, see also `BulkStore::Checkpoint()`. The blobs are written on
+   * the worker threads.
+   */
+  Status Checkpoint(const std::string& path, callback_t<const json&> callback);
+
+  inline ServerMetrics& GetMetrics() { return metrics_; }
+
+  /**
+   * @brief Write the metrics of the server, the stores and the connections in
+   * the prometheus text format.
+   */
+  void DumpMetrics(std::ostream& os);
+
+  /**
+   * @brief Wake up the deferred requests that wait for the updated keys of the
+   * metadata, see also `DeferredReq`, and test the others.
+   */
+  Status ProcessDeferred(const json& meta,
+                         std::unordered_set<std::string> const& updated_keys);
 
   inline InstanceID instance_id() { return instance_id_; }
   inline std::string instance_name() { return instance_name_; }
   inline void set_instance_id(InstanceID id) {
     instance_id_ = id;
     instance_name_ = "i" + std::to_string(instance_id_);
+    if (id != UnspecifiedInstanceID()) {
+      // distinguishes the object ids from the ones of the other instances
+      SetObjectIDTag(id);
+    }
   }
 
   inline std::string const& hostname() { return hostname_; }
@@ -185,6 +345,43 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
  private:
   explicit VineyardServer(const json& spec);
 
+  /**
+   * @brief Compact the shared memory every `interval` seconds.
+   */
+  void startCompaction(const int64_t interval);
+
+  /**
+   * @brief Delete the objects whose leases have expired every `interval`
+   * seconds.
+   */
+  void startLeaseSweeper(const int64_t interval);
+
+  /**
+   * @brief Pin the thread to the CPUs of the role in `--cpu_affinity`, does
+   * nothing if the role isn't listed.
+   */
+  void pinThread(std::thread::native_handle_type thread,
+                 const std::string& role);
+
+  struct ThreadPool;
+
+  void startPool(ThreadPool* pool);
+
+  void sweepExpiredLeases();
+
+  /**
+   * @brief Release the pin of the replica, requires `leases_mutex_`.
+   */
+  void unpinReplica(const ObjectID replica);
+
+  std::vector<ObjectID> lookupPrefetched(const std::vector<ObjectID>& ids);
+
+  Status attributeMemory(const json& meta, json& usage);
+
+  void deferRequest(DeferredReq&& request);
+
+  void finishPersist(const ObjectID id, const Status& status);
+
   json spec_;
 
   unsigned int concurrency_;
@@ -195,21 +392,88 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
 #endif
 
 #if BOOST_VERSION >= 106600
+  using io_context_t = asio::io_context;
   using ctx_guard = asio::executor_work_guard<asio::io_context::executor_type>;
 #else
+  using io_context_t = asio::io_service;
   using ctx_guard = std::unique_ptr<boost::asio::io_service::work>;
 #endif
   ctx_guard guard_, meta_guard_;
   std::vector<std::thread> workers_;
 
+  // the io context of a thread role that is run by its own threads
+  struct ThreadPool {
+    ThreadPool(const std::string& role, const int size);
+
+    std::string role;
+    int size;
+    std::unique_ptr<io_context_t> context;
+    ctx_guard guard;
+    std::vector<std::thread> workers;
+  };
+  std::unique_ptr<ThreadPool> ipc_pool_, rpc_pool_, background_pool_;
+  // role -> CPUs, see also `--cpu_affinity`
+  std::map<std::string, std::vector<int>> cpu_affinity_;
+
+  // per-core io contexts for serving connections, each is run by a single
+  // thread pinned to a core
+#if BOOST_VERSION >= 106600
+  std::vector<std::unique_ptr<asio::io_context>> shards_;
+#else
+  std::vector<std::unique_ptr<asio::io_service>> shards_;
+#endif
+  std::vector<ctx_guard> shard_guards_;
+  std::vector<std::thread> shard_workers_;
+  std::atomic<size_t> next_shard_;
+
   std::shared_ptr<IMetaService> meta_service_ptr_;
   std::unique_ptr<IPCServer> ipc_server_ptr_;
   std::unique_ptr<RPCServer> rpc_server_ptr_;
+  std::unique_ptr<MetricsServer> metrics_server_ptr_;
+  ServerMetrics metrics_;
 
   std::list<DeferredReq> deferred_;
+  // the deferred requests indexed by the keys they wait for, the finished and
+  // dead ones are dropped when their keys are updated, or by a sweep once the
+  // index has doubled
+  std::unordered_map<std::string, std::vector<std::shared_ptr<DeferredReq>>>
+      keyed_deferred_;
+  size_t keyed_deferred_size_ = 0, keyed_deferred_swept_size_ = 0;
 
   std::shared_ptr<BulkStore> bulk_store_;
   std::shared_ptr<StreamStore> stream_store_;
+  std::shared_ptr<RemoteBlobCache> remote_blob_cache_;
+
+  std::unique_ptr<asio::steady_timer> compaction_timer_;
+
+  struct lease_t {
+    std::chrono::seconds ttl;
+    std::chrono::steady_clock::time_point deadline;
+    DeferredReq::alive_t alive;
+  };
+  int64_t lease_sweep_interval_ = 0;
+  std::mutex leases_mutex_;
+  std::unordered_map<ObjectID, lease_t> leases_;
+  // the pinned blobs of prefetched replicas, guarded by `leases_mutex_` and
+  // swept together with the leases
+  struct pin_t {
+    ObjectID origin;
+    std::chrono::steady_clock::time_point deadline;
+    std::set<ObjectID> blobs;
+  };
+  std::unordered_map<ObjectID, ObjectID> prefetched_;  // origin -> replica
+  std::unordered_map<ObjectID, pin_t> pins_;           // replica -> pin
+  std::unique_ptr<asio::steady_timer> lease_timer_;
+
+  // the in-flight asynchronous persistence, and the failed ones that haven't
+  // been reported yet
+  struct PendingPersist {
+    bool done = false;
+    Status status;
+    std::vector<callback_t<const bool>> waiters;
+  };
+  std::mutex pending_persists_mutex_;
+  std::unordered_map<ObjectID, PendingPersist> pending_persists_;
 
   Status serve_status_;
 
@@ -221,9 +485,20 @@ class VineyardServer : public std::enable_shared_from_this<VineyardServer> {
     kBackendReady = 0b11,  // then we can serve ipc/rpc.
     kReady = 0b1111,
   };
-  unsigned char ready_;
+  // the components may get ready on different threads
+  std::atomic<unsigned char> ready_;
   std::atomic_bool stopped_;  // avoid invoke Stop() twice.
 
+  /**
+   * @brief Record the seconds since `Serve()` started at which the startup
+   * phase finishes, which are reported once the server is ready.
+   */
+  void recordStartupPhase(const std::string& phase);
+
+  std::chrono::steady_clock::time_point start_time_;
+  std::mutex startup_mutex_;
+  std::vector<std::pair<std::string, double>> startup_phases_;
+
   InstanceID instance_id_;
   std::string instance_name_;
   std::string hostname_;
@@ -28,6 +28,7 @@ limitations under the License.
 
 #include "common/util/boost.h"
 #include "common/util/logging.h"
+#include "server/util/meta_tree.h"
 
 #define BACKOFF_RETRY_TIME 10
 
@@ -150,8 +151,16 @@ void EtcdMetaService::requestLock(
 }
 
 void EtcdMetaService::commitUpdates(
-    const std::vector<op_t>& changes,
+    const std::vector<op_t>& updates,
     callback_t<unsigned> callback_after_updated) {
+  // The fields of the new objects are packed as one key per object, which
+  // takes fewer keys (and txns) in etcd and less bandwidth for the watchers.
+  std::vector<op_t> packed;
+  if (compress_meta_) {
+    meta_tree::PackDataOps(updates, packed);
+  }
+  const std::vector<op_t>& changes = compress_meta_ ? packed : updates;
+
   // Split to many small txns to conform the requirement of max-txn-ops
   // limitation (128) from etcd.
   //
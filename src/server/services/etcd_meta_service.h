@@ -137,7 +137,8 @@ class EtcdMetaService : public IMetaService {
   explicit EtcdMetaService(vs_ptr_t& server_ptr)
       : IMetaService(server_ptr),
         etcd_spec_(server_ptr_->GetSpec()["metastore_spec"]),
-        prefix_(etcd_spec_["etcd_prefix"].get_ref<std::string const&>()) {
+        prefix_(etcd_spec_["etcd_prefix"].get_ref<std::string const&>()),
+        compress_meta_(etcd_spec_.value("etcd_compress_meta", false)) {
     this->handled_rev_.store(0);
   }
 
@@ -177,6 +178,8 @@ class EtcdMetaService : public IMetaService {
 
   const json etcd_spec_;
   const std::string prefix_;
+  // stores the new objects as a single packed value, see PackDataOps
+  const bool compress_meta_;
 
  private:
   Status preStart() override;
@@ -16,7 +16,18 @@ limitations under the License.
 #include "server/services/meta_service.h"
 
 #include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "glog/logging.h"
 
@@ -85,6 +96,18 @@ std::shared_ptr<IMetaService> IMetaService::Get(vs_ptr_t server_ptr) {
  *   vineyard_server.cc.
  */
 
+static inline void erase_edge(
+    std::unordered_map<ObjectID, std::unordered_set<ObjectID>>& graph,
+    ObjectID const from, ObjectID const to) {
+  auto iter = graph.find(from);
+  if (iter != graph.end()) {
+    iter->second.erase(to);
+    if (iter->second.empty()) {
+      graph.erase(iter);
+    }
+  }
+}
+
 void IMetaService::IncRef(std::string const& instance_name,
                           std::string const& key, std::string const& value,
                           const bool from_remote) {
@@ -105,32 +128,9 @@ void IMetaService::IncRef(std::string const& instance_name,
       // the same object id.
       return;
     }
-    {
-      // validate the dependency graph
-      decltype(subobjects_.begin()) iter;
-      auto range = subobjects_.equal_range(key_obj);
-      for (iter = range.first; iter != range.second; ++iter) {
-        if (iter->second == value_obj) {
-          break;
-        }
-      }
-      if (iter == range.second) {
-        subobjects_.emplace(key_obj, value_obj);
-      }
-    }
-    {
-      // validate the dependency graph
-      decltype(supobjects_.begin()) iter;
-      auto range = supobjects_.equal_range(value_obj);
-      for (iter = range.first; iter != range.second; ++iter) {
-        if (iter->second == key_obj) {
-          break;
-        }
-      }
-      if (iter == range.second) {
-        supobjects_.emplace(value_obj, key_obj);
-      }
-    }
+    // the sets deduplicate the edges
+    subobjects_[key_obj].emplace(value_obj);
+    supobjects_[value_obj].emplace(key_obj);
   }
 }
 
@@ -141,16 +141,16 @@ void IMetaService::CloneRef(ObjectID const target, ObjectID const mirror) {
   if (supobjects_.find(mirror) != supobjects_.end()) {
     return;
   }
-  auto range = supobjects_.equal_range(target);
-  std::vector<ObjectID> suprefs;
-  // n.b.: avoid traverse & modify at the same time (in the same loop).
-  for (auto iter = range.first; iter != range.second; ++iter) {
-    suprefs.emplace_back(iter->second);
+  auto suprefs = supobjects_.find(target);
+  if (suprefs == supobjects_.end()) {
+    return;
   }
-  for (auto const supref : suprefs) {
-    supobjects_.emplace(mirror, supref);
-    subobjects_.emplace(supref, mirror);
+  // n.b.: copy as the insertion below may rehash `supobjects_`.
+  std::unordered_set<ObjectID> mirror_suprefs = suprefs->second;
+  for (auto const supref : mirror_suprefs) {
+    subobjects_[supref].emplace(mirror);
   }
+  supobjects_.emplace(mirror, std::move(mirror_suprefs));
 }
 
 bool IMetaService::deleteable(ObjectID const object_id) {
@@ -180,11 +180,15 @@ void IMetaService::traverseToDelete(std::set<ObjectID>& initial_delete_set,
     return;
   }
   // process the "initial_delete_set" in topo-sort order.
-  auto sup_target_range = supobjects_.equal_range(object_id);
   std::set<ObjectID> sup_traget_to_preprocess;
-  for (auto it = sup_target_range.first; it != sup_target_range.second; ++it) {
-    if (initial_delete_set.find(it->second) != initial_delete_set.end()) {
-      sup_traget_to_preprocess.emplace(it->second);
+  {
+    auto sup_targets = supobjects_.find(object_id);
+    if (sup_targets != supobjects_.end()) {
+      for (auto const sup_target : sup_targets->second) {
+        if (initial_delete_set.find(sup_target) != initial_delete_set.end()) {
+          sup_traget_to_preprocess.emplace(sup_target);
+        }
+      }
     }
   }
   for (ObjectID const& sup_target : sup_traget_to_preprocess) {
@@ -197,41 +201,25 @@ void IMetaService::traverseToDelete(std::set<ObjectID>& initial_delete_set,
     {
       // delete downwards
       std::set<ObjectID> to_delete;
-      {
+      auto subs = subobjects_.find(object_id);
+      if (subs != subobjects_.end()) {
         // delete sup-edges of subobjects
-        auto range = subobjects_.equal_range(object_id);
-        for (auto it = range.first; it != range.second; ++it) {
+        for (auto const sub : subs->second) {
           // remove dependency edge
-          auto suprange = supobjects_.equal_range(it->second);
-          decltype(suprange.first) p;
-          for (p = suprange.first; p != suprange.second; /* no self-inc */) {
-            if (p->second == object_id) {
-              supobjects_.erase(p++);
-            } else {
-              ++p;
-            }
-          }
-          if (deep || IsBlob(it->second)) {
+          erase_edge(supobjects_, sub, object_id);
+          if (deep || IsBlob(sub)) {
             // blob is special: see Note [Deleting objects and blobs].
-            to_delete.emplace(it->second);
+            to_delete.emplace(sub);
           }
         }
       }
 
-      {
+      auto sups = supobjects_.find(object_id);
+      if (sups != supobjects_.end()) {
         // delete sub-edges of supobjects
-        auto range = supobjects_.equal_range(object_id);
-        for (auto it = range.first; it != range.second; ++it) {
+        for (auto const sup : sups->second) {
           // remove dependency edge
-          auto subrange = subobjects_.equal_range(it->second);
-          decltype(subrange.first) p;
-          for (p = subrange.first; p != subrange.second; /* no self-inc */) {
-            if (p->second == object_id) {
-              subobjects_.erase(p++);
-            } else {
-              ++p;
-            }
-          }
+          erase_edge(subobjects_, sup, object_id);
         }
       }
 
@@ -243,27 +231,17 @@ void IMetaService::traverseToDelete(std::set<ObjectID>& initial_delete_set,
     if (force) {
       // delete upwards
       std::set<ObjectID> to_delete;
-      auto range = supobjects_.equal_range(object_id);
-      for (auto it = range.first; it != range.second; ++it) {
-        // remove dependency edge
-        auto subrange = subobjects_.equal_range(it->second);
-        decltype(subrange.first) p;
-        for (p = subrange.first; p != subrange.second; /* no self-inc */) {
-          if (p->second == object_id) {
-            subobjects_.erase(p++);
-          } else {
-            ++p;
-          }
-        }
-        if (force) {
-          to_delete.emplace(it->second);
+      auto sups = supobjects_.find(object_id);
+      if (sups != supobjects_.end()) {
+        for (auto const sup : sups->second) {
+          // remove dependency edge
+          erase_edge(subobjects_, sup, object_id);
+          to_delete.emplace(sup);
         }
       }
-      if (force) {
-        for (auto const& target : to_delete) {
-          traverseToDelete(initial_delete_set, delete_set, depth + 1, depthes,
-                           target, true, false);
-        }
+      for (auto const& target : to_delete) {
+        traverseToDelete(initial_delete_set, delete_set, depth + 1, depthes,
+                         target, true, false);
       }
     }
     subobjects_.erase(object_id);
@@ -285,6 +263,31 @@ void IMetaService::findDeleteSet(std::vector<ObjectID> const& object_ids,
     traverseToDelete(initial_delete_set, delete_set, 0, depthes, object_id,
                      force, deep);
   }
+  // the objects that the scoped names of the deleted objects are associated
+  // with go with them, see also `ScopedName()`
+  std::set<ObjectID> visited;
+  bool expanded = true;
+  while (expanded) {
+    expanded = false;
+    for (auto const object_id : std::set<ObjectID>(delete_set)) {
+      if (IsBlob(object_id) || !visited.emplace(object_id).second) {
+        continue;
+      }
+      std::vector<std::pair<std::string, ObjectID>> names;
+      meta_tree::ScopedNames(meta_, object_id, names);
+      for (auto const& item : names) {
+        bool exists = false;
+        VINEYARD_DISCARD(
+            CATCH_JSON_ERROR(meta_tree::Exists(meta_, item.second, exists)));
+        if (exists && delete_set.find(item.second) == delete_set.end()) {
+          std::set<ObjectID> scoped_delete_set{item.second};
+          traverseToDelete(scoped_delete_set, delete_set, 0, depthes,
+                           item.second, false, true);
+          expanded = true;
+        }
+      }
+    }
+  }
   postProcessForDelete(delete_set, depthes, processed_delete_set);
 }
 
@@ -309,22 +312,302 @@ void IMetaService::printDepsGraph() {
   std::stringstream ss;
   ss << "object top -> down dependencies: " << std::endl;
   for (auto const& kv : subobjects_) {
-    ss << ObjectIDToString(kv.first) << " -> " << ObjectIDToString(kv.second)
-       << std::endl;
+    for (auto const sub : kv.second) {
+      ss << ObjectIDToString(kv.first) << " -> " << ObjectIDToString(sub)
+         << std::endl;
+    }
   }
   ss << "object down <- top dependencies: " << std::endl;
   for (auto const& kv : supobjects_) {
-    ss << ObjectIDToString(kv.first) << " <- " << ObjectIDToString(kv.second)
-       << std::endl;
+    for (auto const sup : kv.second) {
+      ss << ObjectIDToString(kv.first) << " <- " << ObjectIDToString(sup)
+         << std::endl;
+    }
   }
   VLOG(100) << "Depenencies graph on " << server_ptr_->instance_name() << ": \n"
             << ss.str();
 }
 
+static void flatten_meta_tree(const json& tree, std::string const& prefix,
+                              std::vector<IMetaService::op_t>& ops) {
+  for (auto const& item : json::iterator_wrapper(tree)) {
+    std::string key = prefix + "/" + item.key();
+    if (item.value().is_object()) {
+      flatten_meta_tree(item.value(), key, ops);
+    } else {
+      ops.emplace_back(IMetaService::op_t::Put(key, item.value()));
+    }
+  }
+}
+
+Status IMetaService::loadSnapshot() {
+  if (snapshot_path_.empty()) {
+    return Status::OK();
+  }
+  std::ifstream file(snapshot_path_, std::ios::binary);
+  if (!file) {
+    return Status::IOError("No metadata snapshot at " + snapshot_path_);
+  }
+  std::vector<uint8_t> content((std::istreambuf_iterator<char>(file)),
+                               std::istreambuf_iterator<char>());
+  json snapshot;
+  auto status = CATCH_JSON_ERROR([&]() -> Status {
+    snapshot = json::from_msgpack(content);
+    return Status::OK();
+  }());
+  if (!status.ok() || !snapshot.contains("rev") ||
+      !snapshot.contains("meta")) {
+    LOG(WARNING) << "Ignore the invalid metadata snapshot at "
+                 << snapshot_path_;
+    return Status::Invalid("Invalid metadata snapshot");
+  }
+  unsigned const rev = snapshot["rev"].get<unsigned>();
+  if (rev == 0) {
+    return Status::Invalid("Empty metadata snapshot");
+  }
+  std::vector<op_t> ops;
+  flatten_meta_tree(snapshot["meta"], "", ops);
+  this->metaUpdate(ops, true);
+  rev_ = rev;
+  LOG(INFO) << "Restored " << ops.size() << " keys from the metadata snapshot "
+            << snapshot_path_ << ", at revision " << rev_;
+  return Status::OK();
+}
+
+/**
+ * @brief The names of the transient objects, which live in this instance
+ * only.
+ */
+static std::unordered_set<std::string> transient_objects(const json& meta) {
+  std::unordered_set<std::string> transients;
+  auto data = meta.find("data");
+  if (data != meta.end() && data->is_object()) {
+    for (auto iter = data->begin(); iter != data->end(); ++iter) {
+      if (iter->is_object() && iter->value("transient", false)) {
+        transients.emplace(iter.key());
+      }
+    }
+  }
+  return transients;
+}
+
+static bool is_transient_signature(
+    const json& value, std::unordered_set<std::string> const& transients) {
+  return value.is_string() &&
+         transients.find(value.get_ref<std::string const&>()) !=
+             transients.end();
+}
+
+json IMetaService::TransientMeta(const json& meta) {
+  auto transients = transient_objects(meta);
+  json transient = json::object();
+  if (transients.empty()) {
+    return transient;
+  }
+  json& data = transient["data"];
+  for (auto const& name : transients) {
+    data[name] = meta["data"][name];
+  }
+  auto signatures = meta.find("signatures");
+  if (signatures != meta.end() && signatures->is_object()) {
+    for (auto instance = signatures->begin(); instance != signatures->end();
+         ++instance) {
+      if (!instance->is_object()) {
+        continue;
+      }
+      for (auto iter = instance->begin(); iter != instance->end(); ++iter) {
+        if (is_transient_signature(*iter, transients)) {
+          transient["signatures"][instance.key()][iter.key()] = *iter;
+        }
+      }
+    }
+  }
+  return transient;
+}
+
+void IMetaService::RequestToRestoreTransient(const json& transient,
+                                             callback_t<> callback) {
+  server_ptr_->GetMetaContext().post([this, transient, callback]() {
+    std::vector<op_t> ops;
+    auto status = CATCH_JSON_ERROR([&]() {
+      flatten_meta_tree(transient, "", ops);
+      return Status::OK();
+    }());
+    if (status.ok() && !ops.empty()) {
+      this->metaUpdate(ops, false);
+      LOG(INFO) << "Restored " << ops.size()
+                << " keys of the transient objects";
+    }
+    VINEYARD_DISCARD(callback(status));
+  });
+}
+
+Status IMetaService::saveSnapshot() {
+  if (rev_ == 0) {
+    return Status::OK();
+  }
+  json meta = meta_;
+  // the changes of the persist groups that haven't been committed may not be
+  // in etcd at `rev_`, the objects they touch are excluded and restored from
+  // the updates since the snapshot instead
+  std::unordered_set<std::string> uncommitted;
+  for (auto const& item : uncommitted_keys_) {
+    std::vector<std::string> vs;
+    boost::algorithm::split(vs, item.first,
+                            [](const char c) { return c == '/'; });
+    if (vs.size() >= 3 && vs[0].empty() && vs[1] == "data") {
+      uncommitted.emplace(vs[2]);
+      continue;
+    }
+    json::json_pointer pointer(item.first);
+    if (meta.contains(pointer)) {
+      meta[pointer.parent_pointer()].erase(pointer.back());
+    }
+  }
+  // transient objects live in this instance only
+  auto transients = transient_objects(meta);
+  auto data = meta.find("data");
+  if (data != meta.end() && data->is_object()) {
+    for (auto const& name : transients) {
+      data->erase(name);
+    }
+    for (auto const& name : uncommitted) {
+      data->erase(name);
+    }
+  }
+  auto signatures = meta.find("signatures");
+  if (signatures != meta.end() && signatures->is_object()) {
+    for (auto& instance : *signatures) {
+      if (!instance.is_object()) {
+        continue;
+      }
+      for (auto iter = instance.begin(); iter != instance.end();) {
+        if (is_transient_signature(*iter, transients)) {
+          iter = instance.erase(iter);
+        } else {
+          ++iter;
+        }
+      }
+    }
+  }
+  json snapshot;
+  snapshot["rev"] = rev_;
+  snapshot["meta"] = std::move(meta);
+  std::vector<uint8_t> content = json::to_msgpack(snapshot);
+
+  // write to a temporary file first, a crash won't leave a broken snapshot
+  std::string const temporary = snapshot_path_ + ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(content.data()), content.size());
+    if (!file) {
+      return Status::IOError("Failed to write the metadata snapshot to " +
+                             temporary);
+    }
+  }
+  if (std::rename(temporary.c_str(), snapshot_path_.c_str()) != 0) {
+    return Status::IOError("Failed to move the metadata snapshot to " +
+                           snapshot_path_ + ": " + strerror(errno));
+  }
+  VLOG(10) << "Saved the metadata snapshot at revision " << rev_;
+  return Status::OK();
+}
+
+struct IMetaService::object_sync_t {
+  callback_t<const json&> callback;
+  std::unordered_set<ObjectID> requested;
+  size_t pending = 0;
+  bool fallback = false;
+};
+
+void IMetaService::requestObjects(const std::vector<ObjectID>& ids,
+                                  callback_t<const json&> callback) {
+  auto sync = std::make_shared<object_sync_t>();
+  sync->callback = callback;
+  fetchObjects(sync, ids);
+}
+
+void IMetaService::fetchObjects(std::shared_ptr<object_sync_t> const& sync,
+                                const std::vector<ObjectID>& ids) {
+  std::vector<ObjectID> missing;
+  for (auto const& id : ids) {
+    if (!sync->requested.emplace(id).second) {
+      continue;
+    }
+    if (!meta_.contains(json::json_pointer("/data/" + ObjectIDToString(id)))) {
+      missing.emplace_back(id);
+    }
+  }
+  if (missing.empty()) {
+    if (sync->pending > 0) {
+      return;
+    }
+    if (sync->fallback) {
+      auto callback = sync->callback;
+      requestValues("",
+                    [callback](const Status& status, const json& meta,
+                               unsigned) { return callback(status, meta); });
+    } else {
+      VINEYARD_DISCARD(sync->callback(Status::OK(), meta_));
+    }
+    return;
+  }
+  sync->pending += missing.size();
+  for (auto const& id : missing) {
+    requestAll(
+        "/data/" + ObjectIDToString(id), rev_,
+        [this, sync](const Status& status, const std::vector<op_t>& ops,
+                     unsigned) {
+          sync->pending -= 1;
+          std::vector<ObjectID> members;
+          auto collect = [&](const json& value) {
+            if (!value.is_string()) {
+              return;
+            }
+            auto const& encoded = value.get_ref<std::string const&>();
+            ObjectID member = InvalidObjectID();
+            if (meta_tree::DecodeObjectID(meta_, server_ptr_->instance_name(),
+                                          encoded, member)
+                    .ok()) {
+              members.emplace_back(member);
+            } else if (!encoded.empty() && encoded[0] == 'l') {
+              // the link cannot be resolved from the fetched keys
+              sync->fallback = true;
+            }
+          };
+          if (status.ok()) {
+            this->metaUpdate(ops, true);
+            for (auto const& op : ops) {
+              if (op.op != op_t::kPut || op.kv.key.empty()) {
+                continue;
+              }
+              json value;
+              VINEYARD_DISCARD(
+                  meta_tree::DecodeStoredValue(op.kv.value, value));
+              if (value.is_object()) {
+                for (auto const& item : json::iterator_wrapper(value)) {
+                  collect(item.value());
+                }
+              } else {
+                collect(value);
+              }
+            }
+          } else {
+            LOG(WARNING) << "Failed to fetch the metadata of objects: "
+                         << status.ToString();
+            sync->fallback = true;
+          }
+          this->fetchObjects(sync, members);
+          return Status::OK();
+        });
+  }
+}
+
 void IMetaService::putVal(const kv_t& kv, bool const from_remote) {
   // don't crash the server for any reason (any potential garbage value)
   auto upsert_to_meta = [&]() -> Status {
-    json value = json::parse(kv.value);
+    json value;
+    RETURN_ON_ERROR(meta_tree::DecodeStoredValue(kv.value, value));
     if (value.is_string()) {
       IncRef(server_ptr_->instance_name(), kv.key,
              value.get_ref<std::string const&>(), from_remote);
@@ -337,6 +620,7 @@ void IMetaService::putVal(const kv_t& kv, bool const from_remote) {
       }
     }
     meta_[json::json_pointer(kv.key)] = value;
+    indexVal(kv.key, value);
     return Status::OK();
   };
 
@@ -378,7 +662,41 @@ void IMetaService::putVal(const kv_t& kv, bool const from_remote) {
   VINEYARD_LOG_ERROR(CATCH_JSON_ERROR(upsert_to_meta()));
 }
 
+void IMetaService::indexVal(std::string const& key, const json& value) {
+  // either "/data/<name>/typename", or "/data/<name>" for the whole object
+  if (!boost::algorithm::starts_with(key, "/data/")) {
+    return;
+  }
+  std::string const path = key.substr(strlen("/data/"));
+  auto slash = path.find('/');
+  std::string const name = path.substr(0, slash);
+  json const* type = nullptr;
+  if (slash == std::string::npos) {
+    if (value.is_object() && value.contains("typename")) {
+      type = &value["typename"];
+    }
+  } else if (path.compare(slash + 1, std::string::npos, "typename") == 0) {
+    type = &value;
+  }
+  if (type == nullptr || !type->is_string()) {
+    return;
+  }
+  auto const& encoded = type->get_ref<std::string const&>();
+  // the type name is encoded as a value node, see also meta_tree
+  if (!encoded.empty() && encoded[0] == 'v') {
+    type_index_.Put(name, encoded.substr(1));
+  }
+}
+
 void IMetaService::delVal(std::string const& key) {
+  if (boost::algorithm::starts_with(key, "/data/")) {
+    std::string const path = key.substr(strlen("/data/"));
+    auto slash = path.find('/');
+    if (slash == std::string::npos ||
+        path.compare(slash + 1, std::string::npos, "typename") == 0) {
+      type_index_.Erase(path.substr(0, slash));
+    }
+  }
   auto path = json::json_pointer(key);
   if (meta_.contains(path)) {
     auto ppath = path.parent_pointer();
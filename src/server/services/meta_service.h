@@ -18,11 +18,17 @@ limitations under the License.
 
 #include <chrono>
 #include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "boost/asio.hpp"
@@ -37,8 +43,10 @@ limitations under the License.
 #include "common/util/json.h"
 #include "common/util/logging.h"
 #include "common/util/status.h"
+#include "common/util/trace.h"
 #include "server/server/vineyard_server.h"
 #include "server/util/metrics.h"
+#include "server/util/type_index.h"
 
 #define HEARTBEAT_TIME 60
 #define MAX_TIMEOUT_COUNT 3
@@ -126,7 +134,15 @@ class IMetaService {
   };
   virtual ~IMetaService() {}
   explicit IMetaService(vs_ptr_t& server_ptr)
-      : server_ptr_(server_ptr), rev_(0), meta_sync_lock_("/meta_sync_lock") {}
+      : server_ptr_(server_ptr), rev_(0), meta_sync_lock_("/meta_sync_lock") {
+    auto const& spec = server_ptr_->GetSpec()["metastore_spec"];
+    owned_writes_ = spec.value("etcd_owned_writes", false);
+    if (spec.value("meta", "") == "etcd") {
+      // the metadata of the local meta service doesn't survive restarts
+      snapshot_path_ = spec.value("meta_snapshot_path", "");
+      snapshot_interval_ = spec.value("meta_snapshot_interval", 0);
+    }
+  }
 
   static std::shared_ptr<IMetaService> Get(vs_ptr_t);
 
@@ -134,101 +150,74 @@ class IMetaService {
     LOG(INFO) << "meta service is starting ...";
     RETURN_ON_ERROR(this->preStart());
     RETURN_ON_ERROR(this->probe());
-    requestValues("", [this](const Status& status, const json& meta,
-                             unsigned rev) {
-      if (status.ok()) {
-        // start the watcher.
-        this->startDaemonWatch("", rev_,
-                               boost::bind(&IMetaService::daemonWatchHandler,
-                                           this, _1, _2, _3, _4));
-
-        // register self info.
-        this->registerToEtcd();
-      } else {
-        Status s = status;
-        s << "Failed to get initial value";
-        // Abort: since the probe has succeeded but the etcd
-        // doesn't work, we have no idea about what happened.
-        s.Abort();
-      }
-      return status;
-    });
+    bool const warm = loadSnapshot().ok() && rev_ != 0;
+    if (warm) {
+      // replays the updates since the snapshot, the watcher must be running
+      // as waiting for updates relies on it.
+      this->startDaemonWatch("", rev_,
+                             boost::bind(&IMetaService::daemonWatchHandler,
+                                         this, _1, _2, _3, _4));
+    }
+    requestInitialValues(warm);
     return Status::OK();
   }
 
   virtual inline void Stop() { LOG(INFO) << "meta service is stopping ..."; }
 
  public:
+  /**
+   * Bulk updates that arrive while the meta context is busy are applied as a
+   * group: each is validated against the tree left by the earlier ones, and
+   * the deferred requests and blob deletions are processed once.
+   */
   inline void RequestToBulkUpdate(
       callback_t<const json&, std::vector<op_t>&, InstanceID&>
           callback_after_ready,
       callback_t<const InstanceID> callback_after_finish) {
-    server_ptr_->GetMetaContext().post([this, callback_after_ready,
-                                        callback_after_finish]() {
-      std::vector<op_t> ops;
-      InstanceID computed_instance_id;
-      auto status =
-          callback_after_ready(Status::OK(), meta_, ops, computed_instance_id);
-      if (status.ok()) {
-#ifndef NDEBUG
-        // debugging
-        printDepsGraph();
-#endif
-        this->metaUpdate(ops, false);
-      } else {
-        LOG(ERROR) << status.ToString();
+    {
+      std::lock_guard<std::mutex> scope_lock(bulk_update_mutex_);
+      bulk_update_queue_.emplace_back(callback_after_ready,
+                                      callback_after_finish);
+      if (bulk_updating_) {
+        return;
       }
-      VINEYARD_SUPPRESS(callback_after_finish(status, computed_instance_id));
-    });
+      bulk_updating_ = true;
+    }
+    server_ptr_->GetMetaContext().post([this]() { applyBulkUpdateGroup(); });
   }
 
+  /**
+   * Persist requests are committed in groups: while a group is being
+   * committed, the requests that arrive are queued and committed together in
+   * the next group, under a single lock and a single transaction.
+   */
   inline void RequestToPersist(
       callback_t<const json&, std::vector<op_t>&> callback_after_ready,
       callback_t<> callback_after_finish) {
-    // NB: when persist local meta to etcd, we needs the meta_sync_lock_ to
-    // avoid contention between other vineyard instances.
-    this->requestLock(
-        meta_sync_lock_,
-        [this, callback_after_ready, callback_after_finish](
-            const Status& status, std::shared_ptr<ILock> lock) {
-          if (status.ok()) {
-            requestValues(
-                "", [this, callback_after_ready, callback_after_finish, lock](
-                        const Status& status, const json& meta, unsigned rev) {
-                  std::vector<op_t> ops;
-                  auto s = callback_after_ready(status, meta, ops);
-                  if (s.ok()) {
-                    if (ops.empty()) {
-                      unsigned rev_after_unlock = 0;
-                      VINEYARD_DISCARD(lock->Release(rev_after_unlock));
-                      return callback_after_finish(Status::OK());
-                    }
-                    // apply changes locally before committing to etcd
-                    this->metaUpdate(ops, false);
-                    // commit to etcd
-                    this->commitUpdates(
-                        ops, [callback_after_finish, lock](const Status& status,
-                                                           unsigned rev) {
-                          // update rev_ to the revision after unlock.
-                          unsigned rev_after_unlock = 0;
-                          VINEYARD_DISCARD(lock->Release(rev_after_unlock));
-                          return callback_after_finish(status);
-                        });
-                    return Status::OK();
-                  } else {
-                    unsigned rev_after_unlock = 0;
-                    VINEYARD_DISCARD(lock->Release(rev_after_unlock));
-                    return callback_after_finish(s);  // propogate the error
-                  }
-                });
-            return Status::OK();
-          } else {
-            LOG(ERROR) << status.ToString();
-            return callback_after_finish(status);  // propogate the error
-          }
-        });
+    {
+      std::lock_guard<std::mutex> scope_lock(persist_mutex_);
+      persist_queue_.emplace_back(callback_after_ready, callback_after_finish);
+      if (persisting_) {
+        return;
+      }
+      persisting_ = true;
+    }
+    commitPersistGroup();
   }
 
+  /**
+   * @brief The metadata of the transient objects, i.e., the objects that
+   * live in this instance only and can't be recovered from etcd, and the
+   * signature mappings of them, in the layout of the meta tree.
+   */
+  static json TransientMeta(const json& meta);
+
+  /**
+   * @brief Put the metadata saved by `TransientMeta()` back into the meta
+   * tree, e.g., when vineyardd restarts from a checkpoint.
+   */
+  void RequestToRestoreTransient(const json& transient, callback_t<> callback);
+
   inline void RequestToGetData(const bool sync_remote,
                                callback_t<const json&> callback) {
     if (sync_remote) {
@@ -247,6 +236,23 @@ class IMetaService {
     }
   }
 
+  /**
+   * Sync the subtrees of the given objects only, rather than catching up with
+   * all updates of the backend: the keys of the objects that are missing
+   * locally are fetched by their prefixes, then the keys of their missing
+   * members, and so on. The fetched keys are applied at the revision they are
+   * read at, which bounds them against the updates that are older than
+   * `rev_`.
+   *
+   * Falls back to the general sync when a member cannot be resolved from the
+   * fetched keys, e.g., a member that is linked by its signature.
+   */
+  inline void RequestToGetData(const std::vector<ObjectID>& ids,
+                               callback_t<const json&> callback) {
+    server_ptr_->GetMetaContext().post(
+        [this, ids, callback]() { requestObjects(ids, callback); });
+  }
+
   inline void RequestToDelete(
       const std::vector<ObjectID>& object_ids, const bool force,
       const bool deep,
@@ -254,9 +260,12 @@ class IMetaService {
                  bool&>
           callback_after_ready,
       callback_t<> callback_after_finish) {
+    // the request is handled on the meta context, outside of the trace scope
+    uint64_t trace_id = Tracer::CurrentTraceID();
     server_ptr_->GetMetaContext().post([this, object_ids, force, deep,
                                         callback_after_ready,
-                                        callback_after_finish]() {
+                                        callback_after_finish, trace_id]() {
+      VINEYARD_TRACE_ID_SCOPE(trace_id);
       // generated ops.
       std::vector<op_t> ops;
 
@@ -293,18 +302,19 @@ class IMetaService {
       // avoid contention between other vineyard instances.
       this->requestLock(
           meta_sync_lock_,
-          [this, ops /* by copy */, callback_after_ready,
-           callback_after_finish](const Status& status,
-                                  std::shared_ptr<ILock> lock) {
+          [this, ops /* by copy */, callback_after_ready, callback_after_finish,
+           trace_id](const Status& status, std::shared_ptr<ILock> lock) {
             if (status.ok()) {
               // commit to etcd
-              this->commitUpdates(ops, [callback_after_finish, lock](
-                                           const Status& status, unsigned rev) {
-                // update rev_ to the revision after unlock.
-                unsigned rev_after_unlock = 0;
-                VINEYARD_DISCARD(lock->Release(rev_after_unlock));
-                return callback_after_finish(status);
-              });
+              this->tracedCommitUpdates(
+                  ops, trace_id,
+                  [callback_after_finish, lock](const Status& status,
+                                                unsigned rev) {
+                    // update rev_ to the revision after unlock.
+                    unsigned rev_after_unlock = 0;
+                    VINEYARD_DISCARD(lock->Release(rev_after_unlock));
+                    return callback_after_finish(status);
+                  });
               return Status::OK();
             } else {
               LOG(ERROR) << status.ToString();
@@ -353,6 +363,12 @@ class IMetaService {
               std::string const& value, const bool from_remote);
   void CloneRef(ObjectID const target, ObjectID const mirror);
 
+  /**
+   * @brief The index of objects in the meta tree by type names, it should
+   * only be accessed in the meta context.
+   */
+  const TypeIndex& GetTypeIndex() const { return type_index_; }
+
  private:
   inline void registerToEtcd() {
     RequestToPersist(
@@ -527,6 +543,28 @@ class IMetaService {
   virtual void commitUpdates(const std::vector<op_t>&,
                              callback_t<unsigned> callback_after_updated) = 0;
 
+  /**
+   * @brief Commits the updates, and records the latency of the asynchronous
+   * commit in the metrics, and as a span of the given trace id.
+   */
+  void tracedCommitUpdates(const std::vector<op_t>& ops,
+                           uint64_t const trace_id,
+                           callback_t<unsigned> callback_after_updated) {
+    uint64_t start = Tracer::Now();
+    this->commitUpdates(ops, [this, trace_id, start, callback_after_updated](
+                                 const Status& status, unsigned rev) {
+      uint64_t end = Tracer::Now();
+      server_ptr_->GetMetrics().ObserveMetaCommit((end - start) / 1000,
+                                                  status.ok());
+#if defined(WITH_TRACING)
+      Tracer::Record("IMetaService::commitUpdates", trace_id, start, end);
+#else
+      static_cast<void>(trace_id);
+#endif
+      return callback_after_updated(status, rev);
+    });
+  }
+
   void requestValues(const std::string& prefix,
                      callback_t<const json&, unsigned> callback) {
     // We still need to run a `etcdctl get` for the first time. With a
@@ -578,6 +616,100 @@ class IMetaService {
 
   void printDepsGraph();
 
+  /**
+   * @brief Restore the metadata from etcd saved in the snapshot, and the
+   * revision it corresponds to.
+   */
+  Status loadSnapshot();
+
+  /**
+   * @brief Save the metadata from etcd, i.e., excluding transient objects of
+   * this instance, to the snapshot file.
+   */
+  Status saveSnapshot();
+
+  Status startSnapshot(Status const&) {
+    if (snapshot_path_.empty() || snapshot_interval_ <= 0) {
+      return Status::OK();
+    }
+    snapshot_timer_.reset(
+        new asio::steady_timer(server_ptr_->GetMetaContext(),
+                               std::chrono::seconds(snapshot_interval_)));
+    snapshot_timer_->async_wait([this](const boost::system::error_code& error) {
+      if (error) {
+        LOG(ERROR) << "snapshot timer error: " << error << ", "
+                   << error.message();
+        return;
+      }
+      auto status = saveSnapshot();
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to save the metadata snapshot: "
+                     << status.ToString();
+      }
+      startSnapshot(Status::OK());
+    });
+    return Status::OK();
+  }
+
+  /**
+   * @brief Wait for the initial values of the metadata, i.e., the updates
+   * since the snapshot when `warm`, otherwise all values. The warm start
+   * falls back to the cold start when the updates can't be replayed, e.g.,
+   * the revision of the snapshot has been compacted by etcd.
+   */
+  void requestInitialValues(bool const warm) {
+    requestValues("", [this, warm](const Status& status, const json& meta,
+                                   unsigned rev) {
+      if (!status.ok() && warm) {
+        LOG(WARNING) << "Failed to replay the metadata updates since the "
+                     << "snapshot at revision " << rev_
+                     << ", fallback to the cold start: " << status.ToString();
+        resetMeta();
+        requestInitialValues(false);
+        return Status::OK();
+      }
+      if (status.ok()) {
+        if (!warm) {
+          // start the watcher.
+          this->startDaemonWatch("", rev_,
+                                 boost::bind(&IMetaService::daemonWatchHandler,
+                                             this, _1, _2, _3, _4));
+        }
+
+        // register self info.
+        this->registerToEtcd();
+        startSnapshot(Status::OK());
+      } else {
+        Status s = status;
+        s << "Failed to get initial value";
+        // Abort: since the probe has succeeded but the etcd
+        // doesn't work, we have no idea about what happened.
+        s.Abort();
+      }
+      return status;
+    });
+  }
+
+  /**
+   * @brief Drop the metadata restored from the snapshot, and the states
+   * derived from it.
+   */
+  void resetMeta() {
+    meta_ = json();
+    rev_ = 0;
+    type_index_.Clear();
+    subobjects_.clear();
+    supobjects_.clear();
+    instances_list_.clear();
+  }
+
+  std::string snapshot_path_;
+  int64_t snapshot_interval_ = 0;
+  std::unique_ptr<asio::steady_timer> snapshot_timer_;
+  // the keys that have been applied locally by the persist groups that are
+  // being committed, which the snapshot excludes, see `applyPersistGroup()`
+  std::unordered_map<std::string, size_t> uncommitted_keys_;
+
   json meta_;
   vs_ptr_t server_ptr_;
 
@@ -586,9 +718,256 @@ class IMetaService {
 
   std::string meta_sync_lock_;
 
+  TypeIndex type_index_;
+
  private:
+  using persist_request_t =
+      std::pair<callback_t<const json&, std::vector<op_t>&>, callback_t<>>;
+
+  // the ops of a group are limited by the max-txn-ops of etcd (128), a single
+  // request beyond that is split in `commitUpdates()` as before
+  static constexpr size_t kMaxGroupCommitOps = 127;
+
+  void commitPersistGroup() {
+    bool owned = false;
+    {
+      std::lock_guard<std::mutex> scope_lock(persist_mutex_);
+      owned = owned_writes_ && !persist_under_lock_;
+      persist_under_lock_ = false;
+    }
+    if (owned) {
+      // optimistically skip the lock, see also `ownedOps()`
+      requestValues("", [this](const Status& status, const json& meta,
+                               unsigned rev) {
+        applyPersistGroup(status, meta, nullptr);
+        return Status::OK();
+      });
+      return;
+    }
+    // NB: when persist local meta to etcd, we needs the meta_sync_lock_ to
+    // avoid contention between other vineyard instances.
+    this->requestLock(meta_sync_lock_, [this](const Status& status,
+                                              std::shared_ptr<ILock> lock) {
+      if (!status.ok()) {
+        applyPersistGroup(status, meta_, nullptr);
+        return Status::OK();
+      }
+      requestValues("", [this, lock](const Status& status, const json& meta,
+                                     unsigned rev) {
+        applyPersistGroup(status, meta, lock);
+        return Status::OK();
+      });
+      return Status::OK();
+    });
+  }
+
+  /**
+   * Without the `lock`, requests that touch keys of other instances are
+   * deferred to the next group, which is committed under the lock.
+   */
+  void applyPersistGroup(const Status& status, const json& meta,
+                         std::shared_ptr<ILock> lock) {
+    std::deque<persist_request_t> group;
+    {
+      std::lock_guard<std::mutex> scope_lock(persist_mutex_);
+      group.swap(persist_queue_);
+    }
+    if (!status.ok()) {
+      LOG(ERROR) << status.ToString();
+      for (auto const& request : group) {
+        VINEYARD_DISCARD(request.second(status));  // propogate the error
+      }
+      if (lock) {
+        unsigned rev_after_unlock = 0;
+        VINEYARD_DISCARD(lock->Release(rev_after_unlock));
+      }
+      finishPersistGroup({}, false);
+      return;
+    }
+    std::vector<op_t> ops;
+    std::vector<callback_t<>> finishes;
+    std::deque<persist_request_t> deferred;
+    bool needs_lock = false;
+    for (auto const& request : group) {
+      if (ops.size() >= kMaxGroupCommitOps) {
+        deferred.emplace_back(request);
+        continue;
+      }
+      std::vector<op_t> request_ops;
+      auto s = request.first(status, meta, request_ops);
+      if (!s.ok()) {
+        VINEYARD_DISCARD(request.second(s));  // propogate the error
+        continue;
+      }
+      if (!lock && !ownedOps(meta, request_ops)) {
+        deferred.emplace_back(request);
+        needs_lock = true;
+        continue;
+      }
+      if (!request_ops.empty()) {
+        // apply changes locally before committing to etcd, the later
+        // requests in the group see the changes in `meta`
+        this->metaUpdate(request_ops, false);
+        ops.insert(ops.end(), request_ops.begin(), request_ops.end());
+      }
+      finishes.emplace_back(request.second);
+    }
+    if (ops.empty()) {
+      if (lock) {
+        unsigned rev_after_unlock = 0;
+        VINEYARD_DISCARD(lock->Release(rev_after_unlock));
+      }
+      for (auto const& finish : finishes) {
+        VINEYARD_DISCARD(finish(Status::OK()));
+      }
+      finishPersistGroup(std::move(deferred), needs_lock);
+      return;
+    }
+    // commit to etcd
+    std::vector<std::string> keys;
+    keys.reserve(ops.size());
+    for (auto const& op : ops) {
+      keys.emplace_back(op.kv.key);
+      uncommitted_keys_[op.kv.key] += 1;
+    }
+    // a group commits the requests of many traces
+    this->tracedCommitUpdates(ops, 0, [this, finishes, lock, deferred,
+                                       needs_lock, keys](const Status& status,
+                                                         unsigned rev) {
+      for (auto const& key : keys) {
+        auto iter = uncommitted_keys_.find(key);
+        if (iter != uncommitted_keys_.end() && --iter->second == 0) {
+          uncommitted_keys_.erase(iter);
+        }
+      }
+      if (lock) {
+        // update rev_ to the revision after unlock.
+        unsigned rev_after_unlock = 0;
+        VINEYARD_DISCARD(lock->Release(rev_after_unlock));
+      }
+      for (auto const& finish : finishes) {
+        VINEYARD_DISCARD(finish(status));
+      }
+      finishPersistGroup(deferred, needs_lock);
+      return Status::OK();
+    });
+  }
+
+  void finishPersistGroup(std::deque<persist_request_t> deferred,
+                          bool const needs_lock) {
+    {
+      std::lock_guard<std::mutex> scope_lock(persist_mutex_);
+      persist_queue_.insert(persist_queue_.begin(), deferred.begin(),
+                            deferred.end());
+      persist_under_lock_ = needs_lock;
+      if (persist_queue_.empty()) {
+        persisting_ = false;
+        return;
+      }
+    }
+    commitPersistGroup();
+  }
+
+  /**
+   * Whether the ops only touch the keys of objects (and signatures) that
+   * belong to this instance, which no other instance writes.
+   */
+  bool ownedOps(const json& meta, const std::vector<op_t>& ops) {
+    InstanceID const instance_id = server_ptr_->instance_id();
+    std::string const signature_prefix =
+        "/signatures/i" + std::to_string(instance_id) + "/";
+    std::vector<std::string> vs;
+    for (auto const& op : ops) {
+      if (boost::algorithm::starts_with(op.kv.key, signature_prefix)) {
+        continue;
+      }
+      if (!boost::algorithm::starts_with(op.kv.key, "/data/")) {
+        return false;
+      }
+      vs.clear();
+      boost::algorithm::split(vs, op.kv.key,
+                              [](const char c) { return c == '/'; });
+      if (vs.size() < 3) {
+        return false;
+      }
+      auto data = meta.find("data");
+      if (data == meta.end()) {
+        return false;
+      }
+      auto object = data->find(vs[2]);
+      if (object == data->end() || !object->is_object()) {
+        return false;
+      }
+      auto object_instance_id = object->find("instance_id");
+      if (object_instance_id == object->end() ||
+          !object_instance_id->is_number_unsigned() ||
+          object_instance_id->get<InstanceID>() != instance_id) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::mutex persist_mutex_;
+  std::deque<persist_request_t> persist_queue_;
+  bool persisting_ = false;
+  // whether the next group must be committed under the lock
+  bool persist_under_lock_ = false;
+  // persisting objects of this instance skips the lock
+  bool owned_writes_ = false;
+
+  using bulk_update_request_t =
+      std::pair<callback_t<const json&, std::vector<op_t>&, InstanceID&>,
+                callback_t<const InstanceID>>;
+
+  void applyBulkUpdateGroup() {
+    std::deque<bulk_update_request_t> group;
+    {
+      std::lock_guard<std::mutex> scope_lock(bulk_update_mutex_);
+      group.swap(bulk_update_queue_);
+      // the later requests are applied in the next group
+      bulk_updating_ = false;
+    }
+    // the ops of each request are generated against, and applied to, the
+    // tree left by the earlier requests in the group (e.g., the members that
+    // they share), only settling the effects is done once for the group.
+    update_effects_t effects;
+    std::vector<std::pair<callback_t<const InstanceID>, InstanceID>> finishes;
+    for (auto const& request : group) {
+      std::vector<op_t> request_ops;
+      InstanceID computed_instance_id = UnspecifiedInstanceID();
+      auto status = request.first(Status::OK(), meta_, request_ops,
+                                  computed_instance_id);
+      if (!status.ok()) {
+        LOG(ERROR) << status.ToString();
+        VINEYARD_SUPPRESS(request.second(status, computed_instance_id));
+        continue;
+      }
+      this->applyUpdate(request_ops, false, effects);
+      finishes.emplace_back(request.second, computed_instance_id);
+    }
+    if (!finishes.empty()) {
+      this->finishUpdate(effects);
+    }
+    for (auto const& finish : finishes) {
+      VINEYARD_SUPPRESS(finish.first(Status::OK(), finish.second));
+    }
+  }
+
+  std::mutex bulk_update_mutex_;
+  std::deque<bulk_update_request_t> bulk_update_queue_;
+  bool bulk_updating_ = false;
+
   virtual Status preStart() { return Status::OK(); }
 
+  struct object_sync_t;
+
+  void requestObjects(const std::vector<ObjectID>& ids,
+                      callback_t<const json&> callback);
+
+  void fetchObjects(std::shared_ptr<object_sync_t> const& sync,
+                    const std::vector<ObjectID>& ids);
+
   bool deleteable(ObjectID const object_id);
 
   void traverseToDelete(std::set<ObjectID>& initial_delete_set,
@@ -606,13 +985,43 @@ class IMetaService {
                             std::vector<ObjectID>& delete_objects);
 
   void putVal(const kv_t& kv, bool const from_remote);
+  void indexVal(std::string const& key, const json& value);
   void delVal(std::string const& key);
   void delVal(const kv_t& kv);
   void delVal(ObjectID const& target, std::set<ObjectID>& blobs);
 
+  /**
+   * The effects of applied ops that are settled after the tree has been
+   * updated, see also `applyUpdate()` and `finishUpdate()`.
+   */
+  struct update_effects_t {
+    std::set<ObjectID> blobs_to_delete;
+    // blobs that become members of metadata
+    std::set<ObjectID> blobs_referenced;
+    // objects whose metadata cached by clients become stale
+    std::set<ObjectID> objects_to_invalidate;
+    // the keys that the deferred requests may wait for
+    std::unordered_set<std::string> updated_keys;
+  };
+
   template <class RangeT>
   void metaUpdate(const RangeT& ops, bool const from_remote) {
-    std::set<ObjectID> blobs_to_delete;
+    VINEYARD_TRACE_SPAN("IMetaService::metaUpdate");
+    update_effects_t effects;
+    applyUpdate(ops, from_remote, effects);
+    finishUpdate(effects);
+  }
+
+  /**
+   * Apply the ops to the meta tree, the blobs to delete, the objects to
+   * invalidate and the updated keys are accumulated into `effects`.
+   */
+  template <class RangeT>
+  void applyUpdate(const RangeT& ops, bool const from_remote,
+                   update_effects_t& effects) {
+    std::set<ObjectID>& blobs_to_delete = effects.blobs_to_delete;
+    std::set<ObjectID>& objects_to_invalidate = effects.objects_to_invalidate;
+    std::unordered_set<std::string>& updated_keys = effects.updated_keys;
 
     std::vector<op_t> add_sigs, drop_sigs;
     std::vector<op_t> add_datas, drop_datas;
@@ -685,11 +1094,32 @@ class IMetaService {
     // apply adding others
     for (const op_t& op : add_others) {
       putVal(op.kv, from_remote);
+      if (boost::algorithm::starts_with(op.kv.key, "/names/")) {
+        updated_keys.emplace(op.kv.key);
+      }
     }
 
     // apply adding datas
     for (const op_t& op : add_datas) {
       putVal(op.kv, from_remote);
+      // "/data/<object id>/..." or "/data/<object id>"
+      std::string data_key =
+          op.kv.key.substr(0, op.kv.key.find('/', strlen("/data/")));
+      ObjectID data_id = ObjectIDFromString(data_key.substr(strlen("/data/")));
+      if (IsBlob(data_id)) {
+        effects.blobs_referenced.emplace(data_id);
+      }
+      updated_keys.emplace(std::move(data_key));
+      // sealed objects are immutable, except the "transient" field that
+      // changes on persist
+      if (boost::algorithm::ends_with(op.kv.key, "/transient")) {
+        std::vector<std::string> vs;
+        boost::algorithm::split(vs, op.kv.key,
+                                [](const char c) { return c == '/'; });
+        if (vs.size() == 4 && vs[0].empty()) {
+          objects_to_invalidate.emplace(ObjectIDFromString(vs[2]));
+        }
+      }
     }
 
     // apply drop datas
@@ -734,6 +1164,8 @@ class IMetaService {
       for (auto const target : processed_delete_set) {
         delVal(target, blobs_to_delete);
       }
+      objects_to_invalidate.insert(processed_delete_set.begin(),
+                                   processed_delete_set.end());
     }
 
     // apply drop others
@@ -745,17 +1177,26 @@ class IMetaService {
     for (const op_t& op : drop_sigs) {
       delVal(op.kv);
     }
+  }
 
+  /**
+   * Settle the effects of the ops that have been applied, i.e., invalidate
+   * the cached metadata, delete the blobs and wake up the deferred requests.
+   */
+  void finishUpdate(const update_effects_t& effects) {
 #ifndef NDEBUG
     // debugging
     printDepsGraph();
-    for (auto const& id : blobs_to_delete) {
+    for (auto const& id : effects.blobs_to_delete) {
       LOG(INFO) << "blob to delete: " << ObjectIDToString(id);
     }
 #endif
 
-    VINEYARD_SUPPRESS(server_ptr_->DeleteBlobBatch(blobs_to_delete));
-    VINEYARD_SUPPRESS(server_ptr_->ProcessDeferred(meta_));
+    server_ptr_->InvalidateObjects(effects.objects_to_invalidate);
+    server_ptr_->ReferenceBlobsByMeta(effects.blobs_referenced);
+    VINEYARD_SUPPRESS(server_ptr_->DeleteBlobBatch(effects.blobs_to_delete));
+    VINEYARD_SUPPRESS(
+        server_ptr_->ProcessDeferred(meta_, effects.updated_keys));
   }
 
   void instanceUpdate(const op_t& op) {
@@ -794,18 +1235,38 @@ class IMetaService {
     if (ops.empty()) {
       return callback_after_update(Status::OK(), rev);
     }
-    // process events grouped by revision
+    // process events grouped by revision, consecutive revisions that touch
+    // different keys are applied in one update, to avoid traversing the meta
+    // tree and the deferred requests for every revision.
     size_t idx = 0;
+    unsigned batch_rev = rev_;
     std::vector<op_t> op_batch;
+    std::unordered_set<std::string> batch_keys;
     while (idx < ops.size()) {
       unsigned head_index = ops[idx].kv.rev;
-      while (idx < ops.size() && ops[idx].kv.rev == head_index) {
+      size_t end = idx;
+      bool conflict = false;
+      while (end < ops.size() && ops[end].kv.rev == head_index) {
+        conflict = conflict || batch_keys.find(ops[end].kv.key) !=
+                                   batch_keys.end();
+        end += 1;
+      }
+      if (conflict) {
+        // the later revision overrides keys in the batch, applied in order
+        metaUpdate(op_batch, true);
+        rev_ = batch_rev;
+        op_batch.clear();
+        batch_keys.clear();
+      }
+      for (; idx < end; ++idx) {
+        batch_keys.emplace(ops[idx].kv.key);
         op_batch.emplace_back(ops[idx]);
-        idx += 1;
       }
+      batch_rev = head_index;
+    }
+    if (!op_batch.empty()) {
       metaUpdate(op_batch, true);
-      op_batch.clear();
-      rev_ = head_index;
+      rev_ = batch_rev;
     }
     return callback_after_update(Status::OK(), rev);
   }
@@ -815,10 +1276,14 @@ class IMetaService {
   int64_t target_latest_time_ = 0;
   size_t timeout_count_ = 0;
 
+  // adjacency sets, an object without edges has no entry in the graph
+  using dependency_graph_t =
+      std::unordered_map<ObjectID, std::unordered_set<ObjectID>>;
+
   // dependency: object id -> members' object id
-  std::multimap<ObjectID, ObjectID> subobjects_;
+  dependency_graph_t subobjects_;
   // dependency: object id -> ancestors' object id
-  std::multimap<ObjectID, ObjectID> supobjects_;
+  dependency_graph_t supobjects_;
 };
 
 }  // namespace vineyard
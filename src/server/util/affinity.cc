@@ -0,0 +1,121 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/util/affinity.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include <cstring>
+
+#include "boost/algorithm/string.hpp"
+
+namespace vineyard {
+
+#if defined(CPU_SETSIZE)
+static constexpr int kMaxCPUs = CPU_SETSIZE;
+#else
+static constexpr int kMaxCPUs = 1024;
+#endif
+
+static Status parse_cpu(const std::string& value, int& cpu) {
+  size_t consumed = 0;
+  try {
+    cpu = std::stoi(value, &consumed);
+  } catch (...) {
+    consumed = 0;
+  }
+  if (value.empty() || consumed != value.size() || cpu < 0 ||
+      cpu >= kMaxCPUs) {
+    return Status::Invalid("Invalid CPU '" + value + "'");
+  }
+  return Status::OK();
+}
+
+Status parse_cpu_list(const std::string& list, std::vector<int>& cpus) {
+  std::vector<std::string> items;
+  boost::split(items, list, boost::is_any_of(","));
+  for (auto& item : items) {
+    boost::trim(item);
+    if (item.empty()) {
+      continue;
+    }
+    auto dash = item.find('-');
+    int first = 0, last = 0;
+    RETURN_ON_ERROR(parse_cpu(boost::trim_copy(item.substr(0, dash)), first));
+    if (dash == std::string::npos) {
+      last = first;
+    } else {
+      RETURN_ON_ERROR(parse_cpu(boost::trim_copy(item.substr(dash + 1)), last));
+    }
+    if (first > last) {
+      return Status::Invalid("Invalid CPU range '" + item + "'");
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.emplace_back(cpu);
+    }
+  }
+  if (cpus.empty()) {
+    return Status::Invalid("The CPU list '" + list + "' is empty");
+  }
+  return Status::OK();
+}
+
+Status parse_cpu_affinity(const std::string& spec,
+                          std::map<std::string, std::vector<int>>& affinity) {
+  std::vector<std::string> items;
+  boost::split(items, spec, boost::is_any_of(";"));
+  for (auto& item : items) {
+    boost::trim(item);
+    if (item.empty()) {
+      continue;
+    }
+    auto equal = item.find('=');
+    if (equal == std::string::npos) {
+      return Status::Invalid("Expect 'role=cpu-list' in the CPU affinity, "
+                             "but got '" +
+                             item + "'");
+    }
+    auto role = boost::trim_copy(item.substr(0, equal));
+    std::vector<int> cpus;
+    RETURN_ON_ERROR(parse_cpu_list(item.substr(equal + 1), cpus));
+    affinity[role] = std::move(cpus);
+  }
+  return Status::OK();
+}
+
+Status pin_thread(pthread_t thread, const std::vector<int>& cpus) {
+  if (cpus.empty()) {
+    return Status::OK();
+  }
+#if defined(__linux__)
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  for (int cpu : cpus) {
+    CPU_SET(cpu, &cpuset);
+  }
+  int ret = pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpuset);
+  if (ret != 0) {
+    return Status::IOError("Failed to set the CPU affinity: " +
+                           std::string(strerror(ret)));
+  }
+  return Status::OK();
+#else
+  return Status::NotImplemented("CPU affinity is only supported on linux");
+#endif
+}
+
+}  // namespace vineyard
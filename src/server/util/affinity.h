@@ -0,0 +1,53 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_UTIL_AFFINITY_H_
+#define SRC_SERVER_UTIL_AFFINITY_H_
+
+#include <pthread.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief Parse the CPU list of the format of `taskset -c`, e.g., "0-3,8,10".
+ */
+Status parse_cpu_list(const std::string& list, std::vector<int>& cpus);
+
+/**
+ * @brief Parse the CPUs of the thread roles of the format
+ *
+ *    role=cpu-list;role=cpu-list;...
+ *
+ * e.g., "worker=0-7;ipc=8-11;meta=12".
+ */
+Status parse_cpu_affinity(const std::string& spec,
+                          std::map<std::string, std::vector<int>>& affinity);
+
+/**
+ * @brief Restrict the thread to run on the given CPUs, does nothing when the
+ * CPUs are empty. The threads that are created by the thread afterwards
+ * inherit the affinity.
+ */
+Status pin_thread(pthread_t thread, const std::vector<int>& cpus);
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_AFFINITY_H_
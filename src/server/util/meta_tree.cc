@@ -17,14 +17,21 @@ limitations under the License.
 
 #include <fnmatch.h>
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <regex>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "boost/lexical_cast.hpp"
 
+#include "common/util/compression.h"
+
 namespace boost {
 // Makes the behaviour of lexical_cast compatibile with boost::property_tree.
 template <>
@@ -146,50 +153,86 @@ static void generate_link(const std::string& type, const std::string& name,
   link = ss.str();
 }
 
+/**
+ * Walk the tree along the keys in `prefix` (e.g., "/data") and then `name`,
+ * without building json pointers or copying the nodes on the path.
+ */
+static const json* find_sub_tree(const json& tree, const std::string& prefix,
+                                 const std::string& name) {
+  const json* node = &tree;
+  auto step = [&node](const char* key, size_t const length) -> bool {
+    if (!node->is_object()) {
+      return false;
+    }
+    auto iter = node->find(std::string(key, length));
+    if (iter == node->end()) {
+      return false;
+    }
+    node = &(*iter);
+    return true;
+  };
+  size_t begin = 0;
+  while (begin < prefix.size()) {
+    if (prefix[begin] == '/') {
+      begin += 1;
+      continue;
+    }
+    size_t end = std::min(prefix.find('/', begin), prefix.size());
+    if (!step(prefix.c_str() + begin, end - begin)) {
+      return nullptr;
+    }
+    begin = end;
+  }
+  if (!name.empty() && !step(name.c_str(), name.size())) {
+    return nullptr;
+  }
+  return node;
+}
+
 static Status get_sub_tree(const json& tree, const std::string& prefix,
-                           const std::string& name, json& sub_tree) {
+                           const std::string& name, const json*& sub_tree) {
   if (name.find('/') != std::string::npos) {
     LOG(ERROR) << "meta tree name invalid. " << name;
     return Status::MetaTreeNameInvalid("metadata for '" + name +
                                        "' cannot be found");
   }
-  std::string path = prefix;
-  if (!name.empty()) {
-    path += "/" + name;
-  }
-  auto json_path = json::json_pointer(path);
-  if (tree.contains(json_path)) {
-    auto const& tmp_tree = tree[json_path];
-    if (tmp_tree.is_object() && !tmp_tree.empty()) {
-      sub_tree = tmp_tree;
-      return Status::OK();
-    }
+  sub_tree = find_sub_tree(tree, prefix, name);
+  if (sub_tree != nullptr && sub_tree->is_object() && !sub_tree->empty()) {
+    return Status::OK();
   }
+  sub_tree = nullptr;
   return Status::MetaTreeSubtreeNotExists("get subtree failed: " + name);
 }
 
+static Status get_sub_tree(const json& tree, const std::string& prefix,
+                           const std::string& name, json& sub_tree) {
+  const json* node = nullptr;
+  RETURN_ON_ERROR(get_sub_tree(tree, prefix, name, node));
+  sub_tree = *node;
+  return Status::OK();
+}
+
 static bool has_sub_tree(const json& tree, const std::string& prefix,
                          const std::string& name) {
   if (name.find('/') != std::string::npos) {
     return false;
   }
-  std::string path = prefix;
-  if (!name.empty()) {
-    path += "/" + name;
-  }
-  return tree.contains(json::json_pointer(path));
+  return find_sub_tree(tree, prefix, name) != nullptr;
 }
 
 static std::string object_id_from_signature(const json& tree,
                                             const std::string& instance_name,
                                             const std::string& signature) {
-  auto signature_key =
-      json::json_pointer("/signatures/" + instance_name + "/" + signature);
-  if (tree.contains(signature_key)) {
-    return tree[signature_key].get_ref<std::string const&>();
-  }
   auto iter = tree.find("signatures");
   if (iter != tree.end()) {
+    // looks up the signatures of the given instance first
+    auto local = iter->find(instance_name);
+    if (local != iter->end()) {
+      auto val = local->find(signature);
+      if (val != local->end()) {
+        return val->get_ref<std::string const&>();
+      }
+    }
     for (auto const& item : json::iterator_wrapper(*iter)) {
       auto val = item.value().find(signature);
       if (val != item.value().end()) {
@@ -274,7 +317,20 @@ static bool is_meta_placeholder(const json& tree) {
 Status GetData(const json& tree, const std::string& instance_name,
                const ObjectID id, json& sub_tree,
                InstanceID const& current_instance_id) {
-  return GetData(tree, instance_name, ObjectIDToString(id), sub_tree,
+  return GetData(tree, instance_name, ObjectIDToString(id), -1, sub_tree,
+                 current_instance_id);
+}
+
+Status GetData(const json& tree, const std::string& instance_name,
+               const std::string& name, json& sub_tree,
+               InstanceID const& current_instance_id) {
+  return GetData(tree, instance_name, name, -1, sub_tree, current_instance_id);
+}
+
+Status GetData(const json& tree, const std::string& instance_name,
+               const ObjectID id, int const depth, json& sub_tree,
+               InstanceID const& current_instance_id) {
+  return GetData(tree, instance_name, ObjectIDToString(id), depth, sub_tree,
                  current_instance_id);
 }
 
@@ -282,15 +338,15 @@ Status GetData(const json& tree, const std::string& instance_name,
  * Get metadata for an object "recursively".
  */
 Status GetData(const json& tree, const std::string& instance_name,
-               const std::string& name, json& sub_tree,
+               const std::string& name, int const depth, json& sub_tree,
                InstanceID const& current_instance_id) {
-  json tmp_tree;
+  const json* tmp_tree = nullptr;
   sub_tree.clear();
   Status status = get_sub_tree(tree, "/data", name, tmp_tree);
   if (!status.ok()) {
     return status;
   }
-  for (auto const& item : json::iterator_wrapper(tmp_tree)) {
+  for (auto const& item : json::iterator_wrapper(*tmp_tree)) {
     if (!item.value().is_string()) {
       sub_tree[item.key()] = item.value();
       continue;
@@ -300,7 +356,7 @@ Status GetData(const json& tree, const std::string& instance_name,
     std::string value;
     decode_value(item_value, type, value);
     if (type == NodeType::Value) {
-      sub_tree[item.key()] = value;
+      sub_tree[item.key()] = std::move(value);
     } else if (type == NodeType::Link) {
       InstanceID instance_id = UnspecifiedInstanceID();
       std::string sub_sub_tree_type, sub_sub_tree_name;
@@ -317,11 +373,17 @@ Status GetData(const json& tree, const std::string& instance_name,
         sub_tree.clear();
         return status;
       }
+      if (depth == 0 && !IsBlob(ObjectIDFromString(sub_sub_tree_name))) {
+        // left to be resolved by the client on demand
+        sub_tree[item.key()] = json{{"id", sub_sub_tree_name}};
+        continue;
+      }
       json sub_sub_tree;
-      status = GetData(tree, instance_name, sub_sub_tree_name, sub_sub_tree,
+      status = GetData(tree, instance_name, sub_sub_tree_name,
+                       depth < 0 ? depth : depth - 1, sub_sub_tree,
                        current_instance_id);
       if (status.ok()) {
-        sub_tree[item.key()] = sub_sub_tree;
+        sub_tree[item.key()] = std::move(sub_sub_tree);
       } else {
         ObjectID sub_sub_tree_id = ObjectIDFromString(sub_sub_tree_name);
         if (IsBlob(sub_sub_tree_id) && status.IsMetaTreeSubtreeNotExists()) {
@@ -332,7 +394,7 @@ Status GetData(const json& tree, const std::string& instance_name,
           sub_sub_tree["nbytes"] = 0;
           sub_sub_tree["instance_id"] = instance_id;
           sub_sub_tree["transient"] = true;
-          sub_tree[item.key()] = sub_sub_tree;
+          sub_tree[item.key()] = std::move(sub_sub_tree);
         } else {
           sub_tree.clear();
           return status;
@@ -348,37 +410,126 @@ Status GetData(const json& tree, const std::string& instance_name,
   return Status::OK();
 }
 
-Status ListData(const json& tree, const std::string& instance_name,
-                std::string const& pattern, bool const regex,
-                size_t const limit, json& tree_group) {
-  if (!tree.contains("data")) {
+Status ListData(const json& tree, const TypeIndex& index,
+                const std::string& instance_name, std::string const& pattern,
+                bool const regex, size_t const limit, json& tree_group) {
+  if (!tree.contains("data") || limit == 0) {
     return Status::OK();
   }
 
   size_t found = 0;
+  Status status;
+  // match type on pattern
+  index.Match(pattern, regex,
+              [&](std::string const& name, std::string const&) -> bool {
+                json object_meta_tree;
+                status = GetData(tree, instance_name, name, object_meta_tree);
+                if (!status.ok()) {
+                  return false;
+                }
+                tree_group[name] = object_meta_tree;
+                found += 1;
+                return found < limit;
+              });
+  return status;
+}
 
-  for (auto const& item : json::iterator_wrapper(tree["data"])) {
-    if (found >= limit) {
-      break;
-    }
+const std::string kCreatedAtKey = "__created_at";
 
-    if (!item.value().is_object() || item.value().empty()) {
-      LOG(INFO) << "Object meta shouldn't be empty";
-      return Status::MetaTreeInvalid();
-    }
-    std::string type;
-    RETURN_ON_ERROR(get_type(item.value(), type, true));
+/**
+ * The number of objects that a page of `ListDataPage` scans at most, which
+ * bounds the latency of a page when the filters are selective.
+ */
+static const size_t kListDataPageScanLimit = 64 * 1024;
+
+static bool match_filters(const json& meta, const json& filters) {
+  if (filters.contains("instance_id") &&
+      meta.value("instance_id", UnspecifiedInstanceID()) !=
+          filters["instance_id"].get<InstanceID>()) {
+    return false;
+  }
+  int64_t created_at = meta.value(kCreatedAtKey, static_cast<int64_t>(0));
+  if (filters.contains("created_after") &&
+      created_at < filters["created_after"].get<int64_t>()) {
+    return false;
+  }
+  if (filters.contains("created_before") &&
+      created_at > filters["created_before"].get<int64_t>()) {
+    return false;
+  }
+  size_t nbytes = meta.value("nbytes", static_cast<size_t>(0));
+  if (filters.contains("min_nbytes") &&
+      nbytes < filters["min_nbytes"].get<size_t>()) {
+    return false;
+  }
+  if (filters.contains("max_nbytes") &&
+      nbytes > filters["max_nbytes"].get<size_t>()) {
+    return false;
+  }
+  return true;
+}
 
-    // match type on pattern
-    if (MatchTypeName(regex, pattern, type)) {
-      found += 1;
-      json object_meta_tree;
-      RETURN_ON_ERROR(
-          GetData(tree, instance_name, item.key(), object_meta_tree));
-      tree_group[item.key()] = object_meta_tree;
+Status ListDataPage(const json& tree, const TypeIndex& index,
+                    const std::string& instance_name,
+                    const std::string& pattern, bool const regex,
+                    size_t const limit, const json& filters,
+                    const std::vector<std::string>& fields,
+                    const std::string& cursor, std::vector<ObjectID>& ids,
+                    json& projections, std::string& next_cursor) {
+  next_cursor.clear();
+  if (!tree.contains("data") || limit == 0) {
+    return Status::OK();
+  }
+
+  // the cursor is "<name>.<type>", where the name has no dot
+  std::string after_type, after_name;
+  if (!cursor.empty()) {
+    std::string::size_type dot = cursor.find('.');
+    if (dot == std::string::npos) {
+      return Status::Invalid("Invalid cursor of listing: '" + cursor + "'");
     }
+    after_name = cursor.substr(0, dot);
+    after_type = cursor.substr(dot + 1);
   }
-  return Status::OK();
+
+  bool const need_meta = !filters.empty() || !fields.empty();
+  size_t scanned = 0;
+  Status status;
+  index.Match(
+      pattern, regex, after_type, after_name,
+      [&](std::string const& name, std::string const& type) -> bool {
+        scanned += 1;
+        json meta;
+        if (need_meta) {
+          status = GetData(tree, instance_name, name, 0, meta);
+          if (!status.ok()) {
+            return false;
+          }
+        }
+        if (filters.empty() || match_filters(meta, filters)) {
+          ObjectID id = ObjectIDFromString(name);
+          ids.emplace_back(id);
+          if (!fields.empty()) {
+            json projection;
+            for (auto const& field : fields) {
+              auto iter = meta.find(field);
+              if (iter != meta.end()) {
+                projection[field] = *iter;
+              }
+            }
+            projections[name] = projection;
+          }
+        }
+        if (ids.size() >= limit || scanned >= kListDataPageScanLimit) {
+          next_cursor = name + "." + type;
+          return false;
+        }
+        return true;
+      });
+  if (!status.ok()) {
+    next_cursor.clear();
+  }
+  return status;
 }
 
 Status ListAllData(const json& tree, std::vector<ObjectID>& objects) {
@@ -451,6 +602,13 @@ Status DelDataOps(const json& tree, const std::string& name,
           SignatureToString(data["signature"].get<Signature>());
       ops.emplace_back(IMetaService::op_t::Del("/signatures/i" + instance_name +
                                                "/" + signature));
+      // drop the names that are scoped to the object, which live in etcd
+      std::vector<std::pair<std::string, ObjectID>> scoped_names;
+      ScopedNames(tree, ObjectIDFromString(name), scoped_names);
+      for (auto const& item : scoped_names) {
+        ops.emplace_back(IMetaService::op_t::Del("/names/" + item.first));
+        sync_remote = true;
+      }
       // record deletion of object
       LOG_SUMMARY(
           "object",
@@ -463,6 +621,25 @@ Status DelDataOps(const json& tree, const std::string& name,
   return Status::MetaTreeSubtreeNotExists("delete subtree failed: " + name);
 }
 
+void ScopedNames(const json& tree, const ObjectID owner,
+                 std::vector<std::pair<std::string, ObjectID>>& names) {
+  auto iter = tree.find("names");
+  if (iter == tree.end() || !iter->is_object()) {
+    return;
+  }
+  // the names are ordered, thus the scoped names of an object are adjacent
+  std::string const prefix = ScopedName(owner, "");
+  auto const& entries = iter->get_ref<const json::object_t&>();
+  for (auto entry = entries.lower_bound(prefix);
+       entry != entries.end() &&
+       entry->first.compare(0, prefix.size(), prefix) == 0;
+       ++entry) {
+    if (entry->second.is_number()) {
+      names.emplace_back(entry->first, entry->second.get<ObjectID>());
+    }
+  }
+}
+
 static void generate_put_ops(const json& meta, std::string const& instance_name,
                              const json& diff, const json& signatures,
                              const std::string& name,
@@ -872,45 +1049,60 @@ Status ShallowCopyOps(const json& tree, const ObjectID id,
                       const json& extra_metadata, const ObjectID target,
                       std::vector<IMetaService::op_t>& ops, bool& transient) {
   std::string name = ObjectIDToString(id);
-  json tmp_tree;
+  const json* tmp_tree = nullptr;
   RETURN_ON_ERROR(get_sub_tree(tree, "/data", name, tmp_tree));
   RETURN_ON_ASSERT(
-      tmp_tree.contains("transient") && tmp_tree["transient"].is_boolean(),
+      tmp_tree->contains("transient") && (*tmp_tree)["transient"].is_boolean(),
       "The 'transient' should a plain bool value");
   RETURN_ON_ASSERT(extra_metadata.is_object(),
                    "The 'extra_metadata' must be a dict");
+  std::string key_prefix =
+      "/data" + std::string("/") + ObjectIDToString(target) + "/";
+  // The copy re-emits the fields of the source, including the member links,
+  // thus it depends on the members rather than on the source, and deleting
+  // either of them leaves the other one intact. The fields are emitted from
+  // the source directly, rather than from a deep copy of its subtree.
+  for (auto const& item : json::iterator_wrapper(*tmp_tree)) {
+    if (extra_metadata.contains(item.key())) {
+      continue;
+    }
+    ops.emplace_back(
+        IMetaService::op_t::Put(key_prefix + item.key(), item.value()));
+  }
+  transient = (*tmp_tree)["transient"].get<bool>();
   for (auto const& item : json::iterator_wrapper(extra_metadata)) {
     RETURN_ON_ASSERT(
         item.value().is_primitive(),
         "The value of items in 'extra_metadata' must be primitives");
+    if (item.key() == "transient") {
+      RETURN_ON_ASSERT(item.value().is_boolean(),
+                       "The 'transient' should a plain bool value");
+      transient = item.value().get<bool>();
+    }
     if (item.value().is_string()) {
       std::string encoded_value;
       encode_value(NodeType::Value, item.value().get_ref<std::string const&>(),
                    encoded_value);
-      tmp_tree[item.key()] = encoded_value;
+      ops.emplace_back(
+          IMetaService::op_t::Put(key_prefix + item.key(), encoded_value));
     } else {
-      tmp_tree[item.key()] = item.value();
+      ops.emplace_back(
+          IMetaService::op_t::Put(key_prefix + item.key(), item.value()));
     }
   }
-  transient = tmp_tree["transient"].get<bool>();
-  std::string key_prefix =
-      "/data" + std::string("/") + ObjectIDToString(target) + "/";
-  for (auto const& item : json::iterator_wrapper(tmp_tree)) {
-    ops.emplace_back(
-        IMetaService::op_t::Put(key_prefix + item.key(), item.value()));
-  }
   return Status::OK();
 }
 
 Status IfPersist(const json& tree, const ObjectID id, bool& persist) {
   std::string name = ObjectIDToString(id);
-  json tmp_tree;
+  const json* tmp_tree = nullptr;
   Status status = get_sub_tree(tree, "/data", name, tmp_tree);
   if (status.ok()) {
+    auto transient = tmp_tree->find("transient");
     RETURN_ON_ASSERT(
-        tmp_tree.contains("transient") && tmp_tree["transient"].is_boolean(),
+        transient != tmp_tree->end() && transient->is_boolean(),
         "The 'transient' should a plain boolean value");
-    persist = !tmp_tree["transient"].get<bool>();
+    persist = !transient->get<bool>();
   }
   return status;
 }
@@ -930,6 +1122,73 @@ Status FilterAtInstance(const json& tree, const InstanceID& instance_id,
   return Status::OK();
 }
 
+Status ListRootObjects(const json& tree, const std::string& instance_name,
+                       std::vector<RootObject>& roots) {
+  roots.clear();
+  auto data = tree.find("data");
+  if (data == tree.end() || !data->is_object()) {
+    return Status::OK();
+  }
+
+  std::unordered_map<ObjectID, std::vector<ObjectID>> members;
+  std::unordered_set<ObjectID> referenced;
+  for (auto const& item : json::iterator_wrapper(*data)) {
+    ObjectID id = ObjectIDFromString(item.key());
+    if (IsBlob(id) || !item.value().is_object()) {
+      continue;
+    }
+    auto& object_members = members[id];
+    for (auto const& field : json::iterator_wrapper(item.value())) {
+      if (!field.value().is_string()) {
+        continue;
+      }
+      std::string const& value = field.value().get_ref<std::string const&>();
+      ObjectID member = InvalidObjectID();
+      if (!value.empty() && is_link_node(value) &&
+          DecodeObjectID(tree, instance_name, value, member).ok()) {
+        object_members.emplace_back(member);
+        referenced.emplace(member);
+      }
+    }
+  }
+
+  std::unordered_set<ObjectID> collected;
+  for (auto const& item : json::iterator_wrapper(*data)) {
+    ObjectID id = ObjectIDFromString(item.key());
+    if (IsBlob(id) || !item.value().is_object() || referenced.count(id)) {
+      continue;
+    }
+    RootObject root;
+    root.id = id;
+    VINEYARD_DISCARD(get_type(item.value(), root.type_name, true));
+    root.instance_id =
+        item.value().value("instance_id", UnspecifiedInstanceID());
+
+    std::unordered_set<ObjectID> visited{id};
+    std::vector<ObjectID> pending(members[id]);
+    while (!pending.empty()) {
+      ObjectID member = pending.back();
+      pending.pop_back();
+      if (!visited.emplace(member).second) {
+        continue;
+      }
+      if (IsBlob(member)) {
+        if (collected.emplace(member).second) {
+          root.blobs.emplace_back(member);
+        }
+        continue;
+      }
+      auto iter = members.find(member);
+      if (iter != members.end()) {
+        pending.insert(pending.end(), iter->second.begin(),
+                       iter->second.end());
+      }
+    }
+    roots.emplace_back(std::move(root));
+  }
+  return Status::OK();
+}
+
 Status DecodeObjectID(const json& tree, const std::string& instance_name,
                       const std::string& value, ObjectID& object_id) {
   meta_tree::NodeType type;
@@ -958,11 +1217,12 @@ Status DecodeObjectID(const json& tree, const std::string& instance_name,
 bool HasEquivalent(const json& tree, ObjectID const object_id,
                    ObjectID& equivalent) {
   std::string object_name = ObjectIDToString(object_id);
-  auto path = json::json_pointer("/data/" + object_name + "/signature");
-  if (!tree.contains(path)) {
+  const json* object = find_sub_tree(tree, "/data", object_name);
+  if (object == nullptr || !object->contains("signature")) {
     return false;
   }
-  std::string signature = SignatureToString(tree[path].get<Signature>());
+  std::string signature =
+      SignatureToString((*object)["signature"].get<Signature>());
   json::const_iterator signatures = tree.find("signatures");
   if (signatures == tree.end()) {
     return false;
@@ -1008,6 +1268,118 @@ std::string EncodeValue(std::string const& value) {
   return encoded_value;
 }
 
+/// The packed values start with a byte that never starts a JSON text,
+/// followed by the encoding, 'm' for msgpack and 'z' for zstd over msgpack.
+static constexpr char kPackedValueMagic = '\0';
+
+/// Smaller values are hardly shrunk by compression.
+static constexpr size_t kPackedValueCompressionThreshold = 256;
+
+static std::string pack_value(const json& object) {
+  std::vector<uint8_t> content = json::to_msgpack(object);
+  std::string packed(1, kPackedValueMagic);
+#if defined(WITH_ZSTD)
+  if (content.size() >= kPackedValueCompressionThreshold &&
+      content.size() <= kCompressionChunkSize) {
+    std::string frame;
+    if (CompressFrame("zstd", content.data(), content.size(), frame).ok()) {
+      packed.push_back('z');
+      packed.append(frame);
+      return packed;
+    }
+  }
+#endif
+  packed.push_back('m');
+  packed.append(content.begin(), content.end());
+  return packed;
+}
+
+void PackDataOps(const std::vector<IMetaService::op_t>& ops,
+                 std::vector<IMetaService::op_t>& packed) {
+  std::string const data_prefix = "/data/";
+  // the object of the field puts, and the index of the last put of objects
+  std::vector<std::string> names(ops.size());
+  std::unordered_map<std::string, json> objects;
+  std::unordered_map<std::string, size_t> last_puts;
+  std::unordered_set<std::string> unpackable;
+  for (size_t index = 0; index < ops.size(); ++index) {
+    auto const& op = ops[index];
+    if (op.kv.key.compare(0, data_prefix.size(), data_prefix) != 0) {
+      continue;
+    }
+    size_t sep = op.kv.key.find('/', data_prefix.size());
+    std::string name = op.kv.key.substr(
+        data_prefix.size(),
+        sep == std::string::npos ? std::string::npos
+                                 : sep - data_prefix.size());
+    if (op.op != IMetaService::op_t::kPut || sep == std::string::npos ||
+        op.kv.key.find('/', sep + 1) != std::string::npos) {
+      // keep the order of the puts with the deletes of the same object
+      unpackable.emplace(name);
+      continue;
+    }
+    json value = json::parse(op.kv.value, nullptr, false);
+    if (value.is_discarded()) {
+      unpackable.emplace(name);
+      continue;
+    }
+    objects[name][op.kv.key.substr(sep + 1)] = std::move(value);
+    last_puts[name] = index;
+    names[index] = name;
+  }
+  // only the new objects are packed, as the other puts update some of the
+  // fields of the existing objects, e.g., "transient" on persist
+  for (auto iter = objects.begin(); iter != objects.end();) {
+    if (unpackable.find(iter->first) != unpackable.end() ||
+        !iter->second.contains("typename") ||
+        !iter->second.contains("transient")) {
+      iter = objects.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+
+  packed.clear();
+  packed.reserve(ops.size());
+  for (size_t index = 0; index < ops.size(); ++index) {
+    auto const& name = names[index];
+    auto object = name.empty() ? objects.end() : objects.find(name);
+    if (object == objects.end()) {
+      packed.emplace_back(ops[index]);
+    } else if (last_puts[name] == index) {
+      // the last put follows the puts of the members
+      packed.emplace_back(IMetaService::op_t::Put(
+          data_prefix + name, pack_value(object->second), 0));
+    }
+  }
+}
+
+Status DecodeStoredValue(const std::string& value, json& decoded) {
+  if (value.empty() || value[0] != kPackedValueMagic) {
+    decoded = json::parse(value, nullptr, false);
+  } else if (value.size() >= 2 && value[1] == 'm') {
+    decoded = json::from_msgpack(value.begin() + 2, value.end(), true, false);
+  } else if (value.size() >= 2 + sizeof(CompressionFrameHeader) &&
+             value[1] == 'z') {
+    CompressionFrameHeader header;
+    memcpy(&header, value.data() + 2, sizeof(CompressionFrameHeader));
+    size_t const offset = 2 + sizeof(CompressionFrameHeader);
+    RETURN_ON_ASSERT(value.size() - offset == header.compressed_size,
+                     "The packed value is truncated");
+    std::vector<uint8_t> content(header.content_size);
+    RETURN_ON_ERROR(DecompressFrame(
+        "zstd", header, reinterpret_cast<const uint8_t*>(value.data()) + offset,
+        content.data()));
+    decoded = json::from_msgpack(content, true, false);
+  } else {
+    return Status::MetaTreeInvalid("Unknown encoding of the stored value");
+  }
+  if (decoded.is_discarded()) {
+    return Status::MetaTreeInvalid("Failed to decode the stored value");
+  }
+  return Status::OK();
+}
+
 }  // namespace meta_tree
 
 }  // namespace vineyard
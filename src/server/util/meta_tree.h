@@ -19,12 +19,20 @@ limitations under the License.
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "server/services/meta_service.h"
 
 namespace vineyard {
 
+/**
+ * The meta tree is kept as the JSON document that mirrors the keys in the
+ * metadata backend (e.g., "/data/<name>/<field>"), there's no separate
+ * structured store behind these functions. Lookups walk the document in
+ * place (without copying subtrees), and listing by type names goes through
+ * the `TypeIndex` that is maintained along with the tree.
+ */
 namespace meta_tree {
 
 enum class NodeType {
@@ -39,9 +47,47 @@ Status GetData(const json& tree, const std::string& instance_name,
 Status GetData(const json& tree, const std::string& instance_name,
                const std::string& name, json& sub_tree,
                InstanceID const& current_instance_id = UnspecifiedInstanceID());
-Status ListData(const json& tree, const std::string& instance_name,
-                const std::string& pattern, bool const regex,
-                size_t const limit, json& tree_group);
+/**
+ * Members (except blobs) nested more than `depth` levels are returned as
+ * placeholders `{"id": ...}`, a negative `depth` means unlimited.
+ */
+Status GetData(const json& tree, const std::string& instance_name,
+               const ObjectID id, int const depth, json& sub_tree,
+               InstanceID const& current_instance_id = UnspecifiedInstanceID());
+Status GetData(const json& tree, const std::string& instance_name,
+               const std::string& name, int const depth, json& sub_tree,
+               InstanceID const& current_instance_id = UnspecifiedInstanceID());
+Status ListData(const json& tree, const TypeIndex& index,
+                const std::string& instance_name, const std::string& pattern,
+                bool const regex, size_t const limit, json& tree_group);
+/**
+ * The key of the creation time of objects, in microseconds since the epoch,
+ * which is stamped by the server when the metadata is created.
+ */
+extern const std::string kCreatedAtKey;
+
+/**
+ * List a page of at most `limit` objects whose type name matches the pattern
+ * and which satisfy the `filters`, resuming after the `cursor` of the last
+ * page (empty for the first page).
+ *
+ * The filters are optional: "instance_id", "created_after" and
+ * "created_before" (in microseconds since the epoch, inclusive), "min_nbytes"
+ * and "max_nbytes" (inclusive). Only the ids are returned, with the
+ * top-level `fields` of each object in `projections` (keyed by the id) when
+ * any field is requested.
+ *
+ * A page stops scanning after a bounded number of objects, thus a page with
+ * selective filters may be short (even empty) while there are still objects
+ * remained, and the listing ends when the `next_cursor` is empty.
+ */
+Status ListDataPage(const json& tree, const TypeIndex& index,
+                    const std::string& instance_name,
+                    const std::string& pattern, bool const regex,
+                    size_t const limit, const json& filters,
+                    const std::vector<std::string>& fields,
+                    const std::string& cursor, std::vector<ObjectID>& ids,
+                    json& projections, std::string& next_cursor);
 Status ListAllData(const json& tree, std::vector<ObjectID>& objects);
 Status IfPersist(const json& tree, const ObjectID id, bool& persist);
 Status Exists(const json& tree, const ObjectID id, bool& exists);
@@ -66,6 +112,13 @@ Status DelDataOps(const json& tree, const std::vector<ObjectID>& ids,
 Status DelDataOps(const json& tree, const std::string& name,
                   std::vector<IMetaService::op_t>& ops, bool& sync_remote);
 
+/**
+ * @brief The names that are scoped to the owner object, and the objects that
+ * they are associated with, see also `ScopedName()`.
+ */
+void ScopedNames(const json& tree, const ObjectID owner,
+                 std::vector<std::pair<std::string, ObjectID>>& names);
+
 Status ShallowCopyOps(const json& tree, const ObjectID id,
                       const json& extra_metadata, const ObjectID target,
                       std::vector<IMetaService::op_t>& ops, bool& transient);
@@ -73,6 +126,22 @@ Status ShallowCopyOps(const json& tree, const ObjectID id,
 Status FilterAtInstance(const json& tree, const InstanceID& instance_id,
                         std::vector<ObjectID>& objects);
 
+struct RootObject {
+  ObjectID id;
+  std::string type_name;
+  InstanceID instance_id;
+  std::vector<ObjectID> blobs;
+};
+
+/**
+ * The outermost objects, i.e., the objects that aren't a member of any other
+ * object, with the blobs they reference directly or through their members.
+ * A blob that is shared by many outermost objects is collected to the first
+ * one of them (in the order of object ids) only.
+ */
+Status ListRootObjects(const json& tree, const std::string& instance_name,
+                       std::vector<RootObject>& roots);
+
 Status DecodeObjectID(const json& tree, const std::string& instance_name,
                       const std::string& value, ObjectID& object_id);
 
@@ -84,6 +153,24 @@ bool MatchTypeName(bool regex, std::string const& pattern,
 
 std::string EncodeValue(std::string const&);
 
+/**
+ * @brief Pack the puts of the fields of each new object in `ops` into a
+ * single put of "/data/<name>", whose value is the msgpack of the object and
+ * is compressed with zstd when vineyardd is built with it. The other ops are
+ * kept as they are.
+ *
+ * The packed value is decoded by `DecodeStoredValue` when it's applied to
+ * the meta tree, as a put of the whole object.
+ */
+void PackDataOps(const std::vector<IMetaService::op_t>& ops,
+                 std::vector<IMetaService::op_t>& packed);
+
+/**
+ * @brief Decode a value of the meta service, which is either a JSON text or
+ * packed by `PackDataOps`.
+ */
+Status DecodeStoredValue(const std::string& value, json& decoded);
+
 }  // namespace meta_tree
 
 }  // namespace vineyard
@@ -0,0 +1,103 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/util/metrics.h"
+
+#include <mutex>
+#include <string>
+
+namespace vineyard {
+
+size_t ServerMetrics::slotOf(const CommandType cmd) {
+  // the command types start from -1
+  int64_t slot = static_cast<int64_t>(cmd) + 1;
+  if (slot < 0 || slot >= static_cast<int64_t>(kCommandSlots)) {
+    return static_cast<size_t>(CommandType::NullCommand) + 1;
+  }
+  return static_cast<size_t>(slot);
+}
+
+void ServerMetrics::ObserveRequest(const CommandType cmd,
+                                   const std::string& type,
+                                   const uint64_t nanoseconds) {
+  size_t slot = slotOf(cmd);
+  if (!named_[slot].load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(names_mutex_);
+    if (!named_[slot].load(std::memory_order_relaxed)) {
+      // unknown commands are accounted together
+      names_[slot] = cmd == CommandType::NullCommand ? "unknown" : type;
+      named_[slot].store(true, std::memory_order_release);
+    }
+  }
+  requests_[slot].Observe(nanoseconds);
+  request_latency_[slot].Observe(nanoseconds);
+}
+
+void ServerMetrics::ObserveMetaCommit(const uint64_t microseconds,
+                                      const bool succeed) {
+  meta_commits_.Inc();
+  if (!succeed) {
+    meta_commit_failures_.Inc();
+  }
+  meta_commit_latency_.Observe(microseconds);
+}
+
+void ServerMetrics::Dump(std::ostream& os) const {
+  DumpMetricHeader(os, "vineyard_requests_total", "counter",
+                   "Number of requests handled, by command.");
+  for (size_t slot = 0; slot < kCommandSlots; ++slot) {
+    if (named_[slot].load(std::memory_order_acquire)) {
+      os << "vineyard_requests_total{command=\"" << names_[slot] << "\"} "
+         << requests_[slot].Count() << "\n";
+    }
+  }
+  DumpMetricHeader(os, "vineyard_request_duration_seconds", "histogram",
+                   "Latency of handling the requests before the replies (or "
+                   "the asynchronous work) are scheduled, by command.");
+  for (size_t slot = 0; slot < kCommandSlots; ++slot) {
+    if (named_[slot].load(std::memory_order_acquire)) {
+      request_latency_[slot].Dump(
+          os, "vineyard_request_duration_seconds",
+          "command=\"" + names_[slot] + "\"", 1e-9);
+    }
+  }
+
+  DumpMetricHeader(os, "vineyard_meta_commits_total", "counter",
+                   "Number of updates committed to the metadata backend.");
+  os << "vineyard_meta_commits_total " << meta_commits_.Value() << "\n";
+  DumpMetricHeader(os, "vineyard_meta_commit_failures_total", "counter",
+                   "Number of failed commits to the metadata backend.");
+  os << "vineyard_meta_commit_failures_total "
+     << meta_commit_failures_.Value() << "\n";
+  DumpMetricHeader(os, "vineyard_meta_commit_duration_seconds", "histogram",
+                   "Latency of committing updates to the metadata backend.");
+  meta_commit_latency_.Dump(os, "vineyard_meta_commit_duration_seconds", "",
+                            1e-6);
+}
+
+json ServerMetrics::ToJSON() const {
+  json commands = json::object();
+  for (size_t slot = 0; slot < kCommandSlots; ++slot) {
+    if (named_[slot].load(std::memory_order_acquire)) {
+      commands[names_[slot]] = requests_[slot].ToJSON();
+    }
+  }
+  return json{{"commands", commands},
+              {"meta_commits", meta_commits_.Value()},
+              {"meta_commit_failures", meta_commit_failures_.Value()},
+              {"meta_commit_time_us", meta_commit_latency_.Sum()}};
+}
+
+}  // namespace vineyard
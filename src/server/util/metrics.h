@@ -16,10 +16,19 @@ limitations under the License.
 #ifndef SRC_SERVER_UTIL_METRICS_H_
 #define SRC_SERVER_UTIL_METRICS_H_
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
 #include <string>
 
 #include "common/util/env.h"
+#include "common/util/json.h"
 #include "common/util/logging.h"
+#include "common/util/protocols.h"
 #include "server/util/spec_resolvers.h"
 
 namespace vineyard {
@@ -43,6 +52,194 @@ namespace vineyard {
   } while (0)
 #endif
 
+/**
+ * @brief A histogram with exponential buckets, which can be updated
+ * concurrently on the hot path without locking.
+ *
+ * The upper bounds of buckets are 1, 4, 16, ..., 4^(kBuckets - 2) and +Inf,
+ * i.e., up to about 1.07 seconds for latencies observed in nanoseconds.
+ */
+class Histogram {
+ public:
+  static constexpr size_t kBuckets = 17;
+
+  void Observe(const uint64_t value) {
+    size_t index = 0;
+    uint64_t bound = 1;
+    while (index + 1 < kBuckets && value > bound) {
+      ++index;
+      bound <<= 2;
+    }
+    buckets_[index].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Write the series of the histogram in the prometheus text format,
+   * the observed values (and bounds) are multiplied by `scale`.
+   */
+  void Dump(std::ostream& os, const std::string& name,
+            const std::string& labels, const double scale = 1.0) const {
+    std::string prefix = labels.empty() ? "" : labels + ",";
+    uint64_t count = 0, bound = 1;
+    for (size_t index = 0; index < kBuckets; ++index) {
+      count += buckets_[index].load(std::memory_order_relaxed);
+      os << name << "_bucket{" << prefix << "le=\"";
+      if (index + 1 < kBuckets) {
+        os << bound * scale;
+      } else {
+        os << "+Inf";
+      }
+      os << "\"} " << count << "\n";
+      bound <<= 2;
+    }
+    os << name << "_sum{" << labels << "} "
+       << sum_.load(std::memory_order_relaxed) * scale << "\n";
+    os << name << "_count{" << labels << "} " << count << "\n";
+  }
+
+  uint64_t Sum() const { return sum_.load(std::memory_order_relaxed); }
+
+ private:
+  std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+  std::atomic<uint64_t> sum_{0};
+};
+
+/**
+ * @brief A monotonic counter that can be updated concurrently.
+ */
+class Counter {
+ public:
+  void Inc(const uint64_t value = 1) {
+    value_.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  uint64_t Value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<uint64_t> value_{0};
+};
+
+/**
+ * @brief The number, the cumulative and the maximum time of handling the
+ * requests.
+ */
+class RequestStats {
+ public:
+  void Observe(const uint64_t nanoseconds) {
+    count_.Inc();
+    total_.Inc(nanoseconds);
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (nanoseconds > max &&
+           !max_.compare_exchange_weak(max, nanoseconds,
+                                       std::memory_order_relaxed)) {
+    }
+  }
+
+  uint64_t Count() const { return count_.Value(); }
+
+  uint64_t TotalNanoseconds() const { return total_.Value(); }
+
+  uint64_t MaxNanoseconds() const {
+    return max_.load(std::memory_order_relaxed);
+  }
+
+  json ToJSON() const {
+    return json{{"count", Count()},
+                {"total_us", TotalNanoseconds() / 1000.0},
+                {"max_us", MaxNanoseconds() / 1000.0}};
+  }
+
+ private:
+  Counter count_, total_;
+  std::atomic<uint64_t> max_{0};
+};
+
+/**
+ * @brief Writes the HELP and TYPE lines of a metric family in the prometheus
+ * text format.
+ */
+inline void DumpMetricHeader(std::ostream& os, const std::string& name,
+                             const std::string& type,
+                             const std::string& help) {
+  os << "# HELP " << name << " " << help << "\n";
+  os << "# TYPE " << name << " " << type << "\n";
+}
+
+/**
+ * @brief ServerMetrics is the registry of the metrics of the requests and
+ * the metadata service of a vineyard server, which are recorded on the hot
+ * path without locking, and served in the prometheus text format by the
+ * `MetricsServer`, and in JSON by the `InstanceStatus` request.
+ */
+class ServerMetrics {
+ public:
+  // enough for all `CommandType`s
+  static constexpr size_t kCommandSlots = 64;
+
+  /**
+   * @brief Measures the (synchronous) handling of a request in the enclosing
+   * scope, into the stats of the connection as well if it is not null.
+   */
+  class RequestScope {
+   public:
+    RequestScope(ServerMetrics& metrics, RequestStats* connection,
+                 const CommandType cmd, const std::string& type)
+        : metrics_(metrics),
+          connection_(connection),
+          cmd_(cmd),
+          type_(type),
+          start_(std::chrono::steady_clock::now()) {}
+
+    RequestScope(RequestScope const&) = delete;
+    RequestScope& operator=(RequestScope const&) = delete;
+
+    ~RequestScope() {
+      uint64_t nanoseconds =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - start_)
+              .count();
+      metrics_.ObserveRequest(cmd_, type_, nanoseconds);
+      if (connection_ != nullptr) {
+        connection_->Observe(nanoseconds);
+      }
+    }
+
+   private:
+    ServerMetrics& metrics_;
+    RequestStats* connection_;
+    const CommandType cmd_;
+    const std::string& type_;
+    std::chrono::steady_clock::time_point start_;
+  };
+
+  void ObserveRequest(const CommandType cmd, const std::string& type,
+                      const uint64_t nanoseconds);
+
+  void ObserveMetaCommit(const uint64_t microseconds, const bool succeed);
+
+  void Dump(std::ostream& os) const;
+
+  /**
+   * @brief The request stats by command, and the time spent on committing to
+   * the metadata backend.
+   */
+  json ToJSON() const;
+
+ private:
+  static size_t slotOf(const CommandType cmd);
+
+  std::array<RequestStats, kCommandSlots> requests_;
+  std::array<Histogram, kCommandSlots> request_latency_;
+  // the command names are only written on the first request of a command
+  std::array<std::atomic<bool>, kCommandSlots> named_{};
+  std::array<std::string, kCommandSlots> names_;
+  std::mutex names_mutex_;
+
+  Counter meta_commits_, meta_commit_failures_;
+  Histogram meta_commit_latency_;
+};
+
 }  // namespace vineyard
 
 #endif  // SRC_SERVER_UTIL_METRICS_H_
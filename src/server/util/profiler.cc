@@ -0,0 +1,242 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/util/profiler.h"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#ifdef WITH_LIBUNWIND
+#define UNW_LOCAL_ONLY
+#include <libunwind.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "server/memory/allocator.h"
+
+namespace vineyard {
+
+namespace {
+
+// about 6MB, i.e., 160 seconds of samples of a busy thread at 100Hz
+constexpr size_t kMaxSamples = 16384;
+constexpr int kMaxFrames = 48;
+// the frames of the signal handler and the signal trampoline
+constexpr int kSkippedFrames = 2;
+
+struct Sample {
+  int depth;
+  void* frames[kMaxFrames];
+};
+
+// whether a profile is in progress, and whether the signals are sampled
+std::atomic<bool> in_progress{false}, sampling{false};
+std::atomic<size_t> next_sample{0};
+std::atomic<int> active_handlers{0};
+int profile_frequency = 0;
+std::unique_ptr<Sample[]> samples;
+
+void on_profiling_signal(int, siginfo_t*, void*) {
+  int saved_errno = errno;
+  active_handlers.fetch_add(1, std::memory_order_acquire);
+  if (sampling.load(std::memory_order_relaxed)) {
+    size_t index = next_sample.fetch_add(1, std::memory_order_relaxed);
+    if (index < kMaxSamples) {
+      Sample& sample = samples[index];
+#ifdef WITH_LIBUNWIND
+      sample.depth = unw_backtrace(sample.frames, kMaxFrames);
+#else
+      sample.depth = backtrace(sample.frames, kMaxFrames);
+#endif
+    }
+  }
+  active_handlers.fetch_sub(1, std::memory_order_release);
+  errno = saved_errno;
+}
+
+Status set_profiling_timer(int const frequency) {
+  struct itimerval timer;
+  timer.it_interval.tv_sec = 0;
+  timer.it_interval.tv_usec = frequency > 0 ? 1000000 / frequency : 0;
+  timer.it_value = timer.it_interval;
+  if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+    return Status::IOError("Failed to set the profiling timer: " +
+                           std::string(strerror(errno)));
+  }
+  return Status::OK();
+}
+
+/**
+ * @brief Resolve the return address to the enclosing function, or to the
+ * offset in the module when the symbol is not exported.
+ */
+std::string symbolize(void* address) {
+  // the return address may be the first instruction of the next function
+  void* pc = static_cast<char*>(address) - 1;
+  Dl_info info;
+  if (dladdr(pc, &info) == 0) {
+    std::stringstream ss;
+    ss << "[unknown] " << address;
+    return ss.str();
+  }
+  if (info.dli_sname != nullptr) {
+    int status = 0;
+    char* demangled =
+        abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    std::string name = status == 0 ? demangled : info.dli_sname;
+    free(demangled);
+    return name;
+  }
+  std::string module = info.dli_fname != nullptr ? info.dli_fname : "";
+  auto slash = module.rfind('/');
+  if (slash != std::string::npos) {
+    module = module.substr(slash + 1);
+  }
+  std::stringstream ss;
+  ss << "[" << module << "+0x" << std::hex
+     << (reinterpret_cast<uintptr_t>(pc) -
+         reinterpret_cast<uintptr_t>(info.dli_fbase))
+     << "]";
+  return ss.str();
+}
+
+/**
+ * @brief Aggregate the samples to the folded stacks of the format
+ *
+ *    root;caller;...;leaf count
+ */
+std::string fold_samples(size_t const count) {
+  std::unordered_map<void*, std::string> symbols;
+  std::map<std::string, size_t> stacks;
+  for (size_t index = 0; index < count; ++index) {
+    Sample const& sample = samples[index];
+    std::string stack;
+    for (int frame = sample.depth - 1; frame >= kSkippedFrames; --frame) {
+      void* address = sample.frames[frame];
+      auto iter = symbols.find(address);
+      if (iter == symbols.end()) {
+        iter = symbols.emplace(address, symbolize(address)).first;
+      }
+      if (!stack.empty()) {
+        stack += ';';
+      }
+      stack += iter->second;
+    }
+    if (!stack.empty()) {
+      stacks[stack] += 1;
+    }
+  }
+  std::stringstream ss;
+  for (auto const& item : stacks) {
+    ss << item.first << " " << item.second << "\n";
+  }
+  return ss.str();
+}
+
+}  // namespace
+
+Status CPUProfiler::Start(int const frequency) {
+#if defined(WITH_PROFILING)
+  return Status::Invalid(
+      "vineyardd is profiled by gperftools for its whole lifetime");
+#else
+  if (frequency <= 0 || frequency > 1000) {
+    return Status::Invalid("The profiling frequency should be in (0, 1000]");
+  }
+  bool expected = false;
+  if (!in_progress.compare_exchange_strong(expected, true)) {
+    return Status::Invalid("Another CPU profile is in progress");
+  }
+  if (samples == nullptr) {
+    samples.reset(new Sample[kMaxSamples]);
+    // resolves the unwinder before the first signal, as the lazy loading of
+    // libgcc_s by `backtrace` isn't async-signal-safe
+    void* frames[kMaxFrames];
+    backtrace(frames, kMaxFrames);
+  }
+  next_sample.store(0);
+  profile_frequency = frequency;
+  sampling.store(true);
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_sigaction = on_profiling_signal;
+  action.sa_flags = SA_RESTART | SA_SIGINFO;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(SIGPROF, &action, nullptr) != 0) {
+    sampling.store(false);
+    in_progress.store(false);
+    return Status::IOError("Failed to install the profiling signal handler: " +
+                           std::string(strerror(errno)));
+  }
+  auto status = set_profiling_timer(frequency);
+  if (!status.ok()) {
+    sampling.store(false);
+    in_progress.store(false);
+  }
+  return status;
+#endif
+}
+
+Status CPUProfiler::Stop(json& profile) {
+  if (!in_progress.load()) {
+    return Status::Invalid("There's no CPU profile in progress");
+  }
+  Status status = set_profiling_timer(0);
+  // the pending signals may still arrive after the timer is disarmed, and
+  // the default action of SIGPROF terminates the process, thus keeps the
+  // handler installed, and ignores the signals from now on
+  sampling.store(false);
+  while (active_handlers.load(std::memory_order_acquire) > 0) {
+    std::this_thread::yield();
+  }
+  size_t count = next_sample.load();
+  size_t recorded = std::min(count, kMaxSamples);
+  profile["frequency"] = profile_frequency;
+  profile["samples"] = recorded;
+  profile["dropped"] = count - recorded;
+  profile["folded"] = fold_samples(recorded);
+  in_progress.store(false);
+  return status;
+}
+
+Status HeapProfile(json& profile) {
+  profile["stats"] = BulkAllocator::Stats();
+  std::string heap_profile;
+  auto status = BulkAllocator::DumpHeapProfile(heap_profile);
+  if (status.ok()) {
+    profile["heap_profile"] = heap_profile;
+  } else if (!status.IsNotImplemented()) {
+    return status;
+  }
+  return Status::OK();
+}
+
+}  // namespace vineyard
@@ -0,0 +1,57 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_UTIL_PROFILER_H_
+#define SRC_SERVER_UTIL_PROFILER_H_
+
+#include "common/util/json.h"
+#include "common/util/status.h"
+
+namespace vineyard {
+
+/**
+ * @brief CPUProfiler samples the stacks of all threads of vineyardd on the
+ * SIGPROF timer, i.e., every 1/frequency seconds of the CPU time of the
+ * process, and reports the samples as folded stacks, which are consumed by
+ * flamegraph.pl and speedscope directly.
+ *
+ * Only one profile can be in progress at a time. The profiler is unavailable
+ * when vineyardd is built with `BUILD_VINEYARD_PROFILING`, as gperftools
+ * listens to SIGPROF for the whole lifetime of the process then.
+ */
+class CPUProfiler {
+ public:
+  static Status Start(int const frequency);
+
+  /**
+   * @brief Stop the profile and report it as
+   *
+   *    {"frequency": ..., "samples": ..., "dropped": ..., "folded": "..."}
+   *
+   * where the samples that exceed the capacity of the profiler are dropped.
+   */
+  static Status Stop(json& profile);
+};
+
+/**
+ * @brief The statistics of the allocator of the shared memory, and the heap
+ * profile of jemalloc when it is built with `USE_JEMALLOC_PROFILING` and
+ * vineyardd runs with `VINEYARD_JE_MALLOC_CONF=prof:true`.
+ */
+Status HeapProfile(json& profile);
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_PROFILER_H_
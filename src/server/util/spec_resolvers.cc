@@ -14,6 +14,7 @@ limitations under the License.
 */
 
 // #include <cstdlib>
+#include <algorithm>
 #include <exception>
 
 #include "gflags/gflags.h"
@@ -32,13 +33,93 @@ DEFINE_string(meta, "etcd", "Metadata storage, can be one of: etcd, local");
 DEFINE_string(etcd_endpoint, "http://127.0.0.1:2379", "endpoint of etcd");
 DEFINE_string(etcd_prefix, "vineyard", "path prefix in etcd");
 DEFINE_string(etcd_cmd, "", "path of etcd executable");
+DEFINE_bool(etcd_owned_writes, false,
+            "persist objects that only touch the keys owned by this instance "
+            "without taking the global etcd lock");
+DEFINE_bool(etcd_compress_meta, false,
+            "store the metadata of each object in etcd as a single value "
+            "in msgpack, compressed with zstd when available");
+DEFINE_string(meta_snapshot_path, "",
+              "file to save the metadata snapshot in, on restart the metadata "
+              "is restored from it and only the later updates are replayed "
+              "from etcd, empty means disabled");
+DEFINE_int64(meta_snapshot_interval, 300,
+             "interval (in seconds) to save the metadata snapshot");
 
 // share memory
 DEFINE_string(size, "256Mi",
               "shared memory size for vineyardd, the format could be 1024M, "
               "1024000, 1G, or 1Gi");
+DEFINE_string(initial_size, "",
+              "shared memory size to map at startup, vineyardd maps extra "
+              "segments on demand up to --size, defaults to --size");
+// Huge pages reduce the TLB misses when clients traverse large blobs, e.g.,
+// tensors and CSR arrays of fragments.
+//
+// Note that transparent huge pages for shared memory requires
+// "/sys/kernel/mm/transparent_hugepage/shmem_enabled" to be "advise", and
+// hugetlbfs pages requires enough pages being reserved in
+// "/proc/sys/vm/nr_hugepages" (or the 1GB variant).
+DEFINE_string(hugepages, "",
+              "Back the shared memory with huge pages, can be: 'thp' for "
+              "transparent huge pages, '2M' or '1G' for hugetlbfs pages, "
+              "empty means disabled");
+// Pre-faulting trades the startup time for predictable write latency, as
+// otherwise the first touch of each page happens on the client's critical
+// path.
+DEFINE_bool(prefault, false,
+            "Pre-fault the pages of the shared memory once it is mapped");
+DEFINE_int32(prefault_threads, 0,
+             "Number of threads to pre-fault the shared memory, 0 means the "
+             "number of CPU cores");
+DEFINE_bool(mlock, false,
+            "Lock the pages of the shared memory in RAM, requires a large "
+            "enough RLIMIT_MEMLOCK (or CAP_IPC_LOCK)");
+DEFINE_bool(numa_aware, false,
+            "place blobs on the NUMA node of the requesting client when the "
+            "client doesn't specify one");
+DEFINE_int64(small_blob_threshold, 0,
+             "blobs not larger than this size (in bytes) are packed into "
+             "shared slabs, 0 (the default) means disabled");
+DEFINE_int64(compaction_interval, 0,
+             "interval (in seconds) to compact the shared memory in "
+             "background, 0 means compaction is disabled");
 DEFINE_int64(stream_threshold, 80,
              "memory threshold of streams (percentage of total memory)");
+DEFINE_string(spill_path, "",
+              "directory to spill cold blobs to when the shared memory is "
+              "exhausted, empty means spilling is disabled");
+DEFINE_string(eviction_policy, "lru",
+              "policy to choose blobs to spill or drop, can be: lru, lfu");
+DEFINE_bool(evict_cold_blobs, false,
+            "drop unreferenced blobs when the shared memory is exhausted and "
+            "spilling is disabled, suitable for cache-style workloads");
+DEFINE_string(far_memory_path, "",
+              "file on a DAX filesystem (PMEM or CXL-attached memory), or a "
+              "DAX device, to migrate cold blobs to before spilling or "
+              "dropping them, empty means the far memory tier is disabled");
+DEFINE_string(far_memory_size, "0",
+              "size of the far memory tier, the format could be 1024M, 1G, "
+              "or 1Gi, 0 means the size of the existing file");
+DEFINE_int64(far_memory_promote_hits, 2,
+             "number of accesses to a blob in the far memory tier before it "
+             "is promoted back to the shared memory");
+DEFINE_bool(deduplicate_blobs, false,
+            "store identical sealed blobs only once, by hashing the content "
+            "of blobs when they are sealed");
+DEFINE_string(restore_checkpoint, "",
+              "checkpoint file to restore the blobs and the local metadata "
+              "from on start, which is written by the checkpoint command");
+DEFINE_string(remote_cache_size, "0",
+              "size of the local copies of remote blobs to keep for repeated "
+              "cross-instance reads, the format could be 1024M, 1G, or 1Gi, "
+              "0 means the cache is disabled");
+DEFINE_string(memory_quotas, "",
+              "memory quotas of the sessions that clients declare by "
+              "VINEYARD_SESSION, as comma-separated <session>=[<soft>:]<hard>,"
+              " e.g., etl=8Gi:10Gi, where the soft limit evicts the cold blobs "
+              "of the session and the hard limit rejects allocations, and the "
+              "session * is the quota of each of the other sessions");
 
 // ipc
 DEFINE_string(socket, "/var/run/vineyard.sock", "IPC socket file location");
@@ -47,6 +128,44 @@ DEFINE_string(socket, "/var/run/vineyard.sock", "IPC socket file location");
 DEFINE_bool(rpc, true, "Enable RPC service by default");
 DEFINE_int32(rpc_socket_port, 9600, "port to listen in rpc server");
 
+// transport
+DEFINE_int32(io_shards, 0,
+             "Serve connections with such many io contexts, each run by a "
+             "thread pinned to a core, 0 means a single shared io context");
+DEFINE_bool(io_uring, false,
+            "Send blobs to clients with io_uring when supported by the "
+            "kernel, otherwise fallback to asio");
+DEFINE_double(batch_bandwidth_share, 0.25,
+              "share of the time that the remote buffer sends of batch "
+              "clients get while the sends of interactive clients are in "
+              "flight, in (0, 1], 1 means no pacing");
+DEFINE_bool(rdma, false,
+            "Transfer blobs with RDMA during migration and deep copy when "
+            "available, otherwise fallback to TCP");
+
+// threads
+DEFINE_int32(worker_threads, 0,
+             "number of the worker threads, 0 means the number of the CPUs "
+             "of the worker role in --cpu_affinity, or all cores");
+DEFINE_int32(ipc_threads, 0,
+             "Serve the IPC connections on a dedicated pool of such many "
+             "threads, 0 means serving them with the rpc connections");
+DEFINE_int32(rpc_threads, 0,
+             "Serve the RPC connections on a dedicated pool of such many "
+             "threads, 0 means serving them with the ipc connections");
+DEFINE_int32(background_threads, 0,
+             "Run the compaction, lease sweeping and checkpoints on a "
+             "dedicated pool of such many threads, 0 means on the workers");
+DEFINE_string(cpu_affinity, "",
+              "Pin the threads of the roles to CPUs, e.g., 'worker=0-7;"
+              "ipc=8-11;rpc=12;meta=13;background=14,15', the roles that "
+              "are not listed are not pinned");
+
+// leases
+DEFINE_int64(lease_sweep_interval, 30,
+             "interval (in seconds) to delete the unpersisted objects whose "
+             "leases have expired, 0 means leases are disabled");
+
 // Kubernetes
 DEFINE_bool(sync_crds, false, "Synchronize CRDs when persisting objects");
 
@@ -55,6 +174,9 @@ DEFINE_bool(prometheus, false,
             "Whether to print metrics for prometheus or not");
 DEFINE_bool(metrics, false,
             "Alias for --prometheus, and takes precedence over --prometheus");
+DEFINE_int32(metrics_port, 0,
+             "port to serve the metrics in the prometheus text format over "
+             "HTTP, 0 means disabled");
 
 const Resolver& Resolver::get(std::string name) {
   static auto server_resolver = ServerSpecResolver();
@@ -87,6 +209,10 @@ json MetaStoreSpecResolver::resolve() const {
   spec["etcd_prefix"] = FLAGS_etcd_prefix;
   spec["etcd_endpoint"] = FLAGS_etcd_endpoint;
   spec["etcd_cmd"] = FLAGS_etcd_cmd;
+  spec["etcd_owned_writes"] = FLAGS_etcd_owned_writes;
+  spec["etcd_compress_meta"] = FLAGS_etcd_compress_meta;
+  spec["meta_snapshot_path"] = FLAGS_meta_snapshot_path;
+  spec["meta_snapshot_interval"] = FLAGS_meta_snapshot_interval;
   return spec;
 }
 
@@ -94,10 +220,61 @@ json BulkstoreSpecResolver::resolve() const {
   json spec;
   size_t bulkstore_limit = parseMemoryLimit(FLAGS_size);
   spec["memory_size"] = bulkstore_limit;
+  if (FLAGS_initial_size.empty()) {
+    spec["initial_size"] = bulkstore_limit;
+  } else {
+    spec["initial_size"] =
+        std::min(parseMemoryLimit(FLAGS_initial_size), bulkstore_limit);
+  }
+  spec["hugepages"] = FLAGS_hugepages;
+  spec["prefault"] = FLAGS_prefault;
+  spec["prefault_threads"] = std::max(FLAGS_prefault_threads, 0);
+  spec["mlock"] = FLAGS_mlock;
   spec["stream_threshold"] = FLAGS_stream_threshold;
+  spec["small_blob_threshold"] = FLAGS_small_blob_threshold;
+  spec["numa_aware"] = FLAGS_numa_aware;
+  spec["compaction_interval"] = FLAGS_compaction_interval;
+  spec["spill_path"] = FLAGS_spill_path;
+  spec["eviction_policy"] = FLAGS_eviction_policy;
+  spec["evict_cold_blobs"] = FLAGS_evict_cold_blobs;
+  spec["far_memory_path"] = FLAGS_far_memory_path;
+  spec["far_memory_size"] = parseMemoryLimit(FLAGS_far_memory_size);
+  spec["far_memory_promote_hits"] = FLAGS_far_memory_promote_hits;
+  spec["deduplicate_blobs"] = FLAGS_deduplicate_blobs;
+  spec["restore_checkpoint"] = FLAGS_restore_checkpoint;
+  spec["remote_cache_size"] = parseMemoryLimit(FLAGS_remote_cache_size);
+  spec["memory_quotas"] = parseMemoryQuotas(FLAGS_memory_quotas);
   return spec;
 }
 
+json BulkstoreSpecResolver::parseMemoryQuotas(
+    std::string const& memory_quotas) const {
+  json quotas = json::object();
+  size_t begin = 0;
+  while (begin < memory_quotas.size()) {
+    size_t end = std::min(memory_quotas.find(',', begin), memory_quotas.size());
+    std::string item = memory_quotas.substr(begin, end - begin);
+    begin = end + 1;
+    size_t assign = item.find('=');
+    if (assign == std::string::npos || assign == 0) {
+      LOG(WARNING) << "Ignoring the invalid memory quota: '" << item << "'";
+      continue;
+    }
+    std::string limits = item.substr(assign + 1);
+    size_t colon = limits.find(':');
+    size_t soft_limit = 0, hard_limit = 0;
+    if (colon == std::string::npos) {
+      hard_limit = parseMemoryLimit(limits);
+    } else {
+      soft_limit = parseMemoryLimit(limits.substr(0, colon));
+      hard_limit = parseMemoryLimit(limits.substr(colon + 1));
+    }
+    quotas[item.substr(0, assign)] =
+        json{{"soft_limit", soft_limit}, {"hard_limit", hard_limit}};
+  }
+  return quotas;
+}
+
 size_t BulkstoreSpecResolver::parseMemoryLimit(
     std::string const& memory_limit) const {
   // Parse human-readable size. Note that any extra character that follows a
@@ -157,6 +334,17 @@ json RpcSpecResolver::resolve() const {
 json ServerSpecResolver::resolve() const {
   json spec;
   spec["deployment"] = FLAGS_deployment;
+  spec["metrics_port"] = FLAGS_metrics_port;
+  spec["io_uring"] = FLAGS_io_uring;
+  spec["io_shards"] = FLAGS_io_shards;
+  spec["rdma"] = FLAGS_rdma;
+  spec["batch_bandwidth_share"] = FLAGS_batch_bandwidth_share;
+  spec["lease_sweep_interval"] = FLAGS_lease_sweep_interval;
+  spec["worker_threads"] = FLAGS_worker_threads;
+  spec["ipc_threads"] = FLAGS_ipc_threads;
+  spec["rpc_threads"] = FLAGS_rpc_threads;
+  spec["background_threads"] = FLAGS_background_threads;
+  spec["cpu_affinity"] = FLAGS_cpu_affinity;
   spec["sync_crds"] =
       FLAGS_sync_crds || (read_env("VINEYARD_SYNC_CRDS") == "1");
   spec["metastore_spec"] = Resolver::get("metastore").resolve();
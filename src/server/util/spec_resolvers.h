@@ -58,6 +58,8 @@ class BulkstoreSpecResolver : public Resolver {
 
  private:
   size_t parseMemoryLimit(std::string const& memory_limit) const;
+
+  json parseMemoryQuotas(std::string const& memory_quotas) const;
 };
 
 /**
@@ -0,0 +1,119 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "server/util/type_index.h"
+
+#include <fnmatch.h>
+
+#include <algorithm>
+#include <regex>
+
+namespace vineyard {
+
+void TypeIndex::Put(const std::string& name, const std::string& type) {
+  auto iter = types_.find(name);
+  if (iter != types_.end()) {
+    if (iter->second == type) {
+      return;
+    }
+    Erase(name);
+  }
+  types_.emplace(name, type);
+  names_[type].emplace(name);
+}
+
+void TypeIndex::Erase(const std::string& name) {
+  auto iter = types_.find(name);
+  if (iter == types_.end()) {
+    return;
+  }
+  auto names = names_.find(iter->second);
+  if (names != names_.end()) {
+    names->second.erase(name);
+    if (names->second.empty()) {
+      names_.erase(names);
+    }
+  }
+  types_.erase(iter);
+}
+
+void TypeIndex::Clear() {
+  names_.clear();
+  types_.clear();
+}
+
+void TypeIndex::Match(
+    const std::string& pattern, bool const regex,
+    std::function<bool(const std::string& name, const std::string& type)> const&
+        visitor) const {
+  Match(pattern, regex, std::string(), std::string(), visitor);
+}
+
+void TypeIndex::Match(
+    const std::string& pattern, bool const regex,
+    const std::string& after_type, const std::string& after_name,
+    std::function<bool(const std::string& name, const std::string& type)> const&
+        visitor) const {
+  auto visit = [&](std::map<std::string, std::set<std::string>>::const_iterator
+                       iter) -> bool {
+    if (iter->first < after_type) {
+      return true;
+    }
+    auto name = iter->first == after_type
+                    ? iter->second.upper_bound(after_name)
+                    : iter->second.begin();
+    for (; name != iter->second.end(); ++name) {
+      if (!visitor(*name, iter->first)) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  if (regex) {
+    // for invalid regex pattern, return nothing.
+    std::regex regex_pattern;
+    try {
+      regex_pattern = std::regex(pattern);
+    } catch (std::regex_error const&) { return; }
+    for (auto iter = names_.lower_bound(after_type); iter != names_.end();
+         ++iter) {
+      if (std::regex_match(iter->first, regex_pattern) && !visit(iter)) {
+        return;
+      }
+    }
+    return;
+  }
+
+  // only the type names that start with the literal prefix can match
+  std::string const prefix = pattern.substr(0, pattern.find_first_of("*?[\\"));
+  if (prefix.size() == pattern.size()) {
+    auto iter = names_.find(pattern);
+    if (iter != names_.end()) {
+      visit(iter);
+    }
+    return;
+  }
+  for (auto iter = names_.lower_bound(std::max(prefix, after_type));
+       iter != names_.end() &&
+       iter->first.compare(0, prefix.size(), prefix) == 0;
+       ++iter) {
+    if (fnmatch(pattern.c_str(), iter->first.c_str(), 0) == 0 && !visit(iter)) {
+      return;
+    }
+  }
+}
+
+}  // namespace vineyard
@@ -0,0 +1,76 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef SRC_SERVER_UTIL_TYPE_INDEX_H_
+#define SRC_SERVER_UTIL_TYPE_INDEX_H_
+
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+namespace vineyard {
+
+/**
+ * @brief TypeIndex indexes the objects in the meta tree by their type names,
+ * to make listing objects by a type pattern cost proportional to the number
+ * of matched objects, rather than the number of all objects.
+ *
+ * Type names are kept in order, thus a wildcard pattern only visits the type
+ * names that start with its literal prefix.
+ */
+class TypeIndex {
+ public:
+  void Put(const std::string& name, const std::string& type);
+
+  void Erase(const std::string& name);
+
+  void Clear();
+
+  /**
+   * @brief Visit the objects whose type name matches the pattern, until the
+   * visitor returns false. The pattern is either a wildcard pattern (see also
+   * `fnmatch(3)`) or a regular expression.
+   */
+  void Match(const std::string& pattern, bool const regex,
+             std::function<bool(const std::string& name,
+                                const std::string& type)> const& visitor)
+      const;
+
+  /**
+   * @brief Visit the matched objects that are ordered after the object
+   * `after_name` of the type `after_type`, in the order of type names and
+   * then object names, for resuming a listing at where the last page ends.
+   * The object `after_name` doesn't need to be in the index any more.
+   */
+  void Match(const std::string& pattern, bool const regex,
+             const std::string& after_type, const std::string& after_name,
+             std::function<bool(const std::string& name,
+                                const std::string& type)> const& visitor)
+      const;
+
+  size_t size() const { return types_.size(); }
+
+ private:
+  // type name -> object names
+  std::map<std::string, std::set<std::string>> names_;
+  // object name -> type name
+  std::unordered_map<std::string, std::string> types_;
+};
+
+}  // namespace vineyard
+
+#endif  // SRC_SERVER_UTIL_TYPE_INDEX_H_
@@ -0,0 +1,126 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstring>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/arena_allocator.h"
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// Each thread allocates from its own arena through its own cache, and the
+// blocks are freed by the owner thread as well as by other threads.
+
+constexpr size_t kArenaSize = 256 * 1024 * 1024;
+constexpr size_t kThreads = 4;
+constexpr size_t kRounds = 4;
+constexpr size_t kBlocks = 512;
+constexpr size_t kAlignment = 16;
+
+static size_t blockSize(size_t const thread, size_t const block) {
+  return 16 + (thread * 131 + block * 97) % 4096;
+}
+
+static char content(size_t const thread, size_t const block) {
+  return static_cast<char>((thread * 37 + block) % 241);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./arena_allocator_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  auto allocator = std::unique_ptr<VineyardArenaAllocator<void>>(
+      new VineyardArenaAllocator<void>(client, kArenaSize));
+
+  // the last block of each thread is left to the main thread
+  std::vector<void*> leftovers(kThreads, nullptr);
+  std::vector<std::thread> threads;
+  for (size_t thread = 0; thread < kThreads; ++thread) {
+    threads.emplace_back([&, thread]() {
+      for (size_t round = 0; round < kRounds; ++round) {
+        std::vector<void*> blocks;
+        for (size_t block = 0; block < kBlocks; ++block) {
+          size_t const size = blockSize(thread, block);
+          void* pointer = allocator->Allocate(size, kAlignment);
+          CHECK(pointer != nullptr);
+          CHECK_GE(allocator->GetAllocatedSize(pointer), size);
+          memset(pointer, content(thread, block), size);
+          blocks.emplace_back(pointer);
+        }
+        // the blocks don't overlap with each other
+        for (size_t block = 0; block < kBlocks; ++block) {
+          auto data = reinterpret_cast<const char*>(blocks[block]);
+          size_t const size = blockSize(thread, block);
+          CHECK_EQ(data[0], content(thread, block));
+          CHECK_EQ(data[size - 1], content(thread, block));
+        }
+        size_t const kept = round + 1 == kRounds ? 1 : 0;
+        for (size_t block = 0; block + kept < kBlocks; ++block) {
+          allocator->Free(blocks[block]);
+        }
+        if (kept) {
+          leftovers[thread] = blocks.back();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::set<void*> distinct(leftovers.begin(), leftovers.end());
+  CHECK_EQ(distinct.size(), kThreads);
+  for (size_t thread = 0; thread < kThreads; ++thread) {
+    auto data = reinterpret_cast<const char*>(leftovers[thread]);
+    CHECK_EQ(data[0], content(thread, kBlocks - 1));
+  }
+
+  // a block can be frozen as a blob, and the rest are freed by another
+  // thread than the one that allocated them
+  auto blob = allocator->Freeze(leftovers[0]);
+  CHECK(blob != nullptr);
+  CHECK_EQ(reinterpret_cast<const void*>(blob->data()), leftovers[0]);
+  CHECK_GE(blob->allocated_size(), blockSize(0, kBlocks - 1));
+  for (size_t thread = 1; thread < kThreads; ++thread) {
+    allocator->Free(leftovers[thread]);
+  }
+
+  // the caches of the threads are flushed before the arenas are destroyed
+  allocator.reset();
+
+  LOG(INFO) << "Passed arena allocator tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
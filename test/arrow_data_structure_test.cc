@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <cmath>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <thread>
@@ -23,7 +25,10 @@ limitations under the License.
 #include "arrow/util/io_util.h"
 #include "arrow/util/logging.h"
 
+#include "basic/ds/array_reduce.h"
 #include "basic/ds/arrow.h"
+#include "basic/ds/arrow_compute.h"
+#include "basic/ds/arrow_utils.h"
 #include "client/client.h"
 #include "client/ds/object_meta.h"
 #include "common/util/logging.h"
@@ -471,6 +476,333 @@ int main(int argc, char** argv) {
 
     LOG(INFO) << "Passed Table wrapper tests...";
   }
+
+  {
+    LOG(INFO) << "#########  Table Shared Schema Test #############";
+    std::vector<std::string> names = {"f1", "f2"};
+    std::vector<std::tuple<int64_t, double>> rows = {
+        std::tuple<int64_t, double>(1, 1.5),
+        std::tuple<int64_t, double>(2, 2.5),
+        std::tuple<int64_t, double>(3, 3.5)};
+    std::shared_ptr<arrow::Table> chunk;
+    CHECK_ARROW_ERROR(arrow::stl::TableFromTupleRange(
+        arrow::default_memory_pool(), rows, names, &chunk));
+    std::vector<std::shared_ptr<arrow::RecordBatch>> chunk_batches;
+    VINEYARD_CHECK_OK(TableToRecordBatches(chunk, &chunk_batches));
+    CHECK_EQ(chunk_batches.size(), 1U);
+    std::shared_ptr<arrow::Table> table;
+    VINEYARD_CHECK_OK(RecordBatchesToTable(
+        {chunk_batches[0], chunk_batches[0], chunk_batches[0]}, &table));
+
+    // the batches reference the very schema proxy of the table, and the
+    // schema is deserialized only once
+    auto check_shared_schema = [](std::shared_ptr<Table> const& t) {
+      ObjectID schema_id = t->meta().GetMemberMeta("schema_").GetId();
+      for (auto const& batch : t->batches()) {
+        CHECK_EQ(batch->meta().GetMemberMeta("schema_").GetId(), schema_id);
+        CHECK_EQ(batch->schema().get(), t->schema().get());
+      }
+    };
+
+    auto sealed = std::dynamic_pointer_cast<Table>(
+        TableBuilder(client, table).Seal(client));
+    auto r1 = std::dynamic_pointer_cast<Table>(client.GetObject(sealed->id()));
+    CHECK_EQ(r1->batches().size(), 3U);
+    CHECK(r1->GetTable()->Equals(*table));
+    check_shared_schema(r1);
+
+    arrow::Int64Builder value_builder;
+    std::shared_ptr<arrow::Array> values;
+    for (int64_t j = 0; j < table->num_rows(); j++) {
+      CHECK_ARROW_ERROR(value_builder.Append(j));
+    }
+    CHECK_ARROW_ERROR(value_builder.Finish(&values));
+    TableExtender extender(client, r1);
+    VINEYARD_CHECK_OK(extender.AddColumn(client, "f3", values));
+    auto extended = extender.Seal(client);
+    auto r2 =
+        std::dynamic_pointer_cast<Table>(client.GetObject(extended->id()));
+    CHECK_EQ(r2->batches().size(), 3U);
+    CHECK_EQ(r2->schema()->num_fields(), 3);
+    CHECK_NE(r2->meta().GetMemberMeta("schema_").GetId(),
+             r1->meta().GetMemberMeta("schema_").GetId());
+    check_shared_schema(r2);
+
+    VINEYARD_CHECK_OK(client.DelData({extended->id(), sealed->id()}));
+    LOG(INFO) << "Passed table shared schema tests...";
+  }
+
+  {
+    LOG(INFO) << "#########  Table Compute Test #############";
+    std::vector<std::string> names = {"f1", "f2"};
+    std::vector<std::tuple<int64_t, double>> rows;
+    for (int64_t j = 0; j < 100; ++j) {
+      rows.emplace_back(j, j * 0.5);
+    }
+    std::shared_ptr<arrow::Table> table;
+    CHECK_ARROW_ERROR(arrow::stl::TableFromTupleRange(
+        arrow::default_memory_pool(), rows, names, &table));
+    TableBuilder builder(client, table);
+    auto r1 = std::dynamic_pointer_cast<Table>(builder.Seal(client));
+
+    std::shared_ptr<Object> projected;
+    VINEYARD_CHECK_OK(Project(client, r1, {"f2"}, projected));
+    auto r2 = std::dynamic_pointer_cast<Table>(projected);
+    CHECK_EQ(r2->num_columns(), 1UL);
+    CHECK_EQ(r2->num_rows(), 100UL);
+    CHECK_EQ(r2->batches()[0]->columns()[0]->id(),
+             r1->batches()[0]->columns()[1]->id());
+
+    std::shared_ptr<Object> filtered;
+    VINEYARD_CHECK_OK(Filter<int64_t>(client, r1, "f1",
+                                      CompareOp::kGreaterEqual, 90, filtered));
+    auto r3 = std::dynamic_pointer_cast<Table>(filtered);
+    CHECK_EQ(r3->num_rows(), 10UL);
+    auto f2 = std::dynamic_pointer_cast<arrow::DoubleArray>(
+        r3->GetTable()->column(1)->chunk(0));
+    for (int64_t j = 0; j < 10; ++j) {
+      CHECK_EQ(f2->Value(j), (90 + j) * 0.5);
+    }
+
+    std::shared_ptr<Object> all;
+    VINEYARD_CHECK_OK(Filter<double>(client, r1, "f2", CompareOp::kLess, 100.0,
+                                     all));
+    auto r4 = std::dynamic_pointer_cast<Table>(all);
+    CHECK_EQ(r4->batches()[0]->id(), r1->batches()[0]->id());
+
+    auto f1 = std::dynamic_pointer_cast<NumericArray<int64_t>>(
+        r1->batches()[0]->columns()[0]);
+    CHECK(f1->has_statistics());
+    CHECK_EQ(f1->min_value(), 0);
+    CHECK_EQ(f1->max_value(), 99);
+    std::vector<size_t> batches;
+    VINEYARD_CHECK_OK(
+        PruneBatches<int64_t>(r1, "f1", CompareOp::kGreater, 99, batches));
+    CHECK(batches.empty());
+    VINEYARD_CHECK_OK(
+        PruneBatches<int64_t>(r1, "f1", CompareOp::kLess, 1, batches));
+    CHECK_EQ(batches.size(), 1UL);
+
+    // the NaNs are not covered by the statistics of the column
+    std::vector<std::tuple<int64_t, double>> nan_rows;
+    for (int64_t j = 0; j < 10; ++j) {
+      nan_rows.emplace_back(j, j == 5 ? std::nan("") : 1.0);
+    }
+    std::shared_ptr<arrow::Table> nan_table;
+    CHECK_ARROW_ERROR(arrow::stl::TableFromTupleRange(
+        arrow::default_memory_pool(), nan_rows, names, &nan_table));
+    TableBuilder nan_builder(client, nan_table);
+    auto r5 = std::dynamic_pointer_cast<Table>(nan_builder.Seal(client));
+    VINEYARD_CHECK_OK(
+        PruneBatches<double>(r5, "f2", CompareOp::kNotEqual, 1.0, batches));
+    CHECK_EQ(batches.size(), 1UL);
+    std::shared_ptr<Object> not_equal;
+    VINEYARD_CHECK_OK(Filter<double>(client, r5, "f2", CompareOp::kNotEqual,
+                                     1.0, not_equal));
+    auto r6 = std::dynamic_pointer_cast<Table>(not_equal);
+    CHECK_EQ(r6->num_rows(), 1UL);
+    auto nan_f1 = std::dynamic_pointer_cast<arrow::Int64Array>(
+        r6->GetTable()->column(0)->chunk(0));
+    CHECK_EQ(nan_f1->Value(0), 5);
+
+    LOG(INFO) << "Passed table compute tests...";
+  }
+
+  {
+    LOG(INFO) << "#########  Combine Chunks Test #############";
+    std::vector<std::shared_ptr<arrow::Array>> int_chunks, string_chunks;
+    for (int64_t chunk = 0; chunk < 3; ++chunk) {
+      arrow::Int64Builder int_builder;
+      arrow::StringBuilder string_builder;
+      for (int64_t j = 0; j < 100 * chunk; ++j) {
+        if ((j + chunk) % 7 == 0) {
+          CHECK_ARROW_ERROR(int_builder.AppendNull());
+        } else {
+          CHECK_ARROW_ERROR(int_builder.Append(chunk * 1000 + j));
+        }
+        CHECK_ARROW_ERROR(string_builder.Append(std::to_string(j)));
+      }
+      std::shared_ptr<arrow::Array> int_chunk, string_chunk;
+      CHECK_ARROW_ERROR(int_builder.Finish(&int_chunk));
+      CHECK_ARROW_ERROR(string_builder.Finish(&string_chunk));
+      int_chunks.push_back(int_chunk);
+      string_chunks.push_back(string_chunk);
+    }
+    auto int_column = std::make_shared<arrow::ChunkedArray>(int_chunks);
+    auto string_column = std::make_shared<arrow::ChunkedArray>(string_chunks);
+    std::shared_ptr<arrow::Array> expected;
+    VINEYARD_CHECK_OK(ConcatenateChunks(int_column, &expected));
+    CHECK_EQ(expected->length(), 300);
+
+    // the chunks are copied into the blob, with the nulls and the zone map
+    NumericArrayBuilder<int64_t> chunks_builder(client, int_column);
+    auto r1 = std::dynamic_pointer_cast<NumericArray<int64_t>>(
+        chunks_builder.Seal(client));
+    CHECK(r1->GetArray()->Equals(*expected));
+    CHECK_EQ(r1->null_count(), expected->null_count());
+    CHECK_GT(r1->null_count(), 0);
+    CHECK(r1->has_statistics());
+    CHECK_EQ(r1->min_value(), 1000);
+    CHECK_EQ(r1->max_value(), 2199);
+
+    // the only chunk is returned as is, and no chunks is an error
+    std::shared_ptr<arrow::Array> single;
+    VINEYARD_CHECK_OK(ConcatenateChunks(
+        std::make_shared<arrow::ChunkedArray>(int_chunks[2]), &single));
+    CHECK(single == int_chunks[2]);
+    CHECK(ConcatenateChunks(std::make_shared<arrow::ChunkedArray>(
+                                arrow::ArrayVector{}, arrow::int64()),
+                            &single)
+              .IsInvalid());
+
+    // the table is sealed as a single batch of contiguous columns
+    auto schema = arrow::schema({arrow::field("f1", arrow::int64()),
+                                 arrow::field("f2", arrow::utf8())});
+    auto table = arrow::Table::Make(schema, {int_column, string_column});
+    TableBuilder combined_builder(client, table, true);
+    auto r2 = std::dynamic_pointer_cast<Table>(combined_builder.Seal(client));
+    CHECK_EQ(r2->batch_num(), 1U);
+    CHECK_EQ(r2->num_rows(), 300U);
+    CHECK(r2->GetTable()->Equals(*table));
+    for (int column = 0; column < r2->GetTable()->num_columns(); ++column) {
+      CHECK_EQ(r2->GetTable()->column(column)->num_chunks(), 1);
+    }
+    TableBuilder chunked_builder(client, table, false);
+    auto r3 = std::dynamic_pointer_cast<Table>(chunked_builder.Seal(client));
+    CHECK_GT(r3->batch_num(), 1U);
+    CHECK(r3->GetTable()->Equals(*r2->GetTable()));
+
+    // the tables of the same names are concatenated as they are
+    std::vector<std::shared_ptr<arrow::Table>> tables = {table, table};
+    auto concatenated = ConcatenateTables(tables);
+    CHECK_EQ(concatenated->num_rows(), 600);
+    CHECK(concatenated->schema()->Equals(*schema));
+
+    LOG(INFO) << "Passed combine chunks tests...";
+  }
+
+  {
+    LOG(INFO) << "#########  Parallel Serialization Test #############";
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    for (int64_t index = 0; index < 7; ++index) {
+      arrow::Int64Builder value_builder;
+      arrow::StringBuilder string_builder;
+      for (int64_t j = 0; j < 10 * index; ++j) {
+        CHECK_ARROW_ERROR(value_builder.Append(index * 1000 + j));
+        CHECK_ARROW_ERROR(string_builder.Append(std::to_string(j * j)));
+      }
+      std::shared_ptr<arrow::Array> values, strings;
+      CHECK_ARROW_ERROR(value_builder.Finish(&values));
+      CHECK_ARROW_ERROR(string_builder.Finish(&strings));
+      auto schema = arrow::schema({arrow::field("f1", arrow::int64()),
+                                   arrow::field("f2", arrow::utf8())});
+      batches.push_back(arrow::RecordBatch::Make(schema, values->length(),
+                                                 {values, strings}));
+    }
+
+    // the batches come back in order, regardless of the concurrency
+    for (int concurrency : {1, 3, 16}) {
+      std::shared_ptr<arrow::Buffer> buffer;
+      VINEYARD_CHECK_OK(
+          SerializeRecordBatchesInParallel(batches, &buffer, concurrency));
+      std::vector<std::shared_ptr<arrow::RecordBatch>> deserialized;
+      VINEYARD_CHECK_OK(
+          DeserializeRecordBatchesInParallel(buffer, &deserialized, 4));
+      CHECK_EQ(deserialized.size(), batches.size());
+      for (size_t index = 0; index < batches.size(); ++index) {
+        CHECK(deserialized[index]->Equals(*batches[index]));
+      }
+
+      // the values reference the serialized buffer
+      auto values = deserialized.back()->column_data(0)->buffers[1];
+      CHECK_GE(values->data(), buffer->data());
+      CHECK_LE(values->data() + values->size(),
+               buffer->data() + buffer->size());
+    }
+
+    // no batches at all
+    {
+      std::shared_ptr<arrow::Buffer> buffer;
+      VINEYARD_CHECK_OK(SerializeRecordBatchesInParallel({}, &buffer, 3));
+      std::vector<std::shared_ptr<arrow::RecordBatch>> deserialized;
+      VINEYARD_CHECK_OK(
+          DeserializeRecordBatchesInParallel(buffer, &deserialized, 3));
+      CHECK(deserialized.empty());
+    }
+
+    // the truncated or corrupted headers are rejected
+    {
+      std::shared_ptr<arrow::Buffer> buffer;
+      VINEYARD_CHECK_OK(SerializeRecordBatchesInParallel(batches, &buffer, 3));
+      std::vector<int64_t> words(buffer->size() / sizeof(int64_t) + 1);
+      memcpy(words.data(), buffer->data(), buffer->size());
+      std::vector<std::shared_ptr<arrow::RecordBatch>> deserialized;
+
+      auto truncated = std::make_shared<arrow::Buffer>(
+          reinterpret_cast<const uint8_t*>(words.data()),
+          (1 + batches.size()) * sizeof(int64_t));
+      CHECK(DeserializeRecordBatchesInParallel(truncated, &deserialized, 3)
+                .IsInvalid());
+
+      words[2 * batches.size()] = buffer->size();
+      auto corrupted = std::make_shared<arrow::Buffer>(
+          reinterpret_cast<const uint8_t*>(words.data()), buffer->size());
+      CHECK(DeserializeRecordBatchesInParallel(corrupted, &deserialized, 3)
+                .IsInvalid());
+      CHECK(deserialized.empty());
+    }
+
+    LOG(INFO) << "Passed parallel serialization tests...";
+  }
+
+  {
+    LOG(INFO) << "#########  Array Reduce Test #############";
+    arrow::DoubleBuilder b1;
+    for (int64_t j = 0; j < 1000; ++j) {
+      if (j % 10 == 0) {
+        CHECK_ARROW_ERROR(b1.AppendNull());
+      } else {
+        CHECK_ARROW_ERROR(b1.Append(j * 0.5));
+      }
+    }
+    std::shared_ptr<arrow::DoubleArray> a1;
+    CHECK_ARROW_ERROR(b1.Finish(&a1));
+    NumericArrayBuilder<double> array_builder(client, a1);
+    auto r1 = std::dynamic_pointer_cast<NumericArray<double>>(
+        array_builder.Seal(client));
+
+    ArraySummary<double> summary;
+    VINEYARD_CHECK_OK(Summarize(*r1, summary, 4));
+    CHECK_EQ(summary.count, 900);
+    CHECK_EQ(summary.min_value, 0.5);
+    CHECK_EQ(summary.max_value, 499.5);
+    CHECK_EQ(summary.sum, (499500 - 49500) * 0.5);
+
+    std::vector<int64_t> counts;
+    VINEYARD_CHECK_OK(Histogram(*r1, 0.0, 500.0, 10, counts));
+    CHECK_EQ(counts.size(), 10UL);
+    for (auto const count : counts) {
+      CHECK_EQ(count, 90);
+    }
+
+    std::vector<double> quantiles;
+    VINEYARD_CHECK_OK(Quantiles(*r1, {0.0, 0.5, 1.0}, quantiles));
+    CHECK_EQ(quantiles[0], 0.5);
+    CHECK_LE(std::abs(quantiles[1] - 250.0), 1.0);
+    CHECK_EQ(quantiles[2], 499.5);
+
+    ObjectID cached_id = InvalidObjectID();
+    VINEYARD_CHECK_OK(CacheSummary(client, r1->id(), summary, cached_id));
+    ObjectMeta cached_meta;
+    VINEYARD_CHECK_OK(client.GetMetaData(cached_id, cached_meta));
+    ArraySummary<double> cached;
+    CHECK(GetCachedSummary(cached_meta, cached));
+    CHECK_EQ(cached.count, summary.count);
+    CHECK_EQ(cached.sum, summary.sum);
+    CHECK(!GetCachedSummary(r1->meta(), cached));
+
+    LOG(INFO) << "Passed array reduce tests...";
+  }
   client.Disconnect();
 
   return 0;
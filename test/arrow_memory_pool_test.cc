@@ -0,0 +1,95 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+
+#include "arrow/api.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/arrow_utils.h"
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/logging.h"
+#include "malloc/arrow_memory_pool.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+constexpr int64_t kLength = 1024;
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./arrow_memory_pool_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  {
+    VineyardMemoryPool pool(client);
+    std::shared_ptr<arrow::Int64Array> array;
+    {
+      arrow::Int64Builder builder(&pool);
+      for (int64_t i = 0; i < kLength; ++i) {
+        CHECK_ARROW_ERROR(builder.Append(i));
+      }
+      CHECK_ARROW_ERROR(builder.Finish(&array));
+    }
+    auto const& values = array->values();
+
+    std::shared_ptr<Blob> blob;
+    VINEYARD_CHECK_OK(pool.Freeze(values, blob));
+    CHECK_EQ(blob->data(), reinterpret_cast<const char*>(values->data()));
+    CHECK_GE(blob->allocated_size(), static_cast<size_t>(values->size()));
+
+    // a slice in the middle of the allocation resolves to the same blob
+    auto sliced = arrow::SliceBuffer(values, 100 * sizeof(int64_t),
+                                     200 * sizeof(int64_t));
+    std::shared_ptr<Blob> sliced_blob;
+    VINEYARD_CHECK_OK(pool.Freeze(sliced, sliced_blob));
+    CHECK_EQ(sliced_blob->id(), blob->id());
+    size_t offset = reinterpret_cast<const char*>(sliced->data()) -
+                    sliced_blob->data();
+    CHECK_EQ(offset, 100 * sizeof(int64_t));
+    auto elements = reinterpret_cast<const int64_t*>(sliced_blob->data());
+    for (int64_t i = 100; i < 300; ++i) {
+      CHECK_EQ(elements[i], i);
+    }
+
+    // buffers that aren't allocated from the pool are rejected
+    std::shared_ptr<arrow::Array> foreign;
+    {
+      arrow::Int64Builder builder;
+      CHECK_ARROW_ERROR(builder.Append(1));
+      CHECK_ARROW_ERROR(builder.Finish(&foreign));
+    }
+    std::shared_ptr<Blob> foreign_blob;
+    CHECK(!pool.Freeze(foreign->data()->buffers[1], foreign_blob).ok());
+    auto beyond = std::make_shared<arrow::Buffer>(
+        values->data() + blob->allocated_size() - 8, 16);
+    CHECK(!pool.Freeze(beyond, foreign_blob).ok());
+
+    array.reset();
+    VINEYARD_CHECK_OK(pool.Release());
+  }
+  LOG(INFO) << "Passed arrow memory pool tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,107 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/scalar.h"
+#include "client/async_client.h"
+#include "client/client.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./async_client_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  const size_t count = 64;
+  std::vector<ObjectID> ids;
+  for (size_t index = 0; index < count; ++index) {
+    ScalarBuilder<int32_t> scalar_builder(client);
+    scalar_builder.SetValue(index);
+    ids.emplace_back(scalar_builder.Seal(client)->id());
+  }
+
+  AsyncClient async_client;
+  VINEYARD_CHECK_OK(async_client.Open(client, 4));
+
+  {
+    std::vector<ObjectMeta> metas(count);
+    std::vector<std::future<Status>> results;
+    for (size_t index = 0; index < count; ++index) {
+      results.emplace_back(async_client.GetMetaData(ids[index], metas[index]));
+    }
+    for (size_t index = 0; index < count; ++index) {
+      VINEYARD_CHECK_OK(results[index].get());
+      CHECK_EQ(metas[index].GetId(), ids[index]);
+    }
+  }
+
+  {
+    std::vector<std::future<Status>> results;
+    for (auto const id : ids) {
+      results.emplace_back(async_client.DelData(id));
+    }
+    for (auto& result : results) {
+      VINEYARD_CHECK_OK(result.get());
+    }
+    for (auto const id : ids) {
+      bool exists = true;
+      VINEYARD_CHECK_OK(client.Exists(id, exists));
+      CHECK(!exists);
+    }
+  }
+
+  async_client.Close();
+  CHECK(async_client.Persist(ids[0]).get().IsInvalid());
+
+  // the submissions that race with closing either finish or are rejected
+  {
+    VINEYARD_CHECK_OK(async_client.Open(client, 4));
+    std::thread submitter([&async_client]() {
+      for (size_t index = 0; index < 1024; ++index) {
+        auto status =
+            async_client.Submit([](Client&) { return Status::OK(); }).get();
+        CHECK(status.ok() || status.IsInvalid());
+      }
+    });
+    async_client.Close();
+    submitter.join();
+    CHECK(!async_client.Open(client, 0).ok());
+    VINEYARD_CHECK_OK(async_client.Open(client, 2));
+    VINEYARD_CHECK_OK(
+        async_client.Submit([](Client&) { return Status::OK(); }).get());
+    async_client.Close();
+  }
+  client.Disconnect();
+
+  LOG(INFO) << "Passed async client tests...";
+  return 0;
+}
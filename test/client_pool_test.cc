@@ -0,0 +1,92 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/client_pool.h"
+#include "client/ds/blob.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./client_pool_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  ClientPool pool;
+  VINEYARD_CHECK_OK(pool.Open(ipc_socket, 3));
+  CHECK_EQ(pool.Size(), 3);
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  const size_t parallelism = 8, size = 4096;
+  std::vector<ObjectID> ids(parallelism);
+  {
+    std::vector<std::thread> threads;
+    for (size_t index = 0; index < parallelism; ++index) {
+      threads.emplace_back([&pool, &ids, index]() {
+        Client& client = pool.Get();
+        CHECK_EQ(&client, &pool.Get());
+        std::unique_ptr<BlobWriter> blob_writer;
+        VINEYARD_CHECK_OK(client.CreateBlob(size, blob_writer));
+        for (size_t offset = 0; offset < size; ++offset) {
+          blob_writer->data()[offset] = static_cast<char>(index + offset);
+        }
+        ids[index] = blob_writer->Seal(client)->id();
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  {
+    // every connection reads all blobs, through the shared mmap table
+    std::vector<std::thread> threads;
+    for (size_t index = 0; index < parallelism; ++index) {
+      threads.emplace_back([&pool, &ids]() {
+        Client& client = pool.Get();
+        for (size_t index = 0; index < ids.size(); ++index) {
+          std::shared_ptr<Blob> blob;
+          VINEYARD_CHECK_OK(client.GetObject(ids[index], blob));
+          CHECK_GE(blob->allocated_size(), size);
+          CHECK(client.IsSharedMemory(blob->data()));
+          for (size_t offset = 0; offset < size; ++offset) {
+            CHECK_EQ(blob->data()[offset], static_cast<char>(index + offset));
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  VINEYARD_CHECK_OK(pool.Get().DelData(ids));
+  pool.Close();
+
+  LOG(INFO) << "Passed client pool tests...";
+  return 0;
+}
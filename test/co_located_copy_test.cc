@@ -0,0 +1,112 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The "create" step makes an object on one instance and prints its id, which
+// is then copied by `vineyard-migrate` to another instance on the same host,
+// and the "check" step verifies the copy on that instance.
+
+constexpr size_t kSizes[] = {1, 4097, 8 * 1024 * 1024 + 3};
+constexpr size_t kBlobs = sizeof(kSizes) / sizeof(kSizes[0]);
+
+static char content(size_t const blob, size_t const offset) {
+  return static_cast<char>((blob * 17 + offset) % 247);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printf(
+        "usage ./co_located_copy_test <ipc_socket> <create|check> "
+        "[<object_id> <copied_object_id>]");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  std::string step = std::string(argv[2]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  if (step == "create") {
+    ObjectMeta meta;
+    meta.SetTypeName("vineyard::test::CoLocated");
+    size_t nbytes = 0;
+    for (size_t blob = 0; blob < kBlobs; ++blob) {
+      std::unique_ptr<BlobWriter> writer;
+      VINEYARD_CHECK_OK(client.CreateBlob(kSizes[blob], writer));
+      for (size_t i = 0; i < kSizes[blob]; ++i) {
+        writer->data()[i] = content(blob, i);
+      }
+      meta.AddMember("buffer_" + std::to_string(blob), writer->Seal(client));
+      nbytes += kSizes[blob];
+    }
+    meta.AddMember("empty", Blob::MakeEmpty(client));
+    meta.SetNBytes(nbytes);
+    ObjectID id = InvalidObjectID();
+    VINEYARD_CHECK_OK(client.CreateMetaData(meta, id));
+    VINEYARD_CHECK_OK(client.Persist(id));
+    std::cout << ObjectIDToString(id) << std::endl;
+  } else {
+    CHECK_GE(argc, 5);
+    ObjectID id = ObjectIDFromString(argv[3]);
+    ObjectID copied_id = ObjectIDFromString(argv[4]);
+    CHECK_NE(copied_id, id);
+
+    ObjectMeta origin;
+    VINEYARD_CHECK_OK(client.GetMetaData(id, origin, true));
+    CHECK_NE(origin.GetInstanceId(), client.instance_id());
+
+    // every blob of the copy is a blob of this instance, with the same
+    // contents as the origin
+    ObjectMeta meta;
+    VINEYARD_CHECK_OK(client.GetMetaData(copied_id, meta));
+    CHECK_EQ(meta.GetTypeName(), origin.GetTypeName());
+    CHECK_EQ(meta.GetInstanceId(), client.instance_id());
+    for (size_t blob = 0; blob < kBlobs; ++blob) {
+      std::string const name = "buffer_" + std::to_string(blob);
+      CHECK_NE(meta.GetMemberMeta(name).GetId(),
+               origin.GetMemberMeta(name).GetId());
+      auto member = std::dynamic_pointer_cast<Blob>(meta.GetMember(name));
+      CHECK(member != nullptr);
+      CHECK_EQ(member->meta().GetInstanceId(), client.instance_id());
+      CHECK_EQ(member->allocated_size(), kSizes[blob]);
+      for (size_t i = 0; i < kSizes[blob]; ++i) {
+        CHECK_EQ(member->data()[i], content(blob, i));
+      }
+    }
+    CHECK_EQ(meta.GetMemberMeta("empty").GetId(), EmptyBlobID());
+    VINEYARD_CHECK_OK(client.DelData(copied_id, true, true));
+    LOG(INFO) << "Checked the copy " << ObjectIDToString(copied_id) << " of "
+              << ObjectIDToString(id);
+  }
+
+  LOG(INFO) << "Passed co-located copy tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,117 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+#include "common/util/uuid.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The metadata creations that arrive at the same time are applied as a group,
+// where each one sees the objects created by the earlier ones, e.g., the new
+// member that they share.
+
+constexpr size_t kClients = 16;
+constexpr size_t kObjectsPerClient = 32;
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./concurrent_create_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // the shared member is created along with the wrappers that refer to it
+  ObjectID const member_id = GenerateObjectID();
+  ObjectMeta member;
+  member.SetId(member_id);
+  member.SetTypeName("vineyard::test::SharedMember");
+  member.SetNBytes(0);
+  member.AddKeyValue("instance_id", client.instance_id());
+  member.AddKeyValue("transient", true);
+  member.AddKeyValue("signature", GenerateSignature());
+  member.AddKeyValue("value", "shared");
+
+  std::vector<std::vector<ObjectID>> created(kClients);
+  std::vector<std::thread> threads;
+  for (size_t index = 0; index < kClients; ++index) {
+    threads.emplace_back([&, index]() {
+      Client writer;
+      VINEYARD_CHECK_OK(writer.Connect(ipc_socket));
+      for (size_t seq = 0; seq < kObjectsPerClient; ++seq) {
+        ObjectMeta meta;
+        meta.SetTypeName("vineyard::test::Wrapper");
+        meta.SetNBytes(0);
+        meta.AddKeyValue("client", index);
+        meta.AddKeyValue("seq", seq);
+        meta.AddMember("member", member);
+        ObjectID id = InvalidObjectID();
+        VINEYARD_CHECK_OK(writer.CreateMetaData(meta, id));
+        created[index].emplace_back(id);
+      }
+      writer.Disconnect();
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // every wrapper resolves the same member
+  for (size_t index = 0; index < kClients; ++index) {
+    CHECK_EQ(created[index].size(), kObjectsPerClient);
+    for (size_t seq = 0; seq < kObjectsPerClient; ++seq) {
+      ObjectMeta meta;
+      VINEYARD_CHECK_OK(client.GetMetaData(created[index][seq], meta));
+      CHECK_EQ(meta.GetKeyValue<size_t>("client"), index);
+      CHECK_EQ(meta.GetKeyValue<size_t>("seq"), seq);
+      ObjectMeta shared = meta.GetMemberMeta("member");
+      CHECK_EQ(shared.GetId(), member_id);
+      CHECK_EQ(shared.GetKeyValue("value"), "shared");
+    }
+  }
+
+  // the member is kept until the last wrapper is gone
+  auto metas = client.ListObjectMeta("vineyard::test::SharedMember");
+  CHECK_EQ(metas.size(), 1U);
+  for (size_t index = 0; index < kClients; ++index) {
+    VINEYARD_CHECK_OK(client.DelData(created[index], false, false));
+  }
+  bool exists = false;
+  VINEYARD_CHECK_OK(client.Exists(member_id, exists));
+  CHECK(exists);
+  VINEYARD_CHECK_OK(client.DelData(member_id));
+  VINEYARD_CHECK_OK(client.Exists(member_id, exists));
+  CHECK(!exists);
+
+  LOG(INFO) << "Passed concurrent creation tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,103 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/memory/memcpy.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// Copies that are done by a single memcpy, and the ones that are split into
+// chunks, with sizes and addresses that aren't aligned to the cache line.
+constexpr size_t kLargeSize = memory::kConcurrentMemcpyThreshold * 2 + 12345;
+
+uint8_t content(size_t const offset) {
+  return static_cast<uint8_t>((offset * 31 + 7) % 253);
+}
+
+void checkCopy(std::vector<uint8_t> const& source, size_t const src_offset,
+               size_t const dst_offset, size_t const size,
+               size_t const concurrency) {
+  std::vector<uint8_t> target(dst_offset + size + 64, 0xff);
+  memory::concurrent_memcpy(target.data() + dst_offset,
+                            source.data() + src_offset, size, concurrency);
+  CHECK_EQ(memcmp(target.data() + dst_offset, source.data() + src_offset,
+                  size),
+           0);
+  // nothing around the destination is touched
+  for (size_t index = 0; index < dst_offset; ++index) {
+    CHECK_EQ(target[index], 0xff);
+  }
+  for (size_t index = dst_offset + size; index < target.size(); ++index) {
+    CHECK_EQ(target[index], 0xff);
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./concurrent_memcpy_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  std::vector<uint8_t> source(kLargeSize + 64);
+  for (size_t index = 0; index < source.size(); ++index) {
+    source[index] = content(index);
+  }
+
+  for (size_t size : {static_cast<size_t>(0), static_cast<size_t>(1),
+                      static_cast<size_t>(4097),
+                      memory::kConcurrentMemcpyThreshold - 1}) {
+    checkCopy(source, 3, 5, size, 0);
+  }
+  LOG(INFO) << "Passed small copies tests...";
+
+  for (size_t concurrency : {0, 1, 3, 8, 1000}) {
+    checkCopy(source, 0, 0, kLargeSize, concurrency);
+    checkCopy(source, 1, 63, kLargeSize, concurrency);
+    checkCopy(source, 17, 32, memory::kConcurrentMemcpyThreshold,
+              concurrency);
+  }
+  LOG(INFO) << "Passed large copies tests...";
+
+  // into the shared memory of a blob
+  {
+    Client client;
+    VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+    LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+    std::unique_ptr<BlobWriter> blob_writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(kLargeSize, blob_writer));
+    memory::concurrent_memcpy(blob_writer->data(), source.data(), kLargeSize);
+    auto blob = std::dynamic_pointer_cast<Blob>(blob_writer->Seal(client));
+    CHECK_EQ(blob->size(), kLargeSize);
+    CHECK_EQ(memcmp(blob->data(), source.data(), kLargeSize), 0);
+    VINEYARD_CHECK_OK(client.DelData(blob->id()));
+    client.Disconnect();
+  }
+  LOG(INFO) << "Passed copying into blobs tests...";
+
+  LOG(INFO) << "Passed concurrent memcpy tests...";
+
+  return 0;
+}
@@ -0,0 +1,117 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <unistd.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./copy_on_write_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  size_t const page_size = getpagesize();
+  size_t const size = 8 * page_size + 123;
+
+  std::unique_ptr<BlobWriter> writer;
+  VINEYARD_CHECK_OK(client.CreateBlob(size, writer));
+  for (size_t i = 0; i < size; ++i) {
+    writer->data()[i] = static_cast<char>(i % 251);
+  }
+  auto parent = std::dynamic_pointer_cast<Blob>(writer->Seal(client));
+
+  // modifies a few bytes in the middle and at the end
+  size_t const middle = 3 * page_size + 10;
+  std::unique_ptr<BlobWriter> child_writer;
+  VINEYARD_CHECK_OK(client.CreateCopyOnWriteBlob(
+      parent->id(), {{middle, 16}, {size - 1, 1}}, child_writer));
+  CHECK_EQ(child_writer->size(), size);
+  for (size_t i = 0; i < size; ++i) {
+    CHECK_EQ(child_writer->data()[i], static_cast<char>(i % 251));
+  }
+  for (size_t i = middle; i < middle + 16; ++i) {
+    child_writer->data()[i] = 'x';
+  }
+  child_writer->data()[size - 1] = 'y';
+  auto child = std::dynamic_pointer_cast<Blob>(child_writer->Seal(client));
+
+  auto expect = [&](std::shared_ptr<arrow::Buffer> const& buffer,
+                    bool const modified) {
+    CHECK_EQ(static_cast<size_t>(buffer->size()), size);
+    for (size_t i = 0; i < size; ++i) {
+      char value = static_cast<char>(i % 251);
+      if (modified && i >= middle && i < middle + 16) {
+        value = 'x';
+      } else if (modified && i == size - 1) {
+        value = 'y';
+      }
+      CHECK_EQ(static_cast<char>(buffer->data()[i]), value);
+    }
+  };
+
+  {
+    std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
+    VINEYARD_CHECK_OK(client.GetBuffers({parent->id(), child->id()}, buffers));
+    CHECK_EQ(buffers.size(), 2U);
+    expect(buffers.at(parent->id()), false);
+    expect(buffers.at(child->id()), true);
+  }
+
+  // the dirty ranges must be inside the parent
+  {
+    std::unique_ptr<BlobWriter> invalid;
+    CHECK(!client.CreateCopyOnWriteBlob(parent->id(), {{size, 1}}, invalid)
+               .ok());
+  }
+
+  // the shared pages outlive the deletion of the parent
+  VINEYARD_CHECK_OK(client.DelData(parent->id()));
+  {
+    Client other;
+    VINEYARD_CHECK_OK(other.Connect(ipc_socket));
+    std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
+    VINEYARD_CHECK_OK(other.GetBuffers({child->id()}, buffers));
+    CHECK_EQ(buffers.size(), 1U);
+    expect(buffers.at(child->id()), true);
+    other.Disconnect();
+  }
+  VINEYARD_CHECK_OK(client.DelData(child->id()));
+
+  LOG(INFO) << "Passed copy-on-write blob tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
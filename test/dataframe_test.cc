@@ -152,6 +152,32 @@ int main(int argc, char** argv) {
 
   LOG(INFO) << "Passed dataframe tests...";
 
+  {
+    ChunkedDataFrameBuilder chunked_builder(client);
+    VINEYARD_CHECK_OK(chunked_builder.Append(df));
+    auto chunked = std::dynamic_pointer_cast<ChunkedDataFrame>(
+        chunked_builder.Seal(client));
+    CHECK_EQ(chunked->shape().first, 100);
+
+    // append the same chunk again, without touching the existing chunks
+    ChunkedDataFrameBuilder append_builder(client, chunked);
+    VINEYARD_CHECK_OK(append_builder.Append(df));
+    auto appended = std::dynamic_pointer_cast<ChunkedDataFrame>(
+        append_builder.Seal(client));
+    CHECK_EQ(appended->shape().first, 200);
+    CHECK_EQ(appended->shape().second, 4);
+    CHECK_EQ(appended->Chunks().size(), 2);
+    CHECK_EQ(appended->Chunks()[0]->id(), df->id());
+    CHECK_EQ(appended->Column("a").size(), 2);
+
+    std::shared_ptr<arrow::Table> table;
+    VINEYARD_CHECK_OK(appended->AsTable(table));
+    CHECK_EQ(table->num_rows(), 200);
+    CHECK_EQ(table->column(0)->num_chunks(), 2);
+  }
+
+  LOG(INFO) << "Passed chunked dataframe tests...";
+
   client.Disconnect();
 
   return 0;
@@ -0,0 +1,151 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The vineyardd is expected to be launched with `--deduplicate_blobs`.
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./deduplication_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // large enough to be allocated outside the slabs
+  size_t const size = 4 * 1024 * 1024 + 123;
+
+  auto footprint = [&]() -> size_t {
+    std::shared_ptr<InstanceStatus> status;
+    VINEYARD_CHECK_OK(client.InstanceStatus(status));
+    return status->memory_usage;
+  };
+  auto fill = [&](std::unique_ptr<BlobWriter> const& writer) {
+    for (size_t i = 0; i < size; ++i) {
+      writer->data()[i] = static_cast<char>(i % 251);
+    }
+  };
+  auto expect = [&](std::shared_ptr<arrow::Buffer> const& buffer) {
+    CHECK_EQ(static_cast<size_t>(buffer->size()), size);
+    for (size_t i = 0; i < size; ++i) {
+      CHECK_EQ(static_cast<char>(buffer->data()[i]), static_cast<char>(i % 251));
+    }
+  };
+
+  size_t const initial = footprint();
+  std::unique_ptr<BlobWriter> target_writer;
+  VINEYARD_CHECK_OK(client.CreateBlob(size, target_writer));
+  fill(target_writer);
+  auto target = std::dynamic_pointer_cast<Blob>(target_writer->Seal(client));
+  size_t const with_target = footprint();
+  CHECK_GE(with_target - initial, size);
+
+  // the identical blob is allocated, then freed when being sealed
+  std::unique_ptr<BlobWriter> alias_writer;
+  VINEYARD_CHECK_OK(client.CreateBlob(size, alias_writer));
+  fill(alias_writer);
+  CHECK_GE(footprint() - with_target, size);
+  auto alias = std::dynamic_pointer_cast<Blob>(alias_writer->Seal(client));
+  CHECK_NE(alias->id(), target->id());
+  CHECK_EQ(footprint(), with_target);
+  expect(alias->Buffer());
+
+  // both blobs are served from the same location
+  {
+    Client other;
+    VINEYARD_CHECK_OK(other.Connect(ipc_socket));
+    std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
+    VINEYARD_CHECK_OK(other.GetBuffers({target->id(), alias->id()}, buffers));
+    CHECK_EQ(buffers.size(), 2U);
+    CHECK_EQ(buffers.at(target->id())->data(), buffers.at(alias->id())->data());
+    expect(buffers.at(target->id()));
+    expect(buffers.at(alias->id()));
+    other.Disconnect();
+  }
+
+  // the pages of the target outlive its deletion, until the alias is gone
+  VINEYARD_CHECK_OK(client.DelData(target->id()));
+  CHECK_EQ(footprint(), with_target);
+  {
+    Client other;
+    VINEYARD_CHECK_OK(other.Connect(ipc_socket));
+    std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
+    VINEYARD_CHECK_OK(other.GetBuffers({alias->id()}, buffers));
+    CHECK_EQ(buffers.size(), 1U);
+    expect(buffers.at(alias->id()));
+    other.Disconnect();
+  }
+  VINEYARD_CHECK_OK(client.DelData(alias->id()));
+  CHECK_GE(with_target - footprint(), size);
+
+  // the blobs of a group are sealed with a single batch, and are deduplicated
+  // against each other
+  {
+    size_t const before = footprint();
+    std::unique_ptr<BlobWriterGroup> group;
+    VINEYARD_CHECK_OK(BlobWriterGroup::Make(client, {size, size, size}, group));
+    for (size_t index = 0; index < group->size(); ++index) {
+      auto const& writer = group->Writer(index);
+      for (size_t i = 0; i < size; ++i) {
+        writer->data()[i] = static_cast<char>(i % 251);
+      }
+    }
+    std::vector<std::shared_ptr<Blob>> blobs;
+    VINEYARD_CHECK_OK(group->Seal(client, blobs));
+    CHECK_EQ(blobs.size(), 3U);
+    size_t const with_group = footprint();
+    CHECK_GE(with_group - before, size);
+    CHECK_LT(with_group - before, 2 * size);
+    for (auto const& blob : blobs) {
+      expect(blob->Buffer());
+    }
+
+    // other requests still work after the batch
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(size, writer));
+    fill(writer);
+    auto blob = std::dynamic_pointer_cast<Blob>(writer->Seal(client));
+    CHECK_EQ(footprint(), with_group);
+    expect(blob->Buffer());
+
+    VINEYARD_CHECK_OK(client.DelData(blob->id()));
+    for (auto const& item : blobs) {
+      VINEYARD_CHECK_OK(client.DelData(item->id()));
+    }
+  }
+
+  LOG(INFO) << "Passed blob deduplication tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,149 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// Many clients wait for their own names, and each update of a name wakes
+// exactly the waiters of that name.
+
+constexpr size_t kWaiters = 128;
+
+static void waitFor(std::function<bool()> const& predicate) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+  while (!predicate()) {
+    CHECK(std::chrono::steady_clock::now() < deadline);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+}
+
+static size_t deferredRequests(Client& client) {
+  std::shared_ptr<InstanceStatus> status;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  return status->deferred_requests;
+}
+
+static std::string nameOf(size_t const index) {
+  return "deferred_name_test_" + std::to_string(index);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./deferred_name_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  ObjectID id = InvalidObjectID();
+  {
+    ObjectMeta meta;
+    meta.SetTypeName("vineyard::test::NamedObject");
+    meta.SetNBytes(0);
+    VINEYARD_CHECK_OK(client.CreateMetaData(meta, id));
+    VINEYARD_CHECK_OK(client.Persist(id));
+  }
+
+  // drops the waiters that have gone away, if any, before counting
+  VINEYARD_CHECK_OK(client.PutName(id, nameOf(2 * kWaiters)));
+  size_t deferred = deferredRequests(client);
+  std::vector<std::atomic<bool>> woken(kWaiters);
+  for (auto& flag : woken) {
+    flag.store(false);
+  }
+  std::atomic<size_t> connected{0};
+  std::vector<std::thread> waiters;
+  for (size_t index = 0; index < kWaiters; ++index) {
+    waiters.emplace_back([&, index]() {
+      Client waiter;
+      VINEYARD_CHECK_OK(waiter.Connect(ipc_socket));
+      connected.fetch_add(1);
+      ObjectID named = InvalidObjectID();
+      VINEYARD_CHECK_OK(waiter.GetName(nameOf(index), named, true));
+      CHECK_EQ(named, id);
+      woken[index].store(true);
+      waiter.Disconnect();
+    });
+  }
+  waitFor([&]() {
+    return connected.load() == kWaiters &&
+           deferredRequests(client) == deferred + kWaiters;
+  });
+
+  // the updates of the other names wake no one
+  for (size_t index = kWaiters; index < 2 * kWaiters; ++index) {
+    VINEYARD_CHECK_OK(client.PutName(id, nameOf(index)));
+  }
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  for (auto const& flag : woken) {
+    CHECK(!flag.load());
+  }
+  CHECK_EQ(deferredRequests(client), deferred + kWaiters);
+  LOG(INFO) << "Passed waiting for names tests...";
+
+  // every name wakes its own waiter only
+  for (size_t index = 0; index < kWaiters; index += 2) {
+    VINEYARD_CHECK_OK(client.PutName(id, nameOf(index)));
+  }
+  waitFor([&]() {
+    for (size_t index = 0; index < kWaiters; index += 2) {
+      if (!woken[index].load()) {
+        return false;
+      }
+    }
+    return true;
+  });
+  for (size_t index = 1; index < kWaiters; index += 2) {
+    CHECK(!woken[index].load());
+  }
+  waitFor([&]() {
+    return deferredRequests(client) == deferred + kWaiters / 2;
+  });
+
+  for (size_t index = 1; index < kWaiters; index += 2) {
+    VINEYARD_CHECK_OK(client.PutName(id, nameOf(index)));
+  }
+  for (auto& waiter : waiters) {
+    waiter.join();
+  }
+  waitFor([&]() { return deferredRequests(client) == deferred; });
+  LOG(INFO) << "Passed waking waiters tests...";
+
+  for (size_t index = 0; index <= 2 * kWaiters; ++index) {
+    VINEYARD_CHECK_OK(client.DropName(nameOf(index)));
+  }
+  VINEYARD_CHECK_OK(client.DelData(id));
+  client.Disconnect();
+
+  LOG(INFO) << "Passed deferred name tests...";
+
+  return 0;
+}
@@ -323,6 +323,87 @@ int main(int argc, char** argv) {
   CHECK_EQ(status_before->memory_limit, status_after->memory_limit);
   CHECK_EQ(status_before->memory_usage, status_after->memory_usage);
 
+  // delete objects that share a member with many referrers
+  {
+    constexpr size_t kWrappers = 1024;
+    std::vector<double> double_array = {1.0, 7.0, 3.0, 4.0, 2.0};
+    ArrayBuilder<double> builder(client, double_array);
+    auto shared = builder.Seal(client);
+    id = shared->id();
+    blob_id = shared->meta().GetMemberMeta("buffer_").GetId();
+
+    std::vector<ObjectID> wrappers;
+    ObjectMeta group;
+    group.SetTypeName("vineyard::test::Group");
+    group.SetNBytes(0);
+    for (size_t index = 0; index < kWrappers; ++index) {
+      ObjectMeta meta;
+      meta.SetTypeName("vineyard::test::Wrapper");
+      meta.SetNBytes(0);
+      meta.AddMember("member", id);
+      ObjectID wrapper = InvalidObjectID();
+      VINEYARD_CHECK_OK(client.CreateMetaData(meta, wrapper));
+      wrappers.emplace_back(wrapper);
+      group.AddMember("member_" + std::to_string(index), wrapper);
+    }
+    ObjectID group_id = InvalidObjectID();
+    VINEYARD_CHECK_OK(client.CreateMetaData(group, group_id));
+
+    // the member that is still referred to is kept
+    VINEYARD_CHECK_OK(client.DelData(id, false, false));
+    VINEYARD_CHECK_OK(client.Exists(id, exists));
+    CHECK(exists);
+
+    // the shallow deletion keeps the members
+    VINEYARD_CHECK_OK(client.DelData(group_id, false, false));
+    VINEYARD_CHECK_OK(client.Exists(group_id, exists));
+    CHECK(!exists);
+    for (auto const wrapper : wrappers) {
+      VINEYARD_CHECK_OK(client.Exists(wrapper, exists));
+      CHECK(exists);
+    }
+
+    // the shared member goes away with its last referrer
+    VINEYARD_CHECK_OK(client.DelData(
+        std::vector<ObjectID>(wrappers.begin(), wrappers.end() - 1), false,
+        true));
+    VINEYARD_CHECK_OK(client.Exists(wrappers.front(), exists));
+    CHECK(!exists);
+    VINEYARD_CHECK_OK(client.Exists(id, exists));
+    CHECK(exists);
+    VINEYARD_CHECK_OK(client.DelData(wrappers.back(), false, true));
+    VINEYARD_CHECK_OK(client.Exists(wrappers.back(), exists));
+    CHECK(!exists);
+    VINEYARD_CHECK_OK(client.Exists(id, exists));
+    CHECK(!exists);
+    VINEYARD_CHECK_OK(client.Exists(blob_id, exists));
+    CHECK(!exists);
+  }
+
+  // force deletion of a member removes all of its referrers
+  {
+    std::vector<double> double_array = {1.0, 7.0, 3.0, 4.0, 2.0};
+    ArrayBuilder<double> builder(client, double_array);
+    id = builder.Seal(client)->id();
+    std::vector<ObjectID> wrappers;
+    for (size_t index = 0; index < 64; ++index) {
+      ObjectMeta meta;
+      meta.SetTypeName("vineyard::test::Wrapper");
+      meta.SetNBytes(0);
+      meta.AddMember("member", id);
+      ObjectID wrapper = InvalidObjectID();
+      VINEYARD_CHECK_OK(client.CreateMetaData(meta, wrapper));
+      wrappers.emplace_back(wrapper);
+    }
+    VINEYARD_CHECK_OK(client.DelData(id, true, false));
+    VINEYARD_CHECK_OK(client.Exists(id, exists));
+    CHECK(!exists);
+    for (auto const wrapper : wrappers) {
+      VINEYARD_CHECK_OK(client.Exists(wrapper, exists));
+      CHECK(!exists);
+    }
+  }
+
   LOG(INFO) << "Passed delete tests...";
 
   client.Disconnect();
@@ -0,0 +1,121 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/memory/cuda.h"
+#include "common/memory/payload.h"
+#include "common/util/json.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// vineyardd and the client are expected to be built with the same `USE_CUDA`,
+// and the device blobs are checked only when a CUDA device is available.
+constexpr size_t kDeviceBlobSize = 1024 * 1024 + 7;
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./device_blob_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  // the device and the IPC handle are only serialized for device blobs
+  {
+    Payload host(GenerateBlobID(reinterpret_cast<uintptr_t>(&ipc_socket)), 16,
+                 nullptr, 3, 32, 0);
+    json tree = host.ToJSON();
+    CHECK(!tree.contains("device"));
+    CHECK(!tree.contains("ipc_handle"));
+    Payload host_copy;
+    host_copy.FromJSON(tree);
+    CHECK(!host_copy.IsDevice());
+
+    Payload device = host;
+    device.device = 1;
+    device.ipc_handle = "0123456789abcdef";
+    tree = device.ToJSON();
+    CHECK_EQ(tree["device"].get<int>(), 1);
+    Payload device_copy;
+    device_copy.FromJSON(tree);
+    CHECK(device_copy.IsDevice());
+    CHECK_EQ(device_copy.device, 1);
+    CHECK_EQ(device_copy.ipc_handle, device.ipc_handle);
+    CHECK_EQ(device_copy.data_size, device.data_size);
+  }
+  LOG(INFO) << "Passed device payload tests...";
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  {
+    std::unique_ptr<BlobWriter> blob_writer;
+    CHECK(client.CreateDeviceBlob(kDeviceBlobSize, -1, blob_writer)
+              .IsInvalid());
+
+    // the empty blob needs no device
+    VINEYARD_CHECK_OK(client.CreateDeviceBlob(0, 0, blob_writer));
+    CHECK_EQ(blob_writer->id(), EmptyBlobID());
+  }
+
+  if (!memory::cuda_enabled()) {
+    uint8_t* pointer = nullptr;
+    CHECK(memory::cuda_malloc(0, kDeviceBlobSize, &pointer).IsNotImplemented());
+    std::unique_ptr<BlobWriter> blob_writer;
+    CHECK(client.CreateDeviceBlob(kDeviceBlobSize, 0, blob_writer)
+              .IsNotImplemented());
+    LOG(INFO) << "Skipped device blobs tests, as CUDA isn't enabled";
+  } else {
+    std::unique_ptr<BlobWriter> blob_writer;
+    auto status = client.CreateDeviceBlob(kDeviceBlobSize, 0, blob_writer);
+    if (!status.ok()) {
+      LOG(INFO) << "Skipped device blobs tests, as no CUDA device is "
+                   "available: "
+                << status.ToString();
+    } else {
+      CHECK_EQ(blob_writer->size(), kDeviceBlobSize);
+      CHECK(blob_writer->data() != nullptr);
+      auto blob = std::dynamic_pointer_cast<Blob>(blob_writer->Seal(client));
+      CHECK_EQ(blob->size(), kDeviceBlobSize);
+
+      // another client opens the device memory by the IPC handle
+      Client reader;
+      VINEYARD_CHECK_OK(reader.Connect(ipc_socket));
+      Payload payload;
+      VINEYARD_CHECK_OK(reader.GetBlob(blob->id(), payload));
+      CHECK(payload.IsDevice());
+      CHECK_EQ(payload.device, 0);
+      CHECK(!payload.ipc_handle.empty());
+      CHECK_EQ(static_cast<size_t>(payload.data_size), kDeviceBlobSize);
+      reader.Disconnect();
+
+      VINEYARD_CHECK_OK(client.DelData(blob->id()));
+      LOG(INFO) << "Passed device blobs tests...";
+    }
+  }
+
+  client.Disconnect();
+
+  LOG(INFO) << "Passed device blob tests...";
+
+  return 0;
+}
@@ -0,0 +1,109 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "basic/ds/encoded_array.h"
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+void check_encoding(Client& client, std::shared_ptr<arrow::Int64Array> array,
+                    ArrayEncoding encoding) {
+  EncodedArrayBuilder<int64_t> builder(client, array, encoding);
+  auto sealed = std::dynamic_pointer_cast<EncodedArray<int64_t>>(
+      builder.Seal(client));
+  VINEYARD_CHECK_OK(client.Persist(sealed->id()));
+  auto encoded = std::dynamic_pointer_cast<EncodedArray<int64_t>>(
+      client.GetObject(sealed->id()));
+  CHECK(encoded->encoding() == encoding);
+  CHECK_EQ(encoded->length(), static_cast<size_t>(array->length()));
+  CHECK_EQ(encoded->null_count(), array->null_count());
+
+  for (int64_t i = 0; i < array->length(); ++i) {
+    CHECK_EQ(encoded->IsNull(i), array->IsNull(i));
+    if (array->IsValid(i)) {
+      CHECK_EQ(encoded->Value(i), array->Value(i));
+    }
+  }
+
+  std::vector<int64_t> values(array->length() - 10);
+  VINEYARD_CHECK_OK(encoded->Decode(5, values.size(), values.data()));
+  for (size_t i = 0; i < values.size(); ++i) {
+    if (array->IsValid(i + 5)) {
+      CHECK_EQ(values[i], array->Value(i + 5));
+    }
+  }
+
+  std::shared_ptr<arrow::Int64Array> decoded;
+  VINEYARD_CHECK_OK(encoded->ToArray(decoded));
+  CHECK_EQ(decoded->null_count(), array->null_count());
+  for (int64_t i = 0; i < array->length(); ++i) {
+    CHECK_EQ(decoded->IsNull(i), array->IsNull(i));
+    if (array->IsValid(i)) {
+      CHECK_EQ(decoded->Value(i), array->Value(i));
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./encoded_array_test <ipc_socket_name>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  arrow::Int64Builder b1;
+  for (int64_t i = 0; i < 1000; ++i) {
+    if (i % 97 == 3) {
+      CHECK_ARROW_ERROR(b1.AppendNull());
+    } else {
+      CHECK_ARROW_ERROR(b1.Append(-500 + (i / 10) * 7));
+    }
+  }
+  std::shared_ptr<arrow::Int64Array> a1;
+  CHECK_ARROW_ERROR(b1.Finish(&a1));
+
+  for (auto encoding :
+       {ArrayEncoding::kFrameOfReference, ArrayEncoding::kDictionary,
+        ArrayEncoding::kRunLength}) {
+    check_encoding(client, a1, encoding);
+  }
+  LOG(INFO) << "Passed encoded array tests...";
+
+  {
+    // 10-bit offsets are smaller than both 100 runs and 100 dictionary values
+    EncodedArrayBuilder<int64_t> builder(client, a1);
+    CHECK(builder.encoding() == ArrayEncoding::kFrameOfReference);
+    CHECK_LT(builder.EncodedSize(), a1->length() * sizeof(int64_t) / 4);
+  }
+  LOG(INFO) << "Passed encoding selection tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,126 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/json.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The vineyardd is expected to be launched with a 64 MiB `--size`, a
+// 256 MiB `--far_memory_size` and no `--spill_path`, thus most of the blobs
+// below live in the far memory tier, as they are neither spilled nor dropped.
+
+constexpr size_t kBlobs = 32;
+constexpr size_t kRounds = 3;
+
+// large enough to be allocated outside the slabs
+constexpr size_t kSize = 4 * 1024 * 1024 + 123;
+
+static void waitFor(std::function<bool()> const& predicate) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+  while (!predicate()) {
+    CHECK(std::chrono::steady_clock::now() < deadline);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+}
+
+static char content(size_t const blob, size_t const offset) {
+  return static_cast<char>((blob * 31 + offset) % 251);
+}
+
+static size_t farMemoryUsage(Client& client) {
+  json usage;
+  VINEYARD_CHECK_OK(client.MemoryAttribution(usage));
+  return usage["far_memory_usage"].get<size_t>();
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./far_memory_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  // the blobs are released by the writer once it disconnects, and then are
+  // demoted to make room for the next ones
+  std::vector<ObjectID> ids;
+  for (size_t blob = 0; blob < kBlobs; ++blob) {
+    Client writer;
+    VINEYARD_CHECK_OK(writer.Connect(ipc_socket));
+    std::unique_ptr<BlobWriter> blob_writer;
+    VINEYARD_CHECK_OK(writer.CreateBlob(kSize, blob_writer));
+    for (size_t i = 0; i < kSize; ++i) {
+      blob_writer->data()[i] = content(blob, i);
+    }
+    ids.emplace_back(blob_writer->Seal(writer)->id());
+    writer.Disconnect();
+  }
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+  size_t far_usage = farMemoryUsage(client);
+  CHECK_GE(far_usage, (kBlobs / 2) * kSize);
+  CHECK_LE(far_usage, 256U * 1024 * 1024);
+  LOG(INFO) << "Passed demoting blobs tests...";
+
+  // the blobs keep their ids and contents in either tier, the repeated
+  // accesses promote some of them back, which demotes the others in turn
+  for (size_t round = 0; round < kRounds; ++round) {
+    for (size_t blob = 0; blob < kBlobs; ++blob) {
+      Client reader;
+      VINEYARD_CHECK_OK(reader.Connect(ipc_socket));
+      std::vector<std::shared_ptr<Blob>> blobs;
+      VINEYARD_CHECK_OK(reader.GetBlobs({ids[blob]}, blobs));
+      CHECK_EQ(blobs.size(), 1U);
+      auto const& item = blobs[0];
+      CHECK_EQ(item->id(), ids[blob]);
+      CHECK_EQ(item->allocated_size(), kSize);
+      for (size_t i = 0; i < kSize; i += 4093) {
+        CHECK_EQ(item->data()[i], content(blob, i));
+      }
+      reader.Disconnect();
+    }
+  }
+  CHECK_GT(farMemoryUsage(client), 0U);
+  LOG(INFO) << "Passed reading far blobs tests...";
+
+  // the far memory is freed with the blobs
+  VINEYARD_CHECK_OK(client.DelData(ids));
+  for (auto const id : ids) {
+    bool exists = true;
+    VINEYARD_CHECK_OK(client.Exists(id, exists));
+    CHECK(!exists);
+  }
+  waitFor([&]() { return farMemoryUsage(client) == 0; });
+  LOG(INFO) << "Passed freeing far blobs tests...";
+
+  client.Disconnect();
+
+  LOG(INFO) << "Passed far memory tests...";
+
+  return 0;
+}
@@ -22,6 +22,7 @@ limitations under the License.
 #include "arrow/util/logging.h"
 
 #include "basic/ds/array.h"
+#include "basic/ds/pair.h"
 #include "client/client.h"
 #include "client/ds/object_meta.h"
 #include "common/util/logging.h"
@@ -84,8 +85,82 @@ int main(int argc, char** argv) {
   CHECK_EQ(arrays[0]->id(), id);
   CHECK_EQ(arrays[1]->id(), copied_id);
 
+  {
+    // the forked client reuses the fds and mappings of this client
+    Client forked;
+    VINEYARD_CHECK_OK(client.Fork(forked));
+    auto array1 = forked.GetObject<Array<double>>(id);
+    CHECK(array1 != nullptr);
+    CHECK_EQ(array1->data(), sealed_double_array->data());
+    for (size_t i = 0; i < double_array.size(); ++i) {
+      CHECK_EQ((*array1)[i], double_array[i]);
+    }
+    forked.Disconnect();
+  }
+
+  {
+    // the concrete type is constructed directly, and the base type goes
+    // through the factory
+    std::shared_ptr<Array<double>> typed;
+    VINEYARD_CHECK_OK(client.GetObject(copied_id, typed));
+    CHECK_EQ(typed->id(), copied_id);
+    CHECK_EQ(typed->size(), double_array.size());
+    for (size_t i = 0; i < double_array.size(); ++i) {
+      CHECK_EQ((*typed)[i], double_array[i]);
+    }
+    std::shared_ptr<Object> base;
+    VINEYARD_CHECK_OK(client.GetObject(id, base));
+    CHECK(std::dynamic_pointer_cast<Array<double>>(base) != nullptr);
+    auto object = client.GetObject<Object>(id);
+    CHECK(std::dynamic_pointer_cast<Array<double>>(object) != nullptr);
+
+    // a missing object is reported rather than aborting
+    std::shared_ptr<Array<double>> missing;
+    CHECK(!client.GetObject(GenerateObjectID(), missing).ok());
+    CHECK(missing == nullptr);
+  }
+
   LOG(INFO) << "Passed various ways to get object tests...";
 
+  {
+    // the blobs of a nested object, large and small, are resolved up-front
+    // by a client that hasn't mapped them yet
+    std::vector<double> large(512 * 1024 + 3), small = {1.0, 2.0, 3.0};
+    for (size_t i = 0; i < large.size(); ++i) {
+      large[i] = static_cast<double>(i) * 0.5;
+    }
+    ArrayBuilder<double> large_builder(client, large);
+    ArrayBuilder<double> small_builder(client, small);
+    PairBuilder pair_builder(client);
+    pair_builder.SetFirst(large_builder.Seal(client));
+    pair_builder.SetSecond(small_builder.Seal(client));
+    ObjectID pair_id = pair_builder.Seal(client)->id();
+
+    Client reader;
+    VINEYARD_CHECK_OK(reader.Connect(ipc_socket));
+    std::shared_ptr<Pair> pair;
+    VINEYARD_CHECK_OK(reader.GetObject(pair_id, pair, true));
+    auto first = std::dynamic_pointer_cast<Array<double>>(pair->First());
+    auto second = std::dynamic_pointer_cast<Array<double>>(pair->Second());
+    CHECK(first != nullptr && second != nullptr);
+    CHECK_EQ(first->size(), large.size());
+    CHECK_EQ(second->size(), small.size());
+    for (size_t i = 0; i < large.size(); ++i) {
+      CHECK_EQ((*first)[i], large[i]);
+    }
+    for (size_t i = 0; i < small.size(); ++i) {
+      CHECK_EQ((*second)[i], small[i]);
+    }
+
+    std::shared_ptr<Object> missing;
+    CHECK(!reader.GetObject(GenerateObjectID(), missing, true).ok());
+    reader.Disconnect();
+
+    VINEYARD_CHECK_OK(client.DelData(pair_id, true, true));
+  }
+
+  LOG(INFO) << "Passed prefetching object tests...";
+
   client.Disconnect();
 
   return 0;
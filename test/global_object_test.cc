@@ -16,6 +16,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -100,6 +101,55 @@ void testGlobalDataFrame(Client& client) {
   }
 }
 
+void testPartitionIndex(Client& client) {
+  // make two row partitions of 100 and 50 rows
+  std::vector<ObjectID> dataframe_ids;
+  for (size_t index = 0; index < 2; ++index) {
+    DataFrameBuilder builder(client);
+    builder.set_partition_index(index, 0);
+    {
+      auto tb = std::make_shared<TensorBuilder<double>>(
+          client, std::vector<int64_t>{index == 0 ? 100 : 50});
+      builder.AddColumn("a", tb);
+    }
+    auto sealed = std::dynamic_pointer_cast<DataFrame>(builder.Seal(client));
+    VINEYARD_CHECK_OK(client.Persist(sealed->id()));
+    dataframe_ids.push_back(sealed->id());
+  }
+
+  ObjectID global_dataframe_id = InvalidObjectID();
+  {
+    GlobalDataFrameBuilder builder(client);
+    builder.set_partition_shape(2, 1);
+    // added out of order on purpose
+    builder.AddPartition(dataframe_ids[1]);
+    builder.AddPartition(dataframe_ids[0]);
+    global_dataframe_id = builder.Seal(client)->id();
+  }
+
+  {
+    auto global_dataframe =
+        client.GetObject<GlobalDataFrame>(global_dataframe_id);
+    CHECK_EQ(global_dataframe->num_rows(), 150UL);
+
+    auto locations = global_dataframe->LocateRows(90, 110);
+    CHECK_EQ(locations.size(), 2UL);
+    CHECK_EQ(locations[0].id, dataframe_ids[0]);
+    CHECK_EQ(locations[0].row_begin, 0UL);
+    CHECK_EQ(locations[0].row_end, 100UL);
+    CHECK_EQ(locations[1].id, dataframe_ids[1]);
+    CHECK_EQ(locations[1].instance_id, client.instance_id());
+    CHECK_EQ(locations[1].row_begin, 100UL);
+    CHECK_EQ(locations[1].row_end, 150UL);
+
+    locations = global_dataframe->LocateRows(120, 130);
+    CHECK_EQ(locations.size(), 1UL);
+    CHECK_EQ(locations[0].id, dataframe_ids[1]);
+
+    CHECK(global_dataframe->LocateRows(150, 200).empty());
+  }
+}
+
 void testDelete(Client& client) {
   ObjectID dataframe_id = InvalidObjectID();
   ObjectID global_dataframe_id = InvalidObjectID();
@@ -200,6 +250,7 @@ int main(int argc, char** argv) {
 
   testGlobalTensor(client);
   testGlobalDataFrame(client);
+  testPartitionIndex(client);
   testDelete(client);
 
   client.Disconnect();
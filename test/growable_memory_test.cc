@@ -0,0 +1,155 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The vineyardd is expected to be launched with a 16 MiB `--initial_size`
+// and a 256 MiB `--size`, thus the blobs below live in the segments that are
+// mapped on demand, and the segments are released and mapped again between
+// the rounds.
+
+constexpr size_t kBlobs = 24;
+constexpr size_t kSize = 4 * 1024 * 1024 + 17;
+constexpr size_t kRounds = 3;
+
+static char content(size_t const round, size_t const blob,
+                    size_t const offset) {
+  return static_cast<char>((round * 7 + blob * 29 + offset) % 239);
+}
+
+static void checkBlobs(Client& client, std::vector<ObjectID> const& ids,
+                       size_t const round) {
+  std::vector<std::shared_ptr<Blob>> blobs;
+  VINEYARD_CHECK_OK(client.GetBlobs(ids, blobs));
+  CHECK_EQ(blobs.size(), ids.size());
+  for (size_t blob = 0; blob < ids.size(); ++blob) {
+    CHECK_EQ(blobs[blob]->id(), ids[blob]);
+    CHECK_EQ(blobs[blob]->allocated_size(), kSize);
+    for (size_t i = 0; i < kSize; i += 509) {
+      CHECK_EQ(blobs[blob]->data()[i], content(round, blob, i));
+    }
+  }
+}
+
+// the fds of all the segments that the reader hasn't seen yet arrive along
+// with a single reply
+static void checkObjects(Client& client, std::vector<ObjectID> const& ids,
+                         size_t const round) {
+  auto objects = client.GetObjects(ids);
+  CHECK_EQ(objects.size(), ids.size());
+  for (size_t blob = 0; blob < ids.size(); ++blob) {
+    auto item = std::dynamic_pointer_cast<Blob>(objects[blob]);
+    CHECK(item != nullptr);
+    CHECK_EQ(item->id(), ids[blob]);
+    CHECK_EQ(item->allocated_size(), kSize);
+    for (size_t i = 0; i < kSize; i += 509) {
+      CHECK_EQ(item->data()[i], content(round, blob, i));
+    }
+  }
+}
+
+static void checkBuffers(Client& client, std::vector<ObjectID> const& ids,
+                         size_t const round) {
+  std::map<ObjectID, std::shared_ptr<arrow::Buffer>> buffers;
+  VINEYARD_CHECK_OK(
+      client.GetBuffers(std::set<ObjectID>(ids.begin(), ids.end()), buffers));
+  CHECK_EQ(buffers.size(), ids.size());
+  for (size_t blob = 0; blob < ids.size(); ++blob) {
+    auto const& buffer = buffers.at(ids[blob]);
+    CHECK_EQ(static_cast<size_t>(buffer->size()), kSize);
+    for (size_t i = 0; i < kSize; i += 509) {
+      CHECK_EQ(static_cast<char>(buffer->data()[i]), content(round, blob, i));
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./growable_memory_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  for (size_t round = 0; round < kRounds; ++round) {
+    // the writer stays connected across the rounds, i.e., it has mapped the
+    // segments released in the earlier rounds
+    std::vector<ObjectID> ids;
+    for (size_t blob = 0; blob < kBlobs; ++blob) {
+      std::unique_ptr<BlobWriter> writer;
+      VINEYARD_CHECK_OK(client.CreateBlob(kSize, writer));
+      for (size_t i = 0; i < kSize; ++i) {
+        writer->data()[i] = content(round, blob, i);
+      }
+      ids.emplace_back(writer->Seal(client)->id());
+    }
+
+    std::shared_ptr<InstanceStatus> status;
+    VINEYARD_CHECK_OK(client.InstanceStatus(status));
+    CHECK_GE(status->memory_usage, kBlobs * kSize);
+    CHECK_LE(status->memory_usage, status->memory_limit);
+
+    checkBlobs(client, ids, round);
+    {
+      Client reader;
+      VINEYARD_CHECK_OK(reader.Connect(ipc_socket));
+      checkBlobs(reader, ids, round);
+      reader.Disconnect();
+    }
+    {
+      Client reader;
+      VINEYARD_CHECK_OK(reader.Connect(ipc_socket));
+      checkObjects(reader, ids, round);
+      reader.Disconnect();
+    }
+    {
+      Client reader;
+      VINEYARD_CHECK_OK(reader.Connect(ipc_socket));
+      checkBuffers(reader, ids, round);
+      reader.Disconnect();
+    }
+
+    VINEYARD_CHECK_OK(client.DelData(ids));
+    for (auto const id : ids) {
+      bool exists = true;
+      VINEYARD_CHECK_OK(client.Exists(id, exists));
+      CHECK(!exists);
+    }
+    LOG(INFO) << "Passed round " << round << " of growable memory tests";
+  }
+
+  LOG(INFO) << "Passed growable memory tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -13,9 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -29,6 +31,87 @@ limitations under the License.
 
 using namespace vineyard;  // NOLINT(build/namespaces)
 
+// emplaces keys [0, count) from `threads` threads, every key is emplaced by
+// two threads, and compares the result with the one of HashmapBuilder
+void testConcurrentHashmap(Client& client, size_t const capacity,
+                           int64_t const count, int const threads) {
+  ConcurrentHashmapBuilder<int64_t, int64_t> builder(client, capacity);
+  std::atomic<int64_t> emplaced(0);
+  std::vector<std::thread> workers;
+  for (int worker = 0; worker < threads; ++worker) {
+    workers.emplace_back([&, worker]() {
+      for (int64_t key = 0; key < count; ++key) {
+        int const owner = key % threads;
+        if (owner == worker || owner == (worker + 1) % threads) {
+          if (builder.emplace(key, key * 3)) {
+            emplaced += 1;
+          }
+        }
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  CHECK_EQ(emplaced.load(), count);
+  CHECK_EQ(builder.size(), static_cast<size_t>(count));
+  auto concurrent = std::dynamic_pointer_cast<Hashmap<int64_t, int64_t>>(
+      builder.Seal(client));
+
+  HashmapBuilder<int64_t, int64_t> expected_builder(client);
+  for (int64_t key = 0; key < count; ++key) {
+    expected_builder.emplace(key, key * 3);
+  }
+  auto expected = std::dynamic_pointer_cast<Hashmap<int64_t, int64_t>>(
+      expected_builder.Seal(client));
+
+  CHECK_EQ(concurrent->size(), expected->size());
+  for (int64_t key = 0; key < count; ++key) {
+    CHECK_EQ(concurrent->at(key), expected->at(key));
+  }
+  for (int64_t key = count; key < count + 100; ++key) {
+    CHECK(concurrent->find(key) == concurrent->end());
+  }
+  size_t iterated = 0;
+  for (auto const& item : *concurrent) {
+    CHECK_EQ(item.second, item.first * 3);
+    iterated += 1;
+  }
+  CHECK_EQ(iterated, static_cast<size_t>(count));
+
+  VINEYARD_CHECK_OK(client.DelData(concurrent->id(), true, true));
+  VINEYARD_CHECK_OK(client.DelData(expected->id(), true, true));
+}
+
+// looks up present and missing keys in batches whose size is not a multiple
+// of the group size, and compares the results with the ones of find()
+void testBatchLookup(Client& client, int64_t const count) {
+  HashmapBuilder<int64_t, int64_t> builder(client);
+  for (int64_t key = 0; key < count; key += 3) {
+    builder.emplace(key, key * 7);
+  }
+  auto hashmap = std::dynamic_pointer_cast<Hashmap<int64_t, int64_t>>(
+      builder.Seal(client));
+
+  std::vector<int64_t> keys;
+  for (int64_t key = -5; key < count + 37; ++key) {
+    keys.emplace_back(key);
+  }
+  std::vector<int64_t> values(keys.size(), -1);
+  std::unique_ptr<bool[]> found(new bool[keys.size()]);
+  hashmap->find_batch(keys.data(), keys.size(), values.data(), found.get());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    auto iter = hashmap->find(keys[i]);
+    CHECK_EQ(found[i], iter != hashmap->end());
+    CHECK_EQ(values[i], found[i] ? iter->second : -1);
+  }
+
+  // an empty batch touches nothing
+  hashmap->find_batch(keys.data(), 0, values.data(), found.get());
+
+  VINEYARD_CHECK_OK(client.DelData(hashmap->id(), true, true));
+}
+
 int main(int argc, char** argv) {
   if (argc < 2) {
     printf("usage ./hashmap_test <ipc_socket_name>");
@@ -72,6 +155,24 @@ int main(int argc, char** argv) {
 
   LOG(INFO) << "Passed double hashmap tests...";
 
+  testConcurrentHashmap(client, 100000, 100000, 4);
+  LOG(INFO) << "Passed concurrent hashmap tests...";
+
+  // the elements overflow the table, which is rebuilt when sealing
+  {
+    std::shared_ptr<InstanceStatus> status_before, status_after;
+    VINEYARD_CHECK_OK(client.InstanceStatus(status_before));
+    testConcurrentHashmap(client, 64, 10000, 4);
+    VINEYARD_CHECK_OK(client.InstanceStatus(status_after));
+    // nothing is left behind by the replaced table
+    CHECK_EQ(status_before->memory_usage, status_after->memory_usage);
+  }
+  LOG(INFO) << "Passed overflowed concurrent hashmap tests...";
+
+  testBatchLookup(client, 10000);
+  testBatchLookup(client, 7);
+  LOG(INFO) << "Passed batched hashmap lookup tests...";
+
   client.Disconnect();
 
   return 0;
@@ -13,8 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <algorithm>
 #include <bitset>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 #include "common/util/logging.h"
 #include "common/util/uuid.h"
@@ -29,4 +32,31 @@ int main() {
   ObjectID id2 = vineyard::GenerateObjectID();
   LOG(INFO) << id2 << "\n";
   CHECK(!vineyard::IsBlob(id2));
+
+  // ids of the same thread are ordered, and are unique across threads
+  std::vector<std::vector<ObjectID>> ids(4);
+  std::vector<std::thread> threads;
+  for (auto& thread_ids : ids) {
+    threads.emplace_back([&thread_ids]() {
+      for (int i = 0; i < 10000; ++i) {
+        thread_ids.emplace_back(vineyard::GenerateObjectID());
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  std::vector<ObjectID> all_ids = vineyard::GenerateObjectIDs(1000);
+  CHECK_EQ(all_ids.size(), 1000);
+  CHECK(std::is_sorted(all_ids.begin(), all_ids.end()));
+  for (auto const& thread_ids : ids) {
+    CHECK(std::is_sorted(thread_ids.begin(), thread_ids.end()));
+    all_ids.insert(all_ids.end(), thread_ids.begin(), thread_ids.end());
+  }
+  all_ids.emplace_back(id2);
+  std::sort(all_ids.begin(), all_ids.end());
+  CHECK(std::adjacent_find(all_ids.begin(), all_ids.end()) == all_ids.end());
+  for (auto const& id : all_ids) {
+    CHECK(!vineyard::IsBlob(id));
+  }
 }
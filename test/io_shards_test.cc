@@ -0,0 +1,119 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "client/rpc_client.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The vineyardd is expected to be launched with `--io_shards`, thus the
+// connections below are served by different shards, and the requests that
+// wait for the others (e.g., the names that are put later) are woken up
+// across the shards.
+
+constexpr size_t kClients = 8;
+constexpr size_t kBlobSize = 1024;
+
+static std::string nameOf(size_t const index) {
+  return "io_shards_test_" + std::to_string(index);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage ./io_shards_test <ipc_socket> <rpc_endpoint>");
+    return 1;
+  }
+  std::string ipc_socket(argv[1]);
+  std::string rpc_endpoint(argv[2]);
+
+  std::vector<ObjectID> ids(kClients, InvalidObjectID());
+  std::vector<std::thread> threads;
+  for (size_t index = 0; index < kClients; ++index) {
+    threads.emplace_back([&, index]() {
+      Client client;
+      VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+
+      std::unique_ptr<BlobWriter> writer;
+      VINEYARD_CHECK_OK(client.CreateBlob(kBlobSize, writer));
+      memset(writer->data(), static_cast<int>(index), kBlobSize);
+      auto blob = writer->Seal(client);
+      ObjectMeta meta;
+      meta.SetTypeName("vineyard::test::Sharded");
+      meta.SetNBytes(kBlobSize);
+      meta.AddKeyValue("index", index);
+      meta.AddMember("buffer", blob->id());
+      VINEYARD_CHECK_OK(client.CreateMetaData(meta, ids[index]));
+      VINEYARD_CHECK_OK(client.Persist(ids[index]));
+      VINEYARD_CHECK_OK(client.PutName(ids[index], nameOf(index)));
+
+      // waits for the object of the next client, on another connection
+      size_t const next = (index + 1) % kClients;
+      ObjectID next_id = InvalidObjectID();
+      VINEYARD_CHECK_OK(client.GetName(nameOf(next), next_id, true));
+      ObjectMeta next_meta;
+      VINEYARD_CHECK_OK(client.GetMetaData(next_id, next_meta));
+      CHECK_EQ(next_meta.GetKeyValue<size_t>("index"), next);
+      auto buffer = std::dynamic_pointer_cast<Blob>(
+          next_meta.GetMember("buffer"));
+      CHECK(buffer != nullptr);
+      CHECK_EQ(buffer->data()[kBlobSize - 1], static_cast<char>(next));
+
+      client.Disconnect();
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  LOG(INFO) << "Passed waiting across io shards tests...";
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  RPCClient rpc_client;
+  VINEYARD_CHECK_OK(rpc_client.Connect(rpc_endpoint));
+  for (size_t index = 0; index < kClients; ++index) {
+    ObjectMeta meta;
+    VINEYARD_CHECK_OK(rpc_client.GetMetaData(ids[index], meta));
+    CHECK_EQ(meta.GetKeyValue<size_t>("index"), index);
+  }
+  {
+    std::shared_ptr<InstanceStatus> status;
+    VINEYARD_CHECK_OK(client.InstanceStatus(status));
+    CHECK_GE(status->ipc_connections, 1U);
+    CHECK_GE(status->rpc_connections, 1U);
+  }
+  rpc_client.Disconnect();
+
+  for (size_t index = 0; index < kClients; ++index) {
+    VINEYARD_CHECK_OK(client.DropName(nameOf(index)));
+  }
+  VINEYARD_CHECK_OK(client.DelData(ids, true, true));
+  client.Disconnect();
+
+  LOG(INFO) << "Passed io shards tests...";
+  return 0;
+}
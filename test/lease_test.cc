@@ -0,0 +1,128 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// vineyardd is expected to be launched with `--lease_sweep_interval 1`.
+constexpr int64_t kTTL = 2;
+
+static void waitFor(std::function<bool()> const& predicate) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+  while (!predicate()) {
+    CHECK(std::chrono::steady_clock::now() < deadline);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+}
+
+static bool exists(Client& client, ObjectID const id) {
+  bool exists = false;
+  VINEYARD_CHECK_OK(client.Exists(id, exists));
+  return exists;
+}
+
+static ObjectID createBlob(Client& client) {
+  std::unique_ptr<BlobWriter> blob_writer;
+  VINEYARD_CHECK_OK(client.CreateBlob(1024, blob_writer));
+  return blob_writer->Seal(client)->id();
+}
+
+static ObjectID createObject(Client& client, ObjectID const blob_id) {
+  ObjectMeta meta;
+  meta.SetTypeName("vineyard::test::LeasedObject");
+  meta.SetNBytes(0);
+  if (blob_id != InvalidObjectID()) {
+    meta.AddMember("buffer", blob_id);
+  }
+  ObjectID id = InvalidObjectID();
+  VINEYARD_CHECK_OK(client.CreateMetaData(meta, id));
+  return id;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./lease_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // the session that keeps its leases
+  Client keeper;
+  VINEYARD_CHECK_OK(keeper.Connect(ipc_socket));
+  ObjectID kept = createObject(keeper, InvalidObjectID());
+  VINEYARD_CHECK_OK(keeper.Lease({kept}, 1));
+
+  // the session that goes away
+  ObjectID expired_member, expired_object, expired_blob, persisted, released;
+  {
+    Client leaser;
+    VINEYARD_CHECK_OK(leaser.Connect(ipc_socket));
+    expired_member = createBlob(leaser);
+    expired_object = createObject(leaser, expired_member);
+    expired_blob = createBlob(leaser);
+    persisted = createObject(leaser, InvalidObjectID());
+    VINEYARD_CHECK_OK(leaser.Persist(persisted));
+    released = createObject(leaser, InvalidObjectID());
+    VINEYARD_CHECK_OK(leaser.Lease(
+        {expired_object, expired_blob, persisted, released}, kTTL));
+    VINEYARD_CHECK_OK(leaser.Lease({released}, 0));
+
+    // the leases are renewed as long as the session is connected
+    std::this_thread::sleep_for(std::chrono::seconds(kTTL + 2));
+    for (auto const id :
+         {expired_member, expired_object, expired_blob, persisted, released}) {
+      CHECK(exists(client, id));
+    }
+    leaser.Disconnect();
+  }
+  LOG(INFO) << "Passed renewing leases tests...";
+
+  // the objects that are not persisted, and their members, are deleted once
+  // the leases expire
+  waitFor([&]() {
+    return !exists(client, expired_object) && !exists(client, expired_blob) &&
+           !exists(client, expired_member);
+  });
+  std::this_thread::sleep_for(std::chrono::seconds(kTTL + 2));
+  CHECK(exists(client, persisted));
+  CHECK(exists(client, released));
+  CHECK(exists(client, kept));
+  LOG(INFO) << "Passed expiring leases tests...";
+
+  VINEYARD_CHECK_OK(client.DelData({persisted, released, kept}));
+  keeper.Disconnect();
+  client.Disconnect();
+
+  LOG(INFO) << "Passed lease tests...";
+
+  return 0;
+}
@@ -16,6 +16,8 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -53,6 +55,88 @@ int main(int argc, char** argv) {
 
   LOG(INFO) << "Passed list objects tests...";
 
+  {
+    // list the tensors page by page, with filters
+    json filters;
+    filters["instance_id"] = client.instance_id();
+    filters["min_nbytes"] = sizeof(double) * 6;
+    std::string cursor;
+    bool found = false;
+    do {
+      std::vector<ObjectID> ids;
+      std::unordered_map<ObjectID, json> projections;
+      VINEYARD_CHECK_OK(client.ListDataPage("vineyard::Tensor*", false, 1,
+                                            filters, {"typename", "nbytes"},
+                                            cursor, ids, projections));
+      CHECK_LE(ids.size(), 1U);
+      for (auto const& id : ids) {
+        CHECK(projections.find(id) != projections.end());
+        CHECK_GE(projections[id]["nbytes"].get<size_t>(), sizeof(double) * 6);
+        found |= id == sealed->id();
+      }
+    } while (!cursor.empty());
+    CHECK(found);
+
+    filters["min_nbytes"] = sealed->nbytes() + 1;
+    filters["max_nbytes"] = sealed->nbytes() + 1;
+    cursor.clear();
+    do {
+      std::vector<ObjectID> ids;
+      std::unordered_map<ObjectID, json> projections;
+      VINEYARD_CHECK_OK(client.ListDataPage("vineyard::Tensor*", false, 16,
+                                            filters, {}, cursor, ids,
+                                            projections));
+      CHECK(projections.empty());
+      for (auto const& id : ids) {
+        CHECK_NE(id, sealed->id());
+      }
+    } while (!cursor.empty());
+  }
+
+  LOG(INFO) << "Passed list object pages tests...";
+
+  {
+    // the type names that share a prefix, listed with globs and regexes
+    std::unordered_map<std::string, size_t> counts = {
+        {"vineyard::test::IndexA", 3},
+        {"vineyard::test::IndexAB", 2},
+        {"vineyard::test::IndexB", 4}};
+    std::unordered_map<std::string, std::vector<ObjectID>> created;
+    for (auto const& item : counts) {
+      for (size_t i = 0; i < item.second; ++i) {
+        ObjectMeta meta;
+        meta.SetTypeName(item.first);
+        meta.SetNBytes(0);
+        ObjectID id = InvalidObjectID();
+        VINEYARD_CHECK_OK(client.CreateMetaData(meta, id));
+        created[item.first].emplace_back(id);
+      }
+    }
+    auto typeCount = [&](std::string const& pattern, bool const regex) {
+      auto metas = client.ListObjectMeta(pattern, regex, 1024);
+      for (auto const& meta : metas) {
+        CHECK(counts.find(meta.GetTypeName()) != counts.end());
+      }
+      return metas.size();
+    };
+    CHECK_EQ(typeCount("vineyard::test::IndexA", false), 3U);
+    CHECK_EQ(typeCount("vineyard::test::IndexA*", false), 5U);
+    CHECK_EQ(typeCount("vineyard::test::Index*", false), 9U);
+    CHECK_EQ(typeCount("vineyard::test::Index?", false), 7U);
+    CHECK_EQ(typeCount("vineyard::test::Index(AB|B)", true), 6U);
+    CHECK_EQ(typeCount("vineyard::test::IndexC*", false), 0U);
+
+    // the deleted objects are dropped from the index
+    VINEYARD_CHECK_OK(client.DelData(created["vineyard::test::IndexB"]));
+    CHECK_EQ(typeCount("vineyard::test::IndexB", false), 0U);
+    CHECK_EQ(typeCount("vineyard::test::Index*", false), 5U);
+    VINEYARD_CHECK_OK(client.DelData(created["vineyard::test::IndexA"]));
+    VINEYARD_CHECK_OK(client.DelData(created["vineyard::test::IndexAB"]));
+    CHECK_EQ(typeCount("vineyard::test::Index*", false), 0U);
+  }
+
+  LOG(INFO) << "Passed list objects by type name tests...";
+
   client.Disconnect();
 
   return 0;
@@ -0,0 +1,176 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "basic/ds/dataframe.h"
+#include "basic/ds/tensor.h"
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/json.h"
+#include "common/util/logging.h"
+#include "common/util/typename.h"
+#include "common/util/uuid.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// Other tests may have left objects behind, thus only the changes of the
+// usage, and the objects created here, are checked.
+constexpr int64_t kRows = 1000;
+constexpr size_t kTensorBytes = kRows * kRows * sizeof(double);
+constexpr size_t kUnsealedBytes = 1 << 20;
+
+std::shared_ptr<Tensor<double>> makeTensor(Client& client) {
+  TensorBuilder<double> builder(client, {kRows, kRows});
+  for (int64_t index = 0; index < kRows * kRows; ++index) {
+    builder.data()[index] = index;
+  }
+  return std::dynamic_pointer_cast<Tensor<double>>(builder.Seal(client));
+}
+
+size_t usageOf(json const& usage, std::string const& group,
+               std::string const& key, std::string const& field) {
+  auto const& groups = usage[group];
+  if (!groups.contains(key)) {
+    return 0;
+  }
+  return groups[key][field].get<size_t>();
+}
+
+json topObject(json const& usage, ObjectID const id) {
+  for (auto const& object : usage["top_objects"]) {
+    if (object["id"].get<std::string>() == ObjectIDToString(id)) {
+      return object;
+    }
+  }
+  return json();
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./memory_attribution_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // the blobs are owned by this process
+  std::string comm;
+  {
+    std::ifstream is("/proc/self/comm");
+    CHECK(std::getline(is, comm));
+  }
+  std::string owner = comm + ":" + std::to_string(getpid());
+  std::string tensor_type = type_name<Tensor<double>>();
+  std::string dataframe_type = type_name<DataFrame>();
+  std::string instance = std::to_string(client.instance_id());
+
+  json before;
+  VINEYARD_CHECK_OK(client.MemoryAttribution(before));
+
+  // a tensor, a dataframe of a tensor, and a blob that isn't sealed
+  auto tensor = makeTensor(client);
+  DataFrameBuilder dataframe_builder(client);
+  dataframe_builder.AddColumn("a", std::make_shared<TensorBuilder<double>>(
+                                       client, std::vector<int64_t>{kRows}));
+  auto dataframe = std::dynamic_pointer_cast<DataFrame>(
+      dataframe_builder.Seal(client));
+  std::unique_ptr<BlobWriter> unsealed;
+  VINEYARD_CHECK_OK(client.CreateBlob(kUnsealedBytes, unsealed));
+
+  json after;
+  VINEYARD_CHECK_OK(client.MemoryAttribution(after));
+
+  // the tensor is an outermost object, and the column of the dataframe
+  // isn't, as it's referenced by the dataframe
+  CHECK_EQ(usageOf(after, "by_type", tensor_type, "objects"),
+           usageOf(before, "by_type", tensor_type, "objects") + 1);
+  CHECK_EQ(usageOf(after, "by_type", tensor_type, "bytes"),
+           usageOf(before, "by_type", tensor_type, "bytes") + kTensorBytes);
+  CHECK_EQ(usageOf(after, "by_type", dataframe_type, "objects"),
+           usageOf(before, "by_type", dataframe_type, "objects") + 1);
+  CHECK_GE(usageOf(after, "by_type", dataframe_type, "bytes"),
+           usageOf(before, "by_type", dataframe_type, "bytes") +
+               kRows * sizeof(double));
+
+  // the unsealed blob is counted as a blob of no object
+  CHECK_EQ(after["unreferenced_blobs"].get<size_t>(),
+           before["unreferenced_blobs"].get<size_t>() + 1);
+  CHECK_EQ(after["unreferenced_bytes"].get<size_t>(),
+           before["unreferenced_bytes"].get<size_t>() + kUnsealedBytes);
+  size_t dataframe_bytes = usageOf(after, "by_type", dataframe_type, "bytes") -
+                           usageOf(before, "by_type", dataframe_type, "bytes");
+  CHECK_EQ(after["attributed_bytes"].get<size_t>() -
+               before["attributed_bytes"].get<size_t>(),
+           kTensorBytes + dataframe_bytes);
+
+  // all of them are owned by this process, on this instance
+  size_t bytes = kTensorBytes + kRows * sizeof(double) + kUnsealedBytes;
+  CHECK_GE(usageOf(after, "by_owner", owner, "bytes"),
+           usageOf(before, "by_owner", owner, "bytes") + bytes);
+  CHECK_GE(usageOf(after, "by_instance", instance, "bytes"),
+           usageOf(before, "by_instance", instance, "bytes") + bytes);
+  CHECK_GE(after["memory_usage"].get<size_t>(),
+           after["attributed_bytes"].get<size_t>() +
+               after["unreferenced_bytes"].get<size_t>());
+  LOG(INFO) << "Passed attributing memory tests...";
+
+  // the biggest objects are reported in descending order
+  {
+    auto const& top_objects = after["top_objects"];
+    for (size_t index = 1; index < top_objects.size(); ++index) {
+      CHECK_GE(top_objects[index - 1]["bytes"].get<size_t>(),
+               top_objects[index]["bytes"].get<size_t>());
+    }
+    json object = topObject(after, tensor->id());
+    if (object.is_null()) {
+      CHECK_GE(top_objects.back()["bytes"].get<size_t>(), kTensorBytes);
+    } else {
+      CHECK_EQ(object["typename"].get<std::string>(), tensor_type);
+      CHECK_EQ(object["bytes"].get<size_t>(), kTensorBytes);
+    }
+    CHECK(topObject(after, dataframe->Column("a")->id()).is_null());
+  }
+  LOG(INFO) << "Passed top objects tests...";
+
+  // the memory is no longer attributed once the objects are deleted
+  auto unsealed_blob = unsealed->Seal(client);
+  VINEYARD_CHECK_OK(client.DelData(
+      {tensor->id(), dataframe->id(), unsealed_blob->id()}, true, true));
+  json deleted;
+  VINEYARD_CHECK_OK(client.MemoryAttribution(deleted));
+  CHECK_EQ(usageOf(deleted, "by_type", tensor_type, "objects"),
+           usageOf(before, "by_type", tensor_type, "objects"));
+  CHECK_EQ(usageOf(deleted, "by_type", dataframe_type, "objects"),
+           usageOf(before, "by_type", dataframe_type, "objects"));
+  CHECK_EQ(deleted["unreferenced_bytes"].get<size_t>(),
+           before["unreferenced_bytes"].get<size_t>());
+  LOG(INFO) << "Passed releasing memory tests...";
+
+  client.Disconnect();
+
+  LOG(INFO) << "Passed memory attribution tests...";
+
+  return 0;
+}
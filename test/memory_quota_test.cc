@@ -0,0 +1,178 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/json.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// vineyardd is expected to be launched with `--spill_path` and
+// `--memory_quotas etl=4Mi:8Mi,*=6Mi`.
+constexpr size_t kSize = 2 * 1024 * 1024;
+constexpr size_t kSoftLimit = 4 * 1024 * 1024;
+constexpr size_t kHardLimit = 8 * 1024 * 1024;
+constexpr size_t kFairShare = 6 * 1024 * 1024;
+
+static void waitFor(std::function<bool()> const& predicate) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+  while (!predicate()) {
+    CHECK(std::chrono::steady_clock::now() < deadline);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+}
+
+static json sessionMemory(Client& client, std::string const& session) {
+  std::shared_ptr<InstanceStatus> status;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  CHECK(status->session_memory.contains(session));
+  return status->session_memory[session];
+}
+
+static size_t usageOf(Client& client, std::string const& session) {
+  return sessionMemory(client, session)["usage"].get<size_t>();
+}
+
+static char content(ObjectID const id, size_t const offset) {
+  return static_cast<char>((id + offset) % 251);
+}
+
+static Status createBlob(Client& client, size_t const size, ObjectID& id) {
+  std::unique_ptr<BlobWriter> blob_writer;
+  RETURN_ON_ERROR(client.CreateBlob(size, blob_writer));
+  for (size_t offset = 0; offset < size; ++offset) {
+    blob_writer->data()[offset] = content(blob_writer->id(), offset);
+  }
+  id = blob_writer->Seal(client)->id();
+  return Status::OK();
+}
+
+static void connectAs(Client& client, std::string const& ipc_socket,
+                      std::string const& session) {
+  setenv("VINEYARD_SESSION", session.c_str(), 1);
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  unsetenv("VINEYARD_SESSION");
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./memory_quota_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // the released blobs of the session over its soft limit are spilled, and
+  // are charged again once reloaded
+  std::vector<ObjectID> cold_ids;
+  for (int blob = 0; blob < 4; ++blob) {
+    Client writer;
+    connectAs(writer, ipc_socket, "etl");
+    ObjectID id = InvalidObjectID();
+    VINEYARD_CHECK_OK(createBlob(writer, kSize, id));
+    cold_ids.emplace_back(id);
+    writer.Disconnect();
+  }
+  json etl = sessionMemory(client, "etl");
+  CHECK_EQ(etl["soft_limit"].get<size_t>(), kSoftLimit);
+  CHECK_EQ(etl["hard_limit"].get<size_t>(), kHardLimit);
+  CHECK_GT(etl["usage"].get<size_t>(), 0U);
+  CHECK_LE(etl["usage"].get<size_t>(), kSoftLimit);
+  {
+    Client reader;
+    VINEYARD_CHECK_OK(reader.Connect(ipc_socket));
+    std::vector<std::shared_ptr<Blob>> blobs;
+    VINEYARD_CHECK_OK(reader.GetBlobs(cold_ids, blobs));
+    CHECK_EQ(blobs.size(), cold_ids.size());
+    for (auto const& blob : blobs) {
+      CHECK_EQ(blob->size(), kSize);
+      for (size_t offset = 0; offset < kSize; offset += 4099) {
+        CHECK_EQ(blob->data()[offset], content(blob->id(), offset));
+      }
+    }
+    blobs.clear();
+    reader.Disconnect();
+  }
+  LOG(INFO) << "Passed soft limit tests...";
+
+  // the blobs that are in use are never evicted, thus the hard limit
+  // rejects the allocations
+  Client etl_client;
+  connectAs(etl_client, ipc_socket, "etl");
+  std::vector<ObjectID> held_ids;
+  Status status;
+  for (int blob = 0; blob < 8 && status.ok(); ++blob) {
+    ObjectID id = InvalidObjectID();
+    status = createBlob(etl_client, kSize, id);
+    if (status.ok()) {
+      held_ids.emplace_back(id);
+    }
+  }
+  CHECK(status.IsNotEnoughMemory());
+  CHECK_GE(held_ids.size(), 2U);
+  CHECK_LE(held_ids.size(), kHardLimit / kSize);
+  CHECK_LE(usageOf(client, "etl"), kHardLimit);
+  LOG(INFO) << "Passed hard limit tests...";
+
+  // every other session has a quota of its own
+  {
+    Client tenant_a, tenant_b;
+    connectAs(tenant_a, ipc_socket, "tenant_a");
+    connectAs(tenant_b, ipc_socket, "tenant_b");
+    for (size_t blob = 0; blob < kFairShare / kSize; ++blob) {
+      ObjectID id = InvalidObjectID();
+      VINEYARD_CHECK_OK(createBlob(tenant_a, kSize, id));
+      VINEYARD_CHECK_OK(createBlob(tenant_b, kSize, id));
+    }
+    ObjectID id = InvalidObjectID();
+    CHECK(createBlob(tenant_a, kSize, id).IsNotEnoughMemory());
+    CHECK(createBlob(tenant_b, kSize, id).IsNotEnoughMemory());
+    CHECK_EQ(sessionMemory(client, "tenant_a")["hard_limit"].get<size_t>(),
+             kFairShare);
+    CHECK_EQ(usageOf(client, "tenant_b"), kFairShare);
+
+    // the clients without sessions are not charged
+    VINEYARD_CHECK_OK(createBlob(client, 2 * kHardLimit, id));
+    VINEYARD_CHECK_OK(client.DelData(id));
+  }
+  LOG(INFO) << "Passed fair share tests...";
+
+  // the deleted blobs are refunded
+  VINEYARD_CHECK_OK(etl_client.DelData(held_ids));
+  VINEYARD_CHECK_OK(client.DelData(cold_ids));
+  etl_client.Disconnect();
+  waitFor([&]() { return usageOf(client, "etl") == 0; });
+  LOG(INFO) << "Passed refunding quotas tests...";
+
+  client.Disconnect();
+
+  LOG(INFO) << "Passed memory quota tests...";
+
+  return 0;
+}
@@ -0,0 +1,67 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+
+#include "basic/ds/scalar.h"
+#include "client/client.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The vineyardd is expected to be launched with `--meta_snapshot_path`, the
+// "create" step persists an object before the vineyardd is restarted from
+// the snapshot, and the "check" step finds the object after the restart.
+
+static const std::string kObjectName = "meta_snapshot_test_object";
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage ./meta_snapshot_test <ipc_socket> <create|check>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  std::string step = std::string(argv[2]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  if (step == "create") {
+    ScalarBuilder<int32_t> scalar_builder(client);
+    scalar_builder.SetValue(1234);
+    auto scalar = scalar_builder.Seal(client);
+    VINEYARD_CHECK_OK(client.Persist(scalar->id()));
+    VINEYARD_CHECK_OK(client.PutName(scalar->id(), kObjectName));
+    LOG(INFO) << "Created object " << ObjectIDToString(scalar->id());
+  } else {
+    ObjectID id = InvalidObjectID();
+    VINEYARD_CHECK_OK(client.GetName(kObjectName, id));
+    ObjectMeta meta;
+    VINEYARD_CHECK_OK(client.GetMetaData(id, meta, true));
+    CHECK_EQ(meta.GetTypeName(), type_name<Scalar<int32_t>>());
+    CHECK_EQ(meta.GetKeyValue<int32_t>("value_"), 1234);
+    VINEYARD_CHECK_OK(client.DropName(kObjectName));
+    VINEYARD_CHECK_OK(client.DelData(id, true, true));
+    LOG(INFO) << "Found object " << ObjectIDToString(id);
+  }
+
+  LOG(INFO) << "Passed meta snapshot tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
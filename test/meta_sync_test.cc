@@ -0,0 +1,179 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The changes persisted by one instance arrive at the other instance through
+// the etcd watcher, where a burst of revisions is applied in batches, while
+// the rewrites of the same key are still applied in order.
+
+constexpr size_t kClients = 8;
+constexpr size_t kObjectsPerClient = 32;
+constexpr size_t kRenames = 64;
+
+static void waitFor(std::function<bool()> const& predicate) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+  while (!predicate()) {
+    CHECK(std::chrono::steady_clock::now() < deadline);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage ./meta_sync_test <ipc_socket> <ipc_socket_1>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  std::string ipc_socket_1 = std::string(argv[2]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  Client client1;
+  VINEYARD_CHECK_OK(client1.Connect(ipc_socket_1));
+  CHECK_NE(client.instance_id(), client1.instance_id());
+  LOG(INFO) << "Connected to IPCServers: " << ipc_socket << ", "
+            << ipc_socket_1;
+
+  std::vector<std::vector<ObjectID>> created(kClients);
+  std::vector<std::thread> threads;
+  for (size_t index = 0; index < kClients; ++index) {
+    threads.emplace_back([&, index]() {
+      Client writer;
+      VINEYARD_CHECK_OK(writer.Connect(ipc_socket));
+      for (size_t seq = 0; seq < kObjectsPerClient; ++seq) {
+        ObjectMeta meta;
+        meta.SetTypeName("vineyard::test::SyncedObject");
+        meta.SetNBytes(0);
+        meta.AddKeyValue("client", index);
+        meta.AddKeyValue("seq", seq);
+        ObjectID id = InvalidObjectID();
+        VINEYARD_CHECK_OK(writer.CreateMetaData(meta, id));
+        VINEYARD_CHECK_OK(writer.Persist(id));
+        created[index].emplace_back(id);
+      }
+      writer.Disconnect();
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // every persisted object shows up on the other instance, without an
+  // explicit sync
+  for (size_t index = 0; index < kClients; ++index) {
+    for (size_t seq = 0; seq < kObjectsPerClient; ++seq) {
+      ObjectMeta meta;
+      waitFor([&]() {
+        return client1.GetMetaData(created[index][seq], meta, false).ok();
+      });
+      CHECK_EQ(meta.GetInstanceId(), client.instance_id());
+      CHECK_EQ(meta.GetKeyValue<size_t>("client"), index);
+      CHECK_EQ(meta.GetKeyValue<size_t>("seq"), seq);
+    }
+  }
+  LOG(INFO) << "Passed synchronizing persisted objects tests...";
+
+  // the other instance ends up with the last rewrite of the same name
+  std::string const name = "meta_sync_test_name";
+  ObjectID last = InvalidObjectID();
+  for (size_t round = 0; round < kRenames; ++round) {
+    last = created[round % kClients][round / kClients];
+    VINEYARD_CHECK_OK(client.PutName(last, name));
+  }
+  waitFor([&]() {
+    ObjectID id = InvalidObjectID();
+    return client1.GetName(name, id).ok() && id == last;
+  });
+  VINEYARD_CHECK_OK(client.DropName(name));
+  waitFor([&]() {
+    ObjectID id = InvalidObjectID();
+    return client1.GetName(name, id).IsObjectNotExists();
+  });
+  LOG(INFO) << "Passed synchronizing renames tests...";
+
+  // the deletions are synchronized as well
+  for (size_t index = 0; index < kClients; ++index) {
+    VINEYARD_CHECK_OK(client.DelData(created[index]));
+  }
+  for (size_t index = 0; index < kClients; ++index) {
+    for (auto const id : created[index]) {
+      waitFor([&]() {
+        bool exists = true;
+        VINEYARD_CHECK_OK(client1.Exists(id, exists));
+        return !exists;
+      });
+    }
+  }
+  LOG(INFO) << "Passed synchronizing deletions tests...";
+
+  // the global objects are not owned by any instance, and are persisted
+  // along with the local ones
+  {
+    std::vector<ObjectID> members;
+    for (Client* owner : {&client, &client1}) {
+      ObjectMeta meta;
+      meta.SetTypeName("vineyard::test::SyncedObject");
+      meta.SetNBytes(0);
+      ObjectID id = InvalidObjectID();
+      VINEYARD_CHECK_OK(owner->CreateMetaData(meta, id));
+      VINEYARD_CHECK_OK(owner->Persist(id));
+      members.emplace_back(id);
+    }
+    ObjectMeta global;
+    global.SetTypeName("vineyard::test::SyncedGlobalObject");
+    global.SetGlobal(true);
+    global.SetNBytes(0);
+    for (size_t index = 0; index < members.size(); ++index) {
+      ObjectMeta member;
+      VINEYARD_CHECK_OK(client.GetMetaData(members[index], member, true));
+      global.AddMember("member_" + std::to_string(index), member);
+    }
+    ObjectID global_id = InvalidObjectID();
+    VINEYARD_CHECK_OK(client.CreateMetaData(global, global_id));
+    VINEYARD_CHECK_OK(client.Persist(global_id));
+
+    ObjectMeta meta;
+    waitFor([&]() { return client1.GetMetaData(global_id, meta).ok(); });
+    CHECK(meta.IsGlobal());
+    CHECK_EQ(meta.GetMemberMeta("member_0").GetId(), members[0]);
+    CHECK_EQ(meta.GetMemberMeta("member_1").GetId(), members[1]);
+
+    VINEYARD_CHECK_OK(client.DelData(global_id, false, false));
+    VINEYARD_CHECK_OK(client.DelData(members[0]));
+    VINEYARD_CHECK_OK(client1.DelData(members[1]));
+  }
+  LOG(INFO) << "Passed synchronizing global objects tests...";
+
+  client1.Disconnect();
+  client.Disconnect();
+
+  return 0;
+}
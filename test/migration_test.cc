@@ -0,0 +1,207 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The vineyardds are expected to be launched with `--rdma`, the objects are
+// migrated with RDMA reads when a device is available, otherwise the
+// transfer falls back to TCP, and the results are the same.
+
+constexpr size_t kSizes[] = {1, 4097, 4 * 1024 * 1024 + 7};
+constexpr size_t kBlobs = sizeof(kSizes) / sizeof(kSizes[0]);
+
+static char content(size_t const blob, size_t const offset) {
+  return static_cast<char>((blob * 13 + offset) % 249);
+}
+
+static ObjectID makeObject(Client& client) {
+  ObjectMeta meta;
+  meta.SetTypeName("vineyard::test::Wrapper");
+  meta.AddKeyValue("value", "wrapper");
+  size_t nbytes = 0;
+  for (size_t blob = 0; blob < kBlobs; ++blob) {
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(kSizes[blob], writer));
+    for (size_t i = 0; i < kSizes[blob]; ++i) {
+      writer->data()[i] = content(blob, i);
+    }
+    meta.AddMember("buffer_" + std::to_string(blob), writer->Seal(client));
+    nbytes += kSizes[blob];
+  }
+  meta.AddMember("empty", Blob::MakeEmpty(client));
+  meta.SetNBytes(nbytes);
+  ObjectID id = InvalidObjectID();
+  VINEYARD_CHECK_OK(client.CreateMetaData(meta, id));
+  VINEYARD_CHECK_OK(client.Persist(id));
+  return id;
+}
+
+static void checkObject(Client& client, ObjectID const id) {
+  ObjectMeta meta;
+  VINEYARD_CHECK_OK(client.GetMetaData(id, meta));
+  CHECK_EQ(meta.GetInstanceId(), client.instance_id());
+  CHECK_EQ(meta.GetKeyValue("value"), "wrapper");
+  for (size_t blob = 0; blob < kBlobs; ++blob) {
+    auto member = std::dynamic_pointer_cast<Blob>(
+        meta.GetMember("buffer_" + std::to_string(blob)));
+    CHECK(member != nullptr);
+    CHECK_EQ(member->allocated_size(), kSizes[blob]);
+    for (size_t i = 0; i < kSizes[blob]; ++i) {
+      CHECK_EQ(member->data()[i], content(blob, i));
+    }
+  }
+  CHECK_EQ(meta.GetMemberMeta("empty").GetId(), EmptyBlobID());
+}
+
+int main(int argc, char** argv) {
+  if (argc < 4) {
+    printf(
+        "usage ./migration_test <ipc_socket> <ipc_socket_1> <ipc_socket_2>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  std::string ipc_socket_1 = std::string(argv[2]);
+  std::string ipc_socket_2 = std::string(argv[3]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  Client client1;
+  VINEYARD_CHECK_OK(client1.Connect(ipc_socket_1));
+  Client client2;
+  VINEYARD_CHECK_OK(client2.Connect(ipc_socket_2));
+  CHECK_NE(client.instance_id(), client1.instance_id());
+  CHECK_NE(client.instance_id(), client2.instance_id());
+  CHECK_NE(client1.instance_id(), client2.instance_id());
+  LOG(INFO) << "Connected to IPCServers: " << ipc_socket << ", "
+            << ipc_socket_1 << ", " << ipc_socket_2;
+
+  // the segment that would be registered for the RDMA reads covers the blob
+  {
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(kSizes[1], writer));
+    uintptr_t base = 0;
+    size_t size = 0;
+    CHECK(client.IsSharedMemory(writer->data() + kSizes[1] - 1, base, size));
+    auto address = reinterpret_cast<uintptr_t>(writer->data());
+    CHECK_LE(base, address);
+    CHECK_LE(address + kSizes[1], base + size);
+    CHECK(!client.IsSharedMemory(&writer, base, size));
+    VINEYARD_CHECK_OK(client.DelData(writer->Seal(client)->id()));
+  }
+  LOG(INFO) << "Passed shared segment lookup tests...";
+
+  ObjectID id = makeObject(client);
+
+  // migrating to the instance that holds the object does nothing
+  ObjectID local_id = InvalidObjectID();
+  VINEYARD_CHECK_OK(client.MigrateObject(id, local_id));
+  CHECK_EQ(local_id, id);
+
+  ObjectID migrated_id = InvalidObjectID();
+  VINEYARD_CHECK_OK(client1.MigrateObject(id, migrated_id));
+  CHECK_NE(migrated_id, InvalidObjectID());
+  CHECK_NE(migrated_id, id);
+  checkObject(client1, migrated_id);
+  LOG(INFO) << "Passed object migration tests...";
+
+  VINEYARD_CHECK_OK(client1.DelData(migrated_id, true, true));
+  VINEYARD_CHECK_OK(client.DelData(id, true, true));
+
+  // only the member that lives outside the given instances is migrated
+  {
+    std::vector<ObjectID> members = {makeObject(client), makeObject(client1),
+                                     makeObject(client2)};
+    ObjectMeta global;
+    global.SetTypeName("vineyard::test::GlobalWrapper");
+    global.SetGlobal(true);
+    global.SetNBytes(0);
+    for (size_t index = 0; index < members.size(); ++index) {
+      ObjectMeta member;
+      VINEYARD_CHECK_OK(client.GetMetaData(members[index], member, true));
+      global.AddMember("member_" + std::to_string(index), member);
+    }
+    ObjectID global_id = InvalidObjectID();
+    VINEYARD_CHECK_OK(client.CreateMetaData(global, global_id));
+    VINEYARD_CHECK_OK(client.Persist(global_id));
+
+    ObjectMeta unchanged;
+    VINEYARD_CHECK_OK(client.MigrateGlobalObject(
+        global_id, {client1.instance_id(), client2.instance_id()},
+        unchanged));
+    CHECK_EQ(unchanged.GetId(), global_id);
+
+    ObjectMeta view;
+    VINEYARD_CHECK_OK(
+        client.MigrateGlobalObject(global_id, {client1.instance_id()}, view));
+    CHECK_NE(view.GetId(), global_id);
+    CHECK(view.IsGlobal());
+    CHECK_EQ(view.GetMemberMeta("member_0").GetId(), members[0]);
+    CHECK_EQ(view.GetMemberMeta("member_1").GetId(), members[1]);
+    ObjectID copied_id = view.GetMemberMeta("member_2").GetId();
+    CHECK_NE(copied_id, members[2]);
+    checkObject(client, copied_id);
+
+    VINEYARD_CHECK_OK(client.DelData(view.GetId(), true, false));
+    VINEYARD_CHECK_OK(client.DelData(global_id, true, false));
+    VINEYARD_CHECK_OK(client.DelData(copied_id, true, true));
+    VINEYARD_CHECK_OK(client.DelData(members[0], true, true));
+    VINEYARD_CHECK_OK(client1.DelData(members[1], true, true));
+    VINEYARD_CHECK_OK(client2.DelData(members[2], true, true));
+  }
+  LOG(INFO) << "Passed global object migration tests...";
+
+  // the replicas are forwarded along a broadcast tree, the duplicated
+  // targets and the origin are skipped
+  {
+    ObjectID origin_id = makeObject(client);
+    std::map<InstanceID, ObjectID> replicas;
+    VINEYARD_CHECK_OK(client.Broadcast(
+        origin_id,
+        {client1.instance_id(), client2.instance_id(), client1.instance_id(),
+         client.instance_id()},
+        replicas));
+    CHECK_EQ(replicas.size(), 3U);
+    CHECK_EQ(replicas.at(client.instance_id()), origin_id);
+    for (Client* target : {&client1, &client2}) {
+      ObjectID replica_id = replicas.at(target->instance_id());
+      CHECK_NE(replica_id, origin_id);
+      checkObject(*target, replica_id);
+      VINEYARD_CHECK_OK(target->DelData(replica_id, true, true));
+    }
+    VINEYARD_CHECK_OK(client.DelData(origin_id, true, true));
+  }
+  LOG(INFO) << "Passed broadcast tests...";
+
+  client2.Disconnect();
+  client1.Disconnect();
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,106 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/util/blocking_queue.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+int main(int argc, char** argv) {
+  {
+    MPMCQueue<std::string> queue(3);
+    CHECK_EQ(queue.Capacity(), 4);
+    for (int i = 0; i < 4; ++i) {
+      CHECK(queue.TryPut(std::to_string(i)));
+    }
+    CHECK(!queue.TryPut("overflow"));
+    CHECK_EQ(queue.Size(), 4);
+
+    std::vector<std::string> items;
+    CHECK_EQ(queue.PopBatch(items, 3), 3);
+    CHECK(items == std::vector<std::string>({"0", "1", "2"}));
+    std::string item;
+    CHECK(queue.TryGet(item));
+    CHECK_EQ(item, "3");
+    CHECK(!queue.TryGet(item));
+    // leaves some items in the queue to be destroyed with it
+    queue.Put("4");
+  }
+  LOG(INFO) << "Passed single thread MPMC queue tests...";
+
+  constexpr int producers = 6, consumers = 4, items_per_producer = 100000;
+  MPMCQueue<std::string> queue(64);
+  queue.SetProducerNum(producers);
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; ++p) {
+    threads.emplace_back([&queue, p]() {
+      std::vector<std::string> batch;
+      for (int i = 0; i < items_per_producer; ++i) {
+        auto item = std::to_string(p * items_per_producer + i);
+        if (i % 3 == 0) {
+          queue.Put(std::move(item));
+        } else {
+          batch.emplace_back(std::move(item));
+          if (batch.size() == 7) {
+            queue.PushBatch(batch);
+            batch.clear();
+          }
+        }
+      }
+      queue.PushBatch(batch);
+      queue.DecProducerNum();
+    });
+  }
+  std::atomic<int64_t> count{0}, sum{0};
+  for (int c = 0; c < consumers; ++c) {
+    threads.emplace_back([&queue, &count, &sum, c]() {
+      std::string item;
+      std::vector<std::string> items;
+      while (true) {
+        if (c % 2 == 0) {
+          if (!queue.Get(item)) {
+            break;
+          }
+          sum += std::stoll(item);
+          count += 1;
+        } else {
+          items.clear();
+          if (queue.PopBatch(items, 5) == 0) {
+            break;
+          }
+          for (auto const& item : items) {
+            sum += std::stoll(item);
+            count += 1;
+          }
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  int64_t total = static_cast<int64_t>(producers) * items_per_producer;
+  CHECK_EQ(count.load(), total);
+  CHECK_EQ(sum.load(), total * (total - 1) / 2);
+  CHECK(queue.End());
+  LOG(INFO) << "Passed concurrent MPMC queue tests...";
+
+  return 0;
+}
@@ -16,6 +16,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -65,6 +66,115 @@ int main(int argc, char** argv) {
     CHECK_EQ((*vy_double_array)[i], double_array[i]);
   }
 
+  // test creating and persisting metadata in batches
+  {
+    std::vector<ObjectMeta> metas(16);
+    for (size_t i = 0; i < metas.size(); ++i) {
+      metas[i].SetTypeName("vineyard::BatchTestObject");
+      metas[i].AddKeyValue("index", i);
+    }
+    std::vector<ObjectID> ids;
+    VINEYARD_CHECK_OK(client.CreateMetaData(metas, ids));
+    CHECK_EQ(ids.size(), metas.size());
+    VINEYARD_CHECK_OK(client.Persist(ids));
+    for (size_t i = 0; i < ids.size(); ++i) {
+      CHECK_EQ(metas[i].GetId(), ids[i]);
+      bool persist = false;
+      VINEYARD_CHECK_OK(client.IfPersist(ids[i], persist));
+      CHECK(persist);
+      ObjectMeta meta;
+      VINEYARD_CHECK_OK(client.GetMetaData(ids[i], meta));
+      CHECK_EQ(meta.GetKeyValue<size_t>("index"), i);
+    }
+  }
+
+  // test persisting in the background
+  {
+    std::vector<ObjectMeta> metas(16);
+    for (size_t i = 0; i < metas.size(); ++i) {
+      metas[i].SetTypeName("vineyard::AsyncPersistTestObject");
+      metas[i].AddKeyValue("index", i);
+    }
+    std::vector<ObjectID> ids;
+    VINEYARD_CHECK_OK(client.CreateMetaData(metas, ids));
+    VINEYARD_CHECK_OK(client.PersistAsync(ids[0]));
+    VINEYARD_CHECK_OK(client.PersistAsync(
+        std::vector<ObjectID>(ids.begin() + 1, ids.end())));
+    bool persisted = false;
+    VINEYARD_CHECK_OK(client.PollPersist(ids[0], persisted));
+    for (auto const id : ids) {
+      VINEYARD_CHECK_OK(client.WaitPersist(id));
+      VINEYARD_CHECK_OK(client.PollPersist(id, persisted));
+      CHECK(persisted);
+      bool persist = false;
+      VINEYARD_CHECK_OK(client.IfPersist(id, persist));
+      CHECK(persist);
+    }
+
+    // the object that is never persisted
+    ObjectMeta meta;
+    meta.SetTypeName("vineyard::AsyncPersistTestObject");
+    ObjectID id = InvalidObjectID();
+    VINEYARD_CHECK_OK(client.CreateMetaData(meta, id));
+    CHECK(client.WaitPersist(id).IsObjectNotExists());
+  }
+
+  // test the persist requests that arrive at the same time, which are
+  // committed in groups, more than the ops that fit in one transaction
+  {
+    constexpr size_t kClients = 16;
+    constexpr size_t kObjectsPerClient = 24;
+
+    ObjectMeta member;
+    member.SetTypeName("vineyard::ConcurrentPersistTestMember");
+    ObjectID member_id = InvalidObjectID();
+    VINEYARD_CHECK_OK(client.CreateMetaData(member, member_id));
+
+    std::vector<std::vector<ObjectID>> created(kClients);
+    std::vector<std::thread> threads;
+    for (size_t index = 0; index < kClients; ++index) {
+      threads.emplace_back([&, index]() {
+        Client writer;
+        VINEYARD_CHECK_OK(writer.Connect(ipc_socket));
+        for (size_t seq = 0; seq < kObjectsPerClient; ++seq) {
+          ObjectMeta meta;
+          meta.SetTypeName("vineyard::ConcurrentPersistTestObject");
+          meta.AddKeyValue("client", index);
+          meta.AddKeyValue("seq", seq);
+          meta.AddMember("member", member_id);
+          ObjectID id = InvalidObjectID();
+          VINEYARD_CHECK_OK(writer.CreateMetaData(meta, id));
+          created[index].emplace_back(id);
+        }
+        // the shared member is persisted by the first request that reaches
+        // it, and the later ones see it as persisted
+        for (auto const id : created[index]) {
+          VINEYARD_CHECK_OK(writer.Persist(id));
+        }
+        writer.Disconnect();
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    bool persist = false;
+    VINEYARD_CHECK_OK(client.IfPersist(member_id, persist));
+    CHECK(persist);
+    for (size_t index = 0; index < kClients; ++index) {
+      CHECK_EQ(created[index].size(), kObjectsPerClient);
+      for (size_t seq = 0; seq < kObjectsPerClient; ++seq) {
+        VINEYARD_CHECK_OK(client.IfPersist(created[index][seq], persist));
+        CHECK(persist);
+        ObjectMeta meta;
+        VINEYARD_CHECK_OK(client.GetMetaData(created[index][seq], meta));
+        CHECK_EQ(meta.GetKeyValue<size_t>("client"), index);
+        CHECK_EQ(meta.GetKeyValue<size_t>("seq"), seq);
+        CHECK_EQ(meta.GetMemberMeta("member").GetId(), member_id);
+      }
+    }
+  }
+
   LOG(INFO) << "Passed persist tests...";
 
   client.Disconnect();
@@ -0,0 +1,178 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The vineyardds are expected to be launched with `--lease_sweep_interval 1`,
+// which expires the pins of the prefetched replicas.
+
+constexpr size_t kSizes[] = {1, 4097, 4 * 1024 * 1024 + 7};
+constexpr size_t kBlobs = sizeof(kSizes) / sizeof(kSizes[0]);
+constexpr int64_t kPinTTL = 2;
+
+static void waitFor(std::function<bool()> const& predicate) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+  while (!predicate()) {
+    CHECK(std::chrono::steady_clock::now() < deadline);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+}
+
+static char content(size_t const blob, size_t const offset) {
+  return static_cast<char>((blob * 13 + offset) % 249);
+}
+
+static ObjectID makeObject(Client& client) {
+  ObjectMeta meta;
+  meta.SetTypeName("vineyard::test::Prefetched");
+  size_t nbytes = 0;
+  for (size_t blob = 0; blob < kBlobs; ++blob) {
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(kSizes[blob], writer));
+    for (size_t i = 0; i < kSizes[blob]; ++i) {
+      writer->data()[i] = content(blob, i);
+    }
+    meta.AddMember("buffer_" + std::to_string(blob), writer->Seal(client));
+    nbytes += kSizes[blob];
+  }
+  meta.SetNBytes(nbytes);
+  ObjectID id = InvalidObjectID();
+  VINEYARD_CHECK_OK(client.CreateMetaData(meta, id));
+  VINEYARD_CHECK_OK(client.Persist(id));
+  return id;
+}
+
+static void checkObject(Client& client, ObjectID const id) {
+  ObjectMeta meta;
+  VINEYARD_CHECK_OK(client.GetMetaData(id, meta));
+  CHECK_EQ(meta.GetInstanceId(), client.instance_id());
+  for (size_t blob = 0; blob < kBlobs; ++blob) {
+    auto member = std::dynamic_pointer_cast<Blob>(
+        meta.GetMember("buffer_" + std::to_string(blob)));
+    CHECK(member != nullptr);
+    CHECK_EQ(member->allocated_size(), kSizes[blob]);
+    for (size_t i = 0; i < kSizes[blob]; i += 7) {
+      CHECK_EQ(member->data()[i], content(blob, i));
+    }
+  }
+}
+
+// The replica that has been prefetched to the instance, if any.
+static ObjectID prefetched(Client& client, ObjectID const id) {
+  std::vector<ObjectID> known;
+  VINEYARD_CHECK_OK(client.prefetchImpl({id}, {}, 1, known));
+  return known[0];
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage ./prefetch_test <ipc_socket> <ipc_socket_1>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  std::string ipc_socket_1 = std::string(argv[2]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  Client client1;
+  VINEYARD_CHECK_OK(client1.Connect(ipc_socket_1));
+  CHECK_NE(client.instance_id(), client1.instance_id());
+  LOG(INFO) << "Connected to IPCServers: " << ipc_socket << ", "
+            << ipc_socket_1;
+
+  std::vector<ObjectID> ids = {makeObject(client), makeObject(client),
+                               makeObject(client1)};
+
+  // the objects are migrated to the target, except the one that is there
+  std::vector<ObjectID> replicas;
+  VINEYARD_CHECK_OK(client.Prefetch(ids, client1.instance_id(), 60, replicas));
+  CHECK_EQ(replicas.size(), ids.size());
+  CHECK_EQ(replicas[2], ids[2]);
+  for (size_t idx = 0; idx < 2; ++idx) {
+    CHECK_NE(replicas[idx], InvalidObjectID());
+    CHECK_NE(replicas[idx], ids[idx]);
+    checkObject(client1, replicas[idx]);
+    CHECK_EQ(prefetched(client1, ids[idx]), replicas[idx]);
+    CHECK_EQ(prefetched(client, ids[idx]), InvalidObjectID());
+  }
+
+  // prefetching again pins the same replicas, and the jobs on the target
+  // get them without migrating again
+  std::vector<ObjectID> again;
+  VINEYARD_CHECK_OK(client.Prefetch(ids, client1.instance_id(), 60, again));
+  CHECK(again == replicas);
+  for (size_t idx = 0; idx < ids.size(); ++idx) {
+    ObjectID migrated = InvalidObjectID();
+    VINEYARD_CHECK_OK(client1.MigrateObject(ids[idx], migrated));
+    CHECK_EQ(migrated, replicas[idx]);
+  }
+  CHECK(!client.Prefetch(ids, client1.instance_id(), 0, again).ok());
+  LOG(INFO) << "Passed prefetching replicas tests...";
+
+  // the pins are released on demand, or once they expire
+  VINEYARD_CHECK_OK(client1.Unpin({ids[0]}));
+  CHECK_EQ(prefetched(client1, ids[0]), InvalidObjectID());
+  CHECK_EQ(prefetched(client1, ids[1]), replicas[1]);
+
+  ObjectID late = makeObject(client);
+  auto prefetching = client.PrefetchAsync({late}, client1.instance_id(),
+                                          kPinTTL);
+  // the client serves other requests during the prefetch
+  bool exists = false;
+  VINEYARD_CHECK_OK(client.Exists(late, exists));
+  CHECK(exists);
+  VINEYARD_CHECK_OK(prefetching.get());
+  ObjectID late_replica = prefetched(client1, late);
+  CHECK_NE(late_replica, InvalidObjectID());
+  checkObject(client1, late_replica);
+  waitFor([&]() { return prefetched(client1, late) == InvalidObjectID(); });
+
+  // an unpinned object is migrated again
+  ObjectID migrated = InvalidObjectID();
+  VINEYARD_CHECK_OK(client1.MigrateObject(late, migrated));
+  CHECK_NE(migrated, late_replica);
+  checkObject(client1, migrated);
+  LOG(INFO) << "Passed unpin tests...";
+
+  VINEYARD_CHECK_OK(client1.Unpin(ids));
+  for (auto const id : {replicas[0], replicas[1], late_replica, migrated}) {
+    VINEYARD_CHECK_OK(client1.DelData(id, true, true));
+  }
+  for (auto const id : {ids[0], ids[1], late}) {
+    VINEYARD_CHECK_OK(client.DelData(id, true, true));
+  }
+  VINEYARD_CHECK_OK(client1.DelData(ids[2], true, true));
+  client1.Disconnect();
+  client.Disconnect();
+
+  LOG(INFO) << "Passed prefetch tests...";
+
+  return 0;
+}
@@ -0,0 +1,142 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/json.h"
+#include "common/util/logging.h"
+#include "common/util/uuid.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The folded stacks are lines of "frame;frame;... count", and the counts add
+// up to at most the number of samples.
+size_t checkFolded(std::string const& folded) {
+  std::istringstream lines(folded);
+  std::string line;
+  size_t total = 0;
+  while (std::getline(lines, line)) {
+    auto pos = line.rfind(' ');
+    CHECK_NE(pos, std::string::npos);
+    CHECK_GT(pos, 0U);
+    size_t count = std::stoull(line.substr(pos + 1));
+    CHECK_GT(count, 0U);
+    total += count;
+  }
+  return total;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./profile_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // the statistics of the allocator reflect the allocated blobs
+  {
+    json result;
+    VINEYARD_CHECK_OK(client.Debug(json{{"heap_profile", json::object()}},
+                                   result));
+    json const& stats = result["heap_profile"]["stats"];
+    std::string allocator = stats["allocator"].get<std::string>();
+    CHECK(allocator == "dlmalloc" || allocator == "jemalloc");
+    size_t allocated = stats["bulk_allocated"].get<size_t>();
+
+    std::unique_ptr<BlobWriter> blob_writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(1 << 20, blob_writer));
+    VINEYARD_CHECK_OK(client.Debug(json{{"heap_profile", json::object()}},
+                                   result));
+    CHECK_GE(result["heap_profile"]["stats"]["bulk_allocated"].get<size_t>(),
+             allocated + (1 << 20));
+    auto blob = blob_writer->Seal(client);
+    VINEYARD_CHECK_OK(client.DelData(blob->id()));
+  }
+  LOG(INFO) << "Passed heap profile tests...";
+
+  // the invalid profiles are refused
+  {
+    json result;
+    CHECK(client
+              .Debug(json{{"cpu_profile", json{{"seconds", 0}}}}, result)
+              .IsInvalid());
+    CHECK(client
+              .Debug(json{{"cpu_profile",
+                           json{{"seconds", 1}, {"frequency", 100000}}}},
+                     result)
+              .IsInvalid());
+  }
+
+  // the server keeps serving the other requests while being profiled
+  {
+    std::atomic<bool> profiling{true};
+    std::atomic<size_t> requests{0};
+    std::thread worker([&]() {
+      Client worker_client;
+      VINEYARD_CHECK_OK(worker_client.Connect(ipc_socket));
+      while (profiling.load()) {
+        bool exists = true;
+        VINEYARD_CHECK_OK(worker_client.Exists(GenerateObjectID(), exists));
+        CHECK(!exists);
+        requests.fetch_add(1);
+      }
+      worker_client.Disconnect();
+    });
+
+    json result;
+    auto status = client.Debug(
+        json{{"cpu_profile", json{{"seconds", 2}, {"frequency", 499}}}},
+        result);
+    profiling.store(false);
+    worker.join();
+    CHECK_GT(requests.load(), 0U);
+
+    if (status.IsInvalid()) {
+      // vineyardd is built with BUILD_VINEYARD_PROFILING
+      LOG(INFO) << "The CPU profiler is unavailable: " << status.ToString();
+    } else {
+      VINEYARD_CHECK_OK(status);
+      json const& profile = result["cpu_profile"];
+      CHECK_EQ(profile["frequency"].get<int>(), 499);
+      size_t samples = profile["samples"].get<size_t>();
+      CHECK_GT(samples, 0U);
+      CHECK_LE(checkFolded(profile["folded"].get<std::string>()), samples);
+
+      // another profile can be taken once the previous one finishes
+      VINEYARD_CHECK_OK(client.Debug(
+          json{{"cpu_profile", json{{"seconds", 0.1}}}}, result));
+      CHECK_EQ(result["cpu_profile"]["frequency"].get<int>(), 99);
+    }
+  }
+  LOG(INFO) << "Passed cpu profile tests...";
+
+  client.Disconnect();
+
+  LOG(INFO) << "Passed profile tests...";
+
+  return 0;
+}
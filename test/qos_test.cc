@@ -0,0 +1,164 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/rpc_client.h"
+#include "common/util/json.h"
+#include "common/util/logging.h"
+#include "common/util/protocols.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// Larger than a write of batch connections, thus sent in paced writes.
+constexpr size_t kBlobSize = 20 * 1024 * 1024 + 7;
+
+// The number of connections of the given kind and class.
+static size_t connections(Client& client, std::string const& kind,
+                          std::string const& qos) {
+  std::shared_ptr<InstanceStatus> status;
+  VINEYARD_CHECK_OK(client.InstanceStatus(status));
+  size_t count = 0;
+  for (auto const& connection : status->connection_stats) {
+    if (connection["kind"].get<std::string>() == kind &&
+        connection["qos"].get<std::string>() == qos) {
+      count += 1;
+    }
+  }
+  return count;
+}
+
+static void checkBuffer(std::shared_ptr<arrow::Buffer> const& buffer) {
+  CHECK_EQ(static_cast<size_t>(buffer->size()), kBlobSize);
+  for (size_t offset = 0; offset < kBlobSize; ++offset) {
+    CHECK_EQ(buffer->data()[offset], static_cast<uint8_t>(offset % 251));
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage ./qos_test <ipc_socket> <rpc_endpoint>");
+    return 1;
+  }
+  std::string ipc_socket(argv[1]);
+  std::string rpc_endpoint(argv[2]);
+
+  // the class names
+  {
+    QoSClass qos_class = QoSClass::Batch;
+    VINEYARD_CHECK_OK(ParseQoSClass("", qos_class));
+    CHECK(qos_class == QoSClass::Interactive);
+    VINEYARD_CHECK_OK(ParseQoSClass("batch", qos_class));
+    CHECK(qos_class == QoSClass::Batch);
+    VINEYARD_CHECK_OK(ParseQoSClass("interactive", qos_class));
+    CHECK(qos_class == QoSClass::Interactive);
+    CHECK(ParseQoSClass("background", qos_class).IsInvalid());
+
+    // the interactive class is the default, and isn't written
+    for (auto const expected : {QoSClass::Interactive, QoSClass::Batch}) {
+      std::string message;
+      WriteRegisterRequest(WireFormat::MsgPack, 0, expected, message);
+      json root = DecodeMessage(message);
+      CHECK_EQ(root.contains("qos"), expected == QoSClass::Batch);
+      std::string version;
+      WireFormat wire_format = WireFormat::JSON;
+      size_t ring_capacity = 0;
+      VINEYARD_CHECK_OK(ReadRegisterRequest(root, version, wire_format,
+                                            ring_capacity, qos_class));
+      CHECK(qos_class == expected);
+      CHECK(wire_format == WireFormat::MsgPack);
+    }
+  }
+  LOG(INFO) << "Passed qos classes tests...";
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  ObjectID blob_id = InvalidObjectID();
+  {
+    std::unique_ptr<BlobWriter> blob_writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(kBlobSize, blob_writer));
+    for (size_t offset = 0; offset < kBlobSize; ++offset) {
+      blob_writer->data()[offset] = static_cast<char>(offset % 251);
+    }
+    blob_id = blob_writer->Seal(client)->id();
+  }
+
+  // the class is chosen by the environment variable, and reported in the
+  // connection stats
+  size_t ipc_batches = connections(client, "ipc", "batch");
+  size_t rpc_batches = connections(client, "rpc", "batch");
+  setenv("VINEYARD_QOS_CLASS", "batch", 1);
+  Client batch_client;
+  VINEYARD_CHECK_OK(batch_client.Connect(ipc_socket));
+  RPCClient batch_rpc_client;
+  VINEYARD_CHECK_OK(batch_rpc_client.Connect(rpc_endpoint));
+  CHECK_EQ(connections(client, "ipc", "batch"), ipc_batches + 1);
+  CHECK_EQ(connections(client, "rpc", "batch"), rpc_batches + 1);
+
+  setenv("VINEYARD_QOS_CLASS", "background", 1);
+  {
+    Client invalid_client;
+    CHECK(!invalid_client.Connect(ipc_socket).ok());
+  }
+  unsetenv("VINEYARD_QOS_CLASS");
+
+  RPCClient rpc_client;
+  VINEYARD_CHECK_OK(rpc_client.Connect(rpc_endpoint));
+  CHECK_EQ(connections(client, "rpc", "batch"), rpc_batches + 1);
+  LOG(INFO) << "Passed choosing qos classes tests...";
+
+  // the batch connections are served as usual, with the interactive sends
+  // in flight as well
+  {
+    bool exists = false;
+    VINEYARD_CHECK_OK(batch_client.Exists(blob_id, exists));
+    CHECK(exists);
+
+    std::vector<std::shared_ptr<arrow::Buffer>> batch_buffers;
+    std::thread batch_thread([&]() {
+      VINEYARD_CHECK_OK(
+          batch_rpc_client.GetRemoteBuffers({blob_id}, batch_buffers));
+    });
+    for (int round = 0; round < 4; ++round) {
+      std::vector<std::shared_ptr<arrow::Buffer>> buffers;
+      VINEYARD_CHECK_OK(rpc_client.GetRemoteBuffers({blob_id}, buffers));
+      checkBuffer(buffers[0]);
+    }
+    batch_thread.join();
+    CHECK_EQ(batch_buffers.size(), 1U);
+    checkBuffer(batch_buffers[0]);
+  }
+  LOG(INFO) << "Passed serving batch connections tests...";
+
+  rpc_client.Disconnect();
+  batch_rpc_client.Disconnect();
+  batch_client.Disconnect();
+  VINEYARD_CHECK_OK(client.DelData(blob_id));
+  client.Disconnect();
+
+  LOG(INFO) << "Passed qos tests...";
+
+  return 0;
+}
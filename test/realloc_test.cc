@@ -0,0 +1,102 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/allocator.h"
+#include "client/client.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// A large allocation at the tail of the arena grows in place, like the
+// buffer of a builder that keeps appending, and the others are moved.
+
+constexpr size_t kArenaSize = 512 * 1024 * 1024;
+constexpr size_t kInitialSize = 4 * 1024 * 1024;
+constexpr size_t kRounds = 4;
+
+static char content(size_t const offset) {
+  return static_cast<char>((offset * 7) % 251);
+}
+
+static void fill(char* data, size_t const from, size_t const to) {
+  for (size_t i = from; i < to; ++i) {
+    data[i] = content(i);
+  }
+}
+
+static void check(const char* data, size_t const size) {
+  for (size_t i = 0; i < size; i += 4093) {
+    CHECK_EQ(data[i], content(i));
+  }
+  CHECK_EQ(data[size - 1], content(size - 1));
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./realloc_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  // not destroyed, see the FIXME of `allocator_test` in runner.py
+  auto allocator = new VineyardAllocator<void>(client, kArenaSize);
+
+  // reallocating a null pointer allocates
+  char* tail = static_cast<char*>(allocator->Reallocate(nullptr, kInitialSize));
+  CHECK(tail != nullptr);
+  CHECK(allocator->Owns(tail));
+  fill(tail, 0, kInitialSize);
+
+  size_t size = kInitialSize;
+  for (size_t round = 0; round < kRounds; ++round) {
+    char* grown = static_cast<char*>(allocator->Reallocate(tail, size * 2));
+    CHECK_EQ(grown, tail);
+    CHECK_GE(allocator->GetAllocatedSize(grown), size * 2);
+    check(grown, size);
+    fill(grown, size, size * 2);
+    size *= 2;
+  }
+  LOG(INFO) << "Passed reallocating in place tests...";
+
+  // the allocation that is followed by another one is moved, with its content
+  char* other = static_cast<char*>(allocator->Allocate(kInitialSize));
+  CHECK(other != nullptr);
+  char* moved = static_cast<char*>(allocator->Reallocate(tail, size * 2));
+  CHECK(moved != nullptr);
+  CHECK(allocator->Owns(moved));
+  check(moved, size);
+  allocator->Free(moved);
+  allocator->Free(other);
+  LOG(INFO) << "Passed reallocating by moving tests...";
+
+  VINEYARD_CHECK_OK(allocator->Release());
+
+  LOG(INFO) << "Passed realloc tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -0,0 +1,99 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "arrow/buffer.h"
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "client/rpc_client.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The remote buffers are sent in gathered writes, which are bounded by both
+// the number of buffers and the bytes, thus the blobs below are many small
+// ones that span a few writes, and large ones that take a write each.
+
+constexpr size_t kSmallBlobs = 2500;
+constexpr size_t kLargeBlobs = 3;
+constexpr size_t kLargeSize = 40 * 1024 * 1024 + 3;
+
+static char content(size_t const blob, size_t const offset) {
+  return static_cast<char>((blob * 11 + offset) % 233);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage ./remote_buffers_test <ipc_socket> <rpc_endpoint>");
+    return 1;
+  }
+  std::string ipc_socket(argv[1]);
+  std::string rpc_endpoint(argv[2]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  RPCClient rpc_client;
+  VINEYARD_CHECK_OK(rpc_client.Connect(rpc_endpoint));
+  LOG(INFO) << "Connected to RPCServer: " << rpc_endpoint;
+
+  // the large blobs are interleaved with the small ones
+  std::vector<size_t> sizes;
+  for (size_t blob = 0; blob < kSmallBlobs + kLargeBlobs; ++blob) {
+    if (blob % (kSmallBlobs / kLargeBlobs + 1) == kSmallBlobs / kLargeBlobs) {
+      sizes.emplace_back(kLargeSize);
+    } else {
+      sizes.emplace_back(1 + blob % 97);
+    }
+  }
+  std::vector<std::unique_ptr<BlobWriter>> writers;
+  VINEYARD_CHECK_OK(client.CreateBlobs(sizes, writers));
+  std::vector<ObjectID> ids;
+  for (size_t blob = 0; blob < writers.size(); ++blob) {
+    for (size_t i = 0; i < sizes[blob]; ++i) {
+      writers[blob]->data()[i] = content(blob, i);
+    }
+    ids.emplace_back(writers[blob]->Seal(client)->id());
+  }
+
+  std::vector<std::shared_ptr<arrow::Buffer>> buffers;
+  VINEYARD_CHECK_OK(rpc_client.GetRemoteBuffers(ids, buffers));
+  CHECK_EQ(buffers.size(), ids.size());
+  for (size_t blob = 0; blob < ids.size(); ++blob) {
+    CHECK_EQ(static_cast<size_t>(buffers[blob]->size()), sizes[blob]);
+    size_t const step = sizes[blob] > 4096 ? 4093 : 1;
+    for (size_t i = 0; i < sizes[blob]; i += step) {
+      CHECK_EQ(static_cast<char>(buffers[blob]->data()[i]), content(blob, i));
+    }
+    // the last byte of each buffer, where the next one starts in the write
+    CHECK_EQ(static_cast<char>(buffers[blob]->data()[sizes[blob] - 1]),
+             content(blob, sizes[blob] - 1));
+  }
+  LOG(INFO) << "Passed gathered remote buffers tests...";
+
+  VINEYARD_CHECK_OK(client.DelData(ids));
+  client.Disconnect();
+  rpc_client.Disconnect();
+
+  return 0;
+}
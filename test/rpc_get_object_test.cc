@@ -13,9 +13,12 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -23,7 +26,9 @@ limitations under the License.
 
 #include "basic/ds/array.h"
 #include "client/client.h"
+#include "client/ds/blob.h"
 #include "client/ds/object_meta.h"
+#include "client/ds/remote_blob.h"
 #include "client/rpc_client.h"
 #include "common/util/logging.h"
 
@@ -104,6 +109,95 @@ int main(int argc, char** argv) {
     CHECK(!targets3.empty());
   }
 
+  {
+    // a big blob that will be split across connections, and a small one
+    std::vector<size_t> sizes = {160 * 1024 * 1024 + 7, 1024};
+    std::vector<ObjectID> blob_ids;
+    for (size_t const size : sizes) {
+      std::unique_ptr<BlobWriter> blob_writer;
+      VINEYARD_CHECK_OK(client.CreateBlob(size, blob_writer));
+      for (size_t idx = 0; idx < size; ++idx) {
+        blob_writer->data()[idx] = static_cast<char>(idx % 251);
+      }
+      blob_ids.emplace_back(blob_writer->Seal(client)->id());
+    }
+
+    for (auto const& option : std::vector<std::pair<size_t, bool>>{
+             {1, false}, {4, false}, {1, true}, {4, true}}) {
+      std::vector<std::shared_ptr<arrow::Buffer>> buffers;
+      VINEYARD_CHECK_OK(rpc_client.GetRemoteBuffers(
+          blob_ids, buffers, option.first, option.second));
+      CHECK_EQ(buffers.size(), sizes.size());
+      for (size_t idx = 0; idx < sizes.size(); ++idx) {
+        CHECK_EQ(static_cast<size_t>(buffers[idx]->size()), sizes[idx]);
+        for (size_t offset = 0; offset < sizes[idx]; ++offset) {
+          CHECK_EQ(buffers[idx]->data()[offset],
+                   static_cast<uint8_t>(offset % 251));
+        }
+      }
+    }
+  }
+
+  {
+    // stream blobs into the remote instance in chunks
+    size_t const size = 10 * 1024 * 1024 + 3, chunk_size = 1024 * 1024;
+    std::vector<char> chunk(chunk_size);
+    for (bool const compressed : {false, true}) {
+      std::unique_ptr<RemoteBlobWriter> writer;
+      VINEYARD_CHECK_OK(rpc_client.CreateRemoteBlob(size, writer, compressed));
+      while (writer->offset() < writer->size()) {
+        size_t const length =
+            std::min(chunk_size, writer->size() - writer->offset());
+        for (size_t idx = 0; idx < length; ++idx) {
+          chunk[idx] = static_cast<char>((writer->offset() + idx) % 251);
+        }
+        VINEYARD_CHECK_OK(writer->Append(chunk.data(), length));
+      }
+      CHECK(!writer->Append(chunk.data(), 1).ok());
+      ObjectID blob_id = InvalidObjectID();
+      VINEYARD_CHECK_OK(writer->Seal(blob_id));
+      CHECK_EQ(blob_id, writer->id());
+
+      std::vector<std::shared_ptr<arrow::Buffer>> buffers;
+      VINEYARD_CHECK_OK(rpc_client.GetRemoteBuffers({blob_id}, buffers));
+      CHECK_EQ(static_cast<size_t>(buffers[0]->size()), size);
+      for (size_t offset = 0; offset < size; ++offset) {
+        CHECK_EQ(buffers[0]->data()[offset],
+                 static_cast<uint8_t>(offset % 251));
+      }
+    }
+
+    // the unfinished blob is dropped
+    std::unique_ptr<RemoteBlobWriter> writer;
+    VINEYARD_CHECK_OK(rpc_client.CreateRemoteBlob(size, writer));
+    VINEYARD_CHECK_OK(writer->Append(chunk.data(), chunk_size));
+    ObjectID blob_id = InvalidObjectID();
+    CHECK(!writer->Seal(blob_id).ok());
+    VINEYARD_CHECK_OK(writer->Abort());
+  }
+
+  {
+    // repeated reads go through the remote blob cache of the local instance,
+    // it falls back to plain fetches when the cache is disabled
+    size_t const size = 4 * 1024 * 1024 + 5;
+    std::unique_ptr<BlobWriter> blob_writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(size, blob_writer));
+    for (size_t idx = 0; idx < size; ++idx) {
+      blob_writer->data()[idx] = static_cast<char>(idx % 251);
+    }
+    ObjectID blob_id = blob_writer->Seal(client)->id();
+    for (int round = 0; round < 2; ++round) {
+      std::vector<std::shared_ptr<arrow::Buffer>> buffers;
+      VINEYARD_CHECK_OK(
+          rpc_client.GetRemoteBuffers(client, {blob_id}, buffers));
+      CHECK_EQ(static_cast<size_t>(buffers[0]->size()), size);
+      for (size_t offset = 0; offset < size; ++offset) {
+        CHECK_EQ(buffers[0]->data()[offset],
+                 static_cast<uint8_t>(offset % 251));
+      }
+    }
+  }
+
   LOG(INFO) << "Passed various ways to get object with rpc tests...";
 
   client.Disconnect();
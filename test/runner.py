@@ -3,10 +3,13 @@
 
 import contextlib
 import importlib
+import json
 import os
 import platform
+import re
 import socket
 import subprocess
+import tempfile
 import time
 from argparse import ArgumentParser
 
@@ -93,6 +96,7 @@ def start_vineyardd(
     size=4 * 1024 * 1024 * 1024,
     default_ipc_socket=VINEYARD_CI_IPC_SOCKET,
     idx=None,
+    extra_args=(),
     **kw,
 ):
     rpc_socket_port = find_port()
@@ -113,6 +117,7 @@ def start_vineyardd(
             etcd_endpoints,
             '--etcd_prefix',
             etcd_prefix,
+            *extra_args,
             verbose=True,
             **kw,
         )
@@ -279,25 +284,66 @@ def run_single_vineyardd_tests():
         'vineyard_test_%s' % time.time(),
         default_ipc_socket=VINEYARD_CI_IPC_SOCKET,
     ) as (_, rpc_socket_port):
+        run_test('adj_list_intersection_test')
+        run_test('arena_allocator_test')
         run_test('array_test')
+        run_test('async_client_test')
+        run_test('byte_stream_parser_test')
+        run_test('client_pool_test')
         # FIXME: cannot be safely dtor after #350 and #354.
         # run_test('allocator_test')
         run_test('arrow_data_structure_test')
+        run_test('arrow_ipc_view_test')
+        if os.path.exists(get_data_path('p2p-31_property_e_0')):
+            run_test(
+                'arrow_fragment_test',
+                '1',
+                '%s#src_label=v&dst_label=v&label=e'
+                % get_data_path('p2p-31_property_e_0'),
+                '1',
+                '%s#label=v' % get_data_path('p2p-31_property_v_0'),
+                '1',
+            )
+        run_test('arrow_memory_pool_test')
+        run_test('arrow_vertex_map_test')
         run_test('clear_test')
+        run_test('concurrent_create_test')
+        run_test('concurrent_memcpy_test')
+        run_test('copy_on_write_test')
         run_test('custom_vector_test')
         run_test('dataframe_test')
+        run_test('deferred_name_test')
         run_test('delete_test')
+        run_test('device_blob_test')
+        run_test('encoded_array_test')
+        run_test('frontier_test')
+        run_test('fused_test')
         run_test('get_wait_test')
         run_test('get_object_test')
         run_test('global_object_test')
         run_test('hashmap_test')
         run_test('id_test')
+        run_test('io_adaptor_batch_test')
         run_test('invalid_connect_test', '127.0.0.1:%d' % rpc_socket_port)
+        if os.environ.get('KAFKA_BROKERS'):
+            run_test('kafka_io_adaptor_test', os.environ['KAFKA_BROKERS'])
         run_test('large_meta_test')
         run_test('list_object_test')
+        run_test('memory_attribution_test')
+        run_test('mpmc_queue_test')
         run_test('name_test')
+        run_test('object_dump_test')
+        run_test('outer_vertex_index_test')
         run_test('pair_test')
+        run_test('parquet_view_test')
+        run_test('partitioner_test')
+        run_test('perfect_hashmap_test')
         run_test('persist_test')
+        run_test('profile_test')
+        run_test('qos_test', '127.0.0.1:%d' % rpc_socket_port)
+        run_test('readahead_input_stream_test')
+        run_test('realloc_test')
+        run_test('remote_buffers_test', '127.0.0.1:%d' % rpc_socket_port)
         run_test('rpc_delete_test', '127.0.0.1:%d' % rpc_socket_port)
         run_test('rpc_get_object_test', '127.0.0.1:%d' % rpc_socket_port)
         run_test('rpc_test', '127.0.0.1:%d' % rpc_socket_port)
@@ -308,14 +354,347 @@ def run_single_vineyardd_tests():
         run_test('shared_memory_test')
         run_test('deep_copy_test')
         run_test('stream_test')
+        run_test('string_collection_test')
+        run_test('table_shuffler_test', nproc=3)
         run_test('tensor_test')
+        run_test('thread_group_test')
+        run_test('trace_test')
         run_test('tuple_test')
         run_test('typename_test')
         run_test('version_test')
+        run_test('wire_format_test')
 
         run_invalid_client_test('127.0.0.1', rpc_socket_port)
 
 
+def run_deduplication_tests():
+    etcd_port = find_port()
+    [find_port() for _ in range(10)]  # skip some ports
+    with start_vineyardd(
+        'http://localhost:%d' % etcd_port,
+        'vineyard_test_%s' % time.time(),
+        default_ipc_socket=VINEYARD_CI_IPC_SOCKET,
+        extra_args=('--deduplicate_blobs',),
+    ):
+        run_test('deduplication_test')
+
+
+def run_io_uring_tests():
+    etcd_port = find_port()
+    [find_port() for _ in range(10)]  # skip some ports
+    with start_vineyardd(
+        'http://localhost:%d' % etcd_port,
+        'vineyard_test_%s' % time.time(),
+        default_ipc_socket=VINEYARD_CI_IPC_SOCKET,
+        extra_args=('--io_uring',),
+    ) as (_, rpc_socket_port):
+        # falls back to asio when io_uring isn't supported
+        run_test('rpc_get_object_test', '127.0.0.1:%d' % rpc_socket_port)
+
+
+def run_growable_memory_tests():
+    etcd_port = find_port()
+    [find_port() for _ in range(10)]  # skip some ports
+    with start_vineyardd(
+        'http://localhost:%d' % etcd_port,
+        'vineyard_test_%s' % time.time(),
+        size=256 * 1024 * 1024,
+        default_ipc_socket=VINEYARD_CI_IPC_SOCKET,
+        extra_args=('--initial_size', '16Mi'),
+    ):
+        run_test('growable_memory_test')
+        run_test('shared_memory_test')
+
+
+def run_io_shards_tests():
+    etcd_port = find_port()
+    [find_port() for _ in range(10)]  # skip some ports
+    with start_vineyardd(
+        'http://localhost:%d' % etcd_port,
+        'vineyard_test_%s' % time.time(),
+        default_ipc_socket=VINEYARD_CI_IPC_SOCKET,
+        extra_args=('--io_shards', '4'),
+    ) as (_, rpc_socket_port):
+        run_test('io_shards_test', '127.0.0.1:%d' % rpc_socket_port)
+        run_test('stream_test')
+
+
+def run_spill_tests():
+    etcd_port = find_port()
+    [find_port() for _ in range(10)]  # skip some ports
+    with tempfile.TemporaryDirectory() as spill_path:
+        with start_vineyardd(
+            'http://localhost:%d' % etcd_port,
+            'vineyard_test_%s' % time.time(),
+            size=64 * 1024 * 1024,
+            default_ipc_socket=VINEYARD_CI_IPC_SOCKET,
+            extra_args=('--spill_path', spill_path),
+        ):
+            run_test('spill_test')
+            run_test('spill_file_test', spill_path)
+
+
+def run_far_memory_tests():
+    etcd_port = find_port()
+    [find_port() for _ in range(10)]  # skip some ports
+    with tempfile.TemporaryDirectory() as far_memory_dir:
+        with start_vineyardd(
+            'http://localhost:%d' % etcd_port,
+            'vineyard_test_%s' % time.time(),
+            size=64 * 1024 * 1024,
+            default_ipc_socket=VINEYARD_CI_IPC_SOCKET,
+            extra_args=(
+                '--far_memory_path',
+                os.path.join(far_memory_dir, 'far_memory'),
+                '--far_memory_size',
+                '256Mi',
+                '--far_memory_promote_hits',
+                '2',
+            ),
+        ):
+            run_test('far_memory_test')
+
+
+def run_memory_quota_tests():
+    etcd_port = find_port()
+    [find_port() for _ in range(10)]  # skip some ports
+    with tempfile.TemporaryDirectory() as spill_path:
+        with start_vineyardd(
+            'http://localhost:%d' % etcd_port,
+            'vineyard_test_%s' % time.time(),
+            default_ipc_socket=VINEYARD_CI_IPC_SOCKET,
+            extra_args=(
+                '--spill_path',
+                spill_path,
+                '--memory_quotas',
+                'etl=4Mi:8Mi,*=6Mi',
+            ),
+        ):
+            run_test('memory_quota_test')
+
+
+def run_lease_tests():
+    etcd_port = find_port()
+    [find_port() for _ in range(10)]  # skip some ports
+    with start_vineyardd(
+        'http://localhost:%d' % etcd_port,
+        'vineyard_test_%s' % time.time(),
+        default_ipc_socket=VINEYARD_CI_IPC_SOCKET,
+        extra_args=('--lease_sweep_interval', '1'),
+    ):
+        run_test('lease_test')
+
+
+def run_thread_roles_tests():
+    etcd_port = find_port()
+    [find_port() for _ in range(10)]  # skip some ports
+    # all roles share a single CPU, thus their threads can be told by the
+    # affinity
+    cpu = max(os.sched_getaffinity(0))
+    affinity = ';'.join(
+        '%s=%d' % (role, cpu) for role in ['worker', 'ipc', 'rpc', 'meta', 'background']
+    )
+    with start_vineyardd(
+        'http://localhost:%d' % etcd_port,
+        'vineyard_test_%s' % time.time(),
+        default_ipc_socket=VINEYARD_CI_IPC_SOCKET,
+        extra_args=(
+            '--worker_threads',
+            '2',
+            '--ipc_threads',
+            '2',
+            '--rpc_threads',
+            '1',
+            '--background_threads',
+            '1',
+            '--lease_sweep_interval',
+            '1',
+            '--cpu_affinity',
+            affinity,
+        ),
+    ) as (proc, rpc_socket_port):
+        run_test('concurrent_create_test')
+        run_test('lease_test')
+        run_test('rpc_test', '127.0.0.1:%d' % rpc_socket_port)
+
+        # the workers, the ipc, rpc and background threads, the meta thread
+        # and the page recycler
+        pinned = [
+            tid
+            for tid in os.listdir('/proc/%d/task' % proc.pid)
+            if os.sched_getaffinity(int(tid)) == {cpu}
+        ]
+        assert len(pinned) >= 2 + 2 + 1 + 1 + 1 + 1, pinned
+
+
+def run_multiple_vineyardd_tests(etcd_endpoints, instance_size=2, extra_args=()):
+    etcd_prefix = 'vineyard_test_%s' % time.time()
+    ipc_socket_tpl = '/tmp/vineyard.ci.multiple.%s' % time.time()
+    with start_multiple_vineyardd(
+        etcd_endpoints,
+        etcd_prefix,
+        default_ipc_socket=ipc_socket_tpl,
+        instance_size=instance_size,
+        extra_args=extra_args,
+    ):
+        sockets = ['%s.%d' % (ipc_socket_tpl, i) for i in range(instance_size)]
+        run_test('meta_sync_test', *sockets[1:], vineyard_ipc_socket=sockets[0])
+        run_test('sync_remote_test', *sockets[1:], vineyard_ipc_socket=sockets[0])
+
+
+def run_compressed_meta_tests(etcd_endpoints):
+    etcdctl = find_executable('etcdctl')
+    etcd_prefix = 'vineyard_test_%s' % time.time()
+    ipc_socket_tpl = '/tmp/vineyard.ci.compressed.%s' % time.time()
+    # only the first instance packs the metadata, the other one reads the
+    # packed values as well
+    with contextlib.ExitStack() as stack:
+        stack.enter_context(
+            start_vineyardd(
+                etcd_endpoints,
+                etcd_prefix,
+                default_ipc_socket=ipc_socket_tpl,
+                idx=0,
+                extra_args=('--etcd_compress_meta',),
+            )
+        )
+        stack.enter_context(
+            start_vineyardd(
+                etcd_endpoints,
+                etcd_prefix,
+                default_ipc_socket=ipc_socket_tpl,
+                idx=1,
+            )
+        )
+        sockets = ['%s.%d' % (ipc_socket_tpl, i) for i in range(2)]
+        run_test('meta_sync_test', *sockets[1:], vineyard_ipc_socket=sockets[0])
+        run_test('sync_remote_test', *sockets[1:], vineyard_ipc_socket=sockets[0])
+
+        run_test('meta_snapshot_test', 'create', vineyard_ipc_socket=sockets[0])
+        output = subprocess.check_output(
+            [
+                etcdctl,
+                '--endpoints',
+                etcd_endpoints,
+                'get',
+                '%s/data/' % etcd_prefix,
+                '--prefix',
+                '--keys-only',
+            ]
+        )
+        keys = [key for key in output.decode('utf-8').split() if key]
+        fields = [key for key in keys if key.count('/') > 2]
+        assert keys and not fields, keys
+        time.sleep(3)  # wait for the other instance to sync
+        run_test('meta_snapshot_test', 'check', vineyard_ipc_socket=sockets[1])
+
+
+def run_prefetch_tests(etcd_endpoints, instance_size=2):
+    etcd_prefix = 'vineyard_test_%s' % time.time()
+    ipc_socket_tpl = '/tmp/vineyard.ci.prefetch.%s' % time.time()
+    with start_multiple_vineyardd(
+        etcd_endpoints,
+        etcd_prefix,
+        default_ipc_socket=ipc_socket_tpl,
+        instance_size=instance_size,
+        extra_args=('--lease_sweep_interval', '1'),
+    ):
+        sockets = ['%s.%d' % (ipc_socket_tpl, i) for i in range(instance_size)]
+        run_test('prefetch_test', *sockets[1:], vineyard_ipc_socket=sockets[0])
+
+
+def run_migration_tests(etcd_endpoints, instance_size=3):
+    etcd_prefix = 'vineyard_test_%s' % time.time()
+    ipc_socket_tpl = '/tmp/vineyard.ci.migration.%s' % time.time()
+    with start_multiple_vineyardd(
+        etcd_endpoints,
+        etcd_prefix,
+        default_ipc_socket=ipc_socket_tpl,
+        instance_size=instance_size,
+        extra_args=('--rdma',),
+    ):
+        sockets = ['%s.%d' % (ipc_socket_tpl, i) for i in range(instance_size)]
+        run_test('migration_test', *sockets[1:], vineyard_ipc_socket=sockets[0])
+        run_test(
+            'object_migration_test', *sockets[1:], vineyard_ipc_socket=sockets[0]
+        )
+
+
+def run_meta_snapshot_tests(etcd_endpoints):
+    etcdctl = find_executable('etcdctl')
+    etcd_prefix = 'vineyard_test_%s' % time.time()
+    snapshot_path = '/tmp/vineyard_meta_snapshot_%s' % time.time()
+    extra_args = (
+        '--meta_snapshot_path',
+        snapshot_path,
+        '--meta_snapshot_interval',
+        '1',
+    )
+    with start_vineyardd(etcd_endpoints, etcd_prefix, extra_args=extra_args):
+        run_test('meta_snapshot_test', 'create')
+        time.sleep(3)  # wait for the snapshot
+
+    # compact etcd past the revision of the snapshot, the restarted vineyardd
+    # falls back to the cold start
+    key = '%s_compaction' % etcd_prefix
+    for value in range(10):
+        subprocess.check_call(
+            [etcdctl, '--endpoints', etcd_endpoints, 'put', key, str(value)]
+        )
+    output = subprocess.check_output(
+        [etcdctl, '--endpoints', etcd_endpoints, 'get', key, '-w', 'json']
+    )
+    revision = json.loads(output)['header']['revision']
+    subprocess.check_call(
+        [etcdctl, '--endpoints', etcd_endpoints, 'compact', str(revision)]
+    )
+    with start_vineyardd(etcd_endpoints, etcd_prefix, extra_args=extra_args):
+        run_test('meta_snapshot_test', 'check')
+    os.remove(snapshot_path)
+
+
+def run_startup_tests(etcd_endpoints):
+    etcd_prefix = 'vineyard_test_%s' % time.time()
+    phases = [
+        'meta_start',
+        'bulk_allocate',
+        'meta_ready',
+        'bulk_ready',
+        'ipc_ready',
+        'rpc_ready',
+    ]
+    with tempfile.TemporaryDirectory() as log_dir:
+        with start_vineyardd(
+            etcd_endpoints,
+            etcd_prefix,
+            size=512 * 1024 * 1024,
+            extra_args=('--prefault', '--log_dir', log_dir),
+        ):
+            # the meta service and the bulk store start concurrently, and
+            # the server is ready once all of the phases have finished
+            ready, deadline = None, time.time() + 60
+            while ready is None and time.time() < deadline:
+                for name in os.listdir(log_dir):
+                    with open(os.path.join(log_dir, name), errors='ignore') as f:
+                        for line in f:
+                            if 'vineyardd is ready in' in line:
+                                ready = line
+                if ready is None:
+                    time.sleep(1)
+            assert ready is not None, 'vineyardd is not ready'
+            total = float(re.search(r'ready in ([0-9.e+-]+)s', ready).group(1))
+            timings = dict(
+                (phase, float(seconds))
+                for phase, seconds in re.findall(r'(\w+): ([0-9.e+-]+)s', ready)
+            )
+            assert sorted(timings) == sorted(phases), ready
+            assert all(0 <= timings[phase] <= total for phase in phases), ready
+            assert timings['meta_ready'] >= timings['meta_start'], ready
+
+            run_test('persist_test')
+            run_test('stream_test')
+
+
 def run_scale_in_out_tests(etcd_endpoints, instance_size=4):
     etcd_prefix = 'vineyard_test_%s' % time.time()
     with start_multiple_vineyardd(
@@ -346,6 +725,86 @@ def run_scale_in_out_tests(etcd_endpoints, instance_size=4):
         time.sleep(5)
 
 
+def run_co_located_copy_tests(etcd_endpoints):
+    etcd_prefix = 'vineyard_test_%s' % time.time()
+    ipc_socket_tpl = '/tmp/vineyard.ci.co_located.%s' % time.time()
+    with start_multiple_vineyardd(
+        etcd_endpoints,
+        etcd_prefix,
+        default_ipc_socket=ipc_socket_tpl,
+        instance_size=2,
+    ) as instances:
+        sockets = ['%s.%d' % (ipc_socket_tpl, i) for i in range(2)]
+        rpc_endpoint = 'localhost:%d' % instances[0][1]
+        for co_located in ['true', 'false']:
+            output = run_test(
+                'co_located_copy_test',
+                'create',
+                capture=True,
+                vineyard_ipc_socket=sockets[0],
+            )
+            object_id = output.decode().split()[-1]
+            port = find_port()
+            with start_program(
+                'vineyard-migrate',
+                '--server',
+                'true',
+                '--ipc_socket',
+                sockets[0],
+                '--rpc_endpoint',
+                rpc_endpoint,
+                '--host',
+                '0.0.0.0',
+                '--port',
+                str(port),
+                verbose=True,
+            ):
+                proc = subprocess.run(
+                    [
+                        find_executable('vineyard-migrate'),
+                        '--client',
+                        'true',
+                        '--ipc_socket',
+                        sockets[1],
+                        '--rpc_endpoint',
+                        rpc_endpoint,
+                        '--host',
+                        'localhost',
+                        '--port',
+                        str(port),
+                        '--id',
+                        object_id,
+                        '--local_copy',
+                        'true',
+                        '--co_located_copy',
+                        co_located,
+                        '--v',
+                        '10',
+                    ],
+                    stdout=subprocess.PIPE,
+                    stderr=subprocess.PIPE,
+                    check=True,
+                )
+            logs = proc.stderr.decode(errors='ignore')
+            copied_id = proc.stdout.decode().split()[-1]
+
+            # the blobs of the co-located instance are copied between the
+            # shared memory, and never sent over the socket
+            copied = logs.count('from the co-located instance')
+            received = logs.count('Receiving blob payload')
+            if co_located == 'true':
+                assert (copied, received) == (3, 0), logs
+            else:
+                assert (copied, received) == (0, 3), logs
+            run_test(
+                'co_located_copy_test',
+                'check',
+                object_id,
+                copied_id,
+                vineyard_ipc_socket=sockets[1],
+            )
+
+
 def run_python_tests(etcd_endpoints, with_migration):
     etcd_prefix = 'vineyard_test_%s' % time.time()
     with start_vineyardd(
@@ -545,6 +1004,45 @@ def run_io_adaptor_distributed_tests(etcd_endpoints, with_migration):
         )
 
 
+def run_flight_tests(etcd_endpoints):
+    try:
+        find_executable('vineyard-flight')
+    except RuntimeError:
+        print('vineyard-flight is not built, skip the flight tests', flush=True)
+        return
+    etcd_prefix = 'vineyard_test_%s' % time.time()
+    flight_port = find_port()
+    with start_vineyardd(
+        etcd_endpoints, etcd_prefix, default_ipc_socket=VINEYARD_CI_IPC_SOCKET
+    ), start_program(
+        'vineyard-flight',
+        '--ipc_socket',
+        VINEYARD_CI_IPC_SOCKET,
+        '--port',
+        str(flight_port),
+        verbose=True,
+    ):
+        start_time = time.time()
+        subprocess.check_call(
+            [
+                'pytest',
+                '-s',
+                '-vvv',
+                '--durations=0',
+                '--log-cli-level',
+                'DEBUG',
+                'modules/io/python/drivers/io/tests/test_flight.py',
+                '--vineyard-ipc-socket=%s' % VINEYARD_CI_IPC_SOCKET,
+                '--vineyard-flight-endpoint=grpc://localhost:%d' % flight_port,
+            ],
+            cwd=os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'),
+        )
+        print(
+            'running flight tests use %s seconds' % (time.time() - start_time),
+            flush=True,
+        )
+
+
 def parse_sys_args():
     arg_parser = ArgumentParser()
     arg_parser.add_argument(
@@ -589,8 +1087,37 @@ def main():
 
     if args.with_cpp:
         run_single_vineyardd_tests()
+        run_deduplication_tests()
+        run_io_uring_tests()
+        run_io_shards_tests()
+        run_spill_tests()
+        run_far_memory_tests()
+        run_memory_quota_tests()
+        run_lease_tests()
+        if platform.system() == 'Linux':
+            run_thread_roles_tests()
+        run_growable_memory_tests()
+        with start_etcd() as (_, etcd_endpoints):
+            run_multiple_vineyardd_tests(etcd_endpoints)
+        with start_etcd() as (_, etcd_endpoints):
+            run_multiple_vineyardd_tests(
+                etcd_endpoints, extra_args=('--etcd_owned_writes',)
+            )
+        with start_etcd() as (_, etcd_endpoints):
+            run_compressed_meta_tests(etcd_endpoints)
+        with start_etcd() as (_, etcd_endpoints):
+            run_prefetch_tests(etcd_endpoints)
         with start_etcd() as (_, etcd_endpoints):
             run_scale_in_out_tests(etcd_endpoints, instance_size=4)
+        with start_etcd() as (_, etcd_endpoints):
+            run_meta_snapshot_tests(etcd_endpoints)
+        with start_etcd() as (_, etcd_endpoints):
+            run_startup_tests(etcd_endpoints)
+        if args.with_migration:
+            with start_etcd() as (_, etcd_endpoints):
+                run_migration_tests(etcd_endpoints)
+            with start_etcd() as (_, etcd_endpoints):
+                run_co_located_copy_tests(etcd_endpoints)
 
     if args.with_python:
         with start_etcd() as (_, etcd_endpoints):
@@ -608,6 +1135,8 @@ def main():
             run_io_adaptor_tests(etcd_endpoints, args.with_migration)
         with start_etcd() as (_, etcd_endpoints):
             run_io_adaptor_distributed_tests(etcd_endpoints, args.with_migration)
+        with start_etcd() as (_, etcd_endpoints):
+            run_flight_tests(etcd_endpoints)
 
 
 if __name__ == '__main__':
@@ -13,7 +13,10 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <unistd.h>
+
 #include <algorithm>
+#include <cstring>
 #include <map>
 #include <memory>
 #include <string>
@@ -25,6 +28,7 @@ limitations under the License.
 #include "arrow/util/logging.h"
 
 #include "client/client.h"
+#include "client/ds/blob.h"
 #include "client/ds/object_meta.h"
 #include "common/util/logging.h"
 
@@ -58,6 +62,28 @@ int main(int argc, char** argv) {
   CHECK(!cluster.empty());
   CHECK(!cluster[client.instance_id()].empty());
 
+  {
+    // checkpoint the blobs that are referenced by objects
+    std::unique_ptr<BlobWriter> writer;
+    VINEYARD_CHECK_OK(client.CreateBlob(4096, writer));
+    memset(writer->data(), 'x', 4096);
+    auto blob = writer->Seal(client);
+    ObjectMeta meta;
+    meta.SetTypeName("vineyard::CheckpointTest");
+    meta.SetNBytes(4096);
+    meta.AddMember("buffer_", blob->id());
+    ObjectID id = InvalidObjectID();
+    VINEYARD_CHECK_OK(client.CreateMetaData(meta, id));
+
+    std::string path = "/tmp/vineyard_server_status_test.checkpoint";
+    json stats;
+    VINEYARD_CHECK_OK(client.Checkpoint(path, stats));
+    CHECK_GE(stats["blobs"].get<size_t>(), 1);
+    CHECK_GE(stats["bytes"].get<size_t>(), 4096);
+    CHECK_EQ(unlink(path.c_str()), 0);
+    VINEYARD_CHECK_OK(client.DelData(id, true, true));
+  }
+
   LOG(INFO) << "Passed server status tests...";
 
   client.Disconnect();
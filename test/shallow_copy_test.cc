@@ -61,8 +61,66 @@ int main(int argc, char** argv) {
     CHECK_EQ((*copied_vec)[i], double_array[i]);
   }
 
-  VINEYARD_CHECK_OK(client.DelData(target_id));
-  VINEYARD_CHECK_OK(client.DelData(id));
+  // the copies of copies, with the extra metadata
+  ObjectID overlay_id = InvalidObjectID();
+  VINEYARD_CHECK_OK(
+      client.ShallowCopy(target_id, json{{"tag", "copied"}}, overlay_id));
+  ObjectMeta overlay_meta;
+  VINEYARD_CHECK_OK(client.GetMetaData(overlay_id, overlay_meta));
+  CHECK_EQ(overlay_meta.GetKeyValue("tag"), "copied");
+  CHECK_EQ(overlay_meta.GetKeyValue<size_t>("size_"), double_array.size());
+  auto overlay_vec =
+      std::dynamic_pointer_cast<Array<double>>(client.GetObject(overlay_id));
+  for (size_t i = 0; i < double_array.size(); ++i) {
+    CHECK_EQ((*overlay_vec)[i], double_array[i]);
+  }
+
+  bool exists = false;
+  auto check_array = [&](ObjectID const array_id) {
+    auto array =
+        std::dynamic_pointer_cast<Array<double>>(client.GetObject(array_id));
+    CHECK(array != nullptr);
+    CHECK_EQ(array->size(), double_array.size());
+    for (size_t i = 0; i < double_array.size(); ++i) {
+      CHECK_EQ((*array)[i], double_array[i]);
+    }
+  };
+
+  // deleting a copy deeply leaves the source and the other copies intact
+  VINEYARD_CHECK_OK(client.DelData(overlay_id, false, true));
+  VINEYARD_CHECK_OK(client.Exists(overlay_id, exists));
+  CHECK(!exists);
+  VINEYARD_CHECK_OK(client.Exists(id, exists));
+  CHECK(exists);
+  check_array(id);
+  check_array(target_id);
+
+  // the source can be deleted while the copies exist, and the copies are
+  // still readable afterwards
+  VINEYARD_CHECK_OK(client.DelData(id, false, true));
+  VINEYARD_CHECK_OK(client.Exists(id, exists));
+  CHECK(!exists);
+  VINEYARD_CHECK_OK(client.Exists(target_id, exists));
+  CHECK(exists);
+  check_array(target_id);
+
+  // a forced delete of the source doesn't cascade into the copies
+  {
+    ArrayBuilder<double> source_builder(client, double_array);
+    auto source = source_builder.Seal(client);
+    VINEYARD_CHECK_OK(client.Persist(source->id()));
+    ObjectID copy_id = InvalidObjectID();
+    VINEYARD_CHECK_OK(client.ShallowCopy(source->id(), copy_id));
+    VINEYARD_CHECK_OK(client.DelData(source->id(), true, false));
+    VINEYARD_CHECK_OK(client.Exists(source->id(), exists));
+    CHECK(!exists);
+    VINEYARD_CHECK_OK(client.Exists(copy_id, exists));
+    CHECK(exists);
+    check_array(copy_id);
+    VINEYARD_CHECK_OK(client.DelData(copy_id, false, true));
+  }
+
+  VINEYARD_CHECK_OK(client.DelData(target_id, false, true));
 
   LOG(INFO) << "Passed shallow copy tests...";
 
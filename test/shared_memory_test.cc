@@ -13,9 +13,12 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -23,6 +26,7 @@ limitations under the License.
 
 #include "basic/ds/array.h"
 #include "client/client.h"
+#include "client/ds/blob.h"
 #include "client/ds/object_meta.h"
 #include "common/util/logging.h"
 
@@ -59,6 +63,71 @@ int main(int argc, char** argv) {
   CHECK(!client.IsSharedMemory(&sealed_double_array));
   CHECK(!client.IsSharedMemory(&builder));
 
+  // creates and gets buffers through the shared memory request ring
+  {
+    Client ring_client;
+    VINEYARD_CHECK_OK(ring_client.Connect(ipc_socket, 64 * 1024));
+    for (size_t round = 0; round < 64; ++round) {
+      std::vector<double> values(round + 1, static_cast<double>(round));
+      ArrayBuilder<double> ring_builder(ring_client, values);
+      auto sealed = std::dynamic_pointer_cast<Array<double>>(
+          ring_builder.Seal(ring_client));
+      CHECK(ring_client.IsSharedMemory(sealed->data()));
+      auto array = std::dynamic_pointer_cast<Array<double>>(
+          ring_client.GetObject(sealed->id()));
+      CHECK_EQ(array->size(), values.size());
+      for (size_t i = 0; i < values.size(); ++i) {
+        CHECK_EQ((*array)[i], values[i]);
+      }
+    }
+    ring_client.Disconnect();
+  }
+
+  // the lookups run concurrently with the mapping of new segments, e.g.,
+  // when the vineyardd grows its memory on demand
+  {
+    constexpr size_t kBlobs = 64;
+    constexpr size_t kSize = 1024 * 1024 + 11;
+    std::atomic<bool> finished(false);
+    std::mutex mutex;
+    std::vector<std::shared_ptr<Blob>> sealed;
+    std::vector<std::thread> readers;
+    for (size_t reader = 0; reader < 4; ++reader) {
+      readers.emplace_back([&]() {
+        while (!finished.load()) {
+          CHECK(client.IsSharedMemory(ptr));
+          CHECK(!client.IsSharedMemory(&double_array));
+          std::vector<std::shared_ptr<Blob>> blobs;
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            blobs = sealed;
+          }
+          for (auto const& blob : blobs) {
+            CHECK(client.IsSharedMemory(blob->data()));
+            CHECK(client.IsSharedMemory(blob->data() + kSize - 1));
+          }
+        }
+      });
+    }
+    for (size_t index = 0; index < kBlobs; ++index) {
+      std::unique_ptr<BlobWriter> writer;
+      VINEYARD_CHECK_OK(client.CreateBlob(kSize, writer));
+      CHECK(client.IsSharedMemory(writer->data()));
+      auto blob = std::dynamic_pointer_cast<Blob>(writer->Seal(client));
+      std::lock_guard<std::mutex> lock(mutex);
+      sealed.emplace_back(blob);
+    }
+    finished.store(true);
+    for (auto& reader : readers) {
+      reader.join();
+    }
+    std::vector<ObjectID> ids;
+    for (auto const& blob : sealed) {
+      ids.emplace_back(blob->id());
+    }
+    VINEYARD_CHECK_OK(client.DelData(ids));
+  }
+
   LOG(INFO) << "Passed shared memory tests...";
 
   client.Disconnect();
@@ -0,0 +1,133 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The vineyardd is expected to be launched with a 64 MiB `--size` and the
+// `--spill_path` given to this test, the blobs that don't fit are spilled to
+// files named by their ids, except the ones that are held by a client.
+
+constexpr size_t kBlobs = 24;
+constexpr size_t kSize = 4 * 1024 * 1024;
+
+static char content(size_t const blob, size_t const offset) {
+  return static_cast<char>((blob * 13 + offset) % 241);
+}
+
+static std::set<ObjectID> spilledBlobs(std::string const& spill_path) {
+  std::set<ObjectID> spilled;
+  DIR* dir = opendir(spill_path.c_str());
+  CHECK(dir != nullptr);
+  while (struct dirent* entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name != "." && name != "..") {
+      spilled.emplace(ObjectIDFromString(name));
+    }
+  }
+  closedir(dir);
+  return spilled;
+}
+
+static ObjectID createBlob(Client& client, size_t const blob) {
+  std::unique_ptr<BlobWriter> writer;
+  VINEYARD_CHECK_OK(client.CreateBlob(kSize, writer));
+  for (size_t i = 0; i < kSize; ++i) {
+    writer->data()[i] = content(blob, i);
+  }
+  return writer->Seal(client)->id();
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage ./spill_file_test <ipc_socket> <spill_path>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  std::string spill_path = std::string(argv[2]);
+
+  // the blob of a connected client is pinned in the shared memory
+  Client holder;
+  VINEYARD_CHECK_OK(holder.Connect(ipc_socket));
+  ObjectID pinned = createBlob(holder, kBlobs);
+
+  std::vector<ObjectID> ids;
+  for (size_t blob = 0; blob < kBlobs; ++blob) {
+    Client writer;
+    VINEYARD_CHECK_OK(writer.Connect(ipc_socket));
+    ids.emplace_back(createBlob(writer, blob));
+    writer.Disconnect();
+  }
+
+  auto spilled = spilledBlobs(spill_path);
+  CHECK(!spilled.empty());
+  CHECK_EQ(spilled.count(pinned), 0U);
+  for (auto const id : spilled) {
+    CHECK(std::find(ids.begin(), ids.end(), id) != ids.end());
+  }
+  LOG(INFO) << spilled.size() << " of " << kBlobs << " blobs are spilled";
+
+  {
+    std::shared_ptr<InstanceStatus> status;
+    VINEYARD_CHECK_OK(holder.InstanceStatus(status));
+    CHECK_LE(status->memory_usage, status->memory_limit);
+  }
+
+  // the spilled blobs are reloaded transparently, a few at a time as the
+  // reader pins them until it disconnects
+  for (size_t blob = 0; blob < kBlobs; ++blob) {
+    Client reader;
+    VINEYARD_CHECK_OK(reader.Connect(ipc_socket));
+    std::vector<std::shared_ptr<Blob>> items;
+    VINEYARD_CHECK_OK(reader.GetBlobs({ids[blob]}, items));
+    auto const& item = items[0];
+    CHECK_EQ(item->allocated_size(), kSize);
+    for (size_t i = 0; i < kSize; i += 1021) {
+      CHECK_EQ(item->data()[i], content(blob, i));
+    }
+    reader.Disconnect();
+  }
+  LOG(INFO) << "Passed reloading spilled blobs tests...";
+
+  // deleting the blobs removes their spill files as well
+  VINEYARD_CHECK_OK(holder.DelData(ids));
+  for (auto const id : spilledBlobs(spill_path)) {
+    CHECK(std::find(ids.begin(), ids.end(), id) == ids.end());
+  }
+  holder.Disconnect();
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  VINEYARD_CHECK_OK(client.DelData(pinned));
+  client.Disconnect();
+
+  LOG(INFO) << "Passed spill file tests...";
+  return 0;
+}
@@ -0,0 +1,116 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arrow/status.h"
+#include "arrow/util/io_util.h"
+#include "arrow/util/logging.h"
+
+#include "client/client.h"
+#include "client/ds/blob.h"
+#include "common/util/logging.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// The vineyardd is expected to be launched with a 64 MiB `--size` and
+// `--spill_path`, thus most of the blobs below are spilled, and are read back
+// by the concurrent readers.
+
+constexpr size_t kBlobs = 32;
+constexpr size_t kReaders = 4;
+constexpr size_t kBatch = 2;
+constexpr size_t kRounds = 8;
+
+// large enough to be allocated outside the slabs
+constexpr size_t kSize = 4 * 1024 * 1024 + 123;
+
+static char content(size_t const blob, size_t const offset) {
+  return static_cast<char>((blob * 31 + offset) % 251);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./spill_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  // the blobs are released by the writer once it disconnects, and then can
+  // be spilled to make room for the next ones
+  std::vector<ObjectID> ids;
+  for (size_t blob = 0; blob < kBlobs; ++blob) {
+    Client writer;
+    VINEYARD_CHECK_OK(writer.Connect(ipc_socket));
+    std::unique_ptr<BlobWriter> blob_writer;
+    VINEYARD_CHECK_OK(writer.CreateBlob(kSize, blob_writer));
+    for (size_t i = 0; i < kSize; ++i) {
+      blob_writer->data()[i] = content(blob, i);
+    }
+    ids.emplace_back(blob_writer->Seal(writer)->id());
+    writer.Disconnect();
+  }
+  LOG(INFO) << "Created " << kBlobs << " blobs of " << kSize << " bytes";
+
+  // the readers reload the spilled blobs, in batches, at the same time
+  std::vector<std::thread> threads;
+  for (size_t reader = 0; reader < kReaders; ++reader) {
+    threads.emplace_back([&, reader]() {
+      for (size_t round = 0; round < kRounds; ++round) {
+        Client client;
+        VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+        std::vector<ObjectID> batch;
+        for (size_t k = 0; k < kBatch; ++k) {
+          batch.emplace_back(
+              ids[(reader * kRounds * kBatch + round * kBatch + k) % kBlobs]);
+        }
+        std::vector<std::shared_ptr<Blob>> blobs;
+        VINEYARD_CHECK_OK(client.GetBlobs(batch, blobs));
+        CHECK_EQ(blobs.size(), batch.size());
+        for (auto const& item : blobs) {
+          size_t blob = 0;
+          while (ids[blob] != item->id()) {
+            ++blob;
+          }
+          CHECK_EQ(item->allocated_size(), kSize);
+          for (size_t i = 0; i < kSize; i += 4093) {
+            CHECK_EQ(item->data()[i], content(blob, i));
+          }
+        }
+        client.Disconnect();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  VINEYARD_CHECK_OK(client.DelData(ids));
+  for (auto const id : ids) {
+    bool exists = true;
+    VINEYARD_CHECK_OK(client.Exists(id, exists));
+    CHECK(!exists);
+  }
+  LOG(INFO) << "Passed spill tests...";
+
+  client.Disconnect();
+
+  return 0;
+}
@@ -13,10 +13,15 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -25,6 +30,7 @@ limitations under the License.
 #include "basic/stream/byte_stream.h"
 #include "basic/stream/dataframe_stream.h"
 #include "client/client.h"
+#include "client/ds/blob.h"
 #include "client/ds/object_meta.h"
 #include "common/util/logging.h"
 
@@ -108,6 +114,362 @@ void testByteStream(Client& client, std::string const& ipc_socket) {
   }
 }
 
+void testFanoutStream(Client& client, std::string const& ipc_socket) {
+  ObjectID stream_id = InvalidObjectID();
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_test"}});
+    auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+  }
+
+  const size_t readers = 3, chunks = 8;
+  std::atomic<size_t> opened(0);
+  std::vector<std::vector<size_t>> recv_chunks_size(readers);
+
+  std::vector<std::thread> recv_thrds;
+  for (size_t reader = 0; reader < readers; ++reader) {
+    recv_thrds.emplace_back([&, reader]() {
+      Client reader_client;
+      VINEYARD_CHECK_OK(reader_client.Connect(ipc_socket));
+      VINEYARD_CHECK_OK(
+          reader_client.OpenStream(stream_id, StreamOpenMode::fanout));
+      CHECK(reader_client.OpenStream(stream_id, StreamOpenMode::fanout)
+                .IsStreamOpened());
+      CHECK(reader_client.OpenStream(stream_id, StreamOpenMode::read)
+                .IsStreamOpened());
+      opened += 1;
+
+      while (true) {
+        std::unique_ptr<arrow::Buffer> buffer = nullptr;
+        auto status = reader_client.PullNextStreamChunk(stream_id, buffer);
+        if (status.ok()) {
+          CHECK(buffer != nullptr);
+          if (buffer->size() > 0) {
+            CHECK_EQ(static_cast<size_t>(buffer->data()[0]),
+                     recv_chunks_size[reader].size() % 256);
+          }
+          recv_chunks_size[reader].emplace_back(buffer->size());
+        } else {
+          CHECK(status.IsStreamDrained());
+          break;
+        }
+      }
+    });
+  }
+
+  std::thread send_thrd([&]() {
+    Client writer_client;
+    VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+    VINEYARD_CHECK_OK(
+        writer_client.OpenStream(stream_id, StreamOpenMode::write));
+    // readers join before the first chunk to see the whole stream
+    while (opened.load() < readers) {
+      std::this_thread::yield();
+    }
+    for (size_t idx = 1; idx <= chunks; ++idx) {
+      std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+      VINEYARD_CHECK_OK(
+          writer_client.GetNextStreamChunk(stream_id, 1 << idx, buffer));
+      CHECK(buffer != nullptr);
+      buffer->mutable_data()[0] = static_cast<uint8_t>(idx - 1);
+    }
+    VINEYARD_CHECK_OK(writer_client.StopStream(stream_id, false));
+  });
+
+  send_thrd.join();
+  for (auto& thrd : recv_thrds) {
+    thrd.join();
+  }
+
+  for (size_t reader = 0; reader < readers; ++reader) {
+    CHECK_EQ(recv_chunks_size[reader].size(), chunks);
+    for (size_t idx = 0; idx < chunks; ++idx) {
+      CHECK_EQ(recv_chunks_size[reader][idx], 2UL << idx);
+    }
+  }
+}
+
+void testFanoutStreamReleased(Client& client, std::string const& ipc_socket) {
+  ObjectID stream_id = InvalidObjectID();
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_test"}});
+    auto bstream = builder.ByteStreamBaseBuilder::Seal(client);
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+    // the writer is blocked unless the chunks are released
+    VINEYARD_CHECK_OK(client.CreateStream(stream_id, 0, 0, 2, 1));
+  }
+
+  const size_t chunks = 8;
+  std::atomic<bool> opened(false);
+
+  std::thread recv_thrd([&]() {
+    Client reader_client;
+    VINEYARD_CHECK_OK(reader_client.Connect(ipc_socket));
+    VINEYARD_CHECK_OK(
+        reader_client.OpenStream(stream_id, StreamOpenMode::fanout));
+    opened = true;
+    ObjectID chunk = InvalidObjectID();
+    VINEYARD_CHECK_OK(reader_client.PullNextStreamChunk(stream_id, chunk));
+    // the last reader leaves without reading the rest of the stream
+    reader_client.Disconnect();
+  });
+
+  Client writer_client;
+  VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+  VINEYARD_CHECK_OK(writer_client.OpenStream(stream_id, StreamOpenMode::write));
+  while (!opened.load()) {
+    std::this_thread::yield();
+  }
+  for (size_t idx = 0; idx < chunks; ++idx) {
+    std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+    VINEYARD_CHECK_OK(
+        writer_client.GetNextStreamChunk(stream_id, 1 << 10, buffer));
+    CHECK(buffer != nullptr);
+  }
+  VINEYARD_CHECK_OK(writer_client.StopStream(stream_id, false));
+  recv_thrd.join();
+}
+
+void testSharedStream(Client& client, std::string const& ipc_socket) {
+  ObjectID stream_id = InvalidObjectID();
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_test"}});
+    auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+  }
+
+  const size_t readers = 3, chunks = 16;
+  std::mutex mutex;
+  std::vector<ObjectID> send_chunks, recv_chunks;
+
+  std::vector<std::thread> recv_thrds;
+  for (size_t reader = 0; reader < readers; ++reader) {
+    recv_thrds.emplace_back([&]() {
+      Client reader_client;
+      VINEYARD_CHECK_OK(reader_client.Connect(ipc_socket));
+      VINEYARD_CHECK_OK(
+          reader_client.OpenStream(stream_id, StreamOpenMode::shared));
+      CHECK(reader_client.OpenStream(stream_id, StreamOpenMode::shared)
+                .IsStreamOpened());
+      CHECK(reader_client.OpenStream(stream_id, StreamOpenMode::fanout)
+                .IsStreamOpened());
+
+      while (true) {
+        ObjectID chunk = InvalidObjectID();
+        auto status = reader_client.PullNextStreamChunk(stream_id, chunk);
+        if (status.ok()) {
+          std::lock_guard<std::mutex> lock(mutex);
+          recv_chunks.emplace_back(chunk);
+        } else {
+          CHECK(status.IsStreamDrained());
+          break;
+        }
+      }
+    });
+  }
+
+  std::thread send_thrd([&]() {
+    Client writer_client;
+    VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+    VINEYARD_CHECK_OK(
+        writer_client.OpenStream(stream_id, StreamOpenMode::write));
+    for (size_t idx = 0; idx < chunks; ++idx) {
+      std::unique_ptr<BlobWriter> blob_writer;
+      VINEYARD_CHECK_OK(writer_client.CreateBlob(1024, blob_writer));
+      auto chunk = blob_writer->Seal(writer_client)->id();
+      VINEYARD_CHECK_OK(writer_client.PushNextStreamChunk(stream_id, chunk));
+      send_chunks.emplace_back(chunk);
+    }
+    VINEYARD_CHECK_OK(writer_client.StopStream(stream_id, false));
+  });
+
+  send_thrd.join();
+  for (auto& thrd : recv_thrds) {
+    thrd.join();
+  }
+
+  // every chunk is read by exactly one of the readers
+  std::sort(send_chunks.begin(), send_chunks.end());
+  std::sort(recv_chunks.begin(), recv_chunks.end());
+  CHECK(send_chunks == recv_chunks);
+}
+
+void testBatchStream(Client& client, std::string const& ipc_socket) {
+  ObjectID stream_id = InvalidObjectID();
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_test"}});
+    auto bstream = std::dynamic_pointer_cast<ByteStream>(builder.Seal(client));
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+  }
+
+  const size_t batches = 4, batch_size = 4;
+  std::vector<ObjectID> send_chunks, recv_chunks;
+
+  std::thread send_thrd([&]() {
+    Client writer_client;
+    VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+    VINEYARD_CHECK_OK(
+        writer_client.OpenStream(stream_id, StreamOpenMode::write));
+    for (size_t batch = 0; batch < batches; ++batch) {
+      std::vector<ObjectID> chunks;
+      for (size_t idx = 0; idx < batch_size; ++idx) {
+        std::unique_ptr<BlobWriter> blob_writer;
+        VINEYARD_CHECK_OK(writer_client.CreateBlob(1024, blob_writer));
+        chunks.emplace_back(blob_writer->Seal(writer_client)->id());
+      }
+      VINEYARD_CHECK_OK(writer_client.PushNextStreamChunks(stream_id, chunks));
+      send_chunks.insert(send_chunks.end(), chunks.begin(), chunks.end());
+    }
+    VINEYARD_CHECK_OK(writer_client.StopStream(stream_id, false));
+  });
+
+  std::thread recv_thrd([&]() {
+    Client reader_client;
+    VINEYARD_CHECK_OK(reader_client.Connect(ipc_socket));
+    VINEYARD_CHECK_OK(reader_client.OpenStream(stream_id, StreamOpenMode::read));
+    while (true) {
+      std::vector<ObjectID> chunks;
+      // at most 3 chunks, or 2 chunks by the byte budget
+      auto status =
+          reader_client.PullNextStreamChunks(stream_id, 3, 2048, chunks);
+      if (status.ok()) {
+        CHECK(!chunks.empty());
+        CHECK_LE(chunks.size(), 2UL);
+        recv_chunks.insert(recv_chunks.end(), chunks.begin(), chunks.end());
+      } else {
+        CHECK(status.IsStreamDrained());
+        break;
+      }
+    }
+  });
+
+  send_thrd.join();
+  recv_thrd.join();
+
+  CHECK(send_chunks == recv_chunks);
+}
+
+void testWatermarkStream(Client& client, std::string const& ipc_socket) {
+  ObjectID stream_id = InvalidObjectID();
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_test"}});
+    auto bstream = builder.ByteStreamBaseBuilder::Seal(client);
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+    // the writer is blocked at 4 unconsumed chunks, until 2 are left
+    VINEYARD_CHECK_OK(client.CreateStream(stream_id, 0, 0, 4, 2));
+  }
+
+  const size_t chunks = 16;
+  std::atomic<size_t> produced(0);
+
+  std::thread send_thrd([&]() {
+    Client writer_client;
+    VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+    VINEYARD_CHECK_OK(
+        writer_client.OpenStream(stream_id, StreamOpenMode::write));
+    for (size_t idx = 0; idx < chunks; ++idx) {
+      std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+      VINEYARD_CHECK_OK(
+          writer_client.GetNextStreamChunk(stream_id, 1024, buffer));
+      buffer->mutable_data()[0] = static_cast<uint8_t>(idx);
+      produced += 1;
+    }
+    VINEYARD_CHECK_OK(writer_client.StopStream(stream_id, false));
+  });
+
+  // nothing is consumed yet, the writer stops at the high watermark
+  sleep(1);
+  CHECK_GT(produced.load(), 0U);
+  CHECK_LE(produced.load(), 4U);
+
+  Client reader_client;
+  VINEYARD_CHECK_OK(reader_client.Connect(ipc_socket));
+  VINEYARD_CHECK_OK(reader_client.OpenStream(stream_id, StreamOpenMode::read));
+  size_t consumed = 0;
+  while (true) {
+    std::unique_ptr<arrow::Buffer> buffer = nullptr;
+    auto status = reader_client.PullNextStreamChunk(stream_id, buffer);
+    if (!status.ok()) {
+      CHECK(status.IsStreamDrained());
+      break;
+    }
+    CHECK_EQ(buffer->size(), 1024);
+    CHECK_EQ(static_cast<size_t>(buffer->data()[0]), consumed);
+    consumed += 1;
+    // the chunks before the one being read are released
+    CHECK_LE(produced.load(), consumed + 4);
+  }
+  send_thrd.join();
+  CHECK_EQ(consumed, chunks);
+}
+
+void testRecycledStream(Client& client, std::string const& ipc_socket) {
+  ObjectID stream_id = InvalidObjectID();
+  {
+    ByteStreamBuilder builder(client);
+    builder.SetParams(std::unordered_map<std::string, std::string>{
+        {"kind", "test"}, {"test_name", "stream_test"}});
+    auto bstream = builder.ByteStreamBaseBuilder::Seal(client);
+    stream_id = bstream->id();
+    CHECK(stream_id != InvalidObjectID());
+    VINEYARD_CHECK_OK(client.CreateStream(stream_id, 0, 0, 0, 0, true));
+  }
+
+  Client writer_client, reader_client;
+  VINEYARD_CHECK_OK(writer_client.Connect(ipc_socket));
+  VINEYARD_CHECK_OK(reader_client.Connect(ipc_socket));
+  VINEYARD_CHECK_OK(writer_client.OpenStream(stream_id, StreamOpenMode::write));
+  VINEYARD_CHECK_OK(reader_client.OpenStream(stream_id, StreamOpenMode::read));
+
+  // a chunk becomes readable once the next one is requested, and is released
+  // once the next one is read, thus the chunks released are reused by the
+  // writer for the chunks of the same size
+  const size_t chunks = 16;
+  std::set<ObjectID> chunk_ids;
+  auto pull = [&](size_t const expected) {
+    ObjectID chunk = InvalidObjectID();
+    VINEYARD_CHECK_OK(reader_client.PullNextStreamChunk(stream_id, chunk));
+    chunk_ids.emplace(chunk);
+    std::vector<std::shared_ptr<Blob>> blobs;
+    VINEYARD_CHECK_OK(reader_client.GetBlobs({chunk}, blobs));
+    auto const& blob = blobs[0];
+    CHECK_EQ(blob->allocated_size(), 4096U);
+    CHECK_EQ(static_cast<size_t>(blob->data()[0]), expected);
+  };
+  for (size_t idx = 0; idx < chunks; ++idx) {
+    std::unique_ptr<arrow::MutableBuffer> buffer = nullptr;
+    VINEYARD_CHECK_OK(
+        writer_client.GetNextStreamChunk(stream_id, 4096, buffer));
+    buffer->mutable_data()[0] = static_cast<uint8_t>(idx);
+    if (idx > 0) {
+      pull(idx - 1);
+    }
+  }
+  VINEYARD_CHECK_OK(writer_client.StopStream(stream_id, false));
+  pull(chunks - 1);
+  ObjectID chunk = InvalidObjectID();
+  CHECK(reader_client.PullNextStreamChunk(stream_id, chunk).IsStreamDrained());
+  CHECK_LT(chunk_ids.size(), chunks);
+
+  writer_client.Disconnect();
+  reader_client.Disconnect();
+}
+
 void testByteStreamFailed(Client& client, std::string const& ipc_socket) {
   ObjectID stream_id = InvalidObjectID();
   {
@@ -300,6 +662,24 @@ int main(int argc, char** argv) {
   testByteStreamFailed(client, ipc_socket);
   LOG(INFO) << "Passed failed bytestream test...";
 
+  testFanoutStream(client, ipc_socket);
+  LOG(INFO) << "Passed fan-out stream test...";
+
+  testFanoutStreamReleased(client, ipc_socket);
+  LOG(INFO) << "Passed released fan-out stream test...";
+
+  testSharedStream(client, ipc_socket);
+  LOG(INFO) << "Passed shared stream test...";
+
+  testBatchStream(client, ipc_socket);
+  LOG(INFO) << "Passed batched stream test...";
+
+  testWatermarkStream(client, ipc_socket);
+  LOG(INFO) << "Passed watermark stream test...";
+
+  testRecycledStream(client, ipc_socket);
+  LOG(INFO) << "Passed recycled stream test...";
+
   testEmptyStream(client, ipc_socket);
   LOG(INFO) << "Passed empty bytestream test...";
 
@@ -0,0 +1,178 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client/client.h"
+#include "client/ds/object_meta.h"
+#include "common/util/logging.h"
+#include "common/util/uuid.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// GetData with `sync_remote` fetches the subtrees of the requested objects
+// from etcd, thus the objects persisted by another instance are found right
+// away, regardless of the unrelated updates, and the later updates are still
+// replayed by the watcher.
+
+constexpr size_t kObjects = 16;
+
+static void waitFor(std::function<bool()> const& predicate) {
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+  while (!predicate()) {
+    CHECK(std::chrono::steady_clock::now() < deadline);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+}
+
+// An object of two levels of members.
+static ObjectID createNested(Client& client, size_t const seq) {
+  ObjectMeta leaf;
+  leaf.SetTypeName("vineyard::test::SyncedLeaf");
+  leaf.SetNBytes(0);
+  leaf.AddKeyValue("seq", seq);
+  ObjectID leaf_id = InvalidObjectID();
+  VINEYARD_CHECK_OK(client.CreateMetaData(leaf, leaf_id));
+
+  ObjectMeta inner;
+  inner.SetTypeName("vineyard::test::SyncedInner");
+  inner.SetNBytes(0);
+  inner.AddMember("leaf", leaf_id);
+  ObjectID inner_id = InvalidObjectID();
+  VINEYARD_CHECK_OK(client.CreateMetaData(inner, inner_id));
+
+  ObjectMeta outer;
+  outer.SetTypeName("vineyard::test::SyncedOuter");
+  outer.SetNBytes(0);
+  outer.AddMember("inner", inner_id);
+  outer.AddKeyValue("seq", seq);
+  ObjectID outer_id = InvalidObjectID();
+  VINEYARD_CHECK_OK(client.CreateMetaData(outer, outer_id));
+  VINEYARD_CHECK_OK(client.Persist(outer_id));
+  return outer_id;
+}
+
+static void checkNested(ObjectMeta const& meta, ObjectID const id,
+                        size_t const seq) {
+  CHECK_EQ(meta.GetId(), id);
+  CHECK_EQ(meta.GetTypeName(), "vineyard::test::SyncedOuter");
+  CHECK_EQ(meta.GetKeyValue<size_t>("seq"), seq);
+  auto leaf = meta.GetMemberMeta("inner").GetMemberMeta("leaf");
+  CHECK_EQ(leaf.GetTypeName(), "vineyard::test::SyncedLeaf");
+  CHECK_EQ(leaf.GetKeyValue<size_t>("seq"), seq);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    printf("usage ./sync_remote_test <ipc_socket> <ipc_socket_1>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+  std::string ipc_socket_1 = std::string(argv[2]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  Client client1;
+  VINEYARD_CHECK_OK(client1.Connect(ipc_socket_1));
+  CHECK_NE(client.instance_id(), client1.instance_id());
+  LOG(INFO) << "Connected to IPCServers: " << ipc_socket << ", "
+            << ipc_socket_1;
+
+  // the whole subtree is found right after being persisted, while another
+  // writer keeps updating etcd
+  std::vector<ObjectID> created;
+  {
+    std::atomic<bool> churning{true};
+    std::vector<ObjectID> churned;
+    std::thread churn([&]() {
+      Client writer;
+      VINEYARD_CHECK_OK(writer.Connect(ipc_socket));
+      while (churning.load()) {
+        ObjectMeta meta;
+        meta.SetTypeName("vineyard::test::SyncedChurn");
+        meta.SetNBytes(0);
+        ObjectID id = InvalidObjectID();
+        VINEYARD_CHECK_OK(writer.CreateMetaData(meta, id));
+        VINEYARD_CHECK_OK(writer.Persist(id));
+        churned.emplace_back(id);
+      }
+      VINEYARD_CHECK_OK(writer.DelData(churned));
+      writer.Disconnect();
+    });
+
+    for (size_t seq = 0; seq < kObjects; ++seq) {
+      ObjectID id = createNested(client, seq);
+      ObjectMeta meta;
+      VINEYARD_CHECK_OK(client1.GetMetaData(id, meta, true));
+      checkNested(meta, id, seq);
+      created.emplace_back(id);
+    }
+    churning.store(false);
+    churn.join();
+  }
+
+  // as well as a batch of them, which are mostly local already
+  {
+    std::vector<ObjectMeta> metas;
+    VINEYARD_CHECK_OK(client1.GetMetaData(created, metas, true));
+    CHECK_EQ(metas.size(), kObjects);
+    for (size_t seq = 0; seq < kObjects; ++seq) {
+      checkNested(metas[seq], created[seq], seq);
+    }
+  }
+  LOG(INFO) << "Passed fetching remote subtrees tests...";
+
+  // the objects that don't exist anywhere are still reported as missing
+  {
+    ObjectMeta meta;
+    CHECK(client1.GetMetaData(GenerateObjectID(), meta, true)
+              .IsObjectNotExists());
+  }
+  LOG(INFO) << "Passed fetching missing objects tests...";
+
+  // the later updates of the fetched objects are still replayed in order
+  std::string const name = "sync_remote_test_name";
+  VINEYARD_CHECK_OK(client.PutName(created[0], name));
+  VINEYARD_CHECK_OK(client.PutName(created[1], name));
+  waitFor([&]() {
+    ObjectID id = InvalidObjectID();
+    return client1.GetName(name, id).ok() && id == created[1];
+  });
+  VINEYARD_CHECK_OK(client.DropName(name));
+
+  VINEYARD_CHECK_OK(client.DelData(created, false, true));
+  for (auto const id : created) {
+    waitFor([&]() {
+      bool exists = true;
+      VINEYARD_CHECK_OK(client1.Exists(id, exists));
+      return !exists;
+    });
+  }
+  LOG(INFO) << "Passed replaying later updates tests...";
+
+  client1.Disconnect();
+  client.Disconnect();
+
+  LOG(INFO) << "Passed sync remote tests...";
+
+  return 0;
+}
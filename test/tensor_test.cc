@@ -16,6 +16,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "arrow/status.h"
 #include "arrow/util/io_util.h"
@@ -23,6 +24,7 @@ limitations under the License.
 
 #include "basic/ds/tensor.h"
 #include "client/client.h"
+#include "client/ds/dlpack.h"
 #include "client/ds/object_meta.h"
 #include "common/util/logging.h"
 
@@ -58,6 +60,134 @@ int main(int argc, char** argv) {
 
   LOG(INFO) << "Passed tensor tests...";
 
+  {
+    TiledTensorBuilder<double> tiled_builder(client, {5, 7}, {2, 3});
+    std::vector<double> values(35);
+    for (int i = 0; i < 35; ++i) {
+      values[i] = i;
+    }
+    VINEYARD_CHECK_OK(tiled_builder.Write({0, 0}, {5, 7}, values.data()));
+    auto tiled = std::dynamic_pointer_cast<TiledTensor<double>>(
+        tiled_builder.Seal(client));
+    CHECK_EQ(tiled->grid()[0], 3);
+    CHECK_EQ(tiled->grid()[1], 3);
+    CHECK_EQ(tiled->tile_extent({2, 2})[0], 1);
+    CHECK_EQ(tiled->tile_extent({2, 2})[1], 1);
+    CHECK_EQ(tiled->at({4, 6}), 34);
+
+    // read a column, i.e., along the non-leading axis
+    std::vector<double> column(5);
+    VINEYARD_CHECK_OK(tiled->Read({0, 4}, {5, 5}, column.data()));
+    for (int i = 0; i < 5; ++i) {
+      CHECK_EQ(column[i], i * 7 + 4);
+    }
+    CHECK(!tiled->Read({0, 4}, {6, 5}, column.data()).ok());
+  }
+
+  LOG(INFO) << "Passed tiled tensor tests...";
+
+  // the layouts are converted in blocks, and in parallel
+  {
+    std::vector<int64_t> shape = {67, 130, 3};
+    auto value = [](int64_t i, int64_t j, int64_t k) {
+      return static_cast<double>(i * 390 + j * 3 + k);
+    };
+    TensorBuilder<double> c_builder(client, shape);
+    CHECK_EQ(c_builder.layout(), "C");
+    for (int64_t i = 0; i < 67 * 130 * 3; ++i) {
+      c_builder.data()[i] = i;
+    }
+    auto c_tensor =
+        std::dynamic_pointer_cast<Tensor<double>>(c_builder.Seal(client));
+    CHECK_EQ(c_tensor->layout(), "C");
+    CHECK(c_tensor->strides() == std::vector<int64_t>({3120, 24, 8}));
+
+    std::shared_ptr<Tensor<double>> f_tensor;
+    VINEYARD_CHECK_OK(ConvertLayout(client, *c_tensor, "F", f_tensor));
+    CHECK_EQ(f_tensor->layout(), "F");
+    CHECK(f_tensor->shape() == shape);
+    CHECK(f_tensor->strides() == std::vector<int64_t>({8, 536, 69680}));
+    CHECK(f_tensor->ArrowTensor()->is_column_major());
+    for (int64_t i = 0; i < 67; ++i) {
+      for (int64_t j = 0; j < 130; ++j) {
+        for (int64_t k = 0; k < 3; ++k) {
+          CHECK_EQ(f_tensor->data()[i + 67 * (j + 130 * k)], value(i, j, k));
+        }
+      }
+    }
+
+    // and back, on fewer threads than the blocks
+    std::shared_ptr<Tensor<double>> round_trip;
+    VINEYARD_CHECK_OK(ConvertLayout(client, *f_tensor, "C", round_trip, 3));
+    CHECK_EQ(round_trip->layout(), "C");
+    for (int64_t i = 0; i < 67 * 130 * 3; ++i) {
+      CHECK_EQ(round_trip->data()[i], c_tensor->data()[i]);
+    }
+    CHECK(ConvertLayout(client, *c_tensor, "X", round_trip).IsInvalid());
+
+    // the tiles of the blocked layout, from either dense layout
+    for (auto const& dense : {c_tensor, f_tensor}) {
+      std::shared_ptr<TiledTensor<double>> tiled;
+      VINEYARD_CHECK_OK(ConvertLayout(client, *dense, {16, 32, 2}, tiled));
+      CHECK_EQ(tiled->grid()[0], 5);
+      CHECK_EQ(tiled->grid()[1], 5);
+      CHECK_EQ(tiled->grid()[2], 2);
+      for (int64_t i = 0; i < 67; i += 5) {
+        for (int64_t j = 0; j < 130; j += 7) {
+          for (int64_t k = 0; k < 3; ++k) {
+            CHECK_EQ(tiled->at({i, j, k}), value(i, j, k));
+          }
+        }
+      }
+      CHECK_EQ(tiled->at({66, 129, 2}), value(66, 129, 2));
+      CHECK(ConvertLayout(client, *dense, {16, 32}, tiled).IsInvalid());
+      CHECK(ConvertLayout(client, *dense, {16, 0, 2}, tiled).IsInvalid());
+    }
+  }
+  LOG(INFO) << "Passed tensor layout tests...";
+
+  // the DLPack tensors point into the blobs, which are kept alive until the
+  // tensors are released
+  {
+    TensorBuilder<int32_t> builder(client, {4, 5});
+    builder.set_layout("F");
+    for (int32_t i = 0; i < 20; ++i) {
+      builder.data()[i] = i * 3;
+    }
+    auto sealed =
+        std::dynamic_pointer_cast<Tensor<int32_t>>(builder.Seal(client));
+    const int32_t* data = sealed->data();
+    DLManagedTensor* managed = sealed->ToDLPack();
+    sealed.reset();
+
+    DLTensor const& dl_tensor = managed->dl_tensor;
+    CHECK_EQ(dl_tensor.data, static_cast<const void*>(data));
+    CHECK_EQ(dl_tensor.byte_offset, 0U);
+    CHECK_EQ(dl_tensor.device.device_type, kDLCPU);
+    CHECK_EQ(dl_tensor.dtype.code, kDLInt);
+    CHECK_EQ(dl_tensor.dtype.bits, 32);
+    CHECK_EQ(dl_tensor.dtype.lanes, 1);
+    CHECK_EQ(dl_tensor.ndim, 2);
+    CHECK_EQ(dl_tensor.shape[0], 4);
+    CHECK_EQ(dl_tensor.shape[1], 5);
+    CHECK_EQ(dl_tensor.strides[0], 1);
+    CHECK_EQ(dl_tensor.strides[1], 4);
+    for (int32_t i = 0; i < 20; ++i) {
+      CHECK_EQ(static_cast<const int32_t*>(dl_tensor.data)[i], i * 3);
+    }
+    managed->deleter(managed);
+
+    DLDataType dtype;
+    VINEYARD_CHECK_OK(DLPackDataType("float32", dtype));
+    CHECK_EQ(dtype.code, kDLFloat);
+    CHECK_EQ(dtype.bits, 32);
+    VINEYARD_CHECK_OK(DLPackDataType("uint16", dtype));
+    CHECK_EQ(dtype.code, kDLUInt);
+    CHECK_EQ(dtype.bits, 16);
+    CHECK(DLPackDataType("object", dtype).IsNotImplemented());
+  }
+  LOG(INFO) << "Passed dlpack tests...";
+
   client.Disconnect();
 
   return 0;
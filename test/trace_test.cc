@@ -0,0 +1,211 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "client/client.h"
+#include "common/util/json.h"
+#include "common/util/logging.h"
+#include "common/util/trace.h"
+#include "common/util/uuid.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// More spans than a ring buffer holds are recorded by a thread.
+constexpr int kThreads = 4;
+constexpr int kSpansPerThread = 10000;
+constexpr size_t kTraceBufferCapacity = 4096;
+
+std::string toHex(uint64_t const value) {
+  char buffer[17];
+  snprintf(buffer, sizeof(buffer), "%016llx",
+           static_cast<unsigned long long>(value));  // NOLINT(runtime/int)
+  return std::string(buffer);
+}
+
+json dump(TraceFormat const format) {
+  std::ostringstream os;
+  Tracer::Dump(os, format);
+  return json::parse(os.str());
+}
+
+// the chrome trace events of the given name
+std::vector<json> chromeEvents(json const& trace, std::string const& name) {
+  std::vector<json> events;
+  for (auto const& event : trace["traceEvents"]) {
+    if (event["name"].get<std::string>() == name) {
+      events.emplace_back(event);
+    }
+  }
+  return events;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./trace_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  // the trace ids are unique and never zero
+  {
+    uint64_t previous = 0;
+    for (int index = 0; index < 1000; ++index) {
+      uint64_t trace_id = Tracer::NewTraceID();
+      CHECK_NE(trace_id, 0U);
+      CHECK_NE(trace_id, previous);
+      previous = trace_id;
+    }
+  }
+
+  // the trace id of a scope is restored once the scope ends
+  uint64_t trace_id = Tracer::NewTraceID();
+  {
+    CHECK_EQ(Tracer::CurrentTraceID(), 0U);
+    TraceIDScope outer(trace_id);
+    CHECK_EQ(Tracer::CurrentTraceID(), trace_id);
+    {
+      TraceIDScope inner(trace_id + 1);
+      CHECK_EQ(Tracer::CurrentTraceID(), trace_id + 1);
+    }
+    CHECK_EQ(Tracer::CurrentTraceID(), trace_id);
+    TraceSpan span("trace_test_span");
+  }
+  CHECK_EQ(Tracer::CurrentTraceID(), 0U);
+
+  // the pending request is recorded once it ends, and only once
+  Tracer::BeginRequest(Tracer::InternName("trace_test_request"), trace_id);
+  Tracer::EndRequest();
+  Tracer::EndRequest();
+  CHECK_EQ(Tracer::InternName("trace_test_request"),
+           Tracer::InternName(std::string("trace_test_") + "request"));
+
+  // the threads record into their own buffers, which keep the latest spans
+  {
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < kThreads; ++thread) {
+      threads.emplace_back([]() {
+        for (int index = 0; index < kSpansPerThread; ++index) {
+          uint64_t now = Tracer::Now();
+          Tracer::Record("trace_test_thread", index + 1, now, now + index);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  {
+    json trace = dump(TraceFormat::kChrome);
+    auto spans = chromeEvents(trace, "trace_test_span");
+    CHECK_EQ(spans.size(), 1U);
+    CHECK_EQ(spans[0]["args"]["trace_id"].get<std::string>(), toHex(trace_id));
+    CHECK_GE(spans[0]["dur"].get<double>(), 0);
+    auto requests = chromeEvents(trace, "trace_test_request");
+    CHECK_EQ(requests.size(), 1U);
+    CHECK_EQ(requests[0]["args"]["trace_id"].get<std::string>(),
+             toHex(trace_id));
+
+    auto events = chromeEvents(trace, "trace_test_thread");
+    CHECK_EQ(events.size(), kThreads * kTraceBufferCapacity);
+    for (auto const& event : events) {
+      // the oldest spans are overwritten
+      uint64_t dur = std::llround(event["dur"].get<double>() * 1000);
+      CHECK_GE(dur, kSpansPerThread - kTraceBufferCapacity);
+      CHECK_EQ(event["args"]["trace_id"].get<std::string>(), toHex(dur + 1));
+    }
+  }
+  LOG(INFO) << "Passed chrome traces tests...";
+
+  {
+    json trace = dump(TraceFormat::kOpenTelemetry);
+    auto const& resource = trace["resourceSpans"][0];
+    CHECK_EQ(resource["resource"]["attributes"][0]["key"].get<std::string>(),
+             "service.name");
+    size_t count = 0;
+    for (auto const& span : resource["scopeSpans"][0]["spans"]) {
+      CHECK_EQ(span["traceId"].get<std::string>().size(), 32U);
+      CHECK_EQ(span["spanId"].get<std::string>().size(), 16U);
+      CHECK_LE(std::stoull(span["startTimeUnixNano"].get<std::string>()),
+               std::stoull(span["endTimeUnixNano"].get<std::string>()));
+      if (span["name"].get<std::string>() == "trace_test_span") {
+        CHECK_EQ(span["traceId"].get<std::string>(),
+                 toHex(0) + toHex(trace_id));
+      }
+      count += 1;
+    }
+    CHECK_GE(count, kThreads * kTraceBufferCapacity + 2);
+  }
+  LOG(INFO) << "Passed opentelemetry traces tests...";
+
+  // the format of the file is decided by its suffix
+  {
+    char directory[] = "/tmp/trace_test_XXXXXX";
+    CHECK(mkdtemp(directory) != nullptr);
+    std::string chrome = std::string(directory) + "/trace.json";
+    std::string otlp = std::string(directory) + "/trace.otlp.json";
+    VINEYARD_CHECK_OK(Tracer::Dump(chrome));
+    VINEYARD_CHECK_OK(Tracer::Dump(otlp));
+    std::ifstream chrome_file(chrome), otlp_file(otlp);
+    CHECK(json::parse(chrome_file).contains("traceEvents"));
+    CHECK(json::parse(otlp_file).contains("resourceSpans"));
+    CHECK(Tracer::Dump(std::string(directory) + "/missing/trace.json")
+              .IsIOError());
+    unlink(chrome.c_str());
+    unlink(otlp.c_str());
+    rmdir(directory);
+  }
+  LOG(INFO) << "Passed dumping traces tests...";
+
+#if defined(WITH_TRACING)
+  // the requests of the client are recorded under the current trace id
+  {
+    Client client;
+    VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+    uint64_t request_trace_id = Tracer::NewTraceID();
+    {
+      VINEYARD_TRACE_ID_SCOPE(request_trace_id);
+      bool exists = true;
+      VINEYARD_CHECK_OK(client.Exists(GenerateObjectID(), exists));
+      CHECK(!exists);
+    }
+    client.Disconnect();
+
+    bool found = false;
+    for (auto const& event :
+         chromeEvents(dump(TraceFormat::kChrome), "exists_request")) {
+      found = found || event["args"]["trace_id"].get<std::string>() ==
+                           toHex(request_trace_id);
+    }
+    CHECK(found);
+  }
+  LOG(INFO) << "Passed tracing requests tests...";
+#endif
+
+  LOG(INFO) << "Passed trace tests...";
+
+  return 0;
+}
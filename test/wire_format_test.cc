@@ -0,0 +1,136 @@
+/** Copyright 2020-2021 Alibaba Group Holding Limited.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <unistd.h>
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "basic/ds/scalar.h"
+#include "client/client.h"
+#include "client/io.h"
+#include "common/util/logging.h"
+#include "common/util/protocols.h"
+
+using namespace vineyard;  // NOLINT(build/namespaces)
+
+// Checks the encoding of the replies to the metadata requests, which are
+// written by the server after the metadata has been synced.
+
+static int connect_raw(std::string const& ipc_socket,
+                       WireFormat const wire_format) {
+  int conn = -1;
+  VINEYARD_CHECK_OK(connect_ipc_socket_retry(ipc_socket, conn));
+  std::string message_out, message_in;
+  WriteRegisterRequest(wire_format, 0, message_out);
+  VINEYARD_CHECK_OK(send_message(conn, message_out));
+  VINEYARD_CHECK_OK(recv_message(conn, message_in));
+  std::string ipc_socket_value, rpc_endpoint, version;
+  InstanceID instance_id;
+  WireFormat negotiated = WireFormat::JSON;
+  bool support_batch = false;
+  size_t ring_capacity = 0;
+  VINEYARD_CHECK_OK(ReadRegisterReply(
+      DecodeMessage(message_in), ipc_socket_value, rpc_endpoint, instance_id,
+      version, negotiated, support_batch, ring_capacity));
+  CHECK(negotiated == wire_format);
+  return conn;
+}
+
+static void check_replies(std::string const& ipc_socket,
+                          WireFormat const wire_format, ObjectID const id) {
+  int conn = connect_raw(ipc_socket, wire_format);
+  WireFormatScope wire_format_scope(wire_format);
+  bool const binary = wire_format == WireFormat::MsgPack;
+
+  std::string message_out, message_in;
+  WriteGetDataRequest(id, false, false, message_out);
+  VINEYARD_CHECK_OK(send_message(conn, message_out));
+  VINEYARD_CHECK_OK(recv_message(conn, message_in));
+  CHECK_EQ(IsBinaryMessage(message_in), binary);
+  json tree;
+  VINEYARD_CHECK_OK(ReadGetDataReply(DecodeMessage(message_in), tree));
+  CHECK_EQ(tree["id"].get<std::string>(), ObjectIDToString(id));
+
+  WriteListDataRequest("vineyard::Scalar*", false, 10, message_out);
+  VINEYARD_CHECK_OK(send_message(conn, message_out));
+  VINEYARD_CHECK_OK(recv_message(conn, message_in));
+  CHECK_EQ(IsBinaryMessage(message_in), binary);
+
+  close(conn);
+}
+
+static void check_hot_replies(std::string const& ipc_socket,
+                              WireFormat const wire_format) {
+  int conn = connect_raw(ipc_socket, wire_format);
+  bool const binary = wire_format == WireFormat::MsgPack;
+
+  // the requests are accepted in either format, while the replies to the
+  // hot commands follow the negotiated one
+  for (auto const request_format : {WireFormat::MsgPack, WireFormat::JSON}) {
+    std::string message_out, message_in;
+    {
+      WireFormatScope wire_format_scope(request_format);
+      WriteGetBuffersRequest(std::set<ObjectID>{}, message_out);
+    }
+    CHECK_EQ(IsBinaryMessage(message_out),
+             request_format == WireFormat::MsgPack);
+    VINEYARD_CHECK_OK(send_message(conn, message_out));
+    VINEYARD_CHECK_OK(recv_message(conn, message_in));
+    CHECK_EQ(IsBinaryMessage(message_in), binary);
+    std::vector<Payload> payloads;
+    VINEYARD_CHECK_OK(ReadGetBuffersReply(DecodeMessage(message_in), payloads));
+    CHECK(payloads.empty());
+  }
+
+  close(conn);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("usage ./wire_format_test <ipc_socket>");
+    return 1;
+  }
+  std::string ipc_socket = std::string(argv[1]);
+
+  Client client;
+  VINEYARD_CHECK_OK(client.Connect(ipc_socket));
+  LOG(INFO) << "Connected to IPCServer: " << ipc_socket;
+
+  ScalarBuilder<int32_t> scalar_builder(client);
+  scalar_builder.SetValue(1234);
+  auto scalar =
+      std::dynamic_pointer_cast<Scalar<int32_t>>(scalar_builder.Seal(client));
+
+  check_replies(ipc_socket, WireFormat::MsgPack, scalar->id());
+  LOG(INFO) << "Passed msgpack replies of metadata requests...";
+
+  check_replies(ipc_socket, WireFormat::JSON, scalar->id());
+  LOG(INFO) << "Passed json replies of metadata requests...";
+
+  check_hot_replies(ipc_socket, WireFormat::MsgPack);
+  check_hot_replies(ipc_socket, WireFormat::JSON);
+  LOG(INFO) << "Passed replies of buffer requests...";
+
+  VINEYARD_CHECK_OK(client.DelData(scalar->id()));
+
+  LOG(INFO) << "Passed wire format tests...";
+
+  client.Disconnect();
+
+  return 0;
+}